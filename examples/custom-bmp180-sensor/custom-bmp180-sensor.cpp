@@ -25,7 +25,7 @@ class BMP180Sensor : public sensor::PollingSensorComponent {
     publish_state(pressure / 100.0); // convert to hPa
   }
 
-  std::string unit_of_measurement() override { return "hPa"; }
+  const char *unit_of_measurement() override { return "hPa"; }
   int8_t accuracy_decimals() override { return 2; } // 2 decimal places of accuracy.
 };
 
@@ -36,7 +36,7 @@ class BMP180Sensor : public sensor::PollingSensorComponent {
 class BMP280TemperatureSensor : public sensor::Sensor {
  public:
   BMP280TemperatureSensor(const std::string &name) : sensor::Sensor(name) {}
-  std::string unit_of_measurement() override { return "°C"; }
+  const char *unit_of_measurement() override { return "°C"; }
   int8_t accuracy_decimals() override { return 1; }
 };
 
@@ -44,7 +44,7 @@ class BMP280TemperatureSensor : public sensor::Sensor {
 class BMP280PressureSensor : public sensor::Sensor {
  public:
   BMP280PressureSensor(const std::string &name) : sensor::Sensor(name) {}
-  std::string unit_of_measurement() override { return "hPa"; }
+  const char *unit_of_measurement() override { return "hPa"; }
   int8_t accuracy_decimals() override { return 2; }
 };
 
@@ -0,0 +1,268 @@
+#include "esphome/defines.h"
+
+#ifdef USE_API_CLIENT
+
+#include "esphome/api/api_client.h"
+#include "esphome/api/subscribe_state.h"
+#include "esphome/application.h"
+#include "esphome/helpers.h"
+#include "esphome/log.h"
+#include "esphome/util.h"
+
+ESPHOME_NAMESPACE_BEGIN
+
+namespace api {
+
+static const char *TAG = "api.client";
+
+/// The server pings after 60s without traffic, give up on the connection if it's silent for much longer.
+static const uint32_t API_CLIENT_TIMEOUT = 150000;
+
+APIClient::APIClient(const std::string &address, uint16_t port) : address_(address), port_(port) {}
+
+void APIClient::setup() {
+  ESP_LOGCONFIG(TAG, "Setting up API client for %s...", this->address_.c_str());
+  this->send_buffer_.reserve(64);
+  this->recv_buffer_.reserve(64);
+  this->client_.onConnect([](void *s, AsyncClient *c) { ((APIClient *) s)->connected_event_ = true; }, this);
+  this->client_.onDisconnect([](void *s, AsyncClient *c) { ((APIClient *) s)->disconnected_event_ = true; }, this);
+  this->client_.onError([](void *s, AsyncClient *c, int8_t error) { ((APIClient *) s)->disconnected_event_ = true; },
+                        this);
+  // like APIConnection, the data is only parsed in loop()
+  this->client_.onData(
+      [](void *s, AsyncClient *c, void *buf, size_t len) {
+        auto *a_this = (APIClient *) s;
+        auto *data = reinterpret_cast<uint8_t *>(buf);
+        a_this->recv_buffer_.insert(a_this->recv_buffer_.end(), data, data + len);
+        wake_loop();
+      },
+      this);
+  // mirrors have no state until the first connection
+  this->status_set_warning();
+}
+void APIClient::loop() {
+  if (this->disconnected_event_) {
+    this->disconnected_event_ = false;
+    this->connected_event_ = false;
+    if (this->state_ != State::DISCONNECTED) {
+      ESP_LOGW(TAG, "Disconnected from %s", this->address_.c_str());
+      this->disconnect_();
+    }
+  }
+  if (this->connected_event_) {
+    this->connected_event_ = false;
+    this->on_connected_();
+  }
+
+  const uint32_t now = millis();
+  switch (this->state_) {
+    case State::DISCONNECTED:
+      if (network_is_connected() && now - this->last_attempt_ >= this->reconnect_interval_)
+        this->connect_();
+      break;
+    case State::CONNECTING:
+      break;
+    case State::AUTHENTICATING:
+    case State::SUBSCRIBED:
+      this->parse_recv_buffer_();
+      if (this->state_ != State::DISCONNECTED && now - this->last_traffic_ > API_CLIENT_TIMEOUT) {
+        ESP_LOGW(TAG, "Connection to %s timed out", this->address_.c_str());
+        this->disconnect_();
+      }
+      break;
+  }
+}
+void APIClient::dump_config() {
+  ESP_LOGCONFIG(TAG, "API Client:");
+  ESP_LOGCONFIG(TAG, "  Address: %s:%u", this->address_.c_str(), this->port_);
+  ESP_LOGCONFIG(TAG, "  Uses Password: %s", YESNO(!this->password_.empty()));
+  ESP_LOGCONFIG(TAG, "  Mirrored Entities: %u", this->mirrors_.size());
+}
+float APIClient::get_setup_priority() const { return setup_priority::WIFI - 1.0f; }
+bool APIClient::is_connected() const { return this->state_ == State::SUBSCRIBED; }
+
+void APIClient::connect_() {
+  ESP_LOGD(TAG, "Connecting to %s:%u...", this->address_.c_str(), this->port_);
+  this->last_attempt_ = millis();
+  this->recv_buffer_.clear();
+  if (!this->client_.connect(this->address_.c_str(), this->port_)) {
+    ESP_LOGW(TAG, "Connecting to %s failed!", this->address_.c_str());
+    return;
+  }
+  this->state_ = State::CONNECTING;
+}
+void APIClient::disconnect_() {
+  this->state_ = State::DISCONNECTED;
+  this->last_attempt_ = millis();
+  this->client_.close(true);
+  this->status_set_warning();
+}
+void APIClient::on_connected_() {
+  if (this->state_ != State::CONNECTING)
+    return;
+  this->state_ = State::AUTHENTICATING;
+  this->last_traffic_ = millis();
+
+  // The server handles the messages in order, so they can be sent without waiting for the responses
+  auto buffer = this->get_buffer_();
+  // string client_info = 1;
+  buffer.encode_string(1, App.get_name());
+  bool success = this->send_message_(APIMessageType::HELLO_REQUEST);
+
+  buffer = this->get_buffer_();
+  // string password = 1;
+  buffer.encode_string(1, this->password_);
+  success = success && this->send_message_(APIMessageType::CONNECT_REQUEST);
+
+  this->get_buffer_();
+  success = success && this->send_message_(APIMessageType::SUBSCRIBE_STATES_REQUEST);
+
+  if (!success) {
+    ESP_LOGW(TAG, "Sending the handshake to %s failed!", this->address_.c_str());
+    this->disconnect_();
+  }
+}
+
+APIBuffer APIClient::get_buffer_() {
+  this->send_buffer_.clear();
+  return APIBuffer(&this->send_buffer_);
+}
+bool APIClient::send_message_(APIMessageType type) {
+  std::vector<uint8_t> frame;
+  frame.reserve(this->send_buffer_.size() + 11);
+  APIBuffer header(&frame);
+  header.write(0x00);
+  header.encode_varint_raw(this->send_buffer_.size());
+  header.encode_varint_raw(static_cast<uint32_t>(type));
+  frame.insert(frame.end(), this->send_buffer_.begin(), this->send_buffer_.end());
+
+  if (frame.size() > this->client_.space())
+    return false;
+  this->client_.add(reinterpret_cast<char *>(frame.data()), frame.size());
+  return this->client_.send();
+}
+
+void APIClient::parse_recv_buffer_() {
+  size_t offset = 0;
+  while (offset < this->recv_buffer_.size()) {
+    const uint8_t *data = this->recv_buffer_.data() + offset;
+    const size_t remaining = this->recv_buffer_.size() - offset;
+    if (data[0] != 0x00) {
+      ESP_LOGW(TAG, "Invalid preamble from %s", this->address_.c_str());
+      this->disconnect_();
+      return;
+    }
+    uint32_t consumed;
+    auto msg_size = proto_decode_varuint32(data + 1, remaining - 1, &consumed);
+    if (!msg_size.has_value())
+      // not enough data there yet
+      break;
+    size_t header = 1 + consumed;
+    auto msg_type = proto_decode_varuint32(data + header, remaining - header, &consumed);
+    if (!msg_type.has_value())
+      break;
+    header += consumed;
+    if (remaining - header < *msg_size)
+      // message body not fully received
+      break;
+
+    this->last_traffic_ = millis();
+    this->read_message_(static_cast<APIMessageType>(*msg_type), data + header, *msg_size);
+    if (this->state_ == State::DISCONNECTED)
+      return;
+    offset += header + *msg_size;
+  }
+  this->recv_buffer_.erase(this->recv_buffer_.begin(), this->recv_buffer_.begin() + offset);
+}
+void APIClient::read_message_(APIMessageType type, const uint8_t *msg, size_t len) {
+  switch (type) {
+    case APIMessageType::CONNECT_RESPONSE: {
+      // bool invalid_password = 1;
+      const bool invalid_password = len >= 2 && msg[0] == 0x08 && msg[1] != 0;
+      if (invalid_password) {
+        ESP_LOGE(TAG, "Invalid password for %s!", this->address_.c_str());
+        this->disconnect_();
+        return;
+      }
+      ESP_LOGI(TAG, "Connected to %s", this->address_.c_str());
+      this->state_ = State::SUBSCRIBED;
+      this->status_clear_warning();
+      break;
+    }
+    case APIMessageType::PING_REQUEST:
+      this->get_buffer_();
+      this->send_message_(APIMessageType::PING_RESPONSE);
+      break;
+    case APIMessageType::DISCONNECT_REQUEST:
+      this->get_buffer_();
+      this->send_message_(APIMessageType::DISCONNECT_RESPONSE);
+      ESP_LOGW(TAG, "%s closed the connection", this->address_.c_str());
+      this->disconnect_();
+      break;
+    case APIMessageType::BINARY_SENSOR_STATE_RESPONSE:
+    case APIMessageType::SENSOR_STATE_RESPONSE:
+    case APIMessageType::TEXT_SENSOR_STATE_RESPONSE: {
+      EntityStateResponse state(type);
+      state.decode(msg, len);
+      for (auto &mirror : this->mirrors_) {
+        if (mirror.type != type || mirror.key != state.get_key())
+          continue;
+        switch (type) {
+#ifdef USE_BINARY_SENSOR
+          case APIMessageType::BINARY_SENSOR_STATE_RESPONSE:
+            static_cast<binary_sensor::BinarySensor *>(mirror.obj)->publish_state(state.get_bool_state());
+            break;
+#endif
+#ifdef USE_SENSOR
+          case APIMessageType::SENSOR_STATE_RESPONSE:
+            static_cast<sensor::Sensor *>(mirror.obj)->publish_state(state.get_float_state());
+            break;
+#endif
+#ifdef USE_TEXT_SENSOR
+          case APIMessageType::TEXT_SENSOR_STATE_RESPONSE:
+            static_cast<text_sensor::TextSensor *>(mirror.obj)->publish_state(state.get_string_state());
+            break;
+#endif
+          default:
+            break;
+        }
+      }
+      break;
+    }
+    default:
+      // other entities and requests of Home Assistant (for example the time) aren't used
+      break;
+  }
+}
+
+#ifdef USE_BINARY_SENSOR
+binary_sensor::BinarySensor *APIClient::make_binary_sensor(const std::string &name, const std::string &object_id) {
+  auto *binary_sensor = new binary_sensor::BinarySensor(name);
+  this->mirrors_.push_back(
+      Mirror{fnv1_hash(object_id), APIMessageType::BINARY_SENSOR_STATE_RESPONSE, binary_sensor});
+  return binary_sensor;
+}
+#endif
+#ifdef USE_SENSOR
+sensor::Sensor *APIClient::make_sensor(const std::string &name, const std::string &object_id) {
+  auto *sensor = new sensor::Sensor(name);
+  this->mirrors_.push_back(Mirror{fnv1_hash(object_id), APIMessageType::SENSOR_STATE_RESPONSE, sensor});
+  return sensor;
+}
+#endif
+#ifdef USE_TEXT_SENSOR
+text_sensor::TextSensor *APIClient::make_text_sensor(const std::string &name, const std::string &object_id) {
+  auto *text_sensor = new text_sensor::TextSensor(name);
+  this->mirrors_.push_back(Mirror{fnv1_hash(object_id), APIMessageType::TEXT_SENSOR_STATE_RESPONSE, text_sensor});
+  return text_sensor;
+}
+#endif
+
+void APIClient::set_password(const std::string &password) { this->password_ = password; }
+void APIClient::set_reconnect_interval(uint32_t reconnect_interval) { this->reconnect_interval_ = reconnect_interval; }
+
+}  // namespace api
+
+ESPHOME_NAMESPACE_END
+
+#endif  // USE_API_CLIENT
@@ -0,0 +1,112 @@
+#ifndef ESPHOME_API_API_CLIENT_H
+#define ESPHOME_API_API_CLIENT_H
+
+#include "esphome/defines.h"
+
+#ifdef USE_API_CLIENT
+
+#include <vector>
+#include "esphome/component.h"
+#include "esphome/api/util.h"
+#include "esphome/api/api_message.h"
+#include "esphome/binary_sensor/binary_sensor.h"
+#include "esphome/sensor/sensor.h"
+#include "esphome/text_sensor/text_sensor.h"
+
+#ifdef ARDUINO_ARCH_ESP32
+#include <AsyncTCP.h>
+#endif
+#ifdef ARDUINO_ARCH_ESP8266
+#include <ESPAsyncTCP.h>
+#endif
+
+ESPHOME_NAMESPACE_BEGIN
+
+namespace api {
+
+/** Connect to the native API of another node and mirror some of its entities.
+ *
+ * In contrast to the Home Assistant sensors, which get their states through Home Assistant, the states come
+ * straight from the other node, so they keep working while Home Assistant is unavailable. The client subscribes
+ * to all states of the node, the state of each mirrored entity is published to a local entity that's created
+ * with make_sensor() etc. The mirrors keep their last state while the connection is down, the client reconnects
+ * every reconnect interval.
+ */
+class APIClient : public Component {
+ public:
+  /**
+   * @param address The host name or IP address of the other node.
+   * @param port The port of its native API.
+   */
+  APIClient(const std::string &address, uint16_t port);
+
+  void set_password(const std::string &password);
+  /// Set the time between connection attempts in ms, defaults to 5s.
+  void set_reconnect_interval(uint32_t reconnect_interval);
+
+#ifdef USE_BINARY_SENSOR
+  /// Create a local binary sensor that mirrors the binary sensor with the given object id of the other node.
+  binary_sensor::BinarySensor *make_binary_sensor(const std::string &name, const std::string &object_id);
+#endif
+#ifdef USE_SENSOR
+  sensor::Sensor *make_sensor(const std::string &name, const std::string &object_id);
+#endif
+#ifdef USE_TEXT_SENSOR
+  text_sensor::TextSensor *make_text_sensor(const std::string &name, const std::string &object_id);
+#endif
+
+  /// Whether the client is connected and subscribed to the states of the other node.
+  bool is_connected() const;
+
+  void setup() override;
+  void loop() override;
+  void dump_config() override;
+  float get_setup_priority() const override;
+
+ protected:
+  enum class State {
+    DISCONNECTED,
+    CONNECTING,
+    /// The connection is open and Hello/Connect/SubscribeStates were sent, waiting for the ConnectResponse.
+    AUTHENTICATING,
+    SUBSCRIBED,
+  };
+  struct Mirror {
+    uint32_t key;
+    APIMessageType type;
+    Nameable *obj;
+  };
+
+  void connect_();
+  void disconnect_();
+  void on_connected_();
+  /// Frame the message in send_buffer_ and send it.
+  bool send_message_(APIMessageType type);
+  APIBuffer get_buffer_();
+  void parse_recv_buffer_();
+  void read_message_(APIMessageType type, const uint8_t *msg, size_t len);
+
+  std::string address_;
+  uint16_t port_;
+  std::string password_;
+  uint32_t reconnect_interval_{5000};
+  std::vector<Mirror> mirrors_;
+
+  AsyncClient client_;
+  State state_{State::DISCONNECTED};
+  /// Set by the TCP callbacks, handled in loop().
+  volatile bool connected_event_{false};
+  volatile bool disconnected_event_{false};
+  uint32_t last_attempt_{0};
+  uint32_t last_traffic_{0};
+  std::vector<uint8_t> send_buffer_;
+  std::vector<uint8_t> recv_buffer_;
+};
+
+}  // namespace api
+
+ESPHOME_NAMESPACE_END
+
+#endif  // USE_API_CLIENT
+
+#endif  // ESPHOME_API_API_CLIENT_H
@@ -0,0 +1,175 @@
+#include "esphome/defines.h"
+
+#ifdef USE_API
+
+#include "esphome/api/api_crypto.h"
+#include <cstring>
+
+ESPHOME_NAMESPACE_BEGIN
+
+namespace api {
+
+static const size_t SHA256_SIZE = 32;
+static const size_t SHA256_BLOCK_SIZE = 64;
+
+/// Incremental SHA-256 of the platform's crypto library.
+class SHA256 {
+ public:
+  SHA256() {
+#ifdef ARDUINO_ARCH_ESP32
+    mbedtls_sha256_init(&this->ctx_);
+    mbedtls_sha256_starts(&this->ctx_, 0);
+#endif
+#ifdef ARDUINO_ARCH_ESP8266
+    br_sha256_init(&this->ctx_);
+#endif
+  }
+  ~SHA256() {
+#ifdef ARDUINO_ARCH_ESP32
+    mbedtls_sha256_free(&this->ctx_);
+#endif
+  }
+  void update(const uint8_t *data, size_t len) {
+#ifdef ARDUINO_ARCH_ESP32
+    mbedtls_sha256_update(&this->ctx_, data, len);
+#endif
+#ifdef ARDUINO_ARCH_ESP8266
+    br_sha256_update(&this->ctx_, data, len);
+#endif
+  }
+  void finish(uint8_t *out) {
+#ifdef ARDUINO_ARCH_ESP32
+    mbedtls_sha256_finish(&this->ctx_, out);
+#endif
+#ifdef ARDUINO_ARCH_ESP8266
+    br_sha256_out(&this->ctx_, out);
+#endif
+  }
+
+ protected:
+#ifdef ARDUINO_ARCH_ESP32
+  mbedtls_sha256_context ctx_;
+#endif
+#ifdef ARDUINO_ARCH_ESP8266
+  br_sha256_context ctx_;
+#endif
+};
+
+/// HMAC-SHA256 of two concatenated parts.
+static void hmac_sha256(const uint8_t *key, size_t key_len, const uint8_t *a, size_t a_len, const uint8_t *b,
+                        size_t b_len, uint8_t *out) {
+  uint8_t block[SHA256_BLOCK_SIZE] = {0};
+  if (key_len > SHA256_BLOCK_SIZE) {
+    SHA256 hash;
+    hash.update(key, key_len);
+    hash.finish(block);
+  } else {
+    memcpy(block, key, key_len);
+  }
+
+  uint8_t pad[SHA256_BLOCK_SIZE];
+  uint8_t inner[SHA256_SIZE];
+  for (size_t i = 0; i < SHA256_BLOCK_SIZE; i++)
+    pad[i] = block[i] ^ 0x36;
+  {
+    SHA256 hash;
+    hash.update(pad, sizeof(pad));
+    hash.update(a, a_len);
+    hash.update(b, b_len);
+    hash.finish(inner);
+  }
+  for (size_t i = 0; i < SHA256_BLOCK_SIZE; i++)
+    pad[i] = block[i] ^ 0x5C;
+  SHA256 hash;
+  hash.update(pad, sizeof(pad));
+  hash.update(inner, sizeof(inner));
+  hash.finish(out);
+}
+
+void api_hkdf_sha256(const uint8_t *salt, size_t salt_len, const uint8_t *ikm, size_t ikm_len, const char *info,
+                     uint8_t *out, size_t out_len) {
+  uint8_t prk[SHA256_SIZE];
+  hmac_sha256(salt, salt_len, ikm, ikm_len, nullptr, 0, prk);
+
+  // T(i) = HMAC(PRK, T(i - 1) | info | i)
+  const size_t info_len = strlen(info);
+  uint8_t t[SHA256_SIZE + 32 + 1];
+  size_t t_len = 0;
+  for (uint8_t i = 1; out_len > 0; i++) {
+    // info is at most 32 bytes, only used with constant strings
+    memcpy(t + t_len, info, info_len);
+    t[t_len + info_len] = i;
+    hmac_sha256(prk, sizeof(prk), t, t_len + info_len + 1, nullptr, 0, t);
+    t_len = SHA256_SIZE;
+    const size_t n = out_len < SHA256_SIZE ? out_len : SHA256_SIZE;
+    memcpy(out, t, n);
+    out += n;
+    out_len -= n;
+  }
+}
+
+APICipherSuite api_crypto_suite() {
+#ifdef ARDUINO_ARCH_ESP32
+  return APICipherSuite::AES_128_GCM;
+#else
+  return APICipherSuite::CHACHA20_POLY1305;
+#endif
+}
+
+APIFrameCipher::APIFrameCipher(const uint8_t *key, const uint8_t *nonce_prefix) {
+#ifdef ARDUINO_ARCH_ESP32
+  mbedtls_gcm_init(&this->gcm_);
+  mbedtls_gcm_setkey(&this->gcm_, MBEDTLS_CIPHER_ID_AES, key, 128);
+#endif
+#ifdef ARDUINO_ARCH_ESP8266
+  memcpy(this->key_, key, sizeof(this->key_));
+#endif
+  memcpy(this->nonce_prefix_, nonce_prefix, sizeof(this->nonce_prefix_));
+}
+APIFrameCipher::~APIFrameCipher() {
+#ifdef ARDUINO_ARCH_ESP32
+  mbedtls_gcm_free(&this->gcm_);
+#endif
+}
+void APIFrameCipher::next_nonce_(uint8_t *nonce) {
+  memcpy(nonce, this->nonce_prefix_, sizeof(this->nonce_prefix_));
+  const uint64_t counter = this->counter_++;
+  for (uint8_t i = 0; i < 8; i++)
+    nonce[4 + i] = counter >> (56 - i * 8);
+}
+void APIFrameCipher::encrypt(const uint8_t *header, uint8_t *data, size_t len, uint8_t *tag) {
+  uint8_t nonce[12];
+  this->next_nonce_(nonce);
+#ifdef ARDUINO_ARCH_ESP32
+  mbedtls_gcm_crypt_and_tag(&this->gcm_, MBEDTLS_GCM_ENCRYPT, len, nonce, sizeof(nonce), header,
+                            API_CRYPTO_HEADER_SIZE, data, data, API_CRYPTO_TAG_SIZE, tag);
+#endif
+#ifdef ARDUINO_ARCH_ESP8266
+  uint8_t full_tag[16];
+  br_poly1305_ctmul_run(this->key_, nonce, data, len, header, API_CRYPTO_HEADER_SIZE, full_tag, br_chacha20_ct_run, 1);
+  memcpy(tag, full_tag, API_CRYPTO_TAG_SIZE);
+#endif
+}
+bool APIFrameCipher::decrypt(const uint8_t *header, uint8_t *data, size_t len, const uint8_t *tag) {
+  uint8_t nonce[12];
+  this->next_nonce_(nonce);
+#ifdef ARDUINO_ARCH_ESP32
+  return mbedtls_gcm_auth_decrypt(&this->gcm_, len, nonce, sizeof(nonce), header, API_CRYPTO_HEADER_SIZE, tag,
+                                  API_CRYPTO_TAG_SIZE, data, data) == 0;
+#endif
+#ifdef ARDUINO_ARCH_ESP8266
+  uint8_t full_tag[16];
+  br_poly1305_ctmul_run(this->key_, nonce, data, len, header, API_CRYPTO_HEADER_SIZE, full_tag, br_chacha20_ct_run, 0);
+  // constant time comparison
+  uint8_t diff = 0;
+  for (size_t i = 0; i < API_CRYPTO_TAG_SIZE; i++)
+    diff |= full_tag[i] ^ tag[i];
+  return diff == 0;
+#endif
+}
+
+}  // namespace api
+
+ESPHOME_NAMESPACE_END
+
+#endif  // USE_API
@@ -0,0 +1,86 @@
+#ifndef ESPHOME_API_API_CRYPTO_H
+#define ESPHOME_API_API_CRYPTO_H
+
+#include "esphome/defines.h"
+
+#ifdef USE_API
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+#ifdef ARDUINO_ARCH_ESP32
+#include <mbedtls/gcm.h>
+#include <mbedtls/sha256.h>
+#endif
+#ifdef ARDUINO_ARCH_ESP8266
+#include <bearssl/bearssl.h>
+#endif
+
+ESPHOME_NAMESPACE_BEGIN
+
+namespace api {
+
+/* The encrypted transport of the native API.
+ *
+ * Encrypted frames are [0x01] [payload length, 16-bit big endian] [payload]. The client starts with a handshake
+ * frame with a random 16 byte nonce, the server answers with its own nonce and the cipher suite. Both sides then
+ * derive a key and nonce prefix per direction with HKDF-SHA256 from the pre-shared key and both nonces. All further
+ * payloads are one or more plaintext frames, encrypted with the suite and followed by a truncated 8 byte tag. The
+ * AEAD nonce is the nonce prefix and a frame counter, so it isn't sent and the overhead is 11 bytes per frame.
+ */
+
+/// The preamble of encrypted frames, plaintext frames start with 0x00.
+static const uint8_t API_CRYPTO_PREAMBLE = 0x01;
+static const size_t API_CRYPTO_HEADER_SIZE = 3;
+static const size_t API_CRYPTO_TAG_SIZE = 8;
+static const size_t API_CRYPTO_OVERHEAD = API_CRYPTO_HEADER_SIZE + API_CRYPTO_TAG_SIZE;
+static const size_t API_CRYPTO_NONCE_SIZE = 16;
+
+enum class APICipherSuite : uint8_t {
+  /// AES-128-GCM, on the ESP32 with the hardware AES accelerator.
+  AES_128_GCM = 1,
+  /// ChaCha20-Poly1305, fast in software on the ESP8266.
+  CHACHA20_POLY1305 = 2,
+};
+
+/// The suite of this platform.
+APICipherSuite api_crypto_suite();
+
+/// HKDF-SHA256 (RFC 5869), SHA-256 uses the hardware accelerator of the ESP32.
+void api_hkdf_sha256(const uint8_t *salt, size_t salt_len, const uint8_t *ikm, size_t ikm_len, const char *info,
+                     uint8_t *out, size_t out_len);
+
+/// One direction of an encrypted connection, en- or decrypts the payloads in place.
+class APIFrameCipher {
+ public:
+  APIFrameCipher(const uint8_t *key, const uint8_t *nonce_prefix);
+  APIFrameCipher(const APIFrameCipher &) = delete;
+  APIFrameCipher &operator=(const APIFrameCipher &) = delete;
+  ~APIFrameCipher();
+
+  /// Encrypt data in place and write the tag of API_CRYPTO_TAG_SIZE bytes, header is the frame header.
+  void encrypt(const uint8_t *header, uint8_t *data, size_t len, uint8_t *tag);
+  /// Decrypt data in place, returns false if the tag doesn't match.
+  bool decrypt(const uint8_t *header, uint8_t *data, size_t len, const uint8_t *tag);
+
+ protected:
+  void next_nonce_(uint8_t *nonce);
+
+#ifdef ARDUINO_ARCH_ESP32
+  mbedtls_gcm_context gcm_;
+#endif
+#ifdef ARDUINO_ARCH_ESP8266
+  uint8_t key_[32];
+#endif
+  uint8_t nonce_prefix_[4];
+  uint64_t counter_{0};
+};
+
+}  // namespace api
+
+ESPHOME_NAMESPACE_END
+
+#endif  // USE_API
+
+#endif  // ESPHOME_API_API_CRYPTO_H
@@ -15,70 +15,130 @@ bool APIMessage::decode_varint(uint32_t field_id, uint32_t value) { return false
 bool APIMessage::decode_length_delimited(uint32_t field_id, const uint8_t *value, size_t len) { return false; }
 bool APIMessage::decode_32bit(uint32_t field_id, uint32_t value) { return false; }
 void APIMessage::encode(APIBuffer &buffer) {}
-void APIMessage::decode(const uint8_t *buffer, size_t length) {
-  uint32_t i = 0;
-  bool error = false;
-  while (i < length) {
+/// Reads the fields of an APIMessageView, in place as long as a value isn't split between the parts.
+class APIMessageReader {
+ public:
+  explicit APIMessageReader(const APIMessageView &view) : view_(view) {}
+
+  size_t position() const { return this->pos_; }
+  size_t remaining() const { return this->view_.size() - this->pos_; }
+
+  optional<uint32_t> read_varint() {
     uint32_t consumed;
-    auto res = proto_decode_varuint32(&buffer[i], length - i, &consumed);
+    if (this->pos_ < this->view_.len) {
+      auto res = proto_decode_varuint32(this->view_.data + this->pos_, this->view_.len - this->pos_, &consumed);
+      if (res.has_value()) {
+        this->pos_ += consumed;
+        return res;
+      }
+      if (this->view_.rest_len == 0)
+        return {};
+    } else {
+      const size_t offset = this->pos_ - this->view_.len;
+      auto res = proto_decode_varuint32(this->view_.rest + offset, this->view_.rest_len - offset, &consumed);
+      if (res.has_value())
+        this->pos_ += consumed;
+      return res;
+    }
+    // split between the parts
+    uint32_t result = 0;
+    for (uint8_t i = 0; i < 5 && this->remaining() > 0; i++) {
+      const uint8_t val = this->next_byte_();
+      result |= uint32_t(val & 0x7F) << (i * 7);
+      if ((val & 0x80) == 0)
+        return result;
+    }
+    return {};
+  }
+  uint32_t read_fixed32() {
+    uint32_t val = 0;
+    for (uint8_t i = 0; i < 4; i++)
+      val |= uint32_t(this->next_byte_()) << (i * 8);
+    return val;
+  }
+  /// Get the next len bytes in one piece, bytes split between the parts are copied into scratch.
+  const uint8_t *read_bytes(size_t len, std::vector<uint8_t> *scratch) {
+    const size_t start = this->pos_;
+    this->pos_ += len;
+    if (start >= this->view_.len)
+      return this->view_.rest + (start - this->view_.len);
+    if (this->pos_ <= this->view_.len)
+      return this->view_.data + start;
+    scratch->assign(this->view_.data + start, this->view_.data + this->view_.len);
+    scratch->insert(scratch->end(), this->view_.rest, this->view_.rest + (this->pos_ - this->view_.len));
+    return scratch->data();
+  }
+
+ protected:
+  uint8_t next_byte_() {
+    const size_t i = this->pos_++;
+    return i < this->view_.len ? this->view_.data[i] : this->view_.rest[i - this->view_.len];
+  }
+
+  const APIMessageView &view_;
+  size_t pos_{0};
+};
+
+void APIMessage::decode(const uint8_t *buffer, size_t length) { this->decode(APIMessageView{buffer, length}); }
+void APIMessage::decode(const APIMessageView &view) {
+  APIMessageReader reader(view);
+  std::vector<uint8_t> scratch;
+  bool error = false;
+  while (reader.remaining() > 0) {
+    auto res = reader.read_varint();
     if (!res.has_value()) {
-      ESP_LOGV(TAG, "Invalid field start at %u", i);
+      ESP_LOGV(TAG, "Invalid field start at %u", reader.position());
       break;
     }
 
     uint32_t field_type = (*res) & 0b111;
     uint32_t field_id = (*res) >> 3;
-    i += consumed;
 
     switch (field_type) {
       case 0: {  // VarInt
-        res = proto_decode_varuint32(&buffer[i], length - i, &consumed);
+        res = reader.read_varint();
         if (!res.has_value()) {
-          ESP_LOGV(TAG, "Invalid VarInt at %u", i);
+          ESP_LOGV(TAG, "Invalid VarInt at %u", reader.position());
           error = true;
           break;
         }
         if (!this->decode_varint(field_id, *res)) {
           ESP_LOGV(TAG, "Cannot decode VarInt field %u with value %u!", field_id, *res);
         }
-        i += consumed;
         break;
       }
       case 2: {  // Length-delimited
-        res = proto_decode_varuint32(&buffer[i], length - i, &consumed);
+        res = reader.read_varint();
         if (!res.has_value()) {
-          ESP_LOGV(TAG, "Invalid Length Delimited at %u", i);
+          ESP_LOGV(TAG, "Invalid Length Delimited at %u", reader.position());
           error = true;
           break;
         }
-        i += consumed;
-        if (*res > length - i) {
-          ESP_LOGV(TAG, "Out-of-bounds Length Delimited at %u", i);
+        if (*res > reader.remaining()) {
+          ESP_LOGV(TAG, "Out-of-bounds Length Delimited at %u", reader.position());
           error = true;
           break;
         }
-        if (!this->decode_length_delimited(field_id, &buffer[i], *res)) {
+        const uint8_t *value = reader.read_bytes(*res, &scratch);
+        if (!this->decode_length_delimited(field_id, value, *res)) {
           ESP_LOGV(TAG, "Cannot decode Length Delimited field %u!", field_id);
         }
-        i += *res;
         break;
       }
       case 5: {  // 32-bit
-        if (length - i < 4) {
-          ESP_LOGV(TAG, "Out-of-bounds Fixed32-bit at %u", i);
+        if (reader.remaining() < 4) {
+          ESP_LOGV(TAG, "Out-of-bounds Fixed32-bit at %u", reader.position());
           error = true;
           break;
         }
-        uint32_t val = (uint32_t(buffer[i]) << 0) | (uint32_t(buffer[i + 1]) << 8) | (uint32_t(buffer[i + 2]) << 16) |
-                       (uint32_t(buffer[i + 3]) << 24);
+        uint32_t val = reader.read_fixed32();
         if (!this->decode_32bit(field_id, val)) {
           ESP_LOGV(TAG, "Cannot decode 32-bit field %u with value %u!", field_id, val);
         }
-        i += 4;
         break;
       }
       default:
-        ESP_LOGV(TAG, "Invalid field type at %u", i);
+        ESP_LOGV(TAG, "Invalid field type at %u", reader.position());
         error = true;
         break;
     }
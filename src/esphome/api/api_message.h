@@ -68,11 +68,37 @@ enum class APIMessageType {
   HOME_ASSISTANT_STATE_RESPONSE = 40,
 
   EXECUTE_SERVICE_REQUEST = 42,
+
+  COMPONENT_STATS_REQUEST = 49,
+  COMPONENT_STATS_RESPONSE = 50,
+
+  TRACE_REQUEST = 51,
+  TRACE_RESPONSE = 52,
+
+  SENSOR_HISTORY_REQUEST = 53,
+  SENSOR_HISTORY_RESPONSE = 54,
+
+  METRICS_REQUEST = 55,
+  METRICS_RESPONSE = 56,
+};
+
+/** A received message in up to two parts, for messages that are split across two TCP packets.
+ *
+ * The parts are decoded in place, only length-delimited fields that are split themselves are copied.
+ */
+struct APIMessageView {
+  const uint8_t *data;
+  size_t len;
+  const uint8_t *rest{nullptr};
+  size_t rest_len{0};
+
+  size_t size() const { return this->len + this->rest_len; }
 };
 
 class APIMessage {
  public:
   void decode(const uint8_t *buffer, size_t length);
+  void decode(const APIMessageView &view);
   virtual bool decode_varint(uint32_t field_id, uint32_t value);
   virtual bool decode_length_delimited(uint32_t field_id, const uint8_t *value, size_t len);
   virtual bool decode_32bit(uint32_t field_id, uint32_t value);
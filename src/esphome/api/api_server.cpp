@@ -7,10 +7,13 @@
 #include "esphome/log.h"
 #include "esphome/application.h"
 #include "esphome/util.h"
+#include "esphome/helpers.h"
 #include "esphome/deep_sleep_component.h"
 #include "esphome/time/homeassistant_time.h"
 
 #include <algorithm>
+#include <cstring>
+#include <lwip/pbuf.h>
 
 ESPHOME_NAMESPACE_BEGIN
 
@@ -18,12 +21,59 @@ namespace api {
 
 static const char *TAG = "api";
 
+#ifdef ARDUINO_ARCH_ESP32
+#define API_RX_LOCK() portENTER_CRITICAL(&this->rx_lock_)
+#define API_RX_UNLOCK() portEXIT_CRITICAL(&this->rx_lock_)
+#else
+// the TCP callbacks run between loop iterations
+#define API_RX_LOCK()
+#define API_RX_UNLOCK()
+#endif
+
+/// Bytes reserved at the start of the send buffer for the message header (preamble + two varints) and the header of
+/// an encrypted frame.
+static const size_t API_HEADER_GAP = 11 + API_CRYPTO_HEADER_SIZE;
+/// The info of the HKDF for the keys of the encrypted transport.
+static const char *const API_CRYPTO_INFO = "esphome api";
+/// Initial capacity of the send buffer, large enough for all common state messages.
+static const size_t API_SEND_BUFFER_RESERVE = 128;
+/// Size of the per-connection queue for messages that didn't fit into the TCP buffer.
+static const size_t API_TX_QUEUE_SIZE = 1024;
+/// Time the entity iterators may spend per loop iteration.
+static const uint32_t API_ITERATOR_BUDGET_US = 4000;
+/// TCP buffer space below which the entity iterators wait for the client to catch up.
+static const size_t API_ITERATOR_MIN_SPACE = 128;
+/// Time without traffic after which a ping request is sent, the client is disconnected after 1.5 times that.
+static const uint32_t API_KEEPALIVE_TIME = 60000;
+/// The profile of clients without a matching one, and of all clients before their hello request.
+static const APIClientProfile API_DEFAULT_CLIENT_PROFILE{};
+
 // APIServer
 void APIServer::setup() {
   ESP_LOGCONFIG(TAG, "Setting up Home Assistant API server...");
+#ifdef USE_METRICS
+  global_metrics.register_gauge("api_connections", "Connected native API clients.",
+                                [this]() { return this->clients_.size(); });
+  global_metrics.register_gauge("api_tx_queue_bytes", "Bytes waiting in the send queues of all clients.", [this]() {
+    size_t depth = 0;
+    for (auto *client : this->clients_)
+      depth += client->get_tx_queue_depth();
+    return depth;
+  });
+  // per connection, so this resets when a client disconnects
+  global_metrics.register_counter("api_tx_dropped_total", "Messages dropped because a send queue was full.",
+                                  [this]() {
+                                    uint32_t dropped = 0;
+                                    for (auto *client : this->clients_)
+                                      dropped += client->get_tx_dropped();
+                                    return dropped;
+                                  });
+#endif
   this->server_ = AsyncServer(this->port_);
   this->server_.setNoDelay(false);
   this->server_.begin();
+  // the loop runs anyway, state changes are sent from there
+  this->subscribe_states_(nullptr);
   this->server_.onClient(
       [](void *s, AsyncClient *client) {
         if (client == nullptr)
@@ -33,15 +83,20 @@ void APIServer::setup() {
         // ESP_LOGD(TAG, "New client connected from %s", client->remoteIP().toString().c_str());
         auto *a_this = (APIServer *) s;
         a_this->clients_.push_back(new APIConnection(client, a_this));
+        // accepted in loop()
+        wake_loop();
       },
       this);
   if (global_log_component != nullptr) {
-    global_log_component->add_on_log_callback([this](int level, const char *tag, const char *message) {
-      for (auto *c : this->clients_) {
-        if (!c->remove_)
-          c->send_log_message(level, tag, message);
-      }
-    });
+    // only called once a client subscribed to the logs, see update_log_level()
+    this->log_callback_id_ = global_log_component->add_on_log_callback(
+        [this](int level, const char *tag, const char *message) {
+          for (auto *c : this->clients_) {
+            if (!c->remove_)
+              c->send_log_message(level, tag, message);
+          }
+        },
+        ESPHOME_LOG_LEVEL_NONE);
   }
 
   add_shutdown_hook([this](const char *reason) {
@@ -65,9 +120,9 @@ void APIServer::setup() {
 #endif
 }
 void APIServer::loop() {
-  // Partition clients into remove and active
+  // Partition clients into remove and active, keeping the active ones in the order of their priority
   auto new_end =
-      std::partition(this->clients_.begin(), this->clients_.end(), [](APIConnection *conn) { return !conn->remove_; });
+      std::stable_partition(this->clients_.begin(), this->clients_.end(), [](APIConnection *conn) { return !conn->remove_; });
   // print disconnection messages
   for (auto it = new_end; it != this->clients_.end(); ++it) {
     ESP_LOGD(TAG, "Disconnecting %s", (*it)->client_info_.c_str());
@@ -77,11 +132,30 @@ void APIServer::loop() {
   for (auto it = new_end; it != this->clients_.end(); ++it)
     delete *it;
   // resize vector
-  this->clients_.erase(new_end, this->clients_.end());
+  if (new_end != this->clients_.end()) {
+    this->clients_.erase(new_end, this->clients_.end());
+    this->update_log_level();
+  }
+
+  this->accept_clients_();
+  if (this->sort_clients_) {
+    this->sort_clients_ = false;
+    std::stable_sort(this->clients_.begin(), this->clients_.end(), [](APIConnection *a, APIConnection *b) {
+      return a->get_priority() > b->get_priority();
+    });
+  }
 
   for (auto *client : this->clients_) {
     client->loop();
   }
+  this->update_deferred_clients_();
+
+  // clients get all states when they subscribe, so changes don't have to be kept without clients
+  if (this->clients_.empty()) {
+    this->discard_states_();
+  } else {
+    this->process_states_();
+  }
 
   if (this->reboot_timeout_ != 0) {
     const uint32_t now = millis();
@@ -100,8 +174,69 @@ void APIServer::loop() {
 void APIServer::dump_config() {
   ESP_LOGCONFIG(TAG, "API Server:");
   ESP_LOGCONFIG(TAG, "  Address: %s:%u", network_get_address().c_str(), this->port_);
+  if (this->batch_states_) {
+    ESP_LOGCONFIG(TAG, "  State Batch Delay: %u ms", this->batch_delay_);
+  }
+  ESP_LOGCONFIG(TAG, "  Encryption: %s", YESNO(this->encryption_));
+  if (this->max_clients_ != 0) {
+    ESP_LOGCONFIG(TAG, "  Max Clients: %u", this->max_clients_);
+  }
+  for (auto &profile : this->client_profiles_) {
+    ESP_LOGCONFIG(TAG, "  Client Profile '%s':", profile.client_info.c_str());
+    ESP_LOGCONFIG(TAG, "    Priority: %u", profile.priority);
+    ESP_LOGCONFIG(TAG, "    Domains: 0x%04X", profile.domains);
+    ESP_LOGCONFIG(TAG, "    Max Log Level: %d", profile.max_log_level);
+    ESP_LOGCONFIG(TAG, "    Camera: %s", YESNO(profile.camera));
+  }
+}
+void APIServer::accept_clients_() {
+  uint8_t accepted = 0;
+  for (auto *c : this->clients_) {
+    if (c->accepted_)
+      accepted++;
+  }
+  for (auto *c : this->clients_) {
+    if (c->accepted_ || c->remove_)
+      continue;
+    if (this->max_clients_ != 0 && accepted >= this->max_clients_) {
+      ESP_LOGW(TAG, "Too many clients, closing connection from %s", c->client_info_.c_str());
+      c->disconnect_client();
+      continue;
+    }
+    c->accepted_ = true;
+    accepted++;
+  }
 }
+void APIServer::update_deferred_clients_() {
+  // the clients are sorted by priority, once one has messages waiting for TCP buffer space the clients
+  // with a lower priority queue their state updates, so the freed up space goes to it first
+  bool congested = false;
+  uint8_t congested_priority = 0;
+  for (auto *c : this->clients_) {
+    c->defer_states_ = congested && c->get_priority() < congested_priority;
+    if (!congested && c->tx_queue_size_ != 0 && c->state_subscription_) {
+      congested = true;
+      congested_priority = c->get_priority();
+    }
+  }
+}
+void APIServer::set_max_clients(uint8_t max_clients) { this->max_clients_ = max_clients; }
+void APIServer::add_client_profile(const APIClientProfile &profile) { this->client_profiles_.push_back(profile); }
+const APIClientProfile *APIServer::get_client_profile(const std::string &client_info) const {
+  for (auto &profile : this->client_profiles_) {
+    if (client_info.compare(0, profile.client_info.size(), profile.client_info) == 0)
+      return &profile;
+  }
+  return &API_DEFAULT_CLIENT_PROFILE;
+}
+void APIServer::sort_clients() { this->sort_clients_ = true; }
 bool APIServer::uses_password() const { return !this->password_.empty(); }
+bool APIServer::uses_encryption() const { return this->encryption_; }
+const std::array<uint8_t, 32> &APIServer::get_encryption_key() const { return this->encryption_key_; }
+void APIServer::set_encryption_key(const std::array<uint8_t, 32> &key) {
+  this->encryption_key_ = key;
+  this->encryption_ = true;
+}
 bool APIServer::check_password(const std::string &password) const {
   // depend only on input password length
   const char *a = this->password_.c_str();
@@ -131,6 +266,16 @@ bool APIServer::check_password(const std::string &password) const {
   return result == 0;
 }
 void APIServer::handle_disconnect(APIConnection *conn) {}
+void APIServer::update_log_level() {
+  if (global_log_component == nullptr)
+    return;
+  int level = ESPHOME_LOG_LEVEL_NONE;
+  for (auto *c : this->clients_) {
+    if (!c->remove_)
+      level = std::max(level, c->log_subscription_);
+  }
+  global_log_component->set_log_callback_level(this->log_callback_id_, level);
+}
 #ifdef USE_BINARY_SENSOR
 void APIServer::on_binary_sensor_update(binary_sensor::BinarySensor *obj, bool state) {
   if (obj->is_internal())
@@ -186,7 +331,7 @@ void APIServer::on_switch_update(switch_::Switch *obj, bool state) {
 #endif
 
 #ifdef USE_TEXT_SENSOR
-void APIServer::on_text_sensor_update(text_sensor::TextSensor *obj, std::string state) {
+void APIServer::on_text_sensor_update(text_sensor::TextSensor *obj, const std::string &state) {
   if (obj->is_internal())
     return;
   for (auto *c : this->clients_)
@@ -204,6 +349,24 @@ void APIServer::on_climate_update(climate::ClimateDevice *obj) {
 #endif
 
 float APIServer::get_setup_priority() const { return setup_priority::WIFI - 1.0f; }
+float APIServer::get_loop_priority() const {
+  return 5.0f;  // serve clients before other loop components, also when the loop budget is used up
+}
+uint32_t APIServer::get_loop_idle_time() {
+  if (this->sort_clients_)
+    return 0;
+  uint32_t idle_time = this->get_states_idle_time_();
+  for (auto *client : this->clients_) {
+    if (!client->accepted_ || client->remove_)
+      return 0;
+    idle_time = std::min(idle_time, client->get_loop_idle_time());
+  }
+  if (this->reboot_timeout_ != 0 && this->clients_.empty()) {
+    const uint32_t since = millis() - this->last_connected_;
+    idle_time = std::min(idle_time, since < this->reboot_timeout_ ? this->reboot_timeout_ - since : 0);
+  }
+  return idle_time;
+}
 void APIServer::set_port(uint16_t port) { this->port_ = port; }
 APIServer *global_api_server = nullptr;
 
@@ -225,6 +388,12 @@ const std::vector<APIServer::HomeAssistantStateSubscription> &APIServer::get_sta
 }
 uint16_t APIServer::get_port() const { return this->port_; }
 void APIServer::set_reboot_timeout(uint32_t reboot_timeout) { this->reboot_timeout_ = reboot_timeout; }
+void APIServer::set_batch_delay(uint32_t batch_delay) {
+  this->batch_states_ = true;
+  this->batch_delay_ = batch_delay;
+}
+bool APIServer::is_batching_states() const { return this->batch_states_; }
+uint32_t APIServer::get_batch_delay() const { return this->batch_delay_; }
 #ifdef USE_HOMEASSISTANT_TIME
 void APIServer::request_time() {
   for (auto *client : this->clients_) {
@@ -234,24 +403,55 @@ void APIServer::request_time() {
 }
 #endif
 bool APIServer::is_connected() const { return !this->clients_.empty(); }
+std::shared_ptr<const std::vector<uint8_t>> APIServer::get_list_entities() {
+  if (this->list_entities_ == nullptr) {
+    auto cache = std::make_shared<std::vector<uint8_t>>();
+    ListEntitiesIterator iterator(this, cache.get());
+    iterator.begin();
+    while (iterator.advance()) {
+    }
+    cache->shrink_to_fit();
+    ESP_LOGD(TAG, "Encoded the list of entities (%u bytes).", cache->size());
+    this->list_entities_ = cache;
+  }
+  return this->list_entities_;
+}
 
 // APIConnection
 APIConnection::APIConnection(AsyncClient *client, APIServer *parent)
-    : client_(client), parent_(parent), initial_state_iterator_(parent, this), list_entities_iterator_(parent, this) {
+    : client_(client),
+      parent_(parent),
+      profile_(&API_DEFAULT_CLIENT_PROFILE),
+      initial_state_iterator_(parent, this) {
   this->client_->onError([](void *s, AsyncClient *c, int8_t error) { ((APIConnection *) s)->on_error_(error); }, this);
   this->client_->onDisconnect([](void *s, AsyncClient *c) { ((APIConnection *) s)->on_disconnect_(); }, this);
   this->client_->onTimeout([](void *s, AsyncClient *c, uint32_t time) { ((APIConnection *) s)->on_timeout_(time); },
                            this);
-  this->client_->onData([](void *s, AsyncClient *c, void *buf,
-                           size_t len) { ((APIConnection *) s)->on_data_(reinterpret_cast<uint8_t *>(buf), len); },
-                        this);
+  this->client_->onPacket([](void *s, AsyncClient *c, struct pbuf *pb) { ((APIConnection *) s)->on_packet_(pb); },
+                          this);
+  // the send queue is drained from the main loop, wake it up when TCP buffer space frees up
+  this->client_->onAck(
+      [](void *s, AsyncClient *c, size_t len, uint32_t time) {
+        ((APIConnection *) s)->tx_acked_ += len;
+        wake_loop();
+      },
+      this);
 
-  this->send_buffer_.reserve(64);
+  this->send_buffer_.reserve(API_SEND_BUFFER_RESERVE);
   this->recv_buffer_.reserve(32);
   this->client_info_ = this->client_->remoteIP().toString().c_str();
   this->last_traffic_ = millis();
 }
-APIConnection::~APIConnection() { delete this->client_; }
+APIConnection::~APIConnection() {
+  delete this->client_;
+  // no more callbacks, the connection is gone so the packets are only freed
+  if (this->rx_packets_ != nullptr)
+    pbuf_free(this->rx_packets_);
+  if (this->rx_held_ != nullptr)
+    pbuf_free(this->rx_held_);
+  delete this->rx_cipher_;
+  delete this->tx_cipher_;
+}
 void APIConnection::on_error_(int8_t error) {
   ESP_LOGD(TAG, "Error from client '%s': %d", this->client_info_.c_str(), error);
   // disconnect will also be called, nothing to do here
@@ -262,87 +462,262 @@ void APIConnection::on_disconnect_() {
   this->remove_ = true;
 }
 void APIConnection::on_timeout_(uint32_t time) { this->disconnect_client(); }
-void APIConnection::on_data_(uint8_t *buf, size_t len) {
-  if (len == 0 || buf == nullptr)
-    return;
-
-  this->recv_buffer_.insert(this->recv_buffer_.end(), buf, buf + len);
-  // TODO: On ESP32, use queue to notify main thread of new data
+void APIConnection::on_packet_(struct pbuf *pb) {
+  API_RX_LOCK();
+  if (this->rx_packets_ == nullptr)
+    this->rx_packets_ = pb;
+  else
+    pbuf_cat(this->rx_packets_, pb);
+  API_RX_UNLOCK();
+  wake_loop();
+}
+
+/// Decode the header of the frame at the start of data, returns its length or 0 if it isn't complete yet.
+static size_t api_decode_header(const uint8_t *data, size_t len, uint32_t *msg_size, uint32_t *msg_type) {
+  uint32_t consumed;
+  auto size = proto_decode_varuint32(data + 1, len - 1, &consumed);
+  if (!size.has_value())
+    return 0;
+  size_t header = 1 + consumed;
+  auto type = proto_decode_varuint32(data + header, len - header, &consumed);
+  if (!type.has_value())
+    return 0;
+  *msg_size = *size;
+  *msg_type = *type;
+  return header + consumed;
+}
+/// Get the size of the frame (header and message) at the start of data, 0 if the header isn't complete yet.
+static size_t api_frame_size(const uint8_t *data, size_t len) {
+  uint32_t msg_size, msg_type;
+  const size_t header = api_decode_header(data, len, &msg_size, &msg_type);
+  return header == 0 ? 0 : header + msg_size;
 }
+
 void APIConnection::parse_recv_buffer_() {
-  if (this->recv_buffer_.empty() || this->remove_)
+  API_RX_LOCK();
+  struct pbuf *packets = this->rx_packets_;
+  this->rx_packets_ = nullptr;
+  API_RX_UNLOCK();
+
+  while (packets != nullptr) {
+    // take the first packet off the chain, each packet is acked on its own
+    struct pbuf *pb = packets;
+    packets = pb->next;
+    pb->next = nullptr;
+    pb->tot_len = pb->len;
+    this->parse_packet_(pb);
+  }
+}
+void APIConnection::parse_packet_(struct pbuf *pb) {
+  auto *data = reinterpret_cast<uint8_t *>(pb->payload);
+  const size_t len = pb->len;
+  if (this->parent_->uses_encryption()) {
+    if (!this->remove_)
+      this->parse_encrypted_packet_(data, len);
+    this->client_->ackPacket(pb);
     return;
+  }
+  size_t offset = 0;
+  if (this->rx_held_ != nullptr) {
+    if (!this->remove_)
+      offset = this->complete_held_frame_(data, len);
+    this->client_->ackPacket(this->rx_held_);
+    this->rx_held_ = nullptr;
+  }
+  // complete a message that spans more than two packets, only its bytes are copied
+  while (!this->remove_ && !this->recv_buffer_.empty() && offset < len) {
+    size_t frame = api_frame_size(this->recv_buffer_.data(), this->recv_buffer_.size());
+    const size_t take = frame == 0 ? 1 : std::min(frame - this->recv_buffer_.size(), len - offset);
+    this->recv_buffer_.insert(this->recv_buffer_.end(), data + offset, data + offset + take);
+    offset += take;
+    if (frame == 0)
+      frame = api_frame_size(this->recv_buffer_.data(), this->recv_buffer_.size());
+    if (frame != 0 && this->recv_buffer_.size() == frame) {
+      this->parse_frames_(this->recv_buffer_.data(), frame);
+      this->recv_buffer_.clear();
+    }
+  }
+  if (!this->remove_ && offset < len) {
+    offset += this->parse_frames_(data + offset, len - offset);
+    if (!this->remove_ && offset < len) {
+      // the last message continues in the next packet, keep this one until then
+      this->rx_held_ = pb;
+      this->rx_held_offset_ = offset;
+      return;
+    }
+  }
+  // frees the packet and opens the TCP window again
+  this->client_->ackPacket(pb);
+}
+size_t APIConnection::complete_held_frame_(uint8_t *data, size_t len) {
+  const uint8_t *tail = reinterpret_cast<uint8_t *>(this->rx_held_->payload) + this->rx_held_offset_;
+  const size_t tail_len = this->rx_held_->len - this->rx_held_offset_;
+
+  // the header can be split too, it's at most 11 bytes
+  uint8_t header_buf[11];
+  const size_t header_len = std::min(sizeof(header_buf), tail_len + len);
+  for (size_t i = 0; i < header_len; i++)
+    header_buf[i] = i < tail_len ? tail[i] : data[i - tail_len];
+  uint32_t msg_size, msg_type;
+  const size_t header = api_decode_header(header_buf, header_len, &msg_size, &msg_type);
+  if (header == 0 || tail_len + len < header + msg_size) {
+    // continues in further packets, put it back together in recv_buffer_
+    this->recv_buffer_.insert(this->recv_buffer_.end(), tail, tail + tail_len);
+    return 0;
+  }
 
-  while (!this->recv_buffer_.empty()) {
-    if (this->recv_buffer_[0] != 0x00) {
-      ESP_LOGW(TAG, "Invalid preamble from %s", this->client_info_.c_str());
+  if (!this->valid_rx_message_type_(msg_type)) {
+    ESP_LOGE(TAG, "Not a valid message type: %u", msg_type);
+    this->fatal_error_();
+    return len;
+  }
+  APIMessageView msg{};
+  if (header < tail_len) {
+    msg.data = tail + header;
+    msg.len = tail_len - header;
+    msg.rest = data;
+    msg.rest_len = msg_size - msg.len;
+  } else {
+    msg.data = data + (header - tail_len);
+    msg.len = msg_size;
+  }
+  this->read_message_(msg_type, msg);
+  return header + msg_size - tail_len;
+}
+void APIConnection::parse_encrypted_packet_(uint8_t *data, size_t len) {
+  size_t offset = 0;
+  // complete a frame started in an earlier packet
+  while (!this->remove_ && !this->recv_buffer_.empty() && offset < len) {
+    size_t needed = API_CRYPTO_HEADER_SIZE;
+    if (this->recv_buffer_.size() >= API_CRYPTO_HEADER_SIZE)
+      needed += (size_t(this->recv_buffer_[1]) << 8) | this->recv_buffer_[2];
+    const size_t take = std::min(needed - this->recv_buffer_.size(), len - offset);
+    this->recv_buffer_.insert(this->recv_buffer_.end(), data + offset, data + offset + take);
+    offset += take;
+    if (this->recv_buffer_.size() < API_CRYPTO_HEADER_SIZE)
+      continue;
+    const size_t payload_len = (size_t(this->recv_buffer_[1]) << 8) | this->recv_buffer_[2];
+    if (this->recv_buffer_.size() == API_CRYPTO_HEADER_SIZE + payload_len) {
+      this->read_encrypted_frame_(this->recv_buffer_.data(), payload_len);
+      this->recv_buffer_.clear();
+    }
+  }
+  while (!this->remove_ && offset < len) {
+    uint8_t *frame = data + offset;
+    const size_t remaining = len - offset;
+    if (frame[0] != API_CRYPTO_PREAMBLE) {
+      ESP_LOGW(TAG, "Client %s doesn't use encryption", this->client_info_.c_str());
       this->fatal_error_();
       return;
     }
-    uint32_t i = 1;
-    const uint32_t size = this->recv_buffer_.size();
-    uint32_t msg_size = 0;
-    while (i < size) {
-      const uint8_t dat = this->recv_buffer_[i];
-      msg_size |= (dat & 0x7F);
-      // consume
-      i += 1;
-      if ((dat & 0x80) == 0x00) {
-        break;
-      } else {
-        msg_size <<= 7;
-      }
-    }
-    if (i == size)
-      // not enough data there yet
+    if (remaining < API_CRYPTO_HEADER_SIZE)
+      break;
+    const size_t payload_len = (size_t(frame[1]) << 8) | frame[2];
+    if (remaining - API_CRYPTO_HEADER_SIZE < payload_len)
+      break;
+    this->read_encrypted_frame_(frame, payload_len);
+    offset += API_CRYPTO_HEADER_SIZE + payload_len;
+  }
+  if (!this->remove_ && offset < len)
+    this->recv_buffer_.insert(this->recv_buffer_.end(), data + offset, data + len);
+}
+void APIConnection::read_encrypted_frame_(uint8_t *frame, size_t payload_len) {
+  uint8_t *payload = frame + API_CRYPTO_HEADER_SIZE;
+  if (this->rx_cipher_ == nullptr) {
+    // handshake: the nonce of the client
+    if (payload_len < API_CRYPTO_NONCE_SIZE) {
+      ESP_LOGW(TAG, "Invalid handshake from %s", this->client_info_.c_str());
+      this->fatal_error_();
       return;
+    }
+    uint8_t response[API_CRYPTO_HEADER_SIZE + API_CRYPTO_NONCE_SIZE + 1];
+    response[0] = API_CRYPTO_PREAMBLE;
+    response[1] = 0;
+    response[2] = API_CRYPTO_NONCE_SIZE + 1;
+    uint8_t *server_nonce = response + API_CRYPTO_HEADER_SIZE;
+    for (size_t i = 0; i < API_CRYPTO_NONCE_SIZE; i += 4) {
+      const uint32_t rand = random_uint32();
+      memcpy(server_nonce + i, &rand, 4);
+    }
+    response[API_CRYPTO_HEADER_SIZE + API_CRYPTO_NONCE_SIZE] = static_cast<uint8_t>(api_crypto_suite());
+
+    // keys and nonce prefixes for client to server and server to client
+    uint8_t salt[API_CRYPTO_NONCE_SIZE * 2];
+    memcpy(salt, payload, API_CRYPTO_NONCE_SIZE);
+    memcpy(salt + API_CRYPTO_NONCE_SIZE, server_nonce, API_CRYPTO_NONCE_SIZE);
+    uint8_t keys[32 + 32 + 4 + 4];
+    const auto &psk = this->parent_->get_encryption_key();
+    api_hkdf_sha256(salt, sizeof(salt), psk.data(), psk.size(), API_CRYPTO_INFO, keys, sizeof(keys));
+    this->rx_cipher_ = new APIFrameCipher(keys, keys + 64);
+    this->tx_cipher_ = new APIFrameCipher(keys + 32, keys + 68);
+    memset(keys, 0, sizeof(keys));
+
+    this->client_->add(reinterpret_cast<char *>(response), sizeof(response));
+    this->client_->send();
+    this->tx_sent_ += sizeof(response);
+    return;
+  }
 
-    uint32_t msg_type = 0;
-    bool msg_type_done = false;
-    while (i < size) {
-      const uint8_t dat = this->recv_buffer_[i];
-      msg_type |= (dat & 0x7F);
-      // consume
-      i += 1;
-      if ((dat & 0x80) == 0x00) {
-        msg_type_done = true;
-        break;
-      } else {
-        msg_type <<= 7;
-      }
+  if (payload_len < API_CRYPTO_TAG_SIZE) {
+    ESP_LOGW(TAG, "Invalid encrypted frame from %s", this->client_info_.c_str());
+    this->fatal_error_();
+    return;
+  }
+  const size_t len = payload_len - API_CRYPTO_TAG_SIZE;
+  if (!this->rx_cipher_->decrypt(frame, payload, len, payload + len)) {
+    ESP_LOGW(TAG, "Decrypting frame from %s failed, wrong encryption key?", this->client_info_.c_str());
+    this->fatal_error_();
+    return;
+  }
+  // the payload has to consist of complete frames
+  if (this->parse_frames_(payload, len) != len && !this->remove_) {
+    ESP_LOGW(TAG, "Incomplete message in encrypted frame from %s", this->client_info_.c_str());
+    this->fatal_error_();
+  }
+}
+bool APIConnection::is_handshake_pending_() const {
+  return this->parent_->uses_encryption() && this->tx_cipher_ == nullptr;
+}
+size_t APIConnection::parse_frames_(uint8_t *data, size_t len) {
+  size_t offset = 0;
+  while (offset < len) {
+    if (data[offset] != 0x00) {
+      ESP_LOGW(TAG, "Invalid preamble from %s", this->client_info_.c_str());
+      this->fatal_error_();
+      return offset;
     }
-    if (!msg_type_done)
+    uint32_t msg_size, msg_type;
+    const size_t header = api_decode_header(data + offset, len - offset, &msg_size, &msg_type);
+    if (header == 0 || len - offset - header < msg_size)
       // not enough data there yet
-      return;
-
-    if (size - i < msg_size)
-      // message body not fully received
-      return;
+      return offset;
 
     // ESP_LOGVV(TAG, "RECV Message: Size=%u Type=%u", msg_size, msg_type);
 
     if (!this->valid_rx_message_type_(msg_type)) {
       ESP_LOGE(TAG, "Not a valid message type: %u", msg_type);
       this->fatal_error_();
-      return;
+      return offset;
     }
 
-    uint8_t *msg = &this->recv_buffer_[i];
-    this->read_message_(msg_size, msg_type, msg);
+    this->read_message_(msg_type, APIMessageView{data + offset + header, msg_size});
+    offset += header + msg_size;
     if (this->remove_)
-      return;
-    // pop front
-    uint32_t total = i + msg_size;
-    this->recv_buffer_.erase(this->recv_buffer_.begin(), this->recv_buffer_.begin() + total);
+      return offset;
   }
+  return offset;
 }
-void APIConnection::read_message_(uint32_t size, uint32_t type, uint8_t *msg) {
+void APIConnection::read_message_(uint32_t type, const APIMessageView &msg) {
   this->last_traffic_ = millis();
+  // keepalive pings can wait for the next beacon, commands and requests keep the WiFi out of power save
+  if (type != static_cast<uint32_t>(APIMessageType::PING_REQUEST) &&
+      type != static_cast<uint32_t>(APIMessageType::PING_RESPONSE))
+    network_notify_activity();
 
   switch (static_cast<APIMessageType>(type)) {
     case APIMessageType::HELLO_REQUEST: {
       HelloRequest req;
-      req.decode(msg, size);
+      req.decode(msg);
       this->on_hello_request_(req);
       break;
     }
@@ -352,7 +727,7 @@ void APIConnection::read_message_(uint32_t size, uint32_t type, uint8_t *msg) {
     }
     case APIMessageType::CONNECT_REQUEST: {
       ConnectRequest req;
-      req.decode(msg, size);
+      req.decode(msg);
       this->on_connect_request_(req);
       break;
     }
@@ -361,31 +736,31 @@ void APIConnection::read_message_(uint32_t size, uint32_t type, uint8_t *msg) {
       break;
     case APIMessageType::DISCONNECT_REQUEST: {
       DisconnectRequest req;
-      req.decode(msg, size);
+      req.decode(msg);
       this->on_disconnect_request_(req);
       break;
     }
     case APIMessageType::DISCONNECT_RESPONSE: {
       DisconnectResponse req;
-      req.decode(msg, size);
+      req.decode(msg);
       this->on_disconnect_response_(req);
       break;
     }
     case APIMessageType::PING_REQUEST: {
       PingRequest req;
-      req.decode(msg, size);
+      req.decode(msg);
       this->on_ping_request_(req);
       break;
     }
     case APIMessageType::PING_RESPONSE: {
       PingResponse req;
-      req.decode(msg, size);
+      req.decode(msg);
       this->on_ping_response_(req);
       break;
     }
     case APIMessageType::DEVICE_INFO_REQUEST: {
       DeviceInfoRequest req;
-      req.decode(msg, size);
+      req.decode(msg);
       this->on_device_info_request_(req);
       break;
     }
@@ -395,7 +770,7 @@ void APIConnection::read_message_(uint32_t size, uint32_t type, uint8_t *msg) {
     }
     case APIMessageType::LIST_ENTITIES_REQUEST: {
       ListEntitiesRequest req;
-      req.decode(msg, size);
+      req.decode(msg);
       this->on_list_entities_request_(req);
       break;
     }
@@ -414,7 +789,7 @@ void APIConnection::read_message_(uint32_t size, uint32_t type, uint8_t *msg) {
       break;
     case APIMessageType::SUBSCRIBE_STATES_REQUEST: {
       SubscribeStatesRequest req;
-      req.decode(msg, size);
+      req.decode(msg);
       this->on_subscribe_states_request_(req);
       break;
     }
@@ -431,7 +806,7 @@ void APIConnection::read_message_(uint32_t size, uint32_t type, uint8_t *msg) {
       break;
     case APIMessageType::SUBSCRIBE_LOGS_REQUEST: {
       SubscribeLogsRequest req;
-      req.decode(msg, size);
+      req.decode(msg);
       this->on_subscribe_logs_request_(req);
       break;
     }
@@ -441,7 +816,7 @@ void APIConnection::read_message_(uint32_t size, uint32_t type, uint8_t *msg) {
     case APIMessageType::COVER_COMMAND_REQUEST: {
 #ifdef USE_COVER
       CoverCommandRequest req;
-      req.decode(msg, size);
+      req.decode(msg);
       this->on_cover_command_request_(req);
 #endif
       break;
@@ -449,7 +824,7 @@ void APIConnection::read_message_(uint32_t size, uint32_t type, uint8_t *msg) {
     case APIMessageType::FAN_COMMAND_REQUEST: {
 #ifdef USE_FAN
       FanCommandRequest req;
-      req.decode(msg, size);
+      req.decode(msg);
       this->on_fan_command_request_(req);
 #endif
       break;
@@ -457,7 +832,7 @@ void APIConnection::read_message_(uint32_t size, uint32_t type, uint8_t *msg) {
     case APIMessageType::LIGHT_COMMAND_REQUEST: {
 #ifdef USE_LIGHT
       LightCommandRequest req;
-      req.decode(msg, size);
+      req.decode(msg);
       this->on_light_command_request_(req);
 #endif
       break;
@@ -465,7 +840,7 @@ void APIConnection::read_message_(uint32_t size, uint32_t type, uint8_t *msg) {
     case APIMessageType::SWITCH_COMMAND_REQUEST: {
 #ifdef USE_SWITCH
       SwitchCommandRequest req;
-      req.decode(msg, size);
+      req.decode(msg);
       this->on_switch_command_request_(req);
 #endif
       break;
@@ -473,14 +848,14 @@ void APIConnection::read_message_(uint32_t size, uint32_t type, uint8_t *msg) {
     case APIMessageType::CLIMATE_COMMAND_REQUEST: {
 #ifdef USE_CLIMATE
       ClimateCommandRequest req;
-      req.decode(msg, size);
+      req.decode(msg);
       this->on_climate_command_request_(req);
 #endif
       break;
     }
     case APIMessageType::SUBSCRIBE_SERVICE_CALLS_REQUEST: {
       SubscribeServiceCallsRequest req;
-      req.decode(msg, size);
+      req.decode(msg);
       this->on_subscribe_service_calls_request_(req);
       break;
     }
@@ -493,13 +868,13 @@ void APIConnection::read_message_(uint32_t size, uint32_t type, uint8_t *msg) {
     case APIMessageType::GET_TIME_RESPONSE: {
 #ifdef USE_HOMEASSISTANT_TIME
       time::GetTimeResponse req;
-      req.decode(msg, size);
+      req.decode(msg);
 #endif
       break;
     }
     case APIMessageType::SUBSCRIBE_HOME_ASSISTANT_STATES_REQUEST: {
       SubscribeHomeAssistantStatesRequest req;
-      req.decode(msg, size);
+      req.decode(msg);
       this->on_subscribe_home_assistant_states_request_(req);
       break;
     }
@@ -508,24 +883,60 @@ void APIConnection::read_message_(uint32_t size, uint32_t type, uint8_t *msg) {
       break;
     case APIMessageType::HOME_ASSISTANT_STATE_RESPONSE: {
       HomeAssistantStateResponse req;
-      req.decode(msg, size);
+      req.decode(msg);
       this->on_home_assistant_state_response_(req);
       break;
     }
     case APIMessageType::EXECUTE_SERVICE_REQUEST: {
       ExecuteServiceRequest req;
-      req.decode(msg, size);
+      req.decode(msg);
       this->on_execute_service_(req);
       break;
     }
     case APIMessageType::CAMERA_IMAGE_REQUEST: {
 #ifdef USE_ESP32_CAMERA
       CameraImageRequest req;
-      req.decode(msg, size);
+      req.decode(msg);
       this->on_camera_image_request_(req);
 #endif
       break;
     }
+    case APIMessageType::COMPONENT_STATS_REQUEST: {
+      ComponentStatsRequest req;
+      req.decode(msg);
+      this->on_component_stats_request_(req);
+      break;
+    }
+    case APIMessageType::COMPONENT_STATS_RESPONSE:
+      // Invalid
+      break;
+    case APIMessageType::TRACE_REQUEST: {
+      TraceRequest req;
+      req.decode(msg);
+      this->on_trace_request_(req);
+      break;
+    }
+    case APIMessageType::TRACE_RESPONSE:
+      // Invalid
+      break;
+    case APIMessageType::SENSOR_HISTORY_REQUEST: {
+      SensorHistoryRequest req;
+      req.decode(msg);
+      this->on_sensor_history_request_(req);
+      break;
+    }
+    case APIMessageType::SENSOR_HISTORY_RESPONSE:
+      // Invalid
+      break;
+    case APIMessageType::METRICS_REQUEST: {
+      MetricsRequest req;
+      req.decode(msg);
+      this->on_metrics_request_(req);
+      break;
+    }
+    case APIMessageType::METRICS_RESPONSE:
+      // Invalid
+      break;
   }
 }
 void APIConnection::on_hello_request_(const HelloRequest &req) {
@@ -533,6 +944,11 @@ void APIConnection::on_hello_request_(const HelloRequest &req) {
   this->client_info_ = req.get_client_info() + " (" + this->client_->remoteIP().toString().c_str();
   this->client_info_ += ")";
   ESP_LOGV(TAG, "Hello from client: '%s'", this->client_info_.c_str());
+  const APIClientProfile *profile = this->parent_->get_client_profile(req.get_client_info());
+  if (profile != this->profile_) {
+    this->profile_ = profile;
+    this->parent_->sort_clients();
+  }
 
   auto buffer = this->get_buffer();
   // uint32 api_version_major = 1; -> 1
@@ -622,7 +1038,8 @@ void APIConnection::on_device_info_request_(const DeviceInfoRequest &req) {
 }
 void APIConnection::on_list_entities_request_(const ListEntitiesRequest &req) {
   ESP_LOGVV(TAG, "on_list_entities_request_");
-  this->list_entities_iterator_.begin();
+  this->list_entities_ = this->parent_->get_list_entities();
+  this->list_entities_at_ = 0;
 }
 void APIConnection::on_subscribe_states_request_(const SubscribeStatesRequest &req) {
   ESP_LOGVV(TAG, "on_subscribe_states_request_");
@@ -631,11 +1048,228 @@ void APIConnection::on_subscribe_states_request_(const SubscribeStatesRequest &r
 }
 void APIConnection::on_subscribe_logs_request_(const SubscribeLogsRequest &req) {
   ESP_LOGVV(TAG, "on_subscribe_logs_request_");
-  this->log_subscription_ = req.get_level();
+  this->log_subscription_ = std::min(int(req.get_level()), this->profile_->max_log_level);
+  this->parent_->update_log_level();
   if (req.get_dump_config()) {
     App.schedule_dump_config();
   }
 }
+void APIConnection::on_component_stats_request_(const ComponentStatsRequest &req) {
+  ESP_LOGVV(TAG, "on_component_stats_request_");
+#ifdef USE_COMPONENT_PROFILER
+  this->component_stats_at_ = 0;
+  this->component_stats_reset_ = req.get_reset();
+#else
+  ESP_LOGW(TAG, "Component stats requested, but the profiler is not enabled.");
+#endif
+}
+#ifdef USE_COMPONENT_PROFILER
+static void encode_timing_stats(APIBuffer &buffer, uint32_t field, const ComponentTimingStats &stats) {
+  size_t begin = buffer.begin_nested(field);
+  // uint32 count = 1;
+  buffer.encode_uint32(1, stats.count);
+  // uint64 total_us = 2;
+  buffer.encode_uint64(2, stats.total_us);
+  // uint32 max_us = 3;
+  buffer.encode_uint32(3, stats.max_us);
+  // repeated uint32 histogram = 4;
+  for (uint16_t bucket : stats.histogram)
+    buffer.encode_uint32(4, bucket, true);
+  buffer.end_nested(begin);
+}
+bool APIConnection::send_component_stats_(uint32_t index) {
+  const auto &components = App.get_components();
+  Component *component = components[index];
+  auto buffer = this->get_buffer();
+  // uint32 index = 1;
+  buffer.encode_uint32(1, index);
+  // string source = 2;
+  const char *source = component->get_component_source();
+  buffer.encode_string(2, source, strlen(source));
+  // uint32 setup_us = 3;
+  buffer.encode_uint32(3, component->setup_time_us);
+  // ComponentStatsTiming loop = 4;
+  encode_timing_stats(buffer, 4, component->loop_stats);
+  // ComponentStatsTiming time_functions = 5;
+  encode_timing_stats(buffer, 5, component->scheduler_stats);
+  // bool done = 6;
+  buffer.encode_bool(6, index + 1 == components.size());
+#ifdef USE_I2C
+  for (I2CComponent *bus : i2c_buses) {
+    if (bus != component)
+      continue;
+    // repeated ComponentStatsI2CDevice i2c_devices = 7;
+    for (auto &stats : bus->get_device_stats()) {
+      size_t begin = buffer.begin_nested(7);
+      buffer.encode_uint32(1, stats.address);
+      buffer.encode_uint32(2, stats.transactions);
+      buffer.encode_uint32(3, stats.bytes_written);
+      buffer.encode_uint32(4, stats.bytes_read);
+      buffer.encode_uint32(5, stats.errors);
+      buffer.encode_uint64(6, stats.bus_us);
+      buffer.end_nested(begin);
+    }
+  }
+#endif
+#ifdef USE_HEAP_TRACER
+  // ComponentStatsHeap heap = 8;
+  size_t begin = buffer.begin_nested(8);
+  // uint32 allocated = 1;
+  buffer.encode_uint32(1, component->heap_stats.allocated);
+  // uint32 freed = 2;
+  buffer.encode_uint32(2, component->heap_stats.freed);
+  // uint32 max_allocation = 3;
+  buffer.encode_uint32(3, component->heap_stats.max_allocation);
+  buffer.end_nested(begin);
+#endif
+  return this->send_buffer(APIMessageType::COMPONENT_STATS_RESPONSE);
+}
+void APIConnection::advance_component_stats_() {
+  if (this->component_stats_at_ < 0)
+    return;
+
+  const uint32_t size = App.get_components().size();
+  // Send as many as fit in the TCP buffer, continue in the next loop
+  while (uint32_t(this->component_stats_at_) < size) {
+    if (!this->send_component_stats_(this->component_stats_at_))
+      return;
+    this->component_stats_at_++;
+  }
+
+  this->component_stats_at_ = -1;
+  if (this->component_stats_reset_)
+    App.reset_component_stats();
+}
+#endif
+
+void APIConnection::on_trace_request_(const TraceRequest &req) {
+  ESP_LOGVV(TAG, "on_trace_request_");
+#ifdef USE_TRACER
+  this->trace_writer_ = make_unique<TraceJsonWriter>(global_tracer.take_events());
+  this->trace_chunk_.clear();
+#else
+  ESP_LOGW(TAG, "Trace requested, but the tracer is not enabled.");
+#endif
+}
+#ifdef USE_TRACER
+void APIConnection::advance_trace_() {
+  // Send as many parts as fit in the TCP buffer, continue in the next loop
+  while (this->trace_writer_ != nullptr) {
+    if (this->trace_chunk_.empty()) {
+      char chunk[API_TRACE_CHUNK_SIZE];
+      const size_t len = this->trace_writer_->write(chunk, sizeof(chunk));
+      this->trace_chunk_.assign(chunk, len);
+    }
+    const bool done = this->trace_writer_->is_done();
+    auto buffer = this->get_buffer();
+    // string json = 1;
+    buffer.encode_string(1, this->trace_chunk_);
+    // bool done = 2;
+    buffer.encode_bool(2, done);
+    if (!this->send_buffer(APIMessageType::TRACE_RESPONSE))
+      return;
+    this->trace_chunk_.clear();
+    if (done)
+      this->trace_writer_ = nullptr;
+  }
+}
+#endif
+
+void APIConnection::on_metrics_request_(const MetricsRequest &req) {
+  ESP_LOGVV(TAG, "on_metrics_request_");
+#ifdef USE_METRICS
+  this->metrics_include_names_ = req.get_include_names();
+  this->metrics_pending_ = !this->send_metrics_();
+#else
+  ESP_LOGW(TAG, "Metrics requested, but metrics are not enabled.");
+#endif
+}
+#ifdef USE_METRICS
+bool APIConnection::send_metrics_() {
+  auto buffer = this->get_buffer();
+  const auto &metrics = global_metrics.get_metrics();
+  for (uint32_t i = 0; i < metrics.size(); i++) {
+    const Metric &metric = metrics[i];
+    const double value = metric.get_value();
+    // repeated MetricsEntry metrics = 1;
+    size_t begin = buffer.begin_nested(1);
+    // uint32 index = 1;
+    buffer.encode_uint32(1, i);
+    if (metric.type == METRIC_TYPE_COUNTER) {
+      // uint32 count = 2;
+      buffer.encode_uint32(2, uint32_t(value));
+    } else {
+      // float value = 3;
+      buffer.encode_float(3, value);
+    }
+    if (this->metrics_include_names_) {
+      // MetricType type = 4;
+      buffer.encode_uint32(4, metric.type);
+      // string name = 5;
+      buffer.encode_string(5, metric.name);
+      // string id = 6;
+      buffer.encode_string(6, metric.id);
+    }
+    buffer.end_nested(begin);
+  }
+  return this->send_buffer(APIMessageType::METRICS_RESPONSE);
+}
+#endif
+
+void APIConnection::on_sensor_history_request_(const SensorHistoryRequest &req) {
+  ESP_LOGVV(TAG, "on_sensor_history_request_(key=%u, tier=%u)", req.get_key(), req.get_tier());
+#ifdef USE_SENSOR_HISTORY
+  auto *obj = static_cast<sensor::Sensor *>(App.get_state_bus().find_entity(ENTITY_SENSOR, req.get_key()));
+  if (obj == nullptr || obj->get_history() == nullptr || req.get_tier() >= sensor::SENSOR_HISTORY_TIER_COUNT) {
+    auto buffer = this->get_buffer();
+    // fixed32 key = 1;
+    buffer.encode_fixed32(1, req.get_key());
+    // SensorHistoryTier tier = 2;
+    buffer.encode_uint32(2, req.get_tier());
+    // bool done = 4;
+    buffer.encode_bool(4, true);
+    this->send_buffer(APIMessageType::SENSOR_HISTORY_RESPONSE);
+    return;
+  }
+  this->history_ = obj->get_history();
+  this->history_tier_ = sensor::SensorHistoryTier(req.get_tier());
+  this->history_cursor_ = sensor::SensorHistoryCursor();
+#else
+  ESP_LOGW(TAG, "Sensor history requested, but no history is kept.");
+#endif
+}
+#ifdef USE_SENSOR_HISTORY
+void APIConnection::advance_sensor_history_() {
+  // Send as many parts as fit in the TCP buffer, continue in the next loop
+  while (this->history_ != nullptr) {
+    sensor::SensorHistoryPoint points[16];
+    sensor::SensorHistoryCursor cursor = this->history_cursor_;
+    const size_t count = this->history_->read(this->history_tier_, cursor, points, 16);
+    const bool done = count < 16;
+    auto buffer = this->get_buffer();
+    // fixed32 key = 1;
+    buffer.encode_fixed32(1, this->history_->get_sensor()->get_object_id_hash());
+    // SensorHistoryTier tier = 2;
+    buffer.encode_uint32(2, this->history_tier_);
+    for (size_t i = 0; i < count; i++) {
+      // repeated SensorHistoryPoint points = 3;
+      size_t begin = buffer.begin_nested(3);
+      buffer.encode_uint32(1, points[i].time);
+      buffer.encode_float(2, points[i].min);
+      buffer.encode_float(3, points[i].avg);
+      buffer.encode_float(4, points[i].max);
+      buffer.end_nested(begin);
+    }
+    // bool done = 4;
+    buffer.encode_bool(4, done);
+    if (!this->send_buffer(APIMessageType::SENSOR_HISTORY_RESPONSE))
+      return;
+    this->history_cursor_ = cursor;
+    if (done)
+      this->history_ = nullptr;
+  }
+}
+#endif
 
 void APIConnection::fatal_error_() {
   this->client_->close();
@@ -662,13 +1296,12 @@ bool APIConnection::valid_rx_message_type_(uint32_t type) {
   }
 }
 bool APIConnection::send_message(APIMessage &msg) {
-  this->send_buffer_.clear();
-  APIBuffer buf(&this->send_buffer_);
+  APIBuffer buf = this->get_buffer();
   msg.encode(buf);
   return this->send_buffer(msg.message_type());
 }
 bool APIConnection::send_empty_message(APIMessageType type) {
-  this->send_buffer_.clear();
+  this->get_buffer();
   return this->send_buffer(type);
 }
 
@@ -696,25 +1329,77 @@ void encode_varint(uint8_t *dat, uint8_t *len, uint32_t value) {
   }
 }
 
-bool APIConnection::send_buffer(APIMessageType type) {
-  uint8_t header[20];
+bool APIConnection::send_buffer(APIMessageType type) { return this->send_framed_buffer_(type, true); }
+uint8_t *APIConnection::frame_send_buffer_(APIMessageType type, uint32_t extra_len, size_t *len) {
+  // The message body was encoded after a gap of API_HEADER_GAP bytes, write the header right-aligned
+  // into that gap so that header and body end up contiguous in the send buffer.
+  const uint32_t encoded_len = this->send_buffer_.size() - API_HEADER_GAP;
+  uint8_t header[API_HEADER_GAP];
   header[0] = 0x00;
   uint8_t header_len = 1;
-  encode_varint(header + header_len, &header_len, this->send_buffer_.size());
+  encode_varint(header + header_len, &header_len, encoded_len + extra_len);
   encode_varint(header + header_len, &header_len, static_cast<uint32_t>(type));
+  uint8_t *data = this->send_buffer_.data() + API_HEADER_GAP - header_len;
+  memcpy(data, header, header_len);
+  *len = encoded_len + header_len;
+  return data;
+}
+size_t APIConnection::frame_overhead_() const {
+  return this->tx_cipher_ == nullptr ? 0 : API_CRYPTO_OVERHEAD;
+}
+uint8_t *APIConnection::encrypt_frame_(uint8_t *data, size_t *len) {
+  if (this->tx_cipher_ == nullptr)
+    return data;
+
+  // encrypt in place, the frame header goes in front and the tag is appended
+  const size_t offset = data - this->send_buffer_.data();
+  const size_t plain_len = *len;
+  this->send_buffer_.resize(this->send_buffer_.size() + API_CRYPTO_TAG_SIZE);
+  data = this->send_buffer_.data() + offset;
+  uint8_t *frame = data - API_CRYPTO_HEADER_SIZE;
+  const size_t payload_len = plain_len + API_CRYPTO_TAG_SIZE;
+  frame[0] = API_CRYPTO_PREAMBLE;
+  frame[1] = payload_len >> 8;
+  frame[2] = payload_len;
+  this->tx_cipher_->encrypt(frame, data, plain_len, data + plain_len);
+  *len = API_CRYPTO_HEADER_SIZE + payload_len;
+  return frame;
+}
+bool APIConnection::send_framed_buffer_(APIMessageType type, bool queue) {
+  if (this->is_handshake_pending_())
+    return false;
+  TRACE_SCOPE(API, "api_send");
+  size_t len;
+  uint8_t *data = this->frame_send_buffer_(type, 0, &len);
+  // Every encrypted frame uses up a nonce, so only encrypt once it's certain that the frame is sent or
+  // queued. A dropped encrypted frame would break the decryption of all following frames on the client.
+  const size_t needed_space = len + this->frame_overhead_();
+
+  if (this->flushing_states_) {
+    if (this->batch_buffer_.size() + needed_space > this->client_->space())
+      return false;
+    data = this->encrypt_frame_(data, &len);
+    this->batch_buffer_.insert(this->batch_buffer_.end(), data, data + needed_space);
+    return true;
+  }
 
-  size_t needed_space = this->send_buffer_.size() + header_len;
-
-  if (needed_space > this->client_->space()) {
-    delay(5);
-    if (needed_space > this->client_->space()) {
+  if (this->tx_queue_size_ != 0 || needed_space > this->client_->space()) {
+    // Don't block the loop waiting for the TCP buffer, queue the message and send it once the
+    // client has acked enough data. Queued messages go out first so that ordering is preserved.
+    if (!queue)
+      return false;
+    if (needed_space > API_TX_QUEUE_SIZE - this->tx_queue_size_) {
+      this->tx_dropped_++;
       if (type != APIMessageType::SUBSCRIBE_LOGS_RESPONSE) {
         ESP_LOGV(TAG, "Cannot send message because of TCP buffer space");
       }
-      delay(5);
       return false;
     }
+    data = this->encrypt_frame_(data, &len);
+    this->tx_queue_push_(data, needed_space);
+    return true;
   }
+  data = this->encrypt_frame_(data, &len);
 
   //  char buffer[512];
   //  uint32_t offset = 0;
@@ -722,18 +1407,92 @@ bool APIConnection::send_buffer(APIMessageType type) {
   //    offset += snprintf(buffer + offset, 512 - offset, "0x%02X ", header[j]);
   //  }
   //  offset += snprintf(buffer + offset, 512 - offset, "| ");
-  //  for (auto &it : this->send_buffer_) {
-  //    int i = snprintf(buffer + offset, 512 - offset, "0x%02X ", it);
+  //  for (auto it = this->send_buffer_.begin() + API_HEADER_GAP; it != this->send_buffer_.end(); it++) {
+  //    int i = snprintf(buffer + offset, 512 - offset, "0x%02X ", *it);
   //    if (i <= 0)
   //      break;
   //    offset += i;
   //  }
   //  ESP_LOGVV(TAG, "SEND %s", buffer);
 
-  this->client_->add(reinterpret_cast<char *>(header), header_len);
-  this->client_->add(reinterpret_cast<char *>(this->send_buffer_.data()), this->send_buffer_.size());
+  this->client_->add(reinterpret_cast<char *>(data), needed_space);
+  this->tx_sent_ += needed_space;
   return this->client_->send();
 }
+bool APIConnection::send_state_buffer_(APIMessageType type, Nameable *entity) {
+  if (this->send_framed_buffer_(type, false))
+    return true;
+  if (this->flushing_states_)
+    return false;
+  // No room right now, send the latest state of this entity once the connection has caught up.
+  this->states_coalesced_++;
+  return this->schedule_state_(type, entity);
+}
+void APIConnection::tx_queue_push_(const uint8_t *data, size_t len) {
+  if (this->tx_queue_.empty())
+    this->tx_queue_.resize(API_TX_QUEUE_SIZE);
+
+  const size_t tail = (this->tx_queue_head_ + this->tx_queue_size_) % API_TX_QUEUE_SIZE;
+  const size_t first = std::min(len, API_TX_QUEUE_SIZE - tail);
+  memcpy(this->tx_queue_.data() + tail, data, first);
+  memcpy(this->tx_queue_.data(), data + first, len - first);
+  this->tx_queue_size_ += len;
+  this->drain_tx_queue_();
+}
+void APIConnection::drain_tx_queue_() {
+  bool added = false;
+  while (this->tx_queue_size_ != 0) {
+    const size_t space = this->client_->space();
+    const size_t chunk = std::min(std::min(this->tx_queue_size_, API_TX_QUEUE_SIZE - this->tx_queue_head_), space);
+    if (chunk == 0)
+      break;
+    const size_t written =
+        this->client_->add(reinterpret_cast<char *>(this->tx_queue_.data() + this->tx_queue_head_), chunk);
+    if (written == 0)
+      break;
+    this->tx_sent_ += written;
+    this->tx_queue_head_ = (this->tx_queue_head_ + written) % API_TX_QUEUE_SIZE;
+    this->tx_queue_size_ -= written;
+    added = true;
+  }
+  if (this->tx_queue_size_ == 0)
+    this->tx_queue_head_ = 0;
+  if (added)
+    this->client_->send();
+}
+void APIConnection::advance_iterators_() {
+  const uint32_t start = micros();
+  do {
+    // Only advance while the messages go straight into the TCP buffer, so that a subscribing client
+    // doesn't fill up the send queue and stall everything else.
+    if (this->tx_queue_size_ != 0 || this->client_->space() < API_ITERATOR_MIN_SPACE)
+      return;
+    bool progress = this->advance_list_entities_();
+    progress |= this->initial_state_iterator_.advance();
+    if (!progress)
+      return;
+  } while (micros() - start < API_ITERATOR_BUDGET_US);
+}
+bool APIConnection::advance_list_entities_() {
+  if (this->list_entities_ == nullptr)
+    return false;
+  // the cached body goes where get_buffer() would have encoded it
+  const uint8_t *message = this->list_entities_->data() + this->list_entities_at_;
+  const size_t len = message[1] | (message[2] << 8);
+  const uint8_t *body = message + API_LIST_ENTITIES_HEADER_SIZE;
+  this->get_buffer();
+  this->send_buffer_.insert(this->send_buffer_.end(), body, body + len);
+  if (!this->send_buffer(static_cast<APIMessageType>(message[0])))
+    return false;
+  this->list_entities_at_ += API_LIST_ENTITIES_HEADER_SIZE + len;
+  if (this->list_entities_at_ >= this->list_entities_->size())
+    this->list_entities_ = nullptr;
+  return true;
+}
+size_t APIConnection::get_tx_queue_depth() const { return this->tx_queue_size_; }
+uint32_t APIConnection::get_tx_dropped() const { return this->tx_dropped_; }
+uint32_t APIConnection::get_states_coalesced() const { return this->states_coalesced_; }
+uint8_t APIConnection::get_priority() const { return this->profile_->priority; }
 
 void APIConnection::loop() {
   if (!network_is_connected()) {
@@ -749,57 +1508,94 @@ void APIConnection::loop() {
   }
   this->parse_recv_buffer_();
 
-  this->list_entities_iterator_.advance();
-  this->initial_state_iterator_.advance();
+  this->drain_tx_queue_();
+  this->advance_iterators_();
+  this->flush_pending_states_();
+#ifdef USE_COMPONENT_PROFILER
+  this->advance_component_stats_();
+#endif
+#ifdef USE_TRACER
+  this->advance_trace_();
+#endif
+#ifdef USE_SENSOR_HISTORY
+  this->advance_sensor_history_();
+#endif
+#ifdef USE_METRICS
+  if (this->metrics_pending_ && this->send_metrics_())
+    this->metrics_pending_ = false;
+#endif
 
-  const uint32_t keepalive = 60000;
   if (this->sent_ping_) {
-    if (millis() - this->last_traffic_ > (keepalive * 3) / 2) {
+    if (millis() - this->last_traffic_ > (API_KEEPALIVE_TIME * 3) / 2) {
       ESP_LOGW(TAG, "'%s' didn't respond to ping request in time. Disconnecting...", this->client_info_.c_str());
       this->disconnect_client();
     }
-  } else if (millis() - this->last_traffic_ > keepalive) {
+  } else if (millis() - this->last_traffic_ > API_KEEPALIVE_TIME) {
     this->sent_ping_ = true;
     this->send_ping_request();
   }
 
 #ifdef USE_ESP32_CAMERA
   if (this->image_reader_.available()) {
-    uint32_t space = this->client_->space();
-    // reserve 15 bytes for metadata, and at least 64 bytes of data
-    if (space >= 15 + 64) {
-      uint32_t to_send = std::min(space - 15, this->image_reader_.available());
-      auto buffer = this->get_buffer();
-      // fixed32 key = 1;
-      buffer.encode_fixed32(1, global_esp32_camera->get_object_id_hash());
-      // bytes data = 2;
-      buffer.encode_bytes(2, this->image_reader_.peek_data_buffer(), to_send);
-      // bool done = 3;
-      bool done = this->image_reader_.available() == to_send;
-      buffer.encode_bool(3, done);
-      bool success = this->send_buffer(APIMessageType::CAMERA_IMAGE_RESPONSE);
-      if (success) {
-        this->image_reader_.consume_data(to_send);
-      }
-      if (success && done) {
-        this->image_reader_.return_image();
-      }
-    }
+    this->send_camera_chunk_();
+  } else if (this->image_release_pending_ && int32_t(this->tx_acked_ - this->image_release_at_) >= 0) {
+    // all chunks have been acked, lwIP doesn't need the framebuffer anymore
+    this->image_release_pending_ = false;
+    this->image_reader_.return_image();
   }
 #endif
 }
+uint32_t APIConnection::get_loop_idle_time() {
+  // TCP callbacks (received packets, acks that free buffer space) wake the loop up, so a send queue or states
+  // deferred for a lack of buffer space don't keep the loop awake
+  if (this->rx_packets_ != nullptr || this->list_entities_ != nullptr || this->initial_state_iterator_.is_running())
+    return 0;
+#ifdef USE_COMPONENT_PROFILER
+  if (this->component_stats_at_ >= 0)
+    return 0;
+#endif
+#ifdef USE_TRACER
+  if (this->trace_writer_ != nullptr)
+    return 0;
+#endif
+#ifdef USE_SENSOR_HISTORY
+  if (this->history_ != nullptr)
+    return 0;
+#endif
+#ifdef USE_METRICS
+  if (this->metrics_pending_)
+    return 0;
+#endif
+#ifdef USE_ESP32_CAMERA
+  if (this->image_reader_.available())
+    return 0;
+#endif
+
+  const uint32_t now = millis();
+  uint32_t idle_time = SCHEDULER_DONT_RUN;
+  if (!this->pending_states_.empty() && this->tx_queue_size_ == 0 && !this->defer_states_) {
+    const uint32_t waited = now - this->pending_states_since_;
+    const uint32_t batch_delay = this->parent_->get_batch_delay();
+    idle_time = waited < batch_delay ? batch_delay - waited : 0;
+  }
+  const uint32_t ping_time = this->sent_ping_ ? (API_KEEPALIVE_TIME * 3) / 2 : API_KEEPALIVE_TIME;
+  const uint32_t since = now - this->last_traffic_;
+  return std::min(idle_time, since < ping_time ? ping_time - since : 0);
+}
 
 #ifdef USE_BINARY_SENSOR
 bool APIConnection::send_binary_sensor_state(binary_sensor::BinarySensor *binary_sensor, bool state) {
   if (!this->state_subscription_)
     return false;
+  if (!this->accepts_domain_(API_DOMAIN_BINARY_SENSOR))
+    // filtered by the client profile, done as far as the initial state iterator is concerned
+    return true;
+  if (this->should_batch_states_())
+    return this->schedule_state_(APIMessageType::BINARY_SENSOR_STATE_RESPONSE, binary_sensor);
 
   auto buffer = this->get_buffer();
-  // fixed32 key = 1;
-  buffer.encode_fixed32(1, binary_sensor->get_object_id_hash());
-  // bool state = 2;
-  buffer.encode_bool(2, state);
-  return this->send_buffer(APIMessageType::BINARY_SENSOR_STATE_RESPONSE);
+  encode_binary_sensor_state(buffer, binary_sensor, state);
+  return this->send_state_buffer_(APIMessageType::BINARY_SENSOR_STATE_RESPONSE, binary_sensor);
 }
 #endif
 
@@ -807,32 +1603,14 @@ bool APIConnection::send_binary_sensor_state(binary_sensor::BinarySensor *binary
 bool APIConnection::send_cover_state(cover::Cover *cover) {
   if (!this->state_subscription_)
     return false;
+  if (!this->accepts_domain_(API_DOMAIN_COVER))
+    return true;
+  if (this->should_batch_states_())
+    return this->schedule_state_(APIMessageType::COVER_STATE_RESPONSE, cover);
 
   auto buffer = this->get_buffer();
-  auto traits = cover->get_traits();
-  // fixed32 key = 1;
-  buffer.encode_fixed32(1, cover->get_object_id_hash());
-  // enum LegacyCoverState {
-  //   OPEN = 0;
-  //   CLOSED = 1;
-  // }
-  // LegacyCoverState legacy_state = 2;
-  uint32_t state = (cover->position == cover::COVER_OPEN) ? 0 : 1;
-  buffer.encode_uint32(2, state);
-  // float position = 3;
-  buffer.encode_float(3, cover->position);
-  if (traits.get_supports_tilt()) {
-    // float tilt = 4;
-    buffer.encode_float(4, cover->tilt);
-  }
-  // enum CoverCurrentOperation {
-  //   IDLE = 0;
-  //   IS_OPENING = 1;
-  //   IS_CLOSING = 2;
-  // }
-  // CoverCurrentOperation current_operation = 5;
-  buffer.encode_uint32(5, cover->current_operation);
-  return this->send_buffer(APIMessageType::COVER_STATE_RESPONSE);
+  encode_cover_state(buffer, cover);
+  return this->send_state_buffer_(APIMessageType::COVER_STATE_RESPONSE, cover);
 }
 #endif
 
@@ -840,26 +1618,14 @@ bool APIConnection::send_cover_state(cover::Cover *cover) {
 bool APIConnection::send_fan_state(fan::FanState *fan) {
   if (!this->state_subscription_)
     return false;
+  if (!this->accepts_domain_(API_DOMAIN_FAN))
+    return true;
+  if (this->should_batch_states_())
+    return this->schedule_state_(APIMessageType::FAN_STATE_RESPONSE, fan);
 
   auto buffer = this->get_buffer();
-  // fixed32 key = 1;
-  buffer.encode_fixed32(1, fan->get_object_id_hash());
-  // bool state = 2;
-  buffer.encode_bool(2, fan->state);
-  // bool oscillating = 3;
-  if (fan->get_traits().supports_oscillation()) {
-    buffer.encode_bool(3, fan->oscillating);
-  }
-  // enum FanSpeed {
-  //   LOW = 0;
-  //   MEDIUM = 1;
-  //   HIGH = 2;
-  // }
-  // FanSpeed speed = 4;
-  if (fan->get_traits().supports_speed()) {
-    buffer.encode_uint32(4, fan->speed);
-  }
-  return this->send_buffer(APIMessageType::FAN_STATE_RESPONSE);
+  encode_fan_state(buffer, fan);
+  return this->send_state_buffer_(APIMessageType::FAN_STATE_RESPONSE, fan);
 }
 #endif
 
@@ -867,40 +1633,14 @@ bool APIConnection::send_fan_state(fan::FanState *fan) {
 bool APIConnection::send_light_state(light::LightState *light) {
   if (!this->state_subscription_)
     return false;
+  if (!this->accepts_domain_(API_DOMAIN_LIGHT))
+    return true;
+  if (this->should_batch_states_())
+    return this->schedule_state_(APIMessageType::LIGHT_STATE_RESPONSE, light);
 
   auto buffer = this->get_buffer();
-  auto traits = light->get_traits();
-  auto values = light->remote_values;
-
-  // fixed32 key = 1;
-  buffer.encode_fixed32(1, light->get_object_id_hash());
-  // bool state = 2;
-  buffer.encode_bool(2, values.get_state() != 0.0f);
-  // float brightness = 3;
-  if (traits.has_brightness()) {
-    buffer.encode_float(3, values.get_brightness());
-  }
-  if (traits.has_rgb()) {
-    // float red = 4;
-    buffer.encode_float(4, values.get_red());
-    // float green = 5;
-    buffer.encode_float(5, values.get_green());
-    // float blue = 6;
-    buffer.encode_float(6, values.get_blue());
-  }
-  // float white = 7;
-  if (traits.has_rgb_white_value()) {
-    buffer.encode_float(7, values.get_white());
-  }
-  // float color_temperature = 8;
-  if (traits.has_color_temperature()) {
-    buffer.encode_float(8, values.get_color_temperature());
-  }
-  // string effect = 9;
-  if (light->supports_effects()) {
-    buffer.encode_string(9, light->get_effect_name());
-  }
-  return this->send_buffer(APIMessageType::LIGHT_STATE_RESPONSE);
+  encode_light_state(buffer, light);
+  return this->send_state_buffer_(APIMessageType::LIGHT_STATE_RESPONSE, light);
 }
 #endif
 
@@ -908,13 +1648,14 @@ bool APIConnection::send_light_state(light::LightState *light) {
 bool APIConnection::send_sensor_state(sensor::Sensor *sensor, float state) {
   if (!this->state_subscription_)
     return false;
+  if (!this->accepts_domain_(API_DOMAIN_SENSOR))
+    return true;
+  if (this->should_batch_states_())
+    return this->schedule_state_(APIMessageType::SENSOR_STATE_RESPONSE, sensor);
 
   auto buffer = this->get_buffer();
-  // fixed32 key = 1;
-  buffer.encode_fixed32(1, sensor->get_object_id_hash());
-  // float state = 2;
-  buffer.encode_float(2, state);
-  return this->send_buffer(APIMessageType::SENSOR_STATE_RESPONSE);
+  encode_sensor_state(buffer, sensor, state);
+  return this->send_state_buffer_(APIMessageType::SENSOR_STATE_RESPONSE, sensor);
 }
 #endif
 
@@ -922,27 +1663,29 @@ bool APIConnection::send_sensor_state(sensor::Sensor *sensor, float state) {
 bool APIConnection::send_switch_state(switch_::Switch *a_switch, bool state) {
   if (!this->state_subscription_)
     return false;
+  if (!this->accepts_domain_(API_DOMAIN_SWITCH))
+    return true;
+  if (this->should_batch_states_())
+    return this->schedule_state_(APIMessageType::SWITCH_STATE_RESPONSE, a_switch);
 
   auto buffer = this->get_buffer();
-  // fixed32 key = 1;
-  buffer.encode_fixed32(1, a_switch->get_object_id_hash());
-  // bool state = 2;
-  buffer.encode_bool(2, state);
-  return this->send_buffer(APIMessageType::SWITCH_STATE_RESPONSE);
+  encode_switch_state(buffer, a_switch, state);
+  return this->send_state_buffer_(APIMessageType::SWITCH_STATE_RESPONSE, a_switch);
 }
 #endif
 
 #ifdef USE_TEXT_SENSOR
-bool APIConnection::send_text_sensor_state(text_sensor::TextSensor *text_sensor, std::string state) {
+bool APIConnection::send_text_sensor_state(text_sensor::TextSensor *text_sensor, const std::string &state) {
   if (!this->state_subscription_)
     return false;
+  if (!this->accepts_domain_(API_DOMAIN_TEXT_SENSOR))
+    return true;
+  if (this->should_batch_states_())
+    return this->schedule_state_(APIMessageType::TEXT_SENSOR_STATE_RESPONSE, text_sensor);
 
   auto buffer = this->get_buffer();
-  // fixed32 key = 1;
-  buffer.encode_fixed32(1, text_sensor->get_object_id_hash());
-  // string state = 2;
-  buffer.encode_string(2, state);
-  return this->send_buffer(APIMessageType::TEXT_SENSOR_STATE_RESPONSE);
+  encode_text_sensor_state(buffer, text_sensor, state);
+  return this->send_state_buffer_(APIMessageType::TEXT_SENSOR_STATE_RESPONSE, text_sensor);
 }
 #endif
 
@@ -950,37 +1693,21 @@ bool APIConnection::send_text_sensor_state(text_sensor::TextSensor *text_sensor,
 bool APIConnection::send_climate_state(climate::ClimateDevice *climate) {
   if (!this->state_subscription_)
     return false;
+  if (!this->accepts_domain_(API_DOMAIN_CLIMATE))
+    return true;
+  if (this->should_batch_states_())
+    return this->schedule_state_(APIMessageType::CLIMATE_STATE_RESPONSE, climate);
 
   auto buffer = this->get_buffer();
-  auto traits = climate->get_traits();
-  // fixed32 key = 1;
-  buffer.encode_fixed32(1, climate->get_object_id_hash());
-  // ClimateMode mode = 2;
-  buffer.encode_uint32(2, static_cast<uint32_t>(climate->mode));
-  // float current_temperature = 3;
-  if (traits.get_supports_current_temperature()) {
-    buffer.encode_float(3, climate->current_temperature);
-  }
-  if (traits.get_supports_two_point_target_temperature()) {
-    // float target_temperature_low = 5;
-    buffer.encode_float(5, climate->target_temperature_low);
-    // float target_temperature_high = 6;
-    buffer.encode_float(6, climate->target_temperature_high);
-  } else {
-    // float target_temperature = 4;
-    buffer.encode_float(4, climate->target_temperature);
-  }
-  // bool away = 7;
-  if (traits.get_supports_away()) {
-    buffer.encode_bool(7, climate->away);
-  }
-  return this->send_buffer(APIMessageType::CLIMATE_STATE_RESPONSE);
+  encode_climate_state(buffer, climate);
+  return this->send_state_buffer_(APIMessageType::CLIMATE_STATE_RESPONSE, climate);
 }
 #endif
 
 bool APIConnection::send_log_message(int level, const char *tag, const char *line) {
   if (this->log_subscription_ < level)
     return false;
+  network_notify_activity();
 
   auto buffer = this->get_buffer();
   // LogLevel level = 1;
@@ -989,13 +1716,14 @@ bool APIConnection::send_log_message(int level, const char *tag, const char *lin
   // buffer.encode_string(2, tag, strlen(tag));
   // string message = 3;
   buffer.encode_string(3, line, strlen(line));
-  bool success = this->send_buffer(APIMessageType::SUBSCRIBE_LOGS_RESPONSE);
+  // log messages are never queued, they would only crowd out the other messages
+  bool success = this->send_framed_buffer_(APIMessageType::SUBSCRIBE_LOGS_RESPONSE, false);
 
   if (!success) {
     auto buffer = this->get_buffer();
     // bool send_failed = 4;
     buffer.encode_bool(4, true);
-    return this->send_buffer(APIMessageType::SUBSCRIBE_LOGS_RESPONSE);
+    return this->send_framed_buffer_(APIMessageType::SUBSCRIBE_LOGS_RESPONSE, false);
   } else {
     return true;
   }
@@ -1159,8 +1887,95 @@ void APIConnection::on_execute_service_(const ExecuteServiceRequest &req) {
   }
 }
 
+bool APIConnection::should_batch_states_() const {
+  return (this->parent_->is_batching_states() || this->defer_states_) && !this->flushing_states_;
+}
+bool APIConnection::accepts_domain_(APIEntityDomain domain) const { return this->profile_->domains & domain; }
+bool APIConnection::schedule_state_(APIMessageType type, Nameable *entity) {
+  for (auto &pending : this->pending_states_) {
+    if (pending.type == type && pending.entity == entity)
+      // already queued, the latest state is read when the batch is sent
+      return true;
+  }
+  if (this->pending_states_.empty())
+    this->pending_states_since_ = millis();
+  this->pending_states_.push_back(PendingState{type, entity});
+  return true;
+}
+void APIConnection::flush_pending_states_() {
+  if (this->pending_states_.empty() || this->tx_queue_size_ != 0 || this->defer_states_)
+    return;
+  if (millis() - this->pending_states_since_ < this->parent_->get_batch_delay())
+    return;
+
+  this->batch_buffer_.clear();
+  this->flushing_states_ = true;
+  size_t sent = 0;
+  while (sent < this->pending_states_.size()) {
+    if (!this->send_pending_state_(this->pending_states_[sent]))
+      // out of TCP buffer space, the rest is sent in one of the next loop iterations
+      break;
+    sent++;
+  }
+  this->flushing_states_ = false;
+
+  if (this->batch_buffer_.empty())
+    return;
+  this->client_->add(reinterpret_cast<char *>(this->batch_buffer_.data()), this->batch_buffer_.size());
+  this->tx_sent_ += this->batch_buffer_.size();
+  this->client_->send();
+  this->pending_states_.erase(this->pending_states_.begin(), this->pending_states_.begin() + sent);
+}
+bool APIConnection::send_pending_state_(const PendingState &pending) {
+  switch (pending.type) {
+#ifdef USE_BINARY_SENSOR
+    case APIMessageType::BINARY_SENSOR_STATE_RESPONSE: {
+      auto *obj = static_cast<binary_sensor::BinarySensor *>(pending.entity);
+      return this->send_binary_sensor_state(obj, obj->state);
+    }
+#endif
+#ifdef USE_COVER
+    case APIMessageType::COVER_STATE_RESPONSE:
+      return this->send_cover_state(static_cast<cover::Cover *>(pending.entity));
+#endif
+#ifdef USE_FAN
+    case APIMessageType::FAN_STATE_RESPONSE:
+      return this->send_fan_state(static_cast<fan::FanState *>(pending.entity));
+#endif
+#ifdef USE_LIGHT
+    case APIMessageType::LIGHT_STATE_RESPONSE:
+      return this->send_light_state(static_cast<light::LightState *>(pending.entity));
+#endif
+#ifdef USE_SENSOR
+    case APIMessageType::SENSOR_STATE_RESPONSE: {
+      auto *obj = static_cast<sensor::Sensor *>(pending.entity);
+      return this->send_sensor_state(obj, obj->state);
+    }
+#endif
+#ifdef USE_SWITCH
+    case APIMessageType::SWITCH_STATE_RESPONSE: {
+      auto *obj = static_cast<switch_::Switch *>(pending.entity);
+      return this->send_switch_state(obj, obj->state);
+    }
+#endif
+#ifdef USE_TEXT_SENSOR
+    case APIMessageType::TEXT_SENSOR_STATE_RESPONSE: {
+      auto *obj = static_cast<text_sensor::TextSensor *>(pending.entity);
+      return this->send_text_sensor_state(obj, obj->state);
+    }
+#endif
+#ifdef USE_CLIMATE
+    case APIMessageType::CLIMATE_STATE_RESPONSE:
+      return this->send_climate_state(static_cast<climate::ClimateDevice *>(pending.entity));
+#endif
+    default:
+      return true;
+  }
+}
+
 APIBuffer APIConnection::get_buffer() {
-  this->send_buffer_.clear();
+  // Keeps the capacity, so after the first few messages encoding doesn't touch the heap anymore.
+  this->send_buffer_.resize(API_HEADER_GAP);
   return APIBuffer(&this->send_buffer_);
 }
 #ifdef USE_HOMEASSISTANT_TIME
@@ -1169,15 +1984,66 @@ void APIConnection::send_time_request() { this->send_empty_message(APIMessageTyp
 
 #ifdef USE_ESP32_CAMERA
 void APIConnection::send_camera_state(std::shared_ptr<CameraImage> image) {
-  if (!this->state_subscription_)
+  if (!this->state_subscription_ || !this->profile_->camera)
     return;
-  if (this->image_reader_.available())
+  if (this->image_reader_.available() || this->image_release_pending_)
     return;
   this->image_reader_.set_image(image);
 }
 #endif
 
 #ifdef USE_ESP32_CAMERA
+void APIConnection::send_camera_chunk_() {
+  if (this->tx_queue_size_ != 0 || this->defer_states_)
+    return;
+  uint32_t space = this->client_->space();
+  // reserve 15 bytes for metadata (and the encrypted frame), and at least 64 bytes of data
+  const uint32_t overhead = 15 + (this->tx_cipher_ != nullptr ? API_CRYPTO_OVERHEAD : 0);
+  if (space < overhead + 64)
+    return;
+
+  uint32_t to_send = std::min(space - overhead, this->image_reader_.available());
+  bool done = this->image_reader_.available() == to_send;
+  auto buffer = this->get_buffer();
+  // fixed32 key = 1;
+  buffer.encode_fixed32(1, global_esp32_camera->get_object_id_hash());
+  // bytes data = 2;
+  buffer.encode_field_raw(2, 2);
+  buffer.encode_varint_raw(to_send);
+  // bool done = 3;
+  static const uint8_t DONE_FIELD[2] = {(3 << 3) | 0, 0x01};
+  const uint32_t trailer_len = done ? sizeof(DONE_FIELD) : 0;
+
+  size_t len;
+  if (this->tx_cipher_ != nullptr) {
+    // encrypted frames can't point into the framebuffer, the data is encrypted in the send buffer
+    const uint8_t *image = this->image_reader_.peek_data_buffer();
+    this->send_buffer_.insert(this->send_buffer_.end(), image, image + to_send);
+    this->send_buffer_.insert(this->send_buffer_.end(), DONE_FIELD, DONE_FIELD + trailer_len);
+    uint8_t *data = this->frame_send_buffer_(APIMessageType::CAMERA_IMAGE_RESPONSE, 0, &len);
+    data = this->encrypt_frame_(data, &len);
+    this->client_->add(reinterpret_cast<char *>(data), len);
+    this->client_->send();
+    this->tx_sent_ += len;
+  } else {
+    // Only the metadata goes through the send buffer, the image data itself is handed to lwIP
+    // without copying. The framebuffer is therefore kept until the client has acked all of it.
+    uint8_t *data = this->frame_send_buffer_(APIMessageType::CAMERA_IMAGE_RESPONSE, to_send + trailer_len, &len);
+    this->client_->add(reinterpret_cast<char *>(data), len);
+    this->client_->add(reinterpret_cast<char *>(this->image_reader_.peek_data_buffer()), to_send, 0);
+    if (done)
+      this->client_->add(reinterpret_cast<const char *>(DONE_FIELD), trailer_len, 0);
+    this->client_->send();
+    this->tx_sent_ += len + to_send + trailer_len;
+  }
+
+  this->image_reader_.consume_data(to_send);
+  network_notify_activity();
+  if (done) {
+    this->image_release_at_ = this->tx_sent_;
+    this->image_release_pending_ = true;
+  }
+}
 void APIConnection::on_camera_image_request_(const CameraImageRequest &req) {
   if (global_esp32_camera == nullptr)
     return;
@@ -9,6 +9,7 @@
 #include "esphome/controller.h"
 #include "esphome/api/util.h"
 #include "esphome/api/api_message.h"
+#include "esphome/api/api_crypto.h"
 #include "esphome/api/basic_messages.h"
 #include "esphome/api/list_entities.h"
 #include "esphome/api/subscribe_state.h"
@@ -17,6 +18,8 @@
 #include "esphome/api/service_call_message.h"
 #include "esphome/api/user_services.h"
 #include "esphome/log.h"
+#include "esphome/tracer.h"
+#include "esphome/sensor/sensor_history.h"
 
 #ifdef ARDUINO_ARCH_ESP32
 #include <AsyncTCP.h>
@@ -31,6 +34,38 @@ namespace api {
 
 class APIServer;
 
+#ifdef USE_TRACER
+/// The size of the JSON parts of a TraceResponse.
+static const size_t API_TRACE_CHUNK_SIZE = 512;
+#endif
+
+/// The entity domains of APIClientProfile::domains.
+enum APIEntityDomain : uint16_t {
+  API_DOMAIN_BINARY_SENSOR = 1 << 0,
+  API_DOMAIN_COVER = 1 << 1,
+  API_DOMAIN_FAN = 1 << 2,
+  API_DOMAIN_LIGHT = 1 << 3,
+  API_DOMAIN_SENSOR = 1 << 4,
+  API_DOMAIN_SWITCH = 1 << 5,
+  API_DOMAIN_TEXT_SENSOR = 1 << 6,
+  API_DOMAIN_CLIMATE = 1 << 7,
+  API_DOMAIN_ALL = 0xFFFF,
+};
+
+/// What a client subscribes to and how it is prioritized, selected by the client_info of its hello request.
+struct APIClientProfile {
+  /// Applies to clients whose client_info starts with this, an empty string applies to all clients.
+  std::string client_info;
+  /// While a client is short on TCP buffer space, clients with a lower priority hold back their state updates.
+  uint8_t priority{0};
+  /// The entity domains the client gets state updates for.
+  uint16_t domains{API_DOMAIN_ALL};
+  /// The most verbose log level the client can subscribe to.
+  int max_log_level{ESPHOME_LOG_LEVEL_VERY_VERBOSE};
+  /// Whether the client gets camera images.
+  bool camera{true};
+};
+
 class APIConnection {
  public:
   APIConnection(AsyncClient *client, APIServer *parent);
@@ -42,6 +77,16 @@ class APIConnection {
   bool send_message(APIMessage &msg);
   bool send_empty_message(APIMessageType type);
   void loop();
+  /// How long loop() can wait in the idle mode, work that only waits for the client wakes the loop up itself.
+  uint32_t get_loop_idle_time();
+
+  /// Number of bytes waiting in the send queue.
+  size_t get_tx_queue_depth() const;
+  /// Number of messages dropped because the send queue was full.
+  uint32_t get_tx_dropped() const;
+  /// Number of state updates that couldn't be sent right away and were merged into a later update.
+  uint32_t get_states_coalesced() const;
+  uint8_t get_priority() const;
 
 #ifdef USE_BINARY_SENSOR
   bool send_binary_sensor_state(binary_sensor::BinarySensor *binary_sensor, bool state);
@@ -62,7 +107,7 @@ class APIConnection {
   bool send_switch_state(switch_::Switch *a_switch, bool state);
 #endif
 #ifdef USE_TEXT_SENSOR
-  bool send_text_sensor_state(text_sensor::TextSensor *text_sensor, std::string state);
+  bool send_text_sensor_state(text_sensor::TextSensor *text_sensor, const std::string &state);
 #endif
 #ifdef USE_ESP32_CAMERA
   void send_camera_state(std::shared_ptr<CameraImage> image);
@@ -84,11 +129,65 @@ class APIConnection {
   void on_error_(int8_t error);
   void on_disconnect_();
   void on_timeout_(uint32_t time);
-  void on_data_(uint8_t *buf, size_t len);
+  /// Called by the TCP client for each received packet, the packet is only queued and acked once it's parsed.
+  void on_packet_(struct pbuf *pb);
   void fatal_error_();
   bool valid_rx_message_type_(uint32_t msg_type);
-  void read_message_(uint32_t size, uint32_t type, uint8_t *msg);
+  void read_message_(uint32_t type, const APIMessageView &msg);
+  /** Parse the received packets.
+   *
+   * Messages are decoded straight from the packet payloads. A packet that ends with the beginning of a message is
+   * kept until the next one arrives, the message is then decoded in place from both. Only messages that span more
+   * than two packets are copied into recv_buffer_ to be put back together.
+   */
   void parse_recv_buffer_();
+  void parse_packet_(struct pbuf *pb);
+  /// Parse the encrypted frames of a packet, frames split across packets are put together in recv_buffer_.
+  void parse_encrypted_packet_(uint8_t *data, size_t len);
+  /// Handle one complete encrypted frame, the handshake or a payload that is decrypted in place.
+  void read_encrypted_frame_(uint8_t *frame, size_t payload_len);
+  /// Whether messages can't be sent yet because the encryption handshake isn't done.
+  bool is_handshake_pending_() const;
+  /// Decode the message started in rx_held_ that continues in data, returns the number of bytes used from data.
+  size_t complete_held_frame_(uint8_t *data, size_t len);
+  /// Read the complete frames at the start of data, returns the number of bytes consumed.
+  size_t parse_frames_(uint8_t *data, size_t len);
+  /// Send the encoded message, if queue is true it is queued when the TCP buffer is full.
+  bool send_framed_buffer_(APIMessageType type, bool queue);
+  /** Write the message header into the gap in front of the encoded message.
+   *
+   * extra_len is the number of body bytes that will be sent separately after the encoded part.
+   * Returns the start of the framed message, *len is set to the number of bytes up to the end of the encoded part.
+   * With the encrypted transport the frame still has to be encrypted with encrypt_frame_(), extra_len has to be 0
+   * then.
+   */
+  uint8_t *frame_send_buffer_(APIMessageType type, uint32_t extra_len, size_t *len);
+  /// The bytes the encrypted transport adds to each frame, 0 without encryption.
+  size_t frame_overhead_() const;
+  /** Encrypt the frame at data in place if the transport is encrypted, returns the start of the encrypted frame.
+   *
+   * This uses up a nonce, so only call it once the frame will certainly be sent or queued.
+   */
+  uint8_t *encrypt_frame_(uint8_t *data, size_t *len);
+  /// Send a state message, when the TCP buffer is full the state is sent later instead.
+  bool send_state_buffer_(APIMessageType type, Nameable *entity);
+  /// Append data to the send queue, the caller checks that it fits.
+  void tx_queue_push_(const uint8_t *data, size_t len);
+  /// Hand as much of the send queue to the TCP client as it has space for.
+  void drain_tx_queue_();
+  /// Advance the entity iterators for as long as the TCP buffer and the per-loop time budget allow.
+  void advance_iterators_();
+  /// Send the next message of the list entities cache, returns false if none was sent.
+  bool advance_list_entities_();
+
+  /// Whether state messages should be queued for the next batch instead of being sent right away.
+  bool should_batch_states_() const;
+  /// Whether the profile of the client includes state updates of the domain.
+  bool accepts_domain_(APIEntityDomain domain) const;
+  /// Queue a state update for the entity, only the latest state of each entity is sent.
+  bool schedule_state_(APIMessageType type, Nameable *entity);
+  /// Send all queued state updates in a single write once the batch delay has passed.
+  void flush_pending_states_();
 
   // request types
   void on_hello_request_(const HelloRequest &req);
@@ -101,6 +200,24 @@ class APIConnection {
   void on_list_entities_request_(const ListEntitiesRequest &req);
   void on_subscribe_states_request_(const SubscribeStatesRequest &req);
   void on_subscribe_logs_request_(const SubscribeLogsRequest &req);
+  void on_component_stats_request_(const ComponentStatsRequest &req);
+#ifdef USE_COMPONENT_PROFILER
+  bool send_component_stats_(uint32_t index);
+  void advance_component_stats_();
+#endif
+  void on_trace_request_(const TraceRequest &req);
+#ifdef USE_TRACER
+  void advance_trace_();
+#endif
+  void on_sensor_history_request_(const SensorHistoryRequest &req);
+#ifdef USE_SENSOR_HISTORY
+  void advance_sensor_history_();
+#endif
+  void on_metrics_request_(const MetricsRequest &req);
+#ifdef USE_METRICS
+  /// Send the requested metrics, returns false if they didn't fit into the TCP buffer.
+  bool send_metrics_();
+#endif
 #ifdef USE_COVER
   void on_cover_command_request_(const CoverCommandRequest &req);
 #endif
@@ -122,6 +239,8 @@ class APIConnection {
   void on_execute_service_(const ExecuteServiceRequest &req);
 #ifdef USE_ESP32_CAMERA
   void on_camera_image_request_(const CameraImageRequest &req);
+  /// Send the next slice of the current image, straight from the camera framebuffer.
+  void send_camera_chunk_();
 #endif
 
   enum class ConnectionState {
@@ -131,17 +250,41 @@ class APIConnection {
   } connection_state_{ConnectionState::WAITING_FOR_HELLO};
 
   bool remove_{false};
+  /// Set once the server counted the connection towards the client limit.
+  bool accepted_{false};
   AsyncClient *client_;
   APIServer *parent_;
+  const APIClientProfile *profile_;
+  /// Set by the server while a client with a higher priority is short on TCP buffer space.
+  bool defer_states_{false};
 
   std::vector<uint8_t> send_buffer_;
+  /// The beginning of a message that spans more than two packets.
   std::vector<uint8_t> recv_buffer_;
+  /// The packet with the beginning of the message that continues in the next packet, from rx_held_offset_.
+  struct pbuf *rx_held_{nullptr};
+  size_t rx_held_offset_{0};
+  /// The ciphers of the encrypted transport, set after the handshake.
+  APIFrameCipher *rx_cipher_{nullptr};
+  APIFrameCipher *tx_cipher_{nullptr};
+  /// The received packets that haven't been parsed yet, chained with pbuf_cat().
+  struct pbuf *rx_packets_{nullptr};
+#ifdef ARDUINO_ARCH_ESP32
+  /// Guards rx_packets_, the TCP callbacks run in the AsyncTCP task.
+  portMUX_TYPE rx_lock_ = portMUX_INITIALIZER_UNLOCKED;
+#endif
 
   std::string client_info_;
-  ListEntitiesIterator list_entities_iterator_;
+  /// The list entities cache being sent, nullptr if no list entities request is active.
+  std::shared_ptr<const std::vector<uint8_t>> list_entities_;
+  /// The offset of the next message in list_entities_.
+  size_t list_entities_at_{0};
   InitialStateIterator initial_state_iterator_;
 #ifdef USE_ESP32_CAMERA
   CameraImageReader image_reader_;
+  /// The image has been sent completely and is released once tx_acked_ reaches image_release_at_.
+  bool image_release_pending_{false};
+  uint32_t image_release_at_{0};
 #endif
 
   bool state_subscription_{false};
@@ -149,6 +292,51 @@ class APIConnection {
   uint32_t last_traffic_;
   bool sent_ping_{false};
   bool service_call_subscription_{false};
+
+  struct PendingState {
+    APIMessageType type;
+    Nameable *entity;
+  };
+  bool send_pending_state_(const PendingState &pending);
+
+  std::vector<PendingState> pending_states_;
+  uint32_t pending_states_since_{0};
+  /// Set while flushing, send_buffer() then appends the framed message to batch_buffer_.
+  bool flushing_states_{false};
+  std::vector<uint8_t> batch_buffer_;
+  /// Ring buffer of framed messages waiting for TCP buffer space, allocated on first use.
+  std::vector<uint8_t> tx_queue_;
+  size_t tx_queue_head_{0};
+  size_t tx_queue_size_{0};
+  uint32_t tx_dropped_{0};
+  uint32_t states_coalesced_{0};
+  /// Total number of bytes handed to the TCP client.
+  uint32_t tx_sent_{0};
+  /// Total number of bytes acked by the remote, updated from the AsyncTCP task.
+  volatile uint32_t tx_acked_{0};
+#ifdef USE_COMPONENT_PROFILER
+  /// Index of the next component to send stats for, -1 if no stats request is active.
+  int32_t component_stats_at_{-1};
+  bool component_stats_reset_{false};
+#endif
+#ifdef USE_TRACER
+  /// The trace being sent, nullptr if no trace request is active.
+  std::unique_ptr<TraceJsonWriter> trace_writer_;
+  /// The part of the trace that couldn't be sent yet.
+  std::string trace_chunk_;
+#endif
+#ifdef USE_SENSOR_HISTORY
+  /// The history being sent, nullptr if no history request is active.
+  sensor::SensorHistory *history_{nullptr};
+  sensor::SensorHistoryTier history_tier_{sensor::SENSOR_HISTORY_RAW};
+  /// The next entry to send.
+  sensor::SensorHistoryCursor history_cursor_;
+#endif
+#ifdef USE_METRICS
+  /// Whether a metrics response is waiting for room in the TCP buffer.
+  bool metrics_pending_{false};
+  bool metrics_include_names_{false};
+#endif
 };
 
 template<typename... Ts> class HomeAssistantServiceCallAction;
@@ -160,13 +348,49 @@ class APIServer : public Component, public StoringUpdateListenerController {
   uint16_t get_port() const;
   float get_setup_priority() const override;
   void loop() override;
+  float get_loop_priority() const override;
+  uint32_t get_loop_idle_time() override;
   void dump_config() override;
   bool check_password(const std::string &password) const;
   bool uses_password() const;
   void set_port(uint16_t port);
   void set_password(const std::string &password);
+  /** Require the encrypted transport with this pre-shared key.
+   *
+   * Clients then have to do the handshake described in api_crypto.h, plaintext connections are closed. The
+   * password still works on top of the encryption.
+   */
+  void set_encryption_key(const std::array<uint8_t, 32> &key);
+  bool uses_encryption() const;
+  const std::array<uint8_t, 32> &get_encryption_key() const;
+  /// Close new connections while this many clients are connected, 0 for no limit (the default).
+  void set_max_clients(uint8_t max_clients);
+  /** Add a profile for clients with a matching client_info.
+   *
+   * The first matching profile in the order they were added applies, clients without one get everything with
+   * priority 0. The clients are served in the order of their priority, and while one is short on TCP buffer space
+   * the state updates of clients with a lower priority are queued (only the latest state of each entity is kept)
+   * until it caught up.
+   */
+  void add_client_profile(const APIClientProfile &profile);
+  /// Get the profile for the client_info of a hello request.
+  const APIClientProfile *get_client_profile(const std::string &client_info) const;
   void set_reboot_timeout(uint32_t reboot_timeout);
+  /** Enable batching of state messages.
+   *
+   * State updates are then queued per connection and sent together in a single write once
+   * batch_delay ms have passed since the first queued update. If an entity updates multiple times
+   * within that window, only its latest state is sent. With a batch delay of 0, all updates from
+   * one loop iteration are batched.
+   */
+  void set_batch_delay(uint32_t batch_delay);
+  bool is_batching_states() const;
+  uint32_t get_batch_delay() const;
   void handle_disconnect(APIConnection *conn);
+  /// Serve the clients in the order of their priority again, called when the profile of a client changed.
+  void sort_clients();
+  /// Request the highest log level any client subscribed to from the logger.
+  void update_log_level();
 #ifdef USE_BINARY_SENSOR
   void on_binary_sensor_update(binary_sensor::BinarySensor *obj, bool state) override;
 #endif
@@ -186,7 +410,7 @@ class APIServer : public Component, public StoringUpdateListenerController {
   void on_switch_update(switch_::Switch *obj, bool state) override;
 #endif
 #ifdef USE_TEXT_SENSOR
-  void on_text_sensor_update(text_sensor::TextSensor *obj, std::string state) override;
+  void on_text_sensor_update(text_sensor::TextSensor *obj, const std::string &state) override;
 #endif
 #ifdef USE_CLIMATE
   void on_climate_update(climate::ClimateDevice *obj) override;
@@ -210,16 +434,37 @@ class APIServer : public Component, public StoringUpdateListenerController {
   void subscribe_home_assistant_state(std::string entity_id, std::function<void(std::string)> f);
   const std::vector<HomeAssistantStateSubscription> &get_state_subs() const;
   const std::vector<UserServiceDescriptor *> &get_user_services() const { return this->user_services_; }
+  /** The encoded ListEntities*Response messages of all entities, followed by the done message.
+   *
+   * Encoded on the first request after setup and shared by all clients, so that reconnecting clients (for example
+   * after a Home Assistant restart) don't re-encode the names, ids, icons and units. Registering a user service
+   * invalidates it, clients that are still sending the old messages keep their reference.
+   */
+  std::shared_ptr<const std::vector<uint8_t>> get_list_entities();
 
  protected:
+  /// Count new connections towards the client limit, or close them if it is reached.
+  void accept_clients_();
+  /// Let the clients with a lower priority than a client short on TCP buffer space defer their state updates.
+  void update_deferred_clients_();
+
   AsyncServer server_{0};
   uint16_t port_{6053};
   uint32_t reboot_timeout_{300000};
+  bool batch_states_{false};
+  uint32_t batch_delay_{0};
   uint32_t last_connected_{0};
+  size_t log_callback_id_{0};
   std::vector<APIConnection *> clients_;
+  uint8_t max_clients_{0};
+  std::vector<APIClientProfile> client_profiles_;
+  bool sort_clients_{false};
   std::string password_;
+  bool encryption_{false};
+  std::array<uint8_t, 32> encryption_key_;
   std::vector<HomeAssistantStateSubscription> state_subs_;
   std::vector<UserServiceDescriptor *> user_services_;
+  std::shared_ptr<const std::vector<uint8_t>> list_entities_;
 };
 
 extern APIServer *global_api_server;
@@ -270,6 +515,7 @@ UserService<Ts...> *APIServer::make_user_service_trigger(const std::string &name
                                                          const std::array<ServiceTypeArgument, sizeof...(Ts)> &args) {
   auto *service = new UserService<Ts...>(name, args);
   this->user_services_.push_back(service);
+  this->list_entities_ = nullptr;
   return service;
 }
 
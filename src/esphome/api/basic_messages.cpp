@@ -38,6 +38,52 @@ void ConnectRequest::set_password(const std::string &password) { this->password_
 APIMessageType ConnectRequest::message_type() const { return APIMessageType::CONNECT_REQUEST; }
 
 APIMessageType DeviceInfoRequest::message_type() const { return APIMessageType::DEVICE_INFO_REQUEST; }
+APIMessageType ComponentStatsRequest::message_type() const { return APIMessageType::COMPONENT_STATS_REQUEST; }
+bool ComponentStatsRequest::decode_varint(uint32_t field_id, uint32_t value) {
+  switch (field_id) {
+    case 1:  // bool reset = 1;
+      this->reset_ = value;
+      return true;
+    default:
+      return false;
+  }
+}
+bool ComponentStatsRequest::get_reset() const { return this->reset_; }
+void ComponentStatsRequest::set_reset(bool reset) { this->reset_ = reset; }
+APIMessageType TraceRequest::message_type() const { return APIMessageType::TRACE_REQUEST; }
+bool SensorHistoryRequest::decode_varint(uint32_t field_id, uint32_t value) {
+  switch (field_id) {
+    case 2:  // SensorHistoryTier tier = 2;
+      this->tier_ = value;
+      return true;
+    default:
+      return false;
+  }
+}
+bool SensorHistoryRequest::decode_32bit(uint32_t field_id, uint32_t value) {
+  switch (field_id) {
+    case 1:  // fixed32 key = 1;
+      this->key_ = value;
+      return true;
+    default:
+      return false;
+  }
+}
+APIMessageType SensorHistoryRequest::message_type() const { return APIMessageType::SENSOR_HISTORY_REQUEST; }
+uint32_t SensorHistoryRequest::get_key() const { return this->key_; }
+uint32_t SensorHistoryRequest::get_tier() const { return this->tier_; }
+APIMessageType MetricsRequest::message_type() const { return APIMessageType::METRICS_REQUEST; }
+bool MetricsRequest::decode_varint(uint32_t field_id, uint32_t value) {
+  switch (field_id) {
+    case 1:  // bool include_names = 1;
+      this->include_names_ = value;
+      return true;
+    default:
+      return false;
+  }
+}
+bool MetricsRequest::get_include_names() const { return this->include_names_; }
+void MetricsRequest::set_include_names(bool include_names) { this->include_names_ = include_names; }
 APIMessageType DisconnectRequest::message_type() const { return APIMessageType::DISCONNECT_REQUEST; }
 bool DisconnectRequest::decode_length_delimited(uint32_t field_id, const uint8_t *value, size_t len) {
   switch (field_id) {
@@ -38,6 +38,46 @@ class DeviceInfoRequest : public APIMessage {
   APIMessageType message_type() const override;
 };
 
+class ComponentStatsRequest : public APIMessage {
+ public:
+  bool decode_varint(uint32_t field_id, uint32_t value) override;
+  APIMessageType message_type() const override;
+  bool get_reset() const;
+  void set_reset(bool reset);
+
+ protected:
+  bool reset_{false};
+};
+
+class TraceRequest : public APIMessage {
+ public:
+  APIMessageType message_type() const override;
+};
+
+class SensorHistoryRequest : public APIMessage {
+ public:
+  bool decode_varint(uint32_t field_id, uint32_t value) override;
+  bool decode_32bit(uint32_t field_id, uint32_t value) override;
+  APIMessageType message_type() const override;
+  uint32_t get_key() const;
+  uint32_t get_tier() const;
+
+ protected:
+  uint32_t key_{0};
+  uint32_t tier_{0};
+};
+
+class MetricsRequest : public APIMessage {
+ public:
+  bool decode_varint(uint32_t field_id, uint32_t value) override;
+  APIMessageType message_type() const override;
+  bool get_include_names() const;
+  void set_include_names(bool include_names);
+
+ protected:
+  bool include_names_{false};
+};
+
 class DisconnectRequest : public APIMessage {
  public:
   bool decode_length_delimited(uint32_t field_id, const uint8_t *value, size_t len) override;
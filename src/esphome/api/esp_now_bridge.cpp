@@ -0,0 +1,384 @@
+#include "esphome/defines.h"
+
+#ifdef USE_ESP_NOW_BRIDGE
+
+#include "esphome/api/esp_now_bridge.h"
+#include "esphome/api/command_messages.h"
+#include "esphome/api/subscribe_state.h"
+#include "esphome/log.h"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef ARDUINO_ARCH_ESP32
+#include <esp_now.h>
+#include <esp_wifi.h>
+#endif
+#ifdef ARDUINO_ARCH_ESP8266
+extern "C" {
+#include <espnow.h>
+}
+#endif
+
+ESPHOME_NAMESPACE_BEGIN
+
+namespace api {
+
+static const char *TAG = "api.esp_now";
+
+/// Version byte at the start of each frame.
+static const uint8_t ESP_NOW_BRIDGE_VERSION = 0x01;
+/// Preamble and two varints in front of each message.
+static const size_t ESP_NOW_MESSAGE_HEADER_SIZE = 11;
+
+static void address_to_bytes(uint64_t address, uint8_t *bytes) {
+  for (int i = 5; i >= 0; i--) {
+    bytes[i] = address & 0xFF;
+    address >>= 8;
+  }
+}
+static uint64_t address_from_bytes(const uint8_t *bytes) {
+  uint64_t address = 0;
+  for (int i = 0; i < 6; i++)
+    address = (address << 8) | bytes[i];
+  return address;
+}
+
+void ESPNowPacketQueue::push(const uint8_t *address, const uint8_t *data, size_t len) {
+  const uint8_t write_at = this->write_at_;
+  const uint8_t next = (write_at + 1) % ESP_NOW_QUEUE_SIZE;
+  if (next == this->read_at_) {
+    this->dropped_++;
+    return;
+  }
+
+  ESPNowPacket &packet = this->packets_[write_at];
+  packet.address = address_from_bytes(address);
+  packet.len = std::min<size_t>(len, ESP_NOW_MAX_PACKET_SIZE);
+  memcpy(packet.data, data, packet.len);
+  this->write_at_ = next;
+}
+const ESPNowPacket *ESPNowPacketQueue::front() const {
+  const uint8_t read_at = this->read_at_;
+  if (read_at == this->write_at_)
+    return nullptr;
+  return &this->packets_[read_at];
+}
+void ESPNowPacketQueue::pop() { this->read_at_ = (this->read_at_ + 1) % ESP_NOW_QUEUE_SIZE; }
+uint32_t ESPNowPacketQueue::take_dropped() {
+  const uint32_t dropped = this->dropped_;
+  const uint32_t count = dropped - this->dropped_seen_;
+  this->dropped_seen_ = dropped;
+  return count;
+}
+
+ESPNowBridge *global_esp_now_bridge = nullptr;
+
+#ifdef ARDUINO_ARCH_ESP32
+static void esp_now_receive_callback(const uint8_t *address, const uint8_t *data, int len) {
+  global_esp_now_bridge->on_receive(address, data, len);
+}
+#endif
+#ifdef ARDUINO_ARCH_ESP8266
+static void esp_now_receive_callback(uint8_t *address, uint8_t *data, uint8_t len) {
+  global_esp_now_bridge->on_receive(address, data, len);
+}
+#endif
+
+void ESPNowBridge::on_receive(const uint8_t *address, const uint8_t *data, size_t len) {
+  this->queue_.push(address, data, len);
+  wake_loop();
+}
+
+void ESPNowBridge::setup() {
+  ESP_LOGCONFIG(TAG, "Setting up ESP-NOW bridge...");
+  global_esp_now_bridge = this;
+  this->message_.reserve(64);
+  this->packet_.reserve(ESP_NOW_MAX_PACKET_SIZE);
+
+  if (esp_now_init() != 0) {
+    ESP_LOGE(TAG, "Initializing ESP-NOW failed!");
+    this->mark_failed();
+    return;
+  }
+#ifdef ARDUINO_ARCH_ESP8266
+  esp_now_set_self_role(ESP_NOW_ROLE_COMBO);
+#endif
+  esp_now_register_recv_cb(esp_now_receive_callback);
+
+  for (uint64_t address : this->peers_) {
+    uint8_t bytes[6];
+    address_to_bytes(address, bytes);
+#ifdef ARDUINO_ARCH_ESP32
+    esp_now_peer_info_t peer{};
+    memcpy(peer.peer_addr, bytes, 6);
+    // 0 is the current WiFi channel
+    peer.channel = 0;
+    peer.ifidx = ESP_IF_WIFI_STA;
+    peer.encrypt = false;
+    const bool ok = esp_now_add_peer(&peer) == ESP_OK;
+#endif
+#ifdef ARDUINO_ARCH_ESP8266
+    const bool ok = esp_now_add_peer(bytes, ESP_NOW_ROLE_COMBO, 0, nullptr, 0) == 0;
+#endif
+    if (!ok) {
+      ESP_LOGE(TAG, "Adding peer 0x%s failed!", uint64_to_string(address).c_str());
+    }
+  }
+
+  this->subscribe_states_(this);
+}
+void ESPNowBridge::loop() {
+  const ESPNowPacket *packet;
+  while ((packet = this->queue_.front()) != nullptr) {
+    this->handle_packet_(*packet);
+    this->queue_.pop();
+  }
+  const uint32_t dropped = this->queue_.take_dropped();
+  if (dropped != 0) {
+    ESP_LOGW(TAG, "Dropped %u received frames, loop() is too slow!", dropped);
+  }
+
+  this->process_states_();
+  this->send_packet_();
+}
+void ESPNowBridge::dump_config() {
+  ESP_LOGCONFIG(TAG, "ESP-NOW Bridge:");
+  for (uint64_t address : this->peers_) {
+    ESP_LOGCONFIG(TAG, "  Peer: 0x%s", uint64_to_string(address).c_str());
+  }
+  ESP_LOGCONFIG(TAG, "  Published Entities: %u", this->published_.size());
+  ESP_LOGCONFIG(TAG, "  Remote Entities: %u", this->remote_entities_.size());
+}
+float ESPNowBridge::get_setup_priority() const { return setup_priority::WIFI - 1.0f; }
+
+void ESPNowBridge::add_peer(uint64_t address) { this->peers_.push_back(address); }
+bool ESPNowBridge::is_peer_(uint64_t address) const {
+  return std::find(this->peers_.begin(), this->peers_.end(), address) != this->peers_.end();
+}
+bool ESPNowBridge::is_published_(Nameable *obj) const {
+  return std::find(this->published_.begin(), this->published_.end(), obj) != this->published_.end();
+}
+
+APIBuffer ESPNowBridge::get_buffer_() {
+  this->message_.clear();
+  return APIBuffer(&this->message_);
+}
+void ESPNowBridge::add_message_(APIMessageType type) {
+  const size_t needed = this->message_.size() + ESP_NOW_MESSAGE_HEADER_SIZE;
+  if (needed + 1 > ESP_NOW_MAX_PACKET_SIZE) {
+    ESP_LOGW(TAG, "Message of type %u is too large for ESP-NOW!", static_cast<uint32_t>(type));
+    return;
+  }
+  if (this->packet_.size() + needed > ESP_NOW_MAX_PACKET_SIZE)
+    this->send_packet_();
+
+  APIBuffer packet(&this->packet_);
+  if (this->packet_.empty())
+    packet.write(ESP_NOW_BRIDGE_VERSION);
+  packet.write(0x00);
+  packet.encode_varint_raw(this->message_.size());
+  packet.encode_varint_raw(static_cast<uint32_t>(type));
+  this->packet_.insert(this->packet_.end(), this->message_.begin(), this->message_.end());
+}
+void ESPNowBridge::send_packet_() {
+  if (this->packet_.empty())
+    return;
+
+  // a null address sends the frame to all peers
+  if (esp_now_send(nullptr, this->packet_.data(), this->packet_.size()) != 0) {
+    ESP_LOGW(TAG, "Sending frame failed!");
+  }
+  this->packet_.clear();
+}
+
+void ESPNowBridge::handle_packet_(const ESPNowPacket &packet) {
+  if (!this->is_peer_(packet.address)) {
+    ESP_LOGV(TAG, "Ignoring frame from unknown node 0x%s", uint64_to_string(packet.address).c_str());
+    return;
+  }
+  if (packet.len == 0 || packet.data[0] != ESP_NOW_BRIDGE_VERSION) {
+    ESP_LOGW(TAG, "Unsupported frame from 0x%s", uint64_to_string(packet.address).c_str());
+    return;
+  }
+
+  const uint8_t *data = packet.data + 1;
+  size_t remaining = packet.len - 1;
+  while (remaining != 0) {
+    if (data[0] != 0x00)
+      break;
+    uint32_t consumed;
+    auto msg_size = proto_decode_varuint32(data + 1, remaining - 1, &consumed);
+    if (!msg_size.has_value())
+      break;
+    size_t header = 1 + consumed;
+    auto msg_type = proto_decode_varuint32(data + header, remaining - header, &consumed);
+    if (!msg_type.has_value())
+      break;
+    header += consumed;
+    if (remaining - header < *msg_size)
+      break;
+
+    this->handle_message_(static_cast<APIMessageType>(*msg_type), data + header, *msg_size);
+    data += header + *msg_size;
+    remaining -= header + *msg_size;
+  }
+  if (remaining != 0) {
+    ESP_LOGW(TAG, "Invalid frame from 0x%s", uint64_to_string(packet.address).c_str());
+  }
+}
+void ESPNowBridge::handle_message_(APIMessageType type, const uint8_t *data, size_t len) {
+  switch (type) {
+#ifdef USE_BINARY_SENSOR
+    case APIMessageType::BINARY_SENSOR_STATE_RESPONSE: {
+      EntityStateResponse msg(type);
+      msg.decode(data, len);
+      for (auto &remote : this->remote_entities_) {
+        if (remote.type == ENTITY_BINARY_SENSOR && remote.key == msg.get_key())
+          static_cast<binary_sensor::BinarySensor *>(remote.obj)->publish_state(msg.get_bool_state());
+      }
+      break;
+    }
+#endif
+#ifdef USE_SENSOR
+    case APIMessageType::SENSOR_STATE_RESPONSE: {
+      EntityStateResponse msg(type);
+      msg.decode(data, len);
+      for (auto &remote : this->remote_entities_) {
+        if (remote.type == ENTITY_SENSOR && remote.key == msg.get_key())
+          static_cast<sensor::Sensor *>(remote.obj)->publish_state(msg.get_float_state());
+      }
+      break;
+    }
+#endif
+#ifdef USE_SWITCH
+    case APIMessageType::SWITCH_COMMAND_REQUEST: {
+      SwitchCommandRequest req;
+      req.decode(data, len);
+      switch_::Switch *a_switch = this->get_switch_by_key(req.get_key());
+      if (a_switch == nullptr)
+        break;
+      if (req.get_state()) {
+        a_switch->turn_on();
+      } else {
+        a_switch->turn_off();
+      }
+      break;
+    }
+#endif
+#ifdef USE_LIGHT
+    case APIMessageType::LIGHT_COMMAND_REQUEST: {
+      LightCommandRequest req;
+      req.decode(data, len);
+      light::LightState *light = this->get_light_by_key(req.get_key());
+      if (light == nullptr)
+        break;
+      auto call = light->make_call();
+      call.set_state(req.get_state());
+      call.set_brightness(req.get_brightness());
+      call.set_red(req.get_red());
+      call.set_green(req.get_green());
+      call.set_blue(req.get_blue());
+      call.set_white(req.get_white());
+      call.set_color_temperature(req.get_color_temperature());
+      call.set_transition_length(req.get_transition_length());
+      call.set_flash_length(req.get_flash_length());
+      call.set_effect(req.get_effect());
+      call.perform();
+      break;
+    }
+#endif
+    default:
+      ESP_LOGV(TAG, "Ignoring message of type %u", static_cast<uint32_t>(type));
+      break;
+  }
+}
+
+#ifdef USE_BINARY_SENSOR
+void ESPNowBridge::publish_binary_sensor(binary_sensor::BinarySensor *binary_sensor) {
+  this->published_.push_back(binary_sensor);
+}
+void ESPNowBridge::add_remote_binary_sensor(const std::string &object_id,
+                                            binary_sensor::BinarySensor *binary_sensor) {
+  this->remote_entities_.push_back(RemoteEntity{fnv1_hash(object_id), ENTITY_BINARY_SENSOR, binary_sensor});
+}
+void ESPNowBridge::on_binary_sensor_update(binary_sensor::BinarySensor *obj, bool state) {
+  if (!this->is_published_(obj))
+    return;
+  auto buffer = this->get_buffer_();
+  encode_binary_sensor_state(buffer, obj, state);
+  this->add_message_(APIMessageType::BINARY_SENSOR_STATE_RESPONSE);
+}
+#endif
+#ifdef USE_SENSOR
+void ESPNowBridge::publish_sensor(sensor::Sensor *sensor) { this->published_.push_back(sensor); }
+void ESPNowBridge::add_remote_sensor(const std::string &object_id, sensor::Sensor *sensor) {
+  this->remote_entities_.push_back(RemoteEntity{fnv1_hash(object_id), ENTITY_SENSOR, sensor});
+}
+void ESPNowBridge::on_sensor_update(sensor::Sensor *obj, float state) {
+  if (!this->is_published_(obj))
+    return;
+  auto buffer = this->get_buffer_();
+  encode_sensor_state(buffer, obj, state);
+  this->add_message_(APIMessageType::SENSOR_STATE_RESPONSE);
+}
+#endif
+// Only binary sensor and sensor states are bridged
+#ifdef USE_FAN
+void ESPNowBridge::on_fan_update(fan::FanState *obj) {}
+#endif
+#ifdef USE_LIGHT
+void ESPNowBridge::on_light_update(light::LightState *obj) {}
+#endif
+#ifdef USE_SWITCH
+void ESPNowBridge::on_switch_update(switch_::Switch *obj, bool state) {}
+#endif
+#ifdef USE_TEXT_SENSOR
+void ESPNowBridge::on_text_sensor_update(text_sensor::TextSensor *obj, const std::string &state) {}
+#endif
+
+#ifdef USE_SWITCH
+void ESPNowBridge::send_switch_command(uint32_t key, bool state) {
+  auto buffer = this->get_buffer_();
+  // fixed32 key = 1;
+  buffer.encode_fixed32(1, key, true);
+  // bool state = 2;
+  buffer.encode_bool(2, state);
+  this->add_message_(APIMessageType::SWITCH_COMMAND_REQUEST);
+  this->send_packet_();
+}
+#endif
+#ifdef USE_LIGHT
+void ESPNowBridge::send_light_command(uint32_t key, optional<bool> state, optional<float> brightness,
+                                      optional<uint32_t> transition_length) {
+  auto buffer = this->get_buffer_();
+  // fixed32 key = 1;
+  buffer.encode_fixed32(1, key, true);
+  if (state.has_value()) {
+    // bool has_state = 2;
+    buffer.encode_bool(2, true);
+    // bool state = 3;
+    buffer.encode_bool(3, *state);
+  }
+  if (brightness.has_value()) {
+    // bool has_brightness = 4;
+    buffer.encode_bool(4, true);
+    // float brightness = 5;
+    buffer.encode_float(5, *brightness);
+  }
+  if (transition_length.has_value()) {
+    // bool has_transition_length = 14;
+    buffer.encode_bool(14, true);
+    // uint32 transition_length = 15;
+    buffer.encode_uint32(15, *transition_length);
+  }
+  this->add_message_(APIMessageType::LIGHT_COMMAND_REQUEST);
+  this->send_packet_();
+}
+#endif
+
+}  // namespace api
+
+ESPHOME_NAMESPACE_END
+
+#endif  // USE_ESP_NOW_BRIDGE
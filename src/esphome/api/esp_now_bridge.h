@@ -0,0 +1,210 @@
+#ifndef ESPHOME_API_ESP_NOW_BRIDGE_H
+#define ESPHOME_API_ESP_NOW_BRIDGE_H
+
+#include "esphome/defines.h"
+
+#ifdef USE_ESP_NOW_BRIDGE
+
+#include <vector>
+#include "esphome/component.h"
+#include "esphome/controller.h"
+#include "esphome/automation.h"
+#include "esphome/helpers.h"
+#include "esphome/api/util.h"
+#include "esphome/api/api_message.h"
+
+ESPHOME_NAMESPACE_BEGIN
+
+namespace api {
+
+/// The largest payload of an ESP-NOW frame.
+static const uint8_t ESP_NOW_MAX_PACKET_SIZE = 250;
+static const uint8_t ESP_NOW_QUEUE_SIZE = 8;
+
+struct ESPNowPacket {
+  uint64_t address;
+  uint8_t len;
+  uint8_t data[ESP_NOW_MAX_PACKET_SIZE];
+};
+
+/** Single-producer (the WiFi task/SDK callback) single-consumer (loop()) queue of received packets.
+ *
+ * Like ESP32BLEScanResultQueue, the producer only publishes a slot after it's written and the consumer only frees
+ * it after it's been read. Packets that arrive while the queue is full are dropped.
+ */
+class ESPNowPacketQueue {
+ public:
+  /// Copy a packet into the queue, called from the receive callback.
+  void push(const uint8_t *address, const uint8_t *data, size_t len);
+  /// The oldest packet or nullptr if the queue is empty, valid until pop().
+  const ESPNowPacket *front() const;
+  void pop();
+  /// The number of packets dropped since the last call.
+  uint32_t take_dropped();
+
+ protected:
+  ESPNowPacket packets_[ESP_NOW_QUEUE_SIZE];
+  /// The next slot to read, only written by the consumer.
+  volatile uint8_t read_at_{0};
+  /// The next slot to write, only written by the producer.
+  volatile uint8_t write_at_{0};
+  /// Only written by the producer, take_dropped() remembers how many it has seen.
+  volatile uint32_t dropped_{0};
+  uint32_t dropped_seen_{0};
+};
+
+template<typename... Ts> class ESPNowSwitchCommandAction;
+template<typename... Ts> class ESPNowLightCommandAction;
+
+/** Exchange states and commands directly with other nodes over ESP-NOW, without a broker or Home Assistant.
+ *
+ * Frames carry the same messages as the native API: one version byte followed by one or more messages framed like on
+ * the API connection (0x00, varint length, varint message type, message). The state changes of the published
+ * entities are collected during a loop() and sent to all peers in as few frames as possible; commands are sent
+ * right away.
+ *
+ * Received states of remote entities are published to local mirror entities (see add_remote_binary_sensor()),
+ * received switch and light commands are performed on the local entity with the same object id. Frames are only
+ * accepted from configured peers.
+ *
+ * ESP-NOW shares the radio with WiFi, all nodes have to be on the same channel (usually the same access point).
+ */
+class ESPNowBridge : public Component, public StoringUpdateListenerController {
+ public:
+  /// Add a peer by its station MAC address, for example 0x240AC4123456.
+  void add_peer(uint64_t address);
+
+#ifdef USE_BINARY_SENSOR
+  /// Send the states of this binary sensor to all peers.
+  void publish_binary_sensor(binary_sensor::BinarySensor *binary_sensor);
+  /// Publish the states a peer sends for the binary sensor with the given object id to a local binary sensor.
+  void add_remote_binary_sensor(const std::string &object_id, binary_sensor::BinarySensor *binary_sensor);
+#endif
+#ifdef USE_SENSOR
+  void publish_sensor(sensor::Sensor *sensor);
+  void add_remote_sensor(const std::string &object_id, sensor::Sensor *sensor);
+#endif
+
+#ifdef USE_SWITCH
+  /// Turn the switch with the given object id on all peers on or off.
+  void send_switch_command(uint32_t key, bool state);
+  template<typename... Ts> ESPNowSwitchCommandAction<Ts...> *make_switch_command_action(const std::string &object_id);
+#endif
+#ifdef USE_LIGHT
+  /// Control the light with the given object id on all peers.
+  void send_light_command(uint32_t key, optional<bool> state, optional<float> brightness,
+                          optional<uint32_t> transition_length);
+  template<typename... Ts> ESPNowLightCommandAction<Ts...> *make_light_command_action(const std::string &object_id);
+#endif
+
+  void setup() override;
+  void loop() override;
+  void dump_config() override;
+  float get_setup_priority() const override;
+
+  /// Queue a received frame for loop(), called from the ESP-NOW receive callback.
+  void on_receive(const uint8_t *address, const uint8_t *data, size_t len);
+
+#ifdef USE_BINARY_SENSOR
+  void on_binary_sensor_update(binary_sensor::BinarySensor *obj, bool state) override;
+#endif
+#ifdef USE_FAN
+  void on_fan_update(fan::FanState *obj) override;
+#endif
+#ifdef USE_LIGHT
+  void on_light_update(light::LightState *obj) override;
+#endif
+#ifdef USE_SENSOR
+  void on_sensor_update(sensor::Sensor *obj, float state) override;
+#endif
+#ifdef USE_SWITCH
+  void on_switch_update(switch_::Switch *obj, bool state) override;
+#endif
+#ifdef USE_TEXT_SENSOR
+  void on_text_sensor_update(text_sensor::TextSensor *obj, const std::string &state) override;
+#endif
+
+ protected:
+  struct RemoteEntity {
+    uint32_t key;
+    EntityType type;
+    Nameable *obj;
+  };
+
+  bool is_published_(Nameable *obj) const;
+  bool is_peer_(uint64_t address) const;
+  /// Clear the message buffer and return an APIBuffer to encode the next message into.
+  APIBuffer get_buffer_();
+  /// Append the encoded message to the frame, sends the frame first if the message doesn't fit.
+  void add_message_(APIMessageType type);
+  void send_packet_();
+  void handle_packet_(const ESPNowPacket &packet);
+  void handle_message_(APIMessageType type, const uint8_t *data, size_t len);
+
+  std::vector<uint64_t> peers_;
+  std::vector<Nameable *> published_;
+  std::vector<RemoteEntity> remote_entities_;
+  ESPNowPacketQueue queue_;
+  std::vector<uint8_t> message_;
+  std::vector<uint8_t> packet_;
+};
+
+extern ESPNowBridge *global_esp_now_bridge;
+
+#ifdef USE_SWITCH
+template<typename... Ts> class ESPNowSwitchCommandAction : public Action<Ts...> {
+ public:
+  ESPNowSwitchCommandAction(ESPNowBridge *parent, uint32_t key) : parent_(parent), key_(key) {}
+
+  TEMPLATABLE_VALUE(bool, state)
+
+  void play(Ts... x) override {
+    this->parent_->send_switch_command(this->key_, this->state_.value(x...));
+    this->play_next(x...);
+  }
+
+ protected:
+  ESPNowBridge *parent_;
+  uint32_t key_;
+};
+
+template<typename... Ts>
+ESPNowSwitchCommandAction<Ts...> *ESPNowBridge::make_switch_command_action(const std::string &object_id) {
+  return new ESPNowSwitchCommandAction<Ts...>(this, fnv1_hash(object_id));
+}
+#endif
+
+#ifdef USE_LIGHT
+template<typename... Ts> class ESPNowLightCommandAction : public Action<Ts...> {
+ public:
+  ESPNowLightCommandAction(ESPNowBridge *parent, uint32_t key) : parent_(parent), key_(key) {}
+
+  TEMPLATABLE_VALUE(bool, state)
+  TEMPLATABLE_VALUE(float, brightness)
+  TEMPLATABLE_VALUE(uint32_t, transition_length)
+
+  void play(Ts... x) override {
+    this->parent_->send_light_command(this->key_, this->state_.optional_value(x...),
+                                      this->brightness_.optional_value(x...),
+                                      this->transition_length_.optional_value(x...));
+    this->play_next(x...);
+  }
+
+ protected:
+  ESPNowBridge *parent_;
+  uint32_t key_;
+};
+
+template<typename... Ts>
+ESPNowLightCommandAction<Ts...> *ESPNowBridge::make_light_command_action(const std::string &object_id) {
+  return new ESPNowLightCommandAction<Ts...>(this, fnv1_hash(object_id));
+}
+#endif
+
+}  // namespace api
+
+ESPHOME_NAMESPACE_END
+
+#endif  // USE_ESP_NOW_BRIDGE
+
+#endif  // ESPHOME_API_ESP_NOW_BRIDGE_H
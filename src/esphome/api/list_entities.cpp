@@ -16,7 +16,7 @@ std::string get_default_unique_id(const std::string &component_type, Nameable *n
 
 #ifdef USE_BINARY_SENSOR
 bool ListEntitiesIterator::on_binary_sensor(binary_sensor::BinarySensor *binary_sensor) {
-  auto buffer = this->client_->get_buffer();
+  auto buffer = this->begin_message_();
   buffer.encode_nameable(binary_sensor);
   // string unique_id = 4;
   buffer.encode_string(4, get_default_unique_id("binary_sensor", binary_sensor));
@@ -24,12 +24,12 @@ bool ListEntitiesIterator::on_binary_sensor(binary_sensor::BinarySensor *binary_
   buffer.encode_string(5, binary_sensor->get_device_class());
   // bool is_status_binary_sensor = 6;
   buffer.encode_bool(6, binary_sensor->is_status_binary_sensor());
-  return this->client_->send_buffer(APIMessageType::LIST_ENTITIES_BINARY_SENSOR_RESPONSE);
+  return this->end_message_(APIMessageType::LIST_ENTITIES_BINARY_SENSOR_RESPONSE);
 }
 #endif
 #ifdef USE_COVER
 bool ListEntitiesIterator::on_cover(cover::Cover *cover) {
-  auto buffer = this->client_->get_buffer();
+  auto buffer = this->begin_message_();
   buffer.encode_nameable(cover);
   // string unique_id = 4;
   buffer.encode_string(4, get_default_unique_id("cover", cover));
@@ -43,12 +43,12 @@ bool ListEntitiesIterator::on_cover(cover::Cover *cover) {
   buffer.encode_bool(7, traits.get_supports_tilt());
   // string device_class = 8;
   buffer.encode_string(8, cover->get_device_class());
-  return this->client_->send_buffer(APIMessageType::LIST_ENTITIES_COVER_RESPONSE);
+  return this->end_message_(APIMessageType::LIST_ENTITIES_COVER_RESPONSE);
 }
 #endif
 #ifdef USE_FAN
 bool ListEntitiesIterator::on_fan(fan::FanState *fan) {
-  auto buffer = this->client_->get_buffer();
+  auto buffer = this->begin_message_();
   buffer.encode_nameable(fan);
   // string unique_id = 4;
   buffer.encode_string(4, get_default_unique_id("fan", fan));
@@ -56,12 +56,12 @@ bool ListEntitiesIterator::on_fan(fan::FanState *fan) {
   buffer.encode_bool(5, fan->get_traits().supports_oscillation());
   // bool supports_speed = 6;
   buffer.encode_bool(6, fan->get_traits().supports_speed());
-  return this->client_->send_buffer(APIMessageType::LIST_ENTITIES_FAN_RESPONSE);
+  return this->end_message_(APIMessageType::LIST_ENTITIES_FAN_RESPONSE);
 }
 #endif
 #ifdef USE_LIGHT
 bool ListEntitiesIterator::on_light(light::LightState *light) {
-  auto buffer = this->client_->get_buffer();
+  auto buffer = this->begin_message_();
   buffer.encode_nameable(light);
   // string unique_id = 4;
   buffer.encode_string(4, get_default_unique_id("light", light));
@@ -84,12 +84,12 @@ bool ListEntitiesIterator::on_light(light::LightState *light) {
       buffer.encode_string(11, effect->get_name());
     }
   }
-  return this->client_->send_buffer(APIMessageType::LIST_ENTITIES_LIGHT_RESPONSE);
+  return this->end_message_(APIMessageType::LIST_ENTITIES_LIGHT_RESPONSE);
 }
 #endif
 #ifdef USE_SENSOR
 bool ListEntitiesIterator::on_sensor(sensor::Sensor *sensor) {
-  auto buffer = this->client_->get_buffer();
+  auto buffer = this->begin_message_();
   buffer.encode_nameable(sensor);
   // string unique_id = 4;
   std::string unique_id = sensor->unique_id();
@@ -102,12 +102,12 @@ bool ListEntitiesIterator::on_sensor(sensor::Sensor *sensor) {
   buffer.encode_string(6, sensor->get_unit_of_measurement());
   // int32 accuracy_decimals = 7;
   buffer.encode_int32(7, sensor->get_accuracy_decimals());
-  return this->client_->send_buffer(APIMessageType::LIST_ENTITIES_SENSOR_RESPONSE);
+  return this->end_message_(APIMessageType::LIST_ENTITIES_SENSOR_RESPONSE);
 }
 #endif
 #ifdef USE_SWITCH
 bool ListEntitiesIterator::on_switch(switch_::Switch *a_switch) {
-  auto buffer = this->client_->get_buffer();
+  auto buffer = this->begin_message_();
   buffer.encode_nameable(a_switch);
   // string unique_id = 4;
   buffer.encode_string(4, get_default_unique_id("switch", a_switch));
@@ -115,12 +115,12 @@ bool ListEntitiesIterator::on_switch(switch_::Switch *a_switch) {
   buffer.encode_string(5, a_switch->get_icon());
   // bool assumed_state = 6;
   buffer.encode_bool(6, a_switch->assumed_state());
-  return this->client_->send_buffer(APIMessageType::LIST_ENTITIES_SWITCH_RESPONSE);
+  return this->end_message_(APIMessageType::LIST_ENTITIES_SWITCH_RESPONSE);
 }
 #endif
 #ifdef USE_TEXT_SENSOR
 bool ListEntitiesIterator::on_text_sensor(text_sensor::TextSensor *text_sensor) {
-  auto buffer = this->client_->get_buffer();
+  auto buffer = this->begin_message_();
   buffer.encode_nameable(text_sensor);
   // string unique_id = 4;
   std::string unique_id = text_sensor->unique_id();
@@ -129,34 +129,48 @@ bool ListEntitiesIterator::on_text_sensor(text_sensor::TextSensor *text_sensor)
   buffer.encode_string(4, unique_id);
   // string icon = 5;
   buffer.encode_string(5, text_sensor->get_icon());
-  return this->client_->send_buffer(APIMessageType::LIST_ENTITIES_TEXT_SENSOR_RESPONSE);
+  return this->end_message_(APIMessageType::LIST_ENTITIES_TEXT_SENSOR_RESPONSE);
 }
 #endif
 
 bool ListEntitiesIterator::on_end() {
-  return this->client_->send_empty_message(APIMessageType::LIST_ENTITIES_DONE_RESPONSE);
+  this->begin_message_();
+  return this->end_message_(APIMessageType::LIST_ENTITIES_DONE_RESPONSE);
+}
+ListEntitiesIterator::ListEntitiesIterator(APIServer *server, std::vector<uint8_t> *cache)
+    : ComponentIterator(server), cache_(cache) {}
+APIBuffer ListEntitiesIterator::begin_message_() {
+  this->message_begin_ = this->cache_->size();
+  this->cache_->resize(this->message_begin_ + API_LIST_ENTITIES_HEADER_SIZE);
+  return APIBuffer(this->cache_);
+}
+bool ListEntitiesIterator::end_message_(APIMessageType type) {
+  const size_t len = this->cache_->size() - this->message_begin_ - API_LIST_ENTITIES_HEADER_SIZE;
+  uint8_t *header = this->cache_->data() + this->message_begin_;
+  header[0] = static_cast<uint8_t>(type);
+  header[1] = len;
+  header[2] = len >> 8;
+  return true;
 }
-ListEntitiesIterator::ListEntitiesIterator(APIServer *server, APIConnection *client)
-    : ComponentIterator(server), client_(client) {}
 bool ListEntitiesIterator::on_service(UserServiceDescriptor *service) {
-  auto buffer = this->client_->get_buffer();
+  auto buffer = this->begin_message_();
   service->encode_list_service_response(buffer);
-  return this->client_->send_buffer(APIMessageType::LIST_ENTITIES_SERVICE_RESPONSE);
+  return this->end_message_(APIMessageType::LIST_ENTITIES_SERVICE_RESPONSE);
 }
 
 #ifdef USE_ESP32_CAMERA
 bool ListEntitiesIterator::on_camera(ESP32Camera *camera) {
-  auto buffer = this->client_->get_buffer();
+  auto buffer = this->begin_message_();
   buffer.encode_nameable(camera);
   // string unique_id = 4;
   buffer.encode_string(4, get_default_unique_id("camera", camera));
-  return this->client_->send_buffer(APIMessageType::LIST_ENTITIES_CAMERA_RESPONSE);
+  return this->end_message_(APIMessageType::LIST_ENTITIES_CAMERA_RESPONSE);
 }
 #endif
 
 #ifdef USE_CLIMATE
 bool ListEntitiesIterator::on_climate(climate::ClimateDevice *climate) {
-  auto buffer = this->client_->get_buffer();
+  auto buffer = this->begin_message_();
   buffer.encode_nameable(climate);
   // string unique_id = 4;
   buffer.encode_string(4, get_default_unique_id("climate", climate));
@@ -181,7 +195,7 @@ bool ListEntitiesIterator::on_climate(climate::ClimateDevice *climate) {
   buffer.encode_float(10, traits.get_visual_temperature_step());
   // bool supports_away = 11;
   buffer.encode_bool(11, traits.get_supports_away());
-  return this->client_->send_buffer(APIMessageType::LIST_ENTITIES_CLIMATE_RESPONSE);
+  return this->end_message_(APIMessageType::LIST_ENTITIES_CLIMATE_RESPONSE);
 }
 #endif
 
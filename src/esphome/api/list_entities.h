@@ -17,11 +17,17 @@ class ListEntitiesRequest : public APIMessage {
   APIMessageType message_type() const override;
 };
 
-class APIConnection;
+/// The size of the header of each message in the list entities cache: the type and the 16 bit length of the body.
+static const size_t API_LIST_ENTITIES_HEADER_SIZE = 3;
 
+/** Encodes the ListEntities*Response messages of all entities (and the done message) into the list entities cache.
+ *
+ * None of the fields change after setup, so the messages are encoded once (see APIServer::get_list_entities())
+ * and each client is sent the cached bodies.
+ */
 class ListEntitiesIterator : public ComponentIterator {
  public:
-  ListEntitiesIterator(APIServer *server, APIConnection *client);
+  ListEntitiesIterator(APIServer *server, std::vector<uint8_t> *cache);
 #ifdef USE_BINARY_SENSOR
   bool on_binary_sensor(binary_sensor::BinarySensor *binary_sensor) override;
 #endif
@@ -53,7 +59,13 @@ class ListEntitiesIterator : public ComponentIterator {
   bool on_end() override;
 
  protected:
-  APIConnection *client_;
+  /// Start a message in the cache, returns the buffer to encode the body with.
+  APIBuffer begin_message_();
+  /// Write the header of the message started with begin_message_().
+  bool end_message_(APIMessageType type);
+
+  std::vector<uint8_t> *cache_;
+  size_t message_begin_{0};
 };
 
 }  // namespace api
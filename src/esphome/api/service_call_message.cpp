@@ -5,6 +5,8 @@
 #include "esphome/api/service_call_message.h"
 #include "esphome/log.h"
 
+#include <cstdio>
+
 ESPHOME_NAMESPACE_BEGIN
 
 namespace api {
@@ -35,7 +37,7 @@ void ServiceCallResponse::encode(APIBuffer &buffer) {
   for (auto &it : this->variables_) {
     auto nested = buffer.begin_nested(4);
     buffer.encode_string(1, it.key);
-    buffer.encode_string(2, it.value());
+    it.encode_value(buffer, 2);
     buffer.end_nested(nested);
   }
 }
@@ -49,6 +51,43 @@ void ServiceCallResponse::set_variables(const std::vector<TemplatableKeyValuePai
 }
 
 KeyValuePair::KeyValuePair(const std::string &key, const std::string &value) : key(key), value(value) {}
+
+void encode_template_value(APIBuffer &buffer, uint32_t field, const std::string &value) {
+  buffer.encode_string(field, value);
+}
+void encode_template_value(APIBuffer &buffer, uint32_t field, const char *value) {
+  buffer.encode_string(field, value);
+}
+void encode_template_value(APIBuffer &buffer, uint32_t field, const String &value) {
+  buffer.encode_string(field, value.c_str(), value.length());
+}
+template<typename T> static void encode_formatted(APIBuffer &buffer, uint32_t field, const char *format, T value) {
+  char buf[64];
+  const int len = snprintf(buf, sizeof(buf), format, value);
+  buffer.encode_string(field, buf, clamp<int>(0, sizeof(buf) - 1, len));
+}
+void encode_template_value(APIBuffer &buffer, uint32_t field, int value) {
+  encode_formatted(buffer, field, "%d", value);
+}
+void encode_template_value(APIBuffer &buffer, uint32_t field, long value) {
+  encode_formatted(buffer, field, "%ld", value);
+}
+void encode_template_value(APIBuffer &buffer, uint32_t field, long long value) {
+  encode_formatted(buffer, field, "%lld", value);
+}
+void encode_template_value(APIBuffer &buffer, uint32_t field, unsigned value) {
+  encode_formatted(buffer, field, "%u", value);
+}
+void encode_template_value(APIBuffer &buffer, uint32_t field, unsigned long value) {
+  encode_formatted(buffer, field, "%lu", value);
+}
+void encode_template_value(APIBuffer &buffer, uint32_t field, unsigned long long value) {
+  encode_formatted(buffer, field, "%llu", value);
+}
+void encode_template_value(APIBuffer &buffer, uint32_t field, double value) {
+  encode_formatted(buffer, field, "%f", value);
+}
+
 }  // namespace api
 
 ESPHOME_NAMESPACE_END
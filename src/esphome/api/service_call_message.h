@@ -26,15 +26,28 @@ class KeyValuePair {
   std::string value;
 };
 
+/// Encode value as the string field of buffer, formatted like to_string() but without a temporary std::string.
+void encode_template_value(APIBuffer &buffer, uint32_t field, const std::string &value);
+void encode_template_value(APIBuffer &buffer, uint32_t field, const char *value);
+void encode_template_value(APIBuffer &buffer, uint32_t field, const String &value);
+void encode_template_value(APIBuffer &buffer, uint32_t field, int value);
+void encode_template_value(APIBuffer &buffer, uint32_t field, long value);
+void encode_template_value(APIBuffer &buffer, uint32_t field, long long value);
+void encode_template_value(APIBuffer &buffer, uint32_t field, unsigned value);
+void encode_template_value(APIBuffer &buffer, uint32_t field, unsigned long value);
+void encode_template_value(APIBuffer &buffer, uint32_t field, unsigned long long value);
+void encode_template_value(APIBuffer &buffer, uint32_t field, double value);
+
 class TemplatableKeyValuePair {
  public:
   template<typename T> TemplatableKeyValuePair(std::string key, T func);
 
   std::string key;
-  std::function<std::string()> value;
+  /// Evaluate the template and encode the result as the string field of buffer.
+  std::function<void(APIBuffer &buffer, uint32_t field)> encode_value;
 };
 template<typename T> TemplatableKeyValuePair::TemplatableKeyValuePair(std::string key, T func) : key(key) {
-  this->value = [func]() -> std::string { return to_string(func()); };
+  this->encode_value = [func](APIBuffer &buffer, uint32_t field) { encode_template_value(buffer, field, func()); };
 }
 
 class ServiceCallResponse : public APIMessage {
@@ -0,0 +1,201 @@
+#include "esphome/defines.h"
+
+#ifdef USE_API_STATE_BROADCAST
+
+#include "esphome/api/state_broadcaster.h"
+#include "esphome/api/subscribe_state.h"
+#include "esphome/log.h"
+#include "esphome/util.h"
+
+#ifdef ARDUINO_ARCH_ESP8266
+#include <ESP8266WiFi.h>
+#endif
+
+ESPHOME_NAMESPACE_BEGIN
+
+namespace api {
+
+static const char *TAG = "api.broadcast";
+
+/// Datagrams are kept below the usual MTU so they aren't fragmented.
+static const size_t STATE_BROADCAST_MAX_PACKET_SIZE = 1400;
+/// Version byte at the start of each datagram.
+static const uint8_t STATE_BROADCAST_VERSION = 0x01;
+
+StateBroadcaster::StateBroadcaster(const IPAddress &address, uint16_t port) : address_(address), port_(port) {}
+
+void StateBroadcaster::setup() {
+  ESP_LOGCONFIG(TAG, "Setting up state broadcast...");
+  this->message_.reserve(64);
+  this->packet_.reserve(STATE_BROADCAST_MAX_PACKET_SIZE);
+  this->subscribe_states_(this);
+  if (this->refresh_interval_ != 0)
+    this->set_interval("refresh", this->refresh_interval_, [this]() { this->refresh_(); });
+}
+void StateBroadcaster::loop() {
+  if (!network_is_connected()) {
+    this->discard_states_();
+    this->packet_.clear();
+  } else {
+    this->process_states_();
+    this->send_packet_();
+  }
+  // enabled again by the state bus on the next change
+  if (!this->has_timed_states_())
+    this->disable_loop();
+}
+void StateBroadcaster::dump_config() {
+  ESP_LOGCONFIG(TAG, "State Broadcast:");
+  ESP_LOGCONFIG(TAG, "  Address: %s:%u", this->address_.toString().c_str(), this->port_);
+  ESP_LOGCONFIG(TAG, "  Refresh Interval: %u ms", this->refresh_interval_);
+}
+float StateBroadcaster::get_setup_priority() const { return setup_priority::WIFI - 1.0f; }
+
+APIBuffer StateBroadcaster::get_buffer_() {
+  this->message_.clear();
+  return APIBuffer(&this->message_);
+}
+void StateBroadcaster::add_message_(APIMessageType type) {
+  // preamble + two varints
+  const size_t needed = this->message_.size() + 11;
+  if (!this->packet_.empty() && this->packet_.size() + needed > STATE_BROADCAST_MAX_PACKET_SIZE)
+    this->send_packet_();
+
+  APIBuffer packet(&this->packet_);
+  if (this->packet_.empty()) {
+    packet.write(STATE_BROADCAST_VERSION);
+    packet.encode_varint_raw(this->sequence_++);
+  }
+  packet.write(0x00);
+  packet.encode_varint_raw(this->message_.size());
+  packet.encode_varint_raw(static_cast<uint32_t>(type));
+  this->packet_.insert(this->packet_.end(), this->message_.begin(), this->message_.end());
+}
+void StateBroadcaster::send_packet_() {
+  if (this->packet_.empty())
+    return;
+
+#ifdef ARDUINO_ARCH_ESP8266
+  bool ok = this->udp_.beginPacketMulticast(this->address_, this->port_, WiFi.localIP(), this->ttl_);
+#else
+  bool ok = this->udp_.beginPacket(this->address_, this->port_);
+#endif
+  if (ok) {
+    this->udp_.write(this->packet_.data(), this->packet_.size());
+    ok = this->udp_.endPacket();
+  }
+  if (!ok) {
+    ESP_LOGW(TAG, "Sending state datagram failed!");
+  }
+  this->packet_.clear();
+}
+void StateBroadcaster::refresh_() {
+  if (!network_is_connected())
+    return;
+
+#ifdef USE_BINARY_SENSOR
+  for (auto *obj : this->binary_sensors_) {
+    if (obj->has_state())
+      this->on_binary_sensor_update(obj, obj->state);
+  }
+#endif
+#ifdef USE_COVER
+  for (auto *obj : this->covers_)
+    this->on_cover_update(obj);
+#endif
+#ifdef USE_FAN
+  for (auto *obj : this->fans_)
+    this->on_fan_update(obj);
+#endif
+#ifdef USE_LIGHT
+  for (auto *obj : this->lights_)
+    this->on_light_update(obj);
+#endif
+#ifdef USE_SENSOR
+  for (auto *obj : this->sensors_) {
+    if (obj->has_state())
+      this->on_sensor_update(obj, obj->state);
+  }
+#endif
+#ifdef USE_SWITCH
+  for (auto *obj : this->switches_)
+    this->on_switch_update(obj, obj->state);
+#endif
+#ifdef USE_TEXT_SENSOR
+  for (auto *obj : this->text_sensors_) {
+    if (obj->has_state())
+      this->on_text_sensor_update(obj, obj->state);
+  }
+#endif
+#ifdef USE_CLIMATE
+  for (auto *obj : this->climates_)
+    this->on_climate_update(obj);
+#endif
+  this->send_packet_();
+}
+
+#ifdef USE_BINARY_SENSOR
+void StateBroadcaster::on_binary_sensor_update(binary_sensor::BinarySensor *obj, bool state) {
+  auto buffer = this->get_buffer_();
+  encode_binary_sensor_state(buffer, obj, state);
+  this->add_message_(APIMessageType::BINARY_SENSOR_STATE_RESPONSE);
+}
+#endif
+#ifdef USE_COVER
+void StateBroadcaster::on_cover_update(cover::Cover *obj) {
+  auto buffer = this->get_buffer_();
+  encode_cover_state(buffer, obj);
+  this->add_message_(APIMessageType::COVER_STATE_RESPONSE);
+}
+#endif
+#ifdef USE_FAN
+void StateBroadcaster::on_fan_update(fan::FanState *obj) {
+  auto buffer = this->get_buffer_();
+  encode_fan_state(buffer, obj);
+  this->add_message_(APIMessageType::FAN_STATE_RESPONSE);
+}
+#endif
+#ifdef USE_LIGHT
+void StateBroadcaster::on_light_update(light::LightState *obj) {
+  auto buffer = this->get_buffer_();
+  encode_light_state(buffer, obj);
+  this->add_message_(APIMessageType::LIGHT_STATE_RESPONSE);
+}
+#endif
+#ifdef USE_SENSOR
+void StateBroadcaster::on_sensor_update(sensor::Sensor *obj, float state) {
+  auto buffer = this->get_buffer_();
+  encode_sensor_state(buffer, obj, state);
+  this->add_message_(APIMessageType::SENSOR_STATE_RESPONSE);
+}
+#endif
+#ifdef USE_SWITCH
+void StateBroadcaster::on_switch_update(switch_::Switch *obj, bool state) {
+  auto buffer = this->get_buffer_();
+  encode_switch_state(buffer, obj, state);
+  this->add_message_(APIMessageType::SWITCH_STATE_RESPONSE);
+}
+#endif
+#ifdef USE_TEXT_SENSOR
+void StateBroadcaster::on_text_sensor_update(text_sensor::TextSensor *obj, const std::string &state) {
+  auto buffer = this->get_buffer_();
+  encode_text_sensor_state(buffer, obj, state);
+  this->add_message_(APIMessageType::TEXT_SENSOR_STATE_RESPONSE);
+}
+#endif
+#ifdef USE_CLIMATE
+void StateBroadcaster::on_climate_update(climate::ClimateDevice *obj) {
+  auto buffer = this->get_buffer_();
+  encode_climate_state(buffer, obj);
+  this->add_message_(APIMessageType::CLIMATE_STATE_RESPONSE);
+}
+#endif
+
+void StateBroadcaster::set_refresh_interval(uint32_t refresh_interval) { this->refresh_interval_ = refresh_interval; }
+void StateBroadcaster::set_ttl(uint8_t ttl) { this->ttl_ = ttl; }
+
+}  // namespace api
+
+ESPHOME_NAMESPACE_END
+
+#endif  // USE_API_STATE_BROADCAST
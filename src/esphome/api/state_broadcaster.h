@@ -0,0 +1,96 @@
+#ifndef ESPHOME_API_STATE_BROADCASTER_H
+#define ESPHOME_API_STATE_BROADCASTER_H
+
+#include "esphome/defines.h"
+
+#ifdef USE_API_STATE_BROADCAST
+
+#include <IPAddress.h>
+#include <WiFiUdp.h>
+#include <vector>
+#include "esphome/component.h"
+#include "esphome/controller.h"
+#include "esphome/api/util.h"
+#include "esphome/api/api_message.h"
+
+ESPHOME_NAMESPACE_BEGIN
+
+namespace api {
+
+/** Broadcast the state changes of all entities over UDP multicast.
+ *
+ * Unlike the API server there are no connections: any number of listeners can join the multicast group and the
+ * cost for the device stays the same. The state changes of one loop() are sent together, each datagram is
+ *
+ *  - the version byte 0x01,
+ *  - a varint sequence number, incremented for each datagram so listeners can detect lost datagrams,
+ *  - one or more *StateResponse messages framed like on the native API connection (0x00, varint length, varint
+ *    message type, message).
+ *
+ * Since datagrams can get lost, all states are additionally broadcast every refresh interval.
+ */
+class StateBroadcaster : public Component, public StoringUpdateListenerController {
+ public:
+  StateBroadcaster(const IPAddress &address, uint16_t port);
+
+  /// Set the interval in ms in which all states are broadcast, 0 to disable. Defaults to 60s.
+  void set_refresh_interval(uint32_t refresh_interval);
+  /// Set how many routers the datagrams may pass (ESP8266 only), defaults to 1.
+  void set_ttl(uint8_t ttl);
+
+  void setup() override;
+  void loop() override;
+  void dump_config() override;
+  float get_setup_priority() const override;
+
+#ifdef USE_BINARY_SENSOR
+  void on_binary_sensor_update(binary_sensor::BinarySensor *obj, bool state) override;
+#endif
+#ifdef USE_COVER
+  void on_cover_update(cover::Cover *obj) override;
+#endif
+#ifdef USE_FAN
+  void on_fan_update(fan::FanState *obj) override;
+#endif
+#ifdef USE_LIGHT
+  void on_light_update(light::LightState *obj) override;
+#endif
+#ifdef USE_SENSOR
+  void on_sensor_update(sensor::Sensor *obj, float state) override;
+#endif
+#ifdef USE_SWITCH
+  void on_switch_update(switch_::Switch *obj, bool state) override;
+#endif
+#ifdef USE_TEXT_SENSOR
+  void on_text_sensor_update(text_sensor::TextSensor *obj, const std::string &state) override;
+#endif
+#ifdef USE_CLIMATE
+  void on_climate_update(climate::ClimateDevice *obj) override;
+#endif
+
+ protected:
+  /// Clear the message buffer and return an APIBuffer to encode the next message into.
+  APIBuffer get_buffer_();
+  /// Append the encoded message to the datagram, sends the datagram first if the message doesn't fit.
+  void add_message_(APIMessageType type);
+  void send_packet_();
+  /// Queue the states of all entities.
+  void refresh_();
+
+  IPAddress address_;
+  uint16_t port_;
+  uint32_t refresh_interval_{60000};
+  uint8_t ttl_{1};
+  WiFiUDP udp_;
+  std::vector<uint8_t> message_;
+  std::vector<uint8_t> packet_;
+  uint32_t sequence_{0};
+};
+
+}  // namespace api
+
+ESPHOME_NAMESPACE_END
+
+#endif  // USE_API_STATE_BROADCAST
+
+#endif  // ESPHOME_API_STATE_BROADCASTER_H
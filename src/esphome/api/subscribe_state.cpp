@@ -9,6 +9,189 @@ ESPHOME_NAMESPACE_BEGIN
 
 namespace api {
 
+#ifdef USE_BINARY_SENSOR
+void encode_binary_sensor_state(APIBuffer &buffer, binary_sensor::BinarySensor *binary_sensor, bool state) {
+  // fixed32 key = 1;
+  buffer.encode_fixed32(1, binary_sensor->get_object_id_hash());
+  // bool state = 2;
+  buffer.encode_bool(2, state);
+}
+#endif
+#ifdef USE_COVER
+void encode_cover_state(APIBuffer &buffer, cover::Cover *cover) {
+  auto traits = cover->get_traits();
+  // fixed32 key = 1;
+  buffer.encode_fixed32(1, cover->get_object_id_hash());
+  // enum LegacyCoverState {
+  //   OPEN = 0;
+  //   CLOSED = 1;
+  // }
+  // LegacyCoverState legacy_state = 2;
+  uint32_t state = (cover->position == cover::COVER_OPEN) ? 0 : 1;
+  buffer.encode_uint32(2, state);
+  // float position = 3;
+  buffer.encode_float(3, cover->position);
+  if (traits.get_supports_tilt()) {
+    // float tilt = 4;
+    buffer.encode_float(4, cover->tilt);
+  }
+  // enum CoverCurrentOperation {
+  //   IDLE = 0;
+  //   IS_OPENING = 1;
+  //   IS_CLOSING = 2;
+  // }
+  // CoverCurrentOperation current_operation = 5;
+  buffer.encode_uint32(5, cover->current_operation);
+}
+#endif
+#ifdef USE_FAN
+void encode_fan_state(APIBuffer &buffer, fan::FanState *fan) {
+  // fixed32 key = 1;
+  buffer.encode_fixed32(1, fan->get_object_id_hash());
+  // bool state = 2;
+  buffer.encode_bool(2, fan->state);
+  // bool oscillating = 3;
+  if (fan->get_traits().supports_oscillation()) {
+    buffer.encode_bool(3, fan->oscillating);
+  }
+  // enum FanSpeed {
+  //   LOW = 0;
+  //   MEDIUM = 1;
+  //   HIGH = 2;
+  // }
+  // FanSpeed speed = 4;
+  if (fan->get_traits().supports_speed()) {
+    buffer.encode_uint32(4, fan->speed);
+  }
+}
+#endif
+#ifdef USE_LIGHT
+void encode_light_state(APIBuffer &buffer, light::LightState *light) {
+  auto traits = light->get_traits();
+  auto values = light->remote_values;
+
+  // fixed32 key = 1;
+  buffer.encode_fixed32(1, light->get_object_id_hash());
+  // bool state = 2;
+  buffer.encode_bool(2, values.get_state() != 0.0f);
+  // float brightness = 3;
+  if (traits.has_brightness()) {
+    buffer.encode_float(3, values.get_brightness());
+  }
+  if (traits.has_rgb()) {
+    // float red = 4;
+    buffer.encode_float(4, values.get_red());
+    // float green = 5;
+    buffer.encode_float(5, values.get_green());
+    // float blue = 6;
+    buffer.encode_float(6, values.get_blue());
+  }
+  // float white = 7;
+  if (traits.has_rgb_white_value()) {
+    buffer.encode_float(7, values.get_white());
+  }
+  // float color_temperature = 8;
+  if (traits.has_color_temperature()) {
+    buffer.encode_float(8, values.get_color_temperature());
+  }
+  // string effect = 9;
+  if (light->supports_effects()) {
+    buffer.encode_string(9, light->get_effect_name());
+  }
+}
+#endif
+#ifdef USE_SENSOR
+void encode_sensor_state(APIBuffer &buffer, sensor::Sensor *sensor, float state) {
+  // fixed32 key = 1;
+  buffer.encode_fixed32(1, sensor->get_object_id_hash());
+  // float state = 2;
+  buffer.encode_float(2, state);
+}
+#endif
+#ifdef USE_SWITCH
+void encode_switch_state(APIBuffer &buffer, switch_::Switch *a_switch, bool state) {
+  // fixed32 key = 1;
+  buffer.encode_fixed32(1, a_switch->get_object_id_hash());
+  // bool state = 2;
+  buffer.encode_bool(2, state);
+}
+#endif
+#ifdef USE_TEXT_SENSOR
+void encode_text_sensor_state(APIBuffer &buffer, text_sensor::TextSensor *text_sensor, const std::string &state) {
+  // fixed32 key = 1;
+  buffer.encode_fixed32(1, text_sensor->get_object_id_hash());
+  // string state = 2;
+  buffer.encode_string(2, state);
+}
+#endif
+#ifdef USE_CLIMATE
+void encode_climate_state(APIBuffer &buffer, climate::ClimateDevice *climate) {
+  auto traits = climate->get_traits();
+  // fixed32 key = 1;
+  buffer.encode_fixed32(1, climate->get_object_id_hash());
+  // ClimateMode mode = 2;
+  buffer.encode_uint32(2, static_cast<uint32_t>(climate->mode));
+  // float current_temperature = 3;
+  if (traits.get_supports_current_temperature()) {
+    buffer.encode_float(3, climate->current_temperature);
+  }
+  if (traits.get_supports_two_point_target_temperature()) {
+    // float target_temperature_low = 5;
+    buffer.encode_float(5, climate->target_temperature_low);
+    // float target_temperature_high = 6;
+    buffer.encode_float(6, climate->target_temperature_high);
+  } else {
+    // float target_temperature = 4;
+    buffer.encode_float(4, climate->target_temperature);
+  }
+  // bool away = 7;
+  if (traits.get_supports_away()) {
+    buffer.encode_bool(7, climate->away);
+  }
+}
+#endif
+
+EntityStateResponse::EntityStateResponse(APIMessageType type) : type_(type) {}
+bool EntityStateResponse::decode_varint(uint32_t field_id, uint32_t value) {
+  switch (field_id) {
+    case 2:
+      // bool state = 2;
+      this->bool_state_ = value;
+      return true;
+    default:
+      return false;
+  }
+}
+bool EntityStateResponse::decode_length_delimited(uint32_t field_id, const uint8_t *value, size_t len) {
+  switch (field_id) {
+    case 2:
+      // string state = 2;
+      this->string_state_ = as_string(value, len);
+      return true;
+    default:
+      return false;
+  }
+}
+bool EntityStateResponse::decode_32bit(uint32_t field_id, uint32_t value) {
+  switch (field_id) {
+    case 1:
+      // fixed32 key = 1;
+      this->key_ = value;
+      return true;
+    case 2:
+      // float state = 2;
+      this->float_state_ = as_float(value);
+      return true;
+    default:
+      return false;
+  }
+}
+APIMessageType EntityStateResponse::message_type() const { return this->type_; }
+uint32_t EntityStateResponse::get_key() const { return this->key_; }
+bool EntityStateResponse::get_bool_state() const { return this->bool_state_; }
+float EntityStateResponse::get_float_state() const { return this->float_state_; }
+const std::string &EntityStateResponse::get_string_state() const { return this->string_state_; }
+
 #ifdef USE_BINARY_SENSOR
 bool InitialStateIterator::on_binary_sensor(binary_sensor::BinarySensor *binary_sensor) {
   if (!binary_sensor->has_state())
@@ -19,6 +19,60 @@ class SubscribeStatesRequest : public APIMessage {
   APIMessageType message_type() const override;
 };
 
+/** Encode the state messages of the native API.
+ *
+ * Shared by APIConnection, StateBroadcaster and the compact binary payload mode of MQTT, see
+ * MQTTClientComponent::set_binary_prefix().
+ */
+#ifdef USE_BINARY_SENSOR
+void encode_binary_sensor_state(APIBuffer &buffer, binary_sensor::BinarySensor *binary_sensor, bool state);
+#endif
+#ifdef USE_COVER
+void encode_cover_state(APIBuffer &buffer, cover::Cover *cover);
+#endif
+#ifdef USE_FAN
+void encode_fan_state(APIBuffer &buffer, fan::FanState *fan);
+#endif
+#ifdef USE_LIGHT
+void encode_light_state(APIBuffer &buffer, light::LightState *light);
+#endif
+#ifdef USE_SENSOR
+void encode_sensor_state(APIBuffer &buffer, sensor::Sensor *sensor, float state);
+#endif
+#ifdef USE_SWITCH
+void encode_switch_state(APIBuffer &buffer, switch_::Switch *a_switch, bool state);
+#endif
+#ifdef USE_TEXT_SENSOR
+void encode_text_sensor_state(APIBuffer &buffer, text_sensor::TextSensor *text_sensor, const std::string &state);
+#endif
+#ifdef USE_CLIMATE
+void encode_climate_state(APIBuffer &buffer, climate::ClimateDevice *climate);
+#endif
+
+/** Decode the key and state of the state messages of binary sensors, sensors and text sensors.
+ *
+ * Used by the components that consume the states of other nodes, see APIClient and ESPNowBridge.
+ */
+class EntityStateResponse : public APIMessage {
+ public:
+  explicit EntityStateResponse(APIMessageType type);
+  bool decode_varint(uint32_t field_id, uint32_t value) override;
+  bool decode_length_delimited(uint32_t field_id, const uint8_t *value, size_t len) override;
+  bool decode_32bit(uint32_t field_id, uint32_t value) override;
+  APIMessageType message_type() const override;
+  uint32_t get_key() const;
+  bool get_bool_state() const;
+  float get_float_state() const;
+  const std::string &get_string_state() const;
+
+ protected:
+  APIMessageType type_;
+  uint32_t key_{0};
+  bool bool_state_{false};
+  float float_state_{0.0f};
+  std::string string_state_;
+};
+
 class APIConnection;
 
 class InitialStateIterator : public ComponentIterator {
@@ -9,10 +9,12 @@ ESPHOME_NAMESPACE_BEGIN
 
 namespace api {
 
-template<> bool ExecuteServiceArgument::get_value<bool>() { return this->value_bool_; }
-template<> int ExecuteServiceArgument::get_value<int>() { return this->value_int_; }
-template<> float ExecuteServiceArgument::get_value<float>() { return this->value_float_; }
-template<> std::string ExecuteServiceArgument::get_value<std::string>() { return this->value_string_; }
+template<> bool ExecuteServiceArgument::get_value<bool>() const { return this->value_bool_; }
+template<> int ExecuteServiceArgument::get_value<int>() const { return this->value_int_; }
+template<> float ExecuteServiceArgument::get_value<float>() const { return this->value_float_; }
+template<> std::string ExecuteServiceArgument::get_value<std::string>() const {
+  return std::string(this->value_string_, this->value_string_len_);
+}
 
 APIMessageType ExecuteServiceArgument::message_type() const { return APIMessageType::EXECUTE_SERVICE_REQUEST; }
 bool ExecuteServiceArgument::decode_varint(uint32_t field_id, uint32_t value) {
@@ -39,7 +41,8 @@ bool ExecuteServiceArgument::decode_32bit(uint32_t field_id, uint32_t value) {
 bool ExecuteServiceArgument::decode_length_delimited(uint32_t field_id, const uint8_t *value, size_t len) {
   switch (field_id) {
     case 4:  // string string_ = 4;
-      this->value_string_ = as_string(value, len);
+      this->value_string_ = reinterpret_cast<const char *>(value);
+      this->value_string_len_ = len;
       return true;
     default:
       return false;
@@ -58,9 +61,10 @@ bool ExecuteServiceRequest::decode_32bit(uint32_t field_id, uint32_t value) {
 bool ExecuteServiceRequest::decode_length_delimited(uint32_t field_id, const uint8_t *value, size_t len) {
   switch (field_id) {
     case 2: {  // repeated ExecuteServiceArgument args = 2;
-      ExecuteServiceArgument arg;
-      arg.decode(value, len);
-      this->args_.push_back(arg);
+      // still count the arguments that don't fit, so that the request doesn't match a service
+      if (this->args_count_ < API_MAX_SERVICE_ARGS)
+        this->args_[this->args_count_].decode(value, len);
+      this->args_count_++;
       return true;
     }
     default:
@@ -68,7 +72,8 @@ bool ExecuteServiceRequest::decode_length_delimited(uint32_t field_id, const uin
   }
 }
 APIMessageType ExecuteServiceRequest::message_type() const { return APIMessageType::EXECUTE_SERVICE_REQUEST; }
-const std::vector<ExecuteServiceArgument> &ExecuteServiceRequest::get_args() const { return this->args_; }
+size_t ExecuteServiceRequest::get_args_count() const { return this->args_count_; }
+const ExecuteServiceArgument &ExecuteServiceRequest::get_arg(size_t index) const { return this->args_[index]; }
 uint32_t ExecuteServiceRequest::get_key() const { return this->key_; }
 
 ServiceTypeArgument::ServiceTypeArgument(const std::string &name, ServiceArgType type) : name_(name), type_(type) {}
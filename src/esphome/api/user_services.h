@@ -30,10 +30,13 @@ class ServiceTypeArgument {
   ServiceArgType type_;
 };
 
+/// The maximum number of arguments of a user service.
+#define API_MAX_SERVICE_ARGS 8
+
 class ExecuteServiceArgument : public APIMessage {
  public:
   APIMessageType message_type() const override;
-  template<typename T> T get_value();
+  template<typename T> T get_value() const;
 
   bool decode_varint(uint32_t field_id, uint32_t value) override;
   bool decode_length_delimited(uint32_t field_id, const uint8_t *value, size_t len) override;
@@ -43,9 +46,16 @@ class ExecuteServiceArgument : public APIMessage {
   bool value_bool_{false};
   int value_int_{0};
   float value_float_{0.0f};
-  std::string value_string_{};
+  /// Points into the received message, only valid while the request is handled.
+  const char *value_string_{nullptr};
+  size_t value_string_len_{0};
 };
 
+/** A request to execute a user service.
+ *
+ * The arguments are decoded into a fixed number of slots, string arguments point into the received message. So a
+ * request can only be used while the message is handled, but decoding it doesn't allocate.
+ */
 class ExecuteServiceRequest : public APIMessage {
  public:
   bool decode_length_delimited(uint32_t field_id, const uint8_t *value, size_t len) override;
@@ -53,11 +63,14 @@ class ExecuteServiceRequest : public APIMessage {
   APIMessageType message_type() const override;
 
   uint32_t get_key() const;
-  const std::vector<ExecuteServiceArgument> &get_args() const;
+  /// The number of arguments in the request, can be more than API_MAX_SERVICE_ARGS (which then weren't decoded).
+  size_t get_args_count() const;
+  const ExecuteServiceArgument &get_arg(size_t index) const;
 
  protected:
   uint32_t key_;
-  std::vector<ExecuteServiceArgument> args_;
+  ExecuteServiceArgument args_[API_MAX_SERVICE_ARGS];
+  size_t args_count_{0};
 };
 
 class UserServiceDescriptor {
@@ -68,6 +81,8 @@ class UserServiceDescriptor {
 };
 
 template<typename... Ts> class UserService : public UserServiceDescriptor, public Trigger<Ts...> {
+  static_assert(sizeof...(Ts) <= API_MAX_SERVICE_ARGS, "User services can have at most API_MAX_SERVICE_ARGS args");
+
  public:
   UserService(const std::string &name, const std::array<ServiceTypeArgument, sizeof...(Ts)> &args);
 
@@ -76,7 +91,7 @@ template<typename... Ts> class UserService : public UserServiceDescriptor, publi
   bool execute_service(const ExecuteServiceRequest &req) override;
 
  protected:
-  template<int... S> void execute_(std::vector<ExecuteServiceArgument> args, seq<S...>);
+  template<int... S> void execute_(const ExecuteServiceRequest &req, seq<S...>);
 
   std::string name_;
   uint32_t key_{0};
@@ -85,8 +100,8 @@ template<typename... Ts> class UserService : public UserServiceDescriptor, publi
 
 template<typename... Ts>
 template<int... S>
-void UserService<Ts...>::execute_(std::vector<ExecuteServiceArgument> args, seq<S...>) {
-  this->trigger((args[S].get_value<Ts>())...);
+void UserService<Ts...>::execute_(const ExecuteServiceRequest &req, seq<S...>) {
+  this->trigger((req.get_arg(S).template get_value<Ts>())...);
 }
 template<typename... Ts> void UserService<Ts...>::encode_list_service_response(APIBuffer &buffer) {
   // string name = 1;
@@ -108,11 +123,11 @@ template<typename... Ts> bool UserService<Ts...>::execute_service(const ExecuteS
   if (req.get_key() != this->key_)
     return false;
 
-  if (req.get_args().size() != this->args_.size()) {
+  if (req.get_args_count() != this->args_.size()) {
     return false;
   }
 
-  this->execute_(req.get_args(), typename gens<sizeof...(Ts)>::type());
+  this->execute_(req, typename gens<sizeof...(Ts)>::type());
   return true;
 }
 template<typename... Ts>
@@ -121,10 +136,10 @@ UserService<Ts...>::UserService(const std::string &name, const std::array<Servic
   this->key_ = fnv1_hash(this->name_);
 }
 
-template<> bool ExecuteServiceArgument::get_value<bool>();
-template<> int ExecuteServiceArgument::get_value<int>();
-template<> float ExecuteServiceArgument::get_value<float>();
-template<> std::string ExecuteServiceArgument::get_value<std::string>();
+template<> bool ExecuteServiceArgument::get_value<bool>() const;
+template<> int ExecuteServiceArgument::get_value<int>() const;
+template<> float ExecuteServiceArgument::get_value<float>() const;
+template<> std::string ExecuteServiceArgument::get_value<std::string>() const;
 
 }  // namespace api
 
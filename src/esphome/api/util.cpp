@@ -21,6 +21,21 @@ void APIBuffer::encode_uint32(uint32_t field, uint32_t value, bool force) {
   this->encode_field_raw(field, 0);
   this->encode_varint_raw(value);
 }
+void APIBuffer::encode_uint64(uint32_t field, uint64_t value, bool force) {
+  if (value == 0 && !force)
+    return;
+
+  this->encode_field_raw(field, 0);
+  do {
+    uint8_t temp = value & 0x7F;
+    value >>= 7;
+    if (value) {
+      this->write(temp | 0x80);
+    } else {
+      this->write(temp);
+    }
+  } while (value);
+}
 void APIBuffer::encode_int32(uint32_t field, int32_t value, bool force) {
   this->encode_uint32(field, static_cast<uint32_t>(value), force);
 }
@@ -34,6 +49,9 @@ void APIBuffer::encode_bool(uint32_t field, bool value, bool force) {
 void APIBuffer::encode_string(uint32_t field, const std::string &value) {
   this->encode_string(field, value.data(), value.size());
 }
+void APIBuffer::encode_string(uint32_t field, const char *string) {
+  this->encode_string(field, string, strlen(string));
+}
 void APIBuffer::encode_bytes(uint32_t field, const uint8_t *data, size_t len) {
   this->encode_string(field, reinterpret_cast<const char *>(data), len);
 }
@@ -44,9 +62,7 @@ void APIBuffer::encode_string(uint32_t field, const char *string, size_t len) {
   this->encode_field_raw(field, 2);
   this->encode_varint_raw(len);
   const uint8_t *data = reinterpret_cast<const uint8_t *>(string);
-  for (size_t i = 0; i < len; i++) {
-    this->write(data[i]);
-  }
+  this->buffer_->insert(this->buffer_->end(), data, data + len);
 }
 void APIBuffer::encode_fixed32(uint32_t field, uint32_t value, bool force) {
   if (value == 0 && !force)
@@ -110,22 +126,15 @@ size_t APIBuffer::begin_nested(uint32_t field) {
 void APIBuffer::end_nested(size_t begin_index) {
   const uint32_t nested_length = this->buffer_->size() - begin_index;
   // add varint
-  std::vector<uint8_t> var;
+  uint8_t var[5];
+  uint8_t var_len = 0;
   uint32_t val = nested_length;
-  if (val <= 0x7F) {
-    var.push_back(val);
-  } else {
-    while (val) {
-      uint8_t temp = val & 0x7F;
-      val >>= 7;
-      if (val) {
-        var.push_back(temp | 0x80);
-      } else {
-        var.push_back(temp);
-      }
-    }
-  }
-  this->buffer_->insert(this->buffer_->begin() + begin_index, var.begin(), var.end());
+  do {
+    uint8_t temp = val & 0x7F;
+    val >>= 7;
+    var[var_len++] = val ? (temp | 0x80) : temp;
+  } while (val);
+  this->buffer_->insert(this->buffer_->begin() + begin_index, var, var + var_len);
 }
 
 optional<uint32_t> proto_decode_varuint32(const uint8_t *buf, size_t len, uint32_t *consumed) {
@@ -176,18 +185,19 @@ void ComponentIterator::begin() {
   this->state_ = IteratorState::BEGIN;
   this->at_ = 0;
 }
-void ComponentIterator::advance() {
+bool ComponentIterator::is_running() const { return this->state_ != IteratorState::NONE; }
+bool ComponentIterator::advance() {
   bool advance_platform = false;
   bool success = true;
   switch (this->state_) {
     case IteratorState::NONE:
       // not started
-      return;
+      return false;
     case IteratorState::BEGIN:
       if (this->on_begin()) {
         advance_platform = true;
       } else {
-        return;
+        return false;
       }
       break;
 #ifdef USE_BINARY_SENSOR
@@ -335,8 +345,9 @@ void ComponentIterator::advance() {
     case IteratorState::MAX:
       if (this->on_end()) {
         this->state_ = IteratorState::NONE;
+        return true;
       }
-      return;
+      return false;
   }
 
   if (advance_platform) {
@@ -344,7 +355,10 @@ void ComponentIterator::advance() {
     this->at_ = 0;
   } else if (success) {
     this->at_++;
+  } else {
+    return false;
   }
+  return true;
 }
 bool ComponentIterator::on_end() { return true; }
 bool ComponentIterator::on_begin() { return true; }
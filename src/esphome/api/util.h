@@ -23,10 +23,12 @@ class APIBuffer {
 
   void encode_int32(uint32_t field, int32_t value, bool force = false);
   void encode_uint32(uint32_t field, uint32_t value, bool force = false);
+  void encode_uint64(uint32_t field, uint64_t value, bool force = false);
   void encode_sint32(uint32_t field, int32_t value, bool force = false);
   void encode_bool(uint32_t field, bool value, bool force = false);
   void encode_string(uint32_t field, const std::string &value);
   void encode_string(uint32_t field, const char *string, size_t len);
+  void encode_string(uint32_t field, const char *string);
   void encode_bytes(uint32_t field, const uint8_t *data, size_t len);
   void encode_fixed32(uint32_t field, uint32_t value, bool force = false);
   void encode_float(uint32_t field, float value, bool force = false);
@@ -56,7 +58,10 @@ class ComponentIterator {
   ComponentIterator(APIServer *server);
 
   void begin();
-  void advance();
+  /// Whether the iterator was started and hasn't reached the end yet.
+  bool is_running() const;
+  /// Process the next entity, returns false if the iterator isn't running or the entity couldn't be sent.
+  bool advance();
   virtual bool on_begin();
 #ifdef USE_BINARY_SENSOR
   virtual bool on_binary_sensor(binary_sensor::BinarySensor *binary_sensor) = 0;
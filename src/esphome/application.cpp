@@ -61,37 +61,132 @@ void Application::setup() {
     return a->get_actual_setup_priority() > b->get_actual_setup_priority();
   });
 
-  for (uint32_t i = 0; i < this->components_.size(); i++) {
-    Component *component = this->components_[i];
-    if (component->is_failed())
+  const uint32_t setup_start = millis();
+  // The components that have been set up, by loop priority, and whether each component has been set up and can
+  // proceed
+  std::vector<Component *> running;
+  std::vector<bool> set_up(this->components_.size(), false);
+  std::vector<bool> ready(this->components_.size(), false);
+  size_t pending = this->components_.size();
+  while (pending != 0) {
+    bool progress = false;
+    bool waiting = false;
+    for (uint32_t i = 0; i < this->components_.size(); i++) {
+      Component *component = this->components_[i];
+      if (!set_up[i]) {
+        Component *blocker = this->get_setup_blocker_(i);
+        if (blocker != nullptr) {
+#ifdef USE_COMPONENT_PROFILER
+          component->setup_blocker = blocker;
+#endif
+          continue;
+        }
+        this->setup_component_(component, setup_start);
+        set_up[i] = true;
+        pending--;
+        progress = true;
+        auto it = std::upper_bound(running.begin(), running.end(), component, [](Component *a, Component *b) {
+          return a->get_loop_priority() > b->get_loop_priority();
+        });
+        running.insert(it, component);
+      }
+      if (!ready[i] && component->is_setup_finished()) {
+        ready[i] = true;
+#ifdef USE_COMPONENT_PROFILER
+        component->setup_ready_ms = millis() - setup_start;
+#endif
+      }
+      waiting |= !ready[i];
+    }
+    if (progress || pending == 0)
       continue;
 
-    component->call_setup();
-    if (component->can_proceed())
+    if (!waiting) {
+      // every component that has been set up can proceed, so the rest waits for each other
+      for (uint32_t i = 0; i < this->components_.size(); i++) {
+        if (set_up[i])
+          continue;
+        ESP_LOGE(TAG, "Component %s has circular setup dependencies, setting it up anyway!",
+                 this->components_[i]->get_component_source());
+        this->setup_component_(this->components_[i], setup_start);
+        set_up[i] = true;
+        pending--;
+        running.push_back(this->components_[i]);
+        break;
+      }
       continue;
+    }
 
-    std::stable_sort(this->components_.begin(), this->components_.begin() + i + 1,
-                     [](Component *a, Component *b) { return a->get_loop_priority() > b->get_loop_priority(); });
-
-    do {
-      uint32_t new_global_state = STATUS_LED_WARNING;
-      for (uint32_t j = 0; j <= i; j++) {
-        if (!this->components_[j]->is_failed()) {
-          this->components_[j]->call_loop();
-        }
-        new_global_state |= this->components_[j]->get_component_state();
-        global_state |= new_global_state;
+    // wait until a component that has been set up can proceed
+#ifdef USE_COMPONENT_PROFILER
+    const uint32_t wait_start = millis();
+#endif
+    uint32_t new_global_state = STATUS_LED_WARNING;
+    this->scheduler.call();
+    for (Component *component : running) {
+      if (!component->is_failed() && component->is_loop_enabled()) {
+        component->call_loop();
       }
-      global_state = new_global_state;
-      yield();
-    } while (!component->can_proceed());
+      new_global_state |= component->get_component_state();
+      global_state |= new_global_state;
+    }
+    global_state = new_global_state;
+    yield();
+#ifdef USE_COMPONENT_PROFILER
+    const uint32_t waited = millis() - wait_start;
+    for (uint32_t i = 0; i < this->components_.size(); i++) {
+      if (!set_up[i])
+        this->components_[i]->setup_wait_ms += waited;
+    }
+#endif
   }
 
+  // loop() runs in the order of the loop priorities
+  std::stable_sort(this->components_.begin(), this->components_.end(),
+                   [](Component *a, Component *b) { return a->get_loop_priority() > b->get_loop_priority(); });
   this->application_state_ = COMPONENT_STATE_SETUP;
+  // drop the warning shown while setting up
+  global_state_dirty = true;
+  // the objects of the configuration are created, further ones come from the heap
+  global_setup_arena.close();
 
-  ESP_LOGI(TAG, "setup() finished successfully!");
+  ESP_LOGI(TAG, "setup() finished successfully after %u ms!", millis() - setup_start);
   this->dump_config();
 }
+Component *Application::get_setup_blocker_(uint32_t index) {
+  Component *component = this->components_[index];
+  if (component->has_explicit_setup_dependencies()) {
+    for (Component *dependency : component->get_setup_dependencies()) {
+      if (!dependency->is_setup_finished())
+        return dependency;
+    }
+    return nullptr;
+  }
+  // without declared dependencies, wait for all components with a higher setup priority
+  for (uint32_t i = 0; i < index; i++) {
+    if (!this->components_[i]->is_setup_finished())
+      return this->components_[i];
+  }
+  return nullptr;
+}
+void Application::setup_component_(Component *component, uint32_t setup_start) {
+  if (component->is_failed())
+    return;
+  if (component->is_setup_skipped()) {
+    ESP_LOGV(TAG, "Skipping setup of %s", component->get_component_source());
+    component->disable_loop();
+    return;
+  }
+
+#ifdef USE_COMPONENT_PROFILER
+  component->setup_start_ms = millis() - setup_start;
+  const uint32_t start = micros();
+  component->call_setup();
+  component->setup_time_us = micros() - start;
+#else
+  component->call_setup();
+#endif
+}
 
 void Application::dump_config() {
   if (this->compilation_time_.empty()) {
@@ -103,8 +198,93 @@ void Application::dump_config() {
   for (auto component : this->components_) {
     component->dump_config();
   }
+
+#ifdef USE_COMPONENT_PROFILER
+  this->dump_component_stats();
+#endif
 }
 void Application::schedule_dump_config() { this->dump_config_scheduled_ = true; }
+const std::vector<Component *> &Application::get_components() const { return this->components_; }
+#ifdef USE_COMPONENT_PROFILER
+static void dump_timing_stats(const char *name, const ComponentTimingStats &stats) {
+  if (stats.count == 0)
+    return;
+  ESP_LOGCONFIG(TAG, "    %s: count=%u avg=%uus max=%uus total=%ums", name, stats.count,
+                uint32_t(stats.total_us / stats.count), stats.max_us, uint32_t(stats.total_us / 1000));
+}
+void Application::dump_component_stats() {
+  ESP_LOGCONFIG(TAG, "Component Timing Statistics:");
+  for (uint32_t i = 0; i < this->components_.size(); i++) {
+    Component *component = this->components_[i];
+    ESP_LOGCONFIG(TAG, "  Component %u (%s): setup=%uus started=%ums waited=%ums ready=%ums", i,
+                  component->get_component_source(), component->setup_time_us, component->setup_start_ms,
+                  component->setup_wait_ms, component->setup_ready_ms);
+    dump_timing_stats("Loop", component->loop_stats);
+    dump_timing_stats("Time Functions", component->scheduler_stats);
+#ifdef USE_HEAP_TRACER
+    const ComponentHeapStats &heap = component->heap_stats;
+    if (heap.allocated != 0 || heap.freed != 0)
+      ESP_LOGCONFIG(TAG, "    Heap: allocated=%u freed=%u retained=%d max=%u", heap.allocated, heap.freed,
+                    heap.get_retained(), heap.max_allocation);
+#endif
+  }
+  if (this->loop_budget_ != 0) {
+    ESP_LOGCONFIG(TAG, "Loop Budget: %uus overruns=%u deferred=%u", this->loop_budget_, this->loop_budget_overruns_,
+                  this->loop_budget_deferred_);
+  }
+  this->dump_setup_critical_path_();
+}
+void Application::dump_setup_critical_path_() {
+  // the component that was ready last determined the boot time, follow what it waited for
+  Component *component = nullptr;
+  for (Component *c : this->components_) {
+    if (component == nullptr || c->setup_ready_ms > component->setup_ready_ms)
+      component = c;
+  }
+  if (component == nullptr)
+    return;
+  ESP_LOGCONFIG(TAG, "Setup Critical Path (%ums):", component->setup_ready_ms);
+  for (uint32_t depth = 0; component != nullptr && depth < this->components_.size(); depth++) {
+    ESP_LOGCONFIG(TAG, "  %s: started=%ums setup=%uus ready=%ums", component->get_component_source(),
+                  component->setup_start_ms, component->setup_time_us, component->setup_ready_ms);
+    component = component->setup_blocker;
+  }
+}
+void Application::reset_component_stats() {
+  this->loop_budget_overruns_ = 0;
+  this->loop_budget_deferred_ = 0;
+  for (Component *component : this->components_) {
+    component->loop_stats.reset();
+    component->scheduler_stats.reset();
+#ifdef USE_HEAP_TRACER
+    component->heap_stats.reset();
+#endif
+  }
+#ifdef USE_I2C
+  for (I2CComponent *bus : i2c_buses)
+    bus->reset_device_stats();
+#endif
+}
+#endif
+void Application::schedule_looping_components_update() { this->looping_components_dirty_ = true; }
+bool Application::submit_work(std::function<void()> &&work, std::function<void()> &&on_done) {
+  return this->worker_pool_.submit(std::move(work), std::move(on_done));
+}
+void Application::calculate_looping_components_() {
+  this->looping_components_.clear();
+  for (Component *component : this->components_) {
+    if (component->is_loop_enabled() && !component->is_failed())
+      this->looping_components_.push_back(component);
+  }
+  // sorted by loop priority, so the components that always run come first
+  this->always_looping_count_ = 0;
+  while (this->always_looping_count_ < this->looping_components_.size() &&
+         this->looping_components_[this->always_looping_count_]->get_loop_priority() >= this->loop_budget_priority_)
+    this->always_looping_count_++;
+  this->looping_components_dirty_ = false;
+  ESP_LOGV(TAG, "%u of %u components have their loop() enabled.", this->looping_components_.size(),
+           this->components_.size());
+}
 
 void HOT Application::loop() {
   bool first_loop = this->application_state_ == COMPONENT_STATE_SETUP;
@@ -113,25 +293,66 @@ void HOT Application::loop() {
     this->application_state_ = COMPONENT_STATE_LOOP;
   }
 
-  uint32_t new_global_state = 0;
-  for (Component *component : this->components_) {
-    if (!component->is_failed()) {
-      component->call_loop();
+  if (this->looping_components_dirty_)
+    this->calculate_looping_components_();
+
+  const uint32_t loop_start = micros();
+#ifdef USE_LOOP_MONITOR
+  this->slowest_loop_component_ = nullptr;
+  this->slowest_loop_us_ = 0;
+  if (this->loop_monitor_ != nullptr)
+    this->loop_monitor_->enter("<time functions>");
+#endif
+  this->mailbox.process();
+  this->scheduler.call();
+  const uint32_t looping_count = this->looping_components_.size();
+  for (uint32_t i = 0; i < this->always_looping_count_; i++) {
+    this->call_component_loop_(this->looping_components_[i]);
+  }
+  bool budget_exhausted = false;
+  const uint32_t budgeted_count = looping_count - this->always_looping_count_;
+  for (uint32_t i = 0; i < budgeted_count; i++) {
+    const uint32_t index = (this->loop_cursor_ + i) % budgeted_count;
+    // at least one component makes progress each iteration
+    if (this->loop_budget_ != 0 && i != 0 && micros() - loop_start >= this->loop_budget_) {
+      this->loop_cursor_ = index;
+      budget_exhausted = true;
+#ifdef USE_COMPONENT_PROFILER
+      this->loop_budget_overruns_++;
+      this->loop_budget_deferred_ += budgeted_count - i;
+#endif
+      break;
     }
-    new_global_state |= component->get_component_state();
-    global_state |= new_global_state;
-    feed_wdt();
+    this->call_component_loop_(this->looping_components_[this->always_looping_count_ + index]);
+  }
+#ifdef USE_LOOP_MONITOR
+  if (this->loop_monitor_ != nullptr) {
+    this->loop_monitor_->enter(nullptr);
+    this->loop_monitor_->record_loop(micros() - loop_start, this->slowest_loop_component_, this->slowest_loop_us_);
+  }
+#endif
+  // setting a status bit sets it in global_state right away, only clearing one needs a pass over all components
+  if (global_state_dirty) {
+    global_state_dirty = false;
+    uint32_t new_global_state = 0;
+    for (Component *component : this->components_)
+      new_global_state |= component->get_component_state();
+    global_state = new_global_state;
   }
-  global_state = new_global_state;
+  global_preferences.loop();
 
   const uint32_t now = millis();
-  if (HighFrequencyLoopRequester::is_high_frequency()) {
+  if (HighFrequencyLoopRequester::is_high_frequency() || budget_exhausted) {
     yield();
   } else {
     uint32_t delay_time = this->loop_interval_;
     if (now - this->last_loop_ < this->loop_interval_)
       delay_time = this->loop_interval_ - (now - this->last_loop_);
-    delay(delay_time);
+    if (this->max_idle_time_ > delay_time) {
+      idle_sleep(std::max(delay_time, this->calculate_idle_time_()));
+    } else {
+      delay(delay_time);
+    }
   }
   this->last_loop_ = now;
 
@@ -145,6 +366,33 @@ void HOT Application::loop() {
   }
 }
 
+void HOT Application::call_component_loop_(Component *component) {
+  if (!component->is_failed()) {
+    TRACE_SCOPE(LOOP, component->get_component_source());
+#if defined(USE_COMPONENT_PROFILER) || defined(USE_LOOP_MONITOR)
+#ifdef USE_LOOP_MONITOR
+    if (this->loop_monitor_ != nullptr)
+      this->loop_monitor_->enter(component->get_component_source());
+#endif
+    const uint32_t loop_start = micros();
+    component->call_loop();
+    const uint32_t loop_time = micros() - loop_start;
+#ifdef USE_COMPONENT_PROFILER
+    component->loop_stats.record(loop_time);
+#endif
+#ifdef USE_LOOP_MONITOR
+    if (loop_time > this->slowest_loop_us_) {
+      this->slowest_loop_component_ = component;
+      this->slowest_loop_us_ = loop_time;
+    }
+#endif
+#else
+    component->call_loop();
+#endif
+  }
+  feed_wdt();
+}
+
 WiFiComponent *Application::init_wifi(const std::string &ssid, const std::string &password) {
   WiFiComponent *wifi = this->init_wifi();
   WiFiAP ap;
@@ -209,6 +457,7 @@ PowerSupplyComponent *Application::make_power_supply(const GPIOOutputPin &pin, u
 
 #ifdef USE_BINARY_SENSOR
 void Application::register_binary_sensor(binary_sensor::BinarySensor *binary_sensor) {
+  binary_sensor->add_on_state_callback(this->state_bus_.register_entity(binary_sensor, ENTITY_BINARY_SENSOR));
   for (auto *controller : this->controllers_)
     controller->register_binary_sensor(binary_sensor);
 #ifdef USE_MQTT_BINARY_SENSOR
@@ -244,6 +493,7 @@ DHTComponent *Application::make_dht_sensor(const std::string &temperature_friend
 
 #ifdef USE_SENSOR
 void Application::register_sensor(sensor::Sensor *sensor) {
+  sensor->add_on_state_callback(this->state_bus_.register_entity(sensor, ENTITY_SENSOR));
   for (auto *controller : this->controllers_)
     controller->register_sensor(sensor);
 #ifdef USE_MQTT_SENSOR
@@ -313,6 +563,7 @@ Application::MakeLight Application::make_cwww_light(const std::string &friendly_
 
 #ifdef USE_LIGHT
 void Application::register_light(LightState *state) {
+  state->add_new_remote_values_callback(this->state_bus_.register_entity(state, ENTITY_LIGHT));
   for (auto *controller : this->controllers_)
     controller->register_light(state);
 #ifdef USE_MQTT_LIGHT
@@ -362,6 +613,7 @@ MQTTClientComponent *Application::get_mqtt_client() const { return this->mqtt_cl
 
 #ifdef USE_SWITCH
 void Application::register_switch(switch_::Switch *a_switch) {
+  a_switch->add_on_state_callback(this->state_bus_.register_entity(a_switch, ENTITY_SWITCH));
   for (auto *controller : this->controllers_)
     controller->register_switch(a_switch);
 #ifdef USE_MQTT_SWITCH
@@ -387,6 +639,7 @@ switch_::GPIOSwitch *Application::make_gpio_switch(const std::string &friendly_n
 #endif
 
 const std::string &Application::get_name() const { return this->name_; }
+EntityStateBus &Application::get_state_bus() { return this->state_bus_; }
 
 #ifdef USE_FAN
 Application::MakeFan Application::make_fan(const std::string &friendly_name) {
@@ -424,6 +677,13 @@ sensor::ADCSensorComponent *Application::make_adc_sensor(const std::string &frie
 }
 #endif
 
+#ifdef USE_SPECTRUM_ANALYZER
+sensor::SpectrumAnalyzerComponent *Application::make_spectrum_analyzer(sensor::ADCSensorComponent *source,
+                                                                       uint16_t fft_size) {
+  return this->register_component(new SpectrumAnalyzerComponent(source, fft_size));
+}
+#endif
+
 #ifdef USE_ULTRASONIC_SENSOR
 sensor::UltrasonicSensorComponent *Application::make_ultrasonic_sensor(const std::string &friendly_name,
                                                                        const GPIOOutputPin &trigger_pin,
@@ -534,11 +794,32 @@ sensor::HDC1080Component *Application::make_hdc1080_sensor(const std::string &te
 #endif
 
 #ifdef USE_DEBUG_COMPONENT
-DebugComponent *Application::make_debug_component() { return this->register_component(new DebugComponent()); }
+DebugComponent *Application::make_debug_component(uint32_t update_interval) {
+  return this->register_component(new DebugComponent(update_interval));
+}
+#endif
+
+#ifdef USE_LOOP_MONITOR
+LoopMonitorComponent *Application::make_loop_monitor(uint32_t update_interval) {
+  return this->loop_monitor_ = this->register_component(new LoopMonitorComponent(update_interval));
+}
+#endif
+
+#ifdef USE_METRICS
+MetricsComponent *Application::make_metrics(uint32_t update_interval) {
+  return this->register_component(new MetricsComponent(update_interval));
+}
+#endif
+
+#ifdef USE_BENCHMARK_COMPONENT
+BenchmarkComponent *Application::make_benchmark_component() {
+  return this->register_component(new BenchmarkComponent());
+}
 #endif
 
 #ifdef USE_FAN
 void Application::register_fan(fan::FanState *state) {
+  state->add_on_state_callback(this->state_bus_.register_entity(state, ENTITY_FAN));
   for (auto *controller : this->controllers_)
     controller->register_fan(state);
 #ifdef USE_MQTT_FAN
@@ -683,6 +964,18 @@ Application::MakeFastLEDLight Application::make_fast_led_light(const std::string
 }
 #endif
 
+#ifdef USE_I2S_PARALLEL_LIGHT
+Application::MakeI2SParallelLight Application::make_i2s_parallel_light(const std::string &name) {
+  auto *output = this->register_component(new I2SParallelLightOutput());
+  auto make = this->make_light_for_light_output(name, output);
+
+  return MakeI2SParallelLight{
+      .output = output,
+      .state = make.state,
+  };
+}
+#endif
+
 #ifdef USE_DHT12_SENSOR
 sensor::DHT12Component *Application::make_dht12_sensor(const std::string &temperature_name,
                                                        const std::string &humidity_name, uint32_t update_interval) {
@@ -751,6 +1044,7 @@ switch_::TemplateSwitch *Application::make_template_switch(const std::string &na
 
 #ifdef USE_COVER
 void Application::register_cover(cover::Cover *cover) {
+  cover->add_on_state_callback(this->state_bus_.register_entity(cover, ENTITY_COVER));
   for (auto *controller : this->controllers_)
     controller->register_cover(cover);
 #ifdef USE_MQTT_COVER
@@ -790,6 +1084,23 @@ sensor::ESP32HallSensor *Application::make_esp32_hall_sensor(const std::string &
 }
 #endif
 
+#ifdef USE_ESP32_ULP_SENSOR
+sensor::ESP32ULPSensor *Application::make_esp32_ulp_adc_sensor(const std::string &name, uint8_t pin,
+                                                               uint32_t sample_interval) {
+  GPIOInputPin input_pin(pin);
+  auto *ulp = this->register_component(new ESP32ULPSensor(name, input_pin.copy(), ESP32_ULP_MODE_ADC, sample_interval));
+  this->register_sensor(ulp);
+  return ulp;
+}
+sensor::ESP32ULPSensor *Application::make_esp32_ulp_pulse_counter(const std::string &name, const GPIOInputPin &pin,
+                                                                  uint32_t sample_interval) {
+  auto *ulp = this->register_component(
+      new ESP32ULPSensor(name, pin.copy(), ESP32_ULP_MODE_PULSE_COUNTER, sample_interval));
+  this->register_sensor(ulp);
+  return ulp;
+}
+#endif
+
 #ifdef USE_ESP32_BLE_BEACON
 ESP32BLEBeacon *Application::make_esp32_ble_beacon(const std::array<uint8_t, 16> &uuid) {
   return this->register_component(new ESP32BLEBeacon(uuid));
@@ -850,6 +1161,14 @@ sensor::UptimeSensor *Application::make_uptime_sensor(const std::string &name, u
 }
 #endif
 
+#ifdef USE_I2C_BUS_SENSOR
+sensor::I2CBusSensor *Application::make_i2c_bus_sensor(const std::string &name, uint32_t update_interval) {
+  auto *bus = this->register_component(new I2CBusSensor(name, this->i2c_, update_interval));
+  this->register_sensor(bus);
+  return bus;
+}
+#endif
+
 #ifdef USE_INA219
 sensor::INA219Component *Application::make_ina219(float shunt_resistance_ohm, float max_current_a, float max_voltage_v,
                                                   uint8_t address, uint32_t update_interval) {
@@ -1003,6 +1322,7 @@ display::Nextion *Application::make_nextion(UARTComponent *parent, uint32_t upda
 
 #ifdef USE_TEXT_SENSOR
 void Application::register_text_sensor(text_sensor::TextSensor *sensor) {
+  sensor->add_on_state_callback(this->state_bus_.register_entity(sensor, ENTITY_TEXT_SENSOR));
   for (auto *controller : this->controllers_)
     controller->register_text_sensor(sensor);
 #ifdef USE_MQTT_TEXT_SENSOR
@@ -1101,7 +1421,38 @@ sensor::TotalDailyEnergy *Application::make_total_daily_energy_sensor(const std:
 }
 #endif
 
+#ifdef USE_SENSOR_HISTORY
+sensor::SensorHistory *Application::make_sensor_history(sensor::Sensor *sensor, time::RealTimeClockComponent *time) {
+  return this->register_component(new SensorHistory(sensor, time));
+}
+#endif
+
+#ifdef USE_SENSOR_DUTY_CYCLE
+sensor::SensorDutyCycle *Application::make_sensor_duty_cycle(uint32_t update_interval) {
+  return this->register_component(new SensorDutyCycle(update_interval));
+}
+#endif
+
 void Application::set_loop_interval(uint32_t loop_interval) { this->loop_interval_ = loop_interval; }
+void Application::set_idle_mode(uint32_t max_idle_time) { this->max_idle_time_ = max_idle_time; }
+void Application::set_loop_budget(uint32_t loop_budget) { this->loop_budget_ = loop_budget; }
+void Application::set_loop_budget_priority(float loop_budget_priority) {
+  this->loop_budget_priority_ = loop_budget_priority;
+  this->looping_components_dirty_ = true;
+}
+uint32_t HOT Application::calculate_idle_time_() {
+  uint32_t idle_time = this->max_idle_time_;
+  auto next_schedule = this->scheduler.next_schedule_in();
+  if (next_schedule.has_value())
+    idle_time = std::min(idle_time, *next_schedule);
+
+  for (Component *component : this->looping_components_) {
+    if (idle_time == 0)
+      break;
+    idle_time = std::min(idle_time, component->get_loop_idle_time());
+  }
+  return idle_time;
+}
 
 void Application::register_component_(Component *comp) {
   if (comp == nullptr) {
@@ -1116,6 +1467,7 @@ void Application::register_component_(Component *comp) {
     }
   }
   this->components_.push_back(comp);
+  this->looping_components_dirty_ = true;
 }
 
 #ifdef USE_API
@@ -1127,6 +1479,26 @@ api::APIServer *Application::init_api_server() {
 }
 #endif
 
+#ifdef USE_API_STATE_BROADCAST
+api::StateBroadcaster *Application::make_api_state_broadcaster(const IPAddress &address, uint16_t port) {
+  auto *broadcaster = this->register_component(new api::StateBroadcaster(address, port));
+  return this->register_controller(broadcaster);
+}
+#endif
+
+#ifdef USE_ESP_NOW_BRIDGE
+api::ESPNowBridge *Application::make_esp_now_bridge() {
+  auto *bridge = this->register_component(new api::ESPNowBridge());
+  return this->register_controller(bridge);
+}
+#endif
+
+#ifdef USE_API_CLIENT
+api::APIClient *Application::make_api_client(const std::string &address, uint16_t port) {
+  return this->register_component(new api::APIClient(address, port));
+}
+#endif
+
 #ifdef USE_CUSTOM_BINARY_SENSOR
 binary_sensor::CustomBinarySensorConstructor *Application::make_custom_binary_sensor(
     const std::function<std::vector<BinarySensor *>()> &init) {
@@ -1172,6 +1544,12 @@ stepper::ULN2003 *Application::make_uln2003(const GPIOOutputPin &pin_a, const GP
 }
 #endif
 
+#ifdef USE_STEPPER_MOTION_PLANNER
+stepper::StepperMotionPlanner *Application::make_stepper_motion_planner() {
+  return this->register_component(new StepperMotionPlanner());
+}
+#endif
+
 #ifdef USE_LIGHT
 Application::MakePartitionLight Application::make_partition_light(
     const std::string &name, const std::vector<light::AddressableSegment> &segments) {
@@ -1199,6 +1577,7 @@ sensor::SDS011Component *Application::make_sds011(UARTComponent *parent) {
 
 #ifdef USE_CLIMATE
 void Application::register_climate(climate::ClimateDevice *climate) {
+  climate->add_on_state_callback(this->state_bus_.register_entity(climate, ENTITY_CLIMATE));
   for (auto *controller : this->controllers_)
     controller->register_climate(climate);
 #ifdef USE_MQTT_CLIMATE
@@ -4,9 +4,14 @@
 #include <vector>
 #include "esphome/defines.h"
 #include "esphome/api/api_server.h"
+#include "esphome/api/state_broadcaster.h"
+#include "esphome/api/esp_now_bridge.h"
+#include "esphome/api/api_client.h"
 #include "esphome/automation.h"
+#include "esphome/benchmark_component.h"
 #include "esphome/component.h"
 #include "esphome/controller.h"
+#include "esphome/coroutine.h"
 #include "esphome/custom_component.h"
 #include "esphome/debug_component.h"
 #include "esphome/deep_sleep_component.h"
@@ -15,18 +20,24 @@
 #include "esphome/esp_one_wire.h"
 #include "esphome/esphal.h"
 #include "esphome/esppreferences.h"
+#include "esphome/mailbox.h"
 #include "esphome/ethernet_component.h"
 #include "esphome/i2c_component.h"
 #include "esphome/log.h"
 #include "esphome/log_component.h"
+#include "esphome/loop_monitor.h"
+#include "esphome/metrics.h"
 #include "esphome/ota_component.h"
 #include "esphome/power_supply_component.h"
+#include "esphome/scheduler.h"
 #include "esphome/servo.h"
 #include "esphome/spi_component.h"
 #include "esphome/status_led.h"
+#include "esphome/tracer.h"
 #include "esphome/uart_component.h"
 #include "esphome/web_server.h"
 #include "esphome/wifi_component.h"
+#include "esphome/worker_pool.h"
 #include "esphome/binary_sensor/binary_sensor.h"
 #include "esphome/binary_sensor/custom_binary_sensor.h"
 #include "esphome/binary_sensor/esp32_touch_binary_sensor.h"
@@ -41,6 +52,7 @@
 #include "esphome/binary_sensor/mpr121_sensor.h"
 #include "esphome/binary_sensor/ttp229_lsf_sensor.h"
 #include "esphome/climate/bang_bang_climate.h"
+#include "esphome/climate/pid_climate.h"
 #include "esphome/climate/climate_device.h"
 #include "esphome/climate/mqtt_climate_component.h"
 #include "esphome/cover/cover.h"
@@ -49,6 +61,7 @@
 #include "esphome/cover/mqtt_cover_component.h"
 #include "esphome/cover/template_cover.h"
 #include "esphome/display/display.h"
+#include "esphome/display/pixel_format.h"
 #include "esphome/display/lcd_display.h"
 #include "esphome/display/max7219.h"
 #include "esphome/display/nextion.h"
@@ -61,9 +74,11 @@
 #include "esphome/io/pcf8574_component.h"
 #include "esphome/light/addressable_light_effect.h"
 #include "esphome/light/fast_led_light_output.h"
+#include "esphome/light/i2s_parallel_light_output.h"
 #include "esphome/light/light_color_values.h"
 #include "esphome/light/light_effect.h"
 #include "esphome/light/light_output_component.h"
+#include "esphome/light/light_scene.h"
 #include "esphome/light/light_state.h"
 #include "esphome/light/mqtt_json_light_component.h"
 #include "esphome/light/neo_pixel_bus_light_output.h"
@@ -105,13 +120,16 @@
 #include "esphome/sensor/dht_component.h"
 #include "esphome/sensor/duty_cycle_sensor.h"
 #include "esphome/sensor/esp32_hall_sensor.h"
+#include "esphome/sensor/esp32_ulp_sensor.h"
 #include "esphome/sensor/filter.h"
+#include "esphome/sensor/filter_pipeline.h"
 #include "esphome/sensor/hdc1080_component.h"
 #include "esphome/sensor/hlw8012.h"
 #include "esphome/sensor/hmc5883l.h"
 #include "esphome/sensor/homeassistant_sensor.h"
 #include "esphome/sensor/htu21d_component.h"
 #include "esphome/sensor/hx711.h"
+#include "esphome/sensor/i2c_bus_sensor.h"
 #include "esphome/sensor/ina219.h"
 #include "esphome/sensor/ina3221.h"
 #include "esphome/sensor/max31855_sensor.h"
@@ -126,15 +144,19 @@
 #include "esphome/sensor/rotary_encoder.h"
 #include "esphome/sensor/sensor.h"
 #include "esphome/sensor/sht3xd_component.h"
+#include "esphome/sensor/spectrum_analyzer.h"
 #include "esphome/sensor/tcs34725.h"
 #include "esphome/sensor/template_sensor.h"
 #include "esphome/sensor/total_daily_energy.h"
+#include "esphome/sensor/sensor_history.h"
+#include "esphome/sensor/sensor_duty_cycle.h"
 #include "esphome/sensor/tsl2561_sensor.h"
 #include "esphome/sensor/ultrasonic_sensor.h"
 #include "esphome/sensor/uptime_sensor.h"
 #include "esphome/sensor/wifi_signal_sensor.h"
 #include "esphome/sensor/sds011_component.h"
 #include "esphome/stepper/a4988.h"
+#include "esphome/stepper/motion_planner.h"
 #include "esphome/stepper/stepper.h"
 #include "esphome/stepper/uln2003.h"
 #include "esphome/switch_/custom_switch.h"
@@ -267,6 +289,29 @@ class Application {
   api::APIServer *init_api_server();
 #endif
 
+#ifdef USE_API_STATE_BROADCAST
+  /** Broadcast the states of all entities to a UDP multicast group.
+   *
+   * @param address The multicast group, for example 239.255.60.54.
+   * @param port The UDP port.
+   */
+  api::StateBroadcaster *make_api_state_broadcaster(const IPAddress &address, uint16_t port = 6054);
+#endif
+
+#ifdef USE_ESP_NOW_BRIDGE
+  /// Exchange states and commands with other nodes over ESP-NOW, see api::ESPNowBridge.
+  api::ESPNowBridge *make_esp_now_bridge();
+#endif
+
+#ifdef USE_API_CLIENT
+  /** Connect to the native API of another node to mirror its entities, see api::APIClient.
+   *
+   * The mirror entities created by the client have to be registered like other entities, for example with
+   * register_sensor().
+   */
+  api::APIClient *make_api_client(const std::string &address, uint16_t port = 6053);
+#endif
+
 #ifdef USE_ESP32_BLE_TRACKER
   /** Setup an ESP32 BLE Tracker Hub.
    *
@@ -507,6 +552,17 @@ class Application {
                                               uint32_t update_interval = 60000);
 #endif
 
+#ifdef USE_SPECTRUM_ANALYZER
+  /** Create a spectrum analyzer for the bursts of an ADC sensor.
+   *
+   * @param source The ADC sensor, set it up for burst sampling with fft_size samples per burst.
+   * @param fft_size The number of samples per FFT, a power of two from 64 to 1024.
+   * @return The analyzer, use this to create band sensors.
+   */
+  sensor::SpectrumAnalyzerComponent *make_spectrum_analyzer(sensor::ADCSensorComponent *source,
+                                                            uint16_t fft_size = 512);
+#endif
+
 #ifdef USE_ADS1115_SENSOR
   /** Create an ADS1115 component hub. From this hub you can then create individual sensors using `get_sensor()`.
    *
@@ -730,6 +786,26 @@ class Application {
   sensor::ESP32HallSensor *make_esp32_hall_sensor(const std::string &name, uint32_t update_interval = 60000);
 #endif
 
+#ifdef USE_ESP32_ULP_SENSOR
+  /** Sample an ADC1 pin with the ULP coprocessor while the node is in deep sleep.
+   *
+   * @param name The name of the sensor.
+   * @param pin The ADC1 pin (GPIO32-GPIO39).
+   * @param sample_interval The interval in ms the ULP samples the pin at.
+   */
+  sensor::ESP32ULPSensor *make_esp32_ulp_adc_sensor(const std::string &name, uint8_t pin,
+                                                    uint32_t sample_interval = 1000);
+
+  /** Count the pulses on an RTC GPIO with the ULP coprocessor while the node is in deep sleep.
+   *
+   * @param name The name of the sensor.
+   * @param pin The RTC GPIO to count the rising edges of.
+   * @param sample_interval The interval in ms the ULP polls the pin at, pulses must be at least this long.
+   */
+  sensor::ESP32ULPSensor *make_esp32_ulp_pulse_counter(const std::string &name, const GPIOInputPin &pin,
+                                                       uint32_t sample_interval = 5);
+#endif
+
 #ifdef USE_DUTY_CYCLE_SENSOR
   sensor::DutyCycleSensor *make_duty_cycle_sensor(const std::string &name, const GPIOInputPin &pin,
                                                   uint32_t update_interval = 60000);
@@ -744,6 +820,11 @@ class Application {
   sensor::UptimeSensor *make_uptime_sensor(const std::string &name, uint32_t update_interval = 60000);
 #endif
 
+#ifdef USE_I2C_BUS_SENSOR
+  /// Create a debug sensor for the utilization of the (first) i2c bus in percent.
+  sensor::I2CBusSensor *make_i2c_bus_sensor(const std::string &name, uint32_t update_interval = 60000);
+#endif
+
 #ifdef USE_INA219
   sensor::INA219Component *make_ina219(float shunt_resistance_ohm, float max_current_a, float max_voltage_v,
                                        uint8_t address = 0x40, uint32_t update_interval = 60000);
@@ -826,6 +907,23 @@ class Application {
                                                            sensor::Sensor *parent);
 #endif
 
+#ifdef USE_SENSOR_HISTORY
+  /** Keep the history of a sensor in memory, with downsampled minute and quarter hour tiers.
+   *
+   * @param sensor The sensor to record.
+   * @param time The time source for the timestamps, nullptr to use the uptime.
+   */
+  sensor::SensorHistory *make_sensor_history(sensor::Sensor *sensor, time::RealTimeClockComponent *time = nullptr);
+#endif
+
+#ifdef USE_SENSOR_DUTY_CYCLE
+  /** Run a sensor only for a short time each update interval, see for example PMSX003Component::set_duty_cycle().
+   *
+   * @param update_interval The interval in ms between two cycles.
+   */
+  sensor::SensorDutyCycle *make_sensor_duty_cycle(uint32_t update_interval = 300000);
+#endif
+
 #ifdef USE_APDS9960
   sensor::APDS9960 *make_apds9960(uint32_t update_interval = 60000);
 #endif
@@ -891,8 +989,7 @@ class Application {
 #ifdef USE_ESP8266_PWM_OUTPUT
   /** Create an ESP8266 software PWM channel.
    *
-   * Warning: This is a *software* PWM and therefore can have noticeable flickering. Additionally,
-   * this software PWM can't output values higher than 80%.
+   * Warning: This is a *software* PWM and can have some jitter. All channels share one frequency.
    *
    * @param pin The pin for this PWM output, supported pins are 0-16.
    * @return The PWM output channel, use this for advanced settings and using it with lights.
@@ -984,6 +1081,16 @@ class Application {
   MakeFastLEDLight make_fast_led_light(const std::string &name);
 #endif
 
+#ifdef USE_I2S_PARALLEL_LIGHT
+  struct MakeI2SParallelLight {
+    light::I2SParallelLightOutput *output;
+    light::LightState *state;
+  };
+
+  /// Create a light driving up to 16 strips in parallel with the I2S peripheral of the ESP32.
+  MakeI2SParallelLight make_i2s_parallel_light(const std::string &name);
+#endif
+
 #ifdef USE_NEO_PIXEL_BUS_LIGHT
   template<typename T_METHOD, typename T_COLOR_FEATURE> struct MakeNeoPixelBusLight {
     light::NeoPixelBusLightOutputBase<T_METHOD, T_COLOR_FEATURE> *output;
@@ -1103,6 +1210,10 @@ class Application {
                                  const GPIOOutputPin &pin_d);
 #endif
 
+#ifdef USE_STEPPER_MOTION_PLANNER
+  stepper::StepperMotionPlanner *make_stepper_motion_planner();
+#endif
+
 #ifdef USE_CLIMATE
   void register_climate(climate::ClimateDevice *climate);
 #endif
@@ -1114,7 +1225,22 @@ class Application {
    *  |_| |_|_____|_____|_|   |_____|_| \_|____/
    */
 #ifdef USE_DEBUG_COMPONENT
-  DebugComponent *make_debug_component();
+  DebugComponent *make_debug_component(uint32_t update_interval = 60000);
+#endif
+
+#ifdef USE_BENCHMARK_COMPONENT
+  /// Create a component that times workloads on the device, see BenchmarkComponent.
+  BenchmarkComponent *make_benchmark_component();
+#endif
+
+#ifdef USE_LOOP_MONITOR
+  /// Create a component that watches the loop time against thresholds, see LoopMonitorComponent.
+  LoopMonitorComponent *make_loop_monitor(uint32_t update_interval = 60000);
+#endif
+
+#ifdef USE_METRICS
+  /// Create a component that registers the core metrics and publishes all metrics to MQTT, see MetricsComponent.
+  MetricsComponent *make_metrics(uint32_t update_interval = 60000);
 #endif
 
 #ifdef USE_DEEP_SLEEP
@@ -1147,7 +1273,11 @@ class Application {
 
   template<class C> C *register_controller(C *c);
 
-  /// Set up all the registered components. Call this at the end of your setup() function.
+  /** Set up all the registered components. Call this at the end of your setup() function.
+   *
+   * Components are set up in the order of their setup priority, each one once the components it depends on
+   * can proceed (see Component::add_setup_dependency()). While waiting, the components set up so far are looped.
+   */
   void setup();
 
   /// Make a loop iteration. Call this in your loop() function.
@@ -1161,6 +1291,9 @@ class Application {
   /// Get the name of this Application set by set_name().
   const std::string &get_name() const;
 
+  /// Get the bus all entity state changes go through.
+  EntityStateBus &get_state_bus();
+
   bool is_fully_setup() const;
 
   /** Tell ESPHome when your project was last compiled. This is used to show
@@ -1193,14 +1326,92 @@ class Application {
    */
   void set_loop_interval(uint32_t loop_interval);
 
+  /** Enable idle mode to reduce power consumption and wasted CPU time.
+   *
+   * Normally the loop() calls are run every loop interval. In idle mode, the loop instead sleeps until the
+   * next time function of the scheduler is due or until a component needs its loop() called again
+   * (see Component::get_loop_idle_time()), whichever comes first. The sleep is never shorter than the loop
+   * interval and can be ended early by interrupts using wake_loop().
+   *
+   * Components with an enabled loop() that don't state an idle time want loop() at the regular interval, so
+   * the loop only sleeps longer if all of them do. The core components (WiFi, logger, OTA and the native API)
+   * and the polling components that only work in update() state one.
+   *
+   * While sleeping, the chip can enter automatic light sleep if the SDK is configured for it.
+   *
+   * @param max_idle_time The maximum time in ms a single loop may sleep, 0 to disable idle mode (default).
+   */
+  void set_idle_mode(uint32_t max_idle_time);
+
+  /** Limit how long the loop() calls of a single loop iteration may take.
+   *
+   * Components with a loop priority of at least the budget priority (see set_loop_budget_priority()) always have
+   * their loop() called. The other components are called round-robin until the budget is used up, the next
+   * iteration resumes with the first component that was skipped and starts right away instead of waiting for the
+   * loop interval. So a single slow component can't hold up the rest of the loop for long.
+   *
+   * @param loop_budget The budget in µs, 0 to always call all components (default).
+   */
+  void set_loop_budget(uint32_t loop_budget);
+
+  /// Set the loop priority from which components always run regardless of the loop budget, defaults to 1.0.
+  void set_loop_budget_priority(float loop_budget_priority);
+
   void dump_config();
   void schedule_dump_config();
 
+  /// Get all registered components, after setup() sorted by loop priority.
+  const std::vector<Component *> &get_components() const;
+
+#ifdef USE_COMPONENT_PROFILER
+  /// Log the setup, loop and time function timing statistics of all components.
+  void dump_component_stats();
+
+  /// Reset the loop and time function timing statistics of all components.
+  void reset_component_stats();
+#endif
+
+  /// Rebuild the list of components with an enabled loop() at the start of the next loop.
+  void schedule_looping_components_update();
+
+  /** Run CPU-heavy work off the main loop and call on_done from the main loop once it has finished.
+   *
+   * On the ESP32 the work runs on a pool of worker tasks, on the ESP8266 it runs right away. See WorkerPool.
+   *
+   * @return Whether the work was accepted, false if the worker queues are full.
+   */
+  bool submit_work(std::function<void()> &&work, std::function<void()> &&on_done = nullptr);
+
+  /// The scheduler running the timeout/interval/defer functions of all components.
+  Scheduler scheduler;
+  /// Hands states and callbacks from other tasks and ISRs to the main loop.
+  MainLoopMailbox mailbox;
+
  protected:
+  WorkerPool worker_pool_{&this->mailbox};
   void register_component_(Component *comp);
 
+  /// The component the setup of the component at the given index waits for, nullptr if it can be set up.
+  Component *get_setup_blocker_(uint32_t index);
+  void setup_component_(Component *component, uint32_t setup_start);
+#ifdef USE_COMPONENT_PROFILER
+  /// Log the chain of components that determined how long setup took.
+  void dump_setup_critical_path_();
+#endif
+
+  /// Calculate how long the loop may sleep in idle mode.
+  uint32_t calculate_idle_time_();
+
+  void calculate_looping_components_();
+  /// Call the loop() of the component and record its timing.
+  void call_component_loop_(Component *component);
+
   std::vector<Component *> components_{};
+  /// The components that have their loop() enabled, in loop priority order.
+  std::vector<Component *> looping_components_{};
+  bool looping_components_dirty_{true};
   std::vector<Controller *> controllers_{};
+  EntityStateBus state_bus_;
 #ifdef USE_MQTT
   mqtt::MQTTClientComponent *mqtt_client_{nullptr};
 #endif
@@ -1211,6 +1422,25 @@ class Application {
   uint32_t application_state_{COMPONENT_STATE_CONSTRUCTION};
   uint32_t last_loop_{0};
   uint32_t loop_interval_{16};
+  uint32_t max_idle_time_{0};
+  uint32_t loop_budget_{0};
+  float loop_budget_priority_{1.0f};
+  /// The number of looping components at the start of looping_components_ that run regardless of the budget.
+  uint32_t always_looping_count_{0};
+  /// The index among the other looping components the next iteration starts with.
+  uint32_t loop_cursor_{0};
+#ifdef USE_LOOP_MONITOR
+  LoopMonitorComponent *loop_monitor_{nullptr};
+  /// The component with the slowest loop() in the current iteration.
+  Component *slowest_loop_component_{nullptr};
+  uint32_t slowest_loop_us_{0};
+#endif
+#ifdef USE_COMPONENT_PROFILER
+  /// The loop iterations that used up the loop budget.
+  uint32_t loop_budget_overruns_{0};
+  /// The loop() calls deferred to a later iteration because the budget was used up.
+  uint32_t loop_budget_deferred_{0};
+#endif
 #ifdef USE_I2C
   I2CComponent *i2c_{nullptr};
 #endif
@@ -1,8 +1,11 @@
 #include "esphome/automation.h"
 #include "esphome/espmath.h"
+#include "esphome/log.h"
 
 ESPHOME_NAMESPACE_BEGIN
 
+static const char *TAG = "automation";
+
 void StartupTrigger::setup() { this->trigger(); }
 float StartupTrigger::get_setup_priority() const {
   // Run after everything is set up
@@ -19,6 +22,7 @@ float LoopTrigger::get_setup_priority() const { return setup_priority::HARDWARE_
 
 void IntervalTrigger::update() { this->trigger(); }
 float IntervalTrigger::get_setup_priority() const { return setup_priority::HARDWARE_LATE; }
+uint32_t IntervalTrigger::get_loop_idle_time() { return SCHEDULER_DONT_RUN; }
 
 IntervalTrigger::IntervalTrigger(uint32_t update_interval) : PollingComponent(update_interval) {}
 
@@ -36,7 +40,60 @@ bool RangeCondition::check(float x) {
   }
 }
 
-void Script::execute() { this->trigger(); }
-void Script::stop() { this->parent_->stop(); }
+void Script::execute() {
+  if (this->parent_ == nullptr)
+    return;
+  if (!this->has_end_action_) {
+    // all actions have been added by the time the script is first executed, the last one tracks that a run is done
+    this->parent_->add_action(new LambdaAction<>([this]() { this->finish_run_(); }));
+    this->has_end_action_ = true;
+  }
+
+  if (this->running_ != 0) {
+    switch (this->mode_) {
+      case SCRIPT_MODE_SINGLE:
+        ESP_LOGD(TAG, "Script is already running, not executing it again.");
+        return;
+      case SCRIPT_MODE_RESTART:
+        ESP_LOGD(TAG, "Script is already running, restarting it.");
+        this->stop();
+        break;
+      case SCRIPT_MODE_QUEUED:
+        if (this->max_runs_ != 0 && this->running_ + this->queued_ >= this->max_runs_) {
+          ESP_LOGW(TAG, "Script queue is full, dropping the execution!");
+          return;
+        }
+        this->queued_++;
+        return;
+      case SCRIPT_MODE_PARALLEL:
+        if (this->max_runs_ != 0 && this->running_ >= this->max_runs_) {
+          ESP_LOGW(TAG, "Script is already running %u times, dropping the execution!", this->running_);
+          return;
+        }
+        break;
+    }
+  }
+
+  this->running_++;
+  this->trigger();
+}
+void Script::stop() {
+  this->running_ = 0;
+  this->queued_ = 0;
+  if (this->parent_ != nullptr)
+    this->parent_->stop();
+}
+void Script::set_mode(ScriptMode mode) { this->mode_ = mode; }
+void Script::set_max_runs(uint32_t max_runs) { this->max_runs_ = max_runs; }
+bool Script::is_running() const { return this->running_ != 0; }
+void Script::finish_run_() {
+  if (this->running_ != 0)
+    this->running_--;
+  if (this->running_ == 0 && this->queued_ != 0) {
+    this->queued_--;
+    this->running_++;
+    this->trigger();
+  }
+}
 
 ESPHOME_NAMESPACE_END
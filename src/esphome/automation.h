@@ -19,10 +19,16 @@ ESPHOME_NAMESPACE_BEGIN
 
 #define TEMPLATABLE_VALUE(type, name) TEMPLATABLE_VALUE_(type, name)
 
-template<typename... Ts> class Condition {
+template<typename... Ts> class Condition : public SetupAllocated {
  public:
   virtual bool check(Ts... x) = 0;
 
+  /** Register a callback for whenever the result of check() might have changed.
+   *
+   * @return Whether the condition supports this, if not it has to be polled.
+   */
+  virtual bool add_on_change_callback(std::function<void()> &&callback);
+
   bool check_tuple(const std::tuple<Ts...> &tuple);
 
  protected:
@@ -33,6 +39,7 @@ template<typename... Ts> class AndCondition : public Condition<Ts...> {
  public:
   explicit AndCondition(const std::vector<Condition<Ts...> *> &conditions);
   bool check(Ts... x) override;
+  bool add_on_change_callback(std::function<void()> &&callback) override;
 
  protected:
   std::vector<Condition<Ts...> *> conditions_;
@@ -42,6 +49,7 @@ template<typename... Ts> class OrCondition : public Condition<Ts...> {
  public:
   explicit OrCondition(const std::vector<Condition<Ts...> *> &conditions);
   bool check(Ts... x) override;
+  bool add_on_change_callback(std::function<void()> &&callback) override;
 
  protected:
   std::vector<Condition<Ts...> *> conditions_;
@@ -71,7 +79,7 @@ class RangeCondition : public Condition<float> {
 
 template<typename... Ts> class Automation;
 
-template<typename... Ts> class Trigger {
+template<typename... Ts> class Trigger : public SetupAllocated {
  public:
   void trigger(Ts... x);
   void set_parent(Automation<Ts...> *parent);
@@ -106,6 +114,7 @@ class IntervalTrigger : public Trigger<>, public PollingComponent {
  public:
   IntervalTrigger(uint32_t update_interval);
   void update() override;
+  uint32_t get_loop_idle_time() override;
   float get_setup_priority() const override;
 };
 
@@ -114,20 +123,48 @@ template<typename... Ts> class ScriptStopAction;
 
 template<typename... Ts> class ScriptStopAction;
 
+/// What a script does when it's executed while it's still running.
+enum ScriptMode {
+  /// Start another run next to the running ones (up to max_runs). The default.
+  SCRIPT_MODE_PARALLEL = 0,
+  /// Ignore the execution.
+  SCRIPT_MODE_SINGLE,
+  /// Stop the running run and start over.
+  SCRIPT_MODE_RESTART,
+  /// Start the run once the running one is done, keeping up to max_runs (including the running one) queued.
+  SCRIPT_MODE_QUEUED,
+};
+
 class Script : public Trigger<> {
  public:
   void execute();
 
   void stop();
 
+  void set_mode(ScriptMode mode);
+  /// The maximum number of parallel or queued runs, 0 (the default) means no limit.
+  void set_max_runs(uint32_t max_runs);
+  /// Whether a run of this script hasn't finished yet.
+  bool is_running() const;
+
   template<typename... Ts> ScriptExecuteAction<Ts...> *make_execute_action();
 
   template<typename... Ts> ScriptStopAction<Ts...> *make_stop_action();
+
+ protected:
+  /// Called by the last action of each run.
+  void finish_run_();
+
+  ScriptMode mode_{SCRIPT_MODE_PARALLEL};
+  uint32_t max_runs_{0};
+  uint32_t running_{0};
+  uint32_t queued_{0};
+  bool has_end_action_{false};
 };
 
 template<typename... Ts> class ActionList;
 
-template<typename... Ts> class Action {
+template<typename... Ts> class Action : public SetupAllocated {
  public:
   virtual void play(Ts... x) = 0;
   void play_next(Ts... x);
@@ -144,6 +181,11 @@ template<typename... Ts> class Action {
   Action<Ts...> *next_ = nullptr;
 };
 
+/** Continue with the next action after a delay.
+ *
+ * Each play stores its arguments in a pending slot (several plays can be waiting at once), the slots are kept
+ * between plays so that starting a delay doesn't allocate. The loop only runs while plays are pending.
+ */
 template<typename... Ts> class DelayAction : public Action<Ts...>, public Component {
  public:
   explicit DelayAction();
@@ -152,10 +194,24 @@ template<typename... Ts> class DelayAction : public Action<Ts...>, public Compon
   void stop() override;
 
   void play(Ts... x) override;
+  void setup() override;
+  /// Continue the pending plays whose delay is over.
+  void loop() override;
   float get_setup_priority() const override;
 
  protected:
+  struct Pending {
+    uint32_t start;
+    uint32_t delay;
+    std::tuple<typename std::decay<Ts>::type...> x;
+  };
+
+  template<int... S> void play_next_pending_(const Pending &pending, seq<S...>);
+
   TemplatableValue<uint32_t, Ts...> delay_{0};
+  std::vector<Pending> pending_;
+  /// The number of slots at the front of pending_ in use, the others are kept for the next plays.
+  size_t pending_count_{0};
 };
 
 template<typename... Ts> class LambdaAction : public Action<Ts...> {
@@ -201,20 +257,36 @@ template<typename... Ts> class WhileAction : public Action<Ts...> {
   bool is_running_{false};
 };
 
+/** Wait until all conditions are true, then continue with the next action.
+ *
+ * If all conditions can notify about changes, they're only checked when something changed. Otherwise
+ * they're checked each loop while waiting.
+ */
 template<typename... Ts> class WaitUntilAction : public Action<Ts...>, public Component {
  public:
   WaitUntilAction(const std::vector<Condition<Ts...> *> &conditions);
 
+  /// Continue anyway after waiting this long (in ms), defaults to waiting forever.
+  void set_wait_timeout(uint32_t wait_timeout);
+
   void play(Ts... x) override;
 
   void stop() override;
 
+  void setup() override;
+
   void loop() override;
 
   float get_setup_priority() const override;
 
  protected:
+  /// Continue if all conditions are true.
+  void check_();
+  void continue_();
+
   std::vector<Condition<Ts...> *> conditions_;
+  uint32_t wait_timeout_{0};
+  bool event_driven_{false};
   bool triggered_{false};
   std::tuple<Ts...> var_{};
 };
@@ -261,7 +333,7 @@ template<typename... Ts> class ActionList {
   Action<Ts...> *actions_end_{nullptr};
 };
 
-template<typename... Ts> class Automation {
+template<typename... Ts> class Automation : public SetupAllocated {
  public:
   explicit Automation(Trigger<Ts...> *trigger);
 
@@ -11,6 +11,22 @@ bool Condition<Ts...>::check_tuple_(const std::tuple<Ts...> &tuple, seq<S...>) {
   return this->check(std::get<S>(tuple)...);
 }
 
+template<typename... Ts> bool Condition<Ts...>::add_on_change_callback(std::function<void()> &&callback) {
+  return false;
+}
+
+/// Register the callback with all conditions, returns whether all of them support it.
+template<typename... Ts>
+bool add_on_change_callbacks(const std::vector<Condition<Ts...> *> &conditions, const std::function<void()> &callback) {
+  bool ret = true;
+  for (auto *condition : conditions) {
+    std::function<void()> copy = callback;
+    if (!condition->add_on_change_callback(std::move(copy)))
+      ret = false;
+  }
+  return ret;
+}
+
 template<typename... Ts> bool AndCondition<Ts...>::check(Ts... x) {
   for (auto *condition : this->conditions_) {
     if (!condition->check(x...))
@@ -22,6 +38,9 @@ template<typename... Ts> bool AndCondition<Ts...>::check(Ts... x) {
 
 template<typename... Ts>
 AndCondition<Ts...>::AndCondition(const std::vector<Condition<Ts...> *> &conditions) : conditions_(conditions) {}
+template<typename... Ts> bool AndCondition<Ts...>::add_on_change_callback(std::function<void()> &&callback) {
+  return add_on_change_callbacks(this->conditions_, callback);
+}
 
 template<typename... Ts> bool OrCondition<Ts...>::check(Ts... x) {
   for (auto *condition : this->conditions_) {
@@ -34,6 +53,9 @@ template<typename... Ts> bool OrCondition<Ts...>::check(Ts... x) {
 
 template<typename... Ts>
 OrCondition<Ts...>::OrCondition(const std::vector<Condition<Ts...> *> &conditions) : conditions_(conditions) {}
+template<typename... Ts> bool OrCondition<Ts...>::add_on_change_callback(std::function<void()> &&callback) {
+  return add_on_change_callbacks(this->conditions_, callback);
+}
 template<typename... Ts> void Trigger<Ts...>::set_parent(Automation<Ts...> *parent) { this->parent_ = parent; }
 
 template<typename... Ts> void Trigger<Ts...>::trigger(Ts... x) {
@@ -70,12 +92,46 @@ void Action<Ts...>::play_next_tuple_(const std::tuple<Ts...> &tuple, seq<S...>)
 template<typename... Ts> DelayAction<Ts...>::DelayAction() = default;
 
 template<typename... Ts> void DelayAction<Ts...>::play(Ts... x) {
-  auto f = std::bind(&DelayAction<Ts...>::play_next, this, x...);
-  this->set_timeout(this->delay_.value(x...), f);
+  if (this->pending_count_ == this->pending_.size())
+    this->pending_.push_back(Pending{0, 0, std::make_tuple(x...)});
+  else
+    this->pending_[this->pending_count_].x = std::make_tuple(x...);
+  Pending &pending = this->pending_[this->pending_count_++];
+  pending.start = millis();
+  pending.delay = this->delay_.value(x...);
+  this->enable_loop();
+}
+template<typename... Ts> void DelayAction<Ts...>::setup() {
+  if (this->pending_count_ == 0)
+    this->disable_loop();
+}
+template<typename... Ts> void DelayAction<Ts...>::loop() {
+  const uint32_t now = millis();
+  size_t i = 0;
+  while (i < this->pending_count_) {
+    if (now - this->pending_[i].start < this->pending_[i].delay) {
+      i++;
+      continue;
+    }
+    // free the slot before continuing, the next actions might start this delay again
+    Pending pending = std::move(this->pending_[i]);
+    for (size_t j = i + 1; j < this->pending_count_; j++)
+      std::swap(this->pending_[j - 1], this->pending_[j]);
+    this->pending_count_--;
+    this->play_next_pending_(pending, typename gens<sizeof...(Ts)>::type());
+  }
+  if (this->pending_count_ == 0)
+    this->disable_loop();
+}
+template<typename... Ts>
+template<int... S>
+void DelayAction<Ts...>::play_next_pending_(const Pending &pending, seq<S...>) {
+  this->play_next(std::get<S>(pending.x)...);
 }
 template<typename... Ts> float DelayAction<Ts...>::get_setup_priority() const { return setup_priority::HARDWARE; }
 template<typename... Ts> void DelayAction<Ts...>::stop() {
-  this->cancel_timeout("");
+  this->pending_count_ = 0;
+  this->disable_loop();
   this->stop_next();
 }
 
@@ -92,7 +148,7 @@ template<typename... Ts> Automation<Ts...>::Automation(Trigger<Ts...> *trigger)
   this->trigger_->set_parent(this);
 }
 template<typename... Ts> Action<Ts...> *Automation<Ts...>::add_action(Action<Ts...> *action) {
-  this->actions_.add_action(action);
+  return this->actions_.add_action(action);
 }
 template<typename... Ts> void Automation<Ts...>::add_actions(const std::vector<Action<Ts...> *> &actions) {
   this->actions_.add_actions(actions);
@@ -186,7 +242,7 @@ UpdateComponentAction<Ts...>::UpdateComponentAction(PollingComponent *component)
 template<typename... Ts> ScriptExecuteAction<Ts...>::ScriptExecuteAction(Script *script) : script_(script) {}
 
 template<typename... Ts> void ScriptExecuteAction<Ts...>::play(Ts... x) {
-  this->script_->trigger();
+  this->script_->execute();
   this->play_next(x...);
 }
 
@@ -264,25 +320,50 @@ template<typename... Ts> void WhileAction<Ts...>::stop() {
 
 template<typename... Ts>
 WaitUntilAction<Ts...>::WaitUntilAction(const std::vector<Condition<Ts...> *> &conditions) : conditions_(conditions) {}
+template<typename... Ts> void WaitUntilAction<Ts...>::set_wait_timeout(uint32_t wait_timeout) {
+  this->wait_timeout_ = wait_timeout;
+}
+template<typename... Ts> void WaitUntilAction<Ts...>::setup() {
+  this->event_driven_ = add_on_change_callbacks(this->conditions_, [this]() { this->check_(); });
+  if (!this->triggered_)
+    this->disable_loop();
+}
 template<typename... Ts> void WaitUntilAction<Ts...>::play(Ts... x) {
   this->var_ = std::make_tuple(x...);
   this->triggered_ = true;
-  this->loop();
+  if (this->wait_timeout_ != 0)
+    this->set_timeout("wait_timeout", this->wait_timeout_, [this]() { this->continue_(); });
+  this->check_();
+  if (this->triggered_ && !this->event_driven_)
+    this->enable_loop();
 }
 template<typename... Ts> void WaitUntilAction<Ts...>::stop() {
   this->triggered_ = false;
+  this->cancel_timeout("wait_timeout");
   this->stop_next();
 }
 template<typename... Ts> void WaitUntilAction<Ts...>::loop() {
+  // the loop only polls the conditions while waiting for ones that can't notify about changes
+  if (!this->triggered_ || this->event_driven_) {
+    this->disable_loop();
+    return;
+  }
+  this->check_();
+}
+template<typename... Ts> void WaitUntilAction<Ts...>::check_() {
   if (!this->triggered_)
     return;
-
   for (auto *condition : this->conditions_) {
     if (!condition->check_tuple(this->var_)) {
       return;
     }
   }
-
+  this->cancel_timeout("wait_timeout");
+  this->continue_();
+}
+template<typename... Ts> void WaitUntilAction<Ts...>::continue_() {
+  if (!this->triggered_)
+    return;
   this->triggered_ = false;
   this->play_next_tuple(this->var_);
 }
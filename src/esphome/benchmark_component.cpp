@@ -0,0 +1,139 @@
+#include "esphome/defines.h"
+
+#ifdef USE_BENCHMARK_COMPONENT
+
+#include "esphome/benchmark_component.h"
+#include "esphome/log.h"
+#include "esphome/helpers.h"
+#include "esphome/sensor/filter.h"
+#ifdef USE_API
+#include "esphome/api/subscribe_state.h"
+#endif
+
+ESPHOME_NAMESPACE_BEGIN
+
+static const char *TAG = "benchmark";
+
+void BenchmarkComponent::add_workload(const std::string &name, uint32_t iterations, std::function<void()> &&f,
+                                      sensor::Sensor *cycles_sensor) {
+  this->workloads_.push_back(BenchmarkWorkload{
+      .name = name,
+      .iterations = iterations,
+      .f = std::move(f),
+      .cycles_sensor = cycles_sensor,
+  });
+}
+void BenchmarkComponent::set_run_on_boot(bool run_on_boot) { this->run_on_boot_ = run_on_boot; }
+void BenchmarkComponent::set_builtin_workloads(bool builtin_workloads) {
+  this->builtin_workloads_ = builtin_workloads;
+}
+const std::vector<BenchmarkWorkload> &BenchmarkComponent::get_workloads() const { return this->workloads_; }
+
+void BenchmarkComponent::setup() {
+  if (this->builtin_workloads_)
+    this->add_builtin_workloads_();
+
+  // the cost of timing a call through std::function, subtracted from all results
+  BenchmarkWorkload empty{
+      .name = "",
+      .iterations = 64,
+      .f = []() {},
+      .cycles_sensor = nullptr,
+  };
+  this->run_workload_(empty);
+  this->overhead_cycles_ = empty.min_cycles;
+
+  if (this->run_on_boot_)
+    this->defer([this]() { this->run(); });
+}
+void BenchmarkComponent::dump_config() {
+  ESP_LOGCONFIG(TAG, "Benchmark:");
+  ESP_LOGCONFIG(TAG, "  Run On Boot: %s", YESNO(this->run_on_boot_));
+  ESP_LOGCONFIG(TAG, "  Measurement Overhead: %u cycles", this->overhead_cycles_);
+  for (auto &workload : this->workloads_)
+    ESP_LOGCONFIG(TAG, "  Workload '%s': %u iterations", workload.name.c_str(), workload.iterations);
+}
+float BenchmarkComponent::get_setup_priority() const { return setup_priority::LATE; }
+
+void BenchmarkComponent::run() {
+  const uint32_t cpu_mhz = ESP.getCpuFreqMHz();
+  ESP_LOGI(TAG, "Running %u workloads (CPU %u MHz, flash %u MHz mode %u)...", this->workloads_.size(), cpu_mhz,
+           ESP.getFlashChipSpeed() / 1000000, ESP.getFlashChipMode());
+  for (auto &workload : this->workloads_) {
+    this->run_workload_(workload);
+    ESP_LOGI(TAG, "  %s: min %u cycles, mean %u cycles (%.2f us)", workload.name.c_str(), workload.min_cycles,
+             workload.mean_cycles, workload.mean_cycles / float(cpu_mhz));
+    if (workload.cycles_sensor != nullptr)
+      workload.cycles_sensor->publish_state(workload.mean_cycles);
+  }
+}
+void BenchmarkComponent::run_workload_(BenchmarkWorkload &workload) {
+  uint32_t min_cycles = UINT32_MAX;
+  uint64_t total_cycles = 0;
+  for (uint32_t i = 0; i < workload.iterations; i++) {
+    const uint32_t start = ESP.getCycleCount();
+    workload.f();
+    const uint32_t cycles = ESP.getCycleCount() - start;
+    min_cycles = std::min(min_cycles, cycles);
+    total_cycles += cycles;
+    // long workloads must not trip the watchdog, feed_wdt() rate-limits itself
+    feed_wdt();
+  }
+  if (workload.iterations == 0) {
+    workload.min_cycles = workload.mean_cycles = 0;
+    return;
+  }
+  const uint32_t mean_cycles = total_cycles / workload.iterations;
+  workload.min_cycles = min_cycles > this->overhead_cycles_ ? min_cycles - this->overhead_cycles_ : 0;
+  workload.mean_cycles = mean_cycles > this->overhead_cycles_ ? mean_cycles - this->overhead_cycles_ : 0;
+}
+
+void BenchmarkComponent::add_builtin_workloads_() {
+  // The sensors aren't registered with the application, so nothing is sent to the frontends. The last filter hands
+  // the value to a sensor without filters itself, as a filtered sensor would log every state.
+  this->output_sensor_ = new sensor::Sensor("benchmark");
+  this->output_sensor_->set_internal(true);
+  this->output_sensor_->add_on_state_callback([](float state) {});
+  this->filter_sensor_ = new sensor::Sensor("benchmark_filter");
+  this->filter_sensor_->set_internal(true);
+  auto *output = this->output_sensor_;
+  this->filter_sensor_->add_filters({
+      new sensor::SlidingWindowMedianFilter(5, 1, 1),
+      new sensor::SlidingWindowMovingAverageFilter(15, 1, 1),
+      new sensor::ExponentialMovingAverageFilter(0.1f, 1),
+      new sensor::LambdaFilter([output](float value) -> optional<float> {
+        output->publish_state(value);
+        return {};
+      }),
+  });
+
+  auto *filter_sensor = this->filter_sensor_;
+  this->add_workload("sensor_filter_publish", 256, [filter_sensor]() {
+    static float value = 0.0f;
+    value += 0.37f;
+    filter_sensor->publish_state(value);
+  });
+  this->add_workload("value_format", 256, [output]() {
+    char buf[VALUE_ACCURACY_MAX_LEN];
+    value_accuracy_to_buf(buf, output->state, 2);
+  });
+  this->add_workload("state_json", 64, [output]() {
+    write_json([output](JsonWriter &writer) {
+      writer.add("id", "sensor-" + output->get_object_id());
+      writer.add("state", output->state, 2);
+      writer.add("value", output->state);
+    });
+  });
+#ifdef USE_API
+  this->add_workload("api_sensor_state_encode", 256, [output]() {
+    static std::vector<uint8_t> payload;
+    payload.clear();
+    api::APIBuffer buffer(&payload);
+    api::encode_sensor_state(buffer, output, output->state);
+  });
+#endif
+}
+
+ESPHOME_NAMESPACE_END
+
+#endif  // USE_BENCHMARK_COMPONENT
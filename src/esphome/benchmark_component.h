@@ -0,0 +1,115 @@
+#ifndef ESPHOME_BENCHMARK_COMPONENT_H
+#define ESPHOME_BENCHMARK_COMPONENT_H
+
+#include "esphome/defines.h"
+
+#ifdef USE_BENCHMARK_COMPONENT
+
+#include <functional>
+#include <string>
+#include <vector>
+#include "esphome/component.h"
+#include "esphome/automation.h"
+#include "esphome/sensor/sensor.h"
+
+ESPHOME_NAMESPACE_BEGIN
+
+/// A piece of code that's timed by the BenchmarkComponent.
+struct BenchmarkWorkload {
+  std::string name;
+  /// How often the function is called per benchmark run.
+  uint32_t iterations;
+  std::function<void()> f;
+  /// Receives the mean number of CPU cycles per iteration after every run, may be nullptr.
+  sensor::Sensor *cycles_sensor;
+  /// The fastest iteration of the last run, in CPU cycles.
+  uint32_t min_cycles;
+  /// The mean of all iterations of the last run, in CPU cycles.
+  uint32_t mean_cycles;
+};
+
+template<typename... Ts> class BenchmarkRunAction;
+
+/** The benchmark component times micro-workloads on the device itself using the CPU cycle counter.
+ *
+ * Each workload is called a number of times, the fastest and the mean iteration are logged together with the
+ * CPU frequency and flash mode so that results of different boards can be compared. The overhead of the
+ * measurement itself is subtracted.
+ *
+ * A few workloads that don't touch any hardware (sensor filter chain, value formatting, state JSON and native
+ * API state encoding) are built in, everything else - for example a full redraw of a display or a light strip
+ * update - can be added with add_workload():
+ *
+ * ```cpp
+ * auto *benchmark = App.make_benchmark_component();
+ * benchmark->add_workload("ssd1306_redraw", 10, [=]() { display->update(); });
+ * ```
+ */
+class BenchmarkComponent : public Component {
+ public:
+  /** Add a workload.
+   *
+   * @param name The name to log the results with.
+   * @param iterations How often f is called per run, each call is timed on its own.
+   * @param f The workload.
+   * @param cycles_sensor An optional sensor that receives the mean cycles per iteration after each run.
+   */
+  void add_workload(const std::string &name, uint32_t iterations, std::function<void()> &&f,
+                    sensor::Sensor *cycles_sensor = nullptr);
+
+  /// Whether to run the benchmark once right after boot, defaults to true.
+  void set_run_on_boot(bool run_on_boot);
+  /// Whether to add the built-in workloads, defaults to true.
+  void set_builtin_workloads(bool builtin_workloads);
+
+  /// Run all workloads now, this blocks until they've finished.
+  void run();
+
+  const std::vector<BenchmarkWorkload> &get_workloads() const;
+
+  template<typename... Ts> BenchmarkRunAction<Ts...> *make_run_action();
+
+  void setup() override;
+  void dump_config() override;
+  float get_setup_priority() const override;
+
+ protected:
+  void add_builtin_workloads_();
+  void run_workload_(BenchmarkWorkload &workload);
+
+  std::vector<BenchmarkWorkload> workloads_;
+  bool run_on_boot_{true};
+  bool builtin_workloads_{true};
+  /// The cycles it takes to time an empty workload.
+  uint32_t overhead_cycles_{0};
+  /// The sensors the built-in sensor workloads publish to.
+  sensor::Sensor *filter_sensor_{nullptr};
+  sensor::Sensor *output_sensor_{nullptr};
+};
+
+template<typename... Ts> class BenchmarkRunAction : public Action<Ts...> {
+ public:
+  BenchmarkRunAction(BenchmarkComponent *benchmark);
+
+  void play(Ts... x) override;
+
+ protected:
+  BenchmarkComponent *benchmark_;
+};
+
+template<typename... Ts>
+BenchmarkRunAction<Ts...>::BenchmarkRunAction(BenchmarkComponent *benchmark) : benchmark_(benchmark) {}
+template<typename... Ts> void BenchmarkRunAction<Ts...>::play(Ts... x) {
+  this->benchmark_->run();
+  this->play_next(x...);
+}
+
+template<typename... Ts> BenchmarkRunAction<Ts...> *BenchmarkComponent::make_run_action() {
+  return new BenchmarkRunAction<Ts...>(this);
+}
+
+ESPHOME_NAMESPACE_END
+
+#endif  // USE_BENCHMARK_COMPONENT
+
+#endif  // ESPHOME_BENCHMARK_COMPONENT_H
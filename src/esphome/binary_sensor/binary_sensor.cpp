@@ -11,10 +11,6 @@ namespace binary_sensor {
 
 static const char *TAG = "binary_sensor";
 
-void BinarySensor::add_on_state_callback(std::function<void(bool)> &&callback) {
-  this->state_callback_.add(std::move(callback));
-}
-
 void BinarySensor::publish_state(bool state) {
   if (!this->publish_dedup_.next(state))
     return;
@@ -24,6 +20,11 @@ void BinarySensor::publish_state(bool state) {
     this->filter_list_->input(state, false);
   }
 }
+void BinarySensor::publish_state(bool state, uint32_t time) {
+  this->edge_time_ = time;
+  this->publish_state(state);
+  this->edge_time_.reset();
+}
 void BinarySensor::publish_initial_state(bool state) {
   if (!this->publish_dedup_.next(state))
     return;
@@ -37,6 +38,7 @@ void BinarySensor::send_state_internal(bool state, bool is_initial) {
   ESP_LOGD(TAG, "'%s': Sending state %s", this->get_name().c_str(), state ? "ON" : "OFF");
   this->has_state_ = true;
   this->state = state;
+  this->state_time_ = this->edge_time_.value_or(millis());
   if (!is_initial) {
     this->state_callback_.call(state);
   }
@@ -75,6 +77,7 @@ void BinarySensor::add_filters(std::vector<Filter *> filters) {
   }
 }
 bool BinarySensor::has_state() const { return this->has_state_; }
+uint32_t BinarySensor::get_state_time() const { return this->state_time_; }
 PressTrigger::PressTrigger(BinarySensor *parent) {
   parent->add_on_state_callback([this](bool state) {
     if (state)
@@ -99,11 +102,11 @@ bool match_interval(uint32_t min_length, uint32_t max_length, uint32_t length) {
 
 ClickTrigger::ClickTrigger(BinarySensor *parent, uint32_t min_length, uint32_t max_length)
     : min_length_(min_length), max_length_(max_length) {
-  parent->add_on_state_callback([this](bool state) {
+  parent->add_on_state_callback([this, parent](bool state) {
     if (state) {
-      this->start_time_ = millis();
+      this->start_time_ = parent->get_state_time();
     } else {
-      const uint32_t length = millis() - this->start_time_;
+      const uint32_t length = parent->get_state_time() - this->start_time_;
       if (match_interval(this->min_length_, this->max_length_, length))
         this->trigger();
     }
@@ -112,8 +115,8 @@ ClickTrigger::ClickTrigger(BinarySensor *parent, uint32_t min_length, uint32_t m
 
 DoubleClickTrigger::DoubleClickTrigger(BinarySensor *parent, uint32_t min_length, uint32_t max_length)
     : min_length_(min_length), max_length_(max_length) {
-  parent->add_on_state_callback([this](bool state) {
-    const uint32_t now = millis();
+  parent->add_on_state_callback([this, parent](bool state) {
+    const uint32_t now = parent->get_state_time();
 
     if (state && this->start_time_ != 0 && this->end_time_ != 0) {
       if (match_interval(this->min_length_, this->max_length_, this->end_time_ - this->start_time_) &&
@@ -133,6 +136,7 @@ DoubleClickTrigger::DoubleClickTrigger(BinarySensor *parent, uint32_t min_length
 MultiClickTrigger *BinarySensor::make_multi_click_trigger(const std::vector<MultiClickTriggerEvent> &timing) {
   return new MultiClickTrigger(this, timing);
 }
+ClickPatternEngine *BinarySensor::make_click_pattern_engine() { return new ClickPatternEngine(this); }
 uint32_t BinarySensor::hash_base() { return 1210250844UL; }
 StateTrigger *BinarySensor::make_state_trigger() { return new StateTrigger(this); }
 bool BinarySensor::is_status_binary_sensor() const { return false; }
@@ -155,6 +159,8 @@ void MultiClickTrigger::on_state_(bool state) {
     return;
   }
   this->last_state_ = state;
+  // the lengths are measured from the edge times, which can be earlier than now
+  const uint32_t time = this->parent_->get_state_time();
 
   // Cooldown: Do not immediately try matching after having invalid timing
   if (this->is_in_cooldown_) {
@@ -168,10 +174,12 @@ void MultiClickTrigger::on_state_(bool state) {
       ESP_LOGV(TAG, "START min=%u max=%u", evt.min_length, evt.max_length);
       ESP_LOGV(TAG, "Multi Click: Starting multi click action!");
       this->at_index_ = 1;
+      this->segment_start_ = time;
       if (this->timing_.size() == 1 && evt.max_length == 4294967294UL) {
-        this->set_timeout("trigger", evt.min_length, [this]() { this->trigger_(); });
+        this->segment_min_length_ = UINT32_MAX;
+        this->set_timeout("trigger", this->remaining_(evt.min_length), [this]() { this->trigger_(); });
       } else {
-        this->schedule_is_valid_(evt.min_length);
+        this->set_segment_min_length_(evt.min_length);
         this->schedule_is_not_valid_(evt.max_length);
       }
     } else {
@@ -181,10 +189,11 @@ void MultiClickTrigger::on_state_(bool state) {
     return;
   }
 
-  if (!this->is_valid_) {
+  if (time - this->segment_start_ < this->segment_min_length_) {
     this->schedule_cooldown_();
     return;
   }
+  this->segment_start_ = time;
 
   if (*this->at_index_ == this->timing_.size()) {
     this->trigger_();
@@ -195,17 +204,18 @@ void MultiClickTrigger::on_state_(bool state) {
 
   if (evt.max_length != 4294967294UL) {
     ESP_LOGV(TAG, "A i=%u min=%u max=%u", *this->at_index_, evt.min_length, evt.max_length);  // NOLINT
-    this->schedule_is_valid_(evt.min_length);
+    this->set_segment_min_length_(evt.min_length);
     this->schedule_is_not_valid_(evt.max_length);
   } else if (*this->at_index_ + 1 != this->timing_.size()) {
     ESP_LOGV(TAG, "B i=%u min=%u", *this->at_index_, evt.min_length);  // NOLINT
     this->cancel_timeout("is_not_valid");
-    this->schedule_is_valid_(evt.min_length);
+    this->set_segment_min_length_(evt.min_length);
   } else {
     ESP_LOGV(TAG, "C i=%u min=%u", *this->at_index_, evt.min_length);  // NOLINT
-    this->is_valid_ = false;
+    // any edge before the trigger fires is invalid
+    this->segment_min_length_ = UINT32_MAX;
     this->cancel_timeout("is_not_valid");
-    this->set_timeout("trigger", evt.min_length, [this]() { this->trigger_(); });
+    this->set_timeout("trigger", this->remaining_(evt.min_length), [this]() { this->trigger_(); });
   }
 
   *this->at_index_ = *this->at_index_ + 1;
@@ -220,28 +230,23 @@ void MultiClickTrigger::schedule_cooldown_() {
   });
   this->at_index_.reset();
   this->cancel_timeout("trigger");
-  this->cancel_timeout("is_valid");
   this->cancel_timeout("is_not_valid");
 }
-void MultiClickTrigger::schedule_is_valid_(uint32_t min_length) {
-  this->is_valid_ = false;
-  this->set_timeout("is_valid", min_length, [this]() {
-    ESP_LOGV(TAG, "Multi Click: You can now %s the button.", this->parent_->state ? "RELEASE" : "PRESS");
-    this->is_valid_ = true;
-  });
-}
+void MultiClickTrigger::set_segment_min_length_(uint32_t min_length) { this->segment_min_length_ = min_length; }
 void MultiClickTrigger::schedule_is_not_valid_(uint32_t max_length) {
-  this->set_timeout("is_not_valid", max_length, [this]() {
+  this->set_timeout("is_not_valid", this->remaining_(max_length), [this]() {
     ESP_LOGV(TAG, "Multi Click: You waited too long to %s.", this->parent_->state ? "RELEASE" : "PRESS");
-    this->is_valid_ = false;
     this->schedule_cooldown_();
   });
 }
+uint32_t MultiClickTrigger::remaining_(uint32_t length) const {
+  const uint32_t elapsed = millis() - this->segment_start_;
+  return elapsed >= length ? 0 : length - elapsed;
+}
 void MultiClickTrigger::trigger_() {
   ESP_LOGV(TAG, "Multi Click: Hooray, multi click is valid. Triggering!");
   this->at_index_.reset();
   this->cancel_timeout("trigger");
-  this->cancel_timeout("is_valid");
   this->cancel_timeout("is_not_valid");
   this->trigger();
 }
@@ -21,6 +21,7 @@ class ReleaseTrigger;
 class ClickTrigger;
 class DoubleClickTrigger;
 class MultiClickTrigger;
+class ClickPatternEngine;
 class StateTrigger;
 template<typename... Ts> class BinarySensorCondition;
 class Filter;
@@ -63,7 +64,7 @@ class BinarySensor : public Nameable {
    *
    * @param callback The void(bool) callback.
    */
-  void add_on_state_callback(std::function<void(bool)> &&callback);
+  template<typename F> void add_on_state_callback(F &&callback);
 
   /** Publish a new state to the front-end.
    *
@@ -71,6 +72,13 @@ class BinarySensor : public Nameable {
    */
   void publish_state(bool state);
 
+  /** Publish a new state that changed at the given millis() time.
+   *
+   * For inputs that timestamp their edges (for example in an interrupt), so that click triggers measure the
+   * lengths between the actual edges instead of between the loop() iterations that publish them.
+   */
+  void publish_state(bool state, uint32_t time);
+
   /** Publish the initial state, this will not make the callback manager send callbacks
    * and is meant only for the initial state on boot.
    *
@@ -95,6 +103,8 @@ class BinarySensor : public Nameable {
   ClickTrigger *make_click_trigger(uint32_t min_length, uint32_t max_length);
   DoubleClickTrigger *make_double_click_trigger(uint32_t min_length, uint32_t max_length);
   MultiClickTrigger *make_multi_click_trigger(const std::vector<MultiClickTriggerEvent> &timing);
+  /// Create an engine that matches several multi click patterns at once, see ClickPatternEngine.
+  ClickPatternEngine *make_click_pattern_engine();
   StateTrigger *make_state_trigger();
   template<typename... Ts> BinarySensorCondition<Ts...> *make_binary_sensor_is_on_condition(uint32_t for_time = 0);
   template<typename... Ts> BinarySensorCondition<Ts...> *make_binary_sensor_is_off_condition(uint32_t for_time = 0);
@@ -110,6 +120,9 @@ class BinarySensor : public Nameable {
   /// Return whether this binary sensor has outputted a state.
   bool has_state() const;
 
+  /// The millis() time the current state was reached at.
+  uint32_t get_state_time() const;
+
   virtual bool is_status_binary_sensor() const;
 
 #ifdef USE_MQTT_BINARY_SENSOR
@@ -130,6 +143,9 @@ class BinarySensor : public Nameable {
   Filter *filter_list_{nullptr};
   bool has_state_{false};
   Deduplicator<bool> publish_dedup_;
+  uint32_t state_time_{0};
+  /// The time passed to publish_state(), only used if the state goes through the filters synchronously.
+  optional<uint32_t> edge_time_{};
 
 #ifdef USE_MQTT_BINARY_SENSOR
   MQTTBinarySensorComponent *mqtt_{nullptr};
@@ -180,9 +196,11 @@ class MultiClickTrigger : public Trigger<>, public Component {
  protected:
   void on_state_(bool state);
   void schedule_cooldown_();
-  void schedule_is_valid_(uint32_t min_length);
+  void set_segment_min_length_(uint32_t min_length);
   void schedule_is_not_valid_(uint32_t max_length);
   void trigger_();
+  /// Time left until the current segment is length ms long.
+  uint32_t remaining_(uint32_t length) const;
 
   BinarySensor *parent_;
   std::vector<MultiClickTriggerEvent> timing_;
@@ -190,7 +208,10 @@ class MultiClickTrigger : public Trigger<>, public Component {
   optional<size_t> at_index_{};
   bool last_state_{false};
   bool is_in_cooldown_{false};
-  bool is_valid_{false};
+  /// The time of the edge that started the current segment.
+  uint32_t segment_start_{0};
+  /// The minimum length of the current segment, an edge before that is invalid.
+  uint32_t segment_min_length_{0};
 };
 
 class StateTrigger : public Trigger<bool> {
@@ -202,6 +223,8 @@ template<typename... Ts> class BinarySensorCondition : public Condition<Ts...> {
  public:
   BinarySensorCondition(BinarySensor *parent, bool state, uint32_t for_time = 0);
   bool check(Ts... x) override;
+  /// Supported only without a for time, which doesn't end with a state change.
+  bool add_on_change_callback(std::function<void()> &&callback) override;
 
  protected:
   BinarySensor *parent_;
@@ -221,10 +244,13 @@ template<typename... Ts> class BinarySensorPublishAction : public Action<Ts...>
   TemplatableValue<bool, Ts...> state_;
 };
 
+template<typename F> void BinarySensor::add_on_state_callback(F &&callback) {
+  this->state_callback_.add(std::forward<F>(callback));
+}
 template<typename... Ts>
 BinarySensorCondition<Ts...>::BinarySensorCondition(BinarySensor *parent, bool state, uint32_t for_time)
     : parent_(parent), state_(state), for_time_(for_time) {
-  parent->add_on_state_callback([this](bool state) { this->last_state_time_ = millis(); });
+  parent->add_on_state_callback([this](bool state) { this->last_state_time_ = this->parent_->get_state_time(); });
 }
 template<typename... Ts> bool BinarySensorCondition<Ts...>::check(Ts... x) {
   if (this->parent_->state != this->state_)
@@ -232,6 +258,13 @@ template<typename... Ts> bool BinarySensorCondition<Ts...>::check(Ts... x) {
 
   return millis() - this->last_state_time_ >= this->for_time_;
 }
+template<typename... Ts>
+bool BinarySensorCondition<Ts...>::add_on_change_callback(std::function<void()> &&callback) {
+  if (this->for_time_ != 0)
+    return false;
+  this->parent_->add_on_state_callback([callback](bool state) { callback(); });
+  return true;
+}
 
 template<typename... Ts>
 BinarySensorCondition<Ts...> *BinarySensor::make_binary_sensor_is_on_condition(uint32_t for_time) {
@@ -256,6 +289,7 @@ template<typename... Ts> BinarySensorPublishAction<Ts...> *BinarySensor::make_bi
 
 ESPHOME_NAMESPACE_END
 
+#include "esphome/binary_sensor/click_pattern.h"
 #include "esphome/binary_sensor/mqtt_binary_sensor_component.h"
 
 #endif  // USE_BINARY_SENSOR
@@ -0,0 +1,147 @@
+#include "esphome/defines.h"
+
+#ifdef USE_BINARY_SENSOR
+
+#include <algorithm>
+#include "esphome/binary_sensor/click_pattern.h"
+#include "esphome/log.h"
+
+ESPHOME_NAMESPACE_BEGIN
+
+namespace binary_sensor {
+
+static const char *TAG = "binary_sensor.click_pattern";
+
+/// The max_length of multi click events without a maximum.
+static const uint32_t CLICK_PATTERN_NO_MAX_LENGTH = 4294967294UL;
+
+ClickPatternEngine::ClickPatternEngine(BinarySensor *parent) : parent_(parent) {}
+
+Trigger<> *ClickPatternEngine::add_pattern(const std::vector<MultiClickTriggerEvent> &timing) {
+  auto *trigger = new Trigger<>();
+  this->patterns_.push_back(Pattern{timing, trigger});
+  this->max_edges_ = std::max(this->max_edges_, timing.size() + 1);
+  return trigger;
+}
+void ClickPatternEngine::set_invalid_cooldown(uint32_t invalid_cooldown) {
+  this->invalid_cooldown_ = invalid_cooldown;
+}
+
+void ClickPatternEngine::setup() {
+  // one more than the longest pattern, that's when evaluate_() gives up
+  this->edges_.reserve(this->max_edges_ + 1);
+  this->parent_->add_on_state_callback(
+      [this](bool state) { this->on_state_(state, this->parent_->get_state_time()); });
+  this->disable_loop();
+}
+void ClickPatternEngine::dump_config() {
+  ESP_LOGCONFIG(TAG, "Click Patterns for '%s':", this->parent_->get_name().c_str());
+  for (auto &pattern : this->patterns_) {
+    ESP_LOGCONFIG(TAG, "  Pattern with %u steps", pattern.timing.size());
+  }
+}
+float ClickPatternEngine::get_setup_priority() const { return setup_priority::HARDWARE; }
+
+void ClickPatternEngine::on_state_(bool state, uint32_t time) {
+  if (this->in_cooldown_)
+    return;
+
+  if (this->edges_.empty()) {
+    bool starts_pattern = false;
+    for (auto &pattern : this->patterns_)
+      starts_pattern |= pattern.timing[0].state == state;
+    if (!starts_pattern)
+      return;
+    this->start_state_ = state;
+  }
+  this->edges_.push_back(time);
+  this->evaluate_(time);
+}
+void ClickPatternEngine::evaluate_(uint32_t now) {
+  if (this->edges_.empty())
+    return;
+
+  uint32_t next_change = UINT32_MAX;
+  const Pattern *complete = nullptr;
+  bool pending = false;
+  for (auto &pattern : this->patterns_) {
+    switch (this->match_(pattern, now, &next_change)) {
+      case MatchState::COMPLETE:
+        // the longest pattern wins, for example a double click over a click
+        if (complete == nullptr || pattern.timing.size() > complete->timing.size())
+          complete = &pattern;
+        break;
+      case MatchState::PENDING:
+        pending = true;
+        break;
+      case MatchState::FAILED:
+        break;
+    }
+  }
+
+  if (pending) {
+    // a longer pattern can still match, wait for the next edge or until the result changes
+    if (next_change != UINT32_MAX) {
+      this->set_timeout("evaluate", next_change, [this]() { this->evaluate_(millis()); });
+    } else {
+      this->cancel_timeout("evaluate");
+    }
+    return;
+  }
+
+  this->cancel_timeout("evaluate");
+  this->reset_();
+  if (complete != nullptr) {
+    ESP_LOGV(TAG, "'%s': Pattern with %u steps matched", this->parent_->get_name().c_str(), complete->timing.size());
+    complete->trigger->trigger();
+    return;
+  }
+
+  ESP_LOGV(TAG, "'%s': No pattern matched, starting cooldown of %u ms...", this->parent_->get_name().c_str(),
+           this->invalid_cooldown_);
+  this->in_cooldown_ = true;
+  this->set_timeout("cooldown", this->invalid_cooldown_, [this]() { this->in_cooldown_ = false; });
+}
+ClickPatternEngine::MatchState ClickPatternEngine::match_(const Pattern &pattern, uint32_t now,
+                                                          uint32_t *next_change) const {
+  const auto &timing = pattern.timing;
+  if (timing[0].state != this->start_state_)
+    return MatchState::FAILED;
+
+  // the segments between two edges, each has the state of its event since the states alternate
+  const size_t closed = this->edges_.size() - 1;
+  if (closed > timing.size())
+    return MatchState::FAILED;
+  for (size_t i = 0; i < closed; i++) {
+    const uint32_t length = this->edges_[i + 1] - this->edges_[i];
+    const auto &evt = timing[i];
+    if (length < evt.min_length || (evt.max_length != CLICK_PATTERN_NO_MAX_LENGTH && length > evt.max_length))
+      return MatchState::FAILED;
+  }
+  if (closed == timing.size())
+    return MatchState::COMPLETE;
+
+  // the segment in progress
+  const auto &evt = timing[closed];
+  const uint32_t length = now - this->edges_.back();
+  if (evt.max_length == CLICK_PATTERN_NO_MAX_LENGTH) {
+    // a last step without maximum is complete once it lasted min_length, it doesn't need an edge
+    if (closed + 1 == timing.size()) {
+      if (length >= evt.min_length)
+        return MatchState::COMPLETE;
+      *next_change = std::min(*next_change, evt.min_length - length);
+    }
+    return MatchState::PENDING;
+  }
+  if (length > evt.max_length)
+    return MatchState::FAILED;
+  *next_change = std::min(*next_change, evt.max_length - length + 1);
+  return MatchState::PENDING;
+}
+void ClickPatternEngine::reset_() { this->edges_.clear(); }
+
+}  // namespace binary_sensor
+
+ESPHOME_NAMESPACE_END
+
+#endif  // USE_BINARY_SENSOR
@@ -0,0 +1,78 @@
+#ifndef ESPHOME_BINARY_SENSOR_CLICK_PATTERN_H
+#define ESPHOME_BINARY_SENSOR_CLICK_PATTERN_H
+
+#include "esphome/defines.h"
+
+#ifdef USE_BINARY_SENSOR
+
+#include <vector>
+#include "esphome/component.h"
+#include "esphome/automation.h"
+#include "esphome/binary_sensor/binary_sensor.h"
+
+ESPHOME_NAMESPACE_BEGIN
+
+namespace binary_sensor {
+
+/** Match press patterns (clicks, double clicks, long presses, ...) of one binary sensor.
+ *
+ * Instead of one MultiClickTrigger component per pattern, each keeping its own timeouts, the engine records the
+ * times of the state changes (see BinarySensor::get_state_time(), exact with GPIO interrupt mode) and matches the
+ * lengths between them against all patterns at once. The patterns use the same timing as multi click triggers.
+ *
+ * A pattern fires as soon as it's matched and no longer pattern can still match the same presses. So with a
+ * click and a double click pattern, the click fires when the time for the second press has run out, while a
+ * pattern that no other pattern extends fires right on the release. Only one timeout is scheduled, for the next
+ * time the result can change.
+ */
+class ClickPatternEngine : public Component {
+ public:
+  explicit ClickPatternEngine(BinarySensor *parent);
+
+  /// Add a pattern, the returned trigger fires when it's matched.
+  Trigger<> *add_pattern(const std::vector<MultiClickTriggerEvent> &timing);
+  /// After presses that don't match any pattern, ignore the sensor for this many ms (default 1s).
+  void set_invalid_cooldown(uint32_t invalid_cooldown);
+
+  void setup() override;
+  void dump_config() override;
+  float get_setup_priority() const override;
+
+ protected:
+  enum class MatchState {
+    /// The presses so far don't match the pattern.
+    FAILED,
+    /// The presses so far match the beginning of the pattern.
+    PENDING,
+    COMPLETE,
+  };
+  struct Pattern {
+    std::vector<MultiClickTriggerEvent> timing;
+    Trigger<> *trigger;
+  };
+
+  void on_state_(bool state, uint32_t time);
+  /// Match all patterns against the recorded presses at the given time and fire or schedule the next check.
+  void evaluate_(uint32_t now);
+  /// Match one pattern, next_change is lowered to the time in ms until the result changes without a new edge.
+  MatchState match_(const Pattern &pattern, uint32_t now, uint32_t *next_change) const;
+  void reset_();
+
+  BinarySensor *parent_;
+  std::vector<Pattern> patterns_;
+  uint32_t invalid_cooldown_{1000};
+  size_t max_edges_{0};
+  /// The times of the state changes since the first edge of the current presses.
+  std::vector<uint32_t> edges_;
+  /// The state after the first edge.
+  bool start_state_{false};
+  bool in_cooldown_{false};
+};
+
+}  // namespace binary_sensor
+
+ESPHOME_NAMESPACE_END
+
+#endif  // USE_BINARY_SENSOR
+
+#endif  // ESPHOME_BINARY_SENSOR_CLICK_PATTERN_H
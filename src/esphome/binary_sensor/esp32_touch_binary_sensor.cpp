@@ -19,15 +19,21 @@ void ESP32TouchComponent::setup() {
     touch_pad_filter_start(this->iir_filter_);
   }
 
+  // measure all pads on the hardware timer and compare them with the thresholds in hardware
+  touch_pad_set_fsm_mode(TOUCH_FSM_MODE_TIMER);
   touch_pad_set_meas_time(this->sleep_cycle_, this->meas_cycle_);
   touch_pad_set_voltage(this->high_voltage_reference_, this->low_voltage_reference_, this->voltage_attenuation_);
+  touch_pad_set_trigger_mode(TOUCH_TRIGGER_BELOW);
 
   for (auto *child : this->children_) {
-    // Disable interrupt threshold
-    touch_pad_config(child->get_touch_pad(), 0);
+    touch_pad_config(child->get_touch_pad(), child->get_threshold());
   }
 
+  touch_pad_isr_register(reinterpret_cast<intr_handler_t>(ESP32TouchComponent::touch_intr), this);
+  touch_pad_intr_enable();
+
   add_shutdown_hook([this](const char *cause) {
+    touch_pad_intr_disable();
     if (this->iir_filter_enabled_()) {
       touch_pad_filter_stop();
       touch_pad_filter_delete();
@@ -103,7 +109,6 @@ void ESP32TouchComponent::dump_config() {
 
   if (this->iir_filter_enabled_()) {
     ESP_LOGCONFIG(TAG, "    IIR Filter: %ums", this->iir_filter_);
-    touch_pad_filter_start(this->iir_filter_);
   } else {
     ESP_LOGCONFIG(TAG, "  IIR Filter DISABLED");
   }
@@ -119,6 +124,32 @@ void ESP32TouchComponent::dump_config() {
 }
 
 void ESP32TouchComponent::loop() {
+  const uint32_t now = millis();
+  const uint16_t touched = this->touched_;
+  this->touched_ &= ~touched;
+  const uint32_t release_timeout = this->release_timeout_();
+
+  for (auto *child : this->children_) {
+    const touch_pad_t pad = child->get_touch_pad();
+    const uint32_t last_touch = this->last_touch_[pad];
+    if (touched & (1 << pad)) {
+      if (!child->touched_) {
+        child->touched_ = true;
+        child->publish_state(true, last_touch);
+      }
+    } else if (child->touched_ && now - last_touch >= release_timeout) {
+      child->touched_ = false;
+      child->publish_state(false, last_touch + release_timeout);
+    }
+  }
+
+  // Avoid spamming logs
+  if (this->setup_mode_ && now - this->last_log_ >= 250) {
+    this->last_log_ = now;
+    this->log_values_();
+  }
+}
+void ESP32TouchComponent::log_values_() {
   for (auto *child : this->children_) {
     uint16_t value;
     if (this->iir_filter_enabled_()) {
@@ -126,18 +157,24 @@ void ESP32TouchComponent::loop() {
     } else {
       touch_pad_read(child->get_touch_pad(), &value);
     }
-
-    child->publish_state(value < child->get_threshold());
-
-    if (this->setup_mode_) {
-      ESP_LOGD(TAG, "Touch Pad '%s' (T%u): %u", child->get_name().c_str(), child->get_touch_pad(), value);
-    }
+    ESP_LOGD(TAG, "Touch Pad '%s' (T%u): %u", child->get_name().c_str(), child->get_touch_pad(), value);
   }
-
-  if (this->setup_mode_) {
-    // Avoid spamming logs
-    delay(250);
+}
+uint32_t ESP32TouchComponent::release_timeout_() const {
+  // one measurement period is the sleep time (150kHz RTC SLOW clock) plus the measurement time (8MHz)
+  const uint32_t period = this->sleep_cycle_ / 150 + this->meas_cycle_ / 8000 + 1;
+  return 3 * period;
+}
+void ICACHE_RAM_ATTR ESP32TouchComponent::touch_intr(ESP32TouchComponent *arg) {
+  const uint32_t status = touch_pad_get_status();
+  touch_pad_clear_status();
+  const uint32_t now = millis();
+  for (uint8_t pad = 0; pad < TOUCH_PAD_MAX; pad++) {
+    if (status & (1 << pad))
+      arg->last_touch_[pad] = now;
   }
+  arg->touched_ |= status;
+  wake_loop();
 }
 ESP32TouchBinarySensor *ESP32TouchComponent::make_touch_pad(const std::string &name, touch_pad_t touch_pad,
                                                             uint16_t threshold) {
@@ -25,7 +25,10 @@ class ESP32TouchBinarySensor;
  *
  * This component uses the measured touch value and applies a simple threshold. If the measured value
  * is below the threshold, the binary sensor for a touch pad will go ON, and if it's above, the binary
- * sensor will report an OFF state again.
+ * sensor will report an OFF state again. The touch peripheral measures all pads on its own timer and compares
+ * them with the thresholds in hardware: each measurement below the threshold raises an interrupt that records
+ * the time for the pad, a pad is released once no interrupt came for three measurement periods. So loop()
+ * doesn't read the pads and the response doesn't depend on the loop interval.
  *
  * If you notice the values have a lot of noise for your device and cause many false-positive touch events,
  * you can optionally setup an IIR Filter for globally across all touch pads. If this filter value is large
@@ -174,6 +177,12 @@ class ESP32TouchComponent : public Component {
  protected:
   /// Is the IIR filter enabled?
   bool iir_filter_enabled_() const;
+  /// The time in ms after the last threshold interrupt of a pad at which it's considered released.
+  uint32_t release_timeout_() const;
+  /// Log the touch values of all pads, read with touch_pad_read().
+  void log_values_();
+
+  static void touch_intr(ESP32TouchComponent *arg);
 
   uint16_t sleep_cycle_{4096};
   uint16_t meas_cycle_{65535};
@@ -183,6 +192,11 @@ class ESP32TouchComponent : public Component {
   std::vector<ESP32TouchBinarySensor *> children_;
   bool setup_mode_{false};
   uint32_t iir_filter_{0};
+  /// The millis() time of the last threshold interrupt of each pad, written by the ISR.
+  volatile uint32_t last_touch_[TOUCH_PAD_MAX]{};
+  /// Bit mask of the pads that had a threshold interrupt since the last loop(), written by the ISR.
+  volatile uint16_t touched_{0};
+  uint32_t last_log_{0};
 };
 
 /// Simple helper class to expose a touch pad value as a binary sensor.
@@ -198,6 +212,8 @@ class ESP32TouchBinarySensor : public BinarySensor {
 
   touch_pad_t touch_pad_;
   uint16_t threshold_;
+  /// Whether the pad is currently considered touched, ON state before the filters.
+  bool touched_{false};
 };
 
 }  // namespace binary_sensor
@@ -13,7 +13,7 @@ namespace binary_sensor {
 
 class BinarySensor;
 
-class Filter {
+class Filter : public SetupAllocated {
  public:
   virtual optional<bool> new_value(bool value, bool is_initial) = 0;
 
@@ -15,19 +15,97 @@ static const char *TAG = "binary_sensor.gpio";
 void GPIOBinarySensorComponent::setup() {
   ESP_LOGCONFIG(TAG, "Setting up GPIO binary sensor '%s'...", this->name_.c_str());
   this->pin_->setup();
-  this->publish_initial_state(this->pin_->digital_read());
+  const bool level = this->pin_->digital_read();
+  this->debounced_level_ = level;
+  this->pending_level_ = level;
+  this->pending_since_ = millis();
+  this->publish_initial_state(level);
+
+  if (this->use_interrupt_) {
+    this->store_.pin = this->pin_->to_isr();
+    this->store_.last_level = level;
+    this->pin_->attach_interrupt(GPIOBinarySensorStore::gpio_intr, &this->store_, CHANGE);
+  }
 }
 
 void GPIOBinarySensorComponent::dump_config() {
   LOG_BINARY_SENSOR("", "GPIO Binary Sensor", this);
   LOG_PIN("  Pin: ", this->pin_);
+  ESP_LOGCONFIG(TAG, "  Mode: %s", this->use_interrupt_ ? "interrupt" : "polling");
+  if (this->debounce_ != 0) {
+    ESP_LOGCONFIG(TAG, "  Debounce: %u ms", this->debounce_);
+  }
+}
+
+void GPIOBinarySensorComponent::loop() {
+  const uint32_t now = millis();
+  if (this->use_interrupt_) {
+    auto &store = this->store_;
+    while (store.read_at != store.write_at) {
+      const GPIOBinarySensorEdge &edge = store.edges[store.read_at];
+      this->process_edge_(edge.level, edge.time);
+      store.read_at = (store.read_at + 1) % GPIO_BINARY_SENSOR_EDGE_BUFFER_SIZE;
+    }
+    if (store.overflow) {
+      store.overflow = false;
+      ESP_LOGW(TAG, "'%s': Too many edges, some were dropped!", this->name_.c_str());
+      this->process_edge_(this->pin_->digital_read(), now);
+    }
+  } else {
+    this->process_edge_(this->pin_->digital_read(), now);
+  }
+
+  if (this->debounce_ != 0 && this->pending_level_ != this->debounced_level_ &&
+      now - this->pending_since_ >= this->debounce_) {
+    this->debounced_level_ = this->pending_level_;
+    this->publish_state(this->pending_level_, this->pending_since_);
+  }
+}
+
+uint32_t GPIOBinarySensorComponent::get_loop_idle_time() {
+  if (!this->use_interrupt_)
+    return 0;
+  if (this->store_.read_at != this->store_.write_at || this->store_.overflow)
+    return 0;
+  if (this->debounce_ != 0 && this->pending_level_ != this->debounced_level_) {
+    const uint32_t since = millis() - this->pending_since_;
+    return since < this->debounce_ ? this->debounce_ - since : 0;
+  }
+  return SCHEDULER_DONT_RUN;
+}
+
+void GPIOBinarySensorComponent::process_edge_(bool level, uint32_t time) {
+  if (this->debounce_ == 0) {
+    this->publish_state(level, time);
+    return;
+  }
+  if (level != this->pending_level_) {
+    this->pending_level_ = level;
+    this->pending_since_ = time;
+  }
 }
 
-void GPIOBinarySensorComponent::loop() { this->publish_state(this->pin_->digital_read()); }
+void ICACHE_RAM_ATTR HOT GPIOBinarySensorStore::gpio_intr(GPIOBinarySensorStore *arg) {
+  const bool level = arg->pin->digital_read();
+  if (level == arg->last_level)
+    return;
+  arg->last_level = level;
+
+  const uint8_t next = (arg->write_at + 1) % GPIO_BINARY_SENSOR_EDGE_BUFFER_SIZE;
+  if (next == arg->read_at) {
+    arg->overflow = true;
+    return;
+  }
+  arg->edges[arg->write_at] = GPIOBinarySensorEdge{millis(), level};
+  arg->write_at = next;
+  wake_loop();
+}
 
 float GPIOBinarySensorComponent::get_setup_priority() const { return setup_priority::HARDWARE; }
 GPIOBinarySensorComponent::GPIOBinarySensorComponent(const std::string &name, GPIOPin *pin)
     : BinarySensor(name), pin_(pin) {}
+void GPIOBinarySensorComponent::set_use_interrupt(bool use_interrupt) { this->use_interrupt_ = use_interrupt; }
+void GPIOBinarySensorComponent::set_debounce(uint32_t debounce) { this->debounce_ = debounce; }
 
 }  // namespace binary_sensor
 
@@ -12,9 +12,41 @@ ESPHOME_NAMESPACE_BEGIN
 
 namespace binary_sensor {
 
+/// The number of edges that can be recorded between two loop() iterations in interrupt mode.
+static const uint8_t GPIO_BINARY_SENSOR_EDGE_BUFFER_SIZE = 16;
+
+struct GPIOBinarySensorEdge {
+  uint32_t time;
+  bool level;
+};
+
+/** Ring buffer of the edges recorded by the interrupt, the ISR writes and loop() reads.
+ *
+ * Store data in a class that doesn't use multiple-inheritance (vtables in flash).
+ */
+struct GPIOBinarySensorStore {
+  ISRInternalGPIOPin *pin;
+  GPIOBinarySensorEdge edges[GPIO_BINARY_SENSOR_EDGE_BUFFER_SIZE];
+  /// The next edge to read, only written by loop().
+  volatile uint8_t read_at{0};
+  /// The next edge to write, only written by the ISR.
+  volatile uint8_t write_at{0};
+  volatile bool last_level{false};
+  /// Set by the ISR if an edge didn't fit into the buffer, loop() then reads the pin again.
+  volatile bool overflow{false};
+
+  static void gpio_intr(GPIOBinarySensorStore *arg);
+};
+
 /** Simple binary_sensor component for a GPIO pin.
  *
  * This class allows you to observe the digital state of a certain GPIO pin.
+ *
+ * By default the pin is read in every loop() iteration, pulses shorter than a loop iteration can be missed. In
+ * interrupt mode the edges are timestamped in an interrupt and published in order with their times, so short
+ * pulses aren't lost and click triggers measure the actual lengths. The debounce time (in both modes) only
+ * publishes a level after it has been stable for that long, without the overhead of delayed_on/delayed_off
+ * filters.
  */
 class GPIOBinarySensorComponent : public BinarySensor, public Component {
  public:
@@ -25,6 +57,11 @@ class GPIOBinarySensorComponent : public BinarySensor, public Component {
    */
   explicit GPIOBinarySensorComponent(const std::string &name, GPIOPin *pin);
 
+  /// Record the edges in an interrupt instead of reading the pin in loop().
+  void set_use_interrupt(bool use_interrupt);
+  /// Only publish a level once it has been stable for this many ms, 0 (default) disables debouncing.
+  void set_debounce(uint32_t debounce);
+
   // ========== INTERNAL METHODS ==========
   // (In most use cases you won't need these)
   /// Setup pin
@@ -34,9 +71,22 @@ class GPIOBinarySensorComponent : public BinarySensor, public Component {
   float get_setup_priority() const override;
   /// Check sensor
   void loop() override;
+  /// In interrupt mode loop() only runs for new edges (the ISR wakes the loop up) and pending debounces.
+  uint32_t get_loop_idle_time() override;
 
  protected:
+  /// Handle a change of the pin level at the given time.
+  void process_edge_(bool level, uint32_t time);
+
   GPIOPin *pin_;
+  bool use_interrupt_{false};
+  uint32_t debounce_{0};
+  GPIOBinarySensorStore store_;
+  /// The last level published after debouncing, before the filters.
+  bool debounced_level_{false};
+  /// The level that's waiting for the debounce time to pass.
+  bool pending_level_{false};
+  uint32_t pending_since_{0};
 };
 
 }  // namespace binary_sensor
@@ -3,6 +3,7 @@
 
 #include "esphome/binary_sensor/mpr121_sensor.h"
 #include "esphome/log.h"
+#include "esphome/helpers.h"
 
 ESPHOME_NAMESPACE_BEGIN
 
@@ -60,11 +61,19 @@ void MPR121Component::setup() {
   this->write_byte(MPR121_CONFIG2, 0x20);
   // start with first 5 bits of baseline tracking
   this->write_byte(MPR121_ECR, 0x8F);
+
+  if (this->irq_pin_ != nullptr) {
+    this->irq_pin_->setup();
+    this->irq_pin_->attach_interrupt(MPR121IRQStore::gpio_intr, &this->store_, FALLING);
+    // read once, which also releases IRQ if it's already low
+    this->store_.triggered = true;
+  }
 }
 
 void MPR121Component::dump_config() {
   ESP_LOGCONFIG(TAG, "MPR121:");
   LOG_I2C_DEVICE(this);
+  LOG_PIN("  IRQ Pin: ", this->irq_pin_);
   switch (this->error_code_) {
     case COMMUNICATION_FAILED:
       ESP_LOGE(TAG, "Communication with MPR121 failed!");
@@ -102,6 +111,13 @@ uint16_t MPR121Component::read_mpr121_channels_() {
 }
 
 void MPR121Component::loop() {
+  if (this->irq_pin_ != nullptr) {
+    // IRQ stays low until the status is read, also catch edges that happened before the interrupt was attached
+    if (!this->store_.triggered && this->irq_pin_->digital_read())
+      return;
+    this->store_.triggered = false;
+  }
+
   this->currtouched_ = this->read_mpr121_channels_();
   if (this->currtouched_ != this->lasttouched_) {
     this->process_(&currtouched_, &lasttouched_);
@@ -110,6 +126,13 @@ void MPR121Component::loop() {
   this->lasttouched_ = this->currtouched_;
 }
 
+void MPR121Component::set_irq_pin(GPIOPin *irq_pin) { this->irq_pin_ = irq_pin; }
+
+void ICACHE_RAM_ATTR HOT MPR121IRQStore::gpio_intr(MPR121IRQStore *arg) {
+  arg->triggered = true;
+  wake_loop();
+}
+
 }  // namespace binary_sensor
 
 ESPHOME_NAMESPACE_END
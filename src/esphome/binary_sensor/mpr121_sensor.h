@@ -8,6 +8,7 @@
 #include "esphome/binary_sensor/binary_sensor.h"
 #include "esphome/i2c_component.h"
 #include "esphome/component.h"
+#include "esphome/esphal.h"
 
 ESPHOME_NAMESPACE_BEGIN
 
@@ -60,10 +61,22 @@ class MPR121Channel : public binary_sensor::BinarySensor {
   int channel_ = 0;
 };
 
+/// Set by the interrupt of the IRQ pin, the MPR121 pulls it low when the touch status changed.
+struct MPR121IRQStore {
+  volatile bool triggered{false};
+
+  static void gpio_intr(MPR121IRQStore *arg);
+};
+
 class MPR121Component : public Component, public I2CDevice {
  public:
   MPR121Component(I2CComponent *parent, uint8_t address = 0x5A);
   binary_sensor::MPR121Channel *add_channel(binary_sensor::MPR121Channel *channel);
+  /** Only read the touch status after the MPR121 signals a change on its IRQ pin.
+   *
+   * Without it the status is read over I2C on every loop iteration.
+   */
+  void set_irq_pin(GPIOPin *irq_pin);
   void setup() override;
   void dump_config() override;
   float get_setup_priority() const override;
@@ -71,6 +84,8 @@ class MPR121Component : public Component, public I2CDevice {
 
  protected:
   std::vector<MPR121Channel *> channels_{};
+  GPIOPin *irq_pin_{nullptr};
+  MPR121IRQStore store_;
   uint16_t lasttouched_ = 0;
   uint16_t currtouched_ = 0;
   enum ErrorCode {
@@ -5,6 +5,10 @@
 #include "esphome/binary_sensor/mqtt_binary_sensor_component.h"
 #include "esphome/log.h"
 
+#ifdef USE_API
+#include "esphome/api/subscribe_state.h"
+#endif
+
 ESPHOME_NAMESPACE_BEGIN
 
 namespace binary_sensor {
@@ -46,8 +50,13 @@ bool MQTTBinarySensorComponent::publish_state(bool state) {
   if (this->is_status_)
     return true;
 
+#ifdef USE_API
+  this->publish_binary_state_([this, state](api::APIBuffer &buffer) {
+    api::encode_binary_sensor_state(buffer, this->binary_sensor_, state);
+  });
+#endif
   const char *state_s = state ? "ON" : "OFF";
-  return this->publish(this->get_state_topic_(), state_s);
+  return this->publish(this->get_state_topic_(), state_s, strlen(state_s));
 }
 void MQTTBinarySensorComponent::set_is_status(bool status) { this->is_status_ = status; }
 
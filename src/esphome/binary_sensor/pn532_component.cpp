@@ -30,6 +30,8 @@ void format_uid(char *buf, const uint8_t *uid, uint8_t uid_length) {
 void PN532Component::setup() {
   ESP_LOGCONFIG(TAG, "Setting up PN532...");
   this->spi_setup();
+  if (this->irq_pin_ != nullptr)
+    this->irq_pin_->setup();
 
   // Wake the chip up from power down
   // 1. Enable the SS line for at least 2ms
@@ -95,6 +97,10 @@ void PN532Component::setup() {
 }
 
 void PN532Component::update() {
+  if (this->irq_pin_ != nullptr && this->requested_read_)
+    // still listening, the PN532 raises IRQ as soon as a tag is presented
+    return;
+
   bool success = this->pn532_write_command_check_ack_({
       0x4A,  // INLISTPASSIVETARGET
       0x01,  // max 1 card
@@ -135,22 +141,37 @@ void PN532Component::loop() {
     return;
   }
 
-  bool report = true;
-  // 1. Go through all triggers
-  for (auto *trigger : this->triggers_)
-    trigger->process(nfcid, nfcid_length);
+  this->process_tag_(nfcid, nfcid_length);
+}
+void PN532Component::process_tag_(const uint8_t *nfcid, uint8_t nfcid_length) {
+  const uint32_t now = millis();
+  // a tag that stays on the reader is read again on every update
+  const bool repeated = nfcid_length == this->last_uid_.size() &&
+                        std::equal(nfcid, nfcid + nfcid_length, this->last_uid_.begin()) &&
+                        now - this->last_read_ <= this->get_update_interval() * 2;
+  this->last_uid_.assign(nfcid, nfcid + nfcid_length);
+  this->last_read_ = now;
 
-  // 2. Find a binary sensor
-  for (auto *tag : this->binary_sensors_) {
-    if (tag->process(nfcid, nfcid_length)) {
-      // 2.1 if found, do not dump
-      report = false;
-    }
+  char buf[32];
+  buf[0] = '\0';
+  if (!repeated && !this->triggers_.empty()) {
+    format_uid(buf, nfcid, nfcid_length);
+    const std::string uid(buf);
+    for (auto *trigger : this->triggers_)
+      trigger->trigger(uid);
   }
 
-  if (report) {
-    char buf[32];
-    format_uid(buf, nfcid, nfcid_length);
+  // the binary sensors are refreshed on every read, they turn off when the tag isn't read anymore
+  auto it = this->tag_table_.find(fnv1_hash(reinterpret_cast<const char *>(nfcid), nfcid_length));
+  bool found = false;
+  if (it != this->tag_table_.end()) {
+    for (auto *tag : it->second)
+      found |= tag->process(nfcid, nfcid_length);
+  }
+
+  if (!found && !repeated) {
+    if (buf[0] == '\0')
+      format_uid(buf, nfcid, nfcid_length);
     ESP_LOGD(TAG, "Found new tag '%s'", buf);
   }
 }
@@ -160,9 +181,12 @@ float PN532Component::get_setup_priority() const { return setup_priority::HARDWA
 PN532BinarySensor *PN532Component::make_tag(const std::string &name, const std::vector<uint8_t> &uid) {
   auto *tag = new PN532BinarySensor(name, uid, this->get_update_interval());
   this->binary_sensors_.push_back(tag);
+  this->tag_table_[fnv1_hash(reinterpret_cast<const char *>(uid.data()), uid.size())].push_back(tag);
   return tag;
 }
 
+void PN532Component::set_irq_pin(GPIOPin *irq_pin) { this->irq_pin_ = irq_pin; }
+
 PN532Trigger *PN532Component::make_trigger() {
   auto *trigger = new PN532Trigger();
   this->triggers_.push_back(trigger);
@@ -303,6 +327,10 @@ std::vector<uint8_t> PN532Component::pn532_read_data_() {
   return ret;
 }
 bool PN532Component::is_ready_() {
+  if (this->irq_pin_ != nullptr)
+    // IRQ is low while the PN532 has data for us
+    return !this->irq_pin_->digital_read();
+
   this->enable();
   // First byte, communication mode: Read state
   this->write_byte(0x02);
@@ -367,6 +395,7 @@ void PN532Component::dump_config() {
   }
 
   LOG_PIN("  CS Pin: ", this->cs_);
+  LOG_PIN("  IRQ Pin: ", this->irq_pin_);
   LOG_UPDATE_INTERVAL(this);
 
   for (auto *child : this->binary_sensors_) {
@@ -394,11 +423,6 @@ bool PN532BinarySensor::process(const uint8_t *data, uint8_t len) {
   this->publish_state(false);
   return true;
 }
-void PN532Trigger::process(const uint8_t *uid, uint8_t uid_length) {
-  char buf[32];
-  format_uid(buf, uid, uid_length);
-  this->trigger(std::string(buf));
-}
 
 }  // namespace binary_sensor
 
@@ -5,6 +5,7 @@
 
 #ifdef USE_PN532
 
+#include <unordered_map>
 #include <vector>
 #include "esphome/component.h"
 #include "esphome/binary_sensor/binary_sensor.h"
@@ -33,6 +34,14 @@ class PN532Component : public PollingComponent, public SPIDevice {
   PN532BinarySensor *make_tag(const std::string &name, const std::vector<uint8_t> &uid);
   PN532Trigger *make_trigger();
 
+  /** Use the IRQ pin of the PN532 to know when it has data, instead of asking it over SPI.
+   *
+   * The PN532 keeps listening for a tag after each InListPassiveTarget command and pulls IRQ low as soon as one is
+   * presented, so new tags are read within a few ms instead of on the next update, without SPI traffic while
+   * waiting. Tags that stay on the reader are read again once per update interval.
+   */
+  void set_irq_pin(GPIOPin *irq_pin);
+
  protected:
   bool is_device_msb_first() override;
 
@@ -63,9 +72,18 @@ class PN532Component : public PollingComponent, public SPIDevice {
 
   bool read_ack_();
 
+  /// Process a tag read by InListPassiveTarget.
+  void process_tag_(const uint8_t *nfcid, uint8_t nfcid_length);
+
+  GPIOPin *irq_pin_{nullptr};
   bool requested_read_{false};
   std::vector<PN532BinarySensor *> binary_sensors_;
+  /// The binary sensors by the hash of their UID.
+  std::unordered_map<uint32_t, std::vector<PN532BinarySensor *>> tag_table_;
   std::vector<PN532Trigger *> triggers_;
+  /// The UID and time of the last read, to fire the triggers only once while a tag stays on the reader.
+  std::vector<uint8_t> last_uid_;
+  uint32_t last_read_{0};
   enum PN532Error {
     NONE = 0,
     WAKEUP_FAILED,
@@ -83,10 +101,7 @@ class PN532BinarySensor : public binary_sensor::BinarySensor {
   std::vector<uint8_t> uid_;
 };
 
-class PN532Trigger : public Trigger<std::string> {
- public:
-  void process(const uint8_t *uid, uint8_t uid_length);
-};
+class PN532Trigger : public Trigger<std::string> {};
 
 }  // namespace binary_sensor
 
@@ -5,6 +5,7 @@
 
 #ifdef USE_RDM6300
 
+#include <unordered_map>
 #include "esphome/uart_component.h"
 #include "esphome/binary_sensor/binary_sensor.h"
 
@@ -18,17 +19,24 @@ class RDM6300Component : public Component, public UARTDevice {
  public:
   RDM6300Component(UARTComponent *parent);
 
-  void loop() override;
+  void setup() override;
 
   RDM6300BinarySensor *make_card(const std::string &name, uint32_t id);
 
   float get_setup_priority() const override;
 
  protected:
-  int8_t read_state_{-1};
+  /// Decode the hex digits of a frame into buffer_ and verify its checksum.
+  bool decode_frame_(const uint8_t *data);
+  void process_frame_();
+
+  UARTFrameParser parser_;
   uint8_t buffer_[6];
-  std::vector<RDM6300BinarySensor *> cards_;
+  /// The binary sensors by card ID.
+  std::unordered_map<uint32_t, std::vector<RDM6300BinarySensor *>> cards_;
+  /// The ID and time of the last frame, the reader repeats the frame while the card is in range.
   uint32_t last_id_{0};
+  uint32_t last_frame_{0};
 };
 
 class RDM6300BinarySensor : public BinarySensor {
@@ -24,11 +24,19 @@ void TTP229LSFComponent::setup() {
     this->mark_failed();
     return;
   }
+
+  if (this->irq_pin_ != nullptr) {
+    this->irq_pin_->setup();
+    this->irq_pin_->attach_interrupt(TTP229IRQStore::gpio_intr, &this->store_, CHANGE);
+    // read the initial state once
+    this->store_.triggered = true;
+  }
 }
 
 void TTP229LSFComponent::dump_config() {
   ESP_LOGCONFIG(TAG, "ttp229:");
   LOG_I2C_DEVICE(this);
+  LOG_PIN("  IRQ Pin: ", this->irq_pin_);
   switch (this->error_code_) {
     case COMMUNICATION_FAILED:
       ESP_LOGE(TAG, "Communication with TTP229 failed!");
@@ -47,8 +55,16 @@ TTP229Channel *TTP229LSFComponent::add_channel(binary_sensor::TTP229Channel *cha
 }
 
 void TTP229LSFComponent::loop() {
+  if (this->irq_pin_ != nullptr) {
+    if (!this->store_.triggered)
+      return;
+    this->store_.triggered = false;
+  }
+
   uint16_t touched = 0;
   if (!this->parent_->raw_receive_16(this->address_, &touched, 1)) {
+    // try again on the next iteration
+    this->store_.triggered = true;
     this->status_set_warning();
     return;
   }
@@ -59,6 +75,13 @@ void TTP229LSFComponent::loop() {
   }
 }
 
+void TTP229LSFComponent::set_irq_pin(GPIOPin *irq_pin) { this->irq_pin_ = irq_pin; }
+
+void ICACHE_RAM_ATTR HOT TTP229IRQStore::gpio_intr(TTP229IRQStore *arg) {
+  arg->triggered = true;
+  wake_loop();
+}
+
 }  // namespace binary_sensor
 
 ESPHOME_NAMESPACE_END
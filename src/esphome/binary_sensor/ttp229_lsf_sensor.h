@@ -8,6 +8,7 @@
 #include "esphome/binary_sensor/binary_sensor.h"
 #include "esphome/i2c_component.h"
 #include "esphome/component.h"
+#include "esphome/esphal.h"
 
 ESPHOME_NAMESPACE_BEGIN
 
@@ -22,10 +23,22 @@ class TTP229Channel : public binary_sensor::BinarySensor {
   int channel_;
 };
 
+/// Set by the interrupt of the IRQ pin when the keys changed.
+struct TTP229IRQStore {
+  volatile bool triggered{false};
+
+  static void gpio_intr(TTP229IRQStore *arg);
+};
+
 class TTP229LSFComponent : public Component, public I2CDevice {
  public:
   TTP229LSFComponent(I2CComponent *parent, uint8_t address);
   binary_sensor::TTP229Channel *add_channel(binary_sensor::TTP229Channel *channel);
+  /** Only read the keys after an edge on the IRQ pin of the TTP229.
+   *
+   * Without it the keys are read over I2C on every loop iteration.
+   */
+  void set_irq_pin(GPIOPin *irq_pin);
   void setup() override;
   void dump_config() override;
   float get_setup_priority() const override;
@@ -33,6 +46,8 @@ class TTP229LSFComponent : public Component, public I2CDevice {
 
  protected:
   std::vector<TTP229Channel *> channels_{};
+  GPIOPin *irq_pin_{nullptr};
+  TTP229IRQStore store_;
   enum ErrorCode {
     NONE = 0,
     COMMUNICATION_FAILED,
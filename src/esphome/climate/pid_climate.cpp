@@ -0,0 +1,170 @@
+#include "esphome/defines.h"
+
+#ifdef USE_PID_CLIMATE
+
+#include "esphome/climate/pid_climate.h"
+#include "esphome/espmath.h"
+#include "esphome/helpers.h"
+#include "esphome/log.h"
+
+ESPHOME_NAMESPACE_BEGIN
+
+namespace climate {
+
+static const char *TAG = "climate.pid";
+
+PIDClimate::PIDClimate(const std::string &name) : ClimateDevice(name) {}
+
+void PIDClimate::setup() {
+  // the sensor only provides the measurement, the loop runs at its own rate
+  this->sensor_->add_on_state_callback([this](float state) { this->current_temperature = state; });
+  this->current_temperature = this->sensor_->state;
+
+  auto restore = this->restore_state_();
+  if (restore.has_value()) {
+    restore->to_call(this).perform();
+  } else {
+    if (this->heat_.is_configured() && this->cool_.is_configured()) {
+      this->mode = CLIMATE_MODE_AUTO;
+    } else {
+      this->mode = this->heat_.is_configured() ? CLIMATE_MODE_HEAT : CLIMATE_MODE_COOL;
+    }
+    this->target_temperature = this->default_target_temperature_;
+    this->publish_state();
+  }
+
+  this->set_interval("update", this->sample_interval_, [this]() { this->update_(); });
+}
+void PIDClimate::dump_config() {
+  ESP_LOGCONFIG(TAG, "PID Climate '%s':", this->get_name().c_str());
+  ESP_LOGCONFIG(TAG, "  Gains: kp=%.4f, ki=%.5f, kd=%.4f", this->kp_, this->ki_, this->kd_);
+  ESP_LOGCONFIG(TAG, "  Sample Interval: %u ms", this->sample_interval_);
+  ESP_LOGCONFIG(TAG, "  Heat Output: %s", this->heat_.get_type());
+  ESP_LOGCONFIG(TAG, "  Cool Output: %s", this->cool_.get_type());
+  if (this->heat_.binary != nullptr || this->cool_.binary != nullptr) {
+    ESP_LOGCONFIG(TAG, "  Cycle Time: %u s", this->cycle_time_ / 1000);
+    ESP_LOGCONFIG(TAG, "  Min On Time: %u s", this->min_on_time_ / 1000);
+    ESP_LOGCONFIG(TAG, "  Min Off Time: %u s", this->min_off_time_ / 1000);
+  }
+}
+void PIDClimate::control(const ClimateCall &call) {
+  if (call.get_mode().has_value() && *call.get_mode() != this->mode) {
+    this->mode = *call.get_mode();
+    this->reset_();
+  }
+  if (call.get_target_temperature().has_value())
+    this->target_temperature = *call.get_target_temperature();
+
+  // the outputs follow with the next sample
+  this->publish_state();
+}
+ClimateTraits PIDClimate::traits() {
+  auto traits = ClimateTraits();
+  traits.set_supports_current_temperature(true);
+  traits.set_supports_auto_mode(this->heat_.is_configured() && this->cool_.is_configured());
+  traits.set_supports_heat_mode(this->heat_.is_configured());
+  traits.set_supports_cool_mode(this->cool_.is_configured());
+  traits.set_supports_two_point_target_temperature(false);
+  traits.set_supports_away(false);
+  return traits;
+}
+
+void PIDClimate::update_() {
+  const uint32_t now = millis();
+  const float temperature = this->current_temperature;
+  if (this->mode == CLIMATE_MODE_OFF || isnan(temperature) || isnan(this->target_temperature)) {
+    this->reset_();
+  } else {
+    const float dt = this->sample_interval_ / 1000.0f;
+    const float error = this->target_temperature - temperature;
+    // the derivative of the measurement instead of the error, so that changing the target doesn't kick the output
+    float derivative = 0.0f;
+    if (!isnan(this->previous_temperature_))
+      derivative = (temperature - this->previous_temperature_) / dt;
+    this->previous_temperature_ = temperature;
+
+    float min_output = this->mode == CLIMATE_MODE_HEAT ? 0.0f : -1.0f;
+    float max_output = this->mode == CLIMATE_MODE_COOL ? 0.0f : 1.0f;
+    if (!this->heat_.is_configured())
+      max_output = 0.0f;
+    if (!this->cool_.is_configured())
+      min_output = 0.0f;
+
+    // clamping the integral term to the output range prevents windup while an output is saturated
+    this->integral_ = clamp(min_output, max_output, this->integral_ + this->ki_ * error * dt);
+    this->output_ = clamp(min_output, max_output, this->kp_ * error + this->integral_ - this->kd_ * derivative);
+    ESP_LOGV(TAG, "'%s' - error=%.2f integral=%.3f output=%.3f", this->get_name().c_str(), error, this->integral_,
+             this->output_);
+  }
+
+  if (now - this->cycle_start_ >= this->cycle_time_)
+    this->cycle_start_ = now;
+  this->write_actuator_(this->heat_, std::max(this->output_, 0.0f), now);
+  this->write_actuator_(this->cool_, std::max(-this->output_, 0.0f), now);
+
+  if (temperature != this->published_temperature_ && !(isnan(temperature) && isnan(this->published_temperature_))) {
+    this->published_temperature_ = temperature;
+    this->publish_state();
+  }
+}
+void PIDClimate::write_actuator_(Actuator &actuator, float duty, uint32_t now) {
+  if (actuator.level != nullptr) {
+    actuator.level->set_level(duty);
+    return;
+  }
+  if (actuator.binary == nullptr)
+    return;
+
+  // on for the first duty * cycle_time of each cycle
+  const bool should_be_on = now - this->cycle_start_ < duty * this->cycle_time_;
+  if (should_be_on == actuator.on)
+    return;
+  const uint32_t min_time = actuator.on ? this->min_on_time_ : this->min_off_time_;
+  if (now - actuator.last_switch < min_time)
+    return;
+
+  actuator.on = should_be_on;
+  actuator.last_switch = now;
+  if (should_be_on) {
+    actuator.binary->turn_on();
+  } else {
+    actuator.binary->turn_off();
+  }
+}
+void PIDClimate::reset_() {
+  this->integral_ = 0.0f;
+  this->output_ = 0.0f;
+  this->previous_temperature_ = NAN;
+}
+
+const char *PIDClimate::Actuator::get_type() const {
+  if (this->binary != nullptr)
+    return "time proportioned";
+  if (this->level != nullptr)
+    return "level";
+  return "none";
+}
+
+void PIDClimate::set_sensor(sensor::Sensor *sensor) { this->sensor_ = sensor; }
+void PIDClimate::set_heat_output(output::BinaryOutput *heat_output) { this->heat_.binary = heat_output; }
+void PIDClimate::set_heat_output(output::FloatOutput *heat_output) { this->heat_.level = heat_output; }
+void PIDClimate::set_cool_output(output::BinaryOutput *cool_output) { this->cool_.binary = cool_output; }
+void PIDClimate::set_cool_output(output::FloatOutput *cool_output) { this->cool_.level = cool_output; }
+void PIDClimate::set_gains(float kp, float ki, float kd) {
+  this->kp_ = kp;
+  this->ki_ = ki;
+  this->kd_ = kd;
+}
+void PIDClimate::set_sample_interval(uint32_t sample_interval) { this->sample_interval_ = sample_interval; }
+void PIDClimate::set_cycle_time(uint32_t cycle_time) { this->cycle_time_ = cycle_time; }
+void PIDClimate::set_min_on_time(uint32_t min_on_time) { this->min_on_time_ = min_on_time; }
+void PIDClimate::set_min_off_time(uint32_t min_off_time) { this->min_off_time_ = min_off_time; }
+void PIDClimate::set_default_target_temperature(float default_target_temperature) {
+  this->default_target_temperature_ = default_target_temperature;
+}
+
+}  // namespace climate
+
+ESPHOME_NAMESPACE_END
+
+#endif  // USE_PID_CLIMATE
@@ -0,0 +1,103 @@
+#ifndef ESPHOME_CORE_PID_CLIMATE_H
+#define ESPHOME_CORE_PID_CLIMATE_H
+
+#include "esphome/defines.h"
+
+#ifdef USE_PID_CLIMATE
+
+#include "esphome/component.h"
+#include "esphome/climate/climate_device.h"
+#include "esphome/output/binary_output.h"
+#include "esphome/output/float_output.h"
+#include "esphome/sensor/sensor.h"
+
+ESPHOME_NAMESPACE_BEGIN
+
+namespace climate {
+
+/** A climate controller that holds a single target temperature with a PID loop.
+ *
+ * The loop runs at a fixed sample interval, independent of how often the sensor reports. Its output goes to a
+ * heating and/or a cooling output: FloatOutputs get the output as their level, BinaryOutputs are switched
+ * on for that fraction of each cycle (time proportioning) but never for less than the minimum on time or off for
+ * less than the minimum off time, to spare relays and compressors.
+ *
+ * The state is published at most once per sample interval.
+ */
+class PIDClimate : public ClimateDevice, public Component {
+ public:
+  PIDClimate(const std::string &name);
+
+  void set_sensor(sensor::Sensor *sensor);
+  /// Drive heating with a time-proportioned binary output, for example a relay.
+  void set_heat_output(output::BinaryOutput *heat_output);
+  /// Drive heating with the level of a float output.
+  void set_heat_output(output::FloatOutput *heat_output);
+  void set_cool_output(output::BinaryOutput *cool_output);
+  void set_cool_output(output::FloatOutput *cool_output);
+
+  /// Set the PID gains, in output (0-1) per °C, per °C*s and per °C/s.
+  void set_gains(float kp, float ki, float kd);
+  /// How often the PID loop runs in ms, defaults to 10s.
+  void set_sample_interval(uint32_t sample_interval);
+  /// The time proportioning cycle of binary outputs in ms, defaults to 10 minutes.
+  void set_cycle_time(uint32_t cycle_time);
+  /// The shortest time binary outputs stay on and off in ms, both default to 2 minutes.
+  void set_min_on_time(uint32_t min_on_time);
+  void set_min_off_time(uint32_t min_off_time);
+  /// The target temperature if none can be restored.
+  void set_default_target_temperature(float default_target_temperature);
+
+  void setup() override;
+  void dump_config() override;
+
+ protected:
+  /// One direction of the controller (heating or cooling).
+  struct Actuator {
+    output::BinaryOutput *binary{nullptr};
+    output::FloatOutput *level{nullptr};
+    /// The state of a binary output and when it was last switched.
+    bool on{false};
+    uint32_t last_switch{0};
+
+    bool is_configured() const { return this->binary != nullptr || this->level != nullptr; }
+    const char *get_type() const;
+  };
+
+  void control(const ClimateCall &call) override;
+  ClimateTraits traits() override;
+
+  /// Run one iteration of the PID loop.
+  void update_();
+  /// Drive an actuator with the given duty cycle (0-1).
+  void write_actuator_(Actuator &actuator, float duty, uint32_t now);
+  void reset_();
+
+  sensor::Sensor *sensor_{nullptr};
+  Actuator heat_;
+  Actuator cool_;
+
+  float kp_{0.5f};
+  float ki_{0.001f};
+  float kd_{0.0f};
+  uint32_t sample_interval_{10000};
+  uint32_t cycle_time_{600000};
+  uint32_t min_on_time_{120000};
+  uint32_t min_off_time_{120000};
+  float default_target_temperature_{NAN};
+
+  float integral_{0.0f};
+  float previous_temperature_{NAN};
+  uint32_t cycle_start_{0};
+  /// The output of the last iteration, positive for heating and negative for cooling.
+  float output_{0.0f};
+  float published_temperature_{NAN};
+};
+
+}  // namespace climate
+
+ESPHOME_NAMESPACE_END
+
+#endif  // USE_PID_CLIMATE
+
+#endif  // ESPHOME_CORE_PID_CLIMATE_H
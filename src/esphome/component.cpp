@@ -1,6 +1,6 @@
-#include <algorithm>
 #include "esphome/component.h"
 
+#include "esphome/application.h"
 #include "esphome/esphal.h"
 #include "esphome/log.h"
 #include "esphome/helpers.h"
@@ -33,115 +33,59 @@ const uint32_t STATUS_LED_WARNING = 0x0100;
 const uint32_t STATUS_LED_ERROR = 0x0200;
 
 uint32_t global_state = 0;
+bool global_state_dirty = false;
 
 float Component::get_loop_priority() const { return 0.0f; }
 
 float Component::get_setup_priority() const { return setup_priority::HARDWARE_LATE; }
 
+uint32_t Component::get_loop_idle_time() { return 0; }
+
 void Component::setup() {}
 
 void Component::loop() {}
 
 void Component::set_interval(const std::string &name, uint32_t interval, std::function<void()> &&f) {  // NOLINT
-  const uint32_t now = millis();
-  // only put offset in lower half
-  uint32_t offset = 0;
-  if (interval != 0)
-    offset = (random_uint32() % interval) / 2;
-  ESP_LOGVV(TAG, "set_interval(name='%s', interval=%u, offset=%u)", name.c_str(), interval, offset);
-
-  if (!name.empty()) {
-    this->cancel_interval(name);
-  }
-  struct TimeFunction function = {
-      .name = name,
-      .type = TimeFunction::INTERVAL,
-      .interval = interval,
-      .last_execution = now - interval - offset,
-      .f = std::move(f),
-      .remove = false,
-  };
-  this->time_functions_.push_back(function);
+  App.scheduler.set_interval(this, name, interval, std::move(f));
 }
 
 bool Component::cancel_interval(const std::string &name) {  // NOLINT
-  return this->cancel_time_function_(name, TimeFunction::INTERVAL);
+  return App.scheduler.cancel_interval(this, name);
 }
 
 void Component::set_timeout(const std::string &name, uint32_t timeout, std::function<void()> &&f) {  // NOLINT
-  const uint32_t now = millis();
-  ESP_LOGVV(TAG, "set_timeout(name='%s', timeout=%u)", name.c_str(), timeout);
-
-  if (!name.empty()) {
-    this->cancel_timeout(name);
-  }
-  struct TimeFunction function = {
-      .name = name,
-      .type = TimeFunction::TIMEOUT,
-      .interval = timeout,
-      .last_execution = now,
-      .f = std::move(f),
-      .remove = false,
-  };
-  this->time_functions_.push_back(function);
+  App.scheduler.set_timeout(this, name, timeout, std::move(f));
 }
 
 bool Component::cancel_timeout(const std::string &name) {  // NOLINT
-  return this->cancel_time_function_(name, TimeFunction::TIMEOUT);
+  return App.scheduler.cancel_timeout(this, name);
 }
 
 void Component::call_loop() {
+#ifdef USE_HEAP_TRACER
+  const uint32_t free_heap = ESP.getFreeHeap();
+#endif
   this->loop_internal_();
   this->loop();
+#ifdef USE_HEAP_TRACER
+  this->heap_stats.record(free_heap, ESP.getFreeHeap());
+#endif
 }
 
-bool Component::cancel_time_function_(const std::string &name, TimeFunction::Type type) {
-  // NOLINTNEXTLINE
-  for (auto iter = this->time_functions_.begin(); iter != this->time_functions_.end(); iter++) {
-    if (!iter->remove && iter->name == name && iter->type == type) {
-      ESP_LOGVV(TAG, "Removing old time function %s.", iter->name.c_str());
-      iter->remove = true;
-      return true;
-    }
-  }
-  return false;
-}
 void Component::call_setup() {
+#ifdef USE_HEAP_TRACER
+  const uint32_t free_heap = ESP.getFreeHeap();
+#endif
   this->setup_internal_();
   this->setup();
+#ifdef USE_HEAP_TRACER
+  this->heap_stats.record(free_heap, ESP.getFreeHeap());
+#endif
 }
 uint32_t Component::get_component_state() const { return this->component_state_; }
 void Component::loop_internal_() {
   this->component_state_ &= ~COMPONENT_STATE_MASK;
   this->component_state_ |= COMPONENT_STATE_LOOP;
-
-  for (unsigned int i = 0; i < this->time_functions_.size(); i++) {  // NOLINT
-    const uint32_t now = millis();
-    TimeFunction *tf = &this->time_functions_[i];
-    if (tf->should_run(now)) {
-#ifdef ESPHOME_LOG_HAS_VERY_VERBOSE
-      const char *type =
-          tf->type == TimeFunction::INTERVAL ? "interval" : (tf->type == TimeFunction::TIMEOUT ? "timeout" : "defer");
-      ESP_LOGVV(TAG, "Running %s '%s':%u with interval=%u last_execution=%u (now=%u)", type, tf->name.c_str(), i,
-                tf->interval, tf->last_execution, now);
-#endif
-
-      tf->f();
-      // The vector might have reallocated due to new items
-      tf = &this->time_functions_[i];
-
-      if (tf->type == TimeFunction::INTERVAL && tf->interval != 0) {
-        const uint32_t amount = (now - tf->last_execution) / tf->interval;
-        tf->last_execution += (amount * tf->interval);
-      } else if (tf->type == TimeFunction::DEFER || tf->type == TimeFunction::TIMEOUT) {
-        tf->remove = true;
-      }
-    }
-  }
-
-  this->time_functions_.erase(std::remove_if(this->time_functions_.begin(), this->time_functions_.end(),
-                                             [](const TimeFunction &tf) -> bool { return tf.remove; }),
-                              this->time_functions_.end());
 }
 void Component::setup_internal_() {
   this->component_state_ &= ~COMPONENT_STATE_MASK;
@@ -152,24 +96,14 @@ void Component::mark_failed() {
   this->component_state_ &= ~COMPONENT_STATE_MASK;
   this->component_state_ |= COMPONENT_STATE_FAILED;
   this->status_set_error();
+  App.schedule_looping_components_update();
 }
 void Component::defer(std::function<void()> &&f) { this->defer("", std::move(f)); }  // NOLINT
 bool Component::cancel_defer(const std::string &name) {                              // NOLINT
-  return this->cancel_time_function_(name, TimeFunction::DEFER);
+  return App.scheduler.cancel_defer(this, name);
 }
 void Component::defer(const std::string &name, std::function<void()> &&f) {  // NOLINT
-  if (!name.empty()) {
-    this->cancel_defer(name);
-  }
-  struct TimeFunction function = {
-      .name = name,
-      .type = TimeFunction::DEFER,
-      .interval = 0,
-      .last_execution = 0,
-      .f = std::move(f),
-      .remove = false,
-  };
-  this->time_functions_.push_back(function);
+  App.scheduler.defer(this, name, std::move(f));
 }
 void Component::set_timeout(uint32_t timeout, std::function<void()> &&f) {  // NOLINT
   this->set_timeout("", timeout, std::move(f));
@@ -179,12 +113,62 @@ void Component::set_interval(uint32_t interval, std::function<void()> &&f) {  //
 }
 bool Component::is_failed() { return (this->component_state_ & COMPONENT_STATE_MASK) == COMPONENT_STATE_FAILED; }
 bool Component::can_proceed() { return true; }
+void Component::add_setup_dependency(Component *dependency) {
+  this->setup_dependencies_.push_back(dependency);
+  this->explicit_setup_dependencies_ = true;
+}
+void Component::set_setup_independent() { this->explicit_setup_dependencies_ = true; }
+bool Component::has_explicit_setup_dependencies() const { return this->explicit_setup_dependencies_; }
+const std::vector<Component *> &Component::get_setup_dependencies() const { return this->setup_dependencies_; }
+void Component::skip_setup() { this->setup_skipped_ = true; }
+bool Component::is_setup_skipped() const { return this->setup_skipped_; }
+bool Component::is_setup_finished() {
+  if (this->is_failed() || this->setup_skipped_)
+    return true;
+  return (this->component_state_ & COMPONENT_STATE_MASK) != COMPONENT_STATE_CONSTRUCTION && this->can_proceed();
+}
+void Component::disable_loop() {
+  if (!this->loop_enabled_)
+    return;
+  this->loop_enabled_ = false;
+  App.schedule_looping_components_update();
+}
+void Component::enable_loop() {
+  if (this->loop_enabled_)
+    return;
+  this->loop_enabled_ = true;
+  App.schedule_looping_components_update();
+}
+bool Component::is_loop_enabled() const { return this->loop_enabled_; }
+void Component::set_component_source(const char *source) { this->component_source_ = source; }
+const char *Component::get_component_source() const {
+  if (this->component_source_ == nullptr)
+    return "<unknown>";
+  return this->component_source_;
+}
 bool Component::status_has_warning() { return this->component_state_ & STATUS_LED_WARNING; }
 bool Component::status_has_error() { return this->component_state_ & STATUS_LED_ERROR; }
-void Component::status_set_warning() { this->component_state_ |= STATUS_LED_WARNING; }
-void Component::status_set_error() { this->component_state_ |= STATUS_LED_ERROR; }
-void Component::status_clear_warning() { this->component_state_ &= ~STATUS_LED_WARNING; }
-void Component::status_clear_error() { this->component_state_ &= ~STATUS_LED_ERROR; }
+void Component::status_set_warning() {
+  this->component_state_ |= STATUS_LED_WARNING;
+  global_state |= STATUS_LED_WARNING;
+}
+void Component::status_set_error() {
+  this->component_state_ |= STATUS_LED_ERROR;
+  global_state |= STATUS_LED_ERROR;
+}
+void Component::status_clear_warning() {
+  if ((this->component_state_ & STATUS_LED_WARNING) == 0)
+    return;
+  this->component_state_ &= ~STATUS_LED_WARNING;
+  // other components may still have a warning
+  global_state_dirty = true;
+}
+void Component::status_clear_error() {
+  if ((this->component_state_ & STATUS_LED_ERROR) == 0)
+    return;
+  this->component_state_ &= ~STATUS_LED_ERROR;
+  global_state_dirty = true;
+}
 void Component::status_momentary_warning(const std::string &name, uint32_t length) {
   this->status_set_warning();
   this->set_timeout(name, length, [this]() { this->status_clear_warning(); });
@@ -199,6 +183,39 @@ float Component::get_actual_setup_priority() const {
 }
 void Component::set_setup_priority(float priority) { this->setup_priority_override_ = priority; }
 
+#ifdef USE_COMPONENT_PROFILER
+void HOT ComponentTimingStats::record(uint32_t duration_us) {
+  this->count++;
+  this->total_us += duration_us;
+  if (duration_us > this->max_us)
+    this->max_us = duration_us;
+
+  uint8_t bucket = 0;
+  while (duration_us > 1 && bucket < COMPONENT_TIMING_BUCKETS - 1) {
+    duration_us >>= 1;
+    bucket++;
+  }
+  if (this->histogram[bucket] != UINT16_MAX)
+    this->histogram[bucket]++;
+}
+void ComponentTimingStats::reset() { *this = ComponentTimingStats(); }
+#endif
+
+#ifdef USE_HEAP_TRACER
+void HOT ComponentHeapStats::record(uint32_t free_before, uint32_t free_after) {
+  if (free_after < free_before) {
+    const uint32_t allocated = free_before - free_after;
+    this->allocated += allocated;
+    if (allocated > this->max_allocation)
+      this->max_allocation = allocated;
+  } else {
+    this->freed += free_after - free_before;
+  }
+}
+int32_t ComponentHeapStats::get_retained() const { return int32_t(this->allocated - this->freed); }
+void ComponentHeapStats::reset() { *this = ComponentHeapStats(); }
+#endif
+
 PollingComponent::PollingComponent(uint32_t update_interval) : Component(), update_interval_(update_interval) {}
 
 void PollingComponent::call_setup() {
@@ -208,12 +225,21 @@ void PollingComponent::call_setup() {
   // Let the polling component subclass setup their HW.
   this->setup();
 
-  // Register interval.
-  this->set_interval("update", this->get_update_interval(), [this]() { this->update(); });
+  // Register interval, spread across the interval with the other polling components unless a phase was set.
+  const uint32_t update_interval = this->get_update_interval();
+  if (this->update_phase_ == SCHEDULER_DONT_RUN)
+    this->update_phase_ = App.scheduler.next_phase(update_interval);
+  App.scheduler.set_phased_interval(this, "update", update_interval, this->update_phase_, [this]() { this->update(); });
+
+  // Polling components that do all their work in update() opt out of loop() with their idle time.
+  if (this->get_loop_idle_time() == SCHEDULER_DONT_RUN)
+    this->disable_loop();
 }
 
 uint32_t PollingComponent::get_update_interval() const { return this->update_interval_; }
 void PollingComponent::set_update_interval(uint32_t update_interval) { this->update_interval_ = update_interval; }
+void PollingComponent::set_update_phase(uint32_t update_phase) { this->update_phase_ = update_phase; }
+uint32_t PollingComponent::get_update_phase() const { return this->update_phase_; }
 
 const std::string &Nameable::get_name() const { return this->name_; }
 void Nameable::set_name(const std::string &name) {
@@ -232,12 +258,4 @@ void Nameable::calc_object_id_() {
 }
 uint32_t Nameable::get_object_id_hash() { return this->object_id_hash_; }
 
-bool Component::TimeFunction::should_run(uint32_t now) const {
-  if (this->remove)
-    return false;
-  if (this->type == DEFER)
-    return true;
-  return this->interval != 4294967295UL && now - this->last_execution > this->interval;
-}
-
 ESPHOME_NAMESPACE_END
@@ -5,6 +5,7 @@
 #include <vector>
 #include "esphome/defines.h"
 #include "esphome/helpers.h"
+#include "esphome/scheduler.h"
 
 ESPHOME_NAMESPACE_BEGIN
 
@@ -34,9 +35,49 @@ extern const uint32_t STATUS_LED_WARNING;
 extern const uint32_t STATUS_LED_ERROR;
 
 extern uint32_t global_state;
+/// Set when a status bit of a component was cleared, the application then recomputes global_state.
+extern bool global_state_dirty;
 
 #define LOG_UPDATE_INTERVAL(this) ESP_LOGCONFIG(TAG, "  Update Interval: %u ms", this->get_update_interval());
 
+#ifdef USE_COMPONENT_PROFILER
+/// The number of log2 histogram buckets in ComponentTimingStats.
+#define COMPONENT_TIMING_BUCKETS 16
+
+/// Call count and execution time statistics of one kind of call (loop(), time functions) of a component.
+struct ComponentTimingStats {
+  uint32_t count{0};
+  uint64_t total_us{0};
+  uint32_t max_us{0};
+  /// Bucket i counts the calls that took [2^i, 2^(i+1)) µs, the last bucket also holds all longer calls.
+  uint16_t histogram[COMPONENT_TIMING_BUCKETS]{};
+
+  void record(uint32_t duration_us);
+  void reset();
+};
+#endif
+
+#ifdef USE_HEAP_TRACER
+/** How much heap a component consumed and released while it was running.
+ *
+ * Measured from the change of the free heap size around each call, so it includes all allocations made on behalf of
+ * the component (like strings and callbacks) but also anything that other tasks or interrupts allocated meanwhile.
+ */
+struct ComponentHeapStats {
+  /// Total decrease of the free heap across all calls, in bytes.
+  uint32_t allocated{0};
+  /// Total increase of the free heap across all calls, in bytes.
+  uint32_t freed{0};
+  /// The largest decrease of the free heap in a single call, in bytes.
+  uint32_t max_allocation{0};
+
+  void record(uint32_t free_before, uint32_t free_after);
+  /// The heap still held from the recorded calls, allocated minus freed.
+  int32_t get_retained() const;
+  void reset();
+};
+#endif
+
 /** The base class for all ESPHome components.
  *
  * ESPHome uses components to separate code for self-contained units such as
@@ -54,7 +95,7 @@ extern uint32_t global_state;
  *
  * @see Application::add_component()
  */
-class Component {
+class Component : public SetupAllocated {
  public:
   /** Where the component's initialization should happen.
    *
@@ -84,6 +125,25 @@ class Component {
 
   void set_setup_priority(float priority);
 
+  /** Only set up this component once the given component has been set up and can proceed.
+   *
+   * By default the setup of a component waits until all components with a higher setup priority can
+   * proceed, including WiFi while it's still connecting. Once a component declares its dependencies it only
+   * waits for those, so independent components are set up in the meantime.
+   */
+  void add_setup_dependency(Component *dependency);
+  /// Set this component up without waiting for any other component, see add_setup_dependency().
+  void set_setup_independent();
+  /// Whether the dependencies were declared with add_setup_dependency() or set_setup_independent().
+  bool has_explicit_setup_dependencies() const;
+  const std::vector<Component *> &get_setup_dependencies() const;
+  /// Whether setup() has been called (or skipped because the component failed) and it can proceed.
+  bool is_setup_finished();
+
+  /// Don't set up this component during this boot, for example because it isn't needed this deep sleep wake.
+  void skip_setup();
+  bool is_setup_skipped() const;
+
   /** priority of loop(). higher -> executed earlier
    *
    * Defaults to 0.
@@ -92,6 +152,17 @@ class Component {
    */
   virtual float get_loop_priority() const;
 
+  /** How long (in ms) loop() of this component can be skipped while the application is in idle mode.
+   *
+   * Defaults to 0, meaning the component wants loop() to be called at the regular loop interval.
+   * Components that only do work in time functions or after being woken up with wake_loop() can
+   * return a larger value, or SCHEDULER_DONT_RUN if they don't need loop() at all. Polling components
+   * returning SCHEDULER_DONT_RUN have their loop() disabled after setup, since update() is run by the scheduler.
+   *
+   * @see Application::set_idle_mode()
+   */
+  virtual uint32_t get_loop_idle_time();
+
   /** Public loop() functions. These will be called by the Application instance.
    *
    * Note: This should normally not be overriden, unless you know what you're doing.
@@ -100,7 +171,8 @@ class Component {
    * methods within their custom sensors. These methods should ALWAYS call the loop_internal()
    * and setup_internal() methods.
    *
-   * Basically, it handles stuff like interval/timeout functions and eventually calls loop().
+   * Basically, it handles the component state and eventually calls loop(). Interval/timeout
+   * functions are run by the application-wide Scheduler.
    */
   virtual void call_loop();
   virtual void call_setup();
@@ -117,6 +189,19 @@ class Component {
 
   bool is_failed();
 
+  /** Stop calling loop() of this component until enable_loop() is called.
+   *
+   * The application only iterates over components that have their loop enabled, so components
+   * that don't need loop() at all, or only need it temporarily (for example while a transition
+   * is running), should disable it to save loop overhead. Time functions are not affected.
+   */
+  void disable_loop();
+
+  /// Resume calling loop() of this component, see disable_loop().
+  void enable_loop();
+
+  bool is_loop_enabled() const;
+
   virtual bool can_proceed();
 
   bool status_has_warning();
@@ -135,6 +220,31 @@ class Component {
 
   void status_momentary_error(const std::string &name, uint32_t length = 5000);
 
+  /// Set a human-readable identifier for this component (like "sensor.dht"), used for diagnostics.
+  void set_component_source(const char *source);
+  const char *get_component_source() const;
+
+#ifdef USE_COMPONENT_PROFILER
+  /// Timing statistics of the loop() calls of this component.
+  ComponentTimingStats loop_stats;
+  /// Timing statistics of the timeout/interval/defer functions of this component.
+  ComponentTimingStats scheduler_stats;
+  /// How long setup() of this component took, in µs.
+  uint32_t setup_time_us{0};
+  /// When setup() was called, in ms since the application setup started.
+  uint32_t setup_start_ms{0};
+  /// How long this component's setup was held back waiting for other components, in ms.
+  uint32_t setup_wait_ms{0};
+  /// When this component could first proceed, in ms since the application setup started.
+  uint32_t setup_ready_ms{0};
+  /// The component this component's setup waited for last, nullptr if it didn't wait.
+  Component *setup_blocker{nullptr};
+#endif
+#ifdef USE_HEAP_TRACER
+  /// Heap consumed and released by setup(), loop() and the time functions of this component.
+  ComponentHeapStats heap_stats;
+#endif
+
  protected:
   /** Set an interval function with a unique name. Empty name means no cancelling possible.
    *
@@ -142,7 +252,7 @@ class Component {
    * Similar to javascript's setInterval().
    *
    * IMPORTANT: Do not rely on this having correct timing. This is only called from
-   * loop() and therefore can be significantly delay. If you need exact timing please
+   * the main loop and therefore can be significantly delay. If you need exact timing please
    * use hardware timers.
    *
    * @param name The identifier for this interval function.
@@ -169,7 +279,7 @@ class Component {
    * Similar to javascript's setTimeout(). Empty name means no cancelling possible.
    *
    * IMPORTANT: Do not rely on this having correct timing. This is only called from
-   * loop() and therefore can be significantly delay. If you need exact timing please
+   * the main loop and therefore can be significantly delay. If you need exact timing please
    * use hardware timers.
    *
    * @param name The identifier for this timeout function.
@@ -205,31 +315,13 @@ class Component {
   void loop_internal_();
   void setup_internal_();
 
-  /// Internal struct for storing timeout/interval functions.
-  struct TimeFunction {
-    std::string name;                             ///< The name/id of this TimeFunction.
-    enum Type { TIMEOUT, INTERVAL, DEFER } type;  ///< The type of this TimeFunction. Either TIMEOUT, INTERVAL or DEFER.
-    uint32_t interval;                            ///< The interval/timeout of this function.
-    /// The last execution for interval functions and the time, SetInterval was called, for timeout functions.
-    uint32_t last_execution;
-    std::function<void()> f;  ///< The function (or callback) itself.
-    bool remove;
-
-    bool should_run(uint32_t now) const;
-  };
-
-  /// Cancel an only time function. If name is empty, won't do anything.
-  bool cancel_time_function_(const std::string &name, TimeFunction::Type type);
-
-  /** Storage for interval/timeout functions.
-   *
-   * Intentionally a vector despite its map-like nature, because of the
-   * memory overhead.
-   */
-  std::vector<TimeFunction> time_functions_;
-
   uint32_t component_state_{0x0000};  ///< State of this component.
+  bool loop_enabled_{true};
+  const char *component_source_{nullptr};
   optional<float> setup_priority_override_;
+  std::vector<Component *> setup_dependencies_;
+  bool explicit_setup_dependencies_{false};
+  bool setup_skipped_{false};
 };
 
 /** This class simplifies creating components that periodically check a state.
@@ -254,6 +346,16 @@ class PollingComponent : public Component {
    */
   virtual void set_update_interval(uint32_t update_interval);
 
+  /** Set when in each update interval update() is called, in ms.
+   *
+   * By default polling components with the same update interval are spread evenly across it (see
+   * Scheduler::next_phase()), so that they don't all update in the same loop iteration. Components that should
+   * update together can be given the same phase.
+   *
+   * @param update_phase The offset into the update interval in ms.
+   */
+  void set_update_phase(uint32_t update_phase);
+
   // ========== OVERRIDE METHODS ==========
   // (You'll only need this when creating your own custom sensor)
   virtual void update() = 0;
@@ -264,13 +366,17 @@ class PollingComponent : public Component {
 
   /// Get the update interval in ms of this sensor
   virtual uint32_t get_update_interval() const;
+  /// Get the offset into the update interval at which update() is called, SCHEDULER_DONT_RUN before setup.
+  uint32_t get_update_phase() const;
 
  protected:
   uint32_t update_interval_;
+  /// SCHEDULER_DONT_RUN to pick one in setup.
+  uint32_t update_phase_{SCHEDULER_DONT_RUN};
 };
 
 /// Helper class that enables naming of objects so that it doesn't have to be re-implement every single time.
-class Nameable {
+class Nameable : public SetupAllocated {
  public:
   explicit Nameable(const std::string &name);
   const std::string &get_name() const;
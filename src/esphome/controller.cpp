@@ -1,7 +1,100 @@
 #include "esphome/controller.h"
+#include "esphome/application.h"
+#include "esphome/helpers.h"
 
 ESPHOME_NAMESPACE_BEGIN
 
+EntityStateNotifier EntityStateBus::register_entity(Nameable *obj, EntityType type) {
+  this->entities_.push_back(Entity{obj, type});
+  return EntityStateNotifier{this, uint16_t(this->entities_.size() - 1)};
+}
+uint8_t EntityStateBus::subscribe(Component *component) {
+  this->subscribers_.push_back(Subscriber{component, {}, 0});
+  return this->subscribers_.size() - 1;
+}
+void HOT EntityStateBus::mark_dirty(uint16_t id) {
+  const uint16_t word = id / 32;
+  const uint32_t bit = 1UL << (id % 32);
+  for (auto &sub : this->subscribers_) {
+    if (sub.dirty.size() <= word)
+      sub.dirty.resize((this->entities_.size() + 31) / 32);
+    if (sub.dirty[word] & bit)
+      continue;
+    if (word < sub.first_word)
+      sub.first_word = word;
+    sub.dirty[word] |= bit;
+    if (sub.component != nullptr)
+      sub.component->enable_loop();
+  }
+}
+bool EntityStateBus::pop_dirty(uint8_t subscriber, uint16_t *id) {
+  auto &sub = this->subscribers_[subscriber];
+  for (; sub.first_word < sub.dirty.size(); sub.first_word++) {
+    uint32_t &word = sub.dirty[sub.first_word];
+    if (word == 0)
+      continue;
+    const uint8_t bit = __builtin_ctz(word);
+    word &= ~(1UL << bit);
+    *id = sub.first_word * 32 + bit;
+    return true;
+  }
+  return false;
+}
+void EntityStateBus::clear_dirty(uint8_t subscriber) {
+  auto &sub = this->subscribers_[subscriber];
+  for (; sub.first_word < sub.dirty.size(); sub.first_word++)
+    sub.dirty[sub.first_word] = 0;
+}
+bool EntityStateBus::has_dirty(uint8_t subscriber) const {
+  const auto &sub = this->subscribers_[subscriber];
+  for (uint16_t word = sub.first_word; word < sub.dirty.size(); word++) {
+    if (sub.dirty[word] != 0)
+      return true;
+  }
+  return false;
+}
+Nameable *EntityStateBus::get_entity(uint16_t id) const { return this->entities_[id].obj; }
+EntityType EntityStateBus::get_entity_type(uint16_t id) const { return this->entities_[id].type; }
+size_t EntityStateBus::size() const { return this->entities_.size(); }
+uint32_t EntityStateBus::key_slot_(EntityType type, uint32_t key) {
+  // entities of different types can share an object id, so mix in the type
+  return key ^ (uint32_t(type) * 2654435761UL);
+}
+void EntityStateBus::build_key_table_() {
+  size_t size = 1;
+  while (size < this->entities_.size() * 2)
+    size <<= 1;
+  this->key_table_.assign(size, 0);
+  const uint32_t mask = size - 1;
+  for (size_t i = 0; i < this->entities_.size(); i++) {
+    const Entity &entity = this->entities_[i];
+    uint32_t slot = key_slot_(entity.type, entity.obj->get_object_id_hash()) & mask;
+    while (this->key_table_[slot] != 0)
+      slot = (slot + 1) & mask;
+    this->key_table_[slot] = i + 1;
+  }
+  this->key_table_entities_ = this->entities_.size();
+}
+Nameable *EntityStateBus::find_entity(EntityType type, uint32_t key) {
+  if (this->key_table_.empty() || this->key_table_entities_ != this->entities_.size())
+    this->build_key_table_();
+  const uint32_t mask = this->key_table_.size() - 1;
+  for (uint32_t slot = key_slot_(type, key) & mask; this->key_table_[slot] != 0; slot = (slot + 1) & mask) {
+    const Entity &entity = this->entities_[this->key_table_[slot] - 1];
+    if (entity.type == type && entity.obj->get_object_id_hash() == key)
+      return entity.obj;
+  }
+  return nullptr;
+}
+
+/// Look up a non-internal entity of the given type on the state bus.
+template<typename T> T *find_entity_by_key(EntityType type, uint32_t key) {
+  Nameable *obj = App.get_state_bus().find_entity(type, key);
+  if (obj == nullptr || obj->is_internal())
+    return nullptr;
+  return static_cast<T *>(obj);
+}
+
 #ifdef USE_BINARY_SENSOR
 void Controller::register_binary_sensor(binary_sensor::BinarySensor *obj) {}
 
@@ -10,15 +103,7 @@ void StoringController::register_binary_sensor(binary_sensor::BinarySensor *obj)
 }
 
 binary_sensor::BinarySensor *StoringController::get_binary_sensor_by_key(uint32_t key) {
-  for (auto *c : this->binary_sensors_) {
-    if (c->get_object_id_hash() == key && !c->is_internal())
-      return c;
-  }
-  return nullptr;
-}
-void StoringUpdateListenerController::register_binary_sensor(binary_sensor::BinarySensor *obj) {
-  StoringController::register_binary_sensor(obj);
-  obj->add_on_state_callback([this, obj](bool state) { this->on_binary_sensor_update(obj, state); });
+  return find_entity_by_key<binary_sensor::BinarySensor>(ENTITY_BINARY_SENSOR, key);
 }
 #endif
 
@@ -26,15 +111,7 @@ void StoringUpdateListenerController::register_binary_sensor(binary_sensor::Bina
 void Controller::register_fan(fan::FanState *obj) {}
 void StoringController::register_fan(fan::FanState *obj) { this->fans_.push_back(obj); }
 fan::FanState *StoringController::get_fan_by_key(uint32_t key) {
-  for (auto *c : this->fans_) {
-    if (c->get_object_id_hash() == key && !c->is_internal())
-      return c;
-  }
-  return nullptr;
-}
-void StoringUpdateListenerController::register_fan(fan::FanState *obj) {
-  StoringController::register_fan(obj);
-  obj->add_on_state_callback([this, obj]() { this->on_fan_update(obj); });
+  return find_entity_by_key<fan::FanState>(ENTITY_FAN, key);
 }
 #endif
 
@@ -42,15 +119,7 @@ void StoringUpdateListenerController::register_fan(fan::FanState *obj) {
 void Controller::register_light(light::LightState *obj) {}
 void StoringController::register_light(light::LightState *obj) { this->lights_.push_back(obj); }
 light::LightState *StoringController::get_light_by_key(uint32_t key) {
-  for (auto *c : this->lights_) {
-    if (c->get_object_id_hash() == key && !c->is_internal())
-      return c;
-  }
-  return nullptr;
-}
-void StoringUpdateListenerController::register_light(light::LightState *obj) {
-  StoringController::register_light(obj);
-  obj->add_new_remote_values_callback([this, obj]() { this->on_light_update(obj); });
+  return find_entity_by_key<light::LightState>(ENTITY_LIGHT, key);
 }
 #endif
 
@@ -58,15 +127,7 @@ void StoringUpdateListenerController::register_light(light::LightState *obj) {
 void Controller::register_sensor(sensor::Sensor *obj) {}
 void StoringController::register_sensor(sensor::Sensor *obj) { this->sensors_.push_back(obj); }
 sensor::Sensor *StoringController::get_sensor_by_key(uint32_t key) {
-  for (auto *c : this->sensors_) {
-    if (c->get_object_id_hash() == key && !c->is_internal())
-      return c;
-  }
-  return nullptr;
-}
-void StoringUpdateListenerController::register_sensor(sensor::Sensor *obj) {
-  StoringController::register_sensor(obj);
-  obj->add_on_state_callback([this, obj](float state) { this->on_sensor_update(obj, state); });
+  return find_entity_by_key<sensor::Sensor>(ENTITY_SENSOR, key);
 }
 #endif
 
@@ -74,15 +135,7 @@ void StoringUpdateListenerController::register_sensor(sensor::Sensor *obj) {
 void Controller::register_switch(switch_::Switch *obj) {}
 void StoringController::register_switch(switch_::Switch *obj) { this->switches_.push_back(obj); }
 switch_::Switch *StoringController::get_switch_by_key(uint32_t key) {
-  for (auto *c : this->switches_) {
-    if (c->get_object_id_hash() == key && !c->is_internal())
-      return c;
-  }
-  return nullptr;
-}
-void StoringUpdateListenerController::register_switch(switch_::Switch *obj) {
-  StoringController::register_switch(obj);
-  obj->add_on_state_callback([this, obj](bool state) { this->on_switch_update(obj, state); });
+  return find_entity_by_key<switch_::Switch>(ENTITY_SWITCH, key);
 }
 #endif
 
@@ -90,49 +143,147 @@ void StoringUpdateListenerController::register_switch(switch_::Switch *obj) {
 void Controller::register_cover(cover::Cover *cover) {}
 void StoringController::register_cover(cover::Cover *cover) { this->covers_.push_back(cover); }
 cover::Cover *StoringController::get_cover_by_key(uint32_t key) {
-  for (auto *c : this->covers_) {
-    if (c->get_object_id_hash() == key && !c->is_internal())
-      return c;
-  }
-  return nullptr;
-}
-void StoringUpdateListenerController::register_cover(cover::Cover *obj) {
-  StoringController::register_cover(obj);
-  obj->add_on_state_callback([this, obj]() { this->on_cover_update(obj); });
+  return find_entity_by_key<cover::Cover>(ENTITY_COVER, key);
 }
-void StoringUpdateListenerController::on_cover_update(cover::Cover *obj) {}
 #endif
 
 #ifdef USE_TEXT_SENSOR
 void Controller::register_text_sensor(text_sensor::TextSensor *obj) {}
 void StoringController::register_text_sensor(text_sensor::TextSensor *obj) { this->text_sensors_.push_back(obj); }
 text_sensor::TextSensor *StoringController::get_text_sensor_by_key(uint32_t key) {
-  for (auto *c : this->text_sensors_) {
-    if (c->get_object_id_hash() == key && !c->is_internal())
-      return c;
-  }
-  return nullptr;
-}
-void StoringUpdateListenerController::register_text_sensor(text_sensor::TextSensor *obj) {
-  StoringController::register_text_sensor(obj);
-  obj->add_on_state_callback([this, obj](std::string state) { this->on_text_sensor_update(obj, state); });
+  return find_entity_by_key<text_sensor::TextSensor>(ENTITY_TEXT_SENSOR, key);
 }
 #endif
 #ifdef USE_CLIMATE
 void Controller::register_climate(climate::ClimateDevice *obj) {}
 void StoringController::register_climate(climate::ClimateDevice *obj) { this->climates_.push_back(obj); }
 climate::ClimateDevice *StoringController::get_climate_by_key(uint32_t key) {
-  for (auto *c : this->climates_) {
-    if (c->get_object_id_hash() == key && !c->is_internal())
-      return c;
+  return find_entity_by_key<climate::ClimateDevice>(ENTITY_CLIMATE, key);
+}
+#endif
+
+#ifdef USE_COVER
+void StoringUpdateListenerController::on_cover_update(cover::Cover *obj) {}
+#endif
+#ifdef USE_CLIMATE
+void StoringUpdateListenerController::on_climate_update(climate::ClimateDevice *obj) {}
+#endif
+
+#ifdef USE_SENSOR
+/// How often held back values and heartbeats are checked for.
+static const uint32_t SENSOR_PUBLISH_DUE_CHECK_INTERVAL = 100;
+
+void StoringUpdateListenerController::set_sensor_publish_policy(
+    const sensor::SensorPublishPolicy &sensor_publish_policy) {
+  this->sensor_publish_policy_ = sensor_publish_policy;
+}
+void StoringUpdateListenerController::process_sensor_(uint16_t id, sensor::Sensor *obj, uint32_t now) {
+  if (!this->sensor_publish_policy_.is_active()) {
+    this->on_sensor_update(obj, obj->state);
+    return;
+  }
+  if (this->sensor_publish_states_.size() <= id)
+    this->sensor_publish_states_.resize(App.get_state_bus().size());
+  if (this->sensor_publish_policy_.check(this->sensor_publish_states_[id], obj->state, now))
+    this->on_sensor_update(obj, obj->state);
+}
+void StoringUpdateListenerController::process_due_sensors_(uint32_t now) {
+  if (now - this->last_due_check_ < SENSOR_PUBLISH_DUE_CHECK_INTERVAL)
+    return;
+  this->last_due_check_ = now;
+
+  auto &bus = App.get_state_bus();
+  for (uint16_t id = 0; id < this->sensor_publish_states_.size(); id++) {
+    if (this->sensor_publish_policy_.is_due(this->sensor_publish_states_[id], now))
+      this->process_sensor_(id, static_cast<sensor::Sensor *>(bus.get_entity(id)), now);
   }
-  return nullptr;
 }
-void StoringUpdateListenerController::register_climate(climate::ClimateDevice *obj) {
-  StoringController::register_climate(obj);
-  obj->add_on_state_callback([this, obj]() { this->on_climate_update(obj); });
+#endif
+
+void StoringUpdateListenerController::subscribe_states_(Component *component) {
+  this->state_subscriber_ = App.get_state_bus().subscribe(component);
 }
-void StoringUpdateListenerController::on_climate_update(climate::ClimateDevice *obj) {}
+void StoringUpdateListenerController::process_states_() {
+  auto &bus = App.get_state_bus();
+#ifdef USE_SENSOR
+  const uint32_t now = millis();
+#endif
+  uint16_t id;
+  while (bus.pop_dirty(this->state_subscriber_, &id)) {
+    Nameable *obj = bus.get_entity(id);
+    switch (bus.get_entity_type(id)) {
+#ifdef USE_BINARY_SENSOR
+      case ENTITY_BINARY_SENSOR: {
+        auto *entity = static_cast<binary_sensor::BinarySensor *>(obj);
+        this->on_binary_sensor_update(entity, entity->state);
+        break;
+      }
+#endif
+#ifdef USE_COVER
+      case ENTITY_COVER:
+        this->on_cover_update(static_cast<cover::Cover *>(obj));
+        break;
+#endif
+#ifdef USE_FAN
+      case ENTITY_FAN:
+        this->on_fan_update(static_cast<fan::FanState *>(obj));
+        break;
+#endif
+#ifdef USE_LIGHT
+      case ENTITY_LIGHT:
+        this->on_light_update(static_cast<light::LightState *>(obj));
+        break;
+#endif
+#ifdef USE_SENSOR
+      case ENTITY_SENSOR:
+        this->process_sensor_(id, static_cast<sensor::Sensor *>(obj), now);
+        break;
+#endif
+#ifdef USE_SWITCH
+      case ENTITY_SWITCH: {
+        auto *entity = static_cast<switch_::Switch *>(obj);
+        this->on_switch_update(entity, entity->state);
+        break;
+      }
+#endif
+#ifdef USE_TEXT_SENSOR
+      case ENTITY_TEXT_SENSOR: {
+        auto *entity = static_cast<text_sensor::TextSensor *>(obj);
+        this->on_text_sensor_update(entity, entity->state);
+        break;
+      }
+#endif
+#ifdef USE_CLIMATE
+      case ENTITY_CLIMATE:
+        this->on_climate_update(static_cast<climate::ClimateDevice *>(obj));
+        break;
 #endif
+      default:
+        break;
+    }
+  }
+
+#ifdef USE_SENSOR
+  if (this->sensor_publish_policy_.is_timed())
+    this->process_due_sensors_(now);
+#endif
+}
+bool StoringUpdateListenerController::has_timed_states_() const {
+#ifdef USE_SENSOR
+  return this->sensor_publish_policy_.is_timed();
+#else
+  return false;
+#endif
+}
+uint32_t StoringUpdateListenerController::get_states_idle_time_() const {
+  if (App.get_state_bus().has_dirty(this->state_subscriber_))
+    return 0;
+#ifdef USE_SENSOR
+  if (this->sensor_publish_policy_.is_timed())
+    return SENSOR_PUBLISH_DUE_CHECK_INTERVAL;
+#endif
+  return SCHEDULER_DONT_RUN;
+}
+void StoringUpdateListenerController::discard_states_() { App.get_state_bus().clear_dirty(this->state_subscriber_); }
 
 ESPHOME_NAMESPACE_END
@@ -9,10 +9,106 @@
 #include "esphome/cover/cover.h"
 #include "esphome/text_sensor/text_sensor.h"
 #include "esphome/climate/climate_device.h"
+#include "esphome/component.h"
 #include "esphome/defines.h"
 
+#include <vector>
+
 ESPHOME_NAMESPACE_BEGIN
 
+/// The kind of entity that's registered with the EntityStateBus.
+enum EntityType : uint8_t {
+  ENTITY_BINARY_SENSOR,
+  ENTITY_COVER,
+  ENTITY_FAN,
+  ENTITY_LIGHT,
+  ENTITY_SENSOR,
+  ENTITY_SWITCH,
+  ENTITY_TEXT_SENSOR,
+  ENTITY_CLIMATE,
+};
+
+/** The central bus the state changes of all entities go through.
+ *
+ * Each entity is registered once and gets a compact id; its only state callback marks that id in the dirty
+ * bitset of every subscriber. Subscribers (usually controllers) drain their set at their own pace with
+ * pop_dirty() and encode the current state then, so multiple updates of one entity in between are coalesced
+ * and the entity doesn't call into every controller on each publish.
+ */
+class EntityStateBus;
+
+/// The state callback of an entity on the EntityStateBus, marks the entity as changed regardless of the arguments.
+struct EntityStateNotifier {
+  template<typename... Ts> void operator()(Ts &&...) const;
+
+  EntityStateBus *bus;
+  uint16_t id;
+};
+
+class EntityStateBus {
+ public:
+  /// Register an entity with the bus, the returned callback has to be added to the entity's state callbacks.
+  EntityStateNotifier register_entity(Nameable *obj, EntityType type);
+
+  /** Subscribe to state changes and return the subscriber index for pop_dirty().
+   *
+   * @param component The component whose loop() should be enabled when one of the entities changes, may be nullptr.
+   */
+  uint8_t subscribe(Component *component);
+
+  /// Mark the entity with the given id as changed for all subscribers.
+  void mark_dirty(uint16_t id);
+
+  /** Get (and clear) the next changed entity of the subscriber.
+   *
+   * @param subscriber The index returned by subscribe().
+   * @param id Where to store the id of the entity.
+   * @return Whether there was a changed entity.
+   */
+  bool pop_dirty(uint8_t subscriber, uint16_t *id);
+
+  /// Clear all changes of the subscriber, for example because it has no clients.
+  void clear_dirty(uint8_t subscriber);
+  /// Whether pop_dirty() has a changed entity for the subscriber.
+  bool has_dirty(uint8_t subscriber) const;
+
+  Nameable *get_entity(uint16_t id) const;
+  EntityType get_entity_type(uint16_t id) const;
+  size_t size() const;
+
+  /** Find an entity by its type and key (the hash of its object id).
+   *
+   * The lookup goes through a hash table that's built on the first call after entities were registered (so
+   * usually once after setup), it doesn't depend on the number of entities.
+   *
+   * @return The entity or nullptr if there's no such entity.
+   */
+  Nameable *find_entity(EntityType type, uint32_t key);
+
+ protected:
+  static uint32_t key_slot_(EntityType type, uint32_t key);
+  void build_key_table_();
+
+  struct Entity {
+    Nameable *obj;
+    EntityType type;
+  };
+  struct Subscriber {
+    Component *component;
+    /// One bit per entity id.
+    std::vector<uint32_t> dirty;
+    /// The word to start searching in, all words before it are zero.
+    uint16_t first_word;
+  };
+
+  std::vector<Entity> entities_;
+  std::vector<Subscriber> subscribers_;
+  /// Open addressing table of entity id + 1 (0 is an empty slot), its size is a power of two.
+  std::vector<uint16_t> key_table_;
+  /// The number of entities key_table_ was built for.
+  size_t key_table_entities_{0};
+};
+
 /// Controllers allow an object to be notified of every component that's added to the Application.
 class Controller {
  public:
@@ -133,56 +229,85 @@ class StoringController : public Controller {
 #endif
 };
 
+/** A StoringController that gets notified of the state changes of the entities.
+ *
+ * The changes are received through the EntityStateBus: subscribe_states_() has to be called (usually in setup())
+ * and process_states_() drains the changed entities and calls the respective on_*_update() method with their
+ * current state.
+ */
 class StoringUpdateListenerController : public StoringController {
  public:
 #ifdef USE_BINARY_SENSOR
-  void register_binary_sensor(binary_sensor::BinarySensor *obj) override;
-
   virtual void on_binary_sensor_update(binary_sensor::BinarySensor *obj, bool state) = 0;
 #endif
-#ifdef USE_FAN
-  void register_fan(fan::FanState *obj) override;
 
+#ifdef USE_FAN
   virtual void on_fan_update(fan::FanState *obj) = 0;
 #endif
 
 #ifdef USE_LIGHT
-  void register_light(light::LightState *obj) override;
-
   virtual void on_light_update(light::LightState *obj) = 0;
 #endif
 
 #ifdef USE_SENSOR
-  void register_sensor(sensor::Sensor *obj) override;
-
   virtual void on_sensor_update(sensor::Sensor *obj, float state) = 0;
 #endif
 
 #ifdef USE_SWITCH
-  void register_switch(switch_::Switch *obj) override;
-
   virtual void on_switch_update(switch_::Switch *obj, bool state) = 0;
 #endif
 
 #ifdef USE_COVER
-  void register_cover(cover::Cover *obj) override;
-
   virtual void on_cover_update(cover::Cover *obj);
 #endif
 
 #ifdef USE_TEXT_SENSOR
-  void register_text_sensor(text_sensor::TextSensor *obj) override;
-
-  virtual void on_text_sensor_update(text_sensor::TextSensor *obj, std::string state) = 0;
+  virtual void on_text_sensor_update(text_sensor::TextSensor *obj, const std::string &state) = 0;
 #endif
 
 #ifdef USE_CLIMATE
-  void register_climate(climate::ClimateDevice *obj) override;
-
   virtual void on_climate_update(climate::ClimateDevice *obj);
 #endif
+
+#ifdef USE_SENSOR
+  /// Thin out the sensor values this controller sends, see sensor::SensorPublishPolicy.
+  void set_sensor_publish_policy(const sensor::SensorPublishPolicy &sensor_publish_policy);
+#endif
+
+ protected:
+#ifdef USE_SENSOR
+  /// Call on_sensor_update() if the policy lets the value through.
+  void process_sensor_(uint16_t id, sensor::Sensor *obj, uint32_t now);
+  /// Send the held back values and heartbeats that are due.
+  void process_due_sensors_(uint32_t now);
+#endif
+
+  /// Subscribe to the state bus, the loop() of the given component is enabled on each state change.
+  void subscribe_states_(Component *component);
+  /// Call the on_*_update() methods for all entities that changed since the last call.
+  void process_states_();
+  /// Forget all changes since the last call, for example because there's nobody to send them to.
+  void discard_states_();
+  /** Whether process_states_() has to be called periodically even without state changes.
+   *
+   * That's the case if the sensor publish policy holds back values or sends heartbeats, controllers that disable
+   * their loop() after processing the changes have to keep it enabled then.
+   */
+  bool has_timed_states_() const;
+  /// How long process_states_() can wait in the idle mode (see Component::get_loop_idle_time()).
+  uint32_t get_states_idle_time_() const;
+
+  uint8_t state_subscriber_;
+#ifdef USE_SENSOR
+  sensor::SensorPublishPolicy sensor_publish_policy_;
+  /// Indexed by the id of the sensor on the state bus.
+  std::vector<sensor::SensorPublishState> sensor_publish_states_;
+  uint32_t last_due_check_{0};
+#endif
 };
 
+template<typename... Ts> void EntityStateNotifier::operator()(Ts &&...) const { this->bus->mark_dirty(this->id); }
+
 ESPHOME_NAMESPACE_END
 
 #endif  // ESPHOME_CONTROLLER_H
@@ -0,0 +1,106 @@
+#include "esphome/coroutine.h"
+#include "esphome/application.h"
+#include "esphome/log.h"
+
+#include <cstring>
+
+ESPHOME_NAMESPACE_BEGIN
+
+static const char *TAG = "coroutine";
+
+Coroutine::Coroutine(Component *parent, const std::string &name, std::function<void(Coroutine &)> &&body)
+    : parent_(parent), name_(name), body_(std::move(body)) {}
+
+void Coroutine::start() {
+  this->stop();
+  this->running_ = true;
+  this->body_(*this);
+}
+void Coroutine::stop() {
+  this->cancel_timers_();
+  this->wait_ = WAIT_NONE;
+  this->wait_id_++;
+  this->resume_point = 0;
+  this->running_ = false;
+}
+bool Coroutine::is_running() const { return this->running_; }
+void Coroutine::finish() {
+  this->wait_ = WAIT_NONE;
+  this->resume_point = 0;
+  this->running_ = false;
+}
+
+void Coroutine::sleep(uint32_t ms) {
+  const uint32_t wait_id = this->begin_wait_(WAIT_TIME);
+  if (ms == 0) {
+    App.scheduler.defer(this->parent_, this->name_, [this, wait_id]() { this->resume_(wait_id, false); });
+  } else {
+    App.scheduler.set_timeout(this->parent_, this->name_, ms, [this, wait_id]() { this->resume_(wait_id, false); });
+  }
+}
+void Coroutine::poll() { this->sleep(0); }
+bool Coroutine::timed_out() const { return this->timed_out_; }
+
+#ifdef USE_I2C
+void Coroutine::i2c_read(I2CDevice *device, uint8_t a_register, uint8_t len, uint32_t delay) {
+  const uint32_t wait_id = this->begin_wait_(WAIT_I2C);
+  if (len > COROUTINE_I2C_BUFFER_SIZE)
+    len = COROUTINE_I2C_BUFFER_SIZE;
+  auto callback = [this, wait_id](bool success, const uint8_t *data, uint8_t data_len) {
+    if (wait_id != this->wait_id_)
+      return;
+    this->i2c_success_ = success;
+    if (success)
+      memcpy(this->i2c_data_, data, data_len);
+    this->resume_(wait_id, false);
+  };
+  device->read_bytes_async(a_register, len, delay, std::move(callback));
+}
+bool Coroutine::i2c_success() const { return this->i2c_success_; }
+const uint8_t *Coroutine::i2c_data() const { return this->i2c_data_; }
+#endif
+
+#ifdef USE_UART
+void Coroutine::wait_frame(UARTDevice *device, uint32_t timeout) {
+  const uint32_t wait_id = this->begin_wait_(WAIT_FRAME);
+  this->frame_.clear();
+  if (this->frame_device_ == nullptr) {
+    this->frame_device_ = device;
+    device->add_on_frame_callback([this](const uint8_t *data, size_t len) {
+      if (this->wait_ != WAIT_FRAME)
+        return;
+      this->frame_.assign(data, data + len);
+      this->resume_(this->wait_id_, false);
+    });
+  } else if (this->frame_device_ != device) {
+    ESP_LOGE(TAG, "'%s' can only wait for frames from one UART", this->name_.c_str());
+  }
+  if (timeout != 0)
+    this->set_timeout_(wait_id, timeout);
+}
+const std::vector<uint8_t> &Coroutine::get_frame() const { return this->frame_; }
+#endif
+
+uint32_t Coroutine::begin_wait_(Wait wait) {
+  this->cancel_timers_();
+  this->wait_ = wait;
+  this->timed_out_ = false;
+  return ++this->wait_id_;
+}
+void Coroutine::resume_(uint32_t wait_id, bool timed_out) {
+  if (wait_id != this->wait_id_ || this->wait_ == WAIT_NONE)
+    return;
+  this->cancel_timers_();
+  this->wait_ = WAIT_NONE;
+  this->timed_out_ = timed_out;
+  this->body_(*this);
+}
+void Coroutine::set_timeout_(uint32_t wait_id, uint32_t timeout) {
+  App.scheduler.set_timeout(this->parent_, this->name_, timeout, [this, wait_id]() { this->resume_(wait_id, true); });
+}
+void Coroutine::cancel_timers_() {
+  App.scheduler.cancel_timeout(this->parent_, this->name_);
+  App.scheduler.cancel_defer(this->parent_, this->name_);
+}
+
+ESPHOME_NAMESPACE_END
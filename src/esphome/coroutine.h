@@ -0,0 +1,174 @@
+#ifndef ESPHOME_COROUTINE_H
+#define ESPHOME_COROUTINE_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "esphome/defines.h"
+
+ESPHOME_NAMESPACE_BEGIN
+
+class Component;
+#ifdef USE_I2C
+class I2CDevice;
+#endif
+#ifdef USE_UART
+class UARTDevice;
+#endif
+
+/// The most bytes a single COROUTINE_I2C_READ can read.
+static const uint8_t COROUTINE_I2C_BUFFER_SIZE = 32;
+
+/** A stackless coroutine for writing non-blocking drivers without hand-written state machines.
+ *
+ * The body is a function that is called again each time the coroutine resumes, the COROUTINE_* macros jump back
+ * to the statement after the last wait. Waiting returns to the main loop, the coroutine is resumed through the
+ * scheduler of the parent component, so a driver never blocks the loop with delay(). Because the body returns
+ * while waiting, local variables don't survive a wait: keep state in members of the component.
+ *
+ * Example:
+ *
+ * ```cpp
+ * class MyDriver : public PollingComponent, public I2CDevice {
+ *   Coroutine measure_{this, "measure", [this](Coroutine &co) { this->measure_step_(co); }};
+ *   void update() override { this->measure_.start(); }
+ *   void measure_step_(Coroutine &co) {
+ *     COROUTINE_BEGIN(co);
+ *     this->write_byte(0x00, 0x01);  // start a conversion
+ *     COROUTINE_SLEEP(co, 80);
+ *     COROUTINE_I2C_READ(co, this, 0x02, 2, 0);
+ *     if (co.i2c_success())
+ *       this->publish_(co.i2c_data());
+ *     COROUTINE_END(co);
+ *   }
+ * };
+ * ```
+ *
+ * The coroutine must live as long as its parent component, usually as a member of it.
+ */
+class Coroutine {
+ public:
+  /** Construct a coroutine.
+   *
+   * @param parent The component whose scheduler resumes the coroutine.
+   * @param name The name of the time functions used for waiting, unique for the parent component.
+   * @param body The body, called from the main loop with this coroutine each time it resumes.
+   */
+  Coroutine(Component *parent, const std::string &name, std::function<void(Coroutine &)> &&body);
+
+  /// Run the body from the beginning, stopping the run that is in progress.
+  void start();
+  /// Stop the coroutine, pending waits are abandoned.
+  void stop();
+  /// Whether the coroutine is waiting to be resumed.
+  bool is_running() const;
+
+  /// Resume in ms milliseconds, in the next loop iteration for 0. Use COROUTINE_SLEEP.
+  void sleep(uint32_t ms);
+  /// Resume in the next loop iteration to check a condition again. Use COROUTINE_WAIT_UNTIL.
+  void poll();
+  /// Whether the last wait with a timeout ended by the timeout.
+  bool timed_out() const;
+
+#ifdef USE_I2C
+  /// Read len bytes from a register without blocking and resume with the result. Use COROUTINE_I2C_READ.
+  void i2c_read(I2CDevice *device, uint8_t a_register, uint8_t len, uint32_t delay);
+  /// Whether the last COROUTINE_I2C_READ succeeded.
+  bool i2c_success() const;
+  /// The bytes of the last COROUTINE_I2C_READ.
+  const uint8_t *i2c_data() const;
+#endif
+#ifdef USE_UART
+  /** Resume with the next frame received by the UART, or after timeout ms (0 to wait forever).
+   *
+   * Use COROUTINE_UART_FRAME. Frames that arrive while the coroutine isn't waiting for one are dropped, and a
+   * coroutine can only wait for frames of a single UART.
+   */
+  void wait_frame(UARTDevice *device, uint32_t timeout);
+  /// The last frame received with COROUTINE_UART_FRAME, empty if it timed out.
+  const std::vector<uint8_t> &get_frame() const;
+#endif
+
+  /// Internal, the resume point of the body used by the COROUTINE_* macros, 0 to run from the beginning.
+  int resume_point{0};
+  /// Internal, called by COROUTINE_END.
+  void finish();
+
+ protected:
+  enum Wait : uint8_t {
+    WAIT_NONE,
+    WAIT_TIME,
+    WAIT_I2C,
+    WAIT_FRAME,
+  };
+
+  /// Start a new wait, returns its id for the callbacks that end it.
+  uint32_t begin_wait_(Wait wait);
+  /// End the wait with the given id and run the body, ignored if the wait was abandoned.
+  void resume_(uint32_t wait_id, bool timed_out);
+  void set_timeout_(uint32_t wait_id, uint32_t timeout);
+  void cancel_timers_();
+
+  Component *parent_;
+  std::string name_;
+  std::function<void(Coroutine &)> body_;
+  Wait wait_{WAIT_NONE};
+  /// Incremented for each wait, so that callbacks of abandoned waits can be recognized.
+  uint32_t wait_id_{0};
+  bool running_{false};
+  bool timed_out_{false};
+#ifdef USE_I2C
+  bool i2c_success_{false};
+  uint8_t i2c_data_[COROUTINE_I2C_BUFFER_SIZE]{};
+#endif
+#ifdef USE_UART
+  /// The UART whose frame callback was registered, frame callbacks can't be removed again.
+  UARTDevice *frame_device_{nullptr};
+  std::vector<uint8_t> frame_;
+#endif
+};
+
+/// Start the body of a coroutine, must be the first statement of the body.
+#define COROUTINE_BEGIN(co) \
+  switch ((co).resume_point) { \
+    case 0:
+
+/// Wait with the given statement and continue after it once the coroutine is resumed, at most one wait per line.
+#define COROUTINE_AWAIT_(co, wait) \
+  do { \
+    (co).resume_point = __LINE__; \
+    wait; \
+    return; \
+    case __LINE__:; \
+  } while (0)
+
+/// Continue after ms milliseconds.
+#define COROUTINE_SLEEP(co, ms) COROUTINE_AWAIT_(co, (co).sleep(ms))
+/// Continue in the next loop iteration, to split up long work.
+#define COROUTINE_YIELD(co) COROUTINE_AWAIT_(co, (co).sleep(0))
+/// Continue once cond is true, it is checked once per loop iteration.
+#define COROUTINE_WAIT_UNTIL(co, cond) \
+  do { \
+    (co).resume_point = __LINE__; \
+    case __LINE__: \
+      if (!(cond)) { \
+        (co).poll(); \
+        return; \
+      } \
+  } while (0)
+/// Read len bytes from the register of the I2CDevice after delay ms, see Coroutine::i2c_success() and i2c_data().
+#define COROUTINE_I2C_READ(co, device, a_register, len, delay) \
+  COROUTINE_AWAIT_(co, (co).i2c_read(device, a_register, len, delay))
+/// Continue with the next frame received by the UARTDevice, see Coroutine::get_frame() and timed_out().
+#define COROUTINE_UART_FRAME(co, device, timeout) COROUTINE_AWAIT_(co, (co).wait_frame(device, timeout))
+/// End the body of a coroutine, must be the last statement of the body.
+#define COROUTINE_END(co) \
+  default: \
+    break; \
+    } \
+    (co).finish()
+
+ESPHOME_NAMESPACE_END
+
+#endif  // ESPHOME_COROUTINE_H
@@ -11,12 +11,32 @@ namespace cover {
 
 static const char *TAG = "cover.time_based";
 
+/// Distinguishes the saved durations from the saved state, which use the same object id hash.
+static const uint32_t DURATIONS_PREFERENCE_TYPE = 0x6A8F3D21UL;
+
 void TimeBasedCover::dump_config() {
   LOG_COVER("", "Time Based Cover", this);
   ESP_LOGCONFIG(TAG, "  Open Duration: %.1fs", this->open_duration_ / 1e3f);
   ESP_LOGCONFIG(TAG, "  Close Duration: %.1fs", this->close_duration_ / 1e3f);
+  if (this->open_duration_ != this->configured_open_duration_ ||
+      this->close_duration_ != this->configured_close_duration_) {
+    ESP_LOGCONFIG(TAG, "  Configured Durations: %.1fs open, %.1fs close", this->configured_open_duration_ / 1e3f,
+                  this->configured_close_duration_ / 1e3f);
+  }
+  ESP_LOGCONFIG(TAG, "  Publish Interval: %u ms", this->publish_interval_);
 }
 void TimeBasedCover::setup() {
+  this->configured_open_duration_ = this->open_duration_;
+  this->configured_close_duration_ = this->close_duration_;
+  this->durations_pref_ = global_preferences.make_preference<TimeBasedCoverDurations>(this->get_object_id_hash() ^
+                                                                                       DURATIONS_PREFERENCE_TYPE);
+  TimeBasedCoverDurations durations{};
+  if (this->durations_pref_.load(&durations) && durations.configured_open_duration == this->open_duration_ &&
+      durations.configured_close_duration == this->close_duration_) {
+    this->open_duration_ = durations.open_duration;
+    this->close_duration_ = durations.close_duration;
+  }
+
   auto restore = this->restore_state_();
   if (restore.has_value()) {
     restore->apply(this);
@@ -24,25 +44,24 @@ void TimeBasedCover::setup() {
     this->position = 0.5f;
   }
 }
-void TimeBasedCover::loop() {
-  if (this->current_operation == COVER_OPERATION_IDLE)
+void TimeBasedCover::learn_durations(uint32_t open_duration, uint32_t close_duration) {
+  if (open_duration == 0 || close_duration == 0)
     return;
-
-  const uint32_t now = millis();
-
-  // Recompute position every loop cycle
+  // account for the part of the current move made with the old durations
   this->recompute_position_();
-
-  if (this->current_operation != COVER_OPERATION_IDLE && this->is_at_target_()) {
-    this->start_direction_(COVER_OPERATION_IDLE);
-    this->publish_state();
-  }
-
-  // Send current position every second
-  if (this->current_operation != COVER_OPERATION_IDLE && now - this->last_publish_time_ > 1000) {
-    this->publish_state(false);
-    this->last_publish_time_ = now;
-  }
+  this->open_duration_ = open_duration;
+  this->close_duration_ = close_duration;
+  ESP_LOGD(TAG, "'%s' - Learned durations: %.1fs open, %.1fs close", this->get_name().c_str(), open_duration / 1e3f,
+           close_duration / 1e3f);
+  TimeBasedCoverDurations durations{
+      .configured_open_duration = this->configured_open_duration_,
+      .configured_close_duration = this->configured_close_duration_,
+      .open_duration = open_duration,
+      .close_duration = close_duration,
+  };
+  this->durations_pref_.save(&durations);
+  if (this->current_operation != COVER_OPERATION_IDLE)
+    this->schedule_arrival_();
 }
 float TimeBasedCover::get_setup_priority() const { return setup_priority::HARDWARE_LATE; }
 CoverTraits TimeBasedCover::get_traits() {
@@ -58,12 +77,15 @@ void TimeBasedCover::control(const CoverCall &call) {
   }
   if (call.get_position().has_value()) {
     auto pos = *call.get_position();
+    this->recompute_position_();
     if (pos == this->position) {
       // already at target
     } else {
       auto op = pos < this->position ? COVER_OPERATION_CLOSING : COVER_OPERATION_OPENING;
       this->target_position_ = pos;
       this->start_direction_(op);
+      // the target may have changed without changing the direction
+      this->schedule_arrival_();
     }
   }
 }
@@ -73,17 +95,6 @@ void TimeBasedCover::stop_prev_trigger_() {
     this->prev_command_trigger_ = nullptr;
   }
 }
-bool TimeBasedCover::is_at_target_() const {
-  switch (this->current_operation) {
-    case COVER_OPERATION_OPENING:
-      return this->position >= this->target_position_;
-    case COVER_OPERATION_CLOSING:
-      return this->position <= this->target_position_;
-    case COVER_OPERATION_IDLE:
-    default:
-      return true;
-  }
-}
 void TimeBasedCover::start_direction_(CoverOperation dir) {
   if (dir == this->current_operation)
     return;
@@ -113,6 +124,38 @@ void TimeBasedCover::start_direction_(CoverOperation dir) {
   const uint32_t now = millis();
   this->start_dir_time_ = now;
   this->last_recompute_time_ = now;
+
+  this->cancel_timeout("arrival");
+  this->cancel_interval("publish");
+}
+void TimeBasedCover::schedule_arrival_() {
+  float duration;
+  switch (this->current_operation) {
+    case COVER_OPERATION_OPENING:
+      duration = this->open_duration_;
+      break;
+    case COVER_OPERATION_CLOSING:
+      duration = this->close_duration_;
+      break;
+    default:
+      return;
+  }
+
+  this->recompute_position_();
+  const auto arrival = uint32_t(fabsf(this->target_position_ - this->position) * duration);
+  this->set_timeout("arrival", arrival, [this]() {
+    this->recompute_position_();
+    this->position = this->target_position_;
+    this->start_direction_(COVER_OPERATION_IDLE);
+    this->publish_state();
+  });
+
+  if (this->publish_interval_ != 0) {
+    this->set_interval("publish", this->publish_interval_, [this]() {
+      this->recompute_position_();
+      this->publish_state(false);
+    });
+  }
 }
 void TimeBasedCover::recompute_position_() {
   if (this->current_operation == COVER_OPERATION_IDLE)
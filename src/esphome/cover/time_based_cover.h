@@ -12,11 +12,25 @@ ESPHOME_NAMESPACE_BEGIN
 
 namespace cover {
 
+/// The open and close durations saved by TimeBasedCover::learn_durations().
+struct TimeBasedCoverDurations {
+  /// The configured durations the learned ones replace, the learned ones are dropped if the configuration changes.
+  uint32_t configured_open_duration;
+  uint32_t configured_close_duration;
+  uint32_t open_duration;
+  uint32_t close_duration;
+};
+
+/** A cover that knows its position only from how long it has been moving.
+ *
+ * The position isn't tracked while moving. Instead, the time at which the target is reached is calculated when the
+ * cover starts moving and a single timeout stops it there. In between, the position is only published every
+ * publish interval (frontends can interpolate from the current operation).
+ */
 class TimeBasedCover : public Cover, public Component {
  public:
   TimeBasedCover(const std::string &name) : Cover(name) {}
   void setup() override;
-  void loop() override;
   void dump_config() override;
   float get_setup_priority() const override;
 
@@ -25,14 +39,23 @@ class TimeBasedCover : public Cover, public Component {
   Trigger<> *get_stop_trigger() const { return this->stop_trigger_; }
   void set_open_duration(uint32_t open_duration) { this->open_duration_ = open_duration; }
   void set_close_duration(uint32_t close_duration) { this->close_duration_ = close_duration; }
+  /// How often the position is published while moving in ms, 0 to only publish when stopping. Defaults to 1000.
+  void set_publish_interval(uint32_t publish_interval) { this->publish_interval_ = publish_interval; }
+  /** Replace the open and close durations with measured ones, for example from a calibration run.
+   *
+   * They're saved in the preferences and used instead of the configured durations after a reboot, until the
+   * configured durations change.
+   */
+  void learn_durations(uint32_t open_duration, uint32_t close_duration);
   CoverTraits get_traits() override;
 
  protected:
   void control(const CoverCall &call) override;
   void stop_prev_trigger_();
-  bool is_at_target_() const;
 
   void start_direction_(CoverOperation dir);
+  /// Schedule the stop at target_position_ and the position updates until then.
+  void schedule_arrival_();
 
   void recompute_position_();
 
@@ -45,8 +68,12 @@ class TimeBasedCover : public Cover, public Component {
   Trigger<> *prev_command_trigger_{nullptr};
   uint32_t last_recompute_time_{0};
   uint32_t start_dir_time_{0};
-  uint32_t last_publish_time_{0};
+  uint32_t publish_interval_{1000};
   float target_position_{0};
+  /// The durations before learn_durations() replaced them.
+  uint32_t configured_open_duration_{0};
+  uint32_t configured_close_duration_{0};
+  ESPPreferenceObject durations_pref_;
 };
 
 }  // namespace cover
@@ -5,16 +5,28 @@
 #include "esphome/debug_component.h"
 #include "esphome/log.h"
 #include "esphome/helpers.h"
+#ifdef USE_HEAP_TRACER
+#include "esphome/application.h"
+#endif
 #include <string>
 
 #ifdef ARDUINO_ARCH_ESP32
 #include <rom/rtc.h>
+#include <esp_heap_caps.h>
+#include <esp_system.h>
+#endif
+#ifdef ARDUINO_ARCH_ESP8266
+extern "C" {
+#include <umm_malloc/umm_malloc.h>
+}
 #endif
 
 ESPHOME_NAMESPACE_BEGIN
 
 static const char *TAG = "debug";
 
+DebugComponent::DebugComponent(uint32_t update_interval) : PollingComponent(update_interval) {}
+
 void DebugComponent::setup() {
 #ifndef ESPHOME_LOG_HAS_DEBUG
   ESP_LOGE(TAG, "Debug Component requires debug log level!");
@@ -26,7 +38,20 @@ void DebugComponent::setup() {
 void DebugComponent::dump_config() {
   ESP_LOGD(TAG, "ESPHome Core version %s", ESPHOME_VERSION);
   this->free_heap_ = ESP.getFreeHeap();
-  ESP_LOGD(TAG, "Free Heap Size: %u bytes", this->free_heap_);
+  ESP_LOGD(TAG, "Free Heap Size: %u bytes (largest block %u bytes)", this->free_heap_,
+           this->get_largest_free_block_());
+  ESP_LOGD(TAG, "Setup Arena: %u bytes in %u blocks", global_setup_arena.get_used(),
+           global_setup_arena.get_block_count());
+  ESP_LOGD(TAG, "Scratch Buffers: %u bytes reserved, at most %u bytes in use, %u heap fallbacks",
+           global_scratch_buffer_pool.get_reserved(), global_scratch_buffer_pool.get_high_water_mark(),
+           global_scratch_buffer_pool.get_heap_fallbacks());
+#ifdef USE_SENSOR
+  LOG_UPDATE_INTERVAL(this);
+  LOG_SENSOR("  ", "Free Heap", this->free_heap_sensor_);
+  LOG_SENSOR("  ", "Largest Free Block", this->largest_free_block_sensor_);
+  LOG_SENSOR("  ", "Heap Fragmentation", this->heap_fragmentation_sensor_);
+  LOG_SENSOR("  ", "Min Free Heap", this->min_free_heap_sensor_);
+#endif
 
   const char *flash_mode;
   switch (ESP.getFlashChipMode()) {
@@ -203,12 +228,87 @@ void DebugComponent::dump_config() {
 }
 void DebugComponent::loop() {
   uint32_t new_free_heap = ESP.getFreeHeap();
+  if (new_free_heap < this->min_free_heap_)
+    this->min_free_heap_ = new_free_heap;
   if (new_free_heap < this->free_heap_ / 2) {
     this->free_heap_ = new_free_heap;
     ESP_LOGD(TAG, "Free Heap Size: %u bytes", this->free_heap_);
+#ifdef USE_HEAP_TRACER
+    this->dump_top_allocators_();
+#endif
     this->status_momentary_warning("heap", 1000);
   }
 }
+uint32_t DebugComponent::get_loop_idle_time() {
+  // the heap only changes while code runs, and loop() runs after everything that woke the loop up
+  return 1000;
+}
+void DebugComponent::update() {
+  const uint32_t free_heap = ESP.getFreeHeap();
+  const uint32_t largest_free_block = this->get_largest_free_block_();
+  ESP_LOGV(TAG, "Heap: free=%u largest_block=%u min_free=%u", free_heap, largest_free_block,
+           this->get_min_free_heap_());
+
+#ifdef USE_SENSOR
+  if (this->free_heap_sensor_ != nullptr)
+    this->free_heap_sensor_->publish_state(free_heap);
+  if (this->largest_free_block_sensor_ != nullptr)
+    this->largest_free_block_sensor_->publish_state(largest_free_block);
+  if (this->heap_fragmentation_sensor_ != nullptr && free_heap != 0) {
+    const uint32_t fragmentation = 100 - std::min(largest_free_block, free_heap) * 100 / free_heap;
+    this->heap_fragmentation_sensor_->publish_state(fragmentation);
+  }
+  if (this->min_free_heap_sensor_ != nullptr)
+    this->min_free_heap_sensor_->publish_state(this->get_min_free_heap_());
+#endif
+}
+uint32_t DebugComponent::get_largest_free_block_() {
+#ifdef ARDUINO_ARCH_ESP8266
+  // walks the heap and fills ummHeapInfo, sizes are in umm blocks of 8 bytes
+  umm_info(nullptr, 0);
+  return uint32_t(ummHeapInfo.maxFreeContiguousBlocks) * 8;
+#endif
+#ifdef ARDUINO_ARCH_ESP32
+  return heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+#endif
+}
+uint32_t DebugComponent::get_min_free_heap_() {
+#ifdef ARDUINO_ARCH_ESP32
+  return esp_get_minimum_free_heap_size();
+#else
+  return std::min(this->min_free_heap_, ESP.getFreeHeap());
+#endif
+}
+#ifdef USE_HEAP_TRACER
+void DebugComponent::dump_top_allocators_() {
+  std::vector<Component *> components = App.get_components();
+  std::sort(components.begin(), components.end(), [](Component *a, Component *b) {
+    return a->heap_stats.get_retained() > b->heap_stats.get_retained();
+  });
+  ESP_LOGD(TAG, "Components holding the most heap:");
+  for (uint32_t i = 0; i < components.size() && i < 5; i++) {
+    const ComponentHeapStats &stats = components[i]->heap_stats;
+    if (stats.get_retained() <= 0)
+      break;
+    ESP_LOGD(TAG, "  %s: retained=%d allocated=%u max=%u", components[i]->get_component_source(),
+             stats.get_retained(), stats.allocated, stats.max_allocation);
+  }
+}
+#endif
+#ifdef USE_SENSOR
+DebugHeapSensor *DebugComponent::make_free_heap_sensor(const std::string &name) {
+  return this->free_heap_sensor_ = new DebugHeapSensor(name, this);
+}
+DebugHeapSensor *DebugComponent::make_largest_free_block_sensor(const std::string &name) {
+  return this->largest_free_block_sensor_ = new DebugHeapSensor(name, this);
+}
+DebugFragmentationSensor *DebugComponent::make_heap_fragmentation_sensor(const std::string &name) {
+  return this->heap_fragmentation_sensor_ = new DebugFragmentationSensor(name, this);
+}
+DebugHeapSensor *DebugComponent::make_min_free_heap_sensor(const std::string &name) {
+  return this->min_free_heap_sensor_ = new DebugHeapSensor(name, this);
+}
+#endif
 float DebugComponent::get_setup_priority() const {
   return setup_priority::LATE;  // display debug info via MQTT
 }
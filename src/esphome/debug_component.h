@@ -6,19 +6,63 @@
 #ifdef USE_DEBUG_COMPONENT
 
 #include "esphome/component.h"
+#ifdef USE_SENSOR
+#include "esphome/sensor/sensor.h"
+#endif
 
 ESPHOME_NAMESPACE_BEGIN
 
-/// The debug component prints out debug information like free heap size on startup.
-class DebugComponent : public Component {
+#ifdef USE_SENSOR
+using DebugHeapSensor = sensor::EmptyPollingParentSensor<0, sensor::ICON_MEMORY, sensor::UNIT_BYTES>;
+using DebugFragmentationSensor = sensor::EmptyPollingParentSensor<0, sensor::ICON_MEMORY, sensor::UNIT_PERCENT>;
+#endif
+
+/** The debug component prints out debug information like free heap size on startup.
+ *
+ * It watches the heap in every loop and can publish its state every update interval through the heap sensors.
+ * With the heap tracer (USE_HEAP_TRACER) the components holding the most heap are logged when the heap runs low.
+ */
+class DebugComponent : public PollingComponent {
  public:
+  explicit DebugComponent(uint32_t update_interval = 60000);
+
   void setup() override;
   void loop() override;
+  void update() override;
+  /// loop() samples the heap, but doesn't have to wake up the idle mode for it.
+  uint32_t get_loop_idle_time() override;
   float get_setup_priority() const override;
   void dump_config() override;
 
+#ifdef USE_SENSOR
+  /// The free heap size in bytes.
+  DebugHeapSensor *make_free_heap_sensor(const std::string &name);
+  /// The largest block that can be allocated in bytes, smaller than the free heap if it's fragmented.
+  DebugHeapSensor *make_largest_free_block_sensor(const std::string &name);
+  /// How much of the free heap isn't part of the largest free block, in percent.
+  DebugFragmentationSensor *make_heap_fragmentation_sensor(const std::string &name);
+  /// The lowest free heap size since boot in bytes. Sampled every loop on the ESP8266, exact on the ESP32.
+  DebugHeapSensor *make_min_free_heap_sensor(const std::string &name);
+#endif
+
  protected:
+  /// Get the size of the largest free heap block in bytes.
+  uint32_t get_largest_free_block_();
+  uint32_t get_min_free_heap_();
+#ifdef USE_HEAP_TRACER
+  /// Log the components with the most retained heap.
+  void dump_top_allocators_();
+#endif
+
   uint32_t free_heap_{};
+  /// The lowest free heap size seen in loop().
+  uint32_t min_free_heap_{UINT32_MAX};
+#ifdef USE_SENSOR
+  DebugHeapSensor *free_heap_sensor_{nullptr};
+  DebugHeapSensor *largest_free_block_sensor_{nullptr};
+  DebugFragmentationSensor *heap_fragmentation_sensor_{nullptr};
+  DebugHeapSensor *min_free_heap_sensor_{nullptr};
+#endif
 };
 
 ESPHOME_NAMESPACE_END
@@ -2,24 +2,75 @@
 
 #ifdef USE_DEEP_SLEEP
 
+#include <algorithm>
+#include <cmath>
 #include <Esp.h>
+#ifdef ARDUINO_ARCH_ESP8266
+#include <user_interface.h>
+#endif
 #include "esphome/deep_sleep_component.h"
 #include "esphome/log.h"
 #include "esphome/helpers.h"
 #include "esphome/ota_component.h"
 
+#ifdef USE_MQTT
+#include "esphome/mqtt/mqtt_client_component.h"
+#endif
+
 ESPHOME_NAMESPACE_BEGIN
 
 static const char *TAG = "deep_sleep";
 
 bool global_has_deep_sleep = false;
 
+#ifdef ARDUINO_ARCH_ESP32
+/// Kept in RTC slow memory, which is only initialized when the node wasn't woken up from deep sleep.
+RTC_DATA_ATTR static DeepSleepWakeState deep_sleep_wake_state = {};
+#endif
+
 void DeepSleepComponent::setup() {
   ESP_LOGCONFIG(TAG, "Setting up Deep Sleep...");
   global_has_deep_sleep = true;
 
   if (this->run_duration_.has_value())
     this->set_timeout(*this->run_duration_, [this]() { this->begin_sleep(); });
+
+  if (!this->wake_cycle_mode_)
+    return;
+
+  this->load_wake_state_();
+  ESP_LOGD(TAG, "Wake %u", this->wake_state_.wake_count);
+#ifdef USE_SENSOR
+  uint8_t filter_index = 0;
+  for (auto &wake : this->wake_sensors_) {
+    wake.due = this->wake_state_.wake_count % wake.every_n_wakes == 0;
+    // every filter takes a slot, so that the slots stay the same across wakes
+    for (sensor::Filter *filter = wake.sensor->get_filters(); filter != nullptr; filter = filter->get_next()) {
+      if (filter_index >= DEEP_SLEEP_MAX_FILTER_STATES)
+        break;
+      const float state = this->wake_state_.filter_states[filter_index];
+      if (filter_index < this->wake_state_.filter_count && !std::isnan(state))
+        filter->restore_state(state);
+      filter_index++;
+    }
+  }
+  for (uint32_t i = 0; i < this->wake_sensors_.size(); i++) {
+    auto &wake = this->wake_sensors_[i];
+    bool component_due = false;
+    for (auto &other : this->wake_sensors_)
+      component_due |= other.component == wake.component && other.due;
+    if (!component_due)
+      wake.component->skip_setup();
+    if (wake.due)
+      wake.sensor->add_on_state_callback([this, i](float state) { this->wake_sensors_[i].published = true; });
+  }
+#endif
+#ifdef USE_MQTT
+  // retained discovery messages are still known by the broker from the first wake
+  if (global_mqtt_client != nullptr && this->wake_state_.wake_count != 0 &&
+      global_mqtt_client->get_discovery_info().retain)
+    global_mqtt_client->disable_discovery();
+#endif
 }
 void DeepSleepComponent::dump_config() {
   ESP_LOGCONFIG(TAG, "Setting up Deep Sleep...");
@@ -29,6 +80,9 @@ void DeepSleepComponent::dump_config() {
   if (this->run_duration_.has_value()) {
     ESP_LOGCONFIG(TAG, "  Run Duration: %u ms", *this->run_duration_);
   }
+  if (this->wake_cycle_mode_) {
+    ESP_LOGCONFIG(TAG, "  Wake Cycle Mode: wake %u", this->wake_state_.wake_count);
+  }
 #ifdef ARDUINO_ARCH_ESP32
   if (this->wakeup_pin_.has_value()) {
     LOG_PIN("  Wakeup Pin: ", *this->wakeup_pin_);
@@ -36,8 +90,63 @@ void DeepSleepComponent::dump_config() {
 #endif
 }
 void DeepSleepComponent::loop() {
-  if (this->next_enter_deep_sleep_)
+  if (this->next_enter_deep_sleep_) {
     this->begin_sleep();
+    return;
+  }
+  if (this->wake_cycle_mode_ && !this->wake_cycle_done_ && this->is_wake_cycle_done_()) {
+    this->wake_cycle_done_ = true;
+    ESP_LOGI(TAG, "Published all readings of this wake after %u ms", millis());
+    // give the network stack a moment to send the last packets
+    this->set_timeout("wake_cycle", 100, [this]() { this->begin_sleep(); });
+  }
+}
+bool DeepSleepComponent::is_wake_cycle_done_() {
+#ifdef USE_SENSOR
+  for (auto &wake : this->wake_sensors_) {
+    if (wake.due && !wake.published)
+      return false;
+  }
+#endif
+#ifdef USE_MQTT
+  if (global_mqtt_client != nullptr &&
+      (!global_mqtt_client->is_connected() || global_mqtt_client->has_pending_messages()))
+    return false;
+#endif
+  return true;
+}
+void DeepSleepComponent::load_wake_state_() {
+#ifdef ARDUINO_ARCH_ESP32
+  this->wake_state_ = deep_sleep_wake_state;
+  if (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_UNDEFINED)
+    this->wake_state_ = DeepSleepWakeState{};
+#endif
+#ifdef ARDUINO_ARCH_ESP8266
+  this->wake_state_pref_ = global_preferences.make_preference<DeepSleepWakeState>(3404915417UL);
+  if (!this->wake_state_pref_.load(&this->wake_state_) || ESP.getResetInfoPtr()->reason != REASON_DEEP_SLEEP_AWAKE)
+    this->wake_state_ = DeepSleepWakeState{};
+#endif
+}
+void DeepSleepComponent::save_wake_state_() {
+  this->wake_state_.wake_count++;
+#ifdef USE_SENSOR
+  uint8_t filter_index = 0;
+  for (auto &wake : this->wake_sensors_) {
+    for (sensor::Filter *filter = wake.sensor->get_filters(); filter != nullptr; filter = filter->get_next()) {
+      if (filter_index >= DEEP_SLEEP_MAX_FILTER_STATES)
+        break;
+      float state;
+      this->wake_state_.filter_states[filter_index++] = filter->get_state(&state) ? state : NAN;
+    }
+  }
+  this->wake_state_.filter_count = filter_index;
+#endif
+#ifdef ARDUINO_ARCH_ESP32
+  deep_sleep_wake_state = this->wake_state_;
+#endif
+#ifdef ARDUINO_ARCH_ESP8266
+  this->wake_state_pref_.save(&this->wake_state_);
+#endif
 }
 float DeepSleepComponent::get_loop_priority() const {
   return -100.0f;  // run after everything else is ready
@@ -51,6 +160,19 @@ void DeepSleepComponent::set_wakeup_pin_mode(WakeupPinMode wakeup_pin_mode) {
 void DeepSleepComponent::set_ext1_wakeup(Ext1Wakeup ext1_wakeup) { this->ext1_wakeup_ = ext1_wakeup; }
 #endif
 void DeepSleepComponent::set_run_duration(uint32_t time_ms) { this->run_duration_ = time_ms; }
+void DeepSleepComponent::set_wake_cycle_mode(bool wake_cycle_mode) { this->wake_cycle_mode_ = wake_cycle_mode; }
+#ifdef USE_SENSOR
+void DeepSleepComponent::add_wake_sensor(sensor::Sensor *sensor, Component *component, uint32_t every_n_wakes) {
+  this->wake_sensors_.push_back(WakeSensor{
+      .sensor = sensor,
+      .component = component,
+      .every_n_wakes = std::max(every_n_wakes, uint32_t(1)),
+      .due = true,
+      .published = false,
+  });
+}
+#endif
+uint32_t DeepSleepComponent::get_wake_count() const { return this->wake_state_.wake_count; }
 void DeepSleepComponent::begin_sleep(bool manual) {
   if (this->prevent_ && !manual) {
     this->next_enter_deep_sleep_ = true;
@@ -71,6 +193,8 @@ void DeepSleepComponent::begin_sleep(bool manual) {
 
   ESP_LOGI(TAG, "Beginning Deep Sleep");
 
+  if (this->wake_cycle_mode_)
+    this->save_wake_state_();
   run_safe_shutdown_hooks("deep-sleep");
 
 #ifdef ARDUINO_ARCH_ESP32
@@ -92,7 +216,12 @@ void DeepSleepComponent::begin_sleep(bool manual) {
   ESP.deepSleep(*this->sleep_duration_);
 #endif
 }
-float DeepSleepComponent::get_setup_priority() const { return -100.0f; }
+float DeepSleepComponent::get_setup_priority() const {
+  // in wake cycle mode, decide which components to set up before any of them is set up
+  if (this->wake_cycle_mode_)
+    return setup_priority::PRE_HARDWARE + 1.0f;
+  return -100.0f;
+}
 void DeepSleepComponent::prevent_deep_sleep() { this->prevent_ = true; }
 
 ESPHOME_NAMESPACE_END
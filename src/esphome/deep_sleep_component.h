@@ -8,6 +8,11 @@
 #include "esphome/component.h"
 #include "esphome/helpers.h"
 #include "esphome/automation.h"
+#include "esphome/esppreferences.h"
+
+#ifdef USE_SENSOR
+#include "esphome/sensor/sensor.h"
+#endif
 
 ESPHOME_NAMESPACE_BEGIN
 
@@ -33,6 +38,16 @@ struct Ext1Wakeup {
 
 #endif
 
+/// The maximum number of filter states kept across deep sleep in wake cycle mode.
+#define DEEP_SLEEP_MAX_FILTER_STATES 16
+
+/// The state kept in RTC memory across wakes in wake cycle mode.
+struct DeepSleepWakeState {
+  uint32_t wake_count;
+  uint8_t filter_count;
+  float filter_states[DEEP_SLEEP_MAX_FILTER_STATES];
+};
+
 template<typename... Ts> class EnterDeepSleepAction;
 
 template<typename... Ts> class PreventDeepSleepAction;
@@ -60,6 +75,27 @@ class DeepSleepComponent : public Component {
   /// Set a duration in ms for how long the code should run before entering deep sleep mode.
   void set_run_duration(uint32_t time_ms);
 
+  /** Run a single "publish once and sleep" cycle every wake instead of staying awake for the run duration.
+   *
+   * The node goes to sleep as soon as every sensor added with add_wake_sensor() that is due this wake has
+   * published a state and the MQTT client (if any) has sent all messages, with QoS 1/2 messages acknowledged.
+   * The run duration, if set, still limits how long the node stays awake. Components of sensors that aren't
+   * due aren't set up at all, MQTT discovery is only sent on the first wake if it's retained and the state of
+   * moving average filters of the wake sensors is kept in RTC memory between wakes (so use a send_every of 1).
+   */
+  void set_wake_cycle_mode(bool wake_cycle_mode);
+#ifdef USE_SENSOR
+  /** Wait for a reading of this sensor before sleeping in wake cycle mode.
+   *
+   * @param sensor The sensor to wait for.
+   * @param component The component reading the sensor, it's only set up on wakes the sensor is due.
+   * @param every_n_wakes Only read the sensor every n-th wake.
+   */
+  void add_wake_sensor(sensor::Sensor *sensor, Component *component, uint32_t every_n_wakes = 1);
+#endif
+  /// The number of wakes since the node was powered on (wake cycle mode only).
+  uint32_t get_wake_count() const;
+
   void setup() override;
   void dump_config() override;
   void loop() override;
@@ -76,6 +112,11 @@ class DeepSleepComponent : public Component {
   void prevent_deep_sleep();
 
  protected:
+  /// Whether all readings of this wake have been published.
+  bool is_wake_cycle_done_();
+  void load_wake_state_();
+  void save_wake_state_();
+
   optional<uint64_t> sleep_duration_;
 #ifdef ARDUINO_ARCH_ESP32
   optional<GPIOPin *> wakeup_pin_;
@@ -85,6 +126,22 @@ class DeepSleepComponent : public Component {
   optional<uint32_t> run_duration_;
   bool next_enter_deep_sleep_{false};
   bool prevent_{false};
+  bool wake_cycle_mode_{false};
+  bool wake_cycle_done_{false};
+  DeepSleepWakeState wake_state_{};
+#ifdef ARDUINO_ARCH_ESP8266
+  ESPPreferenceObject wake_state_pref_;
+#endif
+#ifdef USE_SENSOR
+  struct WakeSensor {
+    sensor::Sensor *sensor;
+    Component *component;
+    uint32_t every_n_wakes;
+    bool due;
+    bool published;
+  };
+  std::vector<WakeSensor> wake_sensors_;
+#endif
 };
 
 extern bool global_has_deep_sleep;
@@ -33,6 +33,7 @@
 #define USE_DALLAS_SENSOR
 #define USE_PULSE_COUNTER_SENSOR
 #define USE_ADC_SENSOR
+#define USE_SPECTRUM_ANALYZER
 #define USE_ADS1115_SENSOR
 #define USE_BMP085_SENSOR
 #define USE_HTU21D_SENSOR
@@ -51,6 +52,10 @@
 #endif
 #endif
 #define USE_LIGHT
+#define USE_LIGHT_FIXED_POINT
+#ifdef ARDUINO_ARCH_ESP32
+#define USE_I2S_PARALLEL_LIGHT
+#endif
 #define USE_SWITCH
 #define USE_OUTPUT_SWITCH
 #define USE_REMOTE
@@ -61,6 +66,12 @@
 #define USE_SHUTDOWN_SWITCH
 #define USE_FAN
 #define USE_DEBUG_COMPONENT
+#define USE_BENCHMARK_COMPONENT
+#define USE_LOOP_MONITOR
+#define USE_COMPONENT_PROFILER
+#define USE_HEAP_TRACER
+#define USE_TRACER
+#define USE_METRICS
 #define USE_DEEP_SLEEP
 #define USE_PCF8574
 #define USE_MCP23017
@@ -90,6 +101,7 @@
 #define USE_TEMPLATE_COVER
 #ifdef ARDUINO_ARCH_ESP32
 #define USE_ESP32_HALL_SENSOR
+#define USE_ESP32_ULP_SENSOR
 #define USE_ESP32_CAMERA
 #endif
 #define USE_DUTY_CYCLE_SENSOR
@@ -100,6 +112,7 @@
 #define USE_MHZ19
 #define USE_UART_SWITCH
 #define USE_UPTIME_SENSOR
+#define USE_I2C_BUS_SENSOR
 #define USE_INA219
 #define USE_INA3221
 #define USE_HMC5883L
@@ -129,7 +142,10 @@
 #define USE_STEPPER
 #define USE_A4988
 #define USE_ULN2003
+#define USE_STEPPER_MOTION_PLANNER
 #define USE_TOTAL_DAILY_ENERGY_SENSOR
+#define USE_SENSOR_HISTORY
+#define USE_SENSOR_DUTY_CYCLE
 #define USE_MY9231_OUTPUT
 #define USE_CUSTOM_SENSOR
 #define USE_CUSTOM_BINARY_SENSOR
@@ -138,6 +154,9 @@
 #define USE_CUSTOM_TEXT_SENSOR
 #define USE_CUSTOM_COMPONENT
 #define USE_API
+#define USE_API_STATE_BROADCAST
+#define USE_ESP_NOW_BRIDGE
+#define USE_API_CLIENT
 #define USE_HOMEASSISTANT_TIME
 #define USE_HOMEASSISTANT_SENSOR
 #define USE_HOMEASSISTANT_TEXT_SENSOR
@@ -151,8 +170,42 @@
 #define USE_TTP229_LSF
 #define USE_CLIMATE
 #define USE_BANG_BANG_CLIMATE
+#define USE_PID_CLIMATE
 #endif
 
+#ifdef USE_API_STATE_BROADCAST
+#ifndef USE_API
+#define USE_API
+#endif
+#endif
+#ifdef USE_ESP_NOW_BRIDGE
+#ifndef USE_API
+#define USE_API
+#endif
+#endif
+#ifdef USE_API_CLIENT
+#ifndef USE_API
+#define USE_API
+#endif
+#endif
+#ifdef USE_SENSOR_HISTORY
+#ifndef USE_SENSOR
+#define USE_SENSOR
+#endif
+#ifndef USE_TIME
+#define USE_TIME
+#endif
+#endif
+#if defined(USE_SDS011) || defined(USE_PMSX003) || defined(USE_MHZ19)
+#ifndef USE_SENSOR_DUTY_CYCLE
+#define USE_SENSOR_DUTY_CYCLE
+#endif
+#endif
+#ifdef USE_SENSOR_DUTY_CYCLE
+#ifndef USE_SENSOR
+#define USE_SENSOR
+#endif
+#endif
 #ifdef USE_REMOTE_RECEIVER
 #ifndef USE_REMOTE
 #define USE_REMOTE
@@ -182,6 +235,16 @@
 #define USE_SENSOR
 #endif
 #endif
+#ifdef USE_HEAP_TRACER
+#ifndef USE_COMPONENT_PROFILER
+#define USE_COMPONENT_PROFILER
+#endif
+#endif
+#ifdef USE_BENCHMARK_COMPONENT
+#ifndef USE_SENSOR
+#define USE_SENSOR
+#endif
+#endif
 #ifdef USE_PN532
 #ifndef USE_BINARY_SENSOR
 #define USE_BINARY_SENSOR
@@ -197,6 +260,11 @@
 #define USE_ONE_WIRE
 #endif
 #endif
+#ifdef USE_I2S_PARALLEL_LIGHT
+#ifndef USE_LIGHT
+#define USE_LIGHT
+#endif
+#endif
 #ifdef USE_LIGHT
 #ifndef USE_OUTPUT
 #define USE_OUTPUT
@@ -222,6 +290,11 @@
 #define USE_PULSE_COUNTER_SENSOR
 #endif
 #endif
+#ifdef USE_ROTARY_ENCODER_SENSOR
+#ifndef USE_PULSE_COUNTER_SENSOR
+#define USE_PULSE_COUNTER_SENSOR
+#endif
+#endif
 #ifdef USE_MY9231_OUTPUT
 #ifndef USE_OUTPUT
 #define USE_OUTPUT
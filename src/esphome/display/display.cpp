@@ -3,8 +3,10 @@
 #ifdef USE_DISPLAY
 
 #include "esphome/display/display.h"
+#include "esphome/application.h"
 #include "esphome/log.h"
 #include "esphome/espmath.h"
+#include "esphome/helpers.h"
 
 #include <pgmspace.h>
 
@@ -17,14 +19,41 @@ namespace display {
 
 static const char *TAG = "display.display";
 
+/// Maximum number of texts tracked on a retained page.
+static const size_t DISPLAY_MAX_RETAINED_TEXTS = 32;
+
 void DisplayBuffer::init_internal_(uint32_t buffer_length) {
   this->buffer_ = new uint8_t[buffer_length];
   if (this->buffer_ == nullptr) {
     ESP_LOGE(TAG, "Could not allocate buffer for display!");
     return;
   }
+  this->buffer_length_ = buffer_length;
   this->clear();
 }
+void DisplayBuffer::init_dirty_bands_(uint32_t band_length) {
+  this->band_length_ = band_length;
+  const uint32_t bands = (this->buffer_length_ + band_length - 1) / band_length;
+  this->band_hashes_.resize(bands);
+  this->dirty_bands_.resize(bands);
+  this->all_dirty_ = true;
+}
+bool HOT DisplayBuffer::update_dirty_bands_() {
+  bool any_dirty = false;
+  for (uint32_t i = 0; i < this->band_hashes_.size(); i++) {
+    const uint32_t start = i * this->band_length_;
+    const uint32_t length = std::min(this->band_length_, this->buffer_length_ - start);
+    const uint32_t hash = fnv1_hash(reinterpret_cast<const char *>(this->buffer_ + start), length);
+    const bool dirty = this->all_dirty_ || hash != this->band_hashes_[i];
+    this->band_hashes_[i] = hash;
+    this->dirty_bands_[i] = dirty;
+    any_dirty |= dirty;
+  }
+  this->all_dirty_ = false;
+  return any_dirty;
+}
+bool DisplayBuffer::is_band_dirty_(uint32_t band) const { return this->dirty_bands_[band]; }
+void DisplayBuffer::mark_all_dirty_() { this->all_dirty_ = true; }
 void DisplayBuffer::fill(int color) { this->filled_rectangle(0, 0, this->get_width(), this->get_height(), color); }
 void DisplayBuffer::clear() { this->fill(COLOR_OFF); }
 int DisplayBuffer::get_width() {
@@ -91,14 +120,90 @@ void HOT DisplayBuffer::line(int x1, int y1, int x2, int y2, int color) {
   }
 }
 void HOT DisplayBuffer::horizontal_line(int x, int y, int width, int color) {
-  // Future: Could be made more efficient by manipulating buffer directly in certain rotations.
-  for (int i = x; i < x + width; i++)
-    this->draw_pixel_at(i, y, color);
+  switch (this->rotation_) {
+    case DISPLAY_ROTATION_0_DEGREES:
+      this->fill_span_clipped_(x, y, width, color);
+      break;
+    case DISPLAY_ROTATION_180_DEGREES:
+      this->fill_span_clipped_(this->get_width_internal() - x - width, this->get_height_internal() - y - 1, width,
+                               color);
+      break;
+    default:
+      // rotated by 90°, a column in the buffer
+      for (int i = x; i < x + width; i++)
+        this->draw_pixel_at(i, y, color);
+      break;
+  }
 }
 void HOT DisplayBuffer::vertical_line(int x, int y, int height, int color) {
-  // Future: Could be made more efficient by manipulating buffer directly in certain rotations.
-  for (int i = y; i < y + height; i++)
-    this->draw_pixel_at(x, i, color);
+  switch (this->rotation_) {
+    case DISPLAY_ROTATION_90_DEGREES:
+      this->fill_span_clipped_(this->get_width_internal() - y - height, x, height, color);
+      break;
+    case DISPLAY_ROTATION_270_DEGREES:
+      this->fill_span_clipped_(y, this->get_height_internal() - x - 1, height, color);
+      break;
+    default:
+      for (int i = y; i < y + height; i++)
+        this->draw_pixel_at(x, i, color);
+      break;
+  }
+}
+void HOT DisplayBuffer::fill_span_clipped_(int x, int y, int width, int color) {
+  if (y < 0 || y >= this->get_height_internal())
+    return;
+  if (x < 0) {
+    width += x;
+    x = 0;
+  }
+  width = std::min(width, this->get_width_internal() - x);
+  if (width <= 0)
+    return;
+  this->fill_span_internal(x, y, width, color);
+  feed_wdt();
+}
+void HOT DisplayBuffer::fill_span_internal(int x, int y, int width, int color) {
+  for (int i = x; i < x + width; i++)
+    this->draw_absolute_pixel_internal(i, y, color);
+}
+void HOT DisplayBuffer::blit_1bpp_internal(int x, int y, const uint8_t *data, int width, int height, int color,
+                                           bool opaque) {
+  const uint32_t stride = (width + 7u) / 8u;
+  for (int row = 0; row < height; row++) {
+    const uint8_t *row_data = data + row * stride;
+    uint8_t bits = 0;
+    for (int col = 0; col < width; col++) {
+      if ((col & 7) == 0)
+        bits = pgm_read_byte(row_data + col / 8);
+      if (bits & (0x80 >> (col & 7)))
+        this->draw_absolute_pixel_internal(x + col, y + row, color);
+      else if (opaque)
+        this->draw_absolute_pixel_internal(x + col, y + row, COLOR_OFF);
+    }
+  }
+}
+void HOT DisplayBuffer::blit_1bpp_(int x, int y, const uint8_t *data, int width, int height, int color, bool opaque) {
+  if (this->rotation_ == DISPLAY_ROTATION_0_DEGREES) {
+    if (x >= this->get_width_internal() || y >= this->get_height_internal() || x + width <= 0 || y + height <= 0)
+      return;
+    this->blit_1bpp_internal(x, y, data, width, height, color, opaque);
+    feed_wdt();
+    return;
+  }
+
+  const uint32_t stride = (width + 7u) / 8u;
+  for (int row = 0; row < height; row++) {
+    const uint8_t *row_data = data + row * stride;
+    uint8_t bits = 0;
+    for (int col = 0; col < width; col++) {
+      if ((col & 7) == 0)
+        bits = pgm_read_byte(row_data + col / 8);
+      if (bits & (0x80 >> (col & 7)))
+        this->draw_pixel_at(x + col, y + row, color);
+      else if (opaque)
+        this->draw_pixel_at(x + col, y + row, COLOR_OFF);
+    }
+  }
 }
 void DisplayBuffer::rectangle(int x1, int y1, int width, int height, int color) {
   this->horizontal_line(x1, y1, width, color);
@@ -107,9 +212,13 @@ void DisplayBuffer::rectangle(int x1, int y1, int width, int height, int color)
   this->vertical_line(x1 + width - 1, y1, height, color);
 }
 void DisplayBuffer::filled_rectangle(int x1, int y1, int width, int height, int color) {
-  // Future: Use vertical_line and horizontal_line methods depending on rotation to reduce memory accesses.
-  for (int i = y1; i < y1 + height; i++) {
-    this->horizontal_line(x1, i, width, color);
+  // Use the lines that are spans in the buffer
+  if (this->rotation_ == DISPLAY_ROTATION_90_DEGREES || this->rotation_ == DISPLAY_ROTATION_270_DEGREES) {
+    for (int i = x1; i < x1 + width; i++)
+      this->vertical_line(i, y1, height, color);
+  } else {
+    for (int i = y1; i < y1 + height; i++)
+      this->horizontal_line(x1, i, width, color);
   }
 }
 void HOT DisplayBuffer::circle(int center_x, int center_xy, int radius, int color) {
@@ -163,9 +272,38 @@ void DisplayBuffer::filled_circle(int center_x, int center_y, int radius, int co
 }
 
 void DisplayBuffer::print(int x, int y, Font *font, int color, TextAlign align, const char *text) {
+  RetainedText *retained = nullptr;
+  if (this->retained_) {
+    retained = this->get_retained_text_(x, y, font, color, align);
+    if (retained != nullptr) {
+      retained->seen = true;
+      if (!retained->redraw && retained->text == text)
+        // unchanged, still in the buffer
+        return;
+      this->erase_retained_text_(retained);
+      retained->text = text;
+    }
+  }
+
+  int x1, y1, x2, y2;
+  this->render_text_(x, y, font, color, align, text, &x1, &y1, &x2, &y2);
+  if (retained != nullptr) {
+    retained->x1 = x1;
+    retained->y1 = y1;
+    retained->x2 = x2;
+    retained->y2 = y2;
+    retained->redraw = false;
+  }
+}
+void DisplayBuffer::render_text_(int x, int y, Font *font, int color, TextAlign align, const char *text, int *x1,
+                                 int *y1, int *x2, int *y2) {
   int x_start, y_start;
   int width, height;
   this->get_text_bounds(x, y, text, font, align, &x_start, &y_start, &width, &height);
+  *x1 = x_start;
+  *y1 = y_start;
+  *x2 = x_start;
+  *y2 = y_start;
 
   int i = 0;
   int x_at = x_start;
@@ -177,9 +315,9 @@ void DisplayBuffer::print(int x, int y, Font *font, int color, TextAlign align,
       ESP_LOGW(TAG, "Encountered character without representation in font: '%c'", text[i]);
       if (!font->get_glyphs().empty()) {
         uint8_t glyph_width = font->get_glyphs()[0].width_;
-        for (int glyph_x = 0; glyph_x < glyph_width; glyph_x++)
-          for (int glyph_y = 0; glyph_y < height; glyph_y++)
-            this->draw_pixel_at(glyph_x + x_at, glyph_y + y_start, color);
+        this->filled_rectangle(x_at, y_start, glyph_width, height, color);
+        *x2 = std::max(*x2, x_at + glyph_width);
+        *y2 = std::max(*y2, y_start + height);
         x_at += glyph_width;
       }
 
@@ -188,34 +326,79 @@ void DisplayBuffer::print(int x, int y, Font *font, int color, TextAlign align,
     }
 
     const Glyph &glyph = font->get_glyphs()[glyph_n];
-    int scan_x1, scan_y1, scan_width, scan_height;
-    glyph.scan_area(&scan_x1, &scan_y1, &scan_width, &scan_height);
-
-    for (int glyph_x = scan_x1; glyph_x < scan_x1 + scan_width; glyph_x++) {
-      for (int glyph_y = scan_y1; glyph_y < scan_y1 + scan_height; glyph_y++) {
-        if (glyph.get_pixel(glyph_x, glyph_y)) {
-          this->draw_pixel_at(glyph_x + x_at, glyph_y + y_start, color);
-        }
-      }
-    }
+    const int glyph_x = x_at + glyph.offset_x_;
+    const int glyph_y = y_start + glyph.offset_y_;
+    this->blit_1bpp_(glyph_x, glyph_y, glyph.data_, glyph.width_, glyph.height_, color, false);
+    *x1 = std::min(*x1, glyph_x);
+    *y1 = std::min(*y1, glyph_y);
+    *x2 = std::max(*x2, glyph_x + glyph.width_);
+    *y2 = std::max(*y2, glyph_y + glyph.height_);
 
     x_at += glyph.width_ + glyph.offset_x_;
 
     i += match_length;
   }
 }
+DisplayBuffer::RetainedText *DisplayBuffer::get_retained_text_(int x, int y, Font *font, int color, TextAlign align) {
+  for (auto &text : this->retained_texts_) {
+    if (text.x == x && text.y == y && text.font == font && text.color == color && text.align == align)
+      return &text;
+  }
+
+  if (this->retained_texts_.size() >= DISPLAY_MAX_RETAINED_TEXTS) {
+    ESP_LOGW(TAG, "Too many texts on retained page, disabling retained mode for it.");
+    this->page_->set_retained(false);
+    // redraw everything next time
+    this->retained_page_ = nullptr;
+    this->retained_ = false;
+    return nullptr;
+  }
+
+  RetainedText text{};
+  text.font = font;
+  text.x = x;
+  text.y = y;
+  text.color = color;
+  text.align = align;
+  this->retained_texts_.push_back(text);
+  return &this->retained_texts_.back();
+}
+void DisplayBuffer::erase_retained_text_(RetainedText *text) {
+  if (text->x2 <= text->x1 || text->y2 <= text->y1)
+    // nothing drawn yet
+    return;
+  this->filled_rectangle(text->x1, text->y1, text->x2 - text->x1, text->y2 - text->y1, COLOR_OFF);
+
+  for (auto &other : this->retained_texts_) {
+    if (&other == text || other.x2 <= text->x1 || other.x1 >= text->x2 || other.y2 <= text->y1 ||
+        other.y1 >= text->y2)
+      continue;
+    if (other.seen && !other.redraw) {
+      // already skipped in this update, draw it again now
+      int x1, y1, x2, y2;
+      this->render_text_(other.x, other.y, other.font, other.color, other.align, other.text.c_str(), &x1, &y1, &x2,
+                         &y2);
+    } else {
+      other.redraw = true;
+    }
+  }
+}
 void DisplayBuffer::vprintf_(int x, int y, Font *font, int color, TextAlign align, const char *format, va_list arg) {
-  char buffer[256];
-  int ret = vsnprintf(buffer, sizeof(buffer), format, arg);
+  ScratchBuffer buffer(256);
+  int ret = vsnprintf(buffer.data(), buffer.size(), format, arg);
   if (ret > 0)
-    this->print(x, y, font, color, align, buffer);
+    this->print(x, y, font, color, align, buffer.data());
 }
 void DisplayBuffer::image(int x, int y, Image *image) {
-  for (int img_x = 0; img_x < image->get_width(); img_x++) {
-    for (int img_y = 0; img_y < image->get_height(); img_y++) {
-      this->draw_pixel_at(x + img_x, y + img_y, image->get_pixel(img_x, img_y) ? COLOR_ON : COLOR_OFF);
-    }
+  const uint8_t *bitmap = image->get_bitmap_();
+  if (bitmap != nullptr) {
+    this->blit_1bpp_(x, y, bitmap, image->width_, image->height_, COLOR_ON, true);
+    return;
   }
+  // RLE images are decoded straight into spans
+  image->for_each_run_([this, x, y](int col, int row, int length, bool on) {
+    this->horizontal_line(x + col, y + row, length, on ? COLOR_ON : COLOR_OFF);
+  });
 }
 void DisplayBuffer::get_text_bounds(int x, int y, const char *text, Font *font, TextAlign align, int *x1, int *y1,
                                     int *width, int *height) {
@@ -305,12 +488,55 @@ void DisplayBuffer::show_page(DisplayPage *page) { this->page_ = page; }
 void DisplayBuffer::show_next_page() { this->page_->show_next(); }
 void DisplayBuffer::show_prev_page() { this->page_->show_prev(); }
 void DisplayBuffer::do_update_() {
-  this->clear();
+  const bool retained = this->page_ != nullptr && this->page_->is_retained();
+  if (!retained || this->retained_page_ != this->page_) {
+    this->clear();
+    this->retained_texts_.clear();
+  }
+  this->retained_page_ = retained ? this->page_ : nullptr;
+  this->retained_ = retained;
+  for (auto &text : this->retained_texts_)
+    text.seen = false;
+
   if (this->page_ != nullptr) {
     this->page_->get_writer()(*this);
   } else if (this->writer_.has_value()) {
     (*this->writer_)(*this);
   }
+
+  if (this->retained_) {
+    // erase the texts that weren't printed this time
+    for (size_t i = 0; i < this->retained_texts_.size();) {
+      if (this->retained_texts_[i].seen) {
+        i++;
+        continue;
+      }
+      this->erase_retained_text_(&this->retained_texts_[i]);
+      this->retained_texts_.erase(this->retained_texts_.begin() + i);
+    }
+  }
+  this->retained_ = false;
+}
+void DisplayBuffer::render_(std::function<void()> &&on_rendered) {
+  if (this->rendering_) {
+    ESP_LOGV(TAG, "Still rendering the last update, skipping");
+    return;
+  }
+  if (!this->render_in_background_) {
+    this->do_update_();
+    on_rendered();
+    return;
+  }
+  this->rendering_ = true;
+  auto on_done = [this, on_rendered]() {
+    this->rendering_ = false;
+    on_rendered();
+  };
+  if (!App.submit_work([this]() { this->do_update_(); }, std::move(on_done)))
+    this->rendering_ = false;
+}
+void DisplayBuffer::set_render_in_background(bool render_in_background) {
+  this->render_in_background_ = render_in_background;
 }
 #ifdef USE_TIME
 void DisplayBuffer::strftime(int x, int y, Font *font, int color, TextAlign align, const char *format,
@@ -381,7 +607,25 @@ void Glyph::scan_area(int *x1, int *y1, int *width, int *height) const {
   *width = this->width_;
   *height = this->height_;
 }
-int Font::match_next_glyph(const char *str, int *match_length) {
+int HOT Font::match_next_glyph(const char *str, int *match_length) {
+  const auto first = static_cast<uint8_t>(str[0]);
+  if (first < 128) {
+    const int16_t index = this->ascii_index_[first];
+    if (index == FONT_NO_GLYPH) {
+      *match_length = 0;
+      return -1;
+    }
+    if (index != FONT_SEARCH_GLYPH) {
+      *match_length = 1;
+      return index;
+    }
+  }
+  if (this->glyphs_.empty()) {
+    *match_length = 0;
+    return -1;
+  }
+
+  // glyphs are sorted, find the last glyph that is less than or a prefix of str
   int lo = 0;
   int hi = this->glyphs_.size() - 1;
   while (lo != hi) {
@@ -429,19 +673,72 @@ void Font::measure(const char *str, int *width, int *x_offset, int *baseline, in
 }
 const std::vector<Glyph> &Font::get_glyphs() const { return this->glyphs_; }
 Font::Font(std::vector<Glyph> &&glyphs, int baseline, int bottom)
-    : glyphs_(std::move(glyphs)), baseline_(baseline), bottom_(bottom) {}
+    : glyphs_(std::move(glyphs)), baseline_(baseline), bottom_(bottom) {
+  for (int16_t &index : this->ascii_index_)
+    index = FONT_NO_GLYPH;
+  for (size_t i = 0; i < this->glyphs_.size(); i++) {
+    const char *c = this->glyphs_[i].char_;
+    const auto first = static_cast<uint8_t>(c[0]);
+    if (first == 0 || first >= 128)
+      continue;
+    if (c[1] == '\0') {
+      // a longer glyph starting with this character takes precedence
+      if (this->ascii_index_[first] == FONT_NO_GLYPH)
+        this->ascii_index_[first] = i;
+    } else {
+      this->ascii_index_[first] = FONT_SEARCH_GLYPH;
+    }
+  }
+}
 
 bool Image::get_pixel(int x, int y) const {
   if (x < 0 || x >= this->width_ || y < 0 || y >= this->height_)
     return false;
+  const uint8_t *bitmap = this->cache_ != nullptr ? this->cache_ : this->data_start_;
+  if (this->type_ == IMAGE_TYPE_RLE && this->cache_ == nullptr) {
+    // walk the runs up to the pixel
+    const uint32_t pos = x + y * uint32_t(this->width_);
+    uint32_t run_start = 0;
+    for (const uint8_t *data = this->data_start_;; data++) {
+      const uint8_t run = pgm_read_byte(data);
+      run_start += (run & 0x7F) + 1u;
+      if (pos < run_start)
+        return run & 0x80;
+    }
+  }
   const uint32_t width_8 = ((this->width_ + 7u) / 8u) * 8u;
   const uint32_t pos = x + y * width_8;
-  return pgm_read_byte(this->data_start_ + (pos / 8u)) & (0x80 >> (pos % 8u));
+  return pgm_read_byte(bitmap + (pos / 8u)) & (0x80 >> (pos % 8u));
+}
+const uint8_t *Image::get_bitmap_() {
+  if (!this->cached_)
+    return this->type_ == IMAGE_TYPE_BINARY ? this->data_start_ : nullptr;
+  if (this->cache_ != nullptr)
+    return this->cache_;
+
+  const uint32_t stride = (this->width_ + 7u) / 8u;
+  const uint32_t length = stride * this->height_;
+  this->cache_ = new uint8_t[length];
+  if (this->type_ == IMAGE_TYPE_BINARY) {
+    memcpy_P(this->cache_, this->data_start_, length);
+    return this->cache_;
+  }
+  memset(this->cache_, 0, length);
+  this->for_each_run_([this, stride](int x, int y, int length, bool on) {
+    if (!on)
+      return;
+    uint8_t *row = this->cache_ + y * stride;
+    for (int i = x; i < x + length; i++)
+      row[i / 8] |= 0x80 >> (i & 0x07);
+  });
+  return this->cache_;
 }
 int Image::get_width() const { return this->width_; }
 int Image::get_height() const { return this->height_; }
-Image::Image(const uint8_t *data_start, int width, int height)
-    : width_(width), height_(height), data_start_(data_start) {}
+ImageType Image::get_type() const { return this->type_; }
+void Image::set_cached(bool cached) { this->cached_ = cached; }
+Image::Image(const uint8_t *data_start, int width, int height, ImageType type)
+    : width_(width), height_(height), data_start_(data_start), type_(type) {}
 
 DisplayPage::DisplayPage(const display_writer_t &writer) : writer_(writer) {}
 void DisplayPage::show() { this->parent_->show_page(this); }
@@ -451,6 +748,8 @@ void DisplayPage::set_parent(DisplayBuffer *parent) { this->parent_ = parent; }
 void DisplayPage::set_prev(DisplayPage *prev) { this->prev_ = prev; }
 void DisplayPage::set_next(DisplayPage *next) { this->next_ = next; }
 const display_writer_t &DisplayPage::get_writer() const { return this->writer_; }
+void DisplayPage::set_retained(bool retained) { this->retained_ = retained; }
+bool DisplayPage::is_retained() const { return this->retained_; }
 
 }  // namespace display
 
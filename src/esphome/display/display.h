@@ -9,6 +9,7 @@
 #include "esphome/automation.h"
 #include "esphome/time/rtc_component.h"
 #include <functional>
+#include <string>
 #include <vector>
 
 ESPHOME_NAMESPACE_BEGIN
@@ -295,11 +296,66 @@ class DisplayBuffer {
   /// Internal method to set the display rotation with.
   void set_rotation(DisplayRotation rotation);
 
+  /** Render the pages on a worker task instead of the main loop (see Application::submit_work()).
+   *
+   * Only useful on the ESP32. The writer lambdas then run concurrently to the main loop, so they should only read
+   * simple values like sensor states, not strings that may be changed while they run. Defaults to false.
+   */
+  void set_render_in_background(bool render_in_background);
+
  protected:
   void vprintf_(int x, int y, Font *font, int color, TextAlign align, const char *format, va_list arg);
 
   virtual void draw_absolute_pixel_internal(int x, int y, int color) = 0;
 
+  /** Fill width pixels of row y starting at x with color, in display coordinates without rotation.
+   *
+   * The span is already clipped to the display. Drivers can override this to set whole bytes of their
+   * buffer at once, the default implementation draws the pixels one by one.
+   */
+  virtual void fill_span_internal(int x, int y, int width, int color);
+
+  /** Draw a 1 bit per pixel PROGMEM bitmap at [x,y], in display coordinates without rotation.
+   *
+   * The bitmap is stored row by row, MSB first, with each row padded to a full byte. Set bits are drawn with
+   * color, unset bits are drawn with COLOR_OFF if opaque is true and left untouched otherwise. The bitmap
+   * may extend outside of the display.
+   */
+  virtual void blit_1bpp_internal(int x, int y, const uint8_t *data, int width, int height, int color, bool opaque);
+
+  /// Clip a span to the display and fill it with fill_span_internal().
+  void fill_span_clipped_(int x, int y, int width, int color);
+
+  /// Draw a 1bpp bitmap at [x,y] with rotation applied, see blit_1bpp_internal().
+  void blit_1bpp_(int x, int y, const uint8_t *data, int width, int height, int color, bool opaque);
+
+  /// A text printed on a retained page, with the bounds of the pixels drawn for it.
+  struct RetainedText {
+    Font *font;
+    int x;
+    int y;
+    int color;
+    TextAlign align;
+    std::string text;
+    int x1;
+    int y1;
+    /// Exclusive.
+    int x2;
+    int y2;
+    /// Whether the text was printed in the current update.
+    bool seen;
+    /// Whether the text was partially erased by another text and has to be drawn again.
+    bool redraw;
+  };
+
+  /// Draw text and return the bounds of the drawn pixels (x2 and y2 exclusive).
+  void render_text_(int x, int y, Font *font, int color, TextAlign align, const char *text, int *x1, int *y1, int *x2,
+                    int *y2);
+  /// Find or add the retained text entry for a print() call, nullptr if there are too many.
+  RetainedText *get_retained_text_(int x, int y, Font *font, int color, TextAlign align);
+  /// Erase the pixels of a retained text and repair the retained texts overlapping it.
+  void erase_retained_text_(RetainedText *text);
+
   virtual int get_height_internal() = 0;
 
   virtual int get_width_internal() = 0;
@@ -308,10 +364,43 @@ class DisplayBuffer {
 
   void do_update_();
 
+  /** Run do_update_() and then call on_rendered to transfer the buffer.
+   *
+   * With background rendering, do_update_() runs on a worker task and on_rendered is called from the main loop
+   * once it's done. Updates while a render is still running are skipped.
+   */
+  void render_(std::function<void()> &&on_rendered);
+
+  /** Track which parts of the buffer changed between transfers, in bands of band_length bytes.
+   *
+   * Every update clears the buffer and redraws the whole page, so pixel writes alone can't tell what
+   * changed. Instead each band is hashed after drawing and compared to its hash from the last transfer.
+   */
+  void init_dirty_bands_(uint32_t band_length);
+  /// Hash all bands after drawing, returns whether any band changed since the last call.
+  bool update_dirty_bands_();
+  /// Whether the band changed in the last update_dirty_bands_() call.
+  bool is_band_dirty_(uint32_t band) const;
+  /// Treat all bands as changed in the next update_dirty_bands_() call, for example after a failed transfer.
+  void mark_all_dirty_();
+
   uint8_t *buffer_{nullptr};
+  uint32_t buffer_length_{0};
+  uint32_t band_length_{0};
+  std::vector<uint32_t> band_hashes_;
+  std::vector<bool> dirty_bands_;
+  bool all_dirty_{true};
+  /// Texts on the current retained page.
+  std::vector<RetainedText> retained_texts_;
+  /// The retained page whose content is in the buffer, nullptr if the next update has to clear it.
+  DisplayPage *retained_page_{nullptr};
+  /// Whether print() calls are retained, only true during the update of a retained page.
+  bool retained_{false};
   DisplayRotation rotation_{DISPLAY_ROTATION_0_DEGREES};
   optional<display_writer_t> writer_{};
   DisplayPage *page_{nullptr};
+  bool render_in_background_{false};
+  bool rendering_{false};
 };
 
 class DisplayPage {
@@ -325,13 +414,29 @@ class DisplayPage {
   void set_next(DisplayPage *next);
   const display_writer_t &get_writer() const;
 
+  /** Keep the content of this page in the buffer between updates and only redraw texts that changed.
+   *
+   * Texts are identified by position, font, color and alignment. A changed text has its old pixels erased
+   * to COLOR_OFF before it is drawn again, and texts that are no longer printed are erased at the end of
+   * the update. Everything else the writer draws is drawn over the old content without clearing, so only
+   * use this for pages where all other drawing is static.
+   */
+  void set_retained(bool retained);
+  bool is_retained() const;
+
  protected:
   DisplayBuffer *parent_;
   display_writer_t writer_;
   DisplayPage *prev_{nullptr};
   DisplayPage *next_{nullptr};
+  bool retained_{false};
 };
 
+/// Font ASCII index entry for characters that have no glyph.
+static const int16_t FONT_NO_GLYPH = -1;
+/// Font ASCII index entry for characters that need a binary search through the glyphs.
+static const int16_t FONT_SEARCH_GLYPH = -2;
+
 class Glyph {
  public:
   Glyph(const char *a_char, const uint8_t *data_start, uint32_t offset, int offset_x, int offset_y, int width,
@@ -353,10 +458,10 @@ class Glyph {
 
   const char *char_;
   const uint8_t *data_;
-  int offset_x_;
-  int offset_y_;
-  int width_;
-  int height_;
+  int16_t offset_x_;
+  int16_t offset_y_;
+  int16_t width_;
+  int16_t height_;
 };
 
 class Font {
@@ -377,23 +482,78 @@ class Font {
 
  protected:
   std::vector<Glyph> glyphs_;
+  /** Direct lookup of the glyph index for each ASCII character.
+   *
+   * FONT_NO_GLYPH if the font has no glyph starting with the character, FONT_SEARCH_GLYPH if a glyph
+   * of several characters starts with it and the glyphs need to be searched.
+   */
+  int16_t ascii_index_[128];
   int baseline_;
   int bottom_;
 };
 
+enum ImageType {
+  /// 1 bit per pixel, MSB first, each row padded to whole bytes.
+  IMAGE_TYPE_BINARY = 0,
+  /** Run-length encoded 1 bit per pixel.
+   *
+   * Each byte is a run of (byte & 0x7F) + 1 pixels, which are on if bit 7 is set. Runs continue across rows,
+   * so large areas of one color take a byte per 128 pixels.
+   */
+  IMAGE_TYPE_RLE = 1,
+};
+
 class Image {
  public:
-  Image(const uint8_t *data_start, int width, int height);
+  Image(const uint8_t *data_start, int width, int height, ImageType type = IMAGE_TYPE_BINARY);
   bool get_pixel(int x, int y) const;
   int get_width() const;
   int get_height() const;
+  ImageType get_type() const;
+
+  /** Decode the image into RAM on the first draw and draw it from there.
+   *
+   * Useful for small icons that are drawn on every update, costs a bit per pixel of heap.
+   */
+  void set_cached(bool cached);
 
  protected:
+  friend DisplayBuffer;
+
+  /// Call callback(x, y, length, on) for each run of an RLE image, runs are split at the ends of the rows.
+  template<typename F> void for_each_run_(F &&callback) const;
+  /// Get the image as a binary bitmap (in PROGMEM or the cache), nullptr for RLE images without cache.
+  const uint8_t *get_bitmap_();
+
   int width_;
   int height_;
   const uint8_t *data_start_;
+  ImageType type_;
+  bool cached_{false};
+  uint8_t *cache_{nullptr};
 };
 
+template<typename F> void Image::for_each_run_(F &&callback) const {
+  const uint8_t *data = this->data_start_;
+  int x = 0;
+  int y = 0;
+  while (y < this->height_) {
+    const uint8_t run = pgm_read_byte(data++);
+    const bool on = run & 0x80;
+    int length = (run & 0x7F) + 1;
+    while (length > 0 && y < this->height_) {
+      const int span = std::min(length, this->width_ - x);
+      callback(x, y, span, on);
+      length -= span;
+      x += span;
+      if (x == this->width_) {
+        x = 0;
+        y++;
+      }
+    }
+  }
+}
+
 template<typename... Ts> class DisplayPageShowAction : public Action<Ts...> {
  public:
   DisplayPageShowAction();
@@ -4,6 +4,7 @@
 
 #include "esphome/display/lcd_display.h"
 #include "esphome/log.h"
+#include "esphome/helpers.h"
 
 ESPHOME_NAMESPACE_BEGIN
 
@@ -34,8 +35,12 @@ static const uint8_t LCD_DISPLAY_FUNCTION_5X10_DOTS = 0x04;
 
 void LCDDisplay::setup() {
   this->buffer_ = new uint8_t[this->rows_ * this->columns_];
-  for (uint8_t i = 0; i < this->rows_ * this->columns_; i++)
+  this->shadow_ = new uint8_t[this->rows_ * this->columns_];
+  // the display is cleared below
+  for (uint8_t i = 0; i < this->rows_ * this->columns_; i++) {
     this->buffer_[i] = ' ';
+    this->shadow_[i] = ' ';
+  }
 
   uint8_t display_function = 0;
 
@@ -84,29 +89,33 @@ void LCDDisplay::setup() {
 }
 
 float LCDDisplay::get_setup_priority() const { return setup_priority::POST_HARDWARE; }
+uint32_t LCDDisplay::get_loop_idle_time() { return SCHEDULER_DONT_RUN; }
 void HOT LCDDisplay::display() {
-  this->command_(LCD_DISPLAY_COMMAND_SET_DDRAM_ADDR | 0);
-
-  for (uint8_t i = 0; i < this->columns_; i++)
-    this->send(this->buffer_[i], true);
-
-  if (this->rows_ >= 3) {
-    for (uint8_t i = 0; i < this->columns_; i++)
-      this->send(this->buffer_[this->columns_ * 2 + i], true);
-  }
-
-  if (this->rows_ >= 1) {
-    this->command_(LCD_DISPLAY_COMMAND_SET_DDRAM_ADDR | 0x40);
-
-    for (uint8_t i = 0; i < this->columns_; i++)
-      this->send(this->buffer_[this->columns_ + i], true);
-
-    if (this->rows_ >= 4) {
-      for (uint8_t i = 0; i < this->columns_; i++)
-        this->send(this->buffer_[this->columns_ * 3 + i], true);
+  for (uint8_t row = 0; row < this->rows_; row++) {
+    // the address is only sent before the first changed character of each run, the LCD increments it itself
+    bool address_valid = false;
+    for (uint8_t column = 0; column < this->columns_; column++) {
+      const uint8_t pos = row * this->columns_ + column;
+      if (this->buffer_[pos] == this->shadow_[pos]) {
+        address_valid = false;
+        continue;
+      }
+      if (!address_valid) {
+        this->command_(LCD_DISPLAY_COMMAND_SET_DDRAM_ADDR | (this->row_address_(row) + column));
+        address_valid = true;
+      }
+      this->send(this->buffer_[pos], true);
+      this->shadow_[pos] = this->buffer_[pos];
     }
   }
 }
+uint8_t LCDDisplay::row_address_(uint8_t row) const {
+  // rows 2 and 3 continue after rows 0 and 1
+  uint8_t address = (row & 1) ? 0x40 : 0x00;
+  if (row >= 2)
+    address += this->columns_;
+  return address;
+}
 void LCDDisplay::update() {
   for (uint8_t i = 0; i < this->rows_ * this->columns_; i++)
     this->buffer_[i] = ' ';
@@ -137,20 +146,20 @@ void LCDDisplay::print(const std::string &str) { this->print(0, 0, str.c_str());
 void LCDDisplay::printf(uint8_t column, uint8_t row, const char *format, ...) {
   va_list arg;
   va_start(arg, format);
-  char buffer[256];
-  int ret = vsnprintf(buffer, sizeof(buffer), format, arg);
+  ScratchBuffer buffer(256);
+  int ret = vsnprintf(buffer.data(), buffer.size(), format, arg);
   va_end(arg);
   if (ret > 0)
-    this->print(column, row, buffer);
+    this->print(column, row, buffer.data());
 }
 void LCDDisplay::printf(const char *format, ...) {
   va_list arg;
   va_start(arg, format);
-  char buffer[256];
-  int ret = vsnprintf(buffer, sizeof(buffer), format, arg);
+  ScratchBuffer buffer(256);
+  int ret = vsnprintf(buffer.data(), buffer.size(), format, arg);
   va_end(arg);
   if (ret > 0)
-    this->print(0, 0, buffer);
+    this->print(0, 0, buffer.data());
 }
 LCDDisplay::LCDDisplay(uint8_t columns, uint8_t rows, uint32_t update_interval)
     : PollingComponent(update_interval), columns_(columns), rows_(rows) {}
@@ -260,22 +269,27 @@ void PCF8574LCDDisplay::dump_config() {
   }
 }
 bool PCF8574LCDDisplay::is_four_bit_mode() { return true; }
+void PCF8574LCDDisplay::write_nibble_(uint8_t nibble, bool rs, uint8_t *data) {
+  const uint8_t value = (nibble << 4) | rs | 0x08;  // Enable backlight
+  // Pulse ENABLE. At up to 400kHz, each byte takes >20µs on the bus, so the pulse is longer than 450ns and,
+  // together with the following nibble or transaction, the LCD gets its >37µs to process the data.
+  data[0] = value;
+  data[1] = value | 0x04;
+  data[2] = value;
+}
 void PCF8574LCDDisplay::write_n_bits(uint8_t value, uint8_t n) {
-  if (n == 4) {
-    // Ugly fix: in the super setup() with n == 4 value needs to be shifted left
-    value <<= 4;
-  }
-  uint8_t data = value | 0x08;  // Enable backlight
-  this->write_bytes(data, nullptr, 0);
-  // Pulse ENABLE
-  this->write_bytes(data | 0x04, nullptr, 0);
-  delayMicroseconds(1);  // >450ns
-  this->write_bytes(data, nullptr, 0);
-  delayMicroseconds(100);  // >37us
+  // only used for the 4-bit initialization sequence
+  uint8_t data[3];
+  this->write_nibble_(value & 0x0F, false, data);
+  this->write_bytes(data[0], data + 1, 2);
+  delayMicroseconds(40);
 }
 void PCF8574LCDDisplay::send(uint8_t value, bool rs) {
-  this->write_n_bits((value & 0xF0) | rs, 0);
-  this->write_n_bits(((value << 4) & 0xF0) | rs, 0);
+  // both nibbles in a single I2C transaction instead of six, without busy-waiting
+  uint8_t data[6];
+  this->write_nibble_(value >> 4, rs, data);
+  this->write_nibble_(value & 0x0F, rs, data + 3);
+  this->write_bytes(data[0], data + 1, 5);
 }
 PCF8574LCDDisplay::PCF8574LCDDisplay(I2CComponent *parent, uint8_t columns, uint8_t rows, uint8_t address,
                                      uint32_t update_interval)
@@ -27,6 +27,7 @@ class LCDDisplay : public PollingComponent {
   void setup() override;
   float get_setup_priority() const override;
   void update() override;
+  uint32_t get_loop_idle_time() override;
   void display();
 
   /// Print the given text at the specified column and row.
@@ -56,10 +57,14 @@ class LCDDisplay : public PollingComponent {
   virtual void send(uint8_t value, bool rs) = 0;
 
   void command_(uint8_t value);
+  /// Get the DDRAM address of the first character of the given row.
+  uint8_t row_address_(uint8_t row) const;
 
   uint8_t columns_;
   uint8_t rows_;
   uint8_t *buffer_{nullptr};
+  /// What's currently shown on the display, display() only sends the characters that differ from buffer_.
+  uint8_t *shadow_{nullptr};
   lcd_writer_t writer_;
 };
 
@@ -99,6 +104,8 @@ class PCF8574LCDDisplay : public LCDDisplay, public I2CDevice {
   bool is_four_bit_mode() override;
   void write_n_bits(uint8_t value, uint8_t n) override;
   void send(uint8_t value, bool rs) override;
+  /// Write the nibble with a pulse on ENABLE, each output byte takes longer than the LCD needs to process it.
+  void write_nibble_(uint8_t nibble, bool rs, uint8_t *data);
 };
 #endif
 
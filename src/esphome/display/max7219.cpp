@@ -118,10 +118,12 @@ MAX7219Component::MAX7219Component(SPIComponent *parent, GPIOPin *cs, uint32_t u
     : PollingComponent(update_interval), SPIDevice(parent, cs) {}
 
 float MAX7219Component::get_setup_priority() const { return setup_priority::POST_HARDWARE; }
+uint32_t MAX7219Component::get_loop_idle_time() { return SCHEDULER_DONT_RUN; }
 void MAX7219Component::setup() {
   ESP_LOGCONFIG(TAG, "Setting up MAX7219...");
   this->spi_setup();
   this->buffer_ = new uint8_t[this->num_chips_ * 8];
+  this->sent_ = new uint8_t[this->num_chips_ * 8];
   for (uint8_t i = 0; i < this->num_chips_ * 8; i++)
     this->buffer_[i] = 0;
 
@@ -144,12 +146,21 @@ void MAX7219Component::dump_config() {
 
 void MAX7219Component::display() {
   for (uint8_t i = 0; i < 8; i++) {
+    // each frame writes this digit register of all chips, skip it if none of them changed
+    bool changed = !this->sent_valid_;
+    for (uint8_t j = 0; j < this->num_chips_ && !changed; j++)
+      changed = this->buffer_[j * 8 + i] != this->sent_[j * 8 + i];
+    if (!changed)
+      continue;
+
     this->enable();
     for (uint8_t j = 0; j < this->num_chips_; j++) {
       this->send_byte_(8 - i, this->buffer_[j * 8 + i]);
+      this->sent_[j * 8 + i] = this->buffer_[j * 8 + i];
     }
     this->disable();
   }
+  this->sent_valid_ = true;
 }
 void MAX7219Component::send_byte_(uint8_t a_register, uint8_t data) {
   this->write_byte(a_register);
@@ -165,20 +176,62 @@ bool MAX7219Component::is_device_msb_first() { return true; }
 void MAX7219Component::update() {
   for (uint8_t i = 0; i < this->num_chips_ * 8; i++)
     this->buffer_[i] = 0;
+  this->scroll_requested_ = false;
   if (this->writer_.has_value())
     (*this->writer_)(*this);
+  if (this->scrolling_ && !this->scroll_requested_) {
+    this->scrolling_ = false;
+    this->cancel_interval("scroll");
+  }
+  if (this->scrolling_)
+    this->render_scroll_();
+  this->display();
+}
+uint8_t MAX7219Component::ascii_to_raw_(char c) {
+  uint8_t data = MAX7219_UNKNOWN_CHAR;
+  if (c >= ' ' && c <= '}')
+    data = pgm_read_byte(&MAX7219_ASCII_TO_RAW[c - ' ']);
+
+  if (data == MAX7219_UNKNOWN_CHAR) {
+    ESP_LOGW(TAG, "Encountered character '%c' with no MAX7219 representation while translating string!", c);
+  }
+  return data;
+}
+void MAX7219Component::scroll(const char *str) {
+  this->scroll_requested_ = true;
+  if (this->scrolling_ && this->scroll_text_ == str)
+    return;
+
+  this->scroll_text_ = str;
+  // start with an empty display, the text comes in from the right
+  this->scroll_digits_.assign(this->num_chips_ * 8, 0);
+  for (; *str != '\0'; str++) {
+    if (*str == '.' && this->scroll_digits_.size() > this->num_chips_ * 8u) {
+      this->scroll_digits_.back() |= 0b10000000;
+      continue;
+    }
+    this->scroll_digits_.push_back(ascii_to_raw_(*str));
+  }
+  this->scroll_offset_ = 0;
+  if (!this->scrolling_) {
+    this->scrolling_ = true;
+    this->set_interval("scroll", this->scroll_speed_, [this]() { this->scroll_step_(); });
+  }
+}
+void MAX7219Component::render_scroll_() {
+  const size_t size = this->scroll_digits_.size();
+  for (uint8_t i = 0; i < this->num_chips_ * 8; i++)
+    this->buffer_[i] = this->scroll_digits_[(this->scroll_offset_ + i) % size];
+}
+void MAX7219Component::scroll_step_() {
+  this->scroll_offset_ = (this->scroll_offset_ + 1) % this->scroll_digits_.size();
+  this->render_scroll_();
   this->display();
 }
 uint8_t MAX7219Component::print(uint8_t start_pos, const char *str) {
   uint8_t pos = start_pos;
   for (; *str != '\0'; str++) {
-    uint8_t data = MAX7219_UNKNOWN_CHAR;
-    if (*str >= ' ' && *str <= '}')
-      data = pgm_read_byte(&MAX7219_ASCII_TO_RAW[*str - ' ']);
-
-    if (data == MAX7219_UNKNOWN_CHAR) {
-      ESP_LOGW(TAG, "Encountered character '%c' with no MAX7219 representation while translating string!", *str);
-    }
+    uint8_t data = ascii_to_raw_(*str);
     if (*str == '.') {
       if (pos != start_pos)
         pos--;
@@ -218,6 +271,7 @@ uint8_t MAX7219Component::printf(const char *format, ...) {
 void MAX7219Component::set_writer(max7219_writer_t &&writer) { this->writer_ = writer; }
 void MAX7219Component::set_intensity(uint8_t intensity) { this->intensity_ = intensity; }
 void MAX7219Component::set_num_chips(uint8_t num_chips) { this->num_chips_ = num_chips; }
+void MAX7219Component::set_scroll_speed(uint32_t scroll_speed) { this->scroll_speed_ = scroll_speed; }
 
 #ifdef USE_TIME
 uint8_t MAX7219Component::strftime(uint8_t pos, const char *format, time::ESPTime time) {
@@ -5,6 +5,7 @@
 
 #ifdef USE_MAX7219
 
+#include <vector>
 #include "esphome/helpers.h"
 #include "esphome/spi_component.h"
 #include "esphome/time/rtc_component.h"
@@ -30,6 +31,7 @@ class MAX7219Component : public PollingComponent, public SPIDevice {
   void dump_config() override;
 
   void update() override;
+  uint32_t get_loop_idle_time() override;
 
   float get_setup_priority() const override;
 
@@ -48,6 +50,15 @@ class MAX7219Component : public PollingComponent, public SPIDevice {
   /// Print `str` at position 0.
   uint8_t print(const char *str);
 
+  /** Scroll `str` through the display from right to left, over and over.
+   *
+   * Call this from the writer on each update, scrolling stops on the first update that doesn't call it. The text
+   * is only encoded when it changes, each scroll step just moves the window over the encoded digits.
+   */
+  void scroll(const char *str);
+  /// Set the time in ms between two scroll steps, defaults to 250ms.
+  void set_scroll_speed(uint32_t scroll_speed);
+
 #ifdef USE_TIME
   /// Evaluate the strftime-format and print the result at the given position.
   uint8_t strftime(uint8_t pos, const char *format, time::ESPTime time) __attribute__((format(strftime, 3, 0)));
@@ -60,11 +71,28 @@ class MAX7219Component : public PollingComponent, public SPIDevice {
   void send_byte_(uint8_t a_register, uint8_t data);
   void send_to_all_(uint8_t a_register, uint8_t data);
   bool is_device_msb_first() override;
+  /// Get the segments for the character, warns about characters without representation.
+  static uint8_t ascii_to_raw_(char c);
+  /// Copy the scroll window at the current offset to the buffer.
+  void render_scroll_();
+  void scroll_step_();
 
   uint8_t intensity_{15};  /// Intensity of the display from 0 to 15 (most)
   uint8_t num_chips_{1};
   uint8_t *buffer_;
+  /// What the digit registers currently hold, display() only sends the registers that differ from buffer_.
+  uint8_t *sent_;
+  bool sent_valid_{false};
   optional<max7219_writer_t> writer_{};
+
+  uint32_t scroll_speed_{250};
+  std::string scroll_text_;
+  /// The encoded scroll text, after one display width of blanks.
+  std::vector<uint8_t> scroll_digits_;
+  size_t scroll_offset_{0};
+  bool scrolling_{false};
+  /// Whether scroll() was called during the current update.
+  bool scroll_requested_{false};
 };
 
 }  // namespace display
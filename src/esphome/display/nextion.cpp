@@ -4,6 +4,7 @@
 
 #include "esphome/display/nextion.h"
 #include "esphome/log.h"
+#include "esphome/helpers.h"
 
 ESPHOME_NAMESPACE_BEGIN
 
@@ -11,6 +12,11 @@ namespace display {
 
 static const char *TAG = "display.nextion";
 
+/// How many commands may be sent before their ACK is received, the Nextion's serial buffer holds at least 1kB.
+static const uint8_t NEXTION_MAX_PENDING_ACKS = 8;
+/// Give up on missing ACKs after this many ms.
+static const uint32_t NEXTION_ACK_TIMEOUT = 100;
+
 void Nextion::setup() {
   this->send_command_no_ack("");
   this->send_command_printf("bkcmd=3");
@@ -24,31 +30,69 @@ void Nextion::update() {
 }
 void Nextion::send_command_no_ack(const char *command) {
   // Flush RX...
-  this->loop();
+  this->read_messages_();
 
   this->write_str(command);
   const uint8_t data[3] = {0xFF, 0xFF, 0xFF};
   this->write_array(data, sizeof(data));
 }
+void Nextion::write_command_(const std::string &command) {
+  this->write_array(reinterpret_cast<const uint8_t *>(command.data()), command.size());
+  const uint8_t data[3] = {0xFF, 0xFF, 0xFF};
+  this->write_array(data, sizeof(data));
+}
+void Nextion::send_queue_() {
+  if (this->pending_acks_ != 0 && millis() - this->last_ack_ > NEXTION_ACK_TIMEOUT) {
+    ESP_LOGW(TAG, "Waiting for %u ACKs timed out!", this->pending_acks_);
+    this->pending_acks_ = 0;
+  }
 
-bool Nextion::ack_() {
-  if (!this->wait_for_ack_)
-    return true;
-
-  uint32_t start = millis();
-  while (!this->read_until_ack_()) {
-    if (millis() - start > 100) {
-      ESP_LOGW(TAG, "Waiting for ACK timed out!");
-      return false;
+  size_t sent = 0;
+  while (sent < this->queue_.size()) {
+    if (this->wait_for_ack_) {
+      if (this->pending_acks_ >= NEXTION_MAX_PENDING_ACKS)
+        break;
+      if (this->pending_acks_ == 0)
+        this->last_ack_ = millis();
+      this->pending_acks_++;
     }
+    this->write_command_(this->queue_[sent]);
+    sent++;
+  }
+  this->queue_.erase(this->queue_.begin(), this->queue_.begin() + sent);
+}
+bool Nextion::set_property_(const char *component, const char *property, const char *value) {
+  std::string name = component;
+  name += '.';
+  name += property;
+  Property *cached = nullptr;
+  for (auto &prop : this->properties_) {
+    if (prop.name == name) {
+      cached = &prop;
+      break;
+    }
+  }
+  if (cached != nullptr && cached->value == value)
+    return false;
+
+  if (cached == nullptr) {
+    this->properties_.push_back(Property{name, value});
+  } else {
+    cached->value = value;
   }
+  name += '=';
+  name += value;
+  this->queue_.push_back(std::move(name));
   return true;
 }
 void Nextion::set_component_text(const char *component, const char *text) {
-  this->send_command_printf("%s.txt=\"%s\"", component, text);
+  std::string value = "\"";
+  value += text;
+  value += '"';
+  this->set_property_(component, "txt", value.c_str());
 }
 void Nextion::set_component_value(const char *component, int value) {
-  this->send_command_printf("%s.val=%d", component, value);
+  this->set_property_(component, "val", to_string(value).c_str());
 }
 void Nextion::display_picture(int picture_id, int x_start, int y_start) {
   this->send_command_printf("pic %d %d %d", picture_id, x_start, y_start);
@@ -72,23 +116,22 @@ void Nextion::set_component_coordinates(const char *component, int x, int y) {
 void Nextion::set_component_font(const char *component, uint8_t font_id) {
   this->send_command_printf("%s.font=%d", component, font_id);
 }
-void Nextion::goto_page(const char *page) { this->send_command_printf("page %s", page); }
+void Nextion::goto_page(const char *page) {
+  // the components of the new page start with the values of the HMI file
+  this->properties_.clear();
+  this->send_command_printf("page %s", page);
+}
 bool Nextion::send_command_printf(const char *format, ...) {
-  char buffer[256];
+  ScratchBuffer buffer(256);
   va_list arg;
   va_start(arg, format);
-  int ret = vsnprintf(buffer, sizeof(buffer), format, arg);
+  int ret = vsnprintf(buffer.data(), buffer.size(), format, arg);
   va_end(arg);
   if (ret <= 0) {
     ESP_LOGW(TAG, "Building command for format '%s' failed!", format);
     return false;
   }
-  this->send_command_no_ack(buffer);
-  if (!this->ack_()) {
-    ESP_LOGW(TAG, "Sending command '%s' failed because no ACK was received", buffer);
-    return false;
-  }
-
+  this->queue_.emplace_back(buffer.data());
   return true;
 }
 void Nextion::hide_component(const char *component) { this->send_command_printf("vis %s,0", component); }
@@ -113,7 +156,7 @@ void Nextion::circle(int center_x, int center_y, int radius, const char *color)
 void Nextion::filled_circle(int center_x, int center_y, int radius, const char *color) {
   this->send_command_printf("cirs %d,%d,%d,%s", center_x, center_y, radius, color);
 }
-bool Nextion::read_until_ack_() {
+void Nextion::read_messages_() {
   while (this->available() >= 4) {
     // flush preceding filler bytes
     uint8_t temp;
@@ -152,10 +195,16 @@ bool Nextion::read_until_ack_() {
 
     data_length -= 3;  // remove filler bytes
 
+    // with bkcmd=3, each command is answered with an ACK or one of the errors below
+    if (event <= 0x23 && this->pending_acks_ > 0) {
+      this->pending_acks_--;
+      this->last_ack_ = millis();
+    }
+
     bool invalid_data_length = false;
     switch (event) {
       case 0x01:  // successful execution of instruction (ACK)
-        return true;
+        break;
       case 0x00:  // invalid instruction
         ESP_LOGW(TAG, "Nextion reported invalid instruction!");
         break;
@@ -231,9 +280,12 @@ bool Nextion::read_until_ack_() {
       case 0x66:  // sendme page id
       case 0x70:  // string variable data return
       case 0x71:  // numeric variable data return
+      case 0x88:  // system successful start up
+        // the Nextion restarted, it shows the values of the HMI file again
+        this->properties_.clear();
+        break;
       case 0x86:  // device automatically enters into sleep mode
       case 0x87:  // device automatically wakes up
-      case 0x88:  // system successful start up
       case 0x89:  // start SD card upgrade
       case 0xFD:  // data transparent transmit finished
       case 0xFE:  // data transparent transmit ready
@@ -246,13 +298,10 @@ bool Nextion::read_until_ack_() {
       ESP_LOGW(TAG, "Invalid data length from nextion!");
     }
   }
-
-  return false;
 }
 void Nextion::loop() {
-  while (this->available() >= 4) {
-    this->read_until_ack_();
-  }
+  this->read_messages_();
+  this->send_queue_();
 }
 #ifdef USE_TIME
 void Nextion::set_nextion_rtc_time(time::ESPTime time) {
@@ -279,11 +328,11 @@ void Nextion::set_writer(const nextion_writer_t &writer) { this->writer_ = write
 void Nextion::set_component_text_printf(const char *component, const char *format, ...) {
   va_list arg;
   va_start(arg, format);
-  char buffer[256];
-  int ret = vsnprintf(buffer, sizeof(buffer), format, arg);
+  ScratchBuffer buffer(256);
+  int ret = vsnprintf(buffer.data(), buffer.size(), format, arg);
   va_end(arg);
   if (ret > 0)
-    this->set_component_text(component, buffer);
+    this->set_component_text(component, buffer.data());
 }
 void Nextion::set_wait_for_ack(bool wait_for_ack) { this->wait_for_ack_ = wait_for_ack; }
 
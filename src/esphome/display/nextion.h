@@ -23,6 +23,8 @@ class Nextion : public PollingComponent, public UARTDevice {
  public:
   /**
    * Set the text of a component to a static string.
+   *
+   * Skipped if the component already shows this text, the values sent are remembered until the page changes.
    * @param component The component name.
    * @param text The static text to set.
    */
@@ -35,7 +37,7 @@ class Nextion : public PollingComponent, public UARTDevice {
    */
   void set_component_text_printf(const char *component, const char *format, ...) __attribute__((format(printf, 3, 4)));
   /**
-   * Set the integer value of a component
+   * Set the integer value of a component, skipped if it's unchanged like set_component_text().
    * @param component The component name.
    * @param value The value to set.
    */
@@ -196,27 +198,47 @@ class Nextion : public PollingComponent, public UARTDevice {
   void set_writer(const nextion_writer_t &writer);
 
   /**
-   * Manually send a raw command to the display and don't wait for an acknowledgement packet.
+   * Manually send a raw command to the display right away, bypassing the queue and without acknowledgement packet.
    * @param command The command to write, for example "vis b0,0".
    */
   void send_command_no_ack(const char *command);
   /**
    * Manually send a raw formatted command to the display.
+   *
+   * The command is queued and sent from loop(), up to a few commands are sent without waiting for the
+   * acknowledgement packets of the previous ones, the Nextion executes them in order.
    * @param format The printf-style command format, like "vis %s,0"
    * @param ... The format arguments
-   * @return Whether the send was successful.
+   * @return Whether the command could be built and queued.
    */
   bool send_command_printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
 
   void set_wait_for_ack(bool wait_for_ack);
 
  protected:
-  bool ack_();
-  bool read_until_ack_();
+  struct Property {
+    /// The component and property, like "t0.txt".
+    std::string name;
+    std::string value;
+  };
+
+  /// Queue "component.property=value" unless that's the value last sent, returns whether it was queued.
+  bool set_property_(const char *component, const char *property, const char *value);
+  void write_command_(const std::string &command);
+  /// Send queued commands while fewer than NEXTION_MAX_PENDING_ACKS are unacknowledged.
+  void send_queue_();
+  /// Handle all complete messages from the Nextion.
+  void read_messages_();
 
   std::vector<NextionTouchComponent *> touch_;
   optional<nextion_writer_t> writer_;
   bool wait_for_ack_{true};
+  std::vector<std::string> queue_;
+  /// The number of sent commands whose acknowledgement (or error) hasn't been received yet.
+  uint8_t pending_acks_{0};
+  uint32_t last_ack_{0};
+  /// The values last sent for each property, cleared when the page changes.
+  std::vector<Property> properties_;
 };
 
 class NextionTouchComponent : public binary_sensor::BinarySensor {
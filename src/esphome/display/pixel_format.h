@@ -0,0 +1,162 @@
+#ifndef ESPHOME_DISPLAY_PIXEL_FORMAT_H
+#define ESPHOME_DISPLAY_PIXEL_FORMAT_H
+
+#include "esphome/defines.h"
+
+#ifdef USE_DISPLAY
+
+#include <algorithm>
+#include <cstring>
+#include "esphome/display/display.h"
+
+ESPHOME_NAMESPACE_BEGIN
+
+/// Set in colors created with color_rgb(), all other values are COLOR_OFF (0) or ON.
+static const int COLOR_RGB_FLAG = 0x01000000;
+
+/** Create a color for displays with grayscale or color pixel formats.
+ *
+ * Displays with fewer colors use the closest one they have, 1 bit per pixel displays turn pixels with a
+ * luminance of at least 50% on. COLOR_ON and COLOR_OFF stay white and black.
+ */
+inline int color_rgb(uint8_t red, uint8_t green, uint8_t blue) {
+  return COLOR_RGB_FLAG | (uint32_t(red) << 16) | (uint32_t(green) << 8) | blue;
+}
+/// Create a gray color from 0 (black) to 255 (white), see color_rgb().
+inline int color_gray(uint8_t level) { return color_rgb(level, level, level); }
+
+namespace display {
+
+/// Get the 8 bit per channel RGB value of a color passed to the drawing methods.
+inline uint32_t color_to_rgb888(int color) {
+  if (color & COLOR_RGB_FLAG)
+    return color & 0xFFFFFF;
+  return color ? 0xFFFFFF : 0x000000;
+}
+/// Get the luminance of a color passed to the drawing methods from 0 to 255.
+inline uint8_t color_to_luminance(int color) {
+  const uint32_t rgb = color_to_rgb888(color);
+  return (((rgb >> 16) & 0xFF) * 77 + ((rgb >> 8) & 0xFF) * 150 + (rgb & 0xFF) * 29) >> 8;
+}
+
+/* Pixel formats for PackedDisplayBuffer. Rows are stored one after another, each padded to whole bytes. Each
+ * format converts a color to its native pixel value once per drawing call with to_native(), the kernels that
+ * write the pixels into a row are then specialized for the format at compile time.
+ */
+
+/// 1 bit per pixel, 8 pixels per byte with the leftmost in the MSB, 1 is on.
+struct PixelFormat1BPP {
+  using native_t = uint8_t;
+  static uint32_t row_stride(int width) { return (width + 7u) / 8u; }
+  static native_t to_native(int color) { return color_to_luminance(color) >= 128 ? 1 : 0; }
+  static void set(uint8_t *row, int x, native_t value) {
+    if (value)
+      row[x / 8] |= 0x80 >> (x & 0x07);
+    else
+      row[x / 8] &= ~(0x80 >> (x & 0x07));
+  }
+  static void fill(uint8_t *row, int x, int width, native_t value) {
+    const int x_end = x + width;
+    while (x < x_end) {
+      const int bit = x & 0x07;
+      const int count = std::min(8 - bit, x_end - x);
+      if (count == 8) {
+        // whole bytes in the middle of the span
+        const int bytes = (x_end - x) / 8;
+        memset(row + x / 8, value ? 0xFF : 0x00, bytes);
+        x += bytes * 8;
+        continue;
+      }
+      const uint8_t mask = (0xFF >> bit) & ~(0xFF >> (bit + count));
+      if (value)
+        row[x / 8] |= mask;
+      else
+        row[x / 8] &= ~mask;
+      x += count;
+    }
+  }
+};
+
+/// 4 bit grayscale, 2 pixels per byte with the leftmost in the high nibble, 0xF is white.
+struct PixelFormatGray4 {
+  using native_t = uint8_t;
+  static uint32_t row_stride(int width) { return (width + 1u) / 2u; }
+  static native_t to_native(int color) { return color_to_luminance(color) >> 4; }
+  static void set(uint8_t *row, int x, native_t value) {
+    uint8_t *data = row + x / 2;
+    if (x & 1)
+      *data = (*data & 0xF0) | value;
+    else
+      *data = (*data & 0x0F) | (value << 4);
+  }
+  static void fill(uint8_t *row, int x, int width, native_t value) {
+    const int x_end = x + width;
+    if (x < x_end && (x & 1))
+      set(row, x++, value);
+    if (x < x_end && (x_end & 1))
+      set(row, x_end - 1, value);
+    if (x < x_end - 1)
+      memset(row + x / 2, value | (value << 4), (x_end - x) / 2);
+  }
+};
+
+/// 16 bit color, 5 bits red, 6 bits green and 5 bits blue, big endian like most TFT controllers expect it.
+struct PixelFormatRGB565 {
+  using native_t = uint16_t;
+  static uint32_t row_stride(int width) { return width * 2u; }
+  static native_t to_native(int color) {
+    const uint32_t rgb = color_to_rgb888(color);
+    return ((rgb >> 8) & 0xF800) | ((rgb >> 5) & 0x07E0) | ((rgb >> 3) & 0x001F);
+  }
+  static void set(uint8_t *row, int x, native_t value) {
+    row[x * 2] = value >> 8;
+    row[x * 2 + 1] = value;
+  }
+  static void fill(uint8_t *row, int x, int width, native_t value) {
+    uint8_t *data = row + x * 2;
+    for (int i = 0; i < width; i++) {
+      *data++ = value >> 8;
+      *data++ = value;
+    }
+  }
+};
+
+/** A display buffer in one of the pixel formats above, for drivers that send the buffer to the display as is.
+ *
+ * The buffer is sized for the format, so a grayscale or color panel only takes the memory its depth needs.
+ * All drawing methods of DisplayBuffer work, pixels and spans (used by filled shapes, fonts and images) are
+ * written by the kernels of the format.
+ */
+template<typename Format> class PackedDisplayBuffer : public DisplayBuffer {
+ public:
+  void fill(int color) override {
+    const auto value = Format::to_native(color);
+    const int width = this->get_width_internal();
+    for (int y = 0; y < this->get_height_internal(); y++)
+      Format::fill(this->row_(y), 0, width, value);
+  }
+
+ protected:
+  /// Allocate the buffer, call this from the setup() of the driver.
+  void init_packed_buffer_() {
+    this->init_internal_(Format::row_stride(this->get_width_internal()) * this->get_height_internal());
+  }
+  uint8_t *row_(int y) { return this->buffer_ + y * Format::row_stride(this->get_width_internal()); }
+
+  void draw_absolute_pixel_internal(int x, int y, int color) override {
+    if (x < 0 || y < 0 || x >= this->get_width_internal() || y >= this->get_height_internal())
+      return;
+    Format::set(this->row_(y), x, Format::to_native(color));
+  }
+  void fill_span_internal(int x, int y, int width, int color) override {
+    Format::fill(this->row_(y), x, width, Format::to_native(color));
+  }
+};
+
+}  // namespace display
+
+ESPHOME_NAMESPACE_END
+
+#endif  // USE_DISPLAY
+
+#endif  // ESPHOME_DISPLAY_PIXEL_FORMAT_H
@@ -3,6 +3,9 @@
 #ifdef USE_SSD1306
 
 #include "esphome/display/ssd1306.h"
+
+#include <pgmspace.h>
+
 #include "esphome/log.h"
 
 ESPHOME_NAMESPACE_BEGIN
@@ -33,8 +36,12 @@ static const uint8_t SSD1306_COMMAND_PAGE_ADDRESS = 0x22;
 
 static const uint8_t SSD1306_NORMAL_DISPLAY = 0xA6;
 
+/// Dirty tracking granularity, 16 columns of one page. Also the I2C transfer size.
+static const uint8_t SSD1306_BAND_LENGTH = 16;
+
 void SSD1306::setup() {
   this->init_internal_(this->get_buffer_length_());
+  this->init_dirty_bands_(SSD1306_BAND_LENGTH);
 
   this->command(SSD1306_COMMAND_DISPLAY_OFF);
   this->command(SSD1306_COMMAND_SET_DISPLAY_CLOCK_DIV);
@@ -114,38 +121,74 @@ void SSD1306::setup() {
   this->command(SSD1306_COMMAND_DISPLAY_ON);
 }
 void SSD1306::display() {
-  if (this->is_sh1106_()) {
-    this->write_display_data();
+  if (!this->update_dirty_bands_())
+    // nothing changed since the last transfer
+    return;
+
+  const uint8_t width = this->get_width_internal();
+  const uint8_t pages = this->get_height_internal() / 8;
+  const uint8_t bands_per_page = width / SSD1306_BAND_LENGTH;
+  if (this->prefer_single_transfer_() && !this->is_sh1106_()) {
+    // all columns from the first to the last changed page are contiguous in the buffer
+    int first_page = -1;
+    int last_page = -1;
+    for (uint8_t band = 0; band < pages * bands_per_page; band++) {
+      if (!this->is_band_dirty_(band))
+        continue;
+      if (first_page == -1)
+        first_page = band / bands_per_page;
+      last_page = band / bands_per_page;
+    }
+    this->set_window_(first_page, last_page, 0, width - 1);
+    this->write_display_data(first_page * width, (last_page - first_page + 1) * width);
     return;
   }
 
-  this->command(SSD1306_COMMAND_COLUMN_ADDRESS);
-  switch (this->model_) {
-    case SSD1306_MODEL_64_48:
-      this->command(0x20);
-      this->command(0x20 + this->get_width_internal() - 1);
-      break;
-    default:
-      this->command(0);  // Page start address, 0
-      this->command(this->get_width_internal() - 1);
-      break;
+  for (uint8_t page = 0; page < pages; page++) {
+    // send the columns from the first to the last changed band of this page
+    int first = -1;
+    int last = -1;
+    for (uint8_t band = 0; band < bands_per_page; band++) {
+      if (!this->is_band_dirty_(page * bands_per_page + band))
+        continue;
+      if (first == -1)
+        first = band;
+      last = band;
+    }
+    if (first == -1)
+      continue;
+
+    const uint8_t column_start = first * SSD1306_BAND_LENGTH;
+    const uint8_t column_end = (last + 1) * SSD1306_BAND_LENGTH - 1;
+    this->set_window_(page, page, column_start, column_end);
+    this->write_display_data(page * width + column_start, column_end - column_start + 1);
+  }
+}
+void SSD1306::set_window_(uint8_t page_start, uint8_t page_end, uint8_t column_start, uint8_t column_end) {
+  if (this->is_sh1106_()) {
+    // SH1106 only has page addressing, its RAM is 132 columns wide with the panel starting at column 2
+    const uint8_t column = column_start + 2;
+    this->command(0xB0 + page_start);
+    this->command(column & 0x0F);
+    this->command(0x10 | (column >> 4));
+    return;
   }
 
+  const uint8_t offset = this->model_ == SSD1306_MODEL_64_48 ? 0x20 : 0x00;
+  this->command(SSD1306_COMMAND_COLUMN_ADDRESS);
+  this->command(offset + column_start);
+  this->command(offset + column_end);
   this->command(SSD1306_COMMAND_PAGE_ADDRESS);
-  // Page start address, 0
-  this->command(0);
-  // Page end address:
-  this->command((this->get_height_internal() / 8) - 1);
-
-  this->write_display_data();
+  this->command(page_start);
+  this->command(page_end);
 }
+bool SSD1306::prefer_single_transfer_() { return false; }
 bool SSD1306::is_sh1106_() const {
   return this->model_ == SH1106_MODEL_96_16 || this->model_ == SH1106_MODEL_128_32 ||
          this->model_ == SH1106_MODEL_128_64;
 }
 void SSD1306::update() {
-  this->do_update_();
-  this->display();
+  this->render_([this]() { this->display(); });
 }
 void SSD1306::set_model(SSD1306Model model) { this->model_ = model; }
 void SSD1306::set_reset_pin(const GPIOOutputPin &reset_pin) { this->reset_pin_ = reset_pin.copy(); }
@@ -202,7 +245,49 @@ void HOT SSD1306::draw_absolute_pixel_internal(int x, int y, int color) {
     this->buffer_[pos] &= ~(1 << subpos);
   }
 }
+void HOT SSD1306::fill_span_internal(int x, int y, int width, int color) {
+  // one bit in each of the column bytes of the page
+  uint8_t *data = this->buffer_ + x + (y / 8) * this->get_width_internal();
+  const uint8_t mask = 1 << (y & 0x07);
+  if (color) {
+    for (int i = 0; i < width; i++)
+      data[i] |= mask;
+  } else {
+    for (int i = 0; i < width; i++)
+      data[i] &= ~mask;
+  }
+}
+void HOT SSD1306::blit_1bpp_internal(int x, int y, const uint8_t *data, int width, int height, int color,
+                                     bool opaque) {
+  const int display_width = this->get_width_internal();
+  if (x < 0 || y < 0 || x + width > display_width || y + height > this->get_height_internal()) {
+    // partially outside, let the per-pixel path clip
+    DisplayBuffer::blit_1bpp_internal(x, y, data, width, height, color, opaque);
+    return;
+  }
+
+  const uint32_t stride = (width + 7u) / 8u;
+  for (int row = 0; row < height; row++) {
+    const uint8_t *row_data = data + row * stride;
+    uint8_t *dst = this->buffer_ + x + ((y + row) / 8) * display_width;
+    const uint8_t mask = 1 << ((y + row) & 0x07);
+    uint8_t bits = 0;
+    for (int col = 0; col < width; col++) {
+      if ((col & 7) == 0)
+        bits = pgm_read_byte(row_data + col / 8);
+      if (bits & (0x80 >> (col & 7))) {
+        if (color)
+          dst[col] |= mask;
+        else
+          dst[col] &= ~mask;
+      } else if (opaque) {
+        dst[col] &= ~mask;
+      }
+    }
+  }
+}
 float SSD1306::get_setup_priority() const { return setup_priority::POST_HARDWARE; }
+uint32_t SSD1306::get_loop_idle_time() { return SCHEDULER_DONT_RUN; }
 void SSD1306::fill(int color) {
   uint8_t fill = color ? 0xFF : 0x00;
   for (uint32_t i = 0; i < this->get_buffer_length_(); i++)
@@ -262,33 +347,35 @@ void SPISSD1306::dump_config() {
   ESP_LOGCONFIG(TAG, "  External VCC: %s", YESNO(this->external_vcc_));
   LOG_UPDATE_INTERVAL(this);
 }
+void SPISSD1306::update() {
+  // don't draw into the buffer while the last frame is still being sent from it
+  this->wait_transfer();
+  SSD1306::update();
+}
 void SPISSD1306::command(uint8_t value) {
-  this->dc_pin_->digital_write(false);
+  // enable first, it waits for a running data transfer that still needs DC high
   this->enable();
+  this->dc_pin_->digital_write(false);
   this->write_byte(value);
   this->disable();
 }
-void HOT SPISSD1306::write_display_data() {
+void HOT SPISSD1306::write_display_data(uint32_t start, uint32_t length) {
   if (this->is_sh1106_()) {
-    for (uint8_t y = 0; y < this->get_height_internal() / 8; y++) {
-      this->command(0xB0 + y);
-      this->command(0x02);
-      this->command(0x10);
+    for (uint32_t i = start; i < start + length; i++) {
+      this->enable();
       this->dc_pin_->digital_write(true);
-      for (uint8_t x = 0; x < this->get_width_internal(); x++) {
-        this->enable();
-        this->write_byte(this->buffer_[x + y * this->get_width_internal()]);
-        this->disable();
-        feed_wdt();
-      }
+      this->write_byte(this->buffer_[i]);
+      this->disable();
+      feed_wdt();
     }
   } else {
-    this->dc_pin_->digital_write(true);
     this->enable();
-    this->write_array(this->buffer_, this->get_buffer_length_());
-    this->disable();
+    this->dc_pin_->digital_write(true);
+    // sent in the background, disables the chip when done
+    this->write_array_async(this->buffer_ + start, length, nullptr);
   }
 }
+bool SPISSD1306::prefer_single_transfer_() { return true; }
 SPISSD1306::SPISSD1306(SPIComponent *parent, GPIOPin *cs, GPIOPin *dc_pin, uint32_t update_interval)
     : SSD1306(update_interval), SPIDevice(parent, cs), dc_pin_(dc_pin) {}
 bool SPISSD1306::is_device_high_speed() { return true; }
@@ -321,29 +408,9 @@ void I2CSSD1306::dump_config() {
   }
 }
 void I2CSSD1306::command(uint8_t value) { this->write_byte(0x00, value); }
-void HOT I2CSSD1306::write_display_data() {
-  if (this->is_sh1106_()) {
-    uint32_t i = 0;
-    for (uint8_t page = 0; page < this->get_height_internal() / 8; page++) {
-      this->command(0xB0 + page);  // row
-      this->command(0x02);         // lower column
-      this->command(0x10);         // higher column
-
-      for (uint8_t x = 0; x < this->get_width_internal() / 16; x++) {
-        uint8_t data[16];
-        for (uint8_t &j : data)
-          j = this->buffer_[i++];
-        this->write_bytes(0x40, data, sizeof(data));
-      }
-    }
-  } else {
-    for (uint32_t i = 0; i < this->get_buffer_length_();) {
-      uint8_t data[16];
-      for (uint8_t &j : data)
-        j = this->buffer_[i++];
-      this->write_bytes(0x40, data, sizeof(data));
-    }
-  }
+void HOT I2CSSD1306::write_display_data(uint32_t start, uint32_t length) {
+  for (uint32_t i = start; i < start + length; i += SSD1306_BAND_LENGTH)
+    this->write_bytes(0x40, this->buffer_ + i, SSD1306_BAND_LENGTH);
 }
 I2CSSD1306::I2CSSD1306(I2CComponent *parent, uint32_t update_interval)
     : I2CDevice(parent, 0x3C), SSD1306(update_interval) {}
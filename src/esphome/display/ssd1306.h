@@ -33,6 +33,7 @@ class SSD1306 : public PollingComponent, public DisplayBuffer {
   void display();
 
   void update() override;
+  uint32_t get_loop_idle_time() override;
 
   void set_model(SSD1306Model model);
   void set_reset_pin(const GPIOOutputPin &reset_pin);
@@ -43,12 +44,24 @@ class SSD1306 : public PollingComponent, public DisplayBuffer {
 
  protected:
   virtual void command(uint8_t value) = 0;
-  virtual void write_display_data() = 0;
+  /// Write length bytes starting at start in the buffer to the window set with set_window_().
+  virtual void write_display_data(uint32_t start, uint32_t length) = 0;
   void init_reset_();
 
+  /// Set the display RAM window to the given pages and columns (inclusive). SH1106 only uses page_start.
+  void set_window_(uint8_t page_start, uint8_t page_end, uint8_t column_start, uint8_t column_end);
+
+  /** Whether to send everything from the first to the last changed page at once instead of only the changed
+   * columns of each page. Cheaper for fast buses, where the commands for each window cost more than the
+   * extra bytes.
+   */
+  virtual bool prefer_single_transfer_();
+
   bool is_sh1106_() const;
 
   void draw_absolute_pixel_internal(int x, int y, int color) override;
+  void fill_span_internal(int x, int y, int width, int color) override;
+  void blit_1bpp_internal(int x, int y, const uint8_t *data, int width, int height, int color, bool opaque) override;
 
   int get_height_internal() override;
   int get_width_internal() override;
@@ -69,10 +82,13 @@ class SPISSD1306 : public SSD1306, public SPIDevice {
 
   void dump_config() override;
 
+  void update() override;
+
  protected:
   void command(uint8_t value) override;
 
-  void write_display_data() override;
+  void write_display_data(uint32_t start, uint32_t length) override;
+  bool prefer_single_transfer_() override;
   bool is_device_msb_first() override;
   bool is_device_high_speed() override;
 
@@ -89,7 +105,7 @@ class I2CSSD1306 : public SSD1306, public I2CDevice {
 
  protected:
   void command(uint8_t value) override;
-  void write_display_data() override;
+  void write_display_data(uint32_t start, uint32_t length) override;
 
   enum ErrorCode { NONE = 0, COMMUNICATION_FAILED } error_code_{NONE};
 };
@@ -3,6 +3,10 @@
 #ifdef USE_WAVESHARE_EPAPER
 
 #include "esphome/display/waveshare_epaper.h"
+
+#include <algorithm>
+#include <pgmspace.h>
+
 #include "esphome/log.h"
 
 ESPHOME_NAMESPACE_BEGIN
@@ -33,6 +37,12 @@ static const uint8_t WAVESHARE_EPAPER_COMMAND_SET_RAM_X_ADDRESS_COUNTER = 0x4E;
 static const uint8_t WAVESHARE_EPAPER_COMMAND_SET_RAM_Y_ADDRESS_COUNTER = 0x4F;
 static const uint8_t WAVESHARE_EPAPER_COMMAND_TERMINATE_FRAME_READ_WRITE = 0xFF;
 
+/// Give up waiting for a refresh to finish after this many ms, full refreshes of the large displays take seconds.
+static const uint32_t WAVESHARE_EPAPER_BUSY_TIMEOUT = 10000;
+
+/// Buffer bytes converted and sent per transfer by the 7.5in display, each becomes 4 bytes on the wire.
+static const uint32_t WAVESHARE_EPAPER_7P5_CHUNK_LENGTH = 512;
+
 // not in .text section since only 30 bytes
 static const uint8_t FULL_UPDATE_LUT[30] = {0x02, 0x02, 0x01, 0x11, 0x12, 0x12, 0x22, 0x22, 0x66, 0x69,
                                             0x69, 0x59, 0x58, 0x99, 0x99, 0x88, 0x00, 0x00, 0x00, 0x00,
@@ -90,11 +100,36 @@ bool WaveshareEPaper::wait_until_idle_() {
   }
   return true;
 }
+bool WaveshareEPaper::is_busy_() { return this->busy_pin_ != nullptr && this->busy_pin_->digital_read(); }
 void WaveshareEPaper::set_reset_pin(const GPIOOutputPin &reset) { this->reset_pin_ = reset.copy(); }
 void WaveshareEPaper::set_busy_pin(const GPIOInputPin &busy) { this->busy_pin_ = busy.copy(); }
 void WaveshareEPaper::update() {
-  this->do_update_();
-  this->display();
+  if (this->is_busy_()) {
+    // the last refresh is still running, poll for its end in loop() instead of blocking
+    if (!this->update_pending_) {
+      this->update_pending_ = true;
+      this->pending_since_ = millis();
+      this->enable_loop();
+    }
+    return;
+  }
+  this->update_pending_ = false;
+  this->render_([this]() { this->display(); });
+}
+void WaveshareEPaper::loop() {
+  if (!this->update_pending_) {
+    this->disable_loop();
+    return;
+  }
+  if (this->is_busy_()) {
+    if (millis() - this->pending_since_ < WAVESHARE_EPAPER_BUSY_TIMEOUT)
+      return;
+    ESP_LOGE(TAG, "Timeout while displaying image!");
+    this->status_set_warning();
+  }
+  this->update_pending_ = false;
+  this->disable_loop();
+  this->render_([this]() { this->display(); });
 }
 void WaveshareEPaper::fill(int color) {
   // flip logic
@@ -114,18 +149,69 @@ void HOT WaveshareEPaper::draw_absolute_pixel_internal(int x, int y, int color)
   else
     this->buffer_[pos] &= ~(0x80 >> subpos);
 }
+/// Draw the pixels in on with color and the pixels in off with COLOR_OFF into one byte of the buffer.
+static inline void epaper_apply_byte(uint8_t *data, uint8_t on, uint8_t off, int color) {
+  // flip logic
+  if (color)
+    *data &= ~on;
+  else
+    *data |= on;
+  *data |= off;
+}
+void HOT WaveshareEPaper::fill_span_internal(int x, int y, int width, int color) {
+  // 8 pixels per byte, MSB first
+  uint8_t *row = this->buffer_ + (y * this->get_width_internal()) / 8u;
+  const int x_end = x + width;
+  while (x < x_end) {
+    const int bit = x & 0x07;
+    const int count = std::min(8 - bit, x_end - x);
+    const uint8_t mask = (0xFF >> bit) & ~(0xFF >> (bit + count));
+    epaper_apply_byte(row + x / 8, mask, 0, color);
+    x += count;
+  }
+}
+void HOT WaveshareEPaper::blit_1bpp_internal(int x, int y, const uint8_t *data, int width, int height, int color,
+                                             bool opaque) {
+  const int display_width = this->get_width_internal();
+  if (x < 0 || y < 0 || x + width > display_width || y + height > this->get_height_internal()) {
+    // partially outside, let the per-pixel path clip
+    DisplayBuffer::blit_1bpp_internal(x, y, data, width, height, color, opaque);
+    return;
+  }
+
+  // bitmap rows have the same bit order as the buffer, only the alignment differs
+  const uint32_t stride = (width + 7u) / 8u;
+  const uint8_t shift = x & 0x07;
+  for (int row = 0; row < height; row++) {
+    const uint8_t *row_data = data + row * stride;
+    uint8_t *dst = this->buffer_ + ((y + row) * display_width + x) / 8u;
+    for (uint32_t i = 0; i < stride; i++) {
+      const int remaining = width - int(i) * 8;
+      const uint8_t valid = remaining >= 8 ? 0xFF : uint8_t(0xFF << (8 - remaining));
+      const uint8_t on = pgm_read_byte(row_data + i) & valid;
+      const uint8_t off = opaque ? (~on & valid) : 0;
+      epaper_apply_byte(dst + i, on >> shift, off >> shift, color);
+      const uint8_t on_next = on << (8 - shift);
+      const uint8_t off_next = off << (8 - shift);
+      // spills into the next byte, which is only inside the row if there are pixels in it
+      if (shift != 0 && (on_next | off_next) != 0)
+        epaper_apply_byte(dst + i + 1, on_next, off_next, color);
+    }
+  }
+}
 uint32_t WaveshareEPaper::get_buffer_length_() { return this->get_width_internal() * this->get_height_internal() / 8u; }
 WaveshareEPaper::WaveshareEPaper(SPIComponent *parent, GPIOPin *cs, GPIOPin *dc_pin, uint32_t update_interval)
     : PollingComponent(update_interval), SPIDevice(parent, cs), dc_pin_(dc_pin) {}
 bool WaveshareEPaper::is_device_high_speed() { return true; }
+// enable first, it waits for a running data transfer that still needs DC high
 void WaveshareEPaper::start_command_() {
-  this->dc_pin_->digital_write(false);
   this->enable();
+  this->dc_pin_->digital_write(false);
 }
 void WaveshareEPaper::end_command_() { this->disable(); }
 void WaveshareEPaper::start_data_() {
-  this->dc_pin_->digital_write(true);
   this->enable();
+  this->dc_pin_->digital_write(true);
 }
 void WaveshareEPaper::end_data_() { this->disable(); }
 
@@ -157,6 +243,10 @@ void WaveshareEPaperTypeA::setup() {
 
   this->command(WAVESHARE_EPAPER_COMMAND_DATA_ENTRY_MODE_SETTING);
   this->data(0x03);  // from top left to bottom right
+
+  // track changes in bands of 8 rows
+  this->init_dirty_bands_(this->get_width_internal());
+  this->last_dirty_end_ = this->get_height_internal() - 1;
 }
 void WaveshareEPaperTypeA::dump_config() {
   LOG_DISPLAY("", "Waveshare E-Paper", this);
@@ -178,11 +268,30 @@ void WaveshareEPaperTypeA::dump_config() {
   LOG_UPDATE_INTERVAL(this);
 }
 void HOT WaveshareEPaperTypeA::display() {
-  if (!this->wait_until_idle_()) {
-    this->status_set_warning();
+  // update() only gets here once the last refresh is done
+  if (!this->update_dirty_bands_()) {
+    // nothing changed since the last refresh
+    this->status_clear_warning();
     return;
   }
 
+  // find the rows that changed, each band is 8 rows
+  const uint16_t height = this->get_height_internal();
+  uint16_t dirty_start = height;
+  uint16_t dirty_end = 0;
+  for (uint16_t y = 0; y < height; y += 8) {
+    if (!this->is_band_dirty_(y / 8))
+      continue;
+    dirty_start = std::min(dirty_start, y);
+    dirty_end = std::min(uint16_t(y + 7), uint16_t(height - 1));
+  }
+  // The controller alternates between two RAM banks, so the bank written now last received the frame
+  // from two transfers ago. Also rewrite the rows that changed in the previous transfer to bring it up to date.
+  const uint16_t y_start = std::min(dirty_start, this->last_dirty_start_);
+  const uint16_t y_end = std::max(dirty_end, this->last_dirty_end_);
+  this->last_dirty_start_ = dirty_start;
+  this->last_dirty_end_ = dirty_end;
+
   if (this->full_update_every_ >= 2) {
     bool prev_full_update = this->at_update_ == 1;
     bool full_update = this->at_update_ == 0;
@@ -192,30 +301,26 @@ void HOT WaveshareEPaperTypeA::display() {
     this->at_update_ = (this->at_update_ + 1) % this->full_update_every_;
   }
 
-  // Set x & y regions we want to write to (full)
+  // Set x & y regions we want to write to (full width, changed rows)
   this->command(WAVESHARE_EPAPER_COMMAND_SET_RAM_X_ADDRESS_START_END_POSITION);
   this->data(0x00);
   this->data((this->get_width_internal() - 1) >> 3);
   this->command(WAVESHARE_EPAPER_COMMAND_SET_RAM_Y_ADDRESS_START_END_POSITION);
-  this->data(0x00);
-  this->data(0x00);
-  this->data(this->get_height_internal() - 1);
-  this->data((this->get_height_internal() - 1) >> 8);
+  this->data(y_start);
+  this->data(y_start >> 8);
+  this->data(y_end);
+  this->data(y_end >> 8);
 
   this->command(WAVESHARE_EPAPER_COMMAND_SET_RAM_X_ADDRESS_COUNTER);
   this->data(0x00);
   this->command(WAVESHARE_EPAPER_COMMAND_SET_RAM_Y_ADDRESS_COUNTER);
-  this->data(0x00);
-  this->data(0x00);
-
-  if (!this->wait_until_idle_()) {
-    this->status_set_warning();
-    return;
-  }
+  this->data(y_start);
+  this->data(y_start >> 8);
 
+  const uint32_t row_length = this->get_width_internal() / 8u;
   this->command(WAVESHARE_EPAPER_COMMAND_WRITE_RAM);
   this->start_data_();
-  this->write_array(this->buffer_, this->get_buffer_length_());
+  this->write_array(this->buffer_ + y_start * row_length, (y_end - y_start + 1) * row_length);
   this->end_data_();
 
   this->command(WAVESHARE_EPAPER_COMMAND_DISPLAY_UPDATE_CONTROL_2);
@@ -586,35 +691,58 @@ void WaveshareEPaper7P5In::setup() {
   this->command(0xE5);
   this->data(0x03);
 }
+void WaveshareEPaper7P5In::update() {
+  if (this->sending_) {
+    ESP_LOGW(TAG, "Last frame is still being sent, skipping update.");
+    return;
+  }
+  WaveshareEPaper::update();
+}
 void HOT WaveshareEPaper7P5In::display() {
-  this->command(WAVESHARE_EPAPER_B_COMMAND_DATA_START_TRANSMISSION_1);
+  if (this->transfer_buffers_[0] == nullptr) {
+    this->transfer_buffers_[0] = new uint8_t[WAVESHARE_EPAPER_7P5_CHUNK_LENGTH * 4];
+    this->transfer_buffers_[1] = new uint8_t[WAVESHARE_EPAPER_7P5_CHUNK_LENGTH * 4];
+  }
 
-  this->start_data_();
-  for (size_t i = 0; i < this->get_buffer_length_(); i++) {
-    uint8_t temp1 = this->buffer_[i];
-    for (uint8_t j = 0; j < 8; j++) {
-      uint8_t temp2;
-      if (temp1 & 0x80)
-        temp2 = 0x03;
-      else
-        temp2 = 0x00;
-
-      temp2 <<= 4;
-      temp1 <<= 1;
-      j++;
-      if (temp1 & 0x80)
-        temp2 |= 0x03;
-      else
-        temp2 |= 0x00;
-      temp1 <<= 1;
-      this->write_byte(temp2);
+  this->command(WAVESHARE_EPAPER_B_COMMAND_DATA_START_TRANSMISSION_1);
+  this->sending_ = true;
+  this->transfer_position_ = 0;
+  this->transfer_index_ = 0;
+  this->transfer_length_ = this->convert_chunk_(this->transfer_buffers_[0]);
+  this->send_chunk_();
+}
+uint32_t HOT WaveshareEPaper7P5In::convert_chunk_(uint8_t *data) {
+  // the display takes 4 bits per pixel, 0x3 for black and 0x0 for white
+  const uint32_t end =
+      std::min(this->transfer_position_ + WAVESHARE_EPAPER_7P5_CHUNK_LENGTH, this->get_buffer_length_());
+  uint32_t length = 0;
+  for (uint32_t i = this->transfer_position_; i < end; i++) {
+    const uint8_t value = this->buffer_[i];
+    for (uint8_t shift = 8; shift != 0; shift -= 2) {
+      const uint8_t high = (value >> (shift - 1)) & 0x01 ? 0x30 : 0x00;
+      const uint8_t low = (value >> (shift - 2)) & 0x01 ? 0x03 : 0x00;
+      data[length++] = high | low;
     }
-
-    feed_wdt();
   }
-  this->end_data_();
+  this->transfer_position_ = end;
+  return length;
+}
+void HOT WaveshareEPaper7P5In::send_chunk_() {
+  uint8_t *data = this->transfer_buffers_[this->transfer_index_];
+  const uint32_t length = this->transfer_length_;
+  this->start_data_();
+  this->write_array_async(data, length, [this]() {
+    if (this->transfer_length_ == 0) {
+      this->command(WAVESHARE_EPAPER_B_COMMAND_DISPLAY_REFRESH);
+      this->sending_ = false;
+      return;
+    }
+    this->send_chunk_();
+  });
 
-  this->command(WAVESHARE_EPAPER_B_COMMAND_DISPLAY_REFRESH);
+  // convert the next chunk while this one is being sent
+  this->transfer_index_ ^= 1;
+  this->transfer_length_ = this->convert_chunk_(this->transfer_buffers_[this->transfer_index_]);
 }
 int WaveshareEPaper7P5In::get_width_internal() { return 640; }
 int WaveshareEPaper7P5In::get_height_internal() { return 384; }
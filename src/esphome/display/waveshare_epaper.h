@@ -25,14 +25,22 @@ class WaveshareEPaper : public PollingComponent, public SPIDevice, public Displa
 
   virtual void display() = 0;
 
+  /// Draw and send a new frame, or if the display is still refreshing the last one, do so once it's done.
   void update() override;
+  /// Wait for the refresh to finish without blocking, only enabled while an update is deferred.
+  void loop() override;
 
   void fill(int color) override;
 
  protected:
   void draw_absolute_pixel_internal(int x, int y, int color) override;
+  void fill_span_internal(int x, int y, int width, int color) override;
+  void blit_1bpp_internal(int x, int y, const uint8_t *data, int width, int height, int color, bool opaque) override;
 
+  /// Block until the BUSY pin is low, only used during setup.
   bool wait_until_idle_();
+  /// Whether the display is still busy, for example with a refresh.
+  bool is_busy_();
 
   void setup_pins_();
 
@@ -48,6 +56,9 @@ class WaveshareEPaper : public PollingComponent, public SPIDevice, public Displa
   GPIOPin *reset_pin_{nullptr};
   GPIOPin *dc_pin_;
   GPIOPin *busy_pin_{nullptr};
+  /// Whether an update was deferred until the running refresh is done.
+  bool update_pending_{false};
+  uint32_t pending_since_{0};
 };
 
 enum WaveshareEPaperTypeAModel {
@@ -78,6 +89,9 @@ class WaveshareEPaperTypeA : public WaveshareEPaper {
 
   uint32_t full_update_every_{30};
   uint32_t at_update_{0};
+  /// Rows changed in the last transfer, first and last (inclusive).
+  uint16_t last_dirty_start_{0};
+  uint16_t last_dirty_end_{0};
   WaveshareEPaperTypeAModel model_;
 };
 
@@ -124,6 +138,9 @@ class WaveshareEPaper7P5In : public WaveshareEPaper {
   WaveshareEPaper7P5In(SPIComponent *parent, GPIOPin *cs, GPIOPin *dc_pin, uint32_t update_interval);
   void setup() override;
 
+  void update() override;
+
+  /// Start sending the buffer, converted and sent in chunks in the background.
   void display() override;
 
   void dump_config() override;
@@ -132,6 +149,21 @@ class WaveshareEPaper7P5In : public WaveshareEPaper {
   int get_width_internal() override;
 
   int get_height_internal() override;
+
+  /// Convert the next chunk of the buffer to the display's format, returns the number of bytes written to data.
+  uint32_t convert_chunk_(uint8_t *data);
+  /// Send the converted chunk in transfer_buffers_[transfer_index_] and convert the next one meanwhile.
+  void send_chunk_();
+
+  /// Two chunks, one being sent while the other is converted.
+  uint8_t *transfer_buffers_[2]{nullptr, nullptr};
+  uint8_t transfer_index_{0};
+  /// Length of the converted chunk that is sent next, 0 once all have been sent.
+  uint32_t transfer_length_{0};
+  /// Position in the buffer of the next chunk to convert.
+  uint32_t transfer_position_{0};
+  /// Whether a frame is being sent, update() is skipped meanwhile.
+  bool sending_{false};
 };
 
 }  // namespace display
@@ -11,6 +11,7 @@
 #include <esp_gap_ble_api.h>
 #include <esp_bt_defs.h>
 #include "esphome/log.h"
+#include "esphome/metrics.h"
 
 ESPHOME_NAMESPACE_BEGIN
 
@@ -32,10 +33,147 @@ uint64_t ble_addr_to_uint64(const esp_bd_addr_t address) {
   return u;
 }
 
+/// Spread the 48 address bits over the whole hash (Fibonacci hashing).
+static size_t ble_addr_hash(uint64_t address, size_t table_size) {
+  return size_t((address * 0x9E3779B97F4A7C15ULL) >> 32) & (table_size - 1);
+}
+
+const uint16_t BLEAddressMap::EMPTY;
+void BLEAddressMap::insert(uint64_t address, uint16_t index) {
+  if ((this->size_ + 1) * 2 > this->table_.size())
+    this->rehash_(std::max<size_t>(16, this->table_.size() * 2));
+  size_t slot = this->slot_(address);
+  while (this->table_[slot].index != EMPTY && this->table_[slot].address != address)
+    slot = (slot + 1) & (this->table_.size() - 1);
+  if (this->table_[slot].index == EMPTY)
+    this->size_++;
+  this->table_[slot] = Entry{address, index};
+}
+int BLEAddressMap::find(uint64_t address) const {
+  if (this->table_.empty())
+    return -1;
+  size_t slot = this->slot_(address);
+  while (this->table_[slot].index != EMPTY) {
+    if (this->table_[slot].address == address)
+      return this->table_[slot].index;
+    slot = (slot + 1) & (this->table_.size() - 1);
+  }
+  return -1;
+}
+void BLEAddressMap::rehash_(size_t table_size) {
+  std::vector<Entry> old;
+  old.swap(this->table_);
+  this->table_.assign(table_size, Entry{0, EMPTY});
+  this->size_ = 0;
+  for (auto &entry : old) {
+    if (entry.index != EMPTY)
+      this->insert(entry.address, entry.index);
+  }
+}
+size_t BLEAddressMap::slot_(uint64_t address) const { return ble_addr_hash(address, this->table_.size()); }
+
+const uint16_t BLEAddressLRU::NONE;
+BLEAddressLRU::BLEAddressLRU(uint16_t capacity) : nodes_(capacity) {
+  size_t table_size = 16;
+  while (table_size < capacity * 2u)
+    table_size *= 2;
+  this->table_.assign(table_size, NONE);
+}
+bool BLEAddressLRU::touch(uint64_t address) {
+  int slot = this->find_slot_(address);
+  if (slot >= 0) {
+    const uint16_t node = this->table_[slot];
+    this->unlink_(node);
+    this->push_front_(node);
+    return true;
+  }
+
+  uint16_t node;
+  if (this->size_ < this->nodes_.size()) {
+    node = this->size_++;
+  } else {
+    // full, forget the least recently seen address
+    node = this->tail_;
+    this->erase_slot_(this->find_slot_(this->nodes_[node].address));
+    this->unlink_(node);
+  }
+  this->nodes_[node].address = address;
+  this->push_front_(node);
+
+  size_t free_slot = this->slot_(address);
+  while (this->table_[free_slot] != NONE)
+    free_slot = (free_slot + 1) & (this->table_.size() - 1);
+  this->table_[free_slot] = node;
+  return false;
+}
+void BLEAddressLRU::clear() {
+  std::fill(this->table_.begin(), this->table_.end(), NONE);
+  this->size_ = 0;
+  this->head_ = NONE;
+  this->tail_ = NONE;
+}
+uint16_t BLEAddressLRU::size() const { return this->size_; }
+size_t BLEAddressLRU::slot_(uint64_t address) const { return ble_addr_hash(address, this->table_.size()); }
+int BLEAddressLRU::find_slot_(uint64_t address) const {
+  size_t slot = this->slot_(address);
+  while (this->table_[slot] != NONE) {
+    if (this->nodes_[this->table_[slot]].address == address)
+      return slot;
+    slot = (slot + 1) & (this->table_.size() - 1);
+  }
+  return -1;
+}
+void BLEAddressLRU::erase_slot_(size_t slot) {
+  const size_t mask = this->table_.size() - 1;
+  size_t next = (slot + 1) & mask;
+  while (this->table_[next] != NONE) {
+    const size_t home = this->slot_(this->nodes_[this->table_[next]].address);
+    // move the entry into the gap if the gap lies between its home slot and where it is now
+    if (((next - home) & mask) >= ((next - slot) & mask)) {
+      this->table_[slot] = this->table_[next];
+      slot = next;
+    }
+    next = (next + 1) & mask;
+  }
+  this->table_[slot] = NONE;
+}
+void BLEAddressLRU::unlink_(uint16_t node) {
+  Node &n = this->nodes_[node];
+  if (n.prev != NONE)
+    this->nodes_[n.prev].next = n.next;
+  else
+    this->head_ = n.next;
+  if (n.next != NONE)
+    this->nodes_[n.next].prev = n.prev;
+  else
+    this->tail_ = n.prev;
+}
+void BLEAddressLRU::push_front_(uint16_t node) {
+  Node &n = this->nodes_[node];
+  n.prev = NONE;
+  n.next = this->head_;
+  if (this->head_ != NONE)
+    this->nodes_[this->head_].prev = node;
+  this->head_ = node;
+  if (this->tail_ == NONE)
+    this->tail_ = node;
+}
+
+BLETrackedDevice &ESP32BLETracker::get_tracked_(uint64_t address) {
+  int index = this->tracked_index_.find(address);
+  if (index < 0) {
+    index = this->tracked_.size();
+    this->tracked_.emplace_back();
+    this->tracked_index_.insert(address, index);
+  }
+  return this->tracked_[index];
+}
+
 ESP32BLEPresenceDevice *ESP32BLETracker::make_presence_sensor(const std::string &name, std::array<uint8_t, 6> address) {
   uint64_t addr = ble_addr_to_uint64(address.cbegin());
   auto *dev = new ESP32BLEPresenceDevice(name, addr);
   this->presence_sensors_.push_back(dev);
+  this->get_tracked_(addr).presence_sensors.push_back(dev);
   return dev;
 }
 
@@ -43,6 +181,7 @@ ESP32BLERSSISensor *ESP32BLETracker::make_rssi_sensor(const std::string &name, s
   uint64_t addr = ble_addr_to_uint64(address.cbegin());
   auto *dev = new ESP32BLERSSISensor(this, name, addr);
   this->rssi_sensors_.push_back(dev);
+  this->get_tracked_(addr).rssi_sensors.push_back(dev);
   return dev;
 }
 
@@ -50,13 +189,18 @@ XiaomiDevice *ESP32BLETracker::make_xiaomi_device(std::array<uint8_t, 6> address
   uint64_t addr = ble_addr_to_uint64(address.cbegin());
   auto *dev = new XiaomiDevice(this, addr);
   this->xiaomi_devices_.push_back(dev);
+  this->get_tracked_(addr).xiaomi_devices.push_back(dev);
   return dev;
 }
 
 void ESP32BLETracker::setup() {
   global_esp32_ble_tracker = this;
-  this->scan_result_lock_ = xSemaphoreCreateMutex();
-  this->scan_end_lock_ = xSemaphoreCreateMutex();
+#ifdef USE_METRICS
+  global_metrics.register_counter("ble_advertisements_total", "Processed BLE advertisements.",
+                                  [this]() { return this->advertisements_; });
+  global_metrics.register_counter("ble_advertisements_dropped_total", "BLE advertisements dropped, the queue was full.",
+                                  [this]() { return this->advertisements_dropped_; });
+#endif
 
   if (!ESP32BLETracker::ble_setup()) {
     this->mark_failed();
@@ -64,37 +208,39 @@ void ESP32BLETracker::setup() {
   }
 
   global_esp32_ble_tracker->start_scan(true);
+
+  if (this->report_interval_ != 0)
+    this->set_interval("report", this->report_interval_, [this]() { this->report_(); });
 }
 
 void ESP32BLETracker::loop() {
-  if (xSemaphoreTake(this->scan_end_lock_, 0L)) {
-    xSemaphoreGive(this->scan_end_lock_);
-    global_esp32_ble_tracker->start_scan(false);
-  }
-
-  if (xSemaphoreTake(this->scan_result_lock_, 5L / portTICK_PERIOD_MS)) {
-    uint32_t index = this->scan_result_index_;
-    xSemaphoreGive(this->scan_result_lock_);
-
-    if (index >= 16) {
-      ESP_LOGW(TAG, "Too many BLE events to process. Some devices may not show up.");
-    }
-    for (size_t i = 0; i < index; i++) {
-      ESPBTDevice device;
-      device.parse_scan_rst(this->scan_result_buffer_[i]);
+  if (this->scan_ended_.exchange(false))
+    this->start_scan(false);
 
-      this->parse_rssi_sensors_(device);
-      this->parse_xiaomi_sensors_(device);
+  const uint32_t dropped = this->scan_results_.take_dropped();
+  if (dropped != 0) {
+    this->advertisements_dropped_ += dropped;
+    ESP_LOGW(TAG, "Dropped %u BLE advertisements, some devices may not show up.", dropped);
+  }
+  // bounded so that a busy scanner can't keep us here forever
+  for (uint32_t i = 0; i < BLE_SCAN_RESULT_QUEUE_SIZE; i++) {
+    const BLEScanResult *result = this->scan_results_.front();
+    if (result == nullptr)
+      break;
 
-      if (this->parse_already_discovered_(device))
-        continue;
-      this->parse_presence_sensors_(device);
-    }
+    ESPBTDevice device;
+    device.parse_scan_rst(*result);
 
-    if (xSemaphoreTake(this->scan_result_lock_, 10L / portTICK_PERIOD_MS)) {
-      this->scan_result_index_ = 0;
-      xSemaphoreGive(this->scan_result_lock_);
+    const int tracked_index = this->tracked_index_.find(device.address_uint64());
+    BLETrackedDevice *tracked = tracked_index < 0 ? nullptr : &this->tracked_[tracked_index];
+    if (tracked != nullptr) {
+      this->parse_rssi_sensors_(device, *tracked);
+      this->parse_presence_sensors_(*tracked);
     }
+    this->parse_xiaomi_sensors_(device, tracked);
+    this->parse_already_discovered_(device);
+    this->scan_results_.pop();
+    this->advertisements_++;
   }
 
   if (this->scan_set_param_failed_) {
@@ -157,28 +303,20 @@ bool ESP32BLETracker::ble_setup() {
 }
 
 void ESP32BLETracker::start_scan(bool first) {
-  if (!xSemaphoreTake(this->scan_end_lock_, 0L)) {
-    ESP_LOGW("Cannot start scan!");
-    return;
-  }
-
   ESP_LOGD(TAG, "Starting scan...");
-  for (auto *device : this->presence_sensors_) {
-    if (!this->has_already_discovered_(device->address_))
-      device->publish_state(false);
+  for (auto &tracked : this->tracked_) {
+    // the first scan publishes the initial state
+    if (first || (this->presence_timeout_ == 0 && tracked.present && !tracked.seen_in_scan))
+      this->publish_presence_(tracked, false);
+    tracked.seen_in_scan = false;
   }
   this->already_discovered_.clear();
 
   this->scan_params_.scan_type = BLE_SCAN_TYPE_ACTIVE;
   this->scan_params_.own_addr_type = BLE_ADDR_TYPE_PUBLIC;
   this->scan_params_.scan_filter_policy = BLE_SCAN_FILTER_ALLOW_ALL;
-  // Values determined empirically, higher scan intervals and lower scan windows make the ESP more stable
-  // Ideally, these values should both be quite low, especially scan window. 0x10/0x10 is the esp-idf
-  // default and works quite well. 0x100/0x50 discovers a few less BLE broadcast packets but is a lot
-  // more stable (order of several hours). The old ESPHome default (1600/1600) was terrible with
-  // crashes every few minutes
-  this->scan_params_.scan_interval = 0x200;
-  this->scan_params_.scan_window = 0x30;
+  this->scan_params_.scan_interval = this->scan_timing_interval_;
+  this->scan_params_.scan_window = this->scan_timing_window_;
 
   esp_ble_gap_set_scan_params(&this->scan_params_);
   esp_ble_gap_start_scanning(this->scan_interval_);
@@ -210,32 +348,67 @@ void ESP32BLETracker::gap_scan_start_complete(const esp_ble_gap_cb_param_t::ble_
 
 void ESP32BLETracker::gap_scan_result(const esp_ble_gap_cb_param_t::ble_scan_result_evt_param &param) {
   if (param.search_evt == ESP_GAP_SEARCH_INQ_RES_EVT) {
-    if (xSemaphoreTake(this->scan_result_lock_, 0L)) {
-      if (this->scan_result_index_ < 16) {
-        this->scan_result_buffer_[this->scan_result_index_++] = param;
-      }
-      xSemaphoreGive(this->scan_result_lock_);
-    }
+    this->scan_results_.push(param);
   } else if (param.search_evt == ESP_GAP_SEARCH_INQ_CMPL_EVT) {
-    xSemaphoreGive(this->scan_end_lock_);
+    this->scan_ended_ = true;
   }
 }
 
-bool ESP32BLETracker::has_already_discovered_(uint64_t address) {
-  for (auto addr : this->already_discovered_) {
-    if (addr == address) {
-      return true;
-    }
+void ESP32BLEScanResultQueue::push(const esp_ble_gap_cb_param_t::ble_scan_result_evt_param &param) {
+  const uint32_t write_at = this->write_at_.load(std::memory_order_relaxed);
+  const uint32_t next = (write_at + 1) % BLE_SCAN_RESULT_QUEUE_SIZE;
+  if (next == this->read_at_.load(std::memory_order_acquire)) {
+    this->dropped_.fetch_add(1, std::memory_order_relaxed);
+    return;
   }
-  return false;
+
+  BLEScanResult &result = this->results_[write_at];
+  memcpy(result.address, param.bda, ESP_BD_ADDR_LEN);
+  result.address_type = param.ble_addr_type;
+  result.rssi = param.rssi;
+  result.data_len = std::min<size_t>(param.adv_data_len + param.scan_rsp_len, sizeof(result.data));
+  memcpy(result.data, param.ble_adv, result.data_len);
+  this->write_at_.store(next, std::memory_order_release);
 }
+const BLEScanResult *ESP32BLEScanResultQueue::front() const {
+  const uint32_t read_at = this->read_at_.load(std::memory_order_relaxed);
+  if (read_at == this->write_at_.load(std::memory_order_acquire))
+    return nullptr;
+  return &this->results_[read_at];
+}
+void ESP32BLEScanResultQueue::pop() {
+  const uint32_t read_at = this->read_at_.load(std::memory_order_relaxed);
+  this->read_at_.store((read_at + 1) % BLE_SCAN_RESULT_QUEUE_SIZE, std::memory_order_release);
+}
+uint32_t ESP32BLEScanResultQueue::take_dropped() { return this->dropped_.exchange(0, std::memory_order_relaxed); }
 
-void ESP32BLETracker::parse_rssi_sensors_(const ESPBTDevice &device) {
-  const uint64_t address = device.address_uint64();
-  int rssi = device.get_rssi();
-  for (auto *dev : this->rssi_sensors_) {
-    if (dev->address_ == address)
+void ESP32BLETracker::parse_rssi_sensors_(const ESPBTDevice &device, BLETrackedDevice &tracked) {
+  const int8_t rssi = device.get_rssi();
+  if (this->report_interval_ == 0) {
+    for (auto *dev : tracked.rssi_sensors)
       dev->publish_state(rssi);
+    return;
+  }
+  tracked.rssi_sum += rssi;
+  tracked.rssi_max = std::max(tracked.rssi_max, rssi);
+  tracked.packet_count++;
+}
+
+void ESP32BLETracker::report_() {
+  const uint32_t now = millis();
+  for (auto &tracked : this->tracked_) {
+    if (tracked.packet_count != 0) {
+      const float mean = float(tracked.rssi_sum) / tracked.packet_count;
+      ESP_LOGV(TAG, "RSSI mean=%.1f max=%d from %u advertisements", mean, tracked.rssi_max, tracked.packet_count);
+      for (auto *dev : tracked.rssi_sensors)
+        dev->publish_state(dev->aggregation_ == BLE_RSSI_MAX ? tracked.rssi_max : mean);
+      tracked.rssi_sum = 0;
+      tracked.rssi_max = INT8_MIN;
+      tracked.packet_count = 0;
+    }
+
+    if (this->presence_timeout_ != 0 && tracked.present && now - tracked.last_seen > this->presence_timeout_)
+      this->publish_presence_(tracked, false);
   }
 }
 
@@ -306,25 +479,24 @@ XiaomiDataType parse_xiaomi(uint8_t data_type, const uint8_t *data, uint8_t data
   }
 }
 
-void ESP32BLETracker::parse_xiaomi_sensors_(const ESPBTDevice &device) {
-  const uint64_t address = device.address_uint64();
-
-  if (!device.get_service_data_uuid().has_value()) {
+void ESP32BLETracker::parse_xiaomi_sensors_(const ESPBTDevice &device, const BLETrackedDevice *tracked) {
+  auto service_data_uuid = device.get_service_data_uuid();
+  if (!service_data_uuid.has_value()) {
     ESP_LOGVV(TAG, "Xiaomi no service data");
     return;
   }
 
-  if (!device.get_service_data_uuid()->contains(0x95, 0xFE)) {
+  if (!service_data_uuid->contains(0x95, 0xFE)) {
     ESP_LOGVV(TAG, "Xiaomi no service data UUID magic bytes");
     return;
   }
 
-  const auto *raw = reinterpret_cast<const uint8_t *>(device.get_service_data().data());
-
-  if (device.get_service_data().size() < 14) {
+  auto service_data = device.get_service_data_record();
+  if (!service_data.has_value() || service_data->length < 14) {
     ESP_LOGVV(TAG, "Xiaomi service data too short!");
     return;
   }
+  const uint8_t *raw = service_data->data;
 
   bool is_mijia = (raw[1] & 0x20) == 0x20 && raw[2] == 0xAA && raw[3] == 0x01;
   bool is_miflora = (raw[1] & 0x20) == 0x20 && raw[2] == 0x98 && raw[3] == 0x00;
@@ -341,7 +513,7 @@ void ESP32BLETracker::parse_xiaomi_sensors_(const ESPBTDevice &device) {
   const uint8_t data_length = raw[raw_offset + 2];
   const uint8_t *data = &raw[raw_offset + 3];
   const uint8_t expected_length = data_length + raw_offset + 3;
-  const uint8_t actual_length = device.get_service_data().size();
+  const uint8_t actual_length = service_data->length;
   if (expected_length != actual_length) {
     ESP_LOGV(TAG, "Xiaomi %s data length mismatch (%u != %d)", type, expected_length, actual_length);
     return;
@@ -378,54 +550,51 @@ void ESP32BLETracker::parse_xiaomi_sensors_(const ESPBTDevice &device) {
       break;
   }
 
-  for (auto *dev : this->xiaomi_devices_) {
-    if (dev->address_ == address) {
-      switch (data_type) {
-        case XIAOMI_TEMPERATURE_HUMIDITY:
-          if (dev->get_temperature_sensor() != nullptr)
-            dev->get_temperature_sensor()->publish_state(data1);
-          if (dev->get_humidity_sensor() != nullptr)
-            dev->get_humidity_sensor()->publish_state(data2);
-          break;
-        case XIAOMI_HUMIDITY:
-          if (dev->get_humidity_sensor() != nullptr)
-            dev->get_humidity_sensor()->publish_state(data1);
-          break;
-        case XIAOMI_BATTERY_LEVEL:
-          if (dev->get_battery_level_sensor() != nullptr)
-            dev->get_battery_level_sensor()->publish_state(data1);
-          break;
-        case XIAOMI_TEMPERATURE:
-          if (dev->get_temperature_sensor() != nullptr)
-            dev->get_temperature_sensor()->publish_state(data1);
-          break;
-        case XIAOMI_MOISTURE:
-          if (dev->get_moisture_sensor() != nullptr)
-            dev->get_moisture_sensor()->publish_state(data1);
-          break;
-        case XIAOMI_ILLUMINANCE:
-          if (dev->get_illuminance_sensor() != nullptr)
-            dev->get_illuminance_sensor()->publish_state(data1);
-          break;
-        case XIAOMI_CONDUCTIVITY:
-          if (dev->get_conductivity_sensor() != nullptr)
-            dev->get_conductivity_sensor()->publish_state(data1);
-          break;
-        default:
-          break;
-      }
+  if (tracked == nullptr)
+    return;
+  for (auto *dev : tracked->xiaomi_devices) {
+    switch (data_type) {
+      case XIAOMI_TEMPERATURE_HUMIDITY:
+        if (dev->get_temperature_sensor() != nullptr)
+          dev->get_temperature_sensor()->publish_state(data1);
+        if (dev->get_humidity_sensor() != nullptr)
+          dev->get_humidity_sensor()->publish_state(data2);
+        break;
+      case XIAOMI_HUMIDITY:
+        if (dev->get_humidity_sensor() != nullptr)
+          dev->get_humidity_sensor()->publish_state(data1);
+        break;
+      case XIAOMI_BATTERY_LEVEL:
+        if (dev->get_battery_level_sensor() != nullptr)
+          dev->get_battery_level_sensor()->publish_state(data1);
+        break;
+      case XIAOMI_TEMPERATURE:
+        if (dev->get_temperature_sensor() != nullptr)
+          dev->get_temperature_sensor()->publish_state(data1);
+        break;
+      case XIAOMI_MOISTURE:
+        if (dev->get_moisture_sensor() != nullptr)
+          dev->get_moisture_sensor()->publish_state(data1);
+        break;
+      case XIAOMI_ILLUMINANCE:
+        if (dev->get_illuminance_sensor() != nullptr)
+          dev->get_illuminance_sensor()->publish_state(data1);
+        break;
+      case XIAOMI_CONDUCTIVITY:
+        if (dev->get_conductivity_sensor() != nullptr)
+          dev->get_conductivity_sensor()->publish_state(data1);
+        break;
+      default:
+        break;
     }
   }
 }
 
 bool ESP32BLETracker::parse_already_discovered_(const ESPBTDevice &device) {
-  const uint64_t address = device.address_uint64();
-  // O(N^2), but won't be called that often anyway and this is probably better with memory allocation
-  if (this->has_already_discovered_(address)) {
+  if (this->already_discovered_.touch(device.address_uint64())) {
     ESP_LOGV(TAG, "Already discovered device %s", device.address_str().c_str());
     return true;
   }
-  this->already_discovered_.push_back(address);
 
 #ifdef ESPHOME_LOG_HAS_DEBUG
   ESP_LOGD(TAG, "Found device %s RSSI=%d", device.address_str().c_str(), device.get_rssi());
@@ -450,22 +619,28 @@ bool ESP32BLETracker::parse_already_discovered_(const ESPBTDevice &device) {
   }
 
   ESP_LOGD(TAG, "  Address Type: %s", address_type_s);
-  if (!device.get_name().empty())
-    ESP_LOGD(TAG, "  Name: '%s'", device.get_name().c_str());
-  if (device.get_tx_power().has_value()) {
-    ESP_LOGD(TAG, "  TX Power: %d", *device.get_tx_power());
+  std::string name = device.get_name();
+  if (!name.empty())
+    ESP_LOGD(TAG, "  Name: '%s'", name.c_str());
+  auto tx_power = device.get_tx_power();
+  if (tx_power.has_value()) {
+    ESP_LOGD(TAG, "  TX Power: %d", *tx_power);
   }
 #endif
 
   return false;
 }
 
-void ESP32BLETracker::parse_presence_sensors_(const ESPBTDevice &device) {
-  const uint64_t address = device.address_uint64();
-  for (auto *dev : this->presence_sensors_) {
-    if (dev->address_ == address)
-      dev->publish_state(true);
-  }
+void ESP32BLETracker::parse_presence_sensors_(BLETrackedDevice &tracked) {
+  tracked.last_seen = millis();
+  tracked.seen_in_scan = true;
+  if (!tracked.present)
+    this->publish_presence_(tracked, true);
+}
+void ESP32BLETracker::publish_presence_(BLETrackedDevice &tracked, bool present) {
+  tracked.present = present;
+  for (auto *dev : tracked.presence_sensors)
+    dev->publish_state(present);
 }
 
 ESPBTUUID::ESPBTUUID() : uuid_() {}
@@ -526,17 +701,13 @@ std::string ESPBTUUID::to_string() {
   return sbuf;
 }
 
-void ESPBTDevice::parse_scan_rst(const esp_ble_gap_cb_param_t::ble_scan_result_evt_param &param) {
-  for (uint8_t i = 0; i < ESP_BD_ADDR_LEN; i++)
-    this->address_[i] = param.bda[i];
-  this->address_type_ = param.ble_addr_type;
-  this->rssi_ = param.rssi;
-  this->parse_adv(param);
+void ESPBTDevice::parse_scan_rst(const BLEScanResult &result) {
+  this->result_ = &result;
 
 #ifdef ESPHOME_LOG_HAS_VERY_VERBOSE
   ESP_LOGVV(TAG, "Parse Result:");
   const char *address_type = "";
-  switch (this->address_type_) {
+  switch (this->get_address_type()) {
     case BLE_ADDR_TYPE_PUBLIC:
       address_type = "PUBLIC";
       break;
@@ -550,158 +721,243 @@ void ESPBTDevice::parse_scan_rst(const esp_ble_gap_cb_param_t::ble_scan_result_e
       address_type = "RPA_RANDOM";
       break;
   }
-  ESP_LOGVV(TAG, "  Address: %02X:%02X:%02X:%02X:%02X:%02X (%s)", this->address_[0], this->address_[1],
-            this->address_[2], this->address_[3], this->address_[4], this->address_[5], address_type);
+  ESP_LOGVV(TAG, "  Address: %s (%s)", this->address_str().c_str(), address_type);
 
-  ESP_LOGVV(TAG, "  RSSI: %d", this->rssi_);
-  ESP_LOGVV(TAG, "  Name: %s", this->name_.c_str());
-  if (this->tx_power_.has_value()) {
-    ESP_LOGVV(TAG, "  TX Power: %d", *this->tx_power_);
+  ESP_LOGVV(TAG, "  RSSI: %d", this->get_rssi());
+  ESP_LOGVV(TAG, "  Name: %s", this->get_name().c_str());
+  auto tx_power = this->get_tx_power();
+  if (tx_power.has_value()) {
+    ESP_LOGVV(TAG, "  TX Power: %d", *tx_power);
   }
-  if (this->appearance_.has_value()) {
-    ESP_LOGVV(TAG, "  Appearance: %u", *this->appearance_);
+  auto appearance = this->get_appearance();
+  if (appearance.has_value()) {
+    ESP_LOGVV(TAG, "  Appearance: %u", *appearance);
   }
-  if (this->ad_flag_.has_value()) {
-    ESP_LOGVV(TAG, "  Ad Flag: %u", *this->ad_flag_);
+  auto ad_flag = this->get_ad_flag();
+  if (ad_flag.has_value()) {
+    ESP_LOGVV(TAG, "  Ad Flag: %u", *ad_flag);
   }
-  for (auto uuid : this->service_uuids_) {
+  for (auto uuid : this->get_service_uuids()) {
     ESP_LOGVV(TAG, "  Service UUID: %s", uuid.to_string().c_str());
   }
-  ESP_LOGVV(TAG, "  Manufacturer data: '%s'", this->manufacturer_data_.c_str());
-  ESP_LOGVV(TAG, "  Service data: '%s'", this->service_data_.c_str());
+  ESP_LOGVV(TAG, "  Manufacturer data: '%s'", this->get_manufacturer_data().c_str());
+  ESP_LOGVV(TAG, "  Service data: '%s'", this->get_service_data().c_str());
 
-  if (this->service_data_uuid_.has_value()) {
-    ESP_LOGVV(TAG, "  Service Data UUID: %s", this->service_data_uuid_->to_string().c_str());
+  auto service_data_uuid = this->get_service_data_uuid();
+  if (service_data_uuid.has_value()) {
+    ESP_LOGVV(TAG, "  Service Data UUID: %s", service_data_uuid->to_string().c_str());
   }
 
   char buffer[200];
   size_t off = 0;
-  for (uint8_t i = 0; i < param.adv_data_len; i++) {
-    int ret = snprintf(buffer + off, sizeof(buffer) - off, "%02X.", param.ble_adv[i]);
+  for (uint8_t i = 0; i < result.data_len; i++) {
+    int ret = snprintf(buffer + off, sizeof(buffer) - off, "%02X.", result.data[i]);
     if (ret < 0) {
       break;
     }
     off += ret;
   }
-  ESP_LOGVV(TAG, "Adv data: %s (%u bytes)", buffer, param.adv_data_len);
+  ESP_LOGVV(TAG, "Adv data: %s (%u bytes)", buffer, result.data_len);
 #endif
 }
-void ESPBTDevice::parse_adv(const esp_ble_gap_cb_param_t::ble_scan_result_evt_param &param) {
-  size_t offset = 0;
-  const uint8_t *payload = param.ble_adv;
-  uint8_t len = param.adv_data_len;
-
-  while (offset + 2 < len) {
-    const uint8_t field_length = payload[offset++];  // First byte is length of adv record
-    if (field_length == 0)
-      break;
+bool ESPBTDevice::next_record(size_t *offset, ESPBTAdvRecord *record) const {
+  const uint8_t *payload = this->result_->data;
+  const uint8_t len = this->result_->data_len;
 
-    // first byte of adv record is adv record type
-    const uint8_t record_type = payload[offset++];
-    const uint8_t *record = &payload[offset];
-    const uint8_t record_length = field_length - 1;
-    offset += record_length;
+  if (*offset + 2 >= len)
+    return false;
+  const uint8_t field_length = payload[*offset];  // First byte is length of adv record
+  if (field_length == 0 || *offset + 1 + field_length > len)
+    return false;
 
-    switch (record_type) {
-      case ESP_BLE_AD_TYPE_NAME_CMPL: {
-        this->name_ = std::string(reinterpret_cast<const char *>(record), record_length);
-        break;
-      }
-      case ESP_BLE_AD_TYPE_TX_PWR: {
-        this->tx_power_ = *payload;
-        break;
-      }
-      case ESP_BLE_AD_TYPE_APPEARANCE: {
-        this->appearance_ = *reinterpret_cast<const uint16_t *>(record);
-        break;
-      }
-      case ESP_BLE_AD_TYPE_FLAG: {
-        this->ad_flag_ = *record;
-        break;
-      }
+  // first byte of adv record is adv record type
+  record->type = payload[*offset + 1];
+  record->data = &payload[*offset + 2];
+  record->length = field_length - 1;
+  *offset += 1 + field_length;
+  return true;
+}
+optional<ESPBTAdvRecord> ESPBTDevice::find_record(std::initializer_list<uint8_t> types) const {
+  optional<ESPBTAdvRecord> found;
+  size_t offset = 0;
+  ESPBTAdvRecord record{};
+  while (this->next_record(&offset, &record)) {
+    for (uint8_t type : types) {
+      if (record.type == type)
+        found = record;
+    }
+  }
+  return found;
+}
+std::string ESPBTDevice::address_str() const {
+  const uint8_t *address = this->result_->address;
+  char mac[24];
+  snprintf(mac, sizeof(mac), "%02X:%02X:%02X:%02X:%02X:%02X", address[0], address[1], address[2], address[3],
+           address[4], address[5]);
+  return mac;
+}
+uint64_t ESPBTDevice::address_uint64() const { return ble_addr_to_uint64(this->result_->address); }
+esp_ble_addr_type_t ESPBTDevice::get_address_type() const { return this->result_->address_type; }
+int ESPBTDevice::get_rssi() const { return this->result_->rssi; }
+std::string ESPBTDevice::get_name() const {
+  auto record = this->find_record({ESP_BLE_AD_TYPE_NAME_CMPL});
+  if (!record.has_value())
+    return "";
+  return std::string(reinterpret_cast<const char *>(record->data), record->length);
+}
+optional<int8_t> ESPBTDevice::get_tx_power() const {
+  auto record = this->find_record({ESP_BLE_AD_TYPE_TX_PWR});
+  if (!record.has_value() || record->length < 1)
+    return {};
+  return int8_t(record->data[0]);
+}
+optional<uint16_t> ESPBTDevice::get_appearance() const {
+  auto record = this->find_record({ESP_BLE_AD_TYPE_APPEARANCE});
+  if (!record.has_value() || record->length < 2)
+    return {};
+  return uint16_t(record->data[0]) | (uint16_t(record->data[1]) << 8);
+}
+optional<uint8_t> ESPBTDevice::get_ad_flag() const {
+  auto record = this->find_record({ESP_BLE_AD_TYPE_FLAG});
+  if (!record.has_value() || record->length < 1)
+    return {};
+  return record->data[0];
+}
+std::vector<ESPBTUUID> ESPBTDevice::get_service_uuids() const {
+  std::vector<ESPBTUUID> uuids;
+  size_t offset = 0;
+  ESPBTAdvRecord record{};
+  while (this->next_record(&offset, &record)) {
+    switch (record.type) {
       case ESP_BLE_AD_TYPE_16SRV_CMPL:
       case ESP_BLE_AD_TYPE_16SRV_PART: {
-        for (uint8_t i = 0; i < record_length / 2; i++) {
-          this->service_uuids_.push_back(ESPBTUUID::from_uint16(*reinterpret_cast<const uint16_t *>(record + 2 * i)));
+        for (uint8_t i = 0; i < record.length / 2; i++) {
+          uuids.push_back(ESPBTUUID::from_uint16(*reinterpret_cast<const uint16_t *>(record.data + 2 * i)));
         }
         break;
       }
       case ESP_BLE_AD_TYPE_32SRV_CMPL:
       case ESP_BLE_AD_TYPE_32SRV_PART: {
-        for (uint8_t i = 0; i < record_length / 4; i++) {
-          this->service_uuids_.push_back(ESPBTUUID::from_uint32(*reinterpret_cast<const uint32_t *>(record + 4 * i)));
+        for (uint8_t i = 0; i < record.length / 4; i++) {
+          uuids.push_back(ESPBTUUID::from_uint32(*reinterpret_cast<const uint32_t *>(record.data + 4 * i)));
         }
         break;
       }
       case ESP_BLE_AD_TYPE_128SRV_CMPL:
       case ESP_BLE_AD_TYPE_128SRV_PART: {
-        this->service_uuids_.push_back(ESPBTUUID::from_raw(record));
-        break;
-      }
-      case ESP_BLE_AD_MANUFACTURER_SPECIFIC_TYPE: {
-        this->manufacturer_data_ = std::string(reinterpret_cast<const char *>(record), record_length);
-        break;
-      }
-      case ESP_BLE_AD_TYPE_SERVICE_DATA: {
-        if (record_length < 2) {
-          ESP_LOGV(TAG, "Record length too small for ESP_BLE_AD_TYPE_SERVICE_DATA");
-          break;
-        }
-        this->service_data_uuid_ = ESPBTUUID::from_uint16(*reinterpret_cast<const uint16_t *>(record));
-        if (record_length > 2)
-          this->service_data_ = std::string(reinterpret_cast<const char *>(record + 2), record_length - 2UL);
+        if (record.length >= 16)
+          uuids.push_back(ESPBTUUID::from_raw(record.data));
         break;
       }
-      case ESP_BLE_AD_TYPE_32SERVICE_DATA: {
-        if (record_length < 4) {
-          ESP_LOGV(TAG, "Record length too small for ESP_BLE_AD_TYPE_32SERVICE_DATA");
-          break;
-        }
-        this->service_data_uuid_ = ESPBTUUID::from_uint32(*reinterpret_cast<const uint32_t *>(record));
-        if (record_length > 4)
-          this->service_data_ = std::string(reinterpret_cast<const char *>(record + 4), record_length - 4UL);
+      default:
         break;
-      }
-      case ESP_BLE_AD_TYPE_128SERVICE_DATA: {
-        if (record_length < 16) {
-          ESP_LOGV(TAG, "Record length too small for ESP_BLE_AD_TYPE_128SERVICE_DATA");
-          break;
-        }
-        this->service_data_uuid_ = ESPBTUUID::from_raw(record);
-        if (record_length > 16)
-          this->service_data_ = std::string(reinterpret_cast<const char *>(record + 16), record_length - 16UL);
-        break;
-      }
-      default: {
-        ESP_LOGV(TAG, "Unhandled type: advType: 0x%02x", record_type);
-        break;
-      }
     }
   }
+  return uuids;
 }
-std::string ESPBTDevice::address_str() const {
-  char mac[24];
-  snprintf(mac, sizeof(mac), "%02X:%02X:%02X:%02X:%02X:%02X", this->address_[0], this->address_[1], this->address_[2],
-           this->address_[3], this->address_[4], this->address_[5]);
-  return mac;
+std::string ESPBTDevice::get_manufacturer_data() const {
+  auto record = this->find_record({ESP_BLE_AD_MANUFACTURER_SPECIFIC_TYPE});
+  if (!record.has_value())
+    return "";
+  return std::string(reinterpret_cast<const char *>(record->data), record->length);
+}
+/// The size of the UUID at the start of a service data record, 0 if the record is too short.
+static uint8_t service_data_uuid_size(const ESPBTAdvRecord &record) {
+  uint8_t size;
+  switch (record.type) {
+    case ESP_BLE_AD_TYPE_SERVICE_DATA:
+      size = 2;
+      break;
+    case ESP_BLE_AD_TYPE_32SERVICE_DATA:
+      size = 4;
+      break;
+    case ESP_BLE_AD_TYPE_128SERVICE_DATA:
+    default:
+      size = 16;
+      break;
+  }
+  if (record.length < size) {
+    ESP_LOGV(TAG, "Record length too small for service data type 0x%02X", record.type);
+    return 0;
+  }
+  return size;
+}
+optional<ESPBTAdvRecord> ESPBTDevice::get_service_data_record() const {
+  auto record = this->find_record(
+      {ESP_BLE_AD_TYPE_SERVICE_DATA, ESP_BLE_AD_TYPE_32SERVICE_DATA, ESP_BLE_AD_TYPE_128SERVICE_DATA});
+  if (!record.has_value())
+    return {};
+  const uint8_t uuid_size = service_data_uuid_size(*record);
+  if (uuid_size == 0)
+    return {};
+  record->data += uuid_size;
+  record->length -= uuid_size;
+  return record;
+}
+std::string ESPBTDevice::get_service_data() const {
+  auto record = this->get_service_data_record();
+  if (!record.has_value())
+    return "";
+  return std::string(reinterpret_cast<const char *>(record->data), record->length);
+}
+optional<ESPBTUUID> ESPBTDevice::get_service_data_uuid() const {
+  auto record = this->find_record(
+      {ESP_BLE_AD_TYPE_SERVICE_DATA, ESP_BLE_AD_TYPE_32SERVICE_DATA, ESP_BLE_AD_TYPE_128SERVICE_DATA});
+  if (!record.has_value())
+    return {};
+  switch (service_data_uuid_size(*record)) {
+    case 2:
+      return ESPBTUUID::from_uint16(*reinterpret_cast<const uint16_t *>(record->data));
+    case 4:
+      return ESPBTUUID::from_uint32(*reinterpret_cast<const uint32_t *>(record->data));
+    case 16:
+      return ESPBTUUID::from_raw(record->data);
+    default:
+      return {};
+  }
 }
-uint64_t ESPBTDevice::address_uint64() const { return ble_addr_to_uint64(this->address_); }
-esp_ble_addr_type_t ESPBTDevice::get_address_type() const { return this->address_type_; }
-int ESPBTDevice::get_rssi() const { return this->rssi_; }
-const std::string &ESPBTDevice::get_name() const { return this->name_; }
-const optional<int8_t> &ESPBTDevice::get_tx_power() const { return this->tx_power_; }
-const optional<uint16_t> &ESPBTDevice::get_appearance() const { return this->appearance_; }
-const optional<uint8_t> &ESPBTDevice::get_ad_flag() const { return this->ad_flag_; }
-const std::vector<ESPBTUUID> &ESPBTDevice::get_service_uuids() const { return this->service_uuids_; }
-const std::string &ESPBTDevice::get_manufacturer_data() const { return this->manufacturer_data_; }
-const std::string &ESPBTDevice::get_service_data() const { return this->service_data_; }
-const optional<ESPBTUUID> &ESPBTDevice::get_service_data_uuid() const { return this->service_data_uuid_; }
 
 void ESP32BLETracker::set_scan_interval(uint32_t scan_interval) { this->scan_interval_ = scan_interval; }
+void ESP32BLETracker::set_scan_mode(ESP32BLEScanMode scan_mode) {
+  // Values determined empirically, higher scan intervals and lower scan windows make the ESP more stable.
+  // 0x10/0x10 is the esp-idf default and discovers the most packets. 0x100/0x50 discovers a few less BLE
+  // broadcast packets but is a lot more stable (order of several hours). The old ESPHome default
+  // (1600/1600) was terrible with crashes every few minutes
+  switch (scan_mode) {
+    case BLE_SCAN_MODE_LOW_DUTY:
+      this->scan_timing_interval_ = 0x200;
+      this->scan_timing_window_ = 0x30;
+      break;
+    case BLE_SCAN_MODE_BALANCED:
+      this->scan_timing_interval_ = 0x100;
+      this->scan_timing_window_ = 0x50;
+      break;
+    case BLE_SCAN_MODE_CONTINUOUS:
+      this->scan_timing_interval_ = 0x10;
+      this->scan_timing_window_ = 0x10;
+      break;
+  }
+}
+void ESP32BLETracker::set_scan_timing(float interval_ms, float window_ms) {
+  // in units of 0.625ms, between 0x4 and 0x4000
+  this->scan_timing_interval_ = clamp<float>(0x4, 0x4000, interval_ms / 0.625f);
+  this->scan_timing_window_ = clamp<float>(0x4, this->scan_timing_interval_, window_ms / 0.625f);
+}
 uint32_t ESP32BLETracker::get_scan_interval() const { return this->scan_interval_; }
+void ESP32BLETracker::set_report_interval(uint32_t report_interval) { this->report_interval_ = report_interval; }
+void ESP32BLETracker::set_presence_timeout(uint32_t presence_timeout) { this->presence_timeout_ = presence_timeout; }
+uint32_t ESP32BLETracker::get_report_interval() const { return this->report_interval_; }
 void ESP32BLETracker::dump_config() {
   ESP_LOGCONFIG(TAG, "BLE Tracker:");
   ESP_LOGCONFIG(TAG, "  Scan Interval: %u s", this->scan_interval_);
+  ESP_LOGCONFIG(TAG, "  Scan Window: %.1f ms every %.1f ms", this->scan_timing_window_ * 0.625f,
+                this->scan_timing_interval_ * 0.625f);
+  if (this->report_interval_ != 0) {
+    ESP_LOGCONFIG(TAG, "  Report Interval: %u ms", this->report_interval_);
+  }
+  if (this->presence_timeout_ != 0) {
+    ESP_LOGCONFIG(TAG, "  Presence Timeout: %u ms", this->presence_timeout_);
+  }
   for (auto *child : this->presence_sensors_) {
     LOG_BINARY_SENSOR("  ", "Presence", child);
   }
@@ -719,16 +975,21 @@ void ESP32BLETracker::dump_config() {
   }
 }
 
-std::string ESP32BLERSSISensor::unit_of_measurement() { return "dB"; }
+const char *ESP32BLERSSISensor::unit_of_measurement() { return "dB"; }
 
-std::string ESP32BLERSSISensor::icon() { return "mdi:signal"; }
+const char *ESP32BLERSSISensor::icon() { return "mdi:signal"; }
 int8_t ESP32BLERSSISensor::accuracy_decimals() { return Sensor::accuracy_decimals(); }
 std::string ESP32BLERSSISensor::unique_id() {
   char buffer[32];
   sprintf(buffer, "ble-%08X%08X-rssi", uint32_t(this->address_ >> 32), uint32_t(this->address_));
   return buffer;
 }
-uint32_t ESP32BLERSSISensor::update_interval() { return this->parent_->get_scan_interval() * 1000u; }
+uint32_t ESP32BLERSSISensor::update_interval() {
+  if (this->parent_->get_report_interval() != 0)
+    return this->parent_->get_report_interval();
+  return this->parent_->get_scan_interval() * 1000u;
+}
+void ESP32BLERSSISensor::set_aggregation(ESP32BLERSSIAggregation aggregation) { this->aggregation_ = aggregation; }
 ESP32BLERSSISensor::ESP32BLERSSISensor(ESP32BLETracker *parent, const std::string &name, uint64_t address)
     : Sensor(name), parent_(parent), address_(address) {}
 uint32_t XiaomiDevice::update_interval() const {
@@ -741,7 +1002,7 @@ ESP32BLEPresenceDevice::ESP32BLEPresenceDevice(const std::string &name, uint64_t
     : BinarySensor(name), address_(address) {}
 std::string ESP32BLEPresenceDevice::device_class() { return "presence"; }
 
-std::string XiaomiSensor::unit_of_measurement() {
+const char *XiaomiSensor::unit_of_measurement() {
   switch (this->type_) {
     case TYPE_TEMPERATURE:
       return sensor::UNIT_C;
@@ -756,7 +1017,7 @@ std::string XiaomiSensor::unit_of_measurement() {
   }
   return "";
 }
-std::string XiaomiSensor::icon() {
+const char *XiaomiSensor::icon() {
   switch (this->type_) {
     case TYPE_TEMPERATURE:
       return sensor::ICON_EMPTY;
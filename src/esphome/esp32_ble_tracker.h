@@ -11,6 +11,8 @@
 
 #include <string>
 #include <array>
+#include <atomic>
+#include <initializer_list>
 #include <esp_gap_ble_api.h>
 #include <esp_bt_defs.h>
 
@@ -21,6 +23,131 @@ class ESP32BLERSSISensor;
 class XiaomiDevice;
 class ESPBTDevice;
 
+/// How the scanner shares the radio with WiFi, as the scan interval and the scan window within each interval.
+enum ESP32BLEScanMode {
+  /// Listen 30ms every 320ms. Misses some advertisements but leaves the radio to WiFi most of the time.
+  BLE_SCAN_MODE_LOW_DUTY = 0,
+  /// Listen 50ms every 160ms.
+  BLE_SCAN_MODE_BALANCED,
+  /// Listen all the time, the esp-idf default. Finds the most devices, but WiFi can become unstable.
+  BLE_SCAN_MODE_CONTINUOUS,
+};
+
+/// A scan result as copied out of the Bluetooth task, with only the parts the tracker needs.
+struct BLEScanResult {
+  esp_bd_addr_t address;
+  esp_ble_addr_type_t address_type;
+  int8_t rssi;
+  /// The advertisement data followed by the scan response data.
+  uint8_t data_len;
+  uint8_t data[ESP_BLE_ADV_DATA_LEN_MAX + ESP_BLE_SCAN_RSP_DATA_LEN_MAX];
+};
+
+static const uint32_t BLE_SCAN_RESULT_QUEUE_SIZE = 32;
+
+/** Single-producer (the Bluetooth task) single-consumer (loop()) queue of scan results.
+ *
+ * The two tasks may run on different cores, so the positions are atomics: the producer only publishes a
+ * slot after it's written, and the consumer only frees it again after it's been read. Nothing blocks,
+ * results that arrive while the queue is full are dropped and counted.
+ */
+class ESP32BLEScanResultQueue {
+ public:
+  /// Copy a scan result into the queue, called from the Bluetooth task.
+  void push(const esp_ble_gap_cb_param_t::ble_scan_result_evt_param &param);
+  /// The oldest result or nullptr if the queue is empty, valid until pop().
+  const BLEScanResult *front() const;
+  void pop();
+  /// The number of results dropped since the last call.
+  uint32_t take_dropped();
+
+ protected:
+  BLEScanResult results_[BLE_SCAN_RESULT_QUEUE_SIZE];
+  /// The next slot to read, only written by the consumer.
+  std::atomic<uint32_t> read_at_{0};
+  /// The next slot to write, only written by the producer.
+  std::atomic<uint32_t> write_at_{0};
+  std::atomic<uint32_t> dropped_{0};
+};
+
+/** An open-addressing hash map from 48-bit MAC addresses to indices.
+ *
+ * Addresses are only ever added, the table is grown to keep its load factor below one half.
+ */
+class BLEAddressMap {
+ public:
+  void insert(uint64_t address, uint16_t index);
+  /// The index of the address, or -1 if it isn't in the map.
+  int find(uint64_t address) const;
+
+ protected:
+  struct Entry {
+    uint64_t address;
+    uint16_t index;
+  };
+  static const uint16_t EMPTY = 0xFFFF;
+
+  void rehash_(size_t table_size);
+  size_t slot_(uint64_t address) const;
+
+  std::vector<Entry> table_;
+  size_t size_{0};
+};
+
+/** A bounded set of MAC addresses that forgets the least recently seen address when it's full.
+ *
+ * Lookups go through an open-addressing hash table of node indices, the nodes form a doubly linked
+ * list in the order they were last seen, so every operation is constant time.
+ */
+class BLEAddressLRU {
+ public:
+  explicit BLEAddressLRU(uint16_t capacity);
+
+  /// Mark the address as seen, returns whether it was seen before.
+  bool touch(uint64_t address);
+  void clear();
+  uint16_t size() const;
+
+ protected:
+  struct Node {
+    uint64_t address;
+    uint16_t prev;
+    uint16_t next;
+  };
+  static const uint16_t NONE = 0xFFFF;
+
+  size_t slot_(uint64_t address) const;
+  /// The table slot holding the address, or -1.
+  int find_slot_(uint64_t address) const;
+  /// Remove a slot from the table, shifting back the entries after it so no tombstones are needed.
+  void erase_slot_(size_t slot);
+  void unlink_(uint16_t node);
+  void push_front_(uint16_t node);
+
+  std::vector<Node> nodes_;
+  std::vector<uint16_t> table_;
+  uint16_t size_{0};
+  /// Most and least recently seen nodes.
+  uint16_t head_{NONE};
+  uint16_t tail_{NONE};
+};
+
+/// All sensors tracking one MAC address and the advertisements seen from it.
+struct BLETrackedDevice {
+  std::vector<ESP32BLEPresenceDevice *> presence_sensors;
+  std::vector<ESP32BLERSSISensor *> rssi_sensors;
+  std::vector<XiaomiDevice *> xiaomi_devices;
+  /// RSSI statistics of the current report window.
+  int32_t rssi_sum{0};
+  int8_t rssi_max{INT8_MIN};
+  uint32_t packet_count{0};
+  /// millis() of the last advertisement, only valid if present.
+  uint32_t last_seen{0};
+  bool present{false};
+  /// Whether the device was seen during the current scan.
+  bool seen_in_scan{false};
+};
+
 /** The ESP32BLETracker class is a hub for all ESP32 Bluetooth Low Energy devices.
  *
  * The implementation uses a lightweight version of the amazing ESP32 BLE Arduino library by
@@ -81,6 +208,28 @@ class ESP32BLETracker : public Component {
    */
   void set_scan_interval(uint32_t scan_interval);
 
+  /// Set how the scanner shares the radio with WiFi, defaults to BLE_SCAN_MODE_LOW_DUTY.
+  void set_scan_mode(ESP32BLEScanMode scan_mode);
+  /** Set the scan interval and window manually, overriding the scan mode.
+   *
+   * Every interval, the scanner listens for the duration of the window. Both are in ms, between 2.5ms
+   * and 10.24s, and the window can be at most as long as the interval.
+   */
+  void set_scan_timing(float interval_ms, float window_ms);
+
+  /** Publish RSSI sensors once per report window instead of for every advertisement, defaults to 10s.
+   *
+   * Beacons often advertise several times per second, so this cuts the number of states sent upstream a lot.
+   * Use 0 to publish every advertisement.
+   */
+  void set_report_interval(uint32_t report_interval);
+  /** Mark presence sensors as away when their device hasn't been seen for this long (in ms).
+   *
+   * The timeouts are checked once per report window. By default (0), presence sensors are marked as away when
+   * a whole scan didn't see their device.
+   */
+  void set_presence_timeout(uint32_t presence_timeout);
+
   // ========== INTERNAL METHODS ==========
   // (In most use cases you won't need these)
   /// Setup the FreeRTOS task and the Bluetooth stack.
@@ -90,6 +239,7 @@ class ESP32BLETracker : public Component {
   void loop() override;
 
   uint32_t get_scan_interval() const;
+  uint32_t get_report_interval() const;
 
  protected:
   /// The FreeRTOS task managing the bluetooth interface.
@@ -105,17 +255,25 @@ class ESP32BLETracker : public Component {
   /// Called when a `ESP_GAP_BLE_SCAN_START_COMPLETE_EVT` event is received.
   void gap_scan_start_complete(const esp_ble_gap_cb_param_t::ble_scan_start_cmpl_evt_param &param);
 
-  void parse_presence_sensors_(const ESPBTDevice &device);
-  void parse_rssi_sensors_(const ESPBTDevice &device);
-  void parse_xiaomi_sensors_(const ESPBTDevice &device);
+  void parse_presence_sensors_(BLETrackedDevice &tracked);
+  void publish_presence_(BLETrackedDevice &tracked, bool present);
+  void parse_rssi_sensors_(const ESPBTDevice &device, BLETrackedDevice &tracked);
+  /// Publish the RSSI of the last window and check the presence timeouts of all tracked devices.
+  void report_();
+  void parse_xiaomi_sensors_(const ESPBTDevice &device, const BLETrackedDevice *tracked);
 
   bool parse_already_discovered_(const ESPBTDevice &device);
-  bool has_already_discovered_(uint64_t address);
 
-  /// An array of MAC addresses discovered during this scan. Used to mark registered devices as undiscovered.
-  std::vector<uint64_t> already_discovered_;
+  /// Get the sensors tracking an address, adding an entry if there is none yet.
+  BLETrackedDevice &get_tracked_(uint64_t address);
+
+  /// MAC addresses discovered during this scan, only used to log each device once.
+  BLEAddressLRU already_discovered_{128};
 
-  /// An array of registered devices to track
+  /// The registered sensors by MAC address and an index into them.
+  std::vector<BLETrackedDevice> tracked_;
+  BLEAddressMap tracked_index_;
+  /// All registered devices to track
   std::vector<ESP32BLEPresenceDevice *> presence_sensors_;
   std::vector<ESP32BLERSSISensor *> rssi_sensors_;
   std::vector<XiaomiDevice *> xiaomi_devices_;
@@ -123,10 +281,17 @@ class ESP32BLETracker : public Component {
   esp_ble_scan_params_t scan_params_;
   /// The interval in seconds to perform scans.
   uint32_t scan_interval_{300};
-  SemaphoreHandle_t scan_result_lock_;
-  SemaphoreHandle_t scan_end_lock_;
-  size_t scan_result_index_{0};
-  esp_ble_gap_cb_param_t::ble_scan_result_evt_param scan_result_buffer_[16];
+  /// Scan interval and window in units of 0.625ms.
+  uint16_t scan_timing_interval_{0x200};
+  uint16_t scan_timing_window_{0x30};
+  uint32_t report_interval_{10000};
+  /// Advertisements processed and dropped since boot.
+  uint32_t advertisements_{0};
+  uint32_t advertisements_dropped_{0};
+  uint32_t presence_timeout_{0};
+  ESP32BLEScanResultQueue scan_results_;
+  /// Set by the Bluetooth task when a scan has finished.
+  std::atomic<bool> scan_ended_{false};
   esp_bt_status_t scan_start_failed_{ESP_BT_STATUS_SUCCESS};
   esp_bt_status_t scan_set_param_failed_{ESP_BT_STATUS_SUCCESS};
 };
@@ -144,12 +309,22 @@ class ESP32BLEPresenceDevice : public binary_sensor::BinarySensor {
   uint64_t address_;
 };
 
+/// How the RSSI of the advertisements in a report window is combined.
+enum ESP32BLERSSIAggregation {
+  BLE_RSSI_MEAN = 0,
+  /// The strongest signal, less affected by reflections and bodies in the way.
+  BLE_RSSI_MAX,
+};
+
 class ESP32BLERSSISensor : public sensor::Sensor {
  public:
   ESP32BLERSSISensor(ESP32BLETracker *parent, const std::string &name, uint64_t address);
 
-  std::string unit_of_measurement() override;
-  std::string icon() override;
+  /// Set how the advertisements of each report window are combined, defaults to the mean.
+  void set_aggregation(ESP32BLERSSIAggregation aggregation);
+
+  const char *unit_of_measurement() override;
+  const char *icon() override;
   int8_t accuracy_decimals() override;
   std::string unique_id() override;
   uint32_t update_interval() override;
@@ -159,6 +334,7 @@ class ESP32BLERSSISensor : public sensor::Sensor {
 
   uint64_t address_;
   ESP32BLETracker *parent_;
+  ESP32BLERSSIAggregation aggregation_{BLE_RSSI_MEAN};
 };
 
 class XiaomiSensor : public sensor::Sensor {
@@ -174,8 +350,8 @@ class XiaomiSensor : public sensor::Sensor {
 
   XiaomiSensor(XiaomiDevice *parent, Type type, const std::string &name);
 
-  std::string unit_of_measurement() override;
-  std::string icon() override;
+  const char *unit_of_measurement() override;
+  const char *icon() override;
   uint32_t update_interval() override;
   int8_t accuracy_decimals() override;
   std::string unique_id() override;
@@ -237,11 +413,22 @@ class ESPBTUUID {
   esp_bt_uuid_t uuid_;
 };
 
+/// A raw AD structure of an advertisement, pointing into the scan result it was found in.
+struct ESPBTAdvRecord {
+  uint8_t type;
+  const uint8_t *data;
+  uint8_t length;
+};
+
+/** A view of a BLE scan result.
+ *
+ * The advertisement data isn't copied or parsed up front: the getters walk the AD structures of the
+ * scan result when they're called, so the scan result must outlive the device. Only the getters returning
+ * strings or vectors allocate, the raw record getters point into the scan result.
+ */
 class ESPBTDevice {
  public:
-  void parse_scan_rst(const esp_ble_gap_cb_param_t::ble_scan_result_evt_param &param);
-
-  void parse_adv(const esp_ble_gap_cb_param_t::ble_scan_result_evt_param &param);
+  void parse_scan_rst(const BLEScanResult &result);
 
   std::string address_str() const;
 
@@ -249,29 +436,29 @@ class ESPBTDevice {
 
   esp_ble_addr_type_t get_address_type() const;
   int get_rssi() const;
-  const std::string &get_name() const;
-  const optional<int8_t> &get_tx_power() const;
-  const optional<uint16_t> &get_appearance() const;
-  const optional<uint8_t> &get_ad_flag() const;
-  const std::vector<ESPBTUUID> &get_service_uuids() const;
-  const std::string &get_manufacturer_data() const;
-  const std::string &get_service_data() const;
-  const optional<ESPBTUUID> &get_service_data_uuid() const;
+  std::string get_name() const;
+  optional<int8_t> get_tx_power() const;
+  optional<uint16_t> get_appearance() const;
+  optional<uint8_t> get_ad_flag() const;
+  std::vector<ESPBTUUID> get_service_uuids() const;
+  std::string get_manufacturer_data() const;
+  std::string get_service_data() const;
+  optional<ESPBTUUID> get_service_data_uuid() const;
+
+  /** Iterate over the AD structures of the advertisement.
+   *
+   * @param offset The position in the advertisement, start with 0.
+   * @param record The record is stored here.
+   * @return Whether there was another record.
+   */
+  bool next_record(size_t *offset, ESPBTAdvRecord *record) const;
+  /// Find the last record of one of the given types.
+  optional<ESPBTAdvRecord> find_record(std::initializer_list<uint8_t> types) const;
+  /// The service data without its UUID.
+  optional<ESPBTAdvRecord> get_service_data_record() const;
 
  protected:
-  esp_bd_addr_t address_{
-      0,
-  };
-  esp_ble_addr_type_t address_type_{BLE_ADDR_TYPE_PUBLIC};
-  int rssi_{0};
-  std::string name_{};
-  optional<int8_t> tx_power_{};
-  optional<uint16_t> appearance_{};
-  optional<uint8_t> ad_flag_{};
-  std::vector<ESPBTUUID> service_uuids_;
-  std::string manufacturer_data_{};
-  std::string service_data_{};
-  optional<ESPBTUUID> service_data_uuid_{};
+  const BLEScanResult *result_{nullptr};
 };
 
 extern ESP32BLETracker *global_esp32_ble_tracker;
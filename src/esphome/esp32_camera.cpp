@@ -9,10 +9,17 @@ ESPHOME_NAMESPACE_BEGIN
 
 static const char *TAG = "esp32_camera";
 
+/// Interval for logging the frame statistics while images are delivered.
+static const uint32_t CAMERA_STATS_INTERVAL = 10000;
+
 void ESP32Camera::setup() {
   global_esp32_camera = this;
 
   this->last_update_ = millis();
+  if (this->config_.fb_count > 1 && !psramFound()) {
+    ESP_LOGW(TAG, "Multiple framebuffers require PSRAM, using only one.");
+    this->config_.fb_count = 1;
+  }
   esp_err_t err = esp_camera_init(&this->config_);
   if (err != ESP_OK) {
     ESP_LOGE(TAG, "esp_camera_init failed: %s", esp_err_to_name(err));
@@ -29,7 +36,8 @@ void ESP32Camera::setup() {
   s->set_saturation(s, this->saturation_);
   s->set_colorbar(s, this->test_pattern_);
   this->framebuffer_get_queue_ = xQueueCreate(1, sizeof(camera_fb_t *));
-  this->framebuffer_return_queue_ = xQueueCreate(1, sizeof(camera_fb_t *));
+  this->framebuffer_return_queue_ = xQueueCreate(this->config_.fb_count, sizeof(camera_fb_t *));
+  this->images_.reserve(this->config_.fb_count);
   xTaskCreatePinnedToCore(&ESP32Camera::framebuffer_task,
                           "framebuffer_task",  // name
                           1024,                // stack size
@@ -96,7 +104,7 @@ void ESP32Camera::dump_config() {
   sensor_t *s = esp_camera_sensor_get();
   auto st = s->status;
   ESP_LOGCONFIG(TAG, "  JPEG Quality: %u", st.quality);
-  // ESP_LOGCONFIG(TAG, "  Framebuffer Count: %u", conf.fb_count);
+  ESP_LOGCONFIG(TAG, "  Framebuffer Count: %u", conf.fb_count);
   ESP_LOGCONFIG(TAG, "  Contrast: %d", st.contrast);
   ESP_LOGCONFIG(TAG, "  Brightness: %d", st.brightness);
   ESP_LOGCONFIG(TAG, "  Saturation: %d", st.saturation);
@@ -121,22 +129,24 @@ void ESP32Camera::dump_config() {
   ESP_LOGCONFIG(TAG, "  Test Pattern: %s", YESNO(st.colorbar));
 }
 void ESP32Camera::loop() {
-  // check if we can return the image
-  if (this->can_return_image_()) {
-    // return image
-    auto *fb = this->current_image_->get_raw_buffer();
-    xQueueSend(this->framebuffer_return_queue_, &fb, portMAX_DELAY);
-    this->current_image_.reset();
+  this->return_images_();
+
+  const uint32_t now = millis();
+  if (this->frames_delivered_ != this->last_stats_delivered_ && now - this->last_stats_ > CAMERA_STATS_INTERVAL) {
+    const float fps = (this->frames_delivered_ - this->last_stats_delivered_) * 1000.0f / (now - this->last_stats_);
+    ESP_LOGD(TAG, "Delivered %.1f fps, capture time %u ms, %u frames dropped", fps, this->capture_time_,
+             this->frames_dropped_);
+    this->last_stats_ = now;
+    this->last_stats_delivered_ = this->frames_delivered_;
   }
 
   // Check if we should fetch a new image
   if (!this->has_requested_image_())
     return;
-  if (this->current_image_.use_count() > 1) {
-    // image is still in use
+  if (this->images_.size() >= this->config_.fb_count) {
+    // all framebuffers are still in use
     return;
   }
-  const uint32_t now = millis();
   if (now - this->last_update_ <= this->max_update_interval_)
     return;
 
@@ -153,21 +163,56 @@ void ESP32Camera::loop() {
     xQueueSend(this->framebuffer_return_queue_, &fb, portMAX_DELAY);
     return;
   }
-  this->current_image_ = std::make_shared<CameraImage>(fb);
+  auto image = std::make_shared<CameraImage>(fb);
+  this->images_.push_back(image);
 
   ESP_LOGD(TAG, "Got Image: %p len=%u width=%u height=%u format=%u", fb->buf, fb->len, fb->width, fb->height,
            fb->format);
-  this->new_image_callback_.call(this->current_image_);
+  this->new_image_callback_.call(image);
+  this->frames_delivered_++;
   this->last_update_ = now;
   this->single_requester_ = false;
 }
+void ESP32Camera::return_images_() {
+  for (auto it = this->images_.begin(); it != this->images_.end();) {
+    if (it->use_count() == 1) {
+      // no consumer is using the image anymore, return it
+      auto *fb = (*it)->get_raw_buffer();
+      xQueueSend(this->framebuffer_return_queue_, &fb, portMAX_DELAY);
+      it = this->images_.erase(it);
+    } else {
+      it++;
+    }
+  }
+}
 void ESP32Camera::framebuffer_task(void *pv) {
+  ESP32Camera *camera = global_esp32_camera;
+  const uint8_t fb_count = camera->config_.fb_count;
+  uint8_t in_use = 0;
+  camera_fb_t *framebuffer;
   while (true) {
-    camera_fb_t *framebuffer = esp_camera_fb_get();
-    xQueueSend(global_esp32_camera->framebuffer_get_queue_, &framebuffer, portMAX_DELAY);
-    // return is no-op for config with 1 fb
-    xQueueReceive(global_esp32_camera->framebuffer_return_queue_, &framebuffer, portMAX_DELAY);
-    esp_camera_fb_return(framebuffer);
+    // Give frames back to the driver, if all framebuffers are in use wait until one is returned.
+    while (xQueueReceive(camera->framebuffer_return_queue_, &framebuffer, in_use >= fb_count ? portMAX_DELAY : 0) ==
+           pdTRUE) {
+      esp_camera_fb_return(framebuffer);
+      in_use--;
+    }
+
+    const uint32_t start = millis();
+    framebuffer = esp_camera_fb_get();
+    camera->capture_time_ = millis() - start;
+    in_use++;
+
+    if (xQueueSend(camera->framebuffer_get_queue_, &framebuffer, 0L) != pdTRUE) {
+      // The last frame hasn't been picked up yet, replace it by the new one (latest frame wins).
+      camera_fb_t *old;
+      if (xQueueReceive(camera->framebuffer_get_queue_, &old, 0L) == pdTRUE) {
+        esp_camera_fb_return(old);
+        in_use--;
+        camera->frames_dropped_++;
+      }
+      xQueueSend(camera->framebuffer_get_queue_, &framebuffer, portMAX_DELAY);
+    }
   }
 }
 ESP32Camera::ESP32Camera(const std::string &name) : Nameable(name) {
@@ -272,7 +317,9 @@ bool ESP32Camera::has_requested_image_() const {
 
   return false;
 }
-bool ESP32Camera::can_return_image_() const { return this->current_image_.use_count() == 1; }
+uint32_t ESP32Camera::get_capture_time() const { return this->capture_time_; }
+uint32_t ESP32Camera::get_frames_delivered() const { return this->frames_delivered_; }
+uint32_t ESP32Camera::get_frames_dropped() const { return this->frames_dropped_; }
 void ESP32Camera::set_max_update_interval(uint32_t max_update_interval) {
   this->max_update_interval_ = max_update_interval;
 }
@@ -280,6 +327,7 @@ void ESP32Camera::set_idle_update_interval(uint32_t idle_update_interval) {
   this->idle_update_interval_ = idle_update_interval;
 }
 void ESP32Camera::set_test_pattern(bool test_pattern) { this->test_pattern_ = test_pattern; }
+void ESP32Camera::set_frame_buffer_count(uint8_t count) { this->config_.fb_count = count; }
 
 ESP32Camera *global_esp32_camera;
 
@@ -71,6 +71,13 @@ class ESP32Camera : public Component, public Nameable {
   void set_max_update_interval(uint32_t max_update_interval);
   void set_idle_update_interval(uint32_t idle_update_interval);
   void set_test_pattern(bool test_pattern);
+  /** Set the number of framebuffers the driver captures into.
+   *
+   * With more than one framebuffer, capturing continues while consumers are still sending the previous
+   * frames. Frames nobody picked up in time are dropped so that consumers always get the latest one.
+   * Requires PSRAM, the framebuffers are allocated there.
+   */
+  void set_frame_buffer_count(uint8_t count);
   void setup() override;
   void loop() override;
   void dump_config() override;
@@ -79,10 +86,18 @@ class ESP32Camera : public Component, public Nameable {
   void request_stream();
   void request_image();
 
+  /// Time it took the driver to deliver the last frame, in ms.
+  uint32_t get_capture_time() const;
+  /// Total number of frames handed to the image callbacks.
+  uint32_t get_frames_delivered() const;
+  /// Total number of captured frames that were dropped because a newer one was available.
+  uint32_t get_frames_dropped() const;
+
  protected:
   uint32_t hash_base() override;
   bool has_requested_image_() const;
-  bool can_return_image_() const;
+  /// Return all images no consumer holds a reference to anymore to the framebuffer task.
+  void return_images_();
 
   static void framebuffer_task(void *pv);
 
@@ -95,7 +110,8 @@ class ESP32Camera : public Component, public Nameable {
   bool test_pattern_{false};
 
   esp_err_t init_error_{ESP_OK};
-  std::shared_ptr<CameraImage> current_image_;
+  /// Images that have been handed out to consumers, each consumer keeps its own reference.
+  std::vector<std::shared_ptr<CameraImage>> images_;
   uint32_t last_stream_request_{0};
   bool single_requester_{false};
   QueueHandle_t framebuffer_get_queue_;
@@ -104,6 +120,11 @@ class ESP32Camera : public Component, public Nameable {
   uint32_t max_update_interval_{1000};
   uint32_t idle_update_interval_{15000};
   uint32_t last_update_{0};
+  volatile uint32_t capture_time_{0};
+  volatile uint32_t frames_dropped_{0};
+  uint32_t frames_delivered_{0};
+  uint32_t last_stats_{0};
+  uint32_t last_stats_delivered_{0};
 };
 
 extern ESP32Camera *global_esp32_camera;
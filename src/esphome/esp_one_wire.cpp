@@ -10,7 +10,7 @@ ESPHOME_NAMESPACE_BEGIN
 const uint8_t ONE_WIRE_ROM_SELECT = 0x55;
 const int ONE_WIRE_ROM_SEARCH = 0xF0;
 
-ESPOneWire::ESPOneWire(GPIOPin *pin) : pin_(pin) {}
+ESPOneWire::ESPOneWire(GPIOPin *pin) : pin_(pin), isr_pin_(pin->to_isr()) {}
 
 bool HOT ESPOneWire::reset() {
   uint8_t retries = 125;
@@ -21,56 +21,63 @@ bool HOT ESPOneWire::reset() {
     if (--retries == 0)
       return false;
     delayMicroseconds(2);
-  } while (!this->pin_->digital_read());
+  } while (!this->isr_pin_->digital_read());
 
-  // Send 480µs LOW TX reset pulse
+  // Send 480µs LOW TX reset pulse, may be longer so interrupts can stay enabled
   this->pin_->pin_mode(OUTPUT);
-  this->pin_->digital_write(false);
+  this->isr_pin_->digital_write(false);
   delayMicroseconds(480);
 
   // Switch into RX mode, letting the pin float
+  disable_interrupts();
   this->pin_->pin_mode(INPUT_PULLUP);
   // after 15µs-60µs wait time, slave pulls low for 60µs-240µs
   // let's have 70µs just in case
   delayMicroseconds(70);
 
-  bool r = !this->pin_->digital_read();
+  bool r = !this->isr_pin_->digital_read();
+  enable_interrupts();
   delayMicroseconds(410);
   return r;
 }
 
 void HOT ESPOneWire::write_bit(bool bit) {
+  // Only the slot itself is timing critical, the bus may idle for any time between slots.
+  disable_interrupts();
   // Initiate write/read by pulling low.
   this->pin_->pin_mode(OUTPUT);
-  this->pin_->digital_write(false);
+  this->isr_pin_->digital_write(false);
 
   // bus sampled within 15µs and 60µs after pulling LOW.
   if (bit) {
     // pull high/release within 15µs
     delayMicroseconds(10);
-    this->pin_->digital_write(true);
+    this->isr_pin_->digital_write(true);
     // in total minimum of 60µs long
     delayMicroseconds(55);
   } else {
     // continue pulling LOW for at least 60µs
     delayMicroseconds(65);
-    this->pin_->digital_write(true);
+    this->isr_pin_->digital_write(true);
     // grace period, 1µs recovery time
     delayMicroseconds(5);
   }
+  enable_interrupts();
 }
 
 bool HOT ESPOneWire::read_bit() {
+  disable_interrupts();
   // Initiate read slot by pulling LOW for at least 1µs
   this->pin_->pin_mode(OUTPUT);
-  this->pin_->digital_write(false);
+  this->isr_pin_->digital_write(false);
   delayMicroseconds(3);
 
   // release bus, we have to sample within 15µs of pulling low
   this->pin_->pin_mode(INPUT_PULLUP);
   delayMicroseconds(10);
 
-  bool r = this->pin_->digital_read();
+  bool r = this->isr_pin_->digital_read();
+  enable_interrupts();
   // read time slot at least 60µs long + 1µs recovery time between slots
   delayMicroseconds(53);
   return r;
@@ -157,7 +164,7 @@ uint64_t HOT ESPOneWire::search() {
       if (!branch) {
         last_zero = id_bit_number;
         if (last_zero < 9) {
-          this->last_discrepancy_ = last_zero;
+          this->last_family_discrepancy_ = last_zero;
         }
       }
     }
@@ -206,6 +213,15 @@ std::vector<uint64_t> ESPOneWire::search_vec() {
 
   return res;
 }
+bool ESPOneWire::verify(uint64_t address) {
+  this->reset_search();
+  // follow the bits of address at every discrepancy, and the 1 branch at the last bit like search() does
+  this->rom_number_ = address;
+  this->last_discrepancy_ = 64;
+  const uint64_t found = this->search();
+  this->reset_search();
+  return found == address;
+}
 void ESPOneWire::skip() {
   this->write8(0xCC);  // skip ROM
 }
@@ -17,6 +17,9 @@ extern const int ONE_WIRE_ROM_SEARCH;
  *
  * It's more or less the same as Arduino's internal library but uses some fancy C++ and 64 bit
  * unsigned integers to make our lives easier.
+ *
+ * Interrupts are only disabled during the timing critical part of each bit slot (and of the reset
+ * presence detection), so callers must not disable interrupts around transactions themselves.
  */
 class ESPOneWire {
  public:
@@ -64,6 +67,13 @@ class ESPOneWire {
   /// Helper that wraps search in a std::vector.
   std::vector<uint64_t> search_vec();
 
+  /** Check whether the device with this address is on the bus, without enumerating all devices.
+   *
+   * Runs a single search pass that follows the bits of address, so it takes about as long as
+   * finding one device. Resets the device search.
+   */
+  bool verify(uint64_t address);
+
   GPIOPin *get_pin();
 
  protected:
@@ -71,6 +81,8 @@ class ESPOneWire {
   inline uint8_t *rom_number8_();
 
   GPIOPin *pin_;
+  /// Register access copy of pin_ for the bit slots, only the pin mode is changed through pin_.
+  ISRInternalGPIOPin *isr_pin_;
   uint8_t last_discrepancy_{0};
   uint8_t last_family_discrepancy_{0};
   bool last_device_flag_{false};
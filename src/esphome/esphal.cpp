@@ -23,12 +23,14 @@ GPIOPin::GPIOPin(uint8_t pin, uint8_t mode, bool inverted)
       mode_(mode),
       inverted_(inverted),
 #ifdef ARDUINO_ARCH_ESP8266
+      gpio_clear_(pin < 16 ? &GPOC : &GP16O),
+      gpio_set_(pin < 16 ? &GPOS : &GP16O),
       gpio_read_(pin < 16 ? &GPI : &GP16I),
       gpio_mask_(pin < 16 ? (1UL << pin) : 1)
 #endif
 #ifdef ARDUINO_ARCH_ESP32
-          gpio_set_(pin < 32 ? &GPIO.out_w1ts : &GPIO.out1_w1ts.val),
       gpio_clear_(pin < 32 ? &GPIO.out_w1tc : &GPIO.out1_w1tc.val),
+      gpio_set_(pin < 32 ? &GPIO.out_w1ts : &GPIO.out1_w1ts.val),
       gpio_read_(pin < 32 ? &GPIO.in : &GPIO.in1.val),
       gpio_mask_(pin < 32 ? (1UL << pin) : (1UL << (pin - 32)))
 #endif
@@ -120,9 +122,6 @@ void GPIOPin::setup() { this->pin_mode(this->mode_); }
 bool ICACHE_RAM_ATTR HOT GPIOPin::digital_read() {
   return bool((*this->gpio_read_) & this->gpio_mask_) != this->inverted_;
 }
-bool ICACHE_RAM_ATTR HOT ISRInternalGPIOPin::digital_read() {
-  return bool((*this->gpio_read_) & this->gpio_mask_) != this->inverted_;
-}
 void ICACHE_RAM_ATTR HOT GPIOPin::digital_write(bool value) {
 #ifdef ARDUINO_ARCH_ESP8266
   if (this->pin_ != 16) {
@@ -147,46 +146,14 @@ void ICACHE_RAM_ATTR HOT GPIOPin::digital_write(bool value) {
   }
 #endif
 }
-void ISRInternalGPIOPin::digital_write(bool value) {
-#ifdef ARDUINO_ARCH_ESP8266
-  if (this->pin_ != 16) {
-    if (value != this->inverted_) {
-      GPOS = this->gpio_mask_;
-    } else {
-      GPOC = this->gpio_mask_;
-    }
-  } else {
-    if (value != this->inverted_) {
-      GP16O |= 1;
-    } else {
-      GP16O &= ~1;
-    }
-  }
-#endif
-#ifdef ARDUINO_ARCH_ESP32
-  if (value != this->inverted_) {
-    (*this->gpio_set_) = this->gpio_mask_;
-  } else {
-    (*this->gpio_clear_) = this->gpio_mask_;
-  }
-#endif
-}
-ISRInternalGPIOPin::ISRInternalGPIOPin(uint8_t pin,
-#ifdef ARDUINO_ARCH_ESP32
-                                       volatile uint32_t *gpio_clear, volatile uint32_t *gpio_set,
-#endif
+ISRInternalGPIOPin::ISRInternalGPIOPin(uint8_t pin, volatile uint32_t *gpio_clear, volatile uint32_t *gpio_set,
                                        volatile uint32_t *gpio_read, uint32_t gpio_mask, bool inverted)
     : pin_(pin),
+      gpio_high_(inverted ? gpio_clear : gpio_set),
+      gpio_low_(inverted ? gpio_set : gpio_clear),
       gpio_read_(gpio_read),
       gpio_mask_(gpio_mask),
-      inverted_(inverted)
-#ifdef ARDUINO_ARCH_ESP32
-      ,
-      gpio_clear_(gpio_clear),
-      gpio_set_(gpio_set)
-#endif
-{
-}
+      inverted_(inverted) {}
 void ICACHE_RAM_ATTR ISRInternalGPIOPin::clear_interrupt() {
 #ifdef ARDUINO_ARCH_ESP8266
   GPIO_REG_WRITE(GPIO_STATUS_W1TC_ADDRESS, this->gpio_mask_);
@@ -258,11 +225,8 @@ void GPIOPin::attach_interrupt_(void (*func)(void *), void *arg, int mode) const
 }
 
 ISRInternalGPIOPin *GPIOPin::to_isr() const {
-  return new ISRInternalGPIOPin(this->pin_,
-#ifdef ARDUINO_ARCH_ESP32
-                                this->gpio_clear_, this->gpio_set_,
-#endif
-                                this->gpio_read_, this->gpio_mask_, this->inverted_);
+  return new ISRInternalGPIOPin(this->pin_, this->gpio_clear_, this->gpio_set_, this->gpio_read_, this->gpio_mask_,
+                                this->inverted_);
 }
 
 ESPHOME_NAMESPACE_END
@@ -29,24 +29,37 @@ ESPHOME_NAMESPACE_BEGIN
 #define LOG_PIN_PATTERN "GPIO%u (Mode: %s%s)"
 #define LOG_PIN_ARGS(pin) (pin)->get_pin(), (pin)->get_pin_mode_name(), ((pin)->is_inverted() ? ", INVERTED" : "")
 
-/// Copy of GPIOPin that is safe to use from ISRs (with no virtual functions)
+/** Copy of GPIOPin that is safe to use from ISRs (with no virtual functions)
+ *
+ * Reads and writes are inlined register accesses with the inversion folded into the precomputed set/clear
+ * registers, so bit-banging drivers can use them in tight loops too. Only valid for internal GPIOs.
+ */
 class ISRInternalGPIOPin {
  public:
-  ISRInternalGPIOPin(uint8_t pin,
-#ifdef ARDUINO_ARCH_ESP32
-                     volatile uint32_t *gpio_clear, volatile uint32_t *gpio_set,
-#endif
+  ISRInternalGPIOPin(uint8_t pin, volatile uint32_t *gpio_clear, volatile uint32_t *gpio_set,
                      volatile uint32_t *gpio_read, uint32_t gpio_mask, bool inverted);
-  bool digital_read();
-  void digital_write(bool value);
+  inline bool ALWAYS_INLINE digital_read() { return bool((*this->gpio_read_) & this->gpio_mask_) != this->inverted_; }
+  inline void ALWAYS_INLINE digital_write(bool value) {
+#ifdef ARDUINO_ARCH_ESP8266
+    if (this->pin_ == 16) {
+      // GPIO16 has no set/clear registers
+      if (value != this->inverted_) {
+        GP16O |= 1;
+      } else {
+        GP16O &= ~1;
+      }
+      return;
+    }
+#endif
+    *(value ? this->gpio_high_ : this->gpio_low_) = this->gpio_mask_;
+  }
   void clear_interrupt();
 
  protected:
   const uint8_t pin_;
-#ifdef ARDUINO_ARCH_ESP32
-  volatile uint32_t *const gpio_clear_;
-  volatile uint32_t *const gpio_set_;
-#endif
+  /// The registers that drive the pin to the logical high and low level, swapped if inverted.
+  volatile uint32_t *const gpio_high_;
+  volatile uint32_t *const gpio_low_;
   volatile uint32_t *const gpio_read_;
   const uint32_t gpio_mask_;
   const bool inverted_;
@@ -90,6 +103,10 @@ class GPIOPin {
 
   template<typename T> void attach_interrupt(void (*func)(T *), T *arg, int mode) const;
 
+  /** Get a non-virtual copy of this pin for ISRs and timing critical bit-banging. The caller owns the copy.
+   *
+   * Only for internal GPIOs, not for pins of I/O expanders.
+   */
   ISRInternalGPIOPin *to_isr() const;
 
  protected:
@@ -97,10 +114,8 @@ class GPIOPin {
 
   const uint8_t pin_;
   const uint8_t mode_;
-#ifdef ARDUINO_ARCH_ESP32
   volatile uint32_t *const gpio_clear_;
   volatile uint32_t *const gpio_set_;
-#endif
   volatile uint32_t *const gpio_read_;
   const uint32_t gpio_mask_;
   const bool inverted_;
@@ -4,6 +4,7 @@
 
 #include "esphome/log.h"
 #include "esphome/helpers.h"
+#include "esphome/metrics.h"
 
 #ifdef USE_ESP8266_PREFERENCES_FLASH
 extern "C" {
@@ -15,11 +16,14 @@ ESPHOME_NAMESPACE_BEGIN
 
 static const char *TAG = "preferences";
 
+/// The longest time deferred saves are held back while new ones keep coming in.
+static const uint32_t PREFERENCES_MAX_DEFER_TIME = 10000;
+
 ESPPreferenceObject::ESPPreferenceObject() : rtc_offset_(0), length_words_(0), type_(0), data_(nullptr) {}
 ESPPreferenceObject::ESPPreferenceObject(size_t rtc_offset, size_t length, uint32_t type)
     : rtc_offset_(rtc_offset), length_words_(length), type_(type) {
-  this->data_ = new uint32_t[this->length_words_ + 1];
-  for (uint32_t i = 0; i < this->length_words_ + 1; i++)
+  this->data_ = new uint32_t[this->length_words_ + 3];
+  for (uint32_t i = 0; i < this->length_words_ + 3; i++)
     this->data_[i] = 0;
 }
 bool ESPPreferenceObject::load_() {
@@ -27,6 +31,13 @@ bool ESPPreferenceObject::load_() {
     ESP_LOGV(TAG, "Load Pref Not initialized!");
     return false;
   }
+  // a deferred (and on the ESP32 a pending) save shares this buffer, write it before reading over it
+#ifdef ARDUINO_ARCH_ESP32
+  global_preferences.sync();
+#else
+  global_preferences.flush_deferred_();
+#endif
+  memset(this->data_, 0, this->length_words_ * 4);
   if (!this->load_internal_())
     return false;
 
@@ -49,6 +60,19 @@ bool ESPPreferenceObject::save_() {
             this->type_, this->calculate_crc_());
   return true;
 }
+void ESPPreferenceObject::defer_save_() {
+  const uint32_t now = millis();
+  global_preferences.last_deferred_save_ = now;
+  for (auto &deferred : global_preferences.deferred_objects_) {
+    if (deferred.data_ == this->data_)
+      return;
+  }
+  if (global_preferences.deferred_objects_.empty())
+    global_preferences.deferred_since_ = now;
+  global_preferences.deferred_objects_.push_back(*this);
+  if (global_preferences.flash_write_interval_ == 0)
+    global_preferences.sync();
+}
 
 #ifdef ARDUINO_ARCH_ESP8266
 
@@ -66,7 +90,8 @@ static inline bool esp_rtc_user_mem_read(uint32_t index, uint32_t *dest) {
 }
 
 #ifdef USE_ESP8266_PREFERENCES_FLASH
-static bool esp8266_preferences_modified = false;
+/// RTC words changed since the last flash write, one bit per word.
+static uint32_t esp8266_flash_dirty[ESP_RTC_USER_MEM_SIZE_WORDS / 32] = {0};
 #endif
 
 static inline bool esp_rtc_user_mem_write(uint32_t index, uint32_t value) {
@@ -80,7 +105,7 @@ static inline bool esp_rtc_user_mem_write(uint32_t index, uint32_t value) {
   auto *ptr = &ESP_RTC_USER_MEM[index];
 #ifdef USE_ESP8266_PREFERENCES_FLASH
   if (*ptr != value) {
-    esp8266_preferences_modified = true;
+    esp8266_flash_dirty[index / 32] |= 1UL << (index % 32);
   }
 #endif
   *ptr = value;
@@ -93,33 +118,123 @@ extern "C" uint32_t _SPIFFS_end;
 static const uint32_t get_esp8266_flash_sector() { return (uint32_t(&_SPIFFS_end) - 0x40200000) / SPI_FLASH_SEC_SIZE; }
 static const uint32_t get_esp8266_flash_address() { return get_esp8266_flash_sector() * SPI_FLASH_SEC_SIZE; }
 
+/* The flash sector is a log of records, each holding a run of RTC words: a header word (magic, RTC offset and
+ * length), the words and a check word. Changes are appended to the erased part of the sector, and only when
+ * it's full is it erased and rewritten with a single record of all RTC words. Thus the sector is erased once
+ * for many saves instead of for every save, and a write only takes as long as its changed words.
+ */
+static const uint32_t ESP8266_FLASH_RECORD_MAGIC = 0xA5;
+static const uint32_t ESP8266_FLASH_SECTOR_WORDS = SPI_FLASH_SEC_SIZE / 4;
+/// Where the next record is written, in words from the start of the sector.
+static uint32_t esp8266_flash_write_pos = 0;
+/// Whether the log is damaged or in the old format and has to be rewritten before appending to it.
+static bool esp8266_flash_needs_compaction = false;
+/// A record is assembled here, as flash writes have to be from word aligned RAM.
+static uint32_t esp8266_flash_record[ESP_RTC_USER_MEM_SIZE_WORDS + 2];
+
+static uint32_t esp8266_flash_record_check(const uint32_t *record, uint32_t length) {
+  uint32_t check = 2166136261UL;
+  for (uint32_t i = 0; i <= length; i++)
+    check = (check ^ record[i]) * 16777619UL;
+  return check;
+}
+static bool esp8266_flash_read(uint32_t pos, uint32_t *dest, uint32_t length) {
+  disable_interrupts();
+  auto res = spi_flash_read(get_esp8266_flash_address() + pos * 4, dest, length * 4);
+  enable_interrupts();
+  return res == SPI_FLASH_RESULT_OK;
+}
+
 static void load_esp8266_flash() {
   ESP_LOGVV(TAG, "Loading preferences from flash...");
+  uint32_t pos = 0;
+  while (pos + 2 <= ESP8266_FLASH_SECTOR_WORDS) {
+    uint32_t *record = esp8266_flash_record;
+    if (!esp8266_flash_read(pos, record, 1) || record[0] == 0xFFFFFFFF)
+      break;
+    const uint32_t offset = (record[0] >> 16) & 0xFF;
+    const uint32_t length = (record[0] >> 8) & 0xFF;
+    if ((record[0] >> 24) != ESP8266_FLASH_RECORD_MAGIC || length == 0 ||
+        offset + length > ESP_RTC_USER_MEM_SIZE_WORDS || pos + length + 2 > ESP8266_FLASH_SECTOR_WORDS) {
+      if (pos == 0) {
+        // written by an older version as a plain copy of the RTC memory
+        esp8266_flash_read(0, ESP_RTC_USER_MEM, ESP_RTC_USER_MEM_SIZE_WORDS);
+      }
+      esp8266_flash_needs_compaction = true;
+      break;
+    }
+    if (!esp8266_flash_read(pos + 1, record + 1, length + 1) ||
+        record[length + 1] != esp8266_flash_record_check(record, length)) {
+      // interrupted write, the records before it are still good
+      esp8266_flash_needs_compaction = true;
+      break;
+    }
+    for (uint32_t i = 0; i < length; i++)
+      ESP_RTC_USER_MEM[offset + i] = record[i + 1];
+    pos += length + 2;
+  }
+  esp8266_flash_write_pos = pos;
+  ESP_LOGV(TAG, "Preferences log uses %u of %u words", pos, ESP8266_FLASH_SECTOR_WORDS);
+}
+/// Append a record of the RTC words [offset, offset+length) to the log, returns false if it doesn't fit.
+static bool append_esp8266_flash(uint32_t offset, uint32_t length) {
+  if (esp8266_flash_needs_compaction || esp8266_flash_write_pos + length + 2 > ESP8266_FLASH_SECTOR_WORDS)
+    return false;
+
+  uint32_t *record = esp8266_flash_record;
+  record[0] = (ESP8266_FLASH_RECORD_MAGIC << 24) | (offset << 16) | (length << 8);
+  for (uint32_t i = 0; i < length; i++)
+    record[i + 1] = ESP_RTC_USER_MEM[offset + i];
+  record[length + 1] = esp8266_flash_record_check(record, length);
+
   disable_interrupts();
-  spi_flash_read(get_esp8266_flash_address(), ESP_RTC_USER_MEM, ESP_RTC_USER_MEM_SIZE_BYTES);
+  auto write_res =
+      spi_flash_write(get_esp8266_flash_address() + esp8266_flash_write_pos * 4, record, (length + 2) * 4);
   enable_interrupts();
+  // the space is used even if the write failed
+  esp8266_flash_write_pos += length + 2;
+  if (write_res != SPI_FLASH_RESULT_OK) {
+    ESP_LOGV(TAG, "Write ESP8266 flash failed!");
+    esp8266_flash_needs_compaction = true;
+    return false;
+  }
+  return true;
 }
-static void save_esp8266_flash() {
-  if (!esp8266_preferences_modified)
-    return;
-
-  ESP_LOGVV(TAG, "Saving preferences to flash...");
+/// Erase the sector and start it with a record of all RTC words.
+static void compact_esp8266_flash() {
+  ESP_LOGV(TAG, "Compacting preferences log...");
   disable_interrupts();
   auto erase_res = spi_flash_erase_sector(get_esp8266_flash_sector());
+  enable_interrupts();
   if (erase_res != SPI_FLASH_RESULT_OK) {
-    enable_interrupts();
     ESP_LOGV(TAG, "Erase ESP8266 flash failed!");
     return;
   }
-
-  auto write_res = spi_flash_write(get_esp8266_flash_address(), ESP_RTC_USER_MEM, ESP_RTC_USER_MEM_SIZE_BYTES);
-  enable_interrupts();
-  if (write_res != SPI_FLASH_RESULT_OK) {
-    ESP_LOGV(TAG, "Write ESP8266 flash failed!");
-    return;
+  esp8266_flash_write_pos = 0;
+  esp8266_flash_needs_compaction = false;
+  append_esp8266_flash(0, ESP_RTC_USER_MEM_SIZE_WORDS);
+}
+static void save_esp8266_flash() {
+  // write each run of changed words as a record
+  uint32_t index = 0;
+  while (index < ESP_RTC_USER_MEM_SIZE_WORDS) {
+    if ((esp8266_flash_dirty[index / 32] & (1UL << (index % 32))) == 0) {
+      index++;
+      continue;
+    }
+    uint32_t end = index;
+    while (end < ESP_RTC_USER_MEM_SIZE_WORDS && (esp8266_flash_dirty[end / 32] & (1UL << (end % 32))) != 0)
+      end++;
+
+    if (!append_esp8266_flash(index, end - index)) {
+      // the full record written by the compaction includes all remaining changes
+      compact_esp8266_flash();
+      break;
+    }
+    index = end;
   }
-
-  esp8266_preferences_modified = false;
+  for (auto &dirty : esp8266_flash_dirty)
+    dirty = 0;
 }
 #endif
 
@@ -130,7 +245,12 @@ bool ESPPreferenceObject::save_internal_() {
   }
 
 #ifdef USE_ESP8266_PREFERENCES_FLASH
-  save_esp8266_flash();
+  for (auto dirty : esp8266_flash_dirty) {
+    if (dirty != 0) {
+      global_preferences.mark_pending_();
+      break;
+    }
+  }
 #endif
   return true;
 }
@@ -150,6 +270,23 @@ ESPPreferences::ESPPreferences()
 void ESPPreferences::begin(const std::string &name) {
 #ifdef USE_ESP8266_PREFERENCES_FLASH
   load_esp8266_flash();
+#endif
+  // the deferred saves are only in RAM, the RTC memory keeps them over a deep sleep once written
+  add_shutdown_hook([this](const char *cause) { this->sync(); });
+#ifdef USE_METRICS
+  global_metrics.register_counter("preferences_commits_total", "Writes of the pending preferences to flash.",
+                                  [this]() { return this->commits_; });
+#endif
+}
+void ESPPreferences::sync() {
+  this->flush_deferred_();
+  if (!this->pending_)
+    return;
+  this->pending_ = false;
+  this->commits_++;
+#ifdef USE_ESP8266_PREFERENCES_FLASH
+  ESP_LOGVV(TAG, "Saving preferences to flash...");
+  save_esp8266_flash();
 #endif
 }
 
@@ -188,14 +325,18 @@ bool ESPPreferences::is_prevent_write() { return this->prevent_write_; }
 
 #ifdef ARDUINO_ARCH_ESP32
 bool ESPPreferenceObject::save_internal_() {
-  char key[32];
-  sprintf(key, "%u", this->rtc_offset_);
-  uint32_t len = (this->length_words_ + 1) * 4;
-  size_t ret = global_preferences.preferences_.putBytes(key, this->data_, len);
-  if (ret != len) {
-    ESP_LOGV(TAG, "putBytes failed!");
-    return false;
+  uint32_t *committed = &this->data_[this->length_words_ + 1];
+  if (committed[1] != 0 && committed[0] == this->data_[this->length_words_]) {
+    // same value as in NVS
+    return true;
+  }
+
+  for (auto &pending : global_preferences.pending_objects_) {
+    if (pending.data_ == this->data_)
+      return true;
   }
+  global_preferences.pending_objects_.push_back(*this);
+  global_preferences.mark_pending_();
   return true;
 }
 bool ESPPreferenceObject::load_internal_() {
@@ -207,6 +348,8 @@ bool ESPPreferenceObject::load_internal_() {
     ESP_LOGV(TAG, "getBytes failed!");
     return false;
   }
+  this->data_[this->length_words_ + 1] = this->data_[this->length_words_];
+  this->data_[this->length_words_ + 2] = 1;
   return true;
 }
 ESPPreferences::ESPPreferences() : current_offset_(0) {}
@@ -214,6 +357,33 @@ void ESPPreferences::begin(const std::string &name) {
   const std::string key = truncate_string(name, 15);
   ESP_LOGV(TAG, "Opening preferences with key '%s'", key.c_str());
   this->preferences_.begin(key.c_str());
+  add_shutdown_hook([this](const char *cause) { this->sync(); });
+#ifdef USE_METRICS
+  global_metrics.register_counter("preferences_commits_total", "Writes of the pending preferences to flash.",
+                                  [this]() { return this->commits_; });
+#endif
+}
+void ESPPreferences::sync() {
+  this->flush_deferred_();
+  if (!this->pending_)
+    return;
+  this->pending_ = false;
+  this->commits_++;
+
+  ESP_LOGVV(TAG, "Saving %u preferences to NVS...", this->pending_objects_.size());
+  for (auto &pref : this->pending_objects_) {
+    char key[32];
+    sprintf(key, "%u", pref.rtc_offset_);
+    uint32_t len = (pref.length_words_ + 1) * 4;
+    size_t ret = this->preferences_.putBytes(key, pref.data_, len);
+    if (ret != len) {
+      ESP_LOGV(TAG, "putBytes failed!");
+      continue;
+    }
+    pref.data_[pref.length_words_ + 1] = pref.data_[pref.length_words_];
+    pref.data_[pref.length_words_ + 2] = 1;
+  }
+  this->pending_objects_.clear();
 }
 
 ESPPreferenceObject ESPPreferences::make_preference(size_t length, uint32_t type) {
@@ -231,6 +401,40 @@ uint32_t ESPPreferenceObject::calculate_crc_() const {
 }
 bool ESPPreferenceObject::is_initialized() const { return this->data_ != nullptr; }
 
+void ESPPreferences::set_flash_write_interval(uint32_t flash_write_interval) {
+  this->flash_write_interval_ = flash_write_interval;
+}
+void ESPPreferences::mark_pending_() {
+  if (!this->pending_)
+    this->pending_since_ = millis();
+  this->pending_ = true;
+  if (this->flash_write_interval_ == 0)
+    this->sync();
+}
+void ESPPreferences::flush_deferred_() {
+  if (this->deferred_objects_.empty())
+    return;
+  ESP_LOGVV(TAG, "Writing %u deferred saves...", this->deferred_objects_.size());
+  // saving may sync (with a flash write interval of 0), which flushes again
+  std::vector<ESPPreferenceObject> deferred;
+  deferred.swap(this->deferred_objects_);
+  for (auto &pref : deferred)
+    pref.save_();
+}
+void ESPPreferences::loop() {
+  const uint32_t now = millis();
+  if (!this->deferred_objects_.empty()) {
+    // wait until the saves stop, but don't hold back a steady stream of them forever
+    if (now - this->last_deferred_save_ >= this->flash_write_interval_ ||
+        now - this->deferred_since_ >= PREFERENCES_MAX_DEFER_TIME)
+      // the writes are committed right away, the quiet period already collected them
+      this->sync();
+    return;
+  }
+  if (this->pending_ && now - this->pending_since_ >= this->flash_write_interval_)
+    this->sync();
+}
+
 ESPPreferences global_preferences;
 
 ESPHOME_NAMESPACE_END
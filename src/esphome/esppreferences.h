@@ -2,6 +2,7 @@
 #define ESPHOME_ESPPREFERENCES_H
 
 #include <string>
+#include <vector>
 
 #ifdef ARDUINO_ARCH_ESP32
 #include <Preferences.h>
@@ -19,12 +20,23 @@ class ESPPreferenceObject {
 
   template<typename T> bool save(T *src);
 
+  /** Save src once no deferred save happened for the flash write interval, for restore states that change in
+   * bursts (for example a scene that sets many lights).
+   *
+   * The value is copied right away, but computing its CRC and writing it are deferred, so that all deferred saves
+   * are written (and committed to flash) together. They're also written on shutdown and before a load.
+   */
+  template<typename T> bool save_deferred(T *src);
+
   template<typename T> bool load(T *dest);
 
   bool is_initialized() const;
 
  protected:
+  friend class ESPPreferences;
+
   bool save_();
+  void defer_save_();
   bool load_();
   bool save_internal_();
   bool load_internal_();
@@ -34,6 +46,7 @@ class ESPPreferenceObject {
   size_t rtc_offset_;
   size_t length_words_;
   uint32_t type_;
+  /// The data words followed by the CRC. On the ESP32 also the CRC last written to NVS and whether it's valid.
   uint32_t *data_;
 };
 
@@ -56,12 +69,40 @@ class ESPPreferences {
   bool is_prevent_write();
 #endif
 
+  /** Set how long changes are collected before they're written to flash in ms, defaults to 1000ms.
+   *
+   * All saves within this time are combined into a single flash write and saves that don't change the
+   * stored value aren't written at all. Pending changes are also written when the node shuts down.
+   * On the ESP8266 this only applies when preferences are stored in flash (USE_ESP8266_PREFERENCES_FLASH).
+   */
+  void set_flash_write_interval(uint32_t flash_write_interval);
+  /// Write all pending changes to flash now.
+  void sync();
+  /// Write pending changes once the flash write interval has passed, called from the application loop.
+  void loop();
+
  protected:
   friend ESPPreferenceObject;
 
+  /// Note that there are changes to write to flash.
+  void mark_pending_();
+  /// Save the objects of save_deferred() now.
+  void flush_deferred_();
+
   uint32_t current_offset_;
+  uint32_t flash_write_interval_{1000};
+  uint32_t pending_since_{0};
+  /// Number of times the pending preferences were written to flash.
+  uint32_t commits_{0};
+  bool pending_{false};
+  /// Objects with a deferred save, they share their buffers with the objects of the components.
+  std::vector<ESPPreferenceObject> deferred_objects_;
+  uint32_t deferred_since_{0};
+  uint32_t last_deferred_save_{0};
 #ifdef ARDUINO_ARCH_ESP32
   Preferences preferences_;
+  /// Objects saved since the last sync, they share their buffers with the objects of the components.
+  std::vector<ESPPreferenceObject> pending_objects_;
 #endif
 #ifdef ARDUINO_ARCH_ESP8266
   bool prevent_write_{false};
@@ -82,8 +123,16 @@ template<typename T> bool ESPPreferenceObject::save(T *src) {
   return this->save_();
 }
 
-template<typename T> bool ESPPreferenceObject::load(T *dest) {
+template<typename T> bool ESPPreferenceObject::save_deferred(T *src) {
+  if (!this->is_initialized())
+    return false;
   memset(this->data_, 0, this->length_words_ * 4);
+  memcpy(this->data_, src, sizeof(T));
+  this->defer_save_();
+  return true;
+}
+
+template<typename T> bool ESPPreferenceObject::load(T *dest) {
   if (!this->load_())
     return false;
 
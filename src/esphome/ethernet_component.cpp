@@ -19,6 +19,9 @@ ESPHOME_NAMESPACE_BEGIN
 
 static const char *TAG = "ethernet";
 
+/// The interval for the throughput averages.
+static const uint32_t ETHERNET_THROUGHPUT_INTERVAL = 60000;
+
 EthernetComponent *global_eth_component;
 
 EthernetComponent::EthernetComponent() { global_eth_component = this; }
@@ -35,6 +38,8 @@ void EthernetComponent::setup() {
   this->start_connect_();
 
   network_setup_mdns();
+
+  this->set_interval("throughput", ETHERNET_THROUGHPUT_INTERVAL, [this]() { this->update_throughput_(); });
 }
 void EthernetComponent::loop() {
   const uint32_t now = millis();
@@ -52,10 +57,12 @@ void EthernetComponent::loop() {
     // connection established
     ESP_LOGI(TAG, "Connected via Ethernet!");
     this->dump_connect_params_();
+    this->hook_netif_();
     this->status_clear_warning();
   } else {
     // connection lost
     ESP_LOGW(TAG, "Connection via Ethernet lost! Re-connecting...");
+    this->link_down_count_++;
     this->start_connect_();
   }
 
@@ -145,7 +152,7 @@ void EthernetComponent::start_connect_() {
   this->eth_config.phy_addr = static_cast<eth_phy_base_t>(this->phy_addr_);
   this->eth_config.clock_mode = this->clk_mode_;
   this->eth_config.gpio_config = EthernetComponent::eth_phy_config_gpio_;
-  this->eth_config.tcpip_input = tcpip_adapter_eth_input;
+  this->eth_config.tcpip_input = EthernetComponent::eth_input_;
 
   if (this->power_pin_ != nullptr) {
     this->orig_power_enable_fun_ = this->eth_config.phy_power_enable;
@@ -214,6 +221,38 @@ void EthernetComponent::eth_phy_power_enable_(bool enable) {
   delay(1);
   global_eth_component->orig_power_enable_fun_(enable);
 }
+esp_err_t EthernetComponent::eth_input_(void *buffer, uint16_t len, void *eb) {
+  // runs in the EMAC task, only this task writes the rx counters
+  global_eth_component->rx_packets_++;
+  global_eth_component->rx_bytes_ += len;
+  return tcpip_adapter_eth_input(buffer, len, eb);
+}
+err_t EthernetComponent::eth_linkoutput_(struct netif *netif, struct pbuf *p) {
+  // runs in the lwIP task, only this task writes the tx counters
+  global_eth_component->tx_packets_++;
+  global_eth_component->tx_bytes_ += p->tot_len;
+  return global_eth_component->orig_linkoutput_(netif, p);
+}
+void EthernetComponent::hook_netif_() {
+  if (this->orig_linkoutput_ != nullptr)
+    return;
+  struct netif *netif = nullptr;
+  if (tcpip_adapter_get_netif(TCPIP_ADAPTER_IF_ETH, reinterpret_cast<void **>(&netif)) != ESP_OK || netif == nullptr)
+    return;
+  this->orig_linkoutput_ = netif->linkoutput;
+  netif->linkoutput = EthernetComponent::eth_linkoutput_;
+}
+void EthernetComponent::update_throughput_() {
+  const uint32_t rx_bytes = this->rx_bytes_;
+  const uint32_t tx_bytes = this->tx_bytes_;
+  const float seconds = ETHERNET_THROUGHPUT_INTERVAL / 1000.0f;
+  this->rx_throughput_ = (rx_bytes - this->last_rx_bytes_) / seconds;
+  this->tx_throughput_ = (tx_bytes - this->last_tx_bytes_) / seconds;
+  this->last_rx_bytes_ = rx_bytes;
+  this->last_tx_bytes_ = tx_bytes;
+  ESP_LOGV(TAG, "Throughput: RX %.1f kB/s, TX %.1f kB/s", this->rx_throughput_ / 1000.0f,
+           this->tx_throughput_ / 1000.0f);
+}
 bool EthernetComponent::is_connected() { return this->connected_ && this->last_connected_; }
 void EthernetComponent::dump_connect_params_() {
   tcpip_adapter_ip_info_t ip;
@@ -232,7 +271,10 @@ void EthernetComponent::dump_connect_params_() {
   ESP_LOGCONFIG(TAG, "  MAC Address: %02X:%02X:%02X:%02X:%02X:%02X", mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
   ESP_LOGCONFIG(TAG, "  Is Full Duplex: %s", YESNO(this->eth_config.phy_get_duplex_mode()));
   ESP_LOGCONFIG(TAG, "  Link Up: %s", YESNO(this->eth_config.phy_check_link()));
-  ESP_LOGCONFIG(TAG, "  Link Speed: %u", this->eth_config.phy_get_speed_mode() ? 100 : 10);
+  ESP_LOGCONFIG(TAG, "  Link Speed: %u", this->get_link_speed());
+  ESP_LOGCONFIG(TAG, "  Link Down Count: %u", this->link_down_count_);
+  ESP_LOGCONFIG(TAG, "  RX: %u packets, %u bytes", this->rx_packets_, this->rx_bytes_);
+  ESP_LOGCONFIG(TAG, "  TX: %u packets, %u bytes", this->tx_packets_, this->tx_bytes_);
 }
 void EthernetComponent::set_phy_addr(uint8_t phy_addr) { this->phy_addr_ = phy_addr; }
 void EthernetComponent::set_power_pin(const GPIOOutputPin &power_pin) { this->power_pin_ = power_pin.copy(); }
@@ -248,6 +290,15 @@ std::string EthernetComponent::get_use_address() const {
   return this->use_address_;
 }
 void EthernetComponent::set_use_address(const std::string &use_address) { this->use_address_ = use_address; }
+uint32_t EthernetComponent::get_rx_packets() const { return this->rx_packets_; }
+uint32_t EthernetComponent::get_tx_packets() const { return this->tx_packets_; }
+uint32_t EthernetComponent::get_rx_bytes() const { return this->rx_bytes_; }
+uint32_t EthernetComponent::get_tx_bytes() const { return this->tx_bytes_; }
+float EthernetComponent::get_rx_throughput() const { return this->rx_throughput_; }
+float EthernetComponent::get_tx_throughput() const { return this->tx_throughput_; }
+uint32_t EthernetComponent::get_link_down_count() const { return this->link_down_count_; }
+uint8_t EthernetComponent::get_link_speed() { return this->eth_config.phy_get_speed_mode() ? 100 : 10; }
+bool EthernetComponent::is_full_duplex() { return this->eth_config.phy_get_duplex_mode(); }
 
 ESPHOME_NAMESPACE_END
 
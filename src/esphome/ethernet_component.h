@@ -8,6 +8,7 @@
 #include "esphome/component.h"
 #include "esphome/wifi_component.h"
 #include "esp_eth.h"
+#include <lwip/netif.h>
 
 ESPHOME_NAMESPACE_BEGIN
 
@@ -38,13 +39,34 @@ class EthernetComponent : public Component {
   std::string get_use_address() const;
   void set_use_address(const std::string &use_address);
 
+  /// The frames received and sent since boot, the counters wrap around.
+  uint32_t get_rx_packets() const;
+  uint32_t get_tx_packets() const;
+  /// The bytes received and sent since boot, the counters wrap around.
+  uint32_t get_rx_bytes() const;
+  uint32_t get_tx_bytes() const;
+  /// The average throughput of the last minute in bytes per second.
+  float get_rx_throughput() const;
+  float get_tx_throughput() const;
+  /// How often the link went down since boot.
+  uint32_t get_link_down_count() const;
+  /// The negotiated link speed in Mbit/s.
+  uint8_t get_link_speed();
+  bool is_full_duplex();
+
  protected:
   void on_wifi_event_(system_event_id_t event, system_event_info_t info);
   void start_connect_();
   void dump_connect_params_();
 
+  /// Count the traffic once the interface is up, this wraps the output function of its netif.
+  void hook_netif_();
+  void update_throughput_();
+
   static void eth_phy_config_gpio_();
   static void eth_phy_power_enable_(bool enable);
+  static esp_err_t eth_input_(void *buffer, uint16_t len, void *eb);
+  static err_t eth_linkoutput_(struct netif *netif, struct pbuf *p);
 
   std::string use_address_;
   uint8_t phy_addr_{0};
@@ -61,6 +83,17 @@ class EthernetComponent : public Component {
   uint32_t connect_begin_;
   eth_config_t eth_config;
   eth_phy_power_enable_func orig_power_enable_fun_;
+  netif_linkoutput_fn orig_linkoutput_{nullptr};
+
+  volatile uint32_t rx_packets_{0};
+  volatile uint32_t tx_packets_{0};
+  volatile uint32_t rx_bytes_{0};
+  volatile uint32_t tx_bytes_{0};
+  uint32_t link_down_count_{0};
+  uint32_t last_rx_bytes_{0};
+  uint32_t last_tx_bytes_{0};
+  float rx_throughput_{0.0f};
+  float tx_throughput_{0.0f};
 };
 
 extern EthernetComponent *global_eth_component;
@@ -14,6 +14,7 @@ static const char *TAG = "fan.state";
 
 const FanTraits &FanState::get_traits() const { return this->traits_; }
 void FanState::set_traits(const FanTraits &traits) { this->traits_ = traits; }
+void FanState::set_command_window(uint32_t command_window) { this->command_window_ = command_window; }
 void FanState::add_on_state_callback(std::function<void()> &&callback) {
   this->state_callback_.add(std::move(callback));
 }
@@ -21,7 +22,10 @@ FanState::FanState(const std::string &name) : Nameable(name) {}
 
 FanState::StateCall FanState::turn_on() { return this->make_call().set_state(true); }
 FanState::StateCall FanState::turn_off() { return this->make_call().set_state(false); }
-FanState::StateCall FanState::toggle() { return this->make_call().set_state(!this->state); }
+FanState::StateCall FanState::toggle() {
+  // toggle the state a pending call will set, so that two toggles in one window cancel out
+  return this->make_call().set_state(!this->pending_state_.value_or(this->state));
+}
 FanState::StateCall FanState::make_call() { return FanState::StateCall(this); }
 
 struct FanStateRTCState {
@@ -36,14 +40,38 @@ void FanState::setup() {
   if (!this->rtc_.load(&recovered))
     return;
 
-  auto call = this->make_call();
-  call.set_state(recovered.state);
-  call.set_speed(recovered.speed);
-  call.set_oscillating(recovered.oscillating);
-  call.perform();
+  this->apply_(recovered.state, recovered.oscillating, recovered.speed);
 }
 float FanState::get_setup_priority() const { return setup_priority::HARDWARE - 1.0f; }
 uint32_t FanState::hash_base() { return 418001110UL; }
+void FanState::apply_(optional<bool> state, optional<bool> oscillating, optional<FanSpeed> speed) {
+  if (state.has_value()) {
+    this->state = *state;
+  }
+  if (oscillating.has_value()) {
+    this->oscillating = *oscillating;
+  }
+  if (speed.has_value()) {
+    switch (*speed) {
+      case FAN_SPEED_LOW:
+      case FAN_SPEED_MEDIUM:
+      case FAN_SPEED_HIGH:
+        this->speed = *speed;
+        break;
+      default:
+        // protect from invalid input
+        break;
+    }
+  }
+
+  FanStateRTCState saved;
+  saved.state = this->state;
+  saved.speed = this->speed;
+  saved.oscillating = this->oscillating;
+  this->rtc_.save_deferred(&saved);
+
+  this->state_callback_.call();
+}
 #ifdef USE_MQTT_FAN
 MQTTFanComponent *FanState::get_mqtt() const { return this->mqtt_; }
 void FanState::set_mqtt(MQTTFanComponent *mqtt) { this->mqtt_ = mqtt; }
@@ -75,32 +103,32 @@ FanState::StateCall &FanState::StateCall::set_speed(optional<FanSpeed> speed) {
   return *this;
 }
 void FanState::StateCall::perform() const {
-  if (this->binary_state_.has_value()) {
-    this->state_->state = *this->binary_state_;
-  }
-  if (this->oscillating_.has_value()) {
-    this->state_->oscillating = *this->oscillating_;
-  }
-  if (this->speed_.has_value()) {
-    switch (*this->speed_) {
-      case FAN_SPEED_LOW:
-      case FAN_SPEED_MEDIUM:
-      case FAN_SPEED_HIGH:
-        this->state_->speed = *this->speed_;
-        break;
-      default:
-        // protect from invalid input
-        break;
-    }
+  FanState *state = this->state_;
+  if (state->command_window_ == 0) {
+    state->apply_(this->binary_state_, this->oscillating_, this->speed_);
+    return;
   }
 
-  FanStateRTCState saved;
-  saved.state = this->state_->state;
-  saved.speed = this->state_->speed;
-  saved.oscillating = this->state_->oscillating;
-  this->state_->rtc_.save(&saved);
-
-  this->state_->state_callback_.call();
+  if (this->binary_state_.has_value())
+    state->pending_state_ = this->binary_state_;
+  if (this->oscillating_.has_value())
+    state->pending_oscillating_ = this->oscillating_;
+  if (this->speed_.has_value())
+    state->pending_speed_ = this->speed_;
+  if (state->command_pending_)
+    return;
+  // the window isn't extended by later calls, so the fan follows a long burst of calls with a bounded delay
+  state->command_pending_ = true;
+  state->set_timeout("command", state->command_window_, [state]() {
+    state->command_pending_ = false;
+    auto binary_state = state->pending_state_;
+    auto oscillating = state->pending_oscillating_;
+    auto speed = state->pending_speed_;
+    state->pending_state_.reset();
+    state->pending_oscillating_.reset();
+    state->pending_speed_.reset();
+    state->apply_(binary_state, oscillating, speed);
+  });
 }
 FanState::StateCall &FanState::StateCall::set_speed(const char *speed) {
   if (strcasecmp(speed, "low") == 0) {
@@ -48,6 +48,12 @@ class FanState : public Nameable, public Component {
   const FanTraits &get_traits() const;
   /// Set the traits of this fan (i.e. what features it supports).
   void set_traits(const FanTraits &traits);
+  /** Coalesce the calls performed within command_window ms, for example while a speed slider is dragged.
+   *
+   * The latest value of each field wins, and the fan is only updated (and its state saved and published) once at
+   * the end of the window. Defaults to 0 (apply each call right away).
+   */
+  void set_command_window(uint32_t command_window);
 
   template<typename... Ts> TurnOnAction<Ts...> *make_turn_on_action();
   template<typename... Ts> TurnOffAction<Ts...> *make_turn_off_action();
@@ -96,10 +102,18 @@ class FanState : public Nameable, public Component {
 
  protected:
   uint32_t hash_base() override;
+  /// Apply the fields that are set, save the state and notify the output and the front-ends.
+  void apply_(optional<bool> state, optional<bool> oscillating, optional<FanSpeed> speed);
 
   FanTraits traits_{};
   CallbackManager<void()> state_callback_{};
   ESPPreferenceObject rtc_;
+  uint32_t command_window_{0};
+  /// The merged calls of the current command window, applied when it ends.
+  bool command_pending_{false};
+  optional<bool> pending_state_{};
+  optional<bool> pending_oscillating_{};
+  optional<FanSpeed> pending_speed_{};
 #ifdef USE_MQTT_FAN
   MQTTFanComponent *mqtt_{nullptr};
 #endif
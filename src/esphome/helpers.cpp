@@ -1,10 +1,15 @@
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <algorithm>
 
 #ifdef ARDUINO_ARCH_ESP8266
 #include <ESP8266WiFi.h>
 #else
 #include <Esp.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 #endif
 
 #include "esphome/espmath.h"
@@ -117,6 +122,13 @@ void ExponentialMovingAverage::set_alpha(float alpha) { this->alpha_ = alpha; }
 
 float ExponentialMovingAverage::calculate_average() { return this->accumulator_; }
 
+bool ExponentialMovingAverage::has_value() const { return !this->first_value_; }
+
+void ExponentialMovingAverage::set_average(float average) {
+  this->accumulator_ = average;
+  this->first_value_ = false;
+}
+
 float ExponentialMovingAverage::next_value(float value) {
   if (std::isnan(value)) {
     return this->calculate_average();
@@ -131,45 +143,226 @@ float ExponentialMovingAverage::next_value(float value) {
   return this->calculate_average();
 }
 
-SlidingWindowMovingAverage::SlidingWindowMovingAverage(size_t max_size) : max_size_(max_size), sum_(0) {}
+SlidingWindowMovingAverage::SlidingWindowMovingAverage(size_t max_size) : window_(max_size), sum_(0) {}
 
 float SlidingWindowMovingAverage::next_value(float value) {
   if (std::isnan(value))
     return this->calculate_average();
-  if (this->queue_.size() == this->max_size_) {
-    this->sum_ -= this->queue_.front();
-    this->queue_.pop();
-  }
-  this->queue_.push(value);
+  if (this->window_.full())
+    this->sum_ -= this->window_.front();
+  this->window_.push(value);
   this->sum_ += value;
+  if (++this->since_recalculate_ >= this->window_.capacity())
+    this->recalculate_sum_();
 
   return this->calculate_average();
 }
 
 float SlidingWindowMovingAverage::calculate_average() {
-  if (this->queue_.empty())
+  if (this->window_.empty())
     return 0;
   else
-    return this->sum_ / this->queue_.size();
+    return this->sum_ / this->window_.size();
 }
 
-size_t SlidingWindowMovingAverage::get_max_size() const { return this->max_size_; }
+size_t SlidingWindowMovingAverage::get_max_size() const { return this->window_.capacity(); }
 
 void SlidingWindowMovingAverage::set_max_size(size_t max_size) {
-  this->max_size_ = max_size;
+  this->window_.set_capacity(max_size);
+  this->recalculate_sum_();
+}
+void SlidingWindowMovingAverage::recalculate_sum_() {
+  this->sum_ = 0;
+  for (size_t i = 0; i < this->window_.size(); i++)
+    this->sum_ += this->window_[i];
+  this->since_recalculate_ = 0;
+}
+
+SlidingWindowQuantile::SlidingWindowQuantile(size_t max_size, float quantile) : quantile_(quantile) {
+  this->set_max_size(max_size);
+}
+float SlidingWindowQuantile::next_value(float value) {
+  if (std::isnan(value) || this->max_size_ == 0)
+    return this->calculate_quantile();
+
+  const uint16_t size = this->get_size();
+  uint16_t slot;
+  if (size == this->max_size_) {
+    // replace the oldest value
+    slot = this->head_;
+    this->remove_(slot);
+    this->head_ = this->head_ + 1 == this->max_size_ ? 0 : this->head_ + 1;
+  } else {
+    slot = this->head_ + size;
+    if (slot >= this->max_size_)
+      slot -= this->max_size_;
+  }
+  this->values_[slot] = value;
+  this->insert_(slot);
+  return this->calculate_quantile();
+}
+float SlidingWindowQuantile::calculate_quantile() const {
+  if (this->lower_size_ == 0)
+    return NAN;
+  return this->values_[this->lower_[0]];
+}
+size_t SlidingWindowQuantile::get_size() const { return this->lower_size_ + this->upper_size_; }
+size_t SlidingWindowQuantile::get_max_size() const { return this->max_size_; }
+void SlidingWindowQuantile::set_max_size(size_t max_size) {
+  max_size = std::min(max_size, size_t(UINT16_MAX));
+  if (max_size == this->max_size_)
+    return;
+
+  // keep the newest values that fit, in order
+  const uint16_t old_size = this->get_size();
+  const uint16_t keep = std::min(size_t(old_size), max_size);
+  std::unique_ptr<float[]> values(max_size == 0 ? nullptr : new float[max_size]);
+  for (uint16_t i = 0; i < keep; i++) {
+    uint32_t slot = this->head_ + old_size - keep + i;
+    if (slot >= this->max_size_)
+      slot -= this->max_size_;
+    values[i] = this->values_[slot];
+  }
 
-  while (this->queue_.size() > max_size) {
-    this->sum_ -= this->queue_.front();
-    this->queue_.pop();
+  this->values_ = std::move(values);
+  this->lower_.reset(max_size == 0 ? nullptr : new uint16_t[max_size]);
+  this->upper_.reset(max_size == 0 ? nullptr : new uint16_t[max_size]);
+  this->position_.reset(max_size == 0 ? nullptr : new uint16_t[max_size]);
+  this->in_lower_.reset(max_size == 0 ? nullptr : new bool[max_size]);
+  this->max_size_ = max_size;
+  this->head_ = 0;
+  this->lower_size_ = 0;
+  this->upper_size_ = 0;
+  for (uint16_t i = 0; i < keep; i++)
+    this->insert_(i);
+}
+float SlidingWindowQuantile::get_quantile() const { return this->quantile_; }
+void SlidingWindowQuantile::set_quantile(float quantile) {
+  this->quantile_ = quantile;
+  this->rebalance_();
+}
+bool SlidingWindowQuantile::above_(bool lower, uint16_t a, uint16_t b) const {
+  return lower ? this->values_[a] > this->values_[b] : this->values_[a] < this->values_[b];
+}
+uint16_t *SlidingWindowQuantile::heap_(bool lower) { return lower ? this->lower_.get() : this->upper_.get(); }
+uint16_t &SlidingWindowQuantile::heap_size_(bool lower) { return lower ? this->lower_size_ : this->upper_size_; }
+void SlidingWindowQuantile::set_at_(bool lower, uint16_t index, uint16_t slot) {
+  this->heap_(lower)[index] = slot;
+  this->position_[slot] = index;
+  this->in_lower_[slot] = lower;
+}
+void SlidingWindowQuantile::sift_up_(bool lower, uint16_t index) {
+  uint16_t *heap = this->heap_(lower);
+  const uint16_t slot = heap[index];
+  while (index > 0) {
+    const uint16_t parent = (index - 1) / 2;
+    if (!this->above_(lower, slot, heap[parent]))
+      break;
+    this->set_at_(lower, index, heap[parent]);
+    index = parent;
+  }
+  this->set_at_(lower, index, slot);
+}
+void SlidingWindowQuantile::sift_down_(bool lower, uint16_t index) {
+  uint16_t *heap = this->heap_(lower);
+  const uint16_t size = this->heap_size_(lower);
+  const uint16_t slot = heap[index];
+  while (true) {
+    uint32_t child = uint32_t(index) * 2 + 1;
+    if (child >= size)
+      break;
+    if (child + 1 < size && this->above_(lower, heap[child + 1], heap[child]))
+      child++;
+    if (!this->above_(lower, heap[child], slot))
+      break;
+    this->set_at_(lower, index, heap[child]);
+    index = child;
+  }
+  this->set_at_(lower, index, slot);
+}
+void SlidingWindowQuantile::push_(bool lower, uint16_t slot) {
+  const uint16_t index = this->heap_size_(lower)++;
+  this->set_at_(lower, index, slot);
+  this->sift_up_(lower, index);
+}
+uint16_t SlidingWindowQuantile::pop_(bool lower) {
+  const uint16_t top = this->heap_(lower)[0];
+  this->remove_(top);
+  return top;
+}
+void SlidingWindowQuantile::remove_(uint16_t slot) {
+  const bool lower = this->in_lower_[slot];
+  uint16_t *heap = this->heap_(lower);
+  const uint16_t index = this->position_[slot];
+  const uint16_t last = --this->heap_size_(lower);
+  if (index != last) {
+    // fill the gap with the last value of the heap, which may have to move either way
+    const uint16_t moved = heap[last];
+    this->set_at_(lower, index, moved);
+    this->sift_up_(lower, index);
+    this->sift_down_(lower, this->position_[moved]);
   }
 }
+void SlidingWindowQuantile::insert_(uint16_t slot) {
+  const bool lower = this->lower_size_ != 0 && !this->above_(false, this->lower_[0], slot);
+  this->push_(lower, slot);
+  this->rebalance_();
+}
+void SlidingWindowQuantile::rebalance_() {
+  const uint16_t size = this->get_size();
+  const float quantile = clamp(0.0f, 1.0f, this->quantile_);
+  const uint16_t target = size == 0 ? 0 : uint16_t(roundf(quantile * (size - 1))) + 1;
+  while (this->lower_size_ > target)
+    this->push_(false, this->pop_(true));
+  while (this->lower_size_ < target)
+    this->push_(true, this->pop_(false));
+}
 
 std::string value_accuracy_to_string(float value, int8_t accuracy_decimals) {
+  char tmp[VALUE_ACCURACY_MAX_LEN];  // should be enough, but we should maybe improve this at some point.
+  size_t len = value_accuracy_to_buf(tmp, value, accuracy_decimals);
+  return std::string(tmp, len);
+}
+/// The largest number of units (value * 10^accuracy_decimals) that's formatted with integer arithmetic.
+static const float VALUE_ACCURACY_MAX_UNITS = 1e9f;
+/// The most decimals that are formatted with integer arithmetic.
+static const int8_t VALUE_ACCURACY_MAX_DECIMALS = 9;
+
+size_t value_accuracy_to_buf(char *buf, float value, int8_t accuracy_decimals) {
   auto multiplier = float(pow10(accuracy_decimals));
-  float value_rounded = roundf(value * multiplier) / multiplier;
-  char tmp[32];  // should be enough, but we should maybe improve this at some point.
-  dtostrf(value_rounded, 0, uint8_t(std::max(0, int(accuracy_decimals))), tmp);
-  return std::string(tmp);
+  // the value in units of the last digit that's printed
+  float units = roundf(value * multiplier);
+  const uint8_t decimals = std::max(0, int(accuracy_decimals));
+  if (accuracy_decimals < 0)
+    // rounded to tens, hundreds, ...: print the integer value
+    units = roundf(units / multiplier);
+  if (!(fabsf(units) < VALUE_ACCURACY_MAX_UNITS) || accuracy_decimals > VALUE_ACCURACY_MAX_DECIMALS) {
+    // NaN, inf and huge values - rare enough to take the slow path
+    dtostrf(accuracy_decimals < 0 ? units : units / multiplier, 0, decimals, buf);
+    return strlen(buf);
+  }
+
+  // fixed point: print the integer number of units with a decimal point inserted
+  uint32_t abs_units = uint32_t(fabsf(units));
+  char digits[VALUE_ACCURACY_MAX_DECIMALS + 2];
+  uint8_t count = 0;
+  do {
+    digits[count++] = char('0' + abs_units % 10);
+    abs_units /= 10;
+  } while (abs_units != 0 || count <= decimals);
+
+  char *p = buf;
+  if (units < 0)
+    *p++ = '-';
+  while (count > decimals)
+    *p++ = digits[--count];
+  if (decimals != 0) {
+    *p++ = '.';
+    while (count != 0)
+      *p++ = digits[--count];
+  }
+  *p = '\0';
+  return p - buf;
 }
 std::string uint64_to_string(uint64_t num) {
   char buffer[17];
@@ -223,6 +416,406 @@ const char *build_json(const json_build_t &f, size_t *length) {
   *length = bytes_written;
   return global_json_build_buffer;
 }
+/// Allocations of at most this many bytes are served from the blocks of the arena.
+static const size_t SETUP_ARENA_MAX_SIZE = 128;
+/// Allocations are aligned to 8 bytes, like the ones of the heap.
+static const size_t SETUP_ARENA_ALIGN = 8;
+
+void *SetupArena::allocate(size_t size) {
+  size = (size + SETUP_ARENA_ALIGN - 1) & ~(SETUP_ARENA_ALIGN - 1);
+  if (this->closed_ || size > SETUP_ARENA_MAX_SIZE)
+    return malloc(size);
+
+  if (this->block_ == nullptr || this->block_used_ + size > SETUP_ARENA_BLOCK_SIZE) {
+    auto *block = static_cast<uint8_t *>(malloc(SETUP_ARENA_BLOCK_SIZE));
+    if (block == nullptr)
+      return malloc(size);
+    *reinterpret_cast<uint8_t **>(block) = this->block_;
+    this->block_ = block;
+    this->block_used_ = SETUP_ARENA_ALIGN;
+    this->block_count_++;
+  }
+  void *ptr = this->block_ + this->block_used_;
+  this->block_used_ += size;
+  this->used_ += size;
+  return ptr;
+}
+void SetupArena::deallocate(void *ptr) {
+  if (ptr != nullptr && !this->contains_(ptr))
+    free(ptr);
+}
+bool SetupArena::contains_(const void *ptr) const {
+  const auto *p = static_cast<const uint8_t *>(ptr);
+  for (uint8_t *block = this->block_; block != nullptr; block = *reinterpret_cast<uint8_t **>(block)) {
+    if (p >= block && p < block + SETUP_ARENA_BLOCK_SIZE)
+      return true;
+  }
+  return false;
+}
+void SetupArena::close() { this->closed_ = true; }
+size_t SetupArena::get_used() const { return this->used_; }
+size_t SetupArena::get_block_count() const { return this->block_count_; }
+
+SetupArena global_setup_arena;
+
+/// The sizes of the slots of ScratchBufferPool in ascending order.
+static const size_t SCRATCH_BUFFER_SIZES[SCRATCH_BUFFER_SLOTS] = {64, 64, 256, 256, 1024};
+
+char *ScratchBufferPool::acquire(size_t size, size_t *capacity) {
+  for (size_t i = 0; i < SCRATCH_BUFFER_SLOTS; i++) {
+    Slot &slot = this->slots_[i];
+    if (slot.in_use || SCRATCH_BUFFER_SIZES[i] < size)
+      continue;
+    if (slot.data == nullptr)
+      slot.data = new char[SCRATCH_BUFFER_SIZES[i]];
+    slot.in_use = true;
+    *capacity = SCRATCH_BUFFER_SIZES[i];
+    this->checked_out_ += *capacity;
+    this->high_water_mark_ = std::max(this->high_water_mark_, this->checked_out_);
+    return slot.data;
+  }
+
+  this->heap_fallbacks_++;
+  *capacity = size;
+  return new char[size];
+}
+void ScratchBufferPool::release(char *buffer) {
+  for (size_t i = 0; i < SCRATCH_BUFFER_SLOTS; i++) {
+    Slot &slot = this->slots_[i];
+    if (slot.data == buffer && slot.in_use) {
+      slot.in_use = false;
+      this->checked_out_ -= SCRATCH_BUFFER_SIZES[i];
+      return;
+    }
+  }
+  delete[] buffer;
+}
+size_t ScratchBufferPool::get_reserved() const {
+  size_t reserved = 0;
+  for (size_t i = 0; i < SCRATCH_BUFFER_SLOTS; i++) {
+    if (this->slots_[i].data != nullptr)
+      reserved += SCRATCH_BUFFER_SIZES[i];
+  }
+  return reserved;
+}
+size_t ScratchBufferPool::get_high_water_mark() const { return this->high_water_mark_; }
+uint32_t ScratchBufferPool::get_heap_fallbacks() const { return this->heap_fallbacks_; }
+
+ScratchBufferPool global_scratch_buffer_pool;
+
+ScratchBuffer::ScratchBuffer(size_t size) { this->data_ = global_scratch_buffer_pool.acquire(size, &this->size_); }
+ScratchBuffer::~ScratchBuffer() { global_scratch_buffer_pool.release(this->data_); }
+
+/// The buffer write_json() writes into, cleared (but not shrunk) for each call.
+static std::string global_json_write_buffer;
+
+const char *write_json(const json_write_t &f, size_t *length) {
+  global_json_write_buffer.clear();
+  JsonWriter writer(&global_json_write_buffer);
+  writer.begin_object();
+  f(writer);
+  writer.end_object();
+  *length = global_json_write_buffer.size();
+  return global_json_write_buffer.c_str();
+}
+std::string write_json(const json_write_t &f) {
+  size_t len;
+  const char *c_str = write_json(f, &len);
+  return std::string(c_str, len);
+}
+
+JsonWriter::JsonWriter(std::string *out) : out_(out) {}
+void JsonWriter::begin_object() {
+  this->separator_();
+  this->out_->push_back('{');
+  this->need_separator_ = false;
+}
+void JsonWriter::begin_object(const char *key) {
+  this->key_(key);
+  this->out_->push_back('{');
+  this->need_separator_ = false;
+}
+void JsonWriter::end_object() {
+  this->out_->push_back('}');
+  this->need_separator_ = true;
+}
+void JsonWriter::begin_array(const char *key) {
+  this->key_(key);
+  this->out_->push_back('[');
+  this->need_separator_ = false;
+}
+void JsonWriter::end_array() {
+  this->out_->push_back(']');
+  this->need_separator_ = true;
+}
+void JsonWriter::add(const char *key, const char *value) {
+  this->key_(key);
+  this->string_(value, strlen(value));
+}
+void JsonWriter::add(const char *key, const std::string &value) {
+  this->key_(key);
+  this->string_(value.data(), value.size());
+}
+void JsonWriter::add(const char *key, bool value) {
+  this->key_(key);
+  this->out_->append(value ? "true" : "false");
+}
+void JsonWriter::add(const char *key, int value) { this->add(key, long(value)); }
+void JsonWriter::add(const char *key, unsigned value) { this->add(key, static_cast<unsigned long>(value)); }
+void JsonWriter::add(const char *key, long value) {
+  this->key_(key);
+  char buffer[12];
+  sprintf(buffer, "%ld", value);
+  this->out_->append(buffer);
+}
+void JsonWriter::add(const char *key, unsigned long value) {
+  this->key_(key);
+  char buffer[12];
+  sprintf(buffer, "%lu", value);
+  this->out_->append(buffer);
+}
+void JsonWriter::add(const char *key, float value, int8_t accuracy_decimals) {
+  this->key_(key);
+  this->float_(value, accuracy_decimals);
+}
+void JsonWriter::add_element(const std::string &value) {
+  this->separator_();
+  this->string_(value.data(), value.size());
+}
+void JsonWriter::add_element(float value) {
+  this->separator_();
+  this->float_(value, -1);
+}
+void JsonWriter::key_(const char *key) {
+  this->separator_();
+  this->string_(key, strlen(key));
+  this->out_->push_back(':');
+}
+void JsonWriter::separator_() {
+  if (this->need_separator_)
+    this->out_->push_back(',');
+  this->need_separator_ = true;
+}
+void JsonWriter::string_(const char *value, size_t len) {
+  this->out_->push_back('"');
+  for (size_t i = 0; i < len; i++) {
+    const char c = value[i];
+    switch (c) {
+      case '"':
+        this->out_->append("\\\"");
+        break;
+      case '\\':
+        this->out_->append("\\\\");
+        break;
+      case '\n':
+        this->out_->append("\\n");
+        break;
+      case '\r':
+        this->out_->append("\\r");
+        break;
+      case '\t':
+        this->out_->append("\\t");
+        break;
+      default:
+        if (uint8_t(c) < 0x20) {
+          char buffer[7];
+          sprintf(buffer, "\\u%04x", c);
+          this->out_->append(buffer);
+        } else {
+          this->out_->push_back(c);
+        }
+        break;
+    }
+  }
+  this->out_->push_back('"');
+}
+void JsonWriter::float_(float value, int8_t accuracy_decimals) {
+  if (std::isnan(value) || std::isinf(value)) {
+    this->out_->append("null");
+    return;
+  }
+  char buffer[VALUE_ACCURACY_MAX_LEN];
+  if (accuracy_decimals >= 0) {
+    this->out_->append(buffer, value_accuracy_to_buf(buffer, value, accuracy_decimals));
+    return;
+  }
+  snprintf(buffer, sizeof(buffer), "%.7g", value);
+  this->out_->append(buffer);
+}
+
+JsonReader::JsonReader(const char *data, size_t len) : data_(data), len_(len) {
+  this->skip_whitespace_();
+  if (this->pos_ >= this->len_ || this->data_[this->pos_] != '{')
+    this->error_ = true;
+  else
+    this->pos_++;
+}
+bool JsonReader::next() {
+  if (this->done_ || this->error_)
+    return false;
+  this->skip_whitespace_();
+  if (this->pos_ >= this->len_)
+    return this->fail_();
+  if (this->data_[this->pos_] == '}') {
+    this->done_ = true;
+    return false;
+  }
+  if (this->started_) {
+    if (this->data_[this->pos_] != ',')
+      return this->fail_();
+    this->pos_++;
+    this->skip_whitespace_();
+  }
+  this->started_ = true;
+
+  if (this->pos_ >= this->len_ || this->data_[this->pos_] != '"')
+    return this->fail_();
+  const size_t key_start = this->pos_ + 1;
+  if (!this->skip_string_())
+    return this->fail_();
+  this->key_ = this->data_ + key_start;
+  this->key_len_ = this->pos_ - 1 - key_start;
+
+  this->skip_whitespace_();
+  if (this->pos_ >= this->len_ || this->data_[this->pos_] != ':')
+    return this->fail_();
+  this->pos_++;
+  this->skip_whitespace_();
+  const size_t value_start = this->pos_;
+  if (!this->skip_value_())
+    return this->fail_();
+  this->value_ = this->data_ + value_start;
+  this->value_len_ = this->pos_ - value_start;
+  return true;
+}
+bool JsonReader::has_error() const { return this->error_; }
+bool JsonReader::is_key(const char *key) const {
+  return strncmp(this->key_, key, this->key_len_) == 0 && key[this->key_len_] == '\0';
+}
+std::string JsonReader::get_string() const {
+  if (this->value_len_ == 0 || this->value_[0] != '"')
+    return std::string(this->value_, this->value_len_);
+
+  std::string ret;
+  // without the quotes
+  const char *end = this->value_ + this->value_len_ - 1;
+  for (const char *c = this->value_ + 1; c < end; c++) {
+    if (*c != '\\' || c + 1 >= end) {
+      ret += *c;
+      continue;
+    }
+    switch (*++c) {
+      case 'n':
+        ret += '\n';
+        break;
+      case 'r':
+        ret += '\r';
+        break;
+      case 't':
+        ret += '\t';
+        break;
+      case 'b':
+        ret += '\b';
+        break;
+      case 'f':
+        ret += '\f';
+        break;
+      case 'u': {
+        if (c + 4 >= end)
+          return ret;
+        char hex[5] = {c[1], c[2], c[3], c[4], '\0'};
+        const auto code = uint16_t(strtoul(hex, nullptr, 16));
+        c += 4;
+        // encode as UTF-8, surrogate pairs aren't combined
+        if (code < 0x80) {
+          ret += char(code);
+        } else if (code < 0x800) {
+          ret += char(0xC0 | (code >> 6));
+          ret += char(0x80 | (code & 0x3F));
+        } else {
+          ret += char(0xE0 | (code >> 12));
+          ret += char(0x80 | ((code >> 6) & 0x3F));
+          ret += char(0x80 | (code & 0x3F));
+        }
+        break;
+      }
+      default:
+        // quotes, slashes
+        ret += *c;
+        break;
+    }
+  }
+  return ret;
+}
+float JsonReader::get_float() const {
+  const char *value = this->value_;
+  size_t len = this->value_len_;
+  if (len >= 2 && value[0] == '"') {
+    value++;
+    len -= 2;
+  }
+  char buffer[24];
+  len = std::min(len, sizeof(buffer) - 1);
+  memcpy(buffer, value, len);
+  buffer[len] = '\0';
+  char *end;
+  const float ret = strtof(buffer, &end);
+  return end == buffer ? 0.0f : ret;
+}
+JsonReader JsonReader::get_object() const { return JsonReader(this->value_, this->value_len_); }
+void JsonReader::skip_whitespace_() {
+  while (this->pos_ < this->len_ && isspace(this->data_[this->pos_]))
+    this->pos_++;
+}
+bool JsonReader::skip_string_() {
+  this->pos_++;
+  while (this->pos_ < this->len_) {
+    const char c = this->data_[this->pos_++];
+    if (c == '\\')
+      this->pos_++;
+    else if (c == '"')
+      return true;
+  }
+  return false;
+}
+bool JsonReader::skip_value_() {
+  if (this->pos_ >= this->len_)
+    return false;
+  const char first = this->data_[this->pos_];
+  if (first == '"')
+    return this->skip_string_();
+
+  if (first == '{' || first == '[') {
+    uint16_t depth = 0;
+    while (this->pos_ < this->len_) {
+      const char c = this->data_[this->pos_];
+      if (c == '"') {
+        if (!this->skip_string_())
+          return false;
+        continue;
+      }
+      this->pos_++;
+      if (c == '{' || c == '[') {
+        depth++;
+      } else if (c == '}' || c == ']') {
+        if (--depth == 0)
+          return true;
+      }
+    }
+    return false;
+  }
+
+  // numbers and literals
+  const size_t start = this->pos_;
+  while (this->pos_ < this->len_ && strchr(",}] \t\r\n", this->data_[this->pos_]) == nullptr)
+    this->pos_++;
+  return this->pos_ != start;
+}
+bool JsonReader::fail_() {
+  this->error_ = true;
+  return false;
+}
+
 void parse_json(const std::string &data, const json_parse_t &f) {
   global_json_buffer.clear();
   JsonObject &root = global_json_buffer.parseObject(data);
@@ -312,6 +905,136 @@ uint8_t crc8(uint8_t *data, uint8_t len) {
   }
   return crc;
 }
+uint32_t calculate_crc32(const uint8_t *data, size_t len, uint32_t crc) {
+  crc = ~crc;
+  while (len--) {
+    crc ^= *data++;
+    for (uint8_t i = 0; i < 8; i++)
+      crc = (crc >> 1) ^ (0xEDB88320UL & -(crc & 1));
+  }
+  return ~crc;
+}
+
+/// Writes the bits of a deflate stream, least significant bit first.
+class DeflateBitWriter {
+ public:
+  explicit DeflateBitWriter(std::vector<uint8_t> *out) : out_(out) {}
+  void write_bits(uint32_t value, uint8_t count) {
+    this->bits_ |= value << this->count_;
+    this->count_ += count;
+    while (this->count_ >= 8) {
+      this->out_->push_back(this->bits_);
+      this->bits_ >>= 8;
+      this->count_ -= 8;
+    }
+  }
+  /// Huffman codes are stored starting with their most significant bit.
+  void write_code(uint32_t code, uint8_t length) {
+    uint32_t reversed = 0;
+    for (uint8_t i = 0; i < length; i++)
+      reversed |= ((code >> i) & 1) << (length - 1 - i);
+    this->write_bits(reversed, length);
+  }
+  /// Write a symbol of the fixed literal/length code.
+  void write_symbol(uint16_t symbol) {
+    if (symbol < 144)
+      this->write_code(0x30 + symbol, 8);
+    else if (symbol < 256)
+      this->write_code(0x190 + symbol - 144, 9);
+    else if (symbol < 280)
+      this->write_code(symbol - 256, 7);
+    else
+      this->write_code(0xC0 + symbol - 280, 8);
+  }
+  void flush() {
+    if (this->count_ != 0)
+      this->out_->push_back(this->bits_);
+    this->bits_ = 0;
+    this->count_ = 0;
+  }
+
+ protected:
+  std::vector<uint8_t> *out_;
+  uint32_t bits_{0};
+  uint8_t count_{0};
+};
+
+static const uint16_t DEFLATE_LENGTH_BASE[] = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                                               31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const uint8_t DEFLATE_LENGTH_EXTRA[] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                               2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+static const uint16_t DEFLATE_DISTANCE_BASE[] = {1,    2,    3,    4,    5,    7,     9,     13,    17,  25,
+                                                 33,   49,   65,   97,   129,  193,   257,   385,   513, 769,
+                                                 1025, 1537, 2049, 3073, 4097, 6145,  8193,  12289, 16385, 24577};
+static const uint8_t DEFLATE_DISTANCE_EXTRA[] = {0, 0, 0, 0, 1, 1, 2, 2,  3,  3,  4,  4,  5,  5,  6,
+                                                 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+/// The hash table of 3 byte sequences has 2^GZIP_HASH_BITS entries.
+static const uint8_t GZIP_HASH_BITS = 10;
+
+std::vector<uint8_t> gzip_compress(const uint8_t *data, size_t len) {
+  // header: magic, deflate, no flags, no modification time, no extra flags, unknown OS
+  std::vector<uint8_t> out{0x1F, 0x8B, 8, 0, 0, 0, 0, 0, 0, 0xFF};
+  out.reserve(len / 2 + 32);
+  DeflateBitWriter writer(&out);
+  // a single final block with the fixed Huffman codes
+  writer.write_bits(1, 1);
+  writer.write_bits(1, 2);
+
+  // the last position of each 3 byte sequence, shifted by one so that 0 is empty
+  std::unique_ptr<uint32_t[]> head(new uint32_t[1u << GZIP_HASH_BITS]());
+  auto hash = [data](size_t i) -> size_t {
+    const uint32_t v = data[i] | (uint32_t(data[i + 1]) << 8) | (uint32_t(data[i + 2]) << 16);
+    return uint32_t(v * 2654435761UL) >> (32 - GZIP_HASH_BITS);
+  };
+  size_t i = 0;
+  while (i < len) {
+    size_t match = 0;
+    size_t distance = 0;
+    if (i + 3 <= len) {
+      const size_t h = hash(i);
+      const uint32_t candidate = head[h];
+      head[h] = i + 1;
+      if (candidate != 0 && i - (candidate - 1) <= 32768) {
+        const size_t start = candidate - 1;
+        const size_t max_match = std::min<size_t>(258, len - i);
+        while (match < max_match && data[start + match] == data[i + match])
+          match++;
+        distance = i - start;
+      }
+    }
+    if (match < 3) {
+      writer.write_symbol(data[i++]);
+      continue;
+    }
+
+    uint8_t code = 0;
+    while (code < 28 && DEFLATE_LENGTH_BASE[code + 1] <= match)
+      code++;
+    writer.write_symbol(257 + code);
+    writer.write_bits(match - DEFLATE_LENGTH_BASE[code], DEFLATE_LENGTH_EXTRA[code]);
+    code = 0;
+    while (code < 29 && DEFLATE_DISTANCE_BASE[code + 1] <= distance)
+      code++;
+    writer.write_code(code, 5);
+    writer.write_bits(distance - DEFLATE_DISTANCE_BASE[code], DEFLATE_DISTANCE_EXTRA[code]);
+
+    for (size_t j = i + 1; j < i + match && j + 3 <= len; j++)
+      head[hash(j)] = j + 1;
+    i += match;
+  }
+  // end of block
+  writer.write_symbol(256);
+  writer.flush();
+
+  // trailer: CRC-32 and size, little endian
+  const uint32_t crc = calculate_crc32(data, len);
+  for (uint8_t shift = 0; shift < 32; shift += 8)
+    out.push_back(crc >> shift);
+  for (uint8_t shift = 0; shift < 32; shift += 8)
+    out.push_back(uint32_t(len) >> shift);
+  return out;
+}
+
 void delay_microseconds_accurate(uint32_t usec) {
   if (usec == 0)
     return;
@@ -423,11 +1146,12 @@ optional<float> parse_float(const std::string &str) {
     return {};
   return value;
 }
-uint32_t fnv1_hash(const std::string &str) {
+uint32_t fnv1_hash(const std::string &str) { return fnv1_hash(str.data(), str.size()); }
+uint32_t fnv1_hash(const char *data, size_t len) {
   uint32_t hash = 2166136261UL;
-  for (char c : str) {
+  for (size_t i = 0; i < len; i++) {
     hash *= 16777619UL;
-    hash ^= c;
+    hash ^= data[i];
   }
   return hash;
 }
@@ -517,4 +1241,52 @@ void HighFrequencyLoopRequester::stop() {
 }
 bool HighFrequencyLoopRequester::is_high_frequency() { return high_freq_num_requests > 0; }
 
+static volatile bool loop_wake_requested = false;
+#ifdef ARDUINO_ARCH_ESP32
+static TaskHandle_t loop_task_handle = nullptr;
+#endif
+
+void ICACHE_RAM_ATTR HOT wake_loop() {
+  loop_wake_requested = true;
+#ifdef ARDUINO_ARCH_ESP32
+  if (loop_task_handle == nullptr)
+    return;
+  if (xPortInIsrContext()) {
+    BaseType_t higher_priority_task_woken = pdFALSE;
+    vTaskNotifyGiveFromISR(loop_task_handle, &higher_priority_task_woken);
+    if (higher_priority_task_woken)
+      portYIELD_FROM_ISR();
+  } else {
+    xTaskNotifyGive(loop_task_handle);
+  }
+#endif
+}
+void idle_sleep(uint32_t ms) {
+#ifdef ARDUINO_ARCH_ESP32
+  // Block on a task notification so that the idle task (and automatic light sleep if enabled
+  // in the SDK) can run, and so that wake_loop() can end the sleep right away.
+  if (loop_task_handle == nullptr)
+    loop_task_handle = xTaskGetCurrentTaskHandle();
+  if (!loop_wake_requested)
+    ulTaskNotifyTake(pdTRUE, ms / portTICK_PERIOD_MS);
+#endif
+#ifdef ARDUINO_ARCH_ESP8266
+  // The SDK has no way to interrupt a running delay(), so sleep in small steps and check for wake requests.
+  const uint32_t start = millis();
+  while (!loop_wake_requested && millis() - start < ms)
+    delay(1);
+#endif
+  loop_wake_requested = false;
+}
+
+uint64_t ICACHE_RAM_ATTR HOT micros_64() {
+#ifdef ARDUINO_ARCH_ESP32
+  return esp_timer_get_time();
+#endif
+#ifdef ARDUINO_ARCH_ESP8266
+  // extends the 32-bit microsecond counter of the SDK with an overflow count
+  return micros64();
+#endif
+}
+
 ESPHOME_NAMESPACE_END
@@ -3,9 +3,12 @@
 
 #include <string>
 #include <IPAddress.h>
+#include <algorithm>
 #include <memory>
-#include <queue>
 #include <functional>
+#include <new>
+#include <type_traits>
+#include <vector>
 #include <ArduinoJson.h>
 
 #include "esphome/esphal.h"
@@ -35,6 +38,11 @@ using json_parse_t = std::function<void(JsonObject &)>;
 /// Callback function typedef for building JsonObjects.
 using json_build_t = std::function<void(JsonObject &)>;
 
+class JsonWriter;
+
+/// Callback function typedef for writing JSON objects with a JsonWriter.
+using json_write_t = std::function<void(JsonWriter &)>;
+
 /// The characters that are allowed in a hostname.
 extern const char *HOSTNAME_CHARACTER_WHITELIST;
 
@@ -98,12 +106,123 @@ const char *build_json(const json_build_t &f, size_t *length);
 
 std::string build_json(const json_build_t &f);
 
+/** Write a JSON object with the provided json write function.
+ *
+ * Unlike build_json() this doesn't build a document first, the members are written straight into a buffer
+ * that's reused between calls.
+ */
+const char *write_json(const json_write_t &f, size_t *length);
+
+std::string write_json(const json_write_t &f);
+
+/// Make sure the buffer used by build_json() can hold at least required_size bytes.
+void reserve_global_json_build_buffer(size_t required_size);
+
 /// Compare string a to string b (ignoring case) and return whether they are equal.
 bool str_equals_case_insensitive(const std::string &a, const std::string &b);
 
 /// Parse a JSON string and run the provided json parse function if it's valid.
 void parse_json(const std::string &data, const json_parse_t &f);
 
+/// The size of the blocks of SetupArena.
+static const size_t SETUP_ARENA_BLOCK_SIZE = 512;
+
+/** An arena for the objects created during setup that live for the whole program.
+ *
+ * Until close() is called at the end of App.setup(), small allocations are packed into blocks of
+ * SETUP_ARENA_BLOCK_SIZE bytes without the per-allocation overhead of the heap, so the hundreds of components,
+ * filters and automations of a configuration don't fragment the heap before WiFi starts and end up next to each
+ * other. Larger allocations and all allocations after close() come from the heap. Memory from the blocks isn't
+ * freed, deleting such an object only runs its destructor.
+ *
+ * The arena is constant-initialized, so it can be used by static initializers.
+ */
+class SetupArena {
+ public:
+  void *allocate(size_t size);
+  void deallocate(void *ptr);
+  /// Serve all further allocations from the heap.
+  void close();
+
+  /// The number of bytes allocated from the blocks.
+  size_t get_used() const;
+  size_t get_block_count() const;
+
+ protected:
+  /// Whether ptr points into one of the blocks.
+  bool contains_(const void *ptr) const;
+
+  /// The current block, blocks start with a pointer to the previous one.
+  uint8_t *block_{nullptr};
+  size_t block_used_{0};
+  size_t used_{0};
+  size_t block_count_{0};
+  bool closed_{false};
+};
+
+extern SetupArena global_setup_arena;
+
+/// Base class of the objects created during setup, they are allocated from global_setup_arena.
+class SetupAllocated {
+ public:
+  static void *operator new(size_t size) { return global_setup_arena.allocate(size); }
+  static void operator delete(void *ptr) { global_setup_arena.deallocate(ptr); }
+};
+
+/// The number of buffers of ScratchBufferPool, 2 of 64 bytes, 2 of 256 bytes and 1 of 1024 bytes.
+static const size_t SCRATCH_BUFFER_SLOTS = 5;
+
+/** A pool of scratch buffers for formatting, shared by all components.
+ *
+ * Buffers are checked out with ScratchBuffer and returned at the end of the same call, so a few buffers of each
+ * size class serve all components instead of each one keeping its own. The buffers are
+ * allocated on first use and kept. Requests larger than the largest class, or while all fitting buffers are checked
+ * out, are served from the heap. The pool isn't locked, only use it from the main loop.
+ */
+class ScratchBufferPool {
+ public:
+  /// Check out a buffer of at least size bytes, *capacity is set to its actual size.
+  char *acquire(size_t size, size_t *capacity);
+  /// Return a buffer from acquire().
+  void release(char *buffer);
+
+  /// The number of bytes allocated by the pool.
+  size_t get_reserved() const;
+  /// The largest number of bytes that were checked out at the same time.
+  size_t get_high_water_mark() const;
+  /// The number of requests that were served from the heap.
+  uint32_t get_heap_fallbacks() const;
+
+ protected:
+  struct Slot {
+    char *data;
+    bool in_use;
+  };
+
+  Slot slots_[SCRATCH_BUFFER_SLOTS]{};
+  size_t checked_out_{0};
+  size_t high_water_mark_{0};
+  uint32_t heap_fallbacks_{0};
+};
+
+extern ScratchBufferPool global_scratch_buffer_pool;
+
+/// A buffer checked out from global_scratch_buffer_pool for the lifetime of this object.
+class ScratchBuffer {
+ public:
+  explicit ScratchBuffer(size_t size);
+  ScratchBuffer(const ScratchBuffer &) = delete;
+  ScratchBuffer &operator=(const ScratchBuffer &) = delete;
+  ~ScratchBuffer();
+
+  char *data() { return this->data_; }
+  size_t size() const { return this->size_; }
+
+ protected:
+  char *data_;
+  size_t size_;
+};
+
 class HighFrequencyLoopRequester {
  public:
   void start();
@@ -115,6 +234,24 @@ class HighFrequencyLoopRequester {
   bool started_{false};
 };
 
+/** Wake the main loop if it's currently sleeping in idle mode.
+ *
+ * Components that receive data in an interrupt and want loop() to process it right away should call
+ * this from the ISR. Safe to call from ISRs and other tasks.
+ *
+ * @see Application::set_idle_mode()
+ */
+void wake_loop();
+
+/// Sleep for up to ms milliseconds, returning early if wake_loop() is called.
+void idle_sleep(uint32_t ms);
+
+/** Monotonic microseconds since boot as a 64-bit value, unlike micros() and millis() it doesn't roll over.
+ *
+ * Safe to call from ISRs.
+ */
+uint64_t micros_64();
+
 /** Clamp the value between min and max.
  *
  * @tparam T The input/output typename.
@@ -161,6 +298,16 @@ float gamma_correct(float value, float gamma);
 /// Create a string from a value and an accuracy in decimals.
 std::string value_accuracy_to_string(float value, int8_t accuracy_decimals);
 
+/// Size of the buffer required for value_accuracy_to_buf().
+#define VALUE_ACCURACY_MAX_LEN 32
+
+/** Format a value with an accuracy in decimals into a buffer of at least VALUE_ACCURACY_MAX_LEN bytes.
+ *
+ * Same as value_accuracy_to_string() but without allocating, returns the length of the result. Common values are
+ * formatted with integer arithmetic instead of the (slow) float printf.
+ */
+size_t value_accuracy_to_buf(char *buf, float value, int8_t accuracy_decimals);
+
 /// Convert a uint64_t to a hex string
 std::string uint64_to_string(uint64_t num);
 
@@ -188,6 +335,17 @@ void enable_interrupts();
 /// Calculate a crc8 of data with the provided data length.
 uint8_t crc8(uint8_t *data, uint8_t len);
 
+/// Calculate the CRC-32 used by gzip and zlib of data, optionally continuing from the CRC of the data before it.
+uint32_t calculate_crc32(const uint8_t *data, size_t len, uint32_t crc = 0);
+
+/** Compress data into the gzip format.
+ *
+ * This is meant for small buffers that are compressed once, like web pages. To keep the memory use to a few KB,
+ * it only looks for matches at the last position of each 3 byte sequence and encodes everything in a single
+ * block with the fixed Huffman codes.
+ */
+std::vector<uint8_t> gzip_compress(const uint8_t *data, size_t len);
+
 enum ParseOnOffState {
   PARSE_NONE = 0,
   PARSE_ON,
@@ -197,6 +355,39 @@ enum ParseOnOffState {
 
 ParseOnOffState parse_on_off(const char *str, const char *on = nullptr, const char *off = nullptr);
 
+/** Ring buffer with a fixed capacity, for sliding windows of values.
+ *
+ * The storage is allocated once when the capacity is set, pushing to a full buffer overwrites the oldest value.
+ */
+template<typename T> class RingBuffer {
+ public:
+  explicit RingBuffer(size_t capacity);
+
+  /// Add a value, dropping the oldest one if the buffer is full.
+  void push(T value);
+  /// Remove the oldest value.
+  void pop_front();
+  void clear();
+
+  /// The value at index, 0 being the oldest value.
+  T operator[](size_t index) const;
+  T front() const;
+  size_t size() const;
+  bool empty() const;
+  bool full() const;
+
+  size_t capacity() const;
+  /// Change the capacity, keeping the newest values that fit.
+  void set_capacity(size_t capacity);
+
+ protected:
+  std::unique_ptr<T[]> data_;
+  size_t capacity_{0};
+  /// The index of the oldest value in data_.
+  size_t head_{0};
+  size_t size_{0};
+};
+
 /// Helper class that implements a sliding window moving average.
 class SlidingWindowMovingAverage {
  public:
@@ -220,9 +411,77 @@ class SlidingWindowMovingAverage {
   void set_max_size(size_t max_size);
 
  protected:
-  std::queue<float> queue_;
-  size_t max_size_;
+  /// Recalculate the sum from the window, so that rounding errors don't accumulate.
+  void recalculate_sum_();
+
+  RingBuffer<float> window_;
   float sum_;
+  /// Values added since the sum was last recalculated.
+  size_t since_recalculate_{0};
+};
+
+/** Helper class that implements a sliding window quantile, for example a sliding median.
+ *
+ * The window is kept in two heaps: a max-heap with the values up to the quantile and a min-heap with the
+ * rest, so the quantile is always at the top of the first one. Each value knows its position in its
+ * heap, which lets the oldest value be removed directly, so adding a value takes O(log n). All storage
+ * is allocated when the window size is set, windows can be up to 65535 values large.
+ */
+class SlidingWindowQuantile {
+ public:
+  /** Create the SlidingWindowQuantile.
+   *
+   * @param max_size The window size.
+   * @param quantile The quantile from 0 to 1, 0.5 for the median.
+   */
+  SlidingWindowQuantile(size_t max_size, float quantile);
+
+  /** Add value to the window, NaN values are ignored.
+   *
+   * @param value The value.
+   * @return The new quantile, NaN if the window is empty.
+   */
+  float next_value(float value);
+
+  /// Return the quantile of the window or NaN if it's empty.
+  float calculate_quantile() const;
+
+  size_t get_size() const;
+  size_t get_max_size() const;
+  void set_max_size(size_t max_size);
+  float get_quantile() const;
+  void set_quantile(float quantile);
+
+ protected:
+  /// Whether the value in slot a belongs above the value in slot b in the lower (max) or upper (min) heap.
+  bool above_(bool lower, uint16_t a, uint16_t b) const;
+  uint16_t *heap_(bool lower);
+  uint16_t &heap_size_(bool lower);
+  void sift_up_(bool lower, uint16_t index);
+  void sift_down_(bool lower, uint16_t index);
+  void set_at_(bool lower, uint16_t index, uint16_t slot);
+  void push_(bool lower, uint16_t slot);
+  uint16_t pop_(bool lower);
+  void remove_(uint16_t slot);
+  void insert_(uint16_t slot);
+  /// Move values between the heaps so that the lower heap holds the values up to the quantile.
+  void rebalance_();
+
+  /// The window values as a ring, indexed by slot.
+  std::unique_ptr<float[]> values_;
+  /// Slots of the values below and at the quantile, as a max-heap.
+  std::unique_ptr<uint16_t[]> lower_;
+  /// Slots of the values above the quantile, as a min-heap.
+  std::unique_ptr<uint16_t[]> upper_;
+  /// For each slot, its index in the heap it's in.
+  std::unique_ptr<uint16_t[]> position_;
+  std::unique_ptr<bool[]> in_lower_;
+  uint16_t lower_size_{0};
+  uint16_t upper_size_{0};
+  uint16_t max_size_{0};
+  /// The slot of the oldest value.
+  uint16_t head_{0};
+  float quantile_;
 };
 
 /// Helper class that implements an exponential moving average.
@@ -237,6 +496,11 @@ class ExponentialMovingAverage {
   void set_alpha(float alpha);
   float get_alpha() const;
 
+  /// Whether a value has been added yet.
+  bool has_value() const;
+  /// Continue from the given average, for example one saved before deep sleep.
+  void set_average(float average);
+
  protected:
   bool first_value_{true};
   float alpha_;
@@ -250,7 +514,14 @@ template<int... S> struct gens<0, S...> { using type = seq<S...>; };  // NOLINT
 
 template<typename... X> class CallbackManager;
 
+/// Callbacks of up to this size that are trivially copyable are stored in CallbackManager without a std::function.
+static const size_t CALLBACK_INLINE_SIZE = 3 * sizeof(void *);
+
 /** Simple helper class to allow having multiple subscribers to a signal.
+ *
+ * Small, trivially copyable callbacks (like lambdas capturing this and a few pointers or numbers) are stored
+ * directly in the callback list and called through a plain function pointer. Everything else, including
+ * callbacks that already are a std::function, is kept in a std::function.
  *
  * @tparam Ts The arguments for the callback, wrapped in void().
  */
@@ -258,12 +529,27 @@ template<typename... Ts> class CallbackManager<void(Ts...)> {
  public:
   /// Add a callback to the internal callback list.
   void add(std::function<void(Ts...)> &&callback);
+  /// Add a callback to the internal callback list, stored inline if possible.
+  template<typename F> void add(F &&callback);
 
   /// Call all callbacks in this manager.
   void call(Ts... args);
 
  protected:
-  std::vector<std::function<void(Ts...)>> callbacks_;
+  struct Entry {
+    /// Calls the callback stored in storage, nullptr for callbacks in functions_.
+    void (*invoke)(void *storage, Ts... args);
+    /// The index in functions_ if invoke is nullptr.
+    size_t function_index;
+    typename std::aligned_storage<CALLBACK_INLINE_SIZE, alignof(void *)>::type storage;
+  };
+
+  template<typename F> static void invoke_(void *storage, Ts... args);
+  template<typename F> void add_(F &&callback, std::true_type inline_storage);
+  template<typename F> void add_(F &&callback, std::false_type inline_storage);
+
+  std::vector<Entry> entries_;
+  std::vector<std::function<void(Ts...)>> functions_;
 };
 
 // https://stackoverflow.com/a/37161919/8924614
@@ -290,6 +576,8 @@ template<typename T, typename... X> class TemplatableValue {
   TemplatableValue(F f) : type_(LAMBDA), f_(f) {}
 
   bool has_value() { return this->type_ != EMPTY; }
+  /// Whether the value is computed by a lambda, so it can be different for each call.
+  bool is_lambda() const { return this->type_ == LAMBDA; }
 
   T value(X... x) {
     if (this->type_ == LAMBDA) {
@@ -366,6 +654,88 @@ class VectorJsonBuffer : public ArduinoJson::Internals::JsonBufferBase<VectorJso
 
 extern VectorJsonBuffer global_json_buffer;
 
+/** Writes JSON text member by member into a string.
+ *
+ * The writer only keeps track of whether a separator is needed, nesting has to be balanced by the caller.
+ * Non-finite floats are written as null.
+ */
+class JsonWriter {
+ public:
+  explicit JsonWriter(std::string *out);
+
+  void begin_object();
+  void begin_object(const char *key);
+  void end_object();
+  void begin_array(const char *key);
+  void end_array();
+
+  void add(const char *key, const char *value);
+  void add(const char *key, const std::string &value);
+  void add(const char *key, bool value);
+  void add(const char *key, int value);
+  void add(const char *key, unsigned value);
+  void add(const char *key, long value);
+  void add(const char *key, unsigned long value);
+  /// Add a float, with the given number of decimals or the shortest representation if that's negative.
+  void add(const char *key, float value, int8_t accuracy_decimals = -1);
+
+  /// Add an array element.
+  void add_element(const std::string &value);
+  void add_element(float value);
+
+ protected:
+  void key_(const char *key);
+  void separator_();
+  void string_(const char *value, size_t len);
+  void float_(float value, int8_t accuracy_decimals);
+
+  std::string *out_;
+  bool need_separator_{false};
+};
+
+/** Reads the members of a JSON object one by one, in place.
+ *
+ * Nothing is copied or allocated until a value is requested, values that aren't looked at are only skipped.
+ * Reading stops at the first syntax error, so the members read before it should only be used if has_error()
+ * is false after the last member.
+ */
+class JsonReader {
+ public:
+  /// Read the members of the JSON object in data, which is not copied.
+  JsonReader(const char *data, size_t len);
+
+  /// Advance to the next member. Returns false after the last member and on syntax errors.
+  bool next();
+  bool has_error() const;
+
+  /// Whether the current member has the given key.
+  bool is_key(const char *key) const;
+  /// The value of the current member as a string, strings are unescaped and other values returned as written.
+  std::string get_string() const;
+  /// The value of the current member as a float, also parsed from strings. 0 if it isn't a number.
+  float get_float() const;
+  /// A reader for the members of the current value, which has to be an object.
+  JsonReader get_object() const;
+
+ protected:
+  void skip_whitespace_();
+  /// Skip the string that starts at the current position.
+  bool skip_string_();
+  bool skip_value_();
+  bool fail_();
+
+  const char *data_;
+  size_t len_;
+  size_t pos_{0};
+  const char *key_{nullptr};
+  size_t key_len_{0};
+  const char *value_{nullptr};
+  size_t value_len_{0};
+  bool started_{false};
+  bool done_{false};
+  bool error_{false};
+};
+
 template<typename T> class Deduplicator {
  public:
   bool next(T value);
@@ -377,6 +747,7 @@ template<typename T> class Deduplicator {
 };
 
 uint32_t fnv1_hash(const std::string &str);
+uint32_t fnv1_hash(const char *data, size_t len);
 
 // ================================================
 //                 Definitions
@@ -399,11 +770,94 @@ template<typename T, typename... Args> std::unique_ptr<T> make_unique(Args &&...
 }
 
 template<typename... Ts> void CallbackManager<void(Ts...)>::add(std::function<void(Ts...)> &&callback) {
-  this->callbacks_.push_back(std::move(callback));
+  this->add_(std::move(callback), std::false_type());
+}
+template<typename... Ts> template<typename F> void CallbackManager<void(Ts...)>::add(F &&callback) {
+  using Callable = typename std::decay<F>::type;
+  // the type traits for trivially copyable types are missing in older toolchains, use the builtins instead
+  using InlineStorage = std::integral_constant<bool, sizeof(Callable) <= CALLBACK_INLINE_SIZE &&
+                                                        alignof(Callable) <= alignof(void *) &&
+                                                        __has_trivial_copy(Callable) &&
+                                                        __has_trivial_destructor(Callable)>;
+  this->add_(std::forward<F>(callback), InlineStorage());
+}
+template<typename... Ts> void HOT CallbackManager<void(Ts...)>::call(Ts... args) {
+  for (auto &entry : this->entries_) {
+    if (entry.invoke != nullptr)
+      entry.invoke(&entry.storage, args...);
+    else
+      this->functions_[entry.function_index](args...);
+  }
+}
+template<typename... Ts>
+template<typename F>
+void CallbackManager<void(Ts...)>::invoke_(void *storage, Ts... args) {
+  (*reinterpret_cast<F *>(storage))(args...);
+}
+template<typename... Ts>
+template<typename F>
+void CallbackManager<void(Ts...)>::add_(F &&callback, std::true_type inline_storage) {
+  using Callable = typename std::decay<F>::type;
+  Entry entry{};
+  entry.invoke = &CallbackManager::invoke_<Callable>;
+  new (&entry.storage) Callable(std::forward<F>(callback));
+  this->entries_.push_back(entry);
+}
+template<typename... Ts>
+template<typename F>
+void CallbackManager<void(Ts...)>::add_(F &&callback, std::false_type inline_storage) {
+  Entry entry{};
+  entry.invoke = nullptr;
+  entry.function_index = this->functions_.size();
+  this->functions_.emplace_back(std::forward<F>(callback));
+  this->entries_.push_back(entry);
+}
+
+template<typename T> RingBuffer<T>::RingBuffer(size_t capacity) { this->set_capacity(capacity); }
+template<typename T> void RingBuffer<T>::push(T value) {
+  if (this->capacity_ == 0)
+    return;
+  size_t at = this->head_ + this->size_;
+  if (at >= this->capacity_)
+    at -= this->capacity_;
+  this->data_[at] = value;
+  if (this->size_ == this->capacity_)
+    this->head_ = at + 1 == this->capacity_ ? 0 : at + 1;
+  else
+    this->size_++;
+}
+template<typename T> void RingBuffer<T>::pop_front() {
+  if (this->size_ == 0)
+    return;
+  this->head_ = this->head_ + 1 == this->capacity_ ? 0 : this->head_ + 1;
+  this->size_--;
+}
+template<typename T> void RingBuffer<T>::clear() {
+  this->head_ = 0;
+  this->size_ = 0;
+}
+template<typename T> T RingBuffer<T>::operator[](size_t index) const {
+  size_t at = this->head_ + index;
+  if (at >= this->capacity_)
+    at -= this->capacity_;
+  return this->data_[at];
 }
-template<typename... Ts> void CallbackManager<void(Ts...)>::call(Ts... args) {
-  for (auto &cb : this->callbacks_)
-    cb(args...);
+template<typename T> T RingBuffer<T>::front() const { return this->data_[this->head_]; }
+template<typename T> size_t RingBuffer<T>::size() const { return this->size_; }
+template<typename T> bool RingBuffer<T>::empty() const { return this->size_ == 0; }
+template<typename T> bool RingBuffer<T>::full() const { return this->size_ == this->capacity_; }
+template<typename T> size_t RingBuffer<T>::capacity() const { return this->capacity_; }
+template<typename T> void RingBuffer<T>::set_capacity(size_t capacity) {
+  if (capacity == this->capacity_)
+    return;
+  std::unique_ptr<T[]> data(capacity == 0 ? nullptr : new T[capacity]);
+  const size_t size = std::min(this->size_, capacity);
+  for (size_t i = 0; i < size; i++)
+    data[i] = (*this)[this->size_ - size + i];
+  this->data_ = std::move(data);
+  this->capacity_ = capacity;
+  this->head_ = 0;
+  this->size_ = size;
 }
 
 template<typename T> bool Deduplicator<T>::next(T value) {
@@ -2,8 +2,10 @@
 
 #ifdef USE_I2C
 
+#include <algorithm>
 #include "esphome/i2c_component.h"
 #include "esphome/log.h"
+#include "esphome/metrics.h"
 
 ESPHOME_NAMESPACE_BEGIN
 
@@ -20,17 +22,50 @@ I2CComponent::I2CComponent(uint8_t sda_pin, uint8_t scl_pin, bool scan)
 #else
   this->wire_ = &Wire;
 #endif
+  i2c_buses.push_back(this);
 }
 
 void I2CComponent::set_sda_pin(uint8_t sda_pin) { this->sda_pin_ = sda_pin; }
 void I2CComponent::set_scl_pin(uint8_t scl_pin) { this->scl_pin_ = scl_pin; }
 void I2CComponent::set_scan(bool scan) { this->scan_ = scan; }
 void I2CComponent::set_frequency(uint32_t frequency) { this->frequency_ = frequency; }
+void I2CComponent::set_bus_time_budget(uint32_t budget_us) { this->bus_time_budget_ = budget_us; }
+bool I2CComponent::bus_budget_exhausted() const {
+  return this->bus_time_budget_ != 0 && this->budget_used_us_ >= this->bus_time_budget_;
+}
+const std::vector<I2CDeviceStats> &I2CComponent::get_device_stats() const { return this->device_stats_; }
+uint64_t I2CComponent::get_total_bus_us() const { return this->total_bus_us_; }
+void I2CComponent::reset_device_stats() {
+  this->device_stats_.clear();
+  this->total_bus_us_ = 0;
+}
 
 void I2CComponent::setup() {
   this->wire_->begin(this->sda_pin_, this->scl_pin_);
   this->wire_->setClock(this->frequency_);
+  if (this->bus_time_budget_ == 0)
+    this->disable_loop();
+#ifdef USE_METRICS
+  const std::string id = "sda" + to_string(this->sda_pin_);
+  global_metrics.register_counter("i2c_transactions_total", "I2C write transmissions and read requests.",
+                                  [this]() {
+                                    uint32_t transactions = 0;
+                                    for (auto &stats : this->device_stats_)
+                                      transactions += stats.transactions;
+                                    return transactions;
+                                  },
+                                  id);
+  global_metrics.register_counter("i2c_errors_total", "NACKed or short I2C transactions.",
+                                  [this]() {
+                                    uint32_t errors = 0;
+                                    for (auto &stats : this->device_stats_)
+                                      errors += stats.errors;
+                                    return errors;
+                                  },
+                                  id);
+#endif
 }
+void I2CComponent::loop() { this->budget_used_us_ = 0; }
 void I2CComponent::dump_config() {
   ESP_LOGCONFIG(TAG, "I2C Bus:");
   ESP_LOGCONFIG(TAG, "  SDA Pin: GPIO%u", this->sda_pin_);
@@ -56,16 +91,27 @@ void I2CComponent::dump_config() {
       ESP_LOGI(TAG, "Found no i2c devices!");
     }
   }
+  if (this->bus_time_budget_ != 0) {
+    ESP_LOGCONFIG(TAG, "  Bus Time Budget: %u us/loop", this->bus_time_budget_);
+  }
+  for (auto &stats : this->device_stats_) {
+    ESP_LOGCONFIG(TAG, "  Device 0x%02X: transactions=%u written=%uB read=%uB errors=%u bus_time=%ums", stats.address,
+                  stats.transactions, stats.bytes_written, stats.bytes_read, stats.errors,
+                  uint32_t(stats.bus_us / 1000));
+  }
 }
 float I2CComponent::get_setup_priority() const { return setup_priority::PRE_HARDWARE; }
 
 void I2CComponent::raw_begin_transmission(uint8_t address) {
   ESP_LOGVV(TAG, "Beginning Transmission to 0x%02X:", address);
+  this->transmission_start_ = micros();
+  this->transmission_bytes_ = 0;
   this->wire_->beginTransmission(address);
 }
-bool I2CComponent::raw_end_transmission(uint8_t address) {
-  uint8_t status = this->wire_->endTransmission();
+bool I2CComponent::raw_end_transmission(uint8_t address, bool send_stop) {
+  uint8_t status = this->wire_->endTransmission(send_stop);
   ESP_LOGVV(TAG, "    Transmission ended. Status code: 0x%02X", status);
+  this->record_transaction_(address, this->transmission_start_, this->transmission_bytes_, 0, status == 0);
 
   switch (status) {
     case 0:
@@ -88,7 +134,9 @@ bool I2CComponent::raw_end_transmission(uint8_t address) {
 }
 bool I2CComponent::raw_request_from(uint8_t address, uint8_t len) {
   ESP_LOGVV(TAG, "Requesting %u bytes from 0x%02X:", len, address);
+  const uint32_t start = micros();
   uint8_t ret = this->wire_->requestFrom(address, len);
+  this->record_transaction_(address, start, 0, ret, ret == len);
   if (ret != len) {
     ESP_LOGW(TAG, "Requesting %u bytes from 0x%02X failed!", len, address);
     return false;
@@ -96,6 +144,7 @@ bool I2CComponent::raw_request_from(uint8_t address, uint8_t len) {
   return true;
 }
 void HOT I2CComponent::raw_write(uint8_t address, const uint8_t *data, uint8_t len) {
+  this->transmission_bytes_ += len;
   for (size_t i = 0; i < len; i++) {
     ESP_LOGVV(TAG, "    Writing 0b" BYTE_TO_BINARY_PATTERN " (0x%02X)", BYTE_TO_BINARY(data[i]), data[i]);
     this->wire_->write(data[i]);
@@ -103,6 +152,7 @@ void HOT I2CComponent::raw_write(uint8_t address, const uint8_t *data, uint8_t l
   }
 }
 void HOT I2CComponent::raw_write_16(uint8_t address, const uint16_t *data, uint8_t len) {
+  this->transmission_bytes_ += len * 2;
   for (size_t i = 0; i < len; i++) {
     ESP_LOGVV(TAG, "    Writing 0b" BYTE_TO_BINARY_PATTERN BYTE_TO_BINARY_PATTERN " (0x%04X)",
               BYTE_TO_BINARY(data[i] >> 8), BYTE_TO_BINARY(data[i]), data[i]);
@@ -169,12 +219,57 @@ bool I2CComponent::write_bytes_16(uint8_t address, uint8_t a_register, const uin
   this->raw_write_16(address, data, len);
   return this->raw_end_transmission(address);
 }
+void I2CComponent::read_bytes_async(uint8_t address, uint8_t a_register, uint8_t len, uint32_t delay,
+                                    i2c_read_callback_t &&callback) {
+  len = std::min(len, I2C_MAX_READ_LENGTH);
+  if (!this->write_bytes(address, a_register, nullptr, 0)) {
+    this->defer([callback] { callback(false, nullptr, 0); });
+    return;
+  }
+  // unnamed, so that any number of reads can be pending
+  this->set_timeout(delay, [this, address, len, callback] {
+    uint8_t data[I2C_MAX_READ_LENGTH];
+    bool success = this->raw_receive(address, data, len);
+    callback(success, data, success ? len : 0);
+  });
+}
+bool I2CComponent::write_read(uint8_t address, const uint8_t *write_data, uint8_t write_len, uint8_t *read_data,
+                              uint8_t read_len) {
+  this->raw_begin_transmission(address);
+  this->raw_write(address, write_data, write_len);
+  if (!this->raw_end_transmission(address, false))
+    return false;
+  return this->raw_receive(address, read_data, read_len);
+}
 bool I2CComponent::write_byte(uint8_t address, uint8_t a_register, uint8_t data) {
   return this->write_bytes(address, a_register, &data, 1);
 }
 bool I2CComponent::write_byte_16(uint8_t address, uint8_t a_register, uint16_t data) {
   return this->write_bytes_16(address, a_register, &data, 1);
 }
+I2CDeviceStats &I2CComponent::get_stats_(uint8_t address) {
+  for (auto &stats : this->device_stats_) {
+    if (stats.address == address)
+      return stats;
+  }
+  I2CDeviceStats stats{};
+  stats.address = address;
+  this->device_stats_.push_back(stats);
+  return this->device_stats_.back();
+}
+void I2CComponent::record_transaction_(uint8_t address, uint32_t start_us, uint32_t bytes_written,
+                                       uint32_t bytes_read, bool success) {
+  const uint32_t duration = micros() - start_us;
+  I2CDeviceStats &stats = this->get_stats_(address);
+  stats.transactions++;
+  stats.bytes_written += bytes_written;
+  stats.bytes_read += bytes_read;
+  if (!success)
+    stats.errors++;
+  stats.bus_us += duration;
+  this->total_bus_us_ += duration;
+  this->budget_used_us_ += duration;
+}
 
 I2CDevice::I2CDevice(I2CComponent *parent, uint8_t address) : address_(address), parent_(parent) {}
 
@@ -203,7 +298,29 @@ bool I2CDevice::write_bytes_16(uint8_t a_register, const uint16_t *data, uint8_t
 bool I2CDevice::write_byte_16(uint8_t a_register, uint16_t data) {  // NOLINT
   return this->parent_->write_byte_16(this->address_, a_register, data);
 }
+void I2CDevice::read_bytes_async(uint8_t a_register, uint8_t len, uint32_t delay,  // NOLINT
+                                 i2c_read_callback_t &&callback) {
+  this->parent_->read_bytes_async(this->address_, a_register, len, delay, std::move(callback));
+}
+void I2CDevice::read_byte_16_async(uint8_t a_register, uint32_t delay,  // NOLINT
+                                   std::function<void(bool success, uint16_t data)> &&callback) {
+  this->parent_->read_bytes_async(this->address_, a_register, 2, delay,
+                                  [callback](bool success, const uint8_t *data, uint8_t len) {
+                                    if (!success || len != 2) {
+                                      callback(false, 0);
+                                      return;
+                                    }
+                                    callback(true, (uint16_t(data[0]) << 8) | data[1]);
+                                  });
+}
+bool I2CDevice::write_read(const uint8_t *write_data, uint8_t write_len, uint8_t *read_data,  // NOLINT
+                           uint8_t read_len) {
+  return this->parent_->write_read(this->address_, write_data, write_len, read_data, read_len);
+}
 void I2CDevice::set_parent(I2CComponent *parent) { this->parent_ = parent; }
+bool I2CDevice::bus_budget_exhausted() const { return this->parent_->bus_budget_exhausted(); }
+
+std::vector<I2CComponent *> i2c_buses;
 
 #ifdef ARDUINO_ARCH_ESP32
 uint8_t next_i2c_bus_num_ = 0;
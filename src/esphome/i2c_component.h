@@ -5,6 +5,8 @@
 
 #ifdef USE_I2C
 
+#include <functional>
+#include <vector>
 #include "esphome/component.h"
 #include <Wire.h>
 
@@ -12,6 +14,25 @@ ESPHOME_NAMESPACE_BEGIN
 
 #define LOG_I2C_DEVICE(this) ESP_LOGCONFIG(TAG, "  Address: 0x%02X", this->address_);
 
+/// Called with whether an asynchronous read succeeded and the bytes that were read.
+using i2c_read_callback_t = std::function<void(bool success, const uint8_t *data, uint8_t len)>;
+
+/// The most bytes one transaction can read, the size of the Wire buffer.
+static const uint8_t I2C_MAX_READ_LENGTH = 32;
+
+/// Transaction counters of one device (address) on an i2c bus.
+struct I2CDeviceStats {
+  uint8_t address;
+  /// Number of write transmissions and read requests.
+  uint32_t transactions{0};
+  uint32_t bytes_written{0};
+  uint32_t bytes_read{0};
+  /// Number of NACKed or short transactions.
+  uint32_t errors{0};
+  /// Time spent on the wire for this device, in µs.
+  uint64_t bus_us{0};
+};
+
 /** The I2CComponent is the base of ESPHome's i2c communication.
  *
  * It handles setting up the bus (with pins, clock frequency) and provides nice helper functions to
@@ -94,13 +115,35 @@ class I2CComponent : public Component {
   /// Write a single 16-bit word of data into the specified register of address. Return true if successful.
   bool write_byte_16(uint8_t address, uint8_t a_register, uint16_t data);
 
+  /** Select a register (or send a command) now and read len bytes after delay ms, without blocking.
+   *
+   * The read is scheduled with the scheduler of this bus, so the loop keeps running while the device is busy,
+   * for example with a conversion. The callback is always called from the loop, also if writing the register
+   * fails.
+   *
+   * @param address The address of the device.
+   * @param a_register The register or command to write.
+   * @param len The number of bytes to read, at most I2C_MAX_READ_LENGTH.
+   * @param delay The number of ms to wait between the write and the read.
+   * @param callback Called with the result.
+   */
+  void read_bytes_async(uint8_t address, uint8_t a_register, uint8_t len, uint32_t delay,
+                        i2c_read_callback_t &&callback);
+
+  /** Write write_len bytes and read read_len bytes in one transaction, with a repeated start in between.
+   *
+   * @return Whether both the write and the read were successful.
+   */
+  bool write_read(uint8_t address, const uint8_t *write_data, uint8_t write_len, uint8_t *read_data,
+                  uint8_t read_len);
+
   // ========== INTERNAL METHODS ==========
   // (In most use cases you won't need these)
   /// Begin a write transmission to an address.
   void raw_begin_transmission(uint8_t address);
 
   /// End a write transmission to an address, return true if successful.
-  bool raw_end_transmission(uint8_t address);
+  bool raw_end_transmission(uint8_t address, bool send_stop = true);
 
   /** Request data from an address with a number of (8-bit) bytes.
    *
@@ -122,20 +165,56 @@ class I2CComponent : public Component {
   /// Request len amount of 16-bit words from address and write the result into data. Returns true iff was successful.
   bool raw_receive_16(uint8_t address, uint16_t *data, uint8_t len);
 
+  /** Limit the time low-priority devices may use the bus within one loop iteration.
+   *
+   * Devices that poll often but aren't time critical (like gesture polling) check bus_budget_exhausted()
+   * and skip their transaction for this iteration if the bus has already been busy for longer than this.
+   * All transactions count towards the budget. 0 (the default) disables the budget.
+   *
+   * @param budget_us The bus time per loop iteration in µs.
+   */
+  void set_bus_time_budget(uint32_t budget_us);
+
+  /// Whether the bus has been used for longer than the bus time budget since the last loop iteration.
+  bool bus_budget_exhausted() const;
+
+  /// The transaction counters of all devices that have used this bus.
+  const std::vector<I2CDeviceStats> &get_device_stats() const;
+  /// The total time the bus has been busy since boot, in µs.
+  uint64_t get_total_bus_us() const;
+  void reset_device_stats();
+
   /// Setup the i2c. bus
   void setup() override;
   void dump_config() override;
+  /// Reset the bus time budget, loop() is only enabled if a budget is set.
+  void loop() override;
   /// Set a very high setup priority to make sure it's loaded before all other hardware.
   float get_setup_priority() const override;
 
  protected:
+  I2CDeviceStats &get_stats_(uint8_t address);
+  /// Account a finished transaction, started at start_us (micros()).
+  void record_transaction_(uint8_t address, uint32_t start_us, uint32_t bytes_written, uint32_t bytes_read,
+                           bool success);
+
   TwoWire *wire_;
   uint8_t sda_pin_;
   uint8_t scl_pin_;
   bool scan_;
   uint32_t frequency_{50000};
+  std::vector<I2CDeviceStats> device_stats_;
+  uint64_t total_bus_us_{0};
+  /// Start (micros()) and number of bytes of the write transmission being built.
+  uint32_t transmission_start_{0};
+  uint32_t transmission_bytes_{0};
+  uint32_t bus_time_budget_{0};
+  uint32_t budget_used_us_{0};
 };
 
+/// All i2c buses, for reporting statistics.
+extern std::vector<I2CComponent *> i2c_buses;
+
 #ifdef ARDUINO_ARCH_ESP32
 extern uint8_t next_i2c_bus_num_;
 #endif
@@ -159,6 +238,9 @@ class I2CDevice {
   void set_parent(I2CComponent *parent);
 
  protected:
+  /// Whether a low-priority device should skip its transaction this loop iteration, see set_bus_time_budget().
+  bool bus_budget_exhausted() const;
+
   /** Read len amount of bytes from a register into data. Optionally with a conversion time after
    * writing the register value to the bus.
    *
@@ -210,6 +292,16 @@ class I2CDevice {
   /// Write a single 16-bit word of data into the specified register. Return true if successful.
   bool write_byte_16(uint8_t a_register, uint16_t data);  // NOLINT
 
+  /// Select a register and read len bytes after delay ms without blocking, see I2CComponent::read_bytes_async.
+  void read_bytes_async(uint8_t a_register, uint8_t len, uint32_t delay, i2c_read_callback_t &&callback);  // NOLINT
+
+  /// Select a register and read a 16-bit word (MSB first) after delay ms without blocking.
+  void read_byte_16_async(uint8_t a_register, uint32_t delay,  // NOLINT
+                          std::function<void(bool success, uint16_t data)> &&callback);
+
+  /// Write and read in one transaction with a repeated start, see I2CComponent::write_read.
+  bool write_read(const uint8_t *write_data, uint8_t write_len, uint8_t *read_data, uint8_t read_len);  // NOLINT
+
   uint8_t address_;
   I2CComponent *parent_;
 };
@@ -11,6 +11,8 @@ namespace io {
 
 static const char *TAG = "io.mcp23017";
 
+static const uint8_t MCP23017_IOCON_MIRROR = 0x40;
+
 MCP23017::MCP23017(I2CComponent *parent, uint8_t address) : Component(), I2CDevice(parent, address) {}
 MCP23017GPIOInputPin MCP23017::make_input_pin(uint8_t pin, uint8_t mode, bool inverted) {
   return {this, pin, mode, inverted};
@@ -29,21 +31,49 @@ void MCP23017::setup() {
   // all pins input
   this->write_reg_(MCP23017_IODIRA, 0xFF);
   this->write_reg_(MCP23017_IODIRB, 0xFF);
+
+  if (this->interrupt_pin_ != nullptr) {
+    // INTA and INTB both report changes of any port, active low. The inputs interrupt on change as their pin
+    // mode is set.
+    this->write_reg_(MCP23017_IOCONA, iocon | MCP23017_IOCON_MIRROR);
+    this->interrupt_pin_->setup();
+    this->interrupt_pin_->attach_interrupt(MCP23017::gpio_intr, this, FALLING);
+  }
+}
+void MCP23017::loop() {
+  if (this->interrupt_pin_ == nullptr || this->input_changed_)
+    this->read_valid_ = false;
+  if (this->write_pending_)
+    this->write_olat_();
 }
 bool MCP23017::digital_read(uint8_t pin) {
-  uint8_t bit = pin % 8;
-  uint8_t reg_addr = pin < 8 ? MCP23017_GPIOA : MCP23017_GPIOB;
-  uint8_t value = 0;
-  this->read_reg_(reg_addr, &value);
-  return value & (1 << bit);
+  if (!this->read_valid_ && !this->is_failed()) {
+    // clear first, a change while reading triggers the next read
+    this->input_changed_ = false;
+    // GPIOB follows GPIOA, both ports are read in one transaction
+    uint8_t data[2];
+    this->read_valid_ = this->read_bytes(MCP23017_GPIOA, data, 2);
+    if (this->read_valid_)
+      this->input_mask_ = data[0] | (uint16_t(data[1]) << 8);
+  }
+  return this->input_mask_ & (1 << pin);
 }
 void MCP23017::digital_write(uint8_t pin, bool value) {
-  uint8_t reg_addr = pin < 8 ? MCP23017_OLATA : MCP23017_OLATB;
-  this->update_reg_(pin, value, reg_addr);
+  uint8_t &olat = pin < 8 ? this->olat_a_ : this->olat_b_;
+  if (value)
+    olat |= 1 << (pin % 8);
+  else
+    olat &= ~(1 << (pin % 8));
+  // all writes of a loop cycle are sent together in loop()
+  this->write_pending_ = true;
 }
 void MCP23017::pin_mode(uint8_t pin, uint8_t mode) {
   uint8_t iodir = pin < 8 ? MCP23017_IODIRA : MCP23017_IODIRB;
   uint8_t gppu = pin < 8 ? MCP23017_GPPUA : MCP23017_GPPUB;
+  if (this->interrupt_pin_ != nullptr) {
+    uint8_t gpinten = pin < 8 ? MCP23017_GPINTENA : MCP23017_GPINTENB;
+    this->update_reg_(pin, mode != MCP23017_OUTPUT, gpinten);
+  }
   switch (mode) {
     case MCP23017_INPUT:
       this->update_reg_(pin, true, iodir);
@@ -59,6 +89,7 @@ void MCP23017::pin_mode(uint8_t pin, uint8_t mode) {
       break;
   }
 }
+void MCP23017::set_interrupt_pin(const GPIOInputPin &interrupt_pin) { this->interrupt_pin_ = interrupt_pin.copy(); }
 float MCP23017::get_setup_priority() const { return setup_priority::HARDWARE; }
 bool MCP23017::read_reg_(uint8_t reg, uint8_t *value) {
   if (this->is_failed())
@@ -72,6 +103,21 @@ bool MCP23017::write_reg_(uint8_t reg, uint8_t value) {
 
   return this->write_byte(reg, value);
 }
+bool MCP23017::write_olat_() {
+  if (this->is_failed())
+    return false;
+
+  // OLATB follows OLATA
+  const uint8_t data[2] = {this->olat_a_, this->olat_b_};
+  if (!this->write_bytes(MCP23017_OLATA, data, 2)) {
+    this->status_set_warning();
+    return false;
+  }
+  this->write_pending_ = false;
+  this->status_clear_warning();
+  return true;
+}
+void ICACHE_RAM_ATTR MCP23017::gpio_intr(MCP23017 *arg) { arg->input_changed_ = true; }
 void MCP23017::update_reg_(uint8_t pin, bool pin_value, uint8_t reg_addr) {
   uint8_t bit = pin % 8;
   uint8_t reg_value = 0;
@@ -58,7 +58,16 @@ class MCP23017 : public Component, public I2CDevice {
 
   MCP23017GPIOOutputPin make_output_pin(uint8_t pin, bool inverted = false);
 
+  /** Set the pin the INTA or INTB output of the MCP23017 is connected to (both are mirrored).
+   *
+   * Without it the inputs are read at most once per loop cycle when a pin is read, with it only after the
+   * MCP23017 reported a change of an input.
+   */
+  void set_interrupt_pin(const GPIOInputPin &interrupt_pin);
+
   void setup() override;
+  /// Invalidate the cached inputs and send the batched writes.
+  void loop() override;
 
   bool digital_read(uint8_t pin);
   void digital_write(uint8_t pin, bool value);
@@ -73,9 +82,22 @@ class MCP23017 : public Component, public I2CDevice {
   bool write_reg_(uint8_t reg, uint8_t value);
   // update registers with given pin value.
   void update_reg_(uint8_t pin, bool pin_value, uint8_t reg_a);
+  /// Write OLATA and OLATB in one transaction.
+  bool write_olat_();
+
+  static void gpio_intr(MCP23017 *arg);
 
   uint8_t olat_a_{0x00};
   uint8_t olat_b_{0x00};
+  /// The last read GPIOA (low byte) and GPIOB (high byte).
+  uint16_t input_mask_{0x0000};
+  GPIOPin *interrupt_pin_{nullptr};
+  /// Set by the INT interrupt, cleared when the inputs are read.
+  volatile bool input_changed_{false};
+  /// Whether input_mask_ is up to date for this loop cycle.
+  bool read_valid_{false};
+  /// Whether the output latches have changed since the last write.
+  bool write_pending_{false};
 };
 
 class MCP23017GPIOInputPin : public GPIOInputPin {
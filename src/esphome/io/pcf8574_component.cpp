@@ -28,19 +28,35 @@ void PCF8574Component::setup() {
     return;
   }
 
+  if (this->interrupt_pin_ != nullptr) {
+    this->interrupt_pin_->setup();
+    this->interrupt_pin_->attach_interrupt(PCF8574Component::gpio_intr, this, FALLING);
+  }
+
   this->write_gpio_();
-  this->read_gpio_();
+  this->read_valid_ = this->read_gpio_();
+}
+void PCF8574Component::loop() {
+  if (this->interrupt_pin_ == nullptr || this->input_changed_)
+    this->read_valid_ = false;
+  if (this->write_pending_)
+    this->write_gpio_();
 }
 void PCF8574Component::dump_config() {
   ESP_LOGCONFIG(TAG, "PCF8574:");
   ESP_LOGCONFIG(TAG, "    Address: 0x%02X", this->address_);
   ESP_LOGCONFIG(TAG, "    Is PCF8575: %s", YESNO(this->pcf8575_));
+  LOG_PIN("    Interrupt Pin: ", this->interrupt_pin_);
   if (this->is_failed()) {
     ESP_LOGE(TAG, "Communication with PCF8574 failed!");
   }
 }
 bool PCF8574Component::digital_read(uint8_t pin) {
-  this->read_gpio_();
+  if (!this->read_valid_) {
+    // clear first, a change while reading triggers the next read
+    this->input_changed_ = false;
+    this->read_valid_ = this->read_gpio_();
+  }
   return this->input_mask_ & (1 << pin);
 }
 void PCF8574Component::digital_write(uint8_t pin, bool value) {
@@ -49,8 +65,8 @@ void PCF8574Component::digital_write(uint8_t pin, bool value) {
   } else {
     this->port_mask_ &= ~(1 << pin);
   }
-
-  this->write_gpio_();
+  // all writes of a loop cycle are sent together in loop()
+  this->write_pending_ = true;
 }
 void PCF8574Component::pin_mode(uint8_t pin, uint8_t mode) {
   switch (mode) {
@@ -111,15 +127,20 @@ bool PCF8574Component::write_gpio_() {
     this->status_set_warning();
     return false;
   }
+  this->write_pending_ = false;
   this->status_clear_warning();
   return true;
 }
+void ICACHE_RAM_ATTR PCF8574Component::gpio_intr(PCF8574Component *arg) { arg->input_changed_ = true; }
 PCF8574GPIOInputPin PCF8574Component::make_input_pin(uint8_t pin, uint8_t mode, bool inverted) {
   return {this, pin, mode, inverted};
 }
 PCF8574GPIOOutputPin PCF8574Component::make_output_pin(uint8_t pin, bool inverted) {
   return {this, pin, PCF8574_OUTPUT, inverted};
 }
+void PCF8574Component::set_interrupt_pin(const GPIOInputPin &interrupt_pin) {
+  this->interrupt_pin_ = interrupt_pin.copy();
+}
 float PCF8574Component::get_setup_priority() const { return setup_priority::HARDWARE; }
 
 void PCF8574GPIOInputPin::setup() { this->pin_mode(this->mode_); }
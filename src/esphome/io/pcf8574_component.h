@@ -52,10 +52,19 @@ class PCF8574Component : public Component, public I2CDevice {
    */
   PCF8574GPIOOutputPin make_output_pin(uint8_t pin, bool inverted = false);
 
+  /** Set the pin the INT output of the PCF8574 is connected to.
+   *
+   * Without it the inputs are read at most once per loop cycle when a pin is read, with it only after the
+   * PCF8574 reported a change.
+   */
+  void set_interrupt_pin(const GPIOInputPin &interrupt_pin);
+
   // ========== INTERNAL METHODS ==========
   // (In most use cases you won't need these)
   /// Check i2c availability and setup masks
   void setup() override;
+  /// Invalidate the cached inputs and send the batched writes.
+  void loop() override;
   /// Helper function to read the value of a pin.
   bool digital_read(uint8_t pin);
   /// Helper function to write the value of a pin.
@@ -72,6 +81,15 @@ class PCF8574Component : public Component, public I2CDevice {
 
   bool write_gpio_();
 
+  static void gpio_intr(PCF8574Component *arg);
+
+  GPIOPin *interrupt_pin_{nullptr};
+  /// Set by the INT interrupt, cleared when the inputs are read.
+  volatile bool input_changed_{false};
+  /// Whether input_mask_ is up to date for this loop cycle.
+  bool read_valid_{false};
+  /// Whether port_mask_ has changed since the last write.
+  bool write_pending_{false};
   uint16_t ddr_mask_{0x00};
   uint16_t input_mask_{0x00};
   uint16_t port_mask_{0x00};
@@ -3,13 +3,19 @@
 #ifdef USE_LIGHT
 
 #include "esphome/light/addressable_light.h"
+#include "esphome/light/palette.h"
 #include "esphome/log.h"
 #include "esphome/helpers.h"
 
+#include <cstring>
+
 ESPHOME_NAMESPACE_BEGIN
 
 namespace light {
 
+/// Fills with at least this many pixels build the hue table, see AddressableLight::get_rainbow_table_().
+static const int32_t RAINBOW_TABLE_MIN_PIXELS = 128;
+
 ESPColor HOT ESPColor::random_color() {
   uint32_t rand = random_uint32();
   uint8_t w = rand >> 24;
@@ -88,11 +94,54 @@ ESPColor HOT ESPHSVColor::to_rgb() const {
   return rgb;
 }
 
-ESPColorCorrection::ESPColorCorrection() : max_brightness_(255, 255, 255, 255) {}
+ESPColorCorrection::ESPColorCorrection() : max_brightness_(255, 255, 255, 255) { this->calculate_gamma_table(0.0f); }
+
+void ESPColorCorrection::set_local_brightness(uint8_t local_brightness) {
+  if (local_brightness == this->local_brightness_)
+    return;
+  this->local_brightness_ = local_brightness;
+  this->update_correct_tables_();
+}
+
+void ESPColorCorrection::set_max_brightness(const ESPColor &max_brightness) {
+  this->max_brightness_ = max_brightness;
+  this->update_correct_tables_();
+}
 
-void ESPColorCorrection::set_local_brightness(uint8_t local_brightness) { this->local_brightness_ = local_brightness; }
+void HOT ESPColorCorrection::update_correct_tables_() {
+  // corrected = (uncorrected * max_brightness * local_brightness) ^ gamma
+  for (uint8_t c = 0; c < 3; c++) {
+    const uint8_t max_brightness = this->max_brightness_.raw[c];
+    for (uint16_t i = 0; i < 256; i++) {
+      this->correct_table_[c][i] = this->gamma_table_[esp_scale8(esp_scale8(i, max_brightness), this->local_brightness_)];
+    }
+  }
+  // do not scale white value with brightness
+  for (uint16_t i = 0; i < 256; i++)
+    this->correct_table_[3][i] = this->gamma_table_[esp_scale8(i, this->max_brightness_.white)];
+  this->uncorrect_tables_valid_ = false;
+}
 
-void ESPColorCorrection::set_max_brightness(const ESPColor &max_brightness) { this->max_brightness_ = max_brightness; }
+void HOT ESPColorCorrection::update_uncorrect_tables_() const {
+  // uncorrected = corrected^(1/gamma) / (max_brightness * local_brightness)
+  for (uint8_t c = 0; c < 4; c++) {
+    const uint8_t max_brightness = this->max_brightness_.raw[c];
+    // white is not scaled by the brightness
+    const uint8_t local_brightness = c == 3 ? 255 : this->local_brightness_;
+    for (uint16_t i = 0; i < 256; i++) {
+      if (max_brightness == 0 || local_brightness == 0) {
+        this->uncorrect_table_[c][i] = 0;
+        continue;
+      }
+      uint16_t uncorrected = this->gamma_reverse_table_[i] * 255UL;
+      if (c == 3)
+        this->uncorrect_table_[c][i] = uncorrected / max_brightness;
+      else
+        this->uncorrect_table_[c][i] = ((uncorrected / max_brightness) * 255UL) / local_brightness;
+    }
+  }
+  this->uncorrect_tables_valid_ = true;
+}
 
 void ESPColorCorrection::calculate_gamma_table(float gamma) {
   for (uint16_t i = 0; i < 256; i++) {
@@ -103,6 +152,7 @@ void ESPColorCorrection::calculate_gamma_table(float gamma) {
   if (gamma == 0.0f) {
     for (uint16_t i = 0; i < 256; i++)
       this->gamma_reverse_table_[i] = i;
+    this->update_correct_tables_();
     return;
   }
   for (uint16_t i = 0; i < 256; i++) {
@@ -110,6 +160,7 @@ void ESPColorCorrection::calculate_gamma_table(float gamma) {
     auto uncorrected = static_cast<uint8_t>(roundf(255.0f * powf(i / 255.0f, 1.0f / gamma)));
     this->gamma_reverse_table_[i] = uncorrected;
   }
+  this->update_correct_tables_();
 }
 
 AddressableLight::AddressableLight() = default;
@@ -119,21 +170,20 @@ bool AddressableLight::is_effect_active() const { return this->effect_active_; }
 void AddressableLight::set_effect_active(bool effect_active) { this->effect_active_ = effect_active; }
 void AddressableLight::write_state(LightState *state) {
   auto val = state->current_values;
-  auto max_brightness = static_cast<uint8_t>(roundf(val.get_brightness() * val.get_state() * 255.0f));
-  this->correction_.set_local_brightness(max_brightness);
+  // Q16 to 8 bit is a plain shift, exact for both ends of the range and for all 8 bit inputs
+  uint16_t brightness;
+  val.as_brightness_q16(&brightness);
+  this->correction_.set_local_brightness(brightness >> 8);
 
   if (this->is_effect_active())
     return;
 
   // don't use LightState helper, gamma correction+brightness is handled by ESPColorView
-  ESPColor color = ESPColor(uint8_t(roundf(val.get_red() * 255.0f)), uint8_t(roundf(val.get_green() * 255.0f)),
-                            uint8_t(roundf(val.get_blue() * 255.0f)),
+  ESPColor color = ESPColor(val.get_red_q16() >> 8, val.get_green_q16() >> 8, val.get_blue_q16() >> 8,
                             // white is not affected by brightness; so manually scale by state
-                            uint8_t(roundf(val.get_white() * val.get_state() * 255.0f)));
+                            q16_mul(val.get_white_q16(), val.get_state_q16()) >> 8);
 
-  for (int i = 0; i < this->size(); i++) {
-    (*this)[i] = color;
-  }
+  this->range_fill(0, this->size(), color);
 
   this->schedule_show();
 }
@@ -145,8 +195,207 @@ void AddressableLight::setup_state(LightState *state) {
   this->correction_.calculate_gamma_table(state->get_gamma_correct());
 }
 void AddressableLight::schedule_show() { this->next_show_ = true; }
-bool AddressableLight::should_show_() const { return this->effect_active_ || this->next_show_; }
-void AddressableLight::mark_shown_() { this->next_show_ = false; }
+void AddressableLight::schedule_show_if_changed() { this->next_show_if_changed_ = true; }
+bool AddressableLight::get_raw_pixels_(RawPixels *raw) const { return false; }
+bool AddressableLight::clamp_range_(int32_t *from, int32_t *to) const {
+  *from = std::max(*from, int32_t(0));
+  *to = std::min(*to, this->size());
+  return *from < *to;
+}
+void HOT AddressableLight::range_fill(int32_t from, int32_t to, const ESPColor &color) {
+  if (!this->clamp_range_(&from, &to))
+    return;
+  RawPixels raw{};
+  if (!this->get_raw_pixels_(&raw)) {
+    for (int32_t i = from; i < to; i++)
+      (*this)[i] = color;
+    return;
+  }
+
+  const ESPColor corrected = this->correction_.color_correct(color);
+  uint8_t pixel[4];
+  for (uint8_t c = 0; c < raw.stride; c++)
+    pixel[raw.offsets[c]] = corrected.raw[c];
+  uint8_t *dst = raw.data + from * raw.stride;
+  int32_t count = to - from;
+  if (raw.stride == 4) {
+    uint32_t word;
+    memcpy(&word, pixel, 4);
+    for (; count > 0; count--, dst += 4)
+      memcpy(dst, &word, 4);
+    return;
+  }
+
+  // RGB: write four pixels at a time as three words
+  uint32_t pattern[3];
+  auto *pattern_bytes = reinterpret_cast<uint8_t *>(pattern);
+  for (uint8_t i = 0; i < 12; i++)
+    pattern_bytes[i] = pixel[i % 3];
+  for (; count >= 4; count -= 4, dst += 12)
+    memcpy(dst, pattern, 12);
+  for (; count > 0; count--, dst += 3)
+    memcpy(dst, pixel, 3);
+}
+void HOT AddressableLight::range_fill_gradient(int32_t from, int32_t to, const ESPColor &start, const ESPColor &end) {
+  const int32_t first = from;
+  const int32_t steps = std::max(to - from - 1, int32_t(1));
+  if (!this->clamp_range_(&from, &to))
+    return;
+  RawPixels raw{};
+  const bool has_raw = this->get_raw_pixels_(&raw);
+  for (int32_t i = from; i < to; i++) {
+    ESPColor color;
+    for (uint8_t c = 0; c < 4; c++)
+      color.raw[c] = start.raw[c] + (int32_t(end.raw[c]) - int32_t(start.raw[c])) * (i - first) / steps;
+    if (!has_raw) {
+      (*this)[i] = color;
+      continue;
+    }
+    const ESPColor corrected = this->correction_.color_correct(color);
+    uint8_t *dst = raw.data + i * raw.stride;
+    for (uint8_t c = 0; c < raw.stride; c++)
+      dst[raw.offsets[c]] = corrected.raw[c];
+  }
+}
+void HOT AddressableLight::range_fill_rainbow(int32_t from, int32_t to, uint16_t hue, uint16_t hue_delta,
+                                              uint8_t saturation, uint8_t value) {
+  if (from < 0) {
+    hue += uint16_t(-from) * hue_delta;
+    from = 0;
+  }
+  if (!this->clamp_range_(&from, &to))
+    return;
+  RawPixels raw{};
+  const bool has_raw = this->get_raw_pixels_(&raw);
+  const ESPColor *table = this->get_rainbow_table_(saturation, value, to - from);
+  ESPHSVColor hsv(0, saturation, value);
+  for (int32_t i = from; i < to; i++, hue += hue_delta) {
+    hsv.hue = hue >> 8;
+    const ESPColor rgb = table != nullptr ? table[hsv.hue] : hsv.to_rgb();
+    if (!has_raw) {
+      (*this)[i].set_rgb(rgb.r, rgb.g, rgb.b);
+      continue;
+    }
+    uint8_t *dst = raw.data + i * raw.stride;
+    dst[raw.offsets[0]] = this->correction_.color_correct_red(rgb.r);
+    dst[raw.offsets[1]] = this->correction_.color_correct_green(rgb.g);
+    dst[raw.offsets[2]] = this->correction_.color_correct_blue(rgb.b);
+  }
+}
+void HOT AddressableLight::range_fill_palette(int32_t from, int32_t to, const ESPPalette &palette, uint16_t index,
+                                              uint16_t index_delta, uint8_t brightness) {
+  if (from < 0) {
+    index += uint16_t(-from) * index_delta;
+    from = 0;
+  }
+  if (!this->clamp_range_(&from, &to))
+    return;
+  RawPixels raw{};
+  const bool has_raw = this->get_raw_pixels_(&raw);
+  for (int32_t i = from; i < to; i++, index += index_delta) {
+    ESPColor rgb = palette.color_at(index >> 8);
+    if (brightness != 255)
+      rgb *= brightness;
+    if (!has_raw) {
+      (*this)[i].set_rgb(rgb.r, rgb.g, rgb.b);
+      continue;
+    }
+    uint8_t *dst = raw.data + i * raw.stride;
+    dst[raw.offsets[0]] = this->correction_.color_correct_red(rgb.r);
+    dst[raw.offsets[1]] = this->correction_.color_correct_green(rgb.g);
+    dst[raw.offsets[2]] = this->correction_.color_correct_blue(rgb.b);
+  }
+}
+const ESPColor *AddressableLight::get_rainbow_table_(uint8_t saturation, uint8_t value, int32_t count) {
+  const bool valid = this->rainbow_table_ != nullptr && this->rainbow_saturation_ == saturation &&
+                     this->rainbow_value_ == value;
+  if (valid)
+    return this->rainbow_table_.get();
+  if (count < RAINBOW_TABLE_MIN_PIXELS)
+    return nullptr;
+  if (this->rainbow_table_ == nullptr)
+    this->rainbow_table_.reset(new ESPColor[256]);
+  for (uint16_t hue = 0; hue < 256; hue++)
+    this->rainbow_table_[hue] = ESPHSVColor(hue, saturation, value).to_rgb();
+  this->rainbow_saturation_ = saturation;
+  this->rainbow_value_ = value;
+  return this->rainbow_table_.get();
+}
+void HOT AddressableLight::range_scale(int32_t from, int32_t to, uint8_t scale) {
+  if (!this->clamp_range_(&from, &to))
+    return;
+  RawPixels raw{};
+  if (!this->get_raw_pixels_(&raw)) {
+    for (int32_t i = from; i < to; i++) {
+      ESPColorView view = (*this)[i];
+      view = view.get() * scale;
+    }
+    return;
+  }
+
+  // all channels are scaled the same way, so the pixels can be treated as one byte array
+  uint8_t *dst = raw.data + from * raw.stride;
+  uint8_t *end = raw.data + to * raw.stride;
+  const uint32_t mult = uint32_t(scale) + 1;
+  for (; dst != end && (reinterpret_cast<uintptr_t>(dst) & 3) != 0; dst++)
+    *dst = esp_scale8(*dst, scale);
+  for (; end - dst >= 4; dst += 4) {
+    // scale two bytes at a time in 16-bit lanes
+    uint32_t word;
+    memcpy(&word, dst, 4);
+    const uint32_t even = (((word & 0x00FF00FFUL) * mult) >> 8) & 0x00FF00FFUL;
+    const uint32_t odd = (((word >> 8) & 0x00FF00FFUL) * mult) & 0xFF00FF00UL;
+    word = even | odd;
+    memcpy(dst, &word, 4);
+  }
+  for (; dst != end; dst++)
+    *dst = esp_scale8(*dst, scale);
+}
+void HOT AddressableLight::range_blend(int32_t from, int32_t to, const ESPColor *colors, uint8_t amount) {
+  const int32_t first = from;
+  if (!this->clamp_range_(&from, &to))
+    return;
+  RawPixels raw{};
+  const bool has_raw = this->get_raw_pixels_(&raw);
+  for (int32_t i = from; i < to; i++) {
+    const ESPColor &target = colors[i - first];
+    if (!has_raw) {
+      ESPColorView view = (*this)[i];
+      const ESPColor current = view.get();
+      ESPColor color;
+      for (uint8_t c = 0; c < 4; c++)
+        color.raw[c] = current.raw[c] + (int32_t(target.raw[c]) - int32_t(current.raw[c])) * amount / 256;
+      view = color;
+      continue;
+    }
+    const ESPColor corrected = this->correction_.color_correct(target);
+    uint8_t *dst = raw.data + i * raw.stride;
+    for (uint8_t c = 0; c < raw.stride; c++) {
+      uint8_t &current = dst[raw.offsets[c]];
+      current = current + (int32_t(corrected.raw[c]) - int32_t(current)) * amount / 256;
+    }
+  }
+}
+bool HOT AddressableLight::should_show_() {
+  if (!this->effect_active_ && !this->next_show_ && !this->next_show_if_changed_)
+    return false;
+
+  RawPixels raw{};
+  if (!this->get_raw_pixels_(&raw))
+    return true;
+  this->pending_hash_ = fnv1_hash(reinterpret_cast<const char *>(raw.data), size_t(this->size()) * raw.stride);
+  if (this->next_show_ || !this->has_shown_ || this->pending_hash_ != this->shown_hash_)
+    return true;
+  // nothing changed since the last show
+  this->next_show_if_changed_ = false;
+  return false;
+}
+void AddressableLight::mark_shown_() {
+  this->next_show_ = false;
+  this->next_show_if_changed_ = false;
+  this->shown_hash_ = this->pending_hash_;
+  this->has_shown_ = true;
+}
 
 int32_t PartitionLightOutput::size() const {
   auto &last_seg = this->segments_[this->segments_.size() - 1];
@@ -191,12 +440,19 @@ PartitionLightOutput::PartitionLightOutput(const std::vector<AddressableSegment>
 }
 void PartitionLightOutput::loop() {
   if (this->should_show_()) {
-    for (auto seg : this->segments_) {
-      seg.get_src()->schedule_show();
+    // Only flags the lights, so each of them is shown once even if it has multiple segments.
+    // While an effect runs, the lights check themselves if anything changed.
+    const bool changed = this->next_show_;
+    for (auto &seg : this->segments_) {
+      if (changed)
+        seg.get_src()->schedule_show();
+      else
+        seg.get_src()->schedule_show_if_changed();
     }
     this->mark_shown_();
   }
 }
+float PartitionLightOutput::get_loop_priority() const { return 1.0f; }
 
 AddressableSegment::AddressableSegment(LightState *src, int32_t src_offset, int32_t size)
     : src_(static_cast<AddressableLight *>(src->get_output())), src_offset_(src_offset), size_(size) {}
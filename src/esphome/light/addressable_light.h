@@ -14,6 +14,8 @@ namespace light {
 
 inline static uint8_t esp_scale8(uint8_t i, uint8_t scale) ALWAYS_INLINE;
 
+class ESPPalette;
+
 struct ESPColor {
   union {
     struct {
@@ -83,6 +85,12 @@ struct ESPHSVColor {
   ESPColor to_rgb() const;
 };
 
+/** Color correction (max brightness, brightness and gamma) of addressable lights.
+ *
+ * The brightness values are folded into one lookup table per channel together with the gamma table, so
+ * correcting a channel is a single lookup. The tables are only rebuilt if one of the values changes, the inverse
+ * tables for reading pixels back only when they're first needed after a change.
+ */
 class ESPColorCorrection {
  public:
   ESPColorCorrection();
@@ -101,8 +109,17 @@ class ESPColorCorrection {
   inline uint8_t color_uncorrect_white(uint8_t white) const ALWAYS_INLINE;
 
  protected:
+  void update_correct_tables_();
+  void update_uncorrect_tables_() const;
+  inline void ensure_uncorrect_tables_() const ALWAYS_INLINE;
+
   uint8_t gamma_table_[256];
   uint8_t gamma_reverse_table_[256];
+  /// Per channel (red, green, blue, white): uncorrected -> corrected.
+  uint8_t correct_table_[4][256];
+  /// Per channel: corrected -> uncorrected.
+  mutable uint8_t uncorrect_table_[4][256];
+  mutable bool uncorrect_tables_valid_{false};
   ESPColor max_brightness_;
   uint8_t local_brightness_{255};
 };
@@ -151,14 +168,73 @@ class AddressableLight : public LightOutput {
   void set_correction(float red, float green, float blue, float white = 1.0f);
   void setup_state(LightState *state) override;
   void schedule_show();
+  /// Show on the next loop, but only if the pixels changed since they were last shown.
+  void schedule_show_if_changed();
+
+  /** Bulk operations on the pixels in [from, to).
+   *
+   * These work directly on the pixel buffer of the output if possible (see get_raw_pixels_()), so they're much faster
+   * than setting each pixel through operator[]. Colors are in the same uncorrected space as for ESPColorView.
+   */
+  /// Set all pixels to color, the color correction is only calculated once.
+  void range_fill(int32_t from, int32_t to, const ESPColor &color);
+  /// Fill with a linear gradient from start (first pixel) to end (last pixel).
+  void range_fill_gradient(int32_t from, int32_t to, const ESPColor &start, const ESPColor &end);
+  /** Fill with a rainbow beginning at hue (in 1/256 steps of ESPHSVColor::hue), increasing by hue_delta per pixel.
+   *
+   * For long ranges, the colors of all 256 hues at this saturation and value are converted once into a table that's
+   * kept for the next fills (the rainbow effect only changes the start hue each frame), so each pixel is a lookup.
+   */
+  void range_fill_rainbow(int32_t from, int32_t to, uint16_t hue, uint16_t hue_delta, uint8_t saturation,
+                          uint8_t value);
+  /** Fill with the colors of a palette beginning at index (in 1/256 steps of the palette index), increasing by
+   * index_delta per pixel, scaled by brightness.
+   */
+  void range_fill_palette(int32_t from, int32_t to, const ESPPalette &palette, uint16_t index, uint16_t index_delta,
+                          uint8_t brightness = 255);
+  /** Scale all pixels by scale/256, for example to fade them to black.
+   *
+   * This scales the output values after color correction, like FastLED's nscale8().
+   */
+  void range_scale(int32_t from, int32_t to, uint8_t scale);
+  /// Blend the pixels towards colors (to - from entries) by amount/256 (in the color corrected space).
+  void range_blend(int32_t from, int32_t to, const ESPColor *colors, uint8_t amount);
 
  protected:
-  bool should_show_() const;
+  /** Whether the pixels should be written to the strip now.
+   *
+   * For outputs with a pixel buffer, the buffer is hashed and unless schedule_show() was called, nothing is shown
+   * if it's the same as last time.
+   * That way large strips with a static effect don't spend the main loop on sending the same data each loop.
+   */
+  bool should_show_();
   void mark_shown_();
 
+  /// Layout of a pixel buffer, channel c (red, green, blue, white) of pixel i is at data[i * stride + offsets[c]].
+  struct RawPixels {
+    uint8_t *data;
+    /// 3 for RGB, 4 for RGBW.
+    uint8_t stride;
+    uint8_t offsets[4];
+  };
+  /// Get the pixel buffer for the bulk operations, false if the pixels can only be accessed with operator[].
+  virtual bool get_raw_pixels_(RawPixels *raw) const;
+  /// Clamp [from, to) to the size of this light, returns false if the range is empty.
+  bool clamp_range_(int32_t *from, int32_t *to) const;
+  /// Get the hue table for range_fill_rainbow() with count pixels, nullptr if converting each pixel is cheaper.
+  const ESPColor *get_rainbow_table_(uint8_t saturation, uint8_t value, int32_t count);
+
   bool effect_active_{false};
   bool next_show_{true};
+  bool next_show_if_changed_{false};
+  bool has_shown_{false};
+  uint32_t shown_hash_{0};
+  uint32_t pending_hash_{0};
   ESPColorCorrection correction_{};
+  /// The (uncorrected) colors of the 256 hues at rainbow_saturation_ and rainbow_value_, allocated on first use.
+  std::unique_ptr<ESPColor[]> rainbow_table_;
+  uint8_t rainbow_saturation_{0};
+  uint8_t rainbow_value_{0};
 };
 
 class AddressableSegment {
@@ -186,6 +262,8 @@ class PartitionLightOutput : public AddressableLight, public Component {
   void clear_effect_data() override;
   LightTraits get_traits() override;
   void loop() override;
+  /// Run before the lights of the segments, so that they show in the same loop.
+  float get_loop_priority() const override;
 
  protected:
   std::vector<AddressableSegment> segments_;
@@ -223,26 +223,13 @@ ESPColor ESPColorCorrection::color_correct(ESPColor color) const {
                   this->color_correct_blue(color.blue), this->color_correct_white(color.white));
 }
 
-uint8_t ESPColorCorrection::color_correct_red(uint8_t red) const {
-  uint8_t res = esp_scale8(esp_scale8(red, this->max_brightness_.red), this->local_brightness_);
-  return this->gamma_table_[res];
-}
+uint8_t ESPColorCorrection::color_correct_red(uint8_t red) const { return this->correct_table_[0][red]; }
 
-uint8_t ESPColorCorrection::color_correct_green(uint8_t green) const {
-  uint8_t res = esp_scale8(esp_scale8(green, this->max_brightness_.green), this->local_brightness_);
-  return this->gamma_table_[res];
-}
+uint8_t ESPColorCorrection::color_correct_green(uint8_t green) const { return this->correct_table_[1][green]; }
 
-uint8_t ESPColorCorrection::color_correct_blue(uint8_t blue) const {
-  uint8_t res = esp_scale8(esp_scale8(blue, this->max_brightness_.blue), this->local_brightness_);
-  return this->gamma_table_[res];
-}
+uint8_t ESPColorCorrection::color_correct_blue(uint8_t blue) const { return this->correct_table_[2][blue]; }
 
-uint8_t ESPColorCorrection::color_correct_white(uint8_t white) const {
-  // do not scale white value with brightness
-  uint8_t res = esp_scale8(white, this->max_brightness_.white);
-  return this->gamma_table_[res];
-}
+uint8_t ESPColorCorrection::color_correct_white(uint8_t white) const { return this->correct_table_[3][white]; }
 
 ESPColor ESPColorCorrection::color_uncorrect(ESPColor color) const {
   // uncorrected = corrected^(1/gamma) / (max_brightness * local_brightness)
@@ -250,36 +237,29 @@ ESPColor ESPColorCorrection::color_uncorrect(ESPColor color) const {
                   this->color_uncorrect_blue(color.blue), this->color_uncorrect_white(color.white));
 }
 
+void ESPColorCorrection::ensure_uncorrect_tables_() const {
+  if (!this->uncorrect_tables_valid_)
+    this->update_uncorrect_tables_();
+}
+
 uint8_t ESPColorCorrection::color_uncorrect_red(uint8_t red) const {
-  if (this->max_brightness_.red == 0 || this->local_brightness_ == 0)
-    return 0;
-  uint16_t uncorrected = this->gamma_reverse_table_[red] * 255UL;
-  uint8_t res = ((uncorrected / this->max_brightness_.red) * 255UL) / this->local_brightness_;
-  return res;
+  this->ensure_uncorrect_tables_();
+  return this->uncorrect_table_[0][red];
 }
 
 uint8_t ESPColorCorrection::color_uncorrect_green(uint8_t green) const {
-  if (this->max_brightness_.green == 0 || this->local_brightness_ == 0)
-    return 0;
-  uint16_t uncorrected = this->gamma_reverse_table_[green] * 255UL;
-  uint8_t res = ((uncorrected / this->max_brightness_.green) * 255UL) / this->local_brightness_;
-  return res;
+  this->ensure_uncorrect_tables_();
+  return this->uncorrect_table_[1][green];
 }
 
 uint8_t ESPColorCorrection::color_uncorrect_blue(uint8_t blue) const {
-  if (this->max_brightness_.blue == 0 || this->local_brightness_ == 0)
-    return 0;
-  uint16_t uncorrected = this->gamma_reverse_table_[blue] * 255UL;
-  uint8_t res = ((uncorrected / this->max_brightness_.blue) * 255UL) / this->local_brightness_;
-  return res;
+  this->ensure_uncorrect_tables_();
+  return this->uncorrect_table_[2][blue];
 }
 
 uint8_t ESPColorCorrection::color_uncorrect_white(uint8_t white) const {
-  if (this->max_brightness_.white == 0)
-    return 0;
-  uint16_t uncorrected = this->gamma_reverse_table_[white] * 255UL;
-  uint8_t res = uncorrected / this->max_brightness_.white;
-  return res;
+  this->ensure_uncorrect_tables_();
+  return this->uncorrect_table_[3][white];
 }
 
 ESPHSVColor::ESPHSVColor() : h(0), s(0), v(0) {  // NOLINT
@@ -3,15 +3,22 @@
 #ifdef USE_LIGHT
 
 #include "esphome/light/addressable_light_effect.h"
+#include "esphome/log.h"
 
 ESPHOME_NAMESPACE_BEGIN
 
 namespace light {
 
+static const char *TAG = "light.addressable_effect";
+
 void AddressableLightEffect::start_internal() {
   this->get_addressable_()->set_effect_active(true);
   this->get_addressable_()->clear_effect_data();
   this->high_freq_.start();
+  const uint32_t now = micros();
+  this->next_frame_ = now;
+  this->fps_window_start_ = now;
+  this->fps_frames_ = 0;
   this->start();
 }
 
@@ -20,6 +27,12 @@ void AddressableLightEffect::stop() {
   this->high_freq_.stop();
 }
 
+void AddressableLightEffect::set_target_fps(uint32_t target_fps) {
+  this->frame_interval_ = target_fps == 0 ? 0 : 1000000UL / target_fps;
+}
+float AddressableLightEffect::get_fps() const { return this->fps_; }
+uint32_t AddressableLightEffect::get_frames_skipped() const { return this->frames_skipped_; }
+
 AddressableLight *AddressableLightEffect::get_addressable_() const {
   return (AddressableLight *) this->state_->get_output();
 }
@@ -27,6 +40,25 @@ AddressableLight *AddressableLightEffect::get_addressable_() const {
 AddressableLightEffect::AddressableLightEffect(const std::string &name) : LightEffect(name) {}
 
 void AddressableLightEffect::apply() {
+  const uint32_t now = micros();
+  if (this->frame_interval_ != 0) {
+    const uint32_t late = now - this->next_frame_;
+    if (int32_t(late) < 0)
+      // next frame isn't due yet
+      return;
+    const uint32_t missed = late / this->frame_interval_;
+    this->frames_skipped_ += missed;
+    this->next_frame_ += (missed + 1) * this->frame_interval_;
+  }
+
+  this->fps_frames_++;
+  if (now - this->fps_window_start_ >= 1000000UL) {
+    this->fps_ = this->fps_frames_ * 1e6f / (now - this->fps_window_start_);
+    ESP_LOGVV(TAG, "'%s': %.1f FPS, %u frames skipped", this->name_.c_str(), this->fps_, this->frames_skipped_);
+    this->fps_frames_ = 0;
+    this->fps_window_start_ = now;
+  }
+
   LightColorValues color = this->state_->remote_values;
   // not using any color correction etc. that will be handled by the addressable layer
   ESPColor current_color =
@@ -70,22 +102,29 @@ void AddressableLambdaLightEffect::apply(AddressableLight &it, const ESPColor &c
 AddressableRainbowLightEffect::AddressableRainbowLightEffect(const std::string &name) : AddressableLightEffect(name) {}
 
 void AddressableRainbowLightEffect::apply(AddressableLight &it, const ESPColor &current_color) {
-  ESPHSVColor hsv;
-  hsv.value = 255;
-  hsv.saturation = 240;
   uint16_t hue = (millis() * this->speed_) % 0xFFFF;
   const uint16_t add = 0xFFFF / this->width_;
-  for (int i = 0; i < it.size(); i++) {
-    hsv.hue = hue >> 8;
-    it[i] = hsv;
-    hue += add;
-  }
+  it.range_fill_rainbow(0, it.size(), hue, add, 240, 255);
 }
 
 void AddressableRainbowLightEffect::set_speed(uint32_t speed) { this->speed_ = speed; }
 
 void AddressableRainbowLightEffect::set_width(uint32_t width) { this->width_ = width; }
 
+AddressablePaletteEffect::AddressablePaletteEffect(const std::string &name, const ESPPalette *palette)
+    : AddressableLightEffect(name), palette_(palette) {}
+
+void AddressablePaletteEffect::apply(AddressableLight &it, const ESPColor &current_color) {
+  const uint16_t index = millis() * this->speed_;
+  const uint16_t add = 0xFFFF / this->width_;
+  const uint8_t brightness = this->pulse_bpm_ == 0 ? 255 : esp_beatsin8(this->pulse_bpm_, 64, 255);
+  it.range_fill_palette(0, it.size(), *this->palette_, index, add, brightness);
+}
+
+void AddressablePaletteEffect::set_speed(uint32_t speed) { this->speed_ = speed; }
+void AddressablePaletteEffect::set_width(uint32_t width) { this->width_ = width; }
+void AddressablePaletteEffect::set_pulse_bpm(uint8_t pulse_bpm) { this->pulse_bpm_ = pulse_bpm; }
+
 AddressableColorWipeEffect::AddressableColorWipeEffect(const std::string &name) : AddressableLightEffect(name) {
   this->colors_.push_back(
       AddressableColorWipeEffectColor{.r = 255, .g = 255, .b = 255, .w = 255, .random = true, .num_leds = 1});
@@ -140,12 +179,8 @@ AddressableScanEffect::AddressableScanEffect(const std::string &name) : Addressa
 void AddressableScanEffect::set_move_interval(uint32_t move_interval) { this->move_interval_ = move_interval; }
 
 void AddressableScanEffect::apply(AddressableLight &addressable, const ESPColor &current_color) {
-  for (int i = 0; i < addressable.size(); i++) {
-    if (i == this->at_led_)
-      addressable[i] = current_color;
-    else
-      addressable[i] = ESPColor(0, 0, 0, 0);
-  }
+  addressable.range_fill(0, addressable.size(), ESPColor(0, 0, 0, 0));
+  addressable[this->at_led_] = current_color;
   const uint32_t now = millis();
   if (now - this->last_move_ > this->move_interval_) {
     if (direction_) {
@@ -252,9 +287,8 @@ void AddressableRandomTwinkleEffect::set_progress_interval(uint32_t progress_int
 AddressableFireworksEffect::AddressableFireworksEffect(const std::string &name) : AddressableLightEffect(name) {}
 
 void AddressableFireworksEffect::start() {
-  const auto &it = *this->get_addressable_();
-  for (int i = 0; i < it.size(); i++)
-    it[i] = ESPColor(0, 0, 0, 0);
+  auto &it = *this->get_addressable_();
+  it.range_fill(0, it.size(), ESPColor(0, 0, 0, 0));
 }
 
 void AddressableFireworksEffect::apply(AddressableLight &it, const ESPColor &current_color) {
@@ -321,6 +355,56 @@ void AddressableFlickerEffect::set_intensity(float intensity) {
   this->intensity_ = static_cast<uint8_t>(roundf(intensity * 255.0f));
 }
 
+#ifdef USE_SPECTRUM_ANALYZER
+AddressableSpectrumEffect::AddressableSpectrumEffect(const std::string &name,
+                                                     sensor::SpectrumAnalyzerComponent *analyzer)
+    : AddressableLightEffect(name), analyzer_(analyzer) {}
+void AddressableSpectrumEffect::set_min_frequency(float min_frequency) { this->min_frequency_ = min_frequency; }
+void AddressableSpectrumEffect::set_floor(float floor_db) { this->floor_db_ = floor_db; }
+void AddressableSpectrumEffect::set_decay(uint8_t decay) { this->decay_ = decay; }
+void AddressableSpectrumEffect::init() { this->levels_.assign(this->get_addressable_()->size(), 0); }
+void AddressableSpectrumEffect::apply(AddressableLight &it, const ESPColor &current_color) {
+  const int32_t size = it.size();
+  if (this->levels_.size() != size_t(size))
+    this->levels_.assign(size, 0);
+
+  // fall slowly instead of flickering at the spectrum rate
+  for (auto &level : this->levels_)
+    level = level > this->decay_ ? level - this->decay_ : 0;
+  if (this->analyzer_->get_frame() != this->last_frame_) {
+    this->last_frame_ = this->analyzer_->get_frame();
+    this->update_levels_(size);
+  }
+
+  for (int32_t i = 0; i < size; i++)
+    it[i] = ESPHSVColor(i * 256 / size, 255, this->levels_[i]);
+}
+void AddressableSpectrumEffect::update_levels_(int32_t size) {
+  const uint32_t *power = this->analyzer_->get_bin_power();
+  const uint16_t bins = this->analyzer_->get_num_bins();
+  const float resolution = this->analyzer_->get_bin_frequency(1);
+  if (power == nullptr || bins == 0 || resolution <= 0.0f)
+    return;
+
+  const float min_bin = std::max(1.0f, this->min_frequency_ / resolution);
+  const float ratio = powf(bins / min_bin, 1.0f / size);
+  float bin_start = min_bin;
+  for (int32_t i = 0; i < size; i++) {
+    const float bin_end = bin_start * ratio;
+    const uint16_t from = std::min<uint16_t>(bins - 1, bin_start);
+    const uint16_t to = std::min<uint16_t>(bins - 1, std::max<uint16_t>(from, bin_end));
+    bin_start = bin_end;
+
+    uint32_t peak = 0;
+    for (uint16_t bin = from; bin <= to; bin++)
+      peak = std::max(peak, power[bin]);
+    const float db = 10.0f * log10f(std::max(peak / sensor::SPECTRUM_FULL_SCALE_POWER, 1e-12f));
+    const float fraction = clamp(0.0f, 1.0f, 1.0f - db / this->floor_db_);
+    this->levels_[i] = std::max(this->levels_[i], uint8_t(fraction * 255.0f));
+  }
+}
+#endif
+
 }  // namespace light
 
 ESPHOME_NAMESPACE_END
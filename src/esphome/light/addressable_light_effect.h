@@ -7,6 +7,11 @@
 
 #include "esphome/light/light_effect.h"
 #include "esphome/light/addressable_light.h"
+#include "esphome/light/palette.h"
+
+#ifdef USE_SPECTRUM_ANALYZER
+#include "esphome/sensor/spectrum_analyzer.h"
+#endif
 
 ESPHOME_NAMESPACE_BEGIN
 
@@ -20,10 +25,28 @@ class AddressableLightEffect : public LightEffect {
   virtual void apply(AddressableLight &it, const ESPColor &current_color) = 0;
   void apply() override;
 
+  /** Set the frame rate the effect is rendered at, 0 to render it on every loop.
+   *
+   * Frames are scheduled on a fixed timestep. If the loop runs late, the missed frames are skipped instead of being
+   * rendered back to back. Defaults to 60 frames per second.
+   */
+  void set_target_fps(uint32_t target_fps);
+  /// The number of frames actually rendered per second, measured over the last second.
+  float get_fps() const;
+  /// The number of frames that were skipped because the loop ran late.
+  uint32_t get_frames_skipped() const;
+
  protected:
   AddressableLight *get_addressable_() const;
 
   HighFrequencyLoopRequester high_freq_;
+  /// Frame interval in µs, 0 to render every loop.
+  uint32_t frame_interval_{1000000 / 60};
+  uint32_t next_frame_{0};
+  uint32_t frames_skipped_{0};
+  uint32_t fps_frames_{0};
+  uint32_t fps_window_start_{0};
+  float fps_{0.0f};
 };
 
 class AddressableLambdaLightEffect : public AddressableLightEffect {
@@ -50,6 +73,29 @@ class AddressableRainbowLightEffect : public AddressableLightEffect {
   uint16_t width_{50};
 };
 
+/** Scroll the colors of a palette over the strip.
+ *
+ * Each pixel is a lookup in the palette, so this is cheap even for large installations. The palette isn't copied,
+ * the same palette can be used by the effects of several lights.
+ */
+class AddressablePaletteEffect : public AddressableLightEffect {
+ public:
+  AddressablePaletteEffect(const std::string &name, const ESPPalette *palette);
+  void apply(AddressableLight &it, const ESPColor &current_color) override;
+  /// Set how fast the palette scrolls, in 1/65536 of the palette per ms, defaults to 10.
+  void set_speed(uint32_t speed);
+  /// Set the number of pixels the palette is stretched over, defaults to 50.
+  void set_width(uint32_t width);
+  /// Pulse the brightness between 25% and 100% with bpm beats per minute, 0 (the default) to disable.
+  void set_pulse_bpm(uint8_t pulse_bpm);
+
+ protected:
+  const ESPPalette *palette_;
+  uint32_t speed_{10};
+  uint16_t width_{50};
+  uint8_t pulse_bpm_{0};
+};
+
 struct AddressableColorWipeEffectColor {
   uint8_t r, g, b, w;
   bool random;
@@ -143,6 +189,37 @@ class AddressableFlickerEffect : public AddressableLightEffect {
   uint8_t intensity_{13};
 };
 
+#ifdef USE_SPECTRUM_ANALYZER
+/** Audio-reactive effect that shows the spectrum of a SpectrumAnalyzerComponent.
+ *
+ * Each LED shows the loudest frequency of its slice of a logarithmic frequency scale, from the
+ * minimum frequency up to half the sample rate, colored with a rainbow over the strip.
+ */
+class AddressableSpectrumEffect : public AddressableLightEffect {
+ public:
+  AddressableSpectrumEffect(const std::string &name, sensor::SpectrumAnalyzerComponent *analyzer);
+  /// Allocate the levels once, so starting the effect doesn't allocate.
+  void init() override;
+  void apply(AddressableLight &it, const ESPColor &current_color) override;
+  /// The lowest frequency shown, defaults to 60Hz.
+  void set_min_frequency(float min_frequency);
+  /// The level (in dB full scale) shown as off, defaults to -60dB.
+  void set_floor(float floor_db);
+  /// How much the brightness of a LED drops per frame when the level falls, defaults to 8.
+  void set_decay(uint8_t decay);
+
+ protected:
+  void update_levels_(int32_t size);
+
+  sensor::SpectrumAnalyzerComponent *analyzer_;
+  float min_frequency_{60.0f};
+  float floor_db_{-60.0f};
+  uint8_t decay_{8};
+  uint32_t last_frame_{0};
+  std::vector<uint8_t> levels_;
+};
+#endif
+
 }  // namespace light
 
 ESPHOME_NAMESPACE_END
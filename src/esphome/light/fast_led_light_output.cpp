@@ -17,6 +17,15 @@ void FastLEDLightOutputComponent::setup() {
   this->controller_->init();
   this->controller_->setLeds(this->leds_, this->num_leds_);
   this->effect_data_ = new uint8_t[this->num_leds_];
+#ifdef ARDUINO_ARCH_ESP32
+  if (this->show_in_task_) {
+    this->show_leds_ = new CRGB[this->num_leds_];
+    this->controller_->setLeds(this->show_leds_, this->num_leds_);
+    // the main loop runs on core 1
+    xTaskCreatePinnedToCore(show_task_, "fastled_show", 2048, this, 1, &this->show_task_handle_,
+                            xPortGetCoreID() == 0 ? 1 : 0);
+  }
+#endif
   if (!this->max_refresh_rate_.has_value()) {
     this->set_max_refresh_rate(this->controller_->getMaxRefreshRate());
   }
@@ -25,6 +34,9 @@ void FastLEDLightOutputComponent::dump_config() {
   ESP_LOGCONFIG(TAG, "FastLED light:");
   ESP_LOGCONFIG(TAG, "  Num LEDs: %u", this->num_leds_);
   ESP_LOGCONFIG(TAG, "  Max refresh rate: %u", *this->max_refresh_rate_);
+#ifdef ARDUINO_ARCH_ESP32
+  ESP_LOGCONFIG(TAG, "  Show In Task: %s", YESNO(this->show_task_handle_ != nullptr));
+#endif
 }
 void FastLEDLightOutputComponent::loop() {
   if (!this->should_show_())
@@ -35,6 +47,11 @@ void FastLEDLightOutputComponent::loop() {
   if (*this->max_refresh_rate_ != 0 && (now - this->last_refresh_) < *this->max_refresh_rate_) {
     return;
   }
+#ifdef ARDUINO_ARCH_ESP32
+  if (this->show_busy_)
+    // still sending the last frame, try again next loop
+    return;
+#endif
   this->last_refresh_ = now;
   this->mark_shown_();
 
@@ -59,9 +76,28 @@ void FastLEDLightOutputComponent::loop() {
       this->has_requested_high_power_ = false;
     }
   }
+#endif
+#ifdef ARDUINO_ARCH_ESP32
+  if (this->show_task_handle_ != nullptr) {
+    memcpy(this->show_leds_, this->leds_, sizeof(CRGB) * this->num_leds_);
+    this->show_busy_ = true;
+    xTaskNotifyGive(this->show_task_handle_);
+    return;
+  }
 #endif
   this->controller_->showLeds();
 }
+#ifdef ARDUINO_ARCH_ESP32
+void FastLEDLightOutputComponent::show_task_(void *params) {
+  auto *light = reinterpret_cast<FastLEDLightOutputComponent *>(params);
+  while (true) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    light->controller_->showLeds();
+    light->show_busy_ = false;
+  }
+}
+void FastLEDLightOutputComponent::set_show_in_task(bool show_in_task) { this->show_in_task_ = show_in_task; }
+#endif
 CLEDController &FastLEDLightOutputComponent::add_leds(CLEDController *controller, int num_leds) {
   this->controller_ = controller;
   this->num_leds_ = num_leds;
@@ -79,6 +115,10 @@ float FastLEDLightOutputComponent::get_setup_priority() const { return setup_pri
 void FastLEDLightOutputComponent::set_power_supply(PowerSupplyComponent *power_supply) {
   this->power_supply_ = power_supply;
 }
+void FastLEDLightOutputComponent::pre_enable_power() {
+  if (this->power_supply_ != nullptr && !this->has_requested_high_power_)
+    this->power_supply_->pre_enable();
+}
 #endif
 
 ESPColorView FastLEDLightOutputComponent::operator[](int32_t index) const {
@@ -86,6 +126,15 @@ ESPColorView FastLEDLightOutputComponent::operator[](int32_t index) const {
                       &this->effect_data_[index], &this->correction_);
 }
 int32_t FastLEDLightOutputComponent::size() const { return this->num_leds_; }
+bool FastLEDLightOutputComponent::get_raw_pixels_(RawPixels *raw) const {
+  // CRGB is just the three channels in RGB order
+  raw->data = &this->leds_[0].r;
+  raw->stride = 3;
+  raw->offsets[0] = 0;
+  raw->offsets[1] = 1;
+  raw->offsets[2] = 2;
+  return true;
+}
 void FastLEDLightOutputComponent::clear_effect_data() {
   for (int i = 0; i < this->size(); i++)
     this->effect_data_[i] = 0;
@@ -50,6 +50,15 @@ class FastLEDLightOutputComponent : public Component, public AddressableLight {
   void set_power_supply(PowerSupplyComponent *power_supply);
 #endif
 
+#ifdef ARDUINO_ARCH_ESP32
+  /** Send the data to the LEDs from a task on the other core, so that long strips don't block the main loop.
+   *
+   * Effects still draw into the LED buffer in the main loop, on each show the buffer is copied to a second buffer
+   * the task sends from. If the task is still busy with the previous frame, the show is retried on the next loop.
+   */
+  void set_show_in_task(bool show_in_task);
+#endif
+
   /// Add some LEDS, can only be called once.
   CLEDController &add_leds(CLEDController *controller, int num_leds);
 
@@ -367,8 +376,16 @@ class FastLEDLightOutputComponent : public Component, public AddressableLight {
   float get_setup_priority() const override;
 
   void clear_effect_data() override;
+#ifdef USE_OUTPUT
+  void pre_enable_power() override;
+#endif
 
  protected:
+  bool get_raw_pixels_(RawPixels *raw) const override;
+#ifdef ARDUINO_ARCH_ESP32
+  static void show_task_(void *params);
+#endif
+
   CLEDController *controller_{nullptr};
   CRGB *leds_{nullptr};
   uint8_t *effect_data_{nullptr};
@@ -381,6 +398,13 @@ class FastLEDLightOutputComponent : public Component, public AddressableLight {
   PowerSupplyComponent *power_supply_{nullptr};
   bool has_requested_high_power_{false};
 #endif
+#ifdef ARDUINO_ARCH_ESP32
+  bool show_in_task_{false};
+  /// The buffer the controller sends from if show_in_task_ is set.
+  CRGB *show_leds_{nullptr};
+  TaskHandle_t show_task_handle_{nullptr};
+  volatile bool show_busy_{false};
+#endif
 };
 
 }  // namespace light
@@ -0,0 +1,310 @@
+#include "esphome/defines.h"
+
+#ifdef USE_I2S_PARALLEL_LIGHT
+
+#include "esphome/light/i2s_parallel_light_output.h"
+#include "esphome/log.h"
+
+#include <algorithm>
+#include <esp_heap_caps.h>
+#include <driver/gpio.h>
+#include <driver/periph_ctrl.h>
+#include <rom/gpio.h>
+#include <soc/gpio_sig_map.h>
+#include <soc/i2s_struct.h>
+
+ESPHOME_NAMESPACE_BEGIN
+
+namespace light {
+
+static const char *TAG = "light.i2s_parallel";
+
+static const uint8_t I2S_PARALLEL_MAX_STRIPS = 16;
+/// Every bit is sent as 3 samples of 417ns: high, the bit, low. So a 0 is 417ns high, a 1 833ns high.
+static const uint8_t SAMPLES_PER_BIT = 3;
+static const uint16_t SAMPLES_PER_LED = 24 * SAMPLES_PER_BIT;
+/// 28 pixels are 4032 bytes, just below the 4095 bytes a DMA descriptor can hold.
+static const uint16_t LEDS_PER_CHUNK = 28;
+/// The latch, >= 300µs low. The last samples may still be in the FIFO when the DMA is stopped, so add some margin.
+static const uint16_t LATCH_SAMPLES = 1024;
+/// The I2S clock is PLL_D2 (160MHz) / (33 + 1/3) / 2 = 2.4MHz, one sample per clock.
+static const uint8_t CLOCK_DIV_NUM = 33;
+static const uint8_t CLOCK_DIV_A = 3;
+static const uint8_t CLOCK_DIV_B = 1;
+static const uint8_t CLOCK_BCK_DIV = 2;
+
+/// The sample at slot of bit (0-23) of the pixel in the chunk. The I2S sends the high halfword of each word first.
+static inline uint16_t &sample_at(uint16_t *chunk, uint16_t led, uint8_t bit, uint8_t slot) ALWAYS_INLINE;
+static inline uint16_t &sample_at(uint16_t *chunk, uint16_t led, uint8_t bit, uint8_t slot) {
+  return chunk[(led * SAMPLES_PER_LED + bit * SAMPLES_PER_BIT + slot) ^ 1];
+}
+
+/** Transpose the 8x8 bit matrix of the bytes of 8 lanes, out[k] holds bit 7 - k (MSB first) of each lane, lane n
+ * in bit n.
+ */
+static inline void transpose8(const uint8_t *in, uint8_t *out) ALWAYS_INLINE;
+static inline void transpose8(const uint8_t *in, uint8_t *out) {
+  // the rows are the lanes in reverse, so that lane n ends up in bit n of the columns
+  uint32_t x = (uint32_t(in[7]) << 24) | (uint32_t(in[6]) << 16) | (uint32_t(in[5]) << 8) | in[4];
+  uint32_t y = (uint32_t(in[3]) << 24) | (uint32_t(in[2]) << 16) | (uint32_t(in[1]) << 8) | in[0];
+  uint32_t t = (x ^ (x >> 7)) & 0x00AA00AA;
+  x = x ^ t ^ (t << 7);
+  t = (y ^ (y >> 7)) & 0x00AA00AA;
+  y = y ^ t ^ (t << 7);
+  t = (x ^ (x >> 14)) & 0x0000CCCC;
+  x = x ^ t ^ (t << 14);
+  t = (y ^ (y >> 14)) & 0x0000CCCC;
+  y = y ^ t ^ (t << 14);
+  t = (x & 0xF0F0F0F0) | ((y >> 4) & 0x0F0F0F0F);
+  y = ((x << 4) & 0xF0F0F0F0) | (y & 0x0F0F0F0F);
+  x = t;
+  out[0] = x >> 24;
+  out[1] = x >> 16;
+  out[2] = x >> 8;
+  out[3] = x;
+  out[4] = y >> 24;
+  out[5] = y >> 16;
+  out[6] = y >> 8;
+  out[7] = y;
+}
+
+void I2SParallelLightOutput::add_strip(uint8_t pin, uint16_t num_leds) {
+  if (this->strips_.size() >= I2S_PARALLEL_MAX_STRIPS) {
+    ESP_LOGE(TAG, "Can't add the strip on pin %u, at most %u strips are supported!", pin, I2S_PARALLEL_MAX_STRIPS);
+    return;
+  }
+  this->strips_.push_back(Strip{
+      .pin = pin,
+      .num_leds = num_leds,
+      .offset = this->num_leds_,
+  });
+  this->num_leds_ += num_leds;
+  this->max_strip_leds_ = std::max(this->max_strip_leds_, num_leds);
+}
+void I2SParallelLightOutput::set_color_order(I2SParallelColorOrder color_order) { this->color_order_ = color_order; }
+#ifdef USE_OUTPUT
+void I2SParallelLightOutput::set_power_supply(PowerSupplyComponent *power_supply) {
+  this->power_supply_ = power_supply;
+}
+void I2SParallelLightOutput::pre_enable_power() {
+  if (this->power_supply_ != nullptr && !this->has_requested_high_power_)
+    this->power_supply_->pre_enable();
+}
+#endif
+int32_t I2SParallelLightOutput::get_strip_offset(uint8_t strip) const { return this->strips_[strip].offset; }
+
+LightTraits I2SParallelLightOutput::get_traits() { return {true, true, false, false}; }
+void I2SParallelLightOutput::setup() {
+  ESP_LOGCONFIG(TAG, "Setting up I2S parallel light...");
+  this->leds_ = new uint8_t[this->num_leds_ * 3]();
+  this->effect_data_ = new uint8_t[this->num_leds_]();
+
+  const uint16_t num_chunks = (this->max_strip_leds_ + LEDS_PER_CHUNK - 1) / LEDS_PER_CHUNK;
+  this->descriptors_ =
+      reinterpret_cast<lldesc_t *>(heap_caps_calloc(num_chunks + 1, sizeof(lldesc_t), MALLOC_CAP_DMA));
+  if (this->descriptors_ == nullptr) {
+    ESP_LOGE(TAG, "Could not allocate the DMA descriptors!");
+    this->mark_failed();
+    return;
+  }
+  for (uint16_t i = 0; i <= num_chunks; i++) {
+    const bool latch = i == num_chunks;
+    const uint16_t chunk_leds = std::min<uint16_t>(LEDS_PER_CHUNK, this->max_strip_leds_ - i * LEDS_PER_CHUNK);
+    const size_t len = (latch ? LATCH_SAMPLES : chunk_leds * SAMPLES_PER_LED) * sizeof(uint16_t);
+    auto *chunk = reinterpret_cast<uint16_t *>(heap_caps_calloc(1, len, MALLOC_CAP_DMA));
+    if (chunk == nullptr) {
+      ESP_LOGE(TAG, "Could not allocate the DMA buffer (%u bytes)!", len);
+      this->mark_failed();
+      return;
+    }
+    if (!latch) {
+      this->chunks_.push_back(chunk);
+      // The first sample of each bit is high on the lanes that have a pixel at this index, the last one is low.
+      // Both are the same every frame, only the middle samples are encoded on show.
+      for (uint16_t led = 0; led < chunk_leds; led++) {
+        const uint16_t index = i * LEDS_PER_CHUNK + led;
+        uint16_t mask = 0;
+        for (uint8_t lane = 0; lane < this->strips_.size(); lane++) {
+          if (index < this->strips_[lane].num_leds)
+            mask |= 1 << lane;
+        }
+        for (uint8_t bit = 0; bit < 24; bit++)
+          sample_at(chunk, led, bit, 0) = mask;
+      }
+    }
+
+    lldesc_t &desc = this->descriptors_[i];
+    desc.size = len;
+    desc.length = len;
+    desc.owner = 1;
+    desc.sosf = 0;
+    desc.offset = 0;
+    desc.eof = latch;
+    desc.buf = reinterpret_cast<uint8_t *>(chunk);
+    desc.qe.stqe_next = latch ? nullptr : &this->descriptors_[i + 1];
+  }
+
+  periph_module_enable(PERIPH_I2S1_MODULE);
+  I2S1.conf.val = 0;
+  I2S1.conf.tx_right_first = 1;
+  I2S1.conf.tx_msb_right = 1;
+  // LCD mode, 16 bit parallel, one sample per clock
+  I2S1.conf2.val = 0;
+  I2S1.conf2.lcd_en = 1;
+  I2S1.sample_rate_conf.val = 0;
+  I2S1.sample_rate_conf.tx_bits_mod = 16;
+  I2S1.sample_rate_conf.tx_bck_div_num = CLOCK_BCK_DIV;
+  I2S1.clkm_conf.val = 0;
+  I2S1.clkm_conf.clka_en = 0;
+  I2S1.clkm_conf.clkm_div_num = CLOCK_DIV_NUM;
+  I2S1.clkm_conf.clkm_div_a = CLOCK_DIV_A;
+  I2S1.clkm_conf.clkm_div_b = CLOCK_DIV_B;
+  I2S1.fifo_conf.val = 0;
+  I2S1.fifo_conf.tx_fifo_mod_force_en = 1;
+  // 16 bit single channel
+  I2S1.fifo_conf.tx_fifo_mod = 1;
+  I2S1.fifo_conf.tx_data_num = 32;
+  I2S1.fifo_conf.dscr_en = 1;
+  I2S1.conf1.val = 0;
+  I2S1.conf1.tx_stop_en = 0;
+  I2S1.conf1.tx_pcm_bypass = 1;
+  I2S1.conf_chan.val = 0;
+  I2S1.conf_chan.tx_chan_mod = 1;
+  I2S1.timing.val = 0;
+  I2S1.lc_conf.val = 0;
+  I2S1.lc_conf.out_eof_mode = 1;
+
+  // in 16 bit mode, the lanes are the data outputs 8-23
+  for (uint8_t lane = 0; lane < this->strips_.size(); lane++) {
+    const uint8_t pin = this->strips_[lane].pin;
+    PIN_FUNC_SELECT(GPIO_PIN_MUX_REG[pin], PIN_FUNC_GPIO);
+    gpio_set_direction(gpio_num_t(pin), GPIO_MODE_OUTPUT);
+    gpio_matrix_out(pin, I2S1O_DATA_OUT8_IDX + lane, false, false);
+  }
+
+  I2S1.int_ena.val = 0;
+  I2S1.int_clr.val = 0xFFFFFFFF;
+  if (esp_intr_alloc(ETS_I2S1_INTR_SOURCE, ESP_INTR_FLAG_IRAM, interrupt_, this, &this->interrupt_handle_) != ESP_OK) {
+    ESP_LOGE(TAG, "Could not allocate the I2S interrupt!");
+    this->mark_failed();
+    return;
+  }
+  I2S1.int_ena.out_total_eof = 1;
+}
+void I2SParallelLightOutput::dump_config() {
+  ESP_LOGCONFIG(TAG, "I2S Parallel light:");
+  ESP_LOGCONFIG(TAG, "  Num LEDs: %u", this->num_leds_);
+  for (uint8_t i = 0; i < this->strips_.size(); i++) {
+    auto &strip = this->strips_[i];
+    ESP_LOGCONFIG(TAG, "  Strip %u: Pin %u, %u LEDs", i, strip.pin, strip.num_leds);
+  }
+  // 30µs per pixel, plus the latch
+  ESP_LOGCONFIG(TAG, "  Frame Time: %uµs", this->max_strip_leds_ * 30u + LATCH_SAMPLES * 10u / 24u);
+}
+void I2SParallelLightOutput::loop() {
+  if (this->busy_)
+    // still sending the last frame, try again next loop
+    return;
+  if (!this->should_show_())
+    return;
+  this->mark_shown_();
+
+  ESP_LOGVV(TAG, "Writing RGB values to bus...");
+
+#ifdef USE_OUTPUT
+  if (this->power_supply_ != nullptr) {
+    bool is_on = false;
+    for (int32_t i = 0; i < this->num_leds_ * 3; i++) {
+      if (this->leds_[i] != 0) {
+        is_on = true;
+        break;
+      }
+    }
+
+    if (is_on && !this->has_requested_high_power_) {
+      this->power_supply_->request_high_power();
+      this->has_requested_high_power_ = true;
+    }
+    if (!is_on && this->has_requested_high_power_) {
+      this->power_supply_->unrequest_high_power();
+      this->has_requested_high_power_ = false;
+    }
+  }
+#endif
+
+  this->encode_();
+  this->start_();
+}
+void HOT I2SParallelLightOutput::encode_() {
+  const uint8_t order = uint8_t(this->color_order_);
+  const uint8_t channels[3] = {uint8_t((order >> 4) & 0b11), uint8_t((order >> 2) & 0b11), uint8_t(order & 0b11)};
+  const uint8_t num_strips = this->strips_.size();
+  uint8_t bytes[I2S_PARALLEL_MAX_STRIPS] = {0};
+  uint8_t low[8];
+  uint8_t high[8] = {0};
+
+  for (uint16_t index = 0; index < this->max_strip_leds_; index++) {
+    uint16_t *chunk = this->chunks_[index / LEDS_PER_CHUNK];
+    const uint16_t led = index % LEDS_PER_CHUNK;
+    for (uint8_t c = 0; c < 3; c++) {
+      for (uint8_t lane = 0; lane < num_strips; lane++) {
+        const Strip &strip = this->strips_[lane];
+        bytes[lane] = index < strip.num_leds ? this->leds_[(strip.offset + index) * 3 + channels[c]] : 0;
+      }
+      transpose8(bytes, low);
+      if (num_strips > 8)
+        transpose8(bytes + 8, high);
+      for (uint8_t k = 0; k < 8; k++)
+        sample_at(chunk, led, c * 8 + k, 1) = low[k] | (uint16_t(high[k]) << 8);
+    }
+  }
+}
+void I2SParallelLightOutput::start_() {
+  I2S1.conf.tx_start = 0;
+  I2S1.conf.tx_reset = 1;
+  I2S1.conf.tx_reset = 0;
+  I2S1.conf.tx_fifo_reset = 1;
+  I2S1.conf.tx_fifo_reset = 0;
+  I2S1.lc_conf.out_rst = 1;
+  I2S1.lc_conf.out_rst = 0;
+  I2S1.int_clr.val = 0xFFFFFFFF;
+  this->busy_ = true;
+  I2S1.out_link.addr = uint32_t(&this->descriptors_[0]);
+  I2S1.out_link.start = 1;
+  I2S1.conf.tx_start = 1;
+}
+void ICACHE_RAM_ATTR HOT I2SParallelLightOutput::interrupt_(void *arg) {
+  auto *light = reinterpret_cast<I2SParallelLightOutput *>(arg);
+  if (I2S1.int_st.out_total_eof) {
+    // the DMA read the latch, the lanes stay low after the FIFO is stopped
+    I2S1.conf.tx_start = 0;
+    light->busy_ = false;
+  }
+  I2S1.int_clr.val = I2S1.int_st.val;
+}
+float I2SParallelLightOutput::get_setup_priority() const { return setup_priority::HARDWARE; }
+
+ESPColorView I2SParallelLightOutput::operator[](int32_t index) const {
+  uint8_t *base = this->leds_ + index * 3;
+  return ESPColorView(base + 0, base + 1, base + 2, nullptr, &this->effect_data_[index], &this->correction_);
+}
+int32_t I2SParallelLightOutput::size() const { return this->num_leds_; }
+bool I2SParallelLightOutput::get_raw_pixels_(RawPixels *raw) const {
+  // the pixels are kept in RGB order, the color order is applied when encoding
+  raw->data = this->leds_;
+  raw->stride = 3;
+  raw->offsets[0] = 0;
+  raw->offsets[1] = 1;
+  raw->offsets[2] = 2;
+  return true;
+}
+void I2SParallelLightOutput::clear_effect_data() {
+  for (int32_t i = 0; i < this->num_leds_; i++)
+    this->effect_data_[i] = 0;
+}
+
+}  // namespace light
+
+ESPHOME_NAMESPACE_END
+
+#endif  // USE_I2S_PARALLEL_LIGHT
@@ -0,0 +1,112 @@
+#ifndef ESPHOME_LIGHT_I2S_PARALLEL_LIGHT_OUTPUT_H
+#define ESPHOME_LIGHT_I2S_PARALLEL_LIGHT_OUTPUT_H
+
+#include "esphome/defines.h"
+
+#ifdef USE_I2S_PARALLEL_LIGHT
+
+#include "esphome/component.h"
+#include "esphome/power_supply_component.h"
+#include "esphome/light/light_state.h"
+#include "esphome/light/addressable_light.h"
+
+#include <vector>
+#include <rom/lldesc.h>
+#include <esp_intr_alloc.h>
+
+ESPHOME_NAMESPACE_BEGIN
+
+namespace light {
+
+/// The order the color channels are sent in, the three 2 bit fields are the RGB index of the first to last channel.
+enum class I2SParallelColorOrder : uint8_t {
+  RGB = 0b000110,
+  RBG = 0b001001,
+  GRB = 0b010010,
+  GBR = 0b011000,
+  BRG = 0b100001,
+  BGR = 0b100100,
+};
+
+/** Drive up to 16 WS2812-type strips at once with the I2S peripheral of the ESP32 in parallel (LCD) mode.
+ *
+ * Each strip is a lane of the 16 bit parallel output, the DMA clocks out all lanes together, so a frame takes as
+ * long as the longest strip instead of the sum of all strips (30µs per pixel plus the latch). The frame is sent by
+ * DMA without the CPU, the main loop only encodes the pixels into the DMA buffer and doesn't wait for it.
+ *
+ * All strips are one light, the pixels of each strip follow the pixels of the strips added before it. To control
+ * the strips separately, split it up with a PartitionLightOutput, see get_strip_offset().
+ *
+ * The DMA buffer takes 144 bytes per pixel of the longest strip (every bit is 3 samples of 16 bits). It's
+ * allocated in chunks of 28 pixels, so it doesn't need one large block of DMA capable memory.
+ */
+class I2SParallelLightOutput : public Component, public AddressableLight {
+ public:
+  /// Add a strip with num_leds pixels on pin, at most 16 strips. Call before setup.
+  void add_strip(uint8_t pin, uint16_t num_leds);
+  /// Set the order of the color channels on the wire, defaults to GRB (WS2812).
+  void set_color_order(I2SParallelColorOrder color_order);
+#ifdef USE_OUTPUT
+  void set_power_supply(PowerSupplyComponent *power_supply);
+#endif
+
+  /// The index of the first pixel of the strip (in the order they were added), for PartitionLightOutput segments.
+  int32_t get_strip_offset(uint8_t strip) const;
+
+  int32_t size() const override;
+  ESPColorView operator[](int32_t index) const override;
+
+  // ========== INTERNAL METHODS ==========
+  // (In most use cases you won't need these)
+  LightTraits get_traits() override;
+  void setup() override;
+  void dump_config() override;
+  void loop() override;
+  float get_setup_priority() const override;
+
+  void clear_effect_data() override;
+#ifdef USE_OUTPUT
+  void pre_enable_power() override;
+#endif
+
+ protected:
+  struct Strip {
+    uint8_t pin;
+    uint16_t num_leds;
+    int32_t offset;
+  };
+
+  bool get_raw_pixels_(RawPixels *raw) const override;
+  /// Write the data bits of all pixels into the DMA buffer.
+  void encode_();
+  /// Start sending the DMA buffer.
+  void start_();
+  static void interrupt_(void *arg);
+
+  std::vector<Strip> strips_;
+  I2SParallelColorOrder color_order_{I2SParallelColorOrder::GRB};
+  int32_t num_leds_{0};
+  /// The number of pixels of the longest strip.
+  uint16_t max_strip_leds_{0};
+  uint8_t *leds_{nullptr};
+  uint8_t *effect_data_{nullptr};
+  /// The DMA buffer, LEDS_PER_CHUNK pixels per chunk.
+  std::vector<uint16_t *> chunks_;
+  /// One descriptor per chunk, plus the latch (all lanes low) at the end.
+  lldesc_t *descriptors_{nullptr};
+  intr_handle_t interrupt_handle_{nullptr};
+  /// Set while the DMA is sending, the buffer can't be written then.
+  volatile bool busy_{false};
+#ifdef USE_OUTPUT
+  PowerSupplyComponent *power_supply_{nullptr};
+  bool has_requested_high_power_{false};
+#endif
+};
+
+}  // namespace light
+
+ESPHOME_NAMESPACE_END
+
+#endif  // USE_I2S_PARALLEL_LIGHT
+
+#endif  // ESPHOME_LIGHT_I2S_PARALLEL_LIGHT_OUTPUT_H
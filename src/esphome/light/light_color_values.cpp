@@ -21,6 +21,76 @@ namespace light {
 static const char *TAG = "light.light_color_values";
 #endif
 
+#ifdef USE_LIGHT_FIXED_POINT
+float LightColorValues::get_state() const { return q16_to_float(this->state_); }
+
+void LightColorValues::set_state(float state) { this->state_ = float_to_q16(state); }
+void LightColorValues::set_state(bool state) { this->state_ = state ? LIGHT_Q16_ONE : 0; }
+
+float LightColorValues::get_brightness() const { return q16_to_float(this->brightness_); }
+
+void LightColorValues::set_brightness(float brightness) { this->brightness_ = float_to_q16(brightness); }
+
+float LightColorValues::get_red() const { return q16_to_float(this->red_); }
+
+void LightColorValues::set_red(float red) { this->red_ = float_to_q16(red); }
+
+float LightColorValues::get_green() const { return q16_to_float(this->green_); }
+
+void LightColorValues::set_green(float green) { this->green_ = float_to_q16(green); }
+
+float LightColorValues::get_blue() const { return q16_to_float(this->blue_); }
+
+void LightColorValues::set_blue(float blue) { this->blue_ = float_to_q16(blue); }
+
+float LightColorValues::get_white() const { return q16_to_float(this->white_); }
+
+void LightColorValues::set_white(float white) { this->white_ = float_to_q16(white); }
+
+uint16_t LightColorValues::get_state_q16() const { return this->state_; }
+uint16_t LightColorValues::get_brightness_q16() const { return this->brightness_; }
+uint16_t LightColorValues::get_red_q16() const { return this->red_; }
+uint16_t LightColorValues::get_green_q16() const { return this->green_; }
+uint16_t LightColorValues::get_blue_q16() const { return this->blue_; }
+uint16_t LightColorValues::get_white_q16() const { return this->white_; }
+
+LightColorValues::LightColorValues()
+    : state_(0),
+      brightness_(LIGHT_Q16_ONE),
+      red_(LIGHT_Q16_ONE),
+      green_(LIGHT_Q16_ONE),
+      blue_(LIGHT_Q16_ONE),
+      white_(LIGHT_Q16_ONE),
+      color_temperature_{1.0f} {}
+
+static uint16_t lerp_q16_value(uint16_t start, uint16_t end, uint16_t completion) {
+  if (end >= start)
+    return start + q16_mul(end - start, completion);
+  return start - q16_mul(start - end, completion);
+}
+
+LightColorValues LightColorValues::lerp(const LightColorValues &start, const LightColorValues &end, float completion) {
+  return LightColorValues::lerp_q16(start, end, float_to_q16(completion));
+}
+
+LightColorValues LightColorValues::lerp_q16(const LightColorValues &start, const LightColorValues &end,
+                                            uint16_t completion) {
+  LightColorValues v;
+  v.state_ = lerp_q16_value(start.state_, end.state_, completion);
+  v.brightness_ = lerp_q16_value(start.brightness_, end.brightness_, completion);
+  v.red_ = lerp_q16_value(start.red_, end.red_, completion);
+  v.green_ = lerp_q16_value(start.green_, end.green_, completion);
+  v.blue_ = lerp_q16_value(start.blue_, end.blue_, completion);
+  v.white_ = lerp_q16_value(start.white_, end.white_, completion);
+  if (start.color_temperature_ == end.color_temperature_) {
+    v.color_temperature_ = start.color_temperature_;
+  } else {
+    v.set_color_temperature(esphome::lerp(start.color_temperature_, end.color_temperature_, q16_to_float(completion)));
+  }
+
+  return v;
+}
+#else
 float LightColorValues::get_state() const { return this->state_; }
 
 void LightColorValues::set_state(float state) { this->state_ = clamp(0.0f, 1.0f, state); }
@@ -46,6 +116,13 @@ float LightColorValues::get_white() const { return white_; }
 
 void LightColorValues::set_white(float white) { this->white_ = clamp(0.0f, 1.0f, white); }
 
+uint16_t LightColorValues::get_state_q16() const { return float_to_q16(this->state_); }
+uint16_t LightColorValues::get_brightness_q16() const { return float_to_q16(this->brightness_); }
+uint16_t LightColorValues::get_red_q16() const { return float_to_q16(this->red_); }
+uint16_t LightColorValues::get_green_q16() const { return float_to_q16(this->green_); }
+uint16_t LightColorValues::get_blue_q16() const { return float_to_q16(this->blue_); }
+uint16_t LightColorValues::get_white_q16() const { return float_to_q16(this->white_); }
+
 LightColorValues::LightColorValues()
     : state_(0.0f), brightness_(1.0f), red_(1.0f), green_(1.0f), blue_(1.0f), white_(1.0f), color_temperature_{1.0f} {}
 
@@ -62,6 +139,12 @@ LightColorValues LightColorValues::lerp(const LightColorValues &start, const Lig
   return v;
 }
 
+LightColorValues LightColorValues::lerp_q16(const LightColorValues &start, const LightColorValues &end,
+                                            uint16_t completion) {
+  return LightColorValues::lerp(start, end, q16_to_float(completion));
+}
+#endif
+
 LightColorValues::LightColorValues(float state, float brightness, float red, float green, float blue, float white,
                                    float color_temperature) {
   this->set_state(state);
@@ -112,20 +195,21 @@ void LightColorValues::normalize_color(const LightTraits &traits) {
   }
 }
 
-void LightColorValues::dump_json(JsonObject &root, const LightTraits &traits) const {
-  root["state"] = (this->get_state() != 0.0f) ? "ON" : "OFF";
+void LightColorValues::dump_json(JsonWriter &writer, const LightTraits &traits) const {
+  writer.add("state", (this->get_state() != 0.0f) ? "ON" : "OFF");
   if (traits.has_brightness())
-    root["brightness"] = uint8_t(this->get_brightness() * 255);
+    writer.add("brightness", unsigned(uint8_t(this->get_brightness() * 255)));
   if (traits.has_rgb()) {
-    JsonObject &color = root.createNestedObject("color");
-    color["r"] = uint8_t(this->get_red() * 255);
-    color["g"] = uint8_t(this->get_green() * 255);
-    color["b"] = uint8_t(this->get_blue() * 255);
+    writer.begin_object("color");
+    writer.add("r", unsigned(uint8_t(this->get_red() * 255)));
+    writer.add("g", unsigned(uint8_t(this->get_green() * 255)));
+    writer.add("b", unsigned(uint8_t(this->get_blue() * 255)));
+    writer.end_object();
   }
   if (traits.has_rgb_white_value())
-    root["white_value"] = uint8_t(this->get_white() * 255);
+    writer.add("white_value", unsigned(uint8_t(this->get_white() * 255)));
   if (traits.has_color_temperature())
-    root["color_temp"] = uint32_t(this->get_color_temperature());
+    writer.add("color_temp", unsigned(this->get_color_temperature()));
 }
 
 bool LightColorValues::operator==(const LightColorValues &rhs) const {
@@ -136,7 +220,7 @@ bool LightColorValues::operator==(const LightColorValues &rhs) const {
 bool LightColorValues::operator!=(const LightColorValues &rhs) const { return !(rhs == *this); }
 void LightColorValues::as_rgbw(float *red, float *green, float *blue, float *white) const {
   this->as_rgb(red, green, blue);
-  *white = this->state_ * this->white_;
+  *white = this->get_state() * this->get_white();
 }
 
 void LightColorValues::as_rgbww(float color_temperature_cw, float color_temperature_ww, float *red, float *green,
@@ -146,8 +230,8 @@ void LightColorValues::as_rgbww(float color_temperature_cw, float color_temperat
   const float ww_fraction = (color_temp - color_temperature_cw) / (color_temperature_ww - color_temperature_cw);
   const float cw_fraction = 1.0f - ww_fraction;
   const float max_cw_ww = std::max(ww_fraction, cw_fraction);
-  *cold_white = this->state_ * this->white_ * (cw_fraction / max_cw_ww);
-  *warm_white = this->state_ * this->white_ * (ww_fraction / max_cw_ww);
+  *cold_white = this->get_state() * this->get_white() * (cw_fraction / max_cw_ww);
+  *warm_white = this->get_state() * this->get_white() * (ww_fraction / max_cw_ww);
 }
 void LightColorValues::as_cwww(float color_temperature_cw, float color_temperature_ww, float *cold_white,
                                float *warm_white) const {
@@ -155,16 +239,60 @@ void LightColorValues::as_cwww(float color_temperature_cw, float color_temperatu
   const float ww_fraction = (color_temp - color_temperature_cw) / (color_temperature_ww - color_temperature_cw);
   const float cw_fraction = 1.0f - ww_fraction;
   const float max_cw_ww = std::max(ww_fraction, cw_fraction);
-  *cold_white = this->state_ * this->brightness_ * (cw_fraction / max_cw_ww);
-  *warm_white = this->state_ * this->brightness_ * (ww_fraction / max_cw_ww);
+  *cold_white = this->get_state() * this->get_brightness() * (cw_fraction / max_cw_ww);
+  *warm_white = this->get_state() * this->get_brightness() * (ww_fraction / max_cw_ww);
 }
 void LightColorValues::as_rgb(float *red, float *green, float *blue) const {
-  *red = this->state_ * this->brightness_ * this->red_;
-  *green = this->state_ * this->brightness_ * this->green_;
-  *blue = this->state_ * this->brightness_ * this->blue_;
+  const float scale = this->get_state() * this->get_brightness();
+  *red = scale * this->get_red();
+  *green = scale * this->get_green();
+  *blue = scale * this->get_blue();
+}
+void LightColorValues::as_brightness(float *brightness) const {
+  *brightness = this->get_state() * this->get_brightness();
+}
+void LightColorValues::as_binary(bool *binary) const { *binary = this->get_state() == 1.0f; }
+void LightColorValues::as_brightness_q16(uint16_t *brightness) const {
+  *brightness = q16_mul(this->get_state_q16(), this->get_brightness_q16());
+}
+void LightColorValues::as_rgb_q16(uint16_t *red, uint16_t *green, uint16_t *blue) const {
+  const uint16_t scale = q16_mul(this->get_state_q16(), this->get_brightness_q16());
+  *red = q16_mul(scale, this->get_red_q16());
+  *green = q16_mul(scale, this->get_green_q16());
+  *blue = q16_mul(scale, this->get_blue_q16());
+}
+void LightColorValues::as_rgbw_q16(uint16_t *red, uint16_t *green, uint16_t *blue, uint16_t *white) const {
+  this->as_rgb_q16(red, green, blue);
+  *white = q16_mul(this->get_state_q16(), this->get_white_q16());
+}
+void LightColorValues::cwww_fractions_q16_(float color_temperature_cw, float color_temperature_ww,
+                                           uint16_t *cw_fraction, uint16_t *ww_fraction) const {
+  const float color_temp = clamp(color_temperature_cw, color_temperature_ww, this->color_temperature_);
+  const uint16_t ww = float_to_q16((color_temp - color_temperature_cw) / (color_temperature_ww - color_temperature_cw));
+  const uint16_t cw = LIGHT_Q16_ONE - ww;
+  // scale so that the larger of the two is fully on
+  const uint16_t max_cw_ww = std::max(ww, cw);
+  *cw_fraction = (uint32_t(cw) * LIGHT_Q16_ONE + max_cw_ww / 2) / max_cw_ww;
+  *ww_fraction = (uint32_t(ww) * LIGHT_Q16_ONE + max_cw_ww / 2) / max_cw_ww;
+}
+void LightColorValues::as_rgbww_q16(float color_temperature_cw, float color_temperature_ww, uint16_t *red,
+                                    uint16_t *green, uint16_t *blue, uint16_t *cold_white,
+                                    uint16_t *warm_white) const {
+  this->as_rgb_q16(red, green, blue);
+  uint16_t cw_fraction, ww_fraction;
+  this->cwww_fractions_q16_(color_temperature_cw, color_temperature_ww, &cw_fraction, &ww_fraction);
+  const uint16_t white = q16_mul(this->get_state_q16(), this->get_white_q16());
+  *cold_white = q16_mul(white, cw_fraction);
+  *warm_white = q16_mul(white, ww_fraction);
+}
+void LightColorValues::as_cwww_q16(float color_temperature_cw, float color_temperature_ww, uint16_t *cold_white,
+                                   uint16_t *warm_white) const {
+  uint16_t cw_fraction, ww_fraction;
+  this->cwww_fractions_q16_(color_temperature_cw, color_temperature_ww, &cw_fraction, &ww_fraction);
+  const uint16_t brightness = q16_mul(this->get_state_q16(), this->get_brightness_q16());
+  *cold_white = q16_mul(brightness, cw_fraction);
+  *warm_white = q16_mul(brightness, ww_fraction);
 }
-void LightColorValues::as_brightness(float *brightness) const { *brightness = this->state_ * this->brightness_; }
-void LightColorValues::as_binary(bool *binary) const { *binary = this->state_ == 1.0f; }
 LightColorValues LightColorValues::from_binary(bool state) { return {state, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f}; }
 LightColorValues LightColorValues::from_monochromatic(float brightness) {
   if (brightness == 0.0f)
@@ -192,7 +320,7 @@ float LightColorValues::get_color_temperature() const { return this->color_tempe
 void LightColorValues::set_color_temperature(float color_temperature) {
   this->color_temperature_ = std::max(0.000001f, color_temperature);
 }
-bool LightColorValues::is_on() const { return this->get_state() != 0.0f; }
+bool LightColorValues::is_on() const { return this->state_ != 0; }
 
 }  // namespace light
 
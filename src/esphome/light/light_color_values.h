@@ -7,6 +7,7 @@
 
 #include <ArduinoJson.h>
 #include <string>
+#include "esphome/helpers.h"
 #include "esphome/light/light_traits.h"
 
 ESPHOME_NAMESPACE_BEGIN
@@ -21,6 +22,11 @@ namespace light {
  *
  * PLease note all float values are automatically clamped.
  *
+ * With USE_LIGHT_FIXED_POINT the channels are stored as Q16 integers (0 to 65535) instead, so that
+ * interpolating and converting them for the outputs doesn't need any floating point math on chips
+ * without an FPU like the ESP8266. The float API stays available in both modes and the *_q16 API
+ * in both modes too, only the internal representation changes.
+ *
  * state - Whether the light should be on/off. Represented as a float for transitions.
  * brightness - The brightness of the light.
  * red, green, blue - RGB values.
@@ -61,12 +67,15 @@ class LightColorValues {
    */
   static LightColorValues lerp(const LightColorValues &start, const LightColorValues &end, float completion);
 
-  /** Dump this color into a JsonObject. Only dumps values if the corresponding traits are marked supported by traits.
+  /// Same as lerp(), but with completion as a Q16 value from 0 (start) to 65535 (end).
+  static LightColorValues lerp_q16(const LightColorValues &start, const LightColorValues &end, uint16_t completion);
+
+  /** Dump this color as JSON members. Only dumps values if the corresponding traits are marked supported by traits.
    *
-   * @param root The json root object.
+   * @param writer The writer of the json object.
    * @param traits The traits object used for determining whether to include certain attributes.
    */
-  void dump_json(JsonObject &root, const LightTraits &traits) const;
+  void dump_json(JsonWriter &writer, const LightTraits &traits) const;
 
   /** Normalize the color (RGB/W) component.
    *
@@ -96,6 +105,23 @@ class LightColorValues {
   /// Convert these light color values to an CWWW representation with the given parameters.
   void as_cwww(float color_temperature_cw, float color_temperature_ww, float *cold_white, float *warm_white) const;
 
+  /// Convert these light color values to a brightness-only Q16 representation.
+  void as_brightness_q16(uint16_t *brightness) const;
+
+  /// Convert these light color values to an RGB Q16 representation.
+  void as_rgb_q16(uint16_t *red, uint16_t *green, uint16_t *blue) const;
+
+  /// Convert these light color values to an RGBW Q16 representation.
+  void as_rgbw_q16(uint16_t *red, uint16_t *green, uint16_t *blue, uint16_t *white) const;
+
+  /// Convert these light color values to an RGBWW Q16 representation with the given parameters.
+  void as_rgbww_q16(float color_temperature_cw, float color_temperature_ww, uint16_t *red, uint16_t *green,
+                    uint16_t *blue, uint16_t *cold_white, uint16_t *warm_white) const;
+
+  /// Convert these light color values to an CWWW Q16 representation with the given parameters.
+  void as_cwww_q16(float color_temperature_cw, float color_temperature_ww, uint16_t *cold_white,
+                   uint16_t *warm_white) const;
+
   /// Compare this LightColorValues to rhs, return true if and only if all attributes match.
   bool operator==(const LightColorValues &rhs) const;
   bool operator!=(const LightColorValues &rhs) const;
@@ -134,21 +160,68 @@ class LightColorValues {
   /// Set the white property of these light color values. In range 0.0 to 1.0
   void set_white(float white);
 
+  /// Get the state as a Q16 value, 0 (off) to 65535 (on).
+  uint16_t get_state_q16() const;
+  /// Get the brightness as a Q16 value, 0 to 65535.
+  uint16_t get_brightness_q16() const;
+  /// Get the red property as a Q16 value, 0 to 65535.
+  uint16_t get_red_q16() const;
+  /// Get the green property as a Q16 value, 0 to 65535.
+  uint16_t get_green_q16() const;
+  /// Get the blue property as a Q16 value, 0 to 65535.
+  uint16_t get_blue_q16() const;
+  /// Get the white property as a Q16 value, 0 to 65535.
+  uint16_t get_white_q16() const;
+
   /// Get the color temperature property of these light color values in mired.
   float get_color_temperature() const;
   /// Set the color temperature property of these light color values in mired.
   void set_color_temperature(float color_temperature);
 
  protected:
+  /// Get the cold white and warm white fractions (Q16, the larger one is always 65535) for the color temperature.
+  void cwww_fractions_q16_(float color_temperature_cw, float color_temperature_ww, uint16_t *cw_fraction,
+                           uint16_t *ww_fraction) const;
+
+#ifdef USE_LIGHT_FIXED_POINT
+  uint16_t state_;  ///< ON / OFF, Q16 for transition
+  uint16_t brightness_;
+  uint16_t red_;
+  uint16_t green_;
+  uint16_t blue_;
+  uint16_t white_;
+#else
   float state_;  ///< ON / OFF, float for transition
   float brightness_;
   float red_;
   float green_;
   float blue_;
   float white_;
+#endif
   float color_temperature_;  ///< Color Temperature in Mired
 };
 
+/// The Q16 value representing 1.0 (fully on).
+static const uint16_t LIGHT_Q16_ONE = 65535;
+
+/// Convert a float from 0.0 to 1.0 to a Q16 value, clamping it.
+inline uint16_t float_to_q16(float value) {
+  if (value <= 0.0f)
+    return 0;
+  if (value >= 1.0f)
+    return LIGHT_Q16_ONE;
+  return uint16_t(value * 65535.0f + 0.5f);
+}
+
+/// Convert a Q16 value back to a float from 0.0 to 1.0.
+inline float q16_to_float(uint16_t value) { return value * (1.0f / 65535.0f); }
+
+/// Multiply two Q16 values (a * b / 65535), rounded to the nearest integer.
+inline uint16_t q16_mul(uint16_t a, uint16_t b) {
+  const uint32_t t = uint32_t(a) * b + 32768UL;
+  return (t + (t >> 16)) >> 16;
+}
+
 }  // namespace light
 
 ESPHOME_NAMESPACE_END
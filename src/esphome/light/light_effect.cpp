@@ -37,12 +37,22 @@ void RandomLightEffect::set_transition_length(uint32_t transition_length) {
 }
 void RandomLightEffect::set_update_interval(uint32_t update_interval) { this->update_interval_ = update_interval; }
 
-LightEffect::LightEffect(const std::string &name) : name_(name) {}
+LightEffect::LightEffect(const std::string &name) : name_(name), name_hash_(hash_name(name.c_str())) {}
 
 void LightEffect::start() {}
 void LightEffect::start_internal() { this->start(); }
 void LightEffect::stop() {}
 const std::string &LightEffect::get_name() { return this->name_; }
+uint32_t LightEffect::get_name_hash() const { return this->name_hash_; }
+uint32_t LightEffect::hash_name(const char *name) {
+  // FNV-1 of the lower case name
+  uint32_t hash = 2166136261UL;
+  for (; *name != '\0'; name++) {
+    hash *= 16777619UL;
+    hash ^= tolower(*name);
+  }
+  return hash;
+}
 void LightEffect::init() {}
 void LightEffect::init_internal(LightState *state) {
   this->state_ = state;
@@ -31,6 +31,10 @@ class LightEffect {
   virtual void apply() = 0;
 
   const std::string &get_name();
+  /// The case-insensitive hash of the name, to find effects without comparing strings.
+  uint32_t get_name_hash() const;
+  /// Hash an effect name like get_name_hash() does, without copying it.
+  static uint32_t hash_name(const char *name);
 
   /// Internal method called by the LightState when this light effect is registered in it.
   virtual void init();
@@ -40,6 +44,7 @@ class LightEffect {
  protected:
   LightState *state_{nullptr};
   std::string name_;
+  uint32_t name_hash_;
 };
 
 /// Random effect. Sets random colors every 10 seconds and slowly transitions between them.
@@ -22,6 +22,7 @@ void BinaryLightOutput::write_state(LightState *state) {
   else
     this->output_->turn_off();
 }
+void BinaryLightOutput::pre_enable_power() { this->output_->pre_enable_power(); }
 BinaryLightOutput::BinaryLightOutput(output::BinaryOutput *output) : LightOutput(), output_(output) {}
 
 LightTraits MonochromaticLightOutput::get_traits() { return {true, false, false, false}; }
@@ -30,6 +31,13 @@ void MonochromaticLightOutput::write_state(LightState *state) {
   state->current_values_as_brightness(&value);
   this->output_->set_level(value);
 }
+void MonochromaticLightOutput::pre_enable_power() { this->output_->pre_enable_power(); }
+bool MonochromaticLightOutput::supports_fade() { return this->output_->supports_fade(); }
+void MonochromaticLightOutput::write_fade(LightState *state, uint32_t length) {
+  float value;
+  state->current_values_as_brightness(&value);
+  this->output_->fade_to_level(value, length);
+}
 MonochromaticLightOutput::MonochromaticLightOutput(FloatOutput *output) : output_(output) {}
 
 LightTraits CWWWLightOutput::get_traits() {
@@ -44,6 +52,19 @@ void CWWWLightOutput::write_state(LightState *state) {
   this->cold_white_->set_level(cold_white);
   this->warm_white_->set_level(warm_white);
 }
+void CWWWLightOutput::pre_enable_power() {
+  this->cold_white_->pre_enable_power();
+  this->warm_white_->pre_enable_power();
+}
+bool CWWWLightOutput::supports_fade() {
+  return this->cold_white_->supports_fade() && this->warm_white_->supports_fade();
+}
+void CWWWLightOutput::write_fade(LightState *state, uint32_t length) {
+  float cold_white, warm_white;
+  state->current_values_as_cwww(this->cold_white_mireds_, this->warm_white_mireds_, &cold_white, &warm_white);
+  this->cold_white_->fade_to_level(cold_white, length);
+  this->warm_white_->fade_to_level(warm_white, length);
+}
 CWWWLightOutput::CWWWLightOutput(float cold_white_mireds, float warm_white_mireds, FloatOutput *cold_white,
                                  FloatOutput *warm_white)
     : cold_white_mireds_(cold_white_mireds),
@@ -59,6 +80,21 @@ void RGBLightOutput::write_state(LightState *state) {
   this->green_->set_level(green);
   this->blue_->set_level(blue);
 }
+void RGBLightOutput::pre_enable_power() {
+  this->red_->pre_enable_power();
+  this->green_->pre_enable_power();
+  this->blue_->pre_enable_power();
+}
+bool RGBLightOutput::supports_fade() {
+  return this->red_->supports_fade() && this->green_->supports_fade() && this->blue_->supports_fade();
+}
+void RGBLightOutput::write_fade(LightState *state, uint32_t length) {
+  float red, green, blue;
+  state->current_values_as_rgb(&red, &green, &blue);
+  this->red_->fade_to_level(red, length);
+  this->green_->fade_to_level(green, length);
+  this->blue_->fade_to_level(blue, length);
+}
 RGBLightOutput::RGBLightOutput(FloatOutput *red, FloatOutput *green, FloatOutput *blue)
     : red_(red), green_(green), blue_(blue) {}
 
@@ -71,6 +107,24 @@ void RGBWLightOutput::write_state(LightState *state) {
   this->blue_->set_level(blue);
   this->white_->set_level(white);
 }
+void RGBWLightOutput::pre_enable_power() {
+  this->red_->pre_enable_power();
+  this->green_->pre_enable_power();
+  this->blue_->pre_enable_power();
+  this->white_->pre_enable_power();
+}
+bool RGBWLightOutput::supports_fade() {
+  return this->red_->supports_fade() && this->green_->supports_fade() && this->blue_->supports_fade() &&
+         this->white_->supports_fade();
+}
+void RGBWLightOutput::write_fade(LightState *state, uint32_t length) {
+  float red, green, blue, white;
+  state->current_values_as_rgbw(&red, &green, &blue, &white);
+  this->red_->fade_to_level(red, length);
+  this->green_->fade_to_level(green, length);
+  this->blue_->fade_to_level(blue, length);
+  this->white_->fade_to_level(white, length);
+}
 RGBWLightOutput::RGBWLightOutput(FloatOutput *red, FloatOutput *green, FloatOutput *blue, FloatOutput *white)
     : red_(red), green_(green), blue_(blue), white_(white) {}
 
@@ -90,6 +144,27 @@ void RGBWWLightOutput::write_state(LightState *state) {
   this->cold_white_->set_level(cold_white);
   this->warm_white_->set_level(warm_white);
 }
+void RGBWWLightOutput::pre_enable_power() {
+  this->red_->pre_enable_power();
+  this->green_->pre_enable_power();
+  this->blue_->pre_enable_power();
+  this->cold_white_->pre_enable_power();
+  this->warm_white_->pre_enable_power();
+}
+bool RGBWWLightOutput::supports_fade() {
+  return this->red_->supports_fade() && this->green_->supports_fade() && this->blue_->supports_fade() &&
+         this->cold_white_->supports_fade() && this->warm_white_->supports_fade();
+}
+void RGBWWLightOutput::write_fade(LightState *state, uint32_t length) {
+  float red, green, blue, cold_white, warm_white;
+  state->current_values_as_rgbww(this->cold_white_mireds_, this->warm_white_mireds_, &red, &green, &blue, &cold_white,
+                                 &warm_white);
+  this->red_->fade_to_level(red, length);
+  this->green_->fade_to_level(green, length);
+  this->blue_->fade_to_level(blue, length);
+  this->cold_white_->fade_to_level(cold_white, length);
+  this->warm_white_->fade_to_level(warm_white, length);
+}
 RGBWWLightOutput::RGBWWLightOutput(float cold_white_mireds, float warm_white_mireds, FloatOutput *red,
                                    FloatOutput *green, FloatOutput *blue, FloatOutput *cold_white,
                                    FloatOutput *warm_white)
@@ -18,6 +18,7 @@ class BinaryLightOutput : public LightOutput {
   explicit BinaryLightOutput(output::BinaryOutput *output);
   LightTraits get_traits() override;
   void write_state(LightState *state) override;
+  void pre_enable_power() override;
 
  protected:
   output::BinaryOutput *output_;
@@ -28,6 +29,9 @@ class MonochromaticLightOutput : public LightOutput {
   explicit MonochromaticLightOutput(output::FloatOutput *output);
   LightTraits get_traits() override;
   void write_state(LightState *state) override;
+  void pre_enable_power() override;
+  bool supports_fade() override;
+  void write_fade(LightState *state, uint32_t length) override;
 
  protected:
   output::FloatOutput *output_;
@@ -40,6 +44,9 @@ class CWWWLightOutput : public LightOutput {
 
   LightTraits get_traits() override;
   void write_state(LightState *state) override;
+  void pre_enable_power() override;
+  bool supports_fade() override;
+  void write_fade(LightState *state, uint32_t length) override;
 
  protected:
   float cold_white_mireds_;
@@ -53,6 +60,9 @@ class RGBLightOutput : public LightOutput {
   RGBLightOutput(output::FloatOutput *red, output::FloatOutput *green, output::FloatOutput *blue);
   LightTraits get_traits() override;
   void write_state(LightState *state) override;
+  void pre_enable_power() override;
+  bool supports_fade() override;
+  void write_fade(LightState *state, uint32_t length) override;
 
  protected:
   output::FloatOutput *red_;
@@ -66,6 +76,9 @@ class RGBWLightOutput : public LightOutput {
                   output::FloatOutput *white);
   LightTraits get_traits() override;
   void write_state(LightState *state) override;
+  void pre_enable_power() override;
+  bool supports_fade() override;
+  void write_fade(LightState *state, uint32_t length) override;
 
  protected:
   output::FloatOutput *red_;
@@ -82,6 +95,9 @@ class RGBWWLightOutput : public LightOutput {
 
   LightTraits get_traits() override;
   void write_state(LightState *state) override;
+  void pre_enable_power() override;
+  bool supports_fade() override;
+  void write_fade(LightState *state, uint32_t length) override;
 
  protected:
   float cold_white_mireds_;
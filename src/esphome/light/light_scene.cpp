@@ -0,0 +1,36 @@
+#include "esphome/defines.h"
+
+#ifdef USE_LIGHT
+
+#include "esphome/light/light_scene.h"
+#include "esphome/esphal.h"
+
+ESPHOME_NAMESPACE_BEGIN
+
+namespace light {
+
+LightCall &LightScene::add_light(LightState *state) {
+  this->calls_.push_back(state->make_call());
+  return this->calls_.back();
+}
+
+void LightScene::apply() {
+  const uint32_t now = millis();
+  for (auto &call : this->calls_)
+    call.apply_(now);
+
+  // Don't wait for the loop() of each light, lights before the caller in the loop order would only follow next loop
+  for (auto &call : this->calls_)
+    call.parent_->write_pending_();
+
+  for (auto &call : this->calls_) {
+    if (call.publish_)
+      call.parent_->remote_values_callback_.call();
+  }
+}
+
+}  // namespace light
+
+ESPHOME_NAMESPACE_END
+
+#endif  // USE_LIGHT
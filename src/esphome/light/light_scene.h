@@ -0,0 +1,66 @@
+#ifndef ESPHOME_LIGHT_LIGHT_SCENE_H
+#define ESPHOME_LIGHT_LIGHT_SCENE_H
+
+#include "esphome/defines.h"
+
+#ifdef USE_LIGHT
+
+#include <vector>
+#include "esphome/automation.h"
+#include "esphome/light/light_state.h"
+
+ESPHOME_NAMESPACE_BEGIN
+
+namespace light {
+
+template<typename... Ts> class LightSceneApplyAction;
+
+/** A set of lights that are changed together.
+ *
+ * Performing the calls of many lights one after the other lets their transitions start a few ms apart, has each
+ * light write its output in its own loop() and reports the new states light by light. A scene instead applies
+ * all calls first with the same start time, so that the transitions run in lockstep, then writes all outputs and
+ * finally reports the new states to the front-ends in one go.
+ */
+class LightScene {
+ public:
+  /** Add a light to the scene.
+   *
+   * @param state The light.
+   * @return The call describing the target of this light, only valid until the next add_light().
+   */
+  LightCall &add_light(LightState *state);
+
+  /// Apply the calls of all lights.
+  void apply();
+
+  template<typename... Ts> LightSceneApplyAction<Ts...> *make_apply_action();
+
+ protected:
+  std::vector<LightCall> calls_;
+};
+
+template<typename... Ts> class LightSceneApplyAction : public Action<Ts...> {
+ public:
+  explicit LightSceneApplyAction(LightScene *scene) : scene_(scene) {}
+
+  void play(Ts... x) override {
+    this->scene_->apply();
+    this->play_next(x...);
+  }
+
+ protected:
+  LightScene *scene_;
+};
+
+template<typename... Ts> LightSceneApplyAction<Ts...> *LightScene::make_apply_action() {
+  return new LightSceneApplyAction<Ts...>(this);
+}
+
+}  // namespace light
+
+ESPHOME_NAMESPACE_END
+
+#endif  // USE_LIGHT
+
+#endif  // ESPHOME_LIGHT_LIGHT_SCENE_H
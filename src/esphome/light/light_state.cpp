@@ -4,6 +4,8 @@
 
 #include "esphome/light/light_state.h"
 
+#include <algorithm>
+
 #include "esphome/helpers.h"
 #include "esphome/log.h"
 #include "esphome/esphal.h"
@@ -17,27 +19,81 @@ namespace light {
 
 static const char *TAG = "light.state";
 
-void LightState::start_transition_(const LightColorValues &target, uint32_t length) {
-  this->transformer_ = make_unique<LightTransitionTransformer>(millis(), length, this->current_values, target);
+/// Number of linear hardware fades a transition is split into to approximate its curve and the gamma correction.
+static const uint32_t LIGHT_FADE_SEGMENTS = 8;
+/// Minimum length of one hardware fade segment in ms.
+static const uint32_t LIGHT_MIN_FADE_SEGMENT_LENGTH = 100;
+
+void LightState::start_transition_(const LightColorValues &target, uint32_t length, uint32_t start_time) {
+  this->stop_hardware_fade_();
+  this->transformer_ = make_unique<LightTransitionTransformer>(start_time, length, this->current_values, target);
   this->remote_values = this->transformer_->get_remote_values();
+  if (length != 0 && this->output_->supports_fade()) {
+    // The output runs the transition, the loop is only needed for effects
+    this->hardware_fade_ = true;
+    this->fade_segment_length_ = std::max(length / LIGHT_FADE_SEGMENTS, LIGHT_MIN_FADE_SEGMENT_LENGTH);
+    this->start_fade_segment_();
+    return;
+  }
+  this->enable_loop();
 }
 
-void LightState::start_flash_(const LightColorValues &target, uint32_t length) {
+void LightState::start_fade_segment_() {
+  if (this->transformer_->is_finished()) {
+    this->stop_hardware_fade_();
+    this->remote_values = this->current_values = this->transformer_->get_end_values();
+    if (this->transformer_->publish_at_end())
+      this->publish_state();
+    this->transformer_ = nullptr;
+    // write the exact end values and let the loop disable itself again
+    this->next_write_ = true;
+    this->enable_loop();
+    return;
+  }
+
+  const uint32_t now = millis();
+  uint32_t length = this->fade_segment_length_;
+  const uint32_t remaining = this->transformer_->get_end_time() - now;
+  if (remaining < length + length / 2)
+    // Don't leave a tiny last segment
+    length = remaining;
+  // current_values hold the end values of the running segment while fading in hardware
+  this->current_values = this->transformer_->get_values_at(now + length);
+  this->output_->write_fade(this, length);
+  this->set_timeout("fade", length, [this]() { this->start_fade_segment_(); });
+}
+
+void LightState::stop_hardware_fade_() {
+  if (!this->hardware_fade_)
+    return;
+  this->cancel_timeout("fade");
+  this->hardware_fade_ = false;
+}
+
+void LightState::start_flash_(const LightColorValues &target, uint32_t length, uint32_t start_time) {
   LightColorValues end_colors = this->current_values;
   // If starting a flash if one is already happening, set end values to end values of current flash
   // Hacky but works
   if (this->transformer_ != nullptr)
     end_colors = this->transformer_->get_end_values();
-  this->transformer_ = make_unique<LightFlashTransformer>(millis(), length, end_colors, target);
+  this->stop_hardware_fade_();
+  this->transformer_ = make_unique<LightFlashTransformer>(start_time, length, end_colors, target);
   this->remote_values = this->transformer_->get_remote_values();
+  this->enable_loop();
 }
 
-LightState::LightState(const std::string &name, LightOutput *output) : Nameable(name), output_(output) {}
+LightState::LightState(const std::string &name, LightOutput *output) : Nameable(name), output_(output) {
+#ifdef USE_LIGHT_FIXED_POINT
+  this->update_gamma_table_();
+#endif
+}
 
 void LightState::set_immediately_(const LightColorValues &target) {
+  this->stop_hardware_fade_();
   this->transformer_ = nullptr;
   this->current_values = this->remote_values = target;
   this->next_write_ = true;
+  this->enable_loop();
 }
 
 LightColorValues LightState::get_current_values() { return this->current_values; }
@@ -45,15 +101,24 @@ LightColorValues LightState::get_current_values() { return this->current_values;
 void LightState::publish_state() {
   this->remote_values_callback_.call();
   this->next_write_ = true;
+  this->enable_loop();
 }
 
 LightColorValues LightState::get_remote_values() { return this->remote_values; }
 
-std::string LightState::get_effect_name() {
+void LightState::write_pending_() {
+  if (!this->next_write_ || this->hardware_fade_)
+    return;
+  this->output_->write_state(this);
+  this->next_write_ = false;
+}
+
+const std::string &LightState::get_effect_name() {
+  static const std::string NONE = "None";
   if (this->active_effect_index_ > 0)
     return this->effects_[this->active_effect_index_ - 1]->get_name();
   else
-    return "None";
+    return NONE;
 }
 
 void LightState::start_effect_(uint32_t effect_index) {
@@ -64,11 +129,14 @@ void LightState::start_effect_(uint32_t effect_index) {
   this->active_effect_index_ = effect_index;
   auto *effect = this->get_active_effect_();
   effect->start_internal();
+  this->enable_loop();
 }
 
 bool LightState::supports_effects() { return !this->effects_.empty(); }
 void LightState::set_transformer_(std::unique_ptr<LightTransformer> transformer) {
+  this->stop_hardware_fade_();
   this->transformer_ = std::move(transformer);
+  this->enable_loop();
 }
 void LightState::stop_effect_() {
   auto *effect = this->get_active_effect_();
@@ -81,10 +149,10 @@ void LightState::stop_effect_() {
 void LightState::set_default_transition_length(uint32_t default_transition_length) {
   this->default_transition_length_ = default_transition_length;
 }
-void LightState::dump_json(JsonObject &root) {
+void LightState::dump_json(JsonWriter &writer) {
   if (this->supports_effects())
-    root["effect"] = this->get_effect_name();
-  this->remote_values.dump_json(root, this->output_->get_traits());
+    writer.add("effect", this->get_effect_name());
+  this->remote_values.dump_json(writer, this->output_->get_traits());
 }
 
 struct LightStateRTCState {
@@ -133,8 +201,8 @@ void LightState::loop() {
     effect->apply();
   }
 
-  // Apply transformer (if any)
-  if (this->transformer_ != nullptr) {
+  // Apply transformer (if any), hardware fades advance in start_fade_segment_()
+  if (this->transformer_ != nullptr && !this->hardware_fade_) {
     if (this->transformer_->is_finished()) {
       this->remote_values = this->current_values = this->transformer_->get_end_values();
       if (this->transformer_->publish_at_end())
@@ -148,9 +216,15 @@ void LightState::loop() {
   }
 
   if (this->next_write_) {
-    this->output_->write_state(this);
+    // writing now would abort the running hardware fade
+    if (!this->hardware_fade_)
+      this->output_->write_state(this);
     this->next_write_ = false;
   }
+
+  // Nothing left to do until the next call/transition/effect
+  if (effect == nullptr && (this->transformer_ == nullptr || this->hardware_fade_))
+    this->disable_loop();
 }
 LightTraits LightState::get_traits() { return this->output_->get_traits(); }
 const std::vector<LightEffect *> &LightState::get_effects() const { return this->effects_; }
@@ -182,73 +256,62 @@ void LightState::set_mqtt(MQTTJSONLightComponent *mqtt) { this->mqtt_ = mqtt; }
 #endif
 
 void LightOutput::setup_state(LightState *state) {}
-
-LightCall &LightCall::parse_color_json(JsonObject &root) {
-  if (root.containsKey("state")) {
-    auto val = parse_on_off(root["state"]);
-    switch (val) {
-      case PARSE_ON:
-        this->set_state(true);
-        break;
-      case PARSE_OFF:
-        this->set_state(false);
-        break;
-      case PARSE_TOGGLE:
-        this->set_state(!this->parent_->remote_values.is_on());
-        break;
-      case PARSE_NONE:
-        break;
-    }
-  }
-
-  if (root.containsKey("brightness")) {
-    this->set_brightness(float(root["brightness"]) / 255.0f);
-  }
-
-  if (root.containsKey("color")) {
-    JsonObject &color = root["color"];
-    if (color.containsKey("r")) {
-      this->set_red(float(color["r"]) / 255.0f);
-    }
-    if (color.containsKey("g")) {
-      this->set_green(float(color["g"]) / 255.0f);
-    }
-    if (color.containsKey("b")) {
-      this->set_blue(float(color["b"]) / 255.0f);
+bool LightOutput::supports_fade() { return false; }
+void LightOutput::write_fade(LightState *state, uint32_t length) { this->write_state(state); }
+void LightOutput::pre_enable_power() {}
+
+LightCall &LightCall::parse_json(JsonReader &reader) {
+  while (reader.next()) {
+    if (reader.is_key("state")) {
+      auto val = parse_on_off(reader.get_string().c_str());
+      switch (val) {
+        case PARSE_ON:
+          this->set_state(true);
+          break;
+        case PARSE_OFF:
+          this->set_state(false);
+          break;
+        case PARSE_TOGGLE:
+          this->set_state(!this->parent_->remote_values.is_on());
+          break;
+        case PARSE_NONE:
+          break;
+      }
+    } else if (reader.is_key("brightness")) {
+      this->set_brightness(reader.get_float() / 255.0f);
+    } else if (reader.is_key("color")) {
+      JsonReader color = reader.get_object();
+      while (color.next()) {
+        if (color.is_key("r"))
+          this->set_red(color.get_float() / 255.0f);
+        else if (color.is_key("g"))
+          this->set_green(color.get_float() / 255.0f);
+        else if (color.is_key("b"))
+          this->set_blue(color.get_float() / 255.0f);
+      }
+    } else if (reader.is_key("white_value")) {
+      this->set_white(reader.get_float() / 255.0f);
+    } else if (reader.is_key("color_temp")) {
+      this->set_color_temperature(reader.get_float());
+    } else if (reader.is_key("flash")) {
+      this->set_flash_length(uint32_t(reader.get_float() * 1000));
+    } else if (reader.is_key("transition")) {
+      this->set_transition_length(uint32_t(reader.get_float() * 1000));
+    } else if (reader.is_key("effect")) {
+      this->set_effect(reader.get_string());
     }
   }
 
-  if (root.containsKey("white_value")) {
-    this->set_white(float(root["white_value"]) / 255.0f);
-  }
-
-  if (root.containsKey("color_temp")) {
-    this->set_color_temperature(float(root["color_temp"]));
-  }
-
   return *this;
 }
-LightCall &LightCall::parse_json(JsonObject &root) {
-  this->parse_color_json(root);
-
-  if (root.containsKey("flash")) {
-    auto length = uint32_t(float(root["flash"]) * 1000);
-    this->set_flash_length(length);
-  }
-
-  if (root.containsKey("transition")) {
-    auto length = uint32_t(float(root["transition"]) * 1000);
-    this->set_transition_length(length);
-  }
+void LightCall::perform() {
+  this->apply_(millis());
 
-  if (root.containsKey("effect")) {
-    const char *effect = root["effect"];
-    this->set_effect(effect);
+  if (this->publish_) {
+    this->parent_->publish_state();
   }
-
-  return *this;
 }
-void LightCall::perform() {
+void LightCall::apply_(uint32_t start_time) {
   // use remote values for fallback
   const char *name = this->parent_->get_name().c_str();
   if (this->publish_) {
@@ -281,13 +344,18 @@ void LightCall::perform() {
     }
   }
 
+  if (v.is_on() || (this->has_effect_() && *this->effect_ != 0)) {
+    // give the power supply the time until the write to come up
+    this->parent_->output_->pre_enable_power();
+  }
+
   if (this->has_flash_()) {
     // FLASH
     if (this->publish_) {
       ESP_LOGD(TAG, "  Flash Length: %.1fs", *this->flash_length_ / 1e3f);
     }
 
-    this->parent_->start_flash_(v, *this->flash_length_);
+    this->parent_->start_flash_(v, *this->flash_length_, start_time);
   } else if (this->has_transition_()) {
     // TRANSITION
     if (this->publish_) {
@@ -302,7 +370,7 @@ void LightCall::perform() {
       this->parent_->stop_effect_();
     }
 
-    this->parent_->start_transition_(v, *this->transition_length_);
+    this->parent_->start_transition_(v, *this->transition_length_, start_time);
 
   } else if (this->has_effect_()) {
     // EFFECT
@@ -327,10 +395,6 @@ void LightCall::perform() {
     this->parent_->set_immediately_(v);
   }
 
-  if (this->publish_) {
-    this->parent_->publish_state();
-  }
-
   if (this->save_) {
     LightStateRTCState saved;
     saved.state = v.is_on();
@@ -341,7 +405,7 @@ void LightCall::perform() {
     saved.white = v.get_white();
     saved.color_temp = v.get_color_temperature();
     saved.effect = this->parent_->active_effect_index_;
-    this->parent_->rtc_.save(&saved);
+    this->parent_->rtc_.save_deferred(&saved);
   }
 }
 
@@ -494,11 +558,13 @@ LightCall &LightCall::set_effect(const std::string &effect) {
     return *this;
   }
 
+  // compare the precomputed hashes first, the names only on a match
+  const uint32_t hash = LightEffect::hash_name(effect.c_str());
   bool found = false;
   for (uint32_t i = 0; i < this->parent_->effects_.size(); i++) {
     LightEffect *e = this->parent_->effects_[i];
 
-    if (strcasecmp(effect.c_str(), e->get_name().c_str()) == 0) {
+    if (e->get_name_hash() == hash && strcasecmp(effect.c_str(), e->get_name().c_str()) == 0) {
       this->set_effect(i + 1);
       found = true;
       break;
@@ -661,8 +727,68 @@ LightCall &LightCall::set_rgbw(float red, float green, float blue, float white)
 
 float LightState::get_setup_priority() const { return setup_priority::HARDWARE - 1.0f; }
 LightOutput *LightState::get_output() const { return this->output_; }
-void LightState::set_gamma_correct(float gamma_correct) { this->gamma_correct_ = gamma_correct; }
+void LightState::set_gamma_correct(float gamma_correct) {
+  this->gamma_correct_ = gamma_correct;
+#ifdef USE_LIGHT_FIXED_POINT
+  this->update_gamma_table_();
+#endif
+}
 void LightState::current_values_as_binary(bool *binary) { this->current_values.as_binary(binary); }
+#ifdef USE_LIGHT_FIXED_POINT
+void LightState::update_gamma_table_() {
+  for (uint8_t i = 0; i < LIGHT_GAMMA_TABLE_SIZE; i++) {
+    const float value = i / float(LIGHT_GAMMA_TABLE_SIZE - 1);
+    this->gamma_table_[i] = float_to_q16(gamma_correct(value, this->gamma_correct_));
+  }
+}
+uint16_t HOT LightState::gamma_correct_q16_(uint16_t value) const {
+  if (value == LIGHT_Q16_ONE)
+    return this->gamma_table_[LIGHT_GAMMA_TABLE_SIZE - 1];
+  // 64 segments of 1024 steps each
+  const uint8_t index = value >> 10;
+  const uint32_t fraction = value & 0x3FF;
+  const uint16_t low = this->gamma_table_[index];
+  const uint16_t high = this->gamma_table_[index + 1];
+  return low + (((high - low) * fraction + 512) >> 10);
+}
+void LightState::current_values_as_brightness(float *brightness) {
+  uint16_t value;
+  this->current_values.as_brightness_q16(&value);
+  *brightness = q16_to_float(this->gamma_correct_q16_(value));
+}
+void LightState::current_values_as_rgb(float *red, float *green, float *blue) {
+  uint16_t r, g, b;
+  this->current_values.as_rgb_q16(&r, &g, &b);
+  *red = q16_to_float(this->gamma_correct_q16_(r));
+  *green = q16_to_float(this->gamma_correct_q16_(g));
+  *blue = q16_to_float(this->gamma_correct_q16_(b));
+}
+void LightState::current_values_as_rgbw(float *red, float *green, float *blue, float *white) {
+  uint16_t r, g, b, w;
+  this->current_values.as_rgbw_q16(&r, &g, &b, &w);
+  *red = q16_to_float(this->gamma_correct_q16_(r));
+  *green = q16_to_float(this->gamma_correct_q16_(g));
+  *blue = q16_to_float(this->gamma_correct_q16_(b));
+  *white = q16_to_float(this->gamma_correct_q16_(w));
+}
+void LightState::current_values_as_rgbww(float color_temperature_cw, float color_temperature_ww, float *red,
+                                         float *green, float *blue, float *cold_white, float *warm_white) {
+  uint16_t r, g, b, cw, ww;
+  this->current_values.as_rgbww_q16(color_temperature_cw, color_temperature_ww, &r, &g, &b, &cw, &ww);
+  *red = q16_to_float(this->gamma_correct_q16_(r));
+  *green = q16_to_float(this->gamma_correct_q16_(g));
+  *blue = q16_to_float(this->gamma_correct_q16_(b));
+  *cold_white = q16_to_float(this->gamma_correct_q16_(cw));
+  *warm_white = q16_to_float(this->gamma_correct_q16_(ww));
+}
+void LightState::current_values_as_cwww(float color_temperature_cw, float color_temperature_ww, float *cold_white,
+                                        float *warm_white) {
+  uint16_t cw, ww;
+  this->current_values.as_cwww_q16(color_temperature_cw, color_temperature_ww, &cw, &ww);
+  *cold_white = q16_to_float(this->gamma_correct_q16_(cw));
+  *warm_white = q16_to_float(this->gamma_correct_q16_(ww));
+}
+#else
 void LightState::current_values_as_brightness(float *brightness) {
   this->current_values.as_brightness(brightness);
   *brightness = gamma_correct(*brightness, this->gamma_correct_);
@@ -695,6 +821,7 @@ void LightState::current_values_as_cwww(float color_temperature_cw, float color_
   *cold_white = gamma_correct(*cold_white, this->gamma_correct_);
   *warm_white = gamma_correct(*warm_white, this->gamma_correct_);
 }
+#endif
 void LightState::add_new_remote_values_callback(light_send_callback_t &&send_callback) {
   this->remote_values_callback_.add(std::move(send_callback));
 }
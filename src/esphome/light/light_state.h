@@ -21,8 +21,14 @@ namespace light {
 
 using light_send_callback_t = std::function<void()>;
 
+#ifdef USE_LIGHT_FIXED_POINT
+/// Number of entries in the gamma table, the values in between are linearly interpolated.
+static const uint8_t LIGHT_GAMMA_TABLE_SIZE = 65;
+#endif
+
 class LightEffect;
 class LightOutput;
+class LightScene;
 class LightState;
 
 #ifdef USE_MQTT_LIGHT
@@ -144,13 +150,17 @@ class LightCall {
    * @return The light call for chaining setters.
    */
   LightCall &set_rgbw(float red, float green, float blue, float white);
-  LightCall &parse_color_json(JsonObject &root);
-  LightCall &parse_json(JsonObject &root);
+  /// Set the values of the members of the JSON command in the reader (state, brightness, color, effect, ...).
+  LightCall &parse_json(JsonReader &reader);
   LightCall &from_light_color_values(const LightColorValues &values);
 
   void perform();
 
  protected:
+  friend LightScene;
+
+  /// Apply this call to the light without publishing, transitions and flashes start at start_time.
+  void apply_(uint32_t start_time);
   /// Validate all properties and return the target light color values.
   LightColorValues validate_();
 
@@ -233,7 +243,7 @@ class LightState : public Nameable, public Component {
   LightOutput *get_output() const;
 
   /// Return the name of the current effect, or if no effect is active "None".
-  std::string get_effect_name();
+  const std::string &get_effect_name();
 
   /** This lets front-end components subscribe to light change events.
    *
@@ -252,7 +262,7 @@ class LightState : public Nameable, public Component {
   bool supports_effects();
 
   /// Dump the state of this light as JSON.
-  void dump_json(JsonObject &root);
+  void dump_json(JsonWriter &writer);
 
   /// Set the default transition length, i.e. the transition length when no transition is provided.
   void set_default_transition_length(uint32_t default_transition_length);
@@ -287,6 +297,7 @@ class LightState : public Nameable, public Component {
  protected:
   friend LightOutput;
   friend LightCall;
+  friend LightScene;
 
   uint32_t hash_base() override;
 
@@ -295,10 +306,14 @@ class LightState : public Nameable, public Component {
   /// Internal method to stop the current effect (if one is active).
   void stop_effect_();
   /// Internal method to start a transition to the target color with the given length.
-  void start_transition_(const LightColorValues &target, uint32_t length);
+  void start_transition_(const LightColorValues &target, uint32_t length, uint32_t start_time);
+  /// Hand the next segment of the current transition to the output's hardware fade.
+  void start_fade_segment_();
+  /// Stop advancing the hardware fade, the next write overrides the fade running in the output.
+  void stop_hardware_fade_();
 
   /// Internal method to start a flash for the specified amount of time.
-  void start_flash_(const LightColorValues &target, uint32_t length);
+  void start_flash_(const LightColorValues &target, uint32_t length, uint32_t start_time);
 
   /// Internal method to set the color values to target immediately (with no transition).
   void set_immediately_(const LightColorValues &target);
@@ -306,8 +321,18 @@ class LightState : public Nameable, public Component {
   /// Internal method to start a transformer.
   void set_transformer_(std::unique_ptr<LightTransformer> transformer);
 
+  /// Write the current values to the output now if a write is pending, instead of in the next loop().
+  void write_pending_();
+
   LightEffect *get_active_effect_();
 
+#ifdef USE_LIGHT_FIXED_POINT
+  /// Recalculate the gamma table from gamma_correct_.
+  void update_gamma_table_();
+  /// Gamma correct a Q16 value using the gamma table.
+  uint16_t gamma_correct_q16_(uint16_t value) const;
+#endif
+
   /// Object used to store the persisted values of the light.
   ESPPreferenceObject rtc_;
   /// Default transition length for all transitions in ms.
@@ -327,8 +352,16 @@ class LightState : public Nameable, public Component {
   LightOutput *output_;  ///< Store the output to allow effects to have more access.
   /// Whether the light value should be written in the next cycle.
   bool next_write_{true};
+  /// Whether the current transition is run by the output's hardware fade instead of the loop.
+  bool hardware_fade_{false};
+  /// Length of one hardware fade segment in ms.
+  uint32_t fade_segment_length_{0};
   /// Gamma correction factor for the light.
   float gamma_correct_{2.8f};
+#ifdef USE_LIGHT_FIXED_POINT
+  /// gamma_correct() of LIGHT_GAMMA_TABLE_SIZE evenly spaced Q16 values from 0 to 1.
+  uint16_t gamma_table_[LIGHT_GAMMA_TABLE_SIZE];
+#endif
   /// List of effects for this light.
   std::vector<LightEffect *> effects_;
 #ifdef USE_MQTT_LIGHT
@@ -345,6 +378,21 @@ class LightOutput {
   virtual void setup_state(LightState *state);
 
   virtual void write_state(LightState *state) = 0;
+
+  /// Whether this output can fade to new values in hardware, see write_fade().
+  virtual bool supports_fade();
+
+  /** Linearly fade from the values currently being output to the current values of state over length ms.
+   *
+   * Only called if supports_fade() returns true, the default implementation writes the values immediately.
+   */
+  virtual void write_fade(LightState *state, uint32_t length);
+
+  /** Called when the light is about to be turned on, before the values are written in the next loop.
+   *
+   * Outputs with a power supply can switch it on here, so that it's already up when it's requested by the write.
+   */
+  virtual void pre_enable_power();
 };
 
 }  // namespace light
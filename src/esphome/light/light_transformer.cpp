@@ -4,6 +4,8 @@
 
 #include "esphome/light/light_transformer.h"
 
+#include <algorithm>
+
 #include "esphome/helpers.h"
 #include "esphome/component.h"
 #include "esphome/log.h"
@@ -21,20 +23,50 @@ LightTransformer::LightTransformer(uint32_t start_time, uint32_t length, const L
                                    const LightColorValues &target_values)
     : start_time_(start_time), length_(length), start_values_(start_values), target_values_(target_values) {}
 
-bool LightTransformer::is_finished() { return this->get_progress_() >= 1.0f; }
+bool LightTransformer::is_finished() { return millis() - this->start_time_ >= this->length_; }
+
+float LightTransformer::get_progress_() { return this->get_progress_at_(millis()); }
 
-float LightTransformer::get_progress_() {
-  return clamp(0.0f, 1.0f, (millis() - this->start_time_) / float(this->length_));
+float LightTransformer::get_progress_at_(uint32_t time) {
+  return clamp(0.0f, 1.0f, (time - this->start_time_) / float(this->length_));
 }
 
+uint16_t LightTransformer::get_progress_q16_() { return this->get_progress_q16_at_(millis()); }
+
+uint16_t LightTransformer::get_progress_q16_at_(uint32_t time) {
+  const uint32_t elapsed = time - this->start_time_;
+  if (elapsed >= this->length_)
+    return LIGHT_Q16_ONE;
+  if (elapsed <= 0xFFFF)
+    // fits in 32 bits
+    return (elapsed * LIGHT_Q16_ONE) / this->length_;
+  return (uint64_t(elapsed) * LIGHT_Q16_ONE) / this->length_;
+}
+
+LightColorValues LightTransformer::get_values_at(uint32_t time) { return this->get_values(); }
+
+uint32_t LightTransformer::get_end_time() const { return this->start_time_ + this->length_; }
+
 LightColorValues LightTransformer::get_remote_values() { return this->get_target_values_(); }
 
 LightColorValues LightTransformer::get_end_values() { return this->get_target_values_(); }
 
-LightColorValues LightTransitionTransformer::get_values() {
-  float x = this->get_progress_();
+LightColorValues LightTransitionTransformer::get_values() { return this->get_values_at(millis()); }
+LightColorValues LightTransitionTransformer::get_values_at(uint32_t time) {
+#ifdef USE_LIGHT_FIXED_POINT
+  // smoothstep v = x^3 * (x * (6x - 15) + 10) in Q16
+  const uint32_t x = this->get_progress_q16_at_(time);
+  const uint32_t x2 = (x * x) >> 16;
+  const uint32_t x3 = (x2 * x) >> 16;
+  const int32_t inner = 6 * int32_t(x2) - 15 * int32_t(x) + 10 * 65536L;
+  const uint32_t v = (uint64_t(x3) * uint32_t(inner)) >> 16;
+  return LightColorValues::lerp_q16(this->get_start_values_(), this->get_target_values_(),
+                                    std::min(v, uint32_t(LIGHT_Q16_ONE)));
+#else
+  float x = this->get_progress_at_(time);
   float v = x * x * x * (x * (x * 6.0f - 15.0f) + 10.0f);
   return LightColorValues::lerp(this->get_start_values_(), this->get_target_values_(), v);
+#endif
 }
 LightTransitionTransformer::LightTransitionTransformer(uint32_t start_time, uint32_t length,
                                                        const LightColorValues &start_values,
@@ -25,6 +25,12 @@ class LightTransformer {
   /// This will be called to get the current values for output.
   virtual LightColorValues get_values() = 0;
 
+  /// Get the values for output at the given time (in millis()), used for handing transitions to hardware fades.
+  virtual LightColorValues get_values_at(uint32_t time);
+
+  /// The time (in millis()) this transformation ends at.
+  uint32_t get_end_time() const;
+
   /// The values that should be reported to the front-end.
   virtual LightColorValues get_remote_values();
 
@@ -36,6 +42,13 @@ class LightTransformer {
  protected:
   /// Get the completion of this transformer, 0 to 1.
   float get_progress_();
+  /// Get the completion of this transformer at the given time, 0 to 1.
+  float get_progress_at_(uint32_t time);
+
+  /// Get the completion of this transformer as a Q16 value, 0 to 65535.
+  uint16_t get_progress_q16_();
+  /// Get the completion of this transformer at the given time as a Q16 value, 0 to 65535.
+  uint16_t get_progress_q16_at_(uint32_t time);
 
   const LightColorValues &get_start_values_() const;
 
@@ -54,6 +67,8 @@ class LightTransitionTransformer : public LightTransformer {
 
   LightColorValues get_values() override;
 
+  LightColorValues get_values_at(uint32_t time) override;
+
   bool publish_at_end() override;
   ;
 };
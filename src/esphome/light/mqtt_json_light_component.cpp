@@ -6,6 +6,10 @@
 
 #include "esphome/log.h"
 
+#ifdef USE_API
+#include "esphome/api/subscribe_state.h"
+#endif
+
 ESPHOME_NAMESPACE_BEGIN
 
 namespace light {
@@ -15,8 +19,16 @@ static const char *TAG = "light.mqtt_json";
 std::string MQTTJSONLightComponent::component_type() const { return "light"; }
 
 void MQTTJSONLightComponent::setup() {
-  this->subscribe_json(this->get_command_topic_(), [this](const std::string &topic, JsonObject &root) {
-    this->state_->make_call().parse_json(root).perform();
+  this->subscribe(this->get_command_topic_(), [this](const std::string &topic, const std::string &payload) {
+    // the members are set on the call right away, it's only performed if the whole command is valid
+    JsonReader reader(payload.data(), payload.size());
+    auto call = this->state_->make_call();
+    call.parse_json(reader);
+    if (reader.has_error()) {
+      ESP_LOGW(TAG, "Parsing JSON failed.");
+      return;
+    }
+    call.perform();
   });
 
   auto f = std::bind(&MQTTJSONLightComponent::publish_state_, this);
@@ -26,7 +38,11 @@ void MQTTJSONLightComponent::setup() {
 MQTTJSONLightComponent::MQTTJSONLightComponent(LightState *state) : MQTTComponent(), state_(state) {}
 
 bool MQTTJSONLightComponent::publish_state_() {
-  return this->publish_json(this->get_state_topic_(), [this](JsonObject &root) { this->state_->dump_json(root); });
+#ifdef USE_API
+  this->publish_binary_state_([this](api::APIBuffer &buffer) { api::encode_light_state(buffer, this->state_); });
+#endif
+  return this->publish_json_writer(this->get_state_topic_(),
+                                   [this](JsonWriter &writer) { this->state_->dump_json(writer); });
 }
 LightState *MQTTJSONLightComponent::get_state() const { return this->state_; }
 std::string MQTTJSONLightComponent::friendly_name() const { return this->state_->get_name(); }
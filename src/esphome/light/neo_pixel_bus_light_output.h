@@ -89,6 +89,10 @@ class NeoPixelBusLightOutputBase : public Component, public AddressableLight {
 
   int32_t size() const override;
 
+#ifdef USE_OUTPUT
+  void pre_enable_power() override;
+#endif
+
   void set_pixel_order(ESPNeoPixelOrder order);
 
  protected:
@@ -109,6 +113,9 @@ class NeoPixelRGBLightOutput : public NeoPixelBusLightOutputBase<T_METHOD, T_COL
   inline ESPColorView operator[](int32_t index) const override;
 
   LightTraits get_traits() override;
+
+ protected:
+  bool get_raw_pixels_(AddressableLight::RawPixels *raw) const override;
 };
 
 template<typename T_METHOD, typename T_COLOR_FEATURE = NeoRgbwFeature>
@@ -117,6 +124,9 @@ class NeoPixelRGBWLightOutput : public NeoPixelBusLightOutputBase<T_METHOD, T_CO
   inline ESPColorView operator[](int32_t index) const override;
 
   LightTraits get_traits() override;
+
+ protected:
+  bool get_raw_pixels_(AddressableLight::RawPixels *raw) const override;
 };
 
 }  // namespace light
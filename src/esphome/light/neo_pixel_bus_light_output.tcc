@@ -18,6 +18,11 @@ template<typename T_METHOD, typename T_COLOR_FEATURE>
 void NeoPixelBusLightOutputBase<T_METHOD, T_COLOR_FEATURE>::set_power_supply(PowerSupplyComponent *power_supply) {
   this->power_supply_ = power_supply;
 }
+template<typename T_METHOD, typename T_COLOR_FEATURE>
+void NeoPixelBusLightOutputBase<T_METHOD, T_COLOR_FEATURE>::pre_enable_power() {
+  if (this->power_supply_ != nullptr && !this->has_requested_high_power_)
+    this->power_supply_->pre_enable();
+}
 #endif
 
 template<typename T_METHOD, typename T_COLOR_FEATURE>
@@ -122,6 +127,24 @@ ESPColorView NeoPixelRGBWLightOutput<T_METHOD, T_COLOR_FEATURE>::operator[](int3
                       base + this->rgb_offsets_[3], this->effect_data_ + index, &this->correction_);
 }
 
+template<typename T_METHOD, typename T_COLOR_FEATURE>
+bool NeoPixelRGBLightOutput<T_METHOD, T_COLOR_FEATURE>::get_raw_pixels_(AddressableLight::RawPixels *raw) const {
+  raw->data = this->controller_->Pixels();
+  raw->stride = 3;
+  for (uint8_t i = 0; i < 3; i++)
+    raw->offsets[i] = this->rgb_offsets_[i];
+  return true;
+}
+
+template<typename T_METHOD, typename T_COLOR_FEATURE>
+bool NeoPixelRGBWLightOutput<T_METHOD, T_COLOR_FEATURE>::get_raw_pixels_(AddressableLight::RawPixels *raw) const {
+  raw->data = this->controller_->Pixels();
+  raw->stride = 4;
+  for (uint8_t i = 0; i < 4; i++)
+    raw->offsets[i] = this->rgb_offsets_[i];
+  return true;
+}
+
 template<typename T_METHOD, typename T_COLOR_FEATURE>
 LightTraits NeoPixelRGBLightOutput<T_METHOD, T_COLOR_FEATURE>::get_traits() {
   return {true, true, false, false};
@@ -0,0 +1,79 @@
+#include "esphome/defines.h"
+
+#ifdef USE_LIGHT
+
+#include "esphome/light/palette.h"
+
+ESPHOME_NAMESPACE_BEGIN
+
+namespace light {
+
+const uint8_t PALETTE_RAINBOW[] PROGMEM = {
+    0,   255, 0,   0,   32,  171, 85,  0,   64,  171, 171, 0,  96,  0,   255, 0,   128, 0,   171, 85,
+    160, 0,   0,   255, 192, 85,  0,   171, 224, 171, 0,   85, 255, 255, 0,   0,
+};
+const uint8_t PALETTE_PARTY[] PROGMEM = {
+    0,   85,  0,   171, 17,  132, 0,   124, 34,  181, 0,   75,  51,  229, 0,   27,  68,  232, 23,  0,
+    85,  184, 71,  0,   102, 171, 119, 0,   119, 171, 171, 0,   136, 171, 85,  0,   153, 221, 34,  0,
+    170, 242, 0,   14,  187, 194, 0,   62,  204, 143, 0,   113, 221, 95,  0,   161, 238, 47,  0,   208,
+    255, 0,   7,   249,
+};
+const uint8_t PALETTE_HEAT[] PROGMEM = {
+    0, 0, 0, 0, 85, 255, 0, 0, 170, 255, 255, 0, 255, 255, 255, 255,
+};
+const uint8_t PALETTE_LAVA[] PROGMEM = {
+    0, 0, 0, 0, 46, 128, 0, 0, 96, 255, 0, 0, 160, 255, 165, 0, 208, 255, 255, 255, 255, 255, 0, 0,
+};
+const uint8_t PALETTE_OCEAN[] PROGMEM = {
+    0, 0, 0, 128, 64, 0, 0, 255, 128, 0, 128, 128, 192, 0, 255, 255, 255, 0, 0, 128,
+};
+const uint8_t PALETTE_FOREST[] PROGMEM = {
+    0, 0, 100, 0, 64, 85, 107, 47, 128, 34, 139, 34, 192, 107, 142, 35, 255, 0, 100, 0,
+};
+
+ESPPalette::ESPPalette() = default;
+ESPPalette::ESPPalette(const std::vector<ESPGradientStop> &stops) { this->sample_(stops.data(), stops.size()); }
+ESPPalette ESPPalette::from_gradient_P(const uint8_t *gradient) {
+  std::vector<ESPGradientStop> stops;
+  while (true) {
+    ESPGradientStop stop{};
+    stop.position = pgm_read_byte(gradient++);
+    stop.r = pgm_read_byte(gradient++);
+    stop.g = pgm_read_byte(gradient++);
+    stop.b = pgm_read_byte(gradient++);
+    stops.push_back(stop);
+    if (stop.position == 255)
+      break;
+  }
+  return ESPPalette(stops);
+}
+const ESPColor &ESPPalette::operator[](uint8_t entry) const { return this->entries_[entry & 0x0F]; }
+ESPColor &ESPPalette::operator[](uint8_t entry) { return this->entries_[entry & 0x0F]; }
+
+void ESPPalette::sample_(const ESPGradientStop *stops, size_t count) {
+  if (count == 0)
+    return;
+  size_t next = 0;
+  for (uint8_t i = 0; i < 16; i++) {
+    // entries at 0, 17, ..., 255
+    const uint8_t position = i * 17;
+    while (next < count && stops[next].position < position)
+      next++;
+    if (next == 0 || next == count) {
+      // before the first or after the last stop
+      const ESPGradientStop &stop = stops[next == 0 ? 0 : count - 1];
+      this->entries_[i] = ESPColor(stop.r, stop.g, stop.b);
+      continue;
+    }
+    const ESPGradientStop &a = stops[next - 1];
+    const ESPGradientStop &b = stops[next];
+    const uint8_t blend = uint16_t(position - a.position) * 255 / (b.position - a.position);
+    this->entries_[i] = ESPColor(a.r, a.g, a.b) * uint8_t(255 - blend) + ESPColor(b.r, b.g, b.b) * blend;
+  }
+}
+
+}  // namespace light
+
+ESPHOME_NAMESPACE_END
+
+#endif  // USE_LIGHT
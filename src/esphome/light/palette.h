@@ -0,0 +1,110 @@
+#ifndef ESPHOME_LIGHT_PALETTE_H
+#define ESPHOME_LIGHT_PALETTE_H
+
+#include "esphome/defines.h"
+
+#ifdef USE_LIGHT
+
+#include "esphome/light/addressable_light.h"
+
+#include <vector>
+
+ESPHOME_NAMESPACE_BEGIN
+
+namespace light {
+
+/// A stop of a color gradient, position 0 is the start and 255 the end of the palette.
+struct ESPGradientStop {
+  uint8_t position;
+  uint8_t r;
+  uint8_t g;
+  uint8_t b;
+};
+
+/** The built-in gradients, stored in PROGMEM as {position, r, g, b} stops, the last one at position 255.
+ *
+ * Use them with ESPPalette::from_gradient_P().
+ */
+extern const uint8_t PALETTE_RAINBOW[] PROGMEM;
+extern const uint8_t PALETTE_PARTY[] PROGMEM;
+extern const uint8_t PALETTE_HEAT[] PROGMEM;
+extern const uint8_t PALETTE_LAVA[] PROGMEM;
+extern const uint8_t PALETTE_OCEAN[] PROGMEM;
+extern const uint8_t PALETTE_FOREST[] PROGMEM;
+
+/** A palette of 16 colors that effects look up colors in, like FastLED's CRGBPalette16.
+ *
+ * The palette is sampled from a gradient once, color_at() then blends between the two nearest entries with integer
+ * math, so an effect only needs a lookup per pixel. Palettes are plain values, one palette can be shared by the
+ * effects of several lights.
+ */
+class ESPPalette {
+ public:
+  /// All black.
+  ESPPalette();
+  /// Sample the gradient through the stops, which must be sorted by position.
+  explicit ESPPalette(const std::vector<ESPGradientStop> &stops);
+  /// Sample a gradient stored in PROGMEM, see PALETTE_RAINBOW.
+  static ESPPalette from_gradient_P(const uint8_t *gradient);
+
+  /// The color at index (0-255, wrapping around to the first entry), blended between the entries.
+  inline ESPColor color_at(uint8_t index) const ALWAYS_INLINE;
+  const ESPColor &operator[](uint8_t entry) const;
+  ESPColor &operator[](uint8_t entry);
+
+ protected:
+  void sample_(const ESPGradientStop *stops, size_t count);
+
+  ESPColor entries_[16];
+};
+
+/// The sine of theta (a full period is 256) scaled to 0-255, integer piecewise linear like FastLED's sin8().
+inline uint8_t esp_sin8(uint8_t theta) ALWAYS_INLINE;
+/// A sawtooth from 0 to 255 with bpm periods per minute, since timebase (in ms).
+inline uint8_t esp_beat8(uint8_t bpm, uint32_t timebase = 0) ALWAYS_INLINE;
+/// A sine wave between low and high with bpm periods per minute.
+inline uint8_t esp_beatsin8(uint8_t bpm, uint8_t low = 0, uint8_t high = 255, uint32_t timebase = 0) ALWAYS_INLINE;
+
+ESPColor ESPPalette::color_at(uint8_t index) const {
+  const ESPColor &a = this->entries_[index >> 4];
+  const ESPColor &b = this->entries_[((index >> 4) + 1) & 0x0F];
+  const uint8_t blend = (index & 0x0F) << 4;
+  if (blend == 0)
+    return a;
+  return a * uint8_t(255 - blend) + b * blend;
+}
+
+uint8_t esp_sin8(uint8_t theta) {
+  // base and slope (in 1/16) of the four sections of a quarter period
+  static const uint8_t B_M16[] = {0, 49, 49, 41, 90, 27, 117, 10};
+  uint8_t offset = theta;
+  if (theta & 0x40)
+    offset = 255 - offset;
+  offset &= 0x3F;
+  uint8_t secoffset = offset & 0x0F;
+  if (theta & 0x40)
+    secoffset++;
+  const uint8_t section = offset >> 4;
+  const uint8_t b = B_M16[section * 2];
+  const uint8_t m16 = B_M16[section * 2 + 1];
+  int8_t y = int8_t(((m16 * secoffset) >> 4) + b);
+  if (theta & 0x80)
+    y = -y;
+  return uint8_t(y + 128);
+}
+uint8_t esp_beat8(uint8_t bpm, uint32_t timebase) {
+  // bpm in Q8.8, times 280 / 65536 is the phase per ms; the product may wrap, only its low 16 bits are used
+  const uint16_t beat16 = (uint32_t(millis() - timebase) * (uint32_t(bpm) << 8) * 280U) >> 16;
+  return beat16 >> 8;
+}
+uint8_t esp_beatsin8(uint8_t bpm, uint8_t low, uint8_t high, uint32_t timebase) {
+  return low + esp_scale8(esp_sin8(esp_beat8(bpm, timebase)), high - low);
+}
+
+}  // namespace light
+
+ESPHOME_NAMESPACE_END
+
+#endif  // USE_LIGHT
+
+#endif  // ESPHOME_LIGHT_PALETTE_H
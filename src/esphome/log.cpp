@@ -24,7 +24,8 @@ int HOT esp_log_vprintf_(int level, const char *tag, const char *format, va_list
   if (log == nullptr)
     return 0;
 
-  return log->log_vprintf_(level, tag, format, args);
+  // only called by the ESP_LOGx macros, so the format string is a literal
+  return log->log_vprintf_(level, tag, format, args, true);
 }
 
 #ifdef USE_STORE_LOG_STR_IN_FLASH
@@ -28,6 +28,15 @@
 #define ESPHOME_LOG_LEVEL ESPHOME_LOG_LEVEL_DEBUG
 #endif
 
+/** The log level of a single source file, similar to LOG_LOCAL_LEVEL of ESP-IDF.
+ *
+ * Define it before including any header to remove log statements above a lower level from that file at compile time,
+ * without changing the global ESPHOME_LOG_LEVEL. It can't be higher than ESPHOME_LOG_LEVEL.
+ */
+#ifndef ESPHOME_LOG_LOCAL_LEVEL
+#define ESPHOME_LOG_LOCAL_LEVEL ESPHOME_LOG_LEVEL
+#endif
+
 #define ESPHOME_LOG_COLOR_BLACK "30"
 #define ESPHOME_LOG_COLOR_RED "31"     // ERROR
 #define ESPHOME_LOG_COLOR_GREEN "32"   // INFO
@@ -85,7 +94,10 @@ int esp_idf_log_vprintf_(const char *format, va_list args);  // NOLINT
 
 #if ESPHOME_LOG_LEVEL >= ESPHOME_LOG_LEVEL_VERY_VERBOSE
 #define esph_log_vv(tag, format, ...) \
-  esp_log_printf_(ESPHOME_LOG_LEVEL_VERY_VERBOSE, tag, ESPHOME_LOG_FORMAT(tag, VV, format), ##__VA_ARGS__)
+  do { \
+    if (ESPHOME_LOG_LOCAL_LEVEL >= ESPHOME_LOG_LEVEL_VERY_VERBOSE) \
+      esp_log_printf_(ESPHOME_LOG_LEVEL_VERY_VERBOSE, tag, ESPHOME_LOG_FORMAT(tag, VV, format), ##__VA_ARGS__); \
+  } while (0)
 
 #define ESPHOME_LOG_HAS_VERY_VERBOSE
 #else
@@ -94,7 +106,10 @@ int esp_idf_log_vprintf_(const char *format, va_list args);  // NOLINT
 
 #if ESPHOME_LOG_LEVEL >= ESPHOME_LOG_LEVEL_VERBOSE
 #define esph_log_v(tag, format, ...) \
-  esp_log_printf_(ESPHOME_LOG_LEVEL_VERBOSE, tag, ESPHOME_LOG_FORMAT(tag, V, format), ##__VA_ARGS__)
+  do { \
+    if (ESPHOME_LOG_LOCAL_LEVEL >= ESPHOME_LOG_LEVEL_VERBOSE) \
+      esp_log_printf_(ESPHOME_LOG_LEVEL_VERBOSE, tag, ESPHOME_LOG_FORMAT(tag, V, format), ##__VA_ARGS__); \
+  } while (0)
 
 #define ESPHOME_LOG_HAS_VERBOSE
 #else
@@ -103,10 +118,16 @@ int esp_idf_log_vprintf_(const char *format, va_list args);  // NOLINT
 
 #if ESPHOME_LOG_LEVEL >= ESPHOME_LOG_LEVEL_DEBUG
 #define esph_log_d(tag, format, ...) \
-  esp_log_printf_(ESPHOME_LOG_LEVEL_DEBUG, tag, ESPHOME_LOG_FORMAT(tag, D, format), ##__VA_ARGS__)
+  do { \
+    if (ESPHOME_LOG_LOCAL_LEVEL >= ESPHOME_LOG_LEVEL_DEBUG) \
+      esp_log_printf_(ESPHOME_LOG_LEVEL_DEBUG, tag, ESPHOME_LOG_FORMAT(tag, D, format), ##__VA_ARGS__); \
+  } while (0)
 
 #define esph_log_config(tag, format, ...) \
-  esp_log_printf_(ESPHOME_LOG_LEVEL_DEBUG, tag, ESPHOME_LOG_FORMAT(tag, C, format), ##__VA_ARGS__)
+  do { \
+    if (ESPHOME_LOG_LOCAL_LEVEL >= ESPHOME_LOG_LEVEL_DEBUG) \
+      esp_log_printf_(ESPHOME_LOG_LEVEL_DEBUG, tag, ESPHOME_LOG_FORMAT(tag, C, format), ##__VA_ARGS__); \
+  } while (0)
 
 #define ESPHOME_LOG_HAS_DEBUG
 #define ESPHOME_LOG_HAS_CONFIG
@@ -118,7 +139,10 @@ int esp_idf_log_vprintf_(const char *format, va_list args);  // NOLINT
 
 #if ESPHOME_LOG_LEVEL >= ESPHOME_LOG_LEVEL_INFO
 #define esph_log_i(tag, format, ...) \
-  esp_log_printf_(ESPHOME_LOG_LEVEL_INFO, tag, ESPHOME_LOG_FORMAT(tag, I, format), ##__VA_ARGS__)
+  do { \
+    if (ESPHOME_LOG_LOCAL_LEVEL >= ESPHOME_LOG_LEVEL_INFO) \
+      esp_log_printf_(ESPHOME_LOG_LEVEL_INFO, tag, ESPHOME_LOG_FORMAT(tag, I, format), ##__VA_ARGS__); \
+  } while (0)
 
 #define ESPHOME_LOG_HAS_INFO
 #else
@@ -127,7 +151,10 @@ int esp_idf_log_vprintf_(const char *format, va_list args);  // NOLINT
 
 #if ESPHOME_LOG_LEVEL >= ESPHOME_LOG_LEVEL_WARN
 #define esph_log_w(tag, format, ...) \
-  esp_log_printf_(ESPHOME_LOG_LEVEL_WARN, tag, ESPHOME_LOG_FORMAT(tag, W, format), ##__VA_ARGS__)
+  do { \
+    if (ESPHOME_LOG_LOCAL_LEVEL >= ESPHOME_LOG_LEVEL_WARN) \
+      esp_log_printf_(ESPHOME_LOG_LEVEL_WARN, tag, ESPHOME_LOG_FORMAT(tag, W, format), ##__VA_ARGS__); \
+  } while (0)
 
 #define ESPHOME_LOG_HAS_WARN
 #else
@@ -136,7 +163,10 @@ int esp_idf_log_vprintf_(const char *format, va_list args);  // NOLINT
 
 #if ESPHOME_LOG_LEVEL >= ESPHOME_LOG_LEVEL_ERROR
 #define esph_log_e(tag, format, ...) \
-  esp_log_printf_(ESPHOME_LOG_LEVEL_ERROR, tag, ESPHOME_LOG_FORMAT(tag, E, format), ##__VA_ARGS__)
+  do { \
+    if (ESPHOME_LOG_LOCAL_LEVEL >= ESPHOME_LOG_LEVEL_ERROR) \
+      esp_log_printf_(ESPHOME_LOG_LEVEL_ERROR, tag, ESPHOME_LOG_FORMAT(tag, E, format), ##__VA_ARGS__); \
+  } while (0)
 
 #define ESPHOME_LOG_HAS_ERROR
 #else
@@ -4,6 +4,8 @@
 #include <esp_log.h>
 #endif
 #include <HardwareSerial.h>
+#include <algorithm>
+#include <cstring>
 
 #include "esphome/mqtt/mqtt_client_component.h"
 #include "esphome/log.h"
@@ -12,8 +14,256 @@ ESPHOME_NAMESPACE_BEGIN
 
 static const char *TAG = "logger";
 
-int HOT LogComponent::log_vprintf_(int level, const char *tag, const char *format, va_list args) {  // NOLINT
-  if (level > this->level_for(tag))
+/** Header of a message in the log queue. A header with level NONE marks the rest of the ring buffer as padding.
+ *
+ * format is nullptr for formatted messages, length bytes of null-terminated message follow. Otherwise
+ * the message still needs to be formatted and length bytes of arguments encoded by encode_log_args() follow.
+ */
+struct LogQueueHeader {
+  const char *tag;
+  const void *format;
+  uint16_t length;
+  uint8_t level;
+  uint8_t flags;
+};
+
+/// The format string of a deferred message is stored in flash.
+static const uint8_t LOG_QUEUE_FLASH_FORMAT = 1 << 0;
+
+#ifdef ARDUINO_ARCH_ESP32
+#define LOG_QUEUE_LOCK() portENTER_CRITICAL(&this->queue_lock_)
+#define LOG_QUEUE_UNLOCK() portEXIT_CRITICAL(&this->queue_lock_)
+#else
+// the queue is only ever accessed from the main loop
+#define LOG_QUEUE_LOCK()
+#define LOG_QUEUE_UNLOCK()
+#endif
+
+#ifdef USE_STORE_LOG_STR_IN_FLASH
+/// Copy a format string from flash into buf, returns the length including the null terminator or 0 if it didn't fit.
+static size_t copy_format_pgm(const void *format, char *buf, size_t size) {
+  const char *format_pgm_p = (PGM_P) format;
+  size_t len = 0;
+  char ch = '.';
+  while (len < size && ch != '\0') {
+    *buf++ = ch = pgm_read_byte(format_pgm_p++);
+    len++;
+  }
+  if (len == size)
+    return 0;
+  return len;
+}
+#endif
+
+enum LogArgType {
+  LOG_ARG_NONE,
+  LOG_ARG_INT,
+  LOG_ARG_LONG,
+  LOG_ARG_LONG_LONG,
+  LOG_ARG_DOUBLE,
+  LOG_ARG_STRING,
+  LOG_ARG_POINTER,
+  LOG_ARG_UNSUPPORTED,
+};
+
+struct LogFormatSpec {
+  LogArgType type;
+  /// Number of '*' width/precision arguments (ints) before the argument itself.
+  uint8_t stars;
+  /// Precision given in the format string, -1 if none or given with '*'.
+  int precision;
+};
+
+/// Parse the printf conversion specification starting right after '%', returns the pointer after it.
+static const char *parse_log_format_spec(const char *p, LogFormatSpec *spec) {
+  spec->stars = 0;
+  spec->precision = -1;
+  while (*p != '\0' && strchr("-+ #0", *p) != nullptr)
+    p++;
+  if (*p == '*') {
+    spec->stars++;
+    p++;
+  } else {
+    while (*p >= '0' && *p <= '9')
+      p++;
+  }
+  if (*p == '.') {
+    p++;
+    if (*p == '*') {
+      spec->stars++;
+      p++;
+    } else {
+      spec->precision = 0;
+      while (*p >= '0' && *p <= '9')
+        spec->precision = spec->precision * 10 + (*p++ - '0');
+    }
+  }
+
+  LogArgType int_type = LOG_ARG_INT;
+  bool long_double = false, wide = false;
+  if (*p == 'h') {
+    p++;
+    if (*p == 'h')
+      p++;
+  } else if (*p == 'l') {
+    p++;
+    int_type = LOG_ARG_LONG;
+    wide = true;
+    if (*p == 'l') {
+      p++;
+      int_type = LOG_ARG_LONG_LONG;
+    }
+  } else if (*p == 'j') {
+    p++;
+    int_type = LOG_ARG_LONG_LONG;
+  } else if (*p == 'z' || *p == 't') {
+    p++;
+    int_type = sizeof(size_t) == sizeof(long) ? LOG_ARG_LONG : LOG_ARG_INT;
+  } else if (*p == 'L') {
+    p++;
+    long_double = true;
+  }
+
+  switch (*p) {
+    case 'd':
+    case 'i':
+    case 'u':
+    case 'o':
+    case 'x':
+    case 'X':
+    case 'c':
+      spec->type = int_type;
+      break;
+    case 'f':
+    case 'F':
+    case 'e':
+    case 'E':
+    case 'g':
+    case 'G':
+    case 'a':
+    case 'A':
+      spec->type = long_double ? LOG_ARG_UNSUPPORTED : LOG_ARG_DOUBLE;
+      break;
+    case 's':
+      spec->type = wide ? LOG_ARG_UNSUPPORTED : LOG_ARG_STRING;
+      break;
+    case 'p':
+      spec->type = LOG_ARG_POINTER;
+      break;
+    case '%':
+      spec->type = LOG_ARG_NONE;
+      break;
+    default:
+      // %n, wide characters or a truncated format string
+      spec->type = LOG_ARG_UNSUPPORTED;
+      return p;
+  }
+  return p + 1;
+}
+
+template<typename T> static bool log_args_write(uint8_t *buf, size_t size, size_t *pos, const T &value) {
+  if (size - *pos < sizeof(T))
+    return false;
+  memcpy(buf + *pos, &value, sizeof(T));
+  *pos += sizeof(T);
+  return true;
+}
+template<typename T> static T log_args_read(const uint8_t *buf, size_t *pos) {
+  T value;
+  memcpy(&value, buf + *pos, sizeof(T));
+  *pos += sizeof(T);
+  return value;
+}
+
+/** Encode the arguments of a log message so that it can be formatted later.
+ *
+ * Numbers and pointers are copied as they are, strings are copied with a 16-bit length prefix
+ * (including the null terminator) since they may be freed right after the log call.
+ *
+ * @return The length of the encoded arguments, or 0 if the format string isn't supported or they didn't fit.
+ */
+static size_t encode_log_args(const char *format, va_list args, uint8_t *buf, size_t size) {
+  size_t pos = 0;
+  const char *p = format;
+  while ((p = strchr(p, '%')) != nullptr) {
+    LogFormatSpec spec;
+    p = parse_log_format_spec(p + 1, &spec);
+    int star_args[2] = {-1, -1};
+    for (uint8_t i = 0; i < spec.stars; i++) {
+      star_args[i] = va_arg(args, int);
+      if (!log_args_write(buf, size, &pos, star_args[i]))
+        return 0;
+    }
+
+    bool ok = true;
+    switch (spec.type) {
+      case LOG_ARG_NONE:
+        break;
+      case LOG_ARG_INT:
+        ok = log_args_write(buf, size, &pos, va_arg(args, int));
+        break;
+      case LOG_ARG_LONG:
+        ok = log_args_write(buf, size, &pos, va_arg(args, long));
+        break;
+      case LOG_ARG_LONG_LONG:
+        ok = log_args_write(buf, size, &pos, va_arg(args, long long));
+        break;
+      case LOG_ARG_DOUBLE:
+        ok = log_args_write(buf, size, &pos, va_arg(args, double));
+        break;
+      case LOG_ARG_POINTER:
+        ok = log_args_write(buf, size, &pos, va_arg(args, void *));
+        break;
+      case LOG_ARG_STRING: {
+        const char *str = va_arg(args, const char *);
+        if (str == nullptr)
+          str = "(null)";
+        int precision = spec.stars == 0 ? spec.precision : star_args[spec.stars - 1];
+        size_t len = precision >= 0 ? strnlen(str, precision) : strlen(str);
+        if (len >= UINT16_MAX || !log_args_write(buf, size, &pos, uint16_t(len + 1)) || size - pos < len + 1)
+          return 0;
+        memcpy(buf + pos, str, len);
+        buf[pos + len] = '\0';
+        pos += len + 1;
+        break;
+      }
+      case LOG_ARG_UNSUPPORTED:
+      default:
+        return 0;
+    }
+    if (!ok)
+      return 0;
+  }
+  // messages without arguments still need a non-empty payload
+  if (pos == 0 && !log_args_write(buf, size, &pos, uint8_t(0)))
+    return 0;
+  return pos;
+}
+
+template<typename T>
+static int log_format_arg(char *out, size_t size, const char *spec, uint8_t stars, const int *star_args, T value) {
+  switch (stars) {
+    case 0:
+      return snprintf(out, size, spec, value);
+    case 1:
+      return snprintf(out, size, spec, star_args[0], value);
+    default:
+      return snprintf(out, size, spec, star_args[0], star_args[1], value);
+  }
+}
+
+int HOT LogComponent::log_vprintf_(int level, const char *tag, const char *format, va_list args,  // NOLINT
+                                    bool static_format) {
+  if (level > this->max_level_ || level > this->level_for(tag) ||
+      (this->baud_rate_ == 0 && level > this->max_callback_level_))
+    return 0;
+  if (this->forced_flush_) {
+    // tx_buffer_ holds the message that is waiting for space in the queue
+    this->dropped_messages_++;
+    return 0;
+  }
+  if (static_format && this->can_defer_() &&
+      this->defer_message_(level, tag, format, 0, format, args, this->tx_buffer_.data(), this->tx_buffer_.capacity()))
     return 0;
 
   int ret = vsnprintf(this->tx_buffer_.data(), this->tx_buffer_.capacity(), format, args);
@@ -22,25 +272,27 @@ int HOT LogComponent::log_vprintf_(int level, const char *tag, const char *forma
 }
 #ifdef USE_STORE_LOG_STR_IN_FLASH
 int LogComponent::log_vprintf_(int level, const char *tag, const __FlashStringHelper *format, va_list args) {  // NOLINT
-  if (level > this->level_for(tag))
+  if (level > this->max_level_ || level > this->level_for(tag) ||
+      (this->baud_rate_ == 0 && level > this->max_callback_level_))
     return 0;
+  if (this->forced_flush_) {
+    this->dropped_messages_++;
+    return 0;
+  }
 
   // copy format string
-  const char *format_pgm_p = (PGM_P) format;
-  size_t len = 0;
-  char *write = this->tx_buffer_.data();
-  char ch = '.';
-  while (len < this->tx_buffer_.capacity() && ch != '\0') {
-    *write++ = ch = pgm_read_byte(format_pgm_p++);
-    len++;
-  }
-  if (len == this->tx_buffer_.capacity())
+  size_t len = copy_format_pgm(format, this->tx_buffer_.data(), this->tx_buffer_.capacity());
+  if (len == 0)
     return -1;
 
-  // now apply vsnprintf
   size_t offset = len + 1;
   size_t remaining = this->tx_buffer_.capacity() - offset;
   char *msg = this->tx_buffer_.data() + offset;
+  if (this->can_defer_() &&
+      this->defer_message_(level, tag, format, LOG_QUEUE_FLASH_FORMAT, this->tx_buffer_.data(), args, msg, remaining))
+    return 0;
+
+  // now apply vsnprintf
   int ret = vsnprintf(msg, remaining, this->tx_buffer_.data(), args);
   this->log_message_(level, tag, msg, ret);
   return ret;
@@ -48,9 +300,26 @@ int LogComponent::log_vprintf_(int level, const char *tag, const __FlashStringHe
 #endif
 
 int HOT LogComponent::level_for(const char *tag) {
-  // Uses std::vector<> for low memory footprint, though the vector
-  // could be sorted to minimize lookup times. This feature isn't used that
-  // much anyway so it doesn't matter too much.
+  if (this->log_levels_.empty())
+    return this->global_log_level_;
+
+  // Tags are static strings, so the result of the string compares can be cached on the tag pointer.
+  const uint32_t hash = (uint32_t(reinterpret_cast<uintptr_t>(tag)) >> 2) * 2654435761UL;
+  for (uint8_t i = 0; i < LOG_TAG_CACHE_PROBES; i++) {
+    LogTagCacheEntry &entry = this->tag_cache_[((hash >> 24) + i) & (LOG_TAG_CACHE_SIZE - 1)];
+    if (entry.tag == tag)
+      return entry.level;
+    if (entry.tag == nullptr) {
+      // level is written first, so that other tasks never see the tag with a wrong level
+      entry.level = this->lookup_level_(tag);
+      entry.tag = tag;
+      return entry.level;
+    }
+  }
+  return this->lookup_level_(tag);
+}
+int LogComponent::lookup_level_(const char *tag) {
+  // Uses std::vector<> for low memory footprint, lookups are cached by level_for().
   for (auto &it : this->log_levels_) {
     if (it.tag == tag) {
       return it.level;
@@ -58,21 +327,286 @@ int HOT LogComponent::level_for(const char *tag) {
   }
   return this->global_log_level_;
 }
+void LogComponent::update_levels_() {
+  this->max_level_ = this->global_log_level_;
+  for (auto &it : this->log_levels_)
+    this->max_level_ = std::max(this->max_level_, it.level);
+  if (this->log_levels_.empty())
+    return;
+  this->tag_cache_.clear();
+  this->tag_cache_.resize(LOG_TAG_CACHE_SIZE, LogTagCacheEntry{nullptr, 0});
+}
 void HOT LogComponent::log_message_(int level, const char *tag, char *msg, int ret) {
   if (ret <= 0)
     return;
+  size_t len = ret;
+  if (len >= this->tx_buffer_.capacity())
+    // message was truncated
+    len = strlen(msg);
   // remove trailing newline
-  if (msg[ret - 1] == '\n') {
-    msg[ret - 1] = '\0';
+  if (len > 0 && msg[len - 1] == '\n') {
+    msg[--len] = '\0';
   }
   if (this->baud_rate_ > 0)
     this->hw_serial_->println(msg);
-  this->log_callback_.call(level, tag, msg);
+  if (level > this->max_callback_level_)
+    return;
+
+  if (this->queue_.empty()) {
+    this->call_log_callbacks_(level, tag, msg);
+  } else {
+    this->queue_message_(level, tag, msg, len + 1);
+  }
+}
+void HOT LogComponent::call_log_callbacks_(int level, const char *tag, const char *msg) {
+  for (auto &it : this->log_callbacks_) {
+    if (level <= it.level)
+      it.callback(level, tag, msg);
+  }
+}
+bool HOT LogComponent::queue_message_(int level, const char *tag, const void *data, size_t len, const void *format,
+                                      uint8_t flags) {
+  // keep headers aligned
+  const size_t size = (sizeof(LogQueueHeader) + len + 3) & ~size_t(3);
+  if (len > UINT16_MAX || size > this->queue_.size()) {
+    this->dropped_messages_++;
+    return false;
+  }
+#ifdef ARDUINO_ARCH_ESP32
+  const bool main_task = xTaskGetCurrentTaskHandle() == this->main_task_;
+#else
+  const bool main_task = true;
+#endif
+
+  for (uint8_t attempt = 0; attempt < 2; attempt++) {
+    LOG_QUEUE_LOCK();
+    int32_t offset = this->queue_reserve_(size);
+    if (offset >= 0) {
+      LogQueueHeader header{tag, format, uint16_t(len), uint8_t(level), flags};
+      memcpy(&this->queue_[offset], &header, sizeof(header));
+      memcpy(&this->queue_[offset + sizeof(header)], data, len);
+    }
+    LOG_QUEUE_UNLOCK();
+    if (offset >= 0) {
+#ifdef ARDUINO_ARCH_ESP32
+      if (!main_task)
+        wake_loop();
+#endif
+      return true;
+    }
+
+    // Queue is full, in the main loop we can make space by passing the queued messages on right away.
+    if (!main_task || this->processing_queue_)
+      break;
+    this->forced_flush_ = true;
+    this->process_queue_();
+    this->forced_flush_ = false;
+  }
+  this->dropped_messages_++;
+  return false;
+}
+int32_t HOT LogComponent::queue_reserve_(size_t size) {
+  const size_t capacity = this->queue_.size();
+  if (this->queue_used_ == 0) {
+    this->queue_head_ = 0;
+    this->queue_tail_ = 0;
+  }
+  size_t offset = this->queue_head_;
+  if (this->queue_used_ == 0 || this->queue_head_ > this->queue_tail_) {
+    // free space is at the end of the buffer and before the tail
+    if (capacity - this->queue_head_ < size) {
+      if (this->queue_tail_ < size)
+        return -1;
+      // doesn't fit at the end, pad the rest of the buffer and wrap around
+      const size_t padding = capacity - this->queue_head_;
+      if (padding >= sizeof(LogQueueHeader)) {
+        LogQueueHeader header{nullptr, nullptr, 0, ESPHOME_LOG_LEVEL_NONE, 0};
+        memcpy(&this->queue_[this->queue_head_], &header, sizeof(header));
+      }
+      this->queue_used_ += padding;
+      offset = 0;
+    }
+  } else if (this->queue_tail_ - this->queue_head_ < size) {
+    // also handles the queue being completely full (head == tail)
+    return -1;
+  }
+
+  this->queue_head_ = offset + size;
+  if (this->queue_head_ == capacity)
+    this->queue_head_ = 0;
+  this->queue_used_ += size;
+  return offset;
+}
+bool LogComponent::can_defer_() const {
+  // UART messages are always formatted right away, so deferring would only format them twice
+  return this->deferred_formatting_ && this->baud_rate_ == 0 && !this->queue_.empty();
+}
+bool HOT LogComponent::defer_message_(int level, const char *tag, const void *format, uint8_t flags,
+                                      const char *parse_format, va_list args, char *buffer, size_t buffer_size) {
+  va_list args_copy;
+  va_copy(args_copy, args);
+  size_t len = encode_log_args(parse_format, args_copy, reinterpret_cast<uint8_t *>(buffer), buffer_size);
+  va_end(args_copy);
+  if (len == 0)
+    // fall back to formatting the message right away
+    return false;
+
+  this->queue_message_(level, tag, buffer, len, format, flags);
+  return true;
+}
+const char *LogComponent::format_deferred_(const void *format, uint8_t flags, const uint8_t *args, size_t args_len) {
+  char *out = this->deferred_buffer_.data();
+  size_t remaining = this->deferred_buffer_.size();
+  const char *p = reinterpret_cast<const char *>(format);
+#ifdef USE_STORE_LOG_STR_IN_FLASH
+  if (flags & LOG_QUEUE_FLASH_FORMAT) {
+    // copy the format string to the start of the buffer, the message is formatted after it
+    size_t len = copy_format_pgm(format, out, remaining);
+    if (len == 0)
+      return nullptr;
+    p = out;
+    out += len;
+    remaining -= len;
+  }
+#endif
+  char *msg = out;
+  size_t pos = 0;
+
+  while (*p != '\0' && remaining > 1) {
+    if (*p != '%') {
+      *out++ = *p++;
+      remaining--;
+      continue;
+    }
+
+    const char *spec_start = p;
+    LogFormatSpec spec;
+    p = parse_log_format_spec(p + 1, &spec);
+    char spec_str[16];
+    const size_t spec_len = p - spec_start;
+    if (spec_len >= sizeof(spec_str))
+      break;
+    memcpy(spec_str, spec_start, spec_len);
+    spec_str[spec_len] = '\0';
+
+    int star_args[2] = {0, 0};
+    for (uint8_t i = 0; i < spec.stars; i++)
+      star_args[i] = log_args_read<int>(args, &pos);
+
+    int ret = 0;
+    switch (spec.type) {
+      case LOG_ARG_NONE:
+        ret = snprintf(out, remaining, "%%");
+        break;
+      case LOG_ARG_INT:
+        ret = log_format_arg(out, remaining, spec_str, spec.stars, star_args, log_args_read<int>(args, &pos));
+        break;
+      case LOG_ARG_LONG:
+        ret = log_format_arg(out, remaining, spec_str, spec.stars, star_args, log_args_read<long>(args, &pos));
+        break;
+      case LOG_ARG_LONG_LONG:
+        ret = log_format_arg(out, remaining, spec_str, spec.stars, star_args, log_args_read<long long>(args, &pos));
+        break;
+      case LOG_ARG_DOUBLE:
+        ret = log_format_arg(out, remaining, spec_str, spec.stars, star_args, log_args_read<double>(args, &pos));
+        break;
+      case LOG_ARG_POINTER:
+        ret = log_format_arg(out, remaining, spec_str, spec.stars, star_args, log_args_read<void *>(args, &pos));
+        break;
+      case LOG_ARG_STRING: {
+        const uint16_t len = log_args_read<uint16_t>(args, &pos);
+        ret = log_format_arg(out, remaining, spec_str, spec.stars, star_args,
+                             reinterpret_cast<const char *>(args + pos));
+        pos += len;
+        break;
+      }
+      default:
+        // encode_log_args() doesn't queue these
+        break;
+    }
+    if (ret < 0 || pos > args_len)
+      break;
+    const size_t written = std::min(size_t(ret), remaining - 1);
+    out += written;
+    remaining -= written;
+  }
+  *out = '\0';
+
+  // remove trailing newline
+  if (out != msg && out[-1] == '\n')
+    out[-1] = '\0';
+  return msg;
+}
+void LogComponent::process_queue_() {
+  const size_t capacity = this->queue_.size();
+  this->processing_queue_ = true;
+  while (true) {
+    LOG_QUEUE_LOCK();
+    if (this->queue_used_ == 0) {
+      LOG_QUEUE_UNLOCK();
+      break;
+    }
+    const size_t tail = this->queue_tail_;
+    LogQueueHeader header;
+    bool padding = capacity - tail < sizeof(header);
+    if (!padding) {
+      memcpy(&header, &this->queue_[tail], sizeof(header));
+      padding = header.level == ESPHOME_LOG_LEVEL_NONE;
+    }
+    if (padding) {
+      this->queue_used_ -= capacity - tail;
+      this->queue_tail_ = 0;
+      LOG_QUEUE_UNLOCK();
+      continue;
+    }
+    LOG_QUEUE_UNLOCK();
+
+    // The message stays reserved until the callbacks are done, so it can't be overwritten by messages they log.
+    const uint8_t *data = &this->queue_[tail + sizeof(header)];
+    const char *msg = reinterpret_cast<const char *>(data);
+    if (header.format != nullptr)
+      msg = this->format_deferred_(header.format, header.flags, data, header.length);
+    if (msg != nullptr)
+      this->call_log_callbacks_(header.level, header.tag, msg);
+
+    const size_t size = (sizeof(header) + header.length + 3) & ~size_t(3);
+    LOG_QUEUE_LOCK();
+    this->queue_tail_ = tail + size;
+    if (this->queue_tail_ == capacity)
+      this->queue_tail_ = 0;
+    this->queue_used_ -= size;
+    LOG_QUEUE_UNLOCK();
+  }
+  this->processing_queue_ = false;
+}
+void LogComponent::setup() {
+  if (this->queue_size_ > 0)
+    this->queue_.resize((this->queue_size_ + 3) & ~size_t(3));
+  if (this->deferred_formatting_)
+    this->deferred_buffer_.resize(this->tx_buffer_.capacity());
+}
+void LogComponent::loop() {
+  if (!this->queue_.empty())
+    this->process_queue_();
+
+  if (this->dropped_messages_ != this->dropped_messages_reported_) {
+    const uint32_t dropped = this->dropped_messages_ - this->dropped_messages_reported_;
+    this->dropped_messages_reported_ = this->dropped_messages_;
+    ESP_LOGW(TAG, "Dropped %u log messages, the log queue was full!", dropped);
+  }
+}
+uint32_t LogComponent::get_loop_idle_time() {
+  if (this->queue_used_ != 0 || this->dropped_messages_ != this->dropped_messages_reported_)
+    return 0;
+  return SCHEDULER_DONT_RUN;
 }
 
 LogComponent::LogComponent(uint32_t baud_rate, size_t tx_buffer_size, UARTSelection uart)
     : baud_rate_(baud_rate), uart_(uart) {
   this->set_tx_buffer_size(tx_buffer_size);
+#ifdef ARDUINO_ARCH_ESP32
+  vPortCPUInitializeMutex(&this->queue_lock_);
+#endif
 }
 
 void LogComponent::pre_setup() {
@@ -110,6 +644,7 @@ void LogComponent::pre_setup() {
 
   global_log_component = this;
 #ifdef ARDUINO_ARCH_ESP32
+  this->main_task_ = xTaskGetCurrentTaskHandle();
   esp_log_set_vprintf(esp_idf_log_vprintf_);
   if (this->global_log_level_ >= ESPHOME_LOG_LEVEL_VERBOSE) {
     esp_log_level_set("*", ESP_LOG_VERBOSE);
@@ -120,16 +655,33 @@ void LogComponent::pre_setup() {
 }
 uint32_t LogComponent::get_baud_rate() const { return this->baud_rate_; }
 void LogComponent::set_baud_rate(uint32_t baud_rate) { this->baud_rate_ = baud_rate; }
-void LogComponent::set_global_log_level(int log_level) { this->global_log_level_ = log_level; }
+void LogComponent::set_global_log_level(int log_level) {
+  this->global_log_level_ = log_level;
+  this->update_levels_();
+}
 void LogComponent::set_log_level(const std::string &tag, int log_level) {
   this->log_levels_.push_back(LogLevelOverride{tag, log_level});
+  this->update_levels_();
 }
 size_t LogComponent::get_tx_buffer_size() const { return this->tx_buffer_.capacity(); }
 void LogComponent::set_tx_buffer_size(size_t tx_buffer_size) { this->tx_buffer_.reserve(tx_buffer_size); }
 UARTSelection LogComponent::get_uart() const { return this->uart_; }
-void LogComponent::add_on_log_callback(std::function<void(int, const char *, const char *)> &&callback) {
-  this->log_callback_.add(std::move(callback));
+size_t LogComponent::add_on_log_callback(std::function<void(int, const char *, const char *)> &&callback, int level) {
+  this->log_callbacks_.push_back(LogCallback{level, std::move(callback)});
+  this->max_callback_level_ = std::max(this->max_callback_level_, level);
+  return this->log_callbacks_.size() - 1;
+}
+void LogComponent::set_log_callback_level(size_t id, int level) {
+  this->log_callbacks_[id].level = level;
+  this->max_callback_level_ = ESPHOME_LOG_LEVEL_NONE;
+  for (auto &it : this->log_callbacks_)
+    this->max_callback_level_ = std::max(this->max_callback_level_, it.level);
 }
+void LogComponent::set_log_queue_size(size_t log_queue_size) { this->queue_size_ = log_queue_size; }
+void LogComponent::set_deferred_formatting(bool deferred_formatting) {
+  this->deferred_formatting_ = deferred_formatting;
+}
+uint32_t LogComponent::get_dropped_messages() const { return this->dropped_messages_; }
 float LogComponent::get_setup_priority() const { return setup_priority::HARDWARE - 1.0f; }
 const char *LOG_LEVELS[] = {"NONE", "ERROR", "WARN", "INFO", "DEBUG", "VERBOSE", "VERY_VERBOSE"};
 #ifdef ARDUINO_ARCH_ESP32
@@ -143,6 +695,10 @@ void LogComponent::dump_config() {
   ESP_LOGCONFIG(TAG, "  Level: %s", LOG_LEVELS[this->global_log_level_]);
   ESP_LOGCONFIG(TAG, "  Log Baud Rate: %u", this->baud_rate_);
   ESP_LOGCONFIG(TAG, "  Hardware UART: %s", UART_SELECTIONS[this->uart_]);
+  ESP_LOGCONFIG(TAG, "  Log Queue Size: %u", this->queue_.size());
+  if (this->can_defer_()) {
+    ESP_LOGCONFIG(TAG, "  Deferred Formatting: YES");
+  }
   for (auto &it : this->log_levels_) {
     ESP_LOGCONFIG(TAG, "  Level for '%s': %s", it.tag.c_str(), LOG_LEVELS[it.level]);
   }
@@ -15,8 +15,23 @@
 #include "esphome/log.h"
 #include "esphome/defines.h"
 
+#ifdef ARDUINO_ARCH_ESP32
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
+
 ESPHOME_NAMESPACE_BEGIN
 
+/// Number of tag pointers LogComponent::level_for() caches the level of, must be a power of two.
+#define LOG_TAG_CACHE_SIZE 32
+#define LOG_TAG_CACHE_PROBES 4
+
+#ifdef ARDUINO_ARCH_ESP32
+#define LOG_DEFAULT_QUEUE_SIZE 1024
+#else
+#define LOG_DEFAULT_QUEUE_SIZE 512
+#endif
+
 /** Enum for logging UART selection
  *
  * Advanced configuration (pin selection, etc) is not supported.
@@ -63,6 +78,23 @@ class LogComponent : public Component {
   /// Set the log level of the specified tag.
   void set_log_level(const std::string &tag, int log_level);
 
+  /** Set the size (in bytes) of the queue log messages wait in until loop() passes them on to the log callbacks.
+   *
+   * That way callbacks like the native API or MQTT don't slow down code that logs, and messages logged from other
+   * tasks are passed on from the main loop. UART output is not queued. 0 to call the log callbacks synchronously.
+   * Must be called before setup().
+   */
+  void set_log_queue_size(size_t log_queue_size);
+  /** Defer formatting messages of the ESP_LOGx macros to loop().
+   *
+   * Only the format string pointer and the arguments are queued, so code that logs doesn't spend time in vsnprintf
+   * and less queue space is used by most messages. Only has an effect if UART logging is disabled and the log queue
+   * is enabled. Must be called before setup().
+   */
+  void set_deferred_formatting(bool deferred_formatting);
+  /// Get the number of log messages that were dropped because the log queue was full.
+  uint32_t get_dropped_messages() const;
+
   // ========== INTERNAL METHODS ==========
   // (In most use cases you won't need these)
   /// Set up this component.
@@ -72,20 +104,53 @@ class LogComponent : public Component {
 
   size_t get_tx_buffer_size() const;
 
+  void setup() override;
+  void loop() override;
+  /// loop() is only needed while messages are queued, messages from other tasks wake the loop up.
+  uint32_t get_loop_idle_time() override;
+
   int level_for(const char *tag);
 
-  /// Register a callback that will be called for every log message sent
-  void add_on_log_callback(std::function<void(int, const char *, const char *)> &&callback);
+  /** Register a callback that will be called for every log message sent
+   *
+   * @param callback The callback.
+   * @param level The highest log level the callback is interested in, can be changed with set_log_callback_level().
+   * @return An id for set_log_callback_level().
+   */
+  size_t add_on_log_callback(std::function<void(int, const char *, const char *)> &&callback,
+                             int level = ESPHOME_LOG_LEVEL_VERY_VERBOSE);
+  /// Change the highest log level a callback is called for, messages no one is interested in aren't even formatted.
+  void set_log_callback_level(size_t id, int level);
 
   float get_setup_priority() const override;
 
-  int log_vprintf_(int level, const char *tag, const char *format, va_list args);  // NOLINT
+  /// static_format: format is a string literal that outlives the call, so formatting the message can be deferred.
+  int log_vprintf_(int level, const char *tag, const char *format, va_list args,  // NOLINT
+                   bool static_format = false);
 #ifdef USE_STORE_LOG_STR_IN_FLASH
   int log_vprintf_(int level, const char *tag, const __FlashStringHelper *format, va_list args);  // NOLINT
 #endif
 
  protected:
   void log_message_(int level, const char *tag, char *msg, int ret);
+  /// Look up the level of a tag by comparing it with all tag levels.
+  int lookup_level_(const char *tag);
+  /// Recalculate max_level_ and reset the tag level cache.
+  void update_levels_();
+  void call_log_callbacks_(int level, const char *tag, const char *msg);
+  /// Copy a message (or the arguments of a deferred message) into the log queue, returns false if there was no space.
+  bool queue_message_(int level, const char *tag, const void *data, size_t len, const void *format = nullptr,
+                      uint8_t flags = 0);
+  bool can_defer_() const;
+  /// Queue a message without formatting it, returns false if it has to be formatted right away instead.
+  bool defer_message_(int level, const char *tag, const void *format, uint8_t flags, const char *parse_format,
+                      va_list args, char *buffer, size_t buffer_size);
+  /// Format a deferred message into deferred_buffer_, returns nullptr on failure.
+  const char *format_deferred_(const void *format, uint8_t flags, const uint8_t *args, size_t args_len);
+  /// Reserve size bytes in the log queue, returns the offset or -1 if there's no space. Must hold queue_lock_.
+  int32_t queue_reserve_(size_t size);
+  /// Pass all queued log messages on to the log callbacks.
+  void process_queue_();
 
   uint32_t baud_rate_;
   std::vector<char> tx_buffer_;
@@ -97,7 +162,41 @@ class LogComponent : public Component {
     int level;
   };
   std::vector<LogLevelOverride> log_levels_;
-  CallbackManager<void(int, const char *, const char *)> log_callback_{};
+  /// Highest level of the global level and all tag levels.
+  int max_level_{ESPHOME_LOG_LEVEL};
+  struct LogTagCacheEntry {
+    const char *volatile tag;
+    int level;
+  };
+  /// Open addressing hash table of tag pointer -> level, only allocated if there are tag levels.
+  std::vector<LogTagCacheEntry> tag_cache_;
+  struct LogCallback {
+    int level;
+    std::function<void(int, const char *, const char *)> callback;
+  };
+  std::vector<LogCallback> log_callbacks_;
+  /// Highest level of all log callbacks.
+  int max_callback_level_{ESPHOME_LOG_LEVEL_NONE};
+
+  /// Ring buffer of queued messages, each one is a LogQueueHeader followed by the null-terminated message.
+  std::vector<uint8_t> queue_;
+  size_t queue_size_{LOG_DEFAULT_QUEUE_SIZE};
+  size_t queue_head_{0};
+  size_t queue_tail_{0};
+  /// Bytes in use, including padding at the end of the ring buffer when a message didn't fit there.
+  size_t queue_used_{0};
+  bool processing_queue_{false};
+  /// Set while the queue is processed because it's full, tx_buffer_ then still holds the message to queue.
+  bool forced_flush_{false};
+  bool deferred_formatting_{false};
+  std::vector<char> deferred_buffer_;
+  uint32_t dropped_messages_{0};
+  uint32_t dropped_messages_reported_{0};
+#ifdef ARDUINO_ARCH_ESP32
+  portMUX_TYPE queue_lock_;
+  /// The task loop() runs in, messages from other tasks wake it up.
+  TaskHandle_t main_task_{nullptr};
+#endif
 };
 
 extern LogComponent *global_log_component;
@@ -0,0 +1,257 @@
+#include "esphome/defines.h"
+
+#ifdef USE_LOOP_MONITOR
+
+#include "esphome/loop_monitor.h"
+#include "esphome/application.h"
+#include "esphome/helpers.h"
+#include "esphome/log.h"
+#include "esphome/metrics.h"
+#include "esphome/tracer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#ifdef ARDUINO_ARCH_ESP32
+#include <esp_attr.h>
+#include <rom/rtc.h>
+#endif
+
+ESPHOME_NAMESPACE_BEGIN
+
+static const char *TAG = "loop_monitor";
+
+#ifdef ARDUINO_ARCH_ESP32
+static const uint32_t LOOP_MONITOR_RTC_MAGIC = 0x4C4D4F4EUL;
+/// What the main loop is running, kept in RTC memory that isn't initialized on resets.
+struct LoopMonitorRTCState {
+  uint32_t magic;
+  /// The source pointers are only valid in the same firmware.
+  uint32_t firmware_hash;
+  const char *source;
+};
+RTC_NOINIT_ATTR static LoopMonitorRTCState loop_monitor_rtc_state;
+#endif
+
+static const char *breach_to_string(LoopMonitorBreach breach) {
+  switch (breach) {
+    case LOOP_MONITOR_BREACH_MAX:
+      return "max loop time exceeded";
+    case LOOP_MONITOR_BREACH_P99:
+      return "p99 loop time exceeded";
+    case LOOP_MONITOR_BREACH_WATCHDOG:
+      return "watchdog reset";
+    default:
+      return "none";
+  }
+}
+
+LoopMonitorComponent::LoopMonitorComponent(uint32_t update_interval) : PollingComponent(update_interval) {}
+
+void LoopMonitorComponent::set_p99_threshold(uint32_t p99_threshold) { this->p99_threshold_ = p99_threshold; }
+void LoopMonitorComponent::set_max_threshold(uint32_t max_threshold) { this->max_threshold_ = max_threshold; }
+#ifdef USE_SENSOR
+LoopTimeSensor *LoopMonitorComponent::make_p50_sensor(const std::string &name) {
+  return this->p50_sensor_ = new LoopTimeSensor(name, this);
+}
+LoopTimeSensor *LoopMonitorComponent::make_p99_sensor(const std::string &name) {
+  return this->p99_sensor_ = new LoopTimeSensor(name, this);
+}
+LoopTimeSensor *LoopMonitorComponent::make_max_sensor(const std::string &name) {
+  return this->max_sensor_ = new LoopTimeSensor(name, this);
+}
+#endif
+
+void LoopMonitorComponent::setup() {
+  ESP_LOGCONFIG(TAG, "Setting up Loop Monitor...");
+#ifdef USE_METRICS
+  global_metrics.register_gauge("loop_time_p50_seconds", "Median loop time of the last interval.",
+                                [this]() { return this->last_p50_ / 1e6; });
+  global_metrics.register_gauge("loop_time_p99_seconds", "p99 loop time of the last interval.",
+                                [this]() { return this->last_p99_ / 1e6; });
+  global_metrics.register_gauge("loop_time_max_seconds", "Slowest loop of the last interval.",
+                                [this]() { return this->last_max_ / 1e6; });
+  global_metrics.register_counter("loop_time_breaches_total", "Loop time threshold breaches.",
+                                  [this]() { return this->breaches_; });
+#endif
+  this->rtc_ = global_preferences.make_preference<LoopMonitorSnapshot>(2742219107UL);
+  LoopMonitorSnapshot snapshot{};
+  if (this->rtc_.load(&snapshot) && snapshot.breach != LOOP_MONITOR_BREACH_NONE) {
+    this->last_snapshot_ = snapshot;
+    LoopMonitorSnapshot empty{};
+    this->rtc_.save(&empty);
+  }
+
+#ifdef ARDUINO_ARCH_ESP32
+  const uint32_t firmware_hash = fnv1_hash(App.get_compilation_time());
+  const RESET_REASON reason = rtc_get_reset_reason(0);
+  const bool watchdog = reason == TG0WDT_SYS_RESET || reason == TG1WDT_SYS_RESET || reason == RTCWDT_SYS_RESET ||
+                        reason == TGWDT_CPU_RESET || reason == RTCWDT_CPU_RESET || reason == RTCWDT_RTC_RESET;
+  LoopMonitorRTCState &state = loop_monitor_rtc_state;
+  if (watchdog && state.magic == LOOP_MONITOR_RTC_MAGIC && state.firmware_hash == firmware_hash) {
+    // the reset stopped the loop, so this is more recent than a saved snapshot
+    this->last_snapshot_ = LoopMonitorSnapshot{};
+    this->last_snapshot_.breach = LOOP_MONITOR_BREACH_WATCHDOG;
+    strncpy(this->last_snapshot_.component, state.source != nullptr ? state.source : "<idle>",
+            sizeof(this->last_snapshot_.component) - 1);
+  }
+  state.magic = LOOP_MONITOR_RTC_MAGIC;
+  state.firmware_hash = firmware_hash;
+  state.source = nullptr;
+#endif
+
+  if (this->last_snapshot_.breach != LOOP_MONITOR_BREACH_NONE)
+    this->log_snapshot_(this->last_snapshot_);
+}
+void LoopMonitorComponent::update() {
+  if (this->count_ == 0)
+    return;
+  const uint32_t p50 = this->percentile_(0.50f);
+  const uint32_t p99 = this->percentile_(0.99f);
+  const uint32_t max = this->max_;
+  this->last_p50_ = p50;
+  this->last_p99_ = p99;
+  this->last_max_ = max;
+  ESP_LOGD(TAG, "Loop time: p50=%uus p99=%uus max=%uus (%u iterations)", p50, p99, max, this->count_);
+#ifdef USE_SENSOR
+  if (this->p50_sensor_ != nullptr)
+    this->p50_sensor_->publish_state(p50 / 1000.0f);
+  if (this->p99_sensor_ != nullptr)
+    this->p99_sensor_->publish_state(p99 / 1000.0f);
+  if (this->max_sensor_ != nullptr)
+    this->max_sensor_->publish_state(max / 1000.0f);
+#endif
+
+  if (this->p99_threshold_ != 0 && p99 > this->p99_threshold_) {
+    this->breaches_++;
+    ESP_LOGW(TAG, "p99 loop time %uus is above the threshold of %uus!", p99, this->p99_threshold_);
+    if (!this->saved_)
+      this->save_snapshot_(LOOP_MONITOR_BREACH_P99, p99, this->p99_threshold_, nullptr, 0);
+  }
+
+  memset(this->histogram_, 0, sizeof(this->histogram_));
+  this->count_ = 0;
+  this->max_ = 0;
+}
+void LoopMonitorComponent::dump_config() {
+  ESP_LOGCONFIG(TAG, "Loop Monitor:");
+  if (this->p99_threshold_ != 0)
+    ESP_LOGCONFIG(TAG, "  p99 Threshold: %uus", this->p99_threshold_);
+  if (this->max_threshold_ != 0)
+    ESP_LOGCONFIG(TAG, "  Max Threshold: %uus", this->max_threshold_);
+  ESP_LOGCONFIG(TAG, "  Breaches: %u", this->breaches_);
+  LOG_UPDATE_INTERVAL(this);
+#ifdef USE_SENSOR
+  LOG_SENSOR("  ", "p50 Loop Time", this->p50_sensor_);
+  LOG_SENSOR("  ", "p99 Loop Time", this->p99_sensor_);
+  LOG_SENSOR("  ", "Max Loop Time", this->max_sensor_);
+#endif
+  if (this->last_snapshot_.breach != LOOP_MONITOR_BREACH_NONE)
+    this->log_snapshot_(this->last_snapshot_);
+}
+float LoopMonitorComponent::get_setup_priority() const { return setup_priority::HARDWARE; }
+uint32_t LoopMonitorComponent::get_loop_idle_time() { return SCHEDULER_DONT_RUN; }
+
+void HOT LoopMonitorComponent::enter(const char *source) {
+#ifdef ARDUINO_ARCH_ESP32
+  loop_monitor_rtc_state.source = source;
+#endif
+}
+void HOT LoopMonitorComponent::record_loop(uint32_t loop_time_us, Component *slowest, uint32_t slowest_us) {
+  this->histogram_[bucket_for_(loop_time_us)]++;
+  this->count_++;
+  if (loop_time_us > this->max_)
+    this->max_ = loop_time_us;
+
+  if (this->max_threshold_ != 0 && loop_time_us > this->max_threshold_) {
+    this->breaches_++;
+    ESP_LOGW(TAG, "Loop took %uus, more than the threshold of %uus!", loop_time_us, this->max_threshold_);
+    if (!this->saved_)
+      this->save_snapshot_(LOOP_MONITOR_BREACH_MAX, loop_time_us, this->max_threshold_, slowest, slowest_us);
+  }
+}
+
+uint32_t LoopMonitorComponent::bucket_for_(uint32_t loop_time_us) {
+  if (loop_time_us < (1UL << LOOP_MONITOR_MIN_EXPONENT))
+    return 0;
+  const uint8_t exponent = 31 - __builtin_clz(loop_time_us);
+  const uint8_t octave = exponent - LOOP_MONITOR_MIN_EXPONENT;
+  if (octave >= LOOP_MONITOR_OCTAVES)
+    return LOOP_MONITOR_BUCKETS - 1;
+  // the three bits after the leading one
+  const uint32_t sub = (loop_time_us >> (exponent - 3)) & (LOOP_MONITOR_SUB_BUCKETS - 1);
+  return 1 + octave * LOOP_MONITOR_SUB_BUCKETS + sub;
+}
+uint32_t LoopMonitorComponent::bucket_limit_(uint32_t bucket) {
+  if (bucket == 0)
+    return 1UL << LOOP_MONITOR_MIN_EXPONENT;
+  if (bucket == LOOP_MONITOR_BUCKETS - 1)
+    return UINT32_MAX;
+  const uint32_t octave = (bucket - 1) / LOOP_MONITOR_SUB_BUCKETS;
+  const uint32_t sub = (bucket - 1) % LOOP_MONITOR_SUB_BUCKETS;
+  return (LOOP_MONITOR_SUB_BUCKETS + sub + 1) << (octave + LOOP_MONITOR_MIN_EXPONENT - 3);
+}
+uint32_t LoopMonitorComponent::percentile_(float percentile) const {
+  const uint32_t target = uint32_t(ceilf(this->count_ * percentile));
+  uint32_t seen = 0;
+  for (uint32_t i = 0; i < LOOP_MONITOR_BUCKETS; i++) {
+    seen += this->histogram_[i];
+    if (seen >= target)
+      return std::min(bucket_limit_(i), this->max_);
+  }
+  return this->max_;
+}
+void LoopMonitorComponent::save_snapshot_(LoopMonitorBreach breach, uint32_t loop_time_us, uint32_t threshold_us,
+                                          Component *slowest, uint32_t slowest_us) {
+  LoopMonitorSnapshot snapshot{};
+  snapshot.breach = breach;
+  snapshot.uptime_s = millis() / 1000;
+  snapshot.loop_time_us = loop_time_us;
+  snapshot.threshold_us = threshold_us;
+#ifdef USE_COMPONENT_PROFILER
+  if (slowest == nullptr) {
+    // no single iteration to look at, take the component with the slowest loop() of the profiler
+    for (Component *component : App.get_components()) {
+      if (component->loop_stats.max_us > slowest_us) {
+        slowest = component;
+        slowest_us = component->loop_stats.max_us;
+      }
+    }
+  }
+#endif
+  if (slowest != nullptr) {
+    strncpy(snapshot.component, slowest->get_component_source(), sizeof(snapshot.component) - 1);
+    snapshot.component_us = slowest_us;
+  }
+#ifdef USE_TRACER
+  TraceEvent events[LOOP_MONITOR_TRACE_EVENTS];
+  const size_t count = global_tracer.copy_recent_events(events, LOOP_MONITOR_TRACE_EVENTS);
+  for (size_t i = 0; i < count; i++)
+    strncpy(snapshot.trace[i], events[i].name, sizeof(snapshot.trace[i]) - 1);
+#endif
+  this->rtc_.save(&snapshot);
+  this->saved_ = true;
+}
+void LoopMonitorComponent::log_snapshot_(const LoopMonitorSnapshot &snapshot) {
+  ESP_LOGW(TAG, "Last boot: %s", breach_to_string(snapshot.breach));
+  if (snapshot.breach != LOOP_MONITOR_BREACH_WATCHDOG) {
+    ESP_LOGW(TAG, "  Uptime: %us, Loop Time: %uus, Threshold: %uus", snapshot.uptime_s, snapshot.loop_time_us,
+             snapshot.threshold_us);
+  }
+  if (snapshot.breach == LOOP_MONITOR_BREACH_WATCHDOG) {
+    ESP_LOGW(TAG, "  Running: %s", snapshot.component);
+  } else if (snapshot.component[0] != '\0') {
+    ESP_LOGW(TAG, "  Slowest Component: %s (%uus)", snapshot.component, snapshot.component_us);
+  }
+#ifdef USE_TRACER
+  for (auto &name : snapshot.trace) {
+    if (name[0] != '\0')
+      ESP_LOGW(TAG, "  Trace: %s", name);
+  }
+#endif
+}
+
+ESPHOME_NAMESPACE_END
+
+#endif  // USE_LOOP_MONITOR
@@ -0,0 +1,128 @@
+#ifndef ESPHOME_LOOP_MONITOR_H
+#define ESPHOME_LOOP_MONITOR_H
+
+#include "esphome/defines.h"
+
+#ifdef USE_LOOP_MONITOR
+
+#include "esphome/component.h"
+#include "esphome/esppreferences.h"
+#ifdef USE_SENSOR
+#include "esphome/sensor/sensor.h"
+#endif
+
+ESPHOME_NAMESPACE_BEGIN
+
+#ifdef USE_SENSOR
+using LoopTimeSensor = sensor::EmptyPollingParentSensor<2, sensor::ICON_TIMER, sensor::UNIT_MS>;
+#endif
+
+/// Sub-buckets per power of two of the loop time histogram, the percentiles are accurate to 1/8.
+static const uint8_t LOOP_MONITOR_SUB_BUCKETS = 8;
+/// The first power of two of the histogram, faster loops all go into bucket 0.
+static const uint8_t LOOP_MONITOR_MIN_EXPONENT = 6;
+/// The powers of two covered, from 64µs to ~4s. Slower loops all go into the last bucket.
+static const uint8_t LOOP_MONITOR_OCTAVES = 16;
+static const uint32_t LOOP_MONITOR_BUCKETS = LOOP_MONITOR_SUB_BUCKETS * LOOP_MONITOR_OCTAVES + 2;
+/// The number of trace events stored with a snapshot.
+static const uint8_t LOOP_MONITOR_TRACE_EVENTS = 4;
+
+enum LoopMonitorBreach : uint8_t {
+  LOOP_MONITOR_BREACH_NONE = 0,
+  /// A single loop iteration took longer than the max threshold.
+  LOOP_MONITOR_BREACH_MAX,
+  /// The p99 loop time of an update interval was above the p99 threshold.
+  LOOP_MONITOR_BREACH_P99,
+  /// The chip was reset by a watchdog during a loop iteration (ESP32 only).
+  LOOP_MONITOR_BREACH_WATCHDOG,
+};
+
+/// What the loop was doing when a threshold was breached, kept across a reboot.
+struct LoopMonitorSnapshot {
+  LoopMonitorBreach breach;
+  uint32_t uptime_s;
+  /// The loop time that breached the threshold in µs (the p99 for p99 breaches).
+  uint32_t loop_time_us;
+  uint32_t threshold_us;
+  /// The component with the slowest loop() in the breaching iteration (the one running for watchdog resets).
+  char component[24];
+  uint32_t component_us;
+#ifdef USE_TRACER
+  /// The names of the last trace events before the breach, oldest first.
+  char trace[LOOP_MONITOR_TRACE_EVENTS][16];
+#endif
+};
+
+/** Watches the loop time of the application against p99 and max thresholds.
+ *
+ * Every loop iteration is put into a histogram with 8 buckets per power of two, once per update interval the p50,
+ * p99 and max loop times are published through the optional sensors and the histogram starts over. When a threshold
+ * is breached, a snapshot with the slowest component of the breaching iteration (and the last trace events with
+ * USE_TRACER) is saved to the preferences, only the first breach per boot is saved. It's logged on the next boot and
+ * in dump_config(), so stalls in the field can be diagnosed after the node was rebooted.
+ *
+ * On the ESP32 the component whose loop() is running is also kept in RTC memory that survives resets, so a reset by
+ * a watchdog is reported with the component that stalled.
+ */
+class LoopMonitorComponent : public PollingComponent {
+ public:
+  explicit LoopMonitorComponent(uint32_t update_interval = 60000);
+
+  /// Save a snapshot when the p99 loop time of an update interval is above this, in µs. 0 to disable (default).
+  void set_p99_threshold(uint32_t p99_threshold);
+  /// Save a snapshot when a single loop iteration takes longer than this, in µs. 0 to disable (default).
+  void set_max_threshold(uint32_t max_threshold);
+
+#ifdef USE_SENSOR
+  LoopTimeSensor *make_p50_sensor(const std::string &name);
+  LoopTimeSensor *make_p99_sensor(const std::string &name);
+  LoopTimeSensor *make_max_sensor(const std::string &name);
+#endif
+
+  void setup() override;
+  void update() override;
+  uint32_t get_loop_idle_time() override;
+  void dump_config() override;
+  float get_setup_priority() const override;
+
+  /// Internal, called by the application before the main loop runs the code of source (nullptr when it's done).
+  void enter(const char *source);
+  /// Internal, called by the application after each loop iteration.
+  void record_loop(uint32_t loop_time_us, Component *slowest, uint32_t slowest_us);
+
+ protected:
+  static uint32_t bucket_for_(uint32_t loop_time_us);
+  /// The upper bound of the bucket in µs.
+  static uint32_t bucket_limit_(uint32_t bucket);
+  /// The loop time that the given share of the iterations didn't exceed.
+  uint32_t percentile_(float percentile) const;
+  void save_snapshot_(LoopMonitorBreach breach, uint32_t loop_time_us, uint32_t threshold_us, Component *slowest,
+                      uint32_t slowest_us);
+  void log_snapshot_(const LoopMonitorSnapshot &snapshot);
+
+  uint32_t p99_threshold_{0};
+  uint32_t max_threshold_{0};
+  uint32_t histogram_[LOOP_MONITOR_BUCKETS]{};
+  uint32_t count_{0};
+  uint32_t max_{0};
+  uint32_t breaches_{0};
+  /// The loop times of the last update interval in µs.
+  uint32_t last_p50_{0};
+  uint32_t last_p99_{0};
+  uint32_t last_max_{0};
+  bool saved_{false};
+  ESPPreferenceObject rtc_;
+  /// The snapshot reported on this boot.
+  LoopMonitorSnapshot last_snapshot_{};
+#ifdef USE_SENSOR
+  LoopTimeSensor *p50_sensor_{nullptr};
+  LoopTimeSensor *p99_sensor_{nullptr};
+  LoopTimeSensor *max_sensor_{nullptr};
+#endif
+};
+
+ESPHOME_NAMESPACE_END
+
+#endif  // USE_LOOP_MONITOR
+
+#endif  // ESPHOME_LOOP_MONITOR_H
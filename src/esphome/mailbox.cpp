@@ -0,0 +1,138 @@
+#include "esphome/mailbox.h"
+#include "esphome/helpers.h"
+#include "esphome/log.h"
+
+#ifdef USE_SENSOR
+#include "esphome/sensor/sensor.h"
+#endif
+#ifdef USE_BINARY_SENSOR
+#include "esphome/binary_sensor/binary_sensor.h"
+#endif
+
+ESPHOME_NAMESPACE_BEGIN
+
+static const char *TAG = "mailbox";
+
+MainLoopMailbox::MainLoopMailbox() {
+  for (uint32_t i = 0; i < MAILBOX_SIZE; i++)
+    this->cells_[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+#ifdef USE_SENSOR
+bool ICACHE_RAM_ATTR MainLoopMailbox::publish_state(sensor::Sensor *sensor, float state) {
+  MailboxRecord record{};
+  record.type = MailboxRecord::SENSOR_STATE;
+  record.sensor_state.sensor = sensor;
+  record.sensor_state.state = state;
+  return this->post_(record);
+}
+#endif
+#ifdef USE_BINARY_SENSOR
+bool ICACHE_RAM_ATTR MainLoopMailbox::publish_state(binary_sensor::BinarySensor *binary_sensor, bool state) {
+  MailboxRecord record{};
+  record.type = MailboxRecord::BINARY_SENSOR_STATE;
+  record.binary_sensor_state.binary_sensor = binary_sensor;
+  record.binary_sensor_state.state = state;
+  return this->post_(record);
+}
+#endif
+bool ICACHE_RAM_ATTR MainLoopMailbox::defer(void (*callback)(void *), void *arg) {
+  MailboxRecord record{};
+  record.type = MailboxRecord::CALLBACK;
+  record.callback.callback = callback;
+  record.callback.arg = arg;
+  return this->post_(record);
+}
+bool MainLoopMailbox::defer(std::function<void()> &&f) {
+  MailboxRecord record{};
+  record.type = MailboxRecord::FUNCTION;
+  record.function = new std::function<void()>(std::move(f));
+  if (this->post_(record))
+    return true;
+  delete record.function;
+  return false;
+}
+
+bool ICACHE_RAM_ATTR MainLoopMailbox::claim_(uint32_t &pos) {
+#ifdef ARDUINO_ARCH_ESP32
+  return this->write_at_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed);
+#endif
+#ifdef ARDUINO_ARCH_ESP8266
+  // no compare-and-swap instruction, but the only other producers are ISRs
+  const uint32_t state = xt_rsil(15);
+  const uint32_t current = this->write_at_.load(std::memory_order_relaxed);
+  const bool claimed = current == pos;
+  if (claimed)
+    this->write_at_.store(pos + 1, std::memory_order_relaxed);
+  xt_wsr_ps(state);
+  pos = current;
+  return claimed;
+#endif
+}
+bool ICACHE_RAM_ATTR HOT MainLoopMailbox::post_(const MailboxRecord &record) {
+  uint32_t pos = this->write_at_.load(std::memory_order_relaxed);
+  Cell *cell;
+  while (true) {
+    cell = &this->cells_[pos % MAILBOX_SIZE];
+    const uint32_t sequence = cell->sequence.load(std::memory_order_acquire);
+    const int32_t diff = int32_t(sequence - pos);
+    if (diff == 0) {
+      if (this->claim_(pos))
+        break;
+    } else if (diff < 0) {
+      // the slot still holds the record from MAILBOX_SIZE writes ago, the mailbox is full
+      this->dropped_++;
+      return false;
+    } else {
+      // another producer claimed the slot in the meantime
+      pos = this->write_at_.load(std::memory_order_relaxed);
+    }
+  }
+  cell->record = record;
+  cell->sequence.store(pos + 1, std::memory_order_release);
+  wake_loop();
+  return true;
+}
+
+void MainLoopMailbox::process() {
+  while (true) {
+    Cell &cell = this->cells_[this->read_at_ % MAILBOX_SIZE];
+    if (cell.sequence.load(std::memory_order_acquire) != this->read_at_ + 1)
+      // empty, or the producer of the next record is still writing it
+      break;
+    const MailboxRecord record = cell.record;
+    cell.sequence.store(this->read_at_ + MAILBOX_SIZE, std::memory_order_release);
+    this->read_at_++;
+
+    switch (record.type) {
+#ifdef USE_SENSOR
+      case MailboxRecord::SENSOR_STATE:
+        record.sensor_state.sensor->publish_state(record.sensor_state.state);
+        break;
+#endif
+#ifdef USE_BINARY_SENSOR
+      case MailboxRecord::BINARY_SENSOR_STATE:
+        record.binary_sensor_state.binary_sensor->publish_state(record.binary_sensor_state.state);
+        break;
+#endif
+      case MailboxRecord::CALLBACK:
+        record.callback.callback(record.callback.arg);
+        break;
+      case MailboxRecord::FUNCTION:
+        (*record.function)();
+        delete record.function;
+        break;
+      default:
+        break;
+    }
+  }
+
+  const uint32_t dropped = this->dropped_;
+  if (dropped != this->reported_dropped_) {
+    ESP_LOGW(TAG, "Mailbox full, dropped %u records", dropped - this->reported_dropped_);
+    this->reported_dropped_ = dropped;
+  }
+}
+uint32_t MainLoopMailbox::get_dropped() const { return this->dropped_; }
+
+ESPHOME_NAMESPACE_END
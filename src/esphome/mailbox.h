@@ -0,0 +1,110 @@
+#ifndef ESPHOME_MAILBOX_H
+#define ESPHOME_MAILBOX_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include "esphome/defines.h"
+
+ESPHOME_NAMESPACE_BEGIN
+
+#ifdef USE_SENSOR
+namespace sensor {
+class Sensor;
+}  // namespace sensor
+#endif
+#ifdef USE_BINARY_SENSOR
+namespace binary_sensor {
+class BinarySensor;
+}  // namespace binary_sensor
+#endif
+
+/// The number of records the mailbox holds, a power of two.
+static const uint32_t MAILBOX_SIZE = 32;
+
+/// A message for the main loop, copied into the mailbox so that posting doesn't allocate.
+struct MailboxRecord {
+  enum Type : uint8_t {
+    SENSOR_STATE,
+    BINARY_SENSOR_STATE,
+    CALLBACK,
+    FUNCTION,
+  } type;
+  union {
+#ifdef USE_SENSOR
+    struct {
+      sensor::Sensor *sensor;
+      float state;
+    } sensor_state;
+#endif
+#ifdef USE_BINARY_SENSOR
+    struct {
+      binary_sensor::BinarySensor *binary_sensor;
+      bool state;
+    } binary_sensor_state;
+#endif
+    struct {
+      void (*callback)(void *);
+      void *arg;
+    } callback;
+    std::function<void()> *function;
+  };
+};
+
+/** Multi-producer single-consumer mailbox into the main loop.
+ *
+ * Other FreeRTOS tasks (and ISRs) post records, the application drains the mailbox at the start of each loop
+ * iteration and publishes the states or runs the callbacks there, so components don't need their own queue to
+ * hand results to the main loop. Posting wakes the loop (see wake_loop()).
+ *
+ * Posting is lock-free: producers claim a slot by advancing the write position with compare-and-swap and publish
+ * it through the sequence number of the slot (a bounded queue after Dmitry Vyukov). On the ESP8266, where the
+ * only other producers are ISRs, claiming a slot masks interrupts for a few instructions instead. Records that
+ * arrive while the mailbox is full are dropped and counted.
+ */
+class MainLoopMailbox {
+ public:
+  MainLoopMailbox();
+
+#ifdef USE_SENSOR
+  /// Publish the state of the sensor from the main loop, safe to call from any task and from ISRs.
+  bool publish_state(sensor::Sensor *sensor, float state);
+#endif
+#ifdef USE_BINARY_SENSOR
+  /// Publish the state of the binary sensor from the main loop, safe to call from any task and from ISRs.
+  bool publish_state(binary_sensor::BinarySensor *binary_sensor, bool state);
+#endif
+  /// Call callback(arg) from the main loop, safe to call from any task and from ISRs.
+  bool defer(void (*callback)(void *), void *arg);
+  /// Call f from the main loop, safe to call from any task, but not from ISRs (f is moved to the heap).
+  bool defer(std::function<void()> &&f);
+
+  /// Handle all posted records, called by the application from the main loop.
+  void process();
+
+  /// The number of records dropped because the mailbox was full.
+  uint32_t get_dropped() const;
+
+ protected:
+  bool post_(const MailboxRecord &record);
+  /// Claim the slot at pos for writing, on failure pos is updated to the current write position.
+  bool claim_(uint32_t &pos);
+
+  struct Cell {
+    /// pos while free for the write at pos, pos + 1 once the record written at pos can be read.
+    std::atomic<uint32_t> sequence;
+    MailboxRecord record;
+  };
+
+  Cell cells_[MAILBOX_SIZE];
+  std::atomic<uint32_t> write_at_{0};
+  /// Only used by the main loop.
+  uint32_t read_at_{0};
+  /// Only incremented by producers, concurrent drops may be counted once.
+  volatile uint32_t dropped_{0};
+  uint32_t reported_dropped_{0};
+};
+
+ESPHOME_NAMESPACE_END
+
+#endif  // ESPHOME_MAILBOX_H
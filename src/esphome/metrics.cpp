@@ -0,0 +1,160 @@
+#include "esphome/defines.h"
+
+#ifdef USE_METRICS
+
+#include "esphome/metrics.h"
+#include "esphome/log.h"
+#ifdef USE_MQTT
+#include "esphome/mqtt/mqtt_client_component.h"
+#endif
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#ifdef ARDUINO_ARCH_ESP32
+#include <esp_heap_caps.h>
+#include <esp_system.h>
+#endif
+#ifdef ARDUINO_ARCH_ESP8266
+extern "C" {
+#include <umm_malloc/umm_malloc.h>
+}
+#endif
+
+ESPHOME_NAMESPACE_BEGIN
+
+static const char *TAG = "metrics";
+
+/// Format the value of the metric into buffer (at least 24 bytes), counters without decimals.
+static void format_metric_value(const Metric &metric, double value, char *buffer, size_t len) {
+  if (metric.type == METRIC_TYPE_COUNTER)
+    snprintf(buffer, len, "%.0f", value);
+  else
+    snprintf(buffer, len, "%.7g", value);
+}
+
+void MetricsRegistry::register_counter(const char *name, const char *help, std::function<double()> &&get_value,
+                                       const std::string &id) {
+  this->register_(name, help, METRIC_TYPE_COUNTER, std::move(get_value), id);
+}
+void MetricsRegistry::register_gauge(const char *name, const char *help, std::function<double()> &&get_value,
+                                     const std::string &id) {
+  this->register_(name, help, METRIC_TYPE_GAUGE, std::move(get_value), id);
+}
+void MetricsRegistry::register_(const char *name, const char *help, MetricType type,
+                                std::function<double()> &&get_value, const std::string &id) {
+  // keep the instances of a metric together, Prometheus wants them in one group
+  auto it = this->metrics_.end();
+  for (auto it2 = this->metrics_.begin(); it2 != this->metrics_.end(); it2++) {
+    if (strcmp(it2->name, name) == 0)
+      it = it2 + 1;
+  }
+  this->metrics_.insert(it, Metric{name, help, type, id, std::move(get_value)});
+}
+const std::vector<Metric> &MetricsRegistry::get_metrics() const { return this->metrics_; }
+
+std::string MetricsRegistry::to_prometheus() const {
+  std::string out;
+  out.reserve(this->metrics_.size() * 96);
+  const char *last_name = nullptr;
+  char value[24];
+  for (auto &metric : this->metrics_) {
+    if (last_name == nullptr || strcmp(last_name, metric.name) != 0) {
+      out += "# HELP esphome_";
+      out += metric.name;
+      out += ' ';
+      out += metric.help;
+      out += "\n# TYPE esphome_";
+      out += metric.name;
+      out += metric.type == METRIC_TYPE_COUNTER ? " counter\n" : " gauge\n";
+      last_name = metric.name;
+    }
+    const double v = metric.get_value();
+    if (std::isnan(v))
+      strcpy(value, "NaN");
+    else
+      format_metric_value(metric, v, value, sizeof(value));
+    out += "esphome_";
+    out += metric.name;
+    if (!metric.id.empty()) {
+      // not "instance", Prometheus uses that label for the scraped node
+      out += "{id=\"";
+      out += metric.id;
+      out += "\"}";
+    }
+    out += ' ';
+    out += value;
+    out += '\n';
+  }
+  return out;
+}
+std::string MetricsRegistry::to_json() const {
+  std::string out = "{";
+  char value[24];
+  for (auto &metric : this->metrics_) {
+    if (out.size() != 1)
+      out += ',';
+    out += '"';
+    out += metric.name;
+    if (!metric.id.empty()) {
+      out += ':';
+      out += metric.id;
+    }
+    out += "\":";
+    const double v = metric.get_value();
+    if (std::isnan(v)) {
+      out += "null";
+    } else {
+      format_metric_value(metric, v, value, sizeof(value));
+      out += value;
+    }
+  }
+  out += '}';
+  return out;
+}
+
+MetricsRegistry global_metrics;
+
+MetricsComponent::MetricsComponent(uint32_t update_interval) : PollingComponent(update_interval) {}
+#ifdef USE_MQTT
+void MetricsComponent::set_mqtt_topic(const std::string &mqtt_topic) { this->mqtt_topic_ = mqtt_topic; }
+#endif
+void MetricsComponent::setup() {
+  global_metrics.register_gauge("uptime_seconds", "Time since boot.", []() { return millis() / 1000.0; });
+  global_metrics.register_gauge("heap_free_bytes", "Free heap.", []() { return ESP.getFreeHeap(); });
+#ifdef ARDUINO_ARCH_ESP32
+  global_metrics.register_gauge("heap_min_free_bytes", "Lowest free heap since boot.",
+                                []() { return esp_get_minimum_free_heap_size(); });
+  global_metrics.register_gauge("heap_max_block_bytes", "Largest allocatable block.",
+                                []() { return heap_caps_get_largest_free_block(MALLOC_CAP_8BIT); });
+#endif
+#ifdef ARDUINO_ARCH_ESP8266
+  global_metrics.register_gauge("heap_max_block_bytes", "Largest allocatable block.", []() {
+    // walks the heap and fills ummHeapInfo, sizes are in umm blocks of 8 bytes
+    umm_info(nullptr, 0);
+    return uint32_t(ummHeapInfo.maxFreeContiguousBlocks) * 8;
+  });
+#endif
+}
+void MetricsComponent::update() {
+#ifdef USE_MQTT
+  if (global_mqtt_client == nullptr || !global_mqtt_client->is_connected())
+    return;
+  const std::string topic = this->mqtt_topic_.value_or(global_mqtt_client->get_topic_prefix() + "/diagnostics");
+  if (topic.empty())
+    return;
+  global_mqtt_client->publish(topic, global_metrics.to_json());
+#endif
+}
+void MetricsComponent::dump_config() {
+  ESP_LOGCONFIG(TAG, "Metrics:");
+  ESP_LOGCONFIG(TAG, "  Registered: %u", global_metrics.get_metrics().size());
+  LOG_UPDATE_INTERVAL(this);
+}
+float MetricsComponent::get_setup_priority() const { return setup_priority::HARDWARE_LATE; }
+uint32_t MetricsComponent::get_loop_idle_time() { return SCHEDULER_DONT_RUN; }
+
+ESPHOME_NAMESPACE_END
+
+#endif  // USE_METRICS
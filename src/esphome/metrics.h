@@ -0,0 +1,96 @@
+#ifndef ESPHOME_METRICS_H
+#define ESPHOME_METRICS_H
+
+#include "esphome/defines.h"
+
+#ifdef USE_METRICS
+
+#include <functional>
+#include <string>
+#include <vector>
+#include "esphome/component.h"
+
+ESPHOME_NAMESPACE_BEGIN
+
+enum MetricType : uint8_t {
+  /// A value that only increases (until a reboot), like the number of bus errors.
+  METRIC_TYPE_COUNTER = 0,
+  /// A value that can go up and down, like the free heap.
+  METRIC_TYPE_GAUGE = 1,
+};
+
+struct Metric {
+  /// The name in Prometheus style (without the "esphome_" prefix), must stay valid (like a literal).
+  const char *name;
+  const char *help;
+  MetricType type;
+  /// Tells the metrics of several instances (like I2C buses) with the same name apart, empty for single instances.
+  std::string id;
+  /// Reads the value, only called when the metrics are exported.
+  std::function<double()> get_value;
+};
+
+/** One place where the subsystems of a node register their counters and gauges, for fleet monitoring.
+ *
+ * Subsystems register in setup() a getter for each value they already keep, so updating a metric on the hot path
+ * costs nothing beyond the subsystem's own counter increment. The getters are only called when the metrics are
+ * exported: as Prometheus text at /metrics of the web server, with the MetricsRequest of the native API and as JSON
+ * on the diagnostics topic of MQTT (see MetricsComponent).
+ *
+ * Counters may reset on their own (for example with the connection they belong to), Prometheus treats a decrease as
+ * a counter reset.
+ */
+class MetricsRegistry {
+ public:
+  void register_counter(const char *name, const char *help, std::function<double()> &&get_value,
+                        const std::string &id = "");
+  void register_gauge(const char *name, const char *help, std::function<double()> &&get_value,
+                      const std::string &id = "");
+
+  /// All metrics, the ones with the same name are next to each other.
+  const std::vector<Metric> &get_metrics() const;
+
+  /// Write all metrics in the Prometheus text exposition format.
+  std::string to_prometheus() const;
+  /// Write all metrics as one JSON object, keys are the names (with ":<id>" for instances).
+  std::string to_json() const;
+
+ protected:
+  void register_(const char *name, const char *help, MetricType type, std::function<double()> &&get_value,
+                 const std::string &id);
+
+  std::vector<Metric> metrics_;
+};
+
+extern MetricsRegistry global_metrics;
+
+/** Registers the core metrics (uptime and heap) and publishes all metrics to the MQTT diagnostics topic.
+ *
+ * With MQTT, all metrics are published as JSON to "<topic prefix>/diagnostics" every update interval.
+ */
+class MetricsComponent : public PollingComponent {
+ public:
+  explicit MetricsComponent(uint32_t update_interval = 60000);
+
+#ifdef USE_MQTT
+  /// Set the topic the metrics are published to, defaults to "<topic prefix>/diagnostics". Empty to disable.
+  void set_mqtt_topic(const std::string &mqtt_topic);
+#endif
+
+  void setup() override;
+  void update() override;
+  uint32_t get_loop_idle_time() override;
+  void dump_config() override;
+  float get_setup_priority() const override;
+
+#ifdef USE_MQTT
+ protected:
+  optional<std::string> mqtt_topic_{};
+#endif
+};
+
+ESPHOME_NAMESPACE_END
+
+#endif  // USE_METRICS
+
+#endif  // ESPHOME_METRICS_H
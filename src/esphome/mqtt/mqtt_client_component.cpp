@@ -4,14 +4,24 @@
 
 #include "esphome/mqtt/mqtt_client_component.h"
 
+#include <algorithm>
+
 #include "esphome/log.h"
 #include "esphome/util.h"
 #include "esphome/log_component.h"
+#include "esphome/metrics.h"
 #include "lwip/err.h"
 #include "lwip/dns.h"
 
 static const char *TAG = "mqtt.client";
 
+/// Discovery messages sent per loop iteration stop once this many bytes have been published.
+static const size_t MQTT_DISCOVERY_BYTES_PER_LOOP = 1024;
+/// Maximum number of children whose discovery message is built per loop iteration.
+static const size_t MQTT_DISCOVERY_MAX_PER_LOOP = 8;
+/// Initial size of the JSON build buffer, enough for typical discovery payloads.
+static const size_t MQTT_DISCOVERY_BUFFER_SIZE = 512;
+
 ESPHOME_NAMESPACE_BEGIN
 
 namespace mqtt {
@@ -25,28 +35,87 @@ MQTTClientComponent::MQTTClientComponent(const MQTTCredentials &credentials, con
 // Connection
 void MQTTClientComponent::setup() {
   ESP_LOGCONFIG(TAG, "Setting up MQTT...");
+#ifdef USE_METRICS
+  global_metrics.register_gauge("mqtt_connected", "Whether the MQTT client is connected.",
+                                [this]() { return this->is_connected(); });
+  global_metrics.register_gauge("mqtt_inflight_messages", "QoS 1/2 messages waiting for their acknowledgement.",
+                                [this]() { return this->get_inflight_count(); });
+  global_metrics.register_gauge("mqtt_publish_queue_messages", "QoS 1/2 messages waiting for the inflight window.",
+                                [this]() { return this->publish_queue_.size(); });
+  global_metrics.register_gauge("mqtt_offline_queue_messages", "Messages queued while disconnected.",
+                                [this]() { return this->offline_queue_.size(); });
+  global_metrics.register_counter("mqtt_publish_dropped_total", "QoS 1/2 messages dropped, the publish queue was full.",
+                                  [this]() { return this->publish_dropped_; });
+  global_metrics.register_counter("mqtt_offline_dropped_total", "Messages dropped, the offline queue was full.",
+                                  [this]() { return this->offline_queue_dropped_; });
+#endif
   if (this->credentials_.client_id.empty())
     this->credentials_.client_id = generate_hostname(get_app_name());
+  reserve_global_json_build_buffer(MQTT_DISCOVERY_BUFFER_SIZE);
   this->mqtt_client_.onMessage([this](char *topic, char *payload, AsyncMqttClientMessageProperties properties,
                                       size_t len, size_t index, size_t total) {
     std::string payload_s(payload, len);
     std::string topic_s(topic);
     this->on_message(topic_s, payload_s);
+    // the message handlers may have queued publishes
+    wake_loop();
+  });
+  this->mqtt_client_.onConnect([this](bool session_present) {
+    this->session_present_ = session_present;
+    wake_loop();
   });
   this->mqtt_client_.onDisconnect([this](AsyncMqttClientDisconnectReason reason) {
     this->state_ = MQTT_CLIENT_DISCONNECTED;
     this->disconnect_reason_ = reason;
+    wake_loop();
   });
-  if (this->is_log_message_enabled() && global_log_component != nullptr) {
-    global_log_component->add_on_log_callback([this](int level, const char *tag, const char *message) {
-      if (level <= this->log_level_ && this->is_connected()) {
-        this->publish(this->log_message_.topic, message, strlen(message), this->log_message_.qos,
-                      this->log_message_.retain);
+  this->inflight_.resize(this->inflight_window_);
+  this->mqtt_client_.onPublish([this](uint16_t packet_id) {
+    // the window isn't resized after setup, so the slots can be looked at from the TCP callbacks
+    for (auto &inflight : this->inflight_) {
+      if (inflight.used && inflight.packet_id == packet_id) {
+        inflight.acknowledged = true;
+        wake_loop();
+        break;
       }
-    });
+    }
+  });
+  if (this->is_log_message_enabled() && global_log_component != nullptr) {
+    global_log_component->add_on_log_callback(
+        [this](int level, const char *tag, const char *message) {
+          if (this->is_connected()) {
+            this->publish(this->log_message_.topic, message, strlen(message), this->log_message_.qos,
+                          this->log_message_.retain);
+          }
+        },
+        this->log_level_);
+  }
+
+  if (this->offline_queue_persistent_ && this->offline_queue_size_ != 0) {
+    this->offline_queue_pref_ =
+        global_preferences.make_preference((MQTT_OFFLINE_QUEUE_STORE_SIZE + 3) / 4, 1549360831UL);
+    this->load_offline_queue_();
   }
+  if (this->persistent_session_)
+    this->load_session_();
 
   add_shutdown_hook([this](const char *cause) {
+    // save before publishing the shutdown message so that it doesn't end up in the queue
+    if (this->offline_queue_persistent_ && this->offline_queue_size_ != 0) {
+      // messages the broker hasn't acknowledged yet are published again after the next boot
+      for (auto &inflight : this->inflight_) {
+        if (!inflight.used || inflight.acknowledged)
+          continue;
+        const MQTTMessage &message = inflight.message;
+        this->queue_offline_(message.topic, message.payload.data(), message.payload.size(), message.qos,
+                             message.retain);
+      }
+      for (auto &message : this->publish_queue_) {
+        this->queue_offline_(message.topic, message.payload.data(), message.payload.size(), message.qos,
+                             message.retain);
+      }
+      this->save_offline_queue_();
+    }
     if (!this->shutdown_message_.topic.empty()) {
       yield();
       this->publish(this->shutdown_message_);
@@ -69,12 +138,17 @@ void MQTTClientComponent::dump_config() {
     ESP_LOGCONFIG(TAG, "  Discovery retain: %s", YESNO(this->discovery_info_.retain));
   }
   ESP_LOGCONFIG(TAG, "  Topic Prefix: '%s'", this->topic_prefix_.c_str());
+  if (!this->binary_prefix_.empty()) {
+    ESP_LOGCONFIG(TAG, "  Binary Prefix: '%s'", this->binary_prefix_.c_str());
+  }
   if (!this->log_message_.topic.empty()) {
     ESP_LOGCONFIG(TAG, "  Log Topic: '%s'", this->log_message_.topic.c_str());
   }
   if (!this->availability_.topic.empty()) {
     ESP_LOGCONFIG(TAG, "  Availability: '%s'", this->availability_.topic.c_str());
   }
+  ESP_LOGCONFIG(TAG, "  Persistent Session: %s", YESNO(this->persistent_session_));
+  ESP_LOGCONFIG(TAG, "  Inflight Window: %u (timeout %u ms)", this->inflight_window_, this->inflight_timeout_);
 }
 bool MQTTClientComponent::can_proceed() { return this->is_connected(); }
 
@@ -83,10 +157,20 @@ void MQTTClientComponent::start_dnslookup_() {
     subscription.subscribed = false;
     subscription.resubscribe_timeout = 0;
   }
+  this->session_resumed_ = false;
 
   this->status_set_warning();
   this->dns_resolve_error_ = false;
   this->dns_resolved_ = false;
+  if (this->session_address_valid_) {
+    // only for the first connection, later ones look the address up again in case it changed
+    this->session_address_valid_ = false;
+    this->ip_ = IPAddress(this->session_.ip);
+    this->dns_resolved_ = true;
+    ESP_LOGD(TAG, "Using the broker IP address of the last session %s", this->ip_.toString().c_str());
+    this->start_connect_();
+    return;
+  }
   ip_addr_t addr;
 #ifdef ARDUINO_ARCH_ESP32
   err_t err = dns_gethostbyname_addrtype(this->credentials_.address.c_str(), &addr, this->dns_found_callback, this,
@@ -185,6 +269,8 @@ void MQTTClientComponent::start_connect_() {
   this->mqtt_client_.setCredentials(username, password);
 
   this->mqtt_client_.setServer(this->ip_, this->credentials_.port);
+  this->mqtt_client_.setCleanSession(!this->persistent_session_);
+  this->session_present_ = false;
   if (!this->last_will_.topic.empty()) {
     this->mqtt_client_.setWill(this->last_will_.topic.c_str(), this->last_will_.qos, this->last_will_.retain,
                                this->last_will_.payload.c_str(), this->last_will_.payload.length());
@@ -214,10 +300,21 @@ void MQTTClientComponent::check_connected() {
   // MQTT Client needs some time to be fully set up.
   delay(100);
 
+  if (this->persistent_session_) {
+    this->session_resumed_ = this->session_present_;
+    if (this->session_resumed_) {
+      ESP_LOGD(TAG, "Resumed the MQTT session, %u subscriptions are kept", this->session_.subscription_count);
+    } else {
+      this->session_.subscription_count = 0;
+    }
+    this->session_.ip = this->ip_;
+    this->session_pref_.save(&this->session_);
+  }
   this->resubscribe_subscriptions_();
+  this->resend_unacknowledged_();
 
-  for (MQTTComponent *component : this->children_)
-    component->schedule_resend_state();
+  // send discovery messages and initial states of all children again
+  this->discovery_at_ = 0;
 }
 
 void MQTTClientComponent::loop() {
@@ -282,9 +379,12 @@ void MQTTClientComponent::loop() {
         if (!this->birth_message_.topic.empty() && !this->sent_birth_message_) {
           this->sent_birth_message_ = this->publish(this->birth_message_);
         }
+        this->send_offline_queue_();
+        this->process_inflight_();
 
         this->last_connected_ = now;
         this->resubscribe_subscriptions_();
+        this->process_discovery_();
       }
       break;
   }
@@ -295,6 +395,276 @@ void MQTTClientComponent::loop() {
   }
 }
 float MQTTClientComponent::get_setup_priority() const { return setup_priority::MQTT_CLIENT; }
+uint32_t MQTTClientComponent::get_loop_idle_time() {
+  // the TCP callbacks wake the loop up on connects, disconnects, acknowledgements and received messages
+  if (this->disconnect_reason_.has_value())
+    return 0;
+  const uint32_t now = millis();
+  if (this->state_ == MQTT_CLIENT_DISCONNECTED) {
+    // time until the next connection attempt
+    const uint32_t since = now - this->connect_begin_;
+    return since < 5000 ? 5000 - since : 0;
+  }
+  if (this->state_ != MQTT_CLIENT_CONNECTED)
+    return 0;
+  if (!this->publish_queue_.empty() || !this->offline_queue_.empty() || this->discovery_at_ < this->children_.size())
+    return 0;
+  if (!this->birth_message_.topic.empty() && !this->sent_birth_message_)
+    return 0;
+  for (auto &subscription : this->subscriptions_) {
+    if (!subscription.subscribed)
+      return 0;
+  }
+
+  // check the connection once per keep alive interval, a lost connection usually calls onDisconnect earlier
+  uint32_t idle_time = this->keep_alive_ * 1000UL;
+  for (auto &inflight : this->inflight_) {
+    if (!inflight.used)
+      continue;
+    if (inflight.acknowledged || inflight.packet_id == 0)
+      return 0;
+    const uint32_t since = now - inflight.sent_at;
+    idle_time = std::min(idle_time, since < this->inflight_timeout_ ? this->inflight_timeout_ - since : 0);
+  }
+  return idle_time;
+}
+
+bool MQTTClientComponent::queue_offline_(const std::string &topic, const char *payload, size_t payload_length,
+                                         uint8_t qos, bool retain) {
+  if (this->offline_queue_size_ == 0)
+    return false;
+
+  for (auto &message : this->offline_queue_) {
+    if (message.topic == topic) {
+      // only the latest value of a topic is interesting
+      message.payload.assign(payload, payload_length);
+      message.qos = qos;
+      message.retain = retain;
+      return true;
+    }
+  }
+  if (this->offline_queue_.size() >= this->offline_queue_size_) {
+    this->offline_queue_.erase(this->offline_queue_.begin());
+    this->offline_queue_dropped_++;
+  }
+  this->offline_queue_.push_back(MQTTMessage{
+      .topic = topic,
+      .payload = std::string(payload, payload_length),
+      .qos = qos,
+      .retain = retain,
+  });
+  return true;
+}
+void MQTTClientComponent::send_offline_queue_() {
+  if (this->offline_queue_.empty())
+    return;
+
+  size_t sent = 0;
+  while (sent < this->offline_queue_.size() && this->is_connected()) {
+    const MQTTMessage &message = this->offline_queue_[sent];
+    if (!this->publish(message))
+      break;
+    sent++;
+  }
+  if (sent != 0) {
+    ESP_LOGD(TAG, "Sent %u queued messages (%u dropped while disconnected)", sent, this->offline_queue_dropped_);
+  }
+  this->offline_queue_.erase(this->offline_queue_.begin(), this->offline_queue_.begin() + sent);
+  if (this->offline_queue_.empty())
+    this->offline_queue_dropped_ = 0;
+}
+struct MQTTOfflineQueueStore {
+  uint8_t data[MQTT_OFFLINE_QUEUE_STORE_SIZE];
+
+  uint32_t hash() const { return fnv1_hash(reinterpret_cast<const char *>(this->data), sizeof(this->data)); }
+};
+void MQTTClientComponent::save_offline_queue_() {
+  // Format: per message one byte qos/retain flags, topic length, payload length (each one byte), topic, payload.
+  // A flags byte of 0xFF terminates the list.
+  MQTTOfflineQueueStore store{};
+  // find the oldest message from which all newer messages still fit
+  size_t total = 1;
+  size_t start = this->offline_queue_.size();
+  while (start > 0) {
+    const MQTTMessage &message = this->offline_queue_[start - 1];
+    if (message.topic.size() > 255 || message.payload.size() > 255)
+      break;
+    const size_t len = 3 + message.topic.size() + message.payload.size();
+    if (total + len > sizeof(store.data))
+      break;
+    total += len;
+    start--;
+  }
+
+  size_t at = 0;
+  for (size_t i = start; i < this->offline_queue_.size(); i++) {
+    const MQTTMessage &message = this->offline_queue_[i];
+    store.data[at++] = (message.qos & 0x03) | (message.retain ? 0x04 : 0x00);
+    store.data[at++] = message.topic.size();
+    store.data[at++] = message.payload.size();
+    memcpy(store.data + at, message.topic.data(), message.topic.size());
+    at += message.topic.size();
+    memcpy(store.data + at, message.payload.data(), message.payload.size());
+    at += message.payload.size();
+  }
+  store.data[at] = 0xFF;
+  const uint32_t hash = store.hash();
+  if (hash == this->offline_queue_saved_hash_)
+    return;
+  this->offline_queue_pref_.save(&store);
+  this->offline_queue_saved_hash_ = hash;
+}
+void MQTTClientComponent::load_offline_queue_() {
+  MQTTOfflineQueueStore store{};
+  store.data[0] = 0xFF;
+  // nothing saved is the same as an empty queue, which is also what's saved once the queue is restored
+  this->offline_queue_saved_hash_ = store.hash();
+  if (!this->offline_queue_pref_.load(&store) || store.data[0] == 0xFF)
+    return;
+
+  size_t at = 0;
+  while (at + 3 <= sizeof(store.data) && store.data[at] != 0xFF) {
+    const uint8_t flags = store.data[at];
+    const size_t topic_len = store.data[at + 1];
+    const size_t payload_len = store.data[at + 2];
+    at += 3;
+    if (at + topic_len + payload_len > sizeof(store.data))
+      break;
+    std::string topic(reinterpret_cast<const char *>(store.data + at), topic_len);
+    at += topic_len;
+    this->queue_offline_(topic, reinterpret_cast<const char *>(store.data + at), payload_len, flags & 0x03,
+                         (flags & 0x04) != 0);
+    at += payload_len;
+  }
+  if (!this->offline_queue_.empty()) {
+    ESP_LOGD(TAG, "Restored %u queued messages", this->offline_queue_.size());
+  }
+  // don't replay the same messages again after the next reboot
+  store = MQTTOfflineQueueStore{};
+  store.data[0] = 0xFF;
+  this->offline_queue_pref_.save(&store);
+}
+void MQTTClientComponent::resend_unacknowledged_() {
+  uint8_t count = 0;
+  for (auto &inflight : this->inflight_) {
+    if (inflight.used && !inflight.acknowledged) {
+      // the packet IDs of the last connection are gone, process_inflight_() sends the message again
+      inflight.packet_id = 0;
+      count++;
+    }
+  }
+  if (count != 0) {
+    ESP_LOGD(TAG, "Publishing %u unacknowledged messages again", count);
+  }
+}
+void MQTTClientComponent::queue_publish_(const std::string &topic, const char *payload, size_t payload_length,
+                                         uint8_t qos, bool retain) {
+  if (this->publish_queue_.size() >= MQTT_PUBLISH_QUEUE_SIZE) {
+    ESP_LOGW(TAG, "Publish queue full, dropping message for topic='%s'",
+             this->publish_queue_.front().topic.c_str());
+    this->publish_queue_.erase(this->publish_queue_.begin());
+    this->publish_dropped_++;
+  }
+  this->publish_queue_.push_back(MQTTMessage{
+      .topic = topic,
+      .payload = std::string(payload, payload_length),
+      .qos = qos,
+      .retain = retain,
+  });
+}
+void MQTTClientComponent::process_inflight_() {
+  const uint32_t now = millis();
+  bool space = true;
+  for (auto &inflight : this->inflight_) {
+    if (!inflight.used)
+      continue;
+    if (inflight.acknowledged) {
+      inflight.used = false;
+      inflight.message = MQTTMessage{};
+      continue;
+    }
+    if (space && (inflight.packet_id == 0 || now - inflight.sent_at > this->inflight_timeout_))
+      space = this->send_inflight_(inflight);
+  }
+
+  // pipeline the queued messages into the free slots
+  for (auto &inflight : this->inflight_) {
+    if (!space || this->publish_queue_.empty())
+      break;
+    if (inflight.used)
+      continue;
+    inflight.message = std::move(this->publish_queue_.front());
+    this->publish_queue_.erase(this->publish_queue_.begin());
+    inflight.packet_id = 0;
+    inflight.acknowledged = false;
+    inflight.used = true;
+    space = this->send_inflight_(inflight);
+  }
+}
+bool MQTTClientComponent::send_inflight_(MQTTInflightMessage &inflight) {
+  const MQTTMessage &message = inflight.message;
+  // a retry keeps the packet id and sets the DUP flag, so that the broker doesn't deliver it twice
+  const bool dup = inflight.packet_id != 0;
+  const uint16_t packet_id =
+      this->mqtt_client_.publish(message.topic.c_str(), message.qos, message.retain, message.payload.data(),
+                                 message.payload.size(), dup, inflight.packet_id);
+  yield();
+  if (packet_id == 0)
+    // out of TCP buffer space, tried again in the next loop iteration
+    return false;
+
+  if (dup) {
+    ESP_LOGV(TAG, "No acknowledgement for topic='%s', publishing again", message.topic.c_str());
+    this->publish_retries_++;
+  }
+  inflight.packet_id = packet_id;
+  inflight.sent_at = millis();
+  return true;
+}
+static uint32_t session_subscription_hash(const MQTTSubscription &sub) { return fnv1_hash(sub.topic) ^ sub.qos; }
+void MQTTClientComponent::load_session_() {
+  this->session_pref_ = global_preferences.make_preference<MQTTSessionState>(3155408219UL);
+  const uint32_t config_hash = fnv1_hash(this->credentials_.address + "/" + this->credentials_.client_id);
+  if (!this->session_pref_.load(&this->session_) || this->session_.config_hash != config_hash) {
+    this->session_ = MQTTSessionState{};
+    this->session_.config_hash = config_hash;
+    return;
+  }
+  this->session_address_valid_ = this->session_.ip != 0;
+}
+bool MQTTClientComponent::is_session_subscription_(const MQTTSubscription &sub) const {
+  const uint32_t hash = session_subscription_hash(sub);
+  for (uint8_t i = 0; i < this->session_.subscription_count; i++) {
+    if (this->session_.subscriptions[i] == hash)
+      return true;
+  }
+  return false;
+}
+void MQTTClientComponent::add_session_subscription_(const MQTTSubscription &sub) {
+  if (this->is_session_subscription_(sub) || this->session_.subscription_count >= MQTT_SESSION_MAX_SUBSCRIPTIONS)
+    return;
+  this->session_.subscriptions[this->session_.subscription_count++] = session_subscription_hash(sub);
+  this->session_pref_.save(&this->session_);
+}
+void MQTTClientComponent::process_discovery_() {
+  size_t sent = 0;
+  size_t count = 0;
+  while (this->discovery_at_ < this->children_.size() && sent < MQTT_DISCOVERY_BYTES_PER_LOOP &&
+         count < MQTT_DISCOVERY_MAX_PER_LOOP) {
+    MQTTComponent *component = this->children_[this->discovery_at_];
+    if (component->is_discovery_enabled()) {
+      size_t bytes;
+      if (!component->send_discovery_(&bytes))
+        // try again in the next loop iteration
+        return;
+      sent += bytes;
+      count++;
+    }
+    // the state is sent after the discovery message so that Home Assistant knows the entity already
+    component->schedule_resend_state();
+    this->discovery_at_++;
+  }
+}
 
 // Subscribe
 bool MQTTClientComponent::subscribe_(const char *topic, uint8_t qos) {
@@ -316,6 +686,11 @@ bool MQTTClientComponent::subscribe_(const char *topic, uint8_t qos) {
 void MQTTClientComponent::resubscribe_subscription_(MQTTSubscription *sub) {
   if (sub->subscribed)
     return;
+  if (this->session_resumed_ && this->is_session_subscription_(*sub)) {
+    // the broker kept the subscription with the session
+    sub->subscribed = true;
+    return;
+  }
 
   const uint32_t now = millis();
   bool do_resub = sub->resubscribe_timeout == 0 || now - sub->resubscribe_timeout > 1000;
@@ -323,6 +698,8 @@ void MQTTClientComponent::resubscribe_subscription_(MQTTSubscription *sub) {
   if (do_resub) {
     sub->subscribed = this->subscribe_(sub->topic.c_str(), sub->qos);
     sub->resubscribe_timeout = now;
+    if (sub->subscribed && this->persistent_session_)
+      this->add_session_subscription_(*sub);
   }
 }
 void MQTTClientComponent::resubscribe_subscriptions_() {
@@ -340,7 +717,8 @@ void MQTTClientComponent::subscribe(const std::string &topic, mqtt_callback_t ca
       .resubscribe_timeout = 0,
   };
   this->resubscribe_subscription_(&subscription);
-  this->subscriptions_.push_back(subscription);
+  this->subscription_tree_.insert(topic, this->subscriptions_.size());
+  this->subscriptions_.push_back(std::move(subscription));
 }
 
 void MQTTClientComponent::subscribe_json(const std::string &topic, mqtt_json_callback_t callback, uint8_t qos) {
@@ -355,7 +733,8 @@ void MQTTClientComponent::subscribe_json(const std::string &topic, mqtt_json_cal
       .resubscribe_timeout = 0,
   };
   this->resubscribe_subscription_(&subscription);
-  this->subscriptions_.push_back(subscription);
+  this->subscription_tree_.insert(topic, this->subscriptions_.size());
+  this->subscriptions_.push_back(std::move(subscription));
 }
 
 // Publish
@@ -365,11 +744,20 @@ bool MQTTClientComponent::publish(const std::string &topic, const std::string &p
 
 bool MQTTClientComponent::publish(const std::string &topic, const char *payload, size_t payload_length, uint8_t qos,
                                   bool retain) {
+  bool logging_topic = topic == this->log_message_.topic;
   if (!this->is_connected()) {
     // critical components will re-transmit their messages
-    return false;
+    if (logging_topic)
+      return false;
+    return this->queue_offline_(topic, payload, payload_length, qos, retain);
+  }
+  if (qos > 0 && !logging_topic) {
+    // QoS 1/2 messages go through the inflight window, in order
+    ESP_LOGV(TAG, "Publish(topic='%s' payload='%s' retain=%d qos=%u)", topic.c_str(), payload, retain, qos);
+    this->queue_publish_(topic, payload, payload_length, qos, retain);
+    this->process_inflight_();
+    return true;
   }
-  bool logging_topic = topic == this->log_message_.topic;
   uint16_t ret = this->mqtt_client_.publish(topic.c_str(), qos, retain, payload, payload_length);
   yield();
   if (ret == 0 && !logging_topic && this->is_connected()) {
@@ -389,6 +777,17 @@ bool MQTTClientComponent::publish(const std::string &topic, const char *payload,
   return ret != 0;
 }
 
+bool MQTTClientComponent::has_pending_messages() {
+  if (!this->offline_queue_.empty() || this->get_inflight_count() != 0 || !this->publish_queue_.empty() ||
+      this->discovery_at_ < this->children_.size())
+    return true;
+  for (MQTTComponent *component : this->children_) {
+    if (!component->is_internal() && component->is_resend_state_scheduled())
+      return true;
+  }
+  return false;
+}
+
 bool MQTTClientComponent::publish(const MQTTMessage &message) {
   return this->publish(message.topic, message.payload, message.qos, message.retain);
 }
@@ -398,72 +797,16 @@ bool MQTTClientComponent::publish_json(const std::string &topic, const json_buil
   return this->publish(topic, message, len, qos, retain);
 }
 
-/** Check if the message topic matches the given subscription topic
- *
- * INFO: MQTT spec mandates that topics must not be empty and must be valid NULL-terminated UTF-8 strings.
- *
- * @param message The message topic that was received from the MQTT server. Note: this must not contain
- *                wildcard characters as mandated by the MQTT spec.
- * @param subscription The subscription topic we are matching against.
- * @param is_normal Is this a "normal" topic - Does the message topic not begin with a "$".
- * @param past_separator Are we past the first '/' topic separator.
- * @return true if the subscription topic matches the message topic, false otherwise.
- */
-static bool topic_match(const char *message, const char *subscription, bool is_normal, bool past_separator) {
-  // Reached end of both strings at the same time, this means we have a successful match
-  if (*message == '\0' && *subscription == '\0')
-    return true;
-
-  // Either the message or the subscribe are at the end. This means they don't match.
-  if (*message == '\0' || *subscription == '\0')
-    return false;
-
-  bool do_wildcards = is_normal || past_separator;
-
-  if (*subscription == '+' && do_wildcards) {
-    // single level wildcard
-    // consume + from subscription
-    subscription++;
-    // consume everything from message until '/' found or end of string
-    while (*message != '\0' && *message != '/') {
-      message++;
-    }
-    // after this, both pointers will point to a '/' or to the end of the string
-
-    return topic_match(message, subscription, is_normal, true);
-  }
-
-  if (*subscription == '#' && do_wildcards) {
-    // multilevel wildcard - MQTT mandates that this must be at end of subscribe topic
-    return true;
-  }
-
-  // this handles '/' and normal characters at the same time.
-  if (*message != *subscription)
-    return false;
-
-  past_separator = past_separator || *subscription == '/';
-
-  // consume characters
-  subscription++;
-  message++;
-
-  return topic_match(message, subscription, is_normal, past_separator);
-}
-
-static bool topic_match(const char *message, const char *subscription) {
-  return topic_match(message, subscription, *message != '\0' && *message != '$', false);
-}
-
 void MQTTClientComponent::on_message(const std::string &topic, const std::string &payload) {
+  network_notify_activity();
 #ifdef ARDUINO_ARCH_ESP8266
   // on ESP8266, this is called in LWiP thread; some components do not like running
   // in an ISR.
   this->defer([this, topic, payload]() {
 #endif
-    for (auto &subscription : this->subscriptions_)
-      if (topic_match(topic.c_str(), subscription.topic.c_str()))
-        subscription.callback(topic, payload);
+    this->subscription_tree_.match(topic.c_str(), &this->matched_subscriptions_);
+    for (uint32_t index : this->matched_subscriptions_)
+      this->subscriptions_[index].callback(topic, payload);
 #ifdef ARDUINO_ARCH_ESP8266
   });
 #endif
@@ -479,13 +822,40 @@ MQTTJsonMessageTrigger *MQTTClientComponent::make_json_message_trigger(const std
   return new MQTTJsonMessageTrigger(topic, qos);
 }
 void MQTTClientComponent::set_reboot_timeout(uint32_t reboot_timeout) { this->reboot_timeout_ = reboot_timeout; }
+void MQTTClientComponent::set_offline_queue_size(size_t max_messages) { this->offline_queue_size_ = max_messages; }
+void MQTTClientComponent::set_offline_queue_persistent(bool persistent) {
+  this->offline_queue_persistent_ = persistent;
+}
+void MQTTClientComponent::set_persistent_session(bool persistent_session) {
+  this->persistent_session_ = persistent_session;
+}
+void MQTTClientComponent::set_inflight_window(uint8_t inflight_window) { this->inflight_window_ = inflight_window; }
+void MQTTClientComponent::set_inflight_timeout(uint32_t inflight_timeout) {
+  this->inflight_timeout_ = inflight_timeout;
+}
+uint8_t MQTTClientComponent::get_inflight_window() const { return this->inflight_window_; }
+uint8_t MQTTClientComponent::get_inflight_count() const {
+  uint8_t count = 0;
+  for (auto &inflight : this->inflight_) {
+    if (inflight.used && !inflight.acknowledged)
+      count++;
+  }
+  return count;
+}
+size_t MQTTClientComponent::get_publish_queue_size() const { return this->publish_queue_.size(); }
+uint32_t MQTTClientComponent::get_publish_retries() const { return this->publish_retries_; }
+uint32_t MQTTClientComponent::get_publish_dropped() const { return this->publish_dropped_; }
 void MQTTClientComponent::register_mqtt_component(MQTTComponent *component) { this->children_.push_back(component); }
 void MQTTClientComponent::set_log_level(int level) { this->log_level_ = level; }
-void MQTTClientComponent::set_keep_alive(uint16_t keep_alive_s) { this->mqtt_client_.setKeepAlive(keep_alive_s); }
+void MQTTClientComponent::set_keep_alive(uint16_t keep_alive_s) {
+  this->keep_alive_ = keep_alive_s;
+  this->mqtt_client_.setKeepAlive(keep_alive_s);
+}
 void MQTTClientComponent::set_log_message_template(MQTTMessage &&message) { this->log_message_ = std::move(message); }
 const MQTTDiscoveryInfo &MQTTClientComponent::get_discovery_info() const { return this->discovery_info_; }
 void MQTTClientComponent::set_topic_prefix(std::string topic_prefix) {
   this->topic_prefix_ = std::move(topic_prefix);
+  this->topic_prefix_version_++;
   this->set_birth_message(MQTTMessage{
       .topic = this->topic_prefix_ + "/status",
       .payload = "online",
@@ -506,6 +876,24 @@ void MQTTClientComponent::set_topic_prefix(std::string topic_prefix) {
   });
 }
 const std::string &MQTTClientComponent::get_topic_prefix() const { return this->topic_prefix_; }
+uint32_t MQTTClientComponent::get_topic_prefix_version() const { return this->topic_prefix_version_; }
+void MQTTClientComponent::set_binary_prefix(const std::string &binary_prefix) {
+  this->binary_prefix_ = binary_prefix;
+  this->topic_prefix_version_++;
+}
+const std::string &MQTTClientComponent::get_binary_prefix() const { return this->binary_prefix_; }
+std::vector<uint8_t> *MQTTClientComponent::get_binary_buffer() {
+  this->binary_buffer_.clear();
+  return &this->binary_buffer_;
+}
+#ifdef USE_SENSOR
+void MQTTClientComponent::set_sensor_publish_policy(const sensor::SensorPublishPolicy &sensor_publish_policy) {
+  this->sensor_publish_policy_ = sensor_publish_policy;
+}
+const sensor::SensorPublishPolicy &MQTTClientComponent::get_sensor_publish_policy() const {
+  return this->sensor_publish_policy_;
+}
+#endif
 void MQTTClientComponent::disable_birth_message() {
   this->birth_message_.topic = "";
   this->recalculate_availability_();
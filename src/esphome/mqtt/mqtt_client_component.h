@@ -14,7 +14,10 @@
 #include "esphome/component.h"
 #include "esphome/helpers.h"
 #include "esphome/automation.h"
+#include "esphome/sensor/publish_policy.h"
 #include "esphome/log.h"
+#include "esphome/esppreferences.h"
+#include "esphome/mqtt/mqtt_topic_tree.h"
 #include "lwip/ip_addr.h"
 
 ESPHOME_NAMESPACE_BEGIN
@@ -36,6 +39,10 @@ struct MQTTMessage {
   bool retain;
 };
 
+/// Number of bytes of the offline queue saved to ESPPreferences (16 of the 96 RTC words on the ESP8266), see
+/// set_offline_queue_persistent().
+#define MQTT_OFFLINE_QUEUE_STORE_SIZE 64
+
 /// internal struct for MQTT subscriptions.
 struct MQTTSubscription {
   std::string topic;
@@ -78,6 +85,32 @@ struct MQTTDiscoveryInfo {
   bool clean;
 };
 
+#define MQTT_SESSION_MAX_SUBSCRIPTIONS 16
+
+/// The persistent session of the last connection, so that a node waking from deep sleep can reconnect quickly.
+struct MQTTSessionState {
+  /// Hash of the broker address and client ID, to detect when the configuration changed.
+  uint32_t config_hash;
+  /// The broker IP address.
+  uint32_t ip;
+  /// Hashes of the topic and QoS of the subscriptions the broker has for the session.
+  uint8_t subscription_count;
+  uint32_t subscriptions[MQTT_SESSION_MAX_SUBSCRIPTIONS];
+};
+
+#define MQTT_PUBLISH_QUEUE_SIZE 32
+
+/// A slot of the inflight window, for a QoS 1/2 message the broker hasn't acknowledged yet.
+struct MQTTInflightMessage {
+  MQTTMessage message;
+  bool used;
+  /// The packet ID of the last attempt, 0 if the message hasn't been sent on the current connection.
+  uint16_t packet_id;
+  uint32_t sent_at;
+  /// Set from the TCP callbacks, the slot is freed in the main loop.
+  volatile bool acknowledged;
+};
+
 enum MQTTClientState {
   MQTT_CLIENT_DISCONNECTED = 0,
   MQTT_CLIENT_RESOLVING_ADDRESS,
@@ -152,6 +185,25 @@ class MQTTClientComponent : public Component {
   void set_topic_prefix(std::string topic_prefix);
   /// Get the topic prefix of this device, using default if necessary
   const std::string &get_topic_prefix() const;
+  /// Incremented each time the topic prefix changes, used by MQTTComponent to invalidate cached topics.
+  uint32_t get_topic_prefix_version() const;
+
+  /** Additionally publish states as native API protobuf messages (see api.proto) under this topic prefix.
+   *
+   * For example with "livingroom/bin", a sensor state is also published as a SensorStateResponse
+   * to "livingroom/bin/sensor/<object_id>/state". Only sensors, binary sensors, switches and lights
+   * support this and it requires the native API to be compiled in. Empty (default) disables it.
+   */
+  void set_binary_prefix(const std::string &binary_prefix);
+  const std::string &get_binary_prefix() const;
+  /// Get the cleared buffer binary state payloads are encoded into before being published.
+  std::vector<uint8_t> *get_binary_buffer();
+
+#ifdef USE_SENSOR
+  /// Thin out the sensor values published over MQTT, see sensor::SensorPublishPolicy.
+  void set_sensor_publish_policy(const sensor::SensorPublishPolicy &sensor_publish_policy);
+  const sensor::SensorPublishPolicy &get_sensor_publish_policy() const;
+#endif
 
   /// Manually set the topic used for logging.
   void set_log_message_template(MQTTMessage &&message);
@@ -211,6 +263,7 @@ class MQTTClientComponent : public Component {
   void loop() override;
   /// MQTT client setup priority
   float get_setup_priority() const override;
+  uint32_t get_loop_idle_time() override;
 
   void on_message(const std::string &topic, const std::string &payload);
 
@@ -228,10 +281,60 @@ class MQTTClientComponent : public Component {
 
   void set_reboot_timeout(uint32_t reboot_timeout);
 
+  /** Queue messages published while disconnected and send them once connected again.
+   *
+   * At most max_messages messages are kept, the oldest message is dropped when the queue is full. A message
+   * for a topic that is already queued replaces the queued payload, so that only the latest value is sent.
+   *
+   * @param max_messages The maximum number of queued messages, 0 disables the queue (default).
+   */
+  void set_offline_queue_size(size_t max_messages);
+  /** Save the offline queue to ESPPreferences when the node reboots and restore it on boot.
+   *
+   * That way a reboot during an outage (for example by the reboot timeout) doesn't lose the queued messages.
+   * Only the newest messages fitting into MQTT_OFFLINE_QUEUE_STORE_SIZE bytes are saved, and only if the offline
+   * queue is enabled (see set_offline_queue_size()). The preference is only written when the saved messages change.
+   */
+  void set_offline_queue_persistent(bool persistent);
+  /** Keep the MQTT session on the broker across reconnects and deep sleep.
+   *
+   * The client then connects with clean session false, so the broker keeps its subscriptions and queues QoS 1/2
+   * messages for it while the node is away. If the broker still has the session, the subscriptions aren't sent
+   * again. The broker address is cached in RTC memory, so a node waking from deep sleep connects without a DNS
+   * lookup. Together with a persistent offline queue, QoS 1/2 messages that weren't acknowledged before deep sleep
+   * are published after waking up.
+   */
+  void set_persistent_session(bool persistent_session);
+  /** Set how many QoS 1/2 messages can be sent before the broker acknowledged them, at least 1 (default 8).
+   *
+   * The messages of the window are pipelined, further QoS 1/2 messages wait in a queue of at most
+   * MQTT_PUBLISH_QUEUE_SIZE messages until the broker acknowledged earlier ones. Messages that don't fit into the
+   * TCP buffer are queued as well instead of failing.
+   */
+  void set_inflight_window(uint8_t inflight_window);
+  /// Publish a QoS 1/2 message again if the broker hasn't acknowledged it after this many ms (default 10s).
+  void set_inflight_timeout(uint32_t inflight_timeout);
+  uint8_t get_inflight_window() const;
+  /// Number of QoS 1/2 messages sent, but not acknowledged yet.
+  uint8_t get_inflight_count() const;
+  /// Number of QoS 1/2 messages waiting for a free slot in the inflight window.
+  size_t get_publish_queue_size() const;
+  /// Number of QoS 1/2 messages published again because they weren't acknowledged in time.
+  uint32_t get_publish_retries() const;
+  /// Number of QoS 1/2 messages dropped because the publish queue was full.
+  uint32_t get_publish_dropped() const;
+
   void register_mqtt_component(MQTTComponent *component);
 
   bool is_connected();
 
+  /** Whether messages are still waiting to be sent.
+   *
+   * That is queued offline messages, discovery messages and states that haven't been sent yet after
+   * connecting and QoS 1/2 messages that haven't been acknowledged by the broker.
+   */
+  bool has_pending_messages();
+
  protected:
   /// Reconnect to the MQTT broker if not already connected.
   void start_connect_();
@@ -249,6 +352,27 @@ class MQTTClientComponent : public Component {
   bool subscribe_(const char *topic, uint8_t qos);
   void resubscribe_subscription_(MQTTSubscription *sub);
   void resubscribe_subscriptions_();
+  /// Send the discovery messages of the next few children, within the per-loop byte budget.
+  void process_discovery_();
+  /// Add a message to the offline queue, returns false if the queue is disabled.
+  bool queue_offline_(const std::string &topic, const char *payload, size_t payload_length, uint8_t qos, bool retain);
+  /// Publish the queued messages in order, stops at the first message that can't be sent.
+  void send_offline_queue_();
+  void save_offline_queue_();
+  void load_offline_queue_();
+  /// Publish the QoS 1/2 messages the broker hasn't acknowledged before the connection was lost again.
+  void resend_unacknowledged_();
+  /// Queue a QoS 1/2 message for the inflight window, dropping the oldest one if the queue is full.
+  void queue_publish_(const std::string &topic, const char *payload, size_t payload_length, uint8_t qos,
+                      bool retain);
+  /// Free acknowledged slots, retry timed out messages and send queued messages while the window has room.
+  void process_inflight_();
+  /// Send the message of the slot, returns false if it doesn't fit into the TCP buffer.
+  bool send_inflight_(MQTTInflightMessage &inflight);
+  void load_session_();
+  /// Whether the broker has the subscription in the resumed session, or remember it for the next one.
+  bool is_session_subscription_(const MQTTSubscription &sub) const;
+  void add_session_subscription_(const MQTTSubscription &sub);
 
   MQTTCredentials credentials_;
   /// The last will message. Disabled optional denotes it being default and
@@ -269,17 +393,54 @@ class MQTTClientComponent : public Component {
       .clean = false,
   };
   std::string topic_prefix_{};
+  uint32_t topic_prefix_version_{0};
+  std::string binary_prefix_{};
+  std::vector<uint8_t> binary_buffer_;
+#ifdef USE_SENSOR
+  sensor::SensorPublishPolicy sensor_publish_policy_;
+#endif
   MQTTMessage log_message_;
   int log_level_{ESPHOME_LOG_LEVEL};
 
   std::vector<MQTTSubscription> subscriptions_;
+  /// Topic filters of subscriptions_, values are indices into subscriptions_.
+  MQTTTopicTree subscription_tree_;
+  /// Reused buffer for the subscriptions matching a received message.
+  std::vector<uint32_t> matched_subscriptions_;
   AsyncMqttClient mqtt_client_;
   MQTTClientState state_{MQTT_CLIENT_DISCONNECTED};
   IPAddress ip_;
   bool dns_resolved_{false};
   bool dns_resolve_error_{false};
   std::vector<MQTTComponent *> children_;
+  /// Index of the next child to send the discovery message for, children_.size() if all have been sent.
+  size_t discovery_at_{0};
+  std::vector<MQTTMessage> offline_queue_;
+  size_t offline_queue_size_{0};
+  bool offline_queue_persistent_{false};
+  uint32_t offline_queue_dropped_{0};
+  ESPPreferenceObject offline_queue_pref_;
+  /// Hash of the offline queue store last loaded or saved, to skip writing the same messages again.
+  uint32_t offline_queue_saved_hash_{0};
+  /// The inflight window, allocated in setup(). Messages are published again after a reconnect.
+  std::vector<MQTTInflightMessage> inflight_;
+  uint8_t inflight_window_{8};
+  uint32_t inflight_timeout_{10000};
+  std::vector<MQTTMessage> publish_queue_;
+  uint32_t publish_retries_{0};
+  uint32_t publish_dropped_{0};
+  bool persistent_session_{false};
+  ESPPreferenceObject session_pref_;
+  MQTTSessionState session_{};
+  /// Whether the broker address of the saved session is used for the next connection instead of a DNS lookup.
+  bool session_address_valid_{false};
+  /// Whether the broker resumed the saved session on the current connection.
+  bool session_resumed_{false};
+  /// The session present flag of the last CONNACK, set from the TCP callbacks.
+  volatile bool session_present_{false};
   uint32_t reboot_timeout_{300000};
+  /// The keep alive time in seconds, loop() checks the connection at least this often.
+  uint16_t keep_alive_{15};
   uint32_t connect_begin_;
   uint32_t last_connected_{0};
   optional<AsyncMqttClientDisconnectReason> disconnect_reason_{};
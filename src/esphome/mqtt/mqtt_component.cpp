@@ -33,17 +33,55 @@ std::string MQTTComponent::get_default_topic_for_(const std::string &suffix) con
          "/" + suffix;
 }
 
-const std::string MQTTComponent::get_state_topic_() const {
+void MQTTComponent::update_topic_cache_() const {
+  const uint32_t version = global_mqtt_client->get_topic_prefix_version();
+  if (this->topic_cache_valid_ && this->topic_cache_version_ == version)
+    return;
+
   if (this->custom_state_topic_.empty())
-    return this->get_default_topic_for_("state");
-  return this->custom_state_topic_;
+    this->state_topic_ = this->get_default_topic_for_("state");
+  else
+    this->state_topic_ = this->custom_state_topic_;
+  if (this->custom_command_topic_.empty())
+    this->command_topic_ = this->get_default_topic_for_("command");
+  else
+    this->command_topic_ = this->custom_command_topic_;
+  const std::string &binary_prefix = global_mqtt_client->get_binary_prefix();
+  if (binary_prefix.empty())
+    this->binary_state_topic_.clear();
+  else
+    this->binary_state_topic_ = binary_prefix + "/" + this->component_type() + "/" + this->get_default_object_id_() +
+                                "/state";
+  this->topic_cache_valid_ = true;
+  this->topic_cache_version_ = version;
 }
 
-const std::string MQTTComponent::get_command_topic_() const {
-  if (this->custom_command_topic_.empty())
-    return this->get_default_topic_for_("command");
-  return this->custom_command_topic_;
+const std::string &MQTTComponent::get_state_topic_() const {
+  this->update_topic_cache_();
+  return this->state_topic_;
+}
+
+const std::string &MQTTComponent::get_command_topic_() const {
+  this->update_topic_cache_();
+  return this->command_topic_;
+}
+
+const std::string &MQTTComponent::get_binary_state_topic_() const {
+  this->update_topic_cache_();
+  return this->binary_state_topic_;
+}
+
+#ifdef USE_API
+bool MQTTComponent::publish_binary_state_(const std::function<void(api::APIBuffer &)> &encoder) {
+  const std::string &topic = this->get_binary_state_topic_();
+  if (topic.empty())
+    return true;
+  std::vector<uint8_t> *payload = global_mqtt_client->get_binary_buffer();
+  api::APIBuffer buffer(payload);
+  encoder(buffer);
+  return this->publish(topic, reinterpret_cast<const char *>(payload->data()), payload->size());
 }
+#endif
 
 bool MQTTComponent::publish(const std::string &topic, const std::string &payload) {
   if (topic.empty())
@@ -51,24 +89,39 @@ bool MQTTComponent::publish(const std::string &topic, const std::string &payload
   return global_mqtt_client->publish(topic, payload, 0, this->retain_);
 }
 
+bool MQTTComponent::publish(const std::string &topic, const char *payload, size_t payload_length) {
+  if (topic.empty())
+    return false;
+  return global_mqtt_client->publish(topic, payload, payload_length, 0, this->retain_);
+}
+
 bool MQTTComponent::publish_json(const std::string &topic, const json_build_t &f) {
   if (topic.empty())
     return false;
   return global_mqtt_client->publish_json(topic, f, 0, this->retain_);
 }
 
-bool MQTTComponent::send_discovery_() {
+bool MQTTComponent::publish_json_writer(const std::string &topic, const json_write_t &f) {
+  if (topic.empty())
+    return false;
+  size_t len;
+  const char *message = write_json(f, &len);
+  return global_mqtt_client->publish(topic, message, len, 0, this->retain_);
+}
+
+bool MQTTComponent::send_discovery_(size_t *bytes) {
   const MQTTDiscoveryInfo &discovery_info = global_mqtt_client->get_discovery_info();
+  *bytes = 0;
 
   if (discovery_info.clean) {
     ESP_LOGV(TAG, "'%s': Cleaning discovery...", this->friendly_name().c_str());
-    return global_mqtt_client->publish(this->get_discovery_topic_(discovery_info), "", 0, 0, true);
+    const std::string topic = this->get_discovery_topic_(discovery_info);
+    *bytes = topic.size();
+    return global_mqtt_client->publish(topic, "", 0, 0, true);
   }
 
-  ESP_LOGV(TAG, "'%s': Sending discovery...", this->friendly_name().c_str());
-
-  return global_mqtt_client->publish_json(
-      this->get_discovery_topic_(discovery_info),
+  size_t len;
+  const char *payload = build_json(
       [this](JsonObject &root) {
         SendDiscoveryConfig config;
         config.state_topic = true;
@@ -120,7 +173,14 @@ bool MQTTComponent::send_discovery_() {
 #endif
         device_info["manufacturer"] = "espressif";
       },
-      0, discovery_info.retain);
+      &len);
+
+  ESP_LOGV(TAG, "'%s': Sending discovery...", this->friendly_name().c_str());
+  if (!global_mqtt_client->publish(this->get_discovery_topic_(discovery_info), payload, len, 0,
+                                   discovery_info.retain))
+    return false;
+  *bytes = len;
+  return true;
 }
 
 bool MQTTComponent::get_retain() const { return this->retain_; }
@@ -147,9 +207,11 @@ float MQTTComponent::get_setup_priority() const { return setup_priority::MQTT_CO
 void MQTTComponent::disable_discovery() { this->discovery_enabled_ = false; }
 void MQTTComponent::set_custom_state_topic(const std::string &custom_state_topic) {
   this->custom_state_topic_ = custom_state_topic;
+  this->topic_cache_valid_ = false;
 }
 void MQTTComponent::set_custom_command_topic(const std::string &custom_command_topic) {
   this->custom_command_topic_ = custom_command_topic;
+  this->topic_cache_valid_ = false;
 }
 
 void MQTTComponent::set_availability(std::string topic, std::string payload_available,
@@ -170,44 +232,36 @@ void MQTTComponent::call_setup() {
 
   this->setup();
 
+  // the MQTT client sends the discovery info and then schedules sending the initial state
   global_mqtt_client->register_mqtt_component(this);
-
-  if (!this->is_connected_())
-    return;
-
-  if (this->is_discovery_enabled()) {
-    if (!this->send_discovery_()) {
-      this->schedule_resend_state();
-    }
-  }
-  if (!this->send_initial_state()) {
-    this->schedule_resend_state();
-  }
 }
 
 void MQTTComponent::call_loop() {
   this->loop_internal_();
 
-  if (this->is_internal())
+  if (this->is_internal()) {
+    this->disable_loop();
     return;
+  }
 
   this->loop();
 
   if (!this->resend_state_ || !this->is_connected_()) {
+    // the MQTT client schedules a resend after every connect, which enables loop() again
+    this->disable_loop();
     return;
   }
 
   this->resend_state_ = false;
-  if (this->is_discovery_enabled()) {
-    if (!this->send_discovery_()) {
-      this->schedule_resend_state();
-    }
-  }
   if (!this->send_initial_state()) {
     this->schedule_resend_state();
   }
 }
-void MQTTComponent::schedule_resend_state() { this->resend_state_ = true; }
+void MQTTComponent::schedule_resend_state() {
+  this->resend_state_ = true;
+  this->enable_loop();
+}
+bool MQTTComponent::is_resend_state_scheduled() const { return this->resend_state_; }
 std::string MQTTComponent::unique_id() { return ""; }
 bool MQTTComponent::is_connected_() const { return global_mqtt_client->is_connected(); }
 
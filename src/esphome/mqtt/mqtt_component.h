@@ -8,6 +8,10 @@
 #include "esphome/component.h"
 #include "esphome/mqtt/mqtt_client_component.h"
 
+#ifdef USE_API
+#include "esphome/api/util.h"
+#endif
+
 ESPHOME_NAMESPACE_BEGIN
 
 namespace mqtt {
@@ -99,8 +103,14 @@ class MQTTComponent : public Component {
   void set_availability(std::string topic, std::string payload_available, std::string payload_not_available);
   void disable_availability();
 
-  /// Internal method for the MQTT client base to schedule a resend of the state on reconnect.
+  /** Internal method for the MQTT client base to schedule a resend of the state on reconnect.
+   *
+   * loop() of MQTT components is only enabled while a resend is pending, the states are published from the
+   * state callbacks of the entities.
+   */
   void schedule_resend_state();
+  /// Whether the state still has to be resent, for example after the discovery message.
+  bool is_resend_state_scheduled() const;
 
   /** Send a MQTT message.
    *
@@ -109,6 +119,14 @@ class MQTTComponent : public Component {
    */
   bool publish(const std::string &topic, const std::string &payload);
 
+  /** Send a MQTT message without copying the payload.
+   *
+   * @param topic The topic.
+   * @param payload The payload buffer.
+   * @param payload_length The length of the payload.
+   */
+  bool publish(const std::string &topic, const char *payload, size_t payload_length);
+
   /** Construct and send a JSON MQTT message.
    *
    * @param topic The topic.
@@ -116,6 +134,9 @@ class MQTTComponent : public Component {
    */
   bool publish_json(const std::string &topic, const json_build_t &f);
 
+  /// Like publish_json(), but write the message directly with a JsonWriter.
+  bool publish_json_writer(const std::string &topic, const json_write_t &f);
+
   /** Subscribe to a MQTT topic.
    *
    * @param topic The topic. Wildcards are currently not supported.
@@ -157,15 +178,35 @@ class MQTTComponent : public Component {
   virtual std::string unique_id();
 
   /// Get the MQTT topic that new states will be shared to.
-  const std::string get_state_topic_() const;
+  const std::string &get_state_topic_() const;
 
   /// Get the MQTT topic for listening to commands.
-  const std::string get_command_topic_() const;
+  const std::string &get_command_topic_() const;
+
+  /// Get the topic binary state payloads are published to, empty if binary payloads are disabled.
+  const std::string &get_binary_state_topic_() const;
+
+#ifdef USE_API
+  /// Encode a binary state payload with encoder and publish it, if binary payloads are enabled.
+  bool publish_binary_state_(const std::function<void(api::APIBuffer &)> &encoder);
+#endif
+
+  /// Rebuild the cached state/command topics if the topic prefix changed since they were built.
+  void update_topic_cache_() const;
 
   bool is_connected_() const;
 
-  /// Internal method to start sending discovery info, this will call send_discovery().
-  bool send_discovery_();
+  friend MQTTClientComponent;
+
+  /** Internal method to start sending discovery info, this will call send_discovery().
+   *
+   * Called by MQTTClientComponent, which paces discovery messages. Sent once per connection, the broker may
+   * have lost the retained messages while the device was disconnected.
+   *
+   * @param bytes Set to the number of bytes that were published.
+   * @return Whether the discovery message was sent.
+   */
+  bool send_discovery_(size_t *bytes);
 
   // ========== INTERNAL METHODS ==========
   // (In most use cases you won't need these)
@@ -179,6 +220,12 @@ class MQTTComponent : public Component {
   bool discovery_enabled_{true};
   Availability *availability_{nullptr};
   bool resend_state_{false};
+  /// Cached state/command topics, see update_topic_cache_().
+  mutable std::string state_topic_{};
+  mutable std::string command_topic_{};
+  mutable std::string binary_state_topic_{};
+  mutable bool topic_cache_valid_{false};
+  mutable uint32_t topic_cache_version_{0};
 };
 
 }  // namespace mqtt
@@ -0,0 +1,87 @@
+#include "esphome/defines.h"
+
+#ifdef USE_MQTT
+
+#include "esphome/mqtt/mqtt_topic_tree.h"
+
+#include <cstring>
+
+#include "esphome/helpers.h"
+
+ESPHOME_NAMESPACE_BEGIN
+
+namespace mqtt {
+
+void MQTTTopicTree::insert(const std::string &filter, uint32_t value) {
+  Node *node = &this->root_;
+  size_t start = 0;
+  while (true) {
+    size_t end = filter.find('/', start);
+    const size_t len = (end == std::string::npos ? filter.size() : end) - start;
+
+    Node *next = nullptr;
+    for (auto &child : node->children) {
+      if (child->level.compare(0, std::string::npos, filter, start, len) == 0) {
+        next = child.get();
+        break;
+      }
+    }
+    if (next == nullptr) {
+      auto child = make_unique<Node>();
+      child->level = filter.substr(start, len);
+      next = child.get();
+      node->children.push_back(std::move(child));
+    }
+    node = next;
+
+    if (end == std::string::npos)
+      break;
+    start = end + 1;
+  }
+  node->values.push_back(value);
+}
+
+void MQTTTopicTree::match(const char *topic, std::vector<uint32_t> *values) const {
+  values->clear();
+  match_(&this->root_, topic, true, values);
+}
+
+void MQTTTopicTree::match_(const Node *node, const char *level, bool first_level, std::vector<uint32_t> *values) {
+  if (level == nullptr) {
+    values->insert(values->end(), node->values.begin(), node->values.end());
+    // "a/#" also matches "a"
+    for (auto &child : node->children) {
+      if (child->level == "#")
+        values->insert(values->end(), child->values.begin(), child->values.end());
+    }
+    return;
+  }
+
+  // MQTT mandates that wildcards in the first level don't match topics starting with '$'
+  const bool do_wildcards = !first_level || *level != '$';
+  const char *end = strchr(level, '/');
+  const size_t len = end == nullptr ? strlen(level) : end - level;
+  const char *next = end == nullptr ? nullptr : end + 1;
+
+  for (auto &child : node->children) {
+    const std::string &child_level = child->level;
+    if (child_level.size() == 1 && (child_level[0] == '+' || child_level[0] == '#')) {
+      if (!do_wildcards)
+        continue;
+      if (child_level[0] == '#') {
+        // multi-level wildcard, must be the last level of the filter
+        values->insert(values->end(), child->values.begin(), child->values.end());
+      } else {
+        match_(child.get(), next, false, values);
+      }
+    } else if (child_level.size() == len && memcmp(child_level.data(), level, len) == 0) {
+      match_(child.get(), next, false, values);
+    }
+  }
+}
+
+}  // namespace mqtt
+
+ESPHOME_NAMESPACE_END
+
+#endif  // USE_MQTT
@@ -0,0 +1,54 @@
+#ifndef ESPHOME_MQTT_MQTT_TOPIC_TREE_H
+#define ESPHOME_MQTT_MQTT_TOPIC_TREE_H
+
+#include "esphome/defines.h"
+
+#ifdef USE_MQTT
+
+#include <memory>
+#include <string>
+#include <vector>
+
+ESPHOME_NAMESPACE_BEGIN
+
+namespace mqtt {
+
+/** A tree of MQTT topic filters, split at the topic level separators.
+ *
+ * Each node represents one topic level of a filter, the single- ('+') and multi-level ('#') wildcards are stored
+ * as regular levels and handled specially during matching. That way finding all filters matching a topic
+ * only depends on the depth of the topic, not on the number of filters.
+ */
+class MQTTTopicTree {
+ public:
+  /// Add a topic filter (may contain wildcards), value is reported by match() for matching topics.
+  void insert(const std::string &filter, uint32_t value);
+
+  /** Find all filters matching the topic.
+   *
+   * @param topic The topic of a received message, must not contain wildcards.
+   * @param values Output vector, cleared and then filled with the values of all matching filters.
+   */
+  void match(const char *topic, std::vector<uint32_t> *values) const;
+
+ protected:
+  struct Node {
+    std::string level;
+    std::vector<std::unique_ptr<Node>> children;
+    /// Values of the filters ending at this node.
+    std::vector<uint32_t> values;
+  };
+
+  /// level points to the start of the next topic level, or is nullptr if all levels have been consumed.
+  static void match_(const Node *node, const char *level, bool first_level, std::vector<uint32_t> *values);
+
+  Node root_;
+};
+
+}  // namespace mqtt
+
+ESPHOME_NAMESPACE_END
+
+#endif  // USE_MQTT
+
+#endif  // ESPHOME_MQTT_MQTT_TOPIC_TREE_H
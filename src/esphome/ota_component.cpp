@@ -9,7 +9,9 @@
 #include "esphome/status_led.h"
 #include "esphome/util.h"
 
+#include <algorithm>
 #include <cstdio>
+#include <new>
 #include <MD5Builder.h>
 #ifdef ARDUINO_ARCH_ESP32
 #include <Update.h>
@@ -22,6 +24,11 @@ static const char *TAG = "ota";
 
 uint8_t OTA_VERSION_1_0 = 1;
 
+/// Set in the features byte by clients that can send gzip compressed images.
+static const uint8_t OTA_FEATURE_SUPPORTS_COMPRESSION = 0x01;
+/// Set in the features byte by clients that can send a delta patch against the running image.
+static const uint8_t OTA_FEATURE_SUPPORTS_DELTA = 0x02;
+
 void OTAComponent::setup() {
   this->server_ = new WiFiServer(this->port_);
   this->server_->begin();
@@ -59,16 +66,25 @@ void OTAComponent::loop() {
   }
 }
 
+uint32_t OTAComponent::get_loop_idle_time() {
+  // a client waits at most this long for the update to start, the safe mode timer isn't in a hurry either
+  return 1000;
+}
+
 void OTAComponent::handle_() {
   OTAResponseTypes error_code = OTA_RESPONSE_ERROR_UNKNOWN;
   bool update_started = false;
   uint32_t total = 0;
   uint32_t last_progress = 0;
-  uint8_t buf[1024];
+  uint32_t last_progress_total = 0;
+  uint32_t transfer_start = 0;
+  uint8_t buf[128];
   char *sbuf = reinterpret_cast<char *>(buf);
   uint32_t ota_size;
   uint8_t ota_features;
-  (void) ota_features;
+  bool compressed = false;
+  bool delta = false;
+  OTAWriter writer;
 
   if (!this->client_.connected()) {
     this->client_ = this->server_->available();
@@ -110,8 +126,13 @@ void OTAComponent::handle_() {
   ota_features = buf[0];  // NOLINT
   ESP_LOGV(TAG, "OTA features is 0x%02X", ota_features);
 
+#ifdef ARDUINO_ARCH_ESP32
+  // only the ESP32 can decompress the image on the fly
+  compressed = ota_features & OTA_FEATURE_SUPPORTS_COMPRESSION;
+#endif
+
   // Acknowledge header - 1 byte
-  this->client_.write(OTA_RESPONSE_HEADER_OK);
+  this->client_.write(compressed ? OTA_RESPONSE_SUPPORTS_COMPRESSION : OTA_RESPONSE_HEADER_OK);
 
   if (!this->password_.empty()) {
     this->client_.write(OTA_RESPONSE_REQUEST_AUTH);
@@ -172,6 +193,22 @@ void OTAComponent::handle_() {
   // Acknowledge auth OK - 1 byte
   this->client_.write(OTA_RESPONSE_AUTH_OK);
 
+  if (ota_features & OTA_FEATURE_SUPPORTS_DELTA) {
+    // Send the MD5 of the running image, 1 + 32 bytes, so that the client can send a patch against it.
+    // Only after the authentication, it identifies the exact firmware the node runs.
+    String md5 = ESP.getSketchMD5();
+    this->client_.write(OTA_RESPONSE_SUPPORTS_DELTA);
+    this->client_.write(reinterpret_cast<const uint8_t *>(md5.c_str()), 32);
+
+    // Read whether a patch or the full image follows - 1 byte
+    if (!this->wait_receive_(buf, 1)) {
+      ESP_LOGW(TAG, "Reading delta mode failed!");
+      goto error;
+    }
+    delta = buf[0] == 1;
+    ESP_LOGV(TAG, "Running image MD5 is %s, delta update: %s", md5.c_str(), YESNO(delta));
+  }
+
   // Read size, 4 bytes MSB first
   if (!this->wait_receive_(buf, 4)) {
     ESP_LOGW(TAG, "Reading size failed!");
@@ -182,13 +219,18 @@ void OTAComponent::handle_() {
     ota_size <<= 8;
     ota_size |= buf[i];
   }
-  ESP_LOGV(TAG, "OTA size is %u bytes", ota_size);
+  ESP_LOGV(TAG, "OTA size is %u bytes%s", ota_size, compressed ? " (compressed)" : "");
 
 #ifdef ARDUINO_ARCH_ESP8266
   global_preferences.prevent_write(true);
 #endif
 
-  if (!Update.begin(ota_size, U_FLASH)) {
+  // the size of compressed and delta images is only known at the end, reserve all free space for them
+#ifdef ARDUINO_ARCH_ESP32
+  if (!Update.begin(compressed || delta ? UPDATE_SIZE_UNKNOWN : ota_size, U_FLASH)) {
+#else
+  if (!Update.begin(delta ? (ESP.getFreeSketchSpace() - 0x1000) & 0xFFFFF000 : ota_size, U_FLASH)) {
+#endif
     StreamString ss;
     Update.printError(ss);
 #ifdef ARDUINO_ARCH_ESP8266
@@ -236,32 +278,60 @@ void OTAComponent::handle_() {
   // Acknowledge MD5 OK - 1 byte
   this->client_.write(OTA_RESPONSE_BIN_MD5_OK);
 
-  while (!Update.isFinished()) {
-    size_t available = this->wait_receive_(buf, 0);
+  if (!writer.begin(compressed, delta)) {
+    ESP_LOGW(TAG, "Allocating the OTA buffers failed!");
+    goto error;
+  }
+  transfer_start = last_progress = millis();
+  while (total < ota_size) {
+    uint8_t *chunk = writer.get_buffer();
+    if (chunk == nullptr) {
+      ESP_LOGW(TAG, "Timeout writing binary data to flash!");
+      error_code = OTA_RESPONSE_ERROR_WRITING_FLASH;
+      goto error;
+    }
+    size_t available = this->wait_receive_(chunk, 0, true, std::min<size_t>(OTA_BUFFER_SIZE, ota_size - total));
     if (!available) {
       goto error;
     }
 
-    uint32_t written = Update.write(buf, available);
-    if (written != available) {
-      ESP_LOGW(TAG, "Error writing binary data to flash: %u != %zu!", written, available);
-      error_code = OTA_RESPONSE_ERROR_WRITING_FLASH;
+    if (!writer.write(chunk, available)) {
+      ESP_LOGW(TAG, "Error writing binary data to flash!");
+      error_code = delta        ? OTA_RESPONSE_ERROR_PATCHING
+                   : compressed ? OTA_RESPONSE_ERROR_DECOMPRESSING
+                                : OTA_RESPONSE_ERROR_WRITING_FLASH;
       goto error;
     }
-    total += written;
+    total += available;
 
     uint32_t now = millis();
     if (now - last_progress > 1000) {
-      last_progress = now;
       float percentage = (total * 100.0f) / ota_size;
-      ESP_LOGD(TAG, "OTA in progress: %0.1f%%", percentage);
+      float speed = (total - last_progress_total) / float(now - last_progress);
+      ESP_LOGD(TAG, "OTA in progress: %0.1f%% (%.1f kB/s)", percentage, speed);
+      last_progress = now;
+      last_progress_total = total;
     }
   }
+  if (!writer.finish()) {
+    ESP_LOGW(TAG, "Error writing binary data to flash!");
+    error_code = delta        ? OTA_RESPONSE_ERROR_PATCHING
+                 : compressed ? OTA_RESPONSE_ERROR_DECOMPRESSING
+                              : OTA_RESPONSE_ERROR_WRITING_FLASH;
+    goto error;
+  }
+  {
+    const uint32_t duration = millis() - transfer_start;
+    ESP_LOGI(TAG, "Received %u bytes in %u ms (%.1f kB/s), wrote %u bytes", total, duration,
+             total / float(std::max(duration, uint32_t(1))), writer.get_written());
+  }
+  writer.end();
 
   // Acknowledge receive OK - 1 byte
   this->client_.write(OTA_RESPONSE_RECEIVE_OK);
 
-  if (!Update.end()) {
+  // the size of a compressed or delta image is only known now
+  if (!Update.end(compressed || delta)) {
     error_code = OTA_RESPONSE_ERROR_UPDATE_END;
     goto error;
   }
@@ -294,6 +364,7 @@ error:
     this->client_.flush();
   }
   this->client_.stop();
+  writer.end();
 
 #ifdef ARDUINO_ARCH_ESP32
   if (update_started) {
@@ -314,7 +385,7 @@ error:
 #endif
 }
 
-size_t OTAComponent::wait_receive_(uint8_t *buf, size_t bytes, bool check_disconnected) {
+size_t OTAComponent::wait_receive_(uint8_t *buf, size_t bytes, bool check_disconnected, size_t max_bytes) {
   size_t available = 0;
   uint32_t start = millis();
   do {
@@ -338,7 +409,7 @@ size_t OTAComponent::wait_receive_(uint8_t *buf, size_t bytes, bool check_discon
   } while (bytes == 0 ? available == 0 : available < bytes);
 
   if (bytes == 0)
-    bytes = std::min(available, size_t(1024));
+    bytes = std::min(available, max_bytes);
 
   bool success = false;
   for (uint32_t i = 0; !success && i < 100; i++) {
@@ -362,6 +433,414 @@ size_t OTAComponent::wait_receive_(uint8_t *buf, size_t bytes, bool check_discon
   return bytes;
 }
 
+bool OTADeltaPatcher::begin() {
+  this->state_ = DELTA_HEADER;
+  this->header_at_ = 0;
+  this->varint_ = 0;
+  this->varint_shift_ = 0;
+  this->produced_ = 0;
+  this->old_pos_ = 0;
+  this->old_cache_pos_ = UINT32_MAX;
+  this->out_len_ = 0;
+  this->old_size_ = ESP.getSketchSize();
+#ifdef ARDUINO_ARCH_ESP32
+  this->running_ = esp_ota_get_running_partition();
+  if (this->running_ == nullptr)
+    return false;
+#endif
+  return this->old_size_ != 0;
+}
+void OTADeltaPatcher::read_varint_(uint8_t byte) {
+  this->varint_ |= uint32_t(byte & 0x7F) << this->varint_shift_;
+  this->varint_shift_ += 7;
+  this->varint_done_ = !(byte & 0x80);
+  if (!this->varint_done_ && this->varint_shift_ > 28)
+    this->state_ = DELTA_ERROR;
+}
+bool OTADeltaPatcher::emit_old_(uint8_t diff) {
+  if (this->old_pos_ >= this->old_size_)
+    return false;
+  const uint32_t block = this->old_pos_ & ~uint32_t(OTA_DELTA_BUFFER_SIZE - 1);
+  if (block != this->old_cache_pos_) {
+#ifdef ARDUINO_ARCH_ESP32
+    if (esp_partition_read(this->running_, block, this->old_cache_, OTA_DELTA_BUFFER_SIZE) != ESP_OK)
+      return false;
+#endif
+#ifdef ARDUINO_ARCH_ESP8266
+    if (!ESP.flashRead(block, this->old_cache_, OTA_DELTA_BUFFER_SIZE))
+      return false;
+#endif
+    this->old_cache_pos_ = block;
+  }
+  const uint8_t old = reinterpret_cast<const uint8_t *>(this->old_cache_)[this->old_pos_ - block];
+  this->old_pos_++;
+  return this->emit_(old + diff);
+}
+bool OTADeltaPatcher::emit_(uint8_t byte) {
+  if (this->produced_ >= this->new_size_)
+    return false;
+  this->out_[this->out_len_++] = byte;
+  this->produced_++;
+  if (this->out_len_ == OTA_DELTA_BUFFER_SIZE)
+    return this->flush_();
+  return true;
+}
+bool OTADeltaPatcher::flush_() {
+  if (this->out_len_ == 0)
+    return true;
+  const bool success = (*this->write_)(this->out_, this->out_len_);
+  this->out_len_ = 0;
+  return success;
+}
+void OTADeltaPatcher::next_record_() {
+  this->state_ = this->produced_ >= this->new_size_ ? DELTA_DONE : DELTA_DIFF_LENGTH;
+}
+bool OTADeltaPatcher::feed(const uint8_t *data, size_t len,
+                           const std::function<bool(const uint8_t *, size_t)> &write) {
+  this->write_ = &write;
+  for (size_t i = 0; i < len && this->state_ < DELTA_DONE; i++) {
+    const uint8_t byte = data[i];
+    bool success = true;
+    switch (this->state_) {
+      case DELTA_HEADER:
+        this->header_[this->header_at_++] = byte;
+        if (this->header_at_ < sizeof(this->header_))
+          break;
+        if (memcmp(this->header_, "EDP1", 4) != 0) {
+          ESP_LOGW(TAG, "OTA image is not a delta patch!");
+          success = false;
+          break;
+        }
+        this->new_size_ = this->header_[4] | (uint32_t(this->header_[5]) << 8) |
+                          (uint32_t(this->header_[6]) << 16) | (uint32_t(this->header_[7]) << 24);
+        ESP_LOGD(TAG, "Applying delta patch for a %u byte image to the running %u byte image", this->new_size_,
+                 this->old_size_);
+        this->next_record_();
+        break;
+      case DELTA_DIFF_LITERALS:
+        success = this->emit_old_(byte);
+        this->diff_left_--;
+        if (--this->run_left_ == 0)
+          this->state_ = this->diff_left_ == 0 ? DELTA_EXTRA_LENGTH : DELTA_DIFF_ZEROS;
+        break;
+      case DELTA_EXTRA:
+        success = this->emit_(byte);
+        if (--this->run_left_ == 0)
+          this->state_ = DELTA_SEEK;
+        break;
+      default: {
+        // all other states read a varint
+        this->read_varint_(byte);
+        if (this->state_ == DELTA_ERROR || !this->varint_done_)
+          break;
+        const uint32_t value = this->varint_;
+        this->varint_ = 0;
+        this->varint_shift_ = 0;
+        switch (this->state_) {
+          case DELTA_DIFF_LENGTH:
+            success = value <= this->new_size_ - this->produced_;
+            this->diff_left_ = value;
+            this->state_ = value != 0 ? DELTA_DIFF_ZEROS : DELTA_EXTRA_LENGTH;
+            break;
+          case DELTA_DIFF_ZEROS:
+            success = value <= this->diff_left_;
+            for (uint32_t j = 0; success && j < value; j++)
+              success = this->emit_old_(0);
+            this->diff_left_ -= value;
+            this->state_ = this->diff_left_ != 0 ? DELTA_DIFF_LITERALS_LENGTH : DELTA_EXTRA_LENGTH;
+            break;
+          case DELTA_DIFF_LITERALS_LENGTH:
+            success = value <= this->diff_left_;
+            this->run_left_ = value;
+            this->state_ = value != 0 ? DELTA_DIFF_LITERALS : DELTA_DIFF_ZEROS;
+            break;
+          case DELTA_EXTRA_LENGTH:
+            success = value <= this->new_size_ - this->produced_;
+            this->run_left_ = value;
+            this->state_ = value != 0 ? DELTA_EXTRA : DELTA_SEEK;
+            break;
+          case DELTA_SEEK: {
+            // zigzag encoded
+            const int32_t offset = int32_t(value >> 1) ^ -int32_t(value & 1);
+            this->old_pos_ += offset;
+            this->next_record_();
+            break;
+          }
+          default:
+            break;
+        }
+        break;
+      }
+    }
+    if (!success)
+      this->state_ = DELTA_ERROR;
+  }
+  if (this->state_ == DELTA_ERROR) {
+    ESP_LOGW(TAG, "Applying the delta patch failed at %u bytes of the new image!", this->produced_);
+    return false;
+  }
+  // write everything up to the end of this chunk
+  return this->flush_();
+}
+bool OTADeltaPatcher::is_finished() const { return this->state_ == DELTA_DONE; }
+
+#ifdef ARDUINO_ARCH_ESP32
+// gzip header flags
+static const uint8_t GZIP_FLAG_HCRC = 0x02;
+static const uint8_t GZIP_FLAG_EXTRA = 0x04;
+static const uint8_t GZIP_FLAG_NAME = 0x08;
+static const uint8_t GZIP_FLAG_COMMENT = 0x10;
+
+bool OTAInflater::begin() {
+  this->state_ = GZIP_HEADER;
+  this->header_at_ = 0;
+  this->extra_length_ = 0;
+  this->dictionary_at_ = 0;
+  this->decompressor_ = new (std::nothrow) tinfl_decompressor;
+  this->dictionary_ = new (std::nothrow) uint8_t[TINFL_LZ_DICT_SIZE];
+  if (this->decompressor_ == nullptr || this->dictionary_ == nullptr) {
+    this->end();
+    return false;
+  }
+  tinfl_init(this->decompressor_);
+  return true;
+}
+size_t OTAInflater::parse_header_(const uint8_t *data, size_t len) {
+  size_t i = 0;
+  while (i < len && this->state_ < GZIP_DATA) {
+    const uint8_t flags = this->header_[3];
+    switch (this->state_) {
+      case GZIP_HEADER:
+        this->header_[this->header_at_++] = data[i++];
+        if (this->header_at_ < sizeof(this->header_))
+          break;
+        // magic bytes and the deflate compression method
+        if (this->header_[0] != 0x1F || this->header_[1] != 0x8B || this->header_[2] != 8) {
+          ESP_LOGW(TAG, "OTA image is not gzip compressed!");
+          this->state_ = GZIP_ERROR;
+          return i;
+        }
+        this->header_at_ = 0;
+        this->state_ = GZIP_EXTRA_LENGTH;
+        break;
+      case GZIP_EXTRA_LENGTH:
+        if (!(flags & GZIP_FLAG_EXTRA)) {
+          this->state_ = GZIP_NAME;
+          break;
+        }
+        this->extra_length_ |= uint16_t(data[i++]) << (8 * this->header_at_++);
+        if (this->header_at_ == 2) {
+          this->header_at_ = 0;
+          this->state_ = GZIP_EXTRA;
+        }
+        break;
+      case GZIP_EXTRA:
+        if (this->extra_length_ == 0) {
+          this->state_ = GZIP_NAME;
+          break;
+        }
+        this->extra_length_--;
+        i++;
+        break;
+      case GZIP_NAME:
+      case GZIP_COMMENT: {
+        const uint8_t flag = this->state_ == GZIP_NAME ? GZIP_FLAG_NAME : GZIP_FLAG_COMMENT;
+        // zero terminated strings
+        if (!(flags & flag) || data[i++] == 0)
+          this->state_ = State(this->state_ + 1);
+        break;
+      }
+      case GZIP_HEADER_CRC:
+        if (!(flags & GZIP_FLAG_HCRC) || this->header_at_ == 2) {
+          this->header_at_ = 0;
+          this->state_ = GZIP_DATA;
+          break;
+        }
+        this->header_at_++;
+        i++;
+        break;
+      default:
+        break;
+    }
+  }
+  return i;
+}
+bool OTAInflater::feed(const uint8_t *data, size_t len,
+                       const std::function<bool(const uint8_t *, size_t)> &write) {
+  size_t at = this->parse_header_(data, len);
+  if (this->state_ == GZIP_ERROR)
+    return false;
+  if (this->state_ != GZIP_DATA)
+    // rest of the header or the trailer
+    return true;
+
+  tinfl_status status;
+  do {
+    size_t in_bytes = len - at;
+    size_t out_bytes = TINFL_LZ_DICT_SIZE - this->dictionary_at_;
+    status = tinfl_decompress(this->decompressor_, data + at, &in_bytes, this->dictionary_,
+                              this->dictionary_ + this->dictionary_at_, &out_bytes, TINFL_FLAG_HAS_MORE_INPUT);
+    at += in_bytes;
+    if (out_bytes != 0 && !write(this->dictionary_ + this->dictionary_at_, out_bytes))
+      return false;
+    this->dictionary_at_ = (this->dictionary_at_ + out_bytes) & (TINFL_LZ_DICT_SIZE - 1);
+    if (status < TINFL_STATUS_DONE) {
+      ESP_LOGW(TAG, "Decompressing the OTA image failed: %d", status);
+      this->state_ = GZIP_ERROR;
+      return false;
+    }
+  } while (status == TINFL_STATUS_HAS_MORE_OUTPUT || (status == TINFL_STATUS_NEEDS_MORE_INPUT && at < len));
+  if (status == TINFL_STATUS_DONE)
+    this->state_ = GZIP_DONE;
+  return true;
+}
+bool OTAInflater::is_finished() const { return this->state_ == GZIP_DONE; }
+void OTAInflater::end() {
+  delete this->decompressor_;
+  this->decompressor_ = nullptr;
+  delete[] this->dictionary_;
+  this->dictionary_ = nullptr;
+}
+
+bool OTAWriter::begin(bool compressed, bool delta) {
+  this->compressed_ = compressed;
+  this->failed_ = false;
+  this->written_ = 0;
+  if (compressed && !this->inflater_.begin())
+    return false;
+  if (delta && !this->begin_patcher_())
+    return false;
+  this->free_queue_ = xQueueCreate(2, sizeof(uint8_t *));
+  this->full_queue_ = xQueueCreate(2, sizeof(Chunk));
+  for (auto &buffer : this->buffers_) {
+    buffer = new (std::nothrow) uint8_t[OTA_BUFFER_SIZE];
+    if (buffer == nullptr)
+      return false;
+    xQueueSend(this->free_queue_, &buffer, 0);
+  }
+  return xTaskCreate(OTAWriter::writer_task, "ota_writer", 4096, this, 1, &this->task_) == pdPASS;
+}
+void OTAWriter::writer_task(void *arg) {
+  auto *writer = reinterpret_cast<OTAWriter *>(arg);
+  Chunk chunk{};
+  while (true) {
+    if (xQueueReceive(writer->full_queue_, &chunk, portMAX_DELAY) != pdTRUE)
+      continue;
+    if (!writer->failed_ && !writer->process_(chunk.data, chunk.len))
+      writer->failed_ = true;
+    xQueueSend(writer->free_queue_, &chunk.data, portMAX_DELAY);
+  }
+}
+uint8_t *OTAWriter::get_buffer() {
+  uint8_t *buffer;
+  if (xQueueReceive(this->free_queue_, &buffer, pdMS_TO_TICKS(10000)) != pdTRUE)
+    return nullptr;
+  return buffer;
+}
+bool OTAWriter::write(uint8_t *buffer, size_t len) {
+  Chunk chunk{buffer, len};
+  xQueueSend(this->full_queue_, &chunk, portMAX_DELAY);
+  return !this->failed_;
+}
+bool OTAWriter::finish() {
+  // both buffers are back once the writer task is idle
+  const uint32_t start = millis();
+  while (uxQueueMessagesWaiting(this->free_queue_) != 2) {
+    if (millis() - start > 10000)
+      return false;
+    delay(1);
+  }
+  if (this->compressed_ && !this->inflater_.is_finished()) {
+    ESP_LOGW(TAG, "OTA image ended before the end of the compressed data!");
+    return false;
+  }
+  return this->finish_patcher_() && !this->failed_;
+}
+void OTAWriter::end() {
+  if (this->task_ != nullptr) {
+    // wait for the chunk that is being written
+    this->finish();
+    vTaskDelete(this->task_);
+    this->task_ = nullptr;
+  }
+  if (this->free_queue_ != nullptr) {
+    vQueueDelete(this->free_queue_);
+    vQueueDelete(this->full_queue_);
+    this->free_queue_ = this->full_queue_ = nullptr;
+  }
+  for (auto &buffer : this->buffers_) {
+    delete[] buffer;
+    buffer = nullptr;
+  }
+  this->inflater_.end();
+  this->end_patcher_();
+}
+bool OTAWriter::process_(const uint8_t *data, size_t len) {
+  if (this->compressed_) {
+    return this->inflater_.feed(data, len,
+                                [this](const uint8_t *out, size_t out_len) { return this->patch_(out, out_len); });
+  }
+  return this->patch_(data, len);
+}
+#endif
+
+#ifdef ARDUINO_ARCH_ESP8266
+bool OTAWriter::begin(bool compressed, bool delta) {
+  this->failed_ = false;
+  this->written_ = 0;
+  if (delta && !this->begin_patcher_())
+    return false;
+  this->buffer_ = new (std::nothrow) uint8_t[OTA_BUFFER_SIZE];
+  return this->buffer_ != nullptr;
+}
+uint8_t *OTAWriter::get_buffer() { return this->buffer_; }
+bool OTAWriter::write(uint8_t *buffer, size_t len) {
+  if (!this->failed_ && !this->process_(buffer, len))
+    this->failed_ = true;
+  return !this->failed_;
+}
+bool OTAWriter::finish() { return this->finish_patcher_() && !this->failed_; }
+void OTAWriter::end() {
+  delete[] this->buffer_;
+  this->buffer_ = nullptr;
+  this->end_patcher_();
+}
+bool OTAWriter::process_(const uint8_t *data, size_t len) { return this->patch_(data, len); }
+#endif
+
+bool OTAWriter::begin_patcher_() {
+  this->patcher_ = new (std::nothrow) OTADeltaPatcher;
+  return this->patcher_ != nullptr && this->patcher_->begin();
+}
+bool OTAWriter::finish_patcher_() {
+  if (this->patcher_ != nullptr && !this->patcher_->is_finished()) {
+    ESP_LOGW(TAG, "OTA image ended before the end of the delta patch!");
+    return false;
+  }
+  return true;
+}
+void OTAWriter::end_patcher_() {
+  delete this->patcher_;
+  this->patcher_ = nullptr;
+}
+bool OTAWriter::patch_(const uint8_t *data, size_t len) {
+  if (this->patcher_ == nullptr)
+    return this->write_flash_(data, len);
+  return this->patcher_->feed(data, len,
+                              [this](const uint8_t *out, size_t out_len) { return this->write_flash_(out, out_len); });
+}
+
+bool OTAWriter::write_flash_(const uint8_t *data, size_t len) {
+  size_t written = Update.write(const_cast<uint8_t *>(data), len);
+  this->written_ += written;
+  if (written != len) {
+    ESP_LOGW(TAG, "Error writing binary data to flash: %u != %u!", written, len);
+    return false;
+  }
+  return true;
+}
+uint32_t OTAWriter::get_written() const { return this->written_; }
+
 OTAComponent::OTAComponent(uint16_t port) : port_(port) {}
 
 void OTAComponent::set_auth_password(const std::string &password) { this->password_ = password; }
@@ -10,11 +10,25 @@
 #include <WiFiServer.h>
 #include <WiFiClient.h>
 
+#include <functional>
+
+#ifdef ARDUINO_ARCH_ESP32
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+#include <rom/miniz.h>
+#include <esp_ota_ops.h>
+#endif
+
 #ifdef ARDUINO_ARCH_ESP32
 #define OTA_DEFAULT_PORT 3232
+/// The size of the buffers the OTA image is received into, the ESP32 uses two of them.
+#define OTA_BUFFER_SIZE 4096
 #endif
 #ifdef ARDUINO_ARCH_ESP8266
 #define OTA_DEFAULT_PORT 8266
+#define OTA_BUFFER_SIZE 2048
 #endif
 
 ESPHOME_NAMESPACE_BEGIN
@@ -29,6 +43,10 @@ enum OTAResponseTypes {
   OTA_RESPONSE_BIN_MD5_OK = 67,
   OTA_RESPONSE_RECEIVE_OK = 68,
   OTA_RESPONSE_UPDATE_END_OK = 69,
+  /// Sent instead of OTA_RESPONSE_HEADER_OK if the client can send a gzip compressed image and we accept it.
+  OTA_RESPONSE_SUPPORTS_COMPRESSION = 70,
+  /// Sent after the auth response if the client can send a delta patch, followed by the running image MD5.
+  OTA_RESPONSE_SUPPORTS_DELTA = 71,
 
   OTA_RESPONSE_ERROR_MAGIC = 128,
   OTA_RESPONSE_ERROR_UPDATE_PREPARE = 129,
@@ -40,11 +58,176 @@ enum OTAResponseTypes {
   OTA_RESPONSE_ERROR_WRONG_NEW_FLASH_CONFIG = 135,
   OTA_RESPONSE_ERROR_ESP8266_NOT_ENOUGH_SPACE = 136,
   OTA_RESPONSE_ERROR_ESP32_NOT_ENOUGH_SPACE = 137,
+  OTA_RESPONSE_ERROR_DECOMPRESSING = 138,
+  OTA_RESPONSE_ERROR_PATCHING = 139,
   OTA_RESPONSE_ERROR_UNKNOWN = 255,
 };
 
 extern uint8_t OTA_VERSION_1_0;
 
+#ifdef ARDUINO_ARCH_ESP32
+/** Streaming decompression of gzip compressed OTA images with the inflater in the ESP32 ROM.
+ *
+ * The gzip header is skipped, the deflate stream is decompressed into a 32KB dictionary ring buffer and the
+ * trailer is ignored, the image is checked by its MD5 checksum anyway.
+ */
+class OTAInflater {
+ public:
+  bool begin();
+  /// Decompress the next compressed bytes, calling write with each chunk of decompressed data.
+  bool feed(const uint8_t *data, size_t len, const std::function<bool(const uint8_t *, size_t)> &write);
+  /// Whether the end of the deflate stream has been reached.
+  bool is_finished() const;
+  void end();
+
+ protected:
+  /// Parse the gzip header, returns the number of bytes consumed.
+  size_t parse_header_(const uint8_t *data, size_t len);
+
+  enum State {
+    GZIP_HEADER,
+    GZIP_EXTRA_LENGTH,
+    GZIP_EXTRA,
+    GZIP_NAME,
+    GZIP_COMMENT,
+    GZIP_HEADER_CRC,
+    GZIP_DATA,
+    GZIP_DONE,
+    GZIP_ERROR,
+  } state_{GZIP_HEADER};
+  uint8_t header_[10];
+  /// Bytes of the current header field so far.
+  size_t header_at_{0};
+  uint16_t extra_length_{0};
+  tinfl_decompressor *decompressor_{nullptr};
+  uint8_t *dictionary_{nullptr};
+  size_t dictionary_at_{0};
+};
+#endif
+
+/// The size of the buffers for reading the running image and the reconstructed image in delta updates.
+#define OTA_DELTA_BUFFER_SIZE 256
+
+/** Reconstructs the new image from a delta patch against the running image, in a streaming way.
+ *
+ * The patch starts with the magic bytes "EDP1" and the size of the new image (32 bit little endian). It's
+ * followed by bsdiff style records until the new image is complete, all numbers are LEB128 varints:
+ *  - The diff length: this many bytes of the new image are the bytes of the running image at the current
+ *    position plus a difference. As most differences are zero, they're encoded as alternating runs of
+ *    zero differences (a length) and literal differences (a length followed by the differences).
+ *  - The extra length followed by as many bytes that are inserted into the new image as is.
+ *  - The seek: a zigzag encoded offset added to the position in the running image.
+ */
+class OTADeltaPatcher {
+ public:
+  /// Prepare reading the running image.
+  bool begin();
+  /// Apply the next bytes of the patch, calling write with each chunk of the new image.
+  bool feed(const uint8_t *data, size_t len, const std::function<bool(const uint8_t *, size_t)> &write);
+  /// Whether the new image is complete.
+  bool is_finished() const;
+
+ protected:
+  void read_varint_(uint8_t byte);
+  /// Emit the next byte of the running image plus the given difference.
+  bool emit_old_(uint8_t diff);
+  bool emit_(uint8_t byte);
+  bool flush_();
+  /// Start the next record or finish if the new image is complete.
+  void next_record_();
+
+  enum State {
+    DELTA_HEADER,
+    DELTA_DIFF_LENGTH,
+    DELTA_DIFF_ZEROS,
+    DELTA_DIFF_LITERALS_LENGTH,
+    DELTA_DIFF_LITERALS,
+    DELTA_EXTRA_LENGTH,
+    DELTA_EXTRA,
+    DELTA_SEEK,
+    DELTA_DONE,
+    DELTA_ERROR,
+  } state_{DELTA_HEADER};
+  uint8_t header_[8];
+  size_t header_at_{0};
+  /// The varint being read and whether it's complete.
+  uint32_t varint_{0};
+  uint8_t varint_shift_{0};
+  bool varint_done_{false};
+  uint32_t new_size_{0};
+  uint32_t produced_{0};
+  uint32_t diff_left_{0};
+  uint32_t run_left_{0};
+  uint32_t old_size_{0};
+  uint32_t old_pos_{0};
+  /// The block of the running image in old_cache_, UINT32_MAX if none.
+  uint32_t old_cache_pos_{UINT32_MAX};
+  uint32_t old_cache_[OTA_DELTA_BUFFER_SIZE / 4];
+  uint8_t out_[OTA_DELTA_BUFFER_SIZE];
+  size_t out_len_{0};
+  const std::function<bool(const uint8_t *, size_t)> *write_{nullptr};
+#ifdef ARDUINO_ARCH_ESP32
+  const esp_partition_t *running_{nullptr};
+#endif
+};
+
+/** Writes the received OTA image to flash, on the ESP32 optionally decompressing it on the fly.
+ *
+ * On the ESP32 the data is written by a separate task while the next chunk is received into the other
+ * buffer, so receiving and writing to flash overlap. The ESP8266 can't receive while writing to flash,
+ * so each chunk is written right away.
+ */
+class OTAWriter {
+ public:
+  /**
+   * @param compressed Whether the received data is gzip compressed (ESP32 only).
+   * @param delta Whether the (decompressed) data is a delta patch against the running image.
+   */
+  bool begin(bool compressed, bool delta);
+  /// Get a buffer of OTA_BUFFER_SIZE bytes to receive the next chunk into, nullptr if the writer is stuck.
+  uint8_t *get_buffer();
+  /// Write the chunk received into a buffer from get_buffer(), returns false if writing already failed.
+  bool write(uint8_t *buffer, size_t len);
+  /// Wait for all chunks to be written, returns false if writing them failed.
+  bool finish();
+  void end();
+  /// The number of bytes written to flash (after decompressing).
+  uint32_t get_written() const;
+
+ protected:
+  bool process_(const uint8_t *data, size_t len);
+  bool begin_patcher_();
+  bool finish_patcher_();
+  void end_patcher_();
+  /// Apply the delta patch if there is one.
+  bool patch_(const uint8_t *data, size_t len);
+  bool write_flash_(const uint8_t *data, size_t len);
+
+  OTADeltaPatcher *patcher_{nullptr};
+
+#ifdef ARDUINO_ARCH_ESP32
+  struct Chunk {
+    uint8_t *data;
+    size_t len;
+  };
+
+  static void writer_task(void *arg);
+
+  uint8_t *buffers_[2]{nullptr, nullptr};
+  QueueHandle_t free_queue_{nullptr};
+  QueueHandle_t full_queue_{nullptr};
+  TaskHandle_t task_{nullptr};
+  std::atomic<bool> failed_{false};
+  bool compressed_{false};
+  OTAInflater inflater_;
+#endif
+#ifdef ARDUINO_ARCH_ESP8266
+  uint8_t *buffer_{nullptr};
+  bool failed_{false};
+#endif
+  uint32_t written_{0};
+};
+
 /// OTAComponent provides a simple way to integrate Over-the-Air updates into your app using ArduinoOTA.
 class OTAComponent : public Component {
  public:
@@ -86,6 +269,8 @@ class OTAComponent : public Component {
   void dump_config() override;
   float get_setup_priority() const override;
   void loop() override;
+  /// Connecting clients wait in the accept backlog, so loop() only has to look for them now and then.
+  uint32_t get_loop_idle_time() override;
 
   uint16_t get_port() const;
 
@@ -96,7 +281,11 @@ class OTAComponent : public Component {
   uint32_t read_rtc_();
 
   void handle_();
-  size_t wait_receive_(uint8_t *buf, size_t bytes, bool check_disconnected = true);
+  /** Receive data from the client.
+   *
+   * @param bytes The number of bytes to receive, 0 to receive what's available (at most max_bytes).
+   */
+  size_t wait_receive_(uint8_t *buf, size_t bytes, bool check_disconnected = true, size_t max_bytes = 1024);
 
   std::string password_;
 
@@ -12,6 +12,10 @@ bool BinaryOutput::is_inverted() const { return this->inverted_; }
 void BinaryOutput::set_inverted(bool inverted) { this->inverted_ = inverted; }
 PowerSupplyComponent *BinaryOutput::get_power_supply() const { return this->power_supply_; }
 void BinaryOutput::set_power_supply(PowerSupplyComponent *power_supply) { this->power_supply_ = power_supply; }
+void BinaryOutput::pre_enable_power() {
+  if (this->power_supply_ != nullptr && !this->has_requested_high_power_)
+    this->power_supply_->pre_enable();
+}
 void BinaryOutput::turn_on() {
   if (this->power_supply_ != nullptr && !this->has_requested_high_power_) {
     this->power_supply_->request_high_power();
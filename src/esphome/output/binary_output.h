@@ -60,6 +60,9 @@ class BinaryOutput {
   /// Return the power supply assigned to this binary output.
   PowerSupplyComponent *get_power_supply() const;
 
+  /// Switch the power supply on ahead of turning this output on, see PowerSupplyComponent::pre_enable().
+  void pre_enable_power();
+
   template<typename... Ts> TurnOffAction<Ts...> *make_turn_off_action();
   template<typename... Ts> TurnOnAction<Ts...> *make_turn_on_action();
 
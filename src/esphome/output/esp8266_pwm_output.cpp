@@ -8,21 +8,163 @@
 
 #include "esphome/output/esp8266_pwm_output.h"
 #include "esphome/espmath.h"
+#include "esphome/esphal.h"
+#include "esphome/helpers.h"
 #include "esphome/log.h"
 
-#include <core_esp8266_waveform.h>
-
 ESPHOME_NAMESPACE_BEGIN
 
 namespace output {
 
 static const char *TAG = "output.esp8266_pwm";
 
+/// timer1 with a divider of 16 counts at 5MHz.
+static const uint32_t PWM_TIMER_FREQUENCY = 5000000;
+/// Minimum time between two interrupts of the engine in timer ticks (10µs), closer edges are merged.
+static const uint32_t PWM_MIN_TICKS = 50;
+static const uint8_t PWM_MAX_CHANNELS = 17;
+
+/// Pins turned off `time` ticks after the start of the period.
+struct PWMEdge {
+  uint32_t mask;
+  uint32_t time;
+};
+/// Everything the interrupt needs for one period, the engine switches between two of these.
+struct PWMTable {
+  /// Pins turned on at the start of the period, all active channels.
+  uint32_t high_mask;
+  /// Pins turned off at the start of the period, channels with a duty cycle of 0.
+  uint32_t low_mask;
+  uint32_t period;
+  uint8_t edge_count;
+  PWMEdge edges[PWM_MAX_CHANNELS];
+};
+
+static PWMTable pwm_tables[2];
+/// The table used by the interrupt.
+static volatile uint8_t pwm_active_table = 0;
+/// Set when the other table is complete, the interrupt switches to it at the next period start.
+static volatile bool pwm_swap_pending = false;
+static volatile bool pwm_running = false;
+/// The edge the next interrupt handles, edge_count for the end of the period.
+static uint8_t pwm_next_edge = 0;
+static bool pwm_timer_attached = false;
+/// The duty cycles of all channels in timer ticks.
+static uint32_t pwm_duty[PWM_MAX_CHANNELS];
+static uint32_t pwm_channel_mask = 0;
+static uint32_t pwm_period = 0;
+
+static inline void ICACHE_RAM_ATTR pwm_set_pins(uint32_t mask) {
+  GPOS = mask & 0xFFFF;
+  if (mask & 0x10000)
+    GP16O |= 1;
+}
+static inline void ICACHE_RAM_ATTR pwm_clear_pins(uint32_t mask) {
+  GPOC = mask & 0xFFFF;
+  if (mask & 0x10000)
+    GP16O &= ~1;
+}
+
+static void ICACHE_RAM_ATTR HOT pwm_timer_isr() {
+  const PWMTable *table = &pwm_tables[pwm_active_table];
+  if (pwm_next_edge < table->edge_count) {
+    const PWMEdge &edge = table->edges[pwm_next_edge++];
+    pwm_clear_pins(edge.mask);
+    const uint32_t next = pwm_next_edge < table->edge_count ? table->edges[pwm_next_edge].time : table->period;
+    timer1_write(next - edge.time);
+    return;
+  }
+
+  // start of a period
+  if (pwm_swap_pending) {
+    pwm_active_table ^= 1;
+    pwm_swap_pending = false;
+    table = &pwm_tables[pwm_active_table];
+  }
+  pwm_clear_pins(table->low_mask);
+  pwm_set_pins(table->high_mask);
+  if (table->edge_count == 0) {
+    // only channels that are fully on or off, nothing to do until a duty cycle changes
+    timer1_disable();
+    pwm_running = false;
+    return;
+  }
+  pwm_next_edge = 0;
+  timer1_write(table->edges[0].time);
+}
+
+/// Build the table for the current duty cycles into the inactive table and hand it to the interrupt.
+static void pwm_commit() {
+  noInterrupts();
+  pwm_swap_pending = false;
+  const uint8_t index = pwm_active_table ^ 1;
+  interrupts();
+
+  PWMTable &table = pwm_tables[index];
+  table.high_mask = 0;
+  table.low_mask = 0;
+  table.period = pwm_period;
+  table.edge_count = 0;
+  for (uint8_t pin = 0; pin < PWM_MAX_CHANNELS; pin++) {
+    const uint32_t bit = 1UL << pin;
+    if ((pwm_channel_mask & bit) == 0)
+      continue;
+    const uint32_t duty = pwm_duty[pin];
+    if (duty == 0) {
+      table.low_mask |= bit;
+      continue;
+    }
+    table.high_mask |= bit;
+    if (duty >= pwm_period)
+      continue;
+
+    // insert sorted, an edge closer than PWM_MIN_TICKS to another one is merged into it
+    uint8_t i = 0;
+    while (i < table.edge_count && table.edges[i].time + PWM_MIN_TICKS <= duty)
+      i++;
+    if (i < table.edge_count && table.edges[i].time < duty + PWM_MIN_TICKS) {
+      table.edges[i].mask |= bit;
+      continue;
+    }
+    for (uint8_t j = table.edge_count; j > i; j--)
+      table.edges[j] = table.edges[j - 1];
+    table.edges[i] = PWMEdge{bit, duty};
+    table.edge_count++;
+  }
+
+  noInterrupts();
+  if (pwm_running) {
+    pwm_swap_pending = true;
+  } else if (table.edge_count == 0) {
+    pwm_clear_pins(table.low_mask);
+    pwm_set_pins(table.high_mask);
+  } else {
+    if (!pwm_timer_attached) {
+      timer1_isr_init();
+      timer1_attachInterrupt(pwm_timer_isr);
+      pwm_timer_attached = true;
+    }
+    pwm_active_table = index;
+    // the first interrupt starts a period
+    pwm_next_edge = table.edge_count;
+    pwm_running = true;
+    timer1_enable(TIM_DIV16, TIM_EDGE, TIM_SINGLE);
+    timer1_write(PWM_MIN_TICKS);
+  }
+  interrupts();
+}
+
 ESP8266PWMOutput::ESP8266PWMOutput(const GPIOOutputPin &pin) : pin_(pin) {}
 
 void ESP8266PWMOutput::setup() {
   ESP_LOGCONFIG(TAG, "Setting up ESP8266 PWM Output...");
   this->pin_.setup();
+  const auto period = static_cast<uint32_t>(roundf(PWM_TIMER_FREQUENCY / this->frequency_));
+  if (pwm_period != 0 && pwm_period != period) {
+    ESP_LOGW(TAG, "All ESP8266 PWM outputs use the same frequency, using %.1f Hz for all of them!", this->frequency_);
+  }
+  pwm_period = period;
+  pwm_channel_mask |= 1UL << this->pin_.get_pin();
   this->turn_off();
 }
 void ESP8266PWMOutput::dump_config() {
@@ -37,19 +179,21 @@ void HOT ESP8266PWMOutput::write_state(float state) {
     state = 1.0f - state;
   }
 
-  auto total_time_us = static_cast<uint32_t>(roundf(1e6f / this->frequency_));
-  auto duty_on = static_cast<uint32_t>(roundf(total_time_us * state));
-  uint32_t duty_off = total_time_us - duty_on;
-
-  if (duty_on == 0) {
-    stopWaveform(this->pin_.get_pin());
-    this->pin_.digital_write(this->pin_.is_inverted());
-  } else if (duty_off == 0) {
-    stopWaveform(this->pin_.get_pin());
-    this->pin_.digital_write(!this->pin_.is_inverted());
+  auto duty = static_cast<uint32_t>(roundf(pwm_period * state));
+  // keep the interrupts at least PWM_MIN_TICKS apart from the period start
+  if (duty < PWM_MIN_TICKS / 2) {
+    duty = 0;
+  } else if (duty > pwm_period - PWM_MIN_TICKS / 2) {
+    duty = pwm_period;
   } else {
-    startWaveform(this->pin_.get_pin(), duty_on, duty_off, 0);
+    duty = clamp(PWM_MIN_TICKS, pwm_period - PWM_MIN_TICKS, duty);
   }
+
+  const uint8_t pin = this->pin_.get_pin();
+  if (pwm_duty[pin] == duty && pwm_running)
+    return;
+  pwm_duty[pin] = duty;
+  pwm_commit();
 }
 float ESP8266PWMOutput::get_setup_priority() const { return setup_priority::HARDWARE; }
 void ESP8266PWMOutput::set_frequency(float frequency) { this->frequency_ = frequency; }
@@ -13,17 +13,17 @@ namespace output {
 
 /** Software PWM output component for ESP8266.
  *
- * Supported pins are 0-16. By default, this uses a frequency of 1000Hz, and this can only
- * be changed globally for all software PWM pins. To change the PWM frequency, do the following:
+ * Supported pins are 0-16. By default, this uses a frequency of 1000Hz. All ESP8266 PWM outputs share one PWM
+ * engine on timer1 and therefore one frequency, if the outputs are configured with different frequencies the one
+ * set up last is used.
  *
- * ```cpp
- * analogWriteFreq(500); // 500Hz frequency for all pins.
- * ```
+ * The engine starts every period by turning all channels on at once and then turns them off in the order of their
+ * duty cycles, channels with the same (or almost the same) duty cycle are handled by the same interrupt. The
+ * table of these edges is only recalculated when a duty cycle changes and swapped in at the start of a period, so
+ * lights with several channels change all of them in the same period without glitches.
  *
- * Note that this is a software PWM and can have noticeable flickering because of other
- * interrupts on the ESP8266 (like WiFi). Additionally, this PWM output can only be 80%
- * on at max. That is a known limitation, if it's a deal breaker, consider using the ESP32
- * instead - it up to 16 integrated hardware PWM channels.
+ * Note that this is still a software PWM and can have some jitter because of other interrupts on the ESP8266
+ * (like WiFi). Duty cycles are rounded to a resolution of 10µs at the beginning and end of the period.
  */
 class ESP8266PWMOutput : public FloatOutput, public Component {
  public:
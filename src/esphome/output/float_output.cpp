@@ -23,7 +23,15 @@ void FloatOutput::set_min_power(float min_power) {
 
 float FloatOutput::get_min_power() const { return this->min_power_; }
 
-void FloatOutput::set_level(float state) {
+void FloatOutput::set_level(float state) { this->write_state(this->adjust_level_(state)); }
+
+void FloatOutput::fade_to_level(float state, uint32_t length) { this->write_fade(this->adjust_level_(state), length); }
+
+bool FloatOutput::supports_fade() const { return false; }
+
+void FloatOutput::write_fade(float state, uint32_t length) { this->write_state(state); }
+
+float FloatOutput::adjust_level_(float state) {
   state = clamp(0.0f, 1.0f, state);
 
   if (state > 0.0f) {  // ON
@@ -42,7 +50,7 @@ void FloatOutput::set_level(float state) {
   float adjusted_value = (state * (this->max_power_ - this->min_power_)) + this->min_power_;
   if (this->is_inverted())
     adjusted_value = 1.0f - adjusted_value;
-  this->write_state(adjusted_value);
+  return adjusted_value;
 }
 
 void FloatOutput::write_state(bool state) { this->set_level(state != this->inverted_ ? 1.0f : 0.0f); }
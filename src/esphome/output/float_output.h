@@ -57,6 +57,15 @@ class FloatOutput : public BinaryOutput {
   /// Set the level of this float output, this is called from the front-end.
   void set_level(float state);
 
+  /** Linearly fade from the current level to state over length milliseconds.
+   *
+   * If the output doesn't support hardware fading (see supports_fade()), the level is set immediately.
+   */
+  void fade_to_level(float state, uint32_t length);
+
+  /// Whether this output can fade between levels in hardware without any help from the main loop.
+  virtual bool supports_fade() const;
+
   // ========== INTERNAL METHODS ==========
   // (In most use cases you won't need these)
 
@@ -72,6 +81,11 @@ class FloatOutput : public BinaryOutput {
   /// Implement BinarySensor's write_enabled; this should never be called.
   void write_state(bool state) override;
   virtual void write_state(float state) = 0;
+  /// Start a hardware fade to the (already adjusted) state over length ms, by default writes the state immediately.
+  virtual void write_fade(float state, uint32_t length);
+
+  /// Clamp state, apply min/max power and inversion and request high power if needed.
+  float adjust_level_(float state);
 
   float max_power_{1.0f};
   float min_power_{0.0f};
@@ -5,6 +5,7 @@
 #include "esphome/output/ledc_output_component.h"
 
 #include <esp32-hal-ledc.h>
+#include <driver/ledc.h>
 
 #include "esphome/log.h"
 
@@ -14,11 +15,51 @@ namespace output {
 
 static const char *TAG = "output.ledc";
 
-void LEDCOutputComponent::write_state(float state) {
+/// Whether the LEDC fade ISR has been installed, shared by all channels.
+static bool ledc_fade_installed = false;
+
+// The Arduino core maps channels 0-7 to the high speed group and 8-15 to the low speed group.
+static ledc_mode_t ledc_speed_mode(uint8_t channel) { return static_cast<ledc_mode_t>(channel / 8); }
+static ledc_channel_t ledc_group_channel(uint8_t channel) { return static_cast<ledc_channel_t>(channel % 8); }
+
+uint32_t LEDCOutputComponent::get_duty_(float state) const {
   const uint32_t max_duty = (uint32_t(1) << this->bit_depth_) - 1;
   const float duty_rounded = roundf(state * max_duty);
-  auto duty = static_cast<uint32_t>(duty_rounded);
-  ledcWrite(this->channel_, duty);
+  return static_cast<uint32_t>(duty_rounded);
+}
+
+void LEDCOutputComponent::write_state(float state) {
+  const uint32_t duty = this->get_duty_(state);
+  if (!this->fade_used_) {
+    ledcWrite(this->channel_, duty);
+    return;
+  }
+  // ledcWrite doesn't reset the increment configuration of a (possibly still running) fade
+  const ledc_mode_t mode = ledc_speed_mode(this->channel_);
+  const ledc_channel_t channel = ledc_group_channel(this->channel_);
+  ledc_set_duty(mode, channel, duty);
+  ledc_update_duty(mode, channel);
+}
+
+bool LEDCOutputComponent::supports_fade() const { return true; }
+
+void LEDCOutputComponent::write_fade(float state, uint32_t length) {
+  if (!ledc_fade_installed) {
+    if (ledc_fade_func_install(0) != ESP_OK) {
+      ESP_LOGW(TAG, "Could not install LEDC fade function!");
+      this->write_state(state);
+      return;
+    }
+    ledc_fade_installed = true;
+  }
+
+  const ledc_mode_t mode = ledc_speed_mode(this->channel_);
+  const ledc_channel_t channel = ledc_group_channel(this->channel_);
+  this->fade_used_ = true;
+  if (length == 0 || ledc_set_fade_with_time(mode, channel, this->get_duty_(state), length) != ESP_OK ||
+      ledc_fade_start(mode, channel, LEDC_FADE_NO_WAIT) != ESP_OK) {
+    this->write_state(state);
+  }
 }
 
 void LEDCOutputComponent::setup() {
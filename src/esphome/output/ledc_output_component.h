@@ -44,16 +44,26 @@ class LEDCOutputComponent : public FloatOutput, public Component {
   /// Override FloatOutput's write_state.
   void write_state(float adjusted_value) override;
 
+  /// LEDC can fade in hardware.
+  bool supports_fade() const override;
+
   float get_frequency() const;
   uint8_t get_bit_depth() const;
   uint8_t get_channel() const;
   uint8_t get_pin() const;
 
  protected:
+  /// Fade to the duty cycle using the LEDC fade engine.
+  void write_fade(float adjusted_value, uint32_t length) override;
+
+  uint32_t get_duty_(float state) const;
+
   uint8_t pin_;
   uint8_t channel_;
   uint8_t bit_depth_;
   float frequency_;
+  /// Whether the channel has been faded in hardware, writes then need to reset the fade configuration.
+  bool fade_used_{false};
 };
 
 extern uint8_t next_ledc_channel;
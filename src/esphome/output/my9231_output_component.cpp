@@ -49,6 +49,8 @@ void MY9231OutputComponent::setup() {
   this->pin_di_->digital_write(false);
   this->pin_dcki_->setup();
   this->pin_dcki_->digital_write(false);
+  this->di_isr_pin_ = this->pin_di_->to_isr();
+  this->dcki_isr_pin_ = this->pin_dcki_->to_isr();
   this->pwm_amounts_.resize(this->num_channels_, 0);
   uint8_t command = 0;
   if (this->bit_depth_ <= 8) {
@@ -70,7 +72,11 @@ void MY9231OutputComponent::setup() {
 
   this->init_chips_(command);
   ESP_LOGV(TAG, "  Chips initialized.");
-  this->loop();
+  if (this->update_) {
+    this->update_ = false;
+    this->send_frame_();
+  }
+  this->disable_loop();
 }
 void MY9231OutputComponent::dump_config() {
   ESP_LOGCONFIG(TAG, "MY9231:");
@@ -79,19 +85,33 @@ void MY9231OutputComponent::dump_config() {
   ESP_LOGCONFIG(TAG, "  Total number of channels: %u", this->num_channels_);
   ESP_LOGCONFIG(TAG, "  Number of chips: %u", this->num_chips_);
   ESP_LOGCONFIG(TAG, "  Bit depth: %u", this->bit_depth_);
+  ESP_LOGCONFIG(TAG, "  Frame interval: %u ms", this->frame_interval_);
 }
 
 void MY9231OutputComponent::loop() {
   if (!this->update_) {
+    this->disable_loop();
+    return;
+  }
+  if (millis() - this->last_frame_ < this->frame_interval_) {
     return;
   }
 
+  this->update_ = false;
+  this->disable_loop();
+  // the channels may have changed and changed back since the last frame
+  if (this->pwm_amounts_ != this->sent_amounts_) {
+    this->send_frame_();
+  }
+}
+void MY9231OutputComponent::send_frame_() {
   for (auto pwm_amount : this->pwm_amounts_) {
     this->write_word_(pwm_amount, this->bit_depth_);
   }
   // Send 8 DI pulses. After 8 falling edges, the duty data are store.
   this->send_di_pulses_(8);
-  this->update_ = false;
+  this->sent_amounts_ = this->pwm_amounts_;
+  this->last_frame_ = millis();
 }
 
 MY9231OutputComponent::Channel *MY9231OutputComponent::create_channel(uint8_t channel,
@@ -111,6 +131,7 @@ void MY9231OutputComponent::set_channel_value_(uint8_t channel, uint16_t value)
   uint8_t index = this->num_channels_ - channel - 1;
   if (this->pwm_amounts_[index] != value) {
     this->update_ = true;
+    this->enable_loop();
   }
   this->pwm_amounts_[index] = value;
 }
@@ -129,6 +150,8 @@ uint8_t MY9231OutputComponent::get_bit_depth() const { return this->bit_depth_;
 
 void MY9231OutputComponent::set_update(bool update) { this->update_ = update; }
 
+void MY9231OutputComponent::set_frame_interval(uint32_t frame_interval) { this->frame_interval_ = frame_interval; }
+
 uint16_t MY9231OutputComponent::get_max_amount() const { return (uint32_t(1) << this->bit_depth_) - 1; }
 
 void MY9231OutputComponent::init_chips_(uint8_t command) {
@@ -146,16 +169,17 @@ void MY9231OutputComponent::init_chips_(uint8_t command) {
 
 void MY9231OutputComponent::write_word_(uint16_t value, uint8_t bits) {
   for (uint8_t i = bits; i > 0; i--) {
-    this->pin_di_->digital_write(value & (1 << (i - 1)));
-    this->pin_dcki_->digital_write(!this->pin_dcki_->digital_read());
+    this->di_isr_pin_->digital_write(value & (1 << (i - 1)));
+    this->dcki_state_ = !this->dcki_state_;
+    this->dcki_isr_pin_->digital_write(this->dcki_state_);
   }
 }
 
 void MY9231OutputComponent::send_di_pulses_(uint8_t count) {
   delayMicroseconds(12);
   for (uint8_t i = 0; i < count; i++) {
-    this->pin_di_->digital_write(true);
-    this->pin_di_->digital_write(false);
+    this->di_isr_pin_->digital_write(true);
+    this->di_isr_pin_->digital_write(false);
   }
 }
 
@@ -47,6 +47,12 @@ class MY9231OutputComponent : public Component {
   void set_bit_depth(uint8_t bit_depth);
   /// Manually set duty data update on boot. Defaults is true.
   void set_update(bool update);
+  /** Set the minimum time between two frames sent to the chain in ms. Defaults to 20ms (50 frames per second).
+   *
+   * During transitions the channels change on every loop iteration, this limits how often the whole chain is
+   * clocked out. The latest values are always sent in the end.
+   */
+  void set_frame_interval(uint32_t frame_interval);
 
   // ========== INTERNAL METHODS ==========
   // (In most use cases you won't need these)
@@ -60,7 +66,7 @@ class MY9231OutputComponent : public Component {
   void dump_config() override;
   /// HARDWARE setup_priority
   float get_setup_priority() const override;
-  /// Send new values if they were updated.
+  /// Send new values if they were updated, at most once per frame interval.
   void loop() override;
 
   class Channel : public FloatOutput {
@@ -77,16 +83,27 @@ class MY9231OutputComponent : public Component {
  protected:
   void set_channel_value_(uint8_t channel, uint16_t value);
   void init_chips_(uint8_t command);
+  /// Clock out the duty data of all channels and latch it.
+  void send_frame_();
   void write_word_(uint16_t value, uint8_t bits);
   void send_di_pulses_(uint8_t count);
 
   GPIOPin *pin_di_;
   GPIOPin *pin_dcki_;
+  /// Register access copies of the pins for clocking out the data.
+  ISRInternalGPIOPin *di_isr_pin_{nullptr};
+  ISRInternalGPIOPin *dcki_isr_pin_{nullptr};
   uint8_t bit_depth_;
   uint16_t num_channels_;
   uint8_t num_chips_;
   std::vector<uint16_t> pwm_amounts_;
+  /// The duty data the chips currently have, empty before the first frame.
+  std::vector<uint16_t> sent_amounts_;
   bool update_;
+  uint32_t frame_interval_{20};
+  uint32_t last_frame_{0};
+  /// The level of DCKI, data is taken on both edges.
+  bool dcki_state_{false};
 };
 
 }  // namespace output
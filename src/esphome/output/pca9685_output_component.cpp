@@ -35,14 +35,15 @@ static const uint8_t PCA9685_MODE1_SLEEP = 0b00010000;
 static const uint16_t PCA9685_PWM_FULL = 4096;
 
 static const uint8_t PCA9685_ADDRESS = 0x40;
+/// The most channels per transaction, 4 registers each after the register address in the Wire buffer.
+static const uint8_t PCA9685_MAX_CHANNELS_PER_WRITE = (I2C_MAX_READ_LENGTH - 1) / 4;
 
 PCA9685OutputComponent::PCA9685OutputComponent(I2CComponent *parent, float frequency, uint8_t mode)
     : I2CDevice(parent, PCA9685_ADDRESS),
       frequency_(frequency),
       mode_(mode),
       min_channel_(0xFF),
-      max_channel_(0x00),
-      update_(true) {
+      max_channel_(0x00) {
   for (uint16_t &pwm_amount : this->pwm_amounts_)
     pwm_amount = 0;
 }
@@ -95,6 +96,9 @@ void PCA9685OutputComponent::setup() {
   }
   delayMicroseconds(500);
 
+  // write all channels once
+  this->dirty_min_ = this->min_channel_;
+  this->dirty_max_ = this->max_channel_;
   this->loop();
 }
 
@@ -102,57 +106,77 @@ void PCA9685OutputComponent::dump_config() {
   ESP_LOGCONFIG(TAG, "PCA9685:");
   ESP_LOGCONFIG(TAG, "  Mode: 0x%02X", this->mode_);
   ESP_LOGCONFIG(TAG, "  Frequency: %.0f Hz", this->frequency_);
+  ESP_LOGCONFIG(TAG, "  Min Update Interval: %u ms", this->min_update_interval_);
   if (this->is_failed()) {
     ESP_LOGE(TAG, "Setting up PCA9685 failed!");
   }
 }
 
 void PCA9685OutputComponent::loop() {
-  if (this->min_channel_ == 0xFF || !this->update_)
+  if (this->dirty_min_ == 0xFF)
     return;
+  const uint32_t now = millis();
+  if (this->min_update_interval_ != 0 && now - this->last_update_ < this->min_update_interval_)
+    return;
+  this->last_update_ = now;
 
   const uint16_t num_channels = this->max_channel_ - this->min_channel_ + 1;
-  for (uint8_t channel = this->min_channel_; channel <= this->max_channel_; channel++) {
-    uint16_t phase_begin = uint16_t(channel - this->min_channel_) / num_channels * 4096;
-    uint16_t phase_end;
-    uint16_t amount = this->pwm_amounts_[channel];
-    if (amount == 0) {
-      phase_end = 4096;
-    } else if (amount >= 4096) {
-      phase_begin = 4096;
-      phase_end = 0;
-    } else {
-      phase_end = phase_begin + amount;
-      if (phase_end >= 4096)
-        phase_end -= 4096;
+  // the register address auto-increments, so a range of channels is written in one transaction
+  while (this->dirty_min_ <= this->dirty_max_) {
+    const uint8_t first = this->dirty_min_;
+    const uint8_t last = std::min<uint8_t>(this->dirty_max_, first + PCA9685_MAX_CHANNELS_PER_WRITE - 1);
+    uint8_t data[PCA9685_MAX_CHANNELS_PER_WRITE * 4];
+    uint8_t *p = data;
+    for (uint8_t channel = first; channel <= last; channel++) {
+      uint16_t phase_begin = uint16_t(channel - this->min_channel_) / num_channels * 4096;
+      uint16_t phase_end;
+      uint16_t amount = this->pwm_amounts_[channel];
+      if (amount == 0) {
+        phase_end = 4096;
+      } else if (amount >= 4096) {
+        phase_begin = 4096;
+        phase_end = 0;
+      } else {
+        phase_end = phase_begin + amount;
+        if (phase_end >= 4096)
+          phase_end -= 4096;
+      }
+
+      ESP_LOGVV(TAG, "Channel %02u: amount=%04u phase_begin=%04u phase_end=%04u", channel, amount, phase_begin,
+                phase_end);
+
+      *p++ = phase_begin & 0xFF;
+      *p++ = (phase_begin >> 8) & 0xFF;
+      *p++ = phase_end & 0xFF;
+      *p++ = (phase_end >> 8) & 0xFF;
     }
 
-    ESP_LOGVV(TAG, "Channel %02u: amount=%04u phase_begin=%04u phase_end=%04u", channel, amount, phase_begin,
-              phase_end);
-
-    uint8_t data[4];
-    data[0] = phase_begin & 0xFF;
-    data[1] = (phase_begin >> 8) & 0xFF;
-    data[2] = phase_end & 0xFF;
-    data[3] = (phase_end >> 8) & 0xFF;
-
-    uint8_t reg = PCA9685_REGISTER_LED0 + 4 * channel;
-    if (!this->write_bytes(reg, data, 4)) {
+    uint8_t reg = PCA9685_REGISTER_LED0 + 4 * first;
+    if (!this->write_bytes(reg, data, p - data)) {
+      // retry the remaining channels with the next update
       this->status_set_warning();
       return;
     }
+    this->dirty_min_ = last + 1;
   }
 
+  this->dirty_min_ = 0xFF;
+  this->dirty_max_ = 0x00;
   this->status_clear_warning();
-  this->update_ = false;
 }
 
 float PCA9685OutputComponent::get_setup_priority() const { return setup_priority::HARDWARE; }
 
 void PCA9685OutputComponent::set_channel_value_(uint8_t channel, uint16_t value) {
-  if (this->pwm_amounts_[channel] != value)
-    this->update_ = true;
+  if (this->pwm_amounts_[channel] == value)
+    return;
   this->pwm_amounts_[channel] = value;
+  if (this->dirty_min_ == 0xFF) {
+    this->dirty_min_ = this->dirty_max_ = channel;
+  } else {
+    this->dirty_min_ = std::min(this->dirty_min_, channel);
+    this->dirty_max_ = std::max(this->dirty_max_, channel);
+  }
 }
 
 PCA9685OutputComponent::Channel *PCA9685OutputComponent::create_channel(uint8_t channel,
@@ -170,6 +194,9 @@ float PCA9685OutputComponent::get_frequency() const { return this->frequency_; }
 void PCA9685OutputComponent::set_frequency(float frequency) { this->frequency_ = frequency; }
 uint8_t PCA9685OutputComponent::get_mode() const { return this->mode_; }
 void PCA9685OutputComponent::set_mode(uint8_t mode) { this->mode_ = mode; }
+void PCA9685OutputComponent::set_min_update_interval(uint32_t min_update_interval) {
+  this->min_update_interval_ = min_update_interval;
+}
 
 PCA9685OutputComponent::Channel::Channel(PCA9685OutputComponent *parent, uint8_t channel)
     : FloatOutput(), parent_(parent), channel_(channel) {}
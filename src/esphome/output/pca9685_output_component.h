@@ -48,6 +48,12 @@ class PCA9685OutputComponent : public Component, public I2CDevice {
   void set_frequency(float frequency);
   /// Manually set the PCA9685 output mode, see constructor for more details.
   void set_mode(uint8_t mode);
+  /** Limit how often the channel registers are written, in ms. Defaults to 0 (every loop).
+   *
+   * Changed channels are written together in as few auto-increment transactions as the I2C buffer allows, so a
+   * longer interval lets fast transitions on many channels share transactions and keeps the bus free for others.
+   */
+  void set_min_update_interval(uint32_t min_update_interval);
 
   // ========== INTERNAL METHODS ==========
   // (In most use cases you won't need these)
@@ -82,7 +88,11 @@ class PCA9685OutputComponent : public Component, public I2CDevice {
   uint8_t min_channel_;
   uint8_t max_channel_;
   uint16_t pwm_amounts_[16];
-  bool update_;
+  /// The range of channels that changed since the last update, dirty_min_ is 0xFF if nothing changed.
+  uint8_t dirty_min_{0xFF};
+  uint8_t dirty_max_{0x00};
+  uint32_t min_update_interval_{0};
+  uint32_t last_update_{0};
 };
 
 }  // namespace output
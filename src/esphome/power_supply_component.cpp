@@ -12,6 +12,9 @@ ESPHOME_NAMESPACE_BEGIN
 
 static const char *TAG = "power_supply";
 
+/// How long a pre-enabled power supply stays on at least if no request follows, in ms.
+static const uint32_t POWER_SUPPLY_MIN_PRE_ENABLE_TIME = 1000;
+
 void PowerSupplyComponent::setup() {
   ESP_LOGCONFIG(TAG, "Setting up Power Supply...");
 
@@ -21,7 +24,7 @@ void PowerSupplyComponent::setup() {
 
   add_shutdown_hook([this](const char *cause) {
     this->active_requests_ = 0;
-    this->pin_->digital_write(false);
+    this->disable_();
   });
 }
 void PowerSupplyComponent::dump_config() {
@@ -42,17 +45,27 @@ void PowerSupplyComponent::set_enable_time(uint32_t enable_time) { this->enable_
 uint32_t PowerSupplyComponent::get_keep_on_time() const { return this->keep_on_time_; }
 void PowerSupplyComponent::set_keep_on_time(uint32_t keep_on_time) { this->keep_on_time_ = keep_on_time; }
 
+uint32_t PowerSupplyComponent::get_total_on_time() const {
+  if (this->enabled_)
+    return this->total_on_time_ + (millis() - this->enabled_at_);
+  return this->total_on_time_;
+}
+uint32_t PowerSupplyComponent::get_enable_count() const { return this->enable_count_; }
+
 void PowerSupplyComponent::request_high_power() {
+  // cancel old timeout if it exists because we now definitely have a high power mode.
   this->cancel_timeout("power-supply-off");
-  this->pin_->digital_write(true);
+  if (!this->enabled_) {
+    ESP_LOGD(TAG, "Enabling power supply.");
+    this->enable_();
+  }
 
   if (this->active_requests_ == 0) {
-    // we need to enable the power supply.
-    // cancel old timeout if it exists because we now definitely have a high power mode.
-    ESP_LOGD(TAG, "Enabling power supply.");
-    delay(this->enable_time_);
+    // only wait for the part of the enable time that hasn't passed yet, nothing if it was pre-enabled early enough.
+    const uint32_t on_time = millis() - this->enabled_at_;
+    if (on_time < this->enable_time_)
+      delay(this->enable_time_ - on_time);
   }
-  this->enabled_ = true;
   // increase active requests
   this->active_requests_++;
 }
@@ -66,14 +79,39 @@ void PowerSupplyComponent::unrequest_high_power() {
 
   if (this->active_requests_ == 0) {
     // set timeout for power supply off
-    this->set_timeout("power-supply-off", this->keep_on_time_, [this]() {
-      ESP_LOGD(TAG, "Disabling power supply.");
-      this->pin_->digital_write(false);
-      this->enabled_ = false;
-    });
+    this->set_timeout("power-supply-off", this->keep_on_time_, [this]() { this->disable_(); });
   }
 }
 
+void PowerSupplyComponent::pre_enable() {
+  if (this->active_requests_ != 0)
+    return;
+  if (!this->enabled_) {
+    ESP_LOGD(TAG, "Pre-enabling power supply.");
+    this->enable_();
+  }
+  // turn off again if the request doesn't come, but not before it could have reasonably arrived
+  const uint32_t keep_on_time = std::max(this->keep_on_time_, POWER_SUPPLY_MIN_PRE_ENABLE_TIME);
+  this->set_timeout("power-supply-off", keep_on_time, [this]() { this->disable_(); });
+}
+
+void PowerSupplyComponent::enable_() {
+  this->pin_->digital_write(true);
+  this->enabled_ = true;
+  this->enabled_at_ = millis();
+  this->enable_count_++;
+}
+
+void PowerSupplyComponent::disable_() {
+  if (!this->enabled_)
+    return;
+  this->pin_->digital_write(false);
+  this->enabled_ = false;
+  this->total_on_time_ += millis() - this->enabled_at_;
+  ESP_LOGD(TAG, "Disabling power supply. Total on time: %.1f s (turned on %u times)", this->total_on_time_ / 1000.0f,
+           this->enable_count_);
+}
+
 ESPHOME_NAMESPACE_END
 
 #endif  // USE_OUTPUT
@@ -28,6 +28,11 @@ ESPHOME_NAMESPACE_BEGIN
  *
  * Usually though, all this should actually be handled by BinaryOutput and FloatOutput, since using this class
  * correctly is not too easy.
+ *
+ * All outputs and sensors that share a power supply share its request counter, so the supply is only switched off
+ * after the last of them is done. Because a request only waits for the part of the enable time that hasn't passed
+ * yet, pre_enable() can be used to switch the supply on ahead of a request that's known to follow soon (lights do
+ * this when a transition or effect is started), so that the request doesn't have to block.
  */
 class PowerSupplyComponent : public Component {
  public:
@@ -55,6 +60,18 @@ class PowerSupplyComponent : public Component {
   /// Un-request high power mode.
   void unrequest_high_power();
 
+  /** Switch the power supply on without a request, so that it's ready for a request that's about to follow.
+   *
+   * Doesn't block. If no request follows, the power supply is turned off again after the keep on time.
+   */
+  void pre_enable();
+
+  /// Get the total time in milliseconds this power supply has been on since boot.
+  uint32_t get_total_on_time() const;
+
+  /// Get how often this power supply has been turned on since boot.
+  uint32_t get_enable_count() const;
+
   // ========== INTERNAL METHODS ==========
   // (In most use cases you won't need these)
   /// Register callbacks.
@@ -70,8 +87,16 @@ class PowerSupplyComponent : public Component {
   uint32_t get_enable_time() const;
 
  protected:
+  /// Switch the pin on and start counting the on time.
+  void enable_();
+  /// Switch the pin off and add the on time to the stats.
+  void disable_();
+
   GPIOPin *pin_;
   bool enabled_{false};
+  uint32_t enabled_at_{0};
+  uint32_t total_on_time_{0};
+  uint32_t enable_count_{0};
   uint32_t enable_time_;
   uint32_t keep_on_time_;
   int16_t active_requests_{0};  // use signed integer to make catching negative requests easier.
@@ -22,6 +22,7 @@ static const uint32_t BIT_HIGH_US = 525;
 JVCTransmitter::JVCTransmitter(const std::string &name, uint32_t data) : RemoteTransmitter(name), data_(data) {}
 
 void JVCTransmitter::to_data(RemoteTransmitData *data) { encode_jvc(data, this->data_); }
+bool JVCTransmitter::is_data_static() { return true; }
 
 void encode_jvc(RemoteTransmitData *data, uint32_t jvc_data) {
   data->set_carrier_frequency(38000);
@@ -41,18 +42,23 @@ void encode_jvc(RemoteTransmitData *data, uint32_t jvc_data) {
 #endif
 
 #ifdef USE_REMOTE_RECEIVER
+/// The accepted windows of the timings, indexed by the TIMING_ constants.
+enum { TIMING_HEADER_HIGH = 0, TIMING_HEADER_LOW, TIMING_BIT_HIGH, TIMING_BIT_ONE_LOW, TIMING_BIT_ZERO_LOW };
+static RemoteTimingTable<5> jvc_timings(HEADER_HIGH_US, HEADER_LOW_US, BIT_HIGH_US, BIT_ONE_LOW_US, BIT_ZERO_LOW_US);
+
 JVCDecodeData decode_jvc(RemoteReceiveData *data) {
+  const RemoteTimingWindow *timing = jvc_timings.get(data);
   JVCDecodeData out{};
   out.valid = false;
   out.data = 0;
-  if (!data->expect_item(HEADER_HIGH_US, HEADER_LOW_US))
+  if (!data->expect_item(timing[TIMING_HEADER_HIGH], timing[TIMING_HEADER_LOW]))
     return out;
 
   for (uint8_t i = 0; i < NBITS; i++) {
     out.data <<= 1UL;
-    if (data->expect_item(BIT_HIGH_US, BIT_ONE_LOW_US)) {
+    if (data->expect_item(timing[TIMING_BIT_HIGH], timing[TIMING_BIT_ONE_LOW])) {
       out.data |= 1UL;
-    } else if (data->expect_item(BIT_HIGH_US, BIT_ZERO_LOW_US)) {
+    } else if (data->expect_item(timing[TIMING_BIT_HIGH], timing[TIMING_BIT_ZERO_LOW])) {
       out.data |= 0UL;
     } else {
       return out;
@@ -65,13 +71,16 @@ JVCDecodeData decode_jvc(RemoteReceiveData *data) {
 
 JVCReceiver::JVCReceiver(const std::string &name, uint32_t data) : RemoteReceiver(name), data_(data) {}
 
-bool JVCReceiver::matches(RemoteReceiveData *data) {
+const char *JVCReceiver::get_protocol_name() { return "JVC"; }
+bool JVCReceiver::decode(RemoteReceiveData *data, uint64_t *code) {
   auto decode = decode_jvc(data);
   if (!decode.valid)
     return false;
 
-  return this->data_ == decode.data;
+  *code = uint64_t(decode.data);
+  return true;
 }
+uint64_t JVCReceiver::get_code() { return uint64_t(this->data_); }
 
 bool JVCDumper::dump(RemoteReceiveData *data) {
   auto decode = decode_jvc(data);
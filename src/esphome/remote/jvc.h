@@ -18,6 +18,7 @@ class JVCTransmitter : public RemoteTransmitter {
   JVCTransmitter(const std::string &name, uint32_t data);
 
   void to_data(RemoteTransmitData *data) override;
+  bool is_data_static() override;
 
  protected:
   uint32_t data_;
@@ -33,8 +34,11 @@ class JVCReceiver : public RemoteReceiver {
  public:
   JVCReceiver(const std::string &name, uint32_t data);
 
+  const char *get_protocol_name() override;
+  bool decode(RemoteReceiveData *data, uint64_t *code) override;
+  uint64_t get_code() override;
+
  protected:
-  bool matches(RemoteReceiveData *data) override;
 
   uint32_t data_;
 };
@@ -38,6 +38,7 @@ void LGTransmitter::to_data(RemoteTransmitData *data) {
 
   data->mark(BIT_HIGH_US);
 }
+bool LGTransmitter::is_data_static() { return true; }
 
 void encode_lg(RemoteTransmitData *data, uint32_t lg_data, uint8_t nbits) {
   data->set_carrier_frequency(38000);
@@ -57,19 +58,24 @@ void encode_lg(RemoteTransmitData *data, uint32_t lg_data, uint8_t nbits) {
 #endif
 
 #ifdef USE_REMOTE_RECEIVER
+/// The accepted windows of the timings, indexed by the TIMING_ constants.
+enum { TIMING_HEADER_HIGH = 0, TIMING_HEADER_LOW, TIMING_BIT_HIGH, TIMING_BIT_ONE_LOW, TIMING_BIT_ZERO_LOW };
+static RemoteTimingTable<5> lg_timings(HEADER_HIGH_US, HEADER_LOW_US, BIT_HIGH_US, BIT_ONE_LOW_US, BIT_ZERO_LOW_US);
+
 LGDecodeData decode_lg(RemoteReceiveData *data) {
+  const RemoteTimingWindow *timing = lg_timings.get(data);
   LGDecodeData out{};
   out.valid = false;
   out.data = 0;
   out.nbits = 0;
-  if (!data->expect_item(HEADER_HIGH_US, HEADER_LOW_US)) {
+  if (!data->expect_item(timing[TIMING_HEADER_HIGH], timing[TIMING_HEADER_LOW])) {
     return out;
   }
 
   for (out.nbits = 0; out.nbits < 32; out.nbits++) {
-    if (data->expect_item(BIT_HIGH_US, BIT_ONE_LOW_US)) {
+    if (data->expect_item(timing[TIMING_BIT_HIGH], timing[TIMING_BIT_ONE_LOW])) {
       out.data = (out.data << 1) | 1;
-    } else if (data->expect_item(BIT_HIGH_US, BIT_ZERO_LOW_US)) {
+    } else if (data->expect_item(timing[TIMING_BIT_HIGH], timing[TIMING_BIT_ZERO_LOW])) {
       out.data = (out.data << 1) | 0;
     } else {
       out.valid = out.nbits == 28;
@@ -84,13 +90,16 @@ LGDecodeData decode_lg(RemoteReceiveData *data) {
 LGReceiver::LGReceiver(const std::string &name, uint32_t data, uint8_t nbits)
     : RemoteReceiver(name), data_(data), nbits_(nbits) {}
 
-bool LGReceiver::matches(RemoteReceiveData *data) {
-  auto res = decode_lg(data);
-  if (!res.valid)
+const char *LGReceiver::get_protocol_name() { return "LG"; }
+bool LGReceiver::decode(RemoteReceiveData *data, uint64_t *code) {
+  auto decode = decode_lg(data);
+  if (!decode.valid)
     return false;
 
-  return this->data_ == res.data && this->nbits_ == res.nbits;
+  *code = uint64_t(decode.data) | (uint64_t(decode.nbits) << 32);
+  return true;
 }
+uint64_t LGReceiver::get_code() { return uint64_t(this->data_) | (uint64_t(this->nbits_) << 32); }
 
 bool LGDumper::dump(RemoteReceiveData *data) {
   auto res = decode_lg(data);
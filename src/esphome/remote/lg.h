@@ -18,6 +18,7 @@ class LGTransmitter : public RemoteTransmitter {
   LGTransmitter(const std::string &name, uint32_t data, uint8_t nbits);
 
   void to_data(RemoteTransmitData *data) override;
+  bool is_data_static() override;
 
  protected:
   uint32_t data_;
@@ -34,8 +35,11 @@ class LGReceiver : public RemoteReceiver {
  public:
   LGReceiver(const std::string &name, uint32_t data, uint8_t nbits);
 
+  const char *get_protocol_name() override;
+  bool decode(RemoteReceiveData *data, uint64_t *code) override;
+  uint64_t get_code() override;
+
  protected:
-  bool matches(RemoteReceiveData *data) override;
 
   uint32_t data_;
   uint8_t nbits_;
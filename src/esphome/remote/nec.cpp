@@ -44,21 +44,27 @@ void encode_nec(RemoteTransmitData *data, uint16_t address, uint16_t command) {
 NECTransmitter::NECTransmitter(const std::string &name, uint16_t address, uint16_t command)
     : RemoteTransmitter(name), address_(address), command_(command) {}
 void NECTransmitter::to_data(RemoteTransmitData *data) { encode_nec(data, this->address_, this->command_); }
+bool NECTransmitter::is_data_static() { return true; }
 #endif
 
 #ifdef USE_REMOTE_RECEIVER
+/// The accepted windows of the timings, indexed by the TIMING_ constants.
+enum { TIMING_HEADER_HIGH = 0, TIMING_HEADER_LOW, TIMING_BIT_HIGH, TIMING_BIT_ONE_LOW, TIMING_BIT_ZERO_LOW };
+static RemoteTimingTable<5> nec_timings(HEADER_HIGH_US, HEADER_LOW_US, BIT_HIGH_US, BIT_ONE_LOW_US, BIT_ZERO_LOW_US);
+
 NECDecodeData decode_nec(RemoteReceiveData *data) {
+  const RemoteTimingWindow *timing = nec_timings.get(data);
   NECDecodeData out{};
   out.valid = false;
   out.address = 0;
   out.command = 0;
-  if (!data->expect_item(HEADER_HIGH_US, HEADER_LOW_US))
+  if (!data->expect_item(timing[TIMING_HEADER_HIGH], timing[TIMING_HEADER_LOW]))
     return out;
 
   for (uint32_t mask = 1UL << 15; mask != 0; mask >>= 1) {
-    if (data->expect_item(BIT_HIGH_US, BIT_ONE_LOW_US)) {
+    if (data->expect_item(timing[TIMING_BIT_HIGH], timing[TIMING_BIT_ONE_LOW])) {
       out.address |= mask;
-    } else if (data->expect_item(BIT_HIGH_US, BIT_ZERO_LOW_US)) {
+    } else if (data->expect_item(timing[TIMING_BIT_HIGH], timing[TIMING_BIT_ZERO_LOW])) {
       out.address &= ~mask;
     } else {
       return out;
@@ -66,29 +72,32 @@ NECDecodeData decode_nec(RemoteReceiveData *data) {
   }
 
   for (uint32_t mask = 1UL << 15; mask != 0; mask >>= 1) {
-    if (data->expect_item(BIT_HIGH_US, BIT_ONE_LOW_US)) {
+    if (data->expect_item(timing[TIMING_BIT_HIGH], timing[TIMING_BIT_ONE_LOW])) {
       out.command |= mask;
-    } else if (data->expect_item(BIT_HIGH_US, BIT_ZERO_LOW_US)) {
+    } else if (data->expect_item(timing[TIMING_BIT_HIGH], timing[TIMING_BIT_ZERO_LOW])) {
       out.command &= ~mask;
     } else {
       return out;
     }
   }
 
-  data->expect_mark(BIT_HIGH_US);
+  data->expect_mark(timing[TIMING_BIT_HIGH]);
   out.valid = true;
   return out;
 }
 
 NECReceiver::NECReceiver(const std::string &name, uint16_t address, uint16_t command)
     : RemoteReceiver(name), address_(address), command_(command) {}
-bool NECReceiver::matches(RemoteReceiveData *data) {
+const char *NECReceiver::get_protocol_name() { return "NEC"; }
+bool NECReceiver::decode(RemoteReceiveData *data, uint64_t *code) {
   auto decode = decode_nec(data);
   if (!decode.valid)
     return false;
 
-  return this->address_ == decode.address && this->command_ == decode.command;
+  *code = (uint32_t(decode.address) << 16) | decode.command;
+  return true;
 }
+uint64_t NECReceiver::get_code() { return (uint32_t(this->address_) << 16) | this->command_; }
 bool NECDumper::dump(RemoteReceiveData *data) {
   auto decode = decode_nec(data);
   if (!decode.valid)
@@ -18,6 +18,7 @@ class NECTransmitter : public RemoteTransmitter {
   NECTransmitter(const std::string &name, uint16_t address, uint16_t command);
 
   void to_data(RemoteTransmitData *data) override;
+  bool is_data_static() override;
 
  protected:
   uint16_t address_;
@@ -34,8 +35,11 @@ class NECReceiver : public RemoteReceiver {
  public:
   NECReceiver(const std::string &name, uint16_t address, uint16_t command);
 
+  const char *get_protocol_name() override;
+  bool decode(RemoteReceiveData *data, uint64_t *code) override;
+  uint64_t get_code() override;
+
  protected:
-  bool matches(RemoteReceiveData *data) override;
 
   uint16_t address_;
   uint16_t command_;
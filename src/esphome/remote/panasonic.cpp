@@ -21,6 +21,7 @@ static const uint32_t BIT_ONE_LOW_US = 1244;
 
 #ifdef USE_REMOTE_TRANSMITTER
 void PanasonicTransmitter::to_data(RemoteTransmitData *data) { encode_panasonic(data, this->address_, this->command_); }
+bool PanasonicTransmitter::is_data_static() { return true; }
 
 PanasonicTransmitter::PanasonicTransmitter(const std::string &name, uint16_t address, uint32_t command)
     : RemoteTransmitter(name), address_(address), command_(command) {}
@@ -49,19 +50,25 @@ void encode_panasonic(RemoteTransmitData *data, uint16_t address, uint32_t comma
 #endif
 
 #ifdef USE_REMOTE_RECEIVER
+/// The accepted windows of the timings, indexed by the TIMING_ constants.
+enum { TIMING_HEADER_HIGH = 0, TIMING_HEADER_LOW, TIMING_BIT_HIGH, TIMING_BIT_ONE_LOW, TIMING_BIT_ZERO_LOW };
+static RemoteTimingTable<5> panasonic_timings(HEADER_HIGH_US, HEADER_LOW_US, BIT_HIGH_US, BIT_ONE_LOW_US,
+                                              BIT_ZERO_LOW_US);
+
 PanasonicDecodeData decode_panasonic(RemoteReceiveData *data) {
+  const RemoteTimingWindow *timing = panasonic_timings.get(data);
   PanasonicDecodeData out{};
   out.valid = false;
   out.address = 0;
   out.command = 0;
-  if (!data->expect_item(HEADER_HIGH_US, HEADER_LOW_US))
+  if (!data->expect_item(timing[TIMING_HEADER_HIGH], timing[TIMING_HEADER_LOW]))
     return out;
 
   uint32_t mask;
   for (mask = 1UL << 15; mask != 0; mask >>= 1) {
-    if (data->expect_item(BIT_HIGH_US, BIT_ONE_LOW_US)) {
+    if (data->expect_item(timing[TIMING_BIT_HIGH], timing[TIMING_BIT_ONE_LOW])) {
       out.address |= mask;
-    } else if (data->expect_item(BIT_HIGH_US, BIT_ZERO_LOW_US)) {
+    } else if (data->expect_item(timing[TIMING_BIT_HIGH], timing[TIMING_BIT_ZERO_LOW])) {
       out.address &= ~mask;
     } else {
       return out;
@@ -69,9 +76,9 @@ PanasonicDecodeData decode_panasonic(RemoteReceiveData *data) {
   }
 
   for (mask = 1UL << 31; mask != 0; mask >>= 1) {
-    if (data->expect_item(BIT_HIGH_US, BIT_ONE_LOW_US)) {
+    if (data->expect_item(timing[TIMING_BIT_HIGH], timing[TIMING_BIT_ONE_LOW])) {
       out.command |= mask;
-    } else if (data->expect_item(BIT_HIGH_US, BIT_ZERO_LOW_US)) {
+    } else if (data->expect_item(timing[TIMING_BIT_HIGH], timing[TIMING_BIT_ZERO_LOW])) {
       out.command &= ~mask;
     } else {
       return out;
@@ -82,11 +89,16 @@ PanasonicDecodeData decode_panasonic(RemoteReceiveData *data) {
   return out;
 }
 
-bool PanasonicReceiver::matches(RemoteReceiveData *data) {
+const char *PanasonicReceiver::get_protocol_name() { return "Panasonic"; }
+bool PanasonicReceiver::decode(RemoteReceiveData *data, uint64_t *code) {
   auto decode = decode_panasonic(data);
+  if (!decode.valid)
+    return false;
 
-  return decode.valid && this->address_ == decode.address && this->command_ == decode.command;
+  *code = (uint64_t(decode.address) << 32) | decode.command;
+  return true;
 }
+uint64_t PanasonicReceiver::get_code() { return (uint64_t(this->address_) << 32) | this->command_; }
 PanasonicReceiver::PanasonicReceiver(const std::string &name, uint16_t address, uint32_t command)
     : RemoteReceiver(name), address_(address), command_(command) {}
 
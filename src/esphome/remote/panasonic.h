@@ -18,6 +18,7 @@ class PanasonicTransmitter : public RemoteTransmitter {
   PanasonicTransmitter(const std::string &name, uint16_t address, uint32_t command);
 
   void to_data(RemoteTransmitData *data) override;
+  bool is_data_static() override;
 
  protected:
   uint16_t address_;
@@ -34,8 +35,11 @@ class PanasonicReceiver : public RemoteReceiver {
  public:
   PanasonicReceiver(const std::string &name, uint16_t address, uint32_t command);
 
+  const char *get_protocol_name() override;
+  bool decode(RemoteReceiveData *data, uint64_t *code) override;
+  uint64_t get_code() override;
+
  protected:
-  bool matches(RemoteReceiveData *data) override;
 
   uint16_t address_;
   uint32_t command_;
@@ -4,6 +4,7 @@
 
 #include "esphome/remote/raw.h"
 #include "esphome/log.h"
+#include "esphome/helpers.h"
 #include <cstdio>
 #include <utility>
 
@@ -27,19 +28,21 @@ void RawTransmitter::to_data(RemoteTransmitData *data) {
   }
   data->set_carrier_frequency(this->carrier_frequency_);
 }
+bool RawTransmitter::is_data_static() { return true; }
 RawTransmitter::RawTransmitter(const std::string &name, const int32_t *data, size_t len, uint32_t carrier_frequency)
     : RemoteTransmitter(name), data_(data), len_(len), carrier_frequency_(carrier_frequency) {}
 #endif
 
 #ifdef USE_REMOTE_RECEIVER
 bool RawDumper::dump(RemoteReceiveData *data) {
-  char buffer[256];
+  ScratchBuffer scratch(256);
+  char *buffer = scratch.data();
   uint32_t buffer_offset = 0;
   buffer_offset += sprintf(buffer, "Received Raw: ");
 
   for (int32_t i = 0; i < data->size(); i++) {
     const int32_t value = (*data)[i];
-    const uint32_t remaining_length = sizeof(buffer) - buffer_offset;
+    const uint32_t remaining_length = scratch.size() - buffer_offset;
     int written;
 
     if (i + 1 < data->size()) {
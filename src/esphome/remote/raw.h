@@ -18,6 +18,7 @@ class RawTransmitter : public RemoteTransmitter {
   RawTransmitter(const std::string &name, const int32_t *data, size_t len, uint32_t carrier_frequency = 0);
 
   void to_data(RemoteTransmitData *data) override;
+  bool is_data_static() override;
 
  protected:
   const int32_t *data_;
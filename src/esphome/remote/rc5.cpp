@@ -47,21 +47,25 @@ void encode_rc5(RemoteTransmitData *data, uint8_t address, uint8_t command, bool
 #endif
 
 #ifdef USE_REMOTE_RECEIVER
+/// The accepted window of the bit time.
+static RemoteTimingTable<1> rc5_timings(BIT_TIME_US);
+
 RC5DecodeData decode_rc5(RemoteReceiveData *data) {
+  const RemoteTimingWindow &bit_time = rc5_timings.get(data)[0];
   RC5DecodeData out{};
   out.valid = false;
   out.address = 0;
   out.command = 0;
-  data->expect_space(BIT_TIME_US);
-  if (!data->expect_mark(BIT_TIME_US) || !data->expect_space(BIT_TIME_US) || !data->expect_mark(BIT_TIME_US)) {
+  data->expect_space(bit_time);
+  if (!data->expect_mark(bit_time) || !data->expect_space(bit_time) || !data->expect_mark(bit_time)) {
     return out;
   }
 
   uint64_t out_data = 0;
   for (int bit = NBITS - 3; bit >= 0; bit--) {
-    if (data->expect_space(BIT_TIME_US) && data->expect_mark(BIT_TIME_US)) {
+    if (data->expect_space(bit_time) && data->expect_mark(bit_time)) {
       out_data |= 1 << bit;
-    } else if (data->expect_mark(BIT_TIME_US) && data->expect_space(BIT_TIME_US)) {
+    } else if (data->expect_mark(bit_time) && data->expect_space(bit_time)) {
       out_data |= 0 << bit;
     } else {
       out.valid = false;
@@ -78,13 +82,16 @@ RC5DecodeData decode_rc5(RemoteReceiveData *data) {
 RC5Receiver::RC5Receiver(const std::string &name, uint8_t address, uint8_t command)
     : RemoteReceiver(name), address_(address), command_(command) {}
 
-bool RC5Receiver::matches(RemoteReceiveData *data) {
-  auto res = decode_rc5(data);
-  if (!res.valid)
+const char *RC5Receiver::get_protocol_name() { return "RC5"; }
+bool RC5Receiver::decode(RemoteReceiveData *data, uint64_t *code) {
+  auto decode = decode_rc5(data);
+  if (!decode.valid)
     return false;
 
-  return this->address_ == res.address && this->command_ == res.command;
+  *code = (uint32_t(decode.address) << 8) | decode.command;
+  return true;
 }
+uint64_t RC5Receiver::get_code() { return (uint32_t(this->address_) << 8) | this->command_; }
 
 bool RC5Dumper::dump(RemoteReceiveData *data) {
   auto res = decode_rc5(data);
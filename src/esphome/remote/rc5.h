@@ -35,8 +35,11 @@ class RC5Receiver : public RemoteReceiver {
  public:
   RC5Receiver(const std::string &name, uint8_t address, uint8_t command);
 
+  const char *get_protocol_name() override;
+  bool decode(RemoteReceiveData *data, uint64_t *code) override;
+  uint64_t get_code() override;
+
  protected:
-  bool matches(RemoteReceiveData *data) override;
 
   uint8_t address_;
   uint8_t command_;
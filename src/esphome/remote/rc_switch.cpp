@@ -20,6 +20,7 @@ RCSwitchRawTransmitter::RCSwitchRawTransmitter(const std::string &name, RCSwitch
 void RCSwitchRawTransmitter::to_data(RemoteTransmitData *data) {
   this->protocol_.transmit(data, this->code_, this->nbits_);
 }
+bool RCSwitchRawTransmitter::is_data_static() { return true; }
 
 void encode_rc_switch_raw(RemoteTransmitData *data, uint32_t code, uint8_t nbits, RCSwitchProtocol protocol) {
   protocol.transmit(data, code, nbits);
@@ -138,14 +139,23 @@ void encode_rc_switch_type_d(RemoteTransmitData *data, char group, uint8_t devic
 RCSwitchRawReceiver::RCSwitchRawReceiver(const std::string &name, RCSwitchProtocol a_protocol, uint32_t code,
                                          uint8_t nbits)
     : RemoteReceiver(name), protocol_(a_protocol), code_(code), nbits_(nbits) {}
-bool RCSwitchRawReceiver::matches(RemoteReceiveData *data) {
+const char *RCSwitchRawReceiver::get_protocol_name() { return "RCSwitch"; }
+bool RCSwitchRawReceiver::has_same_decoder(RemoteReceiver *other) {
+  if (!RemoteReceiver::has_same_decoder(other))
+    return false;
+  // same protocol name, so other is an RCSwitchRawReceiver too
+  return this->protocol_ == static_cast<RCSwitchRawReceiver *>(other)->protocol_;
+}
+bool RCSwitchRawReceiver::decode(RemoteReceiveData *data, uint64_t *code) {
   uint32_t decoded_code;
   uint8_t decoded_nbits;
   if (!this->protocol_.decode(data, &decoded_code, &decoded_nbits))
     return false;
 
-  return decoded_nbits == this->nbits_ && decoded_code == this->code_;
+  *code = uint64_t(decoded_code) | (uint64_t(decoded_nbits) << 32);
+  return true;
 }
+uint64_t RCSwitchRawReceiver::get_code() { return uint64_t(this->code_) | (uint64_t(this->nbits_) << 32); }
 RCSwitchTypeAReceiver::RCSwitchTypeAReceiver(const std::string &name, RCSwitchProtocol a_protocol, uint8_t switch_group,
                                              uint8_t switch_device, bool state)
     : RCSwitchRawReceiver(name, a_protocol, 0, 0) {
@@ -19,6 +19,7 @@ class RCSwitchRawTransmitter : public RemoteTransmitter {
   RCSwitchRawTransmitter(const std::string &name, RCSwitchProtocol a_protocol, uint32_t code, uint8_t nbits);
 
   void to_data(RemoteTransmitData *data) override;
+  bool is_data_static() override;
 
  protected:
   RCSwitchProtocol protocol_;
@@ -87,8 +88,12 @@ class RCSwitchRawReceiver : public RemoteReceiver {
  public:
   RCSwitchRawReceiver(const std::string &name, RCSwitchProtocol a_protocol, uint32_t code, uint8_t nbits);
 
+  const char *get_protocol_name() override;
+  bool has_same_decoder(RemoteReceiver *other) override;
+  bool decode(RemoteReceiveData *data, uint64_t *code) override;
+  uint64_t get_code() override;
+
  protected:
-  bool matches(RemoteReceiveData *data) override;
 
   RCSwitchProtocol protocol_;
   uint32_t code_;
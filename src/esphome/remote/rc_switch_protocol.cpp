@@ -9,6 +9,17 @@ ESPHOME_NAMESPACE_BEGIN
 
 namespace remote {
 
+#ifdef USE_REMOTE_RECEIVER
+enum {
+  RC_SWITCH_TIMING_SYNC_HIGH = 0,
+  RC_SWITCH_TIMING_SYNC_LOW,
+  RC_SWITCH_TIMING_ZERO_HIGH,
+  RC_SWITCH_TIMING_ZERO_LOW,
+  RC_SWITCH_TIMING_ONE_HIGH,
+  RC_SWITCH_TIMING_ONE_LOW,
+};
+#endif
+
 RCSwitchProtocol rc_switch_protocols[8] = {RCSwitchProtocol(0, 0, 0, 0, 0, 0, false),
                                            RCSwitchProtocol(350, 10850, 350, 1050, 1050, 350, false),
                                            RCSwitchProtocol(650, 6500, 650, 1300, 1300, 650, false),
@@ -26,7 +37,16 @@ RCSwitchProtocol::RCSwitchProtocol(uint32_t sync_high, uint32_t sync_low, uint32
       zero_low_(zero_low),
       one_high_(one_high),
       one_low_(one_low),
-      inverted_(inverted) {}
+      inverted_(inverted) {
+#ifdef USE_REMOTE_RECEIVER
+  this->timings_ = RemoteTimingTable<6>(sync_high, sync_low, zero_high, zero_low, one_high, one_low);
+#endif
+}
+bool RCSwitchProtocol::operator==(const RCSwitchProtocol &other) const {
+  return this->sync_high_ == other.sync_high_ && this->sync_low_ == other.sync_low_ &&
+         this->zero_high_ == other.zero_high_ && this->zero_low_ == other.zero_low_ &&
+         this->one_high_ == other.one_high_ && this->one_low_ == other.one_low_ && this->inverted_ == other.inverted_;
+}
 
 #ifdef USE_REMOTE_TRANSMITTER
 void RCSwitchProtocol::one(RemoteTransmitData *data) const {
@@ -69,45 +89,54 @@ void RCSwitchProtocol::transmit(RemoteTransmitData *data, uint32_t code, uint8_t
 
 #ifdef USE_REMOTE_RECEIVER
 bool RCSwitchProtocol::expect_one(RemoteReceiveData *data) const {
+  const RemoteTimingWindow *timing = this->timings_.get(data);
+  const RemoteTimingWindow &high = timing[RC_SWITCH_TIMING_ONE_HIGH];
+  const RemoteTimingWindow &low = timing[RC_SWITCH_TIMING_ONE_LOW];
   if (!this->inverted_) {
-    if (!data->peek_mark(this->one_high_))
+    if (!data->peek_mark(high))
       return false;
-    if (!data->peek_space(this->one_low_, 1))
+    if (!data->peek_space(low, 1))
       return false;
   } else {
-    if (!data->peek_space(this->one_high_))
+    if (!data->peek_space(high))
       return false;
-    if (!data->peek_mark(this->one_low_, 1))
+    if (!data->peek_mark(low, 1))
       return false;
   }
   data->advance(2);
   return true;
 }
 bool RCSwitchProtocol::expect_zero(RemoteReceiveData *data) const {
+  const RemoteTimingWindow *timing = this->timings_.get(data);
+  const RemoteTimingWindow &high = timing[RC_SWITCH_TIMING_ZERO_HIGH];
+  const RemoteTimingWindow &low = timing[RC_SWITCH_TIMING_ZERO_LOW];
   if (!this->inverted_) {
-    if (!data->peek_mark(this->zero_high_))
+    if (!data->peek_mark(high))
       return false;
-    if (!data->peek_space(this->zero_low_, 1))
+    if (!data->peek_space(low, 1))
       return false;
   } else {
-    if (!data->peek_space(this->zero_high_))
+    if (!data->peek_space(high))
       return false;
-    if (!data->peek_mark(this->zero_low_, 1))
+    if (!data->peek_mark(low, 1))
       return false;
   }
   data->advance(2);
   return true;
 }
 bool RCSwitchProtocol::expect_sync(RemoteReceiveData *data) const {
+  const RemoteTimingWindow *timing = this->timings_.get(data);
+  const RemoteTimingWindow &high = timing[RC_SWITCH_TIMING_SYNC_HIGH];
+  const RemoteTimingWindow &low = timing[RC_SWITCH_TIMING_SYNC_LOW];
   if (!this->inverted_) {
-    if (!data->peek_mark(this->sync_high_))
+    if (!data->peek_mark(high))
       return false;
-    if (!data->peek_space(this->sync_low_, 1))
+    if (!data->peek_space(low, 1))
       return false;
   } else {
-    if (!data->peek_space(this->sync_high_))
+    if (!data->peek_space(high))
       return false;
-    if (!data->peek_mark(this->sync_low_, 1))
+    if (!data->peek_mark(low, 1))
       return false;
   }
   data->advance(2);
@@ -6,6 +6,7 @@
 #ifdef USE_REMOTE
 
 #include "esphome/component.h"
+#include "esphome/remote/remote_protocol.h"
 
 ESPHOME_NAMESPACE_BEGIN
 
@@ -19,6 +20,9 @@ class RCSwitchProtocol {
   RCSwitchProtocol(uint32_t sync_high, uint32_t sync_low, uint32_t zero_high, uint32_t zero_low, uint32_t one_high,
                    uint32_t one_low, bool inverted);
 
+  /// Whether both protocols have the same timings, and thus encode and decode codes the same way.
+  bool operator==(const RCSwitchProtocol &other) const;
+
 #ifdef USE_REMOTE_TRANSMITTER
   void one(RemoteTransmitData *data) const;
 
@@ -60,6 +64,10 @@ class RCSwitchProtocol {
   uint32_t one_high_;
   uint32_t one_low_;
   bool inverted_;
+#ifdef USE_REMOTE_RECEIVER
+  /// The accepted windows of the timings, indexed by the RC_SWITCH_TIMING_ constants.
+  mutable RemoteTimingTable<6> timings_;
+#endif
 };
 
 extern RCSwitchProtocol rc_switch_protocols[8];
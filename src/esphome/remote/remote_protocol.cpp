@@ -27,6 +27,18 @@ uint32_t RemoteControlComponentBase::to_microseconds(uint32_t ticks) {
 }
 void RemoteControlComponentBase::set_channel(rmt_channel_t channel) { this->channel_ = channel; }
 void RemoteControlComponentBase::set_clock_divider(uint8_t clock_divider) { this->clock_divider_ = clock_divider; }
+void RemoteControlComponentBase::set_memory_blocks(uint8_t memory_blocks) {
+  if (next_rmt_channel == rmt_channel_t(int(this->channel_) + this->memory_blocks_))  // NOLINT
+    next_rmt_channel = rmt_channel_t(int(this->channel_) + memory_blocks);          // NOLINT
+  this->memory_blocks_ = memory_blocks;
+}
+bool RemoteControlComponentBase::check_memory_blocks_() {
+  if (this->memory_blocks_ == 0 || int(this->channel_) + this->memory_blocks_ > RMT_CHANNEL_MAX) {
+    this->error_code_ = ESP_ERR_INVALID_ARG;
+    return false;
+  }
+  return true;
+}
 #endif
 
 }  // namespace remote
@@ -17,6 +17,35 @@ ESPHOME_NAMESPACE_BEGIN
 
 namespace remote {
 
+#ifdef USE_REMOTE_RECEIVER
+class RemoteReceiveData;
+
+/// The range of durations in µs that are accepted for one timing of a protocol.
+struct RemoteTimingWindow {
+  uint32_t lo;
+  uint32_t hi;
+};
+
+/** The accepted windows of N timings of a protocol, computed once for the tolerance of the receiver.
+ *
+ * Decoders get the windows once per frame and compare each duration against them, instead of applying the
+ * tolerance to the timings for every bit.
+ */
+template<size_t N> class RemoteTimingTable {
+ public:
+  template<typename... Ts> explicit RemoteTimingTable(Ts... lengths) : lengths_{uint32_t(lengths)...} {}
+
+  /// Get the windows for the tolerance of data's receiver, they're only recomputed when the tolerance changed.
+  const RemoteTimingWindow *get(RemoteReceiveData *data);
+
+ protected:
+  uint32_t lengths_[N];
+  RemoteTimingWindow windows_[N];
+  /// The tolerance the windows were computed for, 0xFF if they weren't computed yet.
+  uint8_t tolerance_{0xFF};
+};
+#endif
+
 class RemoteControlComponentBase {
  public:
   explicit RemoteControlComponentBase(GPIOPin *pin);
@@ -24,18 +53,27 @@ class RemoteControlComponentBase {
 #ifdef ARDUINO_ARCH_ESP32
   void set_channel(rmt_channel_t channel);
   void set_clock_divider(uint8_t clock_divider);
+  /** Set how many of the 64-item RMT memory blocks the channel uses, from 1 to 8.
+   *
+   * A channel with more than one block also uses the memory of the channels after it, which can then not be
+   * used anymore. If this component got the most recently selected channel, those channels are reserved.
+   */
+  void set_memory_blocks(uint8_t memory_blocks);
 #endif
 
  protected:
 #ifdef ARDUINO_ARCH_ESP32
   uint32_t from_microseconds(uint32_t us);
   uint32_t to_microseconds(uint32_t ticks);
+  /// Whether the memory blocks fit after the channel, sets error_code_ if they don't.
+  bool check_memory_blocks_();
 #endif
 
   GPIOPin *pin_;
 #ifdef ARDUINO_ARCH_ESP32
   rmt_channel_t channel_{RMT_CHANNEL_0};
   uint8_t clock_divider_{80};
+  uint8_t memory_blocks_{1};
   esp_err_t error_code_{ESP_OK};
 #endif
 };
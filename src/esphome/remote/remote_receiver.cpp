@@ -2,8 +2,11 @@
 
 #ifdef USE_REMOTE_RECEIVER
 
+#include <algorithm>
+#include <cstring>
 #include "esphome/remote/remote_receiver.h"
 #include "esphome/log.h"
+#include "esphome/tracer.h"
 #include "esphome/remote/jvc.h"
 #include "esphome/remote/nec.h"
 #include "esphome/remote/lg.h"
@@ -25,48 +28,63 @@ static const char *TAG = "remote.receiver";
 
 RemoteReceiveData::RemoteReceiveData(RemoteReceiverComponent *parent, std::vector<int32_t> *data)
     : parent_(parent), data_(data) {}
+#ifdef ARDUINO_ARCH_ESP8266
+RemoteReceiveData::RemoteReceiveData(RemoteReceiverComponent *parent, const RemoteReceiverComponentStore *store,
+                                     uint32_t start, uint32_t size)
+    : parent_(parent), store_(store), start_(start), size_(size) {}
+#endif
 
-uint32_t RemoteReceiveData::lower_bound_(uint32_t length) {
-  return uint32_t(100 - this->parent_->tolerance_) * length / 100U;
-}
-uint32_t RemoteReceiveData::upper_bound_(uint32_t length) {
-  return uint32_t(100 + this->parent_->tolerance_) * length / 100U;
+uint8_t RemoteReceiveData::get_tolerance() const { return this->parent_->tolerance_; }
+RemoteTimingWindow RemoteReceiveData::get_window(uint32_t length) const {
+  const uint32_t tolerance = this->parent_->tolerance_;
+  return RemoteTimingWindow{(100 - tolerance) * length / 100U, (100 + tolerance) * length / 100U};
 }
 bool RemoteReceiveData::peek_mark(uint32_t length, uint32_t offset) {
+  return this->peek_mark(this->get_window(length), offset);
+}
+bool RemoteReceiveData::peek_mark(const RemoteTimingWindow &window, uint32_t offset) {
   if (int32_t(this->index_ + offset) >= this->size())
     return false;
-  int32_t value = this->peek(offset);
-  const int32_t lo = this->lower_bound_(length);
-  const int32_t hi = this->upper_bound_(length);
-  return value >= 0 && lo <= value && value <= hi;
+  const int32_t value = this->peek(offset);
+  return value >= 0 && window.lo <= uint32_t(value) && uint32_t(value) <= window.hi;
 }
 bool RemoteReceiveData::peek_space(uint32_t length, uint32_t offset) {
+  return this->peek_space(this->get_window(length), offset);
+}
+bool RemoteReceiveData::peek_space(const RemoteTimingWindow &window, uint32_t offset) {
   if (int32_t(this->index_ + offset) >= this->size())
     return false;
-  int32_t value = this->peek(offset);
-  const int32_t lo = this->lower_bound_(length);
-  const int32_t hi = this->upper_bound_(length);
-  return value <= 0 && lo <= -value && -value <= hi;
+  const int32_t value = this->peek(offset);
+  return value <= 0 && window.lo <= uint32_t(-value) && uint32_t(-value) <= window.hi;
 }
 bool RemoteReceiveData::peek_item(uint32_t mark, uint32_t space, uint32_t offset) {
   return this->peek_mark(mark, offset) && this->peek_space(space, offset + 1);
 }
+bool RemoteReceiveData::peek_item(const RemoteTimingWindow &mark, const RemoteTimingWindow &space,
+                                  uint32_t offset) {
+  return this->peek_mark(mark, offset) && this->peek_space(space, offset + 1);
+}
 void RemoteReceiveData::advance(uint32_t amount) { this->index_ += amount; }
-bool RemoteReceiveData::expect_mark(uint32_t length) {
-  if (this->peek_mark(length)) {
+bool RemoteReceiveData::expect_mark(uint32_t length) { return this->expect_mark(this->get_window(length)); }
+bool RemoteReceiveData::expect_mark(const RemoteTimingWindow &window) {
+  if (this->peek_mark(window)) {
     this->advance();
     return true;
   }
   return false;
 }
-bool RemoteReceiveData::expect_space(uint32_t length) {
-  if (this->peek_space(length)) {
+bool RemoteReceiveData::expect_space(uint32_t length) { return this->expect_space(this->get_window(length)); }
+bool RemoteReceiveData::expect_space(const RemoteTimingWindow &window) {
+  if (this->peek_space(window)) {
     this->advance();
     return true;
   }
   return false;
 }
 bool RemoteReceiveData::expect_item(uint32_t mark, uint32_t space) {
+  return this->expect_item(this->get_window(mark), this->get_window(space));
+}
+bool RemoteReceiveData::expect_item(const RemoteTimingWindow &mark, const RemoteTimingWindow &space) {
   if (this->peek_item(mark, space)) {
     this->advance(2);
     return true;
@@ -76,16 +94,42 @@ bool RemoteReceiveData::expect_item(uint32_t mark, uint32_t space) {
 void RemoteReceiveData::reset_index() { this->index_ = 0; }
 int32_t RemoteReceiveData::peek(uint32_t offset) { return (*this)[this->index_ + offset]; }
 bool RemoteReceiveData::peek_space_at_least(uint32_t length, uint32_t offset) {
+  return this->peek_space_at_least(this->get_window(length), offset);
+}
+bool RemoteReceiveData::peek_space_at_least(const RemoteTimingWindow &window, uint32_t offset) {
   if (int32_t(this->index_ + offset) >= this->size())
     return false;
-  int32_t value = this->pos(this->index_ + offset);
-  const int32_t lo = this->lower_bound_(length);
-  return value <= 0 && lo <= -value;
+  const int32_t value = this->pos(this->index_ + offset);
+  return value <= 0 && window.lo <= uint32_t(-value);
 }
 int32_t RemoteReceiveData::operator[](uint32_t index) const { return this->pos(index); }
-int32_t RemoteReceiveData::pos(uint32_t index) const { return (*this->data_)[index]; }
+int32_t RemoteReceiveData::pos(uint32_t index) const {
+#ifdef ARDUINO_ARCH_ESP8266
+  if (this->data_ == nullptr) {
+    // the edge at an even index is a falling edge, so the duration up to it is a mark
+    const int32_t multiplier = (this->start_ + index + 1) % 2 == 0 ? 1 : -1;
+    if (index + 1 == this->size_)
+      // the frame ends with the idle space
+      return int32_t(this->parent_->idle_us_) * multiplier;
+
+    const uint32_t buffer_size = this->store_->buffer_size;
+    uint32_t at = this->start_ + index;
+    if (at >= buffer_size)
+      at -= buffer_size;
+    const uint32_t next = at + 1 == buffer_size ? 0 : at + 1;
+    return int32_t(this->store_->buffer[next] - this->store_->buffer[at]) * multiplier;
+  }
+#endif
+  return (*this->data_)[index];
+}
 
-int32_t RemoteReceiveData::size() const { return this->data_->size(); }
+int32_t RemoteReceiveData::size() const {
+#ifdef ARDUINO_ARCH_ESP8266
+  if (this->data_ == nullptr)
+    return this->size_;
+#endif
+  return this->data_->size();
+}
 JVCDecodeData RemoteReceiveData::decode_jvc() { return remote::decode_jvc(this); }
 LGDecodeData RemoteReceiveData::decode_lg() { return remote::decode_lg(this); }
 NECDecodeData RemoteReceiveData::decode_nec() { return remote::decode_nec(this); }
@@ -96,15 +140,26 @@ SonyDecodeData RemoteReceiveData::decode_sony() { return remote::decode_sony(thi
 RemoteReceiverComponent::RemoteReceiverComponent(GPIOPin *pin) : RemoteControlComponentBase(pin) {}
 
 float RemoteReceiverComponent::get_setup_priority() const { return setup_priority::HARDWARE_LATE; }
+float RemoteReceiverComponent::get_loop_priority() const {
+  return 5.0f;  // decode received codes before other loop components, also when the loop budget is used up
+}
 
 #ifdef ARDUINO_ARCH_ESP32
+/// The largest idle threshold the RMT peripheral can measure, in ticks.
+static const uint32_t RMT_MAX_IDLE_TICKS = 32767;
+
 void RemoteReceiverComponent::setup() {
   ESP_LOGCONFIG(TAG, "Setting up Remote Receiver...");
+  if (!this->check_memory_blocks_()) {
+    this->mark_failed();
+    return;
+  }
+
   rmt_config_t rmt{};
   rmt.channel = this->channel_;
   rmt.gpio_num = gpio_num_t(this->pin_->get_pin());
   rmt.clk_div = this->clock_divider_;
-  rmt.mem_block_num = 1;
+  rmt.mem_block_num = this->memory_blocks_;
   rmt.rmt_mode = RMT_MODE_RX;
   if (this->filter_us_ == 0) {
     rmt.rx_config.filter_en = false;
@@ -112,7 +167,9 @@ void RemoteReceiverComponent::setup() {
     rmt.rx_config.filter_en = true;
     rmt.rx_config.filter_ticks_thresh = this->from_microseconds(this->filter_us_);
   }
-  rmt.rx_config.idle_threshold = this->from_microseconds(this->idle_us_);
+  const uint32_t idle_ticks = std::min(this->from_microseconds(this->idle_us_), RMT_MAX_IDLE_TICKS);
+  rmt.rx_config.idle_threshold = idle_ticks;
+  this->rmt_idle_us_ = this->to_microseconds(idle_ticks);
 
   esp_err_t error = rmt_config(&rmt);
   if (error != ESP_OK) {
@@ -145,9 +202,17 @@ void RemoteReceiverComponent::dump_config() {
   LOG_PIN("  Pin: ", this->pin_);
   ESP_LOGCONFIG(TAG, "  Channel: %d", this->channel_);
   ESP_LOGCONFIG(TAG, "  Clock divider: %u", this->clock_divider_);
+  ESP_LOGCONFIG(TAG, "  Memory blocks: %u (%u items)", this->memory_blocks_, this->memory_blocks_ * 64u);
+  ESP_LOGCONFIG(TAG, "  Buffer Size: %u", this->buffer_size_);
   ESP_LOGCONFIG(TAG, "  Tolerance: %u%%", this->tolerance_);
   ESP_LOGCONFIG(TAG, "  Filter out pulses shorter than: %u us", this->filter_us_);
   ESP_LOGCONFIG(TAG, "  Signal is done after %u us of no changes", this->idle_us_);
+  if (this->continuous_) {
+    ESP_LOGCONFIG(TAG, "  Continuous: YES (hardware idle after %u us)", this->rmt_idle_us_);
+  } else if (this->rmt_idle_us_ < this->idle_us_) {
+    ESP_LOGW(TAG, "  Idle time is longer than the RMT can measure, frames are split after %u us!",
+             this->rmt_idle_us_);
+  }
   if (this->is_failed()) {
     ESP_LOGE(TAG, "Configuring RMT driver failed: %s", esp_err_to_name(this->error_code_));
   }
@@ -161,73 +226,74 @@ void RemoteReceiverComponent::loop() {
   size_t len = 0;
   auto *item = (rmt_item32_t *) xRingbufferReceive(this->ringbuf_, &len, 0);
   if (item != nullptr) {
-    this->decode_rmt_(item, len);
+    // len is in bytes
+    const bool stitch = this->continuous_ && !this->temp_.empty();
+    if (stitch) {
+      // the chunks were separated by at least the hardware idle time
+      this->push_duration_(-int32_t(this->rmt_idle_us_));
+    } else {
+      this->temp_.clear();
+    }
+    this->decode_rmt_(item, len / sizeof(rmt_item32_t));
+    // converted right away so that the RMT driver can reuse the ring buffer space
     vRingbufferReturnItem(this->ringbuf_, item);
+    this->last_chunk_at_ = micros();
 
-    if (this->temp_.empty())
-      return;
+    if (!this->continuous_ || this->rmt_idle_us_ >= this->idle_us_)
+      this->process_frame_();
+    return;
+  }
 
-    RemoteReceiveData data(this, &this->temp_);
-    this->process_(&data);
+  // continuous mode, the frame is done once no chunk has followed for the rest of the idle time
+  if (!this->temp_.empty() && micros() - this->last_chunk_at_ >= this->idle_us_ - this->rmt_idle_us_)
+    this->process_frame_();
+}
+void RemoteReceiverComponent::process_frame_() {
+  if (this->temp_.empty())
+    return;
+  RemoteReceiveData data(this, &this->temp_);
+  this->process_(&data);
+  this->temp_.clear();
+}
+void RemoteReceiverComponent::push_duration_(int32_t value) {
+  // merge with the previous duration if it has the same level, for example a space across chunks
+  if (!this->temp_.empty() && (this->temp_.back() < 0) == (value < 0)) {
+    this->temp_.back() += value;
+    return;
   }
+  this->temp_.push_back(value);
 }
 void RemoteReceiverComponent::decode_rmt_(rmt_item32_t *item, size_t len) {
-  bool prev_level = false;
-  uint32_t prev_length = 0;
-  this->temp_.clear();
   int32_t multiplier = this->pin_->is_inverted() ? -1 : 1;
 
+#ifdef ESPHOME_LOG_HAS_VERY_VERBOSE
   ESP_LOGVV(TAG, "START:");
   for (size_t i = 0; i < len; i++) {
-    if (item[i].level0) {
-      ESP_LOGVV(TAG, "%u A: ON %uus (%u ticks)", i, this->to_microseconds(item[i].duration0), item[i].duration0);
-    } else {
-      ESP_LOGVV(TAG, "%u A: OFF %uus (%u ticks)", i, this->to_microseconds(item[i].duration0), item[i].duration0);
-    }
-    if (item[i].level1) {
-      ESP_LOGVV(TAG, "%u B: ON %uus (%u ticks)", i, this->to_microseconds(item[i].duration1), item[i].duration1);
-    } else {
-      ESP_LOGVV(TAG, "%u B: OFF %uus (%u ticks)", i, this->to_microseconds(item[i].duration1), item[i].duration1);
-    }
+    ESP_LOGVV(TAG, "%u A: %s %uus (%u ticks)", i, item[i].level0 ? "ON" : "OFF",
+              this->to_microseconds(item[i].duration0), item[i].duration0);
+    ESP_LOGVV(TAG, "%u B: %s %uus (%u ticks)", i, item[i].level1 ? "ON" : "OFF",
+              this->to_microseconds(item[i].duration1), item[i].duration1);
   }
   ESP_LOGVV(TAG, "\n");
+#endif
 
-  this->temp_.reserve(len / 4);
-  for (size_t i = 0; i < len; i++) {
-    if (item[i].duration0 == 0u) {
-      // Do nothing
-    } else if (bool(item[i].level0) == prev_level) {
-      prev_length += item[i].duration0;
-    } else {
-      if (prev_length > 0) {
-        if (prev_level) {
-          this->temp_.push_back(this->to_microseconds(prev_length) * multiplier);
-        } else {
-          this->temp_.push_back(-int32_t(this->to_microseconds(prev_length)) * multiplier);
-        }
-      }
-      prev_level = bool(item[i].level0);
-      prev_length = item[i].duration0;
-    }
-
-    if (this->to_microseconds(prev_length) > this->idle_us_) {
-      break;
-    }
-
-    if (item[i].duration1 == 0u) {
+  this->temp_.reserve(this->temp_.size() + len * 2);
+  bool prev_level = false;
+  uint32_t prev_length = 0;
+  for (size_t i = 0; i < len * 2; i++) {
+    const bool level = i % 2 == 0 ? item[i / 2].level0 : item[i / 2].level1;
+    const uint32_t duration = i % 2 == 0 ? item[i / 2].duration0 : item[i / 2].duration1;
+    if (duration == 0u) {
       // Do nothing
-    } else if (bool(item[i].level1) == prev_level) {
-      prev_length += item[i].duration1;
+    } else if (level == prev_level) {
+      prev_length += duration;
     } else {
       if (prev_length > 0) {
-        if (prev_level) {
-          this->temp_.push_back(this->to_microseconds(prev_length) * multiplier);
-        } else {
-          this->temp_.push_back(-int32_t(this->to_microseconds(prev_length)) * multiplier);
-        }
+        const int32_t value = this->to_microseconds(prev_length);
+        this->push_duration_((prev_level ? value : -value) * multiplier);
       }
-      prev_level = bool(item[i].level1);
-      prev_length = item[i].duration1;
+      prev_level = level;
+      prev_length = duration;
     }
 
     if (this->to_microseconds(prev_length) > this->idle_us_) {
@@ -235,11 +301,8 @@ void RemoteReceiverComponent::decode_rmt_(rmt_item32_t *item, size_t len) {
     }
   }
   if (prev_length > 0) {
-    if (prev_level) {
-      this->temp_.push_back(this->to_microseconds(prev_length) * multiplier);
-    } else {
-      this->temp_.push_back(-int32_t(this->to_microseconds(prev_length)) * multiplier);
-    }
+    const int32_t value = this->to_microseconds(prev_length);
+    this->push_duration_((prev_level ? value : -value) * multiplier);
   }
 }
 #endif
@@ -248,19 +311,29 @@ void RemoteReceiverComponent::decode_rmt_(rmt_item32_t *item, size_t len) {
 
 void ICACHE_RAM_ATTR HOT RemoteReceiverComponentStore::gpio_intr(RemoteReceiverComponentStore *arg) {
   const uint32_t now = micros();
+  TRACE_BEGIN(ISR, "remote_receiver");
+  arg->record_edge(now);
+  TRACE_END(ISR, "remote_receiver");
+}
+void ICACHE_RAM_ATTR HOT RemoteReceiverComponentStore::record_edge(uint32_t now) {
+  const uint32_t write_at = this->buffer_write_at;
   // If the lhs is 1 (rising edge) we should write to an uneven index and vice versa
-  const uint32_t next = (arg->buffer_write_at + 1) % arg->buffer_size;
-  if (uint32_t(arg->pin->digital_read()) != next % 2)
+  const uint32_t next = write_at + 1 == this->buffer_size ? 0 : write_at + 1;
+  if (uint32_t(this->pin->digital_read()) != next % 2)
     return;
-  const uint32_t last_change = arg->buffer[arg->buffer_write_at];
-  if (now - last_change <= arg->filter_us)
+  const uint32_t last_change = this->buffer[write_at];
+  if (now - last_change <= this->filter_us)
     return;
 
-  arg->buffer[arg->buffer_write_at = next] = now;
-
-  if (next == arg->buffer_read_at) {
-    arg->overflow = true;
+  if (next == this->buffer_read_at) {
+    // full, the slot still holds the start of the frame loop() is working on
+    this->overflow_count++;
+    return;
   }
+
+  this->buffer[next] = now;
+  // publish the slot only after it's written
+  this->buffer_write_at = next;
 }
 
 void RemoteReceiverComponent::setup() {
@@ -295,7 +368,8 @@ void RemoteReceiverComponent::dump_config() {
     ESP_LOGW(TAG, "Remote Receiver Signal starts with a HIGH value. Usually this means you have to "
                   "invert the signal using 'inverted: True' in the pin schema!");
   }
-  ESP_LOGCONFIG(TAG, "  Buffer Size: %u", this->buffer_size_);
+  ESP_LOGCONFIG(TAG, "  Buffer Size: %u (peak usage %u, %u edges dropped)", this->store_.buffer_size,
+                this->buffer_peak_usage_, this->store_.overflow_count);
   ESP_LOGCONFIG(TAG, "  Tolerance: %u%%", this->tolerance_);
   ESP_LOGCONFIG(TAG, "  Filter out pulses shorter than: %u us", this->filter_us_);
   ESP_LOGCONFIG(TAG, "  Signal is done after %u us of no changes", this->idle_us_);
@@ -307,16 +381,22 @@ void RemoteReceiverComponent::dump_config() {
 
 void RemoteReceiverComponent::loop() {
   auto &s = this->store_;
-  if (s.overflow) {
+  const uint32_t overflow_count = s.overflow_count;
+  if (overflow_count != this->last_overflow_count_) {
+    // the frame that is being received is missing edges, drop everything received so far
     s.buffer_read_at = s.buffer_write_at;
-    s.overflow = false;
-    ESP_LOGW(TAG, "Data is coming in too fast! Try increasing the buffer size.");
+    this->last_overflow_count_ = overflow_count;
+    ESP_LOGW(TAG, "Data is coming in too fast! Try increasing the buffer size (%u edges dropped so far).",
+             overflow_count);
     return;
   }
 
   // copy write at to local variables, as it's volatile
   const uint32_t write_at = s.buffer_write_at;
-  const uint32_t dist = (s.buffer_size + write_at - s.buffer_read_at) % s.buffer_size;
+  const uint32_t read_at = s.buffer_read_at;
+  const uint32_t dist = (s.buffer_size + write_at - read_at) % s.buffer_size;
+  if (dist > this->buffer_peak_usage_)
+    this->buffer_peak_usage_ = dist;
   // signals must at least one rising and one leading edge
   if (dist <= 1)
     return;
@@ -326,42 +406,43 @@ void RemoteReceiverComponent::loop() {
     // TODO: Handle case when loop() is not called quickly enough to catch idle
     return;
 
-  ESP_LOGVV(TAG, "read_at=%u write_at=%u dist=%u now=%u end=%u", s.buffer_read_at, write_at, dist, now,
-            s.buffer[write_at]);
+  ESP_LOGVV(TAG, "read_at=%u write_at=%u dist=%u now=%u end=%u", read_at, write_at, dist, now, s.buffer[write_at]);
 
   // Skip first value, it's from the previous idle level
-  s.buffer_read_at = (s.buffer_read_at + 1) % s.buffer_size;
-  uint32_t prev = s.buffer_read_at;
-  s.buffer_read_at = (s.buffer_read_at + 1) % s.buffer_size;
-  const uint32_t reserve_size = 1 + (s.buffer_size + write_at - s.buffer_read_at) % s.buffer_size;
-  this->temp_.clear();
-  this->temp_.reserve(reserve_size);
-  int32_t multiplier = s.buffer_read_at % 2 == 0 ? 1 : -1;
-
-  for (uint32_t i = 0; prev != write_at; i++) {
-    int32_t delta = s.buffer[s.buffer_read_at] - s.buffer[prev];
-    if (uint32_t(delta) >= this->idle_us_) {
-      // already found a space longer than idle. There must have been two pulses
+  const uint32_t start = read_at + 1 == s.buffer_size ? 0 : read_at + 1;
+  // The frame ends at the first space longer than idle, there may be more than one frame in the buffer
+  uint32_t end = start;
+  uint32_t length = 0;
+  while (end != write_at) {
+    const uint32_t next = end + 1 == s.buffer_size ? 0 : end + 1;
+    if (s.buffer[next] - s.buffer[end] >= this->idle_us_)
       break;
-    }
-
-    ESP_LOGVV(TAG, "  i=%u buffer[%u]=%u - buffer[%u]=%u -> %d", i, s.buffer_read_at, s.buffer[s.buffer_read_at], prev,
-              s.buffer[prev], multiplier * delta);
-    this->temp_.push_back(multiplier * delta);
-    prev = s.buffer_read_at;
-    s.buffer_read_at = (s.buffer_read_at + 1) % s.buffer_size;
-    multiplier *= -1;
+    end = next;
+    length++;
   }
-  s.buffer_read_at = (s.buffer_size + s.buffer_read_at - 1) % s.buffer_size;
-  this->temp_.push_back(this->idle_us_ * multiplier);
 
-  RemoteReceiveData data(this, &this->temp_);
+  // decoded straight from the buffer, the interrupt doesn't touch the frame until buffer_read_at is advanced
+  RemoteReceiveData data(this, &s, start, length + 1);
   this->process_(&data);
+  s.buffer_read_at = end;
 }
 #endif
 
 RemoteReceiver *RemoteReceiverComponent::add_decoder(RemoteReceiver *decoder) {
   this->decoders_.push_back(decoder);
+  if (decoder->get_protocol_name() == nullptr) {
+    this->unique_decoders_.push_back(decoder);
+    return decoder;
+  }
+
+  for (auto &group : this->receiver_groups_) {
+    if (group.decoder->has_same_decoder(decoder)) {
+      group.receivers[decoder->get_code()].push_back(decoder);
+      return decoder;
+    }
+  }
+  this->receiver_groups_.push_back(ReceiverGroup{decoder, {}});
+  this->receiver_groups_.back().receivers[decoder->get_code()].push_back(decoder);
   return decoder;
 }
 void RemoteReceiverComponent::add_dumper(RemoteReceiveDumper *dumper) { this->dumpers_.push_back(dumper); }
@@ -369,9 +450,30 @@ void RemoteReceiverComponent::set_buffer_size(uint32_t buffer_size) { this->buff
 void RemoteReceiverComponent::set_tolerance(uint8_t tolerance) { this->tolerance_ = tolerance; }
 void RemoteReceiverComponent::set_filter_us(uint8_t filter_us) { this->filter_us_ = filter_us; }
 void RemoteReceiverComponent::set_idle_us(uint32_t idle_us) { this->idle_us_ = idle_us; }
+#ifdef ARDUINO_ARCH_ESP32
+void RemoteReceiverComponent::set_continuous(bool continuous) { this->continuous_ = continuous; }
+#endif
+uint32_t RemoteReceiverComponent::get_buffer_size() const { return this->buffer_size_; }
+#ifdef ARDUINO_ARCH_ESP8266
+uint32_t RemoteReceiverComponent::get_buffer_peak_usage() const { return this->buffer_peak_usage_; }
+uint32_t RemoteReceiverComponent::get_overflow_count() const { return this->store_.overflow_count; }
+#endif
 void RemoteReceiverComponent::process_(RemoteReceiveData *data) {
   bool found_decoder = false;
-  for (auto *decoder : this->decoders_) {
+  for (auto &group : this->receiver_groups_) {
+    data->reset_index();
+    uint64_t code;
+    if (!group.decoder->decode(data, &code))
+      continue;
+    auto it = group.receivers.find(code);
+    if (it == group.receivers.end())
+      continue;
+
+    for (auto *receiver : it->second)
+      receiver->publish_match();
+    found_decoder = true;
+  }
+  for (auto *decoder : this->unique_decoders_) {
     if (decoder->process(data))
       found_decoder = true;
   }
@@ -400,13 +502,28 @@ RemoteReceiver::RemoteReceiver(const std::string &name) : BinarySensor(name) {}
 bool RemoteReceiver::process(RemoteReceiveData *data) {
   data->reset_index();
   if (this->matches(data)) {
-    this->publish_state(true);
-    yield();
-    this->publish_state(false);
+    this->publish_match();
     return true;
   }
   return false;
 }
+void RemoteReceiver::publish_match() {
+  this->publish_state(true);
+  yield();
+  this->publish_state(false);
+}
+const char *RemoteReceiver::get_protocol_name() { return nullptr; }
+bool RemoteReceiver::has_same_decoder(RemoteReceiver *other) {
+  const char *name = this->get_protocol_name();
+  const char *other_name = other->get_protocol_name();
+  return name != nullptr && other_name != nullptr && strcmp(name, other_name) == 0;
+}
+bool RemoteReceiver::decode(RemoteReceiveData *data, uint64_t *code) { return false; }
+uint64_t RemoteReceiver::get_code() { return 0; }
+bool RemoteReceiver::matches(RemoteReceiveData *data) {
+  uint64_t code;
+  return this->decode(data, &code) && code == this->get_code();
+}
 bool RemoteReceiveDumper::is_secondary() { return false; }
 
 bool RemoteReceiveDumper::process(RemoteReceiveData *data) {
@@ -5,6 +5,7 @@
 
 #ifdef USE_REMOTE_RECEIVER
 
+#include <unordered_map>
 #include "esphome/component.h"
 #include "esphome/remote/remote_protocol.h"
 #include "esphome/switch_/switch.h"
@@ -15,6 +16,7 @@ ESPHOME_NAMESPACE_BEGIN
 namespace remote {
 
 class RemoteReceiverComponent;
+struct RemoteReceiverComponentStore;
 
 struct JVCDecodeData {
   bool valid;
@@ -56,27 +58,49 @@ struct RC5DecodeData {
   uint8_t command;
 };
 
+/** One received frame, as durations in µs: positive values are marks and negative values are spaces.
+ *
+ * The durations are either read from a vector, or on the ESP8266 computed on the fly from the edge
+ * timestamps in the receiver's ring buffer, so that no copy of the frame is needed.
+ */
 class RemoteReceiveData {
  public:
   RemoteReceiveData(RemoteReceiverComponent *parent, std::vector<int32_t> *data);
+#ifdef ARDUINO_ARCH_ESP8266
+  /// The frame from the edge at index start of the store's buffer, with size durations.
+  RemoteReceiveData(RemoteReceiverComponent *parent, const RemoteReceiverComponentStore *store, uint32_t start,
+                    uint32_t size);
+#endif
 
   bool peek_mark(uint32_t length, uint32_t offset = 0);
+  bool peek_mark(const RemoteTimingWindow &window, uint32_t offset = 0);
 
   bool peek_space(uint32_t length, uint32_t offset = 0);
+  bool peek_space(const RemoteTimingWindow &window, uint32_t offset = 0);
 
   bool peek_space_at_least(uint32_t length, uint32_t offset = 0);
+  bool peek_space_at_least(const RemoteTimingWindow &window, uint32_t offset = 0);
 
   bool peek_item(uint32_t mark, uint32_t space, uint32_t offset = 0);
+  bool peek_item(const RemoteTimingWindow &mark, const RemoteTimingWindow &space, uint32_t offset = 0);
 
   int32_t peek(uint32_t offset = 0);
 
   void advance(uint32_t amount = 1);
 
   bool expect_mark(uint32_t length);
+  bool expect_mark(const RemoteTimingWindow &window);
 
   bool expect_space(uint32_t length);
+  bool expect_space(const RemoteTimingWindow &window);
 
   bool expect_item(uint32_t mark, uint32_t space);
+  bool expect_item(const RemoteTimingWindow &mark, const RemoteTimingWindow &space);
+
+  /// The tolerance of the receiver in percent.
+  uint8_t get_tolerance() const;
+  /// The durations that are accepted for a timing of length µs.
+  RemoteTimingWindow get_window(uint32_t length) const;
 
   void reset_index();
 
@@ -94,22 +118,59 @@ class RemoteReceiveData {
   SonyDecodeData decode_sony();
 
  protected:
-  uint32_t lower_bound_(uint32_t length);
-  uint32_t upper_bound_(uint32_t length);
-
   RemoteReceiverComponent *parent_;
   uint32_t index_{0};
-  std::vector<int32_t> *data_;
+  /// nullptr if the frame is read from the ring buffer.
+  std::vector<int32_t> *data_{nullptr};
+#ifdef ARDUINO_ARCH_ESP8266
+  const RemoteReceiverComponentStore *store_{nullptr};
+  uint32_t start_{0};
+  uint32_t size_{0};
+#endif
 };
 
+template<size_t N> const RemoteTimingWindow *RemoteTimingTable<N>::get(RemoteReceiveData *data) {
+  const uint8_t tolerance = data->get_tolerance();
+  if (tolerance != this->tolerance_) {
+    for (size_t i = 0; i < N; i++)
+      this->windows_[i] = data->get_window(this->lengths_[i]);
+    this->tolerance_ = tolerance;
+  }
+  return this->windows_;
+}
+
+/** A binary sensor that triggers when a certain code is received.
+ *
+ * Receivers of one protocol implement get_protocol_name(), decode() and get_code(). The receiver component
+ * then groups all receivers that have the same decoder, decodes each frame only once per group and looks
+ * the code up among the group's receivers. Receivers without a protocol name are checked one by one with
+ * matches().
+ */
 class RemoteReceiver : public binary_sensor::BinarySensor {
  public:
   explicit RemoteReceiver(const std::string &name);
 
+  /// Check if the frame matches this receiver and publish a short ON pulse if it does.
   bool process(RemoteReceiveData *data);
 
+  /// Publish a short ON pulse, the frame matched this receiver.
+  void publish_match();
+
+  /// The name of the protocol decode() decodes, or nullptr if this receiver can only be used with matches().
+  virtual const char *get_protocol_name();
+
+  /// Whether decode() of both receivers results in the same code for every frame, by default if the protocols match.
+  virtual bool has_same_decoder(RemoteReceiver *other);
+
+  /// Decode the frame to a code of this receiver's protocol without comparing it, false if it's not of the protocol.
+  virtual bool decode(RemoteReceiveData *data, uint64_t *code);
+
+  /// The code this receiver triggers on, in the format of decode().
+  virtual uint64_t get_code();
+
  protected:
-  virtual bool matches(RemoteReceiveData *data) = 0;
+  /// Whether the frame matches this receiver, by default whether decode() gives get_code().
+  virtual bool matches(RemoteReceiveData *data);
 };
 
 class RemoteReceiveDumper {
@@ -121,18 +182,27 @@ class RemoteReceiveDumper {
   virtual bool is_secondary();
 };
 
+/** Single-producer (the edge interrupt) single-consumer (loop()) ring buffer of edge timestamps.
+ *
+ * The interrupt only writes slots up to the one before buffer_read_at, so loop() can decode a frame
+ * in place and only releases its slots by advancing buffer_read_at afterwards. Edges that arrive while
+ * the buffer is full are dropped and counted.
+ */
 struct RemoteReceiverComponentStore {
   static void gpio_intr(RemoteReceiverComponentStore *arg);
+  /// Store an edge at the given time, called by the interrupt.
+  void record_edge(uint32_t now);
 
   /// Stores the time (in micros) that the leading/falling edge happened at
   ///  * An even index means a falling edge appeared at the time stored at the index
   ///  * An uneven index means a rising edge appeared at the time stored at the index
   volatile uint32_t *buffer{nullptr};
-  /// The position last written to
+  /// The position last written to, only written by the interrupt
   volatile uint32_t buffer_write_at;
-  /// The position last read from
-  uint32_t buffer_read_at{0};
-  bool overflow{false};
+  /// The position last read from, only written by loop()
+  volatile uint32_t buffer_read_at{0};
+  /// The number of edges dropped because the buffer was full
+  volatile uint32_t overflow_count{0};
   uint32_t buffer_size{1000};
   uint8_t filter_us{10};
   ISRInternalGPIOPin *pin;
@@ -146,6 +216,7 @@ class RemoteReceiverComponent : public RemoteControlComponentBase, public Compon
   void dump_config() override;
   void loop() override;
   float get_setup_priority() const override;
+  float get_loop_priority() const override;
 
   RemoteReceiver *add_decoder(RemoteReceiver *decoder);
   void add_dumper(RemoteReceiveDumper *dumper);
@@ -154,14 +225,41 @@ class RemoteReceiverComponent : public RemoteControlComponentBase, public Compon
   void set_tolerance(uint8_t tolerance);
   void set_filter_us(uint8_t filter_us);
   void set_idle_us(uint32_t idle_us);
+#ifdef ARDUINO_ARCH_ESP32
+  /** Stitch RMT chunks into a single frame until no change happened for the idle time.
+   *
+   * The RMT peripheral can only measure idle times up to 32767 ticks, in continuous mode longer idle
+   * times can be used, for example for air conditioner frames with long gaps between their sections.
+   */
+  void set_continuous(bool continuous);
+#endif
+
+  /// The size of the receive buffer, in RMT memory bytes on the ESP32 and in edges on the ESP8266.
+  uint32_t get_buffer_size() const;
+#ifdef ARDUINO_ARCH_ESP8266
+  /// The most edges that were waiting in the buffer at once.
+  uint32_t get_buffer_peak_usage() const;
+  /// The number of edges dropped because the buffer was full.
+  uint32_t get_overflow_count() const;
+#endif
 
  protected:
   friend RemoteReceiveData;
 
   void process_(RemoteReceiveData *data);
 
+  /// Receivers with the same decoder, the frame is decoded once with decoder and the code looked up in receivers.
+  struct ReceiverGroup {
+    RemoteReceiver *decoder;
+    std::unordered_map<uint64_t, std::vector<RemoteReceiver *>> receivers;
+  };
+
 #ifdef ARDUINO_ARCH_ESP32
+  /// Append the durations of len RMT items to temp_.
   void decode_rmt_(rmt_item32_t *item, size_t len);
+  /// Append a duration to temp_, merging it with the last one if both have the same level.
+  void push_duration_(int32_t value);
+  void process_frame_();
 #endif
 
 #ifdef ARDUINO_ARCH_ESP32
@@ -176,14 +274,27 @@ class RemoteReceiverComponent : public RemoteControlComponentBase, public Compon
 #endif
 #ifdef ARDUINO_ARCH_ESP8266
   uint32_t buffer_size_{1000};
+  uint32_t buffer_peak_usage_{0};
+  /// The overflow count the last overflow warning was logged at.
+  uint32_t last_overflow_count_{0};
   HighFrequencyLoopRequester high_freq_;
 #endif
   uint8_t tolerance_{25};
   std::vector<RemoteReceiver *> decoders_{};
+  std::vector<ReceiverGroup> receiver_groups_{};
+  /// Receivers without a protocol, matched one by one.
+  std::vector<RemoteReceiver *> unique_decoders_{};
   std::vector<RemoteReceiveDumper *> dumpers_{};
   uint8_t filter_us_{10};
   uint32_t idle_us_{10000};
+#ifdef ARDUINO_ARCH_ESP32
+  /// The frame being received, may span several RMT chunks in continuous mode.
   std::vector<int32_t> temp_;
+  bool continuous_{false};
+  /// The idle time the RMT peripheral is configured with, at most 32767 ticks.
+  uint32_t rmt_idle_us_{0};
+  uint32_t last_chunk_at_{0};
+#endif
 };
 
 }  // namespace remote
@@ -64,16 +64,27 @@ void RemoteTransmitter::write_state(bool state) {
 }
 uint32_t RemoteTransmitter::get_send_times() const { return this->send_times_; }
 uint32_t RemoteTransmitter::get_send_wait() const { return this->send_wait_; }
+bool RemoteTransmitter::is_data_static() { return false; }
 
 RemoteTransmitterComponent::RemoteTransmitterComponent(GPIOPin *pin) : RemoteControlComponentBase(pin) {}
 float RemoteTransmitterComponent::get_setup_priority() const { return setup_priority::HARDWARE_LATE; }
 #ifdef ARDUINO_ARCH_ESP32
-void RemoteTransmitterComponent::setup() {}
+void RemoteTransmitterComponent::setup() {
+  if (!this->check_memory_blocks_()) {
+    this->mark_failed();
+    return;
+  }
+  for (auto *transmitter : this->transmitters_) {
+    if (transmitter->is_data_static())
+      this->build_cache_(transmitter);
+  }
+}
 
 void RemoteTransmitterComponent::dump_config() {
   ESP_LOGCONFIG(TAG, "Remote Transmitter...");
   ESP_LOGCONFIG(TAG, "  Channel: %d", this->channel_);
   ESP_LOGCONFIG(TAG, "  Clock divider: %u", this->clock_divider_);
+  ESP_LOGCONFIG(TAG, "  Memory blocks: %u", this->memory_blocks_);
   LOG_PIN("  Pin: ", this->pin_);
 
   if (this->current_carrier_frequency_ != 0 && this->carrier_duty_percent_ != 100) {
@@ -96,7 +107,7 @@ void RemoteTransmitterComponent::configure_rmt() {
   c.channel = this->channel_;
   c.clk_div = this->clock_divider_;
   c.gpio_num = gpio_num_t(this->pin_->get_pin());
-  c.mem_block_num = 1;
+  c.mem_block_num = this->memory_blocks_;
   c.tx_config.loop_en = false;
 
   if (this->current_carrier_frequency_ == 0 || this->carrier_duty_percent_ == 100) {
@@ -134,17 +145,45 @@ void RemoteTransmitterComponent::configure_rmt() {
   }
 }
 
-void RemoteTransmitterComponent::send_(RemoteTransmitData *data, uint32_t send_times, uint32_t send_wait) {
-  if (this->is_failed())
+void RemoteTransmitterComponent::send_(RemoteTransmitData *data, uint32_t send_times, uint32_t send_wait,
+                                       RemoteTransmitter *transmitter) {
+  if (this->is_failed()) {
+    this->finish_send_(transmitter);
     return;
+  }
 
-  if (this->current_carrier_frequency_ != data->get_carrier_frequency()) {
-    this->current_carrier_frequency_ = data->get_carrier_frequency();
-    this->configure_rmt();
+  this->to_rmt_items_(data, &this->rmt_temp_);
+  this->send_rmt_items_(this->rmt_temp_, data->get_carrier_frequency(), send_times, send_wait);
+  this->finish_send_(transmitter);
+}
+void RemoteTransmitterComponent::send_transmitter_(RemoteTransmitter *transmitter) {
+  if (!transmitter->is_data_static()) {
+    this->temp_.reset();
+    transmitter->to_data(&this->temp_);
+    this->send_(&this->temp_, transmitter->get_send_times(), transmitter->get_send_wait(), transmitter);
+    return;
   }
 
-  this->rmt_temp_.clear();
-  this->rmt_temp_.reserve((data->get_data().size() + 1) / 2);
+  if (!transmitter->cache_valid_)
+    this->build_cache_(transmitter);
+  if (!this->is_failed()) {
+    this->send_rmt_items_(transmitter->rmt_items_, transmitter->carrier_frequency_, transmitter->get_send_times(),
+                          transmitter->get_send_wait());
+  }
+  this->finish_send_(transmitter);
+}
+void RemoteTransmitterComponent::build_cache_(RemoteTransmitter *transmitter) {
+  this->temp_.reset();
+  transmitter->to_data(&this->temp_);
+  transmitter->rmt_items_.clear();
+  this->to_rmt_items_(&this->temp_, &transmitter->rmt_items_);
+  transmitter->rmt_items_.shrink_to_fit();
+  transmitter->carrier_frequency_ = this->temp_.get_carrier_frequency();
+  transmitter->cache_valid_ = true;
+}
+void RemoteTransmitterComponent::to_rmt_items_(const RemoteTransmitData *data, std::vector<rmt_item32_t> *items) {
+  items->clear();
+  items->reserve((data->get_data().size() + 1) / 2);
   uint32_t rmt_i = 0;
   rmt_item32_t rmt_item;
 
@@ -164,7 +203,7 @@ void RemoteTransmitterComponent::send_(RemoteTransmitData *data, uint32_t send_t
       } else {
         rmt_item.level1 = static_cast<uint32_t>(level);
         rmt_item.duration1 = static_cast<uint32_t>(item);
-        this->rmt_temp_.push_back(rmt_item);
+        items->push_back(rmt_item);
       }
       rmt_i++;
     } while (val != 0);
@@ -173,11 +212,18 @@ void RemoteTransmitterComponent::send_(RemoteTransmitData *data, uint32_t send_t
   if (rmt_i % 2 == 1) {
     rmt_item.level1 = 0;
     rmt_item.duration1 = 0;
-    this->rmt_temp_.push_back(rmt_item);
+    items->push_back(rmt_item);
+  }
+}
+void RemoteTransmitterComponent::send_rmt_items_(const std::vector<rmt_item32_t> &items, uint32_t carrier_frequency,
+                                                 uint32_t send_times, uint32_t send_wait) {
+  if (this->current_carrier_frequency_ != carrier_frequency) {
+    this->current_carrier_frequency_ = carrier_frequency;
+    this->configure_rmt();
   }
 
   for (uint16_t i = 0; i < send_times; i++) {
-    esp_err_t error = rmt_write_items(this->channel_, this->rmt_temp_.data(), this->rmt_temp_.size(), true);
+    esp_err_t error = rmt_write_items(this->channel_, items.data(), items.size(), true);
     if (error != ESP_OK) {
       ESP_LOGW(TAG, "rmt_write_items failed: %s", esp_err_to_name(error));
       this->status_set_warning();
@@ -196,6 +242,13 @@ void RemoteTransmitterComponent::send_(RemoteTransmitData *data, uint32_t send_t
 void RemoteTransmitterComponent::setup() {
   this->pin_->setup();
   this->pin_->digital_write(false);
+  this->store_.pin = this->pin_->to_isr();
+  this->store_.done = true;
+
+  for (auto *transmitter : this->transmitters_) {
+    if (transmitter->is_data_static())
+      this->build_cache_(transmitter);
+  }
 }
 
 void RemoteTransmitterComponent::dump_config() {
@@ -221,60 +274,168 @@ void RemoteTransmitterComponent::calculate_on_off_time_(uint32_t carrier_frequen
   *off_time_period = period - *on_time_period;
 }
 
-void RemoteTransmitterComponent::send_(RemoteTransmitData *data, uint32_t send_times, uint32_t send_wait) {
-  for (uint32_t i = 0; i < send_times; i++) {
-    uint32_t on_time, off_time;
-    this->calculate_on_off_time_(data->get_carrier_frequency(), &on_time, &off_time);
-    ESP_LOGD(TAG, "Sending remote code...");
+/// The transmitter whose frame is being sent, there's only one timer0.
+static RemoteTransmitterComponentStore *active_store = nullptr;
+/// Interrupts planned closer than this to now are fired this far in the future instead.
+static const uint32_t TIMER_MIN_CYCLES = 160;
 
-    ESP.wdtFeed();
-    disable_interrupts();
-    for (int32_t item : *data) {
-      if (item > 0) {
-        const auto length = uint32_t(item);
-        this->mark_(on_time, off_time, length);
-      } else {
-        const auto length = uint32_t(-item);
-        this->space_(length);
-      }
-      feed_wdt();
-    }
-    enable_interrupts();
+void ICACHE_RAM_ATTR HOT RemoteTransmitterComponentStore::timer_intr() {
+  RemoteTransmitterComponentStore *s = active_store;
+  if (s == nullptr || s->done)
+    return;
 
-    if (i + 1 < send_times) {
-      delay(send_wait / 1000UL);
-      delayMicroseconds(send_wait % 1000UL);
-    }
+  const uint32_t at = s->next_at;
+  if (s->in_mark && s->on_cycles != 0 && at != s->item_end) {
+    // carrier edge within a mark
+    s->carrier_high = !s->carrier_high;
+    s->pin->digital_write(s->carrier_high);
+    uint32_t next = at + (s->carrier_high ? s->on_cycles : s->off_cycles);
+    if (int32_t(next - s->item_end) > 0)
+      next = s->item_end;
+    s->schedule_(next);
+    return;
   }
+
+  s->start_item_(at);
 }
-void RemoteTransmitterComponent::mark_(uint32_t on_time, uint32_t off_time, uint32_t usec) {
-  if (this->carrier_duty_percent_ == 100 || (on_time == 0 && off_time == 0)) {
-    this->pin_->digital_write(true);
-    delay_microseconds_accurate(usec);
-    this->pin_->digital_write(false);
-    return;
+void ICACHE_RAM_ATTR HOT RemoteTransmitterComponentStore::start_item_(uint32_t at) {
+  if (this->index == this->length) {
+    this->pin->digital_write(false);
+    if (--this->send_times_left == 0) {
+      // not rescheduled, loop() detaches the interrupt
+      this->done = true;
+      return;
+    }
+    this->index = 0;
+    if (this->send_wait_cycles != 0) {
+      this->in_mark = false;
+      this->item_end = at + this->send_wait_cycles;
+      this->schedule_(this->item_end);
+      return;
+    }
   }
 
-  const uint32_t start_time = micros();
-  uint32_t current_time = start_time;
+  const int32_t item = this->data[this->index++];
+  this->in_mark = item > 0;
+  this->item_end = at + uint32_t(item > 0 ? item : -item) * this->cycles_per_us;
+  uint32_t next = this->item_end;
+  if (this->in_mark) {
+    this->carrier_high = true;
+    this->pin->digital_write(true);
+    if (this->on_cycles != 0 && int32_t(at + this->on_cycles - this->item_end) < 0)
+      next = at + this->on_cycles;
+  } else {
+    this->pin->digital_write(false);
+  }
+  this->schedule_(next);
+}
+void ICACHE_RAM_ATTR HOT RemoteTransmitterComponentStore::schedule_(uint32_t at) {
+  this->next_at = at;
+  const uint32_t now = ESP.getCycleCount();
+  if (int32_t(at - now) < int32_t(TIMER_MIN_CYCLES))
+    at = now + TIMER_MIN_CYCLES;
+  timer0_write(at);
+}
+
+void RemoteTransmitterComponent::send_(RemoteTransmitData *data, uint32_t send_times, uint32_t send_wait,
+                                       RemoteTransmitter *transmitter) {
+  Frame frame;
+  frame.data = *data;
+  frame.cached = nullptr;
+  frame.send_times = send_times;
+  frame.send_wait = send_wait;
+  frame.transmitter = transmitter;
+  this->queue_frame_(std::move(frame));
+}
+void RemoteTransmitterComponent::send_transmitter_(RemoteTransmitter *transmitter) {
+  if (!transmitter->is_data_static()) {
+    this->temp_.reset();
+    transmitter->to_data(&this->temp_);
+    this->send_(&this->temp_, transmitter->get_send_times(), transmitter->get_send_wait(), transmitter);
+    return;
+  }
 
-  while (current_time - start_time < usec) {
-    const uint32_t elapsed = current_time - start_time;
-    this->pin_->digital_write(true);
+  if (!transmitter->cache_valid_)
+    this->build_cache_(transmitter);
+  Frame frame;
+  frame.cached = &transmitter->data_;
+  frame.send_times = transmitter->get_send_times();
+  frame.send_wait = transmitter->get_send_wait();
+  frame.transmitter = transmitter;
+  this->queue_frame_(std::move(frame));
+}
+void RemoteTransmitterComponent::build_cache_(RemoteTransmitter *transmitter) {
+  transmitter->data_.reset();
+  transmitter->to_data(&transmitter->data_);
+  transmitter->cache_valid_ = true;
+}
+void RemoteTransmitterComponent::queue_frame_(Frame &&frame) {
+  this->queue_.push_back(std::move(frame));
+  this->enable_loop();
+  if (!this->sending_)
+    this->start_frame_();
+}
+const RemoteTransmitData &RemoteTransmitterComponent::Frame::get_data() const {
+  return this->cached != nullptr ? *this->cached : this->data;
+}
+void RemoteTransmitterComponent::start_frame_() {
+  this->current_ = std::move(this->queue_.front());
+  this->queue_.erase(this->queue_.begin());
+  const RemoteTransmitData &data = this->current_.get_data();
+  if (this->current_.send_times == 0 || data.get_data().empty()) {
+    this->finish_send_(this->current_.transmitter);
+    return;
+  }
+  if (active_store != nullptr && active_store != &this->store_) {
+    // timer0 is busy with another transmitter, try again in the next loop()
+    this->queue_.insert(this->queue_.begin(), std::move(this->current_));
+    return;
+  }
 
-    delay_microseconds_accurate(std::min(on_time, usec - elapsed));
-    this->pin_->digital_write(false);
-    if (elapsed + on_time >= usec)
+  ESP_LOGD(TAG, "Sending remote code...");
+  uint32_t on_time, off_time;
+  this->calculate_on_off_time_(data.get_carrier_frequency(), &on_time, &off_time);
+  auto &s = this->store_;
+  s.data = data.get_data().data();
+  s.length = data.get_data().size();
+  s.index = 0;
+  s.send_times_left = this->current_.send_times;
+  s.cycles_per_us = ESP.getCpuFreqMHz();
+  s.send_wait_cycles = this->current_.send_wait * s.cycles_per_us;
+  if (this->carrier_duty_percent_ == 100 || (on_time == 0 && off_time == 0)) {
+    s.on_cycles = s.off_cycles = 0;
+  } else {
+    s.on_cycles = on_time * s.cycles_per_us;
+    s.off_cycles = off_time * s.cycles_per_us;
+  }
+  s.in_mark = false;
+  s.done = false;
+  this->sending_ = true;
+
+  active_store = &s;
+  timer0_isr_init();
+  timer0_attachInterrupt(RemoteTransmitterComponentStore::timer_intr);
+  // the first interrupt starts the first mark
+  s.item_end = ESP.getCycleCount() + TIMER_MIN_CYCLES;
+  s.schedule_(s.item_end);
+}
+void RemoteTransmitterComponent::loop() {
+  if (this->sending_) {
+    if (!this->store_.done)
       return;
 
-    delay_microseconds_accurate(std::min(usec - elapsed - on_time, off_time));
+    timer0_detachInterrupt();
+    active_store = nullptr;
+    this->sending_ = false;
+    this->finish_send_(this->current_.transmitter);
+  }
 
-    current_time = micros();
+  if (this->queue_.empty()) {
+    // Only needs loop() while sending, re-enabled in send_()
+    this->disable_loop();
+    return;
   }
-}
-void RemoteTransmitterComponent::space_(uint32_t usec) {
-  this->pin_->digital_write(false);
-  delay_microseconds_accurate(usec);
+  this->start_frame_();
 }
 #endif  // ARDUINO_ARCH_ESP8266
 
@@ -286,16 +447,25 @@ RemoteTransmitter *RemoteTransmitterComponent::add_transmitter(RemoteTransmitter
 void RemoteTransmitterComponent::set_carrier_duty_percent(uint8_t carrier_duty_percent) {
   this->carrier_duty_percent_ = carrier_duty_percent;
 }
+void RemoteTransmitterComponent::add_on_complete_callback(std::function<void()> &&callback) {
+  this->complete_callback_.add(std::move(callback));
+}
 RemoteTransmitterComponent::TransmitCall RemoteTransmitterComponent::transmit() { return TransmitCall(this); }
 void RemoteTransmitterComponent::deferred_send(RemoteTransmitter *a_switch) {
   this->defer([this, a_switch]() {
     a_switch->publish_state(true);
-    this->temp_.reset();
-    a_switch->to_data(&this->temp_);
-    this->send_(&this->temp_, a_switch->get_send_times(), a_switch->get_send_wait());
-    a_switch->publish_state(false);
+    // the switch is turned off again in finish_send_()
+    this->send_transmitter_(a_switch);
   });
 }
+void RemoteTransmitterComponent::finish_send_(RemoteTransmitter *transmitter) {
+  if (transmitter != nullptr)
+    transmitter->publish_state(false);
+  this->complete_callback_.call();
+}
+RemoteTransmitCompleteTrigger::RemoteTransmitCompleteTrigger(RemoteTransmitterComponent *parent) {
+  parent->add_on_complete_callback([this]() { this->trigger(); });
+}
 
 void RemoteTransmitterComponent::TransmitCall::perform() {
   this->parent_->send_(&this->parent_->temp_, this->send_times_, this->send_wait_);
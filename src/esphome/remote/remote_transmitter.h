@@ -57,14 +57,68 @@ class RemoteTransmitter : public switch_::Switch {
   uint32_t get_send_times() const;
   uint32_t get_send_wait() const;
 
+  /** Whether to_data() always produces the same data, defaults to false.
+   *
+   * The data of these transmitters is built once at setup and kept in its final form (RMT items on the
+   * ESP32, the timing table on the ESP8266), which is then replayed on every send. Only override this for
+   * fixed codes, custom transmitters may build different data on every send.
+   */
+  virtual bool is_data_static();
+
  protected:
+  friend RemoteTransmitterComponent;
+
   void write_state(bool state) override;
 
   RemoteTransmitterComponent *parent_;
   uint32_t send_times_{1};  ///< How many times to send the data
   uint32_t send_wait_{0};   ///< How many microseconds to wait between repeats.
+  /// Whether the cached data below has been built.
+  bool cache_valid_{false};
+#ifdef ARDUINO_ARCH_ESP32
+  std::vector<rmt_item32_t> rmt_items_;
+  uint32_t carrier_frequency_{0};
+#endif
+#ifdef ARDUINO_ARCH_ESP8266
+  RemoteTransmitData data_;
+#endif
 };
 
+#ifdef ARDUINO_ARCH_ESP8266
+/** State of the frame that is being sent, shared with the timer0 interrupt.
+ *
+ * The interrupt fires at every carrier edge and at the start of every mark/space, and reschedules itself
+ * relative to the planned time of the current event so that a late interrupt doesn't add up to drift.
+ */
+struct RemoteTransmitterComponentStore {
+  static void timer_intr();
+
+  /// Start the mark/space at data[index] (or the next repeat) at cycle count at.
+  void start_item_(uint32_t at);
+  /// Fire the interrupt at cycle count at, or as soon as possible if that already passed.
+  void schedule_(uint32_t at);
+
+  const int32_t *data;
+  uint32_t length;
+  uint32_t index;
+  uint32_t send_times_left;
+  uint32_t send_wait_cycles;
+  uint32_t cycles_per_us;
+  /// Carrier high and low time in CPU cycles, 0 if marks are just high
+  uint32_t on_cycles;
+  uint32_t off_cycles;
+  /// Planned cycle count of the next interrupt
+  uint32_t next_at;
+  /// Cycle count the current mark/space ends at
+  uint32_t item_end;
+  bool in_mark;
+  bool carrier_high;
+  ISRInternalGPIOPin *pin;
+  /// Set by the interrupt once all repeats have been sent
+  volatile bool done;
+};
+#endif
+
 class RemoteTransmitterComponent : public RemoteControlComponentBase, public Component {
  public:
   explicit RemoteTransmitterComponent(GPIOPin *pin);
@@ -75,6 +129,13 @@ class RemoteTransmitterComponent : public RemoteControlComponentBase, public Com
 
   void dump_config() override;
 
+#ifdef ARDUINO_ARCH_ESP8266
+  void loop() override;
+#endif
+
+  /// Called once a remote code has been sent completely, including its repeats.
+  void add_on_complete_callback(std::function<void()> &&callback);
+
   float get_setup_priority() const override;
 
   void set_carrier_duty_percent(uint8_t carrier_duty_percent);
@@ -126,18 +187,49 @@ class RemoteTransmitterComponent : public RemoteControlComponentBase, public Com
  protected:
   friend RemoteTransmitter;
 
-  void send_(RemoteTransmitData *data, uint32_t send_times, uint32_t send_wait);
+  /// Send the data, on the ESP8266 it is queued and sent in the background.
+  void send_(RemoteTransmitData *data, uint32_t send_times, uint32_t send_wait,
+             RemoteTransmitter *transmitter = nullptr);
+
+  /// Turn the transmitter's switch (if any) back off and call the complete callbacks.
+  void finish_send_(RemoteTransmitter *transmitter);
+
+  /// Send the transmitter's code, from its cache if its data is static.
+  void send_transmitter_(RemoteTransmitter *transmitter);
+
+  /// Build the final form of a static transmitter's data.
+  void build_cache_(RemoteTransmitter *transmitter);
 
 #ifdef ARDUINO_ARCH_ESP8266
   void calculate_on_off_time_(uint32_t carrier_frequency, uint32_t *on_time_period, uint32_t *off_time_period);
 
-  void mark_(uint32_t on_time, uint32_t off_time, uint32_t usec);
+  /// Start sending the next queued frame.
+  void start_frame_();
 
-  void space_(uint32_t usec);
+  struct Frame {
+    /// The data to send, either owned or the cached data of a transmitter
+    RemoteTransmitData data;
+    const RemoteTransmitData *cached;
+    uint32_t send_times;
+    uint32_t send_wait;
+    RemoteTransmitter *transmitter;
+
+    const RemoteTransmitData &get_data() const;
+  };
+  void queue_frame_(Frame &&frame);
+  /// Frames waiting to be sent.
+  std::vector<Frame> queue_;
+  /// The frame that is being sent, not touched until the interrupt is done with it.
+  Frame current_;
+  bool sending_{false};
+  RemoteTransmitterComponentStore store_;
 #endif
 
 #ifdef ARDUINO_ARCH_ESP32
   void configure_rmt();
+  void to_rmt_items_(const RemoteTransmitData *data, std::vector<rmt_item32_t> *items);
+  void send_rmt_items_(const std::vector<rmt_item32_t> &items, uint32_t carrier_frequency, uint32_t send_times,
+                       uint32_t send_wait);
   uint32_t current_carrier_frequency_{UINT32_MAX};
   bool initialized_{false};
   std::vector<rmt_item32_t> rmt_temp_;
@@ -145,6 +237,12 @@ class RemoteTransmitterComponent : public RemoteControlComponentBase, public Com
   uint8_t carrier_duty_percent_{50};
   std::vector<RemoteTransmitter *> transmitters_{};
   RemoteTransmitData temp_;
+  CallbackManager<void()> complete_callback_{};
+};
+
+class RemoteTransmitCompleteTrigger : public Trigger<> {
+ public:
+  explicit RemoteTransmitCompleteTrigger(RemoteTransmitterComponent *parent);
 };
 
 }  // namespace remote
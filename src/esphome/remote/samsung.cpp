@@ -26,6 +26,7 @@ static const uint32_t FOOTER_LOW_US = 560;
 SamsungTransmitter::SamsungTransmitter(const std::string &name, uint32_t data) : RemoteTransmitter(name), data_(data) {}
 
 void SamsungTransmitter::to_data(RemoteTransmitData *data) { encode_samsung(data, this->data_); }
+bool SamsungTransmitter::is_data_static() { return true; }
 
 void encode_samsung(RemoteTransmitData *data, uint32_t samsung_data) {
   data->set_carrier_frequency(38000);
@@ -45,37 +46,53 @@ void encode_samsung(RemoteTransmitData *data, uint32_t samsung_data) {
 #endif
 
 #ifdef USE_REMOTE_RECEIVER
+/// The accepted windows of the timings, indexed by the TIMING_ constants.
+enum {
+  TIMING_HEADER_HIGH = 0,
+  TIMING_HEADER_LOW,
+  TIMING_BIT_HIGH,
+  TIMING_BIT_ONE_LOW,
+  TIMING_BIT_ZERO_LOW,
+  TIMING_FOOTER_HIGH,
+};
+static RemoteTimingTable<6> samsung_timings(HEADER_HIGH_US, HEADER_LOW_US, BIT_HIGH_US, BIT_ONE_LOW_US,
+                                            BIT_ZERO_LOW_US, FOOTER_HIGH_US);
+
 SamsungDecodeData decode_samsung(RemoteReceiveData *data) {
+  const RemoteTimingWindow *timing = samsung_timings.get(data);
   SamsungDecodeData out{};
   out.valid = false;
   out.data = 0;
-  if (!data->expect_item(HEADER_HIGH_US, HEADER_LOW_US))
+  if (!data->expect_item(timing[TIMING_HEADER_HIGH], timing[TIMING_HEADER_LOW]))
     return out;
 
   for (uint8_t i = 0; i < NBITS; i++) {
     out.data <<= 1UL;
-    if (data->expect_item(BIT_HIGH_US, BIT_ONE_LOW_US)) {
+    if (data->expect_item(timing[TIMING_BIT_HIGH], timing[TIMING_BIT_ONE_LOW])) {
       out.data |= 1UL;
-    } else if (data->expect_item(BIT_HIGH_US, BIT_ZERO_LOW_US)) {
+    } else if (data->expect_item(timing[TIMING_BIT_HIGH], timing[TIMING_BIT_ZERO_LOW])) {
       out.data |= 0UL;
     } else {
       return out;
     }
   }
 
-  out.valid = data->expect_mark(FOOTER_HIGH_US);
+  out.valid = data->expect_mark(timing[TIMING_FOOTER_HIGH]);
   return out;
 }
 
 SamsungReceiver::SamsungReceiver(const std::string &name, uint32_t data) : RemoteReceiver(name), data_(data) {}
 
-bool SamsungReceiver::matches(RemoteReceiveData *data) {
+const char *SamsungReceiver::get_protocol_name() { return "Samsung"; }
+bool SamsungReceiver::decode(RemoteReceiveData *data, uint64_t *code) {
   auto decode = decode_samsung(data);
   if (!decode.valid)
     return false;
 
-  return this->data_ == decode.data;
+  *code = uint64_t(decode.data);
+  return true;
 }
+uint64_t SamsungReceiver::get_code() { return uint64_t(this->data_); }
 
 bool SamsungDumper::dump(RemoteReceiveData *data) {
   auto decode = decode_samsung(data);
@@ -21,6 +21,7 @@ static const uint32_t BIT_LOW_US = 600;
 SonyTransmitter::SonyTransmitter(const std::string &name, uint32_t data, uint8_t nbits)
     : RemoteTransmitter(name), data_(data), nbits_(nbits) {}
 void SonyTransmitter::to_data(RemoteTransmitData *data) { encode_sony(data, this->data_, this->nbits_); }
+bool SonyTransmitter::is_data_static() { return true; }
 
 void encode_sony(RemoteTransmitData *data, uint32_t sony_data, uint8_t nbits) {
   data->set_carrier_frequency(40000);
@@ -38,19 +39,24 @@ void encode_sony(RemoteTransmitData *data, uint32_t sony_data, uint8_t nbits) {
 #endif
 
 #ifdef USE_REMOTE_RECEIVER
+/// The accepted windows of the timings, indexed by the TIMING_ constants.
+enum { TIMING_HEADER_HIGH = 0, TIMING_HEADER_LOW, TIMING_BIT_ONE_HIGH, TIMING_BIT_ZERO_HIGH, TIMING_BIT_LOW };
+static RemoteTimingTable<5> sony_timings(HEADER_HIGH_US, HEADER_LOW_US, BIT_ONE_HIGH_US, BIT_ZERO_HIGH_US, BIT_LOW_US);
+
 SonyDecodeData decode_sony(RemoteReceiveData *data) {
+  const RemoteTimingWindow *timing = sony_timings.get(data);
   SonyDecodeData out{};
   out.valid = false;
   out.data = 0;
   out.nbits = 0;
-  if (!data->expect_item(HEADER_HIGH_US, HEADER_LOW_US))
+  if (!data->expect_item(timing[TIMING_HEADER_HIGH], timing[TIMING_HEADER_LOW]))
     return out;
 
   for (; out.nbits < 20; out.nbits++) {
     uint32_t bit;
-    if (data->expect_mark(BIT_ONE_HIGH_US)) {
+    if (data->expect_mark(timing[TIMING_BIT_ONE_HIGH])) {
       bit = 1;
-    } else if (data->expect_mark(BIT_ZERO_HIGH_US)) {
+    } else if (data->expect_mark(timing[TIMING_BIT_ZERO_HIGH])) {
       bit = 0;
     } else {
       out.valid = out.nbits == 12 || out.nbits == 15;
@@ -58,9 +64,9 @@ SonyDecodeData decode_sony(RemoteReceiveData *data) {
     }
 
     out.data = (out.data << 1UL) | bit;
-    if (data->expect_space(BIT_LOW_US)) {
+    if (data->expect_space(timing[TIMING_BIT_LOW])) {
       // nothing needs to be done
-    } else if (data->peek_space_at_least(BIT_LOW_US)) {
+    } else if (data->peek_space_at_least(timing[TIMING_BIT_LOW])) {
       out.nbits += 1;
       out.valid = out.nbits == 12 || out.nbits == 15 || out.nbits == 20;
       return out;
@@ -76,10 +82,16 @@ SonyDecodeData decode_sony(RemoteReceiveData *data) {
 SonyReceiver::SonyReceiver(const std::string &name, uint32_t data, uint8_t nbits)
     : RemoteReceiver(name), data_(data), nbits_(nbits) {}
 
-bool SonyReceiver::matches(RemoteReceiveData *data) {
+const char *SonyReceiver::get_protocol_name() { return "Sony"; }
+bool SonyReceiver::decode(RemoteReceiveData *data, uint64_t *code) {
   auto decode = decode_sony(data);
-  return decode.valid && this->data_ == decode.data && this->nbits_ == decode.nbits;
+  if (!decode.valid)
+    return false;
+
+  *code = uint64_t(decode.data) | (uint64_t(decode.nbits) << 32);
+  return true;
 }
+uint64_t SonyReceiver::get_code() { return uint64_t(this->data_) | (uint64_t(this->nbits_) << 32); }
 
 bool SonyDumper::dump(RemoteReceiveData *data) {
   auto decode = decode_sony(data);
@@ -0,0 +1,267 @@
+#include <algorithm>
+#include "esphome/scheduler.h"
+
+#include "esphome/component.h"
+#include "esphome/esphal.h"
+#include "esphome/helpers.h"
+#include "esphome/log.h"
+#include "esphome/tracer.h"
+
+ESPHOME_NAMESPACE_BEGIN
+
+static const char *TAG = "scheduler";
+
+const uint32_t SCHEDULER_DONT_RUN = 4294967295UL;
+
+/// Rebuild the heap once this many cancelled items have piled up somewhere below its top.
+static const uint32_t MAX_PENDING_REMOVALS = 16;
+
+void HOT Scheduler::set_timeout(Component *component, const std::string &name, uint32_t timeout,
+                                std::function<void()> &&func) {
+  const uint64_t now = this->millis_();
+  ESP_LOGVV(TAG, "set_timeout(name='%s', timeout=%u)", name.c_str(), timeout);
+
+  if (!name.empty())
+    this->cancel_timeout(component, name);
+
+  if (timeout == SCHEDULER_DONT_RUN)
+    return;
+
+  auto item = make_unique<SchedulerItem>();
+  item->component = component;
+  item->name = name;
+  item->type = SchedulerItem::TIMEOUT;
+  item->interval = timeout;
+  item->next_execution = now + timeout;
+  item->f = std::move(func);
+  item->remove = false;
+  this->push_(std::move(item));
+}
+bool HOT Scheduler::cancel_timeout(Component *component, const std::string &name) {
+  return this->cancel_item_(component, name, SchedulerItem::TIMEOUT);
+}
+void HOT Scheduler::set_interval(Component *component, const std::string &name, uint32_t interval,
+                                 std::function<void()> &&func) {
+  // only put offset in lower half
+  uint32_t offset = 0;
+  if (interval != 0 && interval != SCHEDULER_DONT_RUN)
+    offset = (random_uint32() % interval) / 2;
+  ESP_LOGVV(TAG, "set_interval(name='%s', interval=%u, offset=%u)", name.c_str(), interval, offset);
+  // later executions are shifted by the offset to spread out intervals
+  const uint32_t phase = interval == 0 ? 0 : (this->millis_() + interval - offset) % interval;
+  this->push_interval_(component, name, interval, phase, std::move(func));
+}
+void HOT Scheduler::set_phased_interval(Component *component, const std::string &name, uint32_t interval,
+                                        uint32_t phase, std::function<void()> &&func) {
+  ESP_LOGVV(TAG, "set_phased_interval(name='%s', interval=%u, phase=%u)", name.c_str(), interval, phase);
+  this->push_interval_(component, name, interval, interval == 0 ? 0 : phase % interval, std::move(func));
+}
+uint32_t Scheduler::next_phase(uint32_t interval) {
+  if (interval == 0 || interval == SCHEDULER_DONT_RUN)
+    return 0;
+  uint32_t n = 0;
+  auto it = std::find_if(this->phase_counts_.begin(), this->phase_counts_.end(),
+                         [interval](const std::pair<uint32_t, uint32_t> &count) { return count.first == interval; });
+  if (it == this->phase_counts_.end()) {
+    this->phase_counts_.emplace_back(interval, 1);
+  } else {
+    n = it->second++;
+  }
+  return uint32_t((uint64_t(interval) * reverse_bits_32(n)) >> 32);
+}
+void HOT Scheduler::push_interval_(Component *component, const std::string &name, uint32_t interval, uint32_t phase,
+                                   std::function<void()> &&func) {
+  if (!name.empty())
+    this->cancel_interval(component, name);
+
+  if (interval == SCHEDULER_DONT_RUN)
+    return;
+
+  auto item = make_unique<SchedulerItem>();
+  item->component = component;
+  item->name = name;
+  item->type = SchedulerItem::INTERVAL;
+  item->interval = interval;
+  item->phase = phase;
+  // Run once right away, later executions are aligned to the phase.
+  item->next_execution = this->millis_();
+  item->f = std::move(func);
+  item->remove = false;
+  this->push_(std::move(item));
+}
+bool HOT Scheduler::cancel_interval(Component *component, const std::string &name) {
+  return this->cancel_item_(component, name, SchedulerItem::INTERVAL);
+}
+void HOT Scheduler::defer(Component *component, const std::string &name, std::function<void()> &&func) {
+  if (!name.empty())
+    this->cancel_defer(component, name);
+
+  auto item = make_unique<SchedulerItem>();
+  item->component = component;
+  item->name = name;
+  item->type = SchedulerItem::DEFER;
+  item->interval = 0;
+  item->next_execution = 0;
+  item->f = std::move(func);
+  item->remove = false;
+  this->push_(std::move(item));
+}
+bool HOT Scheduler::cancel_defer(Component *component, const std::string &name) {
+  return this->cancel_item_(component, name, SchedulerItem::DEFER);
+}
+optional<uint32_t> HOT Scheduler::next_schedule_in() {
+  for (auto &item : this->to_add_) {
+    if (!item->remove)
+      return 0;
+  }
+  this->cleanup_();
+  if (this->items_.empty())
+    return {};
+
+  const uint64_t now = this->millis_();
+  const uint64_t next = this->items_[0]->next_execution;
+  if (next <= now)
+    return 0;
+  return uint32_t(std::min(next - now, uint64_t(SCHEDULER_DONT_RUN - 1)));
+}
+void HOT Scheduler::call() {
+  const uint64_t now = this->millis_();
+  this->process_to_add_();
+
+  while (!this->items_.empty()) {
+    if (this->items_[0]->remove) {
+      this->pop_raw_();
+      this->to_remove_--;
+      continue;
+    }
+    if (this->items_[0]->next_execution > now)
+      // Nothing else is due
+      break;
+
+    std::unique_ptr<SchedulerItem> item = this->pop_raw_();
+    if (item->component != nullptr && item->component->is_failed())
+      // Failed components don't get any more time function calls
+      continue;
+
+#ifdef ESPHOME_LOG_HAS_VERY_VERBOSE
+    const char *type = item->type == SchedulerItem::INTERVAL
+                           ? "interval"
+                           : (item->type == SchedulerItem::TIMEOUT ? "timeout" : "defer");
+    ESP_LOGVV(TAG, "Running %s '%s' with interval=%u next_execution=%u (now=%u)", type, item->name.c_str(),
+              item->interval, uint32_t(item->next_execution), uint32_t(now));
+#endif
+
+    if (item->type == SchedulerItem::INTERVAL) {
+      // Re-schedule before running so that the function can cancel itself. Skipped executions are
+      // not caught up on, the next execution is the first one at the phase after now. Runs are at least
+      // half an interval apart, so the immediate first run (or a late one) isn't followed by another right away.
+      if (item->interval != 0) {
+        item->next_execution = now - (now + item->interval - item->phase) % item->interval + item->interval;
+        if (item->next_execution - now < item->interval / 2)
+          item->next_execution += item->interval;
+      } else {
+        item->next_execution = now + 1;
+      }
+      SchedulerItem *raw = item.get();
+      this->to_add_.push_back(std::move(item));
+      this->call_item_(raw);
+    } else {
+      this->call_item_(item.get());
+    }
+  }
+}
+
+void HOT Scheduler::call_item_(SchedulerItem *item) {
+  TRACE_SCOPE(TIME_FUNCTION, item->component != nullptr ? item->component->get_component_source() : "scheduler");
+#ifdef USE_COMPONENT_PROFILER
+  if (item->component != nullptr) {
+#ifdef USE_HEAP_TRACER
+    const uint32_t free_heap = ESP.getFreeHeap();
+#endif
+    const uint32_t start = micros();
+    item->f();
+    item->component->scheduler_stats.record(micros() - start);
+#ifdef USE_HEAP_TRACER
+    item->component->heap_stats.record(free_heap, ESP.getFreeHeap());
+#endif
+    return;
+  }
+#endif
+  item->f();
+}
+bool HOT Scheduler::SchedulerItem::cmp(const std::unique_ptr<SchedulerItem> &a,
+                                       const std::unique_ptr<SchedulerItem> &b) {
+  if (a->next_execution != b->next_execution)
+    return a->next_execution > b->next_execution;
+  // wrapping difference so that the insertion order counter may overflow
+  return int32_t(a->order - b->order) > 0;
+}
+uint64_t HOT Scheduler::millis_() {
+  const uint32_t now = millis();
+  if (now < this->last_millis_) {
+    ESP_LOGD(TAG, "Incrementing scheduler major");
+    this->millis_major_++;
+  }
+  this->last_millis_ = now;
+  return (uint64_t(this->millis_major_) << 32) | now;
+}
+void HOT Scheduler::push_(std::unique_ptr<SchedulerItem> item) {
+  item->order = this->next_order_++;
+  this->to_add_.push_back(std::move(item));
+}
+std::unique_ptr<Scheduler::SchedulerItem> HOT Scheduler::pop_raw_() {
+  std::pop_heap(this->items_.begin(), this->items_.end(), SchedulerItem::cmp);
+  std::unique_ptr<SchedulerItem> item = std::move(this->items_.back());
+  this->items_.pop_back();
+  return item;
+}
+void HOT Scheduler::process_to_add_() {
+  for (auto &item : this->to_add_) {
+    if (item->remove)
+      continue;
+    this->items_.push_back(std::move(item));
+    std::push_heap(this->items_.begin(), this->items_.end(), SchedulerItem::cmp);
+  }
+  this->to_add_.clear();
+}
+void HOT Scheduler::cleanup_() {
+  if (this->to_remove_ >= MAX_PENDING_REMOVALS) {
+    this->items_.erase(std::remove_if(this->items_.begin(), this->items_.end(),
+                                      [](const std::unique_ptr<SchedulerItem> &item) { return item->remove; }),
+                       this->items_.end());
+    std::make_heap(this->items_.begin(), this->items_.end(), SchedulerItem::cmp);
+    this->to_remove_ = 0;
+    return;
+  }
+
+  while (!this->items_.empty() && this->items_[0]->remove) {
+    this->pop_raw_();
+    this->to_remove_--;
+  }
+}
+bool HOT Scheduler::cancel_item_(Component *component, const std::string &name, Scheduler::SchedulerItem::Type type) {
+  if (name.empty())
+    return false;
+
+  bool ret = false;
+  for (auto &item : this->items_) {
+    if (!item->remove && item->component == component && item->type == type && item->name == name) {
+      ESP_LOGVV(TAG, "Removing old time function %s.", name.c_str());
+      item->remove = true;
+      this->to_remove_++;
+      ret = true;
+    }
+  }
+  for (auto &item : this->to_add_) {
+    if (!item->remove && item->component == component && item->type == type && item->name == name) {
+      ESP_LOGVV(TAG, "Removing old time function %s.", name.c_str());
+      // not in the heap yet, will be skipped by process_to_add_()
+      item->remove = true;
+      ret = true;
+    }
+  }
+  this->cleanup_();
+  return ret;
+}
+
+ESPHOME_NAMESPACE_END
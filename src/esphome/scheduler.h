@@ -0,0 +1,103 @@
+#ifndef ESPHOME_SCHEDULER_H
+#define ESPHOME_SCHEDULER_H
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "esphome/defines.h"
+#include "esphome/optional.h"
+
+ESPHOME_NAMESPACE_BEGIN
+
+class Component;
+
+/// Interval/timeout value that disables the time function completely.
+extern const uint32_t SCHEDULER_DONT_RUN;
+
+/** Application-wide scheduler for timeout, interval and defer functions.
+ *
+ * All time functions of all components are stored in a single min-heap keyed on their next
+ * execution time. That way the main loop only needs to look at the top of the heap to see if
+ * anything is due, instead of scanning every timer of every component each loop. It can
+ * also be asked for how long it's safe to sleep until the next timer fires.
+ *
+ * Time is tracked as a 64-bit millisecond counter internally so that the ~49 day rollover
+ * of millis() doesn't break the heap ordering.
+ */
+class Scheduler {
+ public:
+  void set_timeout(Component *component, const std::string &name, uint32_t timeout, std::function<void()> &&func);
+  bool cancel_timeout(Component *component, const std::string &name);
+  void set_interval(Component *component, const std::string &name, uint32_t interval, std::function<void()> &&func);
+  /** Set an interval that runs phase ms into each period of the scheduler time base.
+   *
+   * Like set_interval() the function runs once right away, but all later executions happen at a fixed phase
+   * instead of a random one, see next_phase(). A phase point less than half an interval after the previous
+   * execution is skipped.
+   */
+  void set_phased_interval(Component *component, const std::string &name, uint32_t interval, uint32_t phase,
+                           std::function<void()> &&func);
+  bool cancel_interval(Component *component, const std::string &name);
+  void defer(Component *component, const std::string &name, std::function<void()> &&func);
+  bool cancel_defer(Component *component, const std::string &name);
+
+  /// Time in ms until the next time function is due, 0 if one is due now and empty if none are scheduled.
+  optional<uint32_t> next_schedule_in();
+
+  /// Run all time functions that are due.
+  void call();
+
+  /** Get the phase for the next interval with the given period.
+   *
+   * The n-th call for a period returns the period scaled by the bit-reversed n (0, 1/2, 1/4, 3/4, 1/8, ...), so
+   * however many intervals share a period, their executions are spread evenly across it instead of firing
+   * back-to-back.
+   */
+  uint32_t next_phase(uint32_t interval);
+
+ protected:
+  struct SchedulerItem {
+    Component *component;
+    std::string name;
+    enum Type { TIMEOUT, INTERVAL, DEFER } type;
+    uint32_t interval;
+    /// For intervals, the executions happen at this offset into each period of the scheduler time base.
+    uint32_t phase;
+    /// The time (in the 64-bit scheduler time base) this function should run next.
+    uint64_t next_execution;
+    /// Insertion order, used for breaking ties so that items with equal deadlines run in FIFO order.
+    uint32_t order;
+    std::function<void()> f;
+    bool remove;
+
+    /// Heap comparator, "a < b" means a should run *after* b (std heap functions build a max-heap).
+    static bool cmp(const std::unique_ptr<SchedulerItem> &a, const std::unique_ptr<SchedulerItem> &b);
+  };
+
+  uint64_t millis_();
+  void call_item_(SchedulerItem *item);
+  void push_(std::unique_ptr<SchedulerItem> item);
+  std::unique_ptr<SchedulerItem> pop_raw_();
+  /// Move newly scheduled items into the heap.
+  void process_to_add_();
+  /// Remove cancelled items from the top of the heap (and from the whole heap if too many have piled up).
+  void cleanup_();
+  bool cancel_item_(Component *component, const std::string &name, SchedulerItem::Type type);
+  void push_interval_(Component *component, const std::string &name, uint32_t interval, uint32_t phase,
+                      std::function<void()> &&func);
+
+  std::vector<std::unique_ptr<SchedulerItem>> items_;
+  /// Items scheduled during call(), added to the heap at the start of the next call().
+  std::vector<std::unique_ptr<SchedulerItem>> to_add_;
+  uint32_t to_remove_{0};
+  uint32_t next_order_{0};
+  uint32_t last_millis_{0};
+  uint32_t millis_major_{0};
+  /// The number of phases handed out by next_phase(), by period.
+  std::vector<std::pair<uint32_t, uint32_t>> phase_counts_;
+};
+
+ESPHOME_NAMESPACE_END
+
+#endif  // ESPHOME_SCHEDULER_H
@@ -2,16 +2,27 @@
 
 #ifdef USE_ADC_SENSOR
 
+#include <algorithm>
+#include <cmath>
 #include "esphome/sensor/adc.h"
 
 #include "esphome/log.h"
 
+#ifdef ARDUINO_ARCH_ESP32
+#include <driver/i2s.h>
+#endif
+
 ESPHOME_NAMESPACE_BEGIN
 
 namespace sensor {
 
 static const char *TAG = "sensor.adc";
 
+#ifdef ARDUINO_ARCH_ESP32
+/// Whether an ADC sensor already uses I2S_NUM_0, the only I2S peripheral that can sample the ADC.
+static bool i2s_adc_in_use = false;
+#endif
+
 ADCSensorComponent::ADCSensorComponent(const std::string &name, GPIOInputPin pin, uint32_t update_interval)
     : PollingSensorComponent(name, update_interval), pin_(pin) {}
 
@@ -19,13 +30,58 @@ ADCSensorComponent::ADCSensorComponent(const std::string &name, GPIOInputPin pin
 adc_attenuation_t ADCSensorComponent::get_attenuation() const { return this->attenuation_; }
 void ADCSensorComponent::set_attenuation(adc_attenuation_t attenuation) { this->attenuation_ = attenuation; }
 #endif
+void ADCSensorComponent::set_burst(uint32_t sample_rate, uint32_t sample_count, ADCBurstAggregation aggregation) {
+  this->burst_sample_rate_ = sample_rate;
+  this->burst_sample_count_ = sample_count;
+  this->burst_aggregation_ = aggregation;
+}
+void ADCSensorComponent::add_on_burst_samples_callback(
+    std::function<void(const uint16_t *samples, size_t count)> &&callback) {
+  this->burst_samples_callback_.add(std::move(callback));
+}
+uint32_t ADCSensorComponent::get_burst_sample_rate() const { return this->burst_sample_rate_; }
 
 void ADCSensorComponent::setup() {
   ESP_LOGCONFIG(TAG, "Setting up ADC '%s'...", this->get_name().c_str());
   this->pin_.setup();
+  if (this->burst_sample_count_ == 0)
+    this->burst_sample_rate_ = 0;
 
 #ifdef ARDUINO_ARCH_ESP32
   analogSetPinAttenuation(this->pin_.get_pin(), this->attenuation_);
+
+  if (this->burst_sample_rate_ == 0) {
+    this->disable_loop();
+    return;
+  }
+
+  const int8_t channel = digitalPinToAnalogChannel(this->pin_.get_pin());
+  if (i2s_adc_in_use || channel < 0 || channel >= ADC1_CHANNEL_MAX) {
+    ESP_LOGE(TAG, "Burst sampling needs an ADC1 pin and can only be used by one ADC sensor!");
+    this->mark_failed();
+    return;
+  }
+
+  i2s_config_t config{};
+  config.mode = i2s_mode_t(I2S_MODE_MASTER | I2S_MODE_RX | I2S_MODE_ADC_BUILT_IN);
+  config.sample_rate = this->burst_sample_rate_;
+  config.bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT;
+  config.channel_format = I2S_CHANNEL_FMT_ONLY_LEFT;
+  config.communication_format = I2S_COMM_FORMAT_I2S_MSB;
+  config.intr_alloc_flags = 0;
+  config.dma_buf_count = 4;
+  config.dma_buf_len = 256;
+  config.use_apll = false;
+  if (i2s_driver_install(I2S_NUM_0, &config, 0, nullptr) != ESP_OK ||
+      i2s_set_adc_mode(ADC_UNIT_1, adc1_channel_t(channel)) != ESP_OK) {
+    ESP_LOGE(TAG, "Setting up I2S sampling failed!");
+    this->mark_failed();
+    return;
+  }
+  i2s_adc_in_use = true;
+  i2s_stop(I2S_NUM_0);
+  // loop() only runs while a burst is being collected
+  this->disable_loop();
 #endif
 }
 void ADCSensorComponent::dump_config() {
@@ -54,26 +110,82 @@ void ADCSensorComponent::dump_config() {
       break;
   }
 #endif
+  if (this->burst_sample_rate_ != 0) {
+    static const char *const AGGREGATIONS[] = {"mean", "min", "max", "RMS", "AC RMS"};
+    ESP_LOGCONFIG(TAG, "  Burst: %u samples at %u Hz, %s", this->burst_sample_count_, this->burst_sample_rate_,
+                  AGGREGATIONS[this->burst_aggregation_]);
+  }
   LOG_UPDATE_INTERVAL(this);
 }
 float ADCSensorComponent::get_setup_priority() const { return setup_priority::HARDWARE_LATE; }
-void ADCSensorComponent::update() {
+float ADCSensorComponent::get_full_scale_() const {
 #ifdef ARDUINO_ARCH_ESP32
-  float value_v = analogRead(this->pin_.get_pin()) / 4095.0f;
   switch (this->attenuation_) {
     case ADC_0db:
-      value_v *= 1.1;
-      break;
+      return 1.1f;
     case ADC_2_5db:
-      value_v *= 1.5;
-      break;
+      return 1.5f;
     case ADC_6db:
-      value_v *= 2.2;
-      break;
+      return 2.2f;
     case ADC_11db:
-      value_v *= 3.9;
-      break;
+      return 3.9f;
+  }
+#endif
+  return 1.0f;
+}
+uint32_t ADCSensorComponent::get_max_raw_() const {
+#ifdef ARDUINO_ARCH_ESP32
+  return 4095;
+#endif
+#ifdef ARDUINO_ARCH_ESP8266
+  return 1024;
+#endif
+}
+void ADCSensorComponent::update() {
+  if (this->burst_sample_rate_ != 0) {
+    this->burst_count_ = 0;
+    this->burst_sum_ = 0;
+    this->burst_sum_squares_ = 0;
+    this->burst_min_ = UINT32_MAX;
+    this->burst_max_ = 0;
+#ifdef ARDUINO_ARCH_ESP32
+    if (this->burst_running_) {
+      // the last burst isn't done yet, start over
+      i2s_adc_disable(I2S_NUM_0);
+      i2s_stop(I2S_NUM_0);
+    }
+    i2s_start(I2S_NUM_0);
+    i2s_adc_enable(I2S_NUM_0);
+    this->burst_running_ = true;
+    this->enable_loop();
+#endif
+#ifdef ARDUINO_ARCH_ESP8266
+    const uint32_t period = 1000000UL / this->burst_sample_rate_;
+    uint16_t samples[32];
+    size_t pending = 0;
+    uint32_t next = micros();
+    for (uint32_t i = 0; i < this->burst_sample_count_; i++) {
+      while (int32_t(micros() - next) < 0) {
+      }
+      next += period;
+#ifdef USE_ADC_SENSOR_VCC
+      samples[pending++] = ESP.getVcc();
+#else
+      samples[pending++] = analogRead(this->pin_.get_pin());
+#endif
+      if (pending == 32) {
+        this->add_burst_samples_(samples, pending);
+        pending = 0;
+      }
+    }
+    this->add_burst_samples_(samples, pending);
+    this->publish_burst_();
+#endif
+    return;
   }
+
+#ifdef ARDUINO_ARCH_ESP32
+  float value_v = analogRead(this->pin_.get_pin()) / 4095.0f * this->get_full_scale_();
 #endif
 
 #ifdef ARDUINO_ARCH_ESP8266
@@ -88,8 +200,78 @@ void ADCSensorComponent::update() {
 
   this->publish_state(value_v);
 }
-std::string ADCSensorComponent::unit_of_measurement() { return "V"; }
-std::string ADCSensorComponent::icon() { return "mdi:flash"; }
+#ifdef ARDUINO_ARCH_ESP32
+void ADCSensorComponent::loop() {
+  uint16_t samples[128];
+  size_t bytes_read = 0;
+  while (this->burst_running_) {
+    if (i2s_read(I2S_NUM_0, samples, sizeof(samples), &bytes_read, 0) != ESP_OK || bytes_read == 0)
+      return;
+    size_t count = bytes_read / sizeof(uint16_t);
+    count = std::min<size_t>(count, this->burst_sample_count_ - this->burst_count_);
+    // the upper 4 bits are the channel
+    for (size_t i = 0; i < count; i++)
+      samples[i] &= 0x0FFF;
+    this->add_burst_samples_(samples, count);
+    if (this->burst_count_ < this->burst_sample_count_)
+      continue;
+
+    i2s_adc_disable(I2S_NUM_0);
+    i2s_stop(I2S_NUM_0);
+    this->burst_running_ = false;
+    this->disable_loop();
+    this->publish_burst_();
+    return;
+  }
+}
+#endif
+void ADCSensorComponent::add_burst_sample_(uint32_t raw) {
+  this->burst_count_++;
+  this->burst_sum_ += raw;
+  this->burst_sum_squares_ += uint64_t(raw) * raw;
+  this->burst_min_ = std::min(this->burst_min_, raw);
+  this->burst_max_ = std::max(this->burst_max_, raw);
+}
+void ADCSensorComponent::add_burst_samples_(const uint16_t *samples, size_t count) {
+  if (count == 0)
+    return;
+  for (size_t i = 0; i < count; i++)
+    this->add_burst_sample_(samples[i]);
+  this->burst_samples_callback_.call(samples, count);
+}
+void ADCSensorComponent::publish_burst_() {
+  if (this->burst_count_ == 0)
+    return;
+
+  const float scale = this->get_full_scale_() / this->get_max_raw_();
+  const float mean = float(this->burst_sum_) / this->burst_count_;
+  const float mean_squares = float(this->burst_sum_squares_) / this->burst_count_;
+  float value;
+  switch (this->burst_aggregation_) {
+    case ADC_BURST_MIN:
+      value = this->burst_min_;
+      break;
+    case ADC_BURST_MAX:
+      value = this->burst_max_;
+      break;
+    case ADC_BURST_RMS:
+      value = sqrtf(mean_squares);
+      break;
+    case ADC_BURST_AC_RMS:
+      value = sqrtf(std::max(0.0f, mean_squares - mean * mean));
+      break;
+    case ADC_BURST_MEAN:
+    default:
+      value = mean;
+      break;
+  }
+  value *= scale;
+
+  ESP_LOGD(TAG, "'%s': Got voltage=%.3fV from %u samples", this->get_name().c_str(), value, this->burst_count_);
+  this->publish_state(value);
+}
+const char *ADCSensorComponent::unit_of_measurement() { return "V"; }
+const char *ADCSensorComponent::icon() { return "mdi:flash"; }
 int8_t ADCSensorComponent::accuracy_decimals() { return 2; }
 #ifdef ARDUINO_ARCH_ESP8266
 std::string ADCSensorComponent::unique_id() { return get_mac_address() + "-adc"; }
@@ -13,6 +13,17 @@ ESPHOME_NAMESPACE_BEGIN
 
 namespace sensor {
 
+/// How the samples of a burst are combined into the published value.
+enum ADCBurstAggregation {
+  ADC_BURST_MEAN = 0,
+  ADC_BURST_MIN,
+  ADC_BURST_MAX,
+  /// Root mean square of the voltages.
+  ADC_BURST_RMS,
+  /// Root mean square with the mean removed, for AC signals biased to a DC level like CT clamps.
+  ADC_BURST_AC_RMS,
+};
+
 /** This class allows using the integrated Analog to Digital converts of the ESP32 and ESP8266.
  *
  * Internally it uses the existing `analogRead` methods for doing this.
@@ -33,6 +44,19 @@ class ADCSensorComponent : public PollingSensorComponent {
   void set_attenuation(adc_attenuation_t attenuation);
 #endif
 
+  /** Sample in bursts and publish an aggregate of each burst instead of one reading per update.
+   *
+   * Every update, sample_count samples are taken at sample_rate Hz and only their mean, min, max or RMS is
+   * published. On the ESP32 the samples are taken by the I2S peripheral with DMA in the background, which only
+   * one ADC sensor can use and only with ADC1 pins. On the ESP8266 the burst is sampled in update() and blocks
+   * for its duration, so keep it short.
+   */
+  void set_burst(uint32_t sample_rate, uint32_t sample_count, ADCBurstAggregation aggregation);
+
+  /// Get the raw readings of each burst as they come in, for example for spectrum analysis.
+  void add_on_burst_samples_callback(std::function<void(const uint16_t *samples, size_t count)> &&callback);
+  uint32_t get_burst_sample_rate() const;
+
   // ========== INTERNAL METHODS ==========
   // (In most use cases you won't need these)
   /// Get the pin used for this ADC sensor.
@@ -45,11 +69,15 @@ class ADCSensorComponent : public PollingSensorComponent {
   void update() override;
   /// Setup ADc
   void setup() override;
+#ifdef ARDUINO_ARCH_ESP32
+  /// Collect the samples of a burst.
+  void loop() override;
+#endif
   void dump_config() override;
   /// Unit of measurement: "V".
-  std::string unit_of_measurement() override;
+  const char *unit_of_measurement() override;
   /// Icon: "mdi:flash".
-  std::string icon() override;
+  const char *icon() override;
   /// Accuracy decimals: 2.
   int8_t accuracy_decimals() override;
   /// `HARDWARE_LATE` setup priority.
@@ -60,11 +88,31 @@ class ADCSensorComponent : public PollingSensorComponent {
 #endif
 
  protected:
+  /// The voltage of the largest raw reading.
+  float get_full_scale_() const;
+  uint32_t get_max_raw_() const;
+  void add_burst_sample_(uint32_t raw);
+  void add_burst_samples_(const uint16_t *samples, size_t count);
+  void publish_burst_();
+
   GPIOInputPin pin_;
 
 #ifdef ARDUINO_ARCH_ESP32
   adc_attenuation_t attenuation_{ADC_0db};
+  /// Whether the I2S peripheral is collecting a burst.
+  bool burst_running_{false};
 #endif
+  /// 0 for single readings.
+  uint32_t burst_sample_rate_{0};
+  uint32_t burst_sample_count_{0};
+  ADCBurstAggregation burst_aggregation_{ADC_BURST_MEAN};
+  /// Statistics of the burst so far, in raw readings.
+  uint32_t burst_count_{0};
+  uint32_t burst_sum_{0};
+  uint64_t burst_sum_squares_{0};
+  uint32_t burst_min_{0};
+  uint32_t burst_max_{0};
+  CallbackManager<void(const uint16_t *, size_t)> burst_samples_callback_;
 };
 
 }  // namespace sensor
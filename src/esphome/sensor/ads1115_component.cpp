@@ -3,6 +3,7 @@
 #ifdef USE_ADS1115_SENSOR
 
 #include "esphome/log.h"
+#include "esphome/helpers.h"
 #include "esphome/sensor/ads1115_component.h"
 
 ESPHOME_NAMESPACE_BEGIN
@@ -12,6 +13,8 @@ namespace sensor {
 static const char *TAG = "sensor.ads1115";
 static const uint8_t ADS1115_REGISTER_CONVERSION = 0x00;
 static const uint8_t ADS1115_REGISTER_CONFIG = 0x01;
+static const uint8_t ADS1115_REGISTER_LO_THRESH = 0x02;
+static const uint8_t ADS1115_REGISTER_HI_THRESH = 0x03;
 
 static const uint8_t ADS1115_DATA_RATE_860_SPS = 0b111;
 
@@ -54,14 +57,41 @@ void ADS1115Component::setup() {
   //        0bxxxxxxxxxxxxx0xx
   config |= 0b0000000000000000;
 
-  // Set comparator que mode - disabled
-  //        0bxxxxxxxxxxxxxx11
-  config |= 0b0000000000000011;
+  if (this->ready_pin_ != nullptr) {
+    // Continuous mode, comparator que mode - assert after one conversion. With the MSB of the high threshold
+    // set and the one of the low threshold cleared, ALERT/RDY pulses low after each conversion.
+    config &= 0b1111111011111111;
+    if (!this->write_byte_16(ADS1115_REGISTER_HI_THRESH, 0x8000) ||
+        !this->write_byte_16(ADS1115_REGISTER_LO_THRESH, 0x0000)) {
+      this->mark_failed();
+      return;
+    }
+  } else {
+    // Set comparator que mode - disabled
+    //        0bxxxxxxxxxxxxxx11
+    config |= 0b0000000000000011;
+  }
 
   if (!this->write_byte_16(ADS1115_REGISTER_CONFIG, config)) {
     this->mark_failed();
     return;
   }
+
+  if (this->ready_pin_ != nullptr) {
+    this->config_ = config & 0b1000000111111111;
+    this->accumulators_.resize(this->sensors_.size(), Accumulator{0, 0});
+    this->ready_pin_->setup();
+    this->ready_pin_->attach_interrupt(ADS1115ReadyStore::gpio_intr, &this->store_, FALLING);
+    if (!this->sensors_.empty())
+      this->write_continuous_config_();
+    for (size_t i = 0; i < this->sensors_.size(); i++) {
+      this->set_interval(this->sensors_[i]->get_name(), this->sensors_[i]->update_interval(),
+                         [this, i] { this->publish_average_(i); });
+    }
+    return;
+  }
+
+  this->disable_loop();
   for (auto *sensor : this->sensors_) {
     this->set_interval(sensor->get_name(), sensor->update_interval(),
                        [this, sensor] { this->request_measurement_(sensor); });
@@ -73,6 +103,9 @@ void ADS1115Component::dump_config() {
   if (this->is_failed()) {
     ESP_LOGE(TAG, "Communication with ADS1115 failed!");
   }
+  if (this->ready_pin_ != nullptr) {
+    LOG_PIN("  Ready Pin: ", this->ready_pin_);
+  }
 
   for (auto *sensor : this->sensors_) {
     LOG_SENSOR("  ", "Sensor", sensor);
@@ -81,10 +114,82 @@ void ADS1115Component::dump_config() {
   }
 }
 float ADS1115Component::get_setup_priority() const { return setup_priority::HARDWARE_LATE; }
+void ADS1115Component::loop() {
+  // only runs in continuous mode
+  if (this->sensors_.empty())
+    return;
+  if (!this->store_.ready) {
+    if (millis() - this->last_ready_ > 100) {
+      ESP_LOGW(TAG, "No conversion ready signal from ADS1115, restarting conversion...");
+      this->status_set_warning();
+      this->write_continuous_config_();
+    }
+    return;
+  }
+  this->store_.ready = false;
+  this->last_ready_ = millis();
+  if (this->discard_) {
+    this->discard_ = false;
+    return;
+  }
+
+  uint16_t raw_conversion;
+  if (!this->read_byte_16(ADS1115_REGISTER_CONVERSION, &raw_conversion)) {
+    this->status_set_warning();
+    return;
+  }
+  auto &accumulator = this->accumulators_[this->channel_];
+  accumulator.sum += static_cast<int16_t>(raw_conversion);
+  accumulator.count++;
+  this->status_clear_warning();
+
+  if (this->sensors_.size() > 1) {
+    this->channel_ = (this->channel_ + 1) % this->sensors_.size();
+    this->write_continuous_config_();
+  }
+}
+void ADS1115Component::write_continuous_config_() {
+  ADS1115Sensor *sensor = this->sensors_[this->channel_];
+  uint16_t config = this->config_;
+  config |= (sensor->get_multiplexer() & 0b111) << 12;
+  config |= (sensor->get_gain() & 0b111) << 9;
+  this->last_ready_ = millis();
+  this->discard_ = true;
+  if (!this->write_byte_16(ADS1115_REGISTER_CONFIG, config))
+    this->status_set_warning();
+}
+void ADS1115Component::publish_average_(size_t index) {
+  ADS1115Sensor *sensor = this->sensors_[index];
+  auto &accumulator = this->accumulators_[index];
+  if (accumulator.count == 0) {
+    ESP_LOGW(TAG, "'%s': No conversions since the last update!", sensor->get_name().c_str());
+    return;
+  }
+  float v = raw_to_volts_(sensor, float(accumulator.sum) / accumulator.count);
+  ESP_LOGD(TAG, "'%s': Got Voltage=%fV (%u conversions)", sensor->get_name().c_str(), v, accumulator.count);
+  accumulator.sum = 0;
+  accumulator.count = 0;
+  sensor->publish_state(v);
+}
+void ICACHE_RAM_ATTR HOT ADS1115ReadyStore::gpio_intr(ADS1115ReadyStore *arg) {
+  arg->ready = true;
+  wake_loop();
+}
 void ADS1115Component::request_measurement_(ADS1115Sensor *sensor) {
+  // the sensors share a single converter, so conversions are queued and run one after another
+  for (auto *queued : this->queue_) {
+    if (queued == sensor)
+      return;
+  }
+  this->queue_.push_back(sensor);
+  if (this->queue_.size() == 1)
+    this->start_conversion_();
+}
+void ADS1115Component::start_conversion_() {
+  ADS1115Sensor *sensor = this->queue_.front();
   uint16_t config;
   if (!this->read_byte_16(ADS1115_REGISTER_CONFIG, &config)) {
-    this->status_set_warning();
+    this->finish_conversion_(false);
     return;
   }
   // Multiplexer
@@ -100,30 +205,42 @@ void ADS1115Component::request_measurement_(ADS1115Sensor *sensor) {
   config |= 0b1000000000000000;
 
   if (!this->write_byte_16(ADS1115_REGISTER_CONFIG, config)) {
-    this->status_set_warning();
+    this->finish_conversion_(false);
     return;
   }
 
   // about 1.6 ms with 860 samples per second
-  delay(2);
-
-  uint32_t start = millis();
-  while (this->read_byte_16(ADS1115_REGISTER_CONFIG, &config) && (config >> 15) == 0) {
-    if (millis() - start > 100) {
+  this->conversion_start_ = millis();
+  this->set_timeout("conversion", 2, [this] { this->poll_conversion_(); });
+}
+void ADS1115Component::poll_conversion_() {
+  uint16_t config;
+  if (!this->read_byte_16(ADS1115_REGISTER_CONFIG, &config)) {
+    this->finish_conversion_(false);
+    return;
+  }
+  if ((config >> 15) == 0) {
+    if (millis() - this->conversion_start_ > 100) {
       ESP_LOGW(TAG, "Reading ADS1115 timed out");
-      this->status_set_warning();
+      this->finish_conversion_(false);
       return;
     }
-    yield();
+    this->set_timeout("conversion", 1, [this] { this->poll_conversion_(); });
+    return;
   }
 
+  ADS1115Sensor *sensor = this->queue_.front();
   uint16_t raw_conversion;
   if (!this->read_byte_16(ADS1115_REGISTER_CONVERSION, &raw_conversion)) {
-    this->status_set_warning();
+    this->finish_conversion_(false);
     return;
   }
-  auto signed_conversion = static_cast<int16_t>(raw_conversion);
-
+  float v = raw_to_volts_(sensor, static_cast<int16_t>(raw_conversion));
+  ESP_LOGD(TAG, "'%s': Got Voltage=%fV", sensor->get_name().c_str(), v);
+  sensor->publish_state(v);
+  this->finish_conversion_(true);
+}
+float ADS1115Component::raw_to_volts_(ADS1115Sensor *sensor, float signed_conversion) {
   float millivolts;
   switch (sensor->get_gain()) {
     case ADS1115_GAIN_6P144:
@@ -147,11 +264,16 @@ void ADS1115Component::request_measurement_(ADS1115Sensor *sensor) {
     default:
       millivolts = NAN;
   }
-
-  float v = millivolts / 1000.0f;
-  ESP_LOGD(TAG, "'%s': Got Voltage=%fV", sensor->get_name().c_str(), v);
-  sensor->publish_state(v);
-  this->status_clear_warning();
+  return millivolts / 1000.0f;
+}
+void ADS1115Component::finish_conversion_(bool success) {
+  if (success)
+    this->status_clear_warning();
+  else
+    this->status_set_warning();
+  this->queue_.erase(this->queue_.begin());
+  if (!this->queue_.empty())
+    this->start_conversion_();
 }
 
 ADS1115Sensor *ADS1115Component::get_sensor(const std::string &name, ADS1115Multiplexer multiplexer, ADS1115Gain gain,
@@ -161,6 +283,7 @@ ADS1115Sensor *ADS1115Component::get_sensor(const std::string &name, ADS1115Mult
   return s;
 }
 ADS1115Component::ADS1115Component(I2CComponent *parent, uint8_t address) : I2CDevice(parent, address) {}
+void ADS1115Component::set_ready_pin(GPIOPin *ready_pin) { this->ready_pin_ = ready_pin; }
 
 uint8_t ADS1115Sensor::get_multiplexer() const { return this->multiplexer_; }
 void ADS1115Sensor::set_multiplexer(ADS1115Multiplexer multiplexer) { this->multiplexer_ = multiplexer; }
@@ -5,8 +5,10 @@
 
 #ifdef USE_ADS1115_SENSOR
 
+#include <vector>
 #include "esphome/sensor/sensor.h"
 #include "esphome/i2c_component.h"
+#include "esphome/esphal.h"
 
 ESPHOME_NAMESPACE_BEGIN
 
@@ -34,6 +36,21 @@ enum ADS1115Gain {
 
 class ADS1115Sensor;
 
+/// Store data in a class that doesn't use multiple-inheritance (vtables in flash)
+struct ADS1115ReadyStore {
+  volatile bool ready{false};
+
+  static void gpio_intr(ADS1115ReadyStore *arg);
+};
+
+/** Hub for the sensors of one ADS1115.
+ *
+ * By default each sensor starts a single-shot conversion every update interval, the conversions are queued and
+ * their end is polled with scheduler timeouts. With a ready pin (the ALERT/RDY pin of the ADS1115), the
+ * ADS1115 converts continuously instead: the pin signals each finished conversion with an interrupt, the hub reads
+ * it and switches to the next sensor's channel, round robin. Each sensor publishes the average of the
+ * conversions of its channel since its last update, so its update interval only sets the publish rate.
+ */
 class ADS1115Component : public Component, public I2CDevice {
  public:
   /** Construct the component hub for this ADS1115.
@@ -56,10 +73,14 @@ class ADS1115Component : public Component, public I2CDevice {
   ADS1115Sensor *get_sensor(const std::string &name, ADS1115Multiplexer multiplexer, ADS1115Gain gain,
                             uint32_t update_interval = 60000);
 
+  /// Convert continuously, with the ALERT/RDY pin of the ADS1115 as conversion-ready interrupt.
+  void set_ready_pin(GPIOPin *ready_pin);
+
   // ========== INTERNAL METHODS ==========
   // (In most use cases you won't need these)
   /// Set up the internal sensor array.
   void setup() override;
+  void loop() override;
   void dump_config() override;
   /// HARDWARE_LATE setup priority
   float get_setup_priority() const override;
@@ -67,8 +88,38 @@ class ADS1115Component : public Component, public I2CDevice {
  protected:
   /// Helper method to request a measurement from a sensor.
   void request_measurement_(ADS1115Sensor *sensor);
+  /// Start the conversion for the sensor at the front of the queue.
+  void start_conversion_();
+  /// Check if the running conversion is done without blocking, re-scheduling itself if it isn't.
+  void poll_conversion_();
+  /// Pop the front of the queue and start the next conversion, if any.
+  void finish_conversion_(bool success);
+  /// Continuous mode: switch the converter to the channel of the current sensor.
+  void write_continuous_config_();
+  /// Continuous mode: publish the average of the conversions for the sensor at this index.
+  void publish_average_(size_t index);
+  static float raw_to_volts_(ADS1115Sensor *sensor, float raw);
 
   std::vector<ADS1115Sensor *> sensors_;
+  /// Sensors waiting for a conversion, the front one is currently converting.
+  std::vector<ADS1115Sensor *> queue_;
+  uint32_t conversion_start_{0};
+
+  struct Accumulator {
+    int64_t sum;
+    uint32_t count;
+  };
+  GPIOPin *ready_pin_{nullptr};
+  ADS1115ReadyStore store_;
+  /// The config register without multiplexer and gain.
+  uint16_t config_{0};
+  /// The sum of the conversions of each sensor since its last publish, same order as sensors_.
+  std::vector<Accumulator> accumulators_;
+  /// The index of the sensor that's converting.
+  size_t channel_{0};
+  /// The conversion running while switching channels still uses the old one.
+  bool discard_{false};
+  uint32_t last_ready_{0};
 };
 
 /// Internal holder class that is in instance of Sensor so that the hub can create individual sensors.
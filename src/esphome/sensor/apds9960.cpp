@@ -11,6 +11,13 @@ namespace sensor {
 
 static const char *TAG = "sensor.apds9960";
 
+/// The most bytes the Wire library can receive in one transaction.
+#ifdef ARDUINO_ARCH_ESP32
+static const uint8_t APDS9960_MAX_RECEIVE = I2C_BUFFER_LENGTH;
+#else
+static const uint8_t APDS9960_MAX_RECEIVE = BUFFER_LENGTH;
+#endif
+
 #define APDS9960_ERROR_CHECK(func) \
   if (!func) { \
     this->mark_failed(); \
@@ -109,6 +116,9 @@ void APDS9960::setup() {
   // 0x00 -> all dimensions, 0x01 -> up down, 0x02 -> left right
   APDS9960_WRITE_BYTE(0xAA, 0x00);
 
+  // GConf 4 (0xAB, gesture config 4) -> 0x02 with the INT pin (gesture interrupt enabled), otherwise 0x00
+  APDS9960_WRITE_BYTE(0xAB, this->interrupt_pin_ != nullptr ? 0x02 : 0x00);
+
   // Enable (0x80) ->
   val = 0;
   val |= (0b1) << 0;  // power on
@@ -119,6 +129,15 @@ void APDS9960::setup() {
   val |= 0b0 << 5;                                  // proximity interrupt disabled
   val |= (this->is_gesture_enabled_() & 0b1) << 6;  // proximity is required for gestures
   APDS9960_WRITE_BYTE(0x80, val);
+
+  if (!this->is_gesture_enabled_()) {
+    this->disable_loop();
+  } else if (this->interrupt_pin_ != nullptr) {
+    this->interrupt_pin_->setup();
+    // INT is active low, and stays low while the gesture FIFO is above the threshold
+    this->interrupt_pin_->attach_interrupt(APDS9960InterruptStore::gpio_intr, &this->store_, FALLING);
+    this->store_.triggered = !this->interrupt_pin_->digital_read();
+  }
 }
 bool APDS9960::is_color_enabled_() const {
   return this->red_channel_ != nullptr || this->green_channel_ != nullptr || this->blue_channel_ != nullptr ||
@@ -128,6 +147,7 @@ bool APDS9960::is_color_enabled_() const {
 void APDS9960::dump_config() {
   ESP_LOGCONFIG(TAG, "APDS9960:");
   LOG_I2C_DEVICE(this);
+  LOG_PIN("  Interrupt Pin: ", this->interrupt_pin_);
 
   LOG_UPDATE_INTERVAL(this);
   if (this->is_failed()) {
@@ -161,7 +181,27 @@ void APDS9960::update() {
   this->read_proximity_data_(status);
 }
 
-void APDS9960::loop() { this->read_gesture_data_(); }
+uint32_t APDS9960::get_loop_idle_time() {
+  // with the INT pin, the interrupt wakes the loop
+  return this->interrupt_pin_ != nullptr ? SCHEDULER_DONT_RUN : 0;
+}
+void APDS9960::loop() {
+  if (this->interrupt_pin_ != nullptr && !this->store_.triggered)
+    // no gesture data
+    return;
+  // gesture polling isn't time critical, give the bus to other devices if it's busy
+  if (this->bus_budget_exhausted())
+    return;
+  this->store_.triggered = false;
+  this->read_gesture_data_();
+  if (this->interrupt_pin_ != nullptr && !this->interrupt_pin_->digital_read())
+    // more data arrived while reading, INT only goes high again once the FIFO is below the threshold
+    this->store_.triggered = true;
+}
+void ICACHE_RAM_ATTR HOT APDS9960InterruptStore::gpio_intr(APDS9960InterruptStore *arg) {
+  arg->triggered = true;
+  wake_loop();
+}
 
 void APDS9960::read_color_data_(uint8_t status) {
   if (!this->is_color_enabled_())
@@ -215,8 +255,11 @@ void APDS9960::read_gesture_data_() {
   if (!this->is_gesture_enabled_())
     return;
 
-  uint8_t status;
-  APDS9960_WARNING_CHECK(this->read_byte(0xAF, &status), "Reading gesture status failed.");
+  // GFLVL (0xAE) and GSTATUS (0xAF) in one read
+  uint8_t gesture_status[2];
+  APDS9960_WARNING_CHECK(this->read_bytes(0xAE, gesture_status, 2), "Reading gesture status failed.");
+  const uint8_t fifo_level = gesture_status[0];
+  const uint8_t status = gesture_status[1];
 
   if ((status & 0b01) == 0) {
     // GVALID is false
@@ -227,21 +270,23 @@ void APDS9960::read_gesture_data_() {
     ESP_LOGV(TAG, "FIFO buffer has filled to capacity!");
   }
 
-  uint8_t fifo_level;
-  APDS9960_WARNING_CHECK(this->read_byte(0xAE, &fifo_level), "Reading FIFO level failed.");
   if (fifo_level == 0)
     // no data to process
     return;
 
   APDS9960_WARNING_CHECK(fifo_level <= 32, "FIFO level has invalid value.")
 
+  // Drain the FIFO with one block read from 0xFC, the register pointer wraps around within 0xFC-0xFF while
+  // there's data. If the Wire library can't receive that much at once, the rest is received without writing the
+  // register again, so the pointer continues.
   uint8_t buf[128];
-  for (uint8_t pos = 0; pos < fifo_level * 4; pos += 32) {
-    // The ESP's i2c driver has a limited buffer size.
-    // This way of retrieving the data should be wrong according to the datasheet
-    // but it seems to work.
-    uint8_t read = std::min(32, fifo_level * 4 - pos);
-    APDS9960_WARNING_CHECK(this->read_bytes(0xFC + pos, buf + pos, read), "Reading FIFO buffer failed.");
+  const uint8_t len = fifo_level * 4;
+  const uint8_t reg = 0xFC;
+  uint8_t read = std::min(APDS9960_MAX_RECEIVE, len);
+  APDS9960_WARNING_CHECK(this->write_read(&reg, 1, buf, read), "Reading FIFO buffer failed.");
+  for (uint8_t pos = read; pos < len; pos += read) {
+    read = std::min<uint8_t>(APDS9960_MAX_RECEIVE, len - pos);
+    APDS9960_WARNING_CHECK(this->parent_->raw_receive(this->address_, buf + pos, read), "Reading FIFO buffer failed.");
   }
 
   if (millis() - this->gesture_start_ > 500) {
@@ -251,7 +296,7 @@ void APDS9960::read_gesture_data_() {
     this->gesture_right_started_ = false;
   }
 
-  for (uint32_t i = 0; i < fifo_level * 4; i += 4) {
+  for (uint32_t i = 0; i < len; i += 4) {
     const int up = buf[i + 0];  // NOLINT
     const int down = buf[i + 1];
     const int left = buf[i + 2];
@@ -376,6 +421,7 @@ bool APDS9960::is_gesture_enabled_() const {
 }
 APDS9960::APDS9960(I2CComponent *parent, uint32_t update_interval)
     : PollingComponent(update_interval), I2CDevice(parent, 0x39) {}
+void APDS9960::set_interrupt_pin(GPIOPin *interrupt_pin) { this->interrupt_pin_ = interrupt_pin; }
 APDS9960ColorChannelSensor *APDS9960::make_clear_channel(const std::string &name) {
   return this->clear_channel_ = new APDS9960ColorChannelSensor(name, this);
 }
@@ -9,6 +9,7 @@
 #include "esphome/binary_sensor/binary_sensor.h"
 #include "esphome/i2c_component.h"
 #include "esphome/component.h"
+#include "esphome/esphal.h"
 
 ESPHOME_NAMESPACE_BEGIN
 
@@ -18,14 +19,28 @@ using APDS9960ColorChannelSensor = sensor::EmptyPollingParentSensor<1, ICON_LIGH
 using APDS9960ProximitySensor = sensor::EmptyPollingParentSensor<1, ICON_LIGHTBULB, UNIT_PERCENT>;
 class APDS9960GestureDirectionBinarySensor;
 
+/// Store for the INT pin of the APDS9960, set from the interrupt when gesture data is available.
+struct APDS9960InterruptStore {
+  volatile bool triggered{false};
+
+  static void gpio_intr(APDS9960InterruptStore *arg);
+};
+
 class APDS9960 : public PollingComponent, public I2CDevice {
  public:
   APDS9960(I2CComponent *parent, uint32_t update_interval = 60000);
+  /** Use the INT pin of the APDS9960 to know when gesture data is available.
+   *
+   * Without it, the gesture status is polled over I2C in every loop. With it, the FIFO is only read after the
+   * interrupt, so there's no I2C traffic while no gesture is going on.
+   */
+  void set_interrupt_pin(GPIOPin *interrupt_pin);
   void setup() override;
   void dump_config() override;
   float get_setup_priority() const override;
   void update() override;
   void loop() override;
+  uint32_t get_loop_idle_time() override;
 
   APDS9960ColorChannelSensor *make_clear_channel(const std::string &name);
   APDS9960ColorChannelSensor *make_red_channel(const std::string &name);
@@ -56,6 +71,8 @@ class APDS9960 : public PollingComponent, public I2CDevice {
   APDS9960GestureDirectionBinarySensor *down_direction_{nullptr};
   APDS9960GestureDirectionBinarySensor *left_direction_{nullptr};
   APDS9960ProximitySensor *proximity_{nullptr};
+  GPIOPin *interrupt_pin_{nullptr};
+  APDS9960InterruptStore store_;
   enum ErrorCode {
     NONE = 0,
     COMMUNICATION_FAILED,
@@ -72,10 +72,11 @@ void BH1750Sensor::update() {
 
   this->set_timeout("illuminance", wait, [this]() { this->read_data_(); });
 }
-std::string BH1750Sensor::unit_of_measurement() { return UNIT_LX; }
-std::string BH1750Sensor::icon() { return ICON_BRIGHTNESS_5; }
+const char *BH1750Sensor::unit_of_measurement() { return UNIT_LX; }
+const char *BH1750Sensor::icon() { return ICON_BRIGHTNESS_5; }
 int8_t BH1750Sensor::accuracy_decimals() { return 1; }
 float BH1750Sensor::get_setup_priority() const { return setup_priority::HARDWARE_LATE; }
+uint32_t BH1750Sensor::get_loop_idle_time() { return SCHEDULER_DONT_RUN; }
 void BH1750Sensor::read_data_() {
   uint16_t raw_value;
   if (!this->parent_->raw_receive_16(this->address_, &raw_value, 1)) {
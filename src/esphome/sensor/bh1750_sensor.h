@@ -41,9 +41,10 @@ class BH1750Sensor : public PollingSensorComponent, public I2CDevice {
   void setup() override;
   void dump_config() override;
   void update() override;
+  uint32_t get_loop_idle_time() override;
   float get_setup_priority() const override;
-  std::string unit_of_measurement() override;
-  std::string icon() override;
+  const char *unit_of_measurement() override;
+  const char *icon() override;
   int8_t accuracy_decimals() override;
 
  protected:
@@ -18,25 +18,8 @@ namespace sensor {
 static const char *TAG = "sensor.bme280";
 
 static const uint8_t BME280_REGISTER_DIG_T1 = 0x88;
-static const uint8_t BME280_REGISTER_DIG_T2 = 0x8A;
-static const uint8_t BME280_REGISTER_DIG_T3 = 0x8C;
-
-static const uint8_t BME280_REGISTER_DIG_P1 = 0x8E;
-static const uint8_t BME280_REGISTER_DIG_P2 = 0x90;
-static const uint8_t BME280_REGISTER_DIG_P3 = 0x92;
-static const uint8_t BME280_REGISTER_DIG_P4 = 0x94;
-static const uint8_t BME280_REGISTER_DIG_P5 = 0x96;
-static const uint8_t BME280_REGISTER_DIG_P6 = 0x98;
-static const uint8_t BME280_REGISTER_DIG_P7 = 0x9A;
-static const uint8_t BME280_REGISTER_DIG_P8 = 0x9C;
-static const uint8_t BME280_REGISTER_DIG_P9 = 0x9E;
-
 static const uint8_t BME280_REGISTER_DIG_H1 = 0xA1;
 static const uint8_t BME280_REGISTER_DIG_H2 = 0xE1;
-static const uint8_t BME280_REGISTER_DIG_H3 = 0xE3;
-static const uint8_t BME280_REGISTER_DIG_H4 = 0xE4;
-static const uint8_t BME280_REGISTER_DIG_H5 = 0xE5;
-static const uint8_t BME280_REGISTER_DIG_H6 = 0xE7;
 
 static const uint8_t BME280_REGISTER_CHIPID = 0xD0;
 
@@ -45,12 +28,15 @@ static const uint8_t BME280_REGISTER_STATUS = 0xF3;
 static const uint8_t BME280_REGISTER_CONTROL = 0xF4;
 static const uint8_t BME280_REGISTER_CONFIG = 0xF5;
 static const uint8_t BME280_REGISTER_PRESSUREDATA = 0xF7;
-static const uint8_t BME280_REGISTER_TEMPDATA = 0xFA;
-static const uint8_t BME280_REGISTER_HUMIDDATA = 0xFD;
 
 static const uint8_t BME280_MODE_FORCED = 0b01;
 
 inline uint16_t combine_bytes(uint8_t msb, uint8_t lsb) { return ((msb & 0xFF) << 8) | (lsb & 0xFF); }
+inline uint16_t combine_bytes_le(const uint8_t *data) { return combine_bytes(data[1], data[0]); }
+/// The 20 bit value of a pressure or temperature data block (msb, lsb, xlsb).
+inline int32_t combine_bytes_20(const uint8_t *data) {
+  return (uint32_t(data[0]) << 12) | (data[1] << 4) | (data[2] >> 4);
+}
 
 BME280Component::BME280Component(I2CComponent *parent, const std::string &temperature_name,
                                  const std::string &pressure_name, const std::string &humidity_name, uint8_t address,
@@ -111,27 +97,37 @@ void BME280Component::setup() {
     return;
   }
 
-  // Read calibration
-  this->calibration_.t1 = read_u16_le_(BME280_REGISTER_DIG_T1);
-  this->calibration_.t2 = read_s16_le_(BME280_REGISTER_DIG_T2);
-  this->calibration_.t3 = read_s16_le_(BME280_REGISTER_DIG_T3);
-
-  this->calibration_.p1 = read_u16_le_(BME280_REGISTER_DIG_P1);
-  this->calibration_.p2 = read_s16_le_(BME280_REGISTER_DIG_P2);
-  this->calibration_.p3 = read_s16_le_(BME280_REGISTER_DIG_P3);
-  this->calibration_.p4 = read_s16_le_(BME280_REGISTER_DIG_P4);
-  this->calibration_.p5 = read_s16_le_(BME280_REGISTER_DIG_P5);
-  this->calibration_.p6 = read_s16_le_(BME280_REGISTER_DIG_P6);
-  this->calibration_.p7 = read_s16_le_(BME280_REGISTER_DIG_P7);
-  this->calibration_.p8 = read_s16_le_(BME280_REGISTER_DIG_P8);
-  this->calibration_.p9 = read_s16_le_(BME280_REGISTER_DIG_P9);
-
-  this->calibration_.h1 = read_u8_(BME280_REGISTER_DIG_H1);
-  this->calibration_.h2 = read_s16_le_(BME280_REGISTER_DIG_H2);
-  this->calibration_.h3 = read_u8_(BME280_REGISTER_DIG_H3);
-  this->calibration_.h4 = read_u8_(BME280_REGISTER_DIG_H4) << 4 | (read_u8_(BME280_REGISTER_DIG_H4 + 1) & 0x0F);
-  this->calibration_.h5 = read_u8_(BME280_REGISTER_DIG_H5 + 1) << 4 | (read_u8_(BME280_REGISTER_DIG_H5) >> 4);
-  this->calibration_.h6 = read_u8_(BME280_REGISTER_DIG_H6);
+  // Read calibration, in three bursts
+  uint8_t calibration[24];
+  uint8_t h1 = 0;
+  uint8_t calibration_h[7];
+  if (!this->read_bytes(BME280_REGISTER_DIG_T1, calibration, sizeof(calibration)) ||
+      !this->read_byte(BME280_REGISTER_DIG_H1, &h1) ||
+      !this->read_bytes(BME280_REGISTER_DIG_H2, calibration_h, sizeof(calibration_h))) {
+    this->error_code_ = COMMUNICATION_FAILED;
+    this->mark_failed();
+    return;
+  }
+  this->calibration_.t1 = combine_bytes_le(calibration + 0);
+  this->calibration_.t2 = combine_bytes_le(calibration + 2);
+  this->calibration_.t3 = combine_bytes_le(calibration + 4);
+
+  this->calibration_.p1 = combine_bytes_le(calibration + 6);
+  this->calibration_.p2 = combine_bytes_le(calibration + 8);
+  this->calibration_.p3 = combine_bytes_le(calibration + 10);
+  this->calibration_.p4 = combine_bytes_le(calibration + 12);
+  this->calibration_.p5 = combine_bytes_le(calibration + 14);
+  this->calibration_.p6 = combine_bytes_le(calibration + 16);
+  this->calibration_.p7 = combine_bytes_le(calibration + 18);
+  this->calibration_.p8 = combine_bytes_le(calibration + 20);
+  this->calibration_.p9 = combine_bytes_le(calibration + 22);
+
+  this->calibration_.h1 = h1;
+  this->calibration_.h2 = combine_bytes_le(calibration_h + 0);
+  this->calibration_.h3 = calibration_h[2];
+  this->calibration_.h4 = int8_t(calibration_h[3]) * 16 | (calibration_h[4] & 0x0F);
+  this->calibration_.h5 = int8_t(calibration_h[5]) * 16 | (calibration_h[4] >> 4);
+  this->calibration_.h6 = calibration_h[6];
 
   uint8_t humid_register = 0;
   if (!this->read_byte(BME280_REGISTER_CONTROLHUMID, &humid_register)) {
@@ -183,6 +179,7 @@ void BME280Component::dump_config() {
   ESP_LOGCONFIG(TAG, "    Oversampling: %s", oversampling_to_str(this->humidity_oversampling_));
 }
 float BME280Component::get_setup_priority() const { return setup_priority::HARDWARE_LATE; }
+uint32_t BME280Component::get_loop_idle_time() { return SCHEDULER_DONT_RUN; }
 
 inline uint8_t oversampling_to_time(BME280Oversampling over_sampling) { return (1 << uint8_t(over_sampling)) >> 1; }
 
@@ -204,15 +201,22 @@ void BME280Component::update() {
   meas_time += 2.3f * oversampling_to_time(this->humidity_oversampling_) + 0.575f;
 
   this->set_timeout("data", uint32_t(ceilf(meas_time)), [this]() {
+    // pressure (0xF7-0xF9), temperature (0xFA-0xFC) and humidity (0xFD-0xFE) in one burst, so they're consistent
+    uint8_t data[8];
+    if (!this->read_bytes(BME280_REGISTER_PRESSUREDATA, data, sizeof(data))) {
+      ESP_LOGW(TAG, "Error reading the measurement data.");
+      this->status_set_warning();
+      return;
+    }
     int32_t t_fine = 0;
-    float temperature = this->read_temperature_(&t_fine);
+    float temperature = this->compensate_temperature_(combine_bytes_20(data + 3), &t_fine);
     if (isnan(temperature)) {
       ESP_LOGW(TAG, "Invalid temperature, cannot read pressure & humidity values.");
       this->status_set_warning();
       return;
     }
-    float pressure = this->read_pressure_(t_fine);
-    float humidity = this->read_humidity_(t_fine);
+    float pressure = this->compensate_pressure_(combine_bytes_20(data + 0), t_fine);
+    float humidity = this->compensate_humidity_(combine_bytes(data[6], data[7]), t_fine);
 
     ESP_LOGD(TAG, "Got temperature=%.1f°C pressure=%.1fhPa humidity=%.1f%%", temperature, pressure, humidity);
     this->temperature_sensor_->publish_state(temperature);
@@ -221,12 +225,7 @@ void BME280Component::update() {
     this->status_clear_warning();
   });
 }
-float BME280Component::read_temperature_(int32_t *t_fine) {
-  uint8_t data[3];
-  if (!this->read_bytes(BME280_REGISTER_TEMPDATA, data, 3))
-    return NAN;
-  int32_t adc = ((data[0] & 0xFF) << 16) | ((data[1] & 0xFF) << 8) | (data[2] & 0xFF);
-  adc >>= 4;
+float BME280Component::compensate_temperature_(int32_t adc, int32_t *t_fine) {
   if (adc == 0x80000)
     // temperature was disabled
     return NAN;
@@ -243,12 +242,7 @@ float BME280Component::read_temperature_(int32_t *t_fine) {
   return temperature / 100.0f;
 }
 
-float BME280Component::read_pressure_(int32_t t_fine) {
-  uint8_t data[3];
-  if (!this->read_bytes(BME280_REGISTER_PRESSUREDATA, data, 3))
-    return NAN;
-  int32_t adc = ((data[0] & 0xFF) << 16) | ((data[1] & 0xFF) << 8) | (data[2] & 0xFF);
-  adc >>= 4;
+float BME280Component::compensate_pressure_(int32_t adc, int32_t t_fine) {
   if (adc == 0x80000)
     // pressure was disabled
     return NAN;
@@ -282,13 +276,11 @@ float BME280Component::read_pressure_(int32_t t_fine) {
   return (p / 256.0f) / 100.0f;
 }
 
-float BME280Component::read_humidity_(int32_t t_fine) {
-  uint16_t raw_adc;
-  if (!this->read_byte_16(BME280_REGISTER_HUMIDDATA, &raw_adc) || raw_adc == 0x8000)
+float BME280Component::compensate_humidity_(int32_t adc, int32_t t_fine) {
+  if (adc == 0x8000)
+    // humidity was disabled
     return NAN;
 
-  int32_t adc = raw_adc;
-
   const int32_t h1 = this->calibration_.h1;
   const int32_t h2 = this->calibration_.h2;
   const int32_t h3 = this->calibration_.h3;
@@ -322,17 +314,6 @@ void BME280Component::set_humidity_oversampling(BME280Oversampling humidity_over
   this->humidity_oversampling_ = humidity_over_sampling;
 }
 void BME280Component::set_iir_filter(BME280IIRFilter iir_filter) { this->iir_filter_ = iir_filter; }
-uint8_t BME280Component::read_u8_(uint8_t a_register) {
-  uint8_t data = 0;
-  this->read_byte(a_register, &data);
-  return data;
-}
-uint16_t BME280Component::read_u16_le_(uint8_t a_register) {
-  uint16_t data = 0;
-  this->read_byte_16(a_register, &data);
-  return (data >> 8) | (data << 8);
-}
-int16_t BME280Component::read_s16_le_(uint8_t a_register) { return this->read_u16_le_(a_register); }
 
 }  // namespace sensor
 
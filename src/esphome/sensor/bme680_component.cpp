@@ -9,6 +9,7 @@
 
 #ifdef USE_BME680
 
+#include <algorithm>
 #include "esphome/sensor/bme680_component.h"
 #include "esphome/log.h"
 
@@ -33,6 +34,15 @@ static const uint8_t BME680_REGISTER_CHIPID = 0xD0;
 
 static const uint8_t BME680_REGISTER_FIELD0 = 0x1D;
 
+/// Samples needed until the baseline is trusted, 50 minutes with the default update interval.
+static const uint32_t BME680_IAQ_BURN_IN_SAMPLES = 50;
+/// Save the baseline every this many samples.
+static const uint32_t BME680_IAQ_SAVE_INTERVAL = 60;
+/// The humidity that gets the full humidity score.
+static const float BME680_IAQ_HUMIDITY_BASELINE = 40.0f;
+/// The part of the score from the humidity, the rest is from the gas resistance.
+static const float BME680_IAQ_HUMIDITY_WEIGHT = 0.25f;
+
 const float BME680_GAS_LOOKUP_TABLE_1[16] PROGMEM = {0.0, 0.0, 0.0,  0.0,  0.0, -1.0, 0.0, -0.8,
                                                      0.0, 0.0, -0.2, -0.5, 0.0, -1.0, 0.0, 0.0};
 
@@ -214,6 +224,13 @@ void BME680Component::setup() {
       return;
     }
   }
+
+  if (this->iaq_sensor_ != nullptr) {
+    this->iaq_pref_ = global_preferences.make_preference<BME680IAQState>(this->iaq_sensor_->get_object_id_hash());
+    BME680IAQState state{};
+    if (this->iaq_pref_.load(&state) && state.gas_baseline > 0.0f)
+      this->iaq_state_ = state;
+  }
 }
 
 void BME680Component::dump_config() {
@@ -232,6 +249,7 @@ void BME680Component::dump_config() {
   LOG_SENSOR("  ", "Humidity", this->humidity_sensor_);
   ESP_LOGCONFIG(TAG, "    Oversampling: %s", oversampling_to_str(this->humidity_oversampling_));
   LOG_SENSOR("  ", "Gas Resistance", this->gas_resistance_sensor_);
+  LOG_SENSOR("  ", "IAQ", this->iaq_sensor_);
   if (this->heater_duration_ == 0 || this->heater_temperature_ == 0) {
     ESP_LOGCONFIG(TAG, "  Heater OFF");
   } else {
@@ -240,17 +258,24 @@ void BME680Component::dump_config() {
 }
 
 float BME680Component::get_setup_priority() const { return setup_priority::HARDWARE_LATE; }
+uint32_t BME680Component::get_loop_idle_time() { return SCHEDULER_DONT_RUN; }
 
 void BME680Component::update() {
+  if (this->measuring_) {
+    ESP_LOGW(TAG, "Previous measurement hasn't finished yet, skipping!");
+    return;
+  }
   uint8_t meas_control = 0;  // No need to fetch, we're setting all fields
   meas_control |= (this->temperature_oversampling_ & 0b111) << 5;
-  meas_control |= (this->pressure_oversampling_ & 0b111) << 5;
+  meas_control |= (this->pressure_oversampling_ & 0b111) << 2;
   meas_control |= 0b01;  // forced mode
   if (!this->write_byte(BME680_REGISTER_CONTROL_MEAS, meas_control)) {
     this->status_set_warning();
     return;
   }
 
+  this->measuring_ = true;
+  this->measurement_start_ = millis();
   this->set_timeout("data", this->calc_meas_duration_(), [this]() { this->read_data_(); });
 }
 
@@ -304,14 +329,27 @@ uint8_t BME680Component::calc_heater_duration_(uint16_t duration) {
 void BME680Component::read_data_() {
   uint8_t data[15];
   if (!this->read_bytes(BME680_REGISTER_FIELD0, data, 15)) {
+    this->measuring_ = false;
     this->status_set_warning();
     return;
   }
+  if ((data[0] & 0x80) == 0) {
+    // new data bit not set yet, the measurement duration is only an estimate
+    if (millis() - this->measurement_start_ > this->calc_meas_duration_() + 100) {
+      ESP_LOGW(TAG, "Measurement timed out!");
+      this->measuring_ = false;
+      this->status_set_warning();
+      return;
+    }
+    this->set_timeout("data", 5, [this]() { this->read_data_(); });
+    return;
+  }
+  this->measuring_ = false;
 
   uint32_t raw_temperature = (uint32_t(data[5]) << 12) | (uint32_t(data[6]) << 4) | (uint32_t(data[7]) >> 4);
   uint32_t raw_pressure = (uint32_t(data[2]) << 12) | (uint32_t(data[3]) << 4) | (uint32_t(data[4]) >> 4);
   uint32_t raw_humidity = (uint32_t(data[8]) << 8) | uint32_t(data[9]);
-  uint16_t raw_gas = (uint16_t(data[13]) << 2) | (uint16_t(14) >> 6);
+  uint16_t raw_gas = (uint16_t(data[13]) << 2) | (uint16_t(data[14]) >> 6);
   uint8_t gas_range = data[14] & 0x0F;
 
   float temperature = this->calc_temperature_(raw_temperature);
@@ -328,8 +366,54 @@ void BME680Component::read_data_() {
   this->pressure_sensor_->publish_state(pressure);
   this->humidity_sensor_->publish_state(humidity);
   this->gas_resistance_sensor_->publish_state(gas_resistance);
+  // gas valid and heater stable
+  if (this->iaq_sensor_ != nullptr && (data[14] & 0x30) == 0x30)
+    this->update_iaq_(humidity, gas_resistance);
   this->status_clear_warning();
 }
+void BME680Component::update_iaq_(float humidity, float gas_resistance) {
+  auto &state = this->iaq_state_;
+  if (state.samples == 0) {
+    state.gas_baseline = gas_resistance;
+  } else if (state.samples < BME680_IAQ_BURN_IN_SAMPLES) {
+    // average while burning in
+    state.gas_baseline += (gas_resistance - state.gas_baseline) / (state.samples + 1);
+  } else if (gas_resistance > state.gas_baseline) {
+    // higher resistance means cleaner air, follow quickly
+    state.gas_baseline += (gas_resistance - state.gas_baseline) * 0.2f;
+  } else {
+    // slowly drift down so sensor aging doesn't make the air look bad forever
+    state.gas_baseline += (gas_resistance - state.gas_baseline) * 0.001f;
+  }
+  if (state.samples < BME680_IAQ_BURN_IN_SAMPLES) {
+    state.samples++;
+    ESP_LOGD(TAG, "Learning IAQ baseline (%u/%u)...", state.samples, BME680_IAQ_BURN_IN_SAMPLES);
+    if (state.samples == BME680_IAQ_BURN_IN_SAMPLES)
+      this->iaq_pref_.save(&state);
+    return;
+  }
+
+  float humidity_offset = humidity - BME680_IAQ_HUMIDITY_BASELINE;
+  float humidity_score;
+  if (humidity_offset > 0) {
+    humidity_score =
+        (100.0f - BME680_IAQ_HUMIDITY_BASELINE - humidity_offset) / (100.0f - BME680_IAQ_HUMIDITY_BASELINE);
+  } else {
+    humidity_score = (BME680_IAQ_HUMIDITY_BASELINE + humidity_offset) / BME680_IAQ_HUMIDITY_BASELINE;
+  }
+  float gas_score = std::min(gas_resistance / state.gas_baseline, 1.0f);
+  // quality from 0 (bad) to 1 (good)
+  float quality = humidity_score * BME680_IAQ_HUMIDITY_WEIGHT + gas_score * (1.0f - BME680_IAQ_HUMIDITY_WEIGHT);
+  float iaq = (1.0f - quality) * 500.0f;
+  ESP_LOGD(TAG, "Got IAQ=%.0f (gas baseline=%.0fΩ)", iaq, state.gas_baseline);
+  this->iaq_sensor_->publish_state(iaq);
+
+  this->iaq_samples_since_save_++;
+  if (this->iaq_samples_since_save_ >= BME680_IAQ_SAVE_INTERVAL) {
+    this->iaq_samples_since_save_ = 0;
+    this->iaq_pref_.save(&state);
+  }
+}
 
 float BME680Component::calc_temperature_(uint32_t raw_temperature) {
   float var1 = 0;
@@ -485,6 +569,9 @@ BME680TemperatureSensor *BME680Component::get_temperature_sensor() const { retur
 BME680PressureSensor *BME680Component::get_pressure_sensor() const { return this->pressure_sensor_; }
 BME680HumiditySensor *BME680Component::get_humidity_sensor() const { return this->humidity_sensor_; }
 BME680GasResistanceSensor *BME680Component::get_gas_resistance_sensor() const { return this->gas_resistance_sensor_; }
+BME680IAQSensor *BME680Component::make_iaq_sensor(const std::string &name) {
+  return this->iaq_sensor_ = new BME680IAQSensor(name, this);
+}
 void BME680Component::set_temperature_oversampling(BME680Oversampling temperature_oversampling) {
   this->temperature_oversampling_ = temperature_oversampling;
 }
@@ -7,6 +7,7 @@
 
 #include "esphome/sensor/sensor.h"
 #include "esphome/i2c_component.h"
+#include "esphome/esppreferences.h"
 
 ESPHOME_NAMESPACE_BEGIN
 
@@ -78,6 +79,15 @@ using BME680TemperatureSensor = sensor::EmptyPollingParentSensor<1, ICON_EMPTY,
 using BME680PressureSensor = sensor::EmptyPollingParentSensor<1, ICON_GAUGE, UNIT_HPA>;
 using BME680HumiditySensor = sensor::EmptyPollingParentSensor<1, ICON_WATER_PERCENT, UNIT_PERCENT>;
 using BME680GasResistanceSensor = sensor::EmptyPollingParentSensor<1, ICON_GAS_CYLINDER, UNIT_OHM>;
+using BME680IAQSensor = sensor::EmptyPollingParentSensor<0, ICON_GAUGE, UNIT_IAQ>;
+
+/// The state of the IAQ estimator that's kept across reboots.
+struct BME680IAQState {
+  /// The gas resistance in clean air in Ω.
+  float gas_baseline;
+  /// The number of samples the baseline is based on, saturates at the burn-in length.
+  uint32_t samples;
+} __attribute__((packed));
 
 class BME680Component : public PollingComponent, public I2CDevice {
  public:
@@ -105,12 +115,22 @@ class BME680Component : public PollingComponent, public I2CDevice {
    */
   void set_heater(uint16_t heater_temperature, uint16_t heater_duration);
 
+  /** Estimate the indoor air quality from the gas resistance and the humidity.
+   *
+   * The gas resistance is compared to a baseline, the resistance in clean air, that's learned over time and
+   * kept in flash. The result is on a scale of 0 (good) to 500 (very bad) like the one of Bosch's BSEC library,
+   * but it's only an estimate, not the output of their proprietary algorithm. Nothing is published for the first
+   * samples after the first boot, while the baseline is learned. Requires the heater.
+   */
+  BME680IAQSensor *make_iaq_sensor(const std::string &name);
+
   // ========== INTERNAL METHODS ==========
   // (In most use cases you won't need these)
   void setup() override;
   void dump_config() override;
   float get_setup_priority() const override;
   void update() override;
+  uint32_t get_loop_idle_time() override;
 
   BME680TemperatureSensor *get_temperature_sensor() const;
   BME680PressureSensor *get_pressure_sensor() const;
@@ -122,8 +142,10 @@ class BME680Component : public PollingComponent, public I2CDevice {
   uint8_t calc_heater_resistance_(uint16_t temperature);
   /// Calculate the heater duration value to send to the BME680 register.
   uint8_t calc_heater_duration_(uint16_t duration);
-  /// Read data from the BME680 and publish results.
+  /// Read data from the BME680 and publish results, polls again if the measurement isn't done yet.
   void read_data_();
+  /// Feed a sample with a stable heater to the IAQ estimator and publish the result.
+  void update_iaq_(float humidity, float gas_resistance);
 
   /// Calculate the temperature in °C using the provided raw ADC value.
   float calc_temperature_(uint32_t raw_temperature);
@@ -148,6 +170,14 @@ class BME680Component : public PollingComponent, public I2CDevice {
   BME680PressureSensor *pressure_sensor_;
   BME680HumiditySensor *humidity_sensor_;
   BME680GasResistanceSensor *gas_resistance_sensor_;
+  BME680IAQSensor *iaq_sensor_{nullptr};
+
+  /// Whether a forced measurement is running.
+  bool measuring_{false};
+  uint32_t measurement_start_{0};
+  BME680IAQState iaq_state_{0.0f, 0};
+  uint32_t iaq_samples_since_save_{0};
+  ESPPreferenceObject iaq_pref_;
 };
 
 }  // namespace sensor
@@ -150,6 +150,7 @@ bool BMP085Component::set_mode_(uint8_t mode) {
   return this->write_byte(BMP085_REGISTER_CONTROL, mode);
 }
 float BMP085Component::get_setup_priority() const { return setup_priority::HARDWARE_LATE; }
+uint32_t BMP085Component::get_loop_idle_time() { return SCHEDULER_DONT_RUN; }
 
 }  // namespace sensor
 
@@ -35,6 +35,7 @@ class BMP085Component : public PollingComponent, public I2CDevice {
 
   /// Schedule temperature+pressure readings.
   void update() override;
+  uint32_t get_loop_idle_time() override;
   /// Setup the sensor and test for a connection.
   void setup() override;
   void dump_config() override;
@@ -21,11 +21,16 @@ static const uint8_t BMP280_REGISTER_STATUS = 0xF3;
 static const uint8_t BMP280_REGISTER_CONTROL = 0xF4;
 static const uint8_t BMP280_REGISTER_CONFIG = 0xF5;
 static const uint8_t BMP280_REGISTER_PRESSUREDATA = 0xF7;
-static const uint8_t BMP280_REGISTER_TEMPDATA = 0xFA;
+static const uint8_t BMP280_REGISTER_DIG_T1 = 0x88;
 
 static const uint8_t BMP280_MODE_FORCED = 0b01;
 
 inline uint16_t combine_bytes(uint8_t msb, uint8_t lsb) { return ((msb & 0xFF) << 8) | (lsb & 0xFF); }
+inline uint16_t combine_bytes_le(const uint8_t *data) { return combine_bytes(data[1], data[0]); }
+/// The 20 bit value of a pressure or temperature data block (msb, lsb, xlsb).
+inline int32_t combine_bytes_20(const uint8_t *data) {
+  return (uint32_t(data[0]) << 12) | (data[1] << 4) | (data[2] >> 4);
+}
 
 BMP280Component::BMP280Component(I2CComponent *parent, const std::string &temperature_name,
                                  const std::string &pressure_name, uint8_t address, uint32_t update_interval)
@@ -84,20 +89,26 @@ void BMP280Component::setup() {
     return;
   }
 
-  // Read calibration
-  this->calibration_.t1 = this->read_u16_le_(0x88);
-  this->calibration_.t2 = this->read_s16_le_(0x8A);
-  this->calibration_.t3 = this->read_s16_le_(0x8C);
-
-  this->calibration_.p1 = this->read_u16_le_(0x8E);
-  this->calibration_.p2 = this->read_s16_le_(0x90);
-  this->calibration_.p3 = this->read_s16_le_(0x92);
-  this->calibration_.p4 = this->read_s16_le_(0x94);
-  this->calibration_.p5 = this->read_s16_le_(0x96);
-  this->calibration_.p6 = this->read_s16_le_(0x98);
-  this->calibration_.p7 = this->read_s16_le_(0x9A);
-  this->calibration_.p8 = this->read_s16_le_(0x9C);
-  this->calibration_.p9 = this->read_s16_le_(0x9E);
+  // Read calibration in one burst
+  uint8_t calibration[24];
+  if (!this->read_bytes(BMP280_REGISTER_DIG_T1, calibration, sizeof(calibration))) {
+    this->error_code_ = COMMUNICATION_FAILED;
+    this->mark_failed();
+    return;
+  }
+  this->calibration_.t1 = combine_bytes_le(calibration + 0);
+  this->calibration_.t2 = combine_bytes_le(calibration + 2);
+  this->calibration_.t3 = combine_bytes_le(calibration + 4);
+
+  this->calibration_.p1 = combine_bytes_le(calibration + 6);
+  this->calibration_.p2 = combine_bytes_le(calibration + 8);
+  this->calibration_.p3 = combine_bytes_le(calibration + 10);
+  this->calibration_.p4 = combine_bytes_le(calibration + 12);
+  this->calibration_.p5 = combine_bytes_le(calibration + 14);
+  this->calibration_.p6 = combine_bytes_le(calibration + 16);
+  this->calibration_.p7 = combine_bytes_le(calibration + 18);
+  this->calibration_.p8 = combine_bytes_le(calibration + 20);
+  this->calibration_.p9 = combine_bytes_le(calibration + 22);
 
   uint8_t config_register = 0;
   if (!this->read_byte(BMP280_REGISTER_CONFIG, &config_register)) {
@@ -135,6 +146,7 @@ void BMP280Component::dump_config() {
   ESP_LOGCONFIG(TAG, "    Oversampling: %s", oversampling_to_str(this->pressure_oversampling_));
 }
 float BMP280Component::get_setup_priority() const { return setup_priority::HARDWARE_LATE; }
+uint32_t BMP280Component::get_loop_idle_time() { return SCHEDULER_DONT_RUN; }
 
 inline uint8_t oversampling_to_time(BMP280Oversampling over_sampling) { return (1 << uint8_t(over_sampling)) >> 1; }
 
@@ -155,14 +167,21 @@ void BMP280Component::update() {
   meas_time += 2.3f * oversampling_to_time(this->pressure_oversampling_) + 0.575f;
 
   this->set_timeout("data", uint32_t(ceilf(meas_time)), [this]() {
+    // pressure (0xF7-0xF9) and temperature (0xFA-0xFC) in one burst, so they're consistent
+    uint8_t data[6];
+    if (!this->read_bytes(BMP280_REGISTER_PRESSUREDATA, data, sizeof(data))) {
+      ESP_LOGW(TAG, "Error reading the measurement data.");
+      this->status_set_warning();
+      return;
+    }
     int32_t t_fine = 0;
-    float temperature = this->read_temperature_(&t_fine);
+    float temperature = this->compensate_temperature_(combine_bytes_20(data + 3), &t_fine);
     if (isnan(temperature)) {
       ESP_LOGW(TAG, "Invalid temperature, cannot read pressure values.");
       this->status_set_warning();
       return;
     }
-    float pressure = this->read_pressure_(t_fine);
+    float pressure = this->compensate_pressure_(combine_bytes_20(data + 0), t_fine);
 
     ESP_LOGD(TAG, "Got temperature=%.1f°C pressure=%.1fhPa", temperature, pressure);
     this->temperature_sensor_->publish_state(temperature);
@@ -171,12 +190,7 @@ void BMP280Component::update() {
   });
 }
 
-float BMP280Component::read_temperature_(int32_t *t_fine) {
-  uint8_t data[3];
-  if (!this->read_bytes(BMP280_REGISTER_TEMPDATA, data, 3))
-    return NAN;
-  int32_t adc = ((data[0] & 0xFF) << 16) | ((data[1] & 0xFF) << 8) | (data[2] & 0xFF);
-  adc >>= 4;
+float BMP280Component::compensate_temperature_(int32_t adc, int32_t *t_fine) {
   if (adc == 0x80000)
     // temperature was disabled
     return NAN;
@@ -193,12 +207,7 @@ float BMP280Component::read_temperature_(int32_t *t_fine) {
   return temperature / 100.0f;
 }
 
-float BMP280Component::read_pressure_(int32_t t_fine) {
-  uint8_t data[3];
-  if (!this->read_bytes(BMP280_REGISTER_PRESSUREDATA, data, 3))
-    return NAN;
-  int32_t adc = ((data[0] & 0xFF) << 16) | ((data[1] & 0xFF) << 8) | (data[2] & 0xFF);
-  adc >>= 4;
+float BMP280Component::compensate_pressure_(int32_t adc, int32_t t_fine) {
   if (adc == 0x80000)
     // pressure was disabled
     return NAN;
@@ -240,17 +249,6 @@ void BMP280Component::set_pressure_oversampling(BMP280Oversampling pressure_over
   this->pressure_oversampling_ = pressure_over_sampling;
 }
 void BMP280Component::set_iir_filter(BMP280IIRFilter iir_filter) { this->iir_filter_ = iir_filter; }
-uint8_t BMP280Component::read_u8_(uint8_t a_register) {
-  uint8_t data = 0;
-  this->read_byte(a_register, &data);
-  return data;
-}
-uint16_t BMP280Component::read_u16_le_(uint8_t a_register) {
-  uint16_t data = 0;
-  this->read_byte_16(a_register, &data);
-  return (data >> 8) | (data << 8);
-}
-int16_t BMP280Component::read_s16_le_(uint8_t a_register) { return this->read_u16_le_(a_register); }
 
 }  // namespace sensor
 
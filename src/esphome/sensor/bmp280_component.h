@@ -80,15 +80,13 @@ class BMP280Component : public PollingComponent, public I2CDevice {
   void dump_config() override;
   float get_setup_priority() const override;
   void update() override;
+  uint32_t get_loop_idle_time() override;
 
  protected:
-  /// Read the temperature value and store the calculated ambient temperature in t_fine.
-  float read_temperature_(int32_t *t_fine);
-  /// Read the pressure value in hPa using the provided t_fine value.
-  float read_pressure_(int32_t t_fine);
-  uint8_t read_u8_(uint8_t a_register);
-  uint16_t read_u16_le_(uint8_t a_register);
-  int16_t read_s16_le_(uint8_t a_register);
+  /// Calculate the temperature from the raw value and store the calculated ambient temperature in t_fine.
+  float compensate_temperature_(int32_t adc, int32_t *t_fine);
+  /// Calculate the pressure in hPa from the raw value using the provided t_fine value.
+  float compensate_pressure_(int32_t adc, int32_t t_fine);
 
   BMP280CalibrationData calibration_;
   BMP280Oversampling temperature_oversampling_{BMP280_OVERSAMPLING_16X};
@@ -11,71 +11,46 @@ namespace sensor {
 
 static const char *TAG = "sensor.cse7766";
 
-void CSE7766Component::loop() {
-  const uint32_t now = millis();
-  if (now - this->last_transmission_ >= 500) {
-    // last transmission too long ago. Reset RX index.
-    this->raw_data_index_ = 0;
-  }
-
-  if (this->available() == 0)
-    return;
-
-  this->last_transmission_ = now;
-  while (this->available() != 0) {
-    this->read_byte(&this->raw_data_[this->raw_data_index_]);
-    if (!this->check_byte_()) {
-      this->raw_data_index_ = 0;
-      this->status_set_warning();
-    }
-
-    if (this->raw_data_index_ == 23) {
-      this->parse_data_();
-      this->status_clear_warning();
-    }
-
-    this->raw_data_index_ = (this->raw_data_index_ + 1) % 24;
-  }
+void CSE7766Component::setup() {
+  // 0x55 (or a status byte) 0x5A, 20 data bytes and the checksum
+  this->parser_.set_header({0x5A}, 1);
+  this->parser_.set_fixed_length(24);
+  this->parser_.set_validator([this](const uint8_t *frame, size_t len) { return this->check_frame_(frame); });
+  this->parser_.set_on_frame([this](const uint8_t *frame, size_t len) {
+    this->parse_data_(frame);
+    this->status_clear_warning();
+  });
+  this->add_frame_parser(&this->parser_);
+  // the UART calls us once data has arrived
+  this->disable_loop();
 }
 float CSE7766Component::get_setup_priority() const { return setup_priority::HARDWARE_LATE; }
 
-bool CSE7766Component::check_byte_() {
-  uint8_t index = this->raw_data_index_;
-  uint8_t byte = this->raw_data_[index];
-  if (index == 0) {
-    return !((byte != 0x55) && ((byte & 0xF0) != 0xF0) && (byte != 0xAA));
-  }
-
-  if (index == 1) {
-    if (byte != 0x5A) {
-      ESP_LOGV(TAG, "Invalid Header 2 Start: 0x%02X!", byte);
-      return false;
-    }
-    return true;
+bool CSE7766Component::check_frame_(const uint8_t *data) {
+  uint8_t header1 = data[0];
+  if ((header1 != 0x55) && ((header1 & 0xF0) != 0xF0) && (header1 != 0xAA)) {
+    ESP_LOGV(TAG, "Invalid Header 1 Start: 0x%02X!", header1);
+    return false;
   }
 
-  if (index == 23) {
-    uint8_t checksum = 0;
-    for (uint8_t i = 2; i < 23; i++)
-      checksum += this->raw_data_[i];
+  uint8_t checksum = 0;
+  for (uint8_t i = 2; i < 23; i++)
+    checksum += data[i];
 
-    if (checksum != this->raw_data_[23]) {
-      ESP_LOGW(TAG, "Invalid checksum from CSE7766: 0x%02X != 0x%02X", checksum, this->raw_data_[23]);
-      return false;
-    }
-    return true;
+  if (checksum != data[23]) {
+    ESP_LOGW(TAG, "Invalid checksum from CSE7766: 0x%02X != 0x%02X", checksum, data[23]);
+    this->status_set_warning();
+    return false;
   }
-
   return true;
 }
-void CSE7766Component::parse_data_() {
+void CSE7766Component::parse_data_(const uint8_t *data) {
   ESP_LOGVV(TAG, "CSE7766 Data: ");
   for (uint8_t i = 0; i < 23; i++) {
-    ESP_LOGVV(TAG, "  i=%u: 0b" BYTE_TO_BINARY_PATTERN " (0x%02X)", i, BYTE_TO_BINARY(this->raw_data_[i]),
-              this->raw_data_[i]);
+    ESP_LOGVV(TAG, "  i=%u: 0b" BYTE_TO_BINARY_PATTERN " (0x%02X)", i, BYTE_TO_BINARY(data[i]), data[i]);
   }
 
-  uint8_t header1 = this->raw_data_[0];
+  uint8_t header1 = data[0];
   if (header1 == 0xAA) {
     ESP_LOGW(TAG, "CSE7766 not calibrated!");
     return;
@@ -87,14 +62,26 @@ void CSE7766Component::parse_data_() {
     return;
   }
 
-  uint32_t voltage_calib = this->get_24_bit_uint_(2);
-  uint32_t voltage_cycle = this->get_24_bit_uint_(5);
-  uint32_t current_calib = this->get_24_bit_uint_(8);
-  uint32_t current_cycle = this->get_24_bit_uint_(11);
-  uint32_t power_calib = this->get_24_bit_uint_(14);
-  uint32_t power_cycle = this->get_24_bit_uint_(17);
-
-  uint8_t adj = this->raw_data_[20];
+  uint32_t voltage_calib = get_24_bit_uint_(data, 2);
+  uint32_t voltage_cycle = get_24_bit_uint_(data, 5);
+  uint32_t current_calib = get_24_bit_uint_(data, 8);
+  uint32_t current_cycle = get_24_bit_uint_(data, 11);
+  uint32_t power_calib = get_24_bit_uint_(data, 14);
+  uint32_t power_cycle = get_24_bit_uint_(data, 17);
+
+  uint8_t adj = data[20];
+#ifdef USE_TOTAL_DAILY_ENERGY_SENSOR
+  if (this->total_daily_energy_ != nullptr) {
+    const uint16_t cf_pulses = (uint16_t(data[21]) << 8) | data[22];
+    if (this->has_cf_pulses_) {
+      // the counter wraps around, each pulse is power_calib µWs
+      const uint16_t difference = cf_pulses - this->cf_pulses_last_;
+      this->total_daily_energy_->add_energy(difference * float(power_calib) / 1000000.0f / 3600.0f);
+    }
+    this->cf_pulses_last_ = cf_pulses;
+    this->has_cf_pulses_ = true;
+  }
+#endif
 
   bool power_ok = true;
   bool voltage_ok = true;
@@ -122,72 +109,125 @@ void CSE7766Component::parse_data_() {
 
   if ((adj & 0x40) == 0x40 && voltage_ok && current_ok) {
     // voltage cycle of serial port outputted is a complete cycle;
-    this->voltage_acc_ += voltage_calib / float(voltage_cycle);
-    this->voltage_counts_ += 1;
+    this->voltage_.add(voltage_calib / float(voltage_cycle));
   }
 
   float power = 0;
   if ((adj & 0x10) == 0x10 && voltage_ok && current_ok && power_ok) {
     // power cycle of serial port outputted is a complete cycle;
     power = power_calib / float(power_cycle);
-    this->power_acc_ += power;
-    this->power_counts_ += 1;
+    this->power_.add(power);
   }
 
   if ((adj & 0x20) == 0x20 && current_ok && voltage_ok && power != 0.0) {
     // indicates current cycle of serial port outputted is a complete cycle;
-    this->current_acc_ += current_calib / float(current_cycle);
-    this->current_counts_ += 1;
+    this->current_.add(current_calib / float(current_cycle));
   }
 }
 void CSE7766Component::update() {
-  float voltage = this->voltage_counts_ > 0 ? this->voltage_acc_ / this->voltage_counts_ : 0.0;
-  float current = this->current_counts_ > 0 ? this->current_acc_ / this->current_counts_ : 0.0;
-  float power = this->power_counts_ > 0 ? this->power_acc_ / this->power_counts_ : 0.0;
-
-  ESP_LOGV(TAG, "Got voltage_acc=%.2f current_acc=%.2f power_acc=%.2f", this->voltage_acc_, this->current_acc_,
-           this->power_acc_);
-  ESP_LOGV(TAG, "Got voltage_counts=%d current_counts=%d power_counts=%d", this->voltage_counts_, this->current_counts_,
-           this->power_counts_);
-  ESP_LOGD(TAG, "Got voltage=%.1fV current=%.1fA power=%.1fW", voltage, current, power);
-
-  if (this->voltage_sensor_ != nullptr)
-    this->voltage_sensor_->publish_state(voltage);
-  if (this->current_sensor_ != nullptr)
-    this->current_sensor_->publish_state(current);
-  if (this->power_sensor_ != nullptr)
-    this->power_sensor_->publish_state(power);
+  ESP_LOGV(TAG, "Got voltage_counts=%u current_counts=%u power_counts=%u", this->voltage_.count, this->current_.count,
+           this->power_.count);
+  ESP_LOGD(TAG, "Got voltage=%.1fV current=%.1fA power=%.1fW (average of the interval)",
+           this->voltage_.count > 0 ? this->voltage_.sum / this->voltage_.count : 0.0f,
+           this->current_.count > 0 ? this->current_.sum / this->current_.count : 0.0f,
+           this->power_.count > 0 ? this->power_.sum / this->power_.count : 0.0f);
+
+  this->voltage_.publish_and_reset();
+  this->current_.publish_and_reset();
+  this->power_.publish_and_reset();
+}
 
-  this->voltage_acc_ = 0.0f;
-  this->current_acc_ = 0.0f;
-  this->power_acc_ = 0.0f;
-  this->voltage_counts_ = 0;
-  this->power_counts_ = 0;
-  this->current_counts_ = 0;
+void CSE7766Component::Statistic::add(float value) {
+  this->sum += value;
+  if (this->count == 0 || value < this->min)
+    this->min = value;
+  if (this->count == 0 || value > this->max)
+    this->max = value;
+  this->count++;
+}
+void CSE7766Component::Statistic::publish_and_reset() {
+  if (this->avg_sensor != nullptr)
+    this->avg_sensor->publish_state(this->count > 0 ? this->sum / this->count : 0.0f);
+  // without values there's no meaningful extreme
+  if (this->count > 0) {
+    if (this->min_sensor != nullptr)
+      this->min_sensor->publish_state(this->min);
+    if (this->max_sensor != nullptr)
+      this->max_sensor->publish_state(this->max);
+  }
+  this->sum = 0.0f;
+  this->count = 0;
 }
 
-uint32_t CSE7766Component::get_24_bit_uint_(uint8_t start_index) {
-  return (uint32_t(this->raw_data_[start_index]) << 16) | (uint32_t(this->raw_data_[start_index + 1]) << 8) |
-         uint32_t(this->raw_data_[start_index + 2]);
+uint32_t CSE7766Component::get_24_bit_uint_(const uint8_t *data, uint8_t start_index) {
+  return (uint32_t(data[start_index]) << 16) | (uint32_t(data[start_index + 1]) << 8) | uint32_t(data[start_index + 2]);
 }
 
 CSE7766Component::CSE7766Component(UARTComponent *parent, uint32_t update_interval)
-    : UARTDevice(parent), PollingComponent(update_interval) {}
+    : UARTDevice(parent), PollingComponent(update_interval), parser_(24) {}
 CSE7766VoltageSensor *CSE7766Component::make_voltage_sensor(const std::string &name) {
-  return this->voltage_sensor_ = new CSE7766VoltageSensor(name);
+  auto *sensor = new CSE7766VoltageSensor(name);
+  this->voltage_.avg_sensor = sensor;
+  return sensor;
+}
+CSE7766VoltageSensor *CSE7766Component::make_voltage_min_sensor(const std::string &name) {
+  auto *sensor = new CSE7766VoltageSensor(name);
+  this->voltage_.min_sensor = sensor;
+  return sensor;
+}
+CSE7766VoltageSensor *CSE7766Component::make_voltage_max_sensor(const std::string &name) {
+  auto *sensor = new CSE7766VoltageSensor(name);
+  this->voltage_.max_sensor = sensor;
+  return sensor;
 }
 CSE7766CurrentSensor *CSE7766Component::make_current_sensor(const std::string &name) {
-  return this->current_sensor_ = new CSE7766CurrentSensor(name);
+  auto *sensor = new CSE7766CurrentSensor(name);
+  this->current_.avg_sensor = sensor;
+  return sensor;
+}
+CSE7766CurrentSensor *CSE7766Component::make_current_min_sensor(const std::string &name) {
+  auto *sensor = new CSE7766CurrentSensor(name);
+  this->current_.min_sensor = sensor;
+  return sensor;
+}
+CSE7766CurrentSensor *CSE7766Component::make_current_max_sensor(const std::string &name) {
+  auto *sensor = new CSE7766CurrentSensor(name);
+  this->current_.max_sensor = sensor;
+  return sensor;
 }
 CSE7766PowerSensor *CSE7766Component::make_power_sensor(const std::string &name) {
-  return this->power_sensor_ = new CSE7766PowerSensor(name);
+  auto *sensor = new CSE7766PowerSensor(name);
+  this->power_.avg_sensor = sensor;
+  return sensor;
+}
+CSE7766PowerSensor *CSE7766Component::make_power_min_sensor(const std::string &name) {
+  auto *sensor = new CSE7766PowerSensor(name);
+  this->power_.min_sensor = sensor;
+  return sensor;
+}
+CSE7766PowerSensor *CSE7766Component::make_power_max_sensor(const std::string &name) {
+  auto *sensor = new CSE7766PowerSensor(name);
+  this->power_.max_sensor = sensor;
+  return sensor;
+}
+#ifdef USE_TOTAL_DAILY_ENERGY_SENSOR
+void CSE7766Component::set_total_daily_energy(TotalDailyEnergy *total_daily_energy) {
+  this->total_daily_energy_ = total_daily_energy;
+  total_daily_energy->set_integrate_parent(false);
 }
+#endif
 void CSE7766Component::dump_config() {
   ESP_LOGCONFIG(TAG, "CSE7766:");
   LOG_UPDATE_INTERVAL(this);
-  LOG_SENSOR("  ", "Voltage", this->voltage_sensor_);
-  LOG_SENSOR("  ", "Current", this->current_sensor_);
-  LOG_SENSOR("  ", "Power", this->power_sensor_);
+  LOG_SENSOR("  ", "Voltage", this->voltage_.avg_sensor);
+  LOG_SENSOR("  ", "Voltage Min", this->voltage_.min_sensor);
+  LOG_SENSOR("  ", "Voltage Max", this->voltage_.max_sensor);
+  LOG_SENSOR("  ", "Current", this->current_.avg_sensor);
+  LOG_SENSOR("  ", "Current Min", this->current_.min_sensor);
+  LOG_SENSOR("  ", "Current Max", this->current_.max_sensor);
+  LOG_SENSOR("  ", "Power", this->power_.avg_sensor);
+  LOG_SENSOR("  ", "Power Min", this->power_.min_sensor);
+  LOG_SENSOR("  ", "Power Max", this->power_.max_sensor);
 }
 
 }  // namespace sensor
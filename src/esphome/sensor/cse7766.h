@@ -9,6 +9,7 @@
 #include "esphome/uart_component.h"
 #include "esphome/helpers.h"
 #include "esphome/sensor/sensor.h"
+#include "esphome/sensor/total_daily_energy.h"
 
 ESPHOME_NAMESPACE_BEGIN
 
@@ -18,38 +19,67 @@ using CSE7766VoltageSensor = EmptySensor<1, ICON_FLASH, UNIT_V>;
 using CSE7766CurrentSensor = EmptySensor<1, ICON_FLASH, UNIT_A>;
 using CSE7766PowerSensor = EmptySensor<1, ICON_FLASH, UNIT_W>;
 
+/** CSE7766 power monitor, sends a frame about 20 times per second.
+ *
+ * All valid frames of an update interval are accumulated, the voltage, current and power sensors publish the
+ * average of the interval and the optional min/max sensors the extremes of it.
+ */
 class CSE7766Component : public PollingComponent, public UARTDevice {
  public:
   CSE7766Component(UARTComponent *parent, uint32_t update_interval = 60000);
 
   CSE7766VoltageSensor *make_voltage_sensor(const std::string &name);
+  CSE7766VoltageSensor *make_voltage_min_sensor(const std::string &name);
+  CSE7766VoltageSensor *make_voltage_max_sensor(const std::string &name);
 
   CSE7766CurrentSensor *make_current_sensor(const std::string &name);
+  CSE7766CurrentSensor *make_current_min_sensor(const std::string &name);
+  CSE7766CurrentSensor *make_current_max_sensor(const std::string &name);
 
   CSE7766PowerSensor *make_power_sensor(const std::string &name);
+  CSE7766PowerSensor *make_power_min_sensor(const std::string &name);
+  CSE7766PowerSensor *make_power_max_sensor(const std::string &name);
 
-  void loop() override;
+#ifdef USE_TOTAL_DAILY_ENERGY_SENSOR
+  /// Add the energy counted by the CF pulses to a total daily energy sensor instead of integrating the power.
+  void set_total_daily_energy(TotalDailyEnergy *total_daily_energy);
+#endif
+
+  void setup() override;
   float get_setup_priority() const override;
   void update() override;
   void dump_config() override;
 
  protected:
-  bool check_byte_();
-  void parse_data_();
-  uint32_t get_24_bit_uint_(uint8_t start_index);
-
-  uint8_t raw_data_[24];
-  uint8_t raw_data_index_{0};
-  uint32_t last_transmission_{0};
-  CSE7766VoltageSensor *voltage_sensor_{nullptr};
-  CSE7766CurrentSensor *current_sensor_{nullptr};
-  CSE7766PowerSensor *power_sensor_{nullptr};
-  float voltage_acc_{0.0f};
-  float current_acc_{0.0f};
-  float power_acc_{0.0f};
-  uint32_t voltage_counts_{0};
-  uint32_t current_counts_{0};
-  uint32_t power_counts_{0};
+  /// The values of one quantity in the current update interval.
+  struct Statistic {
+    float sum{0.0f};
+    float min{NAN};
+    float max{NAN};
+    uint32_t count{0};
+    Sensor *avg_sensor{nullptr};
+    Sensor *min_sensor{nullptr};
+    Sensor *max_sensor{nullptr};
+
+    void add(float value);
+    /// Publish the sensors and start a new interval, the average is 0 without values.
+    void publish_and_reset();
+  };
+
+  bool check_frame_(const uint8_t *data);
+  void parse_data_(const uint8_t *data);
+  static uint32_t get_24_bit_uint_(const uint8_t *data, uint8_t start_index);
+
+  UARTFrameParser parser_;
+  Statistic voltage_;
+  Statistic current_;
+  Statistic power_;
+#ifdef USE_TOTAL_DAILY_ENERGY_SENSOR
+  TotalDailyEnergy *total_daily_energy_{nullptr};
+  /// The 16 bit CF pulse counter of the last frame.
+  uint16_t cf_pulses_last_{0};
+  bool has_cf_pulses_{false};
+#endif
 };
 
 }  // namespace sensor
@@ -5,6 +5,7 @@
 
 #ifdef USE_DALLAS_SENSOR
 
+#include <algorithm>
 #include "esphome/sensor/dallas_component.h"
 
 #include "esphome/helpers.h"
@@ -24,6 +25,8 @@ static const uint8_t DALLAS_MODEL_DS28EA00 = 0x42;
 static const uint8_t DALLAS_COMMAND_START_CONVERSION = 0x44;
 static const uint8_t DALLAS_COMMAND_READ_SCRATCH_PAD = 0xBE;
 static const uint8_t DALLAS_COMMAND_WRITE_SCRATCH_PAD = 0x4E;
+/// How often a scratch pad with an invalid CRC is read before the reading is skipped.
+static const uint8_t DALLAS_READ_ATTEMPTS = 3;
 
 uint16_t DallasTemperatureSensor::millis_to_wait_for_conversion() const {
   switch (this->resolution_) {
@@ -42,10 +45,60 @@ void DallasComponent::set_one_wire(ESPOneWire *one_wire) { this->one_wire_ = one
 void DallasComponent::setup() {
   ESP_LOGCONFIG(TAG, "Setting up DallasComponent...");
 
-  yield();
-  disable_interrupts();
+  // one cache per bus
+  this->cache_pref_ =
+      global_preferences.make_preference<DallasCacheState>(1812467310UL ^ this->one_wire_->get_pin()->get_pin());
+  this->from_cache_ = this->load_cache_();
+  if (this->from_cache_) {
+    ESP_LOGD(TAG, "All %u cached devices are present, skipping the search.", this->cache_.count);
+  } else {
+    this->cache_ = DallasCacheState{};
+    this->search_();
+  }
+
+  bool cache_changed = !this->from_cache_;
+  for (auto sensor : this->sensors_) {
+    if (sensor->get_index().has_value()) {
+      if (*sensor->get_index() >= this->found_sensors_.size()) {
+        this->status_set_error();
+        continue;
+      }
+      sensor->set_address(this->found_sensors_[*sensor->get_index()]);
+    }
+
+    uint8_t *cached_resolution = nullptr;
+    for (uint8_t i = 0; i < this->cache_.count; i++) {
+      if (this->cache_.addresses[i] == sensor->get_address())
+        cached_resolution = &this->cache_.resolutions[i];
+    }
+    // the resolution is stored in the EEPROM of the device, so it only has to be set once
+    if (this->from_cache_ && cached_resolution != nullptr && *cached_resolution == sensor->get_resolution())
+      continue;
+
+    if (!sensor->setup_sensor()) {
+      this->status_set_error();
+    } else if (cached_resolution != nullptr) {
+      *cached_resolution = sensor->get_resolution();
+      cache_changed = true;
+    }
+  }
+  if (cache_changed)
+    this->cache_pref_.save(&this->cache_);
+
+  this->skip_rom_ = this->found_sensors_.size() == 1 && this->sensors_.size() == 1 &&
+                    this->sensors_[0]->get_address() == this->found_sensors_[0];
+
+  this->read_order_ = this->sensors_;
+  std::stable_sort(this->read_order_.begin(), this->read_order_.end(),
+                   [](DallasTemperatureSensor *a, DallasTemperatureSensor *b) {
+                     return a->millis_to_wait_for_conversion() < b->millis_to_wait_for_conversion();
+                   });
+  this->read_index_ = this->read_order_.size();
+  // loop() only runs while a conversion is being read
+  this->disable_loop();
+}
+void DallasComponent::search_() {
   std::vector<uint64_t> raw_sensors = this->one_wire_->search_vec();
-  enable_interrupts();
 
   for (auto &address : raw_sensors) {
     std::string s = uint64_to_string(address);
@@ -63,24 +116,47 @@ void DallasComponent::setup() {
     this->found_sensors_.push_back(address);
   }
 
-  for (auto sensor : this->sensors_) {
-    if (sensor->get_index().has_value()) {
-      if (*sensor->get_index() >= this->found_sensors_.size()) {
-        this->status_set_error();
-        continue;
-      }
-      sensor->set_address(this->found_sensors_[*sensor->get_index()]);
-    }
+  // don't cache a partial list, indices past it couldn't be resolved on the next boot
+  if (this->found_sensors_.size() > DALLAS_MAX_CACHED_DEVICES)
+    return;
+  for (auto &address : this->found_sensors_)
+    this->cache_.addresses[this->cache_.count++] = address;
+}
+bool DallasComponent::load_cache_() {
+  if (!this->cache_pref_.load(&this->cache_) || this->cache_.count == 0 ||
+      this->cache_.count > DALLAS_MAX_CACHED_DEVICES)
+    return false;
 
-    if (!sensor->setup_sensor()) {
-      this->status_set_error();
+  const uint64_t *begin = this->cache_.addresses;
+  const uint64_t *end = this->cache_.addresses + this->cache_.count;
+  for (auto sensor : this->sensors_) {
+    if (sensor->get_index().has_value() ? *sensor->get_index() >= this->cache_.count
+                                        : std::find(begin, end, sensor->get_address()) == end)
+      // the configuration changed
+      return false;
+  }
+  for (const uint64_t *address = begin; address != end; address++) {
+    if (!this->one_wire_->verify(*address)) {
+      std::string s = uint64_to_string(*address);
+      ESP_LOGD(TAG, "Cached device 0x%s is gone, searching the bus...", s.c_str());
+      return false;
     }
   }
+  this->found_sensors_.assign(begin, end);
+  return true;
+}
+void DallasComponent::invalidate_cache_() {
+  if (this->cache_.count == 0)
+    return;
+  this->cache_.count = 0;
+  this->cache_pref_.save(&this->cache_);
 }
 void DallasComponent::dump_config() {
   ESP_LOGCONFIG(TAG, "DallasComponent:");
   LOG_PIN("  Pin: ", this->one_wire_->get_pin());
   LOG_UPDATE_INTERVAL(this);
+  ESP_LOGCONFIG(TAG, "  Devices From Cache: %s", YESNO(this->from_cache_));
+  ESP_LOGCONFIG(TAG, "  Skip ROM: %s", YESNO(this->skip_rom_));
 
   if (this->found_sensors_.empty()) {
     ESP_LOGW(TAG, "  Found no sensors!");
@@ -103,6 +179,8 @@ void DallasComponent::dump_config() {
     }
     ESP_LOGCONFIG(TAG, "    Address: %s", sensor->get_address_name().c_str());
     ESP_LOGCONFIG(TAG, "    Resolution: %u", sensor->get_resolution());
+    ESP_LOGCONFIG(TAG, "    CRC Failures: %u, Failed Reads: %u", sensor->get_crc_failures(),
+                  sensor->get_failed_reads());
   }
 }
 
@@ -122,47 +200,87 @@ DallasTemperatureSensor *DallasComponent::get_sensor_by_index(const std::string
 void DallasComponent::update() {
   this->status_clear_warning();
 
-  disable_interrupts();
+  if (this->read_index_ < this->read_order_.size()) {
+    ESP_LOGW(TAG, "Reading the last conversion took longer than the update interval, skipping %u sensors",
+             this->read_order_.size() - this->read_index_);
+    this->status_set_warning();
+  }
+
+  const bool present = this->one_wire_->reset();
+  if (present != this->present_) {
+    if (present) {
+      // the devices may have been replaced while none answered
+      ESP_LOGI(TAG, "Devices answer on the bus again.");
+      this->invalidate_cache_();
+    } else {
+      ESP_LOGW(TAG, "No device answered on the bus, were the sensors disconnected?");
+    }
+    this->present_ = present;
+  }
+
   bool result;
-  if (!this->one_wire_->reset()) {
+  if (!present) {
     result = false;
   } else {
     result = true;
     this->one_wire_->skip();
     this->one_wire_->write8(DALLAS_COMMAND_START_CONVERSION);
   }
-  enable_interrupts();
 
   if (!result) {
     ESP_LOGE(TAG, "Requesting conversion failed");
     this->status_set_warning();
+    this->read_index_ = this->read_order_.size();
     return;
   }
 
-  for (auto *sensor : this->sensors_) {
-    this->set_timeout(sensor->get_address_name(), sensor->millis_to_wait_for_conversion(), [this, sensor] {
-      disable_interrupts();
-      bool res = sensor->read_scratch_pad();
-      enable_interrupts();
+  this->conversion_start_ = millis();
+  this->read_index_ = 0;
+  this->enable_loop();
+}
+void DallasComponent::loop() {
+  if (this->read_index_ >= this->read_order_.size()) {
+    this->disable_loop();
+    return;
+  }
 
-      if (!res) {
-        this->status_set_warning();
-        return;
-      }
-      if (!sensor->check_scratch_pad()) {
-        this->status_set_warning();
-        return;
-      }
+  auto *sensor = this->read_order_[this->read_index_];
+  if (millis() - this->conversion_start_ < sensor->millis_to_wait_for_conversion())
+    // the bus stays idle until the next conversion is done
+    return;
+  this->read_index_++;
 
-      float tempc = sensor->get_temp_c();
-      ESP_LOGD(TAG, "'%s': Got Temperature=%.1f°C", sensor->get_name().c_str(), tempc);
-      sensor->publish_state(tempc);
-    });
+  if (!this->read_sensor_(sensor)) {
+    this->status_set_warning();
+    return;
   }
+
+  float tempc = sensor->get_temp_c();
+  ESP_LOGD(TAG, "'%s': Got Temperature=%.1f°C", sensor->get_name().c_str(), tempc);
+  sensor->publish_state(tempc);
+}
+bool DallasComponent::read_sensor_(DallasTemperatureSensor *sensor) {
+  for (uint8_t attempt = 0; attempt < DALLAS_READ_ATTEMPTS; attempt++) {
+    if (!sensor->read_scratch_pad())
+      // no device answered the reset, reading again right away won't help
+      break;
+    if (sensor->check_scratch_pad())
+      return true;
+    if (this->skip_rom_) {
+      // a device that was added since the search answers Skip ROM too and garbles the scratch pad
+      ESP_LOGW(TAG, "Addressing '%s' by its ROM from now on.", sensor->get_name().c_str());
+      this->skip_rom_ = false;
+    }
+  }
+  sensor->count_failed_read();
+  // the sensor might be gone, search the bus on the next boot
+  this->invalidate_cache_();
+  return false;
 }
 DallasComponent::DallasComponent(ESPOneWire *one_wire, uint32_t update_interval)
     : PollingComponent(update_interval), one_wire_(one_wire) {}
 ESPOneWire *DallasComponent::get_one_wire() const { return this->one_wire_; }
+bool DallasComponent::is_skipping_rom() const { return this->skip_rom_; }
 
 DallasTemperatureSensor::DallasTemperatureSensor(const std::string &name, uint64_t address, uint8_t resolution,
                                                  DallasComponent *parent)
@@ -190,7 +308,11 @@ bool DallasTemperatureSensor::read_scratch_pad() {
     return false;
   }
 
-  wire->select(this->address_);
+  if (this->parent_->is_skipping_rom()) {
+    wire->skip();
+  } else {
+    wire->select(this->address_);
+  }
   wire->write8(DALLAS_COMMAND_READ_SCRATCH_PAD);
 
   for (unsigned char &i : this->scratch_pad_) {
@@ -199,9 +321,7 @@ bool DallasTemperatureSensor::read_scratch_pad() {
   return true;
 }
 bool DallasTemperatureSensor::setup_sensor() {
-  disable_interrupts();
   bool r = this->read_scratch_pad();
-  enable_interrupts();
 
   if (!r) {
     ESP_LOGE(TAG, "Reading scratchpad failed: reset");
@@ -210,33 +330,34 @@ bool DallasTemperatureSensor::setup_sensor() {
   if (!this->check_scratch_pad())
     return false;
 
-  if (this->scratch_pad_[4] == this->resolution_)
-    return false;
-
   if (this->get_address8()[0] == DALLAS_MODEL_DS18S20) {
     // DS18S20 doesn't support resolution.
     ESP_LOGW(TAG, "DS18S20 doesn't support setting resolution.");
     return false;
   }
 
+  uint8_t config;
   switch (this->resolution_) {
     case 12:
-      this->scratch_pad_[4] = 0x7F;
+      config = 0x7F;
       break;
     case 11:
-      this->scratch_pad_[4] = 0x5F;
+      config = 0x5F;
       break;
     case 10:
-      this->scratch_pad_[4] = 0x3F;
+      config = 0x3F;
       break;
     case 9:
     default:
-      this->scratch_pad_[4] = 0x1F;
+      config = 0x1F;
       break;
   }
+  // don't wear out the EEPROM if the resolution is already set
+  if (this->scratch_pad_[4] == config)
+    return true;
+  this->scratch_pad_[4] = config;
 
   ESPOneWire *wire = this->parent_->get_one_wire();
-  disable_interrupts();
   if (wire->reset()) {
     wire->select(this->address_);
     wire->write8(DALLAS_COMMAND_WRITE_SCRATCH_PAD);
@@ -249,7 +370,6 @@ bool DallasTemperatureSensor::setup_sensor() {
     wire->select(this->address_);
     wire->write8(0x48);
   }
-  enable_interrupts();
 
   delay(20);  // allow it to finish operation
   wire->reset();
@@ -263,6 +383,7 @@ bool DallasTemperatureSensor::check_scratch_pad() {
             crc8(this->scratch_pad_, 8));
 #endif
   if (crc8(this->scratch_pad_, 8) != this->scratch_pad_[8]) {
+    this->crc_failures_++;
     ESP_LOGE(TAG, "Reading scratchpad from Dallas Sensor failed");
     return false;
   }
@@ -277,6 +398,9 @@ float DallasTemperatureSensor::get_temp_c() {
 
   return temp / 128.0f;
 }
+uint32_t DallasTemperatureSensor::get_crc_failures() const { return this->crc_failures_; }
+uint32_t DallasTemperatureSensor::get_failed_reads() const { return this->failed_reads_; }
+void DallasTemperatureSensor::count_failed_read() { this->failed_reads_++; }
 std::string DallasTemperatureSensor::unique_id() { return "dallas-" + uint64_to_string(this->address_); }
 
 }  // namespace sensor
@@ -7,6 +7,7 @@
 
 #include "esphome/sensor/sensor.h"
 #include "esphome/esp_one_wire.h"
+#include "esphome/esppreferences.h"
 
 ESPHOME_NAMESPACE_BEGIN
 
@@ -14,9 +15,24 @@ namespace sensor {
 
 class DallasTemperatureSensor;
 
+/// The maximum number of devices whose ROM is cached in preferences.
+#define DALLAS_MAX_CACHED_DEVICES 8
+
+/// The devices found on the bus and the resolution each one is configured for, stored in preferences.
+struct DallasCacheState {
+  uint8_t count;
+  uint8_t resolutions[DALLAS_MAX_CACHED_DEVICES];
+  uint64_t addresses[DALLAS_MAX_CACHED_DEVICES];
+};
+
 /** Hub for dealing with dallas temperature sensor. Uses a OneWire interface.
  *
  * Get the individual sensors with `get_sensor_by_address` or `get_sensor_by_index`.
+ *
+ * The devices found on the bus are cached in preferences together with the resolution each one was set to. On the
+ * next boot, the full ROM search (and re-configuring the resolution) is skipped if every cached device still answers
+ * and all sensors can be resolved from the cache. If there's only one device on the bus, it's addressed with Skip
+ * ROM instead of its 64-bit ROM; a scratch pad with an invalid CRC is read again (by ROM) before giving up.
  */
 class DallasComponent : public PollingComponent {
  public:
@@ -53,14 +69,39 @@ class DallasComponent : public PollingComponent {
   /// HARDWARE_LATE setup priority.
   float get_setup_priority() const override;
 
+  /// Request a conversion from all sensors on the bus at once.
   void update() override;
+  /// Read the sensors whose conversion is done, one per loop() so that the bus isn't busy for long.
+  void loop() override;
 
   ESPOneWire *get_one_wire() const;
+  /// Whether the sensors are addressed with Skip ROM because there's only one device on the bus.
+  bool is_skipping_rom() const;
 
  protected:
+  /// Search the bus for supported devices, and fill the cache with them.
+  void search_();
+  /// Use the cached devices if all of them are still present, return false if a search is needed.
+  bool load_cache_();
+  /// Search the bus again on the next boot.
+  void invalidate_cache_();
+  /// Read the scratch pad of sensor, retrying on CRC errors.
+  bool read_sensor_(DallasTemperatureSensor *sensor);
+
   ESPOneWire *one_wire_;
   std::vector<DallasTemperatureSensor *> sensors_;
   std::vector<uint64_t> found_sensors_;
+  /// The sensors sorted by their conversion time, so the fastest ones are read first.
+  std::vector<DallasTemperatureSensor *> read_order_;
+  /// The index in read_order_ of the next sensor to read, read_order_.size() if no conversion is running.
+  size_t read_index_{0};
+  uint32_t conversion_start_{0};
+  ESPPreferenceObject cache_pref_;
+  DallasCacheState cache_{};
+  bool from_cache_{false};
+  bool skip_rom_{false};
+  /// Whether a device answered the last reset, to log when devices are removed or added.
+  bool present_{true};
 };
 
 /// Internal class that helps us create multiple sensors for one Dallas hub.
@@ -101,6 +142,12 @@ class DallasTemperatureSensor : public EmptyPollingParentSensor<1, ICON_EMPTY, U
 
   float get_temp_c();
 
+  /// Get how many scratch pads with an invalid CRC were read from this sensor.
+  uint32_t get_crc_failures() const;
+  /// Get how many readings failed even after retrying.
+  uint32_t get_failed_reads() const;
+  void count_failed_read();
+
   std::string unique_id() override;
 
  protected:
@@ -112,6 +159,8 @@ class DallasTemperatureSensor : public EmptyPollingParentSensor<1, ICON_EMPTY, U
   uint8_t scratch_pad_[9] = {
       0,
   };
+  uint32_t crc_failures_{0};
+  uint32_t failed_reads_{0};
 };
 
 }  // namespace sensor
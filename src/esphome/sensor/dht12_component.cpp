@@ -63,6 +63,7 @@ void DHT12Component::dump_config() {
   LOG_SENSOR("  ", "Humidity", this->humidity_sensor_);
 }
 float DHT12Component::get_setup_priority() const { return setup_priority::HARDWARE_LATE; }
+uint32_t DHT12Component::get_loop_idle_time() { return SCHEDULER_DONT_RUN; }
 bool DHT12Component::read_data_(uint8_t *data) {
   if (!this->read_bytes(0, data, 5)) {
     ESP_LOGW(TAG, "Updating DHT12 failed!");
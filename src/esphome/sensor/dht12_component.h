@@ -26,6 +26,7 @@ class DHT12Component : public PollingComponent, public I2CDevice {
   void dump_config() override;
   float get_setup_priority() const override;
   void update() override;
+  uint32_t get_loop_idle_time() override;
   DHT12TemperatureSensor *get_temperature_sensor() const;
   DHT12HumiditySensor *get_humidity_sensor() const;
 
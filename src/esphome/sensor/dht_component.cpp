@@ -30,6 +30,8 @@ void DHTComponent::setup() {
   this->pin_->digital_write(true);
   this->pin_->setup();
   this->pin_->digital_write(true);
+  this->store_.pin = this->pin_->to_isr();
+  this->pin_->attach_interrupt(DHTStore::gpio_intr, &this->store_, CHANGE);
 }
 void DHTComponent::dump_config() {
   ESP_LOGCONFIG(TAG, "DHT:");
@@ -49,20 +51,63 @@ void DHTComponent::dump_config() {
 }
 
 void DHTComponent::update() {
-  float temperature, humidity;
-  bool error;
+  if (this->reading_) {
+    ESP_LOGW(TAG, "Previous read hasn't finished yet, skipping!");
+    return;
+  }
   if (this->model_ == DHT_MODEL_AUTO_DETECT) {
     this->model_ = DHT_MODEL_DHT22;
-    error = this->read_sensor_(&temperature, &humidity, false);
-    if (error) {
-      this->model_ = DHT_MODEL_DHT11;
-      return;
-    }
+    this->detecting_ = true;
+  }
+  this->start_read_();
+}
+void DHTComponent::start_read_() {
+  this->reading_ = true;
+  this->pin_->digital_write(false);
+  this->pin_->pin_mode(OUTPUT);
+  this->pin_->digital_write(false);
+
+  if (this->model_ == DHT_MODEL_DHT11) {
+    // the long start signal of the DHT11 doesn't block the loop
+    this->set_timeout("start", 18, [this]() { this->release_(); });
+    return;
+  }
+  // sub-millisecond start signals are too short for the scheduler
+  if (this->model_ == DHT_MODEL_SI7021) {
+    delayMicroseconds(500);
+    this->pin_->digital_write(true);
+    delayMicroseconds(40);
   } else {
-    error = this->read_sensor_(&temperature, &humidity, true);
+    delayMicroseconds(800);
   }
+  this->release_();
+}
+void DHTComponent::release_() {
+  this->store_.count = 0;
+  this->store_.capturing = true;
+  this->pin_->pin_mode(INPUT_PULLUP);
+#ifdef ARDUINO_ARCH_ESP32
+  // pinMode() rewrites the pin config register on the ESP32, which also clears its interrupt type and enable bits
+  this->pin_->attach_interrupt(DHTStore::gpio_intr, &this->store_, CHANGE);
+#endif
+  // the response takes at most 80us + 80us + 40 * 120us, just below 5ms
+  this->set_timeout("read", 10, [this]() { this->finish_read_(); });
+}
+void DHTComponent::finish_read_() {
+  this->store_.capturing = false;
+  this->reading_ = false;
 
-  if (error) {
+  float temperature, humidity;
+  const bool detecting = this->detecting_;
+  this->detecting_ = false;
+  const bool success = this->decode_(&temperature, &humidity, !detecting);
+  if (!success && detecting) {
+    // not a DHT22, try as a DHT11 next time
+    this->model_ = DHT_MODEL_DHT11;
+    return;
+  }
+
+  if (success) {
     ESP_LOGD(TAG, "Got Temperature=%.1f°C Humidity=%.1f%%", temperature, humidity);
 
     this->temperature_sensor_->publish_state(temperature);
@@ -79,86 +124,67 @@ void DHTComponent::update() {
 }
 
 float DHTComponent::get_setup_priority() const { return setup_priority::HARDWARE_LATE; }
+uint32_t DHTComponent::get_loop_idle_time() { return SCHEDULER_DONT_RUN; }
 void DHTComponent::set_dht_model(DHTModel model) {
   this->model_ = model;
   this->is_auto_detect_ = model == DHT_MODEL_AUTO_DETECT;
 }
 DHTTemperatureSensor *DHTComponent::get_temperature_sensor() const { return this->temperature_sensor_; }
 DHTHumiditySensor *DHTComponent::get_humidity_sensor() const { return this->humidity_sensor_; }
-bool HOT DHTComponent::read_sensor_(float *temperature, float *humidity, bool report_errors) {
+void ICACHE_RAM_ATTR HOT DHTStore::gpio_intr(DHTStore *arg) {
+  if (!arg->capturing)
+    return;
+  const uint8_t count = arg->count;
+  if (count >= DHT_MAX_EDGES)
+    return;
+  arg->times[count] = micros();
+  arg->levels[count] = arg->pin->digital_read();
+  arg->count = count + 1;
+}
+bool DHTComponent::decode_(float *temperature, float *humidity, bool report_errors) {
   *humidity = NAN;
   *temperature = NAN;
 
-  disable_interrupts();
-  this->pin_->digital_write(false);
-  this->pin_->pin_mode(OUTPUT);
-  this->pin_->digital_write(false);
-
-  if (this->model_ == DHT_MODEL_DHT11) {
-    delayMicroseconds(18000);
-  } else if (this->model_ == DHT_MODEL_SI7021) {
-    delayMicroseconds(500);
-    this->pin_->digital_write(true);
-    delayMicroseconds(40);
-  } else {
-    delayMicroseconds(800);
+  // The sensor answers with 80us low, 80us high and then sends each bit as 50us low followed by 26-28us (0) or
+  // 70us (1) high. The bits are the last 40 complete high pulses.
+  const uint8_t count = this->store_.count;
+  uint8_t highs = 0;
+  for (uint8_t i = 0; i + 1 < count; i++) {
+    if (this->store_.levels[i] && !this->store_.levels[i + 1])
+      highs++;
   }
-  this->pin_->pin_mode(INPUT_PULLUP);
-  delayMicroseconds(40);
-
-  uint8_t data[5] = {0, 0, 0, 0, 0};
-  uint8_t bit = 7;
-  uint8_t byte = 0;
-
-  for (int8_t i = -1; i < 40; i++) {
-    uint32_t start_time = micros();
-
-    // Wait for rising edge
-    while (!this->pin_->digital_read()) {
-      if (micros() - start_time > 90) {
-        enable_interrupts();
-        if (report_errors) {
-          if (i < 0) {
-            ESP_LOGW(TAG, "Waiting for DHT communication to clear failed!");
-          } else {
-            ESP_LOGW(TAG, "Rising edge for bit %d failed!", i);
-          }
-        }
-        return false;
-      }
-    }
-
-    start_time = micros();
-    uint32_t end_time = start_time;
-
-    // Wait for falling edge
-    while (this->pin_->digital_read()) {
-      if ((end_time = micros()) - start_time > 90) {
-        enable_interrupts();
-        if (report_errors) {
-          if (i < 0) {
-            ESP_LOGW(TAG, "Requesting data from DHT failed!");
-          } else {
-            ESP_LOGW(TAG, "Falling edge for bit %d failed!", i);
-          }
-        }
-        return false;
+  if (highs < 40) {
+    if (report_errors) {
+      if (count == 0) {
+        ESP_LOGW(TAG, "Requesting data from DHT failed!");
+      } else {
+        ESP_LOGW(TAG, "Only received %u of 40 bits!", highs);
       }
     }
+    return false;
+  }
 
-    if (i < 0)
+  uint8_t data[5] = {0, 0, 0, 0, 0};
+  uint8_t skip = highs - 40;
+  uint8_t bit = 0;
+  for (uint8_t i = 0; i + 1 < count; i++) {
+    if (!this->store_.levels[i] || this->store_.levels[i + 1])
       continue;
-
-    if (end_time - start_time >= 40) {
-      data[byte] |= 1 << bit;
+    if (skip > 0) {
+      skip--;
+      continue;
+    }
+    const uint32_t length = this->store_.times[i + 1] - this->store_.times[i];
+    if (length > 90) {
+      if (report_errors) {
+        ESP_LOGW(TAG, "Falling edge for bit %u failed!", bit);
+      }
+      return false;
     }
-    if (bit == 0) {
-      bit = 7;
-      byte++;
-    } else
-      bit--;
+    if (length >= 40)
+      data[bit / 8] |= 1 << (7 - bit % 8);
+    bit++;
   }
-  enable_interrupts();
 
   ESP_LOGVV(TAG,
             "Data: Hum=0b" BYTE_TO_BINARY_PATTERN BYTE_TO_BINARY_PATTERN
@@ -14,6 +14,26 @@ namespace sensor {
 using DHTTemperatureSensor = EmptyPollingParentSensor<1, ICON_EMPTY, UNIT_C>;
 using DHTHumiditySensor = EmptyPollingParentSensor<0, ICON_WATER_PERCENT, UNIT_PERCENT>;
 
+/// Response (3 edges) plus 40 bits (2 edges each) and some room for a glitch.
+static const uint8_t DHT_MAX_EDGES = 88;
+
+/** The edges of the response captured in an interrupt, decoded in the component afterwards.
+ *
+ * Store data in a class that doesn't use multiple-inheritance (vtables in flash).
+ */
+struct DHTStore {
+  ISRInternalGPIOPin *pin;
+  /// Only record edges while the sensor sends, the interrupt stays attached.
+  volatile bool capturing{false};
+  volatile uint8_t count{0};
+  /// micros() time of each edge.
+  volatile uint32_t times[DHT_MAX_EDGES];
+  /// The pin level after each edge.
+  volatile bool levels[DHT_MAX_EDGES];
+
+  static void gpio_intr(DHTStore *arg);
+};
+
 enum DHTModel {
   DHT_MODEL_AUTO_DETECT = 0,
   DHT_MODEL_DHT11,
@@ -59,15 +79,26 @@ class DHTComponent : public PollingComponent {
   void dump_config() override;
   /// Update sensor values and push them to the frontend.
   void update() override;
+  uint32_t get_loop_idle_time() override;
   /// HARDWARE_LATE setup priority.
   float get_setup_priority() const override;
 
  protected:
-  bool read_sensor_(float *temperature, float *humidity, bool report_errors);
+  /// Pull the line low for the start signal.
+  void start_read_();
+  /// End the start signal and capture the response.
+  void release_();
+  /// Decode the captured response and publish it.
+  void finish_read_();
+  bool decode_(float *temperature, float *humidity, bool report_errors);
 
   GPIOPin *pin_;
   DHTModel model_{DHT_MODEL_AUTO_DETECT};
   bool is_auto_detect_{false};
+  /// Whether this read tries if the sensor is a DHT22.
+  bool detecting_{false};
+  bool reading_{false};
+  DHTStore store_;
   DHTTemperatureSensor *temperature_sensor_;
   DHTHumiditySensor *humidity_sensor_;
 };
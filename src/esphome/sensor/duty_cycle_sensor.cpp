@@ -4,6 +4,12 @@
 
 #include "esphome/sensor/duty_cycle_sensor.h"
 #include "esphome/log.h"
+#include "esphome/helpers.h"
+
+#ifdef ARDUINO_ARCH_ESP32
+#include <soc/mcpwm_reg.h>
+#include <soc/mcpwm_struct.h>
+#endif
 
 ESPHOME_NAMESPACE_BEGIN
 
@@ -11,6 +17,17 @@ namespace sensor {
 
 static const char *TAG = "sensor.duty_cycle";
 
+#ifdef ARDUINO_ARCH_ESP32
+/// The capture timer runs from the 80MHz APB clock.
+static const uint32_t DUTY_CYCLE_CAPTURE_TICKS_PER_SECOND = 80000000UL;
+static const uint8_t DUTY_CYCLE_CAPTURE_CHANNELS = 3;
+/// The capture stores by unit and channel, for the shared interrupt of each unit.
+static DutyCycleSensorStore *capture_stores[MCPWM_UNIT_MAX][DUTY_CYCLE_CAPTURE_CHANNELS] = {{nullptr}};
+static bool capture_intr_registered[MCPWM_UNIT_MAX] = {false};
+static mcpwm_dev_t *capture_devices[MCPWM_UNIT_MAX] = {&MCPWM0, &MCPWM1};
+static int8_t next_capture = 0;
+#endif
+
 DutyCycleSensor::DutyCycleSensor(const std::string &name, GPIOPin *pin, uint32_t update_interval)
     : PollingSensorComponent(name, update_interval), pin_(pin) {}
 
@@ -19,52 +36,160 @@ void DutyCycleSensor::setup() {
   this->pin_->setup();
   this->store_.pin = this->pin_->to_isr();
   this->store_.last_level = this->pin_->digital_read();
-  this->last_update_ = micros();
 
+#ifdef ARDUINO_ARCH_ESP32
+  if (next_capture < MCPWM_UNIT_MAX * DUTY_CYCLE_CAPTURE_CHANNELS) {
+    this->capture_ = next_capture++;
+    if (!this->capture_setup_())
+      this->mark_failed();
+    return;
+  }
+  ESP_LOGW(TAG, "All MCPWM capture channels are in use, falling back to a GPIO interrupt");
+#endif
   this->pin_->attach_interrupt(DutyCycleSensorStore::gpio_intr, &this->store_, CHANGE);
 }
+#ifdef ARDUINO_ARCH_ESP32
+bool DutyCycleSensor::capture_setup_() {
+  const uint8_t unit = this->capture_ / DUTY_CYCLE_CAPTURE_CHANNELS;
+  const uint8_t channel = this->capture_ % DUTY_CYCLE_CAPTURE_CHANNELS;
+  const auto mcpwm_unit = mcpwm_unit_t(unit);
+
+  esp_err_t error = mcpwm_gpio_init(mcpwm_unit, mcpwm_io_signals_t(MCPWM_CAP_0 + channel), this->pin_->get_pin());
+  if (error == ESP_OK)
+    error = mcpwm_capture_enable(mcpwm_unit, mcpwm_capture_signal_t(MCPWM_SELECT_CAP0 + channel), MCPWM_POS_EDGE, 0);
+  if (error != ESP_OK) {
+    ESP_LOGE(TAG, "Configuring MCPWM capture failed: %s", esp_err_to_name(error));
+    return false;
+  }
+  // capture both edges (mode bit 0 is the falling, bit 1 the rising edge)
+  capture_devices[unit]->cap_cfg_ch[channel].mode = 3;
+
+  capture_stores[unit][channel] = &this->store_;
+  if (!capture_intr_registered[unit]) {
+    error = mcpwm_isr_register(mcpwm_unit, DutyCycleSensorStore::mcpwm_intr, reinterpret_cast<void *>(unit), 0,
+                               nullptr);
+    if (error != ESP_OK) {
+      ESP_LOGE(TAG, "Registering MCPWM interrupt failed: %s", esp_err_to_name(error));
+      return false;
+    }
+    capture_intr_registered[unit] = true;
+  }
+  this->enable_capture_interrupt_();
+  return true;
+}
+void DutyCycleSensor::enable_capture_interrupt_() {
+  const uint32_t mask = MCPWM_CAP0_INT_ENA << (this->capture_ % DUTY_CYCLE_CAPTURE_CHANNELS);
+  mcpwm_dev_t *dev = capture_devices[this->capture_ / DUTY_CYCLE_CAPTURE_CHANNELS];
+  dev->int_clr.val = mask;
+  dev->int_ena.val |= mask;
+}
+#endif
 void DutyCycleSensor::dump_config() {
   LOG_SENSOR("", "Duty Cycle Sensor", this);
   LOG_PIN("  Pin: ", this->pin_);
+#ifdef ARDUINO_ARCH_ESP32
+  if (this->capture_ != -1) {
+    ESP_LOGCONFIG(TAG, "  MCPWM Unit %d Capture Channel %d", this->capture_ / DUTY_CYCLE_CAPTURE_CHANNELS,
+                  this->capture_ % DUTY_CYCLE_CAPTURE_CHANNELS);
+  }
+#endif
+  ESP_LOGCONFIG(TAG, "  Window: %u cycles", this->store_.window_cycles);
   LOG_UPDATE_INTERVAL(this);
+  LOG_SENSOR("  ", "Frequency", this->frequency_sensor_);
 }
 void DutyCycleSensor::update() {
-  const uint32_t now = micros();
+  disable_interrupts();
+  const uint64_t high_sum = this->store_.high_sum;
+  const uint64_t period_sum = this->store_.period_sum;
+  const uint32_t cycles = this->store_.cycles;
   const bool level = this->store_.last_level;
-  const uint32_t last_interrupt = this->store_.last_interrupt;
-  uint32_t on_time = this->store_.on_time;
-
-  if (level)
-    on_time += now - last_interrupt;
-
-  const float total_time = float(now - this->last_update_);
-
-  const float value = (on_time / total_time) * 100.0f;
-  ESP_LOGD(TAG, "'%s' Got duty cycle=%.1f%%", this->get_name().c_str(), value);
+  const bool window_full = cycles >= this->store_.window_cycles;
+  this->store_.high_sum = 0;
+  this->store_.period_sum = 0;
+  this->store_.cycles = 0;
+  if (window_full)
+    // the edges since then haven't been seen, start with the next rising edge
+    this->store_.has_rise = false;
+  enable_interrupts();
+
+#ifdef ARDUINO_ARCH_ESP32
+  if (window_full && this->capture_ != -1)
+    this->enable_capture_interrupt_();
+#endif
+
+  float value, frequency;
+  if (cycles == 0 || period_sum == 0) {
+    // no complete cycle, the signal is constant (or too slow for the update interval)
+    value = level ? 100.0f : 0.0f;
+    frequency = 0.0f;
+  } else {
+    value = float(double(high_sum) / double(period_sum) * 100.0);
+    frequency = float(double(cycles) * this->ticks_per_second_() / double(period_sum));
+  }
+  ESP_LOGD(TAG, "'%s' Got duty cycle=%.1f%% frequency=%.1fHz", this->get_name().c_str(), value, frequency);
   this->publish_state(value);
-
-  this->store_.on_time = 0;
-  this->store_.last_interrupt = now;
-  this->last_update_ = now;
+  if (this->frequency_sensor_ != nullptr)
+    this->frequency_sensor_->publish_state(frequency);
+}
+uint32_t DutyCycleSensor::ticks_per_second_() const {
+#ifdef ARDUINO_ARCH_ESP32
+  if (this->capture_ != -1)
+    return DUTY_CYCLE_CAPTURE_TICKS_PER_SECOND;
+#endif
+  return 1000000UL;
 }
 
-std::string DutyCycleSensor::unit_of_measurement() { return "%"; }
-std::string DutyCycleSensor::icon() { return "mdi:percent"; }
+const char *DutyCycleSensor::unit_of_measurement() { return "%"; }
+const char *DutyCycleSensor::icon() { return "mdi:percent"; }
 int8_t DutyCycleSensor::accuracy_decimals() { return 1; }
 float DutyCycleSensor::get_setup_priority() const { return setup_priority::HARDWARE_LATE; }
+uint32_t DutyCycleSensor::get_loop_idle_time() { return SCHEDULER_DONT_RUN; }
+DutyCycleFrequencySensor *DutyCycleSensor::make_frequency_sensor(const std::string &name) {
+  return this->frequency_sensor_ = new DutyCycleFrequencySensor(name);
+}
+void DutyCycleSensor::set_window_cycles(uint32_t window_cycles) { this->store_.window_cycles = window_cycles; }
 
-void ICACHE_RAM_ATTR DutyCycleSensorStore::gpio_intr(DutyCycleSensorStore *arg) {
-  const bool new_level = arg->pin->digital_read();
-  if (new_level == arg->last_level)
+void ICACHE_RAM_ATTR HOT DutyCycleSensorStore::record_edge(uint32_t time, bool level) {
+  if (level == this->last_level)
     return;
-  arg->last_level = new_level;
-  const uint32_t now = micros();
-
-  if (!new_level)
-    arg->on_time += now - arg->last_interrupt;
-
-  arg->last_interrupt = now;
+  this->last_level = level;
+  if (!level) {
+    this->high_time = time - this->last_rise;
+    return;
+  }
+  if (this->has_rise && this->cycles < this->window_cycles) {
+    this->high_sum += this->high_time;
+    this->period_sum += time - this->last_rise;
+    this->cycles++;
+  }
+  this->last_rise = time;
+  this->has_rise = true;
+}
+void ICACHE_RAM_ATTR HOT DutyCycleSensorStore::gpio_intr(DutyCycleSensorStore *arg) {
+  arg->record_edge(micros(), arg->pin->digital_read());
+}
+#ifdef ARDUINO_ARCH_ESP32
+void IRAM_ATTR HOT DutyCycleSensorStore::mcpwm_intr(void *arg) {
+  const uint8_t unit = reinterpret_cast<uint32_t>(arg);
+  mcpwm_dev_t *dev = capture_devices[unit];
+  const uint32_t status = dev->int_st.val;
+  for (uint8_t channel = 0; channel < DUTY_CYCLE_CAPTURE_CHANNELS; channel++) {
+    const uint32_t mask = MCPWM_CAP0_INT_ST << channel;
+    if ((status & mask) == 0)
+      continue;
+    dev->int_clr.val = mask;
+    DutyCycleSensorStore *store = capture_stores[unit][channel];
+    if (store == nullptr)
+      continue;
+    // the edge bit is set for a falling edge
+    const bool level = (dev->cap_status.val & BIT(channel)) == 0;
+    store->record_edge(dev->cap_val_ch[channel], level);
+    if (store->cycles >= store->window_cycles)
+      // window full, enabled again by update()
+      dev->int_ena.val &= ~(MCPWM_CAP0_INT_ENA << channel);
+  }
 }
+#endif
 
 }  // namespace sensor
 
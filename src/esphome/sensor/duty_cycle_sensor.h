@@ -7,37 +7,84 @@
 
 #include "esphome/sensor/sensor.h"
 
+#ifdef ARDUINO_ARCH_ESP32
+#include <driver/mcpwm.h>
+#endif
+
 ESPHOME_NAMESPACE_BEGIN
 
 namespace sensor {
 
+using DutyCycleFrequencySensor = EmptySensor<1, ICON_PULSE, UNIT_HZ>;
+
 /// Store data in a class that doesn't use multiple-inheritance (vtables in flash)
 struct DutyCycleSensorStore {
-  volatile uint32_t last_interrupt{0};
-  volatile uint32_t on_time{0};
-  volatile bool last_level{false};
   ISRInternalGPIOPin *pin;
+  /// The level after the last edge.
+  bool last_level{false};
+  /// The time of the last rising edge, in ticks of the time source.
+  uint32_t last_rise{0};
+  bool has_rise{false};
+  /// The high time of the cycle in progress.
+  uint32_t high_time{0};
+
+  /// The sums of all complete cycles (rising edge to rising edge) of the current window.
+  volatile uint64_t high_sum{0};
+  volatile uint64_t period_sum{0};
+  volatile uint32_t cycles{0};
+  uint32_t window_cycles{10000};
+
+  /// Record an edge to the given level at the given time.
+  void record_edge(uint32_t time, bool level);
 
   static void gpio_intr(DutyCycleSensorStore *arg);
+#ifdef ARDUINO_ARCH_ESP32
+  static void mcpwm_intr(void *arg);
+#endif
 };
 
+/** Measure the duty cycle and optionally the frequency of a PWM signal.
+ *
+ * Both are averaged over the complete cycles of each update interval, at most the first window_cycles cycles of it.
+ *
+ * On the ESP32 the edges are timestamped by the capture units of the MCPWM peripheral at 80MHz (12.5ns), so the
+ * interrupt latency doesn't limit the accuracy and signals into the tens of kHz can be measured. Once the window is
+ * full, the capture interrupt is disabled until the next update. The 6 capture channels are assigned in order, further
+ * sensors and the ESP8266 timestamp the edges with micros() in a GPIO interrupt.
+ */
 class DutyCycleSensor : public PollingSensorComponent {
  public:
   DutyCycleSensor(const std::string &name, GPIOPin *pin, uint32_t update_interval = 60000);
 
+  /// Also measure the frequency of the signal in Hz.
+  DutyCycleFrequencySensor *make_frequency_sensor(const std::string &name);
+  /// Average over at most this many cycles per update interval (default 10000).
+  void set_window_cycles(uint32_t window_cycles);
+
   void setup() override;
   float get_setup_priority() const override;
   void dump_config() override;
   void update() override;
-  std::string unit_of_measurement() override;
-  std::string icon() override;
+  uint32_t get_loop_idle_time() override;
+  const char *unit_of_measurement() override;
+  const char *icon() override;
   int8_t accuracy_decimals() override;
 
  protected:
+#ifdef ARDUINO_ARCH_ESP32
+  bool capture_setup_();
+  void enable_capture_interrupt_();
+
+  /// The MCPWM capture channel (unit * 3 + channel), -1 with a GPIO interrupt.
+  int8_t capture_{-1};
+#endif
+  /// The frequency of the timestamps.
+  uint32_t ticks_per_second_() const;
+
   GPIOPin *pin_;
+  DutyCycleFrequencySensor *frequency_sensor_{nullptr};
 
   DutyCycleSensorStore store_;
-  uint32_t last_update_;
 };
 
 }  // namespace sensor
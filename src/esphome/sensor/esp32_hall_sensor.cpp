@@ -19,8 +19,9 @@ void ESP32HallSensor::update() {
   ESP_LOGD(TAG, "'%s': Got reading %.0f µT", this->name_.c_str(), value);
   this->publish_state(value);
 }
-std::string ESP32HallSensor::unit_of_measurement() { return "µT"; }
-std::string ESP32HallSensor::icon() { return "mdi:magnet"; }
+uint32_t ESP32HallSensor::get_loop_idle_time() { return SCHEDULER_DONT_RUN; }
+const char *ESP32HallSensor::unit_of_measurement() { return "µT"; }
+const char *ESP32HallSensor::icon() { return "mdi:magnet"; }
 int8_t ESP32HallSensor::accuracy_decimals() { return -1; }
 std::string ESP32HallSensor::unique_id() { return get_mac_address() + "-hall"; }
 void ESP32HallSensor::dump_config() { LOG_SENSOR("", "ESP32 Hall Sensor", this); }
@@ -18,9 +18,10 @@ class ESP32HallSensor : public PollingSensorComponent {
   void dump_config() override;
 
   void update() override;
+  uint32_t get_loop_idle_time() override;
 
-  std::string unit_of_measurement() override;
-  std::string icon() override;
+  const char *unit_of_measurement() override;
+  const char *icon() override;
   int8_t accuracy_decimals() override;
   std::string unique_id() override;
 };
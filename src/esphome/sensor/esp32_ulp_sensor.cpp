@@ -0,0 +1,213 @@
+#include "esphome/defines.h"
+
+#ifdef USE_ESP32_ULP_SENSOR
+
+#include "esphome/sensor/esp32_ulp_sensor.h"
+#include "esphome/log.h"
+
+#include <cstring>
+#include <esp32/ulp.h>
+#include <esp_sleep.h>
+#include <driver/adc.h>
+#include <driver/rtc_io.h>
+#include <soc/rtc_cntl_reg.h>
+#include <soc/rtc_io_reg.h>
+
+ESPHOME_NAMESPACE_BEGIN
+
+namespace sensor {
+
+static const char *TAG = "sensor.esp32_ulp";
+
+/// Layout of the RTC slow memory (in 32-bit words, the ULP only uses the lower 16 bits of each).
+static const uint16_t ESP32_ULP_DATA_COUNT = 0;
+static const uint16_t ESP32_ULP_DATA_LAST_LEVEL = 1;
+static const uint16_t ESP32_ULP_DATA_SAMPLES = 2;
+static const uint16_t ESP32_ULP_PROGRAM_START = ESP32_ULP_DATA_SAMPLES + ESP32_ULP_MAX_SAMPLES;
+
+enum {
+  ESP32_ULP_LABEL_WAKE = 0,
+  ESP32_ULP_LABEL_DONE,
+};
+
+ESP32ULPSensor::ESP32ULPSensor(const std::string &name, GPIOPin *pin, ESP32ULPMode mode, uint32_t sample_interval)
+    : Sensor(name), pin_(pin), mode_(mode), sample_interval_(sample_interval) {}
+void ESP32ULPSensor::set_attenuation(adc_attenuation_t attenuation) { this->attenuation_ = attenuation; }
+void ESP32ULPSensor::set_batch_size(uint8_t batch_size) {
+  this->batch_size_ = clamp<uint8_t>(1, ESP32_ULP_MAX_SAMPLES, batch_size);
+}
+void ESP32ULPSensor::set_wake_thresholds(float low, float high) {
+  const float full_scale = this->get_full_scale_();
+  this->wake_low_ = uint16_t(clamp(0.0f, 4095.0f, low / full_scale * 4095.0f));
+  this->wake_high_ = uint16_t(clamp(0.0f, 4096.0f, high / full_scale * 4095.0f));
+}
+void ESP32ULPSensor::set_wake_pulses(uint16_t wake_pulses) { this->wake_pulses_ = wake_pulses; }
+void ESP32ULPSensor::add_on_batch_callback(std::function<void(const ESP32ULPSample *, size_t)> &&callback) {
+  this->batch_callback_.add(std::move(callback));
+}
+
+void ESP32ULPSensor::setup() {
+  ESP_LOGCONFIG(TAG, "Setting up ESP32 ULP Sensor '%s'...", this->get_name().c_str());
+  this->pin_->setup();
+  // the ULP keeps running after the wake, stop it before reading what it collected
+  CLEAR_PERI_REG_MASK(RTC_CNTL_STATE0_REG, RTC_CNTL_ULP_CP_SLP_TIMER_EN);
+
+  // the RTC slow memory only holds data from the ULP if we were woken up from deep sleep
+  if (esp_sleep_get_wakeup_cause() != ESP_SLEEP_WAKEUP_UNDEFINED)
+    this->read_batch_();
+
+  add_safe_shutdown_hook([this](const char *cause) {
+    if (strcmp(cause, "deep-sleep") == 0)
+      this->start_();
+  });
+}
+void ESP32ULPSensor::dump_config() {
+  LOG_SENSOR("", "ESP32 ULP Sensor", this);
+  LOG_PIN("  Pin: ", this->pin_);
+  ESP_LOGCONFIG(TAG, "  Sample Interval: %u ms", this->sample_interval_);
+  if (this->mode_ == ESP32_ULP_MODE_ADC) {
+    ESP_LOGCONFIG(TAG, "  Mode: ADC, batches of %u samples", this->batch_size_);
+    ESP_LOGCONFIG(TAG, "  Wake Thresholds: %.2f V - %.2f V", this->wake_low_ / 4095.0f * this->get_full_scale_(),
+                  this->wake_high_ / 4095.0f * this->get_full_scale_());
+  } else {
+    ESP_LOGCONFIG(TAG, "  Mode: Pulse Counter");
+    if (this->wake_pulses_ != 0)
+      ESP_LOGCONFIG(TAG, "  Wake after: %u pulses", this->wake_pulses_);
+  }
+}
+float ESP32ULPSensor::get_setup_priority() const { return setup_priority::HARDWARE; }
+const char *ESP32ULPSensor::unit_of_measurement() { return this->mode_ == ESP32_ULP_MODE_ADC ? UNIT_V : UNIT_PULSES; }
+const char *ESP32ULPSensor::icon() { return this->mode_ == ESP32_ULP_MODE_ADC ? ICON_FLASH : ICON_PULSE; }
+int8_t ESP32ULPSensor::accuracy_decimals() { return this->mode_ == ESP32_ULP_MODE_ADC ? 2 : 0; }
+
+float ESP32ULPSensor::get_full_scale_() const {
+  switch (this->attenuation_) {
+    case ADC_0db:
+      return 1.1f;
+    case ADC_2_5db:
+      return 1.5f;
+    case ADC_6db:
+      return 2.2f;
+    case ADC_11db:
+      return 3.9f;
+  }
+  return 1.1f;
+}
+
+void ESP32ULPSensor::read_batch_() {
+  const uint16_t count = RTC_SLOW_MEM[ESP32_ULP_DATA_COUNT] & 0xFFFF;
+  RTC_SLOW_MEM[ESP32_ULP_DATA_COUNT] = 0;
+
+  if (this->mode_ == ESP32_ULP_MODE_PULSE_COUNTER) {
+    ESP_LOGD(TAG, "'%s': Counted %u pulses while sleeping", this->get_name().c_str(), count);
+    this->publish_state(count);
+    return;
+  }
+
+  const uint8_t samples = std::min<uint16_t>(count, ESP32_ULP_MAX_SAMPLES);
+  ESP_LOGD(TAG, "'%s': Got %u samples from the ULP", this->get_name().c_str(), samples);
+  if (samples == 0)
+    return;
+  ESP32ULPSample batch[ESP32_ULP_MAX_SAMPLES];
+  const float full_scale = this->get_full_scale_();
+  for (uint8_t i = 0; i < samples; i++) {
+    batch[i].value = (RTC_SLOW_MEM[ESP32_ULP_DATA_SAMPLES + i] & 0xFFFF) / 4095.0f * full_scale;
+    // the ULP samples at its wake period, the last sample was taken right before the wake
+    batch[i].age = (samples - 1 - i) * this->sample_interval_;
+  }
+  this->batch_callback_.call(batch, samples);
+  for (uint8_t i = 0; i < samples; i++)
+    this->publish_state(batch[i].value);
+}
+
+void ESP32ULPSensor::start_() {
+  const gpio_num_t gpio = gpio_num_t(this->pin_->get_pin());
+  esp_err_t err;
+  size_t size;
+
+  if (this->mode_ == ESP32_ULP_MODE_ADC) {
+    const int8_t channel = digitalPinToAnalogChannel(gpio);
+    if (channel < 0 || channel >= ADC1_CHANNEL_MAX) {
+      ESP_LOGE(TAG, "Pin %u is not an ADC1 pin, the ULP can't sample it!", gpio);
+      return;
+    }
+    adc1_config_width(ADC_WIDTH_BIT_12);
+    adc1_config_channel_atten(adc1_channel_t(channel), adc_atten_t(this->attenuation_));
+    adc1_ulp_enable();
+
+    const ulp_insn_t program[] = {
+        I_MOVI(R3, 0),
+        I_LD(R2, R3, ESP32_ULP_DATA_COUNT),
+        // don't overwrite a full batch until the main cores read it
+        I_MOVR(R0, R2),
+        M_BGE(ESP32_ULP_LABEL_DONE, this->batch_size_),
+        I_ADC(R0, 0, channel),
+        I_ST(R0, R2, ESP32_ULP_DATA_SAMPLES),
+        I_ADDI(R2, R2, 1),
+        I_ST(R2, R3, ESP32_ULP_DATA_COUNT),
+        // R0 still holds the sample
+        M_BGE(ESP32_ULP_LABEL_WAKE, this->wake_high_),
+        M_BL(ESP32_ULP_LABEL_WAKE, this->wake_low_),
+        I_MOVR(R0, R2),
+        M_BL(ESP32_ULP_LABEL_DONE, this->batch_size_),
+        M_LABEL(ESP32_ULP_LABEL_WAKE),
+        I_WAKE(),
+        M_LABEL(ESP32_ULP_LABEL_DONE),
+        I_HALT(),
+    };
+    size = sizeof(program) / sizeof(ulp_insn_t);
+    err = ulp_process_macros_and_load(ESP32_ULP_PROGRAM_START, program, &size);
+  } else {
+    if (!rtc_gpio_is_valid_gpio(gpio)) {
+      ESP_LOGE(TAG, "Pin %u is not an RTC GPIO, the ULP can't count its pulses!", gpio);
+      return;
+    }
+    rtc_gpio_init(gpio);
+    rtc_gpio_set_direction(gpio, RTC_GPIO_MODE_INPUT_ONLY);
+    const uint32_t rtc_bit = RTC_GPIO_IN_NEXT_S + rtc_gpio_desc[gpio].rtc_num;
+    // R0 = new level - last level, which is 1 for a rising edge (or old - new for a falling edge if inverted)
+    const ulp_insn_t edge_rising = I_SUBR(R0, R0, R1);
+    const ulp_insn_t edge_falling = I_SUBR(R0, R1, R0);
+    // 0 would wake on every pulse, wake only before the counter overflows instead
+    const uint16_t wake_pulses = this->wake_pulses_ != 0 ? this->wake_pulses_ : 0xFFFF;
+    RTC_SLOW_MEM[ESP32_ULP_DATA_LAST_LEVEL] = this->pin_->digital_read() != this->pin_->is_inverted();
+
+    const ulp_insn_t program[] = {
+        I_MOVI(R3, 0),
+        I_RD_REG(RTC_GPIO_IN_REG, rtc_bit, rtc_bit),
+        I_LD(R1, R3, ESP32_ULP_DATA_LAST_LEVEL),
+        I_ST(R0, R3, ESP32_ULP_DATA_LAST_LEVEL),
+        this->pin_->is_inverted() ? edge_falling : edge_rising,
+        M_BL(ESP32_ULP_LABEL_DONE, 1),
+        M_BGE(ESP32_ULP_LABEL_DONE, 2),
+        I_LD(R2, R3, ESP32_ULP_DATA_COUNT),
+        I_ADDI(R2, R2, 1),
+        I_ST(R2, R3, ESP32_ULP_DATA_COUNT),
+        I_MOVR(R0, R2),
+        M_BL(ESP32_ULP_LABEL_DONE, wake_pulses),
+        M_LABEL(ESP32_ULP_LABEL_WAKE),
+        I_WAKE(),
+        M_LABEL(ESP32_ULP_LABEL_DONE),
+        I_HALT(),
+    };
+    size = sizeof(program) / sizeof(ulp_insn_t);
+    err = ulp_process_macros_and_load(ESP32_ULP_PROGRAM_START, program, &size);
+  }
+
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "Loading the ULP program failed: %d", err);
+    return;
+  }
+  RTC_SLOW_MEM[ESP32_ULP_DATA_COUNT] = 0;
+  // the RTC peripherals (RTC GPIOs and the ADC) are powered down in deep sleep by default
+  esp_sleep_pd_config(ESP_PD_DOMAIN_RTC_PERIPH, ESP_PD_OPTION_ON);
+  ulp_set_wakeup_period(0, this->sample_interval_ * 1000);
+  esp_sleep_enable_ulp_wakeup();
+  ulp_run(ESP32_ULP_PROGRAM_START);
+}
+
+}  // namespace sensor
+
+ESPHOME_NAMESPACE_END
+
+#endif  // USE_ESP32_ULP_SENSOR
@@ -0,0 +1,98 @@
+#ifndef ESPHOME_SENSOR_ESP32_ULP_SENSOR_H
+#define ESPHOME_SENSOR_ESP32_ULP_SENSOR_H
+
+#include "esphome/defines.h"
+
+#ifdef USE_ESP32_ULP_SENSOR
+
+#include "esphome/component.h"
+#include "esphome/esphal.h"
+#include "esphome/helpers.h"
+#include "esphome/sensor/sensor.h"
+
+ESPHOME_NAMESPACE_BEGIN
+
+namespace sensor {
+
+/** The maximum number of ADC samples the ULP can batch.
+ *
+ * The program and its data have to fit into the part of the RTC slow memory that's reserved for the ULP, which is
+ * only 512 bytes (128 words) with the Arduino framework.
+ */
+#define ESP32_ULP_MAX_SAMPLES 64
+
+enum ESP32ULPMode {
+  /// Sample an ADC1 channel every sample interval.
+  ESP32_ULP_MODE_ADC = 0,
+  /// Count rising edges of an RTC GPIO, polled every sample interval.
+  ESP32_ULP_MODE_PULSE_COUNTER,
+};
+
+/// A sample taken by the ULP while the main cores were sleeping.
+struct ESP32ULPSample {
+  float value;
+  /// How long before the wake the sample was taken in ms.
+  uint32_t age;
+};
+
+/** Sample a sensor with the ULP coprocessor of the ESP32 while the main cores are in deep sleep.
+ *
+ * Right before the node enters deep sleep, a small ULP program is started that either samples an ADC1 channel or
+ * counts the pulses on an RTC GPIO every sample interval and stores the results in RTC slow memory. The main cores
+ * are only woken up (in addition to the wakeups of the deep sleep component) when the batch is full, a sample is
+ * outside the wake thresholds or enough pulses are counted.
+ *
+ * On the next wake, the batched ADC samples are published in the order they were taken (so that filters see all
+ * of them) and passed to the batch callbacks together with their age. In pulse counter mode the number of pulses
+ * counted while sleeping is published.
+ */
+class ESP32ULPSensor : public Sensor, public Component {
+ public:
+  ESP32ULPSensor(const std::string &name, GPIOPin *pin, ESP32ULPMode mode, uint32_t sample_interval);
+
+  /// Set the attenuation of the ADC (ADC mode), defaults to 0db.
+  void set_attenuation(adc_attenuation_t attenuation);
+  /// Set the number of samples after which the main cores are woken up (ADC mode), defaults to the maximum.
+  void set_batch_size(uint8_t batch_size);
+  /// Wake the main cores when a sample is below low or above high volts (ADC mode).
+  void set_wake_thresholds(float low, float high);
+  /// Wake the main cores after this many pulses (pulse counter mode), defaults to 0 (never).
+  void set_wake_pulses(uint16_t wake_pulses);
+
+  /// Get the samples of each batch with their age, oldest first (ADC mode).
+  void add_on_batch_callback(std::function<void(const ESP32ULPSample *samples, size_t count)> &&callback);
+
+  // ========== INTERNAL METHODS ==========
+  // (In most use cases you won't need these)
+  void setup() override;
+  void dump_config() override;
+  float get_setup_priority() const override;
+  const char *unit_of_measurement() override;
+  const char *icon() override;
+  int8_t accuracy_decimals() override;
+
+ protected:
+  float get_full_scale_() const;
+  /// Publish what the ULP collected during the last deep sleep.
+  void read_batch_();
+  /// Load the program for the mode and start the ULP, called right before entering deep sleep.
+  void start_();
+
+  GPIOPin *pin_;
+  ESP32ULPMode mode_;
+  uint32_t sample_interval_;
+  adc_attenuation_t attenuation_{ADC_0db};
+  uint8_t batch_size_{ESP32_ULP_MAX_SAMPLES};
+  uint16_t wake_low_{0};
+  uint16_t wake_high_{4096};
+  uint16_t wake_pulses_{0};
+  CallbackManager<void(const ESP32ULPSample *, size_t)> batch_callback_;
+};
+
+}  // namespace sensor
+
+ESPHOME_NAMESPACE_END
+
+#endif  // USE_ESP32_ULP_SENSOR
+
+#endif  // ESPHOME_SENSOR_ESP32_ULP_SENSOR_H
@@ -36,6 +36,9 @@ void Filter::initialize(Sensor *parent, Filter *next) {
   this->parent_ = parent;
   this->next_ = next;
 }
+bool Filter::get_state(float *state) { return false; }
+void Filter::restore_state(float state) {}
+Filter *Filter::get_next() const { return this->next_; }
 uint32_t Filter::calculate_remaining_interval(uint32_t input) {
   uint32_t this_interval = this->expected_interval(input);
   ESP_LOGVV(TAG, "Filter(%p)::calculate_remaining_interval(%u) -> %u", this, input, this_interval);
@@ -51,7 +54,7 @@ SlidingWindowMovingAverageFilter::SlidingWindowMovingAverageFilter(size_t window
                                                                    size_t send_first_at)
     : send_every_(send_every),
       send_at_(send_every - send_first_at),
-      average_(SlidingWindowMovingAverage(window_size)) {}
+      average_(window_size) {}
 size_t SlidingWindowMovingAverageFilter::get_send_every() const { return this->send_every_; }
 void SlidingWindowMovingAverageFilter::set_send_every(size_t send_every) { this->send_every_ = send_every; }
 size_t SlidingWindowMovingAverageFilter::get_window_size() const { return this->average_.get_max_size(); }
@@ -70,6 +73,35 @@ optional<float> SlidingWindowMovingAverageFilter::new_value(float value) {
 
 uint32_t SlidingWindowMovingAverageFilter::expected_interval(uint32_t input) { return input * this->send_every_; }
 
+// QuantileFilter
+QuantileFilter::QuantileFilter(size_t window_size, size_t send_every, size_t send_first_at, float quantile)
+    : quantile_(window_size, quantile), send_every_(send_every), send_at_(send_every - send_first_at) {}
+size_t QuantileFilter::get_send_every() const { return this->send_every_; }
+void QuantileFilter::set_send_every(size_t send_every) { this->send_every_ = send_every; }
+size_t QuantileFilter::get_window_size() const { return this->quantile_.get_max_size(); }
+void QuantileFilter::set_window_size(size_t window_size) { this->quantile_.set_max_size(window_size); }
+float QuantileFilter::get_quantile() const { return this->quantile_.get_quantile(); }
+void QuantileFilter::set_quantile(float quantile) { this->quantile_.set_quantile(quantile); }
+optional<float> QuantileFilter::new_value(float value) {
+  float quantile_value = this->quantile_.next_value(value);
+  ESP_LOGVV(TAG, "QuantileFilter(%p)::new_value(%f) -> %f", this, value, quantile_value);
+
+  if (++this->send_at_ >= this->send_every_) {
+    this->send_at_ = 0;
+    if (isnan(quantile_value))
+      // no values yet
+      return {};
+    ESP_LOGVV(TAG, "QuantileFilter(%p)::new_value(%f) SENDING", this, value);
+    return quantile_value;
+  }
+  return {};
+}
+uint32_t QuantileFilter::expected_interval(uint32_t input) { return input * this->send_every_; }
+
+// SlidingWindowMedianFilter
+SlidingWindowMedianFilter::SlidingWindowMedianFilter(size_t window_size, size_t send_every, size_t send_first_at)
+    : QuantileFilter(window_size, send_every, send_first_at, 0.5f) {}
+
 // ExponentialMovingAverageFilter
 ExponentialMovingAverageFilter::ExponentialMovingAverageFilter(float alpha, size_t send_every)
     : send_every_(send_every), send_at_(send_every - 1), average_(ExponentialMovingAverage(alpha)) {}
@@ -89,6 +121,13 @@ void ExponentialMovingAverageFilter::set_send_every(size_t send_every) { this->s
 float ExponentialMovingAverageFilter::get_alpha() const { return this->average_.get_alpha(); }
 void ExponentialMovingAverageFilter::set_alpha(float alpha) { this->average_.set_alpha(alpha); }
 uint32_t ExponentialMovingAverageFilter::expected_interval(uint32_t input) { return input * this->send_every_; }
+bool ExponentialMovingAverageFilter::get_state(float *state) {
+  if (!this->average_.has_value())
+    return false;
+  *state = this->average_.calculate_average();
+  return true;
+}
+void ExponentialMovingAverageFilter::restore_state(float state) { this->average_.set_average(state); }
 
 // LambdaFilter
 LambdaFilter::LambdaFilter(lambda_filter_t lambda_filter) : lambda_filter_(std::move(lambda_filter)) {}
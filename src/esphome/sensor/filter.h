@@ -23,7 +23,7 @@ class MQTTSensorComponent;
  * This class is purposefully kept quite simple, since more complicated
  * filters should really be done with the filter sensor in Home Assistant.
  */
-class Filter {
+class Filter : public SetupAllocated {
  public:
   /** This will be called every time the filter receives a new value.
    *
@@ -48,6 +48,16 @@ class Filter {
 
   void output(float value);
 
+  /** Get the state that this filter accumulated, for example a moving average, to keep it across deep sleep.
+   *
+   * @return Whether this filter has a state.
+   */
+  virtual bool get_state(float *state);
+  /// Continue from a state returned by get_state().
+  virtual void restore_state(float state);
+
+  Filter *get_next() const;
+
  protected:
   friend Sensor;
   friend MQTTSensorComponent;
@@ -88,6 +98,45 @@ class SlidingWindowMovingAverageFilter : public Filter {
   size_t send_at_;
 };
 
+/** Sliding window quantile filter.
+ *
+ * Takes the given quantile of the last window_size values and pushes it out every send_every. Unlike the
+ * moving average this ignores outliers, useful for noisy sensors. Each value takes O(log window_size).
+ */
+class QuantileFilter : public Filter {
+ public:
+  /** Construct a QuantileFilter.
+   *
+   * @param window_size The number of values the quantile is taken of.
+   * @param send_every After how many sensor values should a new one be pushed out.
+   * @param send_first_at After how many values to forward the very first value, see SlidingWindowMovingAverageFilter.
+   * @param quantile The quantile from 0 to 1, for example 0.9 for the 90th percentile.
+   */
+  QuantileFilter(size_t window_size, size_t send_every, size_t send_first_at, float quantile);
+
+  optional<float> new_value(float value) override;
+
+  size_t get_send_every() const;
+  void set_send_every(size_t send_every);
+  size_t get_window_size() const;
+  void set_window_size(size_t window_size);
+  float get_quantile() const;
+  void set_quantile(float quantile);
+
+  uint32_t expected_interval(uint32_t input) override;
+
+ protected:
+  SlidingWindowQuantile quantile_;
+  size_t send_every_;
+  size_t send_at_;
+};
+
+/// Sliding window median filter, a QuantileFilter with a quantile of 0.5.
+class SlidingWindowMedianFilter : public QuantileFilter {
+ public:
+  SlidingWindowMedianFilter(size_t window_size, size_t send_every, size_t send_first_at = 1);
+};
+
 /** Simple exponential moving average filter.
  *
  * Essentially just takes the average of the last few values using exponentially decaying weights.
@@ -106,6 +155,9 @@ class ExponentialMovingAverageFilter : public Filter {
 
   uint32_t expected_interval(uint32_t input) override;
 
+  bool get_state(float *state) override;
+  void restore_state(float state) override;
+
  protected:
   ExponentialMovingAverage average_;
   size_t send_every_;
@@ -0,0 +1,183 @@
+#ifndef ESPHOME_SENSOR_FILTER_PIPELINE_H
+#define ESPHOME_SENSOR_FILTER_PIPELINE_H
+
+#include "esphome/defines.h"
+
+#ifdef USE_SENSOR
+
+#include <utility>
+#include "esphome/sensor/filter.h"
+#include "esphome/helpers.h"
+
+ESPHOME_NAMESPACE_BEGIN
+
+namespace sensor {
+
+/** Stages for FilterPipeline, the compile-time counterparts of the filters with the same name.
+ *
+ * A stage is a plain class (no virtual methods) with:
+ *
+ *  - `bool apply(float &value)`: filter value in place, return false to stop the pipeline.
+ *  - `uint32_t expected_interval(uint32_t input) const`: like Filter::expected_interval().
+ */
+
+/// Add `offset` to each value, see OffsetFilter.
+class OffsetStage {
+ public:
+  explicit OffsetStage(float offset) : offset_(offset) {}
+  inline bool ALWAYS_INLINE apply(float &value) {
+    value += this->offset_;
+    return true;
+  }
+  uint32_t expected_interval(uint32_t input) const { return input; }
+
+ protected:
+  float offset_;
+};
+
+/// Multiply each value by `multiplier`, see MultiplyFilter.
+class MultiplyStage {
+ public:
+  explicit MultiplyStage(float multiplier) : multiplier_(multiplier) {}
+  inline bool ALWAYS_INLINE apply(float &value) {
+    value *= this->multiplier_;
+    return true;
+  }
+  uint32_t expected_interval(uint32_t input) const { return input; }
+
+ protected:
+  float multiplier_;
+};
+
+/// Apply `value * slope + bias`, see CalibrateLinearFilter.
+class CalibrateLinearStage {
+ public:
+  CalibrateLinearStage(float slope, float bias) : slope_(slope), bias_(bias) {}
+  inline bool ALWAYS_INLINE apply(float &value) {
+    value = value * this->slope_ + this->bias_;
+    return true;
+  }
+  uint32_t expected_interval(uint32_t input) const { return input; }
+
+ protected:
+  float slope_;
+  float bias_;
+};
+
+/// Stop at `value_to_filter_out` (or NAN), see FilterOutValueFilter.
+class FilterOutValueStage {
+ public:
+  explicit FilterOutValueStage(float value_to_filter_out) : value_to_filter_out_(value_to_filter_out) {}
+  inline bool ALWAYS_INLINE apply(float &value) {
+    if (isnan(this->value_to_filter_out_))
+      return !isnan(value);
+    return value != this->value_to_filter_out_;
+  }
+  uint32_t expected_interval(uint32_t input) const { return input; }
+
+ protected:
+  float value_to_filter_out_;
+};
+
+/// Average the last window_size values and send every send_every, see SlidingWindowMovingAverageFilter.
+class SlidingWindowMovingAverageStage {
+ public:
+  SlidingWindowMovingAverageStage(size_t window_size, size_t send_every, size_t send_first_at = 1)
+      : average_(window_size), send_every_(send_every), send_at_(send_every - send_first_at) {}
+  inline bool ALWAYS_INLINE apply(float &value) {
+    value = this->average_.next_value(value);
+    if (++this->send_at_ < this->send_every_)
+      return false;
+    this->send_at_ = 0;
+    return true;
+  }
+  uint32_t expected_interval(uint32_t input) const { return input * this->send_every_; }
+
+ protected:
+  SlidingWindowMovingAverage average_;
+  size_t send_every_;
+  size_t send_at_;
+};
+
+/// Only pass values that differ by at least min_delta from the last one passed, see DeltaFilter.
+class DeltaStage {
+ public:
+  explicit DeltaStage(float min_delta) : min_delta_(min_delta) {}
+  inline bool ALWAYS_INLINE apply(float &value) {
+    if (isnan(value))
+      return false;
+    if (!isnan(this->last_value_) && fabsf(value - this->last_value_) < this->min_delta_)
+      return false;
+    this->last_value_ = value;
+    return true;
+  }
+  uint32_t expected_interval(uint32_t input) const { return input; }
+
+ protected:
+  float min_delta_;
+  float last_value_{NAN};
+};
+
+/// The state of all stages of a pipeline in one object, applied in order.
+template<typename... Stages> class FilterPipelineStages;
+
+template<> class FilterPipelineStages<> {
+ public:
+  inline bool ALWAYS_INLINE apply(float &value) { return true; }
+  uint32_t expected_interval(uint32_t input) const { return input; }
+};
+
+template<typename Stage, typename... Rest> class FilterPipelineStages<Stage, Rest...> {
+ public:
+  explicit FilterPipelineStages(Stage stage, Rest... rest) : stage_(std::move(stage)), rest_(std::move(rest)...) {}
+  inline bool ALWAYS_INLINE apply(float &value) { return this->stage_.apply(value) && this->rest_.apply(value); }
+  uint32_t expected_interval(uint32_t input) const {
+    return this->rest_.expected_interval(this->stage_.expected_interval(input));
+  }
+
+ protected:
+  Stage stage_;
+  FilterPipelineStages<Rest...> rest_;
+};
+
+/** A chain of filters that's fixed at compile time, for example offset -> multiply -> moving average -> delta.
+ *
+ * The stages are applied in a single call without virtual dispatch between them, and their state is stored in
+ * the pipeline itself. The pipeline is a Filter, so it can be added to a sensor like any other filter and combined
+ * with runtime filters for the dynamic cases (for example lambdas, debounce or heartbeat).
+ *
+ * Usage:
+ *
+ * ```cpp
+ * sensor->add_filter(make_filter_pipeline(OffsetStage(-2.0f), MultiplyStage(1.5f),
+ *                                         SlidingWindowMovingAverageStage(15, 15), DeltaStage(0.1f)));
+ * ```
+ */
+template<typename... Stages> class FilterPipeline : public Filter {
+ public:
+  explicit FilterPipeline(Stages... stages) : stages_(std::move(stages)...) {}
+
+  optional<float> new_value(float value) override {
+    if (!this->stages_.apply(value))
+      return {};
+    return value;
+  }
+
+  uint32_t expected_interval(uint32_t input) override { return this->stages_.expected_interval(input); }
+
+ protected:
+  FilterPipelineStages<Stages...> stages_;
+};
+
+/// Create a FilterPipeline with the stage types deduced from the arguments.
+template<typename... Stages> FilterPipeline<Stages...> *make_filter_pipeline(Stages... stages) {
+  return new FilterPipeline<Stages...>(std::move(stages)...);
+}
+
+}  // namespace sensor
+
+ESPHOME_NAMESPACE_END
+
+#endif  // USE_SENSOR
+
+#endif  // ESPHOME_SENSOR_FILTER_PIPELINE_H
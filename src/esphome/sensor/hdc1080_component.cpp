@@ -50,28 +50,32 @@ void HDC1080Component::dump_config() {
   LOG_SENSOR("  ", "Humidity", this->humidity_);
 }
 void HDC1080Component::update() {
-  uint16_t raw_temp;
-  if (!this->read_byte_16(HDC1080_CMD_TEMPERATURE, &raw_temp, 9)) {
-    this->status_set_warning();
-    return;
-  }
-  float temp = raw_temp * 0.0025177f - 40.0f;  // raw * 2^-16 * 165 - 40
-  this->temperature_->publish_state(temp);
+  // each conversion takes about 7ms, read them without blocking the loop
+  this->read_byte_16_async(HDC1080_CMD_TEMPERATURE, 9, [this](bool success, uint16_t raw_temp) {
+    if (!success) {
+      this->status_set_warning();
+      return;
+    }
+    float temp = raw_temp * 0.0025177f - 40.0f;  // raw * 2^-16 * 165 - 40
+    this->temperature_->publish_state(temp);
 
-  uint16_t raw_humidity;
-  if (!this->read_byte_16(HDC1080_CMD_HUMIDITY, &raw_humidity, 9)) {
-    this->status_set_warning();
-    return;
-  }
-  float humidity = raw_humidity * 0.001525879f;  // raw * 2^-16 * 100
-  this->humidity_->publish_state(humidity);
+    this->read_byte_16_async(HDC1080_CMD_HUMIDITY, 9, [this, temp](bool success, uint16_t raw_humidity) {
+      if (!success) {
+        this->status_set_warning();
+        return;
+      }
+      float humidity = raw_humidity * 0.001525879f;  // raw * 2^-16 * 100
+      this->humidity_->publish_state(humidity);
 
-  ESP_LOGD(TAG, "Got temperature=%.1f°C humidity=%.1f%%", temp, humidity);
-  this->status_clear_warning();
+      ESP_LOGD(TAG, "Got temperature=%.1f°C humidity=%.1f%%", temp, humidity);
+      this->status_clear_warning();
+    });
+  });
 }
 HDC1080TemperatureSensor *HDC1080Component::get_temperature_sensor() const { return this->temperature_; }
 HDC1080HumiditySensor *HDC1080Component::get_humidity_sensor() const { return this->humidity_; }
 float HDC1080Component::get_setup_priority() const { return setup_priority::HARDWARE_LATE; }
+uint32_t HDC1080Component::get_loop_idle_time() { return SCHEDULER_DONT_RUN; }
 
 }  // namespace sensor
 
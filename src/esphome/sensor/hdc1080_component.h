@@ -33,6 +33,7 @@ class HDC1080Component : public PollingComponent, public I2CDevice {
   void dump_config() override;
   /// Retrieve the latest sensor values. This operation takes approximately 16ms.
   void update() override;
+  uint32_t get_loop_idle_time() override;
 
   /// Get the internal temperature sensor.
   HDC1080TemperatureSensor *get_temperature_sensor() const;
@@ -14,6 +14,11 @@ static const char *TAG = "sensor.hlw8012";
 
 static const uint32_t HLW8012_CLOCK_FREQUENCY = 3579000;
 static const float HLW8012_REFERENCE_VOLTAGE = 2.43f;
+static const uint32_t HLW8012_CF1_CHECK_INTERVAL = 250;
+/// CF1 is unstable for a while after switching SEL.
+static const uint32_t HLW8012_SEL_SETTLE_TIME = 500;
+/// A CF1 window with this many pulses has a resolution of 1%.
+static const int64_t HLW8012_CF1_MIN_PULSES = 100;
 
 HLW8012Component::HLW8012Component(GPIOPin *sel_pin, uint8_t cf_pin, uint8_t cf1_pin, uint32_t update_interval)
     : PollingComponent(update_interval),
@@ -29,6 +34,8 @@ void HLW8012Component::setup() {
     this->mark_failed();
     return;
   }
+  this->cf1_mode_start_ = millis();
+  this->set_interval("cf1", HLW8012_CF1_CHECK_INTERVAL, [this]() { this->check_cf1_(); });
 }
 void HLW8012Component::dump_config() {
   ESP_LOGCONFIG(TAG, "HLW8012:");
@@ -44,60 +51,85 @@ void HLW8012Component::dump_config() {
   LOG_SENSOR("  ", "Power", this->power_sensor_);
 }
 float HLW8012Component::get_setup_priority() const { return setup_priority::HARDWARE_LATE; }
+uint32_t HLW8012Component::get_loop_idle_time() { return SCHEDULER_DONT_RUN; }
 void HLW8012Component::update() {
   pulse_counter_t raw_cf = this->cf_.read_raw_value();
-  pulse_counter_t raw_cf1 = this->cf1_.read_raw_value();
   float cf_hz = raw_cf / (this->get_update_interval() / 1000.0f);
   if (raw_cf <= 1) {
     // don't count single pulse as power
     cf_hz = 0.0f;
   }
-  float cf1_hz = raw_cf1 / (this->get_update_interval() / 1000.0f);
-  if (cf1_hz <= 1) {
-    // don't count single pulse as anything
-    cf1_hz = 0.0f;
-  }
-
-  if (this->nth_value_++ < 2) {
-    return;
-  }
 
   const float v_ref_squared = HLW8012_REFERENCE_VOLTAGE * HLW8012_REFERENCE_VOLTAGE;
   const float power_multiplier_micros =
       64000000.0f * v_ref_squared * this->voltage_divider_ / this->current_resistor_ / 24.0f / HLW8012_CLOCK_FREQUENCY;
-  float power = cf_hz * power_multiplier_micros / 1000000.0f;
-
-  if (this->change_mode_at_ != 0) {
-    // Only read cf1 after one cycle. Apparently it's quite unstable after being changed.
-    if (this->current_mode_) {
-      const float current_multiplier_micros =
-          512000000.0f * HLW8012_REFERENCE_VOLTAGE / this->current_resistor_ / 24.0f / HLW8012_CLOCK_FREQUENCY;
-      float current = cf1_hz * current_multiplier_micros / 1000000.0f;
-      ESP_LOGD(TAG, "Got power=%.1fW, current=%.1fA", power, current);
-      if (this->current_sensor_ != nullptr) {
-        this->current_sensor_->publish_state(current);
-      }
-    } else {
-      const float voltage_multiplier_micros =
-          256000000.0f * HLW8012_REFERENCE_VOLTAGE * this->voltage_divider_ / HLW8012_CLOCK_FREQUENCY;
-      float voltage = cf1_hz * voltage_multiplier_micros / 1000000.0f;
-      ESP_LOGD(TAG, "Got power=%.1fW, voltage=%.1fV", power, voltage);
-      if (this->voltage_sensor_ != nullptr) {
-        this->voltage_sensor_->publish_state(voltage);
-      }
-    }
+#ifdef USE_TOTAL_DAILY_ENERGY_SENSOR
+  if (this->total_daily_energy_ != nullptr) {
+    // each CF pulse is power_multiplier_micros µWs
+    this->total_daily_energy_->add_energy(raw_cf * power_multiplier_micros / 1000000.0f / 3600.0f);
   }
+#endif
 
+  float power = cf_hz * power_multiplier_micros / 1000000.0f;
+  ESP_LOGD(TAG, "Got power=%.1fW", power);
   if (this->power_sensor_ != nullptr) {
     this->power_sensor_->publish_state(power);
   }
 
-  if (this->change_mode_at_++ == this->change_mode_every_) {
-    this->current_mode_ = !this->current_mode_;
-    ESP_LOGV(TAG, "Changing mode to %s mode", this->current_mode_ ? "CURRENT" : "VOLTAGE");
-    this->change_mode_at_ = 0;
-    this->sel_pin_->digital_write(this->current_mode_);
+  if (!isnan(this->voltage_)) {
+    if (this->voltage_sensor_ != nullptr)
+      this->voltage_sensor_->publish_state(this->voltage_);
+    this->voltage_ = NAN;
+  }
+  if (!isnan(this->current_)) {
+    if (this->current_sensor_ != nullptr)
+      this->current_sensor_->publish_state(this->current_);
+    this->current_ = NAN;
+  }
+}
+void HLW8012Component::check_cf1_() {
+  const uint32_t now = millis();
+  if (this->cf1_settling_) {
+    if (now - this->cf1_mode_start_ < HLW8012_SEL_SETTLE_TIME)
+      return;
+    this->cf1_settling_ = false;
+    this->cf1_window_start_ = now;
+    this->cf1_window_start_total_ = this->cf1_.get_total();
+    return;
+  }
+
+  const int64_t pulses = this->cf1_.get_total() - this->cf1_window_start_total_;
+  const uint32_t window = now - this->cf1_window_start_;
+  // high frequencies are accurate quickly, low ones get up to one update interval
+  if (pulses < HLW8012_CF1_MIN_PULSES && window < this->get_update_interval())
+    return;
+
+  // don't count single pulse as anything
+  const float cf1_hz = pulses <= 1 ? 0.0f : pulses * 1000.0f / window;
+  if (this->current_mode_) {
+    const float current_multiplier_micros =
+        512000000.0f * HLW8012_REFERENCE_VOLTAGE / this->current_resistor_ / 24.0f / HLW8012_CLOCK_FREQUENCY;
+    this->current_ = cf1_hz * current_multiplier_micros / 1000000.0f;
+    ESP_LOGV(TAG, "Got current=%.2fA (%d pulses in %u ms)", this->current_, int32_t(pulses), window);
+  } else {
+    const float voltage_multiplier_micros =
+        256000000.0f * HLW8012_REFERENCE_VOLTAGE * this->voltage_divider_ / HLW8012_CLOCK_FREQUENCY;
+    this->voltage_ = cf1_hz * voltage_multiplier_micros / 1000000.0f;
+    ESP_LOGV(TAG, "Got voltage=%.1fV (%d pulses in %u ms)", this->voltage_, int32_t(pulses), window);
   }
+
+  if (++this->change_mode_at_ < this->change_mode_every_) {
+    // another window in the same mode
+    this->cf1_window_start_ = now;
+    this->cf1_window_start_total_ += pulses;
+    return;
+  }
+  this->change_mode_at_ = 0;
+  this->current_mode_ = !this->current_mode_;
+  ESP_LOGV(TAG, "Changing mode to %s mode", this->current_mode_ ? "CURRENT" : "VOLTAGE");
+  this->sel_pin_->digital_write(this->current_mode_);
+  this->cf1_mode_start_ = now;
+  this->cf1_settling_ = true;
 }
 HLW8012VoltageSensor *HLW8012Component::make_voltage_sensor(const std::string &name) {
   return this->voltage_sensor_ = new HLW8012VoltageSensor(name, this);
@@ -113,6 +145,12 @@ void HLW8012Component::set_change_mode_every(uint32_t change_mode_every) {
 }
 void HLW8012Component::set_current_resistor(float current_resistor) { this->current_resistor_ = current_resistor; }
 void HLW8012Component::set_voltage_divider(float voltage_divider) { this->voltage_divider_ = voltage_divider; }
+#ifdef USE_TOTAL_DAILY_ENERGY_SENSOR
+void HLW8012Component::set_total_daily_energy(TotalDailyEnergy *total_daily_energy) {
+  this->total_daily_energy_ = total_daily_energy;
+  total_daily_energy->set_integrate_parent(false);
+}
+#endif
 
 uint32_t HLW8012CurrentSensor::update_interval() {
   return this->parent_->get_update_interval() * this->parent_->change_mode_every_;
@@ -8,6 +8,7 @@
 #include "esphome/component.h"
 #include "esphome/sensor/sensor.h"
 #include "esphome/sensor/pulse_counter.h"
+#include "esphome/sensor/total_daily_energy.h"
 
 ESPHOME_NAMESPACE_BEGIN
 
@@ -33,6 +34,14 @@ class HLW8012CurrentSensor : public EmptySensor<1, ICON_FLASH, UNIT_A> {
 };
 using HLW8012PowerSensor = EmptyPollingParentSensor<1, ICON_FLASH, UNIT_W>;
 
+/** HLW8012 power monitor.
+ *
+ * CF pulses with the power, CF1 with the voltage or current depending on SEL. The pulses are counted by
+ * PulseCounterBase (the PCNT peripheral on the ESP32). Power is measured over each update interval. CF1 is
+ * measured in windows that start once it has settled after switching SEL and end as soon as they have enough
+ * pulses for 1% resolution (or after one update interval for small currents), then SEL is switched. Under load
+ * both voltage and current are therefore fresh on every update.
+ */
 class HLW8012Component : public PollingComponent {
  public:
   HLW8012Component(GPIOPin *sel_pin, uint8_t cf_pin, uint8_t cf1_pin, uint32_t update_interval = 60000);
@@ -41,22 +50,38 @@ class HLW8012Component : public PollingComponent {
   void dump_config() override;
   float get_setup_priority() const override;
   void update() override;
+  uint32_t get_loop_idle_time() override;
 
   HLW8012VoltageSensor *make_voltage_sensor(const std::string &name);
   HLW8012CurrentSensor *make_current_sensor(const std::string &name);
   HLW8012PowerSensor *make_power_sensor(const std::string &name);
+  /// Set the number of CF1 measurement windows before switching SEL, defaults to 1.
   void set_change_mode_every(uint32_t change_mode_every);
   void set_current_resistor(float current_resistor);
   void set_voltage_divider(float voltage_divider);
+#ifdef USE_TOTAL_DAILY_ENERGY_SENSOR
+  /// Add the energy counted by the CF pulses to a total daily energy sensor instead of integrating the power.
+  void set_total_daily_energy(TotalDailyEnergy *total_daily_energy);
+#endif
 
  protected:
   friend HLW8012CurrentSensor;
   friend HLW8012VoltageSensor;
 
-  uint32_t nth_value_{0};
+  /// End the CF1 measurement window if it's complete and switch SEL if it's time to.
+  void check_cf1_();
+
   bool current_mode_{false};
   uint32_t change_mode_at_{0};
-  uint32_t change_mode_every_{8};
+  uint32_t change_mode_every_{1};
+  /// Whether CF1 is still settling after SEL was switched at cf1_mode_start_.
+  bool cf1_settling_{true};
+  uint32_t cf1_mode_start_{0};
+  uint32_t cf1_window_start_{0};
+  int64_t cf1_window_start_total_{0};
+  /// Measurements of the last windows that haven't been published yet, NAN if there's none.
+  float voltage_{NAN};
+  float current_{NAN};
   float current_resistor_{0.001};
   float voltage_divider_{2351};
   GPIOPin *sel_pin_;
@@ -65,6 +90,9 @@ class HLW8012Component : public PollingComponent {
   HLW8012VoltageSensor *voltage_sensor_{nullptr};
   HLW8012CurrentSensor *current_sensor_{nullptr};
   HLW8012PowerSensor *power_sensor_{nullptr};
+#ifdef USE_TOTAL_DAILY_ENERGY_SENSOR
+  TotalDailyEnergy *total_daily_energy_{nullptr};
+#endif
 };
 
 }  // namespace sensor
@@ -89,6 +89,7 @@ void HMC5883LComponent::dump_config() {
   LOG_SENSOR("  ", "Heading", this->heading_sensor_);
 }
 float HMC5883LComponent::get_setup_priority() const { return setup_priority::HARDWARE_LATE; }
+uint32_t HMC5883LComponent::get_loop_idle_time() { return SCHEDULER_DONT_RUN; }
 void HMC5883LComponent::update() {
   uint16_t raw_x, raw_y, raw_z;
   if (!this->read_byte_16(HMC5883L_REGISTER_DATA_X_MSB, &raw_x) ||
@@ -34,6 +34,7 @@ class HMC5883LComponent : public PollingComponent, public I2CDevice {
   void dump_config() override;
   float get_setup_priority() const override;
   void update() override;
+  uint32_t get_loop_idle_time() override;
 
   HMC5883LFieldStrengthSensor *make_x_sensor(const std::string &name);
   HMC5883LFieldStrengthSensor *make_y_sensor(const std::string &name);
@@ -50,30 +50,32 @@ void HTU21DComponent::dump_config() {
   LOG_SENSOR("  ", "Humidity", this->humidity_);
 }
 void HTU21DComponent::update() {
-  uint16_t raw_temperature;
-  if (!this->read_byte_16(HTU21D_REGISTER_TEMPERATURE, &raw_temperature, 50)) {
-    this->status_set_warning();
-    return;
-  }
-
-  float temperature = (float(raw_temperature & 0xFFFC)) * 175.72f / 65536.0f - 46.85f;
-
-  uint16_t raw_humidity;
-  if (!this->read_byte_16(HTU21D_REGISTER_HUMIDITY, &raw_humidity, 50)) {
-    this->status_set_warning();
-    return;
-  }
-
-  float humidity = (float(raw_humidity & 0xFFFC)) * 125.0f / 65536.0f - 6.0f;
-  ESP_LOGD(TAG, "Got Temperature=%.1f°C Humidity=%.1f%%", temperature, humidity);
-
-  this->temperature_->publish_state(temperature);
-  this->humidity_->publish_state(humidity);
-  this->status_clear_warning();
+  // both conversions take up to 50ms, read them without blocking the loop
+  this->read_byte_16_async(HTU21D_REGISTER_TEMPERATURE, 50, [this](bool success, uint16_t raw_temperature) {
+    if (!success) {
+      this->status_set_warning();
+      return;
+    }
+    float temperature = (float(raw_temperature & 0xFFFC)) * 175.72f / 65536.0f - 46.85f;
+
+    this->read_byte_16_async(HTU21D_REGISTER_HUMIDITY, 50, [this, temperature](bool success, uint16_t raw_humidity) {
+      if (!success) {
+        this->status_set_warning();
+        return;
+      }
+      float humidity = (float(raw_humidity & 0xFFFC)) * 125.0f / 65536.0f - 6.0f;
+      ESP_LOGD(TAG, "Got Temperature=%.1f°C Humidity=%.1f%%", temperature, humidity);
+
+      this->temperature_->publish_state(temperature);
+      this->humidity_->publish_state(humidity);
+      this->status_clear_warning();
+    });
+  });
 }
 HTU21DTemperatureSensor *HTU21DComponent::get_temperature_sensor() const { return this->temperature_; }
 HTU21DHumiditySensor *HTU21DComponent::get_humidity_sensor() const { return this->humidity_; }
 float HTU21DComponent::get_setup_priority() const { return setup_priority::HARDWARE_LATE; }
+uint32_t HTU21DComponent::get_loop_idle_time() { return SCHEDULER_DONT_RUN; }
 
 }  // namespace sensor
 
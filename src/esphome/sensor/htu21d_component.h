@@ -34,6 +34,7 @@ class HTU21DComponent : public PollingComponent, public I2CDevice {
   void dump_config() override;
   /// Update the sensor values (temperature+humidity).
   void update() override;
+  uint32_t get_loop_idle_time() override;
 
   float get_setup_priority() const override;
 
@@ -11,13 +11,55 @@ namespace sensor {
 
 static const char *TAG = "sensor.hx711";
 
+void ICACHE_RAM_ATTR HOT HX711Store::gpio_intr(HX711Store *arg) {
+  // the interrupt also fires while the bits are clocked out, the sample is only ready while DOUT is low
+  if (arg->dout->digital_read())
+    return;
+
+  uint32_t data = 0;
+  for (uint8_t i = 0; i < 24; i++) {
+    arg->sck->digital_write(true);
+    delayMicroseconds(1);
+    data |= uint32_t(arg->dout->digital_read()) << (24 - i);
+    arg->sck->digital_write(false);
+    delayMicroseconds(1);
+  }
+
+  // Cycle clock pin for gain setting
+  for (uint8_t i = 0; i < arg->gain_pulses; i++) {
+    arg->sck->digital_write(true);
+    arg->sck->digital_write(false);
+  }
+
+  if (arg->skip != 0) {
+    arg->skip--;
+    return;
+  }
+
+  const uint8_t write_at = arg->write_at;
+  const uint8_t next = write_at + 1 == BUFFER_SIZE ? 0 : write_at + 1;
+  if (next == arg->read_at) {
+    arg->overflow_count++;
+    return;
+  }
+  arg->buffer[write_at] = data ^ 0x800000;
+  // publish the slot only after it's written
+  arg->write_at = next;
+}
+
 void HX711Sensor::setup() {
   ESP_LOGCONFIG(TAG, "Setting up HX711 '%s'...", this->name_.c_str());
   this->sck_pin_->setup();
   this->dout_pin_->setup();
-
-  // Read sensor once without publishing to set the gain
-  this->read_sensor_(nullptr);
+  this->sck_pin_->digital_write(false);
+
+  this->store_.gain_pulses = this->gain_;
+  this->store_.dout = this->dout_pin_->to_isr();
+  this->store_.sck = this->sck_pin_->to_isr();
+  // the first conversion still uses the default gain, 128
+  if (this->gain_ != HX711_GAIN_128)
+    this->store_.skip = 1;
+  this->dout_pin_->attach_interrupt(HX711Store::gpio_intr, &this->store_, FALLING);
 }
 
 void HX711Sensor::dump_config() {
@@ -27,47 +69,48 @@ void HX711Sensor::dump_config() {
   LOG_UPDATE_INTERVAL(this);
 }
 float HX711Sensor::get_setup_priority() const { return setup_priority::HARDWARE_LATE; }
-void HX711Sensor::update() {
-  uint32_t result;
-  if (this->read_sensor_(&result)) {
-    ESP_LOGD(TAG, "'%s': Got value %u", this->name_.c_str(), result);
-    this->publish_state(result);
+void HX711Sensor::loop() {
+  uint8_t read_at = this->store_.read_at;
+  const uint8_t write_at = this->store_.write_at;
+  while (read_at != write_at) {
+    this->sum_ += this->store_.buffer[read_at];
+    this->count_++;
+    read_at = read_at + 1 == HX711Store::BUFFER_SIZE ? 0 : read_at + 1;
   }
+  // release the slots only after they're read
+  this->store_.read_at = read_at;
+
+  const uint32_t overflow_count = this->store_.overflow_count;
+  if (overflow_count != this->last_overflow_count_) {
+    ESP_LOGW(TAG, "'%s': Dropped %u samples, the loop is too slow", this->name_.c_str(),
+             overflow_count - this->last_overflow_count_);
+    this->last_overflow_count_ = overflow_count;
+  }
+}
+uint32_t HX711Sensor::get_loop_idle_time() {
+  // the buffer holds 400ms of samples in the 80 SPS mode
+  return 100;
 }
-bool HX711Sensor::read_sensor_(uint32_t *result) {
-  if (this->dout_pin_->digital_read()) {
-    ESP_LOGW(TAG, "HX711 is not ready for new measurements yet!");
+void HX711Sensor::update() {
+  this->loop();
+  if (this->count_ == 0) {
+    ESP_LOGW(TAG, "HX711 hasn't finished any measurements since the last update!");
     this->status_set_warning();
-    return false;
+    return;
   }
 
   this->status_clear_warning();
-  uint32_t data = 0;
-
-  for (uint8_t i = 0; i < 24; i++) {
-    this->sck_pin_->digital_write(true);
-    delayMicroseconds(1);
-    data |= uint32_t(this->dout_pin_->digital_read()) << (24 - i);
-    this->sck_pin_->digital_write(false);
-    delayMicroseconds(1);
-  }
-
-  // Cycle clock pin for gain setting
-  for (uint8_t i = 0; i < this->gain_; i++) {
-    this->sck_pin_->digital_write(true);
-    this->sck_pin_->digital_write(false);
-  }
-
-  data ^= 0x800000;
-  if (result != nullptr)
-    *result = data;
-  return true;
+  float value = float(this->sum_) / this->count_;
+  ESP_LOGD(TAG, "'%s': Got value %.1f from %u samples", this->name_.c_str(), value, this->count_);
+  this->sum_ = 0;
+  this->count_ = 0;
+  this->publish_state(value);
 }
-std::string HX711Sensor::unit_of_measurement() {
+const char *HX711Sensor::unit_of_measurement() {
   // datasheet gives no unit
   return "";
 }
-std::string HX711Sensor::icon() { return "mdi:scale"; }
+const char *HX711Sensor::icon() { return "mdi:scale"; }
 int8_t HX711Sensor::accuracy_decimals() { return 0; }
 HX711Sensor::HX711Sensor(const std::string &name, GPIOPin *dout, GPIOPin *sck, uint32_t update_interval)
     : PollingSensorComponent(name, update_interval), dout_pin_(dout), sck_pin_(sck) {}
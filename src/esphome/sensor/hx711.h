@@ -17,6 +17,34 @@ enum HX711Gain {
   HX711_GAIN_64 = 3,
 };
 
+/** Samples of the HX711, read by the DOUT interrupt into a single-producer single-consumer ring buffer.
+ *
+ * The interrupt only writes slots up to the one before read_at, loop() advances read_at after reading them.
+ */
+struct HX711Store {
+  static void gpio_intr(HX711Store *arg);
+
+  static const uint8_t BUFFER_SIZE = 32;
+  volatile uint32_t buffer[BUFFER_SIZE];
+  /// The next slot to write, only written by the interrupt
+  volatile uint8_t write_at{0};
+  /// The next slot to read, only written by loop()
+  volatile uint8_t read_at{0};
+  /// Samples dropped because the buffer was full
+  volatile uint32_t overflow_count{0};
+  /// Samples to drop, for example the first one read before the gain was set
+  volatile uint8_t skip{0};
+  uint8_t gain_pulses;
+  ISRInternalGPIOPin *dout;
+  ISRInternalGPIOPin *sck;
+};
+
+/** HX711 load cell amplifier.
+ *
+ * Every conversion is read by an interrupt on the falling edge of DOUT, so the main loop never waits for
+ * the sensor. loop() collects the samples and each update publishes the average of all samples since the
+ * last one, for example about 80 samples per second for the 80 SPS mode.
+ */
 class HX711Sensor : public PollingSensorComponent {
  public:
   HX711Sensor(const std::string &name, GPIOPin *dout, GPIOPin *sck, uint32_t update_interval = 60000);
@@ -24,20 +52,27 @@ class HX711Sensor : public PollingSensorComponent {
   void setup() override;
   void dump_config() override;
   float get_setup_priority() const override;
+  /// Collect the samples read by the interrupt.
+  void loop() override;
+  /// Short enough that the idle mode doesn't let the sample buffer fill up.
+  uint32_t get_loop_idle_time() override;
   void update() override;
 
   void set_gain(HX711Gain gain);
 
-  std::string unit_of_measurement() override;
-  std::string icon() override;
+  const char *unit_of_measurement() override;
+  const char *icon() override;
   int8_t accuracy_decimals() override;
 
  protected:
-  bool read_sensor_(uint32_t *result);
-
   GPIOPin *dout_pin_;
   GPIOPin *sck_pin_;
   HX711Gain gain_{HX711_GAIN_128};
+  HX711Store store_;
+  /// The samples since the last update.
+  uint64_t sum_{0};
+  uint32_t count_{0};
+  uint32_t last_overflow_count_{0};
 };
 
 }  // namespace sensor
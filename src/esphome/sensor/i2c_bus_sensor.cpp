@@ -0,0 +1,49 @@
+#include "esphome/defines.h"
+
+#ifdef USE_I2C_BUS_SENSOR
+
+#include "esphome/sensor/i2c_bus_sensor.h"
+#include "esphome/log.h"
+
+ESPHOME_NAMESPACE_BEGIN
+
+namespace sensor {
+
+static const char *TAG = "sensor.i2c_bus";
+
+I2CBusSensor::I2CBusSensor(const std::string &name, I2CComponent *parent, uint32_t update_interval)
+    : PollingSensorComponent(name, update_interval), parent_(parent) {}
+void I2CBusSensor::setup() {
+  this->last_bus_us_ = this->parent_->get_total_bus_us();
+  this->last_time_ = micros();
+}
+void I2CBusSensor::update() {
+  const uint64_t bus_us = this->parent_->get_total_bus_us();
+  const uint32_t now = micros();
+  // micros() overflows every ~71 minutes, the difference is still correct as long as the update interval is shorter
+  const uint32_t elapsed = now - this->last_time_;
+  // the counters may have been reset in the meantime
+  const uint64_t busy = bus_us >= this->last_bus_us_ ? bus_us - this->last_bus_us_ : bus_us;
+  this->last_bus_us_ = bus_us;
+  this->last_time_ = now;
+  if (elapsed == 0)
+    return;
+
+  for (auto &stats : this->parent_->get_device_stats()) {
+    ESP_LOGV(TAG, "0x%02X: transactions=%u errors=%u bus_time=%ums", stats.address, stats.transactions, stats.errors,
+             uint32_t(stats.bus_us / 1000));
+  }
+  this->publish_state(std::min(100.0f, busy * 100.0f / elapsed));
+}
+void I2CBusSensor::dump_config() { LOG_SENSOR("", "I2C Bus Utilization", this); }
+const char *I2CBusSensor::unit_of_measurement() { return UNIT_PERCENT; }
+const char *I2CBusSensor::icon() { return ICON_GAUGE; }
+int8_t I2CBusSensor::accuracy_decimals() { return 1; }
+float I2CBusSensor::get_setup_priority() const { return setup_priority::HARDWARE_LATE; }
+uint32_t I2CBusSensor::get_loop_idle_time() { return SCHEDULER_DONT_RUN; }
+
+}  // namespace sensor
+
+ESPHOME_NAMESPACE_END
+
+#endif  // USE_I2C_BUS_SENSOR
@@ -0,0 +1,42 @@
+#ifndef ESPHOME_SENSOR_I2C_BUS_SENSOR_H
+#define ESPHOME_SENSOR_I2C_BUS_SENSOR_H
+
+#include "esphome/defines.h"
+
+#ifdef USE_I2C_BUS_SENSOR
+
+#include "esphome/sensor/sensor.h"
+#include "esphome/i2c_component.h"
+
+ESPHOME_NAMESPACE_BEGIN
+
+namespace sensor {
+
+/// Debug sensor reporting the utilization of an i2c bus (the share of time it was busy) in percent.
+class I2CBusSensor : public PollingSensorComponent {
+ public:
+  I2CBusSensor(const std::string &name, I2CComponent *parent, uint32_t update_interval = 60000);
+
+  void setup() override;
+  void update() override;
+  uint32_t get_loop_idle_time() override;
+  void dump_config() override;
+
+  const char *unit_of_measurement() override;
+  const char *icon() override;
+  int8_t accuracy_decimals() override;
+  float get_setup_priority() const override;
+
+ protected:
+  I2CComponent *parent_;
+  uint64_t last_bus_us_{0};
+  uint32_t last_time_{0};
+};
+
+}  // namespace sensor
+
+ESPHOME_NAMESPACE_END
+
+#endif  // USE_I2C_BUS_SENSOR
+
+#endif  // ESPHOME_SENSOR_I2C_BUS_SENSOR_H
@@ -37,6 +37,8 @@ static const uint8_t INA219_REGISTER_BUS_VOLTAGE = 0x02;
 static const uint8_t INA219_REGISTER_POWER = 0x03;
 static const uint8_t INA219_REGISTER_CURRENT = 0x04;
 static const uint8_t INA219_REGISTER_CALIBRATION = 0x05;
+/// How often to poll the conversion ready flag after the expected conversion time.
+static const uint8_t INA219_MAX_READY_ATTEMPTS = 10;
 
 void INA219Component::setup() {
   ESP_LOGCONFIG(TAG, "Setting up INA219...");
@@ -65,15 +67,25 @@ void INA219Component::setup() {
   // 0b1110 -> 12 bit, 64 samples, 34.05 ms
   // 0b1111 -> 12 bit, 128 samples, 68.10 ms <--
 
-  // 0b0000000000000xxx << 0 Mode (Bus and Shunt continuous -> 0b111)
+  // 0b0000000000000xxx << 0 Mode (Bus and Shunt triggered -> 0b011)
+
+  uint8_t adc = 0b0011;
+  uint32_t adc_time_us = 532;
+  if (this->samples_ > 1) {
+    // 2^n samples -> 0b1000 | n, each doubling the conversion time
+    uint8_t n = 1;
+    while (n < 7 && (1u << n) < this->samples_)
+      n++;
+    adc = 0b1000 | n;
+    adc_time_us = 532u << n;
+  }
+  this->conversion_time_ = (2 * adc_time_us + 999) / 1000;
 
-  // Bus ADC and Shunt ADC 12 bit+128 samples
   uint16_t config = 0x0000;
-  // Continuous operation of Bus and Shunt ADCs
-  config |= 0b0000000000000111;
-  // Bus ADC and Shunt ADC 12 bit+128 samples -> 68.10 ms
-  config |= 0b0000011110000000;
-  config |= 0b0000000001111000;
+  // Triggered operation of Bus and Shunt ADCs, each update starts a conversion
+  config |= 0b0000000000000011;
+  config |= adc << 7;
+  config |= adc << 3;
   const float shunt_max_voltage = this->shunt_resistance_ohm_ * this->max_current_a_;
 
   // 0b00x0000000000000 << 13 Bus Voltage Range (0 -> 16V, 1 -> 32V)
@@ -111,6 +123,7 @@ void INA219Component::setup() {
     this->mark_failed();
     return;
   }
+  this->config_ = config;
 
   auto min_lsb = uint32_t(ceilf(this->max_current_a_ * 1000000.0f / 0x8000));
   auto max_lsb = uint32_t(floorf(this->max_current_a_ * 1000000.0f / 0x1000));
@@ -144,6 +157,7 @@ void INA219Component::dump_config() {
     return;
   }
   LOG_UPDATE_INTERVAL(this);
+  ESP_LOGCONFIG(TAG, "  Samples: %u (%u ms)", this->samples_, this->conversion_time_);
 
   LOG_SENSOR("  ", "Bus Voltage", this->bus_voltage_sensor_);
   LOG_SENSOR("  ", "Shunt Voltage", this->shunt_voltage_sensor_);
@@ -152,49 +166,79 @@ void INA219Component::dump_config() {
 }
 
 float INA219Component::get_setup_priority() const { return setup_priority::HARDWARE_LATE; }
+uint32_t INA219Component::get_loop_idle_time() { return SCHEDULER_DONT_RUN; }
 
 void INA219Component::update() {
-  if (this->bus_voltage_sensor_ != nullptr) {
-    uint16_t raw_bus_voltage;
-    if (!this->read_byte_16(INA219_REGISTER_BUS_VOLTAGE, &raw_bus_voltage, 1)) {
+  if (this->converting_) {
+    ESP_LOGW(TAG, "Conversion still in progress, consider fewer samples or a longer update interval.");
+    return;
+  }
+  // writing the configuration triggers a conversion
+  if (!this->write_byte_16(INA219_REGISTER_CONFIG, this->config_)) {
+    this->status_set_warning();
+    return;
+  }
+  this->converting_ = true;
+  this->read_conversion_(this->conversion_time_, 0);
+}
+void INA219Component::read_conversion_(uint32_t delay, uint8_t attempt) {
+  this->read_byte_16_async(INA219_REGISTER_BUS_VOLTAGE, delay, [this, attempt](bool success, uint16_t raw_bus_voltage) {
+    if (!success) {
+      this->converting_ = false;
       this->status_set_warning();
       return;
     }
-    raw_bus_voltage >>= 3;
-    float bus_voltage_v = int16_t(raw_bus_voltage) * 0.004f;
-    this->bus_voltage_sensor_->publish_state(bus_voltage_v);
-  }
+    // 0b00000000000000x0 << 1 Conversion Ready
+    if ((raw_bus_voltage & 0b10) == 0) {
+      if (attempt + 1 >= INA219_MAX_READY_ATTEMPTS) {
+        ESP_LOGW(TAG, "Conversion didn't complete!");
+        this->converting_ = false;
+        this->status_set_warning();
+        return;
+      }
+      this->read_conversion_(1, attempt + 1);
+      return;
+    }
+    this->converting_ = false;
 
-  if (this->shunt_voltage_sensor_ != nullptr) {
-    uint16_t raw_shunt_voltage;
-    if (!this->read_byte_16(INA219_REGISTER_SHUNT_VOLTAGE, &raw_shunt_voltage, 1)) {
-      this->status_set_warning();
+    if (this->bus_voltage_sensor_ != nullptr) {
+      raw_bus_voltage >>= 3;
+      float bus_voltage_v = int16_t(raw_bus_voltage) * 0.004f;
+      this->bus_voltage_sensor_->publish_state(bus_voltage_v);
     }
-    float shunt_voltage_mv = int16_t(raw_shunt_voltage) * 0.01f;
-    this->shunt_voltage_sensor_->publish_state(shunt_voltage_mv / 1000.0f);
-  }
 
-  if (this->current_sensor_ != nullptr) {
-    uint16_t raw_current;
-    if (!this->read_byte_16(INA219_REGISTER_CURRENT, &raw_current, 1)) {
-      this->status_set_warning();
-      return;
+    if (this->shunt_voltage_sensor_ != nullptr) {
+      uint16_t raw_shunt_voltage;
+      if (!this->read_byte_16(INA219_REGISTER_SHUNT_VOLTAGE, &raw_shunt_voltage)) {
+        this->status_set_warning();
+        return;
+      }
+      float shunt_voltage_mv = int16_t(raw_shunt_voltage) * 0.01f;
+      this->shunt_voltage_sensor_->publish_state(shunt_voltage_mv / 1000.0f);
     }
-    float current_ma = int16_t(raw_current) * (this->calibration_lsb_ / 1000.0f);
-    this->current_sensor_->publish_state(current_ma / 1000.0f);
-  }
 
-  if (this->power_sensor_ != nullptr) {
-    uint16_t raw_power;
-    if (!this->read_byte_16(INA219_REGISTER_POWER, &raw_power, 1)) {
-      this->status_set_warning();
-      return;
+    if (this->current_sensor_ != nullptr) {
+      uint16_t raw_current;
+      if (!this->read_byte_16(INA219_REGISTER_CURRENT, &raw_current)) {
+        this->status_set_warning();
+        return;
+      }
+      float current_ma = int16_t(raw_current) * (this->calibration_lsb_ / 1000.0f);
+      this->current_sensor_->publish_state(current_ma / 1000.0f);
+    }
+
+    if (this->power_sensor_ != nullptr) {
+      uint16_t raw_power;
+      if (!this->read_byte_16(INA219_REGISTER_POWER, &raw_power)) {
+        this->status_set_warning();
+        return;
+      }
+      float power_mw = int16_t(raw_power) * (this->calibration_lsb_ * 20.0f / 1000.0f);
+      this->power_sensor_->publish_state(power_mw / 1000.0f);
     }
-    float power_mw = int16_t(raw_power) * (this->calibration_lsb_ * 20.0f / 1000.0f);
-    this->power_sensor_->publish_state(power_mw / 1000.0f);
-  }
 
-  this->status_clear_warning();
+    this->status_clear_warning();
+  });
 }
 INA219Component::INA219Component(I2CComponent *parent, float shunt_resistance_ohm, float max_current_a,
                                  float max_voltage_v, uint8_t address, uint32_t update_interval)
@@ -215,6 +259,7 @@ INA219CurrentSensor *INA219Component::make_current_sensor(const std::string &nam
 INA219PowerSensor *INA219Component::make_power_sensor(const std::string &name) {
   return this->power_sensor_ = new INA219PowerSensor(name, this);
 }
+void INA219Component::set_samples(uint8_t samples) { this->samples_ = samples; }
 
 }  // namespace sensor
 
@@ -25,17 +25,34 @@ class INA219Component : public PollingComponent, public I2CDevice {
   void dump_config() override;
   float get_setup_priority() const override;
   void update() override;
+  uint32_t get_loop_idle_time() override;
 
   INA219VoltageSensor *make_bus_voltage_sensor(const std::string &name);
   INA219VoltageSensor *make_shunt_voltage_sensor(const std::string &name);
   INA219CurrentSensor *make_current_sensor(const std::string &name);
   INA219PowerSensor *make_power_sensor(const std::string &name);
 
+  /** Set the number of samples the INA219 averages for each reading, 1 to 128 in powers of two.
+   *
+   * Defaults to 128 samples, a conversion of 136ms. Each update triggers one conversion and reads the result
+   * once it's ready, without blocking the loop.
+   */
+  void set_samples(uint8_t samples);
+
  protected:
+  /// Read the result once the conversion ready flag is set, retrying every ms.
+  void read_conversion_(uint32_t delay, uint8_t attempt);
+
   float shunt_resistance_ohm_;
   float max_current_a_;
   float max_voltage_v_;
   uint32_t calibration_lsb_;
+  uint8_t samples_{128};
+  /// The configuration register, writing it starts a conversion.
+  uint16_t config_{0};
+  /// The time of a conversion of both ADCs in ms.
+  uint32_t conversion_time_{0};
+  bool converting_{false};
   INA219VoltageSensor *bus_voltage_sensor_{nullptr};
   INA219VoltageSensor *shunt_voltage_sensor_{nullptr};
   INA219CurrentSensor *current_sensor_{nullptr};
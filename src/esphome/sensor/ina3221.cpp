@@ -18,6 +18,11 @@ static const uint8_t INA3221_REGISTER_CHANNEL2_SHUNT_VOLTAGE = 0x03;
 static const uint8_t INA3221_REGISTER_CHANNEL2_BUS_VOLTAGE = 0x04;
 static const uint8_t INA3221_REGISTER_CHANNEL3_SHUNT_VOLTAGE = 0x05;
 static const uint8_t INA3221_REGISTER_CHANNEL3_BUS_VOLTAGE = 0x06;
+static const uint8_t INA3221_REGISTER_MASK_ENABLE = 0x0F;
+/// How often to poll the conversion ready flag after the expected conversion time.
+static const uint8_t INA3221_MAX_READY_ATTEMPTS = 10;
+static const uint16_t INA3221_AVERAGING[] = {1, 4, 16, 64, 128, 256, 512, 1024};
+static const uint16_t INA3221_CONVERSION_TIMES[] = {140, 204, 332, 588, 1100, 2116, 4156, 8244};
 
 // Addresses:
 // A0 = GND -> 0x40
@@ -36,28 +41,43 @@ void INA3221Component::setup() {
   delay(1);
 
   uint16_t config = 0;
+  uint8_t channels = 0;
   // 0b0xxx000000000000 << 12 Channel Enables (1 -> ON)
   if (this->channels_[0].exists()) {
     config |= 0b0100000000000000;
+    channels++;
   }
   if (this->channels_[1].exists()) {
     config |= 0b0010000000000000;
+    channels++;
   }
   if (this->channels_[2].exists()) {
     config |= 0b0001000000000000;
+    channels++;
   }
   // 0b0000xxx000000000 << 9 Averaging Mode (0 -> 1 sample, 111 -> 1024 samples)
-  config |= 0b0000111000000000;
+  uint8_t averaging = 0;
+  while (averaging < 7 && INA3221_AVERAGING[averaging] < this->averaging_)
+    averaging++;
+  config |= averaging << 9;
   // 0b0000000xxx000000 << 6 Bus Voltage Conversion time (100 -> 1.1ms, 111 -> 8.244 ms)
-  config |= 0b0000000111000000;
+  uint8_t conversion = 0;
+  while (conversion < 7 && INA3221_CONVERSION_TIMES[conversion] < this->conversion_time_us_)
+    conversion++;
+  config |= conversion << 6;
   // 0b0000000000xxx000 << 3 Shunt Voltage Conversion time (same as above)
-  config |= 0b0000000000111000;
-  // 0b0000000000000xxx << 0 Operating mode (111 -> Shunt and bus, continuous)
-  config |= 0b0000000000000111;
+  config |= conversion << 3;
+  // 0b0000000000000xxx << 0 Operating mode (011 -> Shunt and bus, triggered)
+  config |= 0b0000000000000011;
+  this->averaging_ = INA3221_AVERAGING[averaging];
+  this->conversion_time_us_ = INA3221_CONVERSION_TIMES[conversion];
+  const uint32_t conversion_time_us = uint32_t(this->averaging_) * this->conversion_time_us_ * 2 * channels;
+  this->conversion_time_ = (conversion_time_us + 999) / 1000;
   if (!this->write_byte_16(INA3221_REGISTER_CONFIG, config)) {
     this->mark_failed();
     return;
   }
+  this->config_ = config;
 }
 
 void INA3221Component::dump_config() {
@@ -67,6 +87,8 @@ void INA3221Component::dump_config() {
     ESP_LOGE(TAG, "Communication with INA3221 failed!");
   }
   LOG_UPDATE_INTERVAL(this);
+  ESP_LOGCONFIG(TAG, "  Averaging: %u samples of %u µs (%u ms)", this->averaging_, this->conversion_time_us_,
+                this->conversion_time_);
 
   LOG_SENSOR("  ", "Bus Voltage #1", this->channels_[0].bus_voltage_sensor_);
   LOG_SENSOR("  ", "Shunt Voltage #1", this->channels_[0].shunt_voltage_sensor_);
@@ -87,41 +109,80 @@ inline uint8_t ina3221_bus_voltage_register(int channel) { return 0x02 + channel
 inline uint8_t ina3221_shunt_voltage_register(int channel) { return 0x01 + channel * 2; }
 
 void INA3221Component::update() {
-  for (int i = 0; i < 3; i++) {
-    INA3221Channel &channel = this->channels_[i];
-    float bus_voltage_v = NAN, current_a = NAN;
-    uint16_t raw;
-    if (channel.should_measure_bus_voltage()) {
-      if (!this->read_byte_16(ina3221_bus_voltage_register(i), &raw, 1)) {
-        this->status_set_warning();
-        return;
-      }
-      bus_voltage_v = int16_t(raw) / 1000.0f;
-      if (channel.bus_voltage_sensor_ != nullptr)
-        channel.bus_voltage_sensor_->publish_state(bus_voltage_v);
+  if (this->converting_) {
+    ESP_LOGW(TAG, "Conversion still in progress, consider less averaging or a longer update interval.");
+    return;
+  }
+  // writing the configuration triggers a conversion
+  if (!this->write_byte_16(INA3221_REGISTER_CONFIG, this->config_)) {
+    this->status_set_warning();
+    return;
+  }
+  this->converting_ = true;
+  this->read_conversion_(this->conversion_time_, 0);
+}
+void INA3221Component::read_conversion_(uint32_t delay, uint8_t attempt) {
+  this->read_byte_16_async(INA3221_REGISTER_MASK_ENABLE, delay, [this, attempt](bool success, uint16_t mask_enable) {
+    if (!success) {
+      this->converting_ = false;
+      this->status_set_warning();
+      return;
     }
-    if (channel.should_measure_shunt_voltage()) {
-      if (!this->read_byte_16(ina3221_shunt_voltage_register(i), &raw, 1)) {
+    // 0b000000000000000x << 0 Conversion Ready Flag, cleared by this read
+    if ((mask_enable & 0b1) == 0) {
+      if (attempt + 1 >= INA3221_MAX_READY_ATTEMPTS) {
+        ESP_LOGW(TAG, "Conversion didn't complete!");
+        this->converting_ = false;
         this->status_set_warning();
         return;
       }
-      const float shunt_voltage_v = int16_t(raw) * 40.0f / 1000000.0f;
-      if (channel.shunt_voltage_sensor_ != nullptr)
-        channel.shunt_voltage_sensor_->publish_state(shunt_voltage_v);
-      current_a = shunt_voltage_v / channel.shunt_resistance_;
-      if (channel.current_sensor_ != nullptr)
-        channel.current_sensor_->publish_state(current_a);
+      this->read_conversion_(1, attempt + 1);
+      return;
     }
-    if (channel.power_sensor_ != nullptr) {
-      channel.power_sensor_->publish_state(bus_voltage_v * current_a);
+    this->converting_ = false;
+
+    for (int i = 0; i < 3; i++) {
+      INA3221Channel &channel = this->channels_[i];
+      float bus_voltage_v = NAN, current_a = NAN;
+      uint16_t raw;
+      if (channel.should_measure_bus_voltage()) {
+        if (!this->read_byte_16(ina3221_bus_voltage_register(i), &raw)) {
+          this->status_set_warning();
+          return;
+        }
+        bus_voltage_v = int16_t(raw) / 1000.0f;
+        if (channel.bus_voltage_sensor_ != nullptr)
+          channel.bus_voltage_sensor_->publish_state(bus_voltage_v);
+      }
+      if (channel.should_measure_shunt_voltage()) {
+        if (!this->read_byte_16(ina3221_shunt_voltage_register(i), &raw)) {
+          this->status_set_warning();
+          return;
+        }
+        const float shunt_voltage_v = int16_t(raw) * 40.0f / 1000000.0f;
+        if (channel.shunt_voltage_sensor_ != nullptr)
+          channel.shunt_voltage_sensor_->publish_state(shunt_voltage_v);
+        current_a = shunt_voltage_v / channel.shunt_resistance_;
+        if (channel.current_sensor_ != nullptr)
+          channel.current_sensor_->publish_state(current_a);
+      }
+      if (channel.power_sensor_ != nullptr) {
+        channel.power_sensor_->publish_state(bus_voltage_v * current_a);
+      }
     }
-  }
+    this->status_clear_warning();
+  });
 }
 
 float INA3221Component::get_setup_priority() const { return setup_priority::HARDWARE_LATE; }
+uint32_t INA3221Component::get_loop_idle_time() { return SCHEDULER_DONT_RUN; }
 void INA3221Component::set_shunt_resistance(int channel, float resistance_ohm) {
   this->channels_[channel].shunt_resistance_ = resistance_ohm;
 }
+void INA3221Component::set_averaging(uint16_t samples) { this->averaging_ = samples; }
+void INA3221Component::set_conversion_time(uint32_t conversion_time_us) {
+  this->conversion_time_us_ = conversion_time_us;
+}
 INA3221PowerSensor *INA3221Component::make_power_sensor(int channel, const std::string &name) {
   return this->channels_[channel].power_sensor_ = new INA3221PowerSensor(name, this);
 }
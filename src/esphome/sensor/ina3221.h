@@ -22,6 +22,7 @@ class INA3221Component : public PollingComponent, public I2CDevice {
   void setup() override;
   void dump_config() override;
   void update() override;
+  uint32_t get_loop_idle_time() override;
   float get_setup_priority() const override;
 
   INA3221VoltageSensor *make_bus_voltage_sensor(int channel, const std::string &name);
@@ -29,8 +30,19 @@ class INA3221Component : public PollingComponent, public I2CDevice {
   INA3221CurrentSensor *make_current_sensor(int channel, const std::string &name);
   INA3221PowerSensor *make_power_sensor(int channel, const std::string &name);
   void set_shunt_resistance(int channel, float resistance_ohm);
+  /// Set the number of samples averaged for each reading: 1, 4, 16, 64, 128, 256, 512 or 1024 (default).
+  void set_averaging(uint16_t samples);
+  /** Set the conversion time of each sample in µs: 140, 204, 332, 588, 1100, 2116, 4156 or 8244 (default).
+   *
+   * Each update triggers one conversion of all channels, which takes samples * 2 * conversion time per channel,
+   * and reads the results once the conversion ready flag is set without blocking the loop.
+   */
+  void set_conversion_time(uint32_t conversion_time_us);
 
  protected:
+  /// Read the results once the conversion ready flag is set, retrying every ms.
+  void read_conversion_(uint32_t delay, uint8_t attempt);
+
   struct INA3221Channel {
     float shunt_resistance_{0.1f};
     INA3221VoltageSensor *bus_voltage_sensor_{nullptr};
@@ -42,6 +54,13 @@ class INA3221Component : public PollingComponent, public I2CDevice {
     bool should_measure_shunt_voltage();
     bool should_measure_bus_voltage();
   } channels_[3];
+  uint16_t averaging_{1024};
+  uint32_t conversion_time_us_{8244};
+  /// The configuration register, writing it starts a conversion.
+  uint16_t config_{0};
+  /// The time of a conversion of all channels in ms.
+  uint32_t conversion_time_{0};
+  bool converting_{false};
 };
 
 }  // namespace sensor
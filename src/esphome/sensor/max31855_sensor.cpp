@@ -35,8 +35,9 @@ void MAX31855Sensor::dump_config() {
   LOG_UPDATE_INTERVAL(this);
 }
 float MAX31855Sensor::get_setup_priority() const { return setup_priority::HARDWARE_LATE; }
-std::string MAX31855Sensor::unit_of_measurement() { return UNIT_C; }
-std::string MAX31855Sensor::icon() { return ICON_EMPTY; }
+uint32_t MAX31855Sensor::get_loop_idle_time() { return SCHEDULER_DONT_RUN; }
+const char *MAX31855Sensor::unit_of_measurement() { return UNIT_C; }
+const char *MAX31855Sensor::icon() { return ICON_EMPTY; }
 int8_t MAX31855Sensor::accuracy_decimals() { return 1; }
 void MAX31855Sensor::read_data_() {
   this->enable();
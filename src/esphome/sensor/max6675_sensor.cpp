@@ -34,8 +34,9 @@ void MAX6675Sensor::dump_config() {
   LOG_UPDATE_INTERVAL(this);
 }
 float MAX6675Sensor::get_setup_priority() const { return setup_priority::HARDWARE_LATE; }
-std::string MAX6675Sensor::unit_of_measurement() { return UNIT_C; }
-std::string MAX6675Sensor::icon() { return ICON_EMPTY; }
+uint32_t MAX6675Sensor::get_loop_idle_time() { return SCHEDULER_DONT_RUN; }
+const char *MAX6675Sensor::unit_of_measurement() { return UNIT_C; }
+const char *MAX6675Sensor::icon() { return ICON_EMPTY; }
 int8_t MAX6675Sensor::accuracy_decimals() { return 1; }
 void MAX6675Sensor::read_data_() {
   this->enable();
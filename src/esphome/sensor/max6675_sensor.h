@@ -21,9 +21,10 @@ class MAX6675Sensor : public PollingSensorComponent, public SPIDevice {
   float get_setup_priority() const override;
 
   void update() override;
+  uint32_t get_loop_idle_time() override;
 
-  std::string unit_of_measurement() override;
-  std::string icon() override;
+  const char *unit_of_measurement() override;
+  const char *icon() override;
   int8_t accuracy_decimals() override;
 
  protected:
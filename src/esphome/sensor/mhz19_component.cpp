@@ -25,6 +25,12 @@ uint8_t mhz19_checksum(const uint8_t *command) {
 }
 
 void MHZ19Component::update() {
+  if (this->duty_cycle_ != nullptr)
+    // the duty cycle takes the readings
+    return;
+  this->read_();
+}
+void MHZ19Component::read_() {
   uint8_t response[MHZ19_RESPONSE_LENGTH];
   if (!this->mhz19_write_command_(MHZ19_COMMAND_GET_PPM, response)) {
     ESP_LOGW(TAG, "Reading data from MHZ19 failed!");
@@ -51,10 +57,20 @@ void MHZ19Component::update() {
   const uint8_t status = response[5];
 
   ESP_LOGD(TAG, "MHZ19 Received CO₂=%uppm Temperature=%d°C Status=0x%02X", ppm, temp, status);
+  if (this->duty_cycle_ != nullptr) {
+    this->duty_cycle_->add_value(this->co2_sensor_, ppm);
+    this->duty_cycle_->add_value(this->temperature_sensor_, temp);
+    this->duty_cycle_->add_sample();
+    return;
+  }
   this->co2_sensor_->publish_state(ppm);
   if (this->temperature_sensor_ != nullptr)
     this->temperature_sensor_->publish_state(temp);
 }
+void MHZ19Component::set_duty_cycle(SensorDutyCycle *duty_cycle) {
+  this->duty_cycle_ = duty_cycle;
+  duty_cycle->set_sample_function([this]() { this->read_(); }, 1000);
+}
 
 bool MHZ19Component::mhz19_write_command_(const uint8_t *command, uint8_t *response) {
   this->flush();
@@ -73,8 +89,10 @@ MHZ19TemperatureSensor *MHZ19Component::make_temperature_sensor(const std::strin
 }
 MHZ19CO2Sensor *MHZ19Component::get_co2_sensor() const { return this->co2_sensor_; }
 float MHZ19Component::get_setup_priority() const { return setup_priority::HARDWARE_LATE; }
+uint32_t MHZ19Component::get_loop_idle_time() { return SCHEDULER_DONT_RUN; }
 void MHZ19Component::dump_config() {
   ESP_LOGCONFIG(TAG, "MH-Z19:");
+  ESP_LOGCONFIG(TAG, "  Duty Cycle: %s", YESNO(this->duty_cycle_ != nullptr));
   LOG_SENSOR("  ", "CO2", this->co2_sensor_);
   LOG_SENSOR("  ", "Temperature", this->temperature_sensor_);
 }
@@ -8,6 +8,7 @@
 #include "esphome/component.h"
 #include "esphome/uart_component.h"
 #include "esphome/sensor/sensor.h"
+#include "esphome/sensor/sensor_duty_cycle.h"
 
 ESPHOME_NAMESPACE_BEGIN
 
@@ -23,16 +24,26 @@ class MHZ19Component : public PollingComponent, public UARTDevice {
   float get_setup_priority() const override;
 
   void update() override;
+  uint32_t get_loop_idle_time() override;
   void dump_config() override;
 
   MHZ19TemperatureSensor *make_temperature_sensor(const std::string &name);
   MHZ19CO2Sensor *get_co2_sensor() const;
 
+  /** Only take readings every update interval of the duty cycle, instead of every update interval of this component.
+   *
+   * The MH-Z19 has no sleep command, so set a power supply on the duty cycle that switches the sensor, and a warm
+   * up time of at least 3 minutes. The readings are taken every second while collecting.
+   */
+  void set_duty_cycle(SensorDutyCycle *duty_cycle);
+
  protected:
   bool mhz19_write_command_(const uint8_t *command, uint8_t *response);
+  void read_();
 
   MHZ19TemperatureSensor *temperature_sensor_{nullptr};
   MHZ19CO2Sensor *co2_sensor_;
+  SensorDutyCycle *duty_cycle_{nullptr};
 };
 
 }  // namespace sensor
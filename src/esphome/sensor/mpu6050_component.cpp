@@ -7,6 +7,8 @@
 
 #ifdef USE_MPU6050
 
+#include <algorithm>
+#include <cmath>
 #include "esphome/sensor/mpu6050_component.h"
 #include "esphome/log.h"
 
@@ -21,6 +23,24 @@ const uint8_t MPU6050_REGISTER_POWER_MANAGEMENT_1 = 0x6B;
 const uint8_t MPU6050_REGISTER_GYRO_CONFIG = 0x1B;
 const uint8_t MPU6050_REGISTER_ACCEL_CONFIG = 0x1C;
 const uint8_t MPU6050_REGISTER_ACCEL_XOUT_H = 0x3B;
+const uint8_t MPU6050_REGISTER_TEMP_OUT_H = 0x41;
+const uint8_t MPU6050_REGISTER_SMPLRT_DIV = 0x19;
+const uint8_t MPU6050_REGISTER_CONFIG = 0x1A;
+const uint8_t MPU6050_REGISTER_FIFO_EN = 0x23;
+const uint8_t MPU6050_REGISTER_USER_CTRL = 0x6A;
+const uint8_t MPU6050_REGISTER_FIFO_COUNT_H = 0x72;
+const uint8_t MPU6050_REGISTER_FIFO_R_W = 0x74;
+/// FIFO_EN: accelerometer and all gyro axes.
+const uint8_t MPU6050_FIFO_EN_ACCEL_GYRO = 0b01111000;
+const uint8_t MPU6050_USER_CTRL_FIFO_EN = 1 << 6;
+const uint8_t MPU6050_USER_CTRL_FIFO_RESET = 1 << 2;
+/// DLPF 188Hz, sets the gyro output rate (the base of the sample rate divider) to 1kHz.
+const uint8_t MPU6050_DLPF_188_HZ = 0b001;
+const uint16_t MPU6050_FIFO_SIZE = 1024;
+/// Bytes per FIFO sample: 3 accel and 3 gyro 16-bit values.
+const uint8_t MPU6050_FIFO_SAMPLE_SIZE = 12;
+/// Drain the FIFO when it has about this many samples, well below the 85 that fit.
+const uint16_t MPU6050_FIFO_DRAIN_SAMPLES = 32;
 const uint8_t MPU6050_CLOCK_SOURCE_X_GYRO = 0b001;
 const uint8_t MPU6050_SCALE_2000_DPS = 0b11;
 const float MPU6050_SCALE_DPS_PER_DIGIT_2000 = 0.060975f;
@@ -89,10 +109,154 @@ void MPU6050Component::setup() {
   accel_config &= 0b11100111;
   accel_config |= (MPU6050_RANGE_2G << 3);
   ESP_LOGV(TAG, "    Output accel_config: 0b" BYTE_TO_BINARY_PATTERN, BYTE_TO_BINARY(accel_config));
-  if (!this->write_byte(MPU6050_REGISTER_GYRO_CONFIG, gyro_config)) {
+  if (!this->write_byte(MPU6050_REGISTER_ACCEL_CONFIG, accel_config)) {
     this->mark_failed();
     return;
   }
+
+  if (this->fifo_sample_rate_ != 0 && !this->setup_fifo_()) {
+    this->mark_failed();
+    return;
+  }
+}
+bool MPU6050Component::setup_fifo_() {
+  ESP_LOGV(TAG, "  Setting up FIFO...");
+  if (!this->write_byte(MPU6050_REGISTER_CONFIG, MPU6050_DLPF_188_HZ))
+    return false;
+  // sample rate = 1kHz / (1 + SMPLRT_DIV) with the DLPF enabled, and the divider is a single byte
+  const uint8_t sample_rate_div = clamp<uint16_t>(1, 256, 1000 / this->fifo_sample_rate_) - 1;
+  if (!this->write_byte(MPU6050_REGISTER_SMPLRT_DIV, sample_rate_div))
+    return false;
+  if (!this->write_byte(MPU6050_REGISTER_FIFO_EN, MPU6050_FIFO_EN_ACCEL_GYRO))
+    return false;
+  this->reset_fifo_();
+  this->reset_window_();
+
+  const uint32_t drain_interval = std::max(1UL, MPU6050_FIFO_DRAIN_SAMPLES * 1000UL / this->fifo_sample_rate_);
+  this->set_interval("fifo", drain_interval, [this] { this->drain_fifo_(); });
+  return true;
+}
+void MPU6050Component::reset_fifo_() {
+  // FIFO_RESET only works while the FIFO is disabled
+  this->write_byte(MPU6050_REGISTER_USER_CTRL, MPU6050_USER_CTRL_FIFO_RESET);
+  this->write_byte(MPU6050_REGISTER_USER_CTRL, MPU6050_USER_CTRL_FIFO_EN);
+}
+void MPU6050Component::drain_fifo_() {
+  uint16_t count;
+  if (!this->read_byte_16(MPU6050_REGISTER_FIFO_COUNT_H, &count)) {
+    this->status_set_warning();
+    return;
+  }
+  if (count >= MPU6050_FIFO_SIZE - MPU6050_FIFO_SAMPLE_SIZE || count % MPU6050_FIFO_SAMPLE_SIZE != 0) {
+    // the FIFO overflowed (or we lost the sample alignment), start over
+    this->fifo_overflows_++;
+    ESP_LOGW(TAG, "FIFO overflow, resetting FIFO (%u overflows so far)", this->fifo_overflows_);
+    this->reset_fifo_();
+    return;
+  }
+
+  // read as many samples at once as the i2c buffer allows
+  const uint8_t chunk_samples = I2C_MAX_READ_LENGTH / MPU6050_FIFO_SAMPLE_SIZE;
+  uint8_t data[I2C_MAX_READ_LENGTH];
+  uint16_t samples = count / MPU6050_FIFO_SAMPLE_SIZE;
+  while (samples > 0) {
+    const uint8_t n = std::min<uint16_t>(samples, chunk_samples);
+    if (!this->read_bytes(MPU6050_REGISTER_FIFO_R_W, data, n * MPU6050_FIFO_SAMPLE_SIZE)) {
+      this->status_set_warning();
+      // a partial read would break the sample alignment
+      this->reset_fifo_();
+      return;
+    }
+    for (uint8_t i = 0; i < n; i++)
+      this->add_sample_(data + i * MPU6050_FIFO_SAMPLE_SIZE);
+    samples -= n;
+  }
+}
+void MPU6050Component::add_sample_(const uint8_t *data) {
+  for (uint8_t i = 0; i < 6; i++) {
+    const int16_t value = int16_t((uint16_t(data[i * 2]) << 8) | data[i * 2 + 1]);
+    this->window_sum_[i] += value;
+    if (i < 3) {
+      this->window_sum_sq_[i] += uint64_t(int32_t(value) * int32_t(value));
+      this->window_min_[i] = std::min(this->window_min_[i], value);
+      this->window_max_[i] = std::max(this->window_max_[i], value);
+    }
+  }
+  this->window_count_++;
+}
+void MPU6050Component::reset_window_() {
+  this->window_count_ = 0;
+  for (uint8_t i = 0; i < 6; i++)
+    this->window_sum_[i] = 0;
+  for (uint8_t i = 0; i < 3; i++) {
+    this->window_sum_sq_[i] = 0;
+    this->window_min_[i] = INT16_MAX;
+    this->window_max_[i] = INT16_MIN;
+  }
+}
+void MPU6050Component::update_fifo_() {
+  // get the samples that arrived since the last drain too
+  this->drain_fifo_();
+  const uint32_t n = this->window_count_;
+  if (n == 0) {
+    ESP_LOGW(TAG, "No FIFO samples in the last update interval");
+    this->status_set_warning();
+    return;
+  }
+
+  double mean[6];
+  for (uint8_t i = 0; i < 6; i++)
+    mean[i] = this->window_sum_[i] / double(n);
+
+  double variance = 0;
+  float peak = 0;
+  for (uint8_t i = 0; i < 3; i++) {
+    variance += this->window_sum_sq_[i] / double(n) - mean[i] * mean[i];
+    peak = std::max(peak, (this->window_max_[i] - this->window_min_[i]) / 2.0f);
+  }
+  const float accel_scale = MPU6050_RANGE_PER_DIGIT_2G * GRAVITY_EARTH;
+  const float rms = sqrtf(std::max(0.0f, float(variance))) * accel_scale;
+  peak *= accel_scale;
+
+  float accel_x = mean[0] * accel_scale;
+  float accel_y = mean[1] * accel_scale;
+  float accel_z = mean[2] * accel_scale;
+  float gyro_x = mean[3] * MPU6050_SCALE_DPS_PER_DIGIT_2000;
+  float gyro_y = mean[4] * MPU6050_SCALE_DPS_PER_DIGIT_2000;
+  float gyro_z = mean[5] * MPU6050_SCALE_DPS_PER_DIGIT_2000;
+  ESP_LOGD(TAG,
+           "Got %u samples: accel={x=%.3f m/s², y=%.3f m/s², z=%.3f m/s²}, "
+           "gyro={x=%.3f °/s, y=%.3f °/s, z=%.3f °/s}, rms=%.3f m/s², peak=%.3f m/s²",
+           n, accel_x, accel_y, accel_z, gyro_x, gyro_y, gyro_z, rms, peak);
+  this->reset_window_();
+
+  if (this->accel_x_sensor_ != nullptr)
+    this->accel_x_sensor_->publish_state(accel_x);
+  if (this->accel_y_sensor_ != nullptr)
+    this->accel_y_sensor_->publish_state(accel_y);
+  if (this->accel_z_sensor_ != nullptr)
+    this->accel_z_sensor_->publish_state(accel_z);
+  if (this->gyro_x_sensor_ != nullptr)
+    this->gyro_x_sensor_->publish_state(gyro_x);
+  if (this->gyro_y_sensor_ != nullptr)
+    this->gyro_y_sensor_->publish_state(gyro_y);
+  if (this->gyro_z_sensor_ != nullptr)
+    this->gyro_z_sensor_->publish_state(gyro_z);
+  if (this->accel_rms_sensor_ != nullptr)
+    this->accel_rms_sensor_->publish_state(rms);
+  if (this->accel_peak_sensor_ != nullptr)
+    this->accel_peak_sensor_->publish_state(peak);
+
+  if (this->temperature_sensor_ != nullptr) {
+    uint16_t raw_temperature;
+    if (!this->read_byte_16(MPU6050_REGISTER_TEMP_OUT_H, &raw_temperature)) {
+      this->status_set_warning();
+      return;
+    }
+    this->temperature_sensor_->publish_state(int16_t(raw_temperature) / 340.0f + 36.53f);
+  }
+
+  this->status_clear_warning();
 }
 void MPU6050Component::dump_config() {
   ESP_LOGCONFIG(TAG, "MPU6050:");
@@ -101,6 +265,9 @@ void MPU6050Component::dump_config() {
     ESP_LOGE(TAG, "Communication with MPU6050 failed!");
   }
   LOG_UPDATE_INTERVAL(this);
+  if (this->fifo_sample_rate_ != 0) {
+    ESP_LOGCONFIG(TAG, "  FIFO Sample Rate: %u Hz", 1000 / (1000 / this->fifo_sample_rate_));
+  }
   LOG_SENSOR("  ", "Acceleration X", this->accel_x_sensor_);
   LOG_SENSOR("  ", "Acceleration Y", this->accel_y_sensor_);
   LOG_SENSOR("  ", "Acceleration Z", this->accel_z_sensor_);
@@ -108,25 +275,32 @@ void MPU6050Component::dump_config() {
   LOG_SENSOR("  ", "Gyro Y", this->gyro_y_sensor_);
   LOG_SENSOR("  ", "Gyro Z", this->gyro_z_sensor_);
   LOG_SENSOR("  ", "Temperature", this->temperature_sensor_);
+  LOG_SENSOR("  ", "Acceleration RMS", this->accel_rms_sensor_);
+  LOG_SENSOR("  ", "Acceleration Peak", this->accel_peak_sensor_);
 }
 
 void MPU6050Component::update() {
   ESP_LOGV(TAG, "    Updating MPU6050...");
+  if (this->fifo_sample_rate_ != 0) {
+    this->update_fifo_();
+    return;
+  }
+
   uint16_t data[7];
   if (!this->read_bytes_16(MPU6050_REGISTER_ACCEL_XOUT_H, data, 7)) {
     this->status_set_warning();
     return;
   }
 
-  float accel_x = data[0] * MPU6050_RANGE_PER_DIGIT_2G * GRAVITY_EARTH;
-  float accel_y = data[1] * MPU6050_RANGE_PER_DIGIT_2G * GRAVITY_EARTH;
-  float accel_z = data[2] * MPU6050_RANGE_PER_DIGIT_2G * GRAVITY_EARTH;
+  float accel_x = int16_t(data[0]) * MPU6050_RANGE_PER_DIGIT_2G * GRAVITY_EARTH;
+  float accel_y = int16_t(data[1]) * MPU6050_RANGE_PER_DIGIT_2G * GRAVITY_EARTH;
+  float accel_z = int16_t(data[2]) * MPU6050_RANGE_PER_DIGIT_2G * GRAVITY_EARTH;
 
-  float temperature = data[3] / 340.0f + 36.53f;
+  float temperature = int16_t(data[3]) / 340.0f + 36.53f;
 
-  float gyro_x = data[4] * MPU6050_SCALE_DPS_PER_DIGIT_2000;
-  float gyro_y = data[5] * MPU6050_SCALE_DPS_PER_DIGIT_2000;
-  float gyro_z = data[6] * MPU6050_SCALE_DPS_PER_DIGIT_2000;
+  float gyro_x = int16_t(data[4]) * MPU6050_SCALE_DPS_PER_DIGIT_2000;
+  float gyro_y = int16_t(data[5]) * MPU6050_SCALE_DPS_PER_DIGIT_2000;
+  float gyro_z = int16_t(data[6]) * MPU6050_SCALE_DPS_PER_DIGIT_2000;
 
   ESP_LOGD(TAG,
            "Got accel={x=%.3f m/s², y=%.3f m/s², z=%.3f m/s²}, "
@@ -173,7 +347,17 @@ MPU6050GyroSensor *MPU6050Component::make_gyro_z_sensor(const std::string &name)
 MPU6050TemperatureSensor *MPU6050Component::make_temperature_sensor(const std::string &name) {
   return this->temperature_sensor_ = new MPU6050TemperatureSensor(name, this);
 }
+void MPU6050Component::set_fifo_sample_rate(uint16_t sample_rate) {
+  this->fifo_sample_rate_ = clamp<uint16_t>(4, 1000, sample_rate);
+}
+MPU6050AccelSensor *MPU6050Component::make_accel_rms_sensor(const std::string &name) {
+  return this->accel_rms_sensor_ = new MPU6050AccelSensor(name, this);
+}
+MPU6050AccelSensor *MPU6050Component::make_accel_peak_sensor(const std::string &name) {
+  return this->accel_peak_sensor_ = new MPU6050AccelSensor(name, this);
+}
 float MPU6050Component::get_setup_priority() const { return setup_priority::HARDWARE_LATE; }
+uint32_t MPU6050Component::get_loop_idle_time() { return SCHEDULER_DONT_RUN; }
 
 }  // namespace sensor
 
@@ -25,6 +25,7 @@ class MPU6050Component : public PollingComponent, public I2CDevice {
   void dump_config() override;
 
   void update() override;
+  uint32_t get_loop_idle_time() override;
 
   float get_setup_priority() const override;
 
@@ -36,7 +37,31 @@ class MPU6050Component : public PollingComponent, public I2CDevice {
   MPU6050GyroSensor *make_gyro_z_sensor(const std::string &name);
   MPU6050TemperatureSensor *make_temperature_sensor(const std::string &name);
 
+  /** Sample at a high rate through the FIFO of the MPU6050 instead of reading once per update interval.
+   *
+   * The FIFO is drained in bursts in the background, and every update interval the axis sensors get the
+   * mean of all samples of that window. The vibration sensors (see make_accel_rms_sensor) are only
+   * available in this mode. High sample rates need a fast i2c bus (400kHz) to keep up.
+   *
+   * @param sample_rate The sample rate in Hz, 4 to 1000.
+   */
+  void set_fifo_sample_rate(uint16_t sample_rate);
+
+  /// RMS of the acceleration around its mean over each update interval (all axes combined), FIFO mode only.
+  MPU6050AccelSensor *make_accel_rms_sensor(const std::string &name);
+  /// Largest peak amplitude of the acceleration of any axis over each update interval, FIFO mode only.
+  MPU6050AccelSensor *make_accel_peak_sensor(const std::string &name);
+
  protected:
+  bool setup_fifo_();
+  void reset_fifo_();
+  /// Read all complete samples from the FIFO into the window statistics.
+  void drain_fifo_();
+  void add_sample_(const uint8_t *data);
+  void update_fifo_();
+  void reset_window_();
+
+
   MPU6050AccelSensor *accel_x_sensor_{nullptr};
   MPU6050AccelSensor *accel_y_sensor_{nullptr};
   MPU6050AccelSensor *accel_z_sensor_{nullptr};
@@ -44,6 +69,17 @@ class MPU6050Component : public PollingComponent, public I2CDevice {
   MPU6050GyroSensor *gyro_x_sensor_{nullptr};
   MPU6050GyroSensor *gyro_y_sensor_{nullptr};
   MPU6050GyroSensor *gyro_z_sensor_{nullptr};
+  MPU6050AccelSensor *accel_rms_sensor_{nullptr};
+  MPU6050AccelSensor *accel_peak_sensor_{nullptr};
+
+  uint16_t fifo_sample_rate_{0};
+  uint32_t fifo_overflows_{0};
+  /// Statistics of the current window of FIFO samples, in raw values. Axis order is accel x/y/z, gyro x/y/z.
+  uint32_t window_count_{0};
+  int64_t window_sum_[6];
+  uint64_t window_sum_sq_[3];
+  int16_t window_min_[3];
+  int16_t window_max_[3];
 };
 
 }  // namespace sensor
@@ -9,6 +9,10 @@
 #include "esphome/log.h"
 #include "esphome/component.h"
 
+#ifdef USE_API
+#include "esphome/api/subscribe_state.h"
+#endif
+
 ESPHOME_NAMESPACE_BEGIN
 
 namespace sensor {
@@ -18,7 +22,8 @@ static const char *TAG = "sensor.mqtt";
 MQTTSensorComponent::MQTTSensorComponent(Sensor *sensor) : MQTTComponent(), sensor_(sensor) {}
 
 void MQTTSensorComponent::setup() {
-  this->sensor_->add_on_state_callback([this](float state) { this->publish_state(state); });
+  this->sensor_->add_on_state_callback([this](float state) { this->on_sensor_state_(state); });
+  this->schedule_publish_check_();
 }
 
 void MQTTSensorComponent::dump_config() {
@@ -47,13 +52,13 @@ void MQTTSensorComponent::set_expire_after(uint32_t expire_after) { this->expire
 void MQTTSensorComponent::disable_expire_after() { this->expire_after_ = 0; }
 std::string MQTTSensorComponent::friendly_name() const { return this->sensor_->get_name(); }
 void MQTTSensorComponent::send_discovery(JsonObject &root, mqtt::SendDiscoveryConfig &config) {
-  if (!this->sensor_->get_unit_of_measurement().empty())
+  if (this->sensor_->get_unit_of_measurement()[0] != '\0')
     root["unit_of_measurement"] = this->sensor_->get_unit_of_measurement();
 
   if (this->get_expire_after() > 0)
     root["expire_after"] = this->get_expire_after() / 1000;
 
-  if (!this->sensor_->get_icon().empty())
+  if (this->sensor_->get_icon()[0] != '\0')
     root["icon"] = this->sensor_->get_icon();
 
   config.command_topic = false;
@@ -65,10 +70,43 @@ bool MQTTSensorComponent::send_initial_state() {
     return true;
   }
 }
+void MQTTSensorComponent::on_sensor_state_(float value) {
+  const auto &policy = global_mqtt_client->get_sensor_publish_policy();
+  if (!policy.is_active()) {
+    this->publish_state(value);
+    return;
+  }
+  if (policy.check(this->publish_state_, value, millis()))
+    this->publish_state(value);
+  this->schedule_publish_check_();
+}
+void MQTTSensorComponent::schedule_publish_check_() {
+  const auto &policy = global_mqtt_client->get_sensor_publish_policy();
+  if (!policy.is_timed() || !this->publish_state_.sent)
+    return;
+  const uint32_t elapsed = millis() - this->publish_state_.time;
+  const uint32_t interval = this->publish_state_.held ? policy.min_interval : policy.max_interval;
+  if (interval == 0)
+    return;
+  // replaces the previously scheduled check
+  this->set_timeout("publish", elapsed < interval ? interval - elapsed : 0, [this]() {
+    if (global_mqtt_client->get_sensor_publish_policy().is_due(this->publish_state_, millis()))
+      this->on_sensor_state_(this->sensor_->state);
+    else
+      this->schedule_publish_check_();
+  });
+}
 bool MQTTSensorComponent::is_internal() { return this->sensor_->is_internal(); }
 bool MQTTSensorComponent::publish_state(float value) {
   int8_t accuracy = this->sensor_->get_accuracy_decimals();
-  return this->publish(this->get_state_topic_(), value_accuracy_to_string(value, accuracy));
+  char buf[VALUE_ACCURACY_MAX_LEN];
+  size_t len = value_accuracy_to_buf(buf, value, accuracy);
+#ifdef USE_API
+  this->publish_binary_state_([this, value](api::APIBuffer &buffer) {
+    api::encode_sensor_state(buffer, this->sensor_, value);
+  });
+#endif
+  return this->publish(this->get_state_topic_(), buf, len);
 }
 std::string MQTTSensorComponent::unique_id() { return this->sensor_->unique_id(); }
 
@@ -55,7 +55,13 @@ class MQTTSensorComponent : public mqtt::MQTTComponent {
 
   std::string unique_id() override;
 
+  /// Publish value if the sensor publish policy of the MQTT client lets it through.
+  void on_sensor_state_(float value);
+  /// Schedule the next check for a held back value or the heartbeat.
+  void schedule_publish_check_();
+
   Sensor *sensor_;
+  SensorPublishState publish_state_;
   optional<uint32_t> expire_after_;  // Override the expire after advertised to Home Assistant
 };
 
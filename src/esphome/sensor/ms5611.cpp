@@ -43,6 +43,7 @@ void MS5611Component::dump_config() {
   LOG_SENSOR("  ", "Pressure", this->pressure_sensor_);
 }
 float MS5611Component::get_setup_priority() const { return setup_priority::HARDWARE_LATE; }
+uint32_t MS5611Component::get_loop_idle_time() { return SCHEDULER_DONT_RUN; }
 void MS5611Component::update() {
   // request temperature reading
   if (!this->write_bytes(MS5611_CMD_CONV_D2 + 0x08, nullptr, 0)) {
@@ -24,6 +24,7 @@ class MS5611Component : public PollingComponent, public I2CDevice {
   void dump_config() override;
   float get_setup_priority() const override;
   void update() override;
+  uint32_t get_loop_idle_time() override;
 
   MS5611TemperatureSensor *get_temperature_sensor() const;
   MS5611PressureSensor *get_pressure_sensor() const;
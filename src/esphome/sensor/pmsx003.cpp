@@ -11,143 +11,124 @@ namespace sensor {
 
 static const char *TAG = "sensor.pmsx003";
 
-void PMSX003Component::loop() {
-  const uint32_t now = millis();
-  if (now - this->last_transmission_ >= 500) {
-    // last transmission too long ago. Reset RX index.
-    this->data_index_ = 0;
-  }
-
-  if (this->available() == 0)
-    return;
-
-  this->last_transmission_ = now;
-  while (this->available() != 0) {
-    this->read_byte(&this->data_[this->data_index_]);
-    auto check = this->check_byte_();
-    if (!check.has_value()) {
-      // finished
-      this->parse_data_();
-      this->data_index_ = 0;
-    } else if (!*check) {
-      // wrong data
-      this->data_index_ = 0;
-    } else {
-      // next byte
-      this->data_index_++;
-    }
-  }
+void PMSX003Component::setup() {
+  // start (16bit) + length (16bit) + DATA (payload_length-2 bytes) + checksum (16bit)
+  this->parser_.set_header({0x42, 0x4D});
+  this->parser_.set_length_field(2, 2, 4);
+  this->parser_.set_validator([this](const uint8_t *frame, size_t len) { return this->check_frame_(frame, len); });
+  this->parser_.set_on_frame([this](const uint8_t *frame, size_t len) { this->parse_data_(frame); });
+  this->add_frame_parser(&this->parser_);
+  // the UART calls us once data has arrived
+  this->disable_loop();
 }
 float PMSX003Component::get_setup_priority() const { return setup_priority::HARDWARE_LATE; }
-optional<bool> PMSX003Component::check_byte_() {
-  uint8_t index = this->data_index_;
-  uint8_t byte = this->data_[index];
-
-  if (index == 0)
-    return byte == 0x42;
-
-  if (index == 1)
-    return byte == 0x4D;
-
-  if (index == 2)
-    return true;
-
-  uint16_t payload_length = this->get_16_bit_uint_(2);
-  if (index == 3) {
-    bool length_matches = false;
-    switch (this->type_) {
-      case PMSX003_TYPE_X003:
-        length_matches = payload_length == 28 || payload_length == 20;
-        break;
-      case PMSX003_TYPE_5003T:
-        length_matches = payload_length == 28;
-        break;
-      case PMSX003_TYPE_5003ST:
-        length_matches = payload_length == 36;
-        break;
-    }
-
-    if (!length_matches) {
-      ESP_LOGW(TAG, "PMSX003 length %u doesn't match. Are you using the correct PMSX003 type?", payload_length);
-      return false;
-    }
-    return true;
+bool PMSX003Component::check_frame_(const uint8_t *data, size_t len) {
+  uint16_t payload_length = get_16_bit_uint_(data, 2);
+  bool length_matches = false;
+  switch (this->type_) {
+    case PMSX003_TYPE_X003:
+      length_matches = payload_length == 28 || payload_length == 20;
+      break;
+    case PMSX003_TYPE_5003T:
+      length_matches = payload_length == 28;
+      break;
+    case PMSX003_TYPE_5003ST:
+      length_matches = payload_length == 36;
+      break;
   }
 
-  // start (16bit) + length (16bit) + DATA (payload_length-2 bytes) + checksum (16bit)
-  uint8_t total_size = 4 + payload_length;
-
-  if (index < total_size - 1)
-    return true;
+  if (!length_matches) {
+    ESP_LOGW(TAG, "PMSX003 length %u doesn't match. Are you using the correct PMSX003 type?", payload_length);
+    return false;
+  }
 
   // checksum is without checksum bytes
   uint16_t checksum = 0;
-  for (uint8_t i = 0; i < total_size - 2; i++)
-    checksum += this->data_[i];
+  for (size_t i = 0; i < len - 2; i++)
+    checksum += data[i];
 
-  uint16_t check = this->get_16_bit_uint_(total_size - 2);
+  uint16_t check = get_16_bit_uint_(data, len - 2);
   if (checksum != check) {
     ESP_LOGW(TAG, "PMSX003 checksum mismatch! 0x%02X!=0x%02X", checksum, check);
     return false;
   }
 
-  return {};
+  return true;
 }
 
-void PMSX003Component::parse_data_() {
+void PMSX003Component::parse_data_(const uint8_t *data) {
+  if (this->duty_cycle_ != nullptr && !this->duty_cycle_->is_collecting())
+    // asleep or warming up
+    return;
+
   switch (this->type_) {
     case PMSX003_TYPE_X003: {
-      uint16_t pm_1_0_concentration = this->get_16_bit_uint_(10);
-      uint16_t pm_2_5_concentration = this->get_16_bit_uint_(12);
-      uint16_t pm_10_0_concentration = this->get_16_bit_uint_(14);
+      uint16_t pm_1_0_concentration = get_16_bit_uint_(data, 10);
+      uint16_t pm_2_5_concentration = get_16_bit_uint_(data, 12);
+      uint16_t pm_10_0_concentration = get_16_bit_uint_(data, 14);
       ESP_LOGD(TAG,
                "Got PM1.0 Concentration: %u µg/m^3, PM2.5 Concentration %u µg/m^3, PM10.0 Concentration: %u µg/m^3",
                pm_1_0_concentration, pm_2_5_concentration, pm_10_0_concentration);
-      if (this->pm_1_0_sensor_ != nullptr)
-        this->pm_1_0_sensor_->publish_state(pm_1_0_concentration);
-      if (this->pm_2_5_sensor_ != nullptr)
-        this->pm_2_5_sensor_->publish_state(pm_2_5_concentration);
-      if (this->pm_10_0_sensor_ != nullptr)
-        this->pm_10_0_sensor_->publish_state(pm_10_0_concentration);
+      this->publish_state_(this->pm_1_0_sensor_, pm_1_0_concentration);
+      this->publish_state_(this->pm_2_5_sensor_, pm_2_5_concentration);
+      this->publish_state_(this->pm_10_0_sensor_, pm_10_0_concentration);
       break;
     }
     case PMSX003_TYPE_5003T: {
-      uint16_t pm_2_5_concentration = this->get_16_bit_uint_(12);
-      float temperature = this->get_16_bit_uint_(24) / 10.0f;
-      float humidity = this->get_16_bit_uint_(26) / 10.0f;
+      uint16_t pm_2_5_concentration = get_16_bit_uint_(data, 12);
+      float temperature = get_16_bit_uint_(data, 24) / 10.0f;
+      float humidity = get_16_bit_uint_(data, 26) / 10.0f;
       ESP_LOGD(TAG, "Got PM2.5 Concentration: %u µg/m^3, Temperature: %.1f°C, Humidity: %.1f%%", pm_2_5_concentration,
                temperature, humidity);
-      if (this->pm_2_5_sensor_ != nullptr)
-        this->pm_2_5_sensor_->publish_state(pm_2_5_concentration);
-      if (this->temperature_sensor_ != nullptr)
-        this->temperature_sensor_->publish_state(temperature);
-      if (this->humidity_sensor_ != nullptr)
-        this->humidity_sensor_->publish_state(humidity);
+      this->publish_state_(this->pm_2_5_sensor_, pm_2_5_concentration);
+      this->publish_state_(this->temperature_sensor_, temperature);
+      this->publish_state_(this->humidity_sensor_, humidity);
       break;
     }
     case PMSX003_TYPE_5003ST: {
-      uint16_t pm_2_5_concentration = this->get_16_bit_uint_(12);
-      uint16_t formaldehyde = this->get_16_bit_uint_(28);
-      float temperature = this->get_16_bit_uint_(30) / 10.0f;
-      float humidity = this->get_16_bit_uint_(32) / 10.0f;
+      uint16_t pm_2_5_concentration = get_16_bit_uint_(data, 12);
+      uint16_t formaldehyde = get_16_bit_uint_(data, 28);
+      float temperature = get_16_bit_uint_(data, 30) / 10.0f;
+      float humidity = get_16_bit_uint_(data, 32) / 10.0f;
       ESP_LOGD(TAG, "Got PM2.5 Concentration: %u µg/m^3, Temperature: %.1f°C, Humidity: %.1f%% Formaldehyde: %u µg/m^3",
                pm_2_5_concentration, temperature, humidity, formaldehyde);
-      if (this->pm_2_5_sensor_ != nullptr)
-        this->pm_2_5_sensor_->publish_state(pm_2_5_concentration);
-      if (this->temperature_sensor_ != nullptr)
-        this->temperature_sensor_->publish_state(temperature);
-      if (this->humidity_sensor_ != nullptr)
-        this->humidity_sensor_->publish_state(humidity);
-      if (this->formaldehyde_sensor_ != nullptr)
-        this->formaldehyde_sensor_->publish_state(formaldehyde);
+      this->publish_state_(this->pm_2_5_sensor_, pm_2_5_concentration);
+      this->publish_state_(this->temperature_sensor_, temperature);
+      this->publish_state_(this->humidity_sensor_, humidity);
+      this->publish_state_(this->formaldehyde_sensor_, formaldehyde);
       break;
     }
   }
 
   this->status_clear_warning();
+  if (this->duty_cycle_ != nullptr)
+    this->duty_cycle_->add_sample();
+}
+void PMSX003Component::publish_state_(PMSX003Sensor *sensor, float state) {
+  if (sensor == nullptr)
+    return;
+  if (this->duty_cycle_ != nullptr) {
+    this->duty_cycle_->add_value(sensor, state);
+    return;
+  }
+  sensor->publish_state(state);
+}
+void PMSX003Component::set_duty_cycle(SensorDutyCycle *duty_cycle) {
+  this->duty_cycle_ = duty_cycle;
+  duty_cycle->set_sleep_function([this](bool awake) { this->write_sleep_command_(awake); });
+}
+void PMSX003Component::write_sleep_command_(bool awake) {
+  // start, command 0xE4 (sleep/wake), data (0 -> sleep, 1 -> wake), checksum
+  uint8_t command[7] = {0x42, 0x4D, 0xE4, 0x00, uint8_t(awake ? 0x01 : 0x00), 0x00, 0x00};
+  uint16_t checksum = 0;
+  for (uint8_t i = 0; i < 5; i++)
+    checksum += command[i];
+  command[5] = checksum >> 8;
+  command[6] = checksum;
+  this->write_array(command, sizeof(command));
 }
-uint16_t PMSX003Component::get_16_bit_uint_(uint8_t start_index) {
-  return (uint16_t(this->data_[start_index]) << 8) | uint16_t(this->data_[start_index + 1]);
+uint16_t PMSX003Component::get_16_bit_uint_(const uint8_t *data, size_t start_index) {
+  return (uint16_t(data[start_index]) << 8) | uint16_t(data[start_index + 1]);
 }
 PMSX003Sensor *PMSX003Component::make_pm_1_0_sensor(const std::string &name) {
   return this->pm_1_0_sensor_ = new PMSX003Sensor(name, PMSX003_SENSOR_TYPE_PM_1_0);
@@ -167,9 +148,11 @@ PMSX003Sensor *PMSX003Component::make_humidity_sensor(const std::string &name) {
 PMSX003Sensor *PMSX003Component::make_formaldehyde_sensor(const std::string &name) {
   return this->formaldehyde_sensor_ = new PMSX003Sensor(name, PMSX003_SENSOR_TYPE_FORMALDEHYDE);
 }
-PMSX003Component::PMSX003Component(UARTComponent *parent, PMSX003Type type) : UARTDevice(parent), type_(type) {}
+PMSX003Component::PMSX003Component(UARTComponent *parent, PMSX003Type type)
+    : UARTDevice(parent), parser_(64), type_(type) {}
 void PMSX003Component::dump_config() {
   ESP_LOGCONFIG(TAG, "PMSX003:");
+  ESP_LOGCONFIG(TAG, "  Duty Cycle: %s", YESNO(this->duty_cycle_ != nullptr));
   LOG_SENSOR("  ", "PM1.0", this->pm_1_0_sensor_);
   LOG_SENSOR("  ", "PM2.5", this->pm_2_5_sensor_);
   LOG_SENSOR("  ", "PM10.0", this->pm_10_0_sensor_);
@@ -178,7 +161,7 @@ void PMSX003Component::dump_config() {
   LOG_SENSOR("  ", "Formaldehyde", this->formaldehyde_sensor_);
 }
 
-std::string PMSX003Sensor::unit_of_measurement() {
+const char *PMSX003Sensor::unit_of_measurement() {
   switch (this->type_) {
     case PMSX003_SENSOR_TYPE_PM_1_0:
     case PMSX003_SENSOR_TYPE_PM_2_5:
@@ -192,7 +175,7 @@ std::string PMSX003Sensor::unit_of_measurement() {
   }
   return "";
 }
-std::string PMSX003Sensor::icon() {
+const char *PMSX003Sensor::icon() {
   switch (this->type_) {
     case PMSX003_SENSOR_TYPE_PM_1_0:
     case PMSX003_SENSOR_TYPE_PM_2_5:
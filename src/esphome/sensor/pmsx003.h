@@ -7,6 +7,7 @@
 
 #include "esphome/component.h"
 #include "esphome/sensor/sensor.h"
+#include "esphome/sensor/sensor_duty_cycle.h"
 #include "esphome/uart_component.h"
 #include "esphome/helpers.h"
 
@@ -39,8 +40,8 @@ class PMSX003Sensor : public sensor::Sensor {
  public:
   PMSX003Sensor(const std::string &name, PMSX003SensorType type);
 
-  std::string unit_of_measurement() override;
-  std::string icon() override;
+  const char *unit_of_measurement() override;
+  const char *icon() override;
   int8_t accuracy_decimals() override;
 
  protected:
@@ -51,7 +52,10 @@ class PMSX003Component : public UARTDevice, public Component {
  public:
   PMSX003Component(UARTComponent *parent, PMSX003Type type);
 
-  void loop() override;
+  /// Only take readings every update interval of the duty cycle, the sensor sleeps in between.
+  void set_duty_cycle(SensorDutyCycle *duty_cycle);
+
+  void setup() override;
   float get_setup_priority() const override;
   void dump_config() override;
 
@@ -63,13 +67,13 @@ class PMSX003Component : public UARTDevice, public Component {
   PMSX003Sensor *make_formaldehyde_sensor(const std::string &name);
 
  protected:
-  optional<bool> check_byte_();
-  void parse_data_();
-  uint16_t get_16_bit_uint_(uint8_t start_index);
+  bool check_frame_(const uint8_t *data, size_t len);
+  void parse_data_(const uint8_t *data);
+  void publish_state_(PMSX003Sensor *sensor, float state);
+  void write_sleep_command_(bool awake);
+  static uint16_t get_16_bit_uint_(const uint8_t *data, size_t start_index);
 
-  uint8_t data_[64];
-  uint8_t data_index_{0};
-  uint32_t last_transmission_{0};
+  UARTFrameParser parser_;
   const PMSX003Type type_;
   PMSX003Sensor *pm_1_0_sensor_{nullptr};
   PMSX003Sensor *pm_2_5_sensor_{nullptr};
@@ -77,6 +81,7 @@ class PMSX003Component : public UARTDevice, public Component {
   PMSX003Sensor *temperature_sensor_{nullptr};
   PMSX003Sensor *humidity_sensor_{nullptr};
   PMSX003Sensor *formaldehyde_sensor_{nullptr};
+  SensorDutyCycle *duty_cycle_{nullptr};
 };
 
 }  // namespace sensor
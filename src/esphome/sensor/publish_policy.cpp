@@ -0,0 +1,50 @@
+#include "esphome/defines.h"
+
+#ifdef USE_SENSOR
+
+#include <algorithm>
+#include "esphome/sensor/publish_policy.h"
+
+ESPHOME_NAMESPACE_BEGIN
+
+namespace sensor {
+
+bool SensorPublishPolicy::is_active() const {
+  return this->absolute_deadband != 0.0f || this->relative_deadband != 0.0f || this->is_timed();
+}
+bool SensorPublishPolicy::is_timed() const { return this->min_interval != 0 || this->max_interval != 0; }
+bool SensorPublishPolicy::check(SensorPublishState &state, float value, uint32_t now) const {
+  if (state.sent) {
+    const uint32_t elapsed = now - state.time;
+    if (elapsed < this->min_interval) {
+      state.held = true;
+      return false;
+    }
+    state.held = false;
+
+    const bool heartbeat = this->max_interval != 0 && elapsed >= this->max_interval;
+    // NAN is outside every deadband (and every value is outside the deadband of NAN)
+    const float threshold = std::max(this->absolute_deadband, this->relative_deadband * fabsf(state.value));
+    if (!heartbeat && fabsf(value - state.value) < threshold)
+      return false;
+  }
+
+  state.value = value;
+  state.time = now;
+  state.sent = true;
+  return true;
+}
+bool SensorPublishPolicy::is_due(const SensorPublishState &state, uint32_t now) const {
+  if (!state.sent)
+    return false;
+  const uint32_t elapsed = now - state.time;
+  if (state.held && elapsed >= this->min_interval)
+    return true;
+  return this->max_interval != 0 && elapsed >= this->max_interval;
+}
+
+}  // namespace sensor
+
+ESPHOME_NAMESPACE_END
+
+#endif  // USE_SENSOR
@@ -0,0 +1,58 @@
+#ifndef ESPHOME_SENSOR_PUBLISH_POLICY_H
+#define ESPHOME_SENSOR_PUBLISH_POLICY_H
+
+#include "esphome/defines.h"
+
+#ifdef USE_SENSOR
+
+#include <cmath>
+#include <cstdint>
+
+ESPHOME_NAMESPACE_BEGIN
+
+namespace sensor {
+
+/// What a controller last sent for a sensor, see SensorPublishPolicy.
+struct SensorPublishState {
+  float value{NAN};
+  uint32_t time{0};
+  bool sent{false};
+  /// Whether a value was held back by the minimum interval.
+  bool held{false};
+};
+
+/** When a controller sends the values of sensors over the network.
+ *
+ * Unlike filters (for example DeltaFilter or ThrottleFilter) this doesn't change the values of the sensor
+ * itself, automations still see every value. It only thins out what a controller (API, web server, MQTT) sends:
+ * a value is sent if it's outside the deadband around the last sent value, but not more often than the minimum
+ * interval (the latest value is sent when the interval is over) and at least every maximum interval.
+ *
+ * With MQTT, keep the maximum interval below the expire_after of the sensors.
+ */
+struct SensorPublishPolicy {
+  /// Only send values that differ from the last sent value by at least this much.
+  float absolute_deadband{0.0f};
+  /// Only send values that differ from the last sent value by at least this fraction of it.
+  float relative_deadband{0.0f};
+  /// Send at most once per this many ms, 0 to disable.
+  uint32_t min_interval{0};
+  /// Send the current value at least every this many ms even if it's inside the deadband, 0 to disable.
+  uint32_t max_interval{0};
+
+  bool is_active() const;
+  /// Whether the policy needs to be checked periodically, see is_due().
+  bool is_timed() const;
+  /// Whether value should be sent now, in which case state is updated to it.
+  bool check(SensorPublishState &state, float value, uint32_t now) const;
+  /// Whether a held back value or the heartbeat should be sent now, check() the current value if so.
+  bool is_due(const SensorPublishState &state, uint32_t now) const;
+};
+
+}  // namespace sensor
+
+ESPHOME_NAMESPACE_END
+
+#endif  // USE_SENSOR
+
+#endif  // ESPHOME_SENSOR_PUBLISH_POLICY_H
@@ -7,6 +7,12 @@
 #include "esphome/log.h"
 #include "esphome/esphal.h"
 #include "esphome/espmath.h"
+#include "esphome/helpers.h"
+#include "esphome/tracer.h"
+
+#ifdef ARDUINO_ARCH_ESP32
+#include <soc/pcnt_struct.h>
+#endif
 
 ESPHOME_NAMESPACE_BEGIN
 
@@ -14,6 +20,14 @@ namespace sensor {
 
 static const char *TAG = "sensor.pulse_counter";
 
+#ifdef ARDUINO_ARCH_ESP32
+static const int16_t PULSE_COUNTER_PCNT_HIGH_LIMIT = 32767;
+static const int16_t PULSE_COUNTER_PCNT_LOW_LIMIT = -32768;
+/// The counters by PCNT unit, for the shared interrupt.
+static PulseCounterBase *pcnt_units[PCNT_UNIT_MAX] = {nullptr};
+static bool pcnt_intr_registered = false;
+#endif
+
 PulseCounterBase::PulseCounterBase(GPIOPin *pin) : pin_(pin) {
 #ifdef ARDUINO_ARCH_ESP32
   this->pcnt_unit_ = next_pcnt_unit;
@@ -35,36 +49,62 @@ const char *EDGE_MODE_TO_STRING[] = {"DISABLE", "INCREMENT", "DECREMENT"};
 GPIOPin *PulseCounterBase::get_pin() { return this->pin_; }
 
 #ifdef ARDUINO_ARCH_ESP8266
-void ICACHE_RAM_ATTR PulseCounterBase::gpio_intr(PulseCounterBase *arg) {
-  const uint32_t now = micros();
-  const bool discard = now - arg->last_pulse_ < arg->filter_us_;
+void ICACHE_RAM_ATTR HOT PulseCounterBase::gpio_intr(PulseCounterBase *arg) {
+  const uint32_t now = ESP.getCycleCount();
+  TRACE_BEGIN(ISR, "pulse_counter");
+  const bool discard = now - arg->last_pulse_ < arg->filter_cycles_;
   arg->last_pulse_ = now;
-  if (discard)
-    return;
-
-  PulseCounterCountMode mode = arg->isr_pin_->digital_read() ? arg->rising_edge_mode_ : arg->falling_edge_mode_;
-  switch (mode) {
-    case PULSE_COUNTER_DISABLE:
-      break;
-    case PULSE_COUNTER_INCREMENT:
-      arg->counter_++;
-      break;
-    case PULSE_COUNTER_DECREMENT:
-      arg->counter_--;
-      break;
+  if (!discard) {
+    PulseCounterCountMode mode = arg->isr_pin_->digital_read() ? arg->rising_edge_mode_ : arg->falling_edge_mode_;
+    switch (mode) {
+      case PULSE_COUNTER_DISABLE:
+        break;
+      case PULSE_COUNTER_INCREMENT:
+        arg->counter_++;
+        break;
+      case PULSE_COUNTER_DECREMENT:
+        arg->counter_--;
+        break;
+    }
   }
+  TRACE_END(ISR, "pulse_counter");
+}
+void ICACHE_RAM_ATTR HOT PulseCounterBase::gpio_intr_single_edge(PulseCounterBase *arg) {
+  const uint32_t now = ESP.getCycleCount();
+  TRACE_BEGIN(ISR, "pulse_counter");
+  const bool discard = now - arg->last_pulse_ < arg->filter_cycles_;
+  arg->last_pulse_ = now;
+  if (!discard)
+    arg->counter_ += arg->single_edge_step_;
+  TRACE_END(ISR, "pulse_counter");
 }
 bool PulseCounterBase::pulse_counter_setup() {
   this->pin_->setup();
   this->isr_pin_ = this->pin_->to_isr();
-  this->pin_->attach_interrupt(PulseCounterBase::gpio_intr, this, CHANGE);
+  this->filter_cycles_ = this->filter_us_ * ESP.getCpuFreqMHz();
+
+  const bool rising = this->rising_edge_mode_ != PULSE_COUNTER_DISABLE;
+  const bool falling = this->falling_edge_mode_ != PULSE_COUNTER_DISABLE;
+  if (rising && falling && this->rising_edge_mode_ != this->falling_edge_mode_) {
+    this->pin_->attach_interrupt(PulseCounterBase::gpio_intr, this, CHANGE);
+    return true;
+  }
+  if (!rising && !falling)
+    return true;
+
+  // all counted edges count the same way, the interrupt doesn't need to read the pin
+  const PulseCounterCountMode mode = rising ? this->rising_edge_mode_ : this->falling_edge_mode_;
+  this->single_edge_step_ = mode == PULSE_COUNTER_INCREMENT ? 1 : -1;
+  const int edges = rising && falling ? CHANGE : (rising ? RISING : FALLING);
+  this->pin_->attach_interrupt(PulseCounterBase::gpio_intr_single_edge, this, edges);
   return true;
 }
-pulse_counter_t PulseCounterBase::read_raw_value() {
-  pulse_counter_t counter = this->counter_;
-  pulse_counter_t ret = counter - this->last_value_;
-  this->last_value_ = counter;
-  return ret;
+int64_t PulseCounterBase::get_total() {
+  const uint32_t counter = this->counter_;
+  // wrapping difference, the counter is read much more often than every 2^31 pulses
+  this->total_ += int32_t(counter - this->last_counter_);
+  this->last_counter_ = counter;
+  return this->total_;
 }
 #endif
 
@@ -103,8 +143,8 @@ bool PulseCounterBase::pulse_counter_setup() {
       .hctrl_mode = PCNT_MODE_KEEP,
       .pos_mode = rising,
       .neg_mode = falling,
-      .counter_h_lim = 0,
-      .counter_l_lim = 0,
+      .counter_h_lim = PULSE_COUNTER_PCNT_HIGH_LIMIT,
+      .counter_l_lim = PULSE_COUNTER_PCNT_LOW_LIMIT,
       .unit = this->pcnt_unit_,
       .channel = PCNT_CHANNEL_0,
   };
@@ -129,6 +169,19 @@ bool PulseCounterBase::pulse_counter_setup() {
     }
   }
 
+  pcnt_units[this->pcnt_unit_] = this;
+  if (!pcnt_intr_registered) {
+    error = pcnt_isr_register(PulseCounterBase::pcnt_intr, nullptr, 0, nullptr);
+    if (error != ESP_OK) {
+      ESP_LOGE(TAG, "Registering pulse counter interrupt failed: %s", esp_err_to_name(error));
+      return false;
+    }
+    pcnt_intr_registered = true;
+  }
+  pcnt_event_enable(this->pcnt_unit_, PCNT_EVT_H_LIM);
+  pcnt_event_enable(this->pcnt_unit_, PCNT_EVT_L_LIM);
+  pcnt_intr_enable(this->pcnt_unit_);
+
   error = pcnt_counter_pause(this->pcnt_unit_);
   if (error != ESP_OK) {
     ESP_LOGE(TAG, "Pausing pulse counter failed: %s", esp_err_to_name(error));
@@ -146,14 +199,58 @@ bool PulseCounterBase::pulse_counter_setup() {
   }
   return true;
 }
+void IRAM_ATTR HOT PulseCounterBase::pcnt_intr(void *arg) {
+  const uint32_t status = PCNT.int_st.val;
+  for (uint8_t unit = 0; unit < PCNT_UNIT_MAX; unit++) {
+    if ((status & BIT(unit)) == 0)
+      continue;
+    const uint32_t unit_status = PCNT.status_unit[unit].val;
+    PCNT.int_clr.val = BIT(unit);
+    PulseCounterBase *counter = pcnt_units[unit];
+    if (counter == nullptr)
+      continue;
+    // the counter has been reset to 0 at the limit
+    if (unit_status & PCNT_STATUS_H_LIM_M)
+      counter->overflow_ += PULSE_COUNTER_PCNT_HIGH_LIMIT;
+    if (unit_status & PCNT_STATUS_L_LIM_M)
+      counter->overflow_ += PULSE_COUNTER_PCNT_LOW_LIMIT;
+  }
+}
+int64_t PulseCounterBase::get_total() {
+  // The interrupt runs on this core, so with interrupts disabled overflow_ can't change. The hardware can still
+  // reset the counter in the meantime, which is seen as a pending interrupt, so retry until it's consistent.
+  int16_t counter;
+  int64_t overflow;
+  while (true) {
+    disable_interrupts();
+    const bool pending_before = PCNT.int_st.val & BIT(this->pcnt_unit_);
+    pcnt_get_counter_value(this->pcnt_unit_, &counter);
+    const bool pending_after = PCNT.int_st.val & BIT(this->pcnt_unit_);
+    const uint32_t unit_status = PCNT.status_unit[this->pcnt_unit_].val;
+    overflow = this->overflow_;
+    enable_interrupts();
+    if (pending_before != pending_after)
+      continue;
+    if (pending_after) {
+      // reset at a limit but not counted by the interrupt yet
+      if (unit_status & PCNT_STATUS_H_LIM_M)
+        overflow += PULSE_COUNTER_PCNT_HIGH_LIMIT;
+      if (unit_status & PCNT_STATUS_L_LIM_M)
+        overflow += PULSE_COUNTER_PCNT_LOW_LIMIT;
+    }
+    break;
+  }
+  this->total_ = overflow + counter;
+  return this->total_;
+}
+#endif
+
 pulse_counter_t PulseCounterBase::read_raw_value() {
-  pulse_counter_t counter;
-  pcnt_get_counter_value(this->pcnt_unit_, &counter);
-  pulse_counter_t ret = counter - this->last_value_;
-  this->last_value_ = counter;
+  const int64_t total = this->get_total();
+  auto ret = pulse_counter_t(total - this->last_total_);
+  this->last_total_ = total;
   return ret;
 }
-#endif
 
 void PulseCounterSensorComponent::setup() {
   ESP_LOGCONFIG(TAG, "Setting up pulse counter '%s'...", this->name_.c_str());
@@ -169,6 +266,7 @@ void PulseCounterSensorComponent::dump_config() {
   ESP_LOGCONFIG(TAG, "  Rising Edge: %s", EDGE_MODE_TO_STRING[this->rising_edge_mode_]);
   ESP_LOGCONFIG(TAG, "  Falling Edge: %s", EDGE_MODE_TO_STRING[this->falling_edge_mode_]);
   ESP_LOGCONFIG(TAG, "  Filtering pulses shorter than %u µs", this->filter_us_);
+  LOG_SENSOR("  ", "Total", this->total_sensor_);
 }
 
 void PulseCounterSensorComponent::update() {
@@ -177,11 +275,18 @@ void PulseCounterSensorComponent::update() {
 
   ESP_LOGD(TAG, "'%s': Retrieved counter: %0.2f pulses/min", this->get_name().c_str(), value);
   this->publish_state(value);
+
+  if (this->total_sensor_ != nullptr)
+    this->total_sensor_->publish_state(float(this->total_));
+}
+PulseCounterTotalSensor *PulseCounterSensorComponent::make_total_sensor(const std::string &name) {
+  return this->total_sensor_ = new PulseCounterTotalSensor(name);
 }
 
 float PulseCounterSensorComponent::get_setup_priority() const { return setup_priority::HARDWARE_LATE; }
-std::string PulseCounterSensorComponent::unit_of_measurement() { return "pulses/min"; }
-std::string PulseCounterSensorComponent::icon() { return "mdi:pulse"; }
+uint32_t PulseCounterSensorComponent::get_loop_idle_time() { return SCHEDULER_DONT_RUN; }
+const char *PulseCounterSensorComponent::unit_of_measurement() { return "pulses/min"; }
+const char *PulseCounterSensorComponent::icon() { return "mdi:pulse"; }
 int8_t PulseCounterSensorComponent::accuracy_decimals() { return 2; }
 void PulseCounterSensorComponent::set_filter_us(uint32_t filter_us) { this->filter_us_ = filter_us; }
 
@@ -22,26 +22,42 @@ enum PulseCounterCountMode {
   PULSE_COUNTER_DECREMENT,
 };
 
-#ifdef ARDUINO_ARCH_ESP32
-using pulse_counter_t = int16_t;
-#endif
-#ifdef ARDUINO_ARCH_ESP8266
+/// The pulses counted between two reads.
 using pulse_counter_t = int32_t;
-#endif
 
+/** Counts pulses on a pin into a 64-bit total.
+ *
+ * On the ESP32 the PCNT peripheral counts in hardware. Its 16-bit counter raises an interrupt when it reaches
+ * one of its limits and resets, the interrupt adds the limit to the total so no pulses are lost between reads.
+ * On the ESP8266 an interrupt counts the edges into a 32-bit counter, which read_raw_value() adds to the total.
+ */
 class PulseCounterBase {
  public:
   PulseCounterBase(GPIOPin *pin);
   bool pulse_counter_setup();
+  /// The pulses counted since the last call.
   pulse_counter_t read_raw_value();
+  /// All pulses counted since setup.
+  int64_t get_total();
 
   GPIOPin *get_pin();
 
  protected:
 #ifdef ARDUINO_ARCH_ESP8266
   static void gpio_intr(PulseCounterBase *arg);
-  volatile pulse_counter_t counter_{0};
+  /// Version of the interrupt for a single counted edge, which doesn't need to read the pin.
+  static void gpio_intr_single_edge(PulseCounterBase *arg);
+  volatile uint32_t counter_{0};
   volatile uint32_t last_pulse_{0};
+  /// filter_us_ in CPU cycles, the interrupt uses the cycle counter since it's much faster than micros().
+  uint32_t filter_cycles_{0};
+  /// The count of the single edge interrupt, +1 or -1.
+  int32_t single_edge_step_{1};
+#endif
+#ifdef ARDUINO_ARCH_ESP32
+  static void pcnt_intr(void *arg);
+  /// The pulses from counter resets at the limits, only written by the interrupt.
+  volatile int64_t overflow_{0};
 #endif
 
   GPIOPin *pin_;
@@ -50,13 +66,18 @@ class PulseCounterBase {
 #endif
 #ifdef ARDUINO_ARCH_ESP8266
   ISRInternalGPIOPin *isr_pin_;
+  /// The value of counter_ the total was last updated at.
+  uint32_t last_counter_{0};
 #endif
   PulseCounterCountMode rising_edge_mode_{PULSE_COUNTER_INCREMENT};
   PulseCounterCountMode falling_edge_mode_{PULSE_COUNTER_DISABLE};
   uint32_t filter_us_{13};
-  pulse_counter_t last_value_{0};
+  int64_t total_{0};
+  int64_t last_total_{0};
 };
 
+using PulseCounterTotalSensor = EmptySensor<0, ICON_PULSE, UNIT_PULSES>;
+
 /** Pulse Counter - This is the sensor component for the ESP32 integrated pulse counter peripheral.
  *
  * It offers 8 pulse counter units that can be setup in several ways to count pulses on a pin.
@@ -83,18 +104,30 @@ class PulseCounterSensorComponent : public PollingSensorComponent, public PulseC
   /// Set the PulseCounterCountMode for the rising and falling edges. can be disable, increment and decrement.
   void set_edge_mode(PulseCounterCountMode rising_edge_mode, PulseCounterCountMode falling_edge_mode);
 
+  /** Ignore pulses shorter than filter_us.
+   *
+   * On the ESP32 this is the PCNT glitch filter, which can filter pulses up to about 12.7µs. On the ESP8266
+   * edges that follow the previous one within this time are dropped.
+   */
   void set_filter_us(uint32_t filter_us);
 
+  /// Also publish the total count of pulses since boot on every update.
+  PulseCounterTotalSensor *make_total_sensor(const std::string &name);
+
   // ========== INTERNAL METHODS ==========
   // (In most use cases you won't need these)
   /// Unit of measurement is "pulses/min".
-  std::string unit_of_measurement() override;
-  std::string icon() override;
+  const char *unit_of_measurement() override;
+  const char *icon() override;
   int8_t accuracy_decimals() override;
   void setup() override;
   void update() override;
+  uint32_t get_loop_idle_time() override;
   float get_setup_priority() const override;
   void dump_config() override;
+
+ protected:
+  PulseCounterTotalSensor *total_sensor_{nullptr};
 };
 
 #ifdef ARDUINO_ARCH_ESP32
@@ -2,15 +2,25 @@
 
 #ifdef USE_ROTARY_ENCODER_SENSOR
 
+#include <algorithm>
 #include "esphome/sensor/rotary_encoder.h"
 #include "esphome/log.h"
 
+#ifdef ARDUINO_ARCH_ESP32
+#include <soc/pcnt_struct.h>
+#endif
+
 ESPHOME_NAMESPACE_BEGIN
 
 namespace sensor {
 
 static const char *TAG = "sensor.rotary_encoder";
 
+#ifdef ARDUINO_ARCH_ESP32
+static const int16_t ROTARY_ENCODER_PCNT_HIGH_LIMIT = 32767;
+static const int16_t ROTARY_ENCODER_PCNT_LOW_LIMIT = -32767;
+#endif
+
 // based on https://github.com/jkDesignDE/MechInputs/blob/master/QEIx4.cpp
 static const uint8_t STATE_LUT_MASK = 0x1C;  // clears upper counter increment/decrement bits and pin states
 static const uint16_t STATE_PIN_A_HIGH = 0x01;
@@ -80,25 +90,26 @@ static const uint16_t STATE_LOOKUP_TABLE[32] = {
     STATE_CW | STATE_S3                                // 0x1F: stay here
 };
 
+// Entries of RotaryEncoderSensorStore::table: the next state (STATE_LUT_MASK) and whether to count
+static const uint8_t TABLE_INCREMENT = 0x20;
+static const uint8_t TABLE_DECREMENT = 0x40;
+
 void ICACHE_RAM_ATTR HOT RotaryEncoderSensorStore::gpio_intr(RotaryEncoderSensorStore *arg) {
-  // Forget upper bits and add pin states
-  uint8_t input_state = arg->state & STATE_LUT_MASK;
+  uint8_t input_state = arg->state;
   if (arg->pin_a->digital_read())
     input_state |= STATE_PIN_A_HIGH;
   if (arg->pin_b->digital_read())
     input_state |= STATE_PIN_B_HIGH;
 
-  uint16_t new_state = STATE_LOOKUP_TABLE[input_state];
-  if ((new_state & arg->resolution & STATE_HAS_INCREMENTED) != 0) {
+  const uint8_t entry = arg->table[input_state];
+  if (entry & TABLE_INCREMENT) {
     if (arg->counter < arg->max_value)
       arg->counter++;
-  }
-  if ((new_state & arg->resolution & STATE_HAS_DECREMENTED) != 0) {
+  } else if (entry & TABLE_DECREMENT) {
     if (arg->counter > arg->min_value)
       arg->counter--;
   }
-
-  arg->state = new_state;
+  arg->state = entry & STATE_LUT_MASK;
 }
 RotaryEncoderSensor::RotaryEncoderSensor(const std::string &name, GPIOPin *pin_a, GPIOPin *pin_b)
     : Sensor(name), Component(), pin_a_(pin_a), pin_b_(pin_b) {}
@@ -106,22 +117,128 @@ RotaryEncoderSensor::RotaryEncoderSensor(const std::string &name, GPIOPin *pin_a
 void RotaryEncoderSensor::setup() {
   ESP_LOGCONFIG(TAG, "Setting up Rotary Encoder '%s'...", this->name_.c_str());
   this->pin_a_->setup();
-  this->store_.pin_a = this->pin_a_->to_isr();
-  this->pin_a_->attach_interrupt(RotaryEncoderSensorStore::gpio_intr, &this->store_, CHANGE);
-
   this->pin_b_->setup();
+  if (this->pin_i_ != nullptr) {
+    this->pin_i_->setup();
+  }
+
+#ifdef ARDUINO_ARCH_ESP32
+  this->pcnt_unit_ = next_pcnt_unit;
+  next_pcnt_unit = pcnt_unit_t(int(next_pcnt_unit) + 1);  // NOLINT
+  if (!this->pcnt_setup_()) {
+    this->mark_failed();
+    return;
+  }
+#else
+  for (uint8_t i = 0; i < 32; i++) {
+    const uint16_t entry = STATE_LOOKUP_TABLE[i];
+    uint8_t value = entry & STATE_LUT_MASK;
+    if (entry & this->store_.resolution & STATE_HAS_INCREMENTED)
+      value |= TABLE_INCREMENT;
+    if (entry & this->store_.resolution & STATE_HAS_DECREMENTED)
+      value |= TABLE_DECREMENT;
+    this->store_.table[i] = value;
+  }
+  this->store_.pin_a = this->pin_a_->to_isr();
   this->store_.pin_b = this->pin_b_->to_isr();
+  this->pin_a_->attach_interrupt(RotaryEncoderSensorStore::gpio_intr, &this->store_, CHANGE);
   this->pin_b_->attach_interrupt(RotaryEncoderSensorStore::gpio_intr, &this->store_, CHANGE);
+#endif
+}
 
-  if (this->pin_i_ != nullptr) {
-    this->pin_i_->setup();
+#ifdef ARDUINO_ARCH_ESP32
+bool RotaryEncoderSensor::pcnt_setup_() {
+  // x4 decoding: each channel counts both edges of one pin, the level of the other pin gives the direction
+  pcnt_config_t config_a = {
+      .pulse_gpio_num = this->pin_a_->get_pin(),
+      .ctrl_gpio_num = this->pin_b_->get_pin(),
+      .lctrl_mode = PCNT_MODE_KEEP,
+      .hctrl_mode = PCNT_MODE_REVERSE,
+      .pos_mode = PCNT_COUNT_INC,
+      .neg_mode = PCNT_COUNT_DEC,
+      .counter_h_lim = ROTARY_ENCODER_PCNT_HIGH_LIMIT,
+      .counter_l_lim = ROTARY_ENCODER_PCNT_LOW_LIMIT,
+      .unit = this->pcnt_unit_,
+      .channel = PCNT_CHANNEL_0,
+  };
+  pcnt_config_t config_b = {
+      .pulse_gpio_num = this->pin_b_->get_pin(),
+      .ctrl_gpio_num = this->pin_a_->get_pin(),
+      .lctrl_mode = PCNT_MODE_REVERSE,
+      .hctrl_mode = PCNT_MODE_KEEP,
+      .pos_mode = PCNT_COUNT_INC,
+      .neg_mode = PCNT_COUNT_DEC,
+      .counter_h_lim = ROTARY_ENCODER_PCNT_HIGH_LIMIT,
+      .counter_l_lim = ROTARY_ENCODER_PCNT_LOW_LIMIT,
+      .unit = this->pcnt_unit_,
+      .channel = PCNT_CHANNEL_1,
+  };
+  esp_err_t error = pcnt_unit_config(&config_a);
+  if (error == ESP_OK)
+    error = pcnt_unit_config(&config_b);
+  if (error != ESP_OK) {
+    ESP_LOGE(TAG, "Configuring PCNT failed: %s", esp_err_to_name(error));
+    return false;
+  }
+
+  if (this->filter_us_ != 0) {
+    uint16_t filter_val = std::min(this->filter_us_ * 80u, 1023u);
+    error = pcnt_set_filter_value(this->pcnt_unit_, filter_val);
+    if (error == ESP_OK)
+      error = pcnt_filter_enable(this->pcnt_unit_);
+    if (error != ESP_OK) {
+      ESP_LOGE(TAG, "Setting up the PCNT filter failed: %s", esp_err_to_name(error));
+      return false;
+    }
+  }
+
+  // The limit events are only polled in loop(), the interrupt stays disabled. Even the fastest encoders take far
+  // longer than one loop iteration to count to the limit.
+  pcnt_event_enable(this->pcnt_unit_, PCNT_EVT_H_LIM);
+  pcnt_event_enable(this->pcnt_unit_, PCNT_EVT_L_LIM);
+  pcnt_counter_pause(this->pcnt_unit_);
+  pcnt_counter_clear(this->pcnt_unit_);
+  error = pcnt_counter_resume(this->pcnt_unit_);
+  if (error != ESP_OK) {
+    ESP_LOGE(TAG, "Starting PCNT failed: %s", esp_err_to_name(error));
+    return false;
   }
+  return true;
 }
+int64_t RotaryEncoderSensor::read_pcnt_total_() {
+  const uint32_t mask = BIT(this->pcnt_unit_);
+  int16_t count;
+  while (true) {
+    const uint32_t pending_before = PCNT.int_raw.val & mask;
+    pcnt_get_counter_value(this->pcnt_unit_, &count);
+    const uint32_t pending_after = PCNT.int_raw.val & mask;
+    const uint32_t unit_status = PCNT.status_unit[this->pcnt_unit_].val;
+    if (pending_before != pending_after)
+      // reset at a limit while reading
+      continue;
+    if (pending_after) {
+      // the counter has been reset to 0 at the limit
+      if (unit_status & PCNT_STATUS_H_LIM_M)
+        this->pcnt_overflow_ += ROTARY_ENCODER_PCNT_HIGH_LIMIT;
+      if (unit_status & PCNT_STATUS_L_LIM_M)
+        this->pcnt_overflow_ += ROTARY_ENCODER_PCNT_LOW_LIMIT;
+      PCNT.int_clr.val = mask;
+    }
+    break;
+  }
+  return this->pcnt_overflow_ + count;
+}
+#endif
 void RotaryEncoderSensor::dump_config() {
   LOG_SENSOR("", "Rotary Encoder", this);
   LOG_PIN("  Pin A: ", this->pin_a_);
   LOG_PIN("  Pin B: ", this->pin_b_);
   LOG_PIN("  Pin I: ", this->pin_i_);
+#ifdef ARDUINO_ARCH_ESP32
+  ESP_LOGCONFIG(TAG, "  PCNT Unit Number: %u", this->pcnt_unit_);
+  ESP_LOGCONFIG(TAG, "  Filter: %u us", this->filter_us_);
+#endif
+  ESP_LOGCONFIG(TAG, "  Publish Interval: %u ms", this->publish_interval_);
   switch (this->store_.resolution) {
     case ROTARY_ENCODER_1_PULSE_PER_CYCLE:
       ESP_LOGCONFIG(TAG, "  Resolution: 1 Pulse Per Cycle");
@@ -135,17 +252,47 @@ void RotaryEncoderSensor::dump_config() {
   }
 }
 void RotaryEncoderSensor::loop() {
+#ifdef ARDUINO_ARCH_ESP32
+  // the hardware counts 4 edges per cycle, 1 pulse per cycle uses every 4th
+  uint8_t shift = 0;
+  switch (this->store_.resolution) {
+    case ROTARY_ENCODER_1_PULSE_PER_CYCLE:
+      shift = 2;
+      break;
+    case ROTARY_ENCODER_2_PULSES_PER_CYCLE:
+      shift = 1;
+      break;
+    case ROTARY_ENCODER_4_PULSES_PER_CYCLE:
+      shift = 0;
+      break;
+  }
+  const int64_t steps = this->read_pcnt_total_() >> shift;
+  if (steps != this->pcnt_last_steps_) {
+    int64_t counter = int64_t(this->store_.counter) + (steps - this->pcnt_last_steps_);
+    this->pcnt_last_steps_ = steps;
+    if (counter < this->store_.min_value)
+      counter = this->store_.min_value;
+    if (counter > this->store_.max_value)
+      counter = this->store_.max_value;
+    this->store_.counter = counter;
+  }
+#endif
   if (this->pin_i_ != nullptr && this->pin_i_->digital_read()) {
     this->store_.counter = 0;
   }
-  int counter = this->store_.counter;
-  if (this->store_.last_read != counter) {
-    this->store_.last_read = counter;
-    this->publish_state(counter);
-  }
+  const int32_t counter = this->store_.counter;
+  if (this->store_.last_read == counter)
+    return;
+  // while the encoder is turned only every publish interval, the final position once the interval has passed
+  const uint32_t now = millis();
+  if (now - this->last_publish_ < this->publish_interval_)
+    return;
+  this->last_publish_ = now;
+  this->store_.last_read = counter;
+  this->publish_state(counter);
 }
-std::string RotaryEncoderSensor::unit_of_measurement() { return "steps"; }
-std::string RotaryEncoderSensor::icon() { return "mdi:rotate-right"; }
+const char *RotaryEncoderSensor::unit_of_measurement() { return "steps"; }
+const char *RotaryEncoderSensor::icon() { return "mdi:rotate-right"; }
 int8_t RotaryEncoderSensor::accuracy_decimals() { return 0; }
 void RotaryEncoderSensor::set_reset_pin(const GPIOInputPin &pin_i) { this->pin_i_ = pin_i.copy(); }
 
@@ -153,6 +300,10 @@ float RotaryEncoderSensor::get_setup_priority() const { return setup_priority::H
 void RotaryEncoderSensor::set_resolution(RotaryEncoderResolution mode) { this->store_.resolution = mode; }
 void RotaryEncoderSensor::set_min_value(int32_t min_value) { this->store_.min_value = min_value; }
 void RotaryEncoderSensor::set_max_value(int32_t max_value) { this->store_.max_value = max_value; }
+void RotaryEncoderSensor::set_publish_interval(uint32_t publish_interval) {
+  this->publish_interval_ = publish_interval;
+}
+void RotaryEncoderSensor::set_filter_us(uint32_t filter_us) { this->filter_us_ = filter_us; }
 
 }  // namespace sensor
 
@@ -10,6 +10,10 @@
 #include "esphome/sensor/sensor.h"
 #include "esphome/esphal.h"
 
+#ifdef ARDUINO_ARCH_ESP32
+#include "esphome/sensor/pulse_counter.h"
+#endif
+
 ESPHOME_NAMESPACE_BEGIN
 
 namespace sensor {
@@ -32,10 +36,20 @@ struct RotaryEncoderSensorStore {
   int32_t max_value{INT32_MAX};
   int32_t last_read{0};
   uint8_t state{0};
+  /// The state table for the resolution, built in setup() so the interrupt only needs one lookup per edge.
+  uint8_t table[32];
 
   static void gpio_intr(RotaryEncoderSensorStore *arg);
 };
 
+/** Count the steps of a quadrature rotary encoder.
+ *
+ * On the ESP32 the PCNT peripheral decodes both channels in hardware (every edge of A and B, direction by the level
+ * of the other pin) with its glitch filter. Its 16-bit counter is extended to 64 bits in loop(), so no interrupts
+ * run at all. On the ESP8266 both pins trigger an interrupt on every edge that advances a state table.
+ *
+ * The position is published at most once per publish interval, the last position is always published.
+ */
 class RotaryEncoderSensor : public Sensor, public Component {
  public:
   RotaryEncoderSensor(const std::string &name, GPIOPin *pin_a, GPIOPin *pin_b);
@@ -52,14 +66,18 @@ class RotaryEncoderSensor : public Sensor, public Component {
   void set_reset_pin(const GPIOInputPin &pin_i);
   void set_min_value(int32_t min_value);
   void set_max_value(int32_t max_value);
+  /// Publish the position at most every this many ms while the encoder is turned (default 50ms), 0 for every step.
+  void set_publish_interval(uint32_t publish_interval);
+  /// ESP32 only: ignore pulses shorter than this many µs (default 10µs, at most about 12.7µs).
+  void set_filter_us(uint32_t filter_us);
 
   // ========== INTERNAL METHODS ==========
   // (In most use cases you won't need these)
   void setup() override;
   void dump_config() override;
   void loop() override;
-  std::string unit_of_measurement() override;
-  std::string icon() override;
+  const char *unit_of_measurement() override;
+  const char *icon() override;
   int8_t accuracy_decimals() override;
 
   float get_setup_priority() const override;
@@ -69,7 +87,21 @@ class RotaryEncoderSensor : public Sensor, public Component {
   GPIOPin *pin_b_;
   GPIOPin *pin_i_{nullptr};  /// Index pin, if this is not nullptr, the counter will reset to 0 once this pin is HIGH.
 
+#ifdef ARDUINO_ARCH_ESP32
+  bool pcnt_setup_();
+  /// The hardware count including the wraps at the limits.
+  int64_t read_pcnt_total_();
+
+  pcnt_unit_t pcnt_unit_;
+  int64_t pcnt_overflow_{0};
+  /// The steps that have been applied to the counter.
+  int64_t pcnt_last_steps_{0};
+#endif
+
   RotaryEncoderSensorStore store_{};
+  uint32_t publish_interval_{50};
+  uint32_t last_publish_{0};
+  uint32_t filter_us_{10};
 };
 
 }  // namespace sensor
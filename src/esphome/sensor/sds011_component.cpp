@@ -36,9 +36,20 @@ static const uint8_t SDS011_MODE_SLEEP = 0x00;
 static const uint8_t SDS011_MODE_WORK = 0x01;
 
 SDS011Component::SDS011Component(UARTComponent *parent, uint8_t update_interval_min, bool rx_mode_only)
-    : UARTDevice(parent), update_interval_min_(update_interval_min), rx_mode_only_(rx_mode_only) {}
+    : UARTDevice(parent),
+      parser_(SDS011_MSG_RESPONSE_LENGTH),
+      update_interval_min_(update_interval_min),
+      rx_mode_only_(rx_mode_only) {}
 
 void SDS011Component::setup() {
+  this->parser_.set_header({SDS011_MSG_HEAD, SDS011_COMMAND_ID_DATA});
+  this->parser_.set_fixed_length(SDS011_MSG_RESPONSE_LENGTH);
+  this->parser_.set_validator([this](const uint8_t *frame, size_t len) { return this->check_frame_(frame); });
+  this->parser_.set_on_frame([this](const uint8_t *frame, size_t len) { this->parse_data_(frame); });
+  this->add_frame_parser(&this->parser_);
+  // the UART calls us once data has arrived
+  this->disable_loop();
+
   if (this->rx_mode_only_) {
     // In RX-only mode we do not setup the sensor, it is assumed to be setup
     // already
@@ -64,41 +75,11 @@ void SDS011Component::dump_config() {
   ESP_LOGCONFIG(TAG, "SDS011:");
   ESP_LOGCONFIG(TAG, "  Update Interval: %u min", this->update_interval_min_);
   ESP_LOGCONFIG(TAG, "  RX-only mode: %s", ONOFF(this->rx_mode_only_));
+  ESP_LOGCONFIG(TAG, "  Duty Cycle: %s", YESNO(this->duty_cycle_ != nullptr));
   LOG_SENSOR("  ", "PM2.5", this->pm_2_5_sensor_);
   LOG_SENSOR("  ", "PM10.0", this->pm_10_0_sensor_);
 }
 
-void SDS011Component::loop() {
-  const uint32_t now = millis();
-  if ((now - this->last_transmission_ >= 500) && this->data_index_) {
-    // last transmission too long ago. Reset RX index.
-    ESP_LOGV(TAG, "Last transmission too long ago. Reset RX index.");
-    this->data_index_ = 0;
-  }
-
-  if (this->available() == 0) {
-    return;
-  }
-
-  this->last_transmission_ = now;
-  while (this->available() != 0) {
-    this->read_byte(&this->data_[this->data_index_]);
-    auto check = this->check_byte_();
-    if (!check.has_value()) {
-      // finished
-      this->parse_data_();
-      this->data_index_ = 0;
-    } else if (!*check) {
-      // wrong data
-      ESP_LOGV(TAG, "Byte %i of received data frame is invalid.", this->data_index_);
-      this->data_index_ = 0;
-    } else {
-      // next byte
-      this->data_index_++;
-    }
-  }
-}
-
 SDS011Sensor *SDS011Component::make_pm_2_5_sensor(const std::string &name) {
   return this->pm_2_5_sensor_ = new SDS011Sensor(name);
 }
@@ -130,45 +111,27 @@ uint8_t SDS011Component::sds011_checksum_(const uint8_t *command_data, uint8_t l
   return sum;
 }
 
-optional<bool> SDS011Component::check_byte_() const {
-  uint8_t index = this->data_index_;
-  uint8_t byte = this->data_[index];
-
-  if (index == 0) {
-    return byte == SDS011_MSG_HEAD;
-  }
-
-  if (index == 1) {
-    return byte == SDS011_COMMAND_ID_DATA;
+bool SDS011Component::check_frame_(const uint8_t *data) const {
+  // checksum is without checksum bytes
+  uint8_t checksum = sds011_checksum_(data + 2, SDS011_DATA_RESPONSE_LENGTH);
+  if (checksum != data[8]) {
+    ESP_LOGW(TAG, "SDS011 Checksum doesn't match: 0x%02X!=0x%02X", data[8], checksum);
+    return false;
   }
-
-  if ((index >= 2) && (index <= 7)) {
-    return true;
-  }
-
-  if (index == 8) {
-    // checksum is without checksum bytes
-    uint8_t checksum = sds011_checksum_(this->data_ + 2, SDS011_DATA_RESPONSE_LENGTH);
-    if (checksum != byte) {
-      ESP_LOGW(TAG, "SDS011 Checksum doesn't match: 0x%02X!=0x%02X", byte, checksum);
-      return false;
-    }
-    return true;
+  if (data[9] != SDS011_MSG_TAIL) {
+    ESP_LOGV(TAG, "Invalid tail byte 0x%02X of received data frame.", data[9]);
+    return false;
   }
-
-  if (index == 9) {
-    if (byte != SDS011_MSG_TAIL) {
-      return false;
-    }
-  }
-
-  return {};
+  return true;
 }
 
-void SDS011Component::parse_data_() {
+void SDS011Component::parse_data_(const uint8_t *data) {
+  if (this->duty_cycle_ != nullptr && !this->duty_cycle_->is_collecting())
+    // asleep or warming up
+    return;
   this->status_clear_warning();
-  const float pm_2_5_concentration = this->get_16_bit_uint_(2) / 10.0f;
-  const float pm_10_0_concentration = this->get_16_bit_uint_(4) / 10.0f;
+  const float pm_2_5_concentration = get_16_bit_uint_(data, 2) / 10.0f;
+  const float pm_10_0_concentration = get_16_bit_uint_(data, 4) / 10.0f;
 
   ESP_LOGD(TAG, "Got PM2.5 Concentration: %.1f µg/m³, PM10.0 Concentration: %.1f µg/m³", pm_2_5_concentration,
            pm_10_0_concentration);
@@ -176,6 +139,12 @@ void SDS011Component::parse_data_() {
     // not yet any valid data
     return;
   }
+  if (this->duty_cycle_ != nullptr) {
+    this->duty_cycle_->add_value(this->pm_2_5_sensor_, pm_2_5_concentration);
+    this->duty_cycle_->add_value(this->pm_10_0_sensor_, pm_10_0_concentration);
+    this->duty_cycle_->add_sample();
+    return;
+  }
   if (this->pm_2_5_sensor_ != nullptr) {
     this->pm_2_5_sensor_->publish_state(pm_2_5_concentration);
   }
@@ -184,12 +153,27 @@ void SDS011Component::parse_data_() {
   }
 }
 
-uint16_t SDS011Component::get_16_bit_uint_(uint8_t start_index) const {
-  return (uint16_t(this->data_[start_index + 1]) << 8) | uint16_t(this->data_[start_index]);
+uint16_t SDS011Component::get_16_bit_uint_(const uint8_t *data, uint8_t start_index) {
+  return (uint16_t(data[start_index + 1]) << 8) | uint16_t(data[start_index]);
 }
 void SDS011Component::set_update_interval_min(uint8_t update_interval_min) {
   this->update_interval_min_ = update_interval_min;
 }
+void SDS011Component::set_duty_cycle(SensorDutyCycle *duty_cycle) {
+  this->duty_cycle_ = duty_cycle;
+  duty_cycle->set_sleep_function([this](bool awake) { this->write_sleep_command_(awake); });
+}
+void SDS011Component::write_sleep_command_(bool awake) {
+  if (this->rx_mode_only_)
+    return;
+  uint8_t command_data[SDS011_DATA_REQUEST_LENGTH] = {0};
+  command_data[0] = SDS011_COMMAND_SLEEP;
+  command_data[1] = SDS011_SET_MODE;
+  command_data[2] = awake ? SDS011_MODE_WORK : SDS011_MODE_SLEEP;
+  command_data[13] = 0xff;
+  command_data[14] = 0xff;
+  this->sds011_write_command_(command_data);
+}
 
 }  // namespace sensor
 
@@ -7,6 +7,7 @@
 
 #include "esphome/component.h"
 #include "esphome/sensor/sensor.h"
+#include "esphome/sensor/sensor_duty_cycle.h"
 #include "esphome/uart_component.h"
 
 ESPHOME_NAMESPACE_BEGIN
@@ -28,11 +29,18 @@ class SDS011Component : public Component, public UARTDevice {
   /// Manually set the rx-only mode. Defaults to false.
   void set_rx_mode_only(bool rx_mode_only);
 
+  /** Only take readings every update interval of the duty cycle, the sensor sleeps in between.
+   *
+   * Unlike the working period of the sensor (see the update interval in minutes), the readings of each cycle are
+   * averaged, and the schedule is the one of the node. In RX-only mode, the sensor can only be switched with the
+   * power supply of the duty cycle.
+   */
+  void set_duty_cycle(SensorDutyCycle *duty_cycle);
+
   // ========== INTERNAL METHODS ==========
   // (In most use cases you won't need these)
   void setup() override;
   void dump_config() override;
-  void loop() override;
 
   float get_setup_priority() const override;
   SDS011Sensor *make_pm_2_5_sensor(const std::string &name);
@@ -44,17 +52,17 @@ class SDS011Component : public Component, public UARTDevice {
  protected:
   void sds011_write_command_(const uint8_t *command);
   uint8_t sds011_checksum_(const uint8_t *command_data, uint8_t length) const;
-  optional<bool> check_byte_() const;
-  void parse_data_();
-  uint16_t get_16_bit_uint_(uint8_t start_index) const;
+  bool check_frame_(const uint8_t *data) const;
+  void parse_data_(const uint8_t *data);
+  void write_sleep_command_(bool awake);
+  static uint16_t get_16_bit_uint_(const uint8_t *data, uint8_t start_index);
 
   SDS011Sensor *pm_2_5_sensor_{nullptr};
   SDS011Sensor *pm_10_0_sensor_{nullptr};
 
-  uint8_t data_[10];
-  uint8_t data_index_{0};
-  uint32_t last_transmission_{0};
+  UARTFrameParser parser_;
   uint8_t update_interval_min_;
+  SensorDutyCycle *duty_cycle_{nullptr};
 
   bool rx_mode_only_;
 };
@@ -2,6 +2,7 @@
 
 #ifdef USE_SENSOR
 
+#include <algorithm>
 #include <utility>
 #include "esphome/sensor/sensor.h"
 
@@ -26,8 +27,8 @@ void Sensor::publish_state(float state) {
   }
 }
 void Sensor::push_new_value(float state) { this->publish_state(state); }
-std::string Sensor::unit_of_measurement() { return ""; }
-std::string Sensor::icon() { return ""; }
+const char *Sensor::unit_of_measurement() { return ""; }
+const char *Sensor::icon() { return ""; }
 uint32_t Sensor::update_interval() { return 0; }
 int8_t Sensor::accuracy_decimals() { return 0; }
 Sensor::Sensor(const std::string &name) : Nameable(name), state(NAN), raw_state(NAN) {}
@@ -38,18 +39,14 @@ void Sensor::set_unit_of_measurement(const std::string &unit_of_measurement) {
 }
 void Sensor::set_icon(const std::string &icon) { this->icon_ = icon; }
 void Sensor::set_accuracy_decimals(int8_t accuracy_decimals) { this->accuracy_decimals_ = accuracy_decimals; }
-void Sensor::add_on_state_callback(std::function<void(float)> &&callback) { this->callback_.add(std::move(callback)); }
-void Sensor::add_on_raw_state_callback(std::function<void(float)> &&callback) {
-  this->raw_callback_.add(std::move(callback));
-}
-std::string Sensor::get_icon() {
+const char *Sensor::get_icon() {
   if (this->icon_.has_value())
-    return *this->icon_;
+    return this->icon_->c_str();
   return this->icon();
 }
-std::string Sensor::get_unit_of_measurement() {
+const char *Sensor::get_unit_of_measurement() {
   if (this->unit_of_measurement_.has_value())
-    return *this->unit_of_measurement_;
+    return this->unit_of_measurement_->c_str();
   return this->unit_of_measurement();
 }
 int8_t Sensor::get_accuracy_decimals() {
@@ -80,6 +77,7 @@ void Sensor::set_filters(const std::vector<Filter *> &filters) {
   this->clear_filters();
   this->add_filters(filters);
 }
+Filter *Sensor::get_filters() const { return this->filter_list_; }
 void Sensor::clear_filters() {
   if (this->filter_list_ != nullptr) {
     ESP_LOGVV(TAG, "Sensor(%p)::clear_filters()", this);
@@ -95,15 +93,24 @@ std::string Sensor::unique_id() { return ""; }
 void Sensor::internal_send_state_to_frontend(float state) {
   this->has_state_ = true;
   this->state = state;
+#ifdef ESPHOME_LOG_HAS_DEBUG
   if (this->filter_list_ != nullptr) {
-    ESP_LOGD(TAG, "'%s': Sending state %.5f %s with %d decimals of accuracy", this->get_name().c_str(), state,
-             this->get_unit_of_measurement().c_str(), this->get_accuracy_decimals());
+    char buf[VALUE_ACCURACY_MAX_LEN];
+    value_accuracy_to_buf(buf, state, this->get_accuracy_decimals());
+    ESP_LOGD(TAG, "'%s': Sending state %s %s with %d decimals of accuracy", this->get_name().c_str(), buf,
+             this->get_unit_of_measurement(), this->get_accuracy_decimals());
   }
+#endif
   this->callback_.call(state);
 }
 SensorStateTrigger *Sensor::make_state_trigger() { return new SensorStateTrigger(this); }
 SensorRawStateTrigger *Sensor::make_raw_state_trigger() { return new SensorRawStateTrigger(this); }
 ValueRangeTrigger *Sensor::make_value_range_trigger() { return new ValueRangeTrigger(this); }
+ValueRangeIndex *Sensor::get_value_range_index() {
+  if (this->value_range_index_ == nullptr)
+    this->value_range_index_ = new ValueRangeIndex(this);
+  return this->value_range_index_;
+}
 bool Sensor::has_state() const { return this->has_state_; }
 uint32_t Sensor::calculate_expected_filter_update_interval() {
   uint32_t interval = this->update_interval();
@@ -123,6 +130,10 @@ uint32_t Sensor::hash_base() { return 2455723294UL; }
 MQTTSensorComponent *Sensor::get_mqtt() const { return this->mqtt_; }
 void Sensor::set_mqtt(MQTTSensorComponent *mqtt) { this->mqtt_ = mqtt; }
 #endif
+#ifdef USE_SENSOR_HISTORY
+SensorHistory *Sensor::get_history() const { return this->history_; }
+void Sensor::set_history(SensorHistory *history) { this->history_ = history; }
+#endif
 
 PollingSensorComponent::PollingSensorComponent(const std::string &name, uint32_t update_interval)
     : PollingComponent(update_interval), Sensor(name) {}
@@ -160,6 +171,15 @@ const char UNIT_K[] = "K";
 const char UNIT_MICROSIEMENS_PER_CENTIMETER[] = "µS/cm";
 const char UNIT_MICROGRAMS_PER_CUBIC_METER[] = "µg/m³";
 const char ICON_CHEMICAL_WEAPON[] = "mdi:chemical-weapon";
+const char ICON_PULSE[] = "mdi:pulse";
+const char UNIT_PULSES[] = "pulses";
+const char UNIT_DECIBEL[] = "dB";
+const char ICON_MEMORY[] = "mdi:memory";
+const char ICON_TIMER[] = "mdi:timer";
+const char UNIT_BYTES[] = "B";
+const char UNIT_IAQ[] = "IAQ";
+const char UNIT_HZ[] = "Hz";
+const char UNIT_MS[] = "ms";
 
 SensorStateTrigger::SensorStateTrigger(Sensor *parent) {
   parent->add_on_state_callback([this](float value) { this->trigger(value); });
@@ -174,8 +194,8 @@ void ValueRangeTrigger::on_state_(float state) {
   if (isnan(state))
     return;
 
-  float local_min = this->min_.value(state);
-  float local_max = this->max_.value(state);
+  const float local_min = this->min_.value(state);
+  const float local_max = this->max_.value(state);
 
   bool in_range;
   if (isnan(local_min) && isnan(local_max)) {
@@ -188,7 +208,9 @@ void ValueRangeTrigger::on_state_(float state) {
     in_range = local_min <= state && state <= local_max;
   }
 
-  if (in_range != this->previous_in_range_ && in_range) {
+  if (in_range == this->previous_in_range_)
+    return;
+  if (in_range) {
     this->trigger(state);
   }
 
@@ -202,10 +224,60 @@ void ValueRangeTrigger::setup() {
     this->previous_in_range_ = initial_state;
   }
 
-  this->parent_->add_on_state_callback([this](float state) { this->on_state_(state); });
+  auto *index = this->parent_->get_value_range_index();
+  if (this->min_.is_lambda() || this->max_.is_lambda()) {
+    index->add_dynamic_range([this](float state) { this->on_state_(state); });
+  } else {
+    index->add_range(this->min_.value(NAN), this->max_.value(NAN), [this](float state) { this->on_state_(state); });
+  }
 }
 float ValueRangeTrigger::get_setup_priority() const { return setup_priority::HARDWARE; }
 
+ValueRangeIndex::ValueRangeIndex(Sensor *parent) {
+  parent->add_on_state_callback([this](float state) { this->on_state_(state); });
+}
+void ValueRangeIndex::add_range(float min, float max, std::function<void(float)> &&callback) {
+  const auto range = uint16_t(this->ranges_.size());
+  this->ranges_.push_back(Range{std::move(callback), 0});
+  for (float value : {min, max}) {
+    if (isnan(value))
+      continue;
+    auto it = std::upper_bound(this->boundaries_.begin(), this->boundaries_.end(), value,
+                               [](float value, const Boundary &boundary) { return value < boundary.value; });
+    this->boundaries_.insert(it, Boundary{value, range});
+  }
+}
+void ValueRangeIndex::add_dynamic_range(std::function<void(float)> &&callback) {
+  this->dynamic_ranges_.push_back(uint16_t(this->ranges_.size()));
+  this->ranges_.push_back(Range{std::move(callback), 0});
+}
+void ValueRangeIndex::on_state_(float state) {
+  const float previous = this->previous_state_;
+  this->previous_state_ = state;
+  if (isnan(previous) || isnan(state)) {
+    // nothing to compare with, the first state also has to sync the restored in range states
+    for (auto &range : this->ranges_)
+      range.callback(state);
+    return;
+  }
+
+  this->generation_++;
+  const float low = std::min(previous, state);
+  const float high = std::max(previous, state);
+  // the boundaries are inclusive, a state that reaches a boundary can change whether it's in range
+  auto it = std::lower_bound(this->boundaries_.begin(), this->boundaries_.end(), low,
+                             [](const Boundary &boundary, float value) { return boundary.value < value; });
+  for (; it != this->boundaries_.end() && it->value <= high; it++) {
+    auto &range = this->ranges_[it->range];
+    if (range.evaluated_at == this->generation_)
+      continue;
+    range.evaluated_at = this->generation_;
+    range.callback(state);
+  }
+  for (uint16_t index : this->dynamic_ranges_)
+    this->ranges_[index].callback(state);
+}
+
 }  // namespace sensor
 
 ESPHOME_NAMESPACE_END
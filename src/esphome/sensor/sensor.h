@@ -12,6 +12,7 @@
 #include "esphome/helpers.h"
 #include "esphome/automation.h"
 #include "esphome/sensor/filter.h"
+#include "esphome/sensor/publish_policy.h"
 
 ESPHOME_NAMESPACE_BEGIN
 
@@ -21,16 +22,17 @@ class MQTTSensorComponent;
 class SensorStateTrigger;
 class SensorRawStateTrigger;
 class ValueRangeTrigger;
+class ValueRangeIndex;
 template<typename... Ts> class SensorInRangeCondition;
 template<typename... Ts> class SensorPublishAction;
 
 #define LOG_SENSOR(prefix, type, obj) \
   if (obj != nullptr) { \
     ESP_LOGCONFIG(TAG, prefix type " '%s'", obj->get_name().c_str()); \
-    ESP_LOGCONFIG(TAG, prefix "  Unit of Measurement: '%s'", obj->get_unit_of_measurement().c_str()); \
+    ESP_LOGCONFIG(TAG, prefix "  Unit of Measurement: '%s'", obj->get_unit_of_measurement()); \
     ESP_LOGCONFIG(TAG, prefix "  Accuracy Decimals: %d", obj->get_accuracy_decimals()); \
-    if (!obj->get_icon().empty()) { \
-      ESP_LOGCONFIG(TAG, prefix "  Icon: '%s'", obj->get_icon().c_str()); \
+    if (obj->get_icon()[0] != '\0') { \
+      ESP_LOGCONFIG(TAG, prefix "  Icon: '%s'", obj->get_icon()); \
     } \
     if (!obj->unique_id().empty()) { \
       ESP_LOGV(TAG, prefix "  Unique ID: '%s'", obj->unique_id().c_str()); \
@@ -40,6 +42,9 @@ template<typename... Ts> class SensorPublishAction;
 #ifdef USE_MQTT_SENSOR
 class MQTTSensorComponent;
 #endif
+#ifdef USE_SENSOR_HISTORY
+class SensorHistory;
+#endif
 
 /** Base-class for all sensors.
  *
@@ -92,6 +97,9 @@ class Sensor : public Nameable {
   /// Clear the entire filter chain.
   void clear_filters();
 
+  /// The first filter of the filter chain, nullptr if there are no filters.
+  Filter *get_filters() const;
+
   /// Getter-syntax for .value. Please use .state instead.
   float get_value() const ESPDEPRECATED(".value is deprecated, please use .state");
   /// Getter-syntax for .state.
@@ -105,10 +113,10 @@ class Sensor : public Nameable {
   int8_t get_accuracy_decimals();
 
   /// Get the unit of measurement. Uses the manual override if specified or the default value instead.
-  std::string get_unit_of_measurement();
+  const char *get_unit_of_measurement();
 
   /// Get the Home Assistant Icon. Uses the manual override if specified or the default value instead.
-  std::string get_icon();
+  const char *get_icon();
 
   /** Publish a new state to the front-end.
    *
@@ -128,15 +136,17 @@ class Sensor : public Nameable {
   // ========== INTERNAL METHODS ==========
   // (In most use cases you won't need these)
   /// Add a callback that will be called every time a filtered value arrives.
-  void add_on_state_callback(std::function<void(float)> &&callback);
+  template<typename F> void add_on_state_callback(F &&callback);
   /// Add a callback that will be called every time the sensor sends a raw value.
-  void add_on_raw_state_callback(std::function<void(float)> &&callback);
+  template<typename F> void add_on_raw_state_callback(F &&callback);
 
   SensorStateTrigger *make_state_trigger();
   SensorRawStateTrigger *make_raw_state_trigger();
   ValueRangeTrigger *make_value_range_trigger();
   template<typename... Ts> SensorInRangeCondition<Ts...> *make_sensor_in_range_condition();
   template<typename... Ts> SensorPublishAction<Ts...> *make_sensor_publish_action();
+  /// The boundaries of the value range triggers and in range conditions of this sensor, created on first use.
+  ValueRangeIndex *get_value_range_index();
 
   union {
     /** This member variable stores the last state that has passed through all filters.
@@ -184,15 +194,20 @@ class Sensor : public Nameable {
   MQTTSensorComponent *get_mqtt() const;
   void set_mqtt(MQTTSensorComponent *mqtt);
 #endif
+#ifdef USE_SENSOR_HISTORY
+  /// The history kept of this sensor, nullptr if there is none.
+  SensorHistory *get_history() const;
+  void set_history(SensorHistory *history);
+#endif
 
  protected:
   /** Override this to set the Home Assistant unit of measurement for this sensor.
    *
-   * Return "" to disable this feature.
+   * Return "" to disable this feature. The string isn't copied, so it should be a literal.
    *
    * @return The icon of this sensor, for example "°C".
    */
-  virtual std::string unit_of_measurement();  // NOLINT
+  virtual const char *unit_of_measurement();  // NOLINT
 
   /** Override this to set the Home Assistant icon for this sensor.
    *
@@ -200,7 +215,7 @@ class Sensor : public Nameable {
    *
    * @return The icon of this sensor, for example "mdi:battery".
    */
-  virtual std::string icon();  // NOLINT
+  virtual const char *icon();  // NOLINT
 
   /// Return the accuracy in decimals for this sensor.
   virtual int8_t accuracy_decimals();  // NOLINT
@@ -216,10 +231,14 @@ class Sensor : public Nameable {
       accuracy_decimals_;         ///< Override the accuracy in decimals, otherwise the sensor's values will be used.
   Filter *filter_list_{nullptr};  ///< Store all active filters.
   bool has_state_{false};
+  ValueRangeIndex *value_range_index_{nullptr};
 
 #ifdef USE_MQTT_SENSOR
   MQTTSensorComponent *mqtt_{nullptr};
 #endif
+#ifdef USE_SENSOR_HISTORY
+  SensorHistory *history_{nullptr};
+#endif
 };
 
 class PollingSensorComponent : public PollingComponent, public Sensor {
@@ -237,8 +256,8 @@ class EmptySensor : public Sensor {
  public:
   explicit EmptySensor(const std::string &name) : Sensor(name) {}
 
-  std::string unit_of_measurement() override { return default_unit_of_measurement; }
-  std::string icon() override { return default_icon; }
+  const char *unit_of_measurement() override { return default_unit_of_measurement; }
+  const char *icon() override { return default_icon; }
   int8_t accuracy_decimals() override { return default_accuracy_decimals; }
 };
 
@@ -301,6 +320,42 @@ class ValueRangeTrigger : public Trigger<float>, public Component {
   TemplatableValue<float, float> max_{NAN};
 };
 
+/** The boundaries of the ranges of the value range triggers and in range conditions of a sensor, sorted by value.
+ *
+ * Whether a state is inside a range can only change if a boundary of the range lies between the previous and the
+ * new state. So instead of evaluating every range for each new state, only the ranges with a boundary in between
+ * are evaluated, found with a binary search. Ranges with lambda boundaries are evaluated for every state.
+ */
+class ValueRangeIndex {
+ public:
+  explicit ValueRangeIndex(Sensor *parent);
+
+  /// Call callback with the new state when it may have entered or left [min, max], NAN for no boundary.
+  void add_range(float min, float max, std::function<void(float)> &&callback);
+  /// Call callback with every new state, for ranges whose boundaries depend on the state.
+  void add_dynamic_range(std::function<void(float)> &&callback);
+
+ protected:
+  void on_state_(float state);
+
+  struct Boundary {
+    float value;
+    uint16_t range;
+  };
+  struct Range {
+    std::function<void(float)> callback;
+    /// The generation this range was last evaluated in, so that a range with two crossed boundaries runs once.
+    uint32_t evaluated_at;
+  };
+
+  std::vector<Boundary> boundaries_;
+  std::vector<Range> ranges_;
+  /// The indices of the ranges that are evaluated for every state.
+  std::vector<uint16_t> dynamic_ranges_;
+  float previous_state_{NAN};
+  uint32_t generation_{0};
+};
+
 template<typename... Ts> class SensorInRangeCondition : public Condition<Ts...> {
  public:
   SensorInRangeCondition(Sensor *parent);
@@ -308,6 +363,7 @@ template<typename... Ts> class SensorInRangeCondition : public Condition<Ts...>
   void set_min(float min);
   void set_max(float max);
   bool check(Ts... x) override;
+  bool add_on_change_callback(std::function<void()> &&callback) override;
 
  protected:
   Sensor *parent_;
@@ -330,6 +386,9 @@ extern const char ICON_LIGHTBULB[];
 extern const char ICON_BATTERY[];
 extern const char ICON_FLOWER[];
 extern const char ICON_CHEMICAL_WEAPON[];
+extern const char ICON_PULSE[];
+extern const char ICON_MEMORY[];
+extern const char ICON_TIMER[];
 
 extern const char UNIT_C[];
 extern const char UNIT_PERCENT[];
@@ -347,7 +406,19 @@ extern const char UNIT_DEGREES[];
 extern const char UNIT_K[];
 extern const char UNIT_MICROSIEMENS_PER_CENTIMETER[];
 extern const char UNIT_MICROGRAMS_PER_CUBIC_METER[];
-
+extern const char UNIT_PULSES[];
+extern const char UNIT_DECIBEL[];
+extern const char UNIT_BYTES[];
+extern const char UNIT_IAQ[];
+extern const char UNIT_HZ[];
+extern const char UNIT_MS[];
+
+template<typename F> void Sensor::add_on_state_callback(F &&callback) {
+  this->callback_.add(std::forward<F>(callback));
+}
+template<typename F> void Sensor::add_on_raw_state_callback(F &&callback) {
+  this->raw_callback_.add(std::forward<F>(callback));
+}
 template<typename... Ts> SensorInRangeCondition<Ts...> *Sensor::make_sensor_in_range_condition() {
   return new SensorInRangeCondition<Ts...>(this);
 }
@@ -364,6 +435,12 @@ template<typename... Ts> bool SensorInRangeCondition<Ts...>::check(Ts... x) {
     return this->min_ <= state && state <= this->max_;
   }
 }
+template<typename... Ts>
+bool SensorInRangeCondition<Ts...>::add_on_change_callback(std::function<void()> &&callback) {
+  // the result can only change if the state crossed min or max
+  this->parent_->get_value_range_index()->add_range(this->min_, this->max_, [callback](float state) { callback(); });
+  return true;
+}
 template<typename... Ts> SensorPublishAction<Ts...>::SensorPublishAction(Sensor *sensor) : sensor_(sensor) {}
 template<typename... Ts> void SensorPublishAction<Ts...>::play(Ts... x) {
   this->sensor_->publish_state(this->state_.value(x...));
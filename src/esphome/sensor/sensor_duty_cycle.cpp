@@ -0,0 +1,130 @@
+#include "esphome/defines.h"
+
+#ifdef USE_SENSOR_DUTY_CYCLE
+
+#include "esphome/sensor/sensor_duty_cycle.h"
+#include "esphome/log.h"
+
+ESPHOME_NAMESPACE_BEGIN
+
+namespace sensor {
+
+static const char *TAG = "sensor.duty_cycle";
+
+/// How long the readings of a cycle may take (per sample) before the cycle is ended with what was collected.
+static const uint32_t SENSOR_DUTY_CYCLE_SAMPLE_TIMEOUT = 5000;
+
+SensorDutyCycle::SensorDutyCycle(uint32_t update_interval) : PollingComponent(update_interval) {}
+void SensorDutyCycle::set_warm_up_time(uint32_t warm_up_time) { this->warm_up_time_ = warm_up_time; }
+void SensorDutyCycle::set_samples(uint8_t samples) { this->samples_ = samples; }
+void SensorDutyCycle::set_power_supply(PowerSupplyComponent *power_supply) { this->power_supply_ = power_supply; }
+void SensorDutyCycle::set_sleep_function(std::function<void(bool)> &&sleep_function) {
+  this->sleep_function_ = std::move(sleep_function);
+}
+void SensorDutyCycle::set_sample_function(std::function<void()> &&sample_function, uint32_t sample_interval) {
+  this->sample_function_ = std::move(sample_function);
+  this->sample_interval_ = sample_interval;
+}
+
+void SensorDutyCycle::setup() {
+  // the sensor starts up awake, let it sleep until the first update
+  this->sleep_();
+}
+void SensorDutyCycle::dump_config() {
+  ESP_LOGCONFIG(TAG, "Sensor Duty Cycle:");
+  LOG_UPDATE_INTERVAL(this);
+  ESP_LOGCONFIG(TAG, "  Warm Up Time: %u ms", this->warm_up_time_);
+  ESP_LOGCONFIG(TAG, "  Samples: %u", this->samples_);
+  ESP_LOGCONFIG(TAG, "  Power Supply: %s", YESNO(this->power_supply_ != nullptr));
+}
+void SensorDutyCycle::update() {
+  if (this->awake_) {
+    ESP_LOGW(TAG, "The last cycle is still running, is the update interval shorter than the warm up time?");
+    return;
+  }
+  this->wake_();
+  this->set_timeout("warm_up", this->warm_up_time_, [this]() { this->start_collecting_(); });
+}
+float SensorDutyCycle::get_setup_priority() const { return setup_priority::HARDWARE_LATE - 1.0f; }
+uint32_t SensorDutyCycle::get_loop_idle_time() { return SCHEDULER_DONT_RUN; }
+
+bool SensorDutyCycle::is_collecting() const { return this->collecting_; }
+void SensorDutyCycle::add_value(Sensor *sensor, float value) {
+  if (!this->collecting_ || sensor == nullptr || isnan(value))
+    return;
+  for (auto &average : this->averages_) {
+    if (average.sensor == sensor) {
+      average.sum += value;
+      average.count++;
+      return;
+    }
+  }
+  this->averages_.push_back(Average{
+      .sensor = sensor,
+      .sum = value,
+      .count = 1,
+  });
+}
+void SensorDutyCycle::add_sample() {
+  if (!this->collecting_)
+    return;
+  if (++this->sample_count_ >= this->samples_)
+    this->finish_();
+}
+
+void SensorDutyCycle::wake_() {
+  ESP_LOGD(TAG, "Waking up the sensor...");
+  this->awake_ = true;
+  if (this->power_supply_ != nullptr && !this->has_requested_high_power_) {
+    this->power_supply_->request_high_power();
+    this->has_requested_high_power_ = true;
+  }
+  if (this->sleep_function_)
+    this->sleep_function_(true);
+}
+void SensorDutyCycle::sleep_() {
+  this->awake_ = false;
+  this->collecting_ = false;
+  if (this->sleep_function_)
+    this->sleep_function_(false);
+  if (this->power_supply_ != nullptr && this->has_requested_high_power_) {
+    this->power_supply_->unrequest_high_power();
+    this->has_requested_high_power_ = false;
+  }
+}
+void SensorDutyCycle::start_collecting_() {
+  for (auto &average : this->averages_) {
+    average.sum = 0;
+    average.count = 0;
+  }
+  this->sample_count_ = 0;
+  this->collecting_ = true;
+  if (this->sample_function_)
+    this->set_interval("sample", this->sample_interval_, [this]() { this->sample_function_(); });
+  // don't keep the sensor awake forever if it stopped sending
+  this->set_timeout("collect", this->samples_ * SENSOR_DUTY_CYCLE_SAMPLE_TIMEOUT, [this]() {
+    ESP_LOGW(TAG, "Only got %u of %u readings!", this->sample_count_, this->samples_);
+    this->status_set_warning();
+    this->finish_();
+  });
+}
+void SensorDutyCycle::finish_() {
+  this->cancel_interval("sample");
+  this->cancel_timeout("collect");
+  if (this->sample_count_ >= this->samples_)
+    this->status_clear_warning();
+  for (auto &average : this->averages_) {
+    if (average.count == 0)
+      continue;
+    const float value = average.sum / average.count;
+    ESP_LOGD(TAG, "'%s': Average of %u readings: %.1f", average.sensor->get_name().c_str(), average.count, value);
+    average.sensor->publish_state(value);
+  }
+  this->sleep_();
+}
+
+}  // namespace sensor
+
+ESPHOME_NAMESPACE_END
+
+#endif  // USE_SENSOR_DUTY_CYCLE
@@ -0,0 +1,91 @@
+#ifndef ESPHOME_SENSOR_SENSOR_DUTY_CYCLE_H
+#define ESPHOME_SENSOR_SENSOR_DUTY_CYCLE_H
+
+#include "esphome/defines.h"
+
+#ifdef USE_SENSOR_DUTY_CYCLE
+
+#include "esphome/component.h"
+#include "esphome/power_supply_component.h"
+#include "esphome/sensor/sensor.h"
+
+#include <vector>
+
+ESPHOME_NAMESPACE_BEGIN
+
+namespace sensor {
+
+/** Run a sensor only for a short time every update interval, to save power and sensor lifetime.
+ *
+ * Each update, the sensor is woken up (with its sleep command and/or by requesting high power from a power supply
+ * that switches it), and after the warm up time the next samples readings are averaged and published. Then the
+ * sensor is put back to sleep until the next update. Readings the sensor sends while asleep or warming up are
+ * dropped.
+ *
+ * Set it on a sensor that supports it, for example PMSX003Component::set_duty_cycle(). When the sensor is
+ * switched with a power supply, set the keep on time of the power supply to 0.
+ */
+class SensorDutyCycle : public PollingComponent {
+ public:
+  explicit SensorDutyCycle(uint32_t update_interval);
+
+  /// Set the time between waking the sensor and the first reading that's used in ms, defaults to 30s.
+  void set_warm_up_time(uint32_t warm_up_time);
+  /// Set the number of readings that are averaged each cycle, defaults to 5.
+  void set_samples(uint8_t samples);
+  /// Power the sensor with this power supply only while it's awake.
+  void set_power_supply(PowerSupplyComponent *power_supply);
+
+  // ========== INTERNAL METHODS ==========
+  // (In most use cases you won't need these)
+  /// Set the function that wakes the sensor up (true) or puts it to sleep (false), for example with a command.
+  void set_sleep_function(std::function<void(bool awake)> &&sleep_function);
+  /// Set the function that takes a reading every sample_interval while collecting, for sensors that are polled.
+  void set_sample_function(std::function<void()> &&sample_function, uint32_t sample_interval);
+
+  /// Whether readings are collected now, readings that arrive otherwise should be dropped.
+  bool is_collecting() const;
+  /// Add a value of sensor to its average.
+  void add_value(Sensor *sensor, float value);
+  /// Finish a reading (all values of one frame). After the last one of a cycle, the averages are published.
+  void add_sample();
+
+  void setup() override;
+  void dump_config() override;
+  void update() override;
+  uint32_t get_loop_idle_time() override;
+  float get_setup_priority() const override;
+
+ protected:
+  struct Average {
+    Sensor *sensor;
+    float sum;
+    uint8_t count;
+  };
+
+  void wake_();
+  void sleep_();
+  void start_collecting_();
+  /// Publish the averages and put the sensor to sleep.
+  void finish_();
+
+  uint32_t warm_up_time_{30000};
+  uint8_t samples_{5};
+  PowerSupplyComponent *power_supply_{nullptr};
+  std::function<void(bool awake)> sleep_function_;
+  std::function<void()> sample_function_;
+  uint32_t sample_interval_{0};
+  std::vector<Average> averages_;
+  uint8_t sample_count_{0};
+  bool awake_{false};
+  bool collecting_{false};
+  bool has_requested_high_power_{false};
+};
+
+}  // namespace sensor
+
+ESPHOME_NAMESPACE_END
+
+#endif  // USE_SENSOR_DUTY_CYCLE
+
+#endif  // ESPHOME_SENSOR_SENSOR_DUTY_CYCLE_H
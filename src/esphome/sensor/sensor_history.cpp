@@ -0,0 +1,437 @@
+#include "esphome/defines.h"
+
+#ifdef USE_SENSOR_HISTORY
+
+#include "esphome/sensor/sensor_history.h"
+#include "esphome/helpers.h"
+#include "esphome/log.h"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef ARDUINO_ARCH_ESP32
+#include <SPIFFS.h>
+#endif
+#ifdef ARDUINO_ARCH_ESP8266
+#include <FS.h>
+#endif
+
+ESPHOME_NAMESPACE_BEGIN
+
+namespace sensor {
+
+static const char *TAG = "sensor.history";
+
+/// The length of the buckets of the minute and quarter hour tiers in seconds.
+static const uint32_t SENSOR_HISTORY_BUCKET_INTERVALS[SENSOR_HISTORY_TIER_COUNT - 1] = {60, 15 * 60};
+/// The value delta of an entry without a state.
+static const int16_t SENSOR_HISTORY_NAN_DELTA = INT16_MIN;
+static const uint32_t SENSOR_HISTORY_FILE_MAGIC = 0x48495354UL;
+
+const char *sensor_history_tier_to_string(SensorHistoryTier tier) {
+  switch (tier) {
+    case SENSOR_HISTORY_RAW:
+      return "raw";
+    case SENSOR_HISTORY_MINUTE:
+      return "minute";
+    case SENSOR_HISTORY_QUARTER_HOUR:
+      return "quarter_hour";
+    default:
+      return "unknown";
+  }
+}
+
+static int16_t clamp_delta(int32_t delta) { return int16_t(clamp<int32_t>(-INT16_MAX, INT16_MAX, delta)); }
+static uint16_t clamp_spread(int32_t spread) { return uint16_t(clamp<int32_t>(0, UINT16_MAX, spread)); }
+
+SensorHistory::SensorHistory(Sensor *sensor, time::RealTimeClockComponent *time) : sensor_(sensor), time_(time) {
+  sensor->set_history(this);
+}
+void SensorHistory::set_raw_capacity(uint16_t raw_capacity) { this->capacities_[SENSOR_HISTORY_RAW] = raw_capacity; }
+void SensorHistory::set_raw_duration(uint32_t raw_duration) {
+  // the time deltas of the raw entries are 16 bits
+  this->raw_duration_ = std::min(raw_duration, uint32_t(UINT16_MAX));
+}
+void SensorHistory::set_minute_capacity(uint16_t minute_capacity) {
+  this->capacities_[SENSOR_HISTORY_MINUTE] = minute_capacity;
+}
+void SensorHistory::set_quarter_hour_capacity(uint16_t quarter_hour_capacity) {
+  this->capacities_[SENSOR_HISTORY_QUARTER_HOUR] = quarter_hour_capacity;
+}
+void SensorHistory::set_persist(bool persist) { this->persist_ = persist; }
+void SensorHistory::set_persist_interval(uint32_t persist_interval) { this->persist_interval_ = persist_interval; }
+Sensor *SensorHistory::get_sensor() const { return this->sensor_; }
+
+void SensorHistory::setup() {
+  this->scale_ = powf(10.0f, this->sensor_->get_accuracy_decimals());
+  this->raw_.init(this->capacities_[SENSOR_HISTORY_RAW]);
+  for (uint8_t i = 0; i < SENSOR_HISTORY_TIER_COUNT - 1; i++)
+    this->buckets_[i].init(this->capacities_[i + 1]);
+
+  if (this->persist_ && this->time_ == nullptr) {
+    ESP_LOGW(TAG, "Persisting the history of '%s' requires a time source.", this->sensor_->get_name().c_str());
+    this->persist_ = false;
+  }
+  if (this->persist_) {
+#ifdef ARDUINO_ARCH_ESP32
+    const bool mounted = SPIFFS.begin(true);
+#else
+    const bool mounted = SPIFFS.begin();
+#endif
+    if (mounted) {
+      this->load_();
+      add_safe_shutdown_hook([this](const char *cause) { this->persist(); });
+    } else {
+      ESP_LOGW(TAG, "Mounting SPIFFS failed, not persisting the history.");
+      this->persist_ = false;
+    }
+  }
+  this->last_persist_ = millis();
+  // loop() only writes the history, it's enabled again when a state is added
+  this->disable_loop();
+
+  this->sensor_->add_on_state_callback([this](float state) {
+    const uint32_t now = this->now_();
+    if (now != 0)
+      this->add_state(now, state);
+  });
+}
+void SensorHistory::dump_config() {
+  ESP_LOGCONFIG(TAG, "Sensor History for '%s':", this->sensor_->get_name().c_str());
+  ESP_LOGCONFIG(TAG, "  Raw: %u states, at most %us", this->capacities_[SENSOR_HISTORY_RAW], this->raw_duration_);
+  ESP_LOGCONFIG(TAG, "  Minute: %u buckets", this->capacities_[SENSOR_HISTORY_MINUTE]);
+  ESP_LOGCONFIG(TAG, "  Quarter Hour: %u buckets", this->capacities_[SENSOR_HISTORY_QUARTER_HOUR]);
+  ESP_LOGCONFIG(TAG, "  Time: %s", this->time_ != nullptr ? "Time Source" : "Uptime");
+  if (this->persist_) {
+    ESP_LOGCONFIG(TAG, "  Persisted to: %s", this->get_path_().c_str());
+    ESP_LOGCONFIG(TAG, "  Persist Interval: %u ms", this->persist_interval_);
+  }
+}
+void SensorHistory::loop() {
+  if (!this->persist_ || !this->persist_pending_) {
+    this->disable_loop();
+    return;
+  }
+  if (millis() - this->last_persist_ >= this->persist_interval_)
+    this->persist();
+}
+float SensorHistory::get_setup_priority() const { return setup_priority::HARDWARE_LATE; }
+
+uint32_t SensorHistory::now_() const {
+  if (this->time_ == nullptr)
+    return uint32_t(micros_64() / 1000000ULL);
+  auto now = this->time_->now();
+  return now.is_valid() ? uint32_t(now.time) : 0;
+}
+int32_t SensorHistory::quantize_(float value) const {
+  return int32_t(clamp(-2e9f, 2e9f, roundf(value * this->scale_)));
+}
+float SensorHistory::dequantize_(int32_t value) const { return value / this->scale_; }
+
+void SensorHistory::add_state(uint32_t time, float state) {
+  this->add_raw_(time, state);
+  for (uint8_t i = 0; i < SENSOR_HISTORY_TIER_COUNT - 1; i++)
+    this->add_to_bucket_(i, time, state);
+  if (this->persist_) {
+    this->persist_pending_ = true;
+    this->enable_loop();
+  }
+}
+void SensorHistory::add_raw_(uint32_t time, float state) {
+  TierState &tier = this->states_[SENSOR_HISTORY_RAW];
+  // drop the states older than the raw duration
+  while (this->raw_.size() != 0) {
+    const uint32_t oldest_time = tier.first_time + this->raw_[0].time_delta;
+    if (int32_t(time - oldest_time) <= int32_t(this->raw_duration_))
+      break;
+    this->pop_raw_();
+  }
+
+  RawEntry entry{};
+  if (this->raw_.size() == 0) {
+    tier.first_time = tier.last_time = time;
+    tier.first_value = tier.last_value = isnan(state) ? 0 : this->quantize_(state);
+  } else if (int32_t(time - tier.last_time) > 0) {
+    // at most the raw duration, the newest entry would have been dropped otherwise
+    entry.time_delta = time - tier.last_time;
+    tier.last_time = time;
+  }
+  if (isnan(state)) {
+    entry.value_delta = SENSOR_HISTORY_NAN_DELTA;
+  } else {
+    entry.value_delta = clamp_delta(this->quantize_(state) - tier.last_value);
+    tier.last_value += entry.value_delta;
+  }
+
+  if (this->raw_.size() == this->raw_.capacity())
+    this->pop_raw_();
+  this->raw_.push(entry);
+  this->sequences_[SENSOR_HISTORY_RAW]++;
+}
+void SensorHistory::pop_raw_() {
+  TierState &tier = this->states_[SENSOR_HISTORY_RAW];
+  const RawEntry &entry = this->raw_[0];
+  tier.first_time += entry.time_delta;
+  if (entry.value_delta != SENSOR_HISTORY_NAN_DELTA)
+    tier.first_value += entry.value_delta;
+  this->raw_.pop();
+}
+void SensorHistory::add_to_bucket_(uint8_t index, uint32_t time, float state) {
+  BucketAccumulator &acc = this->accumulators_[index];
+  const uint32_t start = time - time % SENSOR_HISTORY_BUCKET_INTERVALS[index];
+  if (start != acc.start) {
+    // buckets without states are filled in when the next one is pushed
+    if (acc.count != 0)
+      this->push_bucket_(index);
+    acc.start = start;
+    acc.count = 0;
+  }
+  if (isnan(state))
+    return;
+  if (acc.count == 0) {
+    acc.sum = 0.0f;
+    acc.min = acc.max = state;
+  }
+  acc.count++;
+  acc.sum += state;
+  acc.min = std::min(acc.min, state);
+  acc.max = std::max(acc.max, state);
+}
+void SensorHistory::push_bucket_(uint8_t index) {
+  const BucketAccumulator &acc = this->accumulators_[index];
+  TierState &tier = this->states_[index + 1];
+  SensorHistoryRing<BucketEntry> &ring = this->buckets_[index];
+  const uint32_t interval = SENSOR_HISTORY_BUCKET_INTERVALS[index];
+  const int32_t avg = this->quantize_(acc.sum / acc.count);
+
+  if (ring.size() != 0 && int32_t(acc.start - tier.last_time) <= 0)
+    // the time went backwards
+    return;
+  if (ring.size() == 0 || acc.start - tier.last_time > interval * ring.capacity()) {
+    // the first bucket, or all others are too old: start over
+    ring.clear();
+    tier.first_time = tier.last_time = acc.start - interval;
+    tier.first_value = tier.last_value = avg;
+  }
+  BucketEntry empty{SENSOR_HISTORY_NAN_DELTA, 0, 0};
+  while (tier.last_time + interval < acc.start)
+    this->push_bucket_entry_(index, empty);
+
+  BucketEntry entry{};
+  entry.avg_delta = clamp_delta(avg - tier.last_value);
+  tier.last_value += entry.avg_delta;
+  entry.below_avg = clamp_spread(tier.last_value - this->quantize_(acc.min));
+  entry.above_avg = clamp_spread(this->quantize_(acc.max) - tier.last_value);
+  this->push_bucket_entry_(index, entry);
+}
+void SensorHistory::push_bucket_entry_(uint8_t index, const BucketEntry &entry) {
+  SensorHistoryRing<BucketEntry> &ring = this->buckets_[index];
+  if (ring.size() == ring.capacity())
+    this->pop_bucket_(index);
+  ring.push(entry);
+  this->states_[index + 1].last_time += SENSOR_HISTORY_BUCKET_INTERVALS[index];
+  this->sequences_[index + 1]++;
+}
+void SensorHistory::pop_bucket_(uint8_t index) {
+  TierState &tier = this->states_[index + 1];
+  const BucketEntry &entry = this->buckets_[index][0];
+  tier.first_time += SENSOR_HISTORY_BUCKET_INTERVALS[index];
+  if (entry.avg_delta != SENSOR_HISTORY_NAN_DELTA)
+    tier.first_value += entry.avg_delta;
+  this->buckets_[index].pop();
+}
+
+uint16_t SensorHistory::size(SensorHistoryTier tier) const {
+  if (tier == SENSOR_HISTORY_RAW)
+    return this->raw_.size();
+  return this->buckets_[tier - 1].size();
+}
+size_t SensorHistory::read(SensorHistoryTier tier, SensorHistoryCursor &cursor, SensorHistoryPoint *points,
+                           size_t count) const {
+  const uint16_t size = this->size(tier);
+  const uint32_t first_sequence = this->sequences_[tier] - size;
+  const TierState &state = this->states_[tier];
+  // the entries are deltas, continue from the cursor if the entry before it is still there (entries don't
+  // change once added), otherwise decode from the oldest entry
+  uint16_t start = 0;
+  if (int32_t(cursor.sequence - first_sequence) > 0)
+    start = std::min<uint32_t>(cursor.sequence - first_sequence, size);
+  uint16_t i = 0;
+  uint32_t time = state.first_time;
+  int32_t value = state.first_value;
+  if (cursor.decoded && start != 0 && cursor.sequence - first_sequence <= size) {
+    i = start;
+    time = cursor.time;
+    value = cursor.value;
+  }
+  size_t written = 0;
+  for (; i < size && written < count; i++) {
+    SensorHistoryPoint point{};
+    if (tier == SENSOR_HISTORY_RAW) {
+      const RawEntry &entry = this->raw_[i];
+      time += entry.time_delta;
+      if (entry.value_delta != SENSOR_HISTORY_NAN_DELTA)
+        value += entry.value_delta;
+      point.time = time;
+      const bool has_state = entry.value_delta != SENSOR_HISTORY_NAN_DELTA;
+      point.min = point.avg = point.max = has_state ? this->dequantize_(value) : NAN;
+    } else {
+      const BucketEntry &entry = this->buckets_[tier - 1][i];
+      time += SENSOR_HISTORY_BUCKET_INTERVALS[tier - 1];
+      point.time = time;
+      if (entry.avg_delta != SENSOR_HISTORY_NAN_DELTA) {
+        value += entry.avg_delta;
+        point.min = this->dequantize_(value - entry.below_avg);
+        point.avg = this->dequantize_(value);
+        point.max = this->dequantize_(value + entry.above_avg);
+      } else {
+        point.min = point.avg = point.max = NAN;
+      }
+    }
+    if (i >= start)
+      points[written++] = point;
+  }
+  cursor.sequence = first_sequence + start + written;
+  cursor.time = time;
+  cursor.value = value;
+  cursor.decoded = true;
+  return written;
+}
+
+std::string SensorHistory::get_path_() const {
+  char path[24];
+  snprintf(path, sizeof(path), "/history_%08x", this->sensor_->get_object_id_hash());
+  return path;
+}
+void SensorHistory::persist() {
+  if (!this->persist_)
+    return;
+  this->last_persist_ = millis();
+  this->persist_pending_ = false;
+
+  File file = SPIFFS.open(this->get_path_().c_str(), "w");
+  if (!file) {
+    ESP_LOGW(TAG, "Opening %s for writing failed.", this->get_path_().c_str());
+    return;
+  }
+  FileHeader header{};
+  header.magic = SENSOR_HISTORY_FILE_MAGIC;
+  header.scale = this->scale_;
+  for (uint8_t i = 0; i < SENSOR_HISTORY_TIER_COUNT; i++) {
+    header.capacities[i] = this->capacities_[i];
+    header.sizes[i] = this->size(SensorHistoryTier(i));
+    header.states[i] = this->states_[i];
+  }
+  file.write(reinterpret_cast<const uint8_t *>(&header), sizeof(header));
+  for (uint16_t i = 0; i < this->raw_.size(); i++)
+    file.write(reinterpret_cast<const uint8_t *>(&this->raw_[i]), sizeof(RawEntry));
+  for (auto &ring : this->buckets_)
+    for (uint16_t i = 0; i < ring.size(); i++)
+      file.write(reinterpret_cast<const uint8_t *>(&ring[i]), sizeof(BucketEntry));
+  file.close();
+  ESP_LOGD(TAG, "Persisted the history of '%s'.", this->sensor_->get_name().c_str());
+}
+void SensorHistory::load_() {
+  File file = SPIFFS.open(this->get_path_().c_str(), "r");
+  if (!file)
+    return;
+  FileHeader header{};
+  bool valid = file.read(reinterpret_cast<uint8_t *>(&header), sizeof(header)) == sizeof(header);
+  valid = valid && header.magic == SENSOR_HISTORY_FILE_MAGIC && header.scale == this->scale_;
+  for (uint8_t i = 0; valid && i < SENSOR_HISTORY_TIER_COUNT; i++)
+    valid = header.capacities[i] == this->capacities_[i] && header.sizes[i] <= header.capacities[i];
+  if (!valid) {
+    // written by a different configuration
+    ESP_LOGD(TAG, "Ignoring the stored history of '%s'.", this->sensor_->get_name().c_str());
+    file.close();
+    return;
+  }
+
+  for (uint16_t i = 0; i < header.sizes[SENSOR_HISTORY_RAW]; i++) {
+    RawEntry entry{};
+    file.read(reinterpret_cast<uint8_t *>(&entry), sizeof(entry));
+    this->raw_.push(entry);
+  }
+  for (uint8_t index = 0; index < SENSOR_HISTORY_TIER_COUNT - 1; index++) {
+    for (uint16_t i = 0; i < header.sizes[index + 1]; i++) {
+      BucketEntry entry{};
+      file.read(reinterpret_cast<uint8_t *>(&entry), sizeof(entry));
+      this->buckets_[index].push(entry);
+    }
+  }
+  file.close();
+  for (uint8_t i = 0; i < SENSOR_HISTORY_TIER_COUNT; i++) {
+    this->states_[i] = header.states[i];
+    this->sequences_[i] = header.sizes[i];
+  }
+  ESP_LOGD(TAG, "Loaded the history of '%s': %u raw states, %u + %u buckets.", this->sensor_->get_name().c_str(),
+           header.sizes[0], header.sizes[1], header.sizes[2]);
+}
+
+SensorHistoryJsonWriter::SensorHistoryJsonWriter(SensorHistory *history, SensorHistoryTier tier)
+    : history_(history), tier_(tier) {}
+
+static void history_value_to_buf(char *buf, float value, int8_t accuracy_decimals) {
+  if (isnan(value))
+    strcpy(buf, "null");
+  else
+    value_accuracy_to_buf(buf, value, accuracy_decimals);
+}
+
+size_t SensorHistoryJsonWriter::write(char *buffer, size_t len) {
+  const int8_t decimals = this->history_->get_sensor()->get_accuracy_decimals();
+  size_t written = 0;
+  while (!this->done_) {
+    char item[192];
+    int item_len;
+    if (!this->started_) {
+      item_len = snprintf(item, sizeof(item), "{\"id\":\"sensor-%s\",\"tier\":\"%s\",\"points\":[",
+                          this->history_->get_sensor()->get_object_id().c_str(),
+                          sensor_history_tier_to_string(this->tier_));
+    } else {
+      if (this->points_at_ == this->points_len_) {
+        this->points_len_ = this->history_->read(this->tier_, this->cursor_, this->points_, 16);
+        this->points_at_ = 0;
+      }
+      if (this->points_len_ == 0) {
+        item_len = snprintf(item, sizeof(item), "]}");
+      } else {
+        const SensorHistoryPoint &point = this->points_[this->points_at_];
+        char avg[VALUE_ACCURACY_MAX_LEN];
+        history_value_to_buf(avg, point.avg, decimals);
+        if (this->tier_ == SENSOR_HISTORY_RAW) {
+          item_len = snprintf(item, sizeof(item), "%s[%u,%s]", this->first_point_ ? "" : ",", point.time, avg);
+        } else {
+          char min[VALUE_ACCURACY_MAX_LEN], max[VALUE_ACCURACY_MAX_LEN];
+          history_value_to_buf(min, point.min, decimals);
+          history_value_to_buf(max, point.max, decimals);
+          item_len = snprintf(item, sizeof(item), "%s[%u,%s,%s,%s]", this->first_point_ ? "" : ",", point.time, min,
+                              avg, max);
+        }
+      }
+    }
+    if (item_len < 0 || size_t(item_len) >= sizeof(item))
+      // truncated, for example by a very long object id
+      item_len = 0;
+    if (written + item_len > len)
+      break;
+    memcpy(buffer + written, item, item_len);
+    written += item_len;
+    if (!this->started_) {
+      this->started_ = true;
+    } else if (this->points_len_ == 0) {
+      this->done_ = true;
+    } else {
+      this->points_at_++;
+      this->first_point_ = false;
+    }
+  }
+  return written;
+}
+bool SensorHistoryJsonWriter::is_done() const { return this->done_; }
+
+}  // namespace sensor
+
+ESPHOME_NAMESPACE_END
+
+#endif  // USE_SENSOR_HISTORY
@@ -0,0 +1,242 @@
+#ifndef ESPHOME_SENSOR_SENSOR_HISTORY_H
+#define ESPHOME_SENSOR_SENSOR_HISTORY_H
+
+#include "esphome/defines.h"
+
+#ifdef USE_SENSOR_HISTORY
+
+#include "esphome/component.h"
+#include "esphome/sensor/sensor.h"
+#include "esphome/time/rtc_component.h"
+
+ESPHOME_NAMESPACE_BEGIN
+
+namespace sensor {
+
+/// The resolutions a SensorHistory keeps.
+enum SensorHistoryTier : uint8_t {
+  /// Every state of the sensor.
+  SENSOR_HISTORY_RAW = 0,
+  /// The min/avg/max of the states in each minute.
+  SENSOR_HISTORY_MINUTE = 1,
+  /// The min/avg/max of the states in each quarter hour.
+  SENSOR_HISTORY_QUARTER_HOUR = 2,
+};
+
+static const uint8_t SENSOR_HISTORY_TIER_COUNT = 3;
+
+const char *sensor_history_tier_to_string(SensorHistoryTier tier);
+
+/// A decoded entry of a SensorHistory, min = avg = max for the raw tier. NAN if the sensor had no state.
+struct SensorHistoryPoint {
+  /// The time of the state or the start of the bucket, in seconds (see SensorHistory).
+  uint32_t time;
+  float min;
+  float avg;
+  float max;
+};
+
+/// The position of a reader in a tier of a SensorHistory, see SensorHistory::read().
+struct SensorHistoryCursor {
+  /// The sequence number of the next entry to read.
+  uint32_t sequence{0};
+  /// The decoded time and value after the entry before sequence, only valid if decoded is true.
+  uint32_t time{0};
+  int32_t value{0};
+  bool decoded{false};
+};
+
+/// A fixed-size ring of entries, the oldest entry is overwritten once it's full.
+template<typename T> class SensorHistoryRing {
+ public:
+  void init(uint16_t capacity) {
+    delete[] this->entries_;
+    this->entries_ = new T[capacity];
+    this->capacity_ = capacity;
+    this->clear();
+  }
+  uint16_t size() const { return this->size_; }
+  uint16_t capacity() const { return this->capacity_; }
+  /// The entry at index, 0 is the oldest.
+  const T &operator[](uint16_t index) const { return this->entries_[(this->head_ + index) % this->capacity_]; }
+  void push(const T &entry) {
+    this->entries_[(this->head_ + this->size_) % this->capacity_] = entry;
+    if (this->size_ < this->capacity_)
+      this->size_++;
+    else
+      this->head_ = (this->head_ + 1) % this->capacity_;
+  }
+  void pop() {
+    this->head_ = (this->head_ + 1) % this->capacity_;
+    this->size_--;
+  }
+  void clear() {
+    this->head_ = 0;
+    this->size_ = 0;
+  }
+
+ protected:
+  T *entries_{nullptr};
+  uint16_t capacity_{0};
+  uint16_t head_{0};
+  uint16_t size_{0};
+};
+
+/** Keep the recent history of a sensor in memory, for nodes that lose their connection and for local dashboards.
+ *
+ * Every state is kept at full resolution for the last hour (limited by the raw capacity), plus two downsampled
+ * tiers with the min/avg/max of each minute and each quarter hour. The values are stored in units of the accuracy
+ * of the sensor, as 16 bit deltas to the previous entry (4 bytes per raw state, 6 bytes per bucket); a delta that
+ * doesn't fit is clamped and caught up by the following entries.
+ *
+ * Times are unix timestamps in seconds if a time source is set, states are ignored until it has a valid time.
+ * Without a time source they're the uptime in seconds. The history is served under '/sensor/<id>/history' by the
+ * web server and through SensorHistoryRequest by the native API.
+ *
+ * With persistence enabled (and a time source), the history is written to a file on SPIFFS every persist
+ * interval and before a safe reboot, and loaded again on boot.
+ */
+class SensorHistory : public Component {
+ public:
+  SensorHistory(Sensor *sensor, time::RealTimeClockComponent *time);
+
+  /// Set the number of states kept at full resolution, defaults to 360 (one state every 10s for an hour).
+  void set_raw_capacity(uint16_t raw_capacity);
+  /// Set for how long states are kept at full resolution in seconds, defaults to 3600 and at most 65535.
+  void set_raw_duration(uint32_t raw_duration);
+  /// Set the number of one minute buckets, defaults to 180 (3 hours).
+  void set_minute_capacity(uint16_t minute_capacity);
+  /// Set the number of quarter hour buckets, defaults to 96 (24 hours).
+  void set_quarter_hour_capacity(uint16_t quarter_hour_capacity);
+  /// Persist the history to SPIFFS, defaults to false. Requires a time source.
+  void set_persist(bool persist);
+  /// Set the time between two writes of the history file in ms, defaults to 15 min.
+  void set_persist_interval(uint32_t persist_interval);
+
+  Sensor *get_sensor() const;
+
+  /// Add a state at time, called for each state of the sensor.
+  void add_state(uint32_t time, float state);
+
+  /// The number of entries in the tier.
+  uint16_t size(SensorHistoryTier tier) const;
+
+  /** Decode up to count entries of the tier into points, oldest first.
+   *
+   * Entries are numbered in the order they were added. Reading starts at the entry with the number in
+   * cursor.sequence (or the oldest entry if that was dropped already), afterwards the cursor points to the next
+   * entry. Pass it to the next call to continue, the history can change in between. The cursor also keeps the
+   * decoded values, so continuing doesn't decode the deltas from the oldest entry again.
+   *
+   * @return The number of points written.
+   */
+  size_t read(SensorHistoryTier tier, SensorHistoryCursor &cursor, SensorHistoryPoint *points, size_t count) const;
+
+  /// Write the history to SPIFFS now.
+  void persist();
+
+  void setup() override;
+  void dump_config() override;
+  void loop() override;
+  float get_setup_priority() const override;
+
+ protected:
+  /// A state of the raw tier, relative to the entry before it.
+  struct RawEntry {
+    uint16_t time_delta;
+    int16_t value_delta;
+  };
+  /// A bucket of the minute and quarter hour tiers, the avg relative to the avg of the bucket before it.
+  struct BucketEntry {
+    int16_t avg_delta;
+    uint16_t below_avg;
+    uint16_t above_avg;
+  };
+  /// The absolute values the deltas of a tier are relative to.
+  struct TierState {
+    /// The time and value before the oldest entry.
+    uint32_t first_time;
+    int32_t first_value;
+    /// The time and value of the newest entry.
+    uint32_t last_time;
+    int32_t last_value;
+  };
+  /// The start of the history file, followed by the raw entries and the buckets of both tiers.
+  struct FileHeader {
+    uint32_t magic;
+    float scale;
+    uint16_t capacities[SENSOR_HISTORY_TIER_COUNT];
+    uint16_t sizes[SENSOR_HISTORY_TIER_COUNT];
+    TierState states[SENSOR_HISTORY_TIER_COUNT];
+  };
+  /// The states of the bucket that's being filled.
+  struct BucketAccumulator {
+    uint32_t start;
+    uint16_t count;
+    float sum;
+    float min;
+    float max;
+  };
+
+  uint32_t now_() const;
+  int32_t quantize_(float value) const;
+  float dequantize_(int32_t value) const;
+  void add_raw_(uint32_t time, float state);
+  void pop_raw_();
+  void add_to_bucket_(uint8_t index, uint32_t time, float state);
+  void push_bucket_(uint8_t index);
+  void push_bucket_entry_(uint8_t index, const BucketEntry &entry);
+  void pop_bucket_(uint8_t index);
+  std::string get_path_() const;
+  void load_();
+
+  Sensor *sensor_;
+  time::RealTimeClockComponent *time_;
+  uint32_t raw_duration_{3600};
+  uint16_t capacities_[SENSOR_HISTORY_TIER_COUNT]{360, 180, 96};
+  SensorHistoryRing<RawEntry> raw_;
+  /// The minute and quarter hour tiers.
+  SensorHistoryRing<BucketEntry> buckets_[SENSOR_HISTORY_TIER_COUNT - 1];
+  TierState states_[SENSOR_HISTORY_TIER_COUNT]{};
+  /// The number of entries added to each tier, the sequence number of the next entry.
+  uint32_t sequences_[SENSOR_HISTORY_TIER_COUNT]{};
+  BucketAccumulator accumulators_[SENSOR_HISTORY_TIER_COUNT - 1]{};
+  /// The values are stored in units of 1 / scale.
+  float scale_{1.0f};
+  bool persist_{false};
+  uint32_t persist_interval_{15 * 60 * 1000};
+  uint32_t last_persist_{0};
+  /// Whether states were added since the last write, loop() is only enabled while this is true.
+  bool persist_pending_{false};
+};
+
+/// Formats the entries of a tier of a SensorHistory as JSON, in chunks.
+class SensorHistoryJsonWriter {
+ public:
+  SensorHistoryJsonWriter(SensorHistory *history, SensorHistoryTier tier);
+
+  /// Write the next chunk of whole entries into buffer (at least 192 bytes), returns 0 once all was written.
+  size_t write(char *buffer, size_t len);
+  bool is_done() const;
+
+ protected:
+  SensorHistory *history_;
+  SensorHistoryTier tier_;
+  /// The points read from the history, but not written yet.
+  SensorHistoryPoint points_[16];
+  uint8_t points_len_{0};
+  uint8_t points_at_{0};
+  /// The next entry to read from the history.
+  SensorHistoryCursor cursor_;
+  bool started_{false};
+  bool first_point_{true};
+  bool done_{false};
+};
+
+}  // namespace sensor
+
+ESPHOME_NAMESPACE_END
+
+#endif  // USE_SENSOR_HISTORY
+
+#endif  // ESPHOME_SENSOR_SENSOR_HISTORY_H
@@ -62,6 +62,7 @@ void SHT3XDComponent::dump_config() {
   LOG_SENSOR("  ", "Humidity", this->humidity_sensor_);
 }
 float SHT3XDComponent::get_setup_priority() const { return setup_priority::HARDWARE_LATE; }
+uint32_t SHT3XDComponent::get_loop_idle_time() { return SCHEDULER_DONT_RUN; }
 void SHT3XDComponent::update() {
   if (!this->write_command_(SHT3XD_COMMAND_POLLING_H))
     return;
@@ -30,6 +30,7 @@ class SHT3XDComponent : public PollingComponent, public I2CDevice {
   void dump_config() override;
   float get_setup_priority() const override;
   void update() override;
+  uint32_t get_loop_idle_time() override;
 
  protected:
   bool write_command_(uint16_t command);
@@ -0,0 +1,178 @@
+#include "esphome/defines.h"
+
+#ifdef USE_SPECTRUM_ANALYZER
+
+#include <cmath>
+#include "esphome/sensor/spectrum_analyzer.h"
+#include "esphome/log.h"
+
+ESPHOME_NAMESPACE_BEGIN
+
+namespace sensor {
+
+static const char *TAG = "sensor.spectrum_analyzer";
+
+// A full-range ADC sine has amplitude 2^14 after the input shift, the Hann window halves it and a real signal
+// splits it into two bins.
+const float SPECTRUM_FULL_SCALE_POWER = 4096.0f * 4096.0f;
+
+#ifdef ARDUINO_ARCH_ESP32
+/// Shift to get 12-bit readings to Q15.
+static const uint8_t SPECTRUM_INPUT_SHIFT = 3;
+#endif
+#ifdef ARDUINO_ARCH_ESP8266
+/// Shift to get 10-bit readings to Q15.
+static const uint8_t SPECTRUM_INPUT_SHIFT = 5;
+#endif
+
+SpectrumAnalyzerComponent::SpectrumAnalyzerComponent(ADCSensorComponent *source, uint16_t fft_size)
+    : source_(source) {
+  this->log2_size_ = 6;
+  while (this->log2_size_ < 10 && (1u << this->log2_size_) < fft_size)
+    this->log2_size_++;
+  this->fft_size_ = 1u << this->log2_size_;
+}
+SpectrumBandSensor *SpectrumAnalyzerComponent::make_band_sensor(const std::string &name, float low_hz,
+                                                                float high_hz) {
+  auto *sensor = new SpectrumBandSensor(name, this->source_);
+  this->bands_.push_back(Band{sensor, low_hz, high_hz});
+  return sensor;
+}
+uint16_t SpectrumAnalyzerComponent::get_num_bins() const { return this->fft_size_ / 2; }
+float SpectrumAnalyzerComponent::get_bin_frequency(uint16_t bin) const {
+  return bin * float(this->source_->get_burst_sample_rate()) / this->fft_size_;
+}
+const uint32_t *SpectrumAnalyzerComponent::get_bin_power() const { return this->power_.data(); }
+uint32_t SpectrumAnalyzerComponent::get_frame() const { return this->frame_; }
+
+void SpectrumAnalyzerComponent::setup() {
+  ESP_LOGCONFIG(TAG, "Setting up spectrum analyzer...");
+  if (this->source_->get_burst_sample_rate() == 0) {
+    ESP_LOGE(TAG, "The ADC sensor needs to be in burst mode!");
+    this->mark_failed();
+    return;
+  }
+
+  const uint16_t n = this->fft_size_;
+  this->input_.resize(n);
+  this->buffer_.resize(n);
+  this->power_.assign(n / 2, 0);
+  this->twiddle_.resize(n / 2);
+  for (uint16_t k = 0; k < n / 2; k++) {
+    const float angle = 2.0f * float(M_PI) * k / n;
+    this->twiddle_[k].re = int16_t(lroundf(cosf(angle) * 32767.0f));
+    this->twiddle_[k].im = int16_t(lroundf(-sinf(angle) * 32767.0f));
+  }
+
+  this->source_->add_on_burst_samples_callback(
+      [this](const uint16_t *samples, size_t count) { this->add_samples_(samples, count); });
+  // loop() only runs once a window is complete
+  this->disable_loop();
+}
+void SpectrumAnalyzerComponent::dump_config() {
+  ESP_LOGCONFIG(TAG, "Spectrum Analyzer:");
+  ESP_LOGCONFIG(TAG, "  FFT Size: %u", this->fft_size_);
+  ESP_LOGCONFIG(TAG, "  Resolution: %.1f Hz", this->get_bin_frequency(1));
+  for (auto &band : this->bands_) {
+    LOG_SENSOR("  ", "Band", band.sensor);
+    ESP_LOGCONFIG(TAG, "    Frequencies: %.0f-%.0f Hz", band.low_hz, band.high_hz);
+  }
+}
+float SpectrumAnalyzerComponent::get_setup_priority() const { return setup_priority::HARDWARE_LATE; }
+void SpectrumAnalyzerComponent::add_samples_(const uint16_t *samples, size_t count) {
+  // drop samples while the last window hasn't been transformed yet
+  while (count > 0 && this->input_at_ < this->fft_size_) {
+    this->input_[this->input_at_++] = *samples++;
+    count--;
+  }
+  if (this->input_at_ == this->fft_size_)
+    this->enable_loop();
+}
+void SpectrumAnalyzerComponent::loop() {
+  this->load_input_();
+  this->input_at_ = 0;
+  this->disable_loop();
+
+  this->transform_();
+  const uint16_t bins = this->fft_size_ / 2;
+  for (uint16_t i = 0; i < bins; i++) {
+    const int32_t re = this->buffer_[i].re;
+    const int32_t im = this->buffer_[i].im;
+    this->power_[i] = uint32_t(re * re) + uint32_t(im * im);
+  }
+  this->frame_++;
+  this->publish_bands_();
+}
+void SpectrumAnalyzerComponent::load_input_() {
+  const uint16_t n = this->fft_size_;
+  uint32_t sum = 0;
+  for (uint16_t i = 0; i < n; i++)
+    sum += this->input_[i];
+  const int32_t mean = sum / n;
+
+  for (uint16_t i = 0; i < n; i++) {
+    // Hann window, cos(2 pi i / N) is the real part of the twiddle factors (mirrored for the second half)
+    int32_t cosine;
+    if (i < n / 2)
+      cosine = this->twiddle_[i].re;
+    else if (i == n / 2)
+      cosine = -32767;
+    else
+      cosine = this->twiddle_[n - i].re;
+    const int32_t window = (32767 - cosine) / 2;
+    int32_t value = (int32_t(this->input_[i]) - mean) << SPECTRUM_INPUT_SHIFT;
+    value = clamp<int32_t>(-32767, 32767, value);
+
+    uint16_t reversed = 0;
+    for (uint8_t b = 0; b < this->log2_size_; b++)
+      reversed |= ((i >> b) & 1) << (this->log2_size_ - 1 - b);
+    this->buffer_[reversed].re = int16_t((value * window) >> 15);
+    this->buffer_[reversed].im = 0;
+  }
+}
+void HOT SpectrumAnalyzerComponent::transform_() {
+  const uint16_t n = this->fft_size_;
+  SpectrumComplex *data = this->buffer_.data();
+  const SpectrumComplex *twiddle = this->twiddle_.data();
+  for (uint16_t size = 2; size <= n; size <<= 1) {
+    const uint16_t half = size / 2;
+    const uint16_t step = n / size;
+    for (uint16_t start = 0; start < n; start += size) {
+      SpectrumComplex *a = data + start;
+      SpectrumComplex *b = a + half;
+      for (uint16_t k = 0; k < half; k++) {
+        const SpectrumComplex w = twiddle[k * step];
+        const int32_t tr = (int32_t(b[k].re) * w.re - int32_t(b[k].im) * w.im) >> 15;
+        const int32_t ti = (int32_t(b[k].re) * w.im + int32_t(b[k].im) * w.re) >> 15;
+        const int32_t ar = a[k].re;
+        const int32_t ai = a[k].im;
+        // halve every stage so that the result can't overflow
+        a[k].re = int16_t((ar + tr) >> 1);
+        a[k].im = int16_t((ai + ti) >> 1);
+        b[k].re = int16_t((ar - tr) >> 1);
+        b[k].im = int16_t((ai - ti) >> 1);
+      }
+    }
+  }
+}
+void SpectrumAnalyzerComponent::publish_bands_() {
+  const float resolution = this->get_bin_frequency(1);
+  const uint16_t bins = this->fft_size_ / 2;
+  for (auto &band : this->bands_) {
+    // skip the DC bin
+    const uint16_t low = clamp<int32_t>(1, bins - 1, lroundf(band.low_hz / resolution));
+    const uint16_t high = clamp<int32_t>(low, bins - 1, lroundf(band.high_hz / resolution));
+    float energy = 0;
+    for (uint16_t i = low; i <= high; i++)
+      energy += this->power_[i];
+    // -120 dB for silence
+    const float db = 10.0f * log10f(std::max(energy / SPECTRUM_FULL_SCALE_POWER, 1e-12f));
+    band.sensor->publish_state(db);
+  }
+}
+
+}  // namespace sensor
+
+ESPHOME_NAMESPACE_END
+
+#endif  // USE_SPECTRUM_ANALYZER
@@ -0,0 +1,98 @@
+#ifndef ESPHOME_SENSOR_SPECTRUM_ANALYZER_H
+#define ESPHOME_SENSOR_SPECTRUM_ANALYZER_H
+
+#include "esphome/defines.h"
+
+#ifdef USE_SPECTRUM_ANALYZER
+
+#include "esphome/component.h"
+#include "esphome/sensor/sensor.h"
+#include "esphome/sensor/adc.h"
+
+ESPHOME_NAMESPACE_BEGIN
+
+namespace sensor {
+
+using SpectrumBandSensor = EmptyPollingParentSensor<1, ICON_PULSE, UNIT_DECIBEL, ADCSensorComponent>;
+
+/// A complex value in Q15 fixed point.
+struct SpectrumComplex {
+  int16_t re;
+  int16_t im;
+};
+
+/** Computes the frequency spectrum of the bursts of an ADC sensor.
+ *
+ * Each burst of the ADC sensor (see ADCSensorComponent::set_burst, use the FFT size as the sample count) is
+ * transformed with a Hann-windowed fixed-point radix-2 FFT. The energy of each band sensor is published in dB
+ * relative to a full-scale sine wave, and the power of all bins is kept for visualizers like
+ * AddressableSpectrumEffect.
+ */
+class SpectrumAnalyzerComponent : public Component {
+ public:
+  /** Construct the spectrum analyzer.
+   *
+   * @param source The ADC sensor to take the samples from, needs to be in burst mode.
+   * @param fft_size The number of samples per FFT, a power of two from 64 to 1024.
+   */
+  SpectrumAnalyzerComponent(ADCSensorComponent *source, uint16_t fft_size = 512);
+
+  /// Create a sensor for the energy of all frequencies from low_hz to high_hz.
+  SpectrumBandSensor *make_band_sensor(const std::string &name, float low_hz, float high_hz);
+
+  /// The number of frequency bins, half the FFT size.
+  uint16_t get_num_bins() const;
+  /// The center frequency of a bin in Hz.
+  float get_bin_frequency(uint16_t bin) const;
+  /// The power of each bin of the last spectrum, 0 dB full scale is SPECTRUM_FULL_SCALE_POWER.
+  const uint32_t *get_bin_power() const;
+  /// Incremented each time a new spectrum has been computed.
+  uint32_t get_frame() const;
+
+  // ========== INTERNAL METHODS ==========
+  // (In most use cases you won't need these)
+  void setup() override;
+  void dump_config() override;
+  /// Transform a complete window, only enabled while one is waiting.
+  void loop() override;
+  float get_setup_priority() const override;
+
+ protected:
+  struct Band {
+    SpectrumBandSensor *sensor;
+    float low_hz;
+    float high_hz;
+  };
+
+  void add_samples_(const uint16_t *samples, size_t count);
+  /// Window the input and load it into the FFT buffer in bit-reversed order.
+  void load_input_();
+  /// In-place radix-2 decimation-in-time FFT, scaled by 1/N to stay in range.
+  void transform_();
+  void publish_bands_();
+
+  ADCSensorComponent *source_;
+  uint16_t fft_size_;
+  uint8_t log2_size_;
+  std::vector<Band> bands_;
+  /// Raw readings of the window being collected.
+  std::vector<uint16_t> input_;
+  uint16_t input_at_{0};
+  /// FFT working buffer, interleaved so that each butterfly only touches one cache line per operand.
+  std::vector<SpectrumComplex> buffer_;
+  /// exp(-2 pi i k / N) for k < N/2, also used for the window.
+  std::vector<SpectrumComplex> twiddle_;
+  std::vector<uint32_t> power_;
+  uint32_t frame_{0};
+};
+
+/// The bin power of a full-scale sine wave after windowing and scaling.
+extern const float SPECTRUM_FULL_SCALE_POWER;
+
+}  // namespace sensor
+
+ESPHOME_NAMESPACE_END
+
+#endif  // USE_SPECTRUM_ANALYZER
+
+#endif  // ESPHOME_SENSOR_SPECTRUM_ANALYZER_H
@@ -66,6 +66,7 @@ void TCS34725Component::dump_config() {
   LOG_SENSOR("  ", "Color Temperature", this->color_temperature_sensor_);
 }
 float TCS34725Component::get_setup_priority() const { return setup_priority::HARDWARE_LATE; }
+uint32_t TCS34725Component::get_loop_idle_time() { return SCHEDULER_DONT_RUN; }
 void TCS34725Component::update() {
   uint16_t raw_c;
   uint16_t raw_r;
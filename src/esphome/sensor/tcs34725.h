@@ -49,6 +49,7 @@ class TCS34725Component : public PollingComponent, public I2CDevice {
   void setup() override;
   float get_setup_priority() const override;
   void update() override;
+  uint32_t get_loop_idle_time() override;
   void dump_config() override;
 
  protected:
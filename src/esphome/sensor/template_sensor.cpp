@@ -23,6 +23,7 @@ void TemplateSensor::update() {
   }
 }
 float TemplateSensor::get_setup_priority() const { return setup_priority::HARDWARE; }
+uint32_t TemplateSensor::get_loop_idle_time() { return SCHEDULER_DONT_RUN; }
 void TemplateSensor::set_template(std::function<optional<float>()> &&f) { this->f_ = f; }
 void TemplateSensor::dump_config() {
   LOG_SENSOR("", "Template Sensor", this);
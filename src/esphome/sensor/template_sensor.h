@@ -19,6 +19,7 @@ class TemplateSensor : public PollingSensorComponent {
   void set_template(std::function<optional<float>()> &&f);
 
   void update() override;
+  uint32_t get_loop_idle_time() override;
 
   void dump_config() override;
 
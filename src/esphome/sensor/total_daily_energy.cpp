@@ -3,6 +3,7 @@
 #ifdef USE_TOTAL_DAILY_ENERGY_SENSOR
 
 #include "esphome/sensor/total_daily_energy.h"
+#include "esphome/helpers.h"
 #include "esphome/log.h"
 
 ESPHOME_NAMESPACE_BEGIN
@@ -11,35 +12,68 @@ namespace sensor {
 
 static const char *TAG = "sensor.total_daily_energy";
 
+/// Fixed point scale of the total, 1 nWh resolution for a power sensor in W.
+static const float TOTAL_DAILY_ENERGY_SCALE = 1e9f;
+
 void TotalDailyEnergy::setup() {
-  this->pref_ = global_preferences.make_preference<float>(this->get_object_id_hash());
+  this->pref_ = global_preferences.make_preference<int64_t>(this->get_object_id_hash());
 
-  float recovered;
+  int64_t recovered;
   if (this->pref_.load(&recovered)) {
-    this->publish_state_and_save(recovered);
-  } else {
-    this->publish_state_and_save(0);
+    this->total_energy_ = recovered;
   }
-  this->last_update_ = millis();
+  this->publish_state(this->total_energy_ / TOTAL_DAILY_ENERGY_SCALE);
+  this->last_save_ = millis();
 
-  auto f = std::bind(&TotalDailyEnergy::process_new_state_, this, std::placeholders::_1);
-  this->parent_->add_on_state_callback(f);
+  if (this->integrate_parent_) {
+    auto f = std::bind(&TotalDailyEnergy::process_new_state_, this, std::placeholders::_1);
+    this->parent_->add_on_state_callback(f);
+  }
+}
+void TotalDailyEnergy::dump_config() {
+  LOG_SENSOR("", "Total Daily Energy", this);
+  ESP_LOGCONFIG(TAG, "  Source: %s", this->integrate_parent_ ? "Power" : "Energy Counter");
+  ESP_LOGCONFIG(TAG, "  Save Interval: %u ms", this->save_interval_);
 }
-void TotalDailyEnergy::dump_config() { LOG_SENSOR("", "Total Daily Energy", this); }
 float TotalDailyEnergy::get_setup_priority() const { return setup_priority::HARDWARE_LATE; }
 uint32_t TotalDailyEnergy::update_interval() { return this->parent_->update_interval(); }
-std::string TotalDailyEnergy::unit_of_measurement() { return this->parent_->get_unit_of_measurement() + "h"; }
-std::string TotalDailyEnergy::icon() { return this->parent_->get_icon(); }
+const char *TotalDailyEnergy::unit_of_measurement() {
+  this->unit_of_measurement_h_ = this->parent_->get_unit_of_measurement();
+  this->unit_of_measurement_h_ += 'h';
+  return this->unit_of_measurement_h_.c_str();
+}
+const char *TotalDailyEnergy::icon() { return this->parent_->get_icon(); }
 int8_t TotalDailyEnergy::accuracy_decimals() { return this->parent_->get_accuracy_decimals() + 2; }
 void TotalDailyEnergy::process_new_state_(float state) {
   if (isnan(state))
     return;
-  const uint32_t now = millis();
-  float delta_hours = (now - this->last_update_) / 1000.0f / 60.0f / 60.0f;
-  this->last_update_ = now;
-  this->publish_state_and_save(this->total_energy_ + state * delta_hours);
+  const uint64_t now = micros_64();
+  const float last_power = this->last_power_;
+  const uint64_t last_time = this->last_power_time_;
+  this->last_power_ = state;
+  this->last_power_time_ = now;
+  if (isnan(last_power))
+    return;
+
+  // trapezoid between the last and this state, in units of the parent times µs
+  const float area = (last_power + state) * 0.5f * float(now - last_time);
+  this->add_energy_fixed_(static_cast<int64_t>(area * (TOTAL_DAILY_ENERGY_SCALE / 3.6e9f)));
+}
+void TotalDailyEnergy::add_energy(float energy) {
+  this->add_energy_fixed_(static_cast<int64_t>(energy * TOTAL_DAILY_ENERGY_SCALE));
+}
+void TotalDailyEnergy::add_energy_fixed_(int64_t energy) {
+  this->total_energy_ += energy;
+  this->save_pending_ = true;
+  this->publish_state(this->total_energy_ / TOTAL_DAILY_ENERGY_SCALE);
 }
 void TotalDailyEnergy::loop() {
+  if (this->save_pending_ && millis() - this->last_save_ >= this->save_interval_) {
+    this->pref_.save(&this->total_energy_);
+    this->last_save_ = millis();
+    this->save_pending_ = false;
+  }
+
   auto t = this->time_->now();
   if (!t.is_valid())
     return;
@@ -51,15 +85,18 @@ void TotalDailyEnergy::loop() {
 
   if (t.day_of_year != this->last_day_of_year_) {
     this->last_day_of_year_ = t.day_of_year;
-    this->total_energy_ = 0;
     this->publish_state_and_save(0);
   }
 }
 void TotalDailyEnergy::publish_state_and_save(float state) {
-  this->pref_.save(&state);
-  this->total_energy_ = state;
+  this->total_energy_ = static_cast<int64_t>(state * TOTAL_DAILY_ENERGY_SCALE);
+  this->pref_.save(&this->total_energy_);
+  this->last_save_ = millis();
+  this->save_pending_ = false;
   this->publish_state(state);
 }
+void TotalDailyEnergy::set_integrate_parent(bool integrate_parent) { this->integrate_parent_ = integrate_parent; }
+void TotalDailyEnergy::set_save_interval(uint32_t save_interval) { this->save_interval_ = save_interval; }
 TotalDailyEnergy::TotalDailyEnergy(const std::string &name, time::RealTimeClockComponent *time, Sensor *parent)
     : Sensor(name), time_(time), parent_(parent) {}
 
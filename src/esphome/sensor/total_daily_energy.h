@@ -14,15 +14,31 @@ ESPHOME_NAMESPACE_BEGIN
 
 namespace sensor {
 
+/** Sum up the energy of a power sensor since midnight.
+ *
+ * The power states of the parent are integrated with the trapezoidal rule over the time of micros_64() into a
+ * 64 bit fixed point accumulator, so the total doesn't lose precision over the day. Power sensors that count the
+ * energy themselves (like the CF pulses of the HLW8012 or CSE7766) can instead add it with add_energy().
+ *
+ * The total is saved to flash at most once per save interval and at midnight.
+ */
 class TotalDailyEnergy : public Sensor, public Component {
  public:
   TotalDailyEnergy(const std::string &name, time::RealTimeClockComponent *time, Sensor *parent);
+
+  /// Add energy in units of the parent times hours, see set_integrate_parent().
+  void add_energy(float energy);
+  /// Whether to integrate the power states of the parent, defaults to true. Disabled by sensors using add_energy().
+  void set_integrate_parent(bool integrate_parent);
+  /// Set the minimum time between two saves of the total to flash in ms, defaults to 60s.
+  void set_save_interval(uint32_t save_interval);
+
   void setup() override;
   void dump_config() override;
   float get_setup_priority() const override;
   uint32_t update_interval() override;
-  std::string unit_of_measurement() override;
-  std::string icon() override;
+  const char *unit_of_measurement() override;
+  const char *icon() override;
   int8_t accuracy_decimals() override;
   void loop() override;
 
@@ -30,13 +46,24 @@ class TotalDailyEnergy : public Sensor, public Component {
 
  protected:
   void process_new_state_(float state);
+  /// Add energy in fixed point units and publish the new total.
+  void add_energy_fixed_(int64_t energy);
 
   ESPPreferenceObject pref_;
   time::RealTimeClockComponent *time_;
   Sensor *parent_;
+  /// Storage for unit_of_measurement(), the unit of the parent with an "h" appended.
+  std::string unit_of_measurement_h_;
   uint16_t last_day_of_year_{};
-  uint32_t last_update_{0};
-  float total_energy_{0.0f};
+  bool integrate_parent_{true};
+  /// The time and value of the last power state of the parent, NAN before the first one.
+  uint64_t last_power_time_{0};
+  float last_power_{NAN};
+  /// The total energy in units of the parent times hours, scaled by TOTAL_DAILY_ENERGY_SCALE.
+  int64_t total_energy_{0};
+  uint32_t save_interval_{60000};
+  uint32_t last_save_{0};
+  bool save_pending_{false};
 };
 
 }  // namespace sensor
@@ -139,8 +139,8 @@ void TSL2561Sensor::read_data_() {
   this->publish_state(lx);
   this->status_clear_warning();
 }
-std::string TSL2561Sensor::unit_of_measurement() { return UNIT_LX; }
-std::string TSL2561Sensor::icon() { return ICON_BRIGHTNESS_5; }
+const char *TSL2561Sensor::unit_of_measurement() { return UNIT_LX; }
+const char *TSL2561Sensor::icon() { return ICON_BRIGHTNESS_5; }
 int8_t TSL2561Sensor::accuracy_decimals() { return 1; }
 float TSL2561Sensor::get_integration_time_ms_() {
   switch (this->integration_time_) {
@@ -159,6 +159,7 @@ void TSL2561Sensor::set_integration_time(TSL2561IntegrationTime integration_time
 void TSL2561Sensor::set_gain(TSL2561Gain gain) { this->gain_ = gain; }
 void TSL2561Sensor::set_is_cs_package(bool package_cs) { this->package_cs_ = package_cs; }
 float TSL2561Sensor::get_setup_priority() const { return setup_priority::HARDWARE_LATE; }
+uint32_t TSL2561Sensor::get_loop_idle_time() { return SCHEDULER_DONT_RUN; }
 bool TSL2561Sensor::tsl2561_write_byte(uint8_t a_register, uint8_t value) {
   return this->write_byte(a_register | TSL2561_COMMAND_BIT, value);
 }
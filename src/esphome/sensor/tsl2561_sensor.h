@@ -75,8 +75,9 @@ class TSL2561Sensor : public PollingSensorComponent, public I2CDevice {
   void setup() override;
   void dump_config() override;
   void update() override;
-  std::string unit_of_measurement() override;
-  std::string icon() override;
+  uint32_t get_loop_idle_time() override;
+  const char *unit_of_measurement() override;
+  const char *icon() override;
   int8_t accuracy_decimals() override;
   float get_setup_priority() const override;
 
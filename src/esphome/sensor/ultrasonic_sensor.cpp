@@ -4,6 +4,8 @@
 
 #include "esphome/sensor/ultrasonic_sensor.h"
 
+#include <algorithm>
+#include <cmath>
 #include "esphome/log.h"
 #include "esphome/helpers.h"
 
@@ -13,6 +15,12 @@ namespace sensor {
 
 static const char *TAG = "sensor.ultrasonic";
 
+/// How long to wait before trying again if another ultrasonic sensor is measuring.
+static const uint32_t ULTRASONIC_RETRY_INTERVAL = 5;
+
+/// The sensor that currently waits for its echo.
+static UltrasonicSensorComponent *active_ultrasonic_sensor = nullptr;
+
 UltrasonicSensorComponent::UltrasonicSensorComponent(const std::string &name, GPIOPin *trigger_pin, GPIOPin *echo_pin,
                                                      uint32_t update_interval)
     : PollingSensorComponent(name, update_interval), trigger_pin_(trigger_pin), echo_pin_(echo_pin) {}
@@ -21,24 +29,82 @@ void UltrasonicSensorComponent::setup() {
   this->trigger_pin_->setup();
   this->trigger_pin_->digital_write(false);
   this->echo_pin_->setup();
+  this->samples_.reserve(this->burst_count_);
+  this->store_.pin = this->echo_pin_->to_isr();
+  this->echo_pin_->attach_interrupt(UltrasonicSensorStore::gpio_intr, &this->store_, CHANGE);
 }
 void UltrasonicSensorComponent::update() {
+  if (this->in_burst_) {
+    ESP_LOGW(TAG, "'%s' - Previous measurement hasn't finished yet, skipping!", this->name_.c_str());
+    return;
+  }
+  this->in_burst_ = true;
+  this->samples_.clear();
+  this->fire_();
+}
+void UltrasonicSensorComponent::fire_() {
+  if (active_ultrasonic_sensor != nullptr) {
+    // another sensor waits for its echo, try again once it should be done
+    this->set_timeout("fire", ULTRASONIC_RETRY_INTERVAL, [this]() { this->fire_(); });
+    return;
+  }
+  active_ultrasonic_sensor = this;
+
+  this->store_.has_start = false;
+  this->store_.done = false;
+  this->store_.measuring = true;
   this->trigger_pin_->digital_write(true);
   delayMicroseconds(this->pulse_time_us_);
   this->trigger_pin_->digital_write(false);
 
-  uint32_t time = pulseIn(this->echo_pin_->get_pin(), uint8_t(!this->echo_pin_->is_inverted()), this->timeout_us_);
+  // the echo pulse starts a few hundred µs after the trigger pulse
+  this->set_timeout("echo", this->timeout_us_ / 1000 + 2, [this]() { this->finish_measurement_(); });
+}
+void UltrasonicSensorComponent::finish_measurement_() {
+  this->store_.measuring = false;
+  active_ultrasonic_sensor = nullptr;
 
-  ESP_LOGV(TAG, "Echo took %uµs", time);
+  float result = NAN;
+  if (this->store_.done) {
+    const uint32_t time = this->store_.echo_end - this->store_.echo_start;
+    ESP_LOGV(TAG, "Echo took %uµs", time);
+    if (time <= this->timeout_us_)
+      result = UltrasonicSensorComponent::us_to_m(time);
+  }
+  this->samples_.push_back(result);
 
-  if (time == 0) {
+  if (this->samples_.size() < this->burst_count_) {
+    this->set_timeout("burst", this->burst_interval_, [this]() { this->fire_(); });
+  } else {
+    this->publish_burst_();
+  }
+}
+void UltrasonicSensorComponent::publish_burst_() {
+  this->in_burst_ = false;
+  auto end = std::remove_if(this->samples_.begin(), this->samples_.end(), [](float x) { return std::isnan(x); });
+  const size_t valid = end - this->samples_.begin();
+  if (valid == 0) {
     ESP_LOGD(TAG, "'%s' - Distance measurement timed out!", this->name_.c_str());
     this->publish_state(NAN);
-  } else {
-    float result = UltrasonicSensorComponent::us_to_m(time);
-    this->publish_state(result);
-    ESP_LOGD(TAG, "'%s' - Got distance: %.2f m", this->name_.c_str(), result);
-    this->publish_state(result);
+    return;
+  }
+
+  auto median = this->samples_.begin() + valid / 2;
+  std::nth_element(this->samples_.begin(), median, end);
+  const float result = *median;
+  ESP_LOGD(TAG, "'%s' - Got distance: %.2f m", this->name_.c_str(), result);
+  this->publish_state(result);
+}
+void ICACHE_RAM_ATTR HOT UltrasonicSensorStore::gpio_intr(UltrasonicSensorStore *arg) {
+  if (!arg->measuring || arg->done)
+    return;
+  const uint32_t now = micros();
+  if (arg->pin->digital_read()) {
+    arg->echo_start = now;
+    arg->has_start = true;
+  } else if (arg->has_start) {
+    arg->echo_end = now;
+    arg->done = true;
   }
 }
 void UltrasonicSensorComponent::dump_config() {
@@ -47,6 +113,9 @@ void UltrasonicSensorComponent::dump_config() {
   LOG_PIN("  Trigger Pin: ", this->trigger_pin_);
   ESP_LOGCONFIG(TAG, "  Pulse time: %u µs", this->pulse_time_us_);
   ESP_LOGCONFIG(TAG, "  Timeout: %u µs", this->timeout_us_);
+  if (this->burst_count_ > 1) {
+    ESP_LOGCONFIG(TAG, "  Burst: median of %u, every %u ms", this->burst_count_, this->burst_interval_);
+  }
   LOG_UPDATE_INTERVAL(this);
 }
 float UltrasonicSensorComponent::us_to_m(uint32_t us) {
@@ -56,13 +125,18 @@ float UltrasonicSensorComponent::us_to_m(uint32_t us) {
   return total_dist / 2.0f;
 }
 float UltrasonicSensorComponent::get_setup_priority() const { return setup_priority::HARDWARE_LATE; }
+uint32_t UltrasonicSensorComponent::get_loop_idle_time() { return SCHEDULER_DONT_RUN; }
 void UltrasonicSensorComponent::set_pulse_time_us(uint32_t pulse_time_us) { this->pulse_time_us_ = pulse_time_us; }
-std::string UltrasonicSensorComponent::unit_of_measurement() { return "m"; }
-std::string UltrasonicSensorComponent::icon() { return "mdi:arrow-expand-vertical"; }
+const char *UltrasonicSensorComponent::unit_of_measurement() { return "m"; }
+const char *UltrasonicSensorComponent::icon() { return "mdi:arrow-expand-vertical"; }
 int8_t UltrasonicSensorComponent::accuracy_decimals() {
   return 2;  // cm precision
 }
 void UltrasonicSensorComponent::set_timeout_us(uint32_t timeout_us) { this->timeout_us_ = timeout_us; }
+void UltrasonicSensorComponent::set_burst_count(uint8_t burst_count) { this->burst_count_ = burst_count; }
+void UltrasonicSensorComponent::set_burst_interval(uint32_t burst_interval) {
+  this->burst_interval_ = burst_interval;
+}
 
 }  // namespace sensor
 
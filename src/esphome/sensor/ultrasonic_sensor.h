@@ -5,6 +5,7 @@
 
 #ifdef USE_ULTRASONIC_SENSOR
 
+#include <vector>
 #include "esphome/sensor/sensor.h"
 #include "esphome/esphal.h"
 
@@ -12,6 +13,26 @@ ESPHOME_NAMESPACE_BEGIN
 
 namespace sensor {
 
+/// Store data in a class that doesn't use multiple-inheritance (vtables in flash)
+struct UltrasonicSensorStore {
+  ISRInternalGPIOPin *pin;
+  /// Whether an echo is expected, edges outside of a measurement are ignored.
+  volatile bool measuring{false};
+  volatile bool has_start{false};
+  volatile bool done{false};
+  volatile uint32_t echo_start{0};
+  volatile uint32_t echo_end{0};
+
+  static void gpio_intr(UltrasonicSensorStore *arg);
+};
+
+/** Measure distances with an ultrasonic sensor like the HC-SR04.
+ *
+ * The echo pulse is timed with an interrupt on the echo pin, the result is evaluated by a scheduler timeout, so
+ * the loop keeps running while waiting for the echo. Only one ultrasonic sensor measures at a time, sensors that
+ * want to measure while another one waits for its echo are delayed, so they don't hear each other's pulses.
+ * In burst mode, each update takes several measurements and publishes their median.
+ */
 class UltrasonicSensorComponent : public PollingSensorComponent {
  public:
   /** Construct the ultrasonic sensor with the specified trigger pin and echo pin.
@@ -33,9 +54,10 @@ class UltrasonicSensorComponent : public PollingSensorComponent {
   void dump_config() override;
 
   void update() override;
+  uint32_t get_loop_idle_time() override;
 
-  std::string unit_of_measurement() override;
-  std::string icon() override;
+  const char *unit_of_measurement() override;
+  const char *icon() override;
   int8_t accuracy_decimals() override;
 
   float get_setup_priority() const override;
@@ -43,15 +65,32 @@ class UltrasonicSensorComponent : public PollingSensorComponent {
   /// Set the time in µs the trigger pin should be enabled for in µs, defaults to 10µs (for HC-SR04)
   void set_pulse_time_us(uint32_t pulse_time_us);
 
+  /// Take this many measurements per update and publish their median, defaults to 1.
+  void set_burst_count(uint8_t burst_count);
+  /// Set the time in ms between the measurements of a burst, defaults to 60ms (for HC-SR04).
+  void set_burst_interval(uint32_t burst_interval);
+
  protected:
   /// Helper function to convert the specified echo duration in µs to meters.
   static float us_to_m(uint32_t us);
   /// Helper function to convert the specified distance in meters to the echo duration in µs.
 
+  /// Send a trigger pulse, or try again later if another ultrasonic sensor is measuring.
+  void fire_();
+  /// Evaluate the echo of the last trigger pulse.
+  void finish_measurement_();
+  void publish_burst_();
+
   GPIOPin *trigger_pin_;
   GPIOPin *echo_pin_;
   uint32_t timeout_us_{11662};  /// 2 meters.
   uint32_t pulse_time_us_{10};
+  uint8_t burst_count_{1};
+  uint32_t burst_interval_{60};
+  UltrasonicSensorStore store_;
+  /// The distances measured in the current burst, NAN for timeouts.
+  std::vector<float> samples_;
+  bool in_burst_{false};
 };
 
 }  // namespace sensor
@@ -31,11 +31,12 @@ void UptimeSensor::update() {
   const float seconds = float(seconds_int) + (this->uptime_ % 1000ULL) / 1000.0f;
   this->publish_state(seconds);
 }
-std::string UptimeSensor::unit_of_measurement() { return "s"; }
-std::string UptimeSensor::icon() { return "mdi:timer"; }
+const char *UptimeSensor::unit_of_measurement() { return "s"; }
+const char *UptimeSensor::icon() { return "mdi:timer"; }
 int8_t UptimeSensor::accuracy_decimals() { return 0; }
 std::string UptimeSensor::unique_id() { return get_mac_address() + "-uptime"; }
 float UptimeSensor::get_setup_priority() const { return setup_priority::HARDWARE; }
+uint32_t UptimeSensor::get_loop_idle_time() { return SCHEDULER_DONT_RUN; }
 
 }  // namespace sensor
 
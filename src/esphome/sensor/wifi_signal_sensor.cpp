@@ -19,11 +19,12 @@ static const char *TAG = "sensor.wifi_signal";
 WiFiSignalSensor::WiFiSignalSensor(const std::string &name, uint32_t update_interval)
     : PollingSensorComponent(name, update_interval) {}
 void WiFiSignalSensor::update() { this->publish_state(WiFi.RSSI()); }
-std::string WiFiSignalSensor::unit_of_measurement() { return "dB"; }
-std::string WiFiSignalSensor::icon() { return "mdi:wifi"; }
+const char *WiFiSignalSensor::unit_of_measurement() { return "dB"; }
+const char *WiFiSignalSensor::icon() { return "mdi:wifi"; }
 int8_t WiFiSignalSensor::accuracy_decimals() { return 0; }
 std::string WiFiSignalSensor::unique_id() { return get_mac_address() + "-wifisignal"; }
 float WiFiSignalSensor::get_setup_priority() const { return setup_priority::WIFI; }
+uint32_t WiFiSignalSensor::get_loop_idle_time() { return SCHEDULER_DONT_RUN; }
 void WiFiSignalSensor::dump_config() { LOG_SENSOR("", "WiFi Signal", this); }
 
 }  // namespace sensor
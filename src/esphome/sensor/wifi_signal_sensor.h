@@ -16,10 +16,11 @@ class WiFiSignalSensor : public PollingSensorComponent {
   explicit WiFiSignalSensor(const std::string &name, uint32_t update_interval = 60000);
 
   void update() override;
+  uint32_t get_loop_idle_time() override;
   void dump_config() override;
 
-  std::string unit_of_measurement() override;
-  std::string icon() override;
+  const char *unit_of_measurement() override;
+  const char *icon() override;
   int8_t accuracy_decimals() override;
   std::string unique_id() override;
   float get_setup_priority() const override;
@@ -5,35 +5,109 @@
 #include "esphome/servo.h"
 #include "esphome/log.h"
 
+#include <cmath>
+
 ESPHOME_NAMESPACE_BEGIN
 
 static const char *TAG = "servo";
 
 void Servo::write(float value) {
-  if (value < -1.0)
-    value = -1.0;
-  else if (value > 1.0)
-    value = 1.0;
+  value = clamp(-1.0f, 1.0f, value);
+  this->position_ = this->get_position();
+  this->fade_length_ = 0;
+  this->target_ = value;
 
-  float level;
-  if (value < 0.0)
-    level = lerp(this->idle_level_, this->min_level_, -value);
-  else
-    level = lerp(this->idle_level_, this->max_level_, value);
+  if (this->acceleration_ > 0.0f || (this->max_speed_ > 0.0f && !this->output_->supports_fade())) {
+    if (!this->moving_) {
+      this->moving_ = true;
+      this->last_update_ = millis();
+      this->set_interval("profile", SERVO_PROFILE_INTERVAL, [this]() { this->update_profile_(); });
+    }
+    return;
+  }
 
-  this->output_->set_level(level);
+  uint32_t length = 0;
+  if (this->max_speed_ > 0.0f)
+    length = uint32_t(fabsf(value - this->position_) / this->max_speed_ * 1000.0f);
+  if (length != 0) {
+    this->fade_start_ = millis();
+    this->fade_length_ = length;
+  } else {
+    this->position_ = value;
+  }
+  this->write_position_(value, length);
+}
+void Servo::setup() {
+  this->position_ = this->target_ = 0.0f;
+  this->write_position_(0.0f, 0);
 }
-void Servo::setup() { this->write(0.0f); }
 void Servo::dump_config() {
   ESP_LOGCONFIG(TAG, "Servo:");
   ESP_LOGCONFIG(TAG, "  Idle Level: %.1f%%", this->idle_level_ * 100.0f);
   ESP_LOGCONFIG(TAG, "  Min Level: %.1f%%", this->min_level_ * 100.0f);
   ESP_LOGCONFIG(TAG, "  Max Level: %.1f%%", this->max_level_ * 100.0f);
+  if (this->max_speed_ > 0.0f)
+    ESP_LOGCONFIG(TAG, "  Max Speed: %.2f/s", this->max_speed_);
+  if (this->acceleration_ > 0.0f)
+    ESP_LOGCONFIG(TAG, "  Acceleration: %.2f/s²", this->acceleration_);
 }
 float Servo::get_setup_priority() const { return setup_priority::HARDWARE_LATE; }
 void Servo::set_min_level(float min_level) { this->min_level_ = min_level; }
 void Servo::set_idle_level(float idle_level) { this->idle_level_ = idle_level; }
 void Servo::set_max_level(float max_level) { this->max_level_ = max_level; }
+void Servo::set_max_speed(float max_speed) { this->max_speed_ = max_speed; }
+void Servo::set_acceleration(float acceleration) { this->acceleration_ = acceleration; }
+float Servo::get_position() const {
+  if (this->fade_length_ == 0)
+    return this->position_;
+  const uint32_t elapsed = millis() - this->fade_start_;
+  if (elapsed >= this->fade_length_)
+    return this->target_;
+  return lerp(this->position_, this->target_, elapsed / float(this->fade_length_));
+}
+
+void Servo::write_position_(float position, uint32_t length) {
+  float level;
+  if (position < 0.0)
+    level = lerp(this->idle_level_, this->min_level_, -position);
+  else
+    level = lerp(this->idle_level_, this->max_level_, position);
+
+  if (length == 0)
+    this->output_->set_level(level);
+  else
+    this->output_->fade_to_level(level, length);
+}
+void Servo::update_profile_() {
+  const uint32_t now = millis();
+  // advance by the time that actually passed, so that late updates don't slow the servo down
+  const float dt = (now - this->last_update_) / 1000.0f;
+  this->last_update_ = now;
+  const float distance = this->target_ - this->position_;
+
+  float speed = this->max_speed_ > 0.0f ? this->max_speed_ : INFINITY;
+  // the fastest speed from which the servo can still stop at the target
+  if (this->acceleration_ > 0.0f)
+    speed = std::min(speed, sqrtf(2.0f * this->acceleration_ * fabsf(distance)));
+  float velocity = distance < 0.0f ? -speed : speed;
+  if (this->acceleration_ > 0.0f) {
+    const float change = this->acceleration_ * dt;
+    velocity = clamp(this->velocity_ - change, this->velocity_ + change, velocity);
+  }
+
+  const float step = velocity * dt;
+  if ((step >= 0.0f) == (distance >= 0.0f) && fabsf(step) >= fabsf(distance)) {
+    this->position_ = this->target_;
+    this->velocity_ = 0.0f;
+    this->moving_ = false;
+    this->cancel_interval("profile");
+  } else {
+    this->position_ += step;
+    this->velocity_ = velocity;
+  }
+  // let a fading output interpolate until the next update
+  this->write_position_(this->position_, this->output_->supports_fade() ? SERVO_PROFILE_INTERVAL : 0);
+}
 Servo::Servo(output::FloatOutput *output) : output_(output) {}
 
 ESPHOME_NAMESPACE_END
@@ -10,9 +10,17 @@
 
 ESPHOME_NAMESPACE_BEGIN
 
+/// The interval in ms at which motion profiles are updated, the period of the usual 50Hz servo signal.
+#define SERVO_PROFILE_INTERVAL 20
+
 class Servo : public Component {
  public:
   Servo(output::FloatOutput *output);
+  /** Move the servo to value (-1.0 to 1.0).
+   *
+   * Without a max speed or acceleration the level is written immediately, otherwise the servo follows a motion
+   * profile towards value, starting from where it is now.
+   */
   void write(float value);
   void setup() override;
   void dump_config() override;
@@ -20,12 +28,37 @@ class Servo : public Component {
   void set_min_level(float min_level);
   void set_idle_level(float idle_level);
   void set_max_level(float max_level);
+  /** Limit the speed of the servo to max_speed per second (in the -1.0 to 1.0 range of write()), 0 means unlimited.
+   *
+   * Without an acceleration limit, moves on outputs that can fade in hardware (like LEDC) are a single linear fade
+   * that needs no work from the main loop. Otherwise the profile is updated every SERVO_PROFILE_INTERVAL ms from the
+   * elapsed time (so loop jitter doesn't change the speed), and fading outputs interpolate between the updates.
+   */
+  void set_max_speed(float max_speed);
+  /// Limit the acceleration to acceleration per second² (see set_max_speed()), 0 means unlimited.
+  void set_acceleration(float acceleration);
+  /// Get the position (-1.0 to 1.0) the servo is currently commanded to.
+  float get_position() const;
 
  protected:
+  void write_position_(float position, uint32_t length);
+  /// Advance the motion profile by the time since the last update.
+  void update_profile_();
+
   output::FloatOutput *output_;
   float min_level_ = 0.0300f;
   float idle_level_ = 0.0750f;
   float max_level_ = 0.1200f;
+  float max_speed_{0.0f};
+  float acceleration_{0.0f};
+  float position_{0.0f};
+  float target_{0.0f};
+  float velocity_{0.0f};
+  uint32_t last_update_{0};
+  bool moving_{false};
+  /// The running hardware fade from position_ to target_, if any.
+  uint32_t fade_start_{0};
+  uint32_t fade_length_{0};
 };
 
 template<typename... Ts> class ServoWriteAction : public Action<Ts...> {
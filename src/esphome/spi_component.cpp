@@ -3,6 +3,12 @@
 #ifdef USE_SPI
 
 #include "esphome/spi_component.h"
+
+#include <algorithm>
+#ifdef ARDUINO_ARCH_ESP8266
+#include <SPI.h>
+#endif
+
 #include "esphome/log.h"
 #include "esphome/helpers.h"
 
@@ -10,9 +16,43 @@ ESPHOME_NAMESPACE_BEGIN
 
 static const char *TAG = "spi";
 
+/// Hardware SPI clock for devices that are high speed, and for all others.
+static const uint32_t SPI_HIGH_SPEED_FREQUENCY = 8000000;
+static const uint32_t SPI_LOW_SPEED_FREQUENCY = 1000000;
+
+#ifdef ARDUINO_ARCH_ESP32
+static const spi_host_device_t SPI_HW_HOST = HSPI_HOST;
+/// Largest transfer one DMA descriptor can do, longer writes are split into chunks.
+static const size_t SPI_MAX_DMA_TRANSFER_LENGTH = 4092;
+/** Chunk size of asynchronous transfers.
+ *
+ * Other chips can only use the bus in between two chunks, this is about 1ms at high speed.
+ */
+static const size_t SPI_ASYNC_CHUNK_LENGTH = 1024;
+#endif
+
+/// Index of the settings of a chip, for the hardware device cache.
+static uint8_t spi_config_index(bool msb_first, bool high_speed) {
+  return (msb_first ? 0b10 : 0b00) | (high_speed ? 0b01 : 0b00);
+}
+
 SPIComponent::SPIComponent(GPIOPin *clk, GPIOPin *miso, GPIOPin *mosi) : clk_(clk), miso_(miso), mosi_(mosi) {}
 
 void ICACHE_RAM_ATTR HOT SPIComponent::write_byte(uint8_t data) {
+  if (this->hardware_) {
+#ifdef ARDUINO_ARCH_ESP32
+    spi_transaction_t transaction{};
+    transaction.flags = SPI_TRANS_USE_TXDATA;
+    transaction.length = 8;
+    transaction.tx_data[0] = data;
+    this->hw_transmit_(&transaction);
+#else
+    SPI.write(data);
+#endif
+    ESP_LOGVV(TAG, "    Wrote 0x%02X", data);
+    return;
+  }
+
   uint8_t send_bits = data;
   if (this->msb_first_)
     send_bits = reverse_bits_8(data);
@@ -37,6 +77,20 @@ void ICACHE_RAM_ATTR HOT SPIComponent::write_byte(uint8_t data) {
 }
 
 uint8_t ICACHE_RAM_ATTR HOT SPIComponent::read_byte() {
+  if (this->hardware_) {
+#ifdef ARDUINO_ARCH_ESP32
+    spi_transaction_t transaction{};
+    transaction.flags = SPI_TRANS_USE_TXDATA | SPI_TRANS_USE_RXDATA;
+    transaction.length = 8;
+    this->hw_transmit_(&transaction);
+    const uint8_t data = transaction.rx_data[0];
+#else
+    const uint8_t data = SPI.transfer(0x00);
+#endif
+    ESP_LOGVV(TAG, "    Received 0x%02X", data);
+    return data;
+  }
+
   this->clk_->digital_write(true);
 
   uint8_t data = 0;
@@ -63,29 +117,173 @@ void ICACHE_RAM_ATTR HOT SPIComponent::read_array(uint8_t *data, size_t length)
     data[i] = this->read_byte();
 }
 
-void ICACHE_RAM_ATTR HOT SPIComponent::write_array(uint8_t *data, size_t length) {
+void ICACHE_RAM_ATTR HOT SPIComponent::write_array(const uint8_t *data, size_t length) {
+  if (this->hardware_) {
+#ifdef ARDUINO_ARCH_ESP32
+    while (length > 0) {
+      const size_t chunk = std::min(length, SPI_MAX_DMA_TRANSFER_LENGTH);
+      spi_transaction_t transaction{};
+      transaction.length = chunk * 8;
+      transaction.tx_buffer = data;
+      this->hw_transmit_(&transaction);
+      data += chunk;
+      length -= chunk;
+    }
+#else
+    SPI.writeBytes(const_cast<uint8_t *>(data), length);
+#endif
+    return;
+  }
+
   for (size_t i = 0; i < length; i++) {
     feed_wdt();
     this->write_byte(data[i]);
   }
 }
 
+void SPIComponent::write_array_async(const uint8_t *data, size_t length, std::function<void()> &&callback) {
+  this->transfer_callback_ = std::move(callback);
+#ifdef ARDUINO_ARCH_ESP32
+  if (this->hardware_ && length > 0) {
+    this->transfer_device_ = this->get_hw_device_();
+    this->transfer_cs_ = this->active_cs_;
+    this->transfer_data_ = data;
+    this->transfer_remaining_ = length;
+    this->transfer_active_ = true;
+    this->queue_transfer_chunk_();
+    this->enable_loop();
+    return;
+  }
+#endif
+
+  // no DMA, transfer right away but like with DMA only call the callback once this returned
+  this->write_array(data, length);
+  if (this->active_cs_ != nullptr)
+    this->disable();
+  this->transfer_done_ = true;
+  if (!this->in_transfer_callback_)
+    this->defer("transfer", [this]() { this->call_transfer_callbacks_(); });
+}
+
+bool SPIComponent::is_transfer_active() const {
+#ifdef ARDUINO_ARCH_ESP32
+  return this->transfer_active_;
+#else
+  return false;
+#endif
+}
+
+void SPIComponent::wait_transfer() {
+  // callbacks may chain another transfer
+  while (true) {
+#ifdef ARDUINO_ARCH_ESP32
+    if (this->transfer_active_) {
+      if (this->transfer_paused_)
+        // the chip using the bus in between has to be disabled first
+        return;
+      this->poll_transfer_(portMAX_DELAY);
+      continue;
+    }
+#endif
+    if (!this->transfer_done_ || this->in_transfer_callback_)
+      return;
+    this->call_transfer_callbacks_();
+  }
+}
+
+void SPIComponent::loop() {
+#ifdef ARDUINO_ARCH_ESP32
+  if (this->transfer_active_)
+    this->poll_transfer_(0);
+#endif
+
+  if (!this->is_transfer_active())
+    // Only needs loop() while a transfer is running, re-enabled in write_array_async()
+    this->disable_loop();
+}
+
+void SPIComponent::finish_transfer_() {
+  if (this->active_cs_ != nullptr)
+    this->disable();
+  this->transfer_done_ = true;
+  this->call_transfer_callbacks_();
+}
+void SPIComponent::call_transfer_callbacks_() {
+  if (this->in_transfer_callback_)
+    // chained from a callback, called by the loop below once that returns
+    return;
+
+  this->in_transfer_callback_ = true;
+  while (this->transfer_done_) {
+    this->transfer_done_ = false;
+    std::function<void()> callback = std::move(this->transfer_callback_);
+    this->transfer_callback_ = nullptr;
+    if (callback)
+      callback();
+  }
+  this->in_transfer_callback_ = false;
+}
+
 void ICACHE_RAM_ATTR HOT SPIComponent::enable(GPIOPin *cs, bool msb_first, bool high_speed) {
-  ESP_LOGVV(TAG, "Enabling SPI Chip on pin %u...", cs->get_pin());
-  cs->digital_write(false);
+#ifdef ARDUINO_ARCH_ESP32
+  // don't wait for the whole running transfer, only for its current chunk (the callback can start another one)
+  while (this->transfer_active_ && !this->transfer_paused_)
+    this->pause_transfer_();
+#endif
+  this->wait_transfer();
 
+  ESP_LOGVV(TAG, "Enabling SPI Chip on pin %u...", cs->get_pin());
   this->active_cs_ = cs;
   this->msb_first_ = msb_first;
   this->high_speed_ = high_speed;
+
+#ifdef ARDUINO_ARCH_ESP8266
+  const uint8_t config = spi_config_index(msb_first, high_speed);
+  if (this->hardware_ && config != this->hw_config_) {
+    const uint32_t frequency = high_speed ? SPI_HIGH_SPEED_FREQUENCY : SPI_LOW_SPEED_FREQUENCY;
+    SPI.beginTransaction(SPISettings(frequency, msb_first ? MSBFIRST : LSBFIRST, SPI_MODE3));
+    this->hw_config_ = config;
+  }
+#endif
+  cs->digital_write(false);
 }
 
 void ICACHE_RAM_ATTR HOT SPIComponent::disable() {
   ESP_LOGVV(TAG, "Disabling SPI Chip on pin %u...", this->active_cs_->get_pin());
   this->active_cs_->digital_write(true);
   this->active_cs_ = nullptr;
+#ifdef ARDUINO_ARCH_ESP8266
+  if (this->hardware_)
+    SPI.endTransaction();
+#endif
+#ifdef ARDUINO_ARCH_ESP32
+  if (this->transfer_paused_)
+    this->resume_transfer_();
+#endif
 }
 void SPIComponent::setup() {
   ESP_LOGCONFIG(TAG, "Setting up SPI bus...");
+  if (this->can_use_hardware_()) {
+#ifdef ARDUINO_ARCH_ESP32
+    spi_bus_config_t bus_config{};
+    bus_config.sclk_io_num = this->clk_->get_pin();
+    bus_config.mosi_io_num = this->mosi_ != nullptr ? this->mosi_->get_pin() : -1;
+    bus_config.miso_io_num = this->miso_ != nullptr ? this->miso_->get_pin() : -1;
+    bus_config.quadwp_io_num = -1;
+    bus_config.quadhd_io_num = -1;
+    bus_config.max_transfer_sz = SPI_MAX_DMA_TRANSFER_LENGTH;
+    // DMA channel 1
+    this->hardware_ = spi_bus_initialize(SPI_HW_HOST, &bus_config, 1) == ESP_OK;
+    if (!this->hardware_)
+      ESP_LOGW(TAG, "Initializing hardware SPI failed, falling back to software SPI.");
+#else
+    SPI.begin();
+    this->hardware_ = true;
+#endif
+    if (this->hardware_)
+      return;
+  }
+
   this->clk_->setup();
   this->clk_->digital_write(true);
   if (this->miso_ != nullptr) {
@@ -101,10 +299,124 @@ void SPIComponent::dump_config() {
   LOG_PIN("  CLK Pin: ", this->clk_);
   LOG_PIN("  MISO Pin: ", this->miso_);
   LOG_PIN("  MOSI Pin: ", this->mosi_);
+#ifdef ARDUINO_ARCH_ESP32
+  ESP_LOGCONFIG(TAG, "  Mode: %s", this->hardware_ ? "hardware (DMA)" : "software");
+#else
+  ESP_LOGCONFIG(TAG, "  Mode: %s", this->hardware_ ? "hardware" : "software");
+#endif
+}
+bool SPIComponent::can_use_hardware_() const {
+  if (this->force_software_)
+    return false;
+  if (this->clk_->is_inverted() || (this->miso_ != nullptr && this->miso_->is_inverted()) ||
+      (this->mosi_ != nullptr && this->mosi_->is_inverted()))
+    return false;
+#ifdef ARDUINO_ARCH_ESP8266
+  // HSPI can't be routed to other pins
+  return this->clk_->get_pin() == 14 && (this->miso_ == nullptr || this->miso_->get_pin() == 12) &&
+         (this->mosi_ == nullptr || this->mosi_->get_pin() == 13);
+#else
+  // any pin through the GPIO matrix
+  return true;
+#endif
+}
+#ifdef ARDUINO_ARCH_ESP32
+spi_device_handle_t SPIComponent::get_hw_device_() {
+  const uint8_t config = spi_config_index(this->msb_first_, this->high_speed_);
+  if (this->hw_devices_[config] != nullptr)
+    return this->hw_devices_[config];
+
+  spi_device_interface_config_t device_config{};
+  // clock idles high and data is sampled on the rising edge, like with bit-banging
+  device_config.mode = 3;
+  device_config.clock_speed_hz = this->high_speed_ ? SPI_HIGH_SPEED_FREQUENCY : SPI_LOW_SPEED_FREQUENCY;
+  // chip select is done in enable()/disable()
+  device_config.spics_io_num = -1;
+  device_config.queue_size = 1;
+  if (!this->msb_first_)
+    device_config.flags = SPI_DEVICE_TXBIT_LSBFIRST | SPI_DEVICE_RXBIT_LSBFIRST;
+  esp_err_t err = spi_bus_add_device(SPI_HW_HOST, &device_config, &this->hw_devices_[config]);
+  if (err == ESP_ERR_NOT_FOUND) {
+    // a host only has 3 device slots, but there are 4 combinations of settings: free one that isn't in use
+    for (auto &device : this->hw_devices_) {
+      if (device == nullptr || (this->transfer_active_ && device == this->transfer_device_))
+        continue;
+      spi_bus_remove_device(device);
+      device = nullptr;
+      break;
+    }
+    err = spi_bus_add_device(SPI_HW_HOST, &device_config, &this->hw_devices_[config]);
+  }
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "Adding SPI device failed!");
+    this->hw_devices_[config] = nullptr;
+    return nullptr;
+  }
+  return this->hw_devices_[config];
 }
+bool SPIComponent::hw_transmit_(spi_transaction_t *transaction) {
+  spi_device_handle_t device = this->get_hw_device_();
+  return device != nullptr && spi_device_transmit(device, transaction) == ESP_OK;
+}
+void SPIComponent::queue_transfer_chunk_() {
+  const size_t chunk = std::min(this->transfer_remaining_, SPI_ASYNC_CHUNK_LENGTH);
+  this->hw_transaction_ = {};
+  this->hw_transaction_.length = chunk * 8;
+  this->hw_transaction_.tx_buffer = this->transfer_data_;
+  this->transfer_data_ += chunk;
+  this->transfer_remaining_ -= chunk;
+
+  spi_device_handle_t device = this->transfer_device_;
+  if (device == nullptr || spi_device_queue_trans(device, &this->hw_transaction_, portMAX_DELAY) != ESP_OK) {
+    ESP_LOGE(TAG, "Starting SPI transfer failed!");
+    this->transfer_remaining_ = 0;
+    this->transfer_active_ = false;
+    this->finish_transfer_();
+  }
+}
+void SPIComponent::poll_transfer_(uint32_t wait_ticks) {
+  if (this->transfer_paused_)
+    // no chunk on the bus, continued in disable()
+    return;
+  spi_transaction_t *result;
+  if (spi_device_get_trans_result(this->transfer_device_, &result, wait_ticks) != ESP_OK)
+    // still running
+    return;
+
+  if (this->transfer_remaining_ != 0) {
+    this->queue_transfer_chunk_();
+    return;
+  }
+  this->transfer_active_ = false;
+  this->finish_transfer_();
+}
+void SPIComponent::pause_transfer_() {
+  spi_transaction_t *result;
+  spi_device_get_trans_result(this->transfer_device_, &result, portMAX_DELAY);
+  if (this->transfer_remaining_ == 0) {
+    // that was the last chunk
+    this->transfer_active_ = false;
+    this->finish_transfer_();
+    return;
+  }
+
+  ESP_LOGVV(TAG, "Pausing transfer of SPI Chip on pin %u...", this->transfer_cs_->get_pin());
+  this->transfer_paused_ = true;
+  this->transfer_cs_->digital_write(true);
+  this->active_cs_ = nullptr;
+}
+void SPIComponent::resume_transfer_() {
+  ESP_LOGVV(TAG, "Resuming transfer of SPI Chip on pin %u...", this->transfer_cs_->get_pin());
+  this->transfer_paused_ = false;
+  this->active_cs_ = this->transfer_cs_;
+  this->active_cs_->digital_write(false);
+  this->queue_transfer_chunk_();
+}
+#endif
 float SPIComponent::get_setup_priority() const { return setup_priority::PRE_HARDWARE; }
 void SPIComponent::set_miso(const GPIOInputPin &miso) { this->miso_ = miso.copy(); }
 void SPIComponent::set_mosi(const GPIOOutputPin &mosi) { this->mosi_ = mosi.copy(); }
+void SPIComponent::set_force_software(bool force_software) { this->force_software_ = force_software; }
 
 SPIDevice::SPIDevice(SPIComponent *parent, GPIOPin *cs) : parent_(parent), cs_(cs) {}
 void HOT SPIDevice::enable() {
@@ -114,7 +426,11 @@ void HOT SPIDevice::disable() { this->parent_->disable(); }
 uint8_t HOT SPIDevice::read_byte() { return this->parent_->read_byte(); }
 void HOT SPIDevice::read_array(uint8_t *data, size_t length) { return this->parent_->read_array(data, length); }
 void HOT SPIDevice::write_byte(uint8_t data) { return this->parent_->write_byte(data); }
-void HOT SPIDevice::write_array(uint8_t *data, size_t length) { this->parent_->write_array(data, length); }
+void HOT SPIDevice::write_array(const uint8_t *data, size_t length) { this->parent_->write_array(data, length); }
+void SPIDevice::write_array_async(const uint8_t *data, size_t length, std::function<void()> &&callback) {
+  this->parent_->write_array_async(data, length, std::move(callback));
+}
+void SPIDevice::wait_transfer() { this->parent_->wait_transfer(); }
 void SPIDevice::spi_setup() {
   this->cs_->setup();
   this->cs_->digital_write(true);
@@ -5,11 +5,25 @@
 
 #ifdef USE_SPI
 
+#include <functional>
 #include "esphome/component.h"
 #include "esphome/esphal.h"
 
+#ifdef ARDUINO_ARCH_ESP32
+#include <driver/spi_master.h>
+#endif
+
 ESPHOME_NAMESPACE_BEGIN
 
+/** SPI bus master.
+ *
+ * Uses the hardware SPI peripheral if the pins allow it (any pins on the ESP32, the HSPI pins CLK=14,
+ * MISO=12, MOSI=13 on the ESP8266) and falls back to bit-banging otherwise. On the ESP32, bulk writes
+ * started with write_array_async() are done with DMA in the background while the main loop continues.
+ *
+ * The bus is only reconfigured when a chip with other settings (bit order, speed) is enabled than the last one,
+ * on the ESP32 the hardware device of each combination of settings is kept.
+ */
 class SPIComponent : public Component {
  public:
   SPIComponent(GPIOPin *clk, GPIOPin *miso, GPIOPin *mosi);
@@ -18,13 +32,35 @@ class SPIComponent : public Component {
 
   void dump_config() override;
 
+  void loop() override;
+
   uint8_t read_byte();
 
   void read_array(uint8_t *data, size_t length);
 
   void write_byte(uint8_t data);
 
-  void write_array(uint8_t *data, size_t length);
+  void write_array(const uint8_t *data, size_t length);
+
+  /** Write length bytes in the background and call callback from the main loop once they're sent.
+   *
+   * Must be called with a chip enabled, the chip is disabled again when the transfer is done. data needs to
+   * stay valid until then. The transfer is split into chunks, if another chip is enabled in the meantime it waits
+   * for the current chunk only: the transfer's chip is deselected until the other chip is disabled again, so that
+   * short transactions (like sensor reads) don't have to wait for a long transfer (like a display update).
+   * Without DMA the data is written right away and the callback is called from the next loop iteration, or
+   * right after the running callback if this is chained from one.
+   */
+  void write_array_async(const uint8_t *data, size_t length, std::function<void()> &&callback);
+
+  /// Whether an asynchronous transfer is still running.
+  bool is_transfer_active() const;
+
+  /** Block until the running asynchronous transfer (if any) is done and its callback was called.
+   *
+   * Returns right away while the transfer is paused for a chip that was enabled in between its chunks.
+   */
+  void wait_transfer();
 
   void enable(GPIOPin *cs, bool msb_first, bool high_speed);
 
@@ -36,13 +72,59 @@ class SPIComponent : public Component {
 
   void set_mosi(const GPIOOutputPin &mosi);
 
+  /// Always bit-bang, even if the pins could be used with the hardware SPI peripheral.
+  void set_force_software(bool force_software);
+
  protected:
+  /// Whether the pins can be driven by the hardware SPI peripheral.
+  bool can_use_hardware_() const;
+  /// Deselect the chip of the finished asynchronous transfer and call its callback.
+  void finish_transfer_();
+  /// Call the callbacks of finished transfers, including those of transfers chained by the callbacks.
+  void call_transfer_callbacks_();
+
   GPIOPin *clk_;
   GPIOPin *miso_;
   GPIOPin *mosi_;
   GPIOPin *active_cs_{nullptr};
   bool msb_first_{true};
   bool high_speed_{false};
+  bool force_software_{false};
+  bool hardware_{false};
+  std::function<void()> transfer_callback_;
+  /// Set when a transfer finished and its callback still needs to be called.
+  bool transfer_done_{false};
+  /// Set while transfer callbacks are being called, so that chained transfers don't recurse.
+  bool in_transfer_callback_{false};
+#ifdef ARDUINO_ARCH_ESP32
+  /// Get the device handle for the current bit order and speed, (re-)adding the device if they changed.
+  spi_device_handle_t get_hw_device_();
+  /// Synchronously run one transaction on the hardware device.
+  bool hw_transmit_(spi_transaction_t *transaction);
+  /// Start the DMA transfer of the next chunk of the asynchronous transfer.
+  void queue_transfer_chunk_();
+  /// Check (waiting up to wait_ticks) if the DMA transfer of the current chunk is done and continue with the next.
+  void poll_transfer_(uint32_t wait_ticks);
+
+  /// Wait for the chunk on the bus and deselect the chip of the transfer, so that another chip can be used.
+  void pause_transfer_();
+  /// Select the chip of the paused transfer again and continue with its next chunk.
+  void resume_transfer_();
+
+  /// The hardware device for each combination of bit order and speed, added on first use.
+  spi_device_handle_t hw_devices_[4]{};
+  spi_transaction_t hw_transaction_;
+  spi_device_handle_t transfer_device_{nullptr};
+  GPIOPin *transfer_cs_{nullptr};
+  const uint8_t *transfer_data_{nullptr};
+  size_t transfer_remaining_{0};
+  bool transfer_active_{false};
+  bool transfer_paused_{false};
+#endif
+#ifdef ARDUINO_ARCH_ESP8266
+  /// Bit order and speed the hardware SPI was last set up for, 0xFF if not yet.
+  uint8_t hw_config_{0xFF};
+#endif
 };
 
 class SPIDevice {
@@ -61,7 +143,13 @@ class SPIDevice {
 
   void write_byte(uint8_t data);
 
-  void write_array(uint8_t *data, size_t length);
+  void write_array(const uint8_t *data, size_t length);
+
+  /// Write data in the background, see SPIComponent::write_array_async().
+  void write_array_async(const uint8_t *data, size_t length, std::function<void()> &&callback);
+
+  /// Block until the bus has finished its asynchronous transfer.
+  void wait_transfer();
 
  protected:
   virtual bool is_device_msb_first() = 0;
@@ -21,6 +21,12 @@ void A4988::setup() {
   this->step_pin_->digital_write(false);
   this->dir_pin_->setup();
   this->dir_pin_->digital_write(false);
+
+  // also needed without a timer of our own when a motion planner drives this stepper
+  this->step_isr_pin_ = this->step_pin_->to_isr();
+  this->dir_isr_pin_ = this->dir_pin_->to_isr();
+  this->pulse_cycles_ = 5 * ESP.getCpuFreqMHz();
+  this->setup_timer_();
 }
 void A4988::dump_config() {
   ESP_LOGCONFIG(TAG, "A4988:");
@@ -34,6 +40,9 @@ void A4988::loop() {
   if (this->sleep_pin_ != nullptr) {
     this->sleep_pin_->digital_write(!at_target);
   }
+  if (this->update_timer_())
+    return;
+
   if (at_target) {
     this->high_freq_.stop();
   } else {
@@ -49,6 +58,14 @@ void A4988::loop() {
   delayMicroseconds(5);
   this->step_pin_->digital_write(false);
 }
+void ICACHE_RAM_ATTR HOT A4988::timer_step_(int32_t dir) {
+  this->dir_isr_pin_->digital_write(dir == 1);
+  this->step_isr_pin_->digital_write(true);
+  const uint32_t start = ESP.getCycleCount();
+  while (ESP.getCycleCount() - start < this->pulse_cycles_)
+    ;
+  this->step_isr_pin_->digital_write(false);
+}
 float A4988::get_setup_priority() const { return setup_priority::HARDWARE; }
 A4988::A4988(GPIOPin *step_pin, GPIOPin *dir_pin) : step_pin_(step_pin), dir_pin_(dir_pin) {}
 void A4988::set_sleep_pin(const GPIOOutputPin &sleep_pin) { this->sleep_pin_ = sleep_pin.copy(); }
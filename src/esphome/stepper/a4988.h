@@ -23,10 +23,17 @@ class A4988 : public Stepper, public Component {
   float get_setup_priority() const override;
 
  protected:
+  void timer_step_(int32_t dir) override;
+
   GPIOPin *step_pin_;
   GPIOPin *dir_pin_;
   GPIOPin *sleep_pin_{nullptr};
   HighFrequencyLoopRequester high_freq_;
+  /// Copies of the step and dir pins for the step timer interrupt.
+  ISRInternalGPIOPin *step_isr_pin_{nullptr};
+  ISRInternalGPIOPin *dir_isr_pin_{nullptr};
+  /// How long the step pulse is high, in CPU cycles.
+  uint32_t pulse_cycles_{0};
 };
 
 }  // namespace stepper
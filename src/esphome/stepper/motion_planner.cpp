@@ -0,0 +1,295 @@
+#include "esphome/defines.h"
+
+#ifdef USE_STEPPER_MOTION_PLANNER
+
+#include "esphome/stepper/motion_planner.h"
+#include "esphome/log.h"
+#include "esphome/espmath.h"
+#include "esphome/helpers.h"
+
+ESPHOME_NAMESPACE_BEGIN
+
+namespace stepper {
+
+static const char *TAG = "stepper.motion_planner";
+
+/// The delay between starting the timer and the first step in timer ticks.
+static const uint32_t TIMER_START_TICKS = 50;
+
+void StepperMotionPlanner::add_axis(Stepper *stepper) {
+  if (this->axes_.size() >= MOTION_PLANNER_MAX_AXES) {
+    ESP_LOGE(TAG, "A motion planner can only have %u axes!", MOTION_PLANNER_MAX_AXES);
+    return;
+  }
+  // the planner steps the axis from its own timer
+  stepper->set_timer_driven(false);
+  this->axes_.push_back(stepper);
+}
+void StepperMotionPlanner::queue_move(const std::vector<int32_t> &targets, float max_speed) {
+  if (targets.size() != this->axes_.size()) {
+    ESP_LOGW(TAG, "Got %u targets for %u axes, ignoring move.", targets.size(), this->axes_.size());
+    return;
+  }
+  PendingMove move{};
+  for (uint8_t i = 0; i < targets.size(); i++)
+    move.targets[i] = targets[i];
+  move.max_speed = max_speed;
+  this->pending_.push_back(move);
+}
+bool StepperMotionPlanner::is_idle() const {
+  return this->pending_.empty() && this->tail_ == this->head_ && !this->timer_running_;
+}
+
+void StepperMotionPlanner::setup() {
+  this->timer_ = claim_step_timer(this);
+  if (this->timer_ < 0) {
+    ESP_LOGE(TAG, "All step timers are in use!");
+    this->mark_failed();
+    return;
+  }
+  for (uint8_t i = 0; i < this->axes_.size(); i++)
+    this->planned_position_[i] = this->axes_[i]->current_position;
+}
+void StepperMotionPlanner::loop() {
+  bool added = false;
+  auto it = this->pending_.begin();
+  for (; it != this->pending_.end(); it++) {
+    if ((this->head_ + 1) % MOTION_PLANNER_BUFFER_SIZE == this->tail_)
+      break;
+    added |= this->add_segment_(*it);
+  }
+  this->pending_.erase(this->pending_.begin(), it);
+
+  if (added)
+    this->replan_();
+
+  if (!this->timer_running_ && this->tail_ != this->head_) {
+    this->timer_running_ = true;
+    start_step_timer(this->timer_, TIMER_START_TICKS);
+  }
+}
+void StepperMotionPlanner::dump_config() {
+  ESP_LOGCONFIG(TAG, "Stepper Motion Planner:");
+  ESP_LOGCONFIG(TAG, "  Axes: %u", this->axes_.size());
+  ESP_LOGCONFIG(TAG, "  Look-Ahead: %u moves", MOTION_PLANNER_BUFFER_SIZE - 1);
+  if (this->is_failed())
+    ESP_LOGE(TAG, "  No step timer available!");
+}
+float StepperMotionPlanner::get_setup_priority() const { return setup_priority::HARDWARE_LATE; }
+
+bool StepperMotionPlanner::add_segment_(const PendingMove &move) {
+  if (this->tail_ == this->head_ && !this->timer_running_) {
+    // nothing is moving, the axes might have been moved or re-homed in the meantime
+    for (uint8_t i = 0; i < this->axes_.size(); i++)
+      this->planned_position_[i] = this->axes_[i]->current_position;
+  }
+
+  Segment &segment = this->segments_[this->head_];
+  float length_squared = 0.0f;
+  segment.step_events = 0;
+  for (uint8_t i = 0; i < this->axes_.size(); i++) {
+    const int32_t delta = move.targets[i] - this->planned_position_[i];
+    segment.dir[i] = delta < 0 ? -1 : 1;
+    segment.steps[i] = abs(delta);
+    segment.step_events = std::max(segment.step_events, segment.steps[i]);
+    length_squared += float(delta) * float(delta);
+  }
+  if (segment.step_events == 0)
+    return false;
+
+  segment.length = sqrtf(length_squared);
+  // the speed and acceleration along the path at which no axis exceeds its own limits
+  segment.max_speed = isnan(move.max_speed) ? INFINITY : move.max_speed;
+  segment.acceleration = INFINITY;
+  for (uint8_t i = 0; i < this->axes_.size(); i++) {
+    segment.unit[i] = float(segment.dir[i]) * segment.steps[i] / segment.length;
+    if (segment.steps[i] == 0)
+      continue;
+    const Stepper *axis = this->axes_[i];
+    const float scale = segment.length / segment.steps[i];
+    segment.max_speed = std::min(segment.max_speed, axis->max_speed_ * scale);
+    segment.acceleration = std::min(segment.acceleration, std::min(axis->acceleration_, axis->deceleration_) * scale);
+  }
+
+  // At a corner the speed is limited by the cosine of the angle between the moves, so the axes that reverse come
+  // to a stop and a straight continuation keeps the full speed.
+  segment.max_entry_speed = 0.0f;
+  const uint8_t previous = (this->head_ + MOTION_PLANNER_BUFFER_SIZE - 1) % MOTION_PLANNER_BUFFER_SIZE;
+  if (this->head_ != this->tail_ || this->busy_) {
+    const Segment &prev = this->segments_[previous];
+    float cos_theta = 0.0f;
+    for (uint8_t i = 0; i < this->axes_.size(); i++)
+      cos_theta += prev.unit[i] * segment.unit[i];
+    if (cos_theta > 0.0f)
+      segment.max_entry_speed = std::min(prev.max_speed, segment.max_speed) * cos_theta;
+  }
+  segment.entry_speed = 0.0f;
+  this->calculate_profile_(segment, 0.0f, 0.0f, segment.profile);
+
+  for (uint8_t i = 0; i < this->axes_.size(); i++)
+    this->planned_position_[i] = move.targets[i];
+  this->head_ = (this->head_ + 1) % MOTION_PLANNER_BUFFER_SIZE;
+  return true;
+}
+uint8_t StepperMotionPlanner::get_first_plannable_() const {
+  if (this->busy_)
+    return (this->tail_ + 1) % MOTION_PLANNER_BUFFER_SIZE;
+  return this->tail_;
+}
+void StepperMotionPlanner::replan_() {
+  float entry[MOTION_PLANNER_BUFFER_SIZE];
+  Segment::Profile profiles[MOTION_PLANNER_BUFFER_SIZE];
+
+  // The step timer can start a segment at any time. Plan without blocking it and only commit if it hasn't started
+  // any of the planned segments in the meantime, otherwise the entry speed of the first segment has changed.
+  while (true) {
+    disable_interrupts();
+    const uint8_t first = this->get_first_plannable_();
+    // a running segment ends at the entry speed of the next one, otherwise the first segment starts at standstill
+    const float first_entry = this->busy_ ? this->segments_[first].entry_speed : 0.0f;
+    enable_interrupts();
+    const uint8_t head = this->head_;
+    const uint8_t count = (head + MOTION_PLANNER_BUFFER_SIZE - first) % MOTION_PLANNER_BUFFER_SIZE;
+    if (count == 0)
+      return;
+
+    // backward pass: the highest entry speeds from which the end of the queue can still be reached at standstill
+    float exit_speed = 0.0f;
+    for (uint8_t j = count; j-- > 0;) {
+      const Segment &segment = this->segments_[(first + j) % MOTION_PLANNER_BUFFER_SIZE];
+      const float reachable = sqrtf(exit_speed * exit_speed + 2.0f * segment.acceleration * segment.length);
+      entry[j] = std::min(segment.max_entry_speed, reachable);
+      exit_speed = entry[j];
+    }
+    // forward pass: limit each entry speed to what can be reached by accelerating from the previous one
+    entry[0] = first_entry;
+    for (uint8_t j = 0; j < count; j++) {
+      const Segment &segment = this->segments_[(first + j) % MOTION_PLANNER_BUFFER_SIZE];
+      float next = 0.0f;
+      if (j + 1 < count) {
+        const float reachable = sqrtf(entry[j] * entry[j] + 2.0f * segment.acceleration * segment.length);
+        next = std::min(entry[j + 1], reachable);
+        entry[j + 1] = next;
+      }
+      this->calculate_profile_(segment, entry[j], next, profiles[j]);
+    }
+
+    disable_interrupts();
+    if (this->get_first_plannable_() != first) {
+      enable_interrupts();
+      continue;
+    }
+    for (uint8_t j = 0; j < count; j++) {
+      Segment &segment = this->segments_[(first + j) % MOTION_PLANNER_BUFFER_SIZE];
+      segment.entry_speed = entry[j];
+      segment.profile = profiles[j];
+    }
+    enable_interrupts();
+    return;
+  }
+}
+void StepperMotionPlanner::calculate_profile_(const Segment &segment, float entry_speed, float exit_speed,
+                                              Segment::Profile &profile) {
+  // The step timer counts in steps of the axis with the most steps, convert speeds along the path to its step rate.
+  const float k = segment.step_events / segment.length;
+  const float accel = segment.acceleration * k;
+  const float cruise_speed = std::min(segment.max_speed * k, float(STEP_TIMER_FREQUENCY / STEP_TIMER_MIN_TICKS));
+  const float entry_ramp = (entry_speed * k) * (entry_speed * k) / (2.0f * accel);
+  const float exit_ramp = (exit_speed * k) * (exit_speed * k) / (2.0f * accel);
+  const float cruise_ramp = cruise_speed * cruise_speed / (2.0f * accel);
+  const float n = segment.step_events;
+
+  float accelerate_steps = std::max(cruise_ramp - entry_ramp, 0.0f);
+  float decelerate_steps = std::max(cruise_ramp - exit_ramp, 0.0f);
+  float peak_ramp = cruise_ramp;
+  if (accelerate_steps + decelerate_steps > n) {
+    // no room to reach the cruise speed, accelerate until the ramps meet
+    accelerate_steps = clamp(0.0f, n, (n + exit_ramp - entry_ramp) / 2.0f);
+    decelerate_steps = n - accelerate_steps;
+    peak_ramp = entry_ramp + accelerate_steps;
+  }
+
+  profile.accelerate_until = uint32_t(accelerate_steps);
+  profile.decelerate_after = uint32_t(n - decelerate_steps);
+  profile.entry_ramp = uint32_t(entry_ramp);
+  // see Stepper::calculate_timer_profile_() for the first interval from standstill
+  float initial = profile.entry_ramp == 0 ? 0.676f * STEP_TIMER_FREQUENCY * sqrtf(2.0f / accel)
+                                          : STEP_TIMER_FREQUENCY / (entry_speed * k);
+  float cruise = peak_ramp > 0.5f ? STEP_TIMER_FREQUENCY / sqrtf(2.0f * accel * peak_ramp) : initial;
+  cruise = clamp(float(STEP_TIMER_MIN_TICKS), float(STEP_TIMER_MAX_TICKS), cruise);
+  initial = clamp(cruise, float(STEP_TIMER_MAX_TICKS), initial);
+  profile.initial_interval = uint32_t(initial * 256.0f);
+  profile.cruise_interval = uint32_t(cruise * 256.0f);
+}
+
+void ICACHE_RAM_ATTR HOT StepperMotionPlanner::start_segment_() {
+  const Segment &segment = this->segments_[this->tail_];
+  this->busy_ = true;
+  this->step_count_ = 0;
+  this->ramp_ = segment.profile.entry_ramp;
+  this->interval_ = segment.profile.initial_interval;
+  for (uint8_t i = 0; i < this->axes_.size(); i++)
+    this->error_[i] = segment.step_events / 2;
+}
+uint32_t ICACHE_RAM_ATTR HOT StepperMotionPlanner::on_step_timer() {
+  if (!this->busy_) {
+    if (this->tail_ == this->head_) {
+      this->timer_running_ = false;
+      return 0;
+    }
+    this->start_segment_();
+  }
+
+  const Segment &segment = this->segments_[this->tail_];
+  // Bresenham: the axis with the most steps steps every time, the others whenever their error overflows
+  for (uint8_t i = 0; i < this->axes_.size(); i++) {
+    this->error_[i] -= segment.steps[i];
+    if (this->error_[i] < 0) {
+      this->error_[i] += segment.step_events;
+      Stepper *axis = this->axes_[i];
+      axis->timer_step_(segment.dir[i]);
+      axis->current_position += segment.dir[i];
+      axis->target_position = axis->current_position;
+    }
+  }
+  this->step_count_++;
+
+  if (this->step_count_ == segment.step_events) {
+    this->busy_ = false;
+    this->tail_ = (this->tail_ + 1) % MOTION_PLANNER_BUFFER_SIZE;
+    if (this->tail_ == this->head_) {
+      this->timer_running_ = false;
+      return 0;
+    }
+    this->start_segment_();
+    return this->interval_ >> 8;
+  }
+
+  // the same recurrences as Stepper::on_step_timer()
+  if (this->step_count_ < segment.profile.accelerate_until) {
+    // c_n = c_(n-1) - 2 * c_(n-1) / (4n + 1), the first step from standstill keeps c_0
+    if (this->ramp_ != 0)
+      this->interval_ -= 2 * this->interval_ / (4 * this->ramp_ + 1);
+    this->ramp_++;
+    if (this->interval_ < segment.profile.cruise_interval)
+      this->interval_ = segment.profile.cruise_interval;
+  } else if (this->step_count_ >= segment.profile.decelerate_after) {
+    // c_n = c_(n-1) + 2 * c_(n-1) / (4n - 1), counting n down to 1
+    const uint32_t n = std::max(this->ramp_, uint32_t(1));
+    this->interval_ += 2 * this->interval_ / (4 * n - 1);
+    if (this->ramp_ > 1)
+      this->ramp_--;
+  } else {
+    this->interval_ = segment.profile.cruise_interval;
+  }
+
+  if (this->interval_ > (STEP_TIMER_MAX_TICKS << 8))
+    this->interval_ = STEP_TIMER_MAX_TICKS << 8;
+  return this->interval_ >> 8;
+}
+
+}  // namespace stepper
+
+ESPHOME_NAMESPACE_END
+
+#endif  // USE_STEPPER_MOTION_PLANNER
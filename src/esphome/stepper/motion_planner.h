@@ -0,0 +1,165 @@
+#ifndef ESPHOME_STEPPER_MOTION_PLANNER_H
+#define ESPHOME_STEPPER_MOTION_PLANNER_H
+
+#include "esphome/defines.h"
+
+#ifdef USE_STEPPER_MOTION_PLANNER
+
+#include <vector>
+#include "esphome/component.h"
+#include "esphome/automation.h"
+#include "esphome/stepper/stepper.h"
+
+ESPHOME_NAMESPACE_BEGIN
+
+namespace stepper {
+
+/// The most steppers a StepperMotionPlanner can coordinate.
+#define MOTION_PLANNER_MAX_AXES 4
+/// How many moves the planner looks ahead (and the step timer can run without loop()).
+#define MOTION_PLANNER_BUFFER_SIZE 16
+
+template<typename... Ts> class MotionPlannerMoveAction;
+
+/** Move several steppers in synchronized straight lines through a queue of targets.
+ *
+ * Each queued move goes from the end of the previous move to absolute positions for all axes. A hardware step timer
+ * (see claim_step_timer()) distributes the steps of the axis with the most steps to the others Bresenham-style,
+ * so all axes arrive together. Consecutive moves are blended: the planner looks ahead over the buffered moves and
+ * only slows down at corners (by the cosine of the angle between the moves) and as far as needed to stop at the end
+ * of the queue.
+ *
+ * The speed and acceleration along the path are limited by those of the axes (set_max_speed() and
+ * set_acceleration() of each stepper) and optionally by a per-move speed. The axes don't use their own step timer,
+ * and their targets shouldn't be set directly while the planner moves them.
+ */
+class StepperMotionPlanner : public Component, public StepTimerHandler {
+ public:
+  /// Add an axis, the order of the axes is the order of the targets of a move.
+  void add_axis(Stepper *stepper);
+
+  /** Queue a move.
+   *
+   * @param targets The absolute target position of each axis, in the order they were added.
+   * @param max_speed The highest speed along the path of this move in steps/s, NAN to only use the axis limits.
+   */
+  void queue_move(const std::vector<int32_t> &targets, float max_speed = NAN);
+
+  /// Whether all queued moves have been completed.
+  bool is_idle() const;
+
+  template<typename... Ts> MotionPlannerMoveAction<Ts...> *make_move_action();
+
+  void setup() override;
+  void loop() override;
+  void dump_config() override;
+  float get_setup_priority() const override;
+
+  uint32_t on_step_timer() override;
+
+ protected:
+  struct Segment {
+    // Planning, only used by loop()
+    /// Euclidean length of the move in steps.
+    float length;
+    /// The direction of the move, normalized.
+    float unit[MOTION_PLANNER_MAX_AXES];
+    /// The speed and acceleration limits along the path.
+    float max_speed;
+    float acceleration;
+    /// The highest speed at which this move may be entered from the previous one.
+    float max_entry_speed;
+    float entry_speed;
+
+    // Execution, read by the step timer
+    int8_t dir[MOTION_PLANNER_MAX_AXES];
+    uint32_t steps[MOTION_PLANNER_MAX_AXES];
+    /// The steps of the axis with the most steps, one timer interrupt each.
+    uint32_t step_events;
+    /// The speed profile, only replaced with interrupts disabled while the segment hasn't been started.
+    struct Profile {
+      /// Accelerate before this step event, decelerate from this step event on.
+      uint32_t accelerate_until;
+      uint32_t decelerate_after;
+      /// The speed ramp position at the first step event, see Stepper::on_step_timer().
+      uint32_t entry_ramp;
+      /// The step intervals at the start and at the cruise speed, in timer ticks with 8 fractional bits.
+      uint32_t initial_interval;
+      uint32_t cruise_interval;
+    } profile;
+  };
+  struct PendingMove {
+    int32_t targets[MOTION_PLANNER_MAX_AXES];
+    float max_speed;
+  };
+
+  /// Turn a pending move into a segment at the head of the buffer, returns false if it has zero length.
+  bool add_segment_(const PendingMove &move);
+  /// Recalculate the speed profile of all segments that haven't been started.
+  void replan_();
+  /// Calculate the step timer profile of a segment from its entry and exit speed.
+  static void calculate_profile_(const Segment &segment, float entry_speed, float exit_speed,
+                                 Segment::Profile &profile);
+  /// The first segment that can be replanned, called with interrupts disabled.
+  uint8_t get_first_plannable_() const;
+  void start_segment_();
+
+  std::vector<Stepper *> axes_;
+  std::vector<PendingMove> pending_;
+  /// The position at the end of the last buffered move.
+  int32_t planned_position_[MOTION_PLANNER_MAX_AXES]{};
+
+  Segment segments_[MOTION_PLANNER_BUFFER_SIZE];
+  /// Where the next segment is added, written by loop().
+  volatile uint8_t head_{0};
+  /// The segment that is running or runs next, advanced by the step timer.
+  volatile uint8_t tail_{0};
+  /// Whether the step timer has started the segment at tail_.
+  volatile bool busy_{false};
+  volatile bool timer_running_{false};
+  int8_t timer_{-1};
+
+  // State of the step timer
+  uint32_t step_count_{0};
+  uint32_t ramp_{0};
+  uint32_t interval_{0};
+  int32_t error_[MOTION_PLANNER_MAX_AXES]{};
+};
+
+/// Queue a move of a motion planner, the targets are given in the order of the axes.
+template<typename... Ts> class MotionPlannerMoveAction : public Action<Ts...> {
+ public:
+  explicit MotionPlannerMoveAction(StepperMotionPlanner *parent);
+
+  template<typename V> void add_target(V target) { this->targets_.push_back(target); }
+  template<typename V> void set_max_speed(V max_speed) { this->max_speed_ = max_speed; }
+
+  void play(Ts... x) override;
+
+ protected:
+  StepperMotionPlanner *parent_;
+  std::vector<TemplatableValue<int32_t, Ts...>> targets_;
+  TemplatableValue<float, Ts...> max_speed_{NAN};
+};
+
+template<typename... Ts>
+MotionPlannerMoveAction<Ts...>::MotionPlannerMoveAction(StepperMotionPlanner *parent) : parent_(parent) {}
+template<typename... Ts> void MotionPlannerMoveAction<Ts...>::play(Ts... x) {
+  std::vector<int32_t> targets;
+  targets.reserve(this->targets_.size());
+  for (auto &target : this->targets_)
+    targets.push_back(target.value(x...));
+  this->parent_->queue_move(targets, this->max_speed_.value(x...));
+  this->play_next(x...);
+}
+template<typename... Ts> MotionPlannerMoveAction<Ts...> *StepperMotionPlanner::make_move_action() {
+  return new MotionPlannerMoveAction<Ts...>(this);
+}
+
+}  // namespace stepper
+
+ESPHOME_NAMESPACE_END
+
+#endif  // USE_STEPPER_MOTION_PLANNER
+
+#endif  // ESPHOME_STEPPER_MOTION_PLANNER_H
@@ -5,6 +5,7 @@
 #include "esphome/stepper/stepper.h"
 #include "esphome/log.h"
 #include "esphome/espmath.h"
+#include "esphome/esphal.h"
 #include "esphome/helpers.h"
 
 ESPHOME_NAMESPACE_BEGIN
@@ -13,6 +14,78 @@ namespace stepper {
 
 static const char *TAG = "stepper";
 
+const uint32_t STEP_TIMER_FREQUENCY = 5000000;
+// the ESP8266 timer1 has 23 bits
+const uint32_t STEP_TIMER_MAX_TICKS = (1UL << 23) - 1;
+const uint32_t STEP_TIMER_MIN_TICKS = STEP_TIMER_FREQUENCY / 25000;
+/// The delay between starting the timer and the first step in timer ticks.
+static const uint32_t TIMER_START_TICKS = 50;
+
+#ifdef ARDUINO_ARCH_ESP8266
+static const uint8_t TIMER_COUNT = 1;
+#endif
+#ifdef ARDUINO_ARCH_ESP32
+static const uint8_t TIMER_COUNT = 4;
+static hw_timer_t *timers[TIMER_COUNT];
+#endif
+/// The handler that owns each hardware timer.
+static StepTimerHandler *timer_handlers[TIMER_COUNT];
+
+template<uint8_t N> static void ICACHE_RAM_ATTR HOT step_timer_isr() {
+  const uint32_t ticks = timer_handlers[N]->on_step_timer();
+#ifdef ARDUINO_ARCH_ESP8266
+  if (ticks == 0) {
+    timer1_disable();
+  } else {
+    timer1_write(ticks);
+  }
+#endif
+#ifdef ARDUINO_ARCH_ESP32
+  // the timer auto-reloads, the new alarm applies from now on
+  if (ticks == 0) {
+    timerAlarmDisable(timers[N]);
+  } else {
+    timerAlarmWrite(timers[N], ticks, true);
+  }
+#endif
+}
+
+int8_t claim_step_timer(StepTimerHandler *handler) {
+  for (uint8_t i = 0; i < TIMER_COUNT; i++) {
+    if (timer_handlers[i] != nullptr)
+      continue;
+    timer_handlers[i] = handler;
+#ifdef ARDUINO_ARCH_ESP8266
+    timer1_isr_init();
+    timer1_attachInterrupt(step_timer_isr<0>);
+#endif
+#ifdef ARDUINO_ARCH_ESP32
+    static void (*const TIMER_ISRS[TIMER_COUNT])() = {
+        step_timer_isr<0>,
+        step_timer_isr<1>,
+        step_timer_isr<2>,
+        step_timer_isr<3>,
+    };
+    // 80MHz APB clock / 16 = STEP_TIMER_FREQUENCY
+    timers[i] = timerBegin(i, 16, true);
+    timerAttachInterrupt(timers[i], TIMER_ISRS[i], true);
+#endif
+    return i;
+  }
+  return -1;
+}
+void start_step_timer(int8_t timer, uint32_t ticks) {
+#ifdef ARDUINO_ARCH_ESP8266
+  timer1_enable(TIM_DIV16, TIM_EDGE, TIM_SINGLE);
+  timer1_write(ticks);
+#endif
+#ifdef ARDUINO_ARCH_ESP32
+  timerWrite(timers[timer], 0);
+  timerAlarmWrite(timers[timer], ticks, true);
+  timerAlarmEnable(timers[timer]);
+#endif
+}
+
 void Stepper::calculate_speed_(uint32_t now) {
   // delta t since last calculation in seconds
   float dt = (now - this->last_calculation_) * 1e-6f;
@@ -52,11 +125,120 @@ int32_t Stepper::should_step_() {
 
   return 0;
 }
+
+void Stepper::setup_timer_() {
+  this->calculate_timer_profile_();
+  if (!this->timer_driven_)
+    return;
+
+  this->timer_ = claim_step_timer(this);
+  if (this->timer_ < 0)
+    ESP_LOGW(TAG, "All step timers are in use, stepping from loop() instead.");
+}
+bool Stepper::is_timer_driven_() const { return this->timer_ >= 0; }
+bool Stepper::update_timer_() {
+  if (this->timer_ < 0)
+    return false;
+  if (this->timer_running_ || this->has_reached_target())
+    return true;
+
+  this->timer_running_ = true;
+  start_step_timer(this->timer_, TIMER_START_TICKS);
+  return true;
+}
+void Stepper::calculate_timer_profile_() {
+  // the first interval of a ramp is 0.676 * sqrt(2 / a), see D. Austin, "Generate stepper-motor speed profiles in
+  // real time", which also describes the recurrence on_step_timer() uses for the following steps.
+  float first = 0.676f * STEP_TIMER_FREQUENCY * sqrtf(2.0f / this->acceleration_);
+  float min = STEP_TIMER_FREQUENCY / this->max_speed_;
+  min = clamp(float(STEP_TIMER_MIN_TICKS), float(STEP_TIMER_MAX_TICKS), min);
+  first = clamp(min, float(STEP_TIMER_MAX_TICKS), first);
+  this->timer_first_interval_ = uint32_t(first * 256.0f);
+  this->timer_min_interval_ = uint32_t(min * 256.0f);
+  this->timer_accel_to_decel_ = uint32_t(std::min(this->acceleration_ / this->deceleration_ * 65536.0f, 4e9f));
+  this->timer_decel_to_accel_ = uint32_t(std::min(this->deceleration_ / this->acceleration_ * 65536.0f, 4e9f));
+}
+uint32_t ICACHE_RAM_ATTR HOT Stepper::on_step_timer() {
+  const int32_t target = this->target_position;
+  if (this->timer_dir_ == 0) {
+    if (this->current_position == target) {
+      this->timer_running_ = false;
+      return 0;
+    }
+    // start a ramp from standstill
+    this->timer_dir_ = target > this->current_position ? 1 : -1;
+    this->timer_interval_ = 0;
+    this->timer_ramp_ = 0;
+    this->timer_decelerating_ = false;
+  }
+
+  this->timer_step_(this->timer_dir_);
+  this->current_position += this->timer_dir_;
+
+  // the steps left in the direction of movement, negative if the target is now behind
+  const int32_t remaining = (target - this->current_position) * this->timer_dir_;
+  if (remaining == 0) {
+    this->timer_dir_ = 0;
+    this->timer_running_ = false;
+    return 0;
+  }
+
+  uint32_t stop_steps = this->timer_ramp_;
+  if (!this->timer_decelerating_)
+    stop_steps = (uint64_t(stop_steps) * this->timer_accel_to_decel_) >> 16;
+  if (remaining < 0 || uint32_t(remaining) <= stop_steps) {
+    if (!this->timer_decelerating_) {
+      this->timer_ramp_ = stop_steps;
+      this->timer_decelerating_ = true;
+    }
+    if (this->timer_ramp_ <= 1 && remaining < 0) {
+      // standing still, turn around in the next interrupt
+      this->timer_dir_ = 0;
+      return this->timer_first_interval_ >> 8;
+    }
+    if (this->timer_interval_ == 0)
+      this->timer_interval_ = this->timer_first_interval_;
+    // c_n = c_(n-1) + 2 * c_(n-1) / (4n - 1), counting n down to 1
+    const uint32_t n = std::max(this->timer_ramp_, uint32_t(1));
+    this->timer_interval_ += 2 * this->timer_interval_ / (4 * n - 1);
+    if (this->timer_ramp_ > 1)
+      this->timer_ramp_--;
+  } else {
+    if (this->timer_decelerating_) {
+      this->timer_ramp_ = (uint64_t(this->timer_ramp_) * this->timer_decel_to_accel_) >> 16;
+      this->timer_decelerating_ = false;
+    }
+    if (this->timer_interval_ == 0) {
+      this->timer_interval_ = this->timer_first_interval_;
+    } else if (this->timer_interval_ > this->timer_min_interval_) {
+      // c_n = c_(n-1) - 2 * c_(n-1) / (4n + 1)
+      this->timer_ramp_++;
+      this->timer_interval_ -= 2 * this->timer_interval_ / (4 * this->timer_ramp_ + 1);
+    }
+    if (this->timer_interval_ < this->timer_min_interval_)
+      this->timer_interval_ = this->timer_min_interval_;
+  }
+
+  if (this->timer_interval_ > (STEP_TIMER_MAX_TICKS << 8))
+    this->timer_interval_ = STEP_TIMER_MAX_TICKS << 8;
+  return this->timer_interval_ >> 8;
+}
+
 void Stepper::set_target(int32_t steps) { this->target_position = steps; }
 void Stepper::report_position(int32_t steps) { this->current_position = steps; }
-void Stepper::set_acceleration(float acceleration) { this->acceleration_ = acceleration; }
-void Stepper::set_deceleration(float deceleration) { this->deceleration_ = deceleration; }
-void Stepper::set_max_speed(float max_speed) { this->max_speed_ = max_speed; }
+void Stepper::set_acceleration(float acceleration) {
+  this->acceleration_ = acceleration;
+  this->calculate_timer_profile_();
+}
+void Stepper::set_deceleration(float deceleration) {
+  this->deceleration_ = deceleration;
+  this->calculate_timer_profile_();
+}
+void Stepper::set_max_speed(float max_speed) {
+  this->max_speed_ = max_speed;
+  this->calculate_timer_profile_();
+}
+void Stepper::set_timer_driven(bool timer_driven) { this->timer_driven_ = timer_driven; }
 bool Stepper::has_reached_target() { return this->current_position == this->target_position; }
 
 }  // namespace stepper
@@ -18,9 +18,30 @@ template<typename... Ts> class ReportPositionAction;
 #define LOG_STEPPER(this) \
   ESP_LOGCONFIG(TAG, "  Acceleration: %.0f steps/s^2", this->acceleration_); \
   ESP_LOGCONFIG(TAG, "  Deceleration: %.0f steps/s^2", this->deceleration_); \
-  ESP_LOGCONFIG(TAG, "  Max Speed: %.0f steps/s", this->max_speed_);
+  ESP_LOGCONFIG(TAG, "  Max Speed: %.0f steps/s", this->max_speed_); \
+  ESP_LOGCONFIG(TAG, "  Timer Driven: %s", YESNO(this->is_timer_driven_()));
 
-class Stepper {
+/// The frequency the step timers count with, in Hz.
+extern const uint32_t STEP_TIMER_FREQUENCY;
+/// The longest and shortest step timer interval, in ticks.
+extern const uint32_t STEP_TIMER_MAX_TICKS;
+extern const uint32_t STEP_TIMER_MIN_TICKS;
+
+/// Receives the interrupts of a hardware step timer.
+class StepTimerHandler {
+ public:
+  /// Called from the timer interrupt, returns the ticks until the next call or 0 to stop the timer. Must be in IRAM.
+  virtual uint32_t on_step_timer() = 0;
+};
+
+/// Claim a free hardware step timer for handler, returns the timer or -1 if all are in use.
+int8_t claim_step_timer(StepTimerHandler *handler);
+/// Start a claimed step timer, the handler is called for the first time after ticks.
+void start_step_timer(int8_t timer, uint32_t ticks);
+
+class StepperMotionPlanner;
+
+class Stepper : public StepTimerHandler {
  public:
   void set_target(int32_t steps);
   void report_position(int32_t steps);
@@ -29,22 +50,68 @@ class Stepper {
   void set_max_speed(float max_speed);
   bool has_reached_target();
 
+  /** Generate the steps in a hardware timer interrupt instead of in loop(), defaults to true.
+   *
+   * The timer follows a trapezoidal speed profile (integer step intervals, see on_step_timer()), so the step rate
+   * doesn't depend on how often loop() runs - rates above 10kHz are possible and WiFi or MQTT don't make the motor
+   * stutter. The ESP8266 has one timer for this (timer1, which the ESP8266 PWM output also uses), the ESP32 four.
+   * Steppers that don't get a timer fall back to stepping from loop(). Under timer control the speed is
+   * between 0.6 and 25000 steps/s.
+   */
+  void set_timer_driven(bool timer_driven);
+
   template<typename... Ts> SetTargetAction<Ts...> *make_set_target_action();
   template<typename... Ts> ReportPositionAction<Ts...> *make_report_position_action();
 
-  int32_t current_position{0};
-  int32_t target_position{0};
+  volatile int32_t current_position{0};
+  volatile int32_t target_position{0};
 
  protected:
+  friend StepperMotionPlanner;
+
   void calculate_speed_(uint32_t now);
   int32_t should_step_();
 
+  /// Try to get a hardware timer for this stepper, call in setup() of the driver.
+  void setup_timer_();
+  bool is_timer_driven_() const;
+  /// Start the timer if the stepper has to move, call in loop() of the driver. Returns false if not timer driven.
+  bool update_timer_();
+  /// Take one step in the direction dir (1 or -1) from the timer interrupt. Implementations must be in IRAM.
+  virtual void timer_step_(int32_t dir) {}
+  /// Recalculate the integer profile parameters of the timer.
+  void calculate_timer_profile_();
+  /// Advance the motion profile by one step, called from the timer interrupt. Returns the ticks until the next call.
+  uint32_t on_step_timer() override;
+
   float acceleration_{1e6f};
   float deceleration_{1e6f};
   float current_speed_{0.0f};
   float max_speed_{1e6f};
   uint32_t last_calculation_{0};
   uint32_t last_step_{0};
+
+  bool timer_driven_{true};
+  /// The hardware timer of this stepper, -1 if it steps from loop().
+  int8_t timer_{-1};
+  /// Whether the timer is running, cleared by the interrupt when it stops.
+  volatile bool timer_running_{false};
+  /// The direction the motor is moving in, 0 when standing still.
+  int32_t timer_dir_{0};
+  /// The interval until the next step in timer ticks, fixed point with 8 fractional bits. 0 before the first step.
+  uint32_t timer_interval_{0};
+  /** The position in the speed ramp, the speed is sqrt(2 * rate * ramp) with rate the acceleration or, while
+   * decelerating, the deceleration.
+   */
+  uint32_t timer_ramp_{0};
+  bool timer_decelerating_{false};
+  /// The first interval of a ramp from standstill (fixed point, 8 fractional bits).
+  uint32_t timer_first_interval_{0};
+  /// The interval at the maximum speed (fixed point, 8 fractional bits).
+  uint32_t timer_min_interval_{0};
+  /// acceleration / deceleration and its inverse in 16.16 fixed point, to convert ramp positions.
+  uint32_t timer_accel_to_decel_{1 << 16};
+  uint32_t timer_decel_to_accel_{1 << 16};
 };
 
 template<typename... Ts> class SetTargetAction : public Action<Ts...> {
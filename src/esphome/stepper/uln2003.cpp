@@ -17,6 +17,12 @@ void ULN2003::setup() {
   this->pin_b_->setup();
   this->pin_c_->setup();
   this->pin_d_->setup();
+  // also needed without a timer of our own when a motion planner drives this stepper
+  this->isr_pins_[0] = this->pin_a_->to_isr();
+  this->isr_pins_[1] = this->pin_b_->to_isr();
+  this->isr_pins_[2] = this->pin_c_->to_isr();
+  this->isr_pins_[3] = this->pin_d_->to_isr();
+  this->setup_timer_();
   this->loop();
 }
 void ULN2003::dump_config() {
@@ -54,6 +60,9 @@ void ULN2003::loop() {
       return;
     }
   } else {
+    // the timer interrupt writes the steps
+    if (this->update_timer_())
+      return;
     this->high_freq_.start();
 
     int dir = this->should_step_();
@@ -63,7 +72,20 @@ void ULN2003::loop() {
   this->write_step_(this->current_uln_pos_);
 }
 float ULN2003::get_setup_priority() const { return setup_priority::HARDWARE; }
+void ICACHE_RAM_ATTR HOT ULN2003::timer_step_(int32_t dir) {
+  this->current_uln_pos_ += dir;
+  const uint8_t res = this->step_pattern_(this->current_uln_pos_);
+  for (uint8_t i = 0; i < 4; i++)
+    this->isr_pins_[i]->digital_write((res >> i) & 1);
+}
 void ULN2003::write_step_(int32_t step) {
+  const uint8_t res = this->step_pattern_(step);
+  this->pin_a_->digital_write((res >> 0) & 1);
+  this->pin_b_->digital_write((res >> 1) & 1);
+  this->pin_c_->digital_write((res >> 2) & 1);
+  this->pin_d_->digital_write((res >> 3) & 1);
+}
+uint8_t ICACHE_RAM_ATTR HOT ULN2003::step_pattern_(int32_t step) {
   int32_t n = this->step_mode_ == ULN2003_STEP_MODE_HALF_STEP ? 8 : 4;
   auto i = static_cast<uint32_t>((step % n + n) % n);
   uint8_t res = 0;
@@ -94,10 +116,7 @@ void ULN2003::write_step_(int32_t step) {
     }
   }
 
-  this->pin_a_->digital_write((res >> 0) & 1);
-  this->pin_b_->digital_write((res >> 1) & 1);
-  this->pin_c_->digital_write((res >> 2) & 1);
-  this->pin_d_->digital_write((res >> 3) & 1);
+  return res;
 }
 void ULN2003::set_sleep_when_done(bool sleep_when_done) { this->sleep_when_done_ = sleep_when_done; }
 void ULN2003::set_step_mode(ULN2003StepMode step_mode) { this->step_mode_ = step_mode; }
@@ -30,6 +30,9 @@ class ULN2003 : public Stepper, public Component {
   void set_step_mode(ULN2003StepMode step_mode);
 
  protected:
+  void timer_step_(int32_t dir) override;
+  /// The coils (bit 0 = A to bit 3 = D) to energize at the given step.
+  uint8_t step_pattern_(int32_t step);
   void write_step_(int32_t step);
 
   bool sleep_when_done_{false};
@@ -40,6 +43,8 @@ class ULN2003 : public Stepper, public Component {
   ULN2003StepMode step_mode_{ULN2003_STEP_MODE_FULL_STEP};
   HighFrequencyLoopRequester high_freq_;
   int32_t current_uln_pos_{0};
+  /// Copies of the pins for the step timer interrupt.
+  ISRInternalGPIOPin *isr_pins_[4]{};
 };
 
 }  // namespace stepper
@@ -8,6 +8,10 @@
 
 #include "esphome/log.h"
 
+#ifdef USE_API
+#include "esphome/api/subscribe_state.h"
+#endif
+
 ESPHOME_NAMESPACE_BEGIN
 
 namespace switch_ {
@@ -45,7 +49,7 @@ void MQTTSwitchComponent::dump_config() {
 
 std::string MQTTSwitchComponent::component_type() const { return "switch"; }
 void MQTTSwitchComponent::send_discovery(JsonObject &root, mqtt::SendDiscoveryConfig &config) {
-  if (!this->switch_->get_icon().empty())
+  if (this->switch_->get_icon()[0] != '\0')
     root["icon"] = this->switch_->get_icon();
   if (this->switch_->assumed_state())
     root["optimistic"] = true;
@@ -54,6 +58,11 @@ bool MQTTSwitchComponent::send_initial_state() { return this->publish_state(this
 bool MQTTSwitchComponent::is_internal() { return this->switch_->is_internal(); }
 std::string MQTTSwitchComponent::friendly_name() const { return this->switch_->get_name(); }
 bool MQTTSwitchComponent::publish_state(bool state) {
+#ifdef USE_API
+  this->publish_binary_state_([this, state](api::APIBuffer &buffer) {
+    api::encode_switch_state(buffer, this->switch_, state);
+  });
+#endif
   const char *state_s = state ? "ON" : "OFF";
   return this->publish(this->get_state_topic_(), state_s);
 }
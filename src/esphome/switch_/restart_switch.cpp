@@ -12,7 +12,7 @@ namespace switch_ {
 
 static const char *TAG = "switch.restart";
 
-std::string RestartSwitch::icon() { return "mdi:restart"; }
+const char *RestartSwitch::icon() { return "mdi:restart"; }
 RestartSwitch::RestartSwitch(const std::string &name) : Switch(name) {}
 void RestartSwitch::write_state(bool state) {
   // Acknowledge
@@ -15,7 +15,7 @@ static const char *TAG = "switch.shutdown";
 
 ShutdownSwitch::ShutdownSwitch(const std::string &name) : Switch(name) {}
 
-std::string ShutdownSwitch::icon() { return "mdi:power"; }
+const char *ShutdownSwitch::icon() { return "mdi:power"; }
 void ShutdownSwitch::write_state(bool state) {
   // Acknowledge
   this->publish_state(false);
@@ -5,6 +5,7 @@
 #include "esphome/switch_/switch.h"
 #include "esphome/log.h"
 #include "esphome/esppreferences.h"
+#include "esphome/application.h"
 
 ESPHOME_NAMESPACE_BEGIN
 
@@ -12,28 +13,48 @@ namespace switch_ {
 
 static const char *TAG = "switch";
 
-std::string Switch::icon() { return ""; }
+const char *Switch::icon() { return ""; }
 Switch::Switch(const std::string &name) : Nameable(name), state(false) {}
 Switch::Switch() : Switch("") {}
 
-std::string Switch::get_icon() {
+const char *Switch::get_icon() {
   if (this->icon_.has_value())
-    return *this->icon_;
+    return this->icon_->c_str();
   return this->icon();
 }
 
 void Switch::set_icon(const std::string &icon) { this->icon_ = icon; }
 void Switch::turn_on() {
   ESP_LOGD(TAG, "'%s' Turning ON.", this->get_name().c_str());
-  this->write_state(!this->inverted_);
+  this->write_command_(!this->inverted_);
 }
 void Switch::turn_off() {
   ESP_LOGD(TAG, "'%s' Turning OFF.", this->get_name().c_str());
-  this->write_state(this->inverted_);
+  this->write_command_(this->inverted_);
 }
 void Switch::toggle() {
-  ESP_LOGD(TAG, "'%s' Toggling %s.", this->get_name().c_str(), this->state ? "OFF" : "ON");
-  this->write_state(this->inverted_ == this->state);
+  // toggle the state a pending command will write, so that two toggles in one window cancel out
+  const bool state = this->pending_command_.has_value() ? *this->pending_command_ != this->inverted_ : this->state;
+  ESP_LOGD(TAG, "'%s' Toggling %s.", this->get_name().c_str(), state ? "OFF" : "ON");
+  this->write_command_(this->inverted_ == state);
+}
+void Switch::set_command_window(uint32_t command_window) { this->command_window_ = command_window; }
+void Switch::write_command_(bool state) {
+  if (this->command_window_ == 0) {
+    this->write_state(state);
+    return;
+  }
+
+  const bool window_open = this->pending_command_.has_value();
+  this->pending_command_ = state;
+  if (window_open)
+    return;
+  // switches aren't components, so the timeout isn't bound to one
+  App.scheduler.set_timeout(nullptr, "", this->command_window_, [this]() {
+    const bool state = *this->pending_command_;
+    this->pending_command_.reset();
+    this->write_state(state);
+  });
 }
 optional<bool> Switch::get_initial_state() {
   this->rtc_ = global_preferences.make_preference<bool>(this->get_object_id_hash());
@@ -47,15 +68,12 @@ void Switch::publish_state(bool state) {
     return;
   this->state = state != this->inverted_;
 
-  this->rtc_.save(&this->state);
+  this->rtc_.save_deferred(&this->state);
   ESP_LOGD(TAG, "'%s': Sending state %s", this->name_.c_str(), ONOFF(state));
   this->state_callback_.call(this->state);
 }
 bool Switch::assumed_state() { return false; }
 
-void Switch::add_on_state_callback(std::function<void(bool)> &&callback) {
-  this->state_callback_.add(std::move(callback));
-}
 void Switch::set_inverted(bool inverted) { this->inverted_ = inverted; }
 uint32_t Switch::hash_base() { return 3129890955UL; }
 bool Switch::is_inverted() const { return this->inverted_; }
@@ -24,8 +24,8 @@ class SwitchTurnOffTrigger;
 #define LOG_SWITCH(prefix, type, obj) \
   if (obj != nullptr) { \
     ESP_LOGCONFIG(TAG, prefix type " '%s'", obj->get_name().c_str()); \
-    if (!obj->get_icon().empty()) { \
-      ESP_LOGCONFIG(TAG, prefix "  Icon: '%s'", obj->get_icon().c_str()); \
+    if (obj->get_icon()[0] != '\0') { \
+      ESP_LOGCONFIG(TAG, prefix "  Icon: '%s'", obj->get_icon()); \
     } \
     if (obj->assumed_state()) { \
       ESP_LOGCONFIG(TAG, prefix "  Assumed State: YES"); \
@@ -80,6 +80,14 @@ class Switch : public Nameable {
    */
   void toggle();
 
+  /** Coalesce the commands (turn_on(), turn_off(), toggle()) within command_window ms, for example rapid toggles
+   * from an automation.
+   *
+   * Only the state of the last command is written to the hardware (and so saved and published) at the end of the
+   * window. Defaults to 0 (write each command right away).
+   */
+  void set_command_window(uint32_t command_window);
+
   /** Set whether the state should be treated as inverted.
    *
    * To the developer and user an inverted switch will act just like a non-inverted one.
@@ -95,7 +103,7 @@ class Switch : public Nameable {
   void set_icon(const std::string &icon);
 
   /// Get the icon for this switch. Using icon() if not manually set
-  std::string get_icon();
+  const char *get_icon();
 
   template<typename... Ts> ToggleAction<Ts...> *make_toggle_action();
   template<typename... Ts> TurnOffAction<Ts...> *make_turn_off_action();
@@ -110,7 +118,7 @@ class Switch : public Nameable {
    *
    * @param callback The void(bool) callback.
    */
-  void add_on_state_callback(std::function<void(bool)> &&callback);
+  template<typename F> void add_on_state_callback(F &&callback);
 
   optional<bool> get_initial_state();
 
@@ -145,9 +153,11 @@ class Switch : public Nameable {
    *
    * @return The icon of this switch, for example "mdi:fan".
    */
-  virtual std::string icon();  // NOLINT
+  virtual const char *icon();  // NOLINT
 
   uint32_t hash_base() override;
+  /// Write state (inversion applied) now or at the end of the command window.
+  void write_command_(bool state);
 
   optional<std::string> icon_{};  ///< The icon shown here. Not set means use default from switch. Empty means no icon.
 
@@ -155,6 +165,9 @@ class Switch : public Nameable {
   bool inverted_{false};
   Deduplicator<bool> publish_dedup_;
   ESPPreferenceObject rtc_;
+  uint32_t command_window_{0};
+  /// The state to write at the end of the current command window.
+  optional<bool> pending_command_{};
 #ifdef USE_MQTT_SWITCH
   MQTTSwitchComponent *mqtt_{nullptr};
 #endif
@@ -194,6 +207,7 @@ template<typename... Ts> class SwitchCondition : public Condition<Ts...> {
  public:
   SwitchCondition(Switch *parent, bool state);
   bool check(Ts... x) override;
+  bool add_on_change_callback(std::function<void()> &&callback) override;
 
  protected:
   Switch *parent_;
@@ -248,9 +262,16 @@ template<typename... Ts> ToggleAction<Ts...> *Switch::make_toggle_action() { ret
 template<typename... Ts> TurnOffAction<Ts...> *Switch::make_turn_off_action() { return new TurnOffAction<Ts...>(this); }
 template<typename... Ts> TurnOnAction<Ts...> *Switch::make_turn_on_action() { return new TurnOnAction<Ts...>(this); }
 
+template<typename F> void Switch::add_on_state_callback(F &&callback) {
+  this->state_callback_.add(std::forward<F>(callback));
+}
 template<typename... Ts>
 SwitchCondition<Ts...>::SwitchCondition(Switch *parent, bool state) : parent_(parent), state_(state) {}
 template<typename... Ts> bool SwitchCondition<Ts...>::check(Ts... x) { return this->parent_->state == this->state_; }
+template<typename... Ts> bool SwitchCondition<Ts...>::add_on_change_callback(std::function<void()> &&callback) {
+  this->parent_->add_on_state_callback([callback](bool state) { callback(); });
+  return true;
+}
 
 template<typename... Ts> SwitchCondition<Ts...> *Switch::make_switch_is_on_condition() {
   return new SwitchCondition<Ts...>(this, true);
@@ -13,7 +13,7 @@ static const char *TAG = "text_sensor.mqtt";
 
 MQTTTextSensor::MQTTTextSensor(TextSensor *sensor) : MQTTComponent(), sensor_(sensor) {}
 void MQTTTextSensor::send_discovery(JsonObject &root, mqtt::SendDiscoveryConfig &config) {
-  if (!this->sensor_->get_icon().empty())
+  if (this->sensor_->get_icon()[0] != '\0')
     root["icon"] = this->sensor_->get_icon();
 
   if (!this->sensor_->unique_id().empty())
@@ -23,6 +23,7 @@ void TemplateTextSensor::update() {
   }
 }
 float TemplateTextSensor::get_setup_priority() const { return setup_priority::HARDWARE; }
+uint32_t TemplateTextSensor::get_loop_idle_time() { return SCHEDULER_DONT_RUN; }
 void TemplateTextSensor::set_template(std::function<optional<std::string>()> &&f) { this->f_ = f; }
 void TemplateTextSensor::dump_config() { LOG_TEXT_SENSOR("", "Template Sensor", this); }
 
@@ -19,6 +19,7 @@ class TemplateTextSensor : public TextSensor, public PollingComponent {
   void set_template(std::function<optional<std::string>()> &&f);
 
   void update() override;
+  uint32_t get_loop_idle_time() override;
 
   float get_setup_priority() const override;
 
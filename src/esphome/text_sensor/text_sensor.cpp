@@ -14,22 +14,30 @@ static const char *TAG = "text_sensor.text_sensor";
 TextSensor::TextSensor() : TextSensor("") {}
 TextSensor::TextSensor(const std::string &name) : Nameable(name) {}
 
-void TextSensor::publish_state(std::string state) {
-  this->state = state;
+void TextSensor::publish_state(const std::string &state) {
+  if (this->has_state_ && this->state == state)
+    return;
+  this->state.assign(state);
+  this->notify_state_();
+}
+void TextSensor::publish_state(const char *state) {
+  if (this->has_state_ && this->state.compare(state) == 0)
+    return;
+  this->state.assign(state);
+  this->notify_state_();
+}
+void TextSensor::notify_state_() {
   this->has_state_ = true;
-  ESP_LOGD(TAG, "'%s': Sending state '%s'", this->name_.c_str(), state.c_str());
-  this->callback_.call(state);
+  ESP_LOGD(TAG, "'%s': Sending state '%s'", this->name_.c_str(), this->state.c_str());
+  this->callback_.call(this->state);
 }
 void TextSensor::set_icon(const std::string &icon) { this->icon_ = icon; }
-void TextSensor::add_on_state_callback(std::function<void(std::string)> callback) {
-  this->callback_.add(std::move(callback));
-}
-std::string TextSensor::get_icon() {
+const char *TextSensor::get_icon() {
   if (this->icon_.has_value())
-    return *this->icon_;
+    return this->icon_->c_str();
   return this->icon();
 }
-std::string TextSensor::icon() { return ""; }
+const char *TextSensor::icon() { return ""; }
 std::string TextSensor::unique_id() { return ""; }
 TextSensorStateTrigger *TextSensor::make_state_trigger() { return new TextSensorStateTrigger(this); }
 bool TextSensor::has_state() { return this->has_state_; }
@@ -40,7 +48,7 @@ void TextSensor::set_mqtt(MQTTTextSensor *mqtt) { this->mqtt_ = mqtt; }
 #endif
 
 TextSensorStateTrigger::TextSensorStateTrigger(TextSensor *parent) {
-  parent->add_on_state_callback([this](std::string value) { this->trigger(value); });
+  parent->add_on_state_callback([this](const std::string &value) { this->trigger(value); });
 }
 
 }  // namespace text_sensor
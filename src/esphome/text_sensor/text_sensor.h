@@ -19,8 +19,8 @@ template<typename... Ts> class TextSensorPublishAction;
 #define LOG_TEXT_SENSOR(prefix, type, obj) \
   if (obj != nullptr) { \
     ESP_LOGCONFIG(TAG, prefix type " '%s'", obj->get_name().c_str()); \
-    if (!obj->get_icon().empty()) { \
-      ESP_LOGCONFIG(TAG, prefix "  Icon: '%s'", obj->get_icon().c_str()); \
+    if (obj->get_icon()[0] != '\0') { \
+      ESP_LOGCONFIG(TAG, prefix "  Icon: '%s'", obj->get_icon()); \
     } \
     if (!obj->unique_id().empty()) { \
       ESP_LOGV(TAG, prefix "  Unique ID: '%s'", obj->unique_id().c_str()); \
@@ -36,19 +36,25 @@ class TextSensor : public Nameable {
   explicit TextSensor();
   explicit TextSensor(const std::string &name);
 
-  void publish_state(std::string state);
+  /** Publish a new state, states equal to the current state are skipped.
+   *
+   * The state is copied into the existing buffer of state, so publishing a value that isn't longer than the
+   * previous ones doesn't allocate. Callbacks get a reference to state.
+   */
+  void publish_state(const std::string &state);
+  void publish_state(const char *state);
 
   void set_icon(const std::string &icon);
 
-  void add_on_state_callback(std::function<void(std::string)> callback);
+  template<typename F> void add_on_state_callback(F &&callback);
 
   std::string state;
 
   // ========== INTERNAL METHODS ==========
   // (In most use cases you won't need these)
-  std::string get_icon();
+  const char *get_icon();
 
-  virtual std::string icon();
+  virtual const char *icon();
 
   virtual std::string unique_id();
 
@@ -65,7 +71,10 @@ class TextSensor : public Nameable {
  protected:
   uint32_t hash_base() override;
 
-  CallbackManager<void(std::string)> callback_;
+  /// Log and notify the callbacks about the state that was just stored.
+  void notify_state_();
+
+  CallbackManager<void(const std::string &)> callback_;
   optional<std::string> icon_;
   bool has_state_{false};
 #ifdef USE_MQTT_TEXT_SENSOR
@@ -95,6 +104,9 @@ template<typename... Ts> void TextSensorPublishAction<Ts...>::play(Ts... x) {
   this->sensor_->publish_state(this->state_.value(x...));
   this->play_next(x...);
 }
+template<typename F> void TextSensor::add_on_state_callback(F &&callback) {
+  this->callback_.add(std::forward<F>(callback));
+}
 template<typename... Ts> TextSensorPublishAction<Ts...> *TextSensor::make_text_sensor_publish_action() {
   return new TextSensorPublishAction<Ts...>(this);
 }
@@ -22,7 +22,7 @@ void VersionTextSensor::setup() {
 float VersionTextSensor::get_setup_priority() const { return setup_priority::HARDWARE_LATE; }
 VersionTextSensor::VersionTextSensor(const std::string &name) : TextSensor(name) {}
 
-std::string VersionTextSensor::icon() { return "mdi:new-box"; }
+const char *VersionTextSensor::icon() { return "mdi:new-box"; }
 std::string VersionTextSensor::unique_id() { return get_mac_address() + "-version"; }
 void VersionTextSensor::dump_config() { LOG_TEXT_SENSOR("", "Version Text Sensor", this); }
 
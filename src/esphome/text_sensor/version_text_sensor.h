@@ -18,7 +18,7 @@ class VersionTextSensor : public TextSensor, public Component {
   void setup() override;
   void dump_config() override;
   float get_setup_priority() const override;
-  std::string icon() override;
+  const char *icon() override;
   std::string unique_id() override;
 };
 
@@ -12,23 +12,36 @@ namespace time {
 static const char *TAG = "time.rtc";
 
 RealTimeClockComponent::RealTimeClockComponent() {}
-void RealTimeClockComponent::set_timezone(const std::string &tz) { this->timezone_ = tz; }
+void RealTimeClockComponent::set_timezone(const std::string &tz) {
+  this->timezone_ = tz;
+  // the cached local time is in the old time zone
+  this->now_cache_.time = 0;
+}
 std::string RealTimeClockComponent::get_timezone() { return this->timezone_; }
 ESPTime RealTimeClockComponent::now() {
   time_t t = ::time(nullptr);
-  struct tm *c_tm = ::localtime(&t);
-  return ESPTime::from_tm(c_tm, t);
+  if (t != this->now_cache_.time) {
+    struct tm c_tm;
+    ::localtime_r(&t, &c_tm);
+    this->now_cache_ = ESPTime::from_tm(&c_tm, t);
+  }
+  return this->now_cache_;
 }
 ESPTime RealTimeClockComponent::utcnow() {
   time_t t = ::time(nullptr);
-  struct tm *c_tm = ::gmtime(&t);
-  return ESPTime::from_tm(c_tm, t);
+  if (t != this->utcnow_cache_.time) {
+    struct tm c_tm;
+    ::gmtime_r(&t, &c_tm);
+    this->utcnow_cache_ = ESPTime::from_tm(&c_tm, t);
+  }
+  return this->utcnow_cache_;
 }
 CronTrigger *RealTimeClockComponent::make_cron_trigger() { return new CronTrigger(this); }
 void RealTimeClockComponent::call_setup() {
   this->setup_internal_();
   setenv("TZ", this->timezone_.c_str(), 1);
   tzset();
+  this->now_cache_.time = 0;
   this->setup();
 }
 
@@ -140,33 +153,66 @@ void CronTrigger::loop() {
   ESPTime time = this->rtc_->now();
   if (!time.is_valid())
     return;
+  if (time.time == this->last_check_)
+    // already handled this second
+    return;
 
-  if (this->last_check_.has_value()) {
-    if (*this->last_check_ >= time) {
-      // already handled this one
-      return;
-    }
-
-    while (true) {
-      this->last_check_->increment_second();
-      if (*this->last_check_ >= time)
-        break;
-
-      if (this->matches(*this->last_check_))
-        this->trigger();
-    }
-  }
-
-  this->last_check_ = time;
   if (!time.in_range()) {
     ESP_LOGW(TAG, "Time is out of range!");
     ESP_LOGD(TAG, "Second=%02u Minute=%02u Hour=%02u DayOfWeek=%u DayOfMonth=%u DayOfYear=%u Month=%u time=%ld",
              time.second, time.minute, time.hour, time.day_of_week, time.day_of_month, time.day_of_year, time.month,
              time.time);
+    return;
+  }
+
+  if (!this->has_next_fire_ || time.time < this->last_check_) {
+    // first valid time or the clock was set back, don't fire for the seconds in between
+    this->next_fire_ = this->find_next_(time.time);
+    this->has_next_fire_ = true;
   }
+  this->last_check_ = time.time;
 
-  if (this->matches(time))
+  // like when checking every second, seconds that were skipped (for example because the clock was adjusted)
+  // still fire
+  while (this->next_fire_.has_value() && *this->next_fire_ <= time.time) {
     this->trigger();
+    this->next_fire_ = this->find_next_(*this->next_fire_ + 1);
+  }
+}
+optional<time_t> CronTrigger::find_next_(time_t from) {
+  time_t t = from;
+  // each step skips at least a second and mostly a whole unit, enough for rare combinations like Friday the 13th
+  for (uint16_t i = 0; i < 2000; i++) {
+    struct tm c_tm;
+    ::localtime_r(&t, &c_tm);
+    const ESPTime time = ESPTime::from_tm(&c_tm, t);
+    if (this->matches(time))
+      return t;
+
+    // jump to the start of the next unit that doesn't match, mktime() normalizes overflows and DST
+    if (!this->months_[time.month]) {
+      c_tm.tm_mon++;
+      c_tm.tm_mday = 1;
+      c_tm.tm_hour = c_tm.tm_min = c_tm.tm_sec = 0;
+    } else if (!this->days_of_month_[time.day_of_month] || !this->days_of_week_[time.day_of_week]) {
+      c_tm.tm_mday++;
+      c_tm.tm_hour = c_tm.tm_min = c_tm.tm_sec = 0;
+    } else if (!this->hours_[time.hour]) {
+      c_tm.tm_hour++;
+      c_tm.tm_min = c_tm.tm_sec = 0;
+    } else if (!this->minutes_[time.minute]) {
+      c_tm.tm_min++;
+      c_tm.tm_sec = 0;
+    } else {
+      c_tm.tm_sec++;
+    }
+    c_tm.tm_isdst = -1;
+    const time_t next = ::mktime(&c_tm);
+    // mktime() can map a local time that doesn't exist (DST gap) to an earlier time
+    t = next > t ? next : t + 1;
+  }
+  ESP_LOGW(TAG, "Cron trigger doesn't match any time in the near future!");
+  return {};
 }
 CronTrigger::CronTrigger(RealTimeClockComponent *rtc) : rtc_(rtc) {}
 void CronTrigger::add_seconds(const std::vector<uint8_t> &seconds) {
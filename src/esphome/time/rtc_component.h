@@ -95,6 +95,12 @@ class CronTrigger : public Trigger<>, public Component {
   float get_setup_priority() const override;
 
  protected:
+  /** The first time after the given time (inclusive) that matches, empty if none is found.
+   *
+   * Instead of checking every second, whole months, days, hours and minutes that don't match are skipped.
+   */
+  optional<time_t> find_next_(time_t from);
+
   std::bitset<61> seconds_;
   std::bitset<60> minutes_;
   std::bitset<24> hours_;
@@ -102,7 +108,11 @@ class CronTrigger : public Trigger<>, public Component {
   std::bitset<13> months_;
   std::bitset<8> days_of_week_;
   RealTimeClockComponent *rtc_;
-  optional<ESPTime> last_check_;
+  /// The time this trigger fires next, recalculated after it fired or when the clock jumped back.
+  optional<time_t> next_fire_;
+  /// Whether next_fire_ was calculated, it's empty if the trigger never matches.
+  bool has_next_fire_{false};
+  time_t last_check_{0};
 };
 
 /// The RealTimeClock class exposes common timekeeping functions via the device's local real-time clock.
@@ -121,7 +131,11 @@ class RealTimeClockComponent : public Component {
   /// Get the time zone currently in use.
   std::string get_timezone();
 
-  /// Get the time in the currently defined timezone.
+  /** Get the time in the currently defined timezone.
+   *
+   * The broken-down time is only calculated once per second, later calls in the same second return the cached
+   * value.
+   */
   ESPTime now();
 
   /// Get the time without any time zone or DST corrections.
@@ -133,6 +147,8 @@ class RealTimeClockComponent : public Component {
 
  protected:
   std::string timezone_{};
+  ESPTime now_cache_{};
+  ESPTime utcnow_cache_{};
 };
 
 }  // namespace time
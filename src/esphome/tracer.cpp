@@ -0,0 +1,132 @@
+#include "esphome/defines.h"
+
+#ifdef USE_TRACER
+
+#include "esphome/tracer.h"
+#include "esphome/esphal.h"
+#include "esphome/helpers.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+ESPHOME_NAMESPACE_BEGIN
+
+static const char *trace_category_to_string(TraceCategory category) {
+  switch (category) {
+    case TraceCategory::LOOP:
+      return "loop";
+    case TraceCategory::TIME_FUNCTION:
+      return "time_function";
+    case TraceCategory::ISR:
+      return "isr";
+    case TraceCategory::API:
+      return "api";
+    case TraceCategory::WIFI:
+      return "wifi";
+    default:
+      return "unknown";
+  }
+}
+/// The timeline row of the category, the main loop is row 0.
+static uint8_t trace_category_thread(TraceCategory category) {
+  switch (category) {
+    case TraceCategory::ISR:
+      return 1;
+    case TraceCategory::WIFI:
+      return 2;
+    default:
+      return 0;
+  }
+}
+
+void Tracer::set_enabled(bool enabled) { this->enabled_ = enabled; }
+bool Tracer::is_enabled() const { return this->enabled_; }
+void ICACHE_RAM_ATTR HOT Tracer::record(TraceCategory category, TracePhase phase, const char *name, uint16_t arg) {
+  if (!this->enabled_)
+    return;
+#ifdef ARDUINO_ARCH_ESP32
+  portENTER_CRITICAL(&this->lock_);
+#endif
+#ifdef ARDUINO_ARCH_ESP8266
+  const uint32_t state = xt_rsil(15);
+#endif
+  TraceEvent &event = this->events_[this->write_at_ % TRACE_BUFFER_SIZE];
+  event.time_us = micros();
+  event.name = name;
+  event.phase = phase;
+  event.category = category;
+  event.arg = arg;
+  this->write_at_++;
+#ifdef ARDUINO_ARCH_ESP32
+  portEXIT_CRITICAL(&this->lock_);
+#endif
+#ifdef ARDUINO_ARCH_ESP8266
+  xt_wsr_ps(state);
+#endif
+}
+std::vector<TraceEvent> Tracer::take_events() {
+  // pause recording instead of copying the whole buffer in a critical section
+  const bool enabled = this->enabled_;
+  this->enabled_ = false;
+  const uint32_t count = std::min(this->write_at_, TRACE_BUFFER_SIZE);
+  std::vector<TraceEvent> events;
+  events.reserve(count);
+  for (uint32_t i = this->write_at_ - count; i != this->write_at_; i++)
+    events.push_back(this->events_[i % TRACE_BUFFER_SIZE]);
+  this->write_at_ = 0;
+  this->enabled_ = enabled;
+  return events;
+}
+
+size_t Tracer::copy_recent_events(TraceEvent *events, size_t count) {
+  const bool enabled = this->enabled_;
+  this->enabled_ = false;
+  count = std::min(count, size_t(std::min(this->write_at_, TRACE_BUFFER_SIZE)));
+  for (size_t i = 0; i < count; i++)
+    events[i] = this->events_[(this->write_at_ - count + i) % TRACE_BUFFER_SIZE];
+  this->enabled_ = enabled;
+  return count;
+}
+
+Tracer global_tracer;  // NOLINT
+
+TraceJsonWriter::TraceJsonWriter(std::vector<TraceEvent> &&events) : events_(std::move(events)) {}
+size_t TraceJsonWriter::write(char *buffer, size_t len) {
+  size_t written = 0;
+  while (!this->done_) {
+    char item[192];
+    int item_len;
+    if (this->at_ == -1) {
+      item_len = snprintf(item, sizeof(item), "{\"traceEvents\":[");
+    } else if (uint32_t(this->at_) == this->events_.size()) {
+      item_len = snprintf(item, sizeof(item), "],\"displayTimeUnit\":\"ms\"}");
+    } else {
+      const TraceEvent &event = this->events_[this->at_];
+      // relative to the oldest event, so that the micros() overflow doesn't matter
+      const uint32_t time = event.time_us - this->events_[0].time_us;
+      item_len = snprintf(item, sizeof(item),
+                          "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%c\",\"ts\":%u,\"pid\":1,\"tid\":%u%s,"
+                          "\"args\":{\"arg\":%u}}",
+                          this->at_ == 0 ? "" : ",", event.name, trace_category_to_string(event.category),
+                          char(event.phase), time, trace_category_thread(event.category),
+                          event.phase == TracePhase::INSTANT ? ",\"s\":\"t\"" : "", event.arg);
+    }
+    if (item_len < 0 || size_t(item_len) >= sizeof(item))
+      // truncated, for example by a very long name
+      item_len = 0;
+    if (written + item_len > len)
+      break;
+    memcpy(buffer + written, item, item_len);
+    written += item_len;
+    if (uint32_t(this->at_) == this->events_.size())
+      this->done_ = true;
+    this->at_++;
+  }
+  return written;
+}
+bool TraceJsonWriter::is_done() const { return this->done_; }
+
+ESPHOME_NAMESPACE_END
+
+#endif  // USE_TRACER
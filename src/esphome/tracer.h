@@ -0,0 +1,135 @@
+#ifndef ESPHOME_TRACER_H
+#define ESPHOME_TRACER_H
+
+#include "esphome/defines.h"
+
+#ifdef USE_TRACER
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#ifdef ARDUINO_ARCH_ESP32
+#include <freertos/FreeRTOS.h>
+#endif
+
+ESPHOME_NAMESPACE_BEGIN
+
+/// The number of events the trace ring buffer holds, a power of two.
+#ifdef ARDUINO_ARCH_ESP32
+static const uint32_t TRACE_BUFFER_SIZE = 1024;
+#else
+static const uint32_t TRACE_BUFFER_SIZE = 256;
+#endif
+
+enum class TraceCategory : uint8_t {
+  LOOP,
+  TIME_FUNCTION,
+  ISR,
+  API,
+  WIFI,
+};
+
+/// The phase of an event, the values are the Chrome trace event phases.
+enum class TracePhase : uint8_t {
+  BEGIN = 'B',
+  END = 'E',
+  INSTANT = 'i',
+};
+
+struct TraceEvent {
+  uint32_t time_us;
+  /// Must point to a string that stays valid, like a literal or a component source.
+  const char *name;
+  TracePhase phase;
+  TraceCategory category;
+  /// An extra value shown with the event, like the WiFi event id.
+  uint16_t arg;
+};
+
+/** A ring buffer of timestamped begin/end events for debugging jitter on a timeline.
+ *
+ * Recording an event takes constant time (a short critical section and a 12 byte copy), so it's safe in ISRs
+ * and other tasks. Once the buffer is full the oldest events are overwritten. While disabled, recording is a
+ * single flag check and without USE_TRACER the TRACE_* macros compile to nothing.
+ *
+ * The events can be downloaded as Chrome trace JSON (see TraceJsonWriter) from the web server at /trace.json or
+ * with the TraceRequest of the native API, and opened in chrome://tracing or Perfetto.
+ */
+class Tracer {
+ public:
+  /// Enable or disable recording, enabled by default.
+  void set_enabled(bool enabled);
+  bool is_enabled() const;
+
+  /// Record an event, safe to call from ISRs (in IRAM, unlike inline functions which may be placed in flash).
+  void record(TraceCategory category, TracePhase phase, const char *name, uint16_t arg = 0);
+
+  /// Remove all events from the buffer and return them, oldest first.
+  std::vector<TraceEvent> take_events();
+  /// Copy the last (up to) count events into events without removing them, oldest first. Returns the number copied.
+  size_t copy_recent_events(TraceEvent *events, size_t count);
+
+ protected:
+  TraceEvent events_[TRACE_BUFFER_SIZE];
+  /// The total number of recorded events, the next one is written at write_at_ % TRACE_BUFFER_SIZE.
+  uint32_t write_at_{0};
+  volatile bool enabled_{true};
+#ifdef ARDUINO_ARCH_ESP32
+  portMUX_TYPE lock_ = portMUX_INITIALIZER_UNLOCKED;
+#endif
+};
+
+extern Tracer global_tracer;
+
+/** Formats the events taken from the tracer as Chrome trace JSON, in chunks.
+ *
+ * Timestamps are in µs since the oldest event. Events from ISRs and from the WiFi event task are put on their
+ * own timeline rows ("tid"), so they don't break the nesting of the begin/end events of the main loop.
+ */
+class TraceJsonWriter {
+ public:
+  explicit TraceJsonWriter(std::vector<TraceEvent> &&events);
+
+  /// Write the next chunk of whole events into buffer (at least 192 bytes), returns 0 once all was written.
+  size_t write(char *buffer, size_t len);
+  bool is_done() const;
+
+ protected:
+  std::vector<TraceEvent> events_;
+  /// -1 before the opening, events_.size() for the closing bracket.
+  int32_t at_{-1};
+  bool done_{false};
+};
+
+/// Record a begin event now and the matching end event when the scope is left, not for ISRs.
+class TraceScope {
+ public:
+  TraceScope(TraceCategory category, const char *name) : category_(category), name_(name) {
+    global_tracer.record(category, TracePhase::BEGIN, name);
+  }
+  ~TraceScope() { global_tracer.record(this->category_, TracePhase::END, this->name_); }
+
+ protected:
+  TraceCategory category_;
+  const char *name_;
+};
+
+ESPHOME_NAMESPACE_END
+
+#define TRACE_BEGIN(category, name) global_tracer.record(TraceCategory::category, TracePhase::BEGIN, name)
+#define TRACE_END(category, name) global_tracer.record(TraceCategory::category, TracePhase::END, name)
+#define TRACE_INSTANT(category, name, arg) \
+  global_tracer.record(TraceCategory::category, TracePhase::INSTANT, name, arg)
+#define TRACE_SCOPE(category, name) TraceScope trace_scope_(TraceCategory::category, name)
+
+#else
+
+#define TRACE_BEGIN(category, name)
+#define TRACE_END(category, name)
+#define TRACE_INSTANT(category, name, arg)
+#define TRACE_SCOPE(category, name)
+
+#endif  // USE_TRACER
+
+#endif  // ESPHOME_TRACER_H
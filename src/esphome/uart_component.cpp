@@ -5,6 +5,7 @@
 #include "esphome/uart_component.h"
 #include "esphome/helpers.h"
 #include "esphome/log.h"
+#include "esphome/metrics.h"
 
 ESPHOME_NAMESPACE_BEGIN
 
@@ -21,6 +22,9 @@ float UARTComponent::get_setup_priority() const { return setup_priority::PRE_HAR
 #ifdef ARDUINO_ARCH_ESP32
 void UARTComponent::setup() {
   ESP_LOGCONFIG(TAG, "Setting up UART...");
+#ifdef USE_METRICS
+  this->register_metrics_();
+#endif
   // Use Arduino HardwareSerial UARTs if all used pins match the ones
   // preconfigured by the platform. For example if RX disabled but TX pin
   // is 1 we still want to use Serial.
@@ -94,6 +98,7 @@ bool UARTComponent::check_read_timeout_(size_t len) {
   while (this->available() < len) {
     if (millis() - start_time > 1000) {
       ESP_LOGE(TAG, "Reading from UART timed out at byte %u!", this->available());
+      this->read_timeouts_++;
       return false;
     }
   }
@@ -109,6 +114,9 @@ void UARTComponent::flush() {
 #ifdef ARDUINO_ARCH_ESP8266
 void UARTComponent::setup() {
   ESP_LOGCONFIG(TAG, "Setting up UART bus...");
+#ifdef USE_METRICS
+  this->register_metrics_();
+#endif
   // Use Arduino HardwareSerial UARTs if all used pins match the ones
   // preconfigured by the platform. For example if RX disabled but TX pin
   // is 1 we still want to use Serial.
@@ -126,7 +134,7 @@ void UARTComponent::setup() {
     this->sw_serial_ = new ESP8266SoftwareSerial();
     int8_t tx = this->tx_pin_.has_value() ? *this->tx_pin_ : -1;
     int8_t rx = this->rx_pin_.has_value() ? *this->rx_pin_ : -1;
-    this->sw_serial_->setup(tx, rx, this->baud_rate_);
+    this->sw_serial_->setup(tx, rx, this->baud_rate_, this->rx_buffer_size_);
   }
 }
 
@@ -219,6 +227,7 @@ bool UARTComponent::check_read_timeout_(size_t len) {
   while (this->available() < int(len)) {
     if (millis() - start_time > 100) {
       ESP_LOGE(TAG, "Reading from UART timed out at byte %u!", this->available());
+      this->read_timeouts_++;
       return false;
     }
     yield();
@@ -241,11 +250,13 @@ void UARTComponent::flush() {
   }
 }
 
-void ESP8266SoftwareSerial::setup(int8_t tx_pin, int8_t rx_pin, uint32_t baud_rate) {
+void ESP8266SoftwareSerial::setup(int8_t tx_pin, int8_t rx_pin, uint32_t baud_rate, size_t rx_buffer_size) {
   this->bit_time_ = F_CPU / baud_rate;
+  this->rx_buffer_size_ = rx_buffer_size;
   if (tx_pin != -1) {
-    this->tx_pin_ = GPIOOutputPin(tx_pin).copy();
-    this->tx_pin_->setup();
+    auto pin = GPIOOutputPin(tx_pin);
+    pin.setup();
+    this->tx_pin_ = pin.to_isr();
     this->tx_pin_->digital_write(true);
   }
   if (rx_pin != -1) {
@@ -253,29 +264,60 @@ void ESP8266SoftwareSerial::setup(int8_t tx_pin, int8_t rx_pin, uint32_t baud_ra
     pin.setup();
     this->rx_pin_ = pin.to_isr();
     this->rx_buffer_ = new uint8_t[this->rx_buffer_size_];
-    pin.attach_interrupt(ESP8266SoftwareSerial::gpio_intr, this, FALLING);
+    pin.attach_interrupt(ESP8266SoftwareSerial::gpio_intr, this, CHANGE);
   }
 }
+void ICACHE_RAM_ATTR ESP8266SoftwareSerial::shift_bits_(uint8_t pos, bool level) {
+  // slot 0 is the start bit, 1-8 the data bits (LSB first) and 9 the stop bit
+  for (uint8_t slot = this->rx_pos_; slot < pos && slot < 9; slot++) {
+    if (slot >= 1 && level)
+      this->rx_byte_ |= 1 << (slot - 1);
+  }
+  this->rx_pos_ = pos;
+}
+void ICACHE_RAM_ATTR ESP8266SoftwareSerial::push_byte_() {
+  const size_t next = (this->rx_in_pos_ + 1) % this->rx_buffer_size_;
+  // drop the byte if the buffer is full instead of overwriting unread data
+  if (next != this->rx_out_pos_) {
+    this->rx_buffer_[this->rx_in_pos_] = this->rx_byte_;
+    this->rx_in_pos_ = next;
+  }
+  this->rx_pos_ = -1;
+}
 void ICACHE_RAM_ATTR ESP8266SoftwareSerial::gpio_intr(ESP8266SoftwareSerial *arg) {
-  uint32_t wait = arg->bit_time_ + arg->bit_time_ / 3 - 500;
-  const uint32_t start = ESP.getCycleCount();
-  uint8_t rec = 0;
-  // Manually unroll the loop
-  rec |= arg->read_bit_(&wait, start) << 0;
-  rec |= arg->read_bit_(&wait, start) << 1;
-  rec |= arg->read_bit_(&wait, start) << 2;
-  rec |= arg->read_bit_(&wait, start) << 3;
-  rec |= arg->read_bit_(&wait, start) << 4;
-  rec |= arg->read_bit_(&wait, start) << 5;
-  rec |= arg->read_bit_(&wait, start) << 6;
-  rec |= arg->read_bit_(&wait, start) << 7;
-  // Stop bit
-  arg->wait_(&wait, start);
+  const uint32_t now = ESP.getCycleCount();
+  const bool level = arg->rx_pin_->digital_read();
+  if (level == arg->rx_level_) {
+    // missed an edge in between, nothing changed
+    return;
+  }
 
-  arg->rx_buffer_[arg->rx_in_pos_] = rec;
-  arg->rx_in_pos_ = (arg->rx_in_pos_ + 1) % arg->rx_buffer_size_;
-  // Clear RX pin so that the interrupt doesn't re-trigger right away again.
-  arg->rx_pin_->clear_interrupt();
+  if (arg->rx_pos_ >= 0) {
+    // the bits since the last edge had the previous level, round to the middle of the bit slot
+    const uint32_t pos = (now - arg->rx_start_ + arg->bit_time_ / 2) / arg->bit_time_;
+    arg->shift_bits_(std::min<uint32_t>(pos, 10), arg->rx_level_);
+    if (arg->rx_pos_ >= 9)
+      // the stop bit has been reached, any edge from now on belongs to the next byte
+      arg->push_byte_();
+  }
+  if (arg->rx_pos_ < 0 && !level) {
+    // falling edge while idle: start bit
+    arg->rx_start_ = now;
+    arg->rx_byte_ = 0;
+    arg->rx_pos_ = 0;
+  }
+  arg->rx_level_ = level;
+}
+void ESP8266SoftwareSerial::check_rx_idle_() {
+  if (this->rx_pos_ < 0)
+    return;
+  disable_interrupts();
+  // the last byte of a transmission ends with high bits and the stop bit, which don't produce an edge
+  if (this->rx_pos_ >= 0 && ESP.getCycleCount() - this->rx_start_ > this->bit_time_ * 10) {
+    this->shift_bits_(9, this->rx_level_);
+    this->push_byte_();
+  }
+  enable_interrupts();
 }
 void ICACHE_RAM_ATTR HOT ESP8266SoftwareSerial::write_byte(uint8_t data) {
   if (this->tx_pin_ == nullptr) {
@@ -283,7 +325,11 @@ void ICACHE_RAM_ATTR HOT ESP8266SoftwareSerial::write_byte(uint8_t data) {
     return;
   }
 
-  disable_interrupts();
+  // Every bit is timed against the start, so a short interrupt only delays one bit edge a little instead of
+  // shifting all bits after it. Above 19200 baud (52us per bit) that's too much jitter.
+  const bool lock = this->bit_time_ < F_CPU / 19200;
+  if (lock)
+    disable_interrupts();
   uint32_t wait = this->bit_time_;
   const uint32_t start = ESP.getCycleCount();
   // Start bit
@@ -298,22 +344,20 @@ void ICACHE_RAM_ATTR HOT ESP8266SoftwareSerial::write_byte(uint8_t data) {
   this->write_bit_(data & (1 << 7), &wait, start);
   // Stop bit
   this->write_bit_(true, &wait, start);
-  enable_interrupts();
+  if (lock)
+    enable_interrupts();
 }
 void ESP8266SoftwareSerial::wait_(uint32_t *wait, const uint32_t &start) {
   while (ESP.getCycleCount() - start < *wait)
     ;
   *wait += this->bit_time_;
 }
-bool ESP8266SoftwareSerial::read_bit_(uint32_t *wait, const uint32_t &start) {
-  this->wait_(wait, start);
-  return this->rx_pin_->digital_read();
-}
 void ESP8266SoftwareSerial::write_bit_(bool bit, uint32_t *wait, const uint32_t &start) {
   this->tx_pin_->digital_write(bit);
   this->wait_(wait, start);
 }
 uint8_t ESP8266SoftwareSerial::read_byte() {
+  this->check_rx_idle_();
   if (this->rx_in_pos_ == this->rx_out_pos_)
     return 0;
   uint8_t data = this->rx_buffer_[this->rx_out_pos_];
@@ -327,6 +371,7 @@ uint8_t ESP8266SoftwareSerial::peek_byte() {
 }
 void ESP8266SoftwareSerial::flush() { this->rx_in_pos_ = this->rx_out_pos_ = 0; }
 int ESP8266SoftwareSerial::available() {
+  this->check_rx_idle_();
   int avail = int(this->rx_in_pos_) - int(this->rx_out_pos_);
   if (avail < 0)
     return avail + this->rx_buffer_size_;
@@ -352,6 +397,148 @@ int UARTComponent::peek() {
 }
 void UARTComponent::set_tx_pin(uint8_t tx_pin) { this->tx_pin_ = tx_pin; }
 void UARTComponent::set_rx_pin(uint8_t rx_pin) { this->rx_pin_ = rx_pin; }
+void UARTComponent::set_rx_buffer_size(size_t rx_buffer_size) { this->rx_buffer_size_ = rx_buffer_size; }
+void UARTComponent::add_on_frame_callback(std::function<void(const uint8_t *data, size_t len)> &&callback) {
+  this->frame_callback_.add(std::move(callback));
+  this->has_frame_callback_ = true;
+  this->enable_loop();
+}
+void UARTComponent::set_frame_idle_time(uint32_t frame_idle_time) { this->frame_idle_time_ = frame_idle_time; }
+void UARTComponent::loop() {
+  if (!this->has_frame_callback_) {
+    this->disable_loop();
+    return;
+  }
+  const int avail = this->available();
+  const uint32_t now = millis();
+  if (avail != this->frame_available_) {
+    this->frame_available_ = avail;
+    this->frame_last_rx_ = now;
+    return;
+  }
+  if (avail == 0 || now - this->frame_last_rx_ < this->frame_idle_time_)
+    return;
+
+  this->frame_buffer_.resize(avail);
+  this->read_array(this->frame_buffer_.data(), avail);
+  this->frame_available_ = 0;
+  this->frame_callback_.call(this->frame_buffer_.data(), this->frame_buffer_.size());
+}
+
+#ifdef USE_METRICS
+void UARTComponent::register_metrics_() {
+  const std::string id =
+      this->rx_pin_.has_value() ? "rx" + to_string(*this->rx_pin_) : "tx" + to_string(*this->tx_pin_);
+  global_metrics.register_counter("uart_read_timeouts_total", "Reads that timed out waiting for data.",
+                                  [this]() { return this->read_timeouts_; }, id);
+}
+#endif
+
+UARTFrameParser::UARTFrameParser(size_t max_length) : buffer_(max_length) {}
+void UARTFrameParser::set_header(const std::vector<uint8_t> &header, size_t offset) {
+  this->header_ = header;
+  this->header_offset_ = offset;
+}
+void UARTFrameParser::set_fixed_length(size_t length) { this->fixed_length_ = length; }
+void UARTFrameParser::set_length_field(size_t offset, uint8_t size, size_t overhead) {
+  this->length_offset_ = offset;
+  this->length_size_ = size;
+  this->length_overhead_ = overhead;
+}
+void UARTFrameParser::set_validator(std::function<bool(const uint8_t *frame, size_t len)> &&validator) {
+  this->validator_ = std::move(validator);
+}
+void UARTFrameParser::set_timeout(uint32_t timeout) { this->timeout_ = timeout; }
+void UARTFrameParser::set_on_frame(std::function<void(const uint8_t *frame, size_t len)> &&callback) {
+  this->on_frame_ = std::move(callback);
+}
+uint32_t UARTFrameParser::get_dropped_bytes() const { return this->dropped_bytes_; }
+int UARTFrameParser::check_frame_(const uint8_t *data, size_t len) const {
+  for (size_t i = 0; i < this->header_.size(); i++) {
+    const size_t pos = this->header_offset_ + i;
+    if (pos >= len)
+      return 0;
+    if (data[pos] != this->header_[i])
+      return -1;
+  }
+
+  size_t frame_len = this->fixed_length_;
+  if (this->length_size_ != 0) {
+    if (len < this->length_offset_ + this->length_size_)
+      return 0;
+    size_t field = data[this->length_offset_];
+    if (this->length_size_ == 2)
+      field = (field << 8) | data[this->length_offset_ + 1];
+    frame_len = field + this->length_overhead_;
+  }
+  if (frame_len == 0 || frame_len > this->buffer_.size()) {
+    ESP_LOGV(TAG, "Invalid frame length %u!", frame_len);
+    return -1;
+  }
+  if (len < frame_len)
+    return 0;
+
+  if (this->validator_ && !this->validator_(data, frame_len))
+    return -1;
+  return frame_len;
+}
+void UARTFrameParser::feed(const uint8_t *data, size_t len) {
+  const uint32_t now = millis();
+  if (this->buffer_len_ != 0 && now - this->last_data_ >= this->timeout_) {
+    // last transmission too long ago, drop the partial frame
+    this->dropped_bytes_ += this->buffer_len_;
+    this->buffer_len_ = 0;
+  }
+  this->last_data_ = now;
+
+  while (len != 0) {
+    if (this->buffer_len_ == 0) {
+      // nothing buffered, use frames directly from the received data
+      int frame_len = this->check_frame_(data, len);
+      if (frame_len > 0) {
+        if (this->on_frame_)
+          this->on_frame_(data, frame_len);
+        data += frame_len;
+        len -= frame_len;
+        continue;
+      }
+      if (frame_len < 0) {
+        this->dropped_bytes_++;
+        data++;
+        len--;
+        continue;
+      }
+    }
+
+    // the frame is split across reads, collect it in the buffer
+    const size_t count = std::min(len, this->buffer_.size() - this->buffer_len_);
+    memcpy(this->buffer_.data() + this->buffer_len_, data, count);
+    this->buffer_len_ += count;
+    data += count;
+    len -= count;
+    this->process_buffer_();
+  }
+}
+void UARTFrameParser::process_buffer_() {
+  while (this->buffer_len_ != 0) {
+    int frame_len = this->check_frame_(this->buffer_.data(), this->buffer_len_);
+    if (frame_len == 0)
+      return;
+    if (frame_len > 0) {
+      if (this->on_frame_)
+        this->on_frame_(this->buffer_.data(), frame_len);
+      this->shift_buffer_(frame_len);
+    } else {
+      // resync with the next byte
+      this->dropped_bytes_++;
+      this->shift_buffer_(1);
+    }
+  }
+}
+void UARTFrameParser::shift_buffer_(size_t count) {
+  this->buffer_len_ -= count;
+  memmove(this->buffer_.data(), this->buffer_.data() + count, this->buffer_len_);
+}
 
 void UARTDevice::write_byte(uint8_t data) { this->parent_->write_byte(data); }
 void UARTDevice::write_array(const uint8_t *data, size_t len) { this->parent_->write_array(data, len); }
@@ -365,6 +552,12 @@ UARTDevice::UARTDevice(UARTComponent *parent) : parent_(parent) {}
 size_t UARTDevice::write(uint8_t data) { return this->parent_->write(data); }
 int UARTDevice::read() { return this->parent_->read(); }
 int UARTDevice::peek() { return this->parent_->peek(); }
+void UARTDevice::add_on_frame_callback(std::function<void(const uint8_t *data, size_t len)> &&callback) {
+  this->parent_->add_on_frame_callback(std::move(callback));
+}
+void UARTDevice::add_frame_parser(UARTFrameParser *parser) {
+  this->add_on_frame_callback([parser](const uint8_t *data, size_t len) { parser->feed(data, len); });
+}
 
 ESPHOME_NAMESPACE_END
 
@@ -11,9 +11,17 @@
 ESPHOME_NAMESPACE_BEGIN
 
 #ifdef ARDUINO_ARCH_ESP8266
+/** Software UART for the ESP8266.
+ *
+ * Receiving is edge driven: the GPIO interrupt only timestamps each edge and shifts the bits since the
+ * previous edge into the current byte, so no time is spent busy-waiting with interrupts disabled. The
+ * trailing high bits of the last byte of a transmission (which don't end with an edge) are completed
+ * from available(). Sending times each bit against the cycle counter and only disables interrupts at
+ * high baud rates.
+ */
 class ESP8266SoftwareSerial {
  public:
-  void setup(int8_t tx_pin, int8_t rx_pin, uint32_t baud_rate);
+  void setup(int8_t tx_pin, int8_t rx_pin, uint32_t baud_rate, size_t rx_buffer_size);
 
   uint8_t read_byte();
   uint8_t peek_byte();
@@ -27,16 +35,25 @@ class ESP8266SoftwareSerial {
  protected:
   static void gpio_intr(ESP8266SoftwareSerial *arg);
 
+  /// Shift the bits up to bit slot pos (the start bit is slot 0) with the given level into the current byte.
+  inline void shift_bits_(uint8_t pos, bool level);
+  inline void push_byte_();
+  /// Complete a byte whose stop bit has passed without another edge.
+  void check_rx_idle_();
   inline void wait_(uint32_t *wait, const uint32_t &start);
-  inline bool read_bit_(uint32_t *wait, const uint32_t &start);
   inline void write_bit_(bool bit, uint32_t *wait, const uint32_t &start);
 
   uint32_t bit_time_{0};
   uint8_t *rx_buffer_{nullptr};
-  size_t rx_buffer_size_{64};
+  size_t rx_buffer_size_{256};
   volatile size_t rx_in_pos_{0};
   size_t rx_out_pos_{0};
-  GPIOPin *tx_pin_{nullptr};
+  /// Receive state, owned by the interrupt. rx_pos_ is the next bit slot to fill, -1 while idle.
+  volatile int8_t rx_pos_{-1};
+  uint8_t rx_byte_{0};
+  uint32_t rx_start_{0};
+  bool rx_level_{true};
+  ISRInternalGPIOPin *tx_pin_{nullptr};
   ISRInternalGPIOPin *rx_pin_{nullptr};
 };
 #endif
@@ -73,9 +90,25 @@ class UARTComponent : public Component, public Stream {
 
   void set_tx_pin(uint8_t tx_pin);
   void set_rx_pin(uint8_t rx_pin);
+  /// Set the size of the receive buffer of the software serial (ESP8266 only), defaults to 256 bytes.
+  void set_rx_buffer_size(size_t rx_buffer_size);
+
+  /** Get called with all bytes received so far once the line has been idle for a while.
+   *
+   * Devices sending frames can use this instead of polling available() in their loop().
+   */
+  void add_on_frame_callback(std::function<void(const uint8_t *data, size_t len)> &&callback);
+  /// Set how long the line has to be idle for a frame to be complete, defaults to 5ms.
+  void set_frame_idle_time(uint32_t frame_idle_time);
+
+  /// Detect complete frames, only enabled if there are frame callbacks.
+  void loop() override;
 
  protected:
   bool check_read_timeout_(size_t len = 1);
+#ifdef USE_METRICS
+  void register_metrics_();
+#endif
 
   HardwareSerial *hw_serial_{nullptr};
 #ifdef ARDUINO_ARCH_ESP8266
@@ -84,12 +117,83 @@ class UARTComponent : public Component, public Stream {
   optional<uint8_t> tx_pin_;
   optional<uint8_t> rx_pin_;
   uint32_t baud_rate_;
+  size_t rx_buffer_size_{256};
+  CallbackManager<void(const uint8_t *, size_t)> frame_callback_;
+  bool has_frame_callback_{false};
+  uint32_t frame_idle_time_{5};
+  /// available() as of the last loop() and when it last changed.
+  int frame_available_{0};
+  uint32_t frame_last_rx_{0};
+  std::vector<uint8_t> frame_buffer_;
+  uint32_t read_timeouts_{0};
 };
 
 #ifdef ARDUINO_ARCH_ESP32
 extern uint8_t next_uart_num;
 #endif
 
+/** Assembles the frames of a binary protocol from the received bytes and dispatches each valid one.
+ *
+ * A frame starts with fixed header bytes (optionally at an offset into the frame), has a fixed length or
+ * carries its length in a field and is checked by a validator, usually for its checksum. When the header,
+ * the length or the validator fail, the parser resyncs by searching for the next header from the byte after
+ * the start of the bad frame, so a single corrupted byte only loses the frame it's in.
+ *
+ * Frames that arrive in one piece are passed to the callback straight from the received data, only frames
+ * split across several reads are copied into the parser's buffer first. Either way the data is only valid
+ * during the callback.
+ */
+class UARTFrameParser {
+ public:
+  /// Construct the parser for frames of at most max_length bytes.
+  explicit UARTFrameParser(size_t max_length);
+
+  /// Set the bytes every frame starts with at the given offset.
+  void set_header(const std::vector<uint8_t> &header, size_t offset = 0);
+  /// All frames have this many bytes.
+  void set_fixed_length(size_t length);
+  /** The frame length is stored in the frame.
+   *
+   * @param offset The offset of the length field in the frame.
+   * @param size The size of the length field, 1 or 2 bytes (big endian).
+   * @param overhead The number of bytes of the frame not counted by the length field.
+   */
+  void set_length_field(size_t offset, uint8_t size, size_t overhead);
+  /// Set a check for complete frames, for example for the checksum. Frames it rejects are dropped.
+  void set_validator(std::function<bool(const uint8_t *frame, size_t len)> &&validator);
+  /// Drop a partially received frame if no data arrives for this long, defaults to 500ms.
+  void set_timeout(uint32_t timeout);
+  void set_on_frame(std::function<void(const uint8_t *frame, size_t len)> &&callback);
+
+  /// Feed received bytes into the parser.
+  void feed(const uint8_t *data, size_t len);
+
+  /// Number of bytes dropped to resync so far.
+  uint32_t get_dropped_bytes() const;
+
+ protected:
+  /// The length of the valid frame at the start of data, 0 if it's not complete yet or -1 if it's invalid.
+  int check_frame_(const uint8_t *data, size_t len) const;
+  /// Dispatch all frames in the buffer, resyncing as needed.
+  void process_buffer_();
+  void shift_buffer_(size_t count);
+
+  std::vector<uint8_t> header_;
+  size_t header_offset_{0};
+  size_t fixed_length_{0};
+  size_t length_offset_{0};
+  uint8_t length_size_{0};
+  size_t length_overhead_{0};
+  std::function<bool(const uint8_t *, size_t)> validator_;
+  std::function<void(const uint8_t *, size_t)> on_frame_;
+  uint32_t timeout_{500};
+  uint32_t last_data_{0};
+  /// The start of a frame split across several reads.
+  std::vector<uint8_t> buffer_;
+  size_t buffer_len_{0};
+  uint32_t dropped_bytes_{0};
+};
+
 class UARTDevice : public Stream {
  public:
   UARTDevice(UARTComponent *parent);
@@ -113,6 +217,11 @@ class UARTDevice : public Stream {
   int read() override;
   int peek() override;
 
+  /// See UARTComponent::add_on_frame_callback.
+  void add_on_frame_callback(std::function<void(const uint8_t *data, size_t len)> &&callback);
+  /// Feed everything received on the UART into the given frame parser.
+  void add_frame_parser(UARTFrameParser *parser);
+
  protected:
   UARTComponent *parent_;
 };
@@ -98,6 +98,11 @@ std::string network_get_address() {
   return "";
 }
 
+void network_notify_activity() {
+  if (global_wifi_component != nullptr)
+    global_wifi_component->notify_activity();
+}
+
 std::string get_app_name() { return App.get_name(); }
 
 std::string get_app_compilation_time() { return App.get_compilation_time(); }
@@ -11,6 +11,8 @@ ESPHOME_NAMESPACE_BEGIN
 bool network_is_connected();
 /// Get the active network hostname
 std::string network_get_address();
+/// Report traffic that should be answered quickly, so that the network interface can leave power save.
+void network_notify_activity();
 
 /// Manually set up the network stack (outside of the App.setup() loop, for example in OTA safe mode)
 void network_setup();
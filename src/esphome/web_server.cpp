@@ -15,13 +15,20 @@
 #include <Updater.h>
 #endif
 
+#include <algorithm>
+#include <cmath>
 #include <cstdlib>
+#include <cstring>
+#include <memory>
 
 ESPHOME_NAMESPACE_BEGIN
 
 static const char *TAG = "web_server";
 
-void write_row(AsyncResponseStream *stream, Nameable *obj, const std::string &klass, const std::string &action) {
+/// The size of the buffer the bulk state responses are streamed through, one TCP segment.
+static const size_t STATES_BUFFER_SIZE = 1460;
+
+void write_row(Print *stream, Nameable *obj, const std::string &klass, const std::string &action) {
   stream->print("<tr class=\"");
   stream->print(klass.c_str());
   stream->print("\" id=\"");
@@ -65,51 +72,31 @@ WebServer::WebServer(uint16_t port) : port_(port) {}
 
 void WebServer::set_css_url(const char *css_url) { this->css_url_ = css_url; }
 void WebServer::set_js_url(const char *js_url) { this->js_url_ = js_url; }
+void WebServer::set_css_include(const uint8_t *css_gz, size_t len) {
+  this->css_include_ = css_gz;
+  this->css_include_len_ = len;
+}
+void WebServer::set_js_include(const uint8_t *js_gz, size_t len) {
+  this->js_include_ = js_gz;
+  this->js_include_len_ = len;
+}
 void WebServer::set_port(uint16_t port) { this->port_ = port; }
+void WebServer::set_prometheus(bool prometheus) { this->prometheus_ = prometheus; }
 
 void WebServer::setup() {
   ESP_LOGCONFIG(TAG, "Setting up web server...");
   this->server_ = new AsyncWebServer(this->port_);
+  char etag[11];
+  sprintf(etag, "\"%08X\"", fnv1_hash(App.get_compilation_time()));
+  this->include_etag_ = etag;
 
   this->events_.onConnect([this](AsyncEventSourceClient *client) {
     // Configure reconnect timeout
     client->send("", "ping", millis(), 30000);
 
-#ifdef USE_SENSOR
-    for (auto *obj : this->sensors_)
-      if (!obj->is_internal())
-        client->send(this->sensor_json(obj, obj->state).c_str(), "state");
-#endif
-
-#ifdef USE_SWITCH
-    for (auto *obj : this->switches_)
-      if (!obj->is_internal())
-        client->send(this->switch_json(obj, obj->state).c_str(), "state");
-#endif
-
-#ifdef USE_BINARY_SENSOR
-    for (auto *obj : this->binary_sensors_)
-      if (!obj->is_internal())
-        client->send(this->binary_sensor_json(obj, obj->state).c_str(), "state");
-#endif
-
-#ifdef USE_FAN
-    for (auto *obj : this->fans_)
-      if (!obj->is_internal())
-        client->send(this->fan_json(obj).c_str(), "state");
-#endif
-
-#ifdef USE_LIGHT
-    for (auto *obj : this->lights_)
-      if (!obj->is_internal())
-        client->send(this->light_json(obj).c_str(), "state");
-#endif
-
-#ifdef USE_TEXT_SENSOR
-    for (auto *obj : this->text_sensors_)
-      if (!obj->is_internal())
-        client->send(this->text_sensor_json(obj, obj->state).c_str(), "state");
-#endif
+    this->for_each_state_([this, client](Nameable *obj, EntityType type) {
+      client->send(this->state_json_(obj, type).c_str(), "state");
+    });
   });
 
   if (global_log_component != nullptr)
@@ -121,16 +108,106 @@ void WebServer::setup() {
   this->server_->begin();
 
   this->set_interval(10000, [this]() { this->events_.send("", "ping", millis(), 30000); });
+  // loop() only runs after state changes
+  this->subscribe_states_(this);
+  this->disable_loop();
 }
 void WebServer::dump_config() {
   ESP_LOGCONFIG(TAG, "Web Server:");
   ESP_LOGCONFIG(TAG, "  Address: %s:%u", network_get_address().c_str(), this->port_);
 }
+void WebServer::loop() {
+  // clients that connect later get all states in onConnect, so nothing has to be kept without listeners
+  if (this->events_.count() != 0) {
+    this->process_states_();
+  } else {
+    this->discard_states_();
+  }
+  if (!this->has_timed_states_())
+    this->disable_loop();
+}
+Nameable *WebServer::find_entity_(EntityType type, const UrlMatch &match) {
+  Nameable *obj = App.get_state_bus().find_entity(type, fnv1_hash(match.id));
+  // compare the object id too, the key is just a hash
+  if (obj == nullptr || obj->is_internal() || obj->get_object_id() != match.id)
+    return nullptr;
+  return obj;
+}
+std::string WebServer::state_json_(Nameable *obj, EntityType type) {
+  switch (type) {
+#ifdef USE_SENSOR
+    case ENTITY_SENSOR: {
+      auto *entity = static_cast<sensor::Sensor *>(obj);
+      return this->sensor_json(entity, entity->state);
+    }
+#endif
+#ifdef USE_SWITCH
+    case ENTITY_SWITCH: {
+      auto *entity = static_cast<switch_::Switch *>(obj);
+      return this->switch_json(entity, entity->state);
+    }
+#endif
+#ifdef USE_BINARY_SENSOR
+    case ENTITY_BINARY_SENSOR: {
+      auto *entity = static_cast<binary_sensor::BinarySensor *>(obj);
+      return this->binary_sensor_json(entity, entity->state);
+    }
+#endif
+#ifdef USE_FAN
+    case ENTITY_FAN:
+      return this->fan_json(static_cast<fan::FanState *>(obj));
+#endif
+#ifdef USE_LIGHT
+    case ENTITY_LIGHT:
+      return this->light_json(static_cast<light::LightState *>(obj));
+#endif
+#ifdef USE_TEXT_SENSOR
+    case ENTITY_TEXT_SENSOR: {
+      auto *entity = static_cast<text_sensor::TextSensor *>(obj);
+      return this->text_sensor_json(entity, entity->state);
+    }
+#endif
+    default:
+      return "";
+  }
+}
+void WebServer::for_each_state_(const std::function<void(Nameable *, EntityType)> &callback) {
+#ifdef USE_SENSOR
+  for (auto *obj : this->sensors_)
+    if (!obj->is_internal())
+      callback(obj, ENTITY_SENSOR);
+#endif
+#ifdef USE_SWITCH
+  for (auto *obj : this->switches_)
+    if (!obj->is_internal())
+      callback(obj, ENTITY_SWITCH);
+#endif
+#ifdef USE_BINARY_SENSOR
+  for (auto *obj : this->binary_sensors_)
+    if (!obj->is_internal())
+      callback(obj, ENTITY_BINARY_SENSOR);
+#endif
+#ifdef USE_FAN
+  for (auto *obj : this->fans_)
+    if (!obj->is_internal())
+      callback(obj, ENTITY_FAN);
+#endif
+#ifdef USE_LIGHT
+  for (auto *obj : this->lights_)
+    if (!obj->is_internal())
+      callback(obj, ENTITY_LIGHT);
+#endif
+#ifdef USE_TEXT_SENSOR
+  for (auto *obj : this->text_sensors_)
+    if (!obj->is_internal())
+      callback(obj, ENTITY_TEXT_SENSOR);
+#endif
+}
 float WebServer::get_setup_priority() const { return setup_priority::WIFI - 1.0f; }
 
 void WebServer::handle_update_request(AsyncWebServerRequest *request) {
   AsyncWebServerResponse *response;
-  if (!Update.hasError()) {
+  if (!Update.hasError() && !this->ota_failed_) {
     response = request->beginResponse(200, "text/plain", "Update Successful!");
   } else {
     StreamString ss;
@@ -148,12 +225,69 @@ void report_ota_error() {
   ESP_LOGW(TAG, "OTA Update failed! Error: %s", ss.c_str());
 }
 
+bool WebServer::ota_write_(const uint8_t *data, size_t len) {
+#ifdef USE_OTA
+  // collect the request chunks (about one TCP segment each) into full buffers for the writer
+  while (len != 0) {
+    if (this->ota_buffer_ == nullptr) {
+      // waits while both buffers are being written, which holds back the TCP window until one is free
+      this->ota_buffer_ = this->ota_writer_.get_buffer();
+      if (this->ota_buffer_ == nullptr) {
+        ESP_LOGW(TAG, "Timeout writing binary data to flash!");
+        return false;
+      }
+      this->ota_buffer_len_ = 0;
+    }
+    const size_t to_copy = std::min<size_t>(len, OTA_BUFFER_SIZE - this->ota_buffer_len_);
+    memcpy(this->ota_buffer_ + this->ota_buffer_len_, data, to_copy);
+    this->ota_buffer_len_ += to_copy;
+    data += to_copy;
+    len -= to_copy;
+    if (this->ota_buffer_len_ == OTA_BUFFER_SIZE) {
+      uint8_t *buffer = this->ota_buffer_;
+      this->ota_buffer_ = nullptr;
+      if (!this->ota_writer_.write(buffer, OTA_BUFFER_SIZE))
+        return false;
+    }
+  }
+  return true;
+#else
+  return Update.write(const_cast<uint8_t *>(data), len) == len;
+#endif
+}
+bool WebServer::ota_finish_() {
+#ifdef USE_OTA
+  if (this->ota_buffer_ != nullptr) {
+    uint8_t *buffer = this->ota_buffer_;
+    this->ota_buffer_ = nullptr;
+    if (!this->ota_writer_.write(buffer, this->ota_buffer_len_))
+      return false;
+  }
+  return this->ota_writer_.finish();
+#else
+  return true;
+#endif
+}
+void WebServer::ota_end_() {
+#ifdef USE_OTA
+  if (this->ota_buffer_ != nullptr) {
+    // hand the buffer back, otherwise the writer waits for it
+    this->ota_writer_.write(this->ota_buffer_, 0);
+    this->ota_buffer_ = nullptr;
+  }
+  this->ota_writer_.end();
+#endif
+}
+
 void WebServer::handleUpload(AsyncWebServerRequest *request, const String &filename, size_t index, uint8_t *data,
                              size_t len, bool final) {
   bool success;
   if (index == 0) {
     ESP_LOGI(TAG, "OTA Update Start: %s", filename.c_str());
     this->ota_read_length_ = 0;
+    this->ota_failed_ = false;
+    // the last upload may have been aborted
+    this->ota_end_();
 #ifdef ARDUINO_ARCH_ESP8266
     Update.runAsync(true);
     success = Update.begin((ESP.getFreeSketchSpace() - 0x1000) & 0xFFFFF000);
@@ -162,19 +296,40 @@ void WebServer::handleUpload(AsyncWebServerRequest *request, const String &filen
     if (Update.isRunning())
       Update.abort();
     success = Update.begin(UPDATE_SIZE_UNKNOWN, U_FLASH);
+#endif
+#ifdef USE_OTA
+#ifdef ARDUINO_ARCH_ESP32
+    // gzip compressed images are decompressed while writing, the size is only known at the end anyway
+    const bool compressed = len >= 2 && data[0] == 0x1F && data[1] == 0x8B;
+    if (compressed)
+      ESP_LOGD(TAG, "The OTA image is gzip compressed.");
+#endif
+#ifdef ARDUINO_ARCH_ESP8266
+    // the ESP8266 bootloader decompresses gzip compressed images itself
+    const bool compressed = false;
+#endif
+    if (success && !this->ota_writer_.begin(compressed, false)) {
+      ESP_LOGW(TAG, "Allocating the OTA buffers failed!");
+      this->ota_end_();
+      this->ota_failed_ = true;
+      return;
+    }
 #endif
     if (!success) {
       report_ota_error();
+      this->ota_failed_ = true;
       return;
     }
-  } else if (Update.hasError()) {
+  } else if (Update.hasError() || this->ota_failed_) {
     // don't spam logs with errors if something failed at start
     return;
   }
 
-  success = Update.write(data, len) == len;
+  success = this->ota_write_(data, len);
   if (!success) {
     report_ota_error();
+    this->ota_end_();
+    this->ota_failed_ = true;
     return;
   }
   this->ota_read_length_ += len;
@@ -191,23 +346,27 @@ void WebServer::handleUpload(AsyncWebServerRequest *request, const String &filen
   }
 
   if (final) {
-    if (Update.end(true)) {
+    success = this->ota_finish_();
+    this->ota_end_();
+    if (success && Update.end(true)) {
       ESP_LOGI(TAG, "OTA update successful!");
       this->set_timeout(100, []() { safe_reboot("ota"); });
     } else {
       report_ota_error();
+      this->ota_failed_ = true;
     }
   }
 }
 
-void WebServer::handle_index_request(AsyncWebServerRequest *request) {
-  AsyncResponseStream *stream = request->beginResponseStream("text/html");
+void WebServer::write_index_(Print *stream) {
   std::string title = App.get_name() + " Web Server";
   stream->print(F("<!DOCTYPE html><html><head><meta charset=UTF-8><title>"));
   stream->print(title.c_str());
   stream->print(F("</title><link rel=\"stylesheet\" href=\""));
   if (this->css_url_ != nullptr) {
     stream->print(this->css_url_);
+  } else if (this->css_include_ != nullptr) {
+    stream->print(F("/webserver.css"));
   } else {
     stream->print(F("https://esphome.io/_static/webserver-v1.min.css"));
   }
@@ -259,103 +418,183 @@ void WebServer::handle_index_request(AsyncWebServerRequest *request) {
                   "<script src=\""));
   if (this->js_url_ != nullptr) {
     stream->print(this->js_url_);
+  } else if (this->js_include_ != nullptr) {
+    stream->print(F("/webserver.js"));
   } else {
     stream->print(F("https://esphome.io/_static/webserver-v1.min.js"));
   }
   stream->print(F("\"></script></article></body></html>"));
+}
+void WebServer::build_index_() {
+  if (!this->index_etag_.empty())
+    return;
+  StreamString html;
+  this->write_index_(&html);
+  const auto *data = reinterpret_cast<const uint8_t *>(html.c_str());
+  this->index_gz_ = gzip_compress(data, html.length());
+  char etag[11];
+  sprintf(etag, "\"%08X\"", calculate_crc32(data, html.length()));
+  this->index_etag_ = etag;
+  ESP_LOGD(TAG, "Built index page: %u bytes, %u compressed", html.length(), this->index_gz_.size());
+}
+void WebServer::send_gzip_(AsyncWebServerRequest *request, const char *content_type, const uint8_t *data, size_t len,
+                           bool progmem, const std::string &etag) {
+  AsyncWebServerResponse *response;
+  if (request->hasHeader("If-None-Match") && request->getHeader("If-None-Match")->value() == etag.c_str()) {
+    response = request->beginResponse(304);
+  } else if (progmem) {
+    response = request->beginResponse_P(200, content_type, data, len);
+    response->addHeader("Content-Encoding", "gzip");
+  } else {
+    response = request->beginResponse(content_type, len, [data, len](uint8_t *buffer, size_t max_len, size_t index) {
+      const size_t count = std::min(max_len, len - index);
+      memcpy(buffer, data + index, count);
+      return count;
+    });
+    response->addHeader("Content-Encoding", "gzip");
+  }
+  response->addHeader("ETag", etag.c_str());
+  // cached copies have to be revalidated, but that's answered with an empty 304
+  response->addHeader("Cache-Control", "no-cache");
+  response->addHeader("Vary", "Accept-Encoding");
+  request->send(response);
+}
+void WebServer::handle_index_request(AsyncWebServerRequest *request) {
+  if (!request->hasHeader("Accept-Encoding") || request->getHeader("Accept-Encoding")->value().indexOf("gzip") < 0) {
+    AsyncResponseStream *stream = request->beginResponseStream("text/html");
+    this->write_index_(stream);
+    request->send(stream);
+    return;
+  }
 
-  request->send(stream);
+  this->build_index_();
+  this->send_gzip_(request, "text/html", this->index_gz_.data(), this->index_gz_.size(), false, this->index_etag_);
 }
 
 #ifdef USE_SENSOR
 void WebServer::on_sensor_update(sensor::Sensor *obj, float state) {
+  if (obj->is_internal())
+    return;
   this->events_.send(this->sensor_json(obj, state).c_str(), "state");
 }
 void WebServer::handle_sensor_request(AsyncWebServerRequest *request, UrlMatch match) {
-  for (sensor::Sensor *obj : this->sensors_) {
-    if (obj->is_internal())
-      continue;
-    if (obj->get_object_id() != match.id)
-      continue;
-    std::string data = this->sensor_json(obj, obj->state);
-    request->send(200, "text/json", data.c_str());
+  auto *obj = static_cast<sensor::Sensor *>(this->find_entity_(ENTITY_SENSOR, match));
+  if (obj == nullptr) {
+    request->send(404);
+    return;
+  }
+#ifdef USE_SENSOR_HISTORY
+  if (match.method == "history") {
+    this->handle_sensor_history_request(request, obj);
+    return;
+  }
+#endif
+  std::string data = this->sensor_json(obj, obj->state);
+  request->send(200, "text/json", data.c_str());
+}
+#ifdef USE_SENSOR_HISTORY
+void WebServer::handle_sensor_history_request(AsyncWebServerRequest *request, sensor::Sensor *obj) {
+  if (obj->get_history() == nullptr) {
+    request->send(404);
     return;
   }
-  request->send(404);
+  auto tier = sensor::SENSOR_HISTORY_RAW;
+  if (request->hasParam("tier")) {
+    String value = request->getParam("tier")->value();
+    if (value == "minute") {
+      tier = sensor::SENSOR_HISTORY_MINUTE;
+    } else if (value == "quarter_hour") {
+      tier = sensor::SENSOR_HISTORY_QUARTER_HOUR;
+    } else if (value != "raw") {
+      request->send(400);
+      return;
+    }
+  }
+  // streamed in chunks like the trace, the raw tier alone can be several kB
+  auto writer = std::make_shared<sensor::SensorHistoryJsonWriter>(obj->get_history(), tier);
+  auto filler = [writer](uint8_t *buffer, size_t max_len, size_t index) -> size_t {
+    return writer->write(reinterpret_cast<char *>(buffer), max_len);
+  };
+  request->send(request->beginChunkedResponse("application/json", filler));
 }
+#endif
 std::string WebServer::sensor_json(sensor::Sensor *obj, float value) {
-  return build_json([obj, value](JsonObject &root) {
-    root["id"] = "sensor-" + obj->get_object_id();
-    std::string state = value_accuracy_to_string(value, obj->get_accuracy_decimals());
-    if (!obj->get_unit_of_measurement().empty())
-      state += " " + obj->get_unit_of_measurement();
-    root["state"] = state;
-    root["value"] = value;
+  return write_json([obj, value](JsonWriter &writer) {
+    writer.add("id", "sensor-" + obj->get_object_id());
+    char state[VALUE_ACCURACY_MAX_LEN];
+    value_accuracy_to_buf(state, value, obj->get_accuracy_decimals());
+    const char *unit = obj->get_unit_of_measurement();
+    if (unit[0] != '\0') {
+      std::string with_unit = state;
+      with_unit += ' ';
+      with_unit += unit;
+      writer.add("state", with_unit);
+    } else {
+      writer.add("state", state);
+    }
+    writer.add("value", value);
   });
 }
 #endif
 
 #ifdef USE_TEXT_SENSOR
-void WebServer::on_text_sensor_update(text_sensor::TextSensor *obj, std::string state) {
+void WebServer::on_text_sensor_update(text_sensor::TextSensor *obj, const std::string &state) {
+  if (obj->is_internal())
+    return;
   this->events_.send(this->text_sensor_json(obj, state).c_str(), "state");
 }
 void WebServer::handle_text_sensor_request(AsyncWebServerRequest *request, UrlMatch match) {
-  for (text_sensor::TextSensor *obj : this->text_sensors_) {
-    if (obj->is_internal())
-      continue;
-    if (obj->get_object_id() != match.id)
-      continue;
-    std::string data = this->text_sensor_json(obj, obj->state);
-    request->send(200, "text/json", data.c_str());
+  auto *obj = static_cast<text_sensor::TextSensor *>(this->find_entity_(ENTITY_TEXT_SENSOR, match));
+  if (obj == nullptr) {
+    request->send(404);
     return;
   }
-  request->send(404);
+  std::string data = this->text_sensor_json(obj, obj->state);
+  request->send(200, "text/json", data.c_str());
 }
 std::string WebServer::text_sensor_json(text_sensor::TextSensor *obj, const std::string &value) {
-  return build_json([obj, value](JsonObject &root) {
-    root["id"] = "text_sensor-" + obj->get_object_id();
-    root["state"] = value;
-    root["value"] = value;
+  return write_json([obj, value](JsonWriter &writer) {
+    writer.add("id", "text_sensor-" + obj->get_object_id());
+    writer.add("state", value);
+    writer.add("value", value);
   });
 }
 #endif
 
 #ifdef USE_SWITCH
 void WebServer::on_switch_update(switch_::Switch *obj, bool state) {
+  if (obj->is_internal())
+    return;
   this->events_.send(this->switch_json(obj, state).c_str(), "state");
 }
 std::string WebServer::switch_json(switch_::Switch *obj, bool value) {
-  return build_json([obj, value](JsonObject &root) {
-    root["id"] = "switch-" + obj->get_object_id();
-    root["state"] = value ? "ON" : "OFF";
-    root["value"] = value;
+  return write_json([obj, value](JsonWriter &writer) {
+    writer.add("id", "switch-" + obj->get_object_id());
+    writer.add("state", value ? "ON" : "OFF");
+    writer.add("value", value);
   });
 }
 void WebServer::handle_switch_request(AsyncWebServerRequest *request, UrlMatch match) {
-  for (switch_::Switch *obj : this->switches_) {
-    if (obj->is_internal())
-      continue;
-    if (obj->get_object_id() != match.id)
-      continue;
-
-    if (request->method() == HTTP_GET) {
-      std::string data = this->switch_json(obj, obj->state);
-      request->send(200, "text/json", data.c_str());
-    } else if (match.method == "toggle") {
-      this->defer([obj]() { obj->toggle(); });
-      request->send(200);
-    } else if (match.method == "turn_on") {
-      this->defer([obj]() { obj->turn_on(); });
-      request->send(200);
-    } else if (match.method == "turn_off") {
-      this->defer([obj]() { obj->turn_off(); });
-      request->send(200);
-    } else {
-      request->send(404);
-    }
+  auto *obj = static_cast<switch_::Switch *>(this->find_entity_(ENTITY_SWITCH, match));
+  if (obj == nullptr) {
+    request->send(404);
     return;
   }
-  request->send(404);
+  if (request->method() == HTTP_GET) {
+    std::string data = this->switch_json(obj, obj->state);
+    request->send(200, "text/json", data.c_str());
+  } else if (match.method == "toggle") {
+    this->defer([obj]() { obj->toggle(); });
+    request->send(200);
+  } else if (match.method == "turn_on") {
+    this->defer([obj]() { obj->turn_on(); });
+    request->send(200);
+  } else if (match.method == "turn_off") {
+    this->defer([obj]() { obj->turn_off(); });
+    request->send(200);
+  } else {
+    request->send(404);
+  }
 }
 #endif
 
@@ -366,23 +605,20 @@ void WebServer::on_binary_sensor_update(binary_sensor::BinarySensor *obj, bool s
   this->events_.send(this->binary_sensor_json(obj, state).c_str(), "state");
 }
 std::string WebServer::binary_sensor_json(binary_sensor::BinarySensor *obj, bool value) {
-  return build_json([obj, value](JsonObject &root) {
-    root["id"] = "binary_sensor-" + obj->get_object_id();
-    root["state"] = value ? "ON" : "OFF";
-    root["value"] = value;
+  return write_json([obj, value](JsonWriter &writer) {
+    writer.add("id", "binary_sensor-" + obj->get_object_id());
+    writer.add("state", value ? "ON" : "OFF");
+    writer.add("value", value);
   });
 }
 void WebServer::handle_binary_sensor_request(AsyncWebServerRequest *request, UrlMatch match) {
-  for (binary_sensor::BinarySensor *obj : this->binary_sensors_) {
-    if (obj->is_internal())
-      continue;
-    if (obj->get_object_id() != match.id)
-      continue;
-    std::string data = this->binary_sensor_json(obj, obj->state);
-    request->send(200, "text/json", data.c_str());
+  auto *obj = static_cast<binary_sensor::BinarySensor *>(this->find_entity_(ENTITY_BINARY_SENSOR, match));
+  if (obj == nullptr) {
+    request->send(404);
     return;
   }
-  request->send(404);
+  std::string data = this->binary_sensor_json(obj, obj->state);
+  request->send(200, "text/json", data.c_str());
 }
 #endif
 
@@ -393,75 +629,71 @@ void WebServer::on_fan_update(fan::FanState *obj) {
   this->events_.send(this->fan_json(obj).c_str(), "state");
 }
 std::string WebServer::fan_json(fan::FanState *obj) {
-  return build_json([obj](JsonObject &root) {
-    root["id"] = "fan-" + obj->get_object_id();
-    root["state"] = obj->state ? "ON" : "OFF";
-    root["value"] = obj->state;
+  return write_json([obj](JsonWriter &writer) {
+    writer.add("id", "fan-" + obj->get_object_id());
+    writer.add("state", obj->state ? "ON" : "OFF");
+    writer.add("value", obj->state);
     if (obj->get_traits().supports_speed()) {
       switch (obj->speed) {
         case fan::FAN_SPEED_LOW:
-          root["speed"] = "low";
+          writer.add("speed", "low");
           break;
         case fan::FAN_SPEED_MEDIUM:
-          root["speed"] = "medium";
+          writer.add("speed", "medium");
           break;
         case fan::FAN_SPEED_HIGH:
-          root["speed"] = "high";
+          writer.add("speed", "high");
           break;
       }
     }
     if (obj->get_traits().supports_oscillation())
-      root["oscillation"] = obj->oscillating;
+      writer.add("oscillation", obj->oscillating);
   });
 }
 void WebServer::handle_fan_request(AsyncWebServerRequest *request, UrlMatch match) {
-  for (fan::FanState *obj : this->fans_) {
-    if (obj->is_internal())
-      continue;
-    if (obj->get_object_id() != match.id)
-      continue;
-
-    if (request->method() == HTTP_GET) {
-      std::string data = this->fan_json(obj);
-      request->send(200, "text/json", data.c_str());
-    } else if (match.method == "toggle") {
-      this->defer([obj]() { obj->toggle().perform(); });
-      request->send(200);
-    } else if (match.method == "turn_on") {
-      auto call = obj->turn_on();
-      if (request->hasParam("speed")) {
-        String speed = request->getParam("speed")->value();
-        call.set_speed(speed.c_str());
-      }
-      if (request->hasParam("oscillation")) {
-        String speed = request->getParam("oscillation")->value();
-        auto val = parse_on_off(speed.c_str());
-        switch (val) {
-          case PARSE_ON:
-            call.set_oscillating(true);
-            break;
-          case PARSE_OFF:
-            call.set_oscillating(false);
-            break;
-          case PARSE_TOGGLE:
-            call.set_oscillating(!obj->oscillating);
-            break;
-          case PARSE_NONE:
-            request->send(404);
-            return;
-        }
+  auto *obj = static_cast<fan::FanState *>(this->find_entity_(ENTITY_FAN, match));
+  if (obj == nullptr) {
+    request->send(404);
+    return;
+  }
+  if (request->method() == HTTP_GET) {
+    std::string data = this->fan_json(obj);
+    request->send(200, "text/json", data.c_str());
+  } else if (match.method == "toggle") {
+    this->defer([obj]() { obj->toggle().perform(); });
+    request->send(200);
+  } else if (match.method == "turn_on") {
+    auto call = obj->turn_on();
+    if (request->hasParam("speed")) {
+      String speed = request->getParam("speed")->value();
+      call.set_speed(speed.c_str());
+    }
+    if (request->hasParam("oscillation")) {
+      String speed = request->getParam("oscillation")->value();
+      auto val = parse_on_off(speed.c_str());
+      switch (val) {
+        case PARSE_ON:
+          call.set_oscillating(true);
+          break;
+        case PARSE_OFF:
+          call.set_oscillating(false);
+          break;
+        case PARSE_TOGGLE:
+          call.set_oscillating(!obj->oscillating);
+          break;
+        case PARSE_NONE:
+          request->send(404);
+          return;
       }
-      this->defer([call]() { call.perform(); });
-      request->send(200);
-    } else if (match.method == "turn_off") {
-      this->defer([obj]() { obj->turn_off().perform(); });
-      request->send(200);
-    } else {
-      request->send(404);
     }
-    return;
+    this->defer([call]() { call.perform(); });
+    request->send(200);
+  } else if (match.method == "turn_off") {
+    this->defer([obj]() { obj->turn_off().perform(); });
+    request->send(200);
+  } else {
+    request->send(404);
   }
-  request->send(404);
 }
 #endif
 
@@ -472,76 +704,180 @@ void WebServer::on_light_update(light::LightState *obj) {
   this->events_.send(this->light_json(obj).c_str(), "state");
 }
 void WebServer::handle_light_request(AsyncWebServerRequest *request, UrlMatch match) {
-  for (light::LightState *obj : this->lights_) {
-    if (obj->is_internal())
-      continue;
-    if (obj->get_object_id() != match.id)
-      continue;
-
-    if (request->method() == HTTP_GET) {
-      std::string data = this->light_json(obj);
-      request->send(200, "text/json", data.c_str());
-    } else if (match.method == "toggle") {
-      this->defer([obj]() { obj->toggle().perform(); });
-      request->send(200);
-    } else if (match.method == "turn_on") {
-      auto call = obj->turn_on();
-      if (obj->get_traits().has_brightness() && request->hasParam("brightness"))
-        call.set_brightness(request->getParam("brightness")->value().toFloat() / 255.0f);
-      if (obj->get_traits().has_rgb()) {
-        if (request->hasParam("r"))
-          call.set_red(request->getParam("r")->value().toFloat() / 255.0f);
-        if (request->hasParam("g"))
-          call.set_green(request->getParam("g")->value().toFloat() / 255.0f);
-        if (request->hasParam("b"))
-          call.set_blue(request->getParam("b")->value().toFloat() / 255.0f);
-      }
-      if (obj->get_traits().has_rgb_white_value() && request->hasParam("white_value"))
-        call.set_white(request->getParam("white_value")->value().toFloat() / 255.0f);
-      if (obj->get_traits().has_color_temperature() && request->hasParam("color_temp"))
-        call.set_color_temperature(request->getParam("color_temp")->value().toFloat());
+  auto *obj = static_cast<light::LightState *>(this->find_entity_(ENTITY_LIGHT, match));
+  if (obj == nullptr) {
+    request->send(404);
+    return;
+  }
+  if (request->method() == HTTP_GET) {
+    std::string data = this->light_json(obj);
+    request->send(200, "text/json", data.c_str());
+  } else if (match.method == "toggle") {
+    this->defer([obj]() { obj->toggle().perform(); });
+    request->send(200);
+  } else if (match.method == "turn_on") {
+    auto call = obj->turn_on();
+    if (obj->get_traits().has_brightness() && request->hasParam("brightness"))
+      call.set_brightness(request->getParam("brightness")->value().toFloat() / 255.0f);
+    if (obj->get_traits().has_rgb()) {
+      if (request->hasParam("r"))
+        call.set_red(request->getParam("r")->value().toFloat() / 255.0f);
+      if (request->hasParam("g"))
+        call.set_green(request->getParam("g")->value().toFloat() / 255.0f);
+      if (request->hasParam("b"))
+        call.set_blue(request->getParam("b")->value().toFloat() / 255.0f);
+    }
+    if (obj->get_traits().has_rgb_white_value() && request->hasParam("white_value"))
+      call.set_white(request->getParam("white_value")->value().toFloat() / 255.0f);
+    if (obj->get_traits().has_color_temperature() && request->hasParam("color_temp"))
+      call.set_color_temperature(request->getParam("color_temp")->value().toFloat());
 
-      if (request->hasParam("flash"))
-        call.set_flash_length((uint32_t) request->getParam("flash")->value().toFloat() * 1000);
+    if (request->hasParam("flash"))
+      call.set_flash_length((uint32_t) request->getParam("flash")->value().toFloat() * 1000);
 
-      if (request->hasParam("transition"))
-        call.set_transition_length((uint32_t) request->getParam("transition")->value().toFloat() * 1000);
+    if (request->hasParam("transition"))
+      call.set_transition_length((uint32_t) request->getParam("transition")->value().toFloat() * 1000);
 
-      if (request->hasParam("effect")) {
-        const char *effect = request->getParam("effect")->value().c_str();
-        call.set_effect(effect);
-      }
+    if (request->hasParam("effect")) {
+      const char *effect = request->getParam("effect")->value().c_str();
+      call.set_effect(effect);
+    }
 
-      this->defer([call]() mutable { call.perform(); });
-      request->send(200);
-    } else if (match.method == "turn_off") {
-      auto call = obj->turn_off();
-      if (request->hasParam("transition")) {
-        auto length = (uint32_t) request->getParam("transition")->value().toFloat() * 1000;
-        call.set_transition_length(length);
-      }
-      this->defer([call]() mutable { call.perform(); });
-      request->send(200);
-    } else {
-      request->send(404);
+    this->defer([call]() mutable { call.perform(); });
+    request->send(200);
+  } else if (match.method == "turn_off") {
+    auto call = obj->turn_off();
+    if (request->hasParam("transition")) {
+      auto length = (uint32_t) request->getParam("transition")->value().toFloat() * 1000;
+      call.set_transition_length(length);
     }
-    return;
+    this->defer([call]() mutable { call.perform(); });
+    request->send(200);
+  } else {
+    request->send(404);
   }
-  request->send(404);
 }
 std::string WebServer::light_json(light::LightState *obj) {
-  return build_json([obj](JsonObject &root) {
-    root["id"] = "light-" + obj->get_object_id();
-    root["state"] = obj->remote_values.is_on() ? "ON" : "OFF";
-    obj->dump_json(root);
+  return write_json([obj](JsonWriter &writer) {
+    writer.add("id", "light-" + obj->get_object_id());
+    // dump_json() adds the state
+    obj->dump_json(writer);
   });
 }
 #endif
 
+void WebServer::handle_states_request(AsyncWebServerRequest *request) {
+  AsyncResponseStream *stream = request->beginResponseStream("application/json", STATES_BUFFER_SIZE);
+  bool first = true;
+  this->for_each_state_([this, stream, &first](Nameable *obj, EntityType type) {
+    stream->print(first ? '[' : ',');
+    stream->print(this->state_json_(obj, type).c_str());
+    first = false;
+  });
+  stream->print(first ? F("[]") : F("]"));
+  request->send(stream);
+}
+
+/// Write a Prometheus sample of the entity, with the id and name as labels.
+static void write_metric(Print *stream, const char *metric, Nameable *obj, const char *value) {
+  stream->print(metric);
+  stream->print(F("{id=\""));
+  stream->print(obj->get_object_id().c_str());
+  stream->print(F("\",name=\""));
+  for (char c : obj->get_name()) {
+    if (c == '"' || c == '\\')
+      stream->print('\\');
+    stream->print(c);
+  }
+  stream->print(F("\"} "));
+  stream->print(value);
+  stream->print('\n');
+}
+
+void WebServer::handle_prometheus_request(AsyncWebServerRequest *request) {
+  AsyncResponseStream *stream = request->beginResponseStream("text/plain; version=0.0.4", STATES_BUFFER_SIZE);
+#ifdef USE_SENSOR
+  stream->print(F("#TYPE esphome_sensor_value gauge\n"));
+  char value[VALUE_ACCURACY_MAX_LEN];
+  for (auto *obj : this->sensors_) {
+    if (obj->is_internal())
+      continue;
+    if (isnan(obj->state)) {
+      write_metric(stream, "esphome_sensor_value", obj, "NaN");
+    } else {
+      value_accuracy_to_buf(value, obj->state, obj->get_accuracy_decimals());
+      write_metric(stream, "esphome_sensor_value", obj, value);
+    }
+  }
+#endif
+#ifdef USE_BINARY_SENSOR
+  stream->print(F("#TYPE esphome_binary_sensor_value gauge\n"));
+  for (auto *obj : this->binary_sensors_)
+    if (!obj->is_internal())
+      write_metric(stream, "esphome_binary_sensor_value", obj, obj->state ? "1" : "0");
+#endif
+#ifdef USE_SWITCH
+  stream->print(F("#TYPE esphome_switch_value gauge\n"));
+  for (auto *obj : this->switches_)
+    if (!obj->is_internal())
+      write_metric(stream, "esphome_switch_value", obj, obj->state ? "1" : "0");
+#endif
+#ifdef USE_FAN
+  stream->print(F("#TYPE esphome_fan_value gauge\n"));
+  for (auto *obj : this->fans_)
+    if (!obj->is_internal())
+      write_metric(stream, "esphome_fan_value", obj, obj->state ? "1" : "0");
+#endif
+#ifdef USE_LIGHT
+  stream->print(F("#TYPE esphome_light_state gauge\n"));
+  for (auto *obj : this->lights_)
+    if (!obj->is_internal())
+      write_metric(stream, "esphome_light_state", obj, obj->remote_values.is_on() ? "1" : "0");
+  stream->print(F("#TYPE esphome_light_brightness gauge\n"));
+  for (auto *obj : this->lights_) {
+    if (obj->is_internal())
+      continue;
+    char brightness[VALUE_ACCURACY_MAX_LEN];
+    value_accuracy_to_buf(brightness, obj->remote_values.get_brightness(), 3);
+    write_metric(stream, "esphome_light_brightness", obj, brightness);
+  }
+#endif
+#ifdef USE_METRICS
+  // the diagnostics of the node itself, registered by the subsystems
+  stream->print(global_metrics.to_prometheus().c_str());
+#endif
+  request->send(stream);
+}
+
+#ifdef USE_TRACER
+void WebServer::handle_trace_request(AsyncWebServerRequest *request) {
+  // streamed in chunks, the whole JSON doesn't fit in memory
+  auto writer = std::make_shared<TraceJsonWriter>(global_tracer.take_events());
+  auto filler = [writer](uint8_t *buffer, size_t max_len, size_t index) -> size_t {
+    return writer->write(reinterpret_cast<char *>(buffer), max_len);
+  };
+  request->send(request->beginChunkedResponse("application/json", filler));
+}
+#endif
+
 bool WebServer::canHandle(AsyncWebServerRequest *request) {
   if (request->url() == "/")
     return true;
 
+  if (request->url() == "/states" && request->method() == HTTP_GET)
+    return true;
+  if (request->url() == "/metrics" && request->method() == HTTP_GET && this->prometheus_)
+    return true;
+#ifdef USE_TRACER
+  if (request->url() == "/trace.json" && request->method() == HTTP_GET)
+    return true;
+#endif
+
+  if (request->url() == "/webserver.css" && this->css_include_ != nullptr)
+    return true;
+  if (request->url() == "/webserver.js" && this->js_include_ != nullptr)
+    return true;
+
   if (request->url() == "/update" && request->method() == HTTP_POST)
     return true;
 
@@ -586,6 +922,32 @@ void WebServer::handleRequest(AsyncWebServerRequest *request) {
     return;
   }
 
+  if (request->url() == "/states") {
+    this->handle_states_request(request);
+    return;
+  }
+  if (request->url() == "/metrics") {
+    this->handle_prometheus_request(request);
+    return;
+  }
+#ifdef USE_TRACER
+  if (request->url() == "/trace.json") {
+    this->handle_trace_request(request);
+    return;
+  }
+#endif
+
+  // the included assets are only available compressed
+  if (request->url() == "/webserver.css") {
+    this->send_gzip_(request, "text/css", this->css_include_, this->css_include_len_, true, this->include_etag_);
+    return;
+  }
+  if (request->url() == "/webserver.js") {
+    this->send_gzip_(request, "text/javascript", this->js_include_, this->js_include_len_, true,
+                     this->include_etag_);
+    return;
+  }
+
   if (request->url() == "/update") {
     this->handle_update_request(request);
     return;
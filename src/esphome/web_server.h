@@ -7,6 +7,9 @@
 
 #include "esphome/component.h"
 #include "esphome/controller.h"
+#ifdef USE_OTA
+#include "esphome/ota_component.h"
+#endif
 
 #include <vector>
 #include <ESPAsyncWebServer.h>
@@ -28,7 +31,8 @@ struct UrlMatch {
  * by esphome.io by default), an event source under '/events' that automatically sends
  * all state updates in real time + the debug log. Lastly, there's an REST API available
  * under the '/light/...', '/sensor/...', ... URLs. A full documentation for this API
- * can be found under https://esphome.io/web-api/index.html.
+ * can be found under https://esphome.io/web-api/index.html. The states of all entities can
+ * also be fetched at once under '/states' (and '/metrics' for Prometheus, if enabled).
  */
 class WebServer : public StoringUpdateListenerController, public Component, public AsyncWebHandler {
  public:
@@ -49,9 +53,26 @@ class WebServer : public StoringUpdateListenerController, public Component, publ
    */
   void set_js_url(const char *js_url);
 
+  /** Serve the stylesheet from the firmware under '/webserver.css' instead of loading it from css_url.
+   *
+   * @param css_gz The gzip-compressed stylesheet, stored in PROGMEM.
+   * @param len The length of the compressed stylesheet.
+   */
+  void set_css_include(const uint8_t *css_gz, size_t len);
+
+  /** Serve the script from the firmware under '/webserver.js' instead of loading it from js_url.
+   *
+   * @param js_gz The gzip-compressed script, stored in PROGMEM.
+   * @param len The length of the compressed script.
+   */
+  void set_js_include(const uint8_t *js_gz, size_t len);
+
   /// Set the web server port.
   void set_port(uint16_t port);
 
+  /// Enable the Prometheus text exposition of all states under '/metrics', defaults to false.
+  void set_prometheus(bool prometheus);
+
   // ========== INTERNAL METHODS ==========
   // (In most use cases you won't need these)
   /// Setup the internal web server and register handlers.
@@ -59,19 +80,46 @@ class WebServer : public StoringUpdateListenerController, public Component, publ
 
   void dump_config() override;
 
+  /** Send the states that changed since the last loop() to the event source clients.
+   *
+   * Updates of the same entity within one loop are coalesced, only its latest state is encoded (once for all
+   * clients) and sent.
+   */
+  void loop() override;
+
   /// MQTT setup priority.
   float get_setup_priority() const override;
 
-  /// Handle an index request under '/'.
+  /** Handle an index request under '/'.
+   *
+   * The page only contains the names of the entities (the states are sent through the event source), so
+   * it's built and compressed once and then served from that buffer with an ETag.
+   */
   void handle_index_request(AsyncWebServerRequest *request);
 
   void handle_update_request(AsyncWebServerRequest *request);
 
+  /// Handle a request for the states of all entities as one JSON array under '/states'.
+  void handle_states_request(AsyncWebServerRequest *request);
+
+  /// Handle a Prometheus scrape under '/metrics', with the entity states and the metrics of the MetricsRegistry.
+  void handle_prometheus_request(AsyncWebServerRequest *request);
+
+#ifdef USE_TRACER
+  /// Handle a trace request under '/trace.json', sends the recorded events as Chrome trace JSON.
+  void handle_trace_request(AsyncWebServerRequest *request);
+#endif
+
 #ifdef USE_SENSOR
   void on_sensor_update(sensor::Sensor *obj, float state) override;
   /// Handle a sensor request under '/sensor/<id>'.
   void handle_sensor_request(AsyncWebServerRequest *request, UrlMatch match);
 
+#ifdef USE_SENSOR_HISTORY
+  /// Handle a history request under '/sensor/<id>/history?tier=<raw/minute/quarter_hour>'.
+  void handle_sensor_history_request(AsyncWebServerRequest *request, sensor::Sensor *obj);
+#endif
+
   /// Dump the sensor state with its value as a JSON string.
   std::string sensor_json(sensor::Sensor *obj, float value);
 #endif
@@ -117,7 +165,7 @@ class WebServer : public StoringUpdateListenerController, public Component, publ
 #endif
 
 #ifdef USE_TEXT_SENSOR
-  void on_text_sensor_update(text_sensor::TextSensor *obj, std::string state) override;
+  void on_text_sensor_update(text_sensor::TextSensor *obj, const std::string &state) override;
 
   /// Handle a text sensor request under '/text_sensor/<id>'.
   void handle_text_sensor_request(AsyncWebServerRequest *request, UrlMatch match);
@@ -136,13 +184,51 @@ class WebServer : public StoringUpdateListenerController, public Component, publ
   bool isRequestHandlerTrivial() override;
 
  protected:
+  /// Find the non-internal entity the URL refers to, nullptr if there's none.
+  Nameable *find_entity_(EntityType type, const UrlMatch &match);
+  std::string state_json_(Nameable *obj, EntityType type);
+  /// Call the callback with each non-internal entity.
+  void for_each_state_(const std::function<void(Nameable *, EntityType)> &callback);
+
+  /// Write the HTML of the index page.
+  void write_index_(Print *stream);
+  /// Build the compressed index page and its ETag if that hasn't been done yet.
+  void build_index_();
+  /// Send compressed content with its ETag, or 304 if the client's cached copy is still current.
+  void send_gzip_(AsyncWebServerRequest *request, const char *content_type, const uint8_t *data, size_t len,
+                  bool progmem, const std::string &etag);
+  /// Pass a chunk of the uploaded OTA image on to be written to flash.
+  bool ota_write_(const uint8_t *data, size_t len);
+  /// Write the rest of the OTA image and wait for it to be in flash.
+  bool ota_finish_();
+  /// Release the OTA buffers, also after a failed or aborted upload.
+  void ota_end_();
+
   uint16_t port_;
   AsyncWebServer *server_;
   AsyncEventSource events_{"/events"};
   const char *css_url_{nullptr};
   const char *js_url_{nullptr};
+  const uint8_t *css_include_{nullptr};
+  size_t css_include_len_{0};
+  const uint8_t *js_include_{nullptr};
+  size_t js_include_len_{0};
+  /// The gzip-compressed index page, built on the first request.
+  std::vector<uint8_t> index_gz_;
+  std::string index_etag_;
+  /// The ETag of the included assets, they only change with the firmware.
+  std::string include_etag_;
+  bool prometheus_{false};
   uint32_t last_ota_progress_{0};
   uint32_t ota_read_length_{0};
+  bool ota_failed_{false};
+#ifdef USE_OTA
+  /// Shared with the native OTA, on the ESP32 it writes to flash in a task while the next buffer is received.
+  OTAWriter ota_writer_;
+  /// The buffer the upload is collected into, nullptr if none is taken from the writer.
+  uint8_t *ota_buffer_{nullptr};
+  size_t ota_buffer_len_{0};
+#endif
 };
 
 ESPHOME_NAMESPACE_END
@@ -14,6 +14,7 @@
 
 #include "esphome/helpers.h"
 #include "esphome/log.h"
+#include "esphome/metrics.h"
 #include "esphome/esphal.h"
 #include "esphome/util.h"
 
@@ -21,10 +22,21 @@ ESPHOME_NAMESPACE_BEGIN
 
 static const char *TAG = "wifi";
 
+/// How long a lost connection may go unnoticed in the idle mode.
+static const uint32_t WIFI_IDLE_TIME = 1000;
+/// How long mDNS queries may wait in the idle mode, the responder of the ESP8266 only runs in loop().
+static const uint32_t WIFI_MDNS_IDLE_TIME = 100;
+
 float WiFiComponent::get_setup_priority() const { return setup_priority::WIFI; }
 
 void WiFiComponent::setup() {
   ESP_LOGCONFIG(TAG, "Setting up WiFi...");
+#ifdef USE_METRICS
+  global_metrics.register_gauge("wifi_rssi_dbm", "Signal strength of the connected access point, NaN if disconnected.",
+                                [this]() { return this->is_connected() ? WiFi.RSSI() : NAN; });
+  global_metrics.register_counter("wifi_reconnects_total", "Connections that were lost and reconnected.",
+                                  [this]() { return this->reconnects_; });
+#endif
 
   this->wifi_register_callbacks_();
 
@@ -40,8 +52,14 @@ void WiFiComponent::setup() {
 
     this->wifi_apply_power_save_();
 
-    if (this->fast_connect_) {
+    this->connect_started_ = millis();
+    if (this->fast_reconnect_)
+      this->fast_reconnect_pref_ = global_preferences.make_preference<WiFiFastReconnectState>(2395346938UL);
+    if (this->start_fast_reconnect_()) {
+      // connecting to the last access point
+    } else if (this->fast_connect_) {
       this->selected_ap_ = this->sta_[0];
+      this->selected_sta_index_ = 0;
       this->start_connecting(this->selected_ap_, false);
     } else {
       this->start_scanning();
@@ -68,6 +86,8 @@ void WiFiComponent::loop() {
         this->status_set_warning();
         if (millis() - this->action_started_ > 5000) {
           if (this->fast_connect_) {
+            this->selected_ap_ = this->sta_[0];
+            this->selected_sta_index_ = 0;
             this->start_connecting(this->sta_[0], false);
           } else {
             this->start_scanning();
@@ -90,6 +110,9 @@ void WiFiComponent::loop() {
       case WIFI_COMPONENT_STATE_STA_CONNECTED: {
         if (!this->is_connected()) {
           ESP_LOGW(TAG, "WiFi Connection lost... Reconnecting...");
+          this->reconnects_++;
+          this->connect_started_ = now;
+          this->scan_duration_ = 0;
           this->retry_connect();
         } else {
           this->status_clear_warning();
@@ -108,6 +131,9 @@ void WiFiComponent::loop() {
         reboot("wifi");
       }
     }
+
+    if (this->power_save_ == WIFI_POWER_SAVE_ADAPTIVE)
+      this->update_adaptive_power_save_();
   }
 
   network_tick_mdns();
@@ -118,6 +144,8 @@ WiFiComponent::WiFiComponent() { global_wifi_component = this; }
 bool WiFiComponent::has_ap() const { return !this->ap_.get_ssid().empty(); }
 bool WiFiComponent::has_sta() const { return !this->sta_.empty(); }
 void WiFiComponent::set_fast_connect(bool fast_connect) { this->fast_connect_ = fast_connect; }
+void WiFiComponent::set_fast_reconnect(bool fast_reconnect) { this->fast_reconnect_ = fast_reconnect; }
+void WiFiComponent::set_cache_dhcp_lease(bool cache_dhcp_lease) { this->cache_dhcp_lease_ = cache_dhcp_lease; }
 IPAddress WiFiComponent::get_ip_address() {
   if (this->has_sta())
     return this->wifi_sta_ip_();
@@ -160,6 +188,25 @@ void WiFiComponent::setup_ap_config_() {
 float WiFiComponent::get_loop_priority() const {
   return 10.0f;  // before other loop components
 }
+uint32_t WiFiComponent::get_loop_idle_time() {
+  // scanning and connecting poll the SDK
+  if (this->has_sta() && this->state_ != WIFI_COMPONENT_STATE_STA_CONNECTED)
+    return 0;
+
+  uint32_t idle_time = WIFI_IDLE_TIME;
+  if (this->power_save_ == WIFI_POWER_SAVE_ADAPTIVE) {
+    const uint32_t since = millis() - this->last_activity_;
+    const bool active = since < this->power_save_idle_time_;
+    if (active != this->power_save_suspended_)
+      return 0;
+    if (active)
+      idle_time = std::min(idle_time, this->power_save_idle_time_ - since);
+  }
+#ifdef ARDUINO_ARCH_ESP8266
+  idle_time = std::min(idle_time, WIFI_MDNS_IDLE_TIME);
+#endif
+  return idle_time;
+}
 void WiFiComponent::set_ap(const WiFiAP &ap) { this->ap_ = ap; }
 void WiFiComponent::add_sta(const WiFiAP &ap) { this->sta_.push_back(ap); }
 
@@ -266,6 +313,56 @@ void WiFiComponent::print_connect_params_() {
   ESP_LOGCONFIG(TAG, "  DNS2: %s", WiFi.dnsIP(1).toString().c_str());
 }
 
+bool WiFiComponent::start_fast_reconnect_() {
+  WiFiFastReconnectState state{};
+  if (!this->fast_reconnect_ || !this->fast_reconnect_pref_.load(&state) || state.channel == 0)
+    return false;
+  if (state.sta_index >= this->sta_.size() || state.ssid_hash != fnv1_hash(this->sta_[state.sta_index].get_ssid())) {
+    ESP_LOGV(TAG, "WiFi configuration changed, not using the last access point.");
+    return false;
+  }
+
+  WiFiAP params = this->sta_[state.sta_index];
+  bssid_t bssid;
+  std::copy(state.bssid, state.bssid + 6, bssid.begin());
+  params.set_bssid(bssid);
+  params.set_channel(state.channel);
+  if (this->cache_dhcp_lease_ && !params.get_manual_ip().has_value() && state.ip != 0) {
+    ManualIP lease{};
+    lease.static_ip = IPAddress(state.ip);
+    lease.gateway = IPAddress(state.gateway);
+    lease.subnet = IPAddress(state.subnet);
+    lease.dns1 = IPAddress(state.dns1);
+    lease.dns2 = IPAddress(state.dns2);
+    params.set_manual_ip(lease);
+  }
+
+  ESP_LOGD(TAG, "Connecting to the last access point on channel %u...", state.channel);
+  this->fast_reconnecting_ = true;
+  this->selected_ap_ = params;
+  this->selected_sta_index_ = state.sta_index;
+  this->start_connecting(params, false);
+  return true;
+}
+void WiFiComponent::save_fast_reconnect_() {
+  if (!this->fast_reconnect_)
+    return;
+
+  WiFiFastReconnectState state{};
+  state.ssid_hash = fnv1_hash(this->sta_[this->selected_sta_index_].get_ssid());
+  memcpy(state.bssid, WiFi.BSSID(), 6);
+  state.channel = WiFi.channel();
+  state.sta_index = this->selected_sta_index_;
+  if (this->cache_dhcp_lease_ && !this->sta_[this->selected_sta_index_].get_manual_ip().has_value()) {
+    state.ip = WiFi.localIP();
+    state.gateway = WiFi.gatewayIP();
+    state.subnet = WiFi.subnetMask();
+    state.dns1 = WiFi.dnsIP(0);
+    state.dns2 = WiFi.dnsIP(1);
+  }
+  this->fast_reconnect_pref_.save(&state);
+}
+
 void WiFiComponent::start_scanning() {
   this->action_started_ = millis();
   ESP_LOGD(TAG, "Starting scan...");
@@ -282,33 +379,10 @@ void WiFiComponent::check_scanning_finished() {
     return;
   }
   this->scan_done_ = false;
+  this->scan_duration_ = millis() - this->action_started_;
 
+  // the results are already matched against the configuration and sorted by the scan callbacks
   ESP_LOGD(TAG, "Found networks:");
-  if (this->scan_result_.empty()) {
-    ESP_LOGD(TAG, "  No network found!");
-    this->retry_connect();
-    return;
-  }
-
-  for (auto &res : this->scan_result_) {
-    for (auto &ap : this->sta_) {
-      if (res.matches(ap)) {
-        res.set_matches(true);
-        break;
-      }
-    }
-  }
-
-  std::stable_sort(this->scan_result_.begin(), this->scan_result_.end(),
-                   [this](const WiFiScanResult &a, const WiFiScanResult &b) {
-                     if (a.get_matches() && !b.get_matches())
-                       return true;
-                     if (!a.get_matches() && b.get_matches())
-                       return false;
-
-                     return a.get_rssi() > b.get_rssi();
-                   });
-
   for (auto &res : this->scan_result_) {
     char bssid_s[18];
     auto bssid = res.get_bssid();
@@ -316,29 +390,28 @@ void WiFiComponent::check_scanning_finished() {
     char signal_bars[50];
     print_signal_bars(res.get_rssi(), signal_bars);
 
-    if (res.get_matches()) {
-      ESP_LOGI(TAG, "- '%s' %s" LOG_SECRET("(%s) ") "%s", res.get_ssid().c_str(),
-               res.get_is_hidden() ? "(HIDDEN) " : "", bssid_s, signal_bars);
-      ESP_LOGD(TAG, "    Channel: %u", res.get_channel());
-      ESP_LOGD(TAG, "    RSSI: %d dB", res.get_rssi());
-    } else {
-      ESP_LOGD(TAG, "- " LOG_SECRET("'%s'") " " LOG_SECRET("(%s) ") "%s", res.get_ssid().c_str(), bssid_s, signal_bars);
-    }
+    ESP_LOGI(TAG, "- '%s' %s" LOG_SECRET("(%s) ") "%s", res.get_ssid(), res.get_is_hidden() ? "(HIDDEN) " : "",
+             bssid_s, signal_bars);
+    ESP_LOGD(TAG, "    Channel: %u", res.get_channel());
+    ESP_LOGD(TAG, "    RSSI: %d dB", res.get_rssi());
   }
+  ESP_LOGD(TAG, "  and %u other networks", this->scan_ignored_);
 
-  if (!this->scan_result_[0].get_matches()) {
+  if (this->scan_result_.empty()) {
     ESP_LOGW(TAG, "No matching network found!");
     this->retry_connect();
     return;
   }
 
   WiFiAP connect_params;
-  WiFiScanResult scan_res = this->scan_result_[0];
-  for (auto &config : this->sta_) {
+  const WiFiScanResult &scan_res = this->scan_result_[0];
+  for (uint8_t i = 0; i < this->sta_.size(); i++) {
+    auto &config = this->sta_[i];
     // search for matching STA config, at least one will match (from checks before)
     if (!scan_res.matches(config)) {
       continue;
     }
+    this->selected_sta_index_ = i;
 
     if (config.get_hidden()) {
       // selected network is hidden, we use the data from the config
@@ -370,14 +443,21 @@ void WiFiComponent::check_scanning_finished() {
 void WiFiComponent::dump_config() {
   ESP_LOGCONFIG(TAG, "WiFi:");
   this->print_connect_params_();
+  if (this->power_save_ == WIFI_POWER_SAVE_ADAPTIVE)
+    ESP_LOGCONFIG(TAG, "  Adaptive Power Save, Idle Time: %u ms", this->power_save_idle_time_);
 }
 
 void WiFiComponent::check_connecting_finished() {
   wl_status_t status = this->wifi_sta_status_();
 
   if (status == WL_CONNECTED) {
-    ESP_LOGI(TAG, "WiFi connected!");
+    const uint32_t now = millis();
+    ESP_LOGI(TAG, "WiFi connected in %u ms%s!", now - this->connect_started_,
+             this->fast_reconnecting_ ? " to the last access point" : "");
+    ESP_LOGD(TAG, "  Scan: %u ms, association and IP: %u ms", this->scan_duration_, now - this->action_started_);
     this->print_connect_params_();
+    this->fast_reconnecting_ = false;
+    this->save_fast_reconnect_();
 
     if (this->has_ap()) {
       ESP_LOGD(TAG, "Disabling AP...");
@@ -424,6 +504,14 @@ void WiFiComponent::check_connecting_finished() {
 }
 
 void WiFiComponent::retry_connect() {
+  if (this->fast_reconnecting_) {
+    // the access point might have changed, fall back to scanning right away
+    ESP_LOGW(TAG, "Connecting to the last access point failed, scanning...");
+    this->fast_reconnecting_ = false;
+    this->error_from_callback_ = false;
+    this->start_scanning();
+    return;
+  }
   if (this->num_retried_ > 5 || this->error_from_callback_) {
     // If retry failed for more than 5 times, let's restart STA
     ESP_LOGW(TAG, "Restarting WiFi adapter...");
@@ -459,12 +547,51 @@ bool WiFiComponent::is_connected() {
   return this->state_ == WIFI_COMPONENT_STATE_STA_CONNECTED && this->wifi_sta_status_() == WL_CONNECTED &&
          !this->error_from_callback_;
 }
+void WiFiComponent::add_scan_result_(const WiFiScanResult &res) {
+  bool matches = false;
+  for (auto &ap : this->sta_) {
+    if (res.matches(ap)) {
+      matches = true;
+      break;
+    }
+  }
+  if (!matches) {
+    this->scan_ignored_++;
+    return;
+  }
+
+  // insertion sort, the list is short and already sorted by RSSI
+  size_t index = 0;
+  while (index < this->scan_result_.size() && this->scan_result_[index].get_rssi() >= res.get_rssi())
+    index++;
+  if (index == WIFI_MAX_SCAN_RESULTS) {
+    this->scan_ignored_++;
+    return;
+  }
+  if (this->scan_result_.size() == WIFI_MAX_SCAN_RESULTS) {
+    this->scan_result_.pop_back();
+    this->scan_ignored_++;
+  }
+  this->scan_result_.insert(this->scan_result_.begin() + index, res);
+}
 bool WiFiComponent::ready_for_ota() {
   if (this->has_ap())
     return true;
   return this->is_connected();
 }
 void WiFiComponent::set_power_save_mode(WiFiPowerSaveMode power_save) { this->power_save_ = power_save; }
+void WiFiComponent::set_power_save_idle_time(uint32_t power_save_idle_time) {
+  this->power_save_idle_time_ = power_save_idle_time;
+}
+void WiFiComponent::notify_activity() { this->last_activity_ = millis(); }
+void WiFiComponent::update_adaptive_power_save_() {
+  const bool active = millis() - this->last_activity_ < this->power_save_idle_time_;
+  if (active == this->power_save_suspended_)
+    return;
+  ESP_LOGV(TAG, "%s power save.", active ? "Traffic, disabling" : "Idle, enabling");
+  this->power_save_suspended_ = active;
+  this->wifi_apply_power_save_();
+}
 
 std::string WiFiComponent::format_mac_addr(const uint8_t *mac) {
   char buf[20];
@@ -487,7 +614,10 @@ bool sta_field_equal(const uint8_t *field_a, const uint8_t *field_b, int len) {
   return true;
 }
 
-void WiFiAP::set_ssid(const std::string &ssid) { this->ssid_ = ssid; }
+void WiFiAP::set_ssid(const std::string &ssid) {
+  this->ssid_ = ssid;
+  this->ssid_hash_ = fnv1_hash(ssid);
+}
 void WiFiAP::set_bssid(bssid_t bssid) { this->bssid_ = bssid; }
 void WiFiAP::set_bssid(optional<bssid_t> bssid) { this->bssid_ = bssid; }
 void WiFiAP::set_password(const std::string &password) { this->password_ = password; }
@@ -495,24 +625,30 @@ void WiFiAP::set_channel(optional<uint8_t> channel) { this->channel_ = channel;
 void WiFiAP::set_manual_ip(optional<ManualIP> manual_ip) { this->manual_ip_ = manual_ip; }
 void WiFiAP::set_hidden(bool hidden) { this->hidden_ = hidden; }
 const std::string &WiFiAP::get_ssid() const { return this->ssid_; }
+uint32_t WiFiAP::get_ssid_hash() const { return this->ssid_hash_; }
 const optional<bssid_t> &WiFiAP::get_bssid() const { return this->bssid_; }
 const std::string &WiFiAP::get_password() const { return this->password_; }
 const optional<uint8_t> &WiFiAP::get_channel() const { return this->channel_; }
 const optional<ManualIP> &WiFiAP::get_manual_ip() const { return this->manual_ip_; }
 bool WiFiAP::get_hidden() const { return this->hidden_; }
 
-WiFiScanResult::WiFiScanResult(const bssid_t &bssid, const std::string &ssid, uint8_t channel, int8_t rssi,
+WiFiScanResult::WiFiScanResult(const bssid_t &bssid, const char *ssid, size_t ssid_len, uint8_t channel, int8_t rssi,
                                bool with_auth, bool is_hidden)
-    : bssid_(bssid), ssid_(ssid), channel_(channel), rssi_(rssi), with_auth_(with_auth), is_hidden_(is_hidden) {}
-bool WiFiScanResult::matches(const WiFiAP &config) {
+    : bssid_(bssid), channel_(channel), rssi_(rssi), with_auth_(with_auth), is_hidden_(is_hidden) {
+  ssid_len = std::min(ssid_len, sizeof(this->ssid_) - 1);
+  memcpy(this->ssid_, ssid, ssid_len);
+  this->ssid_[ssid_len] = '\0';
+  this->ssid_hash_ = fnv1_hash(this->ssid_, ssid_len);
+}
+bool WiFiScanResult::matches(const WiFiAP &config) const {
   if (config.get_hidden()) {
     // User configured a hidden network, only match actually hidden networks
     // don't match SSID
     if (!this->is_hidden_)
       return false;
   } else if (!config.get_ssid().empty()) {
-    // check if SSID matches
-    if (config.get_ssid() != this->ssid_)
+    // check if SSID matches, the hash rules out most networks without comparing the strings
+    if (config.get_ssid_hash() != this->ssid_hash_ || config.get_ssid() != this->ssid_)
       return false;
   } else {
     // network is configured without SSID - match other settings
@@ -529,10 +665,8 @@ bool WiFiScanResult::matches(const WiFiAP &config) {
   }
   return true;
 }
-bool WiFiScanResult::get_matches() const { return this->matches_; }
-void WiFiScanResult::set_matches(bool matches) { this->matches_ = matches; }
 const bssid_t &WiFiScanResult::get_bssid() const { return this->bssid_; }
-const std::string &WiFiScanResult::get_ssid() const { return this->ssid_; }
+const char *WiFiScanResult::get_ssid() const { return this->ssid_; }
 uint8_t WiFiScanResult::get_channel() const { return this->channel_; }
 int8_t WiFiScanResult::get_rssi() const { return this->rssi_; }
 bool WiFiScanResult::get_with_auth() const { return this->with_auth_; }
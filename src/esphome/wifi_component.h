@@ -24,6 +24,7 @@ extern "C" {
 #include "esphome/component.h"
 #include "esphome/helpers.h"
 #include "esphome/defines.h"
+#include "esphome/esppreferences.h"
 
 ESPHOME_NAMESPACE_BEGIN
 
@@ -70,6 +71,8 @@ class WiFiAP {
   void set_manual_ip(optional<ManualIP> manual_ip);
   void set_hidden(bool hidden);
   const std::string &get_ssid() const;
+  /// Get the fnv1 hash of the SSID, for comparing it to scan results.
+  uint32_t get_ssid_hash() const;
   const optional<bssid_t> &get_bssid() const;
   const std::string &get_password() const;
   const optional<uint8_t> &get_channel() const;
@@ -78,6 +81,7 @@ class WiFiAP {
 
  protected:
   std::string ssid_;
+  uint32_t ssid_hash_{0};
   optional<bssid_t> bssid_;
   std::string password_;
   optional<uint8_t> channel_;
@@ -85,36 +89,55 @@ class WiFiAP {
   bool hidden_{false};
 };
 
+/// The maximum number of scan results kept, only the strongest networks that match the configuration are stored.
+#define WIFI_MAX_SCAN_RESULTS 8
+
+/// A network found in a scan, stored without heap allocations.
 class WiFiScanResult {
  public:
-  WiFiScanResult(const bssid_t &bssid, const std::string &ssid, uint8_t channel, int8_t rssi, bool with_auth,
-                 bool is_hidden);
+  WiFiScanResult(const bssid_t &bssid, const char *ssid, size_t ssid_len, uint8_t channel, int8_t rssi,
+                 bool with_auth, bool is_hidden);
 
-  bool matches(const WiFiAP &config);
+  bool matches(const WiFiAP &config) const;
 
-  bool get_matches() const;
-  void set_matches(bool matches);
   const bssid_t &get_bssid() const;
-  const std::string &get_ssid() const;
+  const char *get_ssid() const;
   uint8_t get_channel() const;
   int8_t get_rssi() const;
   bool get_with_auth() const;
   bool get_is_hidden() const;
 
  protected:
-  bool matches_{false};
   bssid_t bssid_;
-  std::string ssid_;
+  char ssid_[33];
+  uint32_t ssid_hash_;
   uint8_t channel_;
   int8_t rssi_;
   bool with_auth_;
   bool is_hidden_;
 };
 
+/// The last successful connection, stored so that the next boot can connect without scanning.
+struct WiFiFastReconnectState {
+  /// Hash of the SSID of the configured network, to detect when the configuration changed.
+  uint32_t ssid_hash;
+  uint8_t bssid[6];
+  uint8_t channel;
+  uint8_t sta_index;
+  /// The DHCP lease, all 0 if not cached.
+  uint32_t ip;
+  uint32_t gateway;
+  uint32_t subnet;
+  uint32_t dns1;
+  uint32_t dns2;
+};
+
 enum WiFiPowerSaveMode {
   WIFI_POWER_SAVE_NONE = 0,
   WIFI_POWER_SAVE_LIGHT,
   WIFI_POWER_SAVE_HIGH,
+  /// Modem sleep while idle, no power save while there's API or MQTT traffic.
+  WIFI_POWER_SAVE_ADAPTIVE,
 };
 
 /// This component is responsible for managing the ESP WiFi interface.
@@ -138,6 +161,16 @@ class WiFiComponent : public Component {
   void check_scanning_finished();
   void start_connecting(const WiFiAP &ap, bool two);
   void set_fast_connect(bool fast_connect);
+  /** Remember the access point (BSSID and channel) of the last connection and connect to it directly on the
+   * next boot or wake from deep sleep, defaults to true.
+   *
+   * Only if that fails the networks are scanned.
+   */
+  void set_fast_reconnect(bool fast_reconnect);
+  /** Also remember the IP address received via DHCP and reuse it as a static IP the next time, saving the
+   * DHCP exchange. Only use this if the router reserves the address for this node, defaults to false.
+   */
+  void set_cache_dhcp_lease(bool cache_dhcp_lease);
 
   void check_connecting_finished();
 
@@ -157,6 +190,7 @@ class WiFiComponent : public Component {
    *  * WIFI_POWER_SAVE_NONE (default, least power saving)
    *  * WIFI_POWER_SAVE_LIGHT
    *  * WIFI_POWER_SAVE_HIGH (try to save as much power as possible)
+   *  * WIFI_POWER_SAVE_ADAPTIVE (modem sleep, but none while API clients or MQTT are active)
    *
    * Note that this can affect WiFi performance, for example a higher power saving option
    * can increase the amount of random disconnects from the WiFi router.
@@ -165,6 +199,17 @@ class WiFiComponent : public Component {
    */
   void set_power_save_mode(WiFiPowerSaveMode power_save);
 
+  /** Set how long after the last API or MQTT traffic WIFI_POWER_SAVE_ADAPTIVE returns to modem sleep,
+   * defaults to 10s.
+   */
+  void set_power_save_idle_time(uint32_t power_save_idle_time);
+
+  /** Report network traffic that should be answered quickly, used by WIFI_POWER_SAVE_ADAPTIVE.
+   *
+   * Only records the time so that it can be called from the TCP callbacks, power save is switched in loop().
+   */
+  void notify_activity();
+
   // ========== INTERNAL METHODS ==========
   // (In most use cases you won't need these)
   /// Setup WiFi interface.
@@ -176,6 +221,8 @@ class WiFiComponent : public Component {
 
   /// Reconnect WiFi if required.
   void loop() override;
+  /// While connected, loop() only checks the connection (and answers mDNS queries on the ESP8266).
+  uint32_t get_loop_idle_time() override;
 
   bool has_sta() const;
   bool has_ap() const;
@@ -188,10 +235,15 @@ class WiFiComponent : public Component {
   static std::string format_mac_addr(const uint8_t mac[6]);
   void setup_ap_config_();
   void print_connect_params_();
+  /// Connect to the access point of the last connection, returns false if there is none.
+  bool start_fast_reconnect_();
+  void save_fast_reconnect_();
 
   bool wifi_mode_(optional<bool> sta, optional<bool> ap);
   bool wifi_disable_auto_connect_();
   bool wifi_apply_power_save_();
+  /// Switch WIFI_POWER_SAVE_ADAPTIVE between modem sleep and no power save depending on the traffic.
+  void update_adaptive_power_save_();
   bool wifi_sta_ip_config_(optional<ManualIP> manual_ip);
   IPAddress wifi_sta_ip_();
   bool wifi_apply_hostname_();
@@ -199,6 +251,8 @@ class WiFiComponent : public Component {
   void wifi_register_callbacks_();
   wl_status_t wifi_sta_status_();
   bool wifi_scan_start_();
+  /// Store res if it matches a configured network and is among the WIFI_MAX_SCAN_RESULTS strongest ones.
+  void add_scan_result_(const WiFiScanResult &res);
   bool wifi_ap_ip_config_(optional<ManualIP> manual_ip);
   bool wifi_start_ap_(const WiFiAP &ap);
   IPAddress wifi_soft_ap_ip_();
@@ -217,17 +271,36 @@ class WiFiComponent : public Component {
   std::string use_address_;
   std::vector<WiFiAP> sta_;
   WiFiAP selected_ap_;
+  /// The index of the configured network selected_ap_ was found for.
+  uint8_t selected_sta_index_{0};
   bool fast_connect_{false};
+  bool fast_reconnect_{true};
+  bool cache_dhcp_lease_{false};
+  ESPPreferenceObject fast_reconnect_pref_;
+  /// Whether the current connection attempt uses the stored access point.
+  bool fast_reconnecting_{false};
+  /// Timing of the phases of the current connection attempt, for logging.
+  uint32_t connect_started_{0};
+  uint32_t scan_duration_{0};
 
   WiFiAP ap_;
   WiFiComponentState state_{WIFI_COMPONENT_STATE_OFF};
   uint32_t action_started_;
   uint8_t num_retried_{0};
+  /// Number of times the connection was lost.
+  uint32_t reconnects_{0};
   uint32_t last_connected_{0};
   uint32_t reboot_timeout_{300000};
   WiFiPowerSaveMode power_save_{WIFI_POWER_SAVE_NONE};
+  uint32_t power_save_idle_time_{10000};
+  uint32_t last_activity_{0};
+  /// Whether WIFI_POWER_SAVE_ADAPTIVE currently has power save disabled because of traffic.
+  bool power_save_suspended_{false};
   bool error_from_callback_{false};
+  /// The matching networks of the last scan, strongest first.
   std::vector<WiFiScanResult> scan_result_;
+  /// How many networks of the last scan weren't stored.
+  uint16_t scan_ignored_{0};
   bool scan_done_{false};
   bool ap_setup_{false};
 };
@@ -13,6 +13,7 @@
 
 #include "esphome/helpers.h"
 #include "esphome/log.h"
+#include "esphome/tracer.h"
 #include "esphome/esphal.h"
 #include "esphome/util.h"
 
@@ -66,6 +67,9 @@ bool WiFiComponent::wifi_apply_power_save_() {
     case WIFI_POWER_SAVE_HIGH:
       power_save = WIFI_PS_MAX_MODEM;
       break;
+    case WIFI_POWER_SAVE_ADAPTIVE:
+      power_save = this->power_save_suspended_ ? WIFI_PS_NONE : WIFI_PS_MIN_MODEM;
+      break;
     case WIFI_POWER_SAVE_NONE:
     default:
       power_save = WIFI_PS_NONE;
@@ -281,6 +285,7 @@ const char *get_disconnect_reason_str(uint8_t reason) {
   }
 }
 void WiFiComponent::wifi_event_callback_(system_event_id_t event, system_event_info_t info) {
+  TRACE_INSTANT(WIFI, "wifi_event", event);
   switch (event) {
     case SYSTEM_EVENT_WIFI_READY: {
       ESP_LOGV(TAG, "Event: WiFi ready");
@@ -402,22 +407,24 @@ bool WiFiComponent::wifi_scan_start_() {
 }
 void WiFiComponent::wifi_scan_done_callback_() {
   this->scan_result_.clear();
+  this->scan_result_.reserve(WIFI_MAX_SCAN_RESULTS);
+  this->scan_ignored_ = 0;
 
   int16_t num = WiFi.scanComplete();
   if (num < 0)
     return;
 
-  this->scan_result_.reserve(static_cast<unsigned int>(num));
   for (int i = 0; i < num; i++) {
-    String ssid = WiFi.SSID(i);
-    wifi_auth_mode_t authmode = WiFi.encryptionType(i);
-    int32_t rssi = WiFi.RSSI(i);
-    uint8_t *bssid = WiFi.BSSID(i);
-    int32_t channel = WiFi.channel(i);
-
-    WiFiScanResult scan({bssid[0], bssid[1], bssid[2], bssid[3], bssid[4], bssid[5]}, std::string(ssid.c_str()),
-                        channel, rssi, authmode != WIFI_AUTH_OPEN, ssid.length() == 0);
-    this->scan_result_.push_back(scan);
+    // read the records directly, WiFi.SSID() would allocate a String for each network
+    auto *record = reinterpret_cast<wifi_ap_record_t *>(WiFi.getScanInfoByIndex(i));
+    if (record == nullptr)
+      continue;
+    const uint8_t *bssid = record->bssid;
+    const size_t ssid_len = strnlen(reinterpret_cast<const char *>(record->ssid), sizeof(record->ssid));
+    WiFiScanResult scan({bssid[0], bssid[1], bssid[2], bssid[3], bssid[4], bssid[5]},
+                        reinterpret_cast<const char *>(record->ssid), ssid_len, record->primary, record->rssi,
+                        record->authmode != WIFI_AUTH_OPEN, ssid_len == 0);
+    this->add_scan_result_(scan);
   }
   WiFi.scanDelete();
   this->scan_done_ = true;
@@ -13,6 +13,7 @@
 
 #include "esphome/helpers.h"
 #include "esphome/log.h"
+#include "esphome/tracer.h"
 #include "esphome/esphal.h"
 #include "esphome/util.h"
 
@@ -81,6 +82,9 @@ bool WiFiComponent::wifi_apply_power_save_() {
     case WIFI_POWER_SAVE_HIGH:
       power_save = MODEM_SLEEP_T;
       break;
+    case WIFI_POWER_SAVE_ADAPTIVE:
+      power_save = this->power_save_suspended_ ? NONE_SLEEP_T : MODEM_SLEEP_T;
+      break;
     case WIFI_POWER_SAVE_NONE:
     default:
       power_save = NONE_SLEEP_T;
@@ -329,6 +333,7 @@ const char *get_disconnect_reason_str(uint8_t reason) {
 }
 
 void WiFiComponent::wifi_event_callback(System_Event_t *event) {
+  TRACE_INSTANT(WIFI, "wifi_event", event->event);
 #ifdef ESPHOME_LOG_HAS_VERBOSE
   // TODO: this callback is called while in cont context, so delay will fail
   // We need to defer the log messages until we're out of this context
@@ -472,6 +477,8 @@ void WiFiComponent::s_wifi_scan_done_callback(void *arg, STATUS status) {
 
 void WiFiComponent::wifi_scan_done_callback_(void *arg, STATUS status) {
   this->scan_result_.clear();
+  this->scan_result_.reserve(WIFI_MAX_SCAN_RESULTS);
+  this->scan_ignored_ = 0;
 
   if (status != OK) {
     ESP_LOGV(TAG, "Scan failed! %d", status);
@@ -480,9 +487,9 @@ void WiFiComponent::wifi_scan_done_callback_(void *arg, STATUS status) {
   bss_info *head = reinterpret_cast<bss_info *>(arg);
   for (bss_info *it = head; it != nullptr; it = STAILQ_NEXT(it, next)) {
     WiFiScanResult res({it->bssid[0], it->bssid[1], it->bssid[2], it->bssid[3], it->bssid[4], it->bssid[5]},
-                       std::string(reinterpret_cast<char *>(it->ssid), it->ssid_len), it->channel, it->rssi,
+                       reinterpret_cast<char *>(it->ssid), it->ssid_len, it->channel, it->rssi,
                        it->authmode != AUTH_OPEN, it->is_hidden != 0);
-    this->scan_result_.push_back(res);
+    this->add_scan_result_(res);
   }
   this->scan_done_ = true;
 }
@@ -0,0 +1,108 @@
+#include "esphome/worker_pool.h"
+#include "esphome/mailbox.h"
+#include "esphome/log.h"
+
+ESPHOME_NAMESPACE_BEGIN
+
+static const char *TAG = "worker_pool";
+
+WorkerPool::WorkerPool(MainLoopMailbox *mailbox) : mailbox_(mailbox) {}
+
+bool WorkerPool::submit(std::function<void()> &&work, std::function<void()> &&on_done) {
+#ifdef ARDUINO_ARCH_ESP32
+  if (!this->started_ && !this->start_()) {
+    this->rejected_++;
+    return false;
+  }
+  auto *item = new WorkItem{std::move(work), std::move(on_done)};
+  for (uint8_t i = 0; i < WORKER_POOL_SIZE; i++) {
+    Worker &worker = this->workers_[(this->next_worker_ + i) % WORKER_POOL_SIZE];
+    if (xQueueSend(worker.queue, &item, 0) != pdTRUE)
+      continue;
+    this->next_worker_ = (this->next_worker_ + 1) % WORKER_POOL_SIZE;
+    xSemaphoreGive(this->available_);
+    return true;
+  }
+  delete item;
+  this->rejected_++;
+  ESP_LOGW(TAG, "All worker queues are full, rejecting work");
+  return false;
+#endif
+#ifdef ARDUINO_ARCH_ESP8266
+  work();
+  this->complete_(new WorkItem{nullptr, std::move(on_done)});
+  return true;
+#endif
+}
+uint32_t WorkerPool::get_rejected() const { return this->rejected_; }
+
+void WorkerPool::complete_(WorkItem *item) {
+  if (!item->on_done) {
+    delete item;
+    return;
+  }
+  // the callback must not be lost, wait for the main loop to make room in the mailbox
+  while (!this->mailbox_->defer(WorkerPool::done_callback, item)) {
+#ifdef ARDUINO_ARCH_ESP32
+    vTaskDelay(1);
+#endif
+#ifdef ARDUINO_ARCH_ESP8266
+    // called from the main loop, nothing would empty the mailbox
+    done_callback(item);
+    return;
+#endif
+  }
+}
+void WorkerPool::done_callback(void *arg) {
+  auto *item = reinterpret_cast<WorkItem *>(arg);
+  item->on_done();
+  delete item;
+}
+
+#ifdef ARDUINO_ARCH_ESP32
+bool WorkerPool::start_() {
+  this->available_ = xSemaphoreCreateCounting(WORKER_POOL_SIZE * WORKER_POOL_QUEUE_SIZE, 0);
+  if (this->available_ == nullptr) {
+    ESP_LOGE(TAG, "Could not create the worker pool semaphore");
+    return false;
+  }
+  for (uint8_t i = 0; i < WORKER_POOL_SIZE; i++) {
+    Worker &worker = this->workers_[i];
+    worker.pool = this;
+    worker.index = i;
+    worker.queue = xQueueCreate(WORKER_POOL_QUEUE_SIZE, sizeof(WorkItem *));
+    if (worker.queue == nullptr ||
+        xTaskCreatePinnedToCore(WorkerPool::worker_task, "worker", WORKER_POOL_STACK_SIZE, &worker, 1, &worker.task,
+                                i % portNUM_PROCESSORS) != pdPASS) {
+      ESP_LOGE(TAG, "Could not start worker %u", i);
+      return false;
+    }
+  }
+  ESP_LOGD(TAG, "Started %u workers", WORKER_POOL_SIZE);
+  this->started_ = true;
+  return true;
+}
+WorkerPool::WorkItem *WorkerPool::take_(uint8_t worker) {
+  // the semaphore was taken, so at least one queue holds an item for this worker
+  while (true) {
+    for (uint8_t i = 0; i < WORKER_POOL_SIZE; i++) {
+      WorkItem *item;
+      if (xQueueReceive(this->workers_[(worker + i) % WORKER_POOL_SIZE].queue, &item, 0) == pdTRUE)
+        return item;
+    }
+  }
+}
+void WorkerPool::worker_task(void *arg) {
+  auto *worker = reinterpret_cast<Worker *>(arg);
+  WorkerPool *pool = worker->pool;
+  while (true) {
+    if (xSemaphoreTake(pool->available_, portMAX_DELAY) != pdTRUE)
+      continue;
+    WorkItem *item = pool->take_(worker->index);
+    item->work();
+    pool->complete_(item);
+  }
+}
+#endif
+
+ESPHOME_NAMESPACE_END
@@ -0,0 +1,87 @@
+#ifndef ESPHOME_WORKER_POOL_H
+#define ESPHOME_WORKER_POOL_H
+
+#include <cstdint>
+#include <functional>
+#include "esphome/defines.h"
+
+#ifdef ARDUINO_ARCH_ESP32
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#endif
+
+ESPHOME_NAMESPACE_BEGIN
+
+class MainLoopMailbox;
+
+#ifdef ARDUINO_ARCH_ESP32
+/// The number of worker tasks, one per core.
+static const uint8_t WORKER_POOL_SIZE = 2;
+/// The number of work items each worker queue holds.
+static const uint8_t WORKER_POOL_QUEUE_SIZE = 8;
+static const uint32_t WORKER_POOL_STACK_SIZE = 4096;
+#endif
+
+/** A small pool of worker tasks for CPU-heavy component work.
+ *
+ * On the ESP32, work is handed to one of WORKER_POOL_SIZE FreeRTOS tasks (one pinned to each core) so that the
+ * main loop keeps running while it executes. Every worker has its own queue and work is distributed round-robin,
+ * a worker that runs out of work takes items from the queues of the other workers, so a single long item doesn't
+ * hold up the ones queued behind it. The completion callback of each item is handed to the main loop through the
+ * mailbox, so it may touch component state freely. The tasks are only created with the first submitted item.
+ *
+ * On the ESP8266 there's only one task, the work runs right away and the completion callback is still called
+ * from a later loop iteration, so callers see the same order of events on both platforms.
+ */
+class WorkerPool {
+ public:
+  explicit WorkerPool(MainLoopMailbox *mailbox);
+
+  /** Run work on a worker task and call on_done from the main loop once it has finished.
+   *
+   * work must not touch state the main loop modifies concurrently. Returns false if all queues are full, in that
+   * case neither work nor on_done is called.
+   */
+  bool submit(std::function<void()> &&work, std::function<void()> &&on_done = nullptr);
+
+  /// The number of items rejected because all queues were full.
+  uint32_t get_rejected() const;
+
+ protected:
+  struct WorkItem {
+    std::function<void()> work;
+    std::function<void()> on_done;
+  };
+
+  /// Hand the item back to the main loop, which calls on_done and frees it.
+  void complete_(WorkItem *item);
+  static void done_callback(void *arg);
+
+#ifdef ARDUINO_ARCH_ESP32
+  bool start_();
+  /// Take the next item, from the queue of this worker first.
+  WorkItem *take_(uint8_t worker);
+  static void worker_task(void *arg);
+
+  struct Worker {
+    WorkerPool *pool;
+    uint8_t index;
+    QueueHandle_t queue;
+    TaskHandle_t task;
+  };
+
+  Worker workers_[WORKER_POOL_SIZE]{};
+  /// Counts the items in all queues, workers block on it while idle.
+  SemaphoreHandle_t available_{nullptr};
+  bool started_{false};
+  uint8_t next_worker_{0};
+#endif
+  MainLoopMailbox *mailbox_;
+  uint32_t rejected_{0};
+};
+
+ESPHOME_NAMESPACE_END
+
+#endif  // ESPHOME_WORKER_POOL_H